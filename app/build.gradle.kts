@@ -27,12 +27,16 @@ android {
             isShrinkResources = false
             isDebuggable = false
             isJniDebuggable = false
+            // optimise the native libraries with the profiles in src/main/jni/pgo if there are any
+            externalNativeBuild { ndkBuild { arguments += "FLAG_PGO_USE=true" } }
         }
         create("nouserlib") { // same as release, but does not allow the user to provide a library
             isMinifyEnabled = true
             isShrinkResources = false
             isDebuggable = false
             isJniDebuggable = false
+            // optimise the native libraries with the profiles in src/main/jni/pgo if there are any
+            externalNativeBuild { ndkBuild { arguments += "FLAG_PGO_USE=true" } }
         }
         debug {
             // "normal" debug has minify for smaller APK to fit the GitHub 25 MB limit when zipped
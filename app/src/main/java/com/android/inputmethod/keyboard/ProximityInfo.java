@@ -14,6 +14,8 @@ import androidx.annotation.NonNull;
 import helium314.keyboard.keyboard.Key;
 import helium314.keyboard.keyboard.internal.TouchPositionCorrection;
 import helium314.keyboard.latin.common.Constants;
+import helium314.keyboard.latin.common.InputPointers;
+import helium314.keyboard.latin.common.StringUtils;
 import helium314.keyboard.latin.utils.JniUtils;
 
 import java.util.ArrayList;
@@ -92,6 +94,11 @@ public class ProximityInfo {
 
     private static native void releaseProximityInfoNative(long nativeProximityInfo);
 
+    private static native int getMemoryUsageNative(long nativeProximityInfo, long[] outBytes);
+
+    private static native void learnTouchPositionsNative(long nativeProximityInfo,
+            int[] xCoordinates, int[] yCoordinates, int[] codePoints, int inputSize);
+
     public static boolean needsProximityInfo(final Key key) {
         // Don't include special keys into ProximityInfo.
         return key.getCode() >= Constants.CODE_SPACE;
@@ -224,6 +231,38 @@ public class ProximityInfo {
         return mNativeProximityInfo;
     }
 
+    /**
+     * Reads the native memory held by this proximity info, indexed by the
+     * BinaryDictionary.MEMORY_USAGE_* categories. Keyboards with the same geometry share the
+     * native instance, so each of them reports all of it.
+     */
+    public void getMemoryUsage(final long[] outBytes) {
+        Arrays.fill(outBytes, 0);
+        getMemoryUsageNative(mNativeProximityInfo, outBytes);
+    }
+
+    /**
+     * Learns where the keys of a typed word were tapped. The native touch position model shifts
+     * the keys of all keyboards towards where the user taps them.
+     *
+     * @param inputPointers the taps of the word, one per code point.
+     * @param committedWord the word that was committed for these taps.
+     */
+    public void learnTouchPositions(@NonNull final InputPointers inputPointers,
+            @NonNull final String committedWord) {
+        if (mNativeProximityInfo == 0) {
+            return;
+        }
+        final int[] codePoints = StringUtils.toCodePointArray(committedWord);
+        final int inputSize = inputPointers.getPointerSize();
+        if (codePoints.length != inputSize) {
+            // The taps don't tell which key each of them was aimed at.
+            return;
+        }
+        learnTouchPositionsNative(mNativeProximityInfo, inputPointers.getXCoordinates(),
+                inputPointers.getYCoordinates(), codePoints, inputSize);
+    }
+
     @Override
     protected void finalize() throws Throwable {
         try {
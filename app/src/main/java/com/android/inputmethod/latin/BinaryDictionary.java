@@ -6,6 +6,7 @@
 
 package com.android.inputmethod.latin;
 
+import android.content.ComponentCallbacks2;
 import android.text.TextUtils;
 import helium314.keyboard.latin.utils.Log;
 import android.util.SparseArray;
@@ -22,6 +23,7 @@ import helium314.keyboard.latin.common.InputPointers;
 import helium314.keyboard.latin.common.StringUtils;
 import helium314.keyboard.latin.makedict.DictionaryHeader;
 import helium314.keyboard.latin.makedict.FormatSpec.DictionaryOptions;
+import helium314.keyboard.latin.makedict.ProbabilityInfo;
 import helium314.keyboard.latin.makedict.UnsupportedFormatException;
 import helium314.keyboard.latin.makedict.WordProperty;
 import helium314.keyboard.latin.settings.SettingsValuesForSuggestion;
@@ -30,11 +32,15 @@ import helium314.keyboard.latin.utils.JniUtils;
 import com.android.inputmethod.latin.utils.WordInputEventForPersonalization;
 
 import java.io.File;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.HashMap;
 import java.util.Locale;
 import java.util.Map;
+import java.util.concurrent.atomic.AtomicInteger;
 
 /**
  * Implements a static, compacted, binary dictionary of standard words.
@@ -54,6 +60,10 @@ public final class BinaryDictionary extends Dictionary {
     public static final String BIGRAM_COUNT_QUERY = "BIGRAM_COUNT";
     public static final String MAX_UNIGRAM_COUNT_QUERY = "MAX_UNIGRAM_COUNT";
     public static final String MAX_BIGRAM_COUNT_QUERY = "MAX_BIGRAM_COUNT";
+    public static final String TYPING_BEAM_WIDTH_QUERY = "TYPING_BEAM_WIDTH";
+    // 0 when the typing search runs with all its corrections, up to 3 when it has been degraded
+    // to meet its time budget.
+    public static final String TYPING_DEGRADATION_LEVEL_QUERY = "TYPING_DEGRADATION_LEVEL";
 
     public static final int NOT_A_VALID_TIMESTAMP = -1;
 
@@ -74,13 +84,61 @@ public final class BinaryDictionary extends Dictionary {
 
     public static final String DICT_FILE_NAME_SUFFIX_FOR_MIGRATION = ".migrate";
     public static final String DIR_NAME_SUFFIX_FOR_RECORD_MIGRATION = ".migrating";
+    public static final String DICT_FILE_NAME_SUFFIX_FOR_GC = ".gc";
+
+    // Layout of the values written by getNativeMetrics().
+    // Must be equal to NativeMetrics in native/jni/src/utils/native_metrics.h
+    public static final int METRIC_SUGGEST_SETUP = 0;
+    public static final int METRIC_SUGGEST_EXPAND = 1;
+    public static final int METRIC_SUGGEST_OUTPUT = 2;
+    public static final int METRIC_GET_PREDICTIONS = 3;
+    public static final int METRIC_FLUSH = 4;
+    public static final int METRIC_FLUSH_WITH_GC = 5;
+    public static final int METRIC_COUNT = 6;
+    // Bucket i > 0 counts the latencies from 2^i to 2^(i+1) us, bucket 0 those under 2 us.
+    public static final int METRIC_BUCKET_COUNT = 26;
+    public static final int METRIC_COUNT_INDEX = 0;
+    public static final int METRIC_SUM_US_INDEX = 1;
+    public static final int METRIC_MAX_US_INDEX = 2;
+    public static final int METRIC_FIRST_BUCKET_INDEX = 3;
+    public static final int METRIC_VALUES_PER_METRIC = METRIC_FIRST_BUCKET_INDEX + METRIC_BUCKET_COUNT;
+    public static final int METRIC_VALUE_COUNT = METRIC_COUNT * METRIC_VALUES_PER_METRIC;
+
+    // Categories of the values written by getMemoryUsage().
+    // Must be equal to MemoryUsage::Category in native/jni/src/utils/memory_usage.h
+    // Mapped dictionary files, clean unless an updatable dictionary has written them.
+    public static final int MEMORY_USAGE_MAPPED_FILE_BYTES = 0;
+    // Updates of an updatable dictionary since the last GC, private dirty memory.
+    public static final int MEMORY_USAGE_ADDITIONAL_BUFFER_BYTES = 1;
+    // Pools and caches that are rebuilt on demand.
+    public static final int MEMORY_USAGE_CACHE_BYTES = 2;
+    public static final int MEMORY_USAGE_HEAP_BYTES = 3;
+    public static final int MEMORY_USAGE_CATEGORY_COUNT = 4;
+
+    // Layout of the sample counts written by getSamplingProfile().
+    // Must be equal to NativeSamplingProfiler in native/jni/src/utils/native_sampling_profiler.h
+    public static final int SAMPLING_PROFILE_MAX_PC_COUNT = 1024;
+    public static final int SAMPLING_PROFILE_TOTAL_INDEX = 0;
+    public static final int SAMPLING_PROFILE_OUTSIDE_LIBRARY_INDEX = 1;
+    public static final int SAMPLING_PROFILE_DROPPED_INDEX = 2;
+    public static final int SAMPLING_PROFILE_SAMPLE_COUNT_SIZE = 3;
+
+    // Levels of trimMemoryNative().
+    // Must be equal to Dictionary::TRIM_MEMORY_* in native/jni/src/suggest/core/dictionary/dictionary.h
+    // Frees the prediction cache and the caches of the traverse sessions.
+    private static final int TRIM_MEMORY_CACHES = 1;
+    // Also deletes the idle native sessions and drops the resident pages of read-only dictionaries.
+    private static final int TRIM_MEMORY_ALL = 2;
 
     private long mNativeDict;
     private final long mDictSize;
     private final String mDictFilePath;
     private final boolean mUseFullEditDistance;
     private final boolean mIsUpdatable;
-    private boolean mHasUpdated;
+    // Set by the updates, which can run concurrently with a flush.
+    private volatile boolean mHasUpdated;
+    // Counts the updates. Unlike mHasUpdated, flushing doesn't reset it.
+    private final AtomicInteger mUpdateCount = new AtomicInteger();
 
     private final SparseArray<DicTraverseSession> mDicTraverseSessions = new SparseArray<>();
 
@@ -90,7 +148,7 @@ public final class BinaryDictionary extends Dictionary {
         synchronized(mDicTraverseSessions) {
             DicTraverseSession traverseSession = mDicTraverseSessions.get(traverseSessionId);
             if (traverseSession == null) {
-                traverseSession = new DicTraverseSession(mLocale, mNativeDict, mDictSize);
+                traverseSession = new DicTraverseSession(mNativeDict, mDictSize);
                 mDicTraverseSessions.put(traverseSessionId, traverseSession);
             }
             return traverseSession;
@@ -118,6 +176,60 @@ public final class BinaryDictionary extends Dictionary {
         loadDictionary(filename, offset, length, isUpdatable);
     }
 
+    private BinaryDictionary(final long nativeDict, final String filename, final long length,
+            final boolean useFullEditDistance, final Locale locale, final String dictType,
+            final boolean isUpdatable) {
+        super(dictType, locale);
+        mDictSize = length;
+        mDictFilePath = filename;
+        mIsUpdatable = isUpdatable;
+        mHasUpdated = false;
+        mUseFullEditDistance = useFullEditDistance;
+        mNativeDict = nativeDict;
+    }
+
+    /**
+     * Opens several independent dictionary files at once. The native side opens them in parallel,
+     * which shortens the startup when the main, user history, contacts and personal dictionaries
+     * are all needed.
+     * @param filenames the names of the files to read through native code.
+     * @param offsets the offsets of the dictionary data within the files.
+     * @param lengths the lengths of the binary data.
+     * @param useFullEditDistance whether to use the full edit distance in suggestions
+     * @param dictTypes the dictionary types, as human-readable strings
+     * @param isUpdatables whether to open each dictionary file in writable mode.
+     * @return the dictionaries, in the order of the files. The ones that couldn't be opened are
+     * not valid.
+     */
+    public static BinaryDictionary[] openMany(final String[] filenames, final long[] offsets,
+            final long[] lengths, final boolean useFullEditDistance, final Locale locale,
+            final String[] dictTypes, final boolean[] isUpdatables) {
+        final long[] nativeDicts = new long[filenames.length];
+        openManyNative(filenames, offsets, lengths, isUpdatables, nativeDicts);
+        final BinaryDictionary[] dictionaries = new BinaryDictionary[filenames.length];
+        for (int i = 0; i < filenames.length; i++) {
+            dictionaries[i] = new BinaryDictionary(nativeDicts[i], filenames[i], lengths[i],
+                    useFullEditDistance, locale, dictTypes[i], isUpdatables[i]);
+        }
+        return dictionaries;
+    }
+
+    /**
+     * Opens a read-only snapshot of a dictionary directory to run GC on with flushWithGCTo(). GC
+     * never writes to the file, and unlike an updatable dictionary the snapshot doesn't keep a
+     * replica for concurrent reads. The update log of the directory is replayed into the snapshot
+     * but neither changed nor appended to.
+     * @param filename the name of the dictionary directory.
+     * @param length the length of the dictionary data.
+     * @param dictType the dictionary type, as a human-readable string
+     * @return the snapshot, which is not valid if it couldn't be opened.
+     */
+    public static BinaryDictionary openSnapshot(final String filename, final long length,
+            final Locale locale, final String dictType) {
+        return new BinaryDictionary(openSnapshotNative(filename), filename, length,
+                true /* useFullEditDistance */, locale, dictType, false /* isUpdatable */);
+    }
+
     /**
      * Constructs binary dictionary on memory.
      * @param filename the name of the file used to flush.
@@ -154,6 +266,9 @@ public final class BinaryDictionary extends Dictionary {
 
     private static native long openNative(String sourceDir, long dictOffset, long dictSize,
             boolean isUpdatable);
+    private static native long openSnapshotNative(String sourceDir);
+    private static native void openManyNative(String[] sourceDirs, long[] dictOffsets,
+            long[] dictSizes, boolean[] isUpdatables, long[] outNativeDicts);
     private static native long createOnMemoryNative(long formatVersion,
             String locale, String[] attributeKeyStringArray, String[] attributeValueStringArray);
     private static native void getHeaderInfoNative(long dict, int[] outHeaderSize,
@@ -168,6 +283,10 @@ public final class BinaryDictionary extends Dictionary {
     private static native int getMaxProbabilityOfExactMatchesNative(long dict, int[] word);
     private static native int getNgramProbabilityNative(long dict, int[][] prevWordCodePointArrays,
             boolean[] isBeginningOfSentenceArray, int[] word);
+    // Writes the start and end offsets of the misspelled words of text to outMisspelledRanges and
+    // returns the count of the ranges.
+    private static native int getMisspelledRangesNative(long dict, String text,
+            int[] outMisspelledRanges);
     private static native void getWordPropertyNative(long dict, int[] word,
             boolean isBeginningOfSentence, int[] outCodePoints, boolean[] outFlags,
             int[] outProbabilityInfo, ArrayList<int[][]> outNgramPrevWordsArray,
@@ -176,6 +295,8 @@ public final class BinaryDictionary extends Dictionary {
             ArrayList<int[]> outShortcutTargets, ArrayList<Integer> outShortcutProbabilities);
     private static native int getNextWordNative(long dict, int token, int[] outCodePoints,
             boolean[] outIsBeginningOfSentence);
+    // Writes as many words as fit into outputBuffer, laid out as described in exportWords().
+    private static native int getNextWordsNative(long dict, int token, ByteBuffer outputBuffer);
     private static native void getSuggestionsNative(long dict, long proximityInfo,
             long traverseSession, int[] xCoordinates, int[] yCoordinates, int[] times,
             int[] pointerIds, int[] inputCodePoints, int inputSize, int[] suggestOptions,
@@ -184,9 +305,19 @@ public final class BinaryDictionary extends Dictionary {
             int[] outputScores, int[] outputIndices, int[] outputTypes,
             int[] outputAutoCommitFirstWordConfidence,
             float[] inOutWeightOfLangModelVsSpatialModel);
+    // Same as getSuggestionsNative, but reads the input from and writes the output to direct
+    // buffers laid out as described in DicTraverseSession.
+    private static native void getSuggestionsWithBuffersNative(long dict, long proximityInfo,
+            long traverseSession, ByteBuffer inputBuffer, int[] suggestOptions,
+            int[][] prevWordCodePointArrays, boolean[] isBeginningOfSentenceArray,
+            int prevWordCount, ByteBuffer outputBuffer);
     private static native boolean addUnigramEntryNative(long dict, int[] word, int probability,
             int[] shortcutTarget, int shortcutProbability, boolean isBeginningOfSentence,
             boolean isNotAWord, boolean isPossiblyOffensive, int timestamp);
+    private static native boolean addUnigramEntriesNative(long dict, int[] packedCodePoints,
+            int[] wordStartOffsets, int[] probabilities, int[] packedShortcutTargetCodePoints,
+            int[] shortcutTargetStartOffsets, int[] shortcutProbabilities, boolean[] isNotAWord,
+            int timestamp);
     private static native boolean removeUnigramEntryNative(long dict, int[] word);
     private static native boolean addNgramEntryNative(long dict,
             int[][] prevWordCodePointArrays, boolean[] isBeginningOfSentenceArray,
@@ -197,11 +328,92 @@ public final class BinaryDictionary extends Dictionary {
             int[][] prevWordCodePointArrays, boolean[] isBeginningOfSentenceArray,
             int[] word, boolean isValidWord, int count, int timestamp);
     private static native int updateEntriesForInputEventsNative(long dict,
-            WordInputEventForPersonalization[] inputEvents, int startIndex);
+            int[] packedInputEvents, int startIndex);
     private static native String getPropertyNative(long dict, String query);
     private static native boolean isCorruptedNative(long dict);
     private static native boolean migrateNative(long dict, String dictFilePath,
             long newFormatVersion);
+    private static native int getNativeMetricsNative(long[] outValues);
+    private static native boolean setNativeTracingEnabledNative(boolean enabled);
+    private static native boolean startSamplingProfilerNative(int samplingIntervalUs);
+    private static native void stopSamplingProfilerNative();
+    private static native int getSamplingProfileNative(long[] outPcOffsets, int[] outCounts,
+            long[] outSampleCounts);
+    private static native int getMemoryUsageNative(long dict, long[] outBytes);
+    private static native void trimMemoryNative(long dict, int level);
+    private static native void prewarmNative(long dict, long traverseSession);
+
+    /**
+     * Reads the latency metrics that native code keeps for all dictionaries since the process
+     * started, METRIC_VALUES_PER_METRIC values per metric in the order of the METRIC_* ids.
+     * @param outValues receives the values, should have METRIC_VALUE_COUNT elements
+     * @return the number of values written, only whole metrics are written
+     */
+    public static int getNativeMetrics(final long[] outValues) {
+        return getNativeMetricsNative(outValues);
+    }
+
+    /**
+     * Toggles the systrace sections around the native suggestion, dictionary open, flush and GC
+     * code, so that they can be lined up with the frame timelines.
+     * @return whether tracing is enabled now, false if ATrace is not available (below API 23)
+     */
+    public static boolean setNativeTracingEnabled(final boolean enabled) {
+        return setNativeTracingEnabledNative(enabled);
+    }
+
+    /**
+     * Starts sampling the native code of libjni_latinime every samplingIntervalUs of CPU time,
+     * clearing the previous samples. Only one library can be profiled at a time, see
+     * WhisperGGML.startSamplingProfiler. Samples outside of the library are attributed to the
+     * caller inside it only when it is built with FLAG_SAMPLING_PROFILE.
+     * @return whether the profiler is running now
+     */
+    public static boolean startSamplingProfiler(final int samplingIntervalUs) {
+        return startSamplingProfilerNative(samplingIntervalUs);
+    }
+
+    public static void stopSamplingProfiler() {
+        stopSamplingProfilerNative();
+    }
+
+    /**
+     * Reads the samples since startSamplingProfiler(). The PC offsets are relative to the load
+     * address of libjni_latinime, for addr2line on the unstripped library of the same build.
+     * @param outPcOffsets receives the PC offsets, should have SAMPLING_PROFILE_MAX_PC_COUNT
+     * elements
+     * @param outCounts receives the number of samples of each PC offset
+     * @param outSampleCounts receives the SAMPLING_PROFILE_*_INDEX counts, should have
+     * SAMPLING_PROFILE_SAMPLE_COUNT_SIZE elements
+     * @return the number of PC offsets written
+     */
+    public static int getSamplingProfile(final long[] outPcOffsets, final int[] outCounts,
+            final long[] outSampleCounts) {
+        return getSamplingProfileNative(outPcOffsets, outCounts, outSampleCounts);
+    }
+
+    /**
+     * Estimates a latency percentile of a metric from the values read by getNativeMetrics().
+     * @return the upper bound in microseconds of the bucket holding the percentile, capped at the
+     * maximum latency, or 0 if the metric has no samples
+     */
+    public static long getNativeMetricPercentileUs(final long[] values, final int metric,
+            final float percentile) {
+        final int offset = metric * METRIC_VALUES_PER_METRIC;
+        final long count = values[offset + METRIC_COUNT_INDEX];
+        if (count == 0) {
+            return 0;
+        }
+        final long rank = Math.max(1, (long) Math.ceil(count * percentile));
+        long seen = 0;
+        for (int i = 0; i < METRIC_BUCKET_COUNT; i++) {
+            seen += values[offset + METRIC_FIRST_BUCKET_INDEX + i];
+            if (seen >= rank) {
+                return Math.min((1L << (i + 1)) - 1, values[offset + METRIC_MAX_US_INDEX]);
+            }
+        }
+        return values[offset + METRIC_MAX_US_INDEX];
+    }
 
     // TODO: Move native dict into session
     private void loadDictionary(final String path, final long startOffset,
@@ -279,46 +491,38 @@ public final class BinaryDictionary extends Dictionary {
             session.mNativeSuggestOptions.setIsSpaceAwareGesture(settingsValuesForSuggestion.mSpaceAwareGesture);
         session.mNativeSuggestOptions.setBlockOffensiveWords(settingsValuesForSuggestion.mBlockPotentiallyOffensive);
         session.mNativeSuggestOptions.setWeightForLocale(weightForLocale);
-        if (inOutWeightOfLangModelVsSpatialModel != null) {
-            session.mInputOutputWeightOfLangModelVsSpatialModel[0] =
-                    inOutWeightOfLangModelVsSpatialModel[0];
-        } else {
-            session.mInputOutputWeightOfLangModelVsSpatialModel[0] =
-                    Dictionary.NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL;
-        }
+        session.setOutputWeightOfLangModelVsSpatialModel(
+                inOutWeightOfLangModelVsSpatialModel != null
+                        ? inOutWeightOfLangModelVsSpatialModel[0]
+                        : Dictionary.NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL);
         // TOOD: Pass multiple previous words information for n-gram.
-        getSuggestionsNative(mNativeDict, proximityInfoHandle,
-                getTraverseSession(sessionId).getSession(), inputPointers.getXCoordinates(),
-                inputPointers.getYCoordinates(), inputPointers.getTimes(),
-                inputPointers.getPointerIds(), session.mInputCodePoints, inputSize,
-                session.mNativeSuggestOptions.getOptions(), session.mPrevWordCodePointArrays,
-                session.mIsBeginningOfSentenceArray, ngramContext.getPrevWordCount(),
-                session.mOutputSuggestionCount, session.mOutputCodePoints, session.mOutputScores,
-                session.mSpaceIndices, session.mOutputTypes,
-                session.mOutputAutoCommitFirstWordConfidence,
-                session.mInputOutputWeightOfLangModelVsSpatialModel);
+        // The lock keeps trimMemory() from freeing the caches of the session during the search.
+        synchronized (session) {
+            getSuggestionsWithBuffersNative(mNativeDict, proximityInfoHandle,
+                    session.getSession(), session.fillInputBuffer(inputPointers, inputSize),
+                    session.mNativeSuggestOptions.getOptions(), session.mPrevWordCodePointArrays,
+                    session.mIsBeginningOfSentenceArray, ngramContext.getPrevWordCount(),
+                    session.mOutputBuffer);
+        }
         if (inOutWeightOfLangModelVsSpatialModel != null) {
             inOutWeightOfLangModelVsSpatialModel[0] =
-                    session.mInputOutputWeightOfLangModelVsSpatialModel[0];
+                    session.getOutputWeightOfLangModelVsSpatialModel();
         }
-        final int count = session.mOutputSuggestionCount[0];
+        final int count = session.getOutputSuggestionCount();
+        final int autoCommitFirstWordConfidence = session.getOutputAutoCommitFirstWordConfidence();
+        final int[] codePoints = new int[DICTIONARY_MAX_WORD_LENGTH];
         final ArrayList<SuggestedWordInfo> suggestions = new ArrayList<>();
         for (int j = 0; j < count; ++j) {
-            final int start = j * DICTIONARY_MAX_WORD_LENGTH;
-            int len = 0;
-            while (len < DICTIONARY_MAX_WORD_LENGTH
-                    && session.mOutputCodePoints[start + len] != 0) {
-                ++len;
-            }
-            if (len > 0) {
+            final String word = session.getOutputWord(j, codePoints);
+            if (word != null) {
                 suggestions.add(new SuggestedWordInfo(
-                        new String(session.mOutputCodePoints, start, len),
+                        word,
                         "" /* prevWordsContext */,
-                        (int)(session.mOutputScores[j] * weightForLocale),
-                        session.mOutputTypes[j],
+                        (int)(session.getOutputScore(j) * weightForLocale),
+                        session.getOutputType(j),
                         this /* sourceDict */,
-                        session.mSpaceIndices[j] /* indexOfTouchPointOfSecondWord */,
-                        session.mOutputAutoCommitFirstWordConfidence[0]));
+                        session.getOutputSpaceIndex(j) /* indexOfTouchPointOfSecondWord */,
+                        autoCommitFirstWordConfidence));
             }
         }
         return suggestions;
@@ -371,6 +575,44 @@ public final class BinaryDictionary extends Dictionary {
                 isBeginningOfSentenceArray, wordCodePoints);
     }
 
+    // Checks the words of the text in one native call.
+    @Override
+    public int[] getMisspelledRanges(final String text) {
+        if (!isValidDictionary()) {
+            return null;
+        }
+        if (TextUtils.isEmpty(text)) {
+            return new int[0];
+        }
+        // The words are separated, so there are at most (length + 1) / 2 of them.
+        final int[] misspelledRanges = new int[text.length() + 1];
+        final int rangeCount = getMisspelledRangesNative(mNativeDict, text, misspelledRanges);
+        return Arrays.copyOf(misspelledRanges, rangeCount * 2);
+    }
+
+    // Empty and null words are packed as empty words, such as the missing shortcut targets.
+    private static int[] packWords(final String[] words, final int[] outWordStartOffsets) {
+        int codePointCount = 0;
+        for (int i = 0; i < words.length; ++i) {
+            outWordStartOffsets[i] = codePointCount;
+            if (!TextUtils.isEmpty(words[i])) {
+                codePointCount += words[i].codePointCount(0, words[i].length());
+            }
+        }
+        outWordStartOffsets[words.length] = codePointCount;
+        final int[] packedCodePoints = new int[codePointCount];
+        int codePointIndex = 0;
+        for (final String word : words) {
+            if (TextUtils.isEmpty(word)) {
+                continue;
+            }
+            for (int index = 0; index < word.length(); index = word.offsetByCodePoints(index, 1)) {
+                packedCodePoints[codePointIndex++] = word.codePointAt(index);
+            }
+        }
+        return packedCodePoints;
+    }
+
     public WordProperty getWordProperty(final String word, final boolean isBeginningOfSentence) {
         if (word == null) {
             return null;
@@ -426,6 +668,53 @@ public final class BinaryDictionary extends Dictionary {
                 getWordProperty(word, isBeginningOfSentence[0]), nextToken);
     }
 
+    // Layout of the direct buffer passed to getNextWordsNative, in native order ints. Must be kept
+    // in sync with com_android_inputmethod_latin_BinaryDictionary.cpp: the word count, then for
+    // each word its code point count, probability, WORD_EXPORT_FLAG_* flags and code points.
+    private static final int WORD_EXPORT_BUFFER_INT_COUNT = 64 * 1024;
+    private static final int WORD_EXPORT_BUFFER_HEADER_SIZE = 1;
+    private static final int WORD_EXPORT_RECORD_HEADER_SIZE = 3;
+    private static final int WORD_EXPORT_FLAG_IS_NOT_A_WORD = 0x1;
+    private static final int WORD_EXPORT_FLAG_IS_POSSIBLY_OFFENSIVE = 0x2;
+    private static final int WORD_EXPORT_FLAG_IS_BEGINNING_OF_SENTENCE = 0x4;
+
+    /**
+     * Returns all the words of the dictionary with their unigram probabilities and flags. Many
+     * words are read per native call, so this is much faster than iterating with
+     * {@link #getNextWordProperty(int)}, but the properties have no n-grams, shortcuts or
+     * historical info. The beginning-of-sentence entry is skipped.
+     */
+    public ArrayList<WordProperty> exportWords() {
+        final ArrayList<WordProperty> wordProperties = new ArrayList<>();
+        final ByteBuffer outputBuffer = ByteBuffer.allocateDirect(
+                WORD_EXPORT_BUFFER_INT_COUNT * Integer.BYTES).order(ByteOrder.nativeOrder());
+        final IntBuffer outputInts = outputBuffer.asIntBuffer();
+        final int[] codePoints = new int[DICTIONARY_MAX_WORD_LENGTH];
+        int token = 0;
+        do {
+            token = getNextWordsNative(mNativeDict, token, outputBuffer);
+            final int wordCount = outputInts.get(0);
+            int pos = WORD_EXPORT_BUFFER_HEADER_SIZE;
+            for (int i = 0; i < wordCount; ++i) {
+                final int codePointCount = outputInts.get(pos);
+                final int probability = outputInts.get(pos + 1);
+                final int flags = outputInts.get(pos + 2);
+                pos += WORD_EXPORT_RECORD_HEADER_SIZE;
+                if ((flags & WORD_EXPORT_FLAG_IS_BEGINNING_OF_SENTENCE) == 0) {
+                    outputInts.position(pos);
+                    outputInts.get(codePoints, 0, codePointCount);
+                    wordProperties.add(new WordProperty(
+                            new String(codePoints, 0, codePointCount),
+                            new ProbabilityInfo(probability), new ArrayList<>(),
+                            null /* bigrams */, (flags & WORD_EXPORT_FLAG_IS_NOT_A_WORD) != 0,
+                            (flags & WORD_EXPORT_FLAG_IS_POSSIBLY_OFFENSIVE) != 0));
+                }
+                pos += codePointCount;
+            }
+        } while (token != 0);
+        return wordProperties;
+    }
+
     // Add a unigram entry to binary dictionary with unigram attributes in native code.
     public boolean addUnigramEntry(final String word, final int probability,
             final String shortcutTarget, final int shortcutProbability,
@@ -442,7 +731,29 @@ public final class BinaryDictionary extends Dictionary {
                 timestamp)) {
             return false;
         }
-        mHasUpdated = true;
+        onUpdated();
+        return true;
+    }
+
+    /**
+     * Batch version of {@link #addUnigramEntry} for words that are not beginning-of-sentence and
+     * not possibly offensive. Adding to an empty dictionary writes the whole trie at once, which is
+     * much faster than adding the words one by one. A null shortcut target means no shortcut.
+     */
+    public boolean addUnigramEntries(final String[] words, final int[] probabilities,
+            final String[] shortcutTargets, final int[] shortcutProbabilities,
+            final boolean[] isNotAWord, final int timestamp) {
+        final int[] wordStartOffsets = new int[words.length + 1];
+        final int[] packedCodePoints = packWords(words, wordStartOffsets);
+        final int[] shortcutTargetStartOffsets = new int[shortcutTargets.length + 1];
+        final int[] packedShortcutTargetCodePoints =
+                packWords(shortcutTargets, shortcutTargetStartOffsets);
+        if (!addUnigramEntriesNative(mNativeDict, packedCodePoints, wordStartOffsets,
+                probabilities, packedShortcutTargetCodePoints, shortcutTargetStartOffsets,
+                shortcutProbabilities, isNotAWord, timestamp)) {
+            return false;
+        }
+        onUpdated();
         return true;
     }
 
@@ -455,7 +766,7 @@ public final class BinaryDictionary extends Dictionary {
         if (!removeUnigramEntryNative(mNativeDict, codePoints)) {
             return false;
         }
-        mHasUpdated = true;
+        onUpdated();
         return true;
     }
 
@@ -473,7 +784,7 @@ public final class BinaryDictionary extends Dictionary {
                 isBeginningOfSentenceArray, wordCodePoints, probability, timestamp)) {
             return false;
         }
-        mHasUpdated = true;
+        onUpdated();
         return true;
     }
 
@@ -491,7 +802,7 @@ public final class BinaryDictionary extends Dictionary {
                 isBeginningOfSentenceArray, wordCodePoints, isValidWord, count, timestamp)) {
             return false;
         }
-        mHasUpdated = true;
+        onUpdated();
         return true;
     }
 
@@ -499,40 +810,79 @@ public final class BinaryDictionary extends Dictionary {
         if (!isValidDictionary()) {
             return;
         }
+        final int[] packedInputEvents = packInputEvents(inputEvents);
         int processedEventCount = 0;
         while (processedEventCount < inputEvents.length) {
             if (needsToRunGC(true /* mindsBlockByGC */)) {
                 flushWithGC();
             }
-            processedEventCount = updateEntriesForInputEventsNative(mNativeDict, inputEvents,
-                    processedEventCount);
-            mHasUpdated = true;
-            if (processedEventCount <= 0) {
+            final int newProcessedEventCount = updateEntriesForInputEventsNative(mNativeDict,
+                    packedInputEvents, processedEventCount);
+            onUpdated();
+            if (newProcessedEventCount <= processedEventCount) {
                 return;
             }
+            processedEventCount = newProcessedEventCount;
+        }
+    }
+
+    // Layout of the packed input events, in ints that must be kept in sync with the native code:
+    // for each event its timestamp, previous word count (k), k previous words, each as a
+    // beginning-of-sentence flag (0 or 1), its code point count (m) and code points[m], and then
+    // the code point count of the target word (n) and its code points[n].
+    private static int[] packInputEvents(final WordInputEventForPersonalization[] inputEvents) {
+        int size = 0;
+        for (final WordInputEventForPersonalization inputEvent : inputEvents) {
+            size += 3 + inputEvent.mTargetWord.length;
+            for (int i = 0; i < inputEvent.mPrevWordsCount; ++i) {
+                size += 2 + inputEvent.mPrevWordArray[i].length;
+            }
         }
+        final int[] packedInputEvents = new int[size];
+        int pos = 0;
+        for (final WordInputEventForPersonalization inputEvent : inputEvents) {
+            packedInputEvents[pos++] = inputEvent.mTimestamp;
+            packedInputEvents[pos++] = inputEvent.mPrevWordsCount;
+            for (int i = 0; i < inputEvent.mPrevWordsCount; ++i) {
+                final int[] prevWord = inputEvent.mPrevWordArray[i];
+                packedInputEvents[pos++] =
+                        inputEvent.mIsPrevWordBeginningOfSentenceArray[i] ? 1 : 0;
+                packedInputEvents[pos++] = prevWord.length;
+                System.arraycopy(prevWord, 0, packedInputEvents, pos, prevWord.length);
+                pos += prevWord.length;
+            }
+            packedInputEvents[pos++] = inputEvent.mTargetWord.length;
+            System.arraycopy(inputEvent.mTargetWord, 0, packedInputEvents, pos,
+                    inputEvent.mTargetWord.length);
+            pos += inputEvent.mTargetWord.length;
+        }
+        return packedInputEvents;
     }
 
     private void reopen() {
         close();
         final File dictFile = new File(mDictFilePath);
         // WARNING: Because we pass 0 as the offset and file.length() as the length, this can
-        // only be called for actual files. Right now it's only called by the flush() family of
-        // functions, which require an updatable dictionary, so it's okay. But beware.
+        // only be called for actual files. Right now it's only called by flushWithGC(), which
+        // requires an updatable dictionary, so it's okay. But beware.
         loadDictionary(dictFile.getAbsolutePath(), 0 /* startOffset */,
                 dictFile.length(), mIsUpdatable);
     }
 
-    // Flush to dict file if the dictionary has been updated.
+    // Flush to dict file if the dictionary has been updated. The native dictionary stays valid
+    // after flushing and keeps serving reads and updates while flushing, so the dictionary is not
+    // reopened and this can run concurrently with them.
     public boolean flush() {
         if (!isValidDictionary()) {
             return false;
         }
         if (mHasUpdated) {
+            // Updates made while flushing set the flag again and are written by the next flush.
+            mHasUpdated = false;
             if (!flushNative(mNativeDict, mDictFilePath)) {
+                mHasUpdated = true;
                 return false;
             }
-            reopen();
         }
         return true;
     }
@@ -545,16 +895,39 @@ public final class BinaryDictionary extends Dictionary {
         return true;
     }
 
-    // Run GC and flush to dict file.
-    public boolean flushWithGC() {
+    public boolean hasUpdated() {
+        return mHasUpdated;
+    }
+
+    // Changes with every update, including the updates that have been flushed since.
+    public int getUpdateCount() {
+        return mUpdateCount.get();
+    }
+
+    private void onUpdated() {
+        mUpdateCount.incrementAndGet();
+        mHasUpdated = true;
+    }
+
+    // Run GC and write the result to another dict file, leaving this dictionary's file as is.
+    // GC updates the dictionary in memory, so it has to be closed afterwards.
+    public boolean flushWithGCTo(final String dictFilePath) {
         if (!isValidDictionary()) {
             return false;
         }
-        if (!flushWithGCNative(mNativeDict, mDictFilePath)) {
+        return flushWithGCNative(mNativeDict, dictFilePath);
+    }
+
+    // Run GC and flush to dict file.
+    public boolean flushWithGC() {
+        if (!isValidDictionary()) {
             return false;
         }
+        final boolean result = flushWithGCNative(mNativeDict, mDictFilePath);
+        // GC changes the dictionary in memory even when writing it fails, after which the native
+        // dictionary refuses the updates, so it is reopened either way.
         reopen();
-        return true;
+        return result;
     }
 
     /**
@@ -609,6 +982,74 @@ public final class BinaryDictionary extends Dictionary {
         }
     }
 
+    /**
+     * Reads the native memory held by this dictionary and its traverse sessions, so that the
+     * dictionaries to close under memory pressure can be chosen from real numbers.
+     * @param outBytes receives the sizes in bytes, indexed by the MEMORY_USAGE_* categories,
+     * should have MEMORY_USAGE_CATEGORY_COUNT elements
+     */
+    public void getMemoryUsage(final long[] outBytes) {
+        Arrays.fill(outBytes, 0);
+        if (!isValidDictionary()) {
+            return;
+        }
+        getMemoryUsageNative(mNativeDict, outBytes);
+        final long[] sessionBytes = new long[outBytes.length];
+        synchronized (mDicTraverseSessions) {
+            final int sessionsSize = mDicTraverseSessions.size();
+            for (int index = 0; index < sessionsSize; ++index) {
+                final DicTraverseSession traverseSession = mDicTraverseSessions.valueAt(index);
+                if (traverseSession == null) {
+                    continue;
+                }
+                traverseSession.getMemoryUsage(sessionBytes);
+                for (int i = 0; i < outBytes.length; ++i) {
+                    outBytes[i] += sessionBytes[i];
+                }
+            }
+        }
+    }
+
+    /**
+     * Frees native memory that is rebuilt on demand: the caches of the traverse sessions and the
+     * prediction cache, and under heavy memory pressure also the idle native sessions and the
+     * resident pages of read-only dictionary files.
+     * @param level a ComponentCallbacks2.TRIM_MEMORY_* level
+     */
+    @Override
+    public void trimMemory(final int level) {
+        if (!isValidDictionary()) {
+            return;
+        }
+        final boolean isMemoryLow = level == ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL
+                || level >= ComponentCallbacks2.TRIM_MEMORY_MODERATE;
+        trimMemoryNative(mNativeDict, isMemoryLow ? TRIM_MEMORY_ALL : TRIM_MEMORY_CACHES);
+        synchronized (mDicTraverseSessions) {
+            final int sessionsSize = mDicTraverseSessions.size();
+            for (int index = 0; index < sessionsSize; ++index) {
+                final DicTraverseSession traverseSession = mDicTraverseSessions.valueAt(index);
+                if (traverseSession == null) {
+                    continue;
+                }
+                synchronized (traverseSession) {
+                    traverseSession.trimMemory();
+                }
+            }
+        }
+    }
+
+    @Override
+    public void prewarm(final int sessionId) {
+        if (!isValidDictionary()) {
+            return;
+        }
+        final DicTraverseSession session = getTraverseSession(sessionId);
+        // The lock keeps a search from using the caches of the session meanwhile.
+        synchronized (session) {
+            prewarmNative(mNativeDict, session.getSession());
+        }
+    }
+
     public String getPropertyForGettingStats(final String query) {
         if (!isValidDictionary()) {
             return "";
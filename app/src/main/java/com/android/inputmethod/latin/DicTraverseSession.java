@@ -6,47 +6,153 @@
 
 package com.android.inputmethod.latin;
 
+import helium314.keyboard.latin.common.InputPointers;
 import helium314.keyboard.latin.common.NativeSuggestOptions;
 import helium314.keyboard.latin.define.DecoderSpecificConstants;
 import helium314.keyboard.latin.utils.JniUtils;
 
-import java.util.Locale;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.util.Arrays;
 
 public final class DicTraverseSession {
     static {
         JniUtils.loadNativeLibrary();
     }
     // Must be equal to MAX_RESULTS in native/jni/src/defines.h
-    private static final int MAX_RESULTS = 18;
+    private static final int MAX_RESULTS = 40;
+    // Counters of the work done by the last search, see getOutputSearchEffort. Must be equal to
+    // SearchEffort::Counter in native/jni/src/suggest/core/session/search_effort.h
+    public static final int SEARCH_EFFORT_PUSHED_DIC_NODES = 0;
+    public static final int SEARCH_EFFORT_POPPED_DIC_NODES = 1;
+    public static final int SEARCH_EFFORT_EVICTED_DIC_NODES = 2;
+    public static final int SEARCH_EFFORT_CACHED_DIC_NODES_FOR_CONTINUATION = 3;
+    public static final int SEARCH_EFFORT_EXPANDED_DIC_NODES = 4;
+    public static final int SEARCH_EFFORT_RECOMBINED_DIC_NODES = 5;
+    private static final int SEARCH_EFFORT_COUNTER_COUNT = 6;
     public final int[] mInputCodePoints =
             new int[DecoderSpecificConstants.DICTIONARY_MAX_WORD_LENGTH];
     public final int[][] mPrevWordCodePointArrays =
             new int[DecoderSpecificConstants.MAX_PREV_WORD_COUNT_FOR_N_GRAM][];
     public final boolean[] mIsBeginningOfSentenceArray =
             new boolean[DecoderSpecificConstants.MAX_PREV_WORD_COUNT_FOR_N_GRAM];
-    public final int[] mOutputSuggestionCount = new int[1];
-    public final int[] mOutputCodePoints =
-            new int[DecoderSpecificConstants.DICTIONARY_MAX_WORD_LENGTH * MAX_RESULTS];
-    public final int[] mSpaceIndices = new int[MAX_RESULTS];
-    public final int[] mOutputScores = new int[MAX_RESULTS];
-    public final int[] mOutputTypes = new int[MAX_RESULTS];
-    // Only one result is ever used
-    public final int[] mOutputAutoCommitFirstWordConfidence = new int[1];
-    public final float[] mInputOutputWeightOfLangModelVsSpatialModel = new float[1];
+
+    // Layout of the direct buffers passed to BinaryDictionary#getSuggestionsWithBuffersNative.
+    // Must be kept in sync with com_android_inputmethod_latin_BinaryDictionary.cpp.
+    private static final int BYTES_PER_INT = 4;
+    private static final int INPUT_BUFFER_HEADER_SIZE = 2;
+    private static final int OUTPUT_SUGGESTION_COUNT_INDEX = 0;
+    private static final int OUTPUT_AUTO_COMMIT_FIRST_WORD_CONFIDENCE_INDEX = 1;
+    private static final int OUTPUT_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL_INDEX = 2;
+    private static final int OUTPUT_CODE_POINTS_START = 3;
+    private static final int OUTPUT_SCORES_START = OUTPUT_CODE_POINTS_START
+            + DecoderSpecificConstants.DICTIONARY_MAX_WORD_LENGTH * MAX_RESULTS;
+    private static final int OUTPUT_SPACE_INDICES_START = OUTPUT_SCORES_START + MAX_RESULTS;
+    private static final int OUTPUT_TYPES_START = OUTPUT_SPACE_INDICES_START + MAX_RESULTS;
+    private static final int OUTPUT_SEARCH_EFFORT_START = OUTPUT_TYPES_START + MAX_RESULTS;
+    private static final int OUTPUT_BUFFER_SIZE = OUTPUT_SEARCH_EFFORT_START
+            + SEARCH_EFFORT_COUNTER_COUNT;
+
+    private ByteBuffer mInputBuffer;
+    private IntBuffer mInputInts;
+    public final ByteBuffer mOutputBuffer = ByteBuffer.allocateDirect(
+            OUTPUT_BUFFER_SIZE * BYTES_PER_INT).order(ByteOrder.nativeOrder());
+    private final IntBuffer mOutputInts = mOutputBuffer.asIntBuffer();
 
     public final NativeSuggestOptions mNativeSuggestOptions = new NativeSuggestOptions();
 
-    private static native long setDicTraverseSessionNative(String locale, long dictSize);
+    /**
+     * Writes the given input and mInputCodePoints into the input buffer and returns it. The
+     * buffer is reused and only reallocated when a longer input comes in.
+     */
+    public ByteBuffer fillInputBuffer(final InputPointers inputPointers, final int inputSize) {
+        final int intCount = INPUT_BUFFER_HEADER_SIZE + inputSize * 4 + mInputCodePoints.length;
+        if (mInputInts == null || mInputInts.capacity() < intCount) {
+            // Leave room for the input to grow, as gestures add points one by one.
+            mInputBuffer = ByteBuffer.allocateDirect(intCount * 2 * BYTES_PER_INT)
+                    .order(ByteOrder.nativeOrder());
+            mInputInts = mInputBuffer.asIntBuffer();
+        }
+        mInputInts.clear();
+        mInputInts.put(inputSize).put(mInputCodePoints.length)
+                .put(inputPointers.getXCoordinates(), 0, inputSize)
+                .put(inputPointers.getYCoordinates(), 0, inputSize)
+                .put(inputPointers.getTimes(), 0, inputSize)
+                .put(inputPointers.getPointerIds(), 0, inputSize)
+                .put(mInputCodePoints);
+        return mInputBuffer;
+    }
+
+    public void setOutputWeightOfLangModelVsSpatialModel(final float weight) {
+        mOutputInts.put(OUTPUT_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL_INDEX,
+                Float.floatToRawIntBits(weight));
+    }
+
+    public float getOutputWeightOfLangModelVsSpatialModel() {
+        return Float.intBitsToFloat(
+                mOutputInts.get(OUTPUT_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL_INDEX));
+    }
+
+    public int getOutputSuggestionCount() {
+        return mOutputInts.get(OUTPUT_SUGGESTION_COUNT_INDEX);
+    }
+
+    public int getOutputAutoCommitFirstWordConfidence() {
+        return mOutputInts.get(OUTPUT_AUTO_COMMIT_FIRST_WORD_CONFIDENCE_INDEX);
+    }
+
+    /**
+     * Returns the index-th suggestion, or null if it is empty. outCodePoints must have room for
+     * DICTIONARY_MAX_WORD_LENGTH code points.
+     */
+    public String getOutputWord(final int index, final int[] outCodePoints) {
+        final int start = OUTPUT_CODE_POINTS_START
+                + index * DecoderSpecificConstants.DICTIONARY_MAX_WORD_LENGTH;
+        int len = 0;
+        while (len < DecoderSpecificConstants.DICTIONARY_MAX_WORD_LENGTH) {
+            final int codePoint = mOutputInts.get(start + len);
+            if (codePoint == 0) {
+                break;
+            }
+            outCodePoints[len++] = codePoint;
+        }
+        return len > 0 ? new String(outCodePoints, 0, len) : null;
+    }
+
+    public int getOutputScore(final int index) {
+        return mOutputInts.get(OUTPUT_SCORES_START + index);
+    }
+
+    public int getOutputSpaceIndex(final int index) {
+        return mOutputInts.get(OUTPUT_SPACE_INDICES_START + index);
+    }
+
+    public int getOutputType(final int index) {
+        return mOutputInts.get(OUTPUT_TYPES_START + index);
+    }
+
+    /**
+     * Returns a counter of the last search on this session, one of SEARCH_EFFORT_*. All of them
+     * are 0 after predictions, which don't search.
+     */
+    public int getOutputSearchEffort(final int counter) {
+        return mOutputInts.get(OUTPUT_SEARCH_EFFORT_START + counter);
+    }
+
+    private static native long createDicTraverseSessionNative(long dictionary, long dictSize);
     private static native void initDicTraverseSessionNative(long nativeDicTraverseSession,
             long dictionary, int[] previousWord, int previousWordLength);
     private static native void releaseDicTraverseSessionNative(long nativeDicTraverseSession);
+    private static native int getMemoryUsageNative(long nativeDicTraverseSession,
+            long[] outBytes);
+    private static native void trimMemoryNative(long nativeDicTraverseSession);
 
     private long mNativeDicTraverseSession;
 
-    public DicTraverseSession(Locale locale, long dictionary, long dictSize) {
-        mNativeDicTraverseSession = createNativeDicTraverseSession(
-                locale != null ? locale.toString() : "", dictSize);
-        initSession(dictionary);
+    public DicTraverseSession(long dictionary, long dictSize) {
+        // Created and initialized for the dictionary in a single native call.
+        mNativeDicTraverseSession = createDicTraverseSessionNative(dictionary, dictSize);
     }
 
     public long getSession() {
@@ -62,8 +168,23 @@ public final class DicTraverseSession {
                 mNativeDicTraverseSession, dictionary, previousWord, previousWordLength);
     }
 
-    private static long createNativeDicTraverseSession(String locale, long dictSize) {
-        return setDicTraverseSessionNative(locale, dictSize);
+    /**
+     * Reads the native memory held by this session, indexed by the
+     * BinaryDictionary.MEMORY_USAGE_* categories. Must not be called while the session searches.
+     */
+    public void getMemoryUsage(final long[] outBytes) {
+        Arrays.fill(outBytes, 0);
+        getMemoryUsageNative(mNativeDicTraverseSession, outBytes);
+    }
+
+    /**
+     * Frees the DicNode pools and caches of this session. They grow again on the next search.
+     * Must not be called while the session searches.
+     */
+    public void trimMemory() {
+        if (mNativeDicTraverseSession != 0) {
+            trimMemoryNative(mNativeDicTraverseSession);
+        }
     }
 
     private void closeInternal() {
@@ -14,6 +14,7 @@ import helium314.keyboard.latin.utils.JniUtils;
 
 import java.io.File;
 import java.io.IOException;
+import java.util.List;
 import java.util.Locale;
 import java.util.Map;
 import java.util.regex.Matcher;
@@ -33,6 +34,8 @@ public final class BinaryDictionaryUtils {
     private static native boolean createEmptyDictFileNative(String filePath, long dictVersion,
             String locale, String[] attributeKeyStringArray, String[] attributeValueStringArray);
     private static native float calcNormalizedScoreNative(int[] before, int[] after, int score);
+    private static native void calcNormalizedScoresNative(int[] before, int[] afters,
+            int[] afterLengths, int[] scores, float[] outNormalizedScores);
     private static native int setCurrentTimeForTestNative(int currentTime);
 
     public static DictionaryHeader getHeader(final File dictFile)
@@ -101,6 +104,33 @@ public final class BinaryDictionaryUtils {
                 StringUtils.toCodePointArray(after), score);
     }
 
+    /**
+     * {@link #calcNormalizedScore} of before and each of afters with the corresponding score, in
+     * a single native call that prepares before only once.
+     */
+    public static float[] calcNormalizedScores(final String before, final List<String> afters,
+            final int[] scores) {
+        final int afterCount = afters.size();
+        final int[] afterLengths = new int[afterCount];
+        int totalLength = 0;
+        for (int i = 0; i < afterCount; i++) {
+            final String after = afters.get(i);
+            afterLengths[i] = after.codePointCount(0, after.length());
+            totalLength += afterLengths[i];
+        }
+        final int[] afterCodePoints = new int[totalLength];
+        int codePointIndex = 0;
+        for (final String after : afters) {
+            for (int index = 0; index < after.length(); index = after.offsetByCodePoints(index, 1)) {
+                afterCodePoints[codePointIndex++] = after.codePointAt(index);
+            }
+        }
+        final float[] normalizedScores = new float[afterCount];
+        calcNormalizedScoresNative(StringUtils.toCodePointArray(before), afterCodePoints,
+                afterLengths, scores, normalizedScores);
+        return normalizedScores;
+    }
+
     /**
      * Control the current time to be used in the native code. If currentTime >= 0, this method sets
      * the current time and gets into test mode.
@@ -18,8 +18,8 @@ import java.util.ArrayList;
 import java.util.List;
 import java.util.Locale;
 
-// Note: this class is used as a parameter type of a native method. You should be careful when you
-// rename this class or field name. See BinaryDictionary#addMultipleDictionaryEntriesNative().
+// Note: the fields of this class are packed for a native method. You should be careful when you
+// change them. See BinaryDictionary#packInputEvents().
 public final class WordInputEventForPersonalization {
     private static final String TAG = WordInputEventForPersonalization.class.getSimpleName();
     private static final boolean DEBUG_TOKEN = false;
@@ -7,6 +7,7 @@
 package helium314.keyboard.latin;
 
 import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.Locale;
 
 import helium314.keyboard.latin.SuggestedWords.SuggestedWordInfo;
@@ -113,6 +114,37 @@ public abstract class Dictionary {
         return NOT_A_PROBABILITY;
     }
 
+    /**
+     * Checks all the words of the text at once, in any capitalization. The words with digits are
+     * not checked.
+     * @param text the text to check.
+     * @return the start and end offsets of the words that are not in the dictionary, in pairs, or
+     * null if the dictionary can't check a whole text.
+     */
+    public int[] getMisspelledRanges(final String text) {
+        return null;
+    }
+
+    /**
+     * Returns the ranges of getMisspelledRanges() that are in both arrays, i.e. the words that
+     * are in neither dictionary. The words of a text are the same for all the dictionaries.
+     */
+    public static int[] intersectMisspelledRanges(final int[] ranges, final int[] otherRanges) {
+        final int[] intersection = new int[Math.min(ranges.length, otherRanges.length)];
+        int size = 0;
+        int otherIndex = 0;
+        for (int i = 0; i < ranges.length; i += 2) {
+            while (otherIndex < otherRanges.length && otherRanges[otherIndex] < ranges[i]) {
+                otherIndex += 2;
+            }
+            if (otherIndex < otherRanges.length && otherRanges[otherIndex] == ranges[i]) {
+                intersection[size++] = ranges[i];
+                intersection[size++] = ranges[i + 1];
+            }
+        }
+        return Arrays.copyOf(intersection, size);
+    }
+
     /**
      * Compares the contents of the character array with the typed word and returns true if they
      * are the same.
@@ -144,6 +176,23 @@ public abstract class Dictionary {
         //empty base implementation
     }
 
+    /**
+     * Override to free memory that can be rebuilt on demand.
+     * @param level a ComponentCallbacks2.TRIM_MEMORY_* level
+     */
+    public void trimMemory(final int level) {
+        // empty base implementation
+    }
+
+    /**
+     * Override to load what the first search with the given session needs, e.g. before the user
+     * switches to the language of this dictionary. May be called on a background thread.
+     * @param sessionId the id of the session of the searches
+     */
+    public void prewarm(final int sessionId) {
+        // empty base implementation
+    }
+
     /**
      * Subclasses may override to indicate that this Dictionary is not yet properly initialized.
      */
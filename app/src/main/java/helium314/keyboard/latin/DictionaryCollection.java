@@ -78,6 +78,18 @@ public final class DictionaryCollection extends Dictionary {
         return maxFreq;
     }
 
+    @Override
+    public int[] getMisspelledRanges(final String text) {
+        int[] misspelledRanges = null;
+        for (final Dictionary dict : mDictionaries) {
+            final int[] ranges = dict.getMisspelledRanges(text);
+            if (ranges == null) return null;
+            misspelledRanges = misspelledRanges == null ? ranges
+                    : intersectMisspelledRanges(misspelledRanges, ranges);
+        }
+        return misspelledRanges;
+    }
+
     @Override
     public int getMaxFrequencyOfExactMatches(final String word) {
         int maxFreq = -1;
@@ -98,4 +110,16 @@ public final class DictionaryCollection extends Dictionary {
         for (final Dictionary dict : mDictionaries)
             dict.close();
     }
+
+    @Override
+    public void trimMemory(final int level) {
+        for (final Dictionary dict : mDictionaries)
+            dict.trimMemory(level);
+    }
+
+    @Override
+    public void prewarm(final int sessionId) {
+        for (final Dictionary dict : mDictionaries)
+            dict.prewarm(sessionId);
+    }
 }
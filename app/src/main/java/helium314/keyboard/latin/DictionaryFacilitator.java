@@ -107,6 +107,12 @@ public interface DictionaryFacilitator {
 
     void closeDictionaries();
 
+    /**
+     * Frees memory of the dictionaries that can be rebuilt on demand.
+     * @param level a ComponentCallbacks2.TRIM_MEMORY_* level
+     */
+    void trimMemory(int level);
+
     /** main dictionaries are loaded asynchronously after resetDictionaries */
     boolean hasAtLeastOneInitializedMainDictionary();
 
@@ -140,6 +146,15 @@ public interface DictionaryFacilitator {
 
     boolean isValidSpellingWord(final String word);
 
+    /**
+     * Checks all the words of the text in the main dictionaries at once, in any capitalization.
+     * Words that are not found may still be in the other dictionaries.
+     *
+     * @return the start and end offsets of the words that are in none of the main dictionaries,
+     * in pairs, or null if the text can't be checked at once
+     */
+    @Nullable int[] getMisspelledRangesInMainDictionaries(final String text);
+
     boolean isValidSuggestionWord(final String word);
 
     void clearUserHistoryDictionary(final Context context);
@@ -95,6 +95,12 @@ class DictionaryFacilitatorImpl : DictionaryFacilitator {
         }
     }
 
+    override fun trimMemory(level: Int) {
+        for (dictGroup in dictionaryGroups) {
+            DictionaryFacilitator.ALL_DICTIONARY_TYPES.forEach { dictGroup.getDict(it)?.trimMemory(level) }
+        }
+    }
+
     override fun isActive(): Boolean {
         return dictionaryGroups[0].locale.language.isNotEmpty()
     }
@@ -248,6 +254,9 @@ class DictionaryFacilitatorImpl : DictionaryFacilitator {
 
                 listener?.onUpdateMainDictionaryAvailability(hasAtLeastOneInitializedMainDictionary())
                 latchForWaitingLoadingMainDictionary.countDown()
+
+                // the first suggestions after switching the language would otherwise load what they need
+                dictGroupsWithNewMainDict.forEach { (_, mainDict) -> mainDict.prewarm(Suggest.SESSION_ID_TYPING) }
             } catch (e: Throwable) {
                 Log.e(TAG, "could not initialize main dictionaries for $locales", e)
             }
@@ -468,6 +477,9 @@ class DictionaryFacilitatorImpl : DictionaryFacilitator {
     }
 
     // TODO: Revise the way to fusion suggestion results.
+    // The dictionary groups are searched in parallel here rather than by a native fan-out over
+    // the dictionary handles, which would bypass the locks of the dictionaries, the weight for
+    // the locale of each group and the filtering of the results by dictionary type.
     override fun getSuggestionResults(
         composedData: ComposedData, ngramContext: NgramContext, keyboard: Keyboard,
         settingsValuesForSuggestion: SettingsValuesForSuggestion, sessionId: Int, inputStyle: Int
@@ -553,6 +565,18 @@ class DictionaryFacilitatorImpl : DictionaryFacilitator {
         return result
     }
 
+    override fun getMisspelledRangesInMainDictionaries(text: String): IntArray? {
+        var misspelledRanges: IntArray? = null
+        for (dictionaryGroup in dictionaryGroups) {
+            // the native check doesn't know the blacklisted words
+            if (dictionaryGroup.hasBlacklistedWords()) return null
+            val ranges = dictionaryGroup.getDict(Dictionary.TYPE_MAIN)?.getMisspelledRanges(text) ?: return null
+            misspelledRanges = if (misspelledRanges == null) ranges
+                else Dictionary.intersectMisspelledRanges(misspelledRanges, ranges)
+        }
+        return misspelledRanges
+    }
+
     // this is unused, so leave it for now (redirecting to isValidWord seems to defeat the purpose...)
     override fun isValidSuggestionWord(word: String): Boolean {
         return isValidWord(word, DictionaryFacilitator.ALL_DICTIONARY_TYPES, dictionaryGroups[0])
@@ -755,6 +779,8 @@ private class DictionaryGroup(
 
     fun isBlacklisted(word: String) = blacklist.contains(word)
 
+    fun hasBlacklistedWords() = blacklist.isNotEmpty()
+
     fun addToBlacklist(word: String) {
         if (!blacklist.add(word) || blacklistFile == null) return
         scope.launch {
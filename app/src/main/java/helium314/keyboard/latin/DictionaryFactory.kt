@@ -6,6 +6,7 @@
 package helium314.keyboard.latin
 
 import android.content.Context
+import com.android.inputmethod.latin.BinaryDictionary
 import helium314.keyboard.latin.common.LocaleUtils
 import helium314.keyboard.latin.utils.DictionaryInfoUtils
 import helium314.keyboard.latin.utils.Log
@@ -25,18 +26,19 @@ object DictionaryFactory {
     //  expose the weight so users can adjust dictionary "importance" (useful for addons like emoji dict)
     //  allow users to block certain dictionaries (not sure how this should work exactly)
     fun createMainDictionaryCollection(context: Context, locale: Locale, useEmojiDict: Boolean): DictionaryCollection {
-        val dictList = LinkedList<Dictionary>()
+        val dictFiles = LinkedList<Pair<File, String>>()
         val (extracted, nonExtracted) = getAvailableDictsForLocale(locale, context, useEmojiDict)
         extracted.sortedBy { !it.name.endsWith(DictionaryInfoUtils.USER_DICTIONARY_SUFFIX) }.forEach {
             // we sort to have user dicts first, so they have priority over internal dicts of the same type
-            checkAndAddDictionaryToListIfNewType(it, dictList, locale)
+            checkAndAddDictionaryFileToListIfNewType(it, dictFiles)
         }
         nonExtracted.forEach { filename ->
             val type = filename.substringBefore("_")
-            if (dictList.any { it.mDictType == type }) return@forEach
+            if (dictFiles.any { it.second == type }) return@forEach
             val extractedFile = DictionaryInfoUtils.extractAssetsDictionary(filename, locale, context) ?: return@forEach
-            checkAndAddDictionaryToListIfNewType(extractedFile, dictList, locale)
+            checkAndAddDictionaryFileToListIfNewType(extractedFile, dictFiles)
         }
+        val dictList = openDictionaries(dictFiles, locale)
         return DictionaryCollection(Dictionary.TYPE_MAIN, locale, dictList, FloatArray(dictList.size) { 1f })
     }
 
@@ -60,17 +62,45 @@ object DictionaryFactory {
     }
 
     /**
-     * add dictionary created from [file] to [dicts]
-     * if [file] cannot be loaded it is deleted
-     * if the dictionary type already exists in [dicts], the [file] is skipped
+     * add [file] with its dictionary type to [dictFiles]
+     * if the header of [file] cannot be read it is deleted
+     * if the dictionary type already exists in [dictFiles], the [file] is skipped
      */
-    private fun checkAndAddDictionaryToListIfNewType(file: File, dicts: MutableList<Dictionary>, locale: Locale) {
-        val dictionary = getDictionary(file, locale) ?: return
-        if (dicts.any { it.mDictType == dictionary.mDictType }) {
-            dictionary.close()
+    private fun checkAndAddDictionaryFileToListIfNewType(file: File, dictFiles: MutableList<Pair<File, String>>) {
+        if (!file.isFile) return
+        val header = DictionaryInfoUtils.getDictionaryFileHeaderOrNull(file)
+        if (header == null) {
+            killDictionary(file)
             return
         }
-        dicts.add(dictionary)
+        val dictType = header.mIdString.split(":").first()
+        if (dictFiles.any { it.second == dictType }) return
+        dictFiles.add(file to dictType)
+    }
+
+    /**
+     * open the [dictFiles] at once, which the native side does in parallel
+     * files that cannot be loaded are deleted
+     */
+    private fun openDictionaries(dictFiles: List<Pair<File, String>>, locale: Locale): List<Dictionary> {
+        if (dictFiles.isEmpty()) return emptyList()
+        val binaryDictionaries = BinaryDictionary.openMany(
+            Array(dictFiles.size) { dictFiles[it].first.absolutePath }, LongArray(dictFiles.size),
+            LongArray(dictFiles.size) { dictFiles[it].first.length() }, false, locale,
+            Array(dictFiles.size) { dictFiles[it].second }, BooleanArray(dictFiles.size)
+        )
+        val dictList = LinkedList<Dictionary>()
+        binaryDictionaries.forEachIndexed { i, binaryDictionary ->
+            if (!binaryDictionary.isValidDictionary) {
+                binaryDictionary.close()
+                killDictionary(dictFiles[i].first)
+                return@forEachIndexed
+            }
+            val readOnlyBinaryDictionary = ReadOnlyBinaryDictionary(binaryDictionary)
+            // Use KoreanDictionary for Korean locale
+            dictList.add(if (locale.language == "ko") KoreanDictionary(readOnlyBinaryDictionary) else readOnlyBinaryDictionary)
+        }
+        return dictList
     }
 
     @JvmStatic
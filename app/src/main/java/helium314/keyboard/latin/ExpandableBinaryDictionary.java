@@ -13,6 +13,7 @@ import androidx.annotation.NonNull;
 import androidx.annotation.Nullable;
 
 import com.android.inputmethod.latin.BinaryDictionary;
+import com.android.inputmethod.latin.utils.BinaryDictionaryUtils;
 
 import helium314.keyboard.latin.SuggestedWords.SuggestedWordInfo;
 import helium314.keyboard.latin.common.ComposedData;
@@ -88,6 +89,9 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
     /** Indicates whether a task for reloading the dictionary has been scheduled. */
     private final AtomicBoolean mIsReloading;
 
+    /** Indicates whether a task for running GC on a snapshot has been scheduled. */
+    private final AtomicBoolean mIsRunningGCOnSnapshot;
+
     /** Indicates whether the current dictionary needs to be recreated. */
     private boolean mNeedsToRecreate;
 
@@ -96,13 +100,25 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
     /* A extension for a binary dictionary file. */
     protected static final String DICT_FILE_EXTENSION = ".dict";
 
+    /**
+     * Listener of the flushes that run in the background.
+     */
+    public interface FlushListener {
+        /**
+         * @param succeeded whether the updates have been written to the dictionary file.
+         */
+        void onFlushed(boolean succeeded);
+    }
+
     /**
      * Abstract method for loading initial contents of a given dictionary.
      */
     protected abstract void loadInitialContentsLocked();
 
     static boolean matchesExpectedBinaryDictFormatVersionForThisType(final int formatVersion) {
-        return formatVersion == FormatSpec.VERSION4;
+        // Version 403 dictionaries are still written in their own format, so they don't need to
+        // be migrated.
+        return formatVersion == FormatSpec.VERSION4 || formatVersion == FormatSpec.VERSION403;
     }
 
     private static boolean needsToMigrateDictionary(final int formatVersion) {
@@ -134,6 +150,7 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
         mDictFile = getDictFile(context, dictName, dictFile);
         mBinaryDictionary = null;
         mIsReloading = new AtomicBoolean();
+        mIsRunningGCOnSnapshot = new AtomicBoolean();
         mNeedsToRecreate = false;
         mLock = new ReentrantReadWriteLock();
     }
@@ -253,14 +270,101 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
         }
     }
 
-    private void updateDictionaryWithWriteLock(@NonNull final Runnable updateTask) {
-        reloadDictionaryIfRequired();
-        asyncExecuteTaskWithWriteLock(() -> {
-            if (getBinaryDictionary() == null) {
+    /**
+     * Runs GC on a snapshot of the dictionary without holding the lock, so that GC doesn't block
+     * suggestions and updates. The result replaces the dictionary only if the dictionary hasn't
+     * been updated in the meantime. Otherwise it's dropped and GC runs again next time.
+     */
+    private void asyncRunGCOnSnapshot() {
+        if (!mIsRunningGCOnSnapshot.compareAndSet(false, true)) {
+            return;
+        }
+        ExecutorUtils.getBackgroundExecutor(ExecutorUtils.KEYBOARD).execute(() -> {
+            try {
+                runGCOnSnapshot();
+            } finally {
+                mIsRunningGCOnSnapshot.set(false);
+            }
+        });
+    }
+
+    private void runGCOnSnapshot() {
+        final BinaryDictionary snapshotSource;
+        final int snapshotUpdateCount;
+        mLock.writeLock().lock();
+        try {
+            snapshotSource = getBinaryDictionary();
+            // After flush(), the dictionary file and its update log hold the state to GC, and
+            // snapshotSource has no pending updates.
+            if (snapshotSource == null || !snapshotSource.needsToRunGC(false /* mindsBlockByGC */)
+                    || !snapshotSource.flush()) {
+                return;
+            }
+            snapshotUpdateCount = snapshotSource.getUpdateCount();
+        } finally {
+            mLock.writeLock().unlock();
+        }
+        final File gcDictFile = new File(mDictFile.getPath()
+                + BinaryDictionary.DICT_FILE_NAME_SUFFIX_FOR_GC);
+        if (gcDictFile.exists() && !FileUtils.deleteRecursively(gcDictFile)) {
+            Log.e(TAG, "Can't remove a file: " + gcDictFile.getName());
+            return;
+        }
+        final BinaryDictionary snapshot = BinaryDictionary.openSnapshot(
+                mDictFile.getAbsolutePath(), mDictFile.length(), mLocale, mDictType);
+        final boolean succeeded = snapshot.flushWithGCTo(gcDictFile.getAbsolutePath());
+        snapshot.close();
+        if (!succeeded) {
+            FileUtils.deleteRecursively(gcDictFile);
+            return;
+        }
+        mLock.writeLock().lock();
+        try {
+            // Updates made since the snapshot may have been flushed to the update log, which the
+            // GC result replaces.
+            if (getBinaryDictionary() != snapshotSource
+                    || snapshotSource.getUpdateCount() != snapshotUpdateCount) {
+                // The dictionary has changed since the snapshot was taken.
+                FileUtils.deleteRecursively(gcDictFile);
                 return;
             }
-            runGCIfRequiredLocked(true /* mindsBlockByGC */);
-            updateTask.run();
+            closeBinaryDictionary();
+            if (FileUtils.deleteRecursively(mDictFile)
+                    && BinaryDictionaryUtils.renameDict(gcDictFile, mDictFile)) {
+                openBinaryDictionaryLocked();
+            } else {
+                // The next access reloads the dictionary, or recreates it if the file is gone.
+                Log.e(TAG, "Can't replace the dictionary with the GC result: " + mDictName);
+            }
+        } finally {
+            mLock.writeLock().unlock();
+        }
+    }
+
+    /**
+     * Runs an update task with the read lock, so that suggestions can be looked up during the
+     * update. The native dictionary serializes the updates and keeps the reads consistent. GC
+     * replaces the dictionary, so it runs with the write lock before the update.
+     */
+    private void updateDictionaryWithReadLock(@NonNull final Runnable updateTask) {
+        reloadDictionaryIfRequired();
+        ExecutorUtils.getBackgroundExecutor(ExecutorUtils.KEYBOARD).execute(() -> {
+            mLock.writeLock().lock();
+            try {
+                if (getBinaryDictionary() == null) {
+                    return;
+                }
+                runGCIfRequiredLocked(true /* mindsBlockByGC */);
+                // Downgrade to the read lock.
+                mLock.readLock().lock();
+            } finally {
+                mLock.writeLock().unlock();
+            }
+            try {
+                updateTask.run();
+            } finally {
+                mLock.readLock().unlock();
+            }
         });
     }
 
@@ -270,7 +374,7 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
     public void addUnigramEntry(final String word, final int frequency,
             final String shortcutTarget, final int shortcutFreq, final boolean isNotAWord,
             final boolean isPossiblyOffensive, final int timestamp) {
-        updateDictionaryWithWriteLock(() -> addUnigramLocked(word, frequency, shortcutTarget,
+        updateDictionaryWithReadLock(() -> addUnigramLocked(word, frequency, shortcutTarget,
                 shortcutFreq, isNotAWord, isPossiblyOffensive, timestamp));
     }
 
@@ -283,18 +387,25 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
         }
     }
 
+    /**
+     * Adds many unigram entries at once. This is much faster than calling
+     * {@link #addUnigramLocked} for each word when loading the initial contents.
+     */
+    protected void addUnigramsLocked(final String[] words, final int[] frequencies,
+            final String[] shortcutTargets, final int[] shortcutFreqs, final boolean[] isNotAWord,
+            final int timestamp) {
+        if (!mBinaryDictionary.addUnigramEntries(words, frequencies, shortcutTargets,
+                shortcutFreqs, isNotAWord, timestamp)) {
+            Log.e(TAG, "Cannot add unigram entries. word count: " + words.length);
+        }
+    }
+
     /**
      * Dynamically remove the unigram entry from the dictionary.
      */
     public void removeUnigramEntryDynamically(final String word) {
-        reloadDictionaryIfRequired();
-        asyncExecuteTaskWithWriteLock(() -> {
-            final BinaryDictionary binaryDictionary = getBinaryDictionary();
-            if (binaryDictionary == null) {
-                return;
-            }
-            runGCIfRequiredLocked(true /* mindsBlockByGC */);
-            if (!binaryDictionary.removeUnigramEntry(word)) {
+        updateDictionaryWithReadLock(() -> {
+            if (!mBinaryDictionary.removeUnigramEntry(word)) {
                 if (DEBUG) {
                     Log.i(TAG, "Cannot remove unigram entry: " + word);
                 }
@@ -307,14 +418,8 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
      */
     public void addNgramEntry(@NonNull final NgramContext ngramContext, final String word,
             final int frequency, final int timestamp) {
-        reloadDictionaryIfRequired();
-        asyncExecuteTaskWithWriteLock(() -> {
-            if (getBinaryDictionary() == null) {
-                return;
-            }
-            runGCIfRequiredLocked(true /* mindsBlockByGC */);
-            addNgramEntryLocked(ngramContext, word, frequency, timestamp);
-        });
+        updateDictionaryWithReadLock(() -> addNgramEntryLocked(ngramContext, word, frequency,
+                timestamp));
     }
 
     protected void addNgramEntryLocked(@NonNull final NgramContext ngramContext, final String word,
@@ -332,12 +437,8 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
      */
     public void updateEntriesForWord(@NonNull final NgramContext ngramContext,
             final String word, final boolean isValidWord, final int count, final int timestamp) {
-        updateDictionaryWithWriteLock(() -> {
-            final BinaryDictionary binaryDictionary = getBinaryDictionary();
-            if (binaryDictionary == null) {
-                return;
-            }
-            if (!binaryDictionary.updateEntriesForWordWithNgramContext(ngramContext, word,
+        updateDictionaryWithReadLock(() -> {
+            if (!mBinaryDictionary.updateEntriesForWordWithNgramContext(ngramContext, word,
                     isValidWord, count, timestamp)) {
                 if (DEBUG) {
                     Log.e(TAG, "Cannot update counter. word: " + word
@@ -544,20 +645,48 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
         });
     }
 
+    @Override
+    public void trimMemory(final int level) {
+        // The native dictionary synchronizes the trimming with the updates itself.
+        asyncExecuteTaskWithLock(mLock.readLock(), () -> {
+            final BinaryDictionary binaryDictionary = getBinaryDictionary();
+            if (binaryDictionary != null) {
+                binaryDictionary.trimMemory(level);
+            }
+        });
+    }
+
     /**
      * Flush binary dictionary to dictionary file.
      */
     @Override
     public void onFinishInput() {
-        asyncExecuteTaskWithWriteLock(() -> {
+        asyncFlush(null /* listener */);
+    }
+
+    /**
+     * Flushes the binary dictionary to the dictionary file in the background. The flush only
+     * needs the read lock, so suggestions and updates can run while the file is written, and the
+     * updates made in the meantime are written by the next flush.
+     * @param listener called on the background thread when the flush has finished, or when it is
+     * left to the GC that has to run first.
+     */
+    public void asyncFlush(@Nullable final FlushListener listener) {
+        asyncExecuteTaskWithLock(mLock.readLock(), () -> {
             final BinaryDictionary binaryDictionary = getBinaryDictionary();
+            final boolean succeeded;
             if (binaryDictionary == null) {
-                return;
-            }
-            if (binaryDictionary.needsToRunGC(false /* mindsBlockByGC */)) {
-                binaryDictionary.flushWithGCIfHasUpdated();
+                succeeded = false;
+            } else if (binaryDictionary.needsToRunGC(false /* mindsBlockByGC */)
+                    && binaryDictionary.hasUpdated()) {
+                // GC on the snapshot flushes the dictionary first.
+                asyncRunGCOnSnapshot();
+                succeeded = false;
             } else {
-                binaryDictionary.flush();
+                succeeded = binaryDictionary.flush();
+            }
+            if (listener != null) {
+                listener.onFlushed(succeeded);
             }
         });
     }
@@ -594,47 +723,31 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
             } catch (final UnsupportedFormatException e) {
                 Log.d(tag, "Cannot fetch header information.", e);
             }
-            int token = 0;
-            do {
-                final BinaryDictionary.GetNextWordPropertyResult result =
-                        binaryDictionary.getNextWordProperty(token);
-                final WordProperty wordProperty = result.mWordProperty;
-                if (wordProperty == null) {
-                    Log.d(tag, " dictionary is empty.");
-                    break;
-                }
+            final ArrayList<WordProperty> wordProperties = binaryDictionary.exportWords();
+            if (wordProperties.isEmpty()) {
+                Log.d(tag, " dictionary is empty.");
+            }
+            for (final WordProperty wordProperty : wordProperties) {
                 Log.d(tag, wordProperty.toString());
-                token = result.mNextToken;
-            } while (token != 0);
+            }
         });
     }
 
     /**
-     * Returns dictionary content required for syncing.
+     * Returns dictionary content required for syncing. The words come without n-grams, shortcuts
+     * and historical info, see {@link BinaryDictionary#exportWords()}.
      */
     public WordProperty[] getWordPropertiesForSyncing() {
         reloadDictionaryIfRequired();
         final AsyncResultHolder<WordProperty[]> result =
                 new AsyncResultHolder<>("WordPropertiesForSync");
         asyncExecuteTaskWithLock(mLock.readLock(), () -> {
-            final ArrayList<WordProperty> wordPropertyList = new ArrayList<>();
             final BinaryDictionary binaryDictionary = getBinaryDictionary();
             if (binaryDictionary == null) {
                 return;
             }
-            int token = 0;
-            do {
-                // TODO: We need a new API that returns *new* un-synced data.
-                final BinaryDictionary.GetNextWordPropertyResult nextWordPropertyResult =
-                        binaryDictionary.getNextWordProperty(token);
-                final WordProperty wordProperty = nextWordPropertyResult.mWordProperty;
-                if (wordProperty == null) {
-                    break;
-                }
-                wordPropertyList.add(wordProperty);
-                token = nextWordPropertyResult.mNextToken;
-            } while (token != 0);
-            result.set(wordPropertyList.toArray(new WordProperty[0]));
+            // TODO: We need a new API that returns *new* un-synced data.
+            result.set(binaryDictionary.exportWords().toArray(new WordProperty[0]));
         });
         // TODO: Figure out the best timeout duration for this API.
         return result.get(DEFAULT_WORD_PROPERTIES_FOR_SYNC, TIMEOUT_FOR_READ_OPS_IN_MILLISECONDS);
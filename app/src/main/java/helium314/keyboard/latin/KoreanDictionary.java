@@ -95,6 +95,16 @@ public class KoreanDictionary extends Dictionary {
         mDictionary.onFinishInput();
     }
 
+    @Override
+    public void trimMemory(final int level) {
+        mDictionary.trimMemory(level);
+    }
+
+    @Override
+    public void prewarm(final int sessionId) {
+        mDictionary.prewarm(sessionId);
+    }
+
     @Override
     public boolean isInitialized() {
         return mDictionary.isInitialized();
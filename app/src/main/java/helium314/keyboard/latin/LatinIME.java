@@ -1156,6 +1156,13 @@ public class LatinIME extends InputMethodService implements
                 currentSettingsValues.mGestureTrailEnabled,
                 currentSettingsValues.mGestureFloatingPreviewTextEnabled);
 
+        // Load the speech model while the user is still looking at the keyboard, so the first
+        // dictation after the mic key is shown doesn't pay for it.
+        if (currentSettingsValues.mShowsVoiceInputKey && currentSettingsValues.mUseBuiltInVoiceRecognition
+                && mVoiceInputManager != null) {
+            mVoiceInputManager.warmup(getVoiceLanguageHints());
+        }
+
         if (TRACE) Debug.startMethodTracing("/data/trace/latinime");
     }
 
@@ -1607,6 +1614,59 @@ public class LatinIME extends InputMethodService implements
         mKeyboardActionListener.onCodeInput(codePoint, x, y, isKeyRepeat);
     }
 
+    /**
+     * Builds the comma separated language hint passed to the built-in voice recognizer: the
+     * current keyboard language first, followed by the other enabled keyboard languages.
+     */
+    private String getVoiceLanguageHints() {
+        // Get all enabled keyboard languages for voice recognition
+        final List<InputMethodSubtype> enabledSubtypes =
+            mRichImm.getMyEnabledInputMethodSubtypes(true);
+        Log.d(TAG, "[VOICE] Number of enabled subtypes: " + enabledSubtypes.size());
+
+        final StringBuilder languageHints = new StringBuilder();
+        final String currentLanguage = mRichImm.getCurrentSubtypeLocale().getLanguage();
+        Log.d(TAG, "[VOICE] Current keyboard language: " + currentLanguage);
+
+        // Add current language first for priority
+        languageHints.append(currentLanguage);
+
+        // Add other enabled languages
+        int languageCount = 1;
+        for (InputMethodSubtype subtype : enabledSubtypes) {
+            // Get the locale from the subtype using the extension function
+            // In Java, Kotlin extension functions are called as static methods
+            final Locale locale = SubtypeUtilsKt.locale(subtype);
+            if (locale != null) {
+                final String lang = locale.getLanguage();
+                Log.d(TAG, "[VOICE] Checking subtype language: " + lang +
+                      " (locale: " + locale.toString() + ")");
+                // Avoid duplicates and don't re-add current language
+                if (!lang.equals(currentLanguage) &&
+                    languageHints.indexOf(lang) == -1) {
+                    languageHints.append(",").append(lang);
+                    languageCount++;
+                    Log.d(TAG, "[VOICE] Added language to hints: " + lang);
+                }
+            }
+        }
+
+        // If we have multiple languages but want to prioritize the current one,
+        // duplicate it to give it stronger weight in language detection
+        String languageHintString = languageHints.toString();
+        if (languageCount > 1) {
+            // Duplicate current language for stronger hint
+            languageHintString = currentLanguage + "," + languageHintString;
+            Log.d(TAG, "[VOICE] Duplicating current language for stronger hint");
+            Log.d(TAG, "[VOICE] Modified hint string: " + languageHintString);
+        }
+
+        Log.d(TAG, "[VOICE] Final language hint string: " + languageHintString);
+        Log.d(TAG, "[VOICE] Total unique languages: " + languageCount);
+        Log.d(TAG, "[VOICE] Mode: " + (languageCount == 1 ? "STRICT LOCK" : "PRIORITIZED MULTI-LANGUAGE"));
+        return languageHintString;
+    }
+
     // This method is public for testability of LatinIME, but also in the future it should
     // completely replace #onCodeInput.
     public void onEvent(@NonNull final Event event) {
@@ -1615,51 +1675,7 @@ public class LatinIME extends InputMethodService implements
             if (mSettings.getCurrent().mUseBuiltInVoiceRecognition) {
                 // Show built-in voice input UI using KeyboardSwitcher
                 if (mVoiceInputManager != null && mKeyboardSwitcher != null) {
-                    // Get all enabled keyboard languages for voice recognition
-                    final List<InputMethodSubtype> enabledSubtypes =
-                        mRichImm.getMyEnabledInputMethodSubtypes(true);
-                    Log.d(TAG, "[VOICE] Number of enabled subtypes: " + enabledSubtypes.size());
-
-                    final StringBuilder languageHints = new StringBuilder();
-                    final String currentLanguage = mRichImm.getCurrentSubtypeLocale().getLanguage();
-                    Log.d(TAG, "[VOICE] Current keyboard language: " + currentLanguage);
-
-                    // Add current language first for priority
-                    languageHints.append(currentLanguage);
-
-                    // Add other enabled languages
-                    int languageCount = 1;
-                    for (InputMethodSubtype subtype : enabledSubtypes) {
-                        // Get the locale from the subtype using the extension function
-                        // In Java, Kotlin extension functions are called as static methods
-                        final Locale locale = SubtypeUtilsKt.locale(subtype);
-                        if (locale != null) {
-                            final String lang = locale.getLanguage();
-                            Log.d(TAG, "[VOICE] Checking subtype language: " + lang +
-                                  " (locale: " + locale.toString() + ")");
-                            // Avoid duplicates and don't re-add current language
-                            if (!lang.equals(currentLanguage) &&
-                                languageHints.indexOf(lang) == -1) {
-                                languageHints.append(",").append(lang);
-                                languageCount++;
-                                Log.d(TAG, "[VOICE] Added language to hints: " + lang);
-                            }
-                        }
-                    }
-
-                    // If we have multiple languages but want to prioritize the current one,
-                    // duplicate it to give it stronger weight in language detection
-                    String languageHintString = languageHints.toString();
-                    if (languageCount > 1) {
-                        // Duplicate current language for stronger hint
-                        languageHintString = currentLanguage + "," + languageHintString;
-                        Log.d(TAG, "[VOICE] Duplicating current language for stronger hint");
-                        Log.d(TAG, "[VOICE] Modified hint string: " + languageHintString);
-                    }
-
-                    Log.d(TAG, "[VOICE] Final language hint string: " + languageHintString);
-                    Log.d(TAG, "[VOICE] Total unique languages: " + languageCount);
-                    Log.d(TAG, "[VOICE] Mode: " + (languageCount == 1 ? "STRICT LOCK" : "PRIORITIZED MULTI-LANGUAGE"));
+                    final String languageHintString = getVoiceLanguageHints();
 
                     // Initialize voice view if needed
                     final helium314.keyboard.voice.ui.VoiceInputView voiceView =
@@ -2084,5 +2100,10 @@ public class LatinIME extends InputMethodService implements
             }
             // deallocateMemory always called on hiding, and should not be called when showing
         }
+        // native caches and buffers that are rebuilt on demand, how much is freed depends on the level
+        mDictionaryFacilitator.trimMemory(level);
+        if (mVoiceInputManager != null) {
+            mVoiceInputManager.trimMemory(level);
+        }
     }
 }
@@ -38,6 +38,15 @@ public final class ReadOnlyBinaryDictionary extends Dictionary {
                 locale, dictType, false /* isUpdatable */);
     }
 
+    /**
+     * Wraps a dictionary that is already open read-only, e.g. by
+     * {@link BinaryDictionary#openMany}.
+     */
+    public ReadOnlyBinaryDictionary(final BinaryDictionary binaryDictionary) {
+        super(binaryDictionary.mDictType, binaryDictionary.mLocale);
+        mBinaryDictionary = binaryDictionary;
+    }
+
     public boolean isValidDictionary() {
         return mBinaryDictionary.isValidDictionary();
     }
@@ -108,6 +117,18 @@ public final class ReadOnlyBinaryDictionary extends Dictionary {
         return NOT_A_PROBABILITY;
     }
 
+    @Override
+    public int[] getMisspelledRanges(final String text) {
+        if (mLock.readLock().tryLock()) {
+            try {
+                return mBinaryDictionary.getMisspelledRanges(text);
+            } finally {
+                mLock.readLock().unlock();
+            }
+        }
+        return null;
+    }
+
     @Override
     public WordProperty getWordProperty(String word, boolean isBeginningOfSentence) {
         if (mLock.readLock().tryLock()) {
@@ -120,6 +141,26 @@ public final class ReadOnlyBinaryDictionary extends Dictionary {
         return null;
     }
 
+    @Override
+    public void trimMemory(final int level) {
+        mLock.readLock().lock();
+        try {
+            mBinaryDictionary.trimMemory(level);
+        } finally {
+            mLock.readLock().unlock();
+        }
+    }
+
+    @Override
+    public void prewarm(final int sessionId) {
+        mLock.readLock().lock();
+        try {
+            mBinaryDictionary.prewarm(sessionId);
+        } finally {
+            mLock.readLock().unlock();
+        }
+    }
+
     @Override
     public void close() {
         mLock.writeLock().lock();
@@ -68,6 +68,10 @@ class SingleDictionaryFacilitator(private val dict: Dictionary) : DictionaryFaci
         dict.close()
     }
 
+    override fun trimMemory(level: Int) {
+        dict.trimMemory(level)
+    }
+
     override fun isActive(): Boolean = true
 
     override fun getMainLocale(): Locale = dict.mLocale
@@ -102,6 +106,8 @@ class SingleDictionaryFacilitator(private val dict: Dictionary) : DictionaryFaci
 
     override fun isValidSuggestionWord(word: String) = isValidSpellingWord(word)
 
+    override fun getMisspelledRangesInMainDictionaries(text: String): IntArray? = dict.getMisspelledRanges(text)
+
     override fun removeWord(word: String) {}
 
     override fun clearUserHistoryDictionary(context: Context) {}
@@ -439,15 +439,20 @@ class Suggest(private val mDictionaryFacilitator: DictionaryFacilitator) {
         ): ArrayList<SuggestedWordInfo> {
             val suggestionsSize = suggestions.size
             val suggestionsList = ArrayList<SuggestedWordInfo>(suggestionsSize)
-            for (cur in suggestions) {
-                addDebugInfo(cur, typedWord)
-                suggestionsList.add(cur)
+            val normalizedScores = BinaryDictionaryUtils.calcNormalizedScores(typedWord,
+                suggestions.map { it.toString() }, IntArray(suggestionsSize) { suggestions[it].mScore })
+            for (i in 0 until suggestionsSize) {
+                addDebugInfo(suggestions[i], normalizedScores[i])
+                suggestionsList.add(suggestions[i])
             }
             return suggestionsList
         }
 
         private fun addDebugInfo(wordInfo: SuggestedWordInfo?, typedWord: String) {
-            val normalizedScore = BinaryDictionaryUtils.calcNormalizedScore(typedWord, wordInfo.toString(), wordInfo!!.mScore)
+            addDebugInfo(wordInfo!!, BinaryDictionaryUtils.calcNormalizedScore(typedWord, wordInfo.toString(), wordInfo.mScore))
+        }
+
+        private fun addDebugInfo(wordInfo: SuggestedWordInfo, normalizedScore: Float) {
             val scoreInfoString: String
             val dict = wordInfo.mSourceDict.mDictType + ":" + wordInfo.mSourceDict.mLocale
             scoreInfoString = if (normalizedScore > 0) {
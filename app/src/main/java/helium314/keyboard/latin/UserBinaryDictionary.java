@@ -22,6 +22,7 @@ import helium314.keyboard.latin.utils.Log;
 import helium314.keyboard.latin.utils.SubtypeLocaleUtils;
 
 import java.io.File;
+import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.Locale;
 
@@ -190,6 +191,12 @@ public class UserBinaryDictionary extends ExpandableBinaryDictionary {
             final int indexWord = cursor.getColumnIndex(Words.WORD);
             final int indexShortcut = hasShortcutColumn ? cursor.getColumnIndex(Words.SHORTCUT) : 0;
             final int indexFrequency = cursor.getColumnIndex(Words.FREQUENCY);
+            // The entries are collected and added at once, which is much faster than adding them
+            // one by one to the empty dictionary.
+            final ArrayList<String> words = new ArrayList<>();
+            final ArrayList<Integer> frequencies = new ArrayList<>();
+            final ArrayList<String> shortcutTargets = new ArrayList<>();
+            final ArrayList<Boolean> isNotAWord = new ArrayList<>();
             while (!cursor.isAfterLast()) {
                 final String word = cursor.getString(indexWord);
                 final String shortcut = hasShortcutColumn ? cursor.getString(indexShortcut) : null;
@@ -197,21 +204,32 @@ public class UserBinaryDictionary extends ExpandableBinaryDictionary {
                 final int adjustedFrequency = scaleFrequencyFromDefaultToLatinIme(frequency);
                 // Safeguard against adding really long words.
                 if (word.length() <= MAX_WORD_LENGTH) {
-                    runGCIfRequiredLocked(true /* mindsBlockByGC */);
-                    addUnigramLocked(word, adjustedFrequency, null /* shortcutTarget */,
-                            0 /* shortcutFreq */, false /* isNotAWord */,
-                            false /* isPossiblyOffensive */,
-                            BinaryDictionary.NOT_A_VALID_TIMESTAMP);
+                    words.add(word);
+                    frequencies.add(adjustedFrequency);
+                    shortcutTargets.add(null);
+                    isNotAWord.add(false);
                     if (null != shortcut && shortcut.length() <= MAX_WORD_LENGTH) {
-                        runGCIfRequiredLocked(true /* mindsBlockByGC */);
-                        addUnigramLocked(shortcut, adjustedFrequency, word,
-                                USER_DICT_SHORTCUT_FREQUENCY, true /* isNotAWord */,
-                                false /* isPossiblyOffensive */,
-                                BinaryDictionary.NOT_A_VALID_TIMESTAMP);
+                        words.add(shortcut);
+                        frequencies.add(adjustedFrequency);
+                        shortcutTargets.add(word);
+                        isNotAWord.add(true);
                     }
                 }
                 cursor.moveToNext();
             }
+            final int wordCount = words.size();
+            final int[] frequencyArray = new int[wordCount];
+            final int[] shortcutFrequencyArray = new int[wordCount];
+            final boolean[] isNotAWordArray = new boolean[wordCount];
+            for (int i = 0; i < wordCount; ++i) {
+                frequencyArray[i] = frequencies.get(i);
+                shortcutFrequencyArray[i] = USER_DICT_SHORTCUT_FREQUENCY;
+                isNotAWordArray[i] = isNotAWord.get(i);
+            }
+            runGCIfRequiredLocked(true /* mindsBlockByGC */);
+            addUnigramsLocked(words.toArray(new String[0]), frequencyArray,
+                    shortcutTargets.toArray(new String[0]), shortcutFrequencyArray,
+                    isNotAWordArray, BinaryDictionary.NOT_A_VALID_TIMESTAMP);
         }
     }
 }
@@ -13,7 +13,9 @@ public class NativeSuggestOptions {
     private static final int BLOCK_OFFENSIVE_WORDS = 2;
     private static final int SPACE_AWARE_GESTURE_ENABLED = 3;
     private static final int WEIGHT_FOR_LOCALE_IN_THOUSANDS = 4;
-    private static final int OPTIONS_SIZE = 5;
+    private static final int SEARCH_TIME_LIMIT_IN_MICROSECONDS = 5;
+    private static final int PARALLEL_EXPANSION_THREAD_COUNT = 6;
+    private static final int OPTIONS_SIZE = 7;
 
     private final int[] mOptions;
 
@@ -43,6 +45,16 @@ public class NativeSuggestOptions {
         setIntegerOption(WEIGHT_FOR_LOCALE_IN_THOUSANDS, (int) (value * 1000));
     }
 
+    // 0 means no limit. When the limit is reached, native code returns the suggestions found so far.
+    public void setSearchTimeLimitInMicroseconds(final int value) {
+        setIntegerOption(SEARCH_TIME_LIMIT_IN_MICROSECONDS, value);
+    }
+
+    // 0 or 1 means serial. Splits the typing search of long inputs across up to this many threads.
+    public void setParallelExpansionThreadCount(final int value) {
+        setIntegerOption(PARALLEL_EXPANSION_THREAD_COUNT, value);
+    }
+
     public int[] getOptions() {
         return mOptions;
     }
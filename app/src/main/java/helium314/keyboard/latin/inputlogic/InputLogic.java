@@ -2365,6 +2365,13 @@ public final class InputLogic {
                     + "performAdditionToUserHistoryDictionary()");
             startTimeMillis = System.currentTimeMillis();
         }
+        // The taps of a typed word tell where the user actually taps the keys of the committed
+        // one; gestures don't.
+        final Keyboard keyboard = KeyboardSwitcher.getInstance().getKeyboard();
+        if (keyboard != null && mWordComposer.isComposingWord() && !mWordComposer.isBatchMode()) {
+            keyboard.getProximityInfo().learnTouchPositions(mWordComposer.getInputPointers(),
+                    chosenWord);
+        }
         // TODO: figure out here if this is an auto-correct or if the best word is actually
         // what user typed. Note: currently this is done much later in
         // LastComposedWord#didCommitTypedWord by string equality of the remembered
@@ -51,6 +51,7 @@ class DictionaryHeader(
         const val DICTIONARY_DATE_KEY = "date"
         const val HAS_HISTORICAL_INFO_KEY = "HAS_HISTORICAL_INFO"
         const val USES_FORGETTING_CURVE_KEY = "USES_FORGETTING_CURVE"
+        const val USES_NGRAM_CONTEXT_MAP_KEY = "USES_NGRAM_CONTEXT_MAP"
         const val FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID_KEY =
             "FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID"
         const val MAX_UNIGRAM_COUNT_KEY = "MAX_UNIGRAM_ENTRY_COUNT"
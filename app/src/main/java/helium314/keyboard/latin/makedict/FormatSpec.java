@@ -170,11 +170,13 @@ public final class FormatSpec {
     public static final int VERSION4_ONLY_FOR_TESTING = 399;
     public static final int VERSION402 = 402;
     public static final int VERSION403 = 403;
-    public static final int VERSION4 = VERSION403;
+    // Same as 403 but the large n-gram values are stored in a single trie map entry.
+    public static final int VERSION404 = 404;
+    public static final int VERSION4 = VERSION404;
     public static final int MINIMUM_SUPPORTED_STATIC_VERSION = VERSION202;
     public static final int MAXIMUM_SUPPORTED_STATIC_VERSION = VERSION_DELIGHT3;
-    static final int MINIMUM_SUPPORTED_DYNAMIC_VERSION = VERSION4;
-    static final int MAXIMUM_SUPPORTED_DYNAMIC_VERSION = VERSION403;
+    static final int MINIMUM_SUPPORTED_DYNAMIC_VERSION = VERSION403;
+    static final int MAXIMUM_SUPPORTED_DYNAMIC_VERSION = VERSION404;
 
     // TODO: Make this value adaptative to content data, store it in the header, and
     // use it in the reading code.
@@ -75,6 +75,9 @@ public class UserHistoryDictionary extends ExpandableBinaryDictionary {
                 DictionaryHeader.ATTRIBUTE_VALUE_TRUE);
         attributeMap.put(DictionaryHeader.HAS_HISTORICAL_INFO_KEY,
                 DictionaryHeader.ATTRIBUTE_VALUE_TRUE);
+        // User history is mostly looked up by n-gram context.
+        attributeMap.put(DictionaryHeader.USES_NGRAM_CONTEXT_MAP_KEY,
+                DictionaryHeader.ATTRIBUTE_VALUE_TRUE);
         return attributeMap;
     }
 
@@ -15,6 +15,7 @@ import android.view.inputmethod.InputMethodSubtype;
 import android.view.textservice.SuggestionsInfo;
 
 import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
 
 import helium314.keyboard.keyboard.Keyboard;
 import helium314.keyboard.keyboard.KeyboardId;
@@ -144,6 +145,22 @@ public final class AndroidSpellCheckerService extends SpellCheckerService
         }
     }
 
+    /**
+     * Checks the words of the text in the main dictionaries for the locale at once.
+     * @return the start and end offsets of the words that are not found, in pairs, or null if the
+     * words have to be checked one by one.
+     */
+    @Nullable
+    public int[] getMisspelledRanges(final Locale locale, final String text) {
+        mSemaphore.acquireUninterruptibly();
+        try {
+            DictionaryFacilitator dictionaryFacilitatorForLocale = mDictionaryFacilitatorCache.get(locale);
+            return dictionaryFacilitatorForLocale.getMisspelledRangesInMainDictionaries(text);
+        } finally {
+            mSemaphore.release();
+        }
+    }
+
     public SuggestionResults getSuggestionResults(final Locale locale,
             final ComposedData composedData, final NgramContext ngramContext,
             @NonNull final Keyboard keyboard) {
@@ -164,21 +164,105 @@ public final class AndroidSpellCheckerSession extends AndroidWordLevelSpellCheck
             for (int j = 0; j < itemsSize; ++j) {
                 splitTextInfos[j] = mItems.get(j).mTextInfo;
             }
-            retval[i] = SentenceLevelAdapter.reconstructSuggestions(
-                    textInfoParams, onGetSuggestionsMultiple(
-                            splitTextInfos, suggestionsLimit, true));
+            // The words found in the main dictionaries by one native call need no further lookup.
+            final String text = textInfos[i].getText();
+            final int[] misspelledRanges = getMisspelledRanges(text);
+            final boolean[] areInDictionary = misspelledRanges == null ? null
+                    : getWordsInDictionary(text, mItems, misspelledRanges);
+            retval[i] = SentenceLevelAdapter.reconstructSuggestions(textInfoParams,
+                    getSuggestionsForWords(splitTextInfos, areInDictionary, suggestionsLimit,
+                            true /* sequentialWords */));
         }
         return retval;
     }
 
+    // A word is in the dictionary if the text has been checked at once and the word is one of the
+    // checked words, but not one of the misspelled ones.
+    private static boolean[] getWordsInDictionary(final String text,
+            final ArrayList<SentenceLevelAdapter.SentenceWordItem> items,
+            final int[] misspelledRanges) {
+        final boolean[] areInDictionary = new boolean[items.size()];
+        for (int i = 0; i < items.size(); ++i) {
+            final int start = items.get(i).mStart;
+            final int end = start + items.get(i).mLength;
+            if (!isCheckedAsOneWord(text, start, end)) {
+                continue;
+            }
+            boolean isMisspelled = false;
+            for (int j = 0; j < misspelledRanges.length && !isMisspelled; j += 2) {
+                isMisspelled = misspelledRanges[j] < end && misspelledRanges[j + 1] > start;
+            }
+            areInDictionary[i] = !isMisspelled;
+        }
+        return areInDictionary;
+    }
+
+    // Whether the native check has looked up exactly this word: it is made of letters and
+    // apostrophes between letters, and the text around it separates it from other words.
+    private static boolean isCheckedAsOneWord(final String text, final int start, final int end) {
+        if (start >= end || (start > 0 && !isSeparator(text.codePointBefore(start)))
+                || (end < text.length() && !isSeparator(text.codePointAt(end)))) {
+            return false;
+        }
+        boolean isAfterLetter = false;
+        for (int i = start; i < end; i = text.offsetByCodePoints(i, 1)) {
+            final int codePoint = text.codePointAt(i);
+            if (isCheckedLetter(codePoint)) {
+                isAfterLetter = true;
+            } else if (isAfterLetter && isApostrophe(codePoint)
+                    && i + 1 < end && isCheckedLetter(text.codePointAt(i + 1))) {
+                isAfterLetter = false;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The letters that the native check also takes as letters, see CharUtils::isLetterOrDigit().
+    private static boolean isCheckedLetter(final int codePoint) {
+        return Character.isLetter(codePoint) && (codePoint < 0x80 || codePoint >= 0xC0)
+                && !(codePoint >= 0x2000 && codePoint <= 0x2BFF)
+                && !(codePoint >= 0x3000 && codePoint <= 0x303F)
+                && !(codePoint >= 0x1F000 && codePoint <= 0x1FAFF);
+    }
+
+    private static boolean isApostrophe(final int codePoint) {
+        return codePoint == AndroidSpellCheckerService.SINGLE_QUOTE.charAt(0)
+                || codePoint == AndroidSpellCheckerService.APOSTROPHE.charAt(0);
+    }
+
+    // Only the characters that separate words for the native check in any case.
+    private static boolean isSeparator(final int codePoint) {
+        if (codePoint < 0x80) {
+            return !Character.isLetterOrDigit(codePoint) && !isApostrophe(codePoint);
+        }
+        return Character.isWhitespace(codePoint) || Character.isSpaceChar(codePoint);
+    }
+
     @Override
     public SuggestionsInfo[] onGetSuggestionsMultiple(TextInfo[] textInfos,
             int suggestionsLimit, boolean sequentialWords) {
+        return getSuggestionsForWords(textInfos, null /* areInDictionary */, suggestionsLimit,
+                sequentialWords);
+    }
+
+    // The words for which areInDictionary is true are reported as in the dictionary without
+    // looking them up again.
+    private SuggestionsInfo[] getSuggestionsForWords(final TextInfo[] textInfos,
+            final boolean[] areInDictionary, final int suggestionsLimit,
+            final boolean sequentialWords) {
         long ident = Binder.clearCallingIdentity();
         try {
             final int length = textInfos.length;
             final SuggestionsInfo[] retval = new SuggestionsInfo[length];
             for (int i = 0; i < length; ++i) {
+                final TextInfo textInfo = textInfos[i];
+                if (areInDictionary != null && areInDictionary[i]) {
+                    retval[i] = AndroidSpellCheckerService.getInDictEmptySuggestions();
+                    retval[i].setCookieAndSequence(textInfo.getCookie(), textInfo.getSequence());
+                    continue;
+                }
                 final CharSequence prevWord;
                 if (sequentialWords && i > 0) {
                     final TextInfo prevTextInfo = textInfos[i - 1];
@@ -191,7 +275,6 @@ public final class AndroidSpellCheckerSession extends AndroidWordLevelSpellCheck
                 }
                 final NgramContext ngramContext =
                         new NgramContext(new NgramContext.WordInfo(prevWord));
-                final TextInfo textInfo = textInfos[i];
                 retval[i] = onGetSuggestionsInternal(textInfo, ngramContext, suggestionsLimit);
                 retval[i].setCookieAndSequence(textInfo.getCookie(), textInfo.getSequence());
             }
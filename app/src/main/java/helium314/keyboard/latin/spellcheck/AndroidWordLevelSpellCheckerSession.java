@@ -22,6 +22,8 @@ import android.view.inputmethod.InputMethodSubtype;
 import android.view.textservice.SuggestionsInfo;
 import android.view.textservice.TextInfo;
 
+import androidx.annotation.Nullable;
+
 import helium314.keyboard.keyboard.Keyboard;
 import helium314.keyboard.latin.NgramContext;
 import helium314.keyboard.latin.SuggestedWords.SuggestedWordInfo;
@@ -255,6 +257,20 @@ public abstract class AndroidWordLevelSpellCheckerSession extends Session {
         return mService.isValidWord(mLocale, StringUtils.capitalizeFirstAndDowncaseRest(lowerCaseText, mLocale));
     }
 
+    /**
+     * Checks the words of the text in the main dictionaries at once.
+     * @return the start and end offsets of the words that are not found, in pairs, or null if the
+     * words have to be checked one by one.
+     */
+    @Nullable
+    protected int[] getMisspelledRanges(final String text) {
+        updateLocale();
+        if (mLocale == null || !mService.hasMainDictionaryForLocale(mLocale)) {
+            return null;
+        }
+        return mService.getMisspelledRanges(mLocale, text);
+    }
+
     // Note : this must be reentrant
     /**
      * Gets a list of suggestions for a specific string. This returns a list of possible
@@ -144,6 +144,27 @@ public class VoiceInputManager {
         Log.d(TAG, "[VOICE] ========================================");
     }
     
+    /**
+     * Prepare recognition in the background while the voice input key is shown, so the first
+     * dictation doesn't wait for the model to load
+     * @param languageHint Keyboard languages for recognition hint
+     */
+    public void warmup(String languageHint) {
+        if (recognitionEngine != null && !isVoiceInputActive) {
+            recognitionEngine.warmup(languageHint);
+        }
+    }
+
+    /**
+     * Free memory of the recognition engine that is allocated again on the next recognition
+     * @param level ComponentCallbacks2.TRIM_MEMORY_* level
+     */
+    public void trimMemory(int level) {
+        if (recognitionEngine != null) {
+            recognitionEngine.trimMemory(level);
+        }
+    }
+
     /**
      * Hide voice input UI and restore keyboard
      */
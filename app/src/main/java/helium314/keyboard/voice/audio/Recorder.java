@@ -41,6 +41,7 @@ public class Recorder {
     public interface RecorderListener {
         void onUpdateReceived(String message);
         default void onAudioBufferReceived(float[] audioBuffer) {} // Optional callback for audio visualization
+        default void onAudioChunkReceived(float[] audioChunk) {} // Optional callback with all recorded audio, for streaming recognition
     }
 
     private static final String TAG = "VoiceRecorder";
@@ -161,16 +162,26 @@ public class Recorder {
             mListener.onUpdateReceived(message);
     }
     
+    private static float[] toFloatSamples(byte[] audioData, int bytesRead) {
+        float[] floatBuffer = new float[bytesRead / 2]; // 16-bit audio = 2 bytes per sample
+        for (int i = 0; i < floatBuffer.length; i++) {
+            // Convert 16-bit PCM to float (-1.0 to 1.0)
+            short sample = (short) ((audioData[i * 2] & 0xFF) | (audioData[i * 2 + 1] << 8));
+            floatBuffer[i] = sample / 32768.0f;
+        }
+        return floatBuffer;
+    }
+
     private void sendAudioBuffer(byte[] audioData, int bytesRead) {
         if (mListener != null) {
             // Convert byte array to float array for visualization
-            float[] floatBuffer = new float[bytesRead / 2]; // 16-bit audio = 2 bytes per sample
-            for (int i = 0; i < floatBuffer.length; i++) {
-                // Convert 16-bit PCM to float (-1.0 to 1.0)
-                short sample = (short) ((audioData[i * 2] & 0xFF) | (audioData[i * 2 + 1] << 8));
-                floatBuffer[i] = sample / 32768.0f;
-            }
-            mListener.onAudioBufferReceived(floatBuffer);
+            mListener.onAudioBufferReceived(toFloatSamples(audioData, bytesRead));
+        }
+    }
+
+    private void sendAudioChunk(byte[] audioData, int bytesRead) {
+        if (mListener != null) {
+            mListener.onAudioChunkReceived(toFloatSamples(audioData, bytesRead));
         }
     }
 
@@ -301,6 +312,7 @@ public class Recorder {
                 if (bytesRead > 0) {
                     outputBuffer.write(audioData, 0, bytesRead);
                     totalBytesRead += bytesRead;
+                    sendAudioChunk(audioData, bytesRead);
 
                     // Send audio buffer for visualization
                     long currentTime = System.currentTimeMillis();
@@ -315,11 +327,15 @@ public class Recorder {
 
                 // VAD processing
                 if (useVAD) {
-                    byte[] outputBufferByteArray = outputBuffer.toByteArray();
-                    if (outputBufferByteArray.length >= VAD_FRAME_SIZE * 2) {
-                        // Always use the last VAD_FRAME_SIZE * 2 bytes (16-bit) from outputBuffer for VAD
-                        System.arraycopy(outputBufferByteArray, outputBufferByteArray.length - VAD_FRAME_SIZE * 2, vadAudioBuffer, 0, VAD_FRAME_SIZE * 2);
-
+                    // Always use the last VAD_FRAME_SIZE * 2 bytes (16-bit) of the recording for VAD,
+                    // kept here instead of copying all the audio recorded so far for every frame
+                    if (bytesRead >= vadAudioBuffer.length) {
+                        System.arraycopy(audioData, bytesRead - vadAudioBuffer.length, vadAudioBuffer, 0, vadAudioBuffer.length);
+                    } else {
+                        System.arraycopy(vadAudioBuffer, bytesRead, vadAudioBuffer, 0, vadAudioBuffer.length - bytesRead);
+                        System.arraycopy(audioData, 0, vadAudioBuffer, vadAudioBuffer.length - bytesRead, bytesRead);
+                    }
+                    if (totalBytesRead >= VAD_FRAME_SIZE * 2) {
                         isSpeech = vad.isSpeech(vadAudioBuffer);
                         if (isSpeech) {
                             if (!isRecording) {
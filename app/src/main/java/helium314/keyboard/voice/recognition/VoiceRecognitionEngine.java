@@ -31,6 +31,43 @@ public interface VoiceRecognitionEngine {
      * @param languageHint Optional language hint (e.g., "en", "es", "fr")
      */
     void recognize(float[] audioData, String languageHint);
+
+    /**
+     * Check if the engine can recognize audio while it is being recorded
+     * @return true if startStreaming, feedAudio and finishStreaming are supported
+     */
+    default boolean supportsStreaming() {
+        return false;
+    }
+
+    /**
+     * Start recognition of audio that is still being recorded
+     * @param languageHint Optional language hint (e.g., "en", "es", "fr")
+     */
+    default void startStreaming(String languageHint) {}
+
+    /**
+     * Add recorded audio to the recognition started by startStreaming
+     * @param audioData Float array of audio samples (16kHz mono expected)
+     */
+    default void feedAudio(float[] audioData) {}
+
+    /**
+     * End the recorded audio and report the result of the streamed recognition
+     */
+    default void finishStreaming() {}
+
+    /**
+     * Prepare the engine for a recognition that is likely to start soon, e.g. load the model
+     * @param languageHint Optional language hint (e.g., "en", "es", "fr")
+     */
+    default void warmup(String languageHint) {}
+
+    /**
+     * Free memory that is allocated again on the next recognition, e.g. compute buffers
+     * @param level ComponentCallbacks2.TRIM_MEMORY_* level
+     */
+    default void trimMemory(int level) {}
     
     /**
      * Check if the engine is available and ready
@@ -1,5 +1,6 @@
 package helium314.keyboard.voice.recognition;
 
+import android.content.ComponentCallbacks2;
 import android.content.Context;
 import android.util.Log;
 
@@ -13,6 +14,7 @@ import java.util.Map;
 import java.util.concurrent.ExecutorService;
 import java.util.concurrent.Executors;
 import java.util.concurrent.Future;
+import java.util.concurrent.atomic.AtomicInteger;
 
 import helium314.keyboard.voice.whisper.WhisperGGML;
 import helium314.keyboard.voice.whisper.WhisperModelLoader;
@@ -31,12 +33,17 @@ public class WhisperRecognitionEngine implements VoiceRecognitionEngine {
     private ExecutorService executorService;
     private Future<?> currentTask;
     private boolean isProcessing = false;
+    // Primary language of the stream in progress, null when not streaming
+    private volatile String streamPrimaryLanguage = null;
+    private final AtomicInteger pendingStreamChunks = new AtomicInteger();
     
     // Audio buffer for accumulating samples
     private final List<Float> audioBuffer = new ArrayList<>();
     private static final int SAMPLE_RATE = 16000;
     private static final int MAX_RECORDING_SECONDS = 30;
     private static final int MAX_SAMPLES = SAMPLE_RATE * MAX_RECORDING_SECONDS;
+    // Models not used for this long give their buffers back and are resumed by the next warmup
+    private static final int MODEL_IDLE_TIMEOUT_MS = 60 * 1000;
     
     public WhisperRecognitionEngine(Context context) {
         this.context = context;
@@ -87,6 +94,7 @@ public class WhisperRecognitionEngine implements VoiceRecognitionEngine {
             if (modelBuffer != null) {
                 Log.d(TAG, "[VOICE] Model buffer loaded, creating WhisperGGML instance...");
                 WhisperGGML newInstance = new WhisperGGML(modelBuffer);
+                newInstance.setIdleTimeout(MODEL_IDLE_TIMEOUT_MS);
                 modelCache.put(modelPath, newInstance);
                 whisperInstance = newInstance;
                 currentLanguage = languageCode;
@@ -141,23 +149,219 @@ public class WhisperRecognitionEngine implements VoiceRecognitionEngine {
     public void recognize(float[] audioData, String languageHint) {
         Log.d(TAG, "[VOICE] ===== WhisperRecognitionEngine.recognize() =====");
         Log.d(TAG, "[VOICE] Audio data length: " + audioData.length + " samples");
+
+        final String[] finalLanguages = parseLanguageHint(languageHint);
+        final String finalPrimaryLanguage = getPrimaryLanguage(finalLanguages);
+
+        if (!prepareInstance(finalPrimaryLanguage)) {
+            return;
+        }
+
+        if (isProcessing) {
+            Log.w(TAG, "[VOICE] Recognition already in progress");
+            return;
+        }
+
+        isProcessing = true;
+        if (listener != null) {
+            listener.onRecognitionStarted();
+        }
+
+        // Ensure executor service is available
+        ensureExecutorService();
+
+        currentTask = executorService.submit(() -> runRecognition(finalPrimaryLanguage, () -> {
+            setPartialResultCallback();
+            String[] languages = prepareLanguages(finalLanguages);
+
+            // No bail languages for now
+            String[] bailLanguages = new String[]{};
+            Log.d(TAG, "[VOICE] Bail languages: " + (bailLanguages.length == 0 ? "none" : String.join(", ", bailLanguages)));
+
+            Log.d(TAG, "[VOICE] Starting Whisper inference...");
+            Log.d(TAG, "[VOICE] Model: " + (finalPrimaryLanguage.equals("en") ? "English" : "Multilingual"));
+
+            // Run inference with language enforcement
+            return whisperInstance.infer(
+                audioData,
+                "", // No prompt
+                languages,
+                bailLanguages,
+                WhisperGGML.DecodingMode.GREEDY,
+                true // Suppress non-speech tokens
+            );
+        }));
+    }
+
+    @Override
+    public boolean supportsStreaming() {
+        return WhisperGGML.isNativeLibraryAvailable();
+    }
+
+    @Override
+    public void startStreaming(String languageHint) {
+        Log.d(TAG, "[VOICE] ===== WhisperRecognitionEngine.startStreaming() =====");
+
+        final String[] finalLanguages = parseLanguageHint(languageHint);
+        final String finalPrimaryLanguage = getPrimaryLanguage(finalLanguages);
+
+        if (isProcessing) {
+            Log.w(TAG, "[VOICE] Recognition already in progress");
+            return;
+        }
+
+        isProcessing = true;
+        streamPrimaryLanguage = finalPrimaryLanguage;
+        ensureExecutorService();
+
+        // The tasks of a stream run in order on the executor, starting with loading the model
+        executorService.submit(() -> {
+            if (!prepareInstance(finalPrimaryLanguage)) {
+                streamPrimaryLanguage = null;
+                isProcessing = false;
+                return;
+            }
+            if (!isProcessing) {
+                // Cancelled while the model was loading
+                return;
+            }
+            setPartialResultCallback();
+            whisperInstance.startStream(
+                "", // No prompt
+                prepareLanguages(finalLanguages),
+                new String[]{}, // No bail languages for now
+                WhisperGGML.DecodingMode.GREEDY,
+                true // Suppress non-speech tokens
+            );
+        });
+    }
+
+    @Override
+    public void feedAudio(float[] audioData) {
+        if (streamPrimaryLanguage == null) {
+            return;
+        }
+        pendingStreamChunks.incrementAndGet();
+        executorService.submit(() -> {
+            // Decoding is skipped while more audio is queued, so that decoding slower than the
+            // audio arrives does not fall further and further behind
+            boolean isLastChunk = pendingStreamChunks.decrementAndGet() == 0;
+            if (whisperInstance != null && isProcessing) {
+                whisperInstance.pushAudio(audioData, isLastChunk);
+            }
+        });
+    }
+
+    @Override
+    public void finishStreaming() {
+        Log.d(TAG, "[VOICE] ===== WhisperRecognitionEngine.finishStreaming() =====");
+        final String finalPrimaryLanguage = streamPrimaryLanguage;
+        if (finalPrimaryLanguage == null) {
+            return;
+        }
+        streamPrimaryLanguage = null;
+
+        if (listener != null) {
+            listener.onRecognitionStarted();
+        }
+        currentTask = executorService.submit(() -> {
+            if (whisperInstance == null || !isProcessing) {
+                // The model could not be loaded or the stream was cancelled, so there is no result,
+                // but the listener has been told that the recognition started
+                isProcessing = false;
+                if (listener != null) {
+                    listener.onRecognitionFinished();
+                }
+                return;
+            }
+            runRecognition(finalPrimaryLanguage, () -> whisperInstance.finishStream());
+        });
+    }
+
+    @Override
+    public void warmup(String languageHint) {
+        if (!isAvailable()) {
+            return;
+        }
+        final String finalPrimaryLanguage = getPrimaryLanguage(parseLanguageHint(languageHint));
+        ensureExecutorService();
+
+        // Runs on the executor, so a recognition started meanwhile waits for it instead of overlapping
+        executorService.submit(() -> {
+            if (isProcessing) {
+                return;
+            }
+            if (whisperInstance == null || !finalPrimaryLanguage.equals(currentLanguage)) {
+                Log.d(TAG, "[VOICE] Warming up model for language: " + finalPrimaryLanguage);
+                initializeForLanguage(finalPrimaryLanguage);
+            }
+            if (whisperInstance != null) {
+                whisperInstance.warmup();
+            }
+        });
+    }
+
+    private interface RecognitionTask {
+        String run() throws WhisperGGML.BailLanguageException, WhisperGGML.InferenceCancelledException;
+    }
+
+    private void runRecognition(String primaryLanguage, RecognitionTask task) {
+        try {
+            String result = task.run();
+
+            Log.d(TAG, "[VOICE] Inference completed");
+
+            // Handle result
+            if (result != null && !result.isEmpty()) {
+                Log.d(TAG, "[VOICE] Recognition result: \"" + result + "\"");
+                Log.d(TAG, "[VOICE] Reporting language as: " + primaryLanguage);
+                if (listener != null) {
+                    // Return the primary language for consistency
+                    listener.onRecognitionResult(result, primaryLanguage);
+                }
+            } else {
+                Log.d(TAG, "[VOICE] Recognition result: EMPTY");
+                if (listener != null) {
+                    listener.onRecognitionResult("", primaryLanguage);
+                }
+            }
+
+        } catch (WhisperGGML.BailLanguageException e) {
+            Log.d(TAG, "Bail language detected: " + e.getLanguage());
+            if (listener != null) {
+                // Return empty result but keep the primary language
+                listener.onRecognitionResult("", primaryLanguage);
+            }
+        } catch (WhisperGGML.InferenceCancelledException e) {
+            Log.d(TAG, "Inference cancelled");
+        } catch (Exception e) {
+            Log.e(TAG, "Recognition error", e);
+            if (listener != null) {
+                listener.onRecognitionError("Voice recognition failed");
+            }
+        } finally {
+            isProcessing = false;
+            if (listener != null) {
+                listener.onRecognitionFinished();
+            }
+        }
+    }
+
+    private String[] parseLanguageHint(String languageHint) {
         Log.d(TAG, "[VOICE] Raw language hint: " + languageHint);
 
         // Parse language hint into array
         String[] languageArray;
-        String primaryLanguage;
 
         if (languageHint == null || languageHint.isEmpty()) {
             // No language hint - use empty array to trigger full auto-detection in C++ layer
             languageArray = new String[0];
-            primaryLanguage = "auto"; // For model loading (triggers multilingual) and reporting
             Log.d(TAG, "[VOICE] No language hint provided, using FULL AUTO-DETECTION with multilingual model");
             Log.d(TAG, "[VOICE] Passing EMPTY language array to C++ layer");
         } else {
             // Parse multiple languages if comma-separated
             languageArray = languageHint.contains(",") ?
                 languageHint.split(",") : new String[]{languageHint};
-            primaryLanguage = languageArray[0];
         }
 
         Log.d(TAG, "[VOICE] Parsed languages count: " + languageArray.length);
@@ -165,7 +369,15 @@ public class WhisperRecognitionEngine implements VoiceRecognitionEngine {
             Log.d(TAG, "[VOICE] Language[" + i + "]: " + languageArray[i] +
                   (i == 0 ? " (PRIMARY)" : ""));
         }
+        return languageArray;
+    }
+
+    private static String getPrimaryLanguage(String[] languageArray) {
+        // "auto" is used for model loading (triggers multilingual) and reporting
+        return languageArray.length == 0 ? "auto" : languageArray[0];
+    }
 
+    private boolean prepareInstance(String primaryLanguage) {
         // Initialize for the primary language if needed
         if (whisperInstance == null || !primaryLanguage.equals(currentLanguage)) {
             Log.d(TAG, "[VOICE] Initializing model for primary language: " + primaryLanguage);
@@ -180,116 +392,49 @@ public class WhisperRecognitionEngine implements VoiceRecognitionEngine {
             if (listener != null) {
                 listener.onRecognitionError("Voice recognition not initialized");
             }
-            return;
+            return false;
         }
+        return true;
+    }
 
-        if (isProcessing) {
-            Log.w(TAG, "[VOICE] Recognition already in progress");
-            return;
-        }
+    private void setPartialResultCallback() {
+        whisperInstance.setPartialResultCallback(text -> {
+            Log.d(TAG, "[VOICE] Partial result: \"" + text + "\"");
+            if (listener != null) {
+                listener.onPartialResult(text);
+            }
+        });
+    }
 
-        isProcessing = true;
-        if (listener != null) {
-            listener.onRecognitionStarted();
+    private String[] prepareLanguages(String[] finalLanguages) {
+        // Prepare language hints - normalize to Whisper's expected codes
+        String[] normalizedLanguages = new String[finalLanguages.length];
+        for (int i = 0; i < finalLanguages.length; i++) {
+            normalizedLanguages[i] = normalizeLanguageCode(finalLanguages[i]);
+            if (!normalizedLanguages[i].equals(finalLanguages[i])) {
+                Log.d(TAG, "[VOICE] Normalized language: " + finalLanguages[i] + " -> " + normalizedLanguages[i]);
+            }
         }
 
-        // Ensure executor service is available
-        ensureExecutorService();
-
-        final String[] finalLanguages = languageArray;
-        final String finalPrimaryLanguage = primaryLanguage;
-        currentTask = executorService.submit(() -> {
-            try {
-                // Set up partial result callback
-                whisperInstance.setPartialResultCallback(text -> {
-                    Log.d(TAG, "[VOICE] Partial result: \"" + text + "\"");
-                    if (listener != null) {
-                        listener.onPartialResult(text);
-                    }
-                });
-
-                // Prepare language hints - normalize to Whisper's expected codes
-                String[] normalizedLanguages = new String[finalLanguages.length];
-                for (int i = 0; i < finalLanguages.length; i++) {
-                    normalizedLanguages[i] = normalizeLanguageCode(finalLanguages[i]);
-                    if (!normalizedLanguages[i].equals(finalLanguages[i])) {
-                        Log.d(TAG, "[VOICE] Normalized language: " + finalLanguages[i] + " -> " + normalizedLanguages[i]);
-                    }
-                }
-
-                String[] languages;
-                if (normalizedLanguages.length == 0) {
-                    // No languages - full auto-detection
-                    languages = normalizedLanguages;
-                    Log.d(TAG, "[VOICE] *** FULL AUTO-DETECTION MODE ***");
-                    Log.d(TAG, "[VOICE] Empty language array passed to JNI - triggers unrestricted auto-detection");
-                } else if (normalizedLanguages.length == 1) {
-                    // Single language - strict lock (pass twice for enforcement)
-                    languages = new String[]{normalizedLanguages[0], normalizedLanguages[0]};
-                    Log.d(TAG, "[VOICE] *** STRICT LOCK MODE ***");
-                    Log.d(TAG, "[VOICE] Duplicating language for strict lock: " + normalizedLanguages[0]);
-                    Log.d(TAG, "[VOICE] Passing to JNI: [" + languages[0] + ", " + languages[1] + "]");
-                } else {
-                    // Multiple languages - restricted auto-detection
-                    languages = normalizedLanguages;
-                    Log.d(TAG, "[VOICE] *** MULTI-LANGUAGE MODE ***");
-                    Log.d(TAG, "[VOICE] Languages for restricted auto-detection: " + String.join(", ", normalizedLanguages));
-                }
-
-                // No bail languages for now
-                String[] bailLanguages = new String[]{};
-                Log.d(TAG, "[VOICE] Bail languages: " + (bailLanguages.length == 0 ? "none" : String.join(", ", bailLanguages)));
-
-                Log.d(TAG, "[VOICE] Starting Whisper inference...");
-                Log.d(TAG, "[VOICE] Model: " + (primaryLanguage.equals("en") ? "English" : "Multilingual"));
-
-                // Run inference with language enforcement
-                String result = whisperInstance.infer(
-                    audioData,
-                    "", // No prompt
-                    languages,
-                    bailLanguages,
-                    WhisperGGML.DecodingMode.GREEDY,
-                    true // Suppress non-speech tokens
-                );
-
-                Log.d(TAG, "[VOICE] Inference completed");
-
-                // Handle result
-                if (result != null && !result.isEmpty()) {
-                    Log.d(TAG, "[VOICE] Recognition result: \"" + result + "\"");
-                    Log.d(TAG, "[VOICE] Reporting language as: " + finalPrimaryLanguage);
-                    if (listener != null) {
-                        // Return the primary language for consistency
-                        listener.onRecognitionResult(result, finalPrimaryLanguage);
-                    }
-                } else {
-                    Log.d(TAG, "[VOICE] Recognition result: EMPTY");
-                    if (listener != null) {
-                        listener.onRecognitionResult("", finalPrimaryLanguage);
-                    }
-                }
-
-            } catch (WhisperGGML.BailLanguageException e) {
-                Log.d(TAG, "Bail language detected: " + e.getLanguage());
-                if (listener != null) {
-                    // Return empty result but keep the primary language
-                    listener.onRecognitionResult("", finalPrimaryLanguage);
-                }
-            } catch (WhisperGGML.InferenceCancelledException e) {
-                Log.d(TAG, "Inference cancelled");
-            } catch (Exception e) {
-                Log.e(TAG, "Recognition error", e);
-                if (listener != null) {
-                    listener.onRecognitionError("Voice recognition failed");
-                }
-            } finally {
-                isProcessing = false;
-                if (listener != null) {
-                    listener.onRecognitionFinished();
-                }
-            }
-        });
+        String[] languages;
+        if (normalizedLanguages.length == 0) {
+            // No languages - full auto-detection
+            languages = normalizedLanguages;
+            Log.d(TAG, "[VOICE] *** FULL AUTO-DETECTION MODE ***");
+            Log.d(TAG, "[VOICE] Empty language array passed to JNI - triggers unrestricted auto-detection");
+        } else if (normalizedLanguages.length == 1) {
+            // Single language - strict lock (pass twice for enforcement)
+            languages = new String[]{normalizedLanguages[0], normalizedLanguages[0]};
+            Log.d(TAG, "[VOICE] *** STRICT LOCK MODE ***");
+            Log.d(TAG, "[VOICE] Duplicating language for strict lock: " + normalizedLanguages[0]);
+            Log.d(TAG, "[VOICE] Passing to JNI: [" + languages[0] + ", " + languages[1] + "]");
+        } else {
+            // Multiple languages - restricted auto-detection
+            languages = normalizedLanguages;
+            Log.d(TAG, "[VOICE] *** MULTI-LANGUAGE MODE ***");
+            Log.d(TAG, "[VOICE] Languages for restricted auto-detection: " + String.join(", ", normalizedLanguages));
+        }
+        return languages;
     }
     
     @Override
@@ -309,7 +454,10 @@ public class WhisperRecognitionEngine implements VoiceRecognitionEngine {
         }
         if (whisperInstance != null) {
             whisperInstance.cancel();
+            // An open stream keeps its audio and keeps the model from being trimmed until it ends
+            whisperInstance.abortStream();
         }
+        streamPrimaryLanguage = null;
         isProcessing = false;
     }
     
@@ -318,6 +466,22 @@ public class WhisperRecognitionEngine implements VoiceRecognitionEngine {
         this.listener = listener;
     }
     
+    @Override
+    public void trimMemory(int level) {
+        if (executorService == null || executorService.isShutdown()) {
+            return;
+        }
+        // The KV caches are used by every recognition, so they are only freed under heavy memory pressure
+        final boolean releaseKvCache = level == ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL
+                || level >= ComponentCallbacks2.TRIM_MEMORY_MODERATE;
+        // On the executor, so that it does not race with loading a model
+        executorService.execute(() -> {
+            for (WhisperGGML instance : modelCache.values()) {
+                instance.trimMemory(releaseKvCache);
+            }
+        });
+    }
+
     @Override
     public void cleanup() {
         cancelRecognition();
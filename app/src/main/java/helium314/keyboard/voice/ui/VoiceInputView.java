@@ -58,6 +58,8 @@ public class VoiceInputView extends FrameLayout {
     // State
     private boolean isProcessing = false;
     private boolean isRecording = false;
+    // Whether the recorded audio is fed to the engine while recording
+    private volatile boolean isStreaming = false;
 
     // Recognition parameters
     private String languageHint;
@@ -148,6 +150,14 @@ public class VoiceInputView extends FrameLayout {
                     }
                 });
             }
+
+            @Override
+            public void onAudioChunkReceived(float[] audioChunk) {
+                VoiceRecognitionEngine engine = recognitionEngine;
+                if (isStreaming && engine != null) {
+                    engine.feedAudio(audioChunk);
+                }
+            }
         });
     }
 
@@ -358,6 +368,12 @@ public class VoiceInputView extends FrameLayout {
             }
         }, RECORDING_MAX_TIME);
 
+        // Recognize the audio while it is recorded, so that only the end is left when it stops
+        if (recognitionEngine != null && recognitionEngine.supportsStreaming()) {
+            recognitionEngine.startStreaming(languageHint);
+            isStreaming = true;
+        }
+
         // Start recording with VAD
         if (mRecorder != null) {
             mRecorder.initVad(getContext());
@@ -422,6 +438,15 @@ public class VoiceInputView extends FrameLayout {
 
     private void startTranscription() {
         if (recognitionEngine != null) {
+            if (isStreaming) {
+                // The engine already has the recorded audio
+                isStreaming = false;
+                Log.d(TAG, "Finishing streamed recognition");
+                recognitionEngine.finishStreaming();
+                startProcessingTimeout();
+                return;
+            }
+
             // Get audio data from record buffer
             float[] audioData = RecordBuffer.getSamples();
             if (audioData != null && audioData.length > 0) {
@@ -432,25 +457,29 @@ public class VoiceInputView extends FrameLayout {
                 showError(getContext().getString(R.string.voice_no_audio));
             }
 
-            // Cancel any existing timeout
-            if (timeoutRunnable != null) {
-                handler.removeCallbacks(timeoutRunnable);
-            }
-
-            // Add timeout to prevent stuck state
-            timeoutRunnable = () -> {
-                if (isProcessing) {
-                    Log.w(TAG, "Processing timeout after 15 seconds");
-                    showError(getContext().getString(R.string.voice_recognition_error));
-                }
-            };
-            handler.postDelayed(timeoutRunnable, 15000);
+            startProcessingTimeout();
         } else {
             Log.e(TAG, "No recognition engine available");
             showError(getContext().getString(R.string.voice_engine_unavailable));
         }
     }
 
+    private void startProcessingTimeout() {
+        // Cancel any existing timeout
+        if (timeoutRunnable != null) {
+            handler.removeCallbacks(timeoutRunnable);
+        }
+
+        // Add timeout to prevent stuck state
+        timeoutRunnable = () -> {
+            if (isProcessing) {
+                Log.w(TAG, "Processing timeout after 15 seconds");
+                showError(getContext().getString(R.string.voice_recognition_error));
+            }
+        };
+        handler.postDelayed(timeoutRunnable, 15000);
+    }
+
     private void showSuccessAndNotify(String text, String language) {
         isProcessing = false;
 
@@ -512,6 +541,13 @@ public class VoiceInputView extends FrameLayout {
         isRecording = false;
         isProcessing = false;
 
+        if (isStreaming) {
+            isStreaming = false;
+            if (recognitionEngine != null) {
+                recognitionEngine.cancelRecognition();
+            }
+        }
+
         // Cancel timeout if it exists
         if (timeoutRunnable != null) {
             handler.removeCallbacks(timeoutRunnable);
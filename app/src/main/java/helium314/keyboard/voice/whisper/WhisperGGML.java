@@ -5,6 +5,7 @@ import androidx.annotation.Keep;
 
 import java.nio.Buffer;
 import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
 
 /**
  * JNI wrapper for Whisper C++ implementation
@@ -13,7 +14,10 @@ import java.nio.ByteBuffer;
 public class WhisperGGML {
     private static final String TAG = "WhisperGGML";
     private long handle = 0L;
+    // The native model uses its weights in place, so the buffer has to stay mapped while it is open
+    private ByteBuffer modelBuffer;
     private PartialResultCallback partialResultCallback;
+    private byte[] partialResultBytes = new byte[256];
     
     public enum DecodingMode {
         GREEDY(0),
@@ -50,6 +54,35 @@ public class WhisperGGML {
         }
     }
     
+    /**
+     * Weight types a model can be converted to, with their ggml_ftype values
+     */
+    public enum QuantizationType {
+        Q4_0(2),
+        Q4_1(3),
+        Q8_0(7),
+        Q5_0(8),
+        Q5_1(9);
+
+        private final int value;
+
+        QuantizationType(int value) {
+            this.value = value;
+        }
+
+        public int getValue() {
+            return value;
+        }
+    }
+
+    public interface QuantizationProgressCallback {
+        /**
+         * @param progress fraction of the model converted, from 0 to 1
+         * @return false to cancel the conversion
+         */
+        boolean onProgress(float progress);
+    }
+
     public interface PartialResultCallback {
         void onPartialResult(String text);
     }
@@ -79,6 +112,7 @@ public class WhisperGGML {
         if (handle == 0L) {
             throw new InvalidModelException("The Whisper model could not be loaded from the given buffer");
         }
+        this.modelBuffer = modelBuffer;
     }
     
     /**
@@ -93,14 +127,24 @@ public class WhisperGGML {
         }
     }
     
+    /**
+     * Called by the native code with the UTF-8 bytes of the partial result at the start of a direct
+     * buffer that it reuses for every call
+     */
     @Keep
-    private void invokePartialResult(String text) {
-        Log.d(TAG, "invokePartialResult called with: " + text);
-        if (partialResultCallback != null) {
-            partialResultCallback.onPartialResult(text.trim());
-        } else {
+    private void invokePartialResult(ByteBuffer utf8, int length) {
+        if (partialResultCallback == null) {
             Log.w(TAG, "partialResultCallback is null");
+            return;
         }
+        if (partialResultBytes.length < length) {
+            partialResultBytes = new byte[Math.max(length, 2 * partialResultBytes.length)];
+        }
+        utf8.position(0);
+        utf8.get(partialResultBytes, 0, length);
+        String text = new String(partialResultBytes, 0, length, StandardCharsets.UTF_8);
+        Log.d(TAG, "invokePartialResult called with: " + text);
+        partialResultCallback.onPartialResult(text.trim());
     }
     
     /**
@@ -121,7 +165,7 @@ public class WhisperGGML {
         DecodingMode decodingMode,
         boolean suppressNonSpeechTokens
     ) throws BailLanguageException, InferenceCancelledException {
-        return infer(samples, prompt, languages, bailLanguages, decodingMode, suppressNonSpeechTokens, partialResultCallback);
+        return infer(samples, prompt, languages, bailLanguages, decodingMode, suppressNonSpeechTokens, false, partialResultCallback);
     }
     
     /**
@@ -132,6 +176,7 @@ public class WhisperGGML {
      * @param bailLanguages Languages that should trigger model switch
      * @param decodingMode Greedy or beam search
      * @param suppressNonSpeechTokens Whether to suppress symbols
+     * @param speedUp Whether to compress the audio 2x in time before encoding, halving the encoder work
      * @param partialCallback Callback for partial results
      * @return Final transcription result
      * @throws BailLanguageException if a bail language is detected
@@ -144,6 +189,7 @@ public class WhisperGGML {
         String[] bailLanguages,
         DecodingMode decodingMode,
         boolean suppressNonSpeechTokens,
+        boolean speedUp,
         PartialResultCallback partialCallback
     ) throws BailLanguageException, InferenceCancelledException {
         if (handle == 0L) {
@@ -163,6 +209,7 @@ public class WhisperGGML {
         }
         Log.d(TAG, "[VOICE] Decoding mode: " + decodingMode.name() + " (value=" + decodingMode.getValue() + ")");
         Log.d(TAG, "[VOICE] Suppress non-speech tokens: " + suppressNonSpeechTokens);
+        Log.d(TAG, "[VOICE] Speed up: " + speedUp);
 
         this.partialResultCallback = partialCallback;
 
@@ -174,11 +221,72 @@ public class WhisperGGML {
             languages,
             bailLanguages,
             decodingMode.getValue(),
-            suppressNonSpeechTokens
+            suppressNonSpeechTokens,
+            speedUp
         ).trim();
 
         Log.d(TAG, "[VOICE] Native inference returned: \"" + result + "\"");
 
+        return checkResult(result);
+    }
+
+    /**
+     * Start transcribing audio while it is recorded. The audio is given with
+     * {@link #pushAudio(float[])}, partial results go to the partial result callback, and
+     * {@link #finishStream()} returns the transcription.
+     * @param prompt Initial prompt/glossary terms
+     * @param languages Array of allowed language codes (empty = autodetect)
+     * @param bailLanguages Languages that should trigger model switch
+     * @param decodingMode Greedy or beam search
+     * @param suppressNonSpeechTokens Whether to suppress symbols
+     */
+    public void startStream(
+        String prompt,
+        String[] languages,
+        String[] bailLanguages,
+        DecodingMode decodingMode,
+        boolean suppressNonSpeechTokens
+    ) {
+        if (handle == 0L) {
+            throw new IllegalStateException("WhisperGGML has already been closed, cannot stream");
+        }
+
+        Log.d(TAG, "[VOICE] === WhisperGGML.startStream() ===");
+        startStreamNative(handle, prompt, languages, bailLanguages, decodingMode.getValue(),
+            suppressNonSpeechTokens);
+    }
+
+    /**
+     * Add recorded audio to the stream. Decodes the audio received so far every few seconds,
+     * so call it off the recording thread.
+     * @param samples Float array of audio samples (16kHz mono)
+     * @param decode Whether the audio may be decoded now, false while more audio is waiting
+     */
+    public void pushAudio(float[] samples, boolean decode) {
+        if (handle == 0L) {
+            throw new IllegalStateException("WhisperGGML has already been closed, cannot stream");
+        }
+        pushAudioNative(handle, samples, decode);
+    }
+
+    /**
+     * Transcribe the audio that has not been committed yet and end the stream
+     * @return Final transcription result
+     * @throws BailLanguageException if a bail language is detected
+     * @throws InferenceCancelledException if inference was cancelled
+     */
+    public String finishStream() throws BailLanguageException, InferenceCancelledException {
+        if (handle == 0L) {
+            throw new IllegalStateException("WhisperGGML has already been closed, cannot stream");
+        }
+
+        String result = finishStreamNative(handle).trim();
+        Log.d(TAG, "[VOICE] Native stream returned: \"" + result + "\"");
+
+        return checkResult(result);
+    }
+
+    private static String checkResult(String result) throws BailLanguageException, InferenceCancelledException {
         // Check for special cancellation markers
         if (result.contains("<>CANCELLED<>")) {
             if (result.contains("flag")) {
@@ -198,6 +306,56 @@ public class WhisperGGML {
         return result;
     }
     
+    /**
+     * End the stream without transcribing it, releasing its audio. Call it after {@link #cancel()},
+     * which makes a window being decoded stop soon; until then this waits for it.
+     */
+    public void abortStream() {
+        if (handle != 0L) {
+            abortStreamNative(handle);
+        }
+    }
+
+    /**
+     * Run a tiny inference on silence, so that the model pages and compute buffers are touched
+     * before the first real dictation. Only the first call after opening the model or after an idle
+     * eviction (see setIdleTimeout) does any work.
+     */
+    public void warmup() {
+        if (handle != 0L) {
+            warmupNative(handle);
+        }
+    }
+
+    /**
+     * Time this model on synthetic audio: after an untimed warm-up run, every run encodes the audio
+     * and makes nDecode decoder steps. Takes seconds per run, so call it off the main thread.
+     * @param nThreads Threads used by the encoder and decoder
+     * @param audioMs Length of the audio, at most 30 s
+     * @param audioCtx Encoder context, 0 for the full 1500
+     * @param nDecode Decoder steps per run
+     * @param nRuns Timed runs
+     * @return JSON object with the load time and the mel, encode, decode and sample times of every run,
+     *         or with an "error" member
+     */
+    public String bench(int nThreads, int audioMs, int audioCtx, int nDecode, int nRuns) {
+        if (handle == 0L) {
+            throw new IllegalStateException("WhisperGGML has already been closed, cannot bench");
+        }
+        return benchNative(handle, nThreads, audioMs, audioCtx, nDecode, nRuns);
+    }
+
+    /**
+     * Limit how often the partial result callback is called while a recording is transcribed.
+     * The final result is not affected.
+     * @param intervalMs Minimum time between two partial results, 0 for one per decoded token
+     */
+    public void setPartialResultInterval(int intervalMs) {
+        if (handle != 0L) {
+            setPartialResultIntervalNative(handle, intervalMs);
+        }
+    }
+
     /**
      * Cancel ongoing inference
      */
@@ -207,6 +365,31 @@ public class WhisperGGML {
         }
     }
     
+    /**
+     * Free the compute buffers, and the KV caches if releaseKvCache is set. They are allocated again by
+     * the next inference. Does nothing while the model is in use or a stream is open.
+     * @return the number of bytes freed
+     */
+    public long trimMemory(boolean releaseKvCache) {
+        if (handle == 0L) {
+            return 0L;
+        }
+        return trimMemoryNative(handle, releaseKvCache);
+    }
+
+    /**
+     * Free the compute buffers and the KV caches, and let the kernel reclaim the model weights
+     * first, once the model has not been used for timeoutMs. A model that is in use or has a stream
+     * open is not evicted. The next warmup() reads the weights back in and allocates the buffers
+     * again, which is much faster than opening the model again.
+     * @param timeoutMs Idle time before the eviction, 0 to never evict the model
+     */
+    public void setIdleTimeout(int timeoutMs) {
+        if (handle != 0L) {
+            setIdleTimeoutNative(handle, timeoutMs);
+        }
+    }
+
     /**
      * Close and release resources
      */
@@ -214,9 +397,78 @@ public class WhisperGGML {
         if (handle != 0L) {
             closeNative(handle);
             handle = 0L;
+            modelBuffer = null;
         }
     }
     
+    /**
+     * Write a copy of an F16 or F32 model with its weight matrices quantized. This reads the whole
+     * model and takes a while, so it has to run in the background.
+     * @param srcPath Path to the model file
+     * @param dstPath Path of the converted model, which is removed again if the conversion fails
+     * @param type Weight type of the converted model
+     * @param callback Progress callback, may be null
+     * @return true if the converted model was written
+     */
+    public static boolean quantizeModel(String srcPath, String dstPath, QuantizationType type,
+                                        QuantizationProgressCallback callback) {
+        if (!nativeLibraryAvailable) return false;
+        final int res = quantizeModelNative(srcPath, dstPath, type.getValue(), callback);
+        if (res != 0) {
+            Log.w(TAG, "Quantizing " + srcPath + " failed with code " + res);
+        }
+        return res == 0;
+    }
+
+    /**
+     * Same as {@link #quantizeModel(String, String, QuantizationType, QuantizationProgressCallback)}
+     * for a model in a direct buffer, e.g. one mapped from the assets
+     */
+    public static boolean quantizeModel(ByteBuffer modelBuffer, String dstPath, QuantizationType type,
+                                        QuantizationProgressCallback callback) {
+        if (!nativeLibraryAvailable) return false;
+        final int res = quantizeModelFromBufferNative(modelBuffer, dstPath, type.getValue(), callback);
+        if (res != 0) {
+            Log.w(TAG, "Quantizing a model to " + dstPath + " failed with code " + res);
+        }
+        return res == 0;
+    }
+
+    /**
+     * Toggles the systrace sections around the mel, encode and decode phases of the native code,
+     * independently of BinaryDictionary.setNativeTracingEnabled as it is a separate library
+     * @return whether tracing is enabled now, false if ATrace is not available (below API 23)
+     */
+    public static boolean setNativeTracingEnabled(boolean enabled) {
+        if (!nativeLibraryAvailable) return false;
+        return setNativeTracingEnabledNative(enabled);
+    }
+
+    /**
+     * Starts sampling the native code of whisperggml, in the same way and with the same layout
+     * of the profile as BinaryDictionary.startSamplingProfiler, which it cannot run together with
+     * @return whether the profiler is running now
+     */
+    public static boolean startSamplingProfiler(int samplingIntervalUs) {
+        if (!nativeLibraryAvailable) return false;
+        return startSamplingProfilerNative(samplingIntervalUs);
+    }
+
+    public static void stopSamplingProfiler() {
+        if (!nativeLibraryAvailable) return;
+        stopSamplingProfilerNative();
+    }
+
+    /**
+     * Reads the samples since startSamplingProfiler(), see BinaryDictionary.getSamplingProfile.
+     * The PC offsets are relative to the load address of whisperggml.
+     * @return the number of PC offsets written
+     */
+    public static int getSamplingProfile(long[] outPcOffsets, int[] outCounts, long[] outSampleCounts) {
+        if (!nativeLibraryAvailable) return 0;
+        return getSamplingProfileNative(outPcOffsets, outCounts, outSampleCounts);
+    }
+
     @Override
     protected void finalize() throws Throwable {
         close();
@@ -233,8 +485,33 @@ public class WhisperGGML {
         String[] languages,
         String[] bailLanguages,
         int decodingMode,
+        boolean suppressNonSpeechTokens,
+        boolean speedUp
+    );
+    private native void startStreamNative(
+        long handle,
+        String prompt,
+        String[] languages,
+        String[] bailLanguages,
+        int decodingMode,
         boolean suppressNonSpeechTokens
     );
+    private native void pushAudioNative(long handle, float[] samples, boolean decode);
+    private native String finishStreamNative(long handle);
+    private native void abortStreamNative(long handle);
+    private native void warmupNative(long handle);
+    private native String benchNative(long handle, int nThreads, int audioMs, int audioCtx, int nDecode, int nRuns);
+    private native void setPartialResultIntervalNative(long handle, int intervalMs);
     private native void cancelNative(long handle);
+    private native long trimMemoryNative(long handle, boolean releaseKvCache);
+    private native void setIdleTimeoutNative(long handle, int timeoutMs);
     private native void closeNative(long handle);
+    private static native int quantizeModelNative(String srcPath, String dstPath, int ftype,
+                                                  QuantizationProgressCallback callback);
+    private static native int quantizeModelFromBufferNative(Buffer modelBuffer, String dstPath, int ftype,
+                                                            QuantizationProgressCallback callback);
+    private static native boolean setNativeTracingEnabledNative(boolean enabled);
+    private static native boolean startSamplingProfilerNative(int samplingIntervalUs);
+    private static native void stopSamplingProfilerNative();
+    private static native int getSamplingProfileNative(long[] outPcOffsets, int[] outCounts, long[] outSampleCounts);
 }
\ No newline at end of file
@@ -2,12 +2,20 @@ package helium314.keyboard.voice.whisper;
 
 import android.content.Context;
 import android.content.res.AssetFileDescriptor;
+import android.os.Process;
 import android.util.Log;
 
+import java.io.File;
 import java.io.FileInputStream;
 import java.io.IOException;
 import java.nio.ByteBuffer;
 import java.nio.channels.FileChannel;
+import java.util.Collections;
+import java.util.HashSet;
+import java.util.Locale;
+import java.util.Set;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 
 /**
  * Loads Whisper models from assets based on language
@@ -18,6 +26,14 @@ public class WhisperModelLoader {
     private static final String ENGLISH_MODEL_PATH = "voice/voice-input-english-39.bin.tflite";
     private static final String MULTILINGUAL_MODEL_PATH = "voice/voice-input-multilingual-244.bin.tflite";
 
+    // The asset models have F16 weights. They are converted once in the background, and the
+    // converted copy, which decodes much faster, is used from then on.
+    private static final String QUANTIZED_MODEL_DIR = "voice-models";
+    private static final WhisperGGML.QuantizationType QUANTIZATION_TYPE = WhisperGGML.QuantizationType.Q8_0;
+    private static final ExecutorService quantizationExecutor = Executors.newSingleThreadExecutor();
+    // Asset models whose conversion was started by this process
+    private static final Set<String> quantizationStarted = Collections.synchronizedSet(new HashSet<>());
+
     private final Context context;
 
     public WhisperModelLoader(Context context) {
@@ -61,9 +77,66 @@ public class WhisperModelLoader {
      */
     public ByteBuffer loadModelForLanguage(String languageCode) throws IOException {
         String modelPath = getModelPathForLanguage(languageCode);
+        File quantizedModel = getQuantizedModelFile(modelPath);
+        if (quantizedModel.isFile()) {
+            try {
+                return loadModelFromFile(quantizedModel);
+            } catch (IOException e) {
+                Log.w(TAG, "Error loading " + quantizedModel + ", using the asset model", e);
+            }
+        }
+        scheduleQuantization(modelPath, quantizedModel);
         return loadModelFromAssets(modelPath);
     }
 
+    private File getQuantizedModelFile(String assetPath) {
+        String name = new File(assetPath).getName() + "." + QUANTIZATION_TYPE.name().toLowerCase(Locale.ROOT);
+        return new File(new File(context.getFilesDir(), QUANTIZED_MODEL_DIR), name);
+    }
+
+    /**
+     * Convert an asset model in the background, the next load uses the result
+     */
+    private void scheduleQuantization(String assetPath, File target) {
+        if (!WhisperGGML.isNativeLibraryAvailable() || !quantizationStarted.add(assetPath)) {
+            return;
+        }
+        quantizationExecutor.execute(() -> {
+            Process.setThreadPriority(Process.THREAD_PRIORITY_BACKGROUND);
+
+            File dir = target.getParentFile();
+            if (dir == null || (!dir.isDirectory() && !dir.mkdirs())) {
+                Log.w(TAG, "Cannot create " + dir);
+                return;
+            }
+            // written under another name, a process killed halfway leaves no model that looks complete
+            File partial = new File(dir, target.getName() + ".partial");
+            try {
+                ByteBuffer source = loadModelFromAssets(assetPath);
+                final int[] loggedPercent = { 0 };
+                boolean converted = WhisperGGML.quantizeModel(source, partial.getPath(), QUANTIZATION_TYPE, progress -> {
+                    int percent = (int) (progress * 100);
+                    if (percent >= loggedPercent[0] + 10) {
+                        loggedPercent[0] = percent;
+                        Log.d(TAG, "Converting " + assetPath + ": " + percent + "%");
+                    }
+                    return true;
+                });
+                if (converted && partial.renameTo(target)) {
+                    Log.i(TAG, "Converted " + assetPath + " to " + QUANTIZATION_TYPE + " (" + target.length() + " bytes)");
+                } else if (converted) {
+                    Log.w(TAG, "Cannot rename " + partial + " to " + target);
+                }
+            } catch (IOException e) {
+                Log.e(TAG, "Error converting " + assetPath, e);
+            } finally {
+                if (partial.exists() && !partial.delete()) {
+                    Log.w(TAG, "Cannot delete " + partial);
+                }
+            }
+        });
+    }
+
     /**
      * Load model from assets as a memory-mapped ByteBuffer
      * @param assetPath Path to the model in assets
@@ -90,6 +163,18 @@ public class WhisperModelLoader {
         }
     }
 
+    /**
+     * Load a model file as a memory-mapped ByteBuffer
+     */
+    private static ByteBuffer loadModelFromFile(File file) throws IOException {
+        try (FileInputStream inputStream = new FileInputStream(file)) {
+            FileChannel fileChannel = inputStream.getChannel();
+            ByteBuffer buffer = fileChannel.map(FileChannel.MapMode.READ_ONLY, 0, fileChannel.size());
+            Log.d(TAG, "Loaded model from " + file + " (" + fileChannel.size() + " bytes)");
+            return buffer;
+        }
+    }
+
     /**
      * Convert language code to Whisper language format
      * @param languageCode ISO language code (e.g., "en", "es")
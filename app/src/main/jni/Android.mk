@@ -19,6 +19,15 @@ LOCAL_PATH := $(call my-dir)
 # and the shared library that uses libjni_latinime_common_static.
 FLAG_DBG ?= false
 FLAG_DO_PROFILE ?= false
+# Frame pointers for NativeSamplingProfiler, so that samples in libc or libm are attributed to the
+# caller in the library. The offsets it exports are symbolised with the unstripped library of the
+# same build, e.g. llvm-addr2line -C -f -e obj/local/arm64-v8a/libjni_latinime.so <offset>.
+FLAG_SAMPLING_PROFILE ?= false
+# Profile-guided optimisation, see NativePgo.mk. FLAG_PGO_GENERATE builds the instrumented
+# libraries and the benchmarks that train them, FLAG_PGO_USE the optimised release libraries.
+FLAG_PGO_GENERATE ?= false
+FLAG_PGO_USE ?= false
+LATINIME_PGO_PROFILE_DIR ?= $(LOCAL_PATH)/pgo
 
 ######################################
 include $(CLEAR_VARS)
@@ -60,6 +69,11 @@ endif # FLAG_FULL_DBG
 endif # FLAG_DBG
 endif # FLAG_DO_PROFILE
 
+ifeq ($(FLAG_SAMPLING_PROFILE), true)
+    $(warning Making sampling profiler version of native library)
+    LOCAL_CFLAGS += -DFLAG_SAMPLING_PROFILE -fno-omit-frame-pointer -mno-omit-leaf-frame-pointer
+endif # FLAG_SAMPLING_PROFILE
+
 LOCAL_MODULE := libjni_latinime_common_static
 LOCAL_MODULE_TAGS := optional
 
@@ -67,6 +81,9 @@ LOCAL_CLANG := true
 LOCAL_SDK_VERSION := 14
 LOCAL_NDK_STL_VARIANT := c++_static
 
+LATINIME_PGO_PROFILE := latinime
+include $(LOCAL_PATH)/NativePgo.mk
+
 include $(BUILD_STATIC_LIBRARY)
 ######################################
 include $(CLEAR_VARS)
@@ -95,7 +112,33 @@ LOCAL_LDFLAGS += -ldl
 # Avoid issues with reproducible builds, see https://gitlab.com/fdroid/rfp/-/issues/2662
 LOCAL_LDFLAGS += -Wl,--build-id=none
 
+LATINIME_PGO_PROFILE := latinime
+include $(LOCAL_PATH)/NativePgo.mk
+
 include $(BUILD_SHARED_LIBRARY)
+######################################
+ifeq ($(FLAG_PGO_GENERATE), true)
+# The keystroke replay benchmark on the instrumented core, run on a device by pgo-train.sh to
+# collect the profile of libjni_latinime. See suggest_bench.cpp.
+include $(CLEAR_VARS)
+
+LOCAL_WHOLE_STATIC_LIBRARIES := libjni_latinime_common_static
+LOCAL_C_INCLUDES += $(LOCAL_PATH)/src
+LOCAL_SRC_FILES := suggest_bench.cpp
+LOCAL_CFLAGS += -Wno-unused-parameter -Wno-unused-function
+
+LOCAL_MODULE := latinime_suggest_bench
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_CLANG := true
+LOCAL_SDK_VERSION := 21
+LOCAL_NDK_STL_VARIANT := c++_static
+
+LATINIME_PGO_PROFILE := latinime
+include $(LOCAL_PATH)/NativePgo.mk
+
+include $(BUILD_EXECUTABLE)
+endif # FLAG_PGO_GENERATE
 #################### Clean up the tmp vars
 include $(LOCAL_PATH)/CleanupNativeFileList.mk
 
@@ -11,7 +11,9 @@ LOCAL_SRC_FILES := \
     src/ggml/ggml-alloc.c \
     src/ggml/ggml-backend.c \
     src/ggml/ggml-quants.c \
-    src/jni_utils.cpp
+    src/jni_utils.cpp \
+    src/utils/native_sampling_profiler.cpp \
+    src/utils/native_trace.cpp
 
 LOCAL_C_INCLUDES := \
     $(LOCAL_PATH) \
@@ -21,9 +23,14 @@ LOCAL_C_INCLUDES := \
 LOCAL_CFLAGS := -O3 -DNDEBUG -Wall -Wextra -Wno-unused-parameter -ffast-math -DFLAG_DO_PROFILE
 LOCAL_CPPFLAGS := -std=c++11 -fexceptions
 
-# For ARM NEON optimizations
+# See FLAG_SAMPLING_PROFILE in Android.mk
+ifeq ($(FLAG_SAMPLING_PROFILE), true)
+    LOCAL_CFLAGS += -DFLAG_SAMPLING_PROFILE -fno-omit-frame-pointer -mno-omit-leaf-frame-pointer
+endif
+
+# Baseline ARMv8-A so the library loads on every arm64 device, ggml picks fp16 and dotprod kernels at runtime
 ifeq ($(TARGET_ARCH), arm64-v8a)
-    LOCAL_CFLAGS += -march=armv8-a+fp16
+    LOCAL_CFLAGS += -march=armv8-a
 endif
 
 LOCAL_LDLIBS := -llog -landroid -ldl
@@ -32,4 +39,46 @@ LOCAL_CLANG := true
 LOCAL_SDK_VERSION := 21
 LOCAL_NDK_STL_VARIANT := c++_static
 
-include $(BUILD_SHARED_LIBRARY)
\ No newline at end of file
+LATINIME_PGO_PROFILE := whisperggml
+include $(LOCAL_PATH)/NativePgo.mk
+
+include $(BUILD_SHARED_LIBRARY)
+
+# Command line benchmark of the same sources, pushed to a device with adb, see whisper_bench.cpp.
+# Its profile trains whisperggml, see pgo-train.sh.
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := whisper_bench
+
+LOCAL_SRC_FILES := \
+    whisper_bench.cpp \
+    src/ggml/whisper.cpp \
+    src/ggml/ggml.c \
+    src/ggml/ggml-alloc.c \
+    src/ggml/ggml-backend.c \
+    src/ggml/ggml-quants.c \
+    src/utils/native_sampling_profiler.cpp \
+    src/utils/native_trace.cpp
+
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH) \
+    $(LOCAL_PATH)/src \
+    $(LOCAL_PATH)/src/ggml
+
+LOCAL_CFLAGS := -O3 -DNDEBUG -Wall -Wextra -Wno-unused-parameter -ffast-math
+LOCAL_CPPFLAGS := -std=c++11 -fexceptions
+
+ifeq ($(TARGET_ARCH), arm64-v8a)
+    LOCAL_CFLAGS += -march=armv8-a
+endif
+
+LOCAL_LDLIBS := -llog -ldl
+
+LOCAL_CLANG := true
+LOCAL_SDK_VERSION := 21
+LOCAL_NDK_STL_VARIANT := c++_static
+
+LATINIME_PGO_PROFILE := whisperggml
+include $(LOCAL_PATH)/NativePgo.mk
+
+include $(BUILD_EXECUTABLE)
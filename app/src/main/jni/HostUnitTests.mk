@@ -52,6 +52,44 @@ LOCAL_SRC_FILES := $(addprefix $(LATIN_IME_TEST_SRC_DIR)/, $(LATIN_IME_CORE_TEST
 LOCAL_STATIC_LIBRARIES += liblatinime_host_static_for_unittests
 include $(BUILD_HOST_NATIVE_TEST)
 
+#################### Host suggestion benchmark
+# Built without the sanitizer and with the core sources directly, so the latencies are realistic.
+include $(CLEAR_VARS)
+LOCAL_CFLAGS += -O2 -Wno-unused-parameter -Wno-unused-function
+LOCAL_CLANG := true
+LOCAL_CXX_STL := libc++
+LOCAL_C_INCLUDES += $(LOCAL_PATH)/$(LATIN_IME_SRC_DIR)
+LOCAL_MODULE := latinime_suggest_bench
+LOCAL_MODULE_TAGS := optional
+LOCAL_SRC_FILES := suggest_bench.cpp \
+    $(addprefix $(LATIN_IME_SRC_DIR)/, $(LATIN_IME_CORE_SRC_FILES))
+include $(BUILD_HOST_EXECUTABLE)
+
+#################### Host dictionary structure policy benchmark
+include $(CLEAR_VARS)
+LOCAL_CFLAGS += -O2 -Wno-unused-parameter -Wno-unused-function
+LOCAL_CLANG := true
+LOCAL_CXX_STL := libc++
+LOCAL_C_INCLUDES += $(LOCAL_PATH)/$(LATIN_IME_SRC_DIR)
+LOCAL_MODULE := latinime_dict_bench
+LOCAL_MODULE_TAGS := optional
+LOCAL_SRC_FILES := dict_bench.cpp \
+    $(addprefix $(LATIN_IME_SRC_DIR)/, $(LATIN_IME_CORE_SRC_FILES))
+include $(BUILD_HOST_EXECUTABLE)
+
+#################### Host replay of the dictionary format fuzzer corpora
+# The fuzzers themselves are cc_fuzz modules in Android.bp.
+include $(CLEAR_VARS)
+LOCAL_CFLAGS += -O2 -Wno-unused-parameter -Wno-unused-function
+LOCAL_CLANG := true
+LOCAL_CXX_STL := libc++
+LOCAL_C_INCLUDES += $(LOCAL_PATH)/$(LATIN_IME_SRC_DIR)
+LOCAL_MODULE := latinime_dict_corpus_bench
+LOCAL_MODULE_TAGS := optional
+LOCAL_SRC_FILES := fuzzers/dict_corpus_bench.cpp fuzzers/dict_fuzz_utils.cpp \
+    $(addprefix $(LATIN_IME_SRC_DIR)/, $(LATIN_IME_CORE_SRC_FILES))
+include $(BUILD_HOST_EXECUTABLE)
+
 include $(LOCAL_PATH)/CleanupNativeFileList.mk
 
 endif # Darwin - TODO: Remove this
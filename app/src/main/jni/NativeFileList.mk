@@ -36,6 +36,8 @@ LATIN_IME_CORE_SRC_FILES := \
         shortcut/shortcut_list_reading_utils.cpp) \
     $(addprefix dictionary/structure/v2/, \
         patricia_trie_policy.cpp \
+        ver2_child_edge_index.cpp \
+        ver2_folded_word_index.cpp \
         ver2_patricia_trie_node_reader.cpp \
         ver2_pt_node_array_reader.cpp) \
     $(addprefix dictionary/structure/v4/, \
@@ -46,7 +48,8 @@ LATIN_IME_CORE_SRC_FILES := \
         ver4_patricia_trie_policy.cpp \
         ver4_patricia_trie_reading_utils.cpp \
         ver4_patricia_trie_writing_helper.cpp \
-        ver4_pt_node_array_reader.cpp) \
+        ver4_pt_node_array_reader.cpp \
+        ver4_top_level_pt_node_cache.cpp) \
     $(addprefix dictionary/structure/v4/content/, \
         dynamic_language_model_probability_utils.cpp \
         language_model_dict_content.cpp \
@@ -58,39 +61,63 @@ LATIN_IME_CORE_SRC_FILES := \
         buffer_with_extendable_buffer.cpp \
         byte_array_utils.cpp \
         dict_file_writing_utils.cpp \
+        dict_migration_utils.cpp \
         file_utils.cpp \
         forgetting_curve_utils.cpp \
         format_utils.cpp \
         mmapped_buffer.cpp \
         multi_bigram_map.cpp \
+        ngram_context_map.cpp \
         probability_utils.cpp \
         sparse_table.cpp \
         trie_map.cpp ) \
     suggest/core/suggest.cpp \
     $(addprefix suggest/core/dicnode/, \
+        child_dic_node_filter.cpp \
         dic_node.cpp \
+        dic_node_slab_allocator.cpp \
         dic_node_utils.cpp \
         dic_nodes_cache.cpp) \
     $(addprefix suggest/core/dictionary/, \
+        completion_cache.cpp \
         dictionary.cpp \
+        dictionary_opener.cpp \
+        dictionary_update_log.cpp \
         dictionary_utils.cpp \
         digraph_utils.cpp \
-        error_type_utils.cpp ) \
+        error_type_utils.cpp \
+        prediction_cache.cpp \
+        spell_check_utils.cpp ) \
     $(addprefix suggest/core/layout/, \
         additional_proximity_chars.cpp \
         proximity_info.cpp \
+        proximity_info_cache.cpp \
         proximity_info_params.cpp \
+        proximity_info_simd_utils.cpp \
         proximity_info_state.cpp \
-        proximity_info_state_utils.cpp) \
+        proximity_info_state_utils.cpp \
+        touch_position_model.cpp) \
     suggest/core/policy/weighting.cpp \
-    suggest/core/session/dic_traverse_session.cpp \
+    $(addprefix suggest/core/session/, \
+        dic_traverse_session.cpp \
+        dic_traverse_session_pool.cpp \
+        word_attributes_cache.cpp) \
     $(addprefix suggest/core/result/, \
         suggestion_results.cpp \
         suggestions_output_utils.cpp) \
-    suggest/policyimpl/gesture/gesture_suggest_policy_factory.cpp \
+    $(addprefix suggest/policyimpl/gesture/, \
+        gesture_scoring.cpp \
+        gesture_suggest_policy.cpp \
+        gesture_suggest_policy_factory.cpp \
+        gesture_traversal.cpp \
+        gesture_weighting.cpp \
+        scoring_params_g.cpp) \
     $(addprefix suggest/policyimpl/typing/, \
         scoring_params.cpp \
+        typing_beam_width_tuner.cpp \
+        typing_latency_guard.cpp \
         typing_scoring.cpp \
+        typing_segmentation.cpp \
         typing_suggest_policy.cpp \
         typing_traversal.cpp \
         typing_weighting.cpp) \
@@ -99,7 +126,11 @@ LATIN_IME_CORE_SRC_FILES := \
         char_utils.cpp \
         jni_data_utils.cpp \
         log_utils.cpp \
-        time_keeper.cpp)
+        native_metrics.cpp \
+        native_sampling_profiler.cpp \
+        native_trace.cpp \
+        time_keeper.cpp \
+        worker_thread_pool.cpp)
 
 LATIN_IME_CORE_SRC_FILES_BACKWARD_V402 := \
     $(addprefix dictionary/structure/backward/v402/, \
@@ -125,22 +156,64 @@ LATIN_IME_CORE_SRC_FILES += $(LATIN_IME_CORE_SRC_FILES_BACKWARD_V402)
 LATIN_IME_CORE_TEST_FILES := \
     defines_test.cpp \
     dictionary/header/header_read_write_utils_test.cpp \
+    dictionary/interface/ngram_listener_test.cpp \
+    dictionary/property/ngram_context_test.cpp \
+    dictionary/structure/pt_common/dynamic_pt_reading_helper_test.cpp \
+    dictionary/structure/pt_common/dynamic_pt_updating_helper_test.cpp \
+    dictionary/structure/v2/ver2_child_edge_index_test.cpp \
+    dictionary/structure/v2/ver2_folded_word_index_test.cpp \
     dictionary/structure/v4/content/language_model_dict_content_test.cpp \
     dictionary/structure/v4/content/language_model_dict_content_global_counters_test.cpp \
     dictionary/structure/v4/content/probability_entry_test.cpp \
     dictionary/structure/v4/content/terminal_position_lookup_table_test.cpp \
+    dictionary/structure/v4/ver4_patricia_trie_policy_test.cpp \
+    dictionary/structure/v4/ver4_top_level_pt_node_cache_test.cpp \
     dictionary/utils/bloom_filter_test.cpp \
     dictionary/utils/buffer_with_extendable_buffer_test.cpp \
     dictionary/utils/byte_array_utils_test.cpp \
+    dictionary/utils/dict_migration_utils_test.cpp \
     dictionary/utils/format_utils_test.cpp \
+    dictionary/utils/multi_bigram_map_test.cpp \
+    dictionary/utils/ngram_context_map_test.cpp \
     dictionary/utils/probability_utils_test.cpp \
     dictionary/utils/sparse_table_test.cpp \
     dictionary/utils/trie_map_test.cpp \
+    suggest/core/dicnode/child_dic_node_filter_test.cpp \
     suggest/core/dicnode/dic_node_pool_test.cpp \
+    suggest/core/dicnode/dic_node_priority_queue_test.cpp \
+    suggest/core/dicnode/dic_node_slab_allocator_test.cpp \
+    suggest/core/dicnode/dic_node_test.cpp \
+    suggest/core/dicnode/dic_nodes_cache_test.cpp \
+    suggest/core/dictionary/completion_cache_test.cpp \
+    suggest/core/dictionary/dictionary_opener_test.cpp \
+    suggest/core/dictionary/dictionary_test.cpp \
+    suggest/core/dictionary/dictionary_update_log_test.cpp \
+    suggest/core/dictionary/dictionary_utils_test.cpp \
+    suggest/core/dictionary/digraph_utils_test.cpp \
+    suggest/core/dictionary/prediction_cache_test.cpp \
+    suggest/core/dictionary/spell_check_utils_test.cpp \
     suggest/core/layout/geometry_utils_test.cpp \
     suggest/core/layout/normal_distribution_2d_test.cpp \
+    suggest/core/layout/proximity_info_cache_test.cpp \
+    suggest/core/layout/proximity_info_simd_utils_test.cpp \
+    suggest/core/layout/proximity_info_state_test.cpp \
+    suggest/core/layout/touch_position_model_test.cpp \
+    suggest/core/result/suggestion_results_test.cpp \
+    suggest/core/session/dic_traverse_session_pool_test.cpp \
+    suggest/core/session/expansion_workspace_test.cpp \
+    suggest/core/session/word_attributes_cache_test.cpp \
+    suggest/policyimpl/gesture/gesture_suggest_policy_test.cpp \
+    suggest/policyimpl/typing/typing_beam_width_tuner_test.cpp \
+    suggest/policyimpl/typing/typing_latency_guard_test.cpp \
+    suggest/policyimpl/typing/typing_search_costs_test.cpp \
+    suggest/policyimpl/typing/typing_segmentation_test.cpp \
     suggest/policyimpl/utils/damerau_levenshtein_edit_distance_policy_test.cpp \
+    utils/allocation_counter.cpp \
     utils/autocorrection_threshold_utils_test.cpp \
     utils/char_utils_test.cpp \
     utils/int_array_view_test.cpp \
-    utils/time_keeper_test.cpp
+    utils/native_metrics_test.cpp \
+    utils/native_sampling_profiler_test.cpp \
+    utils/native_trace_test.cpp \
+    utils/time_keeper_test.cpp \
+    utils/worker_thread_pool_test.cpp
@@ -0,0 +1,41 @@
+# Copyright (C) 2026 The HeliBoard Contributors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Profile-guided optimisation flags of the module being defined. Include it right before the
+# module's include $(BUILD_...), after setting LATINIME_PGO_PROFILE to the name of its profile in
+# LATINIME_PGO_PROFILE_DIR. The profiles are collected by pgo-train.sh.
+#
+# With FLAG_PGO_GENERATE, the module is instrumented and writes a raw profile on exit.
+# With FLAG_PGO_USE, the module is optimised with its merged profile and ThinLTO. A missing profile
+# is not an error, the module is then built as usual.
+
+ifeq ($(FLAG_PGO_GENERATE), true)
+    LOCAL_CFLAGS += -fprofile-generate
+    LOCAL_LDFLAGS += -fprofile-generate
+else ifeq ($(FLAG_PGO_USE), true)
+    LATINIME_PGO_PROFILE_PATH := $(LATINIME_PGO_PROFILE_DIR)/$(LATINIME_PGO_PROFILE).profdata
+ifneq ($(wildcard $(LATINIME_PGO_PROFILE_PATH)),)
+    # The profiles are allowed to lag behind the sources a little; functions that changed since
+    # are simply optimised without their profile.
+    # Expanded right away, LATINIME_PGO_PROFILE_PATH is reused by the next module.
+    LOCAL_CFLAGS := $(LOCAL_CFLAGS) -fprofile-use=$(LATINIME_PGO_PROFILE_PATH) -flto=thin \
+        -Wno-profile-instr-out-of-date -Wno-profile-instr-unprofiled -Wno-backend-plugin
+    LOCAL_LDFLAGS += -flto=thin
+else # wildcard
+    $(warning No $(LATINIME_PGO_PROFILE_PATH), building $(LOCAL_MODULE) without PGO)
+endif # wildcard
+endif # FLAG_PGO_GENERATE
+
+LATINIME_PGO_PROFILE :=
+LATINIME_PGO_PROFILE_PATH :=
@@ -18,10 +18,16 @@
 
 #include "com_android_inputmethod_keyboard_ProximityInfo.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "defines.h"
 #include "jni.h"
 #include "jni_common.h"
 #include "suggest/core/layout/proximity_info.h"
+#include "suggest/core/layout/proximity_info_cache.h"
+#include "suggest/core/layout/touch_position_model.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 
@@ -31,16 +37,56 @@ static jlong latinime_Keyboard_setProximityInfo(JNIEnv *env, jclass clazz,
         jintArray keyXCoordinates, jintArray keyYCoordinates, jintArray keyWidths,
         jintArray keyHeights, jintArray keyCharCodes, jfloatArray sweetSpotCenterXs,
         jfloatArray sweetSpotCenterYs, jfloatArray sweetSpotRadii) {
-    ProximityInfo *proximityInfo = new ProximityInfo(env, displayWidth, displayHeight,
-            gridWidth, gridHeight, mostCommonkeyWidth, mostCommonkeyHeight, proximityChars,
-            keyCount, keyXCoordinates, keyYCoordinates, keyWidths, keyHeights, keyCharCodes,
-            sweetSpotCenterXs, sweetSpotCenterYs, sweetSpotRadii);
+    // Keyboards with the same geometry share one instance.
+    ProximityInfo *proximityInfo = ProximityInfoCache::getInstance()->acquire(env, displayWidth,
+            displayHeight, gridWidth, gridHeight, mostCommonkeyWidth, mostCommonkeyHeight,
+            proximityChars, keyCount, keyXCoordinates, keyYCoordinates, keyWidths, keyHeights,
+            keyCharCodes, sweetSpotCenterXs, sweetSpotCenterYs, sweetSpotRadii);
     return reinterpret_cast<jlong>(proximityInfo);
 }
 
 static void latinime_Keyboard_release(JNIEnv *env, jclass clazz, jlong proximityInfo) {
     ProximityInfo *pi = reinterpret_cast<ProximityInfo *>(proximityInfo);
-    delete pi;
+    ProximityInfoCache::getInstance()->release(pi);
+}
+
+// Copies the MemoryUsage of the proximity info to outBytes and returns how many values were
+// copied. Keyboards with the same geometry report the same shared instance.
+static jint latinime_Keyboard_getMemoryUsage(JNIEnv *env, jclass clazz, jlong proximityInfo,
+        jlongArray outBytes) {
+    ProximityInfo *pi = reinterpret_cast<ProximityInfo *>(proximityInfo);
+    if (!pi) {
+        return 0;
+    }
+    MemoryUsage memoryUsage;
+    pi->addMemoryUsage(&memoryUsage);
+    int64_t bytes[MemoryUsage::CATEGORY_COUNT];
+    memoryUsage.copyTo(bytes);
+    const int valueCount = std::min(static_cast<int>(env->GetArrayLength(outBytes)),
+            static_cast<int>(MemoryUsage::CATEGORY_COUNT));
+    env->SetLongArrayRegion(outBytes, 0 /* start */, valueCount,
+            reinterpret_cast<const jlong *>(bytes));
+    return valueCount;
+}
+
+static void latinime_Keyboard_learnTouchPositions(JNIEnv *env, jclass clazz, jlong proximityInfo,
+        jintArray xCoordinatesArray, jintArray yCoordinatesArray, jintArray codePointsArray,
+        jint inputSize) {
+    const ProximityInfo *const pi = reinterpret_cast<ProximityInfo *>(proximityInfo);
+    if (!pi || inputSize <= 0 || inputSize > MAX_WORD_LENGTH
+            || env->GetArrayLength(xCoordinatesArray) < inputSize
+            || env->GetArrayLength(yCoordinatesArray) < inputSize
+            || env->GetArrayLength(codePointsArray) < inputSize) {
+        return;
+    }
+    int xCoordinates[MAX_WORD_LENGTH];
+    int yCoordinates[MAX_WORD_LENGTH];
+    int codePoints[MAX_WORD_LENGTH];
+    env->GetIntArrayRegion(xCoordinatesArray, 0, inputSize, xCoordinates);
+    env->GetIntArrayRegion(yCoordinatesArray, 0, inputSize, yCoordinates);
+    env->GetIntArrayRegion(codePointsArray, 0, inputSize, codePoints);
+    TouchPositionModel::getInstance()->learn(pi, xCoordinates, yCoordinates, codePoints,
+            inputSize);
 }
 
 static const JNINativeMethod sMethods[] = {
@@ -53,6 +99,16 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("releaseProximityInfoNative"),
         const_cast<char *>("(J)V"),
         reinterpret_cast<void *>(latinime_Keyboard_release)
+    },
+    {
+        const_cast<char *>("getMemoryUsageNative"),
+        const_cast<char *>("(J[J)I"),
+        reinterpret_cast<void *>(latinime_Keyboard_getMemoryUsage)
+    },
+    {
+        const_cast<char *>("learnTouchPositionsNative"),
+        const_cast<char *>("(J[I[I[II)V"),
+        reinterpret_cast<void *>(latinime_Keyboard_learnTouchPositions)
     }
 };
 
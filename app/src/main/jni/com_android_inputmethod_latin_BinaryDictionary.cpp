@@ -18,7 +18,11 @@
 
 #include "com_android_inputmethod_latin_BinaryDictionary.h"
 
-#include <cstring> // for memset()
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring> // for memset() and memcpy()
+#include <memory>
 #include <vector>
 
 #include "defines.h"
@@ -26,15 +30,24 @@
 #include "dictionary/property/ngram_context.h"
 #include "dictionary/property/word_property.h"
 #include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/utils/dict_migration_utils.h"
 #include "jni.h"
 #include "jni_common.h"
 #include "suggest/core/dictionary/dictionary.h"
+#include "suggest/core/dictionary/dictionary_opener.h"
+#include "suggest/core/dictionary/spell_check_utils.h"
 #include "suggest/core/result/suggestion_results.h"
+#include "suggest/core/session/dic_traverse_session.h"
+#include "suggest/core/session/search_effort.h"
 #include "suggest/core/suggest_options.h"
 #include "utils/char_utils.h"
 #include "utils/int_array_view.h"
 #include "utils/jni_data_utils.h"
 #include "utils/log_utils.h"
+#include "utils/memory_usage.h"
+#include "utils/native_metrics.h"
+#include "utils/native_sampling_profiler.h"
+#include "utils/native_trace.h"
 #include "utils/profiler.h"
 #include "utils/time_keeper.h"
 
@@ -46,6 +59,7 @@ static jlong latinime_BinaryDictionary_open(JNIEnv *env, jclass clazz, jstring s
         jlong dictOffset, jlong dictSize, jboolean isUpdatable) {
     PROF_INIT;
     PROF_TIMER_START(66);
+    const NativeTrace::ScopedSection section("BinaryDictionary::open");
     const jsize sourceDirUtf8Length = env->GetStringUTFLength(sourceDir);
     if (sourceDirUtf8Length <= 0) {
         AKLOGE("DICT: Can't get sourceDir string");
@@ -54,18 +68,68 @@ static jlong latinime_BinaryDictionary_open(JNIEnv *env, jclass clazz, jstring s
     char sourceDirChars[sourceDirUtf8Length + 1];
     env->GetStringUTFRegion(sourceDir, 0, env->GetStringLength(sourceDir), sourceDirChars);
     sourceDirChars[sourceDirUtf8Length] = '\0';
-    DictionaryStructureWithBufferPolicy::StructurePolicyPtr dictionaryStructureWithBufferPolicy(
-            DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(
-                    sourceDirChars, static_cast<int>(dictOffset), static_cast<int>(dictSize),
-                    isUpdatable == JNI_TRUE));
-    if (!dictionaryStructureWithBufferPolicy) {
+    Dictionary *const dictionary = DictionaryOpener::openDictionary(env,
+            DictionaryOpener::DictionaryFile(sourceDirChars, static_cast<int>(dictOffset),
+                    static_cast<int>(dictSize), isUpdatable == JNI_TRUE)).release();
+    PROF_TIMER_END(66);
+    return reinterpret_cast<jlong>(dictionary);
+}
+
+static jlong latinime_BinaryDictionary_openSnapshot(JNIEnv *env, jclass clazz,
+        jstring sourceDir) {
+    const jsize sourceDirUtf8Length = env->GetStringUTFLength(sourceDir);
+    if (sourceDirUtf8Length <= 0) {
+        AKLOGE("DICT: Can't get sourceDir string");
         return 0;
     }
+    char sourceDirChars[sourceDirUtf8Length + 1];
+    env->GetStringUTFRegion(sourceDir, 0, env->GetStringLength(sourceDir), sourceDirChars);
+    sourceDirChars[sourceDirUtf8Length] = '\0';
+    return reinterpret_cast<jlong>(
+            DictionaryOpener::openSnapshot(env, sourceDirChars).release());
+}
 
-    Dictionary *const dictionary =
-            new Dictionary(env, std::move(dictionaryStructureWithBufferPolicy));
-    PROF_TIMER_END(66);
-    return reinterpret_cast<jlong>(dictionary);
+// Opens the dictionaries of the given files in parallel and writes their handles to outDicts, 0
+// for the ones that can't be opened.
+static void latinime_BinaryDictionary_openMany(JNIEnv *env, jclass clazz,
+        jobjectArray sourceDirs, jlongArray dictOffsets, jlongArray dictSizes,
+        jbooleanArray isUpdatables, jlongArray outDicts) {
+    const NativeTrace::ScopedSection section("BinaryDictionary::openMany");
+    const jsize dictCount = env->GetArrayLength(sourceDirs);
+    if (env->GetArrayLength(dictOffsets) != dictCount || env->GetArrayLength(dictSizes) != dictCount
+            || env->GetArrayLength(isUpdatables) != dictCount
+            || env->GetArrayLength(outDicts) != dictCount) {
+        AKLOGE("Invalid array lengths for openMany: %d", dictCount);
+        ASSERT(false);
+        return;
+    }
+    std::vector<jlong> offsets(dictCount);
+    env->GetLongArrayRegion(dictOffsets, 0 /* start */, dictCount, offsets.data());
+    std::vector<jlong> sizes(dictCount);
+    env->GetLongArrayRegion(dictSizes, 0 /* start */, dictCount, sizes.data());
+    std::vector<jboolean> updatables(dictCount);
+    env->GetBooleanArrayRegion(isUpdatables, 0 /* start */, dictCount, updatables.data());
+    std::vector<DictionaryOpener::DictionaryFile> dictionaryFiles;
+    dictionaryFiles.reserve(dictCount);
+    for (jsize i = 0; i < dictCount; ++i) {
+        jstring sourceDir = static_cast<jstring>(env->GetObjectArrayElement(sourceDirs, i));
+        const jsize sourceDirUtf8Length = env->GetStringUTFLength(sourceDir);
+        char sourceDirChars[sourceDirUtf8Length + 1];
+        env->GetStringUTFRegion(sourceDir, 0, env->GetStringLength(sourceDir), sourceDirChars);
+        sourceDirChars[sourceDirUtf8Length] = '\0';
+        env->DeleteLocalRef(sourceDir);
+        // An empty path can't be opened and leaves its handle at 0.
+        dictionaryFiles.emplace_back(static_cast<const char *>(sourceDirChars),
+                static_cast<int>(offsets[i]), static_cast<int>(sizes[i]),
+                updatables[i] == JNI_TRUE);
+    }
+    std::vector<std::unique_ptr<Dictionary>> dictionaries;
+    DictionaryOpener::openDictionaries(env, dictionaryFiles, &dictionaries);
+    std::vector<jlong> dicts(dictCount);
+    for (jsize i = 0; i < dictCount; ++i) {
+        dicts[i] = reinterpret_cast<jlong>(dictionaries[i].release());
+    }
+    env->SetLongArrayRegion(outDicts, 0 /* start */, dictCount, dicts.data());
 }
 
 static jlong latinime_BinaryDictionary_createOnMemory(JNIEnv *env, jclass clazz,
@@ -91,8 +155,16 @@ static jlong latinime_BinaryDictionary_createOnMemory(JNIEnv *env, jclass clazz,
     if (!dictionaryStructureWithBufferPolicy) {
         return 0;
     }
-    Dictionary *const dictionary =
-            new Dictionary(env, std::move(dictionaryStructureWithBufferPolicy));
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr replicaStructurePolicy =
+            DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
+                    formatVersion, localeCodePoints, &attributeMap);
+    if (!replicaStructurePolicy) {
+        AKLOGE("Cannot create the replica of the dictionary.");
+        return 0;
+    }
+    Dictionary *const dictionary = new Dictionary(env,
+            std::move(dictionaryStructureWithBufferPolicy), std::move(replicaStructurePolicy),
+            false /* usesLargeTraverseSessionCache */);
     return reinterpret_cast<jlong>(dictionary);
 }
 
@@ -191,11 +263,10 @@ static void latinime_BinaryDictionary_getSuggestions(JNIEnv *env, jclass clazz,
         return;
     }
     ProximityInfo *pInfo = reinterpret_cast<ProximityInfo *>(proximityInfo);
+    // When no session is given, the dictionary leases one from its session pool. This allows
+    // concurrent calls on the same dictionary from different threads.
     DicTraverseSession *traverseSession =
             reinterpret_cast<DicTraverseSession *>(dicTraverseSession);
-    if (!traverseSession) {
-        return;
-    }
     // Input values
     int xCoordinates[inputSize];
     int yCoordinates[inputSize];
@@ -260,6 +331,119 @@ static void latinime_BinaryDictionary_getSuggestions(JNIEnv *env, jclass clazz,
             outAutoCommitFirstWordConfidenceArray, inOutWeightOfLangModelVsSpatialModel);
 }
 
+// Layout of the direct buffers of getSuggestionsWithBuffersNative. Both consist of native order
+// 32-bit ints and must be kept in sync with DicTraverseSession.java.
+//
+// Input buffer, a struct of arrays sized by its header:
+//   [0] input size (n), [1] input code point count (c),
+//   then x coordinates[n], y coordinates[n], times[n], pointer ids[n], input code points[c].
+// Output buffer, fixed size:
+//   [0] suggestion count, [1] auto-commit first word confidence,
+//   [2] weight of language model vs spatial model as float bits (in/out),
+//   then code points[MAX_RESULTS * MAX_WORD_LENGTH], scores[MAX_RESULTS],
+//   space indices[MAX_RESULTS], types[MAX_RESULTS],
+//   then the search effort counters[SearchEffort::COUNTER_COUNT], all 0 for predictions.
+static const int SUGGESTION_BUFFER_INPUT_HEADER_SIZE = 2;
+static const int SUGGESTION_BUFFER_OUTPUT_HEADER_SIZE = 3;
+static const int SUGGESTION_BUFFER_OUTPUT_SIZE = SUGGESTION_BUFFER_OUTPUT_HEADER_SIZE
+        + MAX_RESULTS * MAX_WORD_LENGTH
+        + MAX_RESULTS * 3 /* scores, space indices, types */ + SearchEffort::COUNTER_COUNT;
+
+// Returns the int view of the given direct buffer, or nullptr when it isn't a direct buffer with
+// room for minIntCount ints.
+static int *getDirectIntBuffer(JNIEnv *env, jobject buffer, const jlong minIntCount) {
+    void *const address = env->GetDirectBufferAddress(buffer);
+    if (!address) {
+        AKLOGE("Not a direct buffer.");
+        return nullptr;
+    }
+    if (reinterpret_cast<uintptr_t>(address) % alignof(int) != 0) {
+        AKLOGE("Misaligned direct buffer.");
+        return nullptr;
+    }
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (capacity < minIntCount * static_cast<jlong>(sizeof(int))) {
+        AKLOGE("Direct buffer is too small: %lld bytes, %lld ints required.",
+                static_cast<long long>(capacity), static_cast<long long>(minIntCount));
+        return nullptr;
+    }
+    return static_cast<int *>(address);
+}
+
+// Same as getSuggestions, but the input and output are read and written in place in the given
+// direct buffers. See above for their layout.
+static void latinime_BinaryDictionary_getSuggestionsWithBuffers(JNIEnv *env, jclass clazz,
+        jlong dict, jlong proximityInfo, jlong dicTraverseSession, jobject inputBuffer,
+        jintArray suggestOptions, jobjectArray prevWordCodePointArrays,
+        jbooleanArray isBeginningOfSentenceArray, jint prevWordCount, jobject outputBuffer) {
+    int *const output = getDirectIntBuffer(env, outputBuffer, SUGGESTION_BUFFER_OUTPUT_SIZE);
+    if (!output) {
+        return;
+    }
+    // Assign 0 to the suggestion count here in case of returning earlier in this method.
+    output[0] = 0;
+    Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
+    if (!dictionary) {
+        return;
+    }
+    const int *const inputHeader = getDirectIntBuffer(env, inputBuffer,
+            SUGGESTION_BUFFER_INPUT_HEADER_SIZE);
+    if (!inputHeader) {
+        return;
+    }
+    const int inputSize = inputHeader[0];
+    const int inputCodePointCount = inputHeader[1];
+    if (inputSize < 0 || inputCodePointCount < 0) {
+        AKLOGE("Invalid input size: %d, code point count: %d", inputSize, inputCodePointCount);
+        return;
+    }
+    // x coordinates, y coordinates, times and pointer ids, then the input code points.
+    const jlong inputIntCount = SUGGESTION_BUFFER_INPUT_HEADER_SIZE
+            + static_cast<jlong>(inputSize) * 4 + inputCodePointCount;
+    int *const input = getDirectIntBuffer(env, inputBuffer, inputIntCount);
+    if (!input) {
+        return;
+    }
+    int *const xCoordinates = input + SUGGESTION_BUFFER_INPUT_HEADER_SIZE;
+    int *const yCoordinates = xCoordinates + inputSize;
+    int *const times = yCoordinates + inputSize;
+    int *const pointerIds = times + inputSize;
+    int *const inputCodePoints = pointerIds + inputSize;
+    ProximityInfo *pInfo = reinterpret_cast<ProximityInfo *>(proximityInfo);
+    DicTraverseSession *traverseSession =
+            reinterpret_cast<DicTraverseSession *>(dicTraverseSession);
+
+    const jsize numberOfOptions = env->GetArrayLength(suggestOptions);
+    int options[numberOfOptions];
+    env->GetIntArrayRegion(suggestOptions, 0, numberOfOptions, options);
+    SuggestOptions givenSuggestOptions(options, numberOfOptions);
+
+    float weightOfLangModelVsSpatialModel;
+    memcpy(&weightOfLangModelVsSpatialModel, &output[2], sizeof(float));
+    SuggestionResults suggestionResults(MAX_RESULTS);
+    const NgramContext ngramContext = JniDataUtils::constructNgramContext(env,
+            prevWordCodePointArrays, isBeginningOfSentenceArray, prevWordCount);
+    if (givenSuggestOptions.isGesture() || inputSize > 0) {
+        dictionary->getSuggestions(pInfo, traverseSession, xCoordinates, yCoordinates,
+                times, pointerIds, inputCodePoints, inputSize, &ngramContext,
+                &givenSuggestOptions, weightOfLangModelVsSpatialModel, &suggestionResults);
+    } else {
+        dictionary->getPredictions(&ngramContext, &suggestionResults);
+    }
+    if (DEBUG_DICT) {
+        suggestionResults.dumpSuggestions();
+    }
+    weightOfLangModelVsSpatialModel = suggestionResults.getWeightOfLangModelVsSpatialModel();
+    int *const outCodePoints = output + SUGGESTION_BUFFER_OUTPUT_HEADER_SIZE;
+    int *const outScores = outCodePoints + MAX_RESULTS * MAX_WORD_LENGTH;
+    int *const outSpaceIndices = outScores + MAX_RESULTS;
+    int *const outTypes = outSpaceIndices + MAX_RESULTS;
+    output[0] = suggestionResults.outputSuggestions(outCodePoints, outScores, outSpaceIndices,
+            outTypes, &output[1]);
+    memcpy(&output[2], &weightOfLangModelVsSpatialModel, sizeof(float));
+    suggestionResults.getSearchEffort().copyTo(outTypes + MAX_RESULTS);
+}
+
 static jint latinime_BinaryDictionary_getProbability(JNIEnv *env, jclass clazz, jlong dict,
         jintArray word) {
     Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
@@ -296,6 +480,51 @@ static jint latinime_BinaryDictionary_getNgramProbability(JNIEnv *env, jclass cl
             CodePointArrayView(wordCodePoints, wordLength));
 }
 
+// Reads words packed into one code point array. The i-th word consists of the code points from
+// wordStartOffsets[i] to wordStartOffsets[i + 1], so wordStartOffsets has (word count + 1)
+// elements. Returns false when the offsets are not valid.
+static bool readPackedWords(JNIEnv *env, jintArray packedCodePoints, jintArray wordStartOffsets,
+        std::vector<int> *const outCodePoints, std::vector<int> *const outWordStartOffsets) {
+    const jsize offsetCount = env->GetArrayLength(wordStartOffsets);
+    if (offsetCount < 1) {
+        return false;
+    }
+    const jsize codePointCount = env->GetArrayLength(packedCodePoints);
+    outCodePoints->resize(codePointCount);
+    env->GetIntArrayRegion(packedCodePoints, 0, codePointCount, outCodePoints->data());
+    outWordStartOffsets->resize(offsetCount);
+    env->GetIntArrayRegion(wordStartOffsets, 0, offsetCount, outWordStartOffsets->data());
+    int prevOffset = 0;
+    for (const int offset : *outWordStartOffsets) {
+        if (offset < prevOffset || offset > codePointCount) {
+            AKLOGE("Invalid word start offset: %d, code point count: %d", offset, codePointCount);
+            return false;
+        }
+        prevOffset = offset;
+    }
+    return true;
+}
+
+// Checks all the words of text in one call. The UTF-16 start and end offsets of the misspelled
+// words are written to outMisspelledRanges in pairs, and the count of the pairs is returned. The
+// ranges that don't fit in outMisspelledRanges are dropped.
+static jint latinime_BinaryDictionary_getMisspelledRanges(JNIEnv *env, jclass clazz, jlong dict,
+        jstring text, jintArray outMisspelledRanges) {
+    Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
+    if (!dictionary) return 0;
+    const jsize textLength = env->GetStringLength(text);
+    std::vector<uint16_t> textChars(textLength);
+    env->GetStringRegion(text, 0, textLength, textChars.data());
+    std::vector<int> misspelledRanges;
+    SpellCheckUtils::getMisspelledRanges(dictionary, textChars.data(), textLength,
+            &misspelledRanges);
+    const int rangeCount = std::min(static_cast<int>(misspelledRanges.size()) / 2,
+            env->GetArrayLength(outMisspelledRanges) / 2);
+    env->SetIntArrayRegion(outMisspelledRanges, 0 /* start */, rangeCount * 2,
+            misspelledRanges.data());
+    return rangeCount;
+}
+
 // Method to iterate all words in the dictionary for makedict.
 // If token is 0, this method newly starts iterating the dictionary. This method returns 0 when
 // the dictionary does not have a next word.
@@ -325,6 +554,76 @@ static jint latinime_BinaryDictionary_getNextWord(JNIEnv *env, jclass clazz,
     return nextToken;
 }
 
+// Layout of the direct buffer of getNextWordsNative, in native order 32-bit ints that must be kept
+// in sync with BinaryDictionary.java: [0] word count, then for each word its code point count (n),
+// probability, WORD_EXPORT_FLAG_* flags and code points[n].
+static const int WORD_EXPORT_BUFFER_HEADER_SIZE = 1;
+static const int WORD_EXPORT_RECORD_HEADER_SIZE = 3;
+static const int WORD_EXPORT_FLAG_IS_NOT_A_WORD = 0x1;
+static const int WORD_EXPORT_FLAG_IS_POSSIBLY_OFFENSIVE = 0x2;
+static const int WORD_EXPORT_FLAG_IS_BEGINNING_OF_SENTENCE = 0x4;
+
+// Packs the words in the export buffer while there is room for a word of MAX_WORD_LENGTH.
+class WordListenerForExport : public Dictionary::WordListener {
+ public:
+    WordListenerForExport(int *const buffer, const int bufferSize)
+            : mBuffer(buffer), mBufferSize(bufferSize),
+              mWritingPos(WORD_EXPORT_BUFFER_HEADER_SIZE) {
+        mBuffer[0] = 0;
+    }
+
+    bool canTakeWord() const {
+        return mWritingPos + WORD_EXPORT_RECORD_HEADER_SIZE + MAX_WORD_LENGTH <= mBufferSize;
+    }
+
+    void onVisitWord(const CodePointArrayView codePoints, const WordAttributes &wordAttributes) {
+        int flags = 0;
+        if (wordAttributes.isNotAWord()) {
+            flags |= WORD_EXPORT_FLAG_IS_NOT_A_WORD;
+        }
+        if (wordAttributes.isPossiblyOffensive()) {
+            flags |= WORD_EXPORT_FLAG_IS_POSSIBLY_OFFENSIVE;
+        }
+        if (codePoints[0] == CODE_POINT_BEGINNING_OF_SENTENCE) {
+            flags |= WORD_EXPORT_FLAG_IS_BEGINNING_OF_SENTENCE;
+        }
+        mBuffer[mWritingPos++] = static_cast<int>(codePoints.size());
+        mBuffer[mWritingPos++] = wordAttributes.getProbability();
+        mBuffer[mWritingPos++] = flags;
+        memcpy(mBuffer + mWritingPos, codePoints.data(), sizeof(int) * codePoints.size());
+        mWritingPos += codePoints.size();
+        ++mBuffer[0];
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(WordListenerForExport);
+
+    int *const mBuffer;
+    const int mBufferSize;
+    int mWritingPos;
+};
+
+// Same as getNextWord, but outputs as many words as outputBuffer can take with their unigram
+// probabilities and flags in one call. See above for the layout.
+static jint latinime_BinaryDictionary_getNextWords(JNIEnv *env, jclass clazz, jlong dict,
+        jint token, jobject outputBuffer) {
+    const jlong minIntCount = WORD_EXPORT_BUFFER_HEADER_SIZE + WORD_EXPORT_RECORD_HEADER_SIZE
+            + MAX_WORD_LENGTH;
+    int *const output = getDirectIntBuffer(env, outputBuffer, minIntCount);
+    if (!output) {
+        return 0;
+    }
+    output[0] = 0;
+    Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
+    if (!dictionary) {
+        return 0;
+    }
+    const jlong capacity = env->GetDirectBufferCapacity(outputBuffer) / sizeof(int);
+    WordListenerForExport listener(output,
+            static_cast<int>(std::min(capacity, static_cast<jlong>(INT_MAX))));
+    return dictionary->getNextWordsAndNextToken(token, &listener);
+}
+
 static void latinime_BinaryDictionary_getWordProperty(JNIEnv *env, jclass clazz,
         jlong dict, jintArray word, jboolean isBeginningOfSentence, jintArray outCodePoints,
         jbooleanArray outFlags, jintArray outProbabilityInfo, jobject outNgramPrevWordsArray,
@@ -383,6 +682,60 @@ static bool latinime_BinaryDictionary_addUnigramEntry(JNIEnv *env, jclass clazz,
             &unigramProperty);
 }
 
+// Batch version of addUnigramEntry. Empty shortcut targets mean that the word has no shortcut.
+static bool latinime_BinaryDictionary_addUnigramEntries(JNIEnv *env, jclass clazz, jlong dict,
+        jintArray packedCodePoints, jintArray wordStartOffsets, jintArray probabilities,
+        jintArray packedShortcutTargetCodePoints, jintArray shortcutTargetStartOffsets,
+        jintArray shortcutProbabilities, jbooleanArray isNotAWordArray, jint timestamp) {
+    Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
+    if (!dictionary) {
+        return false;
+    }
+    std::vector<int> codePoints;
+    std::vector<int> offsets;
+    std::vector<int> shortcutTargetCodePoints;
+    std::vector<int> shortcutTargetOffsets;
+    if (!readPackedWords(env, packedCodePoints, wordStartOffsets, &codePoints, &offsets)
+            || !readPackedWords(env, packedShortcutTargetCodePoints, shortcutTargetStartOffsets,
+                    &shortcutTargetCodePoints, &shortcutTargetOffsets)) {
+        return false;
+    }
+    const int wordCount = static_cast<int>(offsets.size()) - 1;
+    if (static_cast<int>(shortcutTargetOffsets.size()) - 1 != wordCount
+            || env->GetArrayLength(probabilities) != wordCount
+            || env->GetArrayLength(shortcutProbabilities) != wordCount
+            || env->GetArrayLength(isNotAWordArray) != wordCount) {
+        AKLOGE("The arrays of unigram entries have different lengths. word count: %d", wordCount);
+        return false;
+    }
+    std::vector<int> wordProbabilities(wordCount);
+    env->GetIntArrayRegion(probabilities, 0, wordCount, wordProbabilities.data());
+    std::vector<int> shortcutTargetProbabilities(wordCount);
+    env->GetIntArrayRegion(shortcutProbabilities, 0, wordCount,
+            shortcutTargetProbabilities.data());
+    std::vector<jboolean> isNotAWord(wordCount);
+    env->GetBooleanArrayRegion(isNotAWordArray, 0, wordCount, isNotAWord.data());
+    std::vector<CodePointArrayView> words;
+    std::vector<UnigramProperty> unigramProperties;
+    words.reserve(wordCount);
+    unigramProperties.reserve(wordCount);
+    for (int i = 0; i < wordCount; ++i) {
+        words.emplace_back(codePoints.data() + offsets[i], offsets[i + 1] - offsets[i]);
+        std::vector<UnigramProperty::ShortcutProperty> shortcuts;
+        if (shortcutTargetOffsets[i + 1] > shortcutTargetOffsets[i]) {
+            shortcuts.emplace_back(std::vector<int>(
+                    shortcutTargetCodePoints.begin() + shortcutTargetOffsets[i],
+                    shortcutTargetCodePoints.begin() + shortcutTargetOffsets[i + 1]),
+                    shortcutTargetProbabilities[i]);
+        }
+        // Use 1 for count to indicate the word has inputted.
+        unigramProperties.emplace_back(false /* representsBeginningOfSentence */,
+                isNotAWord[i] == JNI_TRUE, false /* isPossiblyOffensive */, wordProbabilities[i],
+                HistoricalInfo(timestamp, 0 /* level */, 1 /* count */), std::move(shortcuts));
+    }
+    return dictionary->addUnigramEntries(words, unigramProperties);
+}
+
 static bool latinime_BinaryDictionary_removeUnigramEntry(JNIEnv *env, jclass clazz, jlong dict,
         jintArray word) {
     Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
@@ -452,60 +805,90 @@ static bool latinime_BinaryDictionary_updateEntriesForWordWithNgramContext(JNIEn
             historicalInfo);
 }
 
+// Layout of the packed input events of updateEntriesForInputEventsNative, in ints that must be
+// kept in sync with BinaryDictionary.java: for each event its timestamp, previous word count (k),
+// k previous words, each as a beginning-of-sentence flag (0 or 1), its code point count (m) and code
+// points[m], and then the code point count of the target word (n) and its code points[n].
+static const int INPUT_EVENT_HEADER_SIZE = 2;
+static const int INPUT_EVENT_WORD_HEADER_SIZE = 1;
+static const int INPUT_EVENT_PREV_WORD_HEADER_SIZE = 2;
+
+// Reads the packed input events after the first startIndex ones. The code points of the target
+// words refer to packedEvents. Returns false when the events are malformed.
+static bool readPackedInputEvents(const std::vector<int> &packedEvents, const int startIndex,
+        std::vector<NgramContext> *const outNgramContexts,
+        std::vector<CodePointArrayView> *const outCodePoints,
+        std::vector<HistoricalInfo> *const outHistoricalInfos) {
+    const int size = static_cast<int>(packedEvents.size());
+    int pos = 0;
+    for (int eventIndex = 0; pos < size; ++eventIndex) {
+        if (pos + INPUT_EVENT_HEADER_SIZE > size) {
+            return false;
+        }
+        const int timestamp = packedEvents[pos++];
+        const int prevWordCount = packedEvents[pos++];
+        if (prevWordCount < 0 || prevWordCount > MAX_PREV_WORD_COUNT_FOR_N_GRAM) {
+            return false;
+        }
+        int prevWordCodePoints[MAX_PREV_WORD_COUNT_FOR_N_GRAM][MAX_WORD_LENGTH];
+        int prevWordCodePointCount[MAX_PREV_WORD_COUNT_FOR_N_GRAM];
+        bool isBeginningOfSentence[MAX_PREV_WORD_COUNT_FOR_N_GRAM];
+        for (int i = 0; i < prevWordCount; ++i) {
+            if (pos + INPUT_EVENT_PREV_WORD_HEADER_SIZE > size) {
+                return false;
+            }
+            isBeginningOfSentence[i] = packedEvents[pos++] != 0;
+            const int codePointCount = packedEvents[pos++];
+            if (codePointCount < 0 || pos + codePointCount > size) {
+                return false;
+            }
+            // Too long previous words are ignored like in JniDataUtils::constructNgramContext.
+            prevWordCodePointCount[i] = codePointCount <= MAX_WORD_LENGTH ? codePointCount : 0;
+            memcpy(prevWordCodePoints[i], packedEvents.data() + pos,
+                    prevWordCodePointCount[i] * sizeof(prevWordCodePoints[i][0]));
+            pos += codePointCount;
+        }
+        if (pos + INPUT_EVENT_WORD_HEADER_SIZE > size) {
+            return false;
+        }
+        const int codePointCount = packedEvents[pos++];
+        if (codePointCount < 0 || pos + codePointCount > size) {
+            return false;
+        }
+        if (eventIndex >= startIndex) {
+            outNgramContexts->emplace_back(prevWordCodePoints, prevWordCodePointCount,
+                    isBeginningOfSentence, prevWordCount);
+            outCodePoints->emplace_back(packedEvents.data() + pos, codePointCount);
+            // Use 1 for count to indicate the word has inputted.
+            outHistoricalInfos->emplace_back(timestamp, 0 /* level */, 1 /* count */);
+        }
+        pos += codePointCount;
+    }
+    return true;
+}
+
 // Returns how many input events are processed.
 static int latinime_BinaryDictionary_updateEntriesForInputEvents(JNIEnv *env, jclass clazz,
-        jlong dict, jobjectArray inputEvents, jint startIndex) {
+        jlong dict, jintArray packedInputEvents, jint startIndex) {
     Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
     if (!dictionary) {
         return 0;
     }
-    jsize inputEventCount = env->GetArrayLength(inputEvents);
-    if (inputEventCount == 0 || startIndex >= inputEventCount) {
+    std::vector<int> packedEvents(env->GetArrayLength(packedInputEvents));
+    env->GetIntArrayRegion(packedInputEvents, 0, packedEvents.size(), packedEvents.data());
+    std::vector<NgramContext> ngramContexts;
+    std::vector<CodePointArrayView> codePoints;
+    std::vector<HistoricalInfo> historicalInfos;
+    if (!readPackedInputEvents(packedEvents, startIndex, &ngramContexts, &codePoints,
+            &historicalInfos)) {
+        AKLOGE("The packed input events are malformed.");
         return 0;
     }
-    jobject inputEvent = env->GetObjectArrayElement(inputEvents, 0);
-    jclass wordInputEventClass = env->GetObjectClass(inputEvent);
-    env->DeleteLocalRef(inputEvent);
-
-    jfieldID targetWordFieldId = env->GetFieldID(wordInputEventClass, "mTargetWord", "[I");
-    jfieldID prevWordCountFieldId = env->GetFieldID(wordInputEventClass, "mPrevWordsCount", "I");
-    jfieldID prevWordArrayFieldId = env->GetFieldID(wordInputEventClass, "mPrevWordArray", "[[I");
-    jfieldID isPrevWordBoSArrayFieldId =
-            env->GetFieldID(wordInputEventClass, "mIsPrevWordBeginningOfSentenceArray", "[Z");
-    jfieldID isValidFieldId = env->GetFieldID(wordInputEventClass, "mIsValid", "Z");
-    jfieldID timestampFieldId = env->GetFieldID(wordInputEventClass, "mTimestamp", "I");
-    env->DeleteLocalRef(wordInputEventClass);
-
-    for (int i = startIndex; i < inputEventCount; ++i) {
-        jobject inputEvent = env->GetObjectArrayElement(inputEvents, i);
-        jintArray targetWord = static_cast<jintArray>(
-                env->GetObjectField(inputEvent, targetWordFieldId));
-        jsize wordLength = env->GetArrayLength(targetWord);
-        int wordCodePoints[wordLength];
-        env->GetIntArrayRegion(targetWord, 0, wordLength, wordCodePoints);
-        env->DeleteLocalRef(targetWord);
-
-        jint prevWordCount = env->GetIntField(inputEvent, prevWordCountFieldId);
-        jobjectArray prevWordArray =
-                static_cast<jobjectArray>(env->GetObjectField(inputEvent, prevWordArrayFieldId));
-        jbooleanArray isPrevWordBeginningOfSentenceArray = static_cast<jbooleanArray>(
-                env->GetObjectField(inputEvent, isPrevWordBoSArrayFieldId));
-        jboolean isValid = env->GetBooleanField(inputEvent, isValidFieldId);
-        jint timestamp = env->GetIntField(inputEvent, timestampFieldId);
-        const NgramContext ngramContext = JniDataUtils::constructNgramContext(env,
-                prevWordArray, isPrevWordBeginningOfSentenceArray, prevWordCount);
-        // Use 1 for count to indicate the word has inputted.
-        dictionary->updateEntriesForWordWithNgramContext(&ngramContext,
-                CodePointArrayView(wordCodePoints, wordLength), isValid,
-                HistoricalInfo(timestamp, 0 /* level */, 1 /* count */));
-        if (dictionary->needsToRunGC(true /* mindsBlockByGC */)) {
-            return i + 1;
-        }
-        env->DeleteLocalRef(prevWordArray);
-        env->DeleteLocalRef(isPrevWordBeginningOfSentenceArray);
-        env->DeleteLocalRef(inputEvent);
+    if (codePoints.empty()) {
+        return 0;
     }
-    return inputEventCount;
+    return startIndex + dictionary->updateEntriesForWords(ngramContexts, codePoints,
+            historicalInfos);
 }
 
 static jstring latinime_BinaryDictionary_getProperty(JNIEnv *env, jclass clazz, jlong dict,
@@ -533,6 +916,97 @@ static bool latinime_BinaryDictionary_isCorruptedNative(JNIEnv *env, jclass claz
     return dictionary->getDictionaryStructurePolicy()->isCorrupted();
 }
 
+// Copies the values of NativeMetrics to outValues and returns how many were copied.
+static jint latinime_BinaryDictionary_getNativeMetrics(JNIEnv *env, jclass clazz,
+        jlongArray outValues) {
+    const jsize outValuesLength = env->GetArrayLength(outValues);
+    int64_t values[NativeMetrics::VALUE_COUNT];
+    const int valueCount = NativeMetrics::copyTo(values,
+            std::min(static_cast<int>(outValuesLength), NativeMetrics::VALUE_COUNT));
+    static_assert(sizeof(jlong) == sizeof(int64_t), "jlong has to hold the metric values");
+    env->SetLongArrayRegion(outValues, 0 /* start */, valueCount,
+            reinterpret_cast<const jlong *>(values));
+    return valueCount;
+}
+
+// Copies the MemoryUsage of the dictionary to outBytes and returns how many values were copied.
+static jint latinime_BinaryDictionary_getMemoryUsage(JNIEnv *env, jclass clazz, jlong dict,
+        jlongArray outBytes) {
+    Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
+    if (!dictionary) {
+        return 0;
+    }
+    MemoryUsage memoryUsage;
+    dictionary->addMemoryUsage(&memoryUsage);
+    int64_t bytes[MemoryUsage::CATEGORY_COUNT];
+    memoryUsage.copyTo(bytes);
+    const int valueCount = std::min(static_cast<int>(env->GetArrayLength(outBytes)),
+            static_cast<int>(MemoryUsage::CATEGORY_COUNT));
+    env->SetLongArrayRegion(outBytes, 0 /* start */, valueCount,
+            reinterpret_cast<const jlong *>(bytes));
+    return valueCount;
+}
+
+// level is one of the Dictionary::TRIM_MEMORY_* constants.
+static void latinime_BinaryDictionary_trimMemory(JNIEnv *env, jclass clazz, jlong dict,
+        jint level) {
+    Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
+    if (!dictionary) {
+        return;
+    }
+    dictionary->trimMemory(level);
+}
+
+// traverseSession may be 0, in which case a pooled session of the dictionary is prepared.
+static void latinime_BinaryDictionary_prewarm(JNIEnv *env, jclass clazz, jlong dict,
+        jlong traverseSession) {
+    Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
+    if (!dictionary) {
+        return;
+    }
+    dictionary->prewarm(reinterpret_cast<DicTraverseSession *>(traverseSession));
+}
+
+// Returns whether the trace sections of the native code are enabled now.
+static jboolean latinime_BinaryDictionary_setNativeTracingEnabled(JNIEnv *env, jclass clazz,
+        jboolean enabled) {
+    return NativeTrace::setEnabled(enabled == JNI_TRUE) ? JNI_TRUE : JNI_FALSE;
+}
+
+// Returns whether the sampling profiler of this library is running now.
+static jboolean latinime_BinaryDictionary_startSamplingProfiler(JNIEnv *env, jclass clazz,
+        jint samplingIntervalUs) {
+    return NativeSamplingProfiler::start(samplingIntervalUs) ? JNI_TRUE : JNI_FALSE;
+}
+
+static void latinime_BinaryDictionary_stopSamplingProfiler(JNIEnv *env, jclass clazz) {
+    NativeSamplingProfiler::stop();
+}
+
+// Copies the sampled PC offsets and their counts and returns how many were copied. The sample
+// counts receive the NativeSamplingProfiler::SampleCountIndex values.
+static jint latinime_BinaryDictionary_getSamplingProfile(JNIEnv *env, jclass clazz,
+        jlongArray outPcOffsets, jintArray outCounts, jlongArray outSampleCounts) {
+    const int maxCount = std::min(static_cast<int>(env->GetArrayLength(outPcOffsets)),
+            static_cast<int>(env->GetArrayLength(outCounts)));
+    std::vector<int64_t> pcOffsets(std::min(maxCount,
+            static_cast<int>(NativeSamplingProfiler::MAX_PC_COUNT)));
+    std::vector<int> counts(pcOffsets.size());
+    const int pcCount = NativeSamplingProfiler::getSamples(static_cast<int>(pcOffsets.size()),
+            pcOffsets.data(), counts.data());
+    env->SetLongArrayRegion(outPcOffsets, 0 /* start */, pcCount,
+            reinterpret_cast<const jlong *>(pcOffsets.data()));
+    env->SetIntArrayRegion(outCounts, 0 /* start */, pcCount,
+            reinterpret_cast<const jint *>(counts.data()));
+    int64_t sampleCounts[NativeSamplingProfiler::SAMPLE_COUNT_SIZE];
+    NativeSamplingProfiler::getSampleCounts(sampleCounts);
+    env->SetLongArrayRegion(outSampleCounts, 0 /* start */,
+            std::min(static_cast<int>(env->GetArrayLength(outSampleCounts)),
+                    static_cast<int>(NativeSamplingProfiler::SAMPLE_COUNT_SIZE)),
+            reinterpret_cast<const jlong *>(sampleCounts));
+    return pcCount;
+}
+
 static DictionaryStructureWithBufferPolicy::StructurePolicyPtr runGCAndGetNewStructurePolicy(
         DictionaryStructureWithBufferPolicy::StructurePolicyPtr structurePolicy,
         const char *const dictFilePath) {
@@ -548,11 +1022,27 @@ static bool latinime_BinaryDictionary_migrateNative(JNIEnv *env, jclass clazz, j
     if (!dictionary) {
         return false;
     }
+    const NativeTrace::ScopedSection section("BinaryDictionary::migrate");
     const jsize filePathUtf8Length = env->GetStringUTFLength(dictFilePath);
     char dictFilePathChars[filePathUtf8Length + 1];
     env->GetStringUTFRegion(dictFilePath, 0, env->GetStringLength(dictFilePath), dictFilePathChars);
     dictFilePathChars[filePathUtf8Length] = '\0';
 
+    if (DictMigrationUtils::canMigrate(dictionary->getDictionaryStructurePolicy(),
+            newFormatVersion)) {
+        // Translate the structures directly instead of adding all the entries one by one.
+        DictionaryStructureWithBufferPolicy::StructurePolicyPtr migratedStructurePolicy =
+                DictMigrationUtils::migrate(dictionary->getDictionaryStructurePolicy(),
+                        newFormatVersion);
+        if (!migratedStructurePolicy) {
+            LogUtils::logToJava(env, "Cannot migrate the dict structures.");
+            return false;
+        }
+        // Save to File.
+        migratedStructurePolicy->flushWithGC(dictFilePathChars);
+        return true;
+    }
+
     const DictionaryHeaderStructurePolicy *const headerPolicy =
             dictionary->getDictionaryStructurePolicy()->getHeaderStructurePolicy();
     DictionaryStructureWithBufferPolicy::StructurePolicyPtr dictionaryStructureWithBufferPolicy =
@@ -622,6 +1112,16 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("(Ljava/lang/String;JJZ)J"),
         reinterpret_cast<void *>(latinime_BinaryDictionary_open)
     },
+    {
+        const_cast<char *>("openSnapshotNative"),
+        const_cast<char *>("(Ljava/lang/String;)J"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_openSnapshot)
+    },
+    {
+        const_cast<char *>("openManyNative"),
+        const_cast<char *>("([Ljava/lang/String;[J[J[Z[J)V"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_openMany)
+    },
     {
         const_cast<char *>("createOnMemoryNative"),
         const_cast<char *>("(JLjava/lang/String;[Ljava/lang/String;[Ljava/lang/String;)J"),
@@ -662,6 +1162,11 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("(JJJ[I[I[I[I[II[I[[I[ZI[I[I[I[I[I[I[F)V"),
         reinterpret_cast<void *>(latinime_BinaryDictionary_getSuggestions)
     },
+    {
+        const_cast<char *>("getSuggestionsWithBuffersNative"),
+        const_cast<char *>("(JJJLjava/nio/ByteBuffer;[I[[I[ZILjava/nio/ByteBuffer;)V"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_getSuggestionsWithBuffers)
+    },
     {
         const_cast<char *>("getProbabilityNative"),
         const_cast<char *>("(J[I)I"),
@@ -677,6 +1182,11 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("(J[[I[Z[I)I"),
         reinterpret_cast<void *>(latinime_BinaryDictionary_getNgramProbability)
     },
+    {
+        const_cast<char *>("getMisspelledRangesNative"),
+        const_cast<char *>("(JLjava/lang/String;[I)I"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_getMisspelledRanges)
+    },
     {
         const_cast<char *>("getWordPropertyNative"),
         const_cast<char *>("(J[IZ[I[Z[ILjava/util/ArrayList;Ljava/util/ArrayList;"
@@ -684,6 +1194,11 @@ static const JNINativeMethod sMethods[] = {
                 "Ljava/util/ArrayList;)V"),
         reinterpret_cast<void *>(latinime_BinaryDictionary_getWordProperty)
     },
+    {
+        const_cast<char *>("getNextWordsNative"),
+        const_cast<char *>("(JILjava/nio/ByteBuffer;)I"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_getNextWords)
+    },
     {
         const_cast<char *>("getNextWordNative"),
         const_cast<char *>("(JI[I[Z)I"),
@@ -694,6 +1209,11 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("(J[II[IIZZZI)Z"),
         reinterpret_cast<void *>(latinime_BinaryDictionary_addUnigramEntry)
     },
+    {
+        const_cast<char *>("addUnigramEntriesNative"),
+        const_cast<char *>("(J[I[I[I[I[I[I[ZI)Z"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_addUnigramEntries)
+    },
     {
         const_cast<char *>("removeUnigramEntryNative"),
         const_cast<char *>("(J[I)Z"),
@@ -716,8 +1236,7 @@ static const JNINativeMethod sMethods[] = {
     },
     {
         const_cast<char *>("updateEntriesForInputEventsNative"),
-        const_cast<char *>(
-                "(J[Lcom/android/inputmethod/latin/utils/WordInputEventForPersonalization;I)I"),
+        const_cast<char *>("(J[II)I"),
         reinterpret_cast<void *>(latinime_BinaryDictionary_updateEntriesForInputEvents)
     },
     {
@@ -730,6 +1249,46 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("(J)Z"),
         reinterpret_cast<void *>(latinime_BinaryDictionary_isCorruptedNative)
     },
+    {
+        const_cast<char *>("getNativeMetricsNative"),
+        const_cast<char *>("([J)I"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_getNativeMetrics)
+    },
+    {
+        const_cast<char *>("getMemoryUsageNative"),
+        const_cast<char *>("(J[J)I"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_getMemoryUsage)
+    },
+    {
+        const_cast<char *>("trimMemoryNative"),
+        const_cast<char *>("(JI)V"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_trimMemory)
+    },
+    {
+        const_cast<char *>("prewarmNative"),
+        const_cast<char *>("(JJ)V"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_prewarm)
+    },
+    {
+        const_cast<char *>("setNativeTracingEnabledNative"),
+        const_cast<char *>("(Z)Z"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_setNativeTracingEnabled)
+    },
+    {
+        const_cast<char *>("startSamplingProfilerNative"),
+        const_cast<char *>("(I)Z"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_startSamplingProfiler)
+    },
+    {
+        const_cast<char *>("stopSamplingProfilerNative"),
+        const_cast<char *>("()V"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_stopSamplingProfiler)
+    },
+    {
+        const_cast<char *>("getSamplingProfileNative"),
+        const_cast<char *>("([J[I[J)I"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_getSamplingProfile)
+    },
     {
         const_cast<char *>("migrateNative"),
         const_cast<char *>("(JLjava/lang/String;J)Z"),
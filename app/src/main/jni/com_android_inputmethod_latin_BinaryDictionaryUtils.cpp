@@ -18,6 +18,8 @@
 
 #include "com_android_inputmethod_latin_BinaryDictionaryUtils.h"
 
+#include <vector>
+
 #include "defines.h"
 #include "dictionary/utils/dict_file_writing_utils.h"
 #include "jni.h"
@@ -68,6 +70,45 @@ static jfloat latinime_BinaryDictionaryUtils_calcNormalizedScore(JNIEnv *env, jc
             afterCodePoints, afterLength, score);
 }
 
+static void latinime_BinaryDictionaryUtils_calcNormalizedScores(JNIEnv *env, jclass clazz,
+        jintArray before, jintArray afters, jintArray afterLengths, jintArray scores,
+        jfloatArray outNormalizedScores) {
+    const jsize beforeLength = env->GetArrayLength(before);
+    const jsize aftersLength = env->GetArrayLength(afters);
+    const jsize afterCount = env->GetArrayLength(afterLengths);
+    if (env->GetArrayLength(scores) < afterCount
+            || env->GetArrayLength(outNormalizedScores) < afterCount) {
+        AKLOGE("Invalid array size: candidates: %d, scores: %d, out normalized scores: %d",
+                afterCount, env->GetArrayLength(scores), env->GetArrayLength(outNormalizedScores));
+        ASSERT(false);
+        return;
+    }
+    int beforeCodePoints[beforeLength];
+    env->GetIntArrayRegion(before, 0, beforeLength, beforeCodePoints);
+    // A whole paragraph of candidates may not fit on the stack.
+    std::vector<int> afterCodePoints(aftersLength);
+    std::vector<int> afterLengthArray(afterCount);
+    std::vector<int> scoreArray(afterCount);
+    env->GetIntArrayRegion(afters, 0, aftersLength, afterCodePoints.data());
+    env->GetIntArrayRegion(afterLengths, 0, afterCount, afterLengthArray.data());
+    env->GetIntArrayRegion(scores, 0, afterCount, scoreArray.data());
+    int totalLength = 0;
+    for (const int afterLength : afterLengthArray) {
+        if (afterLength < 0 || afterLength > aftersLength - totalLength) {
+            AKLOGE("Invalid candidate length: %d, total: %d / %d", afterLength, totalLength,
+                    aftersLength);
+            ASSERT(false);
+            return;
+        }
+        totalLength += afterLength;
+    }
+    std::vector<float> normalizedScores(afterCount);
+    AutocorrectionThresholdUtils::calcNormalizedScores(beforeCodePoints, beforeLength,
+            afterCodePoints.data(), afterLengthArray.data(), scoreArray.data(), afterCount,
+            normalizedScores.data());
+    env->SetFloatArrayRegion(outNormalizedScores, 0, afterCount, normalizedScores.data());
+}
+
 static int latinime_BinaryDictionaryUtils_setCurrentTimeForTest(JNIEnv *env, jclass clazz,
         jint currentTime) {
     if (currentTime >= 0) {
@@ -91,6 +132,11 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("([I[II)F"),
         reinterpret_cast<void *>(latinime_BinaryDictionaryUtils_calcNormalizedScore)
     },
+    {
+        const_cast<char *>("calcNormalizedScoresNative"),
+        const_cast<char *>("([I[I[I[I[F)V"),
+        reinterpret_cast<void *>(latinime_BinaryDictionaryUtils_calcNormalizedScores)
+    },
     {
         const_cast<char *>("setCurrentTimeForTestNative"),
         const_cast<char *>("(I)I"),
@@ -18,20 +18,18 @@
 
 #include "com_android_inputmethod_latin_DicTraverseSession.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "defines.h"
 #include "dictionary/property/ngram_context.h"
 #include "jni.h"
 #include "jni_common.h"
+#include "suggest/core/dictionary/dictionary.h"
 #include "suggest/core/session/dic_traverse_session.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
-class Dictionary;
-static jlong latinime_setDicTraverseSession(JNIEnv *env, jclass clazz, jstring localeJStr,
-        jlong dictSize) {
-    void *traverseSession = DicTraverseSession::getSessionInstance(env, localeJStr, dictSize);
-    return reinterpret_cast<jlong>(traverseSession);
-}
-
 static void latinime_initDicTraverseSession(JNIEnv *env, jclass clazz, jlong traverseSession,
         jlong dictionary, jintArray previousWord, jint previousWordLength) {
     DicTraverseSession *ts = reinterpret_cast<DicTraverseSession *>(traverseSession);
@@ -39,15 +37,27 @@ static void latinime_initDicTraverseSession(JNIEnv *env, jclass clazz, jlong tra
         return;
     }
     Dictionary *dict = reinterpret_cast<Dictionary *>(dictionary);
+    const Dictionary::ScopedReadingPolicy readingPolicy(dict);
     if (!previousWord) {
         NgramContext emptyNgramContext;
-        ts->init(dict, &emptyNgramContext, 0 /* suggestOptions */);
+        ts->init(dict, readingPolicy.get(), &emptyNgramContext, 0 /* suggestOptions */);
         return;
     }
     int prevWord[previousWordLength];
     env->GetIntArrayRegion(previousWord, 0, previousWordLength, prevWord);
     NgramContext ngramContext(prevWord, previousWordLength, false /* isStartOfSentence */);
-    ts->init(dict, &ngramContext, 0 /* suggestOptions */);
+    ts->init(dict, readingPolicy.get(), &ngramContext, 0 /* suggestOptions */);
+}
+
+// Creates a session and initializes it for the dictionary in one call, as sessions are created
+// for each dictionary when the keyboard starts.
+static jlong latinime_createDicTraverseSession(JNIEnv *env, jclass clazz, jlong dictionary,
+        jlong dictSize) {
+    DicTraverseSession *const ts = DicTraverseSession::getSessionInstance(dictSize);
+    const jlong traverseSession = reinterpret_cast<jlong>(ts);
+    latinime_initDicTraverseSession(env, clazz, traverseSession, dictionary,
+            nullptr /* previousWord */, 0 /* previousWordLength */);
+    return traverseSession;
 }
 
 static void latinime_releaseDicTraverseSession(JNIEnv *env, jclass clazz, jlong traverseSession) {
@@ -55,11 +65,39 @@ static void latinime_releaseDicTraverseSession(JNIEnv *env, jclass clazz, jlong
     DicTraverseSession::releaseSessionInstance(ts);
 }
 
+// Copies the MemoryUsage of the session to outBytes and returns how many values were copied.
+static jint latinime_getDicTraverseSessionMemoryUsage(JNIEnv *env, jclass clazz,
+        jlong traverseSession, jlongArray outBytes) {
+    DicTraverseSession *ts = reinterpret_cast<DicTraverseSession *>(traverseSession);
+    if (!ts) {
+        return 0;
+    }
+    MemoryUsage memoryUsage;
+    ts->addMemoryUsage(&memoryUsage);
+    int64_t bytes[MemoryUsage::CATEGORY_COUNT];
+    memoryUsage.copyTo(bytes);
+    const int valueCount = std::min(static_cast<int>(env->GetArrayLength(outBytes)),
+            static_cast<int>(MemoryUsage::CATEGORY_COUNT));
+    env->SetLongArrayRegion(outBytes, 0 /* start */, valueCount,
+            reinterpret_cast<const jlong *>(bytes));
+    return valueCount;
+}
+
+// Must not be called while the session is used for a search.
+static void latinime_trimDicTraverseSessionMemory(JNIEnv *env, jclass clazz,
+        jlong traverseSession) {
+    DicTraverseSession *ts = reinterpret_cast<DicTraverseSession *>(traverseSession);
+    if (!ts) {
+        return;
+    }
+    ts->trimMemory();
+}
+
 static const JNINativeMethod sMethods[] = {
     {
-        const_cast<char *>("setDicTraverseSessionNative"),
-        const_cast<char *>("(Ljava/lang/String;J)J"),
-        reinterpret_cast<void *>(latinime_setDicTraverseSession)
+        const_cast<char *>("createDicTraverseSessionNative"),
+        const_cast<char *>("(JJ)J"),
+        reinterpret_cast<void *>(latinime_createDicTraverseSession)
     },
     {
         const_cast<char *>("initDicTraverseSessionNative"),
@@ -70,6 +108,16 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("releaseDicTraverseSessionNative"),
         const_cast<char *>("(J)V"),
         reinterpret_cast<void *>(latinime_releaseDicTraverseSession)
+    },
+    {
+        const_cast<char *>("getMemoryUsageNative"),
+        const_cast<char *>("(J[J)I"),
+        reinterpret_cast<void *>(latinime_getDicTraverseSessionMemoryUsage)
+    },
+    {
+        const_cast<char *>("trimMemoryNative"),
+        const_cast<char *>("(J)V"),
+        reinterpret_cast<void *>(latinime_trimDicTraverseSessionMemory)
     }
 };
 
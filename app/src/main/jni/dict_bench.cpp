@@ -0,0 +1,377 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Micro-benchmarks of the dictionary structure policies, built for the host by HostUnitTests.mk:
+//   latinime_dict_bench -d main.dict [-w work_dir] [-r runs]
+//
+// The given v2 dictionary is migrated to an on-memory v403 dictionary with addUnigramEntry and
+// addNgramEntry, which is flushed with flushWithGC to work_dir (main.dict.v4bench by default,
+// removed afterwards) and opened again. The read primitives are then measured on both policies,
+// and the edit distance of the autocorrection threshold on the words of the dictionary.
+// Each benchmark runs the given number of times and the best run is reported, as JSON on the
+// standard output.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/interface/dictionary_header_structure_policy.h"
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "dictionary/interface/ngram_listener.h"
+#include "dictionary/property/word_property.h"
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/utils/file_utils.h"
+#include "dictionary/utils/format_utils.h"
+#include "dictionary/utils/multi_bigram_map.h"
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_node_utils.h"
+#include "suggest/core/dicnode/dic_node_vector.h"
+#include "suggest/policyimpl/utils/damerau_levenshtein_edit_distance_policy.h"
+#include "suggest/policyimpl/utils/edit_distance.h"
+#include "utils/int_array_view.h"
+#include "utils/time_keeper.h"
+
+namespace latinime {
+namespace {
+
+typedef DictionaryStructureWithBufferPolicy::StructurePolicyPtr StructurePolicyPtr;
+
+struct Word {
+    int mCodePoints[MAX_WORD_LENGTH];
+    int mCodePointCount;
+
+    const CodePointArrayView getCodePoints() const {
+        return CodePointArrayView(mCodePoints, mCodePointCount);
+    }
+};
+
+struct Result {
+    std::string mPolicyName;
+    std::string mBenchmarkName;
+    // The operations of one run, e.g. the looked up words.
+    int64_t mOperationCount;
+    int64_t mBestRunUs;
+};
+
+class NgramEntryCounter : public NgramListener {
+ public:
+    NgramEntryCounter() : mEntryCount(0) {}
+    virtual void onVisitEntry(const int ngramProbability, const int targetWordId) {
+        ++mEntryCount;
+    }
+    int64_t mEntryCount;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(NgramEntryCounter);
+};
+
+// The result of the benchmarks is accumulated here, so that the compiler can't drop them.
+volatile int64_t sSink = 0;
+
+// Runs the benchmark runCount times and adds the best run to results. The benchmark returns the
+// operation count of a run.
+template<typename Benchmark>
+void runBenchmark(const char *const policyName, const char *const benchmarkName,
+        const int runCount, const Benchmark &benchmark, std::vector<Result> *const results) {
+    Result result{policyName, benchmarkName, 0, INT64_MAX};
+    for (int run = 0; run < runCount; ++run) {
+        const int64_t startTimeUs = TimeKeeper::getMonotonicTimeInMicroseconds();
+        result.mOperationCount = benchmark();
+        result.mBestRunUs = std::min(result.mBestRunUs,
+                TimeKeeper::getMonotonicTimeInMicroseconds() - startTimeUs);
+    }
+    results->push_back(result);
+}
+
+std::vector<Word> getAllWords(DictionaryStructureWithBufferPolicy *const policy) {
+    std::vector<Word> words;
+    Word word;
+    int token = 0;
+    do {
+        token = policy->getNextWordAndNextToken(token, word.mCodePoints, &word.mCodePointCount,
+                nullptr /* outWordId */);
+        if (word.mCodePointCount > 0 && word.mCodePoints[0] != CODE_POINT_BEGINNING_OF_SENTENCE) {
+            words.push_back(word);
+        }
+    } while (token != 0);
+    return words;
+}
+
+void runReadBenchmarks(const char *const policyName,
+        DictionaryStructureWithBufferPolicy *const policy, const int runCount,
+        std::vector<Result> *const results) {
+    std::vector<Word> words;
+    runBenchmark(policyName, "getNextWordAndNextToken", runCount, [&]() {
+        words = getAllWords(policy);
+        return static_cast<int64_t>(words.size());
+    }, results);
+
+    std::vector<int> wordIds;
+    runBenchmark(policyName, "getWordId", runCount, [&]() {
+        wordIds.clear();
+        for (const Word &word : words) {
+            wordIds.push_back(policy->getWordId(word.getCodePoints(),
+                    false /* forceLowerCaseSearch */));
+        }
+        return static_cast<int64_t>(wordIds.size());
+    }, results);
+
+    runBenchmark(policyName, "getCodePointsAndReturnCodePointCount", runCount, [&]() {
+        int codePoints[MAX_WORD_LENGTH];
+        int64_t codePointCount = 0;
+        for (const int wordId : wordIds) {
+            codePointCount += policy->getCodePointsAndReturnCodePointCount(wordId,
+                    MAX_WORD_LENGTH, codePoints);
+        }
+        sSink += codePointCount;
+        return static_cast<int64_t>(wordIds.size());
+    }, results);
+
+    runBenchmark(policyName, "getWordAttributesInContext", runCount, [&]() {
+        MultiBigramMap multiBigramMap;
+        int64_t probabilitySum = 0;
+        for (const int wordId : wordIds) {
+            probabilitySum += policy->getWordAttributesInContext(WordIdArrayView(), wordId,
+                    &multiBigramMap).getProbability();
+        }
+        sSink += probabilitySum;
+        return static_cast<int64_t>(wordIds.size());
+    }, results);
+
+    runBenchmark(policyName, "iterateNgramEntries", runCount, [&]() {
+        NgramEntryCounter counter;
+        for (const int wordId : wordIds) {
+            policy->iterateNgramEntries(WordIdArrayView::singleElementView(&wordId), &counter);
+        }
+        sSink += counter.mEntryCount;
+        return static_cast<int64_t>(wordIds.size());
+    }, results);
+
+    // Expands the whole trie, depth first.
+    runBenchmark(policyName, "createAndGetAllChildDicNodes", runCount, [&]() {
+        std::vector<DicNode> stack(1);
+        DicNodeUtils::initAsRoot(policy, WordIdArrayView(), &stack.back());
+        DicNodeVector childDicNodes;
+        int64_t expandedDicNodeCount = 0;
+        while (!stack.empty()) {
+            const DicNode dicNode(stack.back());
+            stack.pop_back();
+            childDicNodes.clear();
+            policy->createAndGetAllChildDicNodes(&dicNode, &childDicNodes);
+            ++expandedDicNodeCount;
+            const int childCount = childDicNodes.getSizeAndLock();
+            for (int i = 0; i < childCount; ++i) {
+                if (childDicNodes[i]->hasChildren()) {
+                    stack.push_back(*childDicNodes[i]);
+                }
+            }
+        }
+        return expandedDicNodeCount;
+    }, results);
+}
+
+// Adds all the words and their ngrams of sourcePolicy to a new v403 dictionary. Runs the GC by
+// flushing to workPath when needed, as BinaryDictionary.migrateNative does.
+StructurePolicyPtr migrateToVer4(DictionaryStructureWithBufferPolicy *const sourcePolicy,
+        const std::vector<Word> &words, const char *const workPath, const int runCount,
+        std::vector<Result> *const results) {
+    const DictionaryHeaderStructurePolicy *const headerPolicy =
+            sourcePolicy->getHeaderStructurePolicy();
+    std::vector<WordProperty> wordProperties;
+    for (const Word &word : words) {
+        wordProperties.push_back(sourcePolicy->getWordProperty(word.getCodePoints()));
+    }
+    StructurePolicyPtr policy;
+    bool succeeded = true;
+    const auto runGCIfNeeded = [&]() {
+        if (policy->needsToRunGC(true /* mindsBlockByGC */)) {
+            policy->flushWithGC(workPath);
+            policy = DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(
+                    workPath, 0 /* bufOffset */, 0 /* size */, true /* isUpdatable */);
+        }
+        return policy != nullptr;
+    };
+    for (int run = 0; run < runCount && succeeded; ++run) {
+        const bool isLastRun = run == runCount - 1;
+        std::vector<Result> runResults;
+        policy = DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
+                FormatUtils::VERSION_403, *headerPolicy->getLocale(),
+                headerPolicy->getAttributeMap());
+        if (!policy) {
+            return nullptr;
+        }
+        runBenchmark("v403", "addUnigramEntry", 1 /* runCount */, [&]() {
+            for (size_t i = 0; i < words.size() && succeeded; ++i) {
+                succeeded = runGCIfNeeded() && policy->addUnigramEntry(words[i].getCodePoints(),
+                        &wordProperties[i].getUnigramProperty());
+            }
+            return static_cast<int64_t>(words.size());
+        }, &runResults);
+        runBenchmark("v403", "addNgramEntry", 1 /* runCount */, [&]() {
+            int64_t ngramCount = 0;
+            for (size_t i = 0; i < words.size() && succeeded; ++i) {
+                succeeded = runGCIfNeeded();
+                for (const NgramProperty &ngramProperty : wordProperties[i].getNgramProperties()) {
+                    if (!succeeded) {
+                        break;
+                    }
+                    succeeded = policy->addNgramEntry(&ngramProperty);
+                    ++ngramCount;
+                }
+            }
+            return ngramCount;
+        }, &runResults);
+        runBenchmark("v403", "flushWithGC", 1 /* runCount */, [&]() {
+            succeeded = succeeded && policy->flushWithGC(workPath);
+            return static_cast<int64_t>(1);
+        }, &runResults);
+        for (size_t i = 0; i < runResults.size(); ++i) {
+            if (run == 0) {
+                results->push_back(runResults[i]);
+            } else {
+                Result &result = (*results)[results->size() - runResults.size() + i];
+                result.mBestRunUs = std::min(result.mBestRunUs, runResults[i].mBestRunUs);
+            }
+        }
+        if (!isLastRun) {
+            FileUtils::removeDirAndFiles(workPath);
+        }
+    }
+    if (!succeeded) {
+        return nullptr;
+    }
+    policy.reset();
+    return DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(workPath,
+            0 /* bufOffset */, 0 /* size */, false /* isUpdatable */);
+}
+
+// The autocorrection threshold compares the typed word with each candidate; neighbouring words in
+// the dictionary order stand in for those, as they share a prefix and differ in a few letters.
+void runEditDistanceBenchmarks(const std::vector<Word> &words, const int runCount,
+        std::vector<Result> *const results) {
+    runBenchmark("table", "editDistance", runCount, [&]() {
+        int64_t distanceSum = 0;
+        for (size_t i = 1; i < words.size(); ++i) {
+            const DamerauLevenshteinEditDistancePolicy policy(words[i - 1].mCodePoints,
+                    words[i - 1].mCodePointCount, words[i].mCodePoints, words[i].mCodePointCount);
+            distanceSum += static_cast<int>(EditDistance::getEditDistance(&policy));
+        }
+        sSink += distanceSum;
+        return static_cast<int64_t>(words.size() - 1);
+    }, results);
+    runBenchmark("bit_parallel", "editDistance", runCount, [&]() {
+        int64_t distanceSum = 0;
+        for (size_t i = 1; i < words.size(); ++i) {
+            distanceSum += EditDistance::getDamerauLevenshteinEditDistance(
+                    words[i - 1].mCodePoints, words[i - 1].mCodePointCount,
+                    words[i].mCodePoints, words[i].mCodePointCount);
+        }
+        sSink += distanceSum;
+        return static_cast<int64_t>(words.size() - 1);
+    }, results);
+}
+
+void printResults(const char *const dictPath, const int wordCount,
+        const std::vector<Result> &results) {
+    printf("{\n  \"dict\": \"%s\",\n  \"words\": %d,\n  \"results\": [\n", dictPath, wordCount);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result &result = results[i];
+        const double nsPerOperation = result.mOperationCount > 0
+                ? static_cast<double>(result.mBestRunUs) * 1000.0 / result.mOperationCount : 0.0;
+        printf("    {\"policy\": \"%s\", \"benchmark\": \"%s\", \"operations\": %lld, "
+                "\"best_run_us\": %lld, \"ns_per_operation\": %.1f}%s\n",
+                result.mPolicyName.c_str(), result.mBenchmarkName.c_str(),
+                static_cast<long long>(result.mOperationCount),
+                static_cast<long long>(result.mBestRunUs), nsPerOperation,
+                i + 1 < results.size() ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+void usage(const char *const argv0) {
+    fprintf(stderr, "usage: %s -d main.dict [-w work_dir] [-r runs]\n", argv0);
+}
+
+int run(int argc, char **argv) {
+    const char *dictPath = nullptr;
+    std::string workPath;
+    int runCount = 3;
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char *const arg = argv[i];
+        const char *const value = argv[++i];
+        if (strcmp(arg, "-d") == 0) {
+            dictPath = value;
+        } else if (strcmp(arg, "-w") == 0) {
+            workPath = value;
+        } else if (strcmp(arg, "-r") == 0) {
+            runCount = std::max(1, atoi(value));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!dictPath) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (workPath.empty()) {
+        workPath = std::string(dictPath) + ".v4bench";
+    }
+
+    const int dictSize = FileUtils::getFileSize(dictPath);
+    StructurePolicyPtr ver2Policy =
+            DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(dictPath,
+                    0 /* bufOffset */, dictSize, false /* isUpdatable */);
+    if (!ver2Policy || ver2Policy->getHeaderStructurePolicy()->getFormatVersionNumber()
+            != FormatUtils::VERSION_202) {
+        fprintf(stderr, "%s is not a v2 dictionary\n", dictPath);
+        return 1;
+    }
+    std::vector<Result> results;
+    runReadBenchmarks("v2", ver2Policy.get(), runCount, &results);
+
+    const std::vector<Word> words = getAllWords(ver2Policy.get());
+    StructurePolicyPtr ver4Policy = migrateToVer4(ver2Policy.get(), words, workPath.c_str(),
+            runCount, &results);
+    if (!ver4Policy) {
+        fprintf(stderr, "Cannot migrate %s to v403 in %s\n", dictPath, workPath.c_str());
+        FileUtils::removeDirAndFiles(workPath.c_str());
+        return 1;
+    }
+    runReadBenchmarks("v403", ver4Policy.get(), runCount, &results);
+    runEditDistanceBenchmarks(words, runCount, &results);
+    ver4Policy.reset();
+    FileUtils::removeDirAndFiles(workPath.c_str());
+
+    printResults(dictPath, static_cast<int>(words.size()), results);
+    return 0;
+}
+
+} // namespace
+} // namespace latinime
+
+int main(int argc, char **argv) {
+    return latinime::run(argc, argv);
+}
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays the corpus of a dictionary format fuzzer as a performance regression set, built for the
+// host by HostUnitTests.mk:
+//   latinime_dict_corpus_bench -f header|v2|v4 [-r runs] [-t max_ms] input...
+//   latinime_dict_corpus_bench -g out_dir
+//
+// Every input file, or every file of an input directory, is opened and traversed the way the
+// fuzzer of the format does, see DictFuzzUtils. The best run of each input is reported as JSON on
+// the standard output, and the exit code is 2 if an input took longer than max_ms.
+//
+// With -g, pathological v4 inputs are written to out_dir to seed the corpus of the v4 fuzzer: a
+// deep and wide trie, max-length words and a word with a huge ngram fanout. The v2 and header
+// fuzzers are seeded with the shipped dictionaries, since there is no native v2 writer.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include "defines.h"
+#include "dict_fuzz_utils.h"
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "dictionary/property/historical_info.h"
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/property/ngram_property.h"
+#include "dictionary/property/unigram_property.h"
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/utils/file_utils.h"
+#include "dictionary/utils/format_utils.h"
+#include "utils/int_array_view.h"
+#include "utils/time_keeper.h"
+
+namespace latinime {
+namespace {
+
+typedef DictionaryStructureWithBufferPolicy::StructurePolicyPtr StructurePolicyPtr;
+
+const int MAX_LENGTH_WORD_COUNT = 5000;
+const int NGRAM_FANOUT = 5000;
+
+struct Input {
+    std::string mPath;
+    std::vector<uint8_t> mData;
+};
+
+bool readInput(const std::string &path, std::vector<Input> *const outInputs) {
+    struct stat pathStat;
+    if (stat(path.c_str(), &pathStat) != 0) {
+        fprintf(stderr, "Cannot read %s\n", path.c_str());
+        return false;
+    }
+    if (S_ISDIR(pathStat.st_mode)) {
+        DIR *const dir = opendir(path.c_str());
+        if (!dir) {
+            fprintf(stderr, "Cannot read %s\n", path.c_str());
+            return false;
+        }
+        std::vector<std::string> names;
+        while (const struct dirent *const entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                names.push_back(entry->d_name);
+            }
+        }
+        closedir(dir);
+        // Sorted, so that the output of two runs can be compared line by line.
+        std::sort(names.begin(), names.end());
+        for (const std::string &name : names) {
+            if (!readInput(path + "/" + name, outInputs)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    Input input{path, std::vector<uint8_t>()};
+    FILE *const file = fopen(path.c_str(), "rb");
+    if (!file) {
+        fprintf(stderr, "Cannot read %s\n", path.c_str());
+        return false;
+    }
+    input.mData.resize(pathStat.st_size);
+    const bool succeeded = fread(input.mData.data(), 1, input.mData.size(), file)
+            == input.mData.size();
+    fclose(file);
+    if (!succeeded) {
+        fprintf(stderr, "Cannot read %s\n", path.c_str());
+        return false;
+    }
+    outInputs->push_back(std::move(input));
+    return true;
+}
+
+std::vector<int> toCodePoints(const std::string &word) {
+    return std::vector<int>(word.begin(), word.end());
+}
+
+// Builds a v403 dictionary from the unigrams and the ngrams, all from the first unigram to the
+// others if withNgramFanout, and writes it packed as a v4 fuzzer input.
+bool writeVer4Input(const std::string &outDirPath, const char *const name,
+        const std::vector<std::string> &words, const bool withNgramFanout) {
+    const std::string dictDirPath = outDirPath + "/" + name + ".dict";
+    const std::vector<int> locale = toCodePoints("en");
+    const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+    StructurePolicyPtr policy =
+            DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
+                    FormatUtils::VERSION_403, locale, &attributeMap);
+    if (!policy) {
+        return false;
+    }
+    // Runs the GC by flushing when needed, as BinaryDictionary.migrateNative does.
+    const auto runGCIfNeeded = [&]() {
+        if (policy->needsToRunGC(true /* mindsBlockByGC */)) {
+            policy->flushWithGC(dictDirPath.c_str());
+            policy = DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(
+                    dictDirPath.c_str(), 0 /* bufOffset */, 0 /* size */, true /* isUpdatable */);
+        }
+        return policy != nullptr;
+    };
+    const UnigramProperty unigramProperty(false /* representsBeginningOfSentence */,
+            false /* isNotAWord */, false /* isPossiblyOffensive */, 100 /* probability */,
+            HistoricalInfo());
+    for (const std::string &word : words) {
+        const std::vector<int> codePoints = toCodePoints(word);
+        if (!runGCIfNeeded() || !policy->addUnigramEntry(
+                CodePointArrayView(codePoints), &unigramProperty)) {
+            return false;
+        }
+    }
+    if (withNgramFanout && !words.empty()) {
+        const std::vector<int> prevWord = toCodePoints(words[0]);
+        const NgramContext ngramContext(prevWord.data(), static_cast<int>(prevWord.size()),
+                false /* isBeginningOfSentence */);
+        for (size_t i = 1; i < words.size(); ++i) {
+            const NgramProperty ngramProperty(ngramContext, toCodePoints(words[i]),
+                    100 /* probability */, HistoricalInfo());
+            // Entries beyond the ngram count limit are dropped, which is fine for a seed.
+            if (!runGCIfNeeded()) {
+                return false;
+            }
+            policy->addNgramEntry(&ngramProperty);
+        }
+    }
+    std::vector<uint8_t> data;
+    const bool succeeded = policy->flushWithGC(dictDirPath.c_str())
+            && DictFuzzUtils::packVer4Dict(dictDirPath.c_str(), &data);
+    policy.reset();
+    FileUtils::removeDirAndFiles(dictDirPath.c_str());
+    if (!succeeded) {
+        return false;
+    }
+    const std::string outPath = outDirPath + "/" + name;
+    FILE *const file = fopen(outPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && written;
+}
+
+int generate(const char *const outDirPath) {
+    // Every prefix of a max-length word, each with all the other letters as a sibling.
+    std::vector<std::string> deepTrieWords;
+    for (int depth = 1; depth <= MAX_WORD_LENGTH; ++depth) {
+        const std::string prefix(depth - 1, 'a');
+        for (char c = 'a'; c <= 'z'; ++c) {
+            deepTrieWords.push_back(prefix + c);
+        }
+    }
+    // Random words, so that they barely share prefixes.
+    std::vector<std::string> maxLengthWords;
+    uint32_t random = 1;
+    for (int i = 0; i < MAX_LENGTH_WORD_COUNT; ++i) {
+        std::string word;
+        for (int j = 0; j < MAX_WORD_LENGTH; ++j) {
+            random = random * 1103515245u + 12345u;
+            word += static_cast<char>('a' + (random >> 16) % 26);
+        }
+        maxLengthWords.push_back(word);
+    }
+    std::vector<std::string> fanoutWords;
+    for (int i = 0; i <= NGRAM_FANOUT; ++i) {
+        fanoutWords.push_back("w" + std::to_string(i));
+    }
+    if (!writeVer4Input(outDirPath, "deep_trie", deepTrieWords, false /* withNgramFanout */)
+            || !writeVer4Input(outDirPath, "max_length_words", maxLengthWords,
+                    false /* withNgramFanout */)
+            || !writeVer4Input(outDirPath, "ngram_fanout", fanoutWords,
+                    true /* withNgramFanout */)) {
+        fprintf(stderr, "Cannot write the inputs to %s\n", outDirPath);
+        return 1;
+    }
+    return 0;
+}
+
+void usage(const char *const argv0) {
+    fprintf(stderr, "usage: %s -f header|v2|v4 [-r runs] [-t max_ms] input...\n"
+            "       %s -g out_dir\n", argv0, argv0);
+}
+
+int run(int argc, char **argv) {
+    DictFuzzUtils::InputFormat inputFormat = DictFuzzUtils::INPUT_FORMAT_UNKNOWN;
+    int runCount = 3;
+    int64_t maxUs = 0;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; ++i) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char *const arg = argv[i];
+        const char *const value = argv[++i];
+        if (strcmp(arg, "-g") == 0) {
+            return generate(value);
+        } else if (strcmp(arg, "-f") == 0) {
+            inputFormat = DictFuzzUtils::getInputFormat(value);
+        } else if (strcmp(arg, "-r") == 0) {
+            runCount = std::max(1, atoi(value));
+        } else if (strcmp(arg, "-t") == 0) {
+            maxUs = static_cast<int64_t>(atoi(value)) * 1000;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (inputFormat == DictFuzzUtils::INPUT_FORMAT_UNKNOWN || i >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::vector<Input> inputs;
+    for (; i < argc; ++i) {
+        if (!readInput(argv[i], &inputs)) {
+            return 1;
+        }
+    }
+
+    bool isTooSlow = false;
+    printf("{\n  \"format\": \"%s\",\n  \"results\": [\n",
+            DictFuzzUtils::getInputFormatName(inputFormat));
+    for (size_t j = 0; j < inputs.size(); ++j) {
+        const Input &input = inputs[j];
+        int64_t visitedCount = 0;
+        int64_t bestRunUs = INT64_MAX;
+        for (int run = 0; run < runCount; ++run) {
+            const int64_t startTimeUs = TimeKeeper::getMonotonicTimeInMicroseconds();
+            visitedCount = DictFuzzUtils::openAndTraverse(inputFormat, input.mData.data(),
+                    input.mData.size());
+            bestRunUs = std::min(bestRunUs,
+                    TimeKeeper::getMonotonicTimeInMicroseconds() - startTimeUs);
+        }
+        const bool isInputTooSlow = maxUs > 0 && bestRunUs > maxUs;
+        isTooSlow = isTooSlow || isInputTooSlow;
+        printf("    {\"input\": \"%s\", \"bytes\": %zu, \"visited\": %lld, \"best_run_us\": %lld, "
+                "\"too_slow\": %s}%s\n", input.mPath.c_str(), input.mData.size(),
+                static_cast<long long>(visitedCount), static_cast<long long>(bestRunUs),
+                isInputTooSlow ? "true" : "false", j + 1 < inputs.size() ? "," : "");
+    }
+    printf("  ]\n}\n");
+    return isTooSlow ? 2 : 0;
+}
+
+} // namespace
+} // namespace latinime
+
+int main(int argc, char **argv) {
+    return latinime::run(argc, argv);
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dict_fuzz_utils.h"
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dictionary/header/header_policy.h"
+#include "dictionary/header/header_read_write_utils.h"
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "dictionary/property/word_property.h"
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/structure/v4/ver4_dict_constants.h"
+#include "dictionary/utils/byte_array_utils.h"
+#include "dictionary/utils/file_utils.h"
+#include "dictionary/utils/format_utils.h"
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_node_utils.h"
+#include "suggest/core/dicnode/dic_node_vector.h"
+#include "utils/byte_array_view.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+const char *const DictFuzzUtils::DICT_NAME = "fuzz_dict";
+
+/* static */ DictFuzzUtils::InputFormat DictFuzzUtils::getInputFormat(const char *const name) {
+    for (int i = 0; i < INPUT_FORMAT_UNKNOWN; ++i) {
+        const InputFormat inputFormat = static_cast<InputFormat>(i);
+        if (strcmp(name, getInputFormatName(inputFormat)) == 0) {
+            return inputFormat;
+        }
+    }
+    return INPUT_FORMAT_UNKNOWN;
+}
+
+/* static */ const char *DictFuzzUtils::getInputFormatName(const InputFormat inputFormat) {
+    switch (inputFormat) {
+        case INPUT_FORMAT_HEADER:
+            return "header";
+        case INPUT_FORMAT_V2:
+            return "v2";
+        case INPUT_FORMAT_V4:
+            return "v4";
+        default:
+            return "unknown";
+    }
+}
+
+/* static */ int64_t DictFuzzUtils::openAndTraverse(const InputFormat inputFormat,
+        const uint8_t *const data, const size_t size) {
+    if (inputFormat == INPUT_FORMAT_HEADER) {
+        return readHeader(data, size);
+    }
+    const std::string dictPath = std::string(getWorkDirPath()) + "/" + DICT_NAME;
+    if (inputFormat == INPUT_FORMAT_V2) {
+        if (!writeFile(dictPath, data, size)) {
+            return -1;
+        }
+    } else if (inputFormat == INPUT_FORMAT_V4) {
+        if (size < sizeof(uint32_t)) {
+            return -1;
+        }
+        const size_t headerSize = ByteArrayUtils::readUint32(data, 0 /* pos */);
+        if (headerSize > size - sizeof(uint32_t) || mkdir(dictPath.c_str(), S_IRWXU) != 0) {
+            return -1;
+        }
+        const uint8_t *const header = data + sizeof(uint32_t);
+        const std::string filePath = dictPath + "/" + DICT_NAME;
+        if (!writeFile(filePath + Ver4DictConstants::HEADER_FILE_EXTENSION, header, headerSize)
+                || !writeFile(filePath + Ver4DictConstants::BODY_FILE_EXTENSION,
+                        header + headerSize, size - sizeof(uint32_t) - headerSize)) {
+            FileUtils::removeDirAndFiles(dictPath.c_str());
+            return -1;
+        }
+    } else {
+        return -1;
+    }
+    int64_t visitedCount = -1;
+    {
+        // User dictionaries are directories opened for updating.
+        DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+                DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(
+                        dictPath.c_str(), 0 /* bufOffset */, static_cast<int>(size),
+                        inputFormat == INPUT_FORMAT_V4 /* isUpdatable */);
+        if (policy) {
+            visitedCount = traverse(policy.get(), size);
+        }
+    }
+    if (inputFormat == INPUT_FORMAT_V4) {
+        FileUtils::removeDirAndFiles(dictPath.c_str());
+    } else {
+        unlink(dictPath.c_str());
+    }
+    return visitedCount;
+}
+
+/* static */ int64_t DictFuzzUtils::readHeader(const uint8_t *const data, const size_t size) {
+    const FormatUtils::FORMAT_VERSION formatVersion =
+            FormatUtils::detectFormatVersion(ReadOnlyByteArrayView(data, size));
+    if (formatVersion == FormatUtils::UNKNOWN_VERSION
+            || static_cast<size_t>(HeaderReadWriteUtils::getHeaderSize(data)) > size) {
+        return -1;
+    }
+    const HeaderPolicy headerPolicy(data, formatVersion);
+    if (!headerPolicy.isValid()) {
+        return -1;
+    }
+    return static_cast<int64_t>(headerPolicy.getAttributeMap()->size());
+}
+
+/* static */ int64_t DictFuzzUtils::traverse(DictionaryStructureWithBufferPolicy *const policy,
+        const size_t dictSize) {
+    int64_t visitedCount = 0;
+    // Every word takes at least a byte, so a dictionary returning more words loops.
+    const int64_t maxWordCount = static_cast<int64_t>(dictSize) + 1;
+    int codePoints[MAX_WORD_LENGTH];
+    int codePointCount = 0;
+    int token = 0;
+    do {
+        token = policy->getNextWordAndNextToken(token, codePoints, &codePointCount,
+                nullptr /* outWordId */);
+        if (codePointCount <= 0 || codePointCount > MAX_WORD_LENGTH) {
+            continue;
+        }
+        const CodePointArrayView wordCodePoints(codePoints, codePointCount);
+        const int wordId = policy->getWordId(wordCodePoints, false /* forceLowerCaseSearch */);
+        policy->getCodePointsAndReturnCodePointCount(wordId, MAX_WORD_LENGTH, codePoints);
+        visitedCount += 1 + policy->getWordProperty(wordCodePoints).getNgramProperties().size();
+    } while (token != 0 && visitedCount < maxWordCount);
+
+    // Expands the whole trie, depth first, down to MAX_WORD_LENGTH so that cycles end.
+    std::vector<DicNode> stack(1);
+    DicNodeUtils::initAsRoot(policy, WordIdArrayView(), &stack.back());
+    DicNodeVector childDicNodes;
+    while (!stack.empty() && !policy->isCorrupted()) {
+        const DicNode dicNode(stack.back());
+        stack.pop_back();
+        childDicNodes.clear();
+        policy->createAndGetAllChildDicNodes(&dicNode, &childDicNodes);
+        ++visitedCount;
+        const int childCount = childDicNodes.getSizeAndLock();
+        for (int i = 0; i < childCount; ++i) {
+            if (childDicNodes[i]->hasChildren()
+                    && childDicNodes[i]->getNodeCodePointCount() < MAX_WORD_LENGTH) {
+                stack.push_back(*childDicNodes[i]);
+            }
+        }
+    }
+    return visitedCount;
+}
+
+/* static */ bool DictFuzzUtils::packVer4Dict(const char *const dictDirPath,
+        std::vector<uint8_t> *const outData) {
+    const int nameBufSize = strlen(dictDirPath) + 1 /* terminator */;
+    char name[nameBufSize];
+    FileUtils::getBasename(dictDirPath, nameBufSize, name);
+    const std::string filePath = std::string(dictDirPath) + "/" + name;
+    std::vector<uint8_t> header;
+    std::vector<uint8_t> body;
+    if (!readFile(filePath + Ver4DictConstants::HEADER_FILE_EXTENSION, &header)
+            || !readFile(filePath + Ver4DictConstants::BODY_FILE_EXTENSION, &body)) {
+        return false;
+    }
+    outData->resize(sizeof(uint32_t));
+    int pos = 0;
+    ByteArrayUtils::writeUintAndAdvancePosition(outData->data(),
+            static_cast<uint32_t>(header.size()), sizeof(uint32_t), &pos);
+    outData->insert(outData->end(), header.begin(), header.end());
+    outData->insert(outData->end(), body.begin(), body.end());
+    return true;
+}
+
+/* static */ const char *DictFuzzUtils::getWorkDirPath() {
+    static char workDirPath[PATH_MAX];
+    static std::once_flag onceFlag;
+    std::call_once(onceFlag, []() {
+        const char *const tmpDir = getenv("TMPDIR");
+        snprintf(workDirPath, NELEMS(workDirPath), "%s/latinime_fuzz_XXXXXX",
+                tmpDir ? tmpDir : "/tmp");
+        if (!mkdtemp(workDirPath)) {
+            AKLOGE("Cannot create the work directory %s.", workDirPath);
+            abort();
+        }
+        // The inputs are removed after each run, so the directory is empty at exit.
+        atexit([]() { rmdir(workDirPath); });
+    });
+    return workDirPath;
+}
+
+/* static */ bool DictFuzzUtils::writeFile(const std::string &path, const uint8_t *const data,
+        const size_t size) {
+    FILE *const file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const bool succeeded = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && succeeded;
+}
+
+/* static */ bool DictFuzzUtils::readFile(const std::string &path,
+        std::vector<uint8_t> *const outData) {
+    const int fileSize = FileUtils::getFileSize(path.c_str());
+    if (fileSize < 0) {
+        return false;
+    }
+    FILE *const file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    outData->resize(fileSize);
+    const bool succeeded = fread(outData->data(), 1, fileSize, file)
+            == static_cast<size_t>(fileSize);
+    fclose(file);
+    return succeeded;
+}
+
+} // namespace latinime
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_DICT_FUZZ_UTILS_H
+#define LATINIME_DICT_FUZZ_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+
+namespace latinime {
+
+class DictionaryStructureWithBufferPolicy;
+
+// The inputs of the dictionary format fuzzers, shared with dict_corpus_bench.cpp so that the
+// corpus of a fuzzer can be replayed as a performance regression set.
+//
+// A header or v2 input is the content of a dictionary file. A v4 input packs the two files of a
+// dictionary directory: the size of the header file as a big-endian uint32, the header file, then
+// the body file.
+class DictFuzzUtils {
+ public:
+    enum InputFormat {
+        INPUT_FORMAT_HEADER,
+        INPUT_FORMAT_V2,
+        INPUT_FORMAT_V4,
+        INPUT_FORMAT_UNKNOWN,
+    };
+
+    static InputFormat getInputFormat(const char *const name);
+    static const char *getInputFormatName(const InputFormat inputFormat);
+
+    // Opens the input the way the format is opened by the app, with the policy factory, and
+    // traverses it with traverse(). Returns the visited entry count, or -1 if it cannot be opened.
+    static int64_t openAndTraverse(const InputFormat inputFormat, const uint8_t *const data,
+            const size_t size);
+
+    // Reads the whole header of a dictionary file, with the attribute map. Returns the attribute
+    // count, or -1 if the format is not known.
+    static int64_t readHeader(const uint8_t *const data, const size_t size);
+
+    // Visits all the words with their ngrams and all the PtNodes of the trie. Each loop is bounded,
+    // so that a corrupted dictionary cannot make it run forever.
+    static int64_t traverse(DictionaryStructureWithBufferPolicy *const policy,
+            const size_t dictSize);
+
+    // Packs the files of a v4 dictionary directory into a v4 input.
+    static bool packVer4Dict(const char *const dictDirPath, std::vector<uint8_t> *const outData);
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(DictFuzzUtils);
+
+    static const char *const DICT_NAME;
+
+    // A directory created once per process, where the inputs are written to be opened.
+    static const char *getWorkDirPath();
+    static bool writeFile(const std::string &path, const uint8_t *const data, const size_t size);
+    static bool readFile(const std::string &path, std::vector<uint8_t> *const outData);
+};
+} // namespace latinime
+#endif // LATINIME_DICT_FUZZ_UTILS_H
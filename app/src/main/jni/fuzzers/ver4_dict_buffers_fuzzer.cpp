@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Fuzzes opening a v4 dictionary directory with Ver4DictBuffers and traversing it. The inputs pack
+// the header and body files, see DictFuzzUtils.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "dict_fuzz_utils.h"
+
+using latinime::DictFuzzUtils;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    DictFuzzUtils::openAndTraverse(DictFuzzUtils::INPUT_FORMAT_V4, data, size);
+    return 0;
+}
@@ -1,7 +1,11 @@
 #include <string>
 #include <vector>
-#include <map>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <utility>
 #include <jni.h>
 #include <bits/sysconf.h>
@@ -10,20 +14,226 @@
 #include "helium314_keyboard_voice_whisper_WhisperGGML.h"
 #include "jni_common.h"
 #include "src/jni_utils.h"
+#include "src/utils/native_sampling_profiler.h"
+#include "src/utils/native_trace.h"
+
+static const int STREAM_SAMPLE_RATE = 16000;
+// Samples per unit of the segment timestamps, which are in 10 ms.
+static const int STREAM_SAMPLES_PER_TIMESTAMP = STREAM_SAMPLE_RATE / 100;
+// New audio needed before the window is decoded again.
+static const size_t STREAM_STEP_SAMPLES = 2 * STREAM_SAMPLE_RATE;
+// Segments ending closer than this to the end of the window may still change.
+static const size_t STREAM_GUARD_SAMPLES = STREAM_SAMPLE_RATE;
+// Longer windows commit their segments without waiting for the next window to agree, which keeps
+// the window inside the 30 s the encoder sees.
+static const size_t STREAM_MAX_WINDOW_SAMPLES = 24 * STREAM_SAMPLE_RATE;
+// Committed text passed as the prompt of the next window.
+static const size_t STREAM_MAX_PROMPT_CHARS = 200;
+
+// The longest prompt that is passed to whisper_full, the limit whisper_full tokenizes it with.
+static const int PROMPT_MAX_TOKENS = 1024;
+
+// Voice activity detection works on 10 ms frames of the 16 kHz audio.
+static const size_t VAD_FRAME_SAMPLES = STREAM_SAMPLES_PER_TIMESTAMP;
+// Frames louder than this multiple of the noise floor are speech. The floor is the energy of the
+// quietest fifth of the frames.
+static const float VAD_NOISE_FLOOR_RATIO = 8.0f;
+static const size_t VAD_NOISE_FLOOR_PERCENTILE = 20;
+// Mean square below which a frame is silence however quiet the floor is (about -50 dBFS).
+static const float VAD_MIN_SPEECH_ENERGY = 1e-5f;
+// Shorter runs of loud frames are clicks and taps rather than speech.
+static const size_t VAD_MIN_SPEECH_FRAMES = 5;
+// Audio kept around speech so that soft onsets and trailing consonants are not cut. A pause
+// longer than VAD_MAX_PAUSE_FRAMES shrinks to the sum of the two paddings.
+static const size_t VAD_PADDING_BEFORE_FRAMES = 20;
+static const size_t VAD_PADDING_AFTER_FRAMES = 30;
+static const size_t VAD_MAX_PAUSE_FRAMES = 100;
+
+// Devices with at most this much RAM run the whisper state under LOW_RAM_MEMORY_BUDGET, which frees the
+// encoder buffers while decoding and shortens the text context, so that voice input is less likely to get
+// the keyboard killed.
+static const int64_t LOW_RAM_DEVICE_BYTES = 4LL << 30;
+static const size_t LOW_RAM_MEMORY_BUDGET = 48 << 20;
+
+// Recordings longer than this are split at pauses into chunks that are transcribed at the same time,
+// each on its own whisper state, as whisper_full would otherwise decode their 30 s windows one after
+// the other. Not on low RAM devices, as every state has its own buffers.
+static const size_t PARALLEL_MIN_SAMPLES = 30 * STREAM_SAMPLE_RATE;
+// The matrix multiplications of a state scale poorly beyond a few threads, so the threads are
+// better spent on more states, as long as each has at least this many.
+static const int PARALLEL_MIN_THREADS_PER_STATE = 2;
+static const int PARALLEL_MAX_STATES = 4;
+// A split is moved to the quietest PARALLEL_SPLIT_WINDOW_FRAMES frames within this many frames of
+// where the chunks would have the same length, so that it falls into a pause rather than a word.
+static const size_t PARALLEL_SPLIT_SEARCH_FRAMES = 500;
+static const size_t PARALLEL_SPLIT_WINDOW_FRAMES = 20;
+// The language of chunked speech is detected on an encoding of this much of its start, see
+// whisperFullInChunks. whisper_full detects it again on the whole first chunk below the threshold.
+static const int PARALLEL_LANG_DETECT_MS = 5000;
+static const float PARALLEL_LANG_DETECT_THOLD = 0.7f;
+
+static bool isLowRamDevice() {
+    const int64_t ram = (int64_t) sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGE_SIZE);
+    return ram > 0 && ram <= LOW_RAM_DEVICE_BYTES;
+}
+
+// The encoder matrices of F16 models are quantized while loading, so that the encoder, most of the
+// latency of a dictation, uses the integer dot products. Quantized models are used as they are.
+static const ggml_type ENCODER_WEIGHT_TYPE = GGML_TYPE_Q8_0;
+
+static whisper_context_params contextParams() {
+    whisper_context_params cparams = { .use_gpu = false, .use_mmap = true, .type_k = GGML_TYPE_Q8_0, .flash_attn = true, .mem_budget = 0,
+                                       .encoder_wtype = ENCODER_WEIGHT_TYPE };
+
+    if (isLowRamDevice()) {
+        cparams.mem_budget = LOW_RAM_MEMORY_BUDGET;
+    }
+
+    return cparams;
+}
+
+// Dictation that is transcribed while the audio arrives. The audio after the committed offset is
+// decoded again every STREAM_STEP_SAMPLES, and a segment is committed once two windows agree on it,
+// so finishing the stream only decodes the audio after the last commit.
+struct WhisperStream {
+    bool active = false;
+
+    std::string prompt;
+    std::vector<int> allowed_languages;
+    std::vector<int> forbidden_languages;
+    int decoding_mode = 0;
+    bool suppress_non_speech = false;
+
+    std::vector<float> samples;
+    size_t committed_samples = 0;
+    size_t decoded_samples = 0;
+    std::string committed_text;
+    // Segment texts of the last window, from the committed offset.
+    std::vector<std::string> window_segments;
+    // The language of the first decoded window, used for the later ones.
+    int language_id = -1;
+    int bail_language_id = -1;
+};
+
+// The partial results are sent at most this often while whisper_full decodes.
+static const int PARTIAL_RESULT_DEFAULT_INTERVAL_MS = 100;
+
+// Text of the partial results while whisper_full decodes: the segments it has finished, followed
+// by the text tokens of the segment being decoded.
+struct PartialText {
+    int segment = 0;
+    size_t segment_start = 0;
+    std::vector<whisper_token> tokens;
+    // Size of the text after each token.
+    std::vector<size_t> token_ends;
+    std::string text;
+
+    bool changed = false;
+    std::chrono::steady_clock::time_point sent_time;
+};
 
 struct WhisperModelState {
     JNIEnv *env;
     jobject partial_result_instance;
     jmethodID partial_result_method;
-    int n_threads = 4;
     struct whisper_context *context = nullptr;
 
     std::vector<int> last_forbidden_languages;
-    std::map<int, std::string> partial_results;
+    PartialText partial;
+    int partial_interval_ms = PARTIAL_RESULT_DEFAULT_INTERVAL_MS;
+    // UTF-8 bytes of the last partial result, which partial_buffer wraps for Java.
+    std::vector<char> partial_bytes;
+    jobject partial_buffer = nullptr;
+
+    WhisperStream stream;
+    // The log mel frames of the stream audio, so that a partial window only computes the frames of
+    // the audio added since the previous one. Created by the first stream.
+    struct whisper_mel_stream *mel_stream = nullptr;
+
+    // The last prompt and its tokens. The tokenizer of whisper.cpp runs a regular expression over
+    // the text, which takes a while for long vocabulary prompts, and the prompt rarely changes
+    // between decodes.
+    std::string prompt_text;
+    std::vector<whisper_token> prompt_tokens;
+    bool has_prompt_tokens = false;
 
     volatile int cancel_flag = 0;
+    // Cleared when the model is evicted for being idle, so that the next warmup resumes it.
+    bool warmed_up = false;
+
+    // Held while the context or the stream is used, so that trimMemoryNative and the idle eviction can
+    // skip a busy model.
+    std::mutex mutex;
+
+    // The idle eviction, see setIdleTimeoutNative. Guarded by idle_mutex, which is taken after mutex.
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+    std::thread idle_thread;
+    int idle_timeout_ms = 0;
+    std::chrono::steady_clock::time_point last_used = std::chrono::steady_clock::now();
+    bool evicted = false;
+    bool closing = false;
+};
+
+// Holds the mutex of the model while its context or stream is used, and restarts the idle timeout
+// when the use ends.
+struct ModelUse {
+    explicit ModelUse(WhisperModelState *state) : state(state), lock(state->mutex) {}
+
+    ~ModelUse() {
+        std::lock_guard<std::mutex> idle_lock(state->idle_mutex);
+        state->last_used = std::chrono::steady_clock::now();
+        state->evicted = false;
+        state->idle_cv.notify_one();
+    }
+
+    WhisperModelState *const state;
+    std::lock_guard<std::mutex> lock;
 };
 
+// Frees the compute buffers and the KV caches of a model that has been idle for its timeout and
+// advises its weights cold. Returns false if the model is busy or a stream is open.
+static bool evictIdleModel(WhisperModelState *state) {
+    std::unique_lock<std::mutex> lock(state->mutex, std::try_to_lock);
+    if(!lock.owns_lock() || state->stream.active) {
+        return false;
+    }
+
+    const size_t freed = whisper_trim_memory(state->context, true);
+    const size_t advised = whisper_advise_weights_cold(state->context);
+    state->warmed_up = false;
+    AKLOGI("[VOICE] Idle for %d ms, freed %.1f MB and advised %.1f MB of weights cold",
+           state->idle_timeout_ms, freed / 1e6, advised / 1e6);
+
+    std::lock_guard<std::mutex> idle_lock(state->idle_mutex);
+    state->evicted = true;
+    return true;
+}
+
+// Evicts the model once it has not been used for idle_timeout_ms, until closeNative.
+static void idleLoop(WhisperModelState *state) {
+    std::unique_lock<std::mutex> idle_lock(state->idle_mutex);
+    while(!state->closing) {
+        if(state->idle_timeout_ms <= 0 || state->evicted) {
+            state->idle_cv.wait(idle_lock);
+            continue;
+        }
+        const auto deadline = state->last_used + std::chrono::milliseconds(state->idle_timeout_ms);
+        if(std::chrono::steady_clock::now() < deadline) {
+            state->idle_cv.wait_until(idle_lock, deadline);
+            continue;
+        }
+
+        idle_lock.unlock();
+        const bool evicted = evictIdleModel(state);
+        idle_lock.lock();
+        if(!evicted) {
+            // Busy or streaming, try again after another timeout.
+            state->last_used = std::chrono::steady_clock::now();
+        }
+    }
+}
+
 JNIEXPORT jlong JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_openNative
   (JNIEnv *env, jobject obj, jstring model_path) {
     std::string model_path_str = jstring2string(env, model_path);
@@ -31,7 +241,7 @@ JNIEXPORT jlong JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_openNa
     auto *state = new WhisperModelState();
 
     AKLOGI("Attempting to load model from file...");
-    state->context = whisper_init_from_file_with_params(model_path_str.c_str(), { .use_gpu = false });
+    state->context = whisper_init_from_file_with_params(model_path_str.c_str(), contextParams());
 
     if(!state->context){
         AKLOGE("Failed to initialize whisper_context from path %s", model_path_str.c_str());
@@ -50,7 +260,7 @@ JNIEXPORT jlong JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_openFr
     auto *state = new WhisperModelState();
 
     AKLOGI("Attempting to load model from buffer...");
-    state->context = whisper_init_from_buffer_with_params(buffer_address, buffer_capacity, { .use_gpu = false });
+    state->context = whisper_init_from_buffer_with_params(buffer_address, buffer_capacity, contextParams());
 
     if(!state->context){
         AKLOGE("Failed to initialize whisper_context from direct buffer");
@@ -61,62 +271,84 @@ JNIEXPORT jlong JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_openFr
     return reinterpret_cast<jlong>(state);
 }
 
-JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_inferNative
-  (JNIEnv *env, jobject instance, jlong handle, jfloatArray samples_array, jstring prompt,
-   jobjectArray languages, jobjectArray bail_languages, jint decoding_mode, jboolean suppress_non_speech) {
-
-    AKLOGI("[VOICE] ===== Native inferNative() =====");
-
-    auto *state = reinterpret_cast<WhisperModelState *>(handle);
-    state->cancel_flag = 0;
+// Points wparams at the tokens of the prompt, which the state keeps until the prompt changes.
+static void setPrompt(WhisperModelState *state, whisper_full_params &wparams,
+        const std::string &prompt) {
+    if(!state->has_prompt_tokens || prompt != state->prompt_text) {
+        state->prompt_text = prompt;
+        state->prompt_tokens.resize(PROMPT_MAX_TOKENS);
+        const int n_tokens = whisper_tokenize(state->context, prompt.c_str(),
+                state->prompt_tokens.data(), PROMPT_MAX_TOKENS);
+        // whisper_full also drops a prompt that is too long.
+        state->prompt_tokens.resize(std::max(n_tokens, 0));
+        state->has_prompt_tokens = true;
+    }
+    wparams.initial_prompt = nullptr;
+    wparams.prompt_tokens = state->prompt_tokens.data();
+    wparams.prompt_n_tokens = (int)state->prompt_tokens.size();
+}
 
-    std::vector<int> allowed_languages;
+static std::vector<int> readLanguageIds(JNIEnv *env, jobjectArray languages, const char *label) {
+    std::vector<int> language_ids;
     int num_languages = env->GetArrayLength(languages);
-    AKLOGI("[VOICE] Number of languages received: %d", num_languages);
+    AKLOGI("[VOICE] %s count: %d", label, num_languages);
 
     for (int i=0; i<num_languages; i++) {
         jstring jstr = static_cast<jstring>(env->GetObjectArrayElement(languages, i));
         std::string str = jstring2string(env, jstr);
         int lang_id = whisper_lang_id(str.c_str());
 
-        AKLOGI("[VOICE] Language[%d]: '%s' -> whisper_lang_id=%d", i, str.c_str(), lang_id);
-        allowed_languages.push_back(lang_id);
-    }
-
-    std::vector<int> forbidden_languages;
-    int num_bail_languages = env->GetArrayLength(bail_languages);
-    AKLOGI("[VOICE] Number of bail languages: %d", num_bail_languages);
-
-    for (int i=0; i<num_bail_languages; i++) {
-        jstring jstr = static_cast<jstring>(env->GetObjectArrayElement(bail_languages, i));
-        std::string str = jstring2string(env, jstr);
-        int lang_id = whisper_lang_id(str.c_str());
-
-        AKLOGI("[VOICE] Bail language[%d]: '%s' -> whisper_lang_id=%d", i, str.c_str(), lang_id);
-        forbidden_languages.push_back(lang_id);
+        AKLOGI("[VOICE] %s[%d]: '%s' -> whisper_lang_id=%d", label, i, str.c_str(), lang_id);
+        language_ids.push_back(lang_id);
     }
+    return language_ids;
+}
 
-    state->last_forbidden_languages = forbidden_languages;
-
-    size_t num_samples = env->GetArrayLength(samples_array);
-    jfloat *samples = env->GetFloatArrayElements(samples_array, nullptr);
+// wparams keeps pointing into allowed_languages, which must outlive the whisper_full call.
+// One thread per big core on big.LITTLE devices: every ggml barrier waits for the slowest thread,
+// so a thread on a little core slows down all the others. ggml keeps these threads on the big cores.
+static int threadCount() {
+    const int n_big = ggml_cpu_n_big_cores();
+    if(n_big >= 2) return std::min(n_big, 16);
 
     long num_procs = sysconf(_SC_NPROCESSORS_ONLN);
     if(num_procs < 2 || num_procs > 16) num_procs = 6; // Make sure the number is sane
+    return (int)num_procs;
+}
 
+// Sizes the encoder context and picks segment timestamps for audio of num_samples samples.
+static void setAudioLength(whisper_full_params &wparams, size_t num_samples) {
+    // The encoder buffers are sized for the full 1500 context when the state is created, so a new
+    // audio_ctx only costs rebuilding the graph (well under a millisecond). Rounding it up to
+    // shared sizes would encode up to several seconds of padding for nothing.
+    // With speed_up the audio is compressed 2x in time by WSOLA first, halving the encoder context.
+    const size_t num_encoded_samples = wparams.speed_up ? num_samples / 2 : num_samples;
+    wparams.audio_ctx = std::max(160, std::min(1500, (int)ceil((double)num_encoded_samples / (double)(320.0)) + 32));
+    wparams.no_timestamps = num_samples < 16000 * 25;
+}
+
+static whisper_full_params createParams(size_t num_samples, std::vector<int> &allowed_languages,
+        int decoding_mode, bool suppress_non_speech, bool speed_up) {
     whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
     wparams.print_progress = false;
     wparams.print_realtime = false;
     wparams.print_special = false;
     wparams.print_timestamps = false;
     wparams.max_tokens = 256;
-    wparams.n_threads = (int)num_procs;
+    wparams.n_threads = threadCount();
     wparams.translate = false;  // Explicitly disable translation mode
     AKLOGI("[VOICE] Translation mode: DISABLED (translate = false)");
 
-    wparams.audio_ctx = std::max(160, std::min(1500, (int)ceil((double)num_samples / (double)(320.0)) + 32));
+    wparams.speed_up = speed_up;
+    setAudioLength(wparams, num_samples);
     wparams.temperature_inc = 0.0f;
 
+    // Hallucinations on noise or after the speech usually loop or run on, end the segment early then
+    // rather than at max_tokens. Dictation is 2-4 tokens per second, CJK text up to about twice that.
+    wparams.eot_thold = 0.4f;
+    wparams.repetition_thold = 5;
+    wparams.max_tokens_per_s = 12.0f;
+
     // Replicates old tflite behavior
     if(decoding_mode == 0) {
         wparams.strategy = WHISPER_SAMPLING_GREEDY;
@@ -129,8 +361,10 @@ JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_infe
 
 
     wparams.suppress_blank = false;
-    wparams.suppress_non_speech_tokens = (suppress_non_speech == JNI_TRUE);
-    wparams.no_timestamps = num_samples < 16000 * 25;
+    wparams.suppress_non_speech_tokens = suppress_non_speech;
+    // Without timestamps only the text tokens and EOT can be sampled, so the decoder skips the
+    // vocab projection of the others. whisper_full ignores this when timestamps are on.
+    wparams.text_logits_only = true;
 
     // Improved language handling for strict language locking
     AKLOGI("[VOICE] === Configuring language parameters ===");
@@ -204,16 +438,131 @@ JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_infe
         }
     }
 
-    std::string prompt_str = jstring2string(env, prompt);
-    wparams.initial_prompt = prompt_str.c_str();
-    AKLOGI("Initial prompt size: %d", prompt_str.size());
+    return wparams;
+}
+
+// Leaves the forbidden languages out of the language detection, so that the encoder output is
+// decoded once in the most likely remaining language instead of aborting after the encoder and
+// transcribing the audio again. wparams.allowed_langs points into detect_languages afterwards.
+// Does nothing if the language is forced or no language would be left, then a forbidden
+// language still aborts whisper_full.
+static void excludeForbiddenLanguages(whisper_full_params &wparams,
+        const std::vector<int> &forbidden_languages, std::vector<int> &detect_languages) {
+    if (forbidden_languages.empty() || wparams.language != nullptr) return;
+
+    detect_languages.clear();
+    const int n_candidates = wparams.allowed_langs != nullptr
+            ? (int)wparams.allowed_langs_size : whisper_lang_max_id() + 1;
+    for (int i = 0; i < n_candidates; i++) {
+        const int lang_id = wparams.allowed_langs != nullptr ? wparams.allowed_langs[i] : i;
+        if (std::find(forbidden_languages.begin(), forbidden_languages.end(), lang_id)
+                == forbidden_languages.end()) {
+            detect_languages.push_back(lang_id);
+        }
+    }
+    if (detect_languages.empty()) {
+        AKLOGI("[VOICE] All detectable languages are forbidden, keeping the bail out");
+        return;
+    }
+
+    wparams.allowed_langs = detect_languages.data();
+    wparams.allowed_langs_size = detect_languages.size();
+    AKLOGI("[VOICE] Detecting among %zu languages that are not forbidden", detect_languages.size());
+}
+
+// Passes the text to Java as UTF-8 bytes in a direct buffer over partial_bytes, which is only
+// replaced when the text outgrows it, so a partial result creates no JNI objects.
+static void sendPartialResult(WhisperModelState *wstate, const std::string &final_partial) {
+    AKLOGI("Sending partial result: %s", final_partial.c_str());
+
+    if (wstate->partial_result_method == nullptr) {
+        AKLOGE("partial_result_method is null, cannot send partial result");
+        return;
+    }
+
+    JNIEnv *env = wstate->env;
+    if (wstate->partial_buffer == nullptr || final_partial.size() > wstate->partial_bytes.size()) {
+        if (wstate->partial_buffer != nullptr) {
+            env->DeleteGlobalRef(wstate->partial_buffer);
+        }
+        wstate->partial_bytes.resize(std::max(std::max(final_partial.size(), (size_t)256),
+                2 * wstate->partial_bytes.size()));
+        jobject buffer = env->NewDirectByteBuffer(wstate->partial_bytes.data(),
+                (jlong)wstate->partial_bytes.size());
+        wstate->partial_buffer = env->NewGlobalRef(buffer);
+        env->DeleteLocalRef(buffer);
+    }
+    std::copy(final_partial.begin(), final_partial.end(), wstate->partial_bytes.begin());
+
+    env->CallVoidMethod(wstate->partial_result_instance, wstate->partial_result_method,
+            wstate->partial_buffer, (jint)final_partial.size());
+
+    // Check for JNI exceptions
+    if (env->ExceptionCheck()) {
+        AKLOGE("JNI exception occurred in partial callback");
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+}
+
+static bool isPartialTextToken(struct whisper_context *ctx, whisper_token id) {
+    if(id == whisper_token_beg(ctx) ||
+       id == whisper_token_eot(ctx) ||
+       id == whisper_token_nosp(ctx) ||
+       id == whisper_token_not(ctx) ||
+       id == whisper_token_prev(ctx) ||
+       id == whisper_token_solm(ctx) ||
+       id == whisper_token_sot(ctx) ||
+       id == whisper_token_transcribe(ctx) ||
+       id == whisper_token_translate(ctx)) return false;
+
+    // Skip timestamp token
+    return id < whisper_token_beg(ctx) || id > whisper_token_beg(ctx) + 1500;
+}
+
+// Brings the partial text up to date with the tokens of the segment being decoded. Only the tokens
+// after the ones that are unchanged since the last callback are converted to text.
+static void updatePartialText(PartialText &partial, struct whisper_context *ctx, int segment,
+        const whisper_token_data *tokens, size_t n_tokens) {
+    if (segment != partial.segment) {
+        // whisper_full finished the segments before this one, their text stays as it is.
+        partial.segment = segment;
+        partial.segment_start = partial.text.size();
+        partial.tokens.clear();
+        partial.token_ends.clear();
+    }
+
+    size_t n_kept = 0;
+    size_t i = 0;
+    for (; i < n_tokens; i++) {
+        if (!isPartialTextToken(ctx, tokens[i].id)) continue;
+        if (n_kept == partial.tokens.size() || partial.tokens[n_kept] != tokens[i].id) break;
+        n_kept++;
+    }
+    if (n_kept < partial.tokens.size()) {
+        partial.tokens.resize(n_kept);
+        partial.token_ends.resize(n_kept);
+        partial.text.resize(n_kept > 0 ? partial.token_ends.back() : partial.segment_start);
+        partial.changed = true;
+    }
 
+    for (; i < n_tokens; i++) {
+        if (!isPartialTextToken(ctx, tokens[i].id)) continue;
+        partial.text.append(whisper_token_to_str(ctx, tokens[i].id));
+        partial.tokens.push_back(tokens[i].id);
+        partial.token_ends.push_back(partial.text.size());
+        partial.changed = true;
+    }
+}
+
+static void setCallbacks(JNIEnv *env, jobject instance, WhisperModelState *state,
+        whisper_full_params &wparams) {
     state->env = env;
     state->partial_result_instance = instance;
     state->partial_result_method = env->GetMethodID(
             env->GetObjectClass(instance),
             "invokePartialResult",
-            "(Ljava/lang/String;)V");
+            "(Ljava/nio/ByteBuffer;I)V");
     
     if (state->partial_result_method == nullptr) {
         AKLOGE("Failed to find invokePartialResult method");
@@ -221,65 +570,26 @@ JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_infe
         AKLOGI("Successfully found invokePartialResult method");
     }
 
+    state->partial = PartialText();
+
     wparams.partial_text_callback_user_data = state;
     wparams.partial_text_callback = [](struct whisper_context * ctx, struct whisper_state * state, const whisper_token_data *tokens, size_t n_tokens, void * user_data) {
         AKLOGI("Partial callback invoked with %zu tokens", n_tokens);
-        std::string partial;
-
-        //AKLOGI(" -- - - - - -- ");
-        for(size_t i=0; i < n_tokens; i++) {
-            bool skipping = false;
-            if(tokens[i].id == whisper_token_beg(ctx) ||
-               tokens[i].id == whisper_token_eot(ctx) ||
-               tokens[i].id == whisper_token_nosp(ctx) ||
-               tokens[i].id == whisper_token_not(ctx) ||
-               tokens[i].id == whisper_token_prev(ctx) ||
-               tokens[i].id == whisper_token_solm(ctx) ||
-               tokens[i].id == whisper_token_sot(ctx) ||
-               tokens[i].id == whisper_token_transcribe(ctx) ||
-               tokens[i].id == whisper_token_translate(ctx)) skipping = true;
-
-            // Skip timestamp token
-            if(tokens[i].id >= whisper_token_beg(ctx)
-                    && tokens[i].id <= whisper_token_beg(ctx)+1500) {
-                skipping = true;
-            }
-
-            //AKLOGI("[%d] %d: %d (%s) %c", whisper_full_n_segments_from_state(state), i, tokens[i].id, whisper_token_to_str(ctx, tokens[i].id), skipping ? '>' : ' ');
-
-            if(skipping) continue;
-            partial += whisper_token_to_str(ctx, tokens[i].id);
-        }
-
         auto *wstate = reinterpret_cast<WhisperModelState *>(user_data);
-        wstate->partial_results[whisper_full_n_segments_from_state(state)] = partial;
+        PartialText &partial = wstate->partial;
 
-        // Add previous segment partials
-        std::string final_partial;
-        for(int i=0; i<whisper_full_n_segments_from_state(state); i++) {
-            if(wstate->partial_results.count(i))
-                final_partial.append(wstate->partial_results[i]);
-        }
+        updatePartialText(partial, ctx, whisper_full_n_segments_from_state(state), tokens, n_tokens);
 
-        final_partial.append(partial);
-
-        AKLOGI("Sending partial result: %s", final_partial.c_str());
-        
-        if (wstate->partial_result_method != nullptr) {
-            jstring pjstr = string2jstring(wstate->env, final_partial.c_str());
-            wstate->env->CallVoidMethod(wstate->partial_result_instance, wstate->partial_result_method, pjstr);
-            
-            // Check for JNI exceptions
-            if (wstate->env->ExceptionCheck()) {
-                AKLOGE("JNI exception occurred in partial callback");
-                wstate->env->ExceptionDescribe();
-                wstate->env->ExceptionClear();
-            }
-            
-            wstate->env->DeleteLocalRef(pjstr);
-        } else {
-            AKLOGE("partial_result_method is null, cannot send partial result");
+        // The final result is returned by whisper_full's caller, so skipped updates are not lost.
+        const auto now = std::chrono::steady_clock::now();
+        if (!partial.changed || now - partial.sent_time
+                < std::chrono::milliseconds(wstate->partial_interval_ms)) {
+            return;
         }
+        partial.changed = false;
+        partial.sent_time = now;
+
+        sendPartialResult(wstate, partial.text);
     };
 
     wparams.abort_callback_user_data = state;
@@ -299,10 +609,256 @@ JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_infe
 
         return false;
     };
+}
+
+// Mean squares of the VAD frames.
+static std::vector<float> frameEnergies(const float *samples, size_t n_frames) {
+    std::vector<float> energies(n_frames);
+    for (size_t i = 0; i < n_frames; ++i) {
+        const float *frame = samples + i * VAD_FRAME_SAMPLES;
+        float sum = 0.0f;
+        for (size_t j = 0; j < VAD_FRAME_SAMPLES; ++j) {
+            sum += frame[j] * frame[j];
+        }
+        energies[i] = sum / (float)VAD_FRAME_SAMPLES;
+    }
+    return energies;
+}
+
+// Removes the silence before and after the speech and shortens long pauses, so that the mel
+// spectrogram and the encoder (through audio_ctx) only cover the speech. Returns the samples
+// unchanged if no speech is found.
+static std::vector<float> trimSilence(const float *samples, size_t num_samples) {
+    const size_t n_frames = num_samples / VAD_FRAME_SAMPLES;
+    if (n_frames < VAD_MIN_SPEECH_FRAMES) {
+        return std::vector<float>(samples, samples + num_samples);
+    }
+
+    std::vector<float> energies = frameEnergies(samples, n_frames);
+    std::vector<float> sorted_energies(energies);
+    const auto floor_it = sorted_energies.begin() + n_frames * VAD_NOISE_FLOOR_PERCENTILE / 100;
+    std::nth_element(sorted_energies.begin(), floor_it, sorted_energies.end());
+    const float threshold = std::max(VAD_MIN_SPEECH_ENERGY, *floor_it * VAD_NOISE_FLOOR_RATIO);
+
+    // Speech regions in frames, with pauses up to VAD_MAX_PAUSE_FRAMES merged into the region.
+    std::vector<std::pair<size_t, size_t>> regions;
+    size_t run_start = 0;
+    for (size_t i = 0; i <= n_frames; ++i) {
+        if (i < n_frames && energies[i] > threshold) continue;
+        if (i - run_start >= VAD_MIN_SPEECH_FRAMES) {
+            if (!regions.empty() && run_start - regions.back().second <= VAD_MAX_PAUSE_FRAMES) {
+                regions.back().second = i;
+            } else {
+                regions.emplace_back(run_start, i);
+            }
+        }
+        run_start = i + 1;
+    }
+    if (regions.empty()) {
+        AKLOGI("[VOICE] VAD found no speech in %zu samples", num_samples);
+        return std::vector<float>(samples, samples + num_samples);
+    }
+
+    std::vector<float> speech;
+    size_t copied_frames = 0;
+    for (const auto &region : regions) {
+        const size_t begin = std::max(copied_frames,
+                region.first - std::min(region.first, VAD_PADDING_BEFORE_FRAMES));
+        // The samples after the last whole frame belong to the last region.
+        const size_t end_sample = region.second + VAD_PADDING_AFTER_FRAMES >= n_frames
+                ? num_samples : (region.second + VAD_PADDING_AFTER_FRAMES) * VAD_FRAME_SAMPLES;
+        speech.insert(speech.end(), samples + begin * VAD_FRAME_SAMPLES, samples + end_sample);
+        copied_frames = region.second + VAD_PADDING_AFTER_FRAMES;
+    }
+    AKLOGI("[VOICE] VAD kept %zu of %zu samples in %zu regions", speech.size(), num_samples,
+            regions.size());
+    return speech;
+}
+
+// The text of the segments of a whisper state, without a trailing " you", which whisper tends to
+// hallucinate at the end of the audio.
+static std::string segmentsText(struct whisper_state *wstate) {
+    std::string text;
+    const int n_segments = whisper_full_n_segments_from_state(wstate);
+    for (int i = 0; i < n_segments; i++) {
+        const std::string seg = whisper_full_get_segment_text_from_state(wstate, i);
+        if(seg == " you" && i == n_segments - 1) continue;
+        text.append(seg);
+    }
+    return text;
+}
+
+// The number of chunks the speech is transcribed in at the same time, see PARALLEL_MIN_SAMPLES.
+static int parallelChunkCount(const whisper_full_params &wparams, size_t num_samples) {
+    if (num_samples <= PARALLEL_MIN_SAMPLES || isLowRamDevice()) return 1;
+    const int n_chunks = std::min(std::min(PARALLEL_MAX_STATES,
+            wparams.n_threads / PARALLEL_MIN_THREADS_PER_STATE),
+            (int)((num_samples + PARALLEL_MIN_SAMPLES - 1) / PARALLEL_MIN_SAMPLES));
+    return std::max(n_chunks, 1);
+}
+
+// The sample offsets of the n_chunks chunks of the speech, followed by the end of the speech. The
+// chunks have about the same length, and are split at the quietest frames near the even splits.
+static std::vector<size_t> chunkOffsets(const std::vector<float> &speech, int n_chunks) {
+    const size_t n_frames = speech.size() / VAD_FRAME_SAMPLES;
+    const std::vector<float> energies = frameEnergies(speech.data(), n_frames);
+    // The energy of the frames before each frame.
+    std::vector<double> energy_sums(n_frames + 1, 0.0);
+    for (size_t i = 0; i < n_frames; ++i) {
+        energy_sums[i + 1] = energy_sums[i] + energies[i];
+    }
+
+    const size_t half_window = PARALLEL_SPLIT_WINDOW_FRAMES / 2;
+    std::vector<size_t> offsets = { 0 };
+    size_t last_split = 0;
+    for (int i = 1; i < n_chunks; ++i) {
+        const size_t even_split = n_frames * i / n_chunks;
+        const size_t first = std::max(even_split - std::min(even_split, PARALLEL_SPLIT_SEARCH_FRAMES),
+                last_split + PARALLEL_SPLIT_WINDOW_FRAMES);
+        const size_t last = std::min(even_split + PARALLEL_SPLIT_SEARCH_FRAMES, n_frames - half_window);
+        size_t split = even_split;
+        double min_energy = -1.0;
+        for (size_t frame = std::max(first, half_window); frame <= last; ++frame) {
+            const double energy = energy_sums[frame + half_window] - energy_sums[frame - half_window];
+            if (min_energy < 0.0 || energy < min_energy) {
+                min_energy = energy;
+                split = frame;
+            }
+        }
+        offsets.push_back(split * VAD_FRAME_SAMPLES);
+        last_split = split;
+    }
+    offsets.push_back(speech.size());
+    return offsets;
+}
+
+// Transcribes the chunks of the speech at the same time, each with its share of the threads. The
+// first chunk is decoded with whisper_full, so that its segments, language and timings are in the
+// default state as after decoding the whole speech, and sends the partial results. The others are
+// decoded outside the JNI thread on states of their own, and their text is appended to later_text
+// in order.
+static int whisperFullInChunks(WhisperModelState *state, const whisper_full_params &wparams,
+        const std::vector<float> &speech, const std::vector<size_t> &offsets,
+        std::string &later_text) {
+    const int n_chunks = (int)offsets.size() - 1;
+
+    // The language is detected once with all the threads rather than by every chunk, so that the
+    // chunks are transcribed in the same language, and a forbidden one bails out before any chunk
+    // is encoded whole.
+    const char *language = wparams.language;
+    if (language == nullptr) {
+        whisper_full_params params = wparams;
+        setAudioLength(params, offsets[1]);
+        params.detect_language = true;
+        params.lang_detect_ms = PARALLEL_LANG_DETECT_MS;
+        params.lang_detect_thold = PARALLEL_LANG_DETECT_THOLD;
+        const int res = whisper_full(state->context, params, speech.data(), (int)offsets[1]);
+        if (res != 0) return res;
+        const int lang_id = whisper_full_lang_id(state->context);
+        if (std::find(state->last_forbidden_languages.begin(),
+                state->last_forbidden_languages.end(), lang_id)
+                != state->last_forbidden_languages.end()) {
+            return 0;
+        }
+        language = whisper_lang_str(lang_id);
+    }
+    std::vector<struct whisper_state *> chunk_states;
+    for (int i = 1; i < n_chunks; i++) {
+        struct whisper_state *chunk_state = whisper_init_state(state->context);
+        if (chunk_state == nullptr) {
+            AKLOGE("[VOICE] Failed to create the whisper state of chunk %d, decoding in one", i);
+            for (struct whisper_state *created_state : chunk_states) {
+                whisper_free_state(created_state);
+            }
+            return whisper_full(state->context, wparams, speech.data(), (int)speech.size());
+        }
+        chunk_states.push_back(chunk_state);
+    }
+
+    auto chunkParams = [&](int i) {
+        whisper_full_params params = wparams;
+        setAudioLength(params, offsets[i + 1] - offsets[i]);
+        params.language = language;
+        params.n_threads = wparams.n_threads / n_chunks + (i == 0 ? wparams.n_threads % n_chunks : 0);
+        if (i > 0) {
+            params.partial_text_callback = nullptr;
+            params.draft_ctx = nullptr;
+        }
+        return params;
+    };
+
+    AKLOGI("[VOICE] Decoding %zu samples in %d chunks", speech.size(), n_chunks);
+    std::vector<int> results(n_chunks, 0);
+    std::vector<std::thread> workers;
+    for (int i = 1; i < n_chunks; i++) {
+        workers.emplace_back([&, i]() {
+            results[i] = whisper_full_with_state(state->context, chunk_states[i - 1],
+                    chunkParams(i), speech.data() + offsets[i], (int)(offsets[i + 1] - offsets[i]));
+        });
+    }
+    results[0] = whisper_full(state->context, chunkParams(0), speech.data(), (int)offsets[1]);
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    int res = results[0];
+    for (int i = 1; i < n_chunks; i++) {
+        if (results[i] != 0) {
+            AKLOGE("[VOICE] whisper_full failed on chunk %d with code %d", i, results[i]);
+            if (res == 0) res = results[i];
+        }
+        later_text.append(segmentsText(chunk_states[i - 1]));
+        whisper_free_state(chunk_states[i - 1]);
+    }
+    return res;
+}
+
+JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_inferNative
+  (JNIEnv *env, jobject instance, jlong handle, jfloatArray samples_array, jstring prompt,
+   jobjectArray languages, jobjectArray bail_languages, jint decoding_mode, jboolean suppress_non_speech,
+   jboolean speed_up) {
+
+    AKLOGI("[VOICE] ===== Native inferNative() =====");
+
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    ModelUse use(state);
+    state->cancel_flag = 0;
+
+    std::vector<int> allowed_languages = readLanguageIds(env, languages, "Language");
+    std::vector<int> forbidden_languages = readLanguageIds(env, bail_languages, "Bail language");
+
+    state->last_forbidden_languages = forbidden_languages;
+
+    // The speech is copied out of the Java array by trimSilence, so the array is read in place
+    // instead of through a copy of the whole recording. No JNI calls are made meanwhile.
+    const size_t num_recorded_samples = env->GetArrayLength(samples_array);
+    auto *recorded_samples = static_cast<const jfloat *>(
+            env->GetPrimitiveArrayCritical(samples_array, nullptr));
+    const std::vector<float> speech = trimSilence(recorded_samples, num_recorded_samples);
+    env->ReleasePrimitiveArrayCritical(samples_array, const_cast<jfloat *>(recorded_samples),
+            JNI_ABORT);
+    const size_t num_samples = speech.size();
+
+    whisper_full_params wparams = createParams(num_samples, allowed_languages, decoding_mode,
+            suppress_non_speech == JNI_TRUE, speed_up == JNI_TRUE);
+    std::vector<int> detect_languages;
+    excludeForbiddenLanguages(wparams, forbidden_languages, detect_languages);
+
+    std::string prompt_str = jstring2string(env, prompt);
+    setPrompt(state, wparams, prompt_str);
+    AKLOGI("Initial prompt size: %d, %d tokens", prompt_str.size(), wparams.prompt_n_tokens);
+
+    setCallbacks(env, instance, state, wparams);
 
     AKLOGI("[VOICE] Final params.translate = %s", wparams.translate ? "TRUE" : "FALSE");
     AKLOGI("[VOICE] Calling whisper_full...");
-    int res = whisper_full(state->context, wparams, samples, (int)num_samples);
+    // The text of the chunks after the first, which are not in the default state.
+    std::string later_chunks_text;
+    const int n_chunks = parallelChunkCount(wparams, num_samples);
+    int res = n_chunks > 1
+            ? whisperFullInChunks(state, wparams, speech, chunkOffsets(speech, n_chunks),
+                    later_chunks_text)
+            : whisper_full(state->context, wparams, speech.data(), (int)num_samples);
     if(res != 0) {
         AKLOGE("[VOICE] WhisperGGML whisper_full failed with non-zero code %d", res);
     }
@@ -325,6 +881,10 @@ JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_infe
 
     whisper_print_timings(state->context);
 
+    const whisper_mem_stats mem = whisper_get_mem_stats(state->context);
+    AKLOGI("[VOICE] Whisper memory: %.1f MB now, %.1f MB peak, n_text_ctx = %d",
+           mem.current / 1e6, mem.peak / 1e6, mem.n_text_ctx);
+
     std::string output = "";
     const int n_segments = whisper_full_n_segments(state->context);
     AKLOGI("[VOICE] Number of segments: %d", n_segments);
@@ -336,6 +896,7 @@ JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_infe
 
         AKLOGI("[VOICE] Segment[%d]: '%s'", i, seg.c_str());
     }
+    output.append(later_chunks_text);
 
     if(std::find(forbidden_languages.begin(),
                  forbidden_languages.end(),
@@ -355,18 +916,479 @@ JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_infe
     return jstr;
 }
 
+// The recorder does not normalize the streamed audio, so each window is scaled to its peak like the
+// samples given to inferNative.
+static float streamWindowScale(const WhisperStream &stream) {
+    float max_abs = 0.0f;
+    for (size_t i = stream.committed_samples; i < stream.samples.size(); i++) {
+        max_abs = std::max(max_abs, std::fabs(stream.samples[i]));
+    }
+    return max_abs > 0.0f ? 1.0f / max_abs : 1.0f;
+}
+
+// The user prompt followed by the end of the committed text, cut at a word boundary.
+static std::string streamWindowPrompt(const WhisperStream &stream) {
+    std::string prompt = stream.prompt;
+    size_t start = 0;
+    if (stream.committed_text.size() > STREAM_MAX_PROMPT_CHARS) {
+        start = stream.committed_text.find(' ',
+                stream.committed_text.size() - STREAM_MAX_PROMPT_CHARS);
+    }
+    if (start != std::string::npos) {
+        prompt.append(stream.committed_text, start, std::string::npos);
+    }
+    return prompt;
+}
+
+// Decodes the audio after the committed offset. The final window is decoded like inferNative
+// decodes a whole recording, the others with segment timestamps so that their stable segments
+// can be committed.
+static void decodeStreamWindow(JNIEnv *env, jobject instance, WhisperModelState *state,
+        bool is_final) {
+    WhisperStream &stream = state->stream;
+    const float scale = streamWindowScale(stream);
+    stream.decoded_samples = stream.samples.size();
+    // Partial windows keep their silence, their segment timestamps map back to stream offsets, and
+    // their mel is set from the frames of the stream. A commit clamped to the end of a window does
+    // not start at a frame, its window is passed as samples like the final one.
+    const bool from_mel_stream = !is_final
+            && stream.committed_samples % WHISPER_HOP_LENGTH == 0
+            && stream.samples.size() - stream.committed_samples > WHISPER_N_FFT;
+    std::vector<float> window;
+    if (!from_mel_stream) {
+        window.assign(stream.samples.begin() + stream.committed_samples, stream.samples.end());
+        for (float &sample : window) {
+            sample *= scale;
+        }
+    }
+    if (is_final) {
+        window = trimSilence(window.data(), window.size());
+    }
+    const size_t window_size = from_mel_stream
+            ? stream.samples.size() - stream.committed_samples : window.size();
+
+    std::vector<int> allowed_languages = stream.allowed_languages;
+    whisper_full_params wparams = createParams(window_size, allowed_languages,
+            stream.decoding_mode, stream.suppress_non_speech, false);
+    if (!is_final) {
+        wparams.no_timestamps = false;
+    }
+    if (stream.language_id >= 0) {
+        wparams.language = whisper_lang_str(stream.language_id);
+    }
+    std::vector<int> detect_languages;
+    excludeForbiddenLanguages(wparams, stream.forbidden_languages, detect_languages);
+
+    setPrompt(state, wparams, streamWindowPrompt(stream));
+
+    setCallbacks(env, instance, state, wparams);
+    // The partial text of a stream also includes the committed text, see sendStreamPartialResult.
+    wparams.partial_text_callback = nullptr;
+
+    AKLOGI("[VOICE] Decoding %s stream window of %zu samples after %zu committed samples",
+            is_final ? "final" : "partial", window_size, stream.committed_samples);
+    int res;
+    if (from_mel_stream) {
+        const int n_samples = (int)stream.samples.size();
+        res = whisper_mel_stream_update(state->context, state->mel_stream, stream.samples.data(),
+                n_samples, wparams.n_threads);
+        if (res == 0) {
+            res = whisper_set_mel_from_stream(state->context, state->mel_stream,
+                    stream.samples.data(), n_samples, (int)stream.committed_samples, scale);
+        }
+        if (res == 0) {
+            // No samples, whisper_full uses the mel that is set.
+            res = whisper_full(state->context, wparams, nullptr, 0);
+        }
+    } else {
+        res = whisper_full(state->context, wparams, window.data(), (int)window.size());
+    }
+
+    // A forbidden language also aborts whisper_full.
+    const int detected_lang_id = whisper_full_lang_id(state->context);
+    if(std::find(stream.forbidden_languages.begin(), stream.forbidden_languages.end(),
+                 detected_lang_id) != stream.forbidden_languages.end()) {
+        stream.bail_language_id = detected_lang_id;
+        return;
+    }
+    if(res != 0) {
+        AKLOGE("[VOICE] WhisperGGML whisper_full failed with non-zero code %d", res);
+        stream.window_segments.clear();
+        return;
+    }
+    if (stream.language_id < 0 && detected_lang_id >= 0) {
+        // Detecting the language again for every window would cost an extra encoder run each.
+        stream.language_id = detected_lang_id;
+    }
+
+    std::vector<std::string> segments;
+    std::vector<size_t> segment_ends;
+    const int n_segments = whisper_full_n_segments(state->context);
+    for (int i = 0; i < n_segments; i++) {
+        segments.push_back(whisper_full_get_segment_text(state->context, i));
+        const size_t end = (size_t)std::max<int64_t>(0, whisper_full_get_segment_t1(state->context, i))
+                * STREAM_SAMPLES_PER_TIMESTAMP;
+        segment_ends.push_back(std::min(end, window_size));
+    }
+
+    if (!is_final) {
+        // The last segment may go on in the audio still to come. Windows that grow too long
+        // commit without waiting for the next window to agree.
+        const bool forced = window_size > STREAM_MAX_WINDOW_SAMPLES;
+        const int n_candidates = forced ? n_segments : n_segments - 1;
+        int n_committed = 0;
+        for (int i = 0; i < n_candidates; i++) {
+            const bool agreed = i < (int)stream.window_segments.size()
+                    && stream.window_segments[i] == segments[i]
+                    && segment_ends[i] + STREAM_GUARD_SAMPLES <= window_size;
+            if ((!agreed && !forced) || segment_ends[i] == 0
+                    || (i > 0 && segment_ends[i] < segment_ends[i - 1])) {
+                break;
+            }
+            n_committed = i + 1;
+        }
+        if (n_committed > 0) {
+            for (int i = 0; i < n_committed; i++) {
+                stream.committed_text.append(segments[i]);
+            }
+            stream.committed_samples += segment_ends[n_committed - 1];
+            segments.erase(segments.begin(), segments.begin() + n_committed);
+            AKLOGI("[VOICE] Committed %d stream segments, %zu samples", n_committed,
+                    stream.committed_samples);
+        }
+    }
+    stream.window_segments = segments;
+}
+
+static void sendStreamPartialResult(WhisperModelState *state) {
+    std::string partial = state->stream.committed_text;
+    for (const std::string &segment : state->stream.window_segments) {
+        partial.append(segment);
+    }
+    sendPartialResult(state, partial);
+}
+
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_startStreamNative
+  (JNIEnv *env, jobject instance, jlong handle, jstring prompt, jobjectArray languages,
+   jobjectArray bail_languages, jint decoding_mode, jboolean suppress_non_speech) {
+    AKLOGI("[VOICE] ===== Native startStreamNative() =====");
+
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    ModelUse use(state);
+    state->cancel_flag = 0;
+
+    WhisperStream &stream = state->stream;
+    stream = WhisperStream();
+    stream.active = true;
+    stream.prompt = jstring2string(env, prompt);
+    stream.allowed_languages = readLanguageIds(env, languages, "Language");
+    stream.forbidden_languages = readLanguageIds(env, bail_languages, "Bail language");
+    stream.decoding_mode = decoding_mode;
+    stream.suppress_non_speech = (suppress_non_speech == JNI_TRUE);
+    stream.samples.reserve(60 * STREAM_SAMPLE_RATE);
+    if (state->mel_stream == nullptr) {
+        state->mel_stream = whisper_mel_stream_init(state->context);
+    } else {
+        whisper_mel_stream_clear(state->mel_stream);
+    }
+
+    state->last_forbidden_languages = stream.forbidden_languages;
+}
+
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_pushAudioNative
+  (JNIEnv *env, jobject instance, jlong handle, jfloatArray samples_array, jboolean decode) {
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    ModelUse use(state);
+    WhisperStream &stream = state->stream;
+    if (!stream.active || state->cancel_flag || stream.bail_language_id >= 0) return;
+
+    const size_t num_samples = env->GetArrayLength(samples_array);
+    const size_t offset = stream.samples.size();
+    stream.samples.resize(offset + num_samples);
+    env->GetFloatArrayRegion(samples_array, 0, (jsize)num_samples, stream.samples.data() + offset);
+
+    if (decode != JNI_TRUE || stream.samples.size() - stream.decoded_samples < STREAM_STEP_SAMPLES) {
+        return;
+    }
+
+    decodeStreamWindow(env, instance, state, false /* is_final */);
+    if (!state->cancel_flag && stream.bail_language_id < 0) {
+        sendStreamPartialResult(state);
+    }
+}
+
+JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_finishStreamNative
+  (JNIEnv *env, jobject instance, jlong handle) {
+    AKLOGI("[VOICE] ===== Native finishStreamNative() =====");
+
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    ModelUse use(state);
+    WhisperStream &stream = state->stream;
+
+    std::string output = "";
+    if (stream.active && !state->cancel_flag && stream.bail_language_id < 0) {
+        stream.window_segments.clear();
+        if (stream.samples.size() > stream.committed_samples) {
+            decodeStreamWindow(env, instance, state, true /* is_final */);
+            whisper_print_timings(state->context);
+        }
+
+        output = stream.committed_text;
+        const int n_segments = (int)stream.window_segments.size();
+        for (int i = 0; i < n_segments; i++) {
+            if(stream.window_segments[i] == " you" && i == n_segments - 1) continue;
+            output.append(stream.window_segments[i]);
+        }
+    }
+
+    if (stream.bail_language_id >= 0) {
+        const char* detected_lang_str = whisper_lang_str(stream.bail_language_id);
+        AKLOGI("[VOICE] Detected language %s is in forbidden list - cancelling", detected_lang_str);
+        output = "<>CANCELLED<> lang=" + std::string(detected_lang_str);
+    }
+
+    if(state->cancel_flag) {
+        AKLOGI("[VOICE] Cancel flag set - cancelling");
+        output = "<>CANCELLED<> flag";
+    }
+
+    AKLOGI("[VOICE] Final stream output: '%s'", output.c_str());
+
+    // Releases the audio of the stream.
+    stream = WhisperStream();
+    if (state->mel_stream != nullptr) {
+        whisper_mel_stream_clear(state->mel_stream);
+    }
+
+    return string2jstring(env, output.c_str());
+}
+
+// Ends the stream without decoding the rest of its audio, so that a cancelled stream does not keep
+// its audio and keep the model from being trimmed or evicted. Waits for a window being decoded, which
+// stops soon once the cancel flag is set.
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_abortStreamNative
+  (JNIEnv *env, jobject obj, jlong handle) {
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    if(!state) return;
+    ModelUse use(state);
+    if(!state->stream.active) return;
+
+    AKLOGI("[VOICE] Aborting the stream after %zu samples", state->stream.samples.size());
+    state->stream = WhisperStream();
+    if (state->mel_stream != nullptr) {
+        whisper_mel_stream_clear(state->mel_stream);
+    }
+}
+
+// Decodes one token of silence, which reads every weight once and runs through the first-use setup
+// of the decoder, so that the first dictation after opening the model or after an idle eviction does
+// not pay for it.
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_warmupNative
+  (JNIEnv *env, jobject obj, jlong handle) {
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    if(!state) return;
+    ModelUse use(state);
+    if(state->warmed_up) return;
+    state->warmed_up = true;
+
+    // Reads the weights of an evicted model ahead of the decode below faulting them in.
+    whisper_prefetch_weights(state->context);
+
+    const std::vector<float> silence(STREAM_SAMPLE_RATE, 0.0f);
+    std::vector<int> languages = { whisper_lang_id("en") };
+    whisper_full_params wparams = createParams(silence.size(), languages, 0, false, false);
+    wparams.max_tokens = 1;
+    wparams.single_segment = true;
+
+    int res = whisper_full(state->context, wparams, silence.data(), (int)silence.size());
+    if(res != 0) {
+        AKLOGE("[VOICE] Warmup whisper_full failed with non-zero code %d", res);
+    }
+}
+
+JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_benchNative
+  (JNIEnv *env, jobject obj, jlong handle, jint n_threads, jint audio_ms, jint audio_ctx, jint n_decode, jint n_runs) {
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    ModelUse use(state);
+
+    whisper_bench_params params = whisper_bench_default_params();
+    params.n_threads = n_threads;
+    params.audio_ms = audio_ms;
+    params.audio_ctx = audio_ctx;
+    params.n_decode = n_decode;
+    params.n_runs = n_runs;
+
+    AKLOGI("[VOICE] Benchmark: %d threads, %d ms of audio, audio_ctx %d, %d decoder steps, %d runs",
+           (int)n_threads, (int)audio_ms, (int)audio_ctx, (int)n_decode, (int)n_runs);
+    const char *result = whisper_bench_model_str(state->context, params);
+    state->warmed_up = true;
+
+    return env->NewStringUTF(result);
+}
+
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_setPartialResultIntervalNative
+  (JNIEnv *env, jobject obj, jlong handle, jint interval_ms) {
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    state->partial_interval_ms = std::max(0, (int)interval_ms);
+}
+
 JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_cancelNative
   (JNIEnv *env, jobject obj, jlong handle) {
     auto *state = reinterpret_cast<WhisperModelState *>(handle);
     state->cancel_flag = 1;
 }
 
+// Frees the compute buffers, and the KV caches if release_kv_cache is set, unless the model is busy or a
+// stream is open. Returns the number of bytes freed.
+JNIEXPORT jlong JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_trimMemoryNative
+  (JNIEnv *env, jobject obj, jlong handle, jboolean release_kv_cache) {
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    if(!state) return 0;
+
+    std::unique_lock<std::mutex> lock(state->mutex, std::try_to_lock);
+    if(!lock.owns_lock() || state->stream.active) {
+        AKLOGI("[VOICE] Model in use, not trimming its memory");
+        return 0;
+    }
+
+    const size_t freed = whisper_trim_memory(state->context, release_kv_cache == JNI_TRUE);
+    AKLOGI("[VOICE] Trimmed %.1f MB%s", freed / 1e6, release_kv_cache == JNI_TRUE ? " including the KV caches" : "");
+    return (jlong)freed;
+}
+
+// Evicts the model like trimMemoryNative with the KV caches, and advises its weights cold, once it has
+// not been used for timeout_ms. The next warmupNative resumes it. 0 disables the eviction.
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_setIdleTimeoutNative
+  (JNIEnv *env, jobject obj, jlong handle, jint timeout_ms) {
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    if(!state) return;
+
+    std::lock_guard<std::mutex> idle_lock(state->idle_mutex);
+    state->idle_timeout_ms = std::max(0, (int)timeout_ms);
+    state->last_used = std::chrono::steady_clock::now();
+    if(state->idle_timeout_ms > 0 && !state->idle_thread.joinable()) {
+        state->idle_thread = std::thread(idleLoop, state);
+    }
+    state->idle_cv.notify_one();
+}
+
 JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_closeNative
   (JNIEnv *env, jobject obj, jlong handle) {
     auto *state = reinterpret_cast<WhisperModelState *>(handle);
     if(!state) return;
 
+    {
+        std::lock_guard<std::mutex> idle_lock(state->idle_mutex);
+        state->closing = true;
+        state->idle_cv.notify_one();
+    }
+    if(state->idle_thread.joinable()) {
+        state->idle_thread.join();
+    }
+
+    if(state->mel_stream != nullptr) {
+        whisper_mel_stream_free(state->mel_stream);
+    }
     whisper_free(state->context);
+    if(state->partial_buffer != nullptr) {
+        env->DeleteGlobalRef(state->partial_buffer);
+    }
 
     delete state;
-}
\ No newline at end of file
+}
+
+// Forwards the progress of a model conversion to QuantizationProgressCallback.onProgress, which can
+// cancel it by returning false.
+struct QuantizeProgress {
+    JNIEnv *env;
+    jobject callback;
+    jmethodID on_progress;
+};
+
+static bool quantizeProgress(float progress, void *user_data) {
+    auto *p = static_cast<QuantizeProgress *>(user_data);
+    if(p->callback == nullptr) return true;
+
+    const bool proceed = p->env->CallBooleanMethod(p->callback, p->on_progress, (jfloat)progress);
+    if(p->env->ExceptionCheck()) return false;
+    return proceed;
+}
+
+static QuantizeProgress quantizeProgressFor(JNIEnv *env, jobject callback) {
+    QuantizeProgress progress = { env, callback, nullptr };
+    if(callback != nullptr) {
+        jclass clazz = env->GetObjectClass(callback);
+        progress.on_progress = env->GetMethodID(clazz, "onProgress", "(F)Z");
+        env->DeleteLocalRef(clazz);
+        if(progress.on_progress == nullptr) {
+            env->ExceptionClear();
+            AKLOGE("[VOICE] QuantizationProgressCallback.onProgress not found");
+            progress.callback = nullptr;
+        }
+    }
+    return progress;
+}
+
+JNIEXPORT jint JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_quantizeModelNative
+  (JNIEnv *env, jclass clazz, jstring src_path, jstring dst_path, jint ftype, jobject callback) {
+    const std::string src = jstring2string(env, src_path);
+    const std::string dst = jstring2string(env, dst_path);
+
+    QuantizeProgress progress = quantizeProgressFor(env, callback);
+
+    AKLOGI("[VOICE] Quantizing %s to %s (ftype %d)", src.c_str(), dst.c_str(), (int)ftype);
+    return whisper_model_quantize(src.c_str(), dst.c_str(), (ggml_ftype)ftype, quantizeProgress, &progress);
+}
+
+JNIEXPORT jint JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_quantizeModelFromBufferNative
+  (JNIEnv *env, jclass clazz, jobject buffer, jstring dst_path, jint ftype, jobject callback) {
+    void* buffer_address = env->GetDirectBufferAddress(buffer);
+    jlong buffer_capacity = env->GetDirectBufferCapacity(buffer);
+    if(buffer_address == nullptr || buffer_capacity <= 0) {
+        AKLOGE("[VOICE] Quantization needs a direct buffer");
+        return -1;
+    }
+
+    const std::string dst = jstring2string(env, dst_path);
+
+    QuantizeProgress progress = quantizeProgressFor(env, callback);
+
+    AKLOGI("[VOICE] Quantizing a %lld byte model to %s (ftype %d)", (long long)buffer_capacity, dst.c_str(), (int)ftype);
+    return whisper_model_quantize_from_buffer(buffer_address, (size_t)buffer_capacity, dst.c_str(), (ggml_ftype)ftype,
+                                              quantizeProgress, &progress);
+}
+
+JNIEXPORT jboolean JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_setNativeTracingEnabledNative
+  (JNIEnv *env, jclass clazz, jboolean enabled) {
+    // The whisper library has its own copy of the tracing state, separate from libjni_latinime
+    return latinime::NativeTrace::setEnabled(enabled == JNI_TRUE) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_startSamplingProfilerNative
+  (JNIEnv *env, jclass clazz, jint sampling_interval_us) {
+    // Only the PCs inside this library are counted, the samples of libjni_latinime are separate
+    return latinime::NativeSamplingProfiler::start(sampling_interval_us) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_stopSamplingProfilerNative
+  (JNIEnv *env, jclass clazz) {
+    latinime::NativeSamplingProfiler::stop();
+}
+
+JNIEXPORT jint JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_getSamplingProfileNative
+  (JNIEnv *env, jclass clazz, jlongArray out_pc_offsets, jintArray out_counts, jlongArray out_sample_counts) {
+    using latinime::NativeSamplingProfiler;
+    const int max_count = std::min(std::min(env->GetArrayLength(out_pc_offsets), env->GetArrayLength(out_counts)),
+                                   (jsize)NativeSamplingProfiler::MAX_PC_COUNT);
+    std::vector<int64_t> pc_offsets(max_count);
+    std::vector<int> counts(max_count);
+    const int pc_count = NativeSamplingProfiler::getSamples(max_count, pc_offsets.data(), counts.data());
+    env->SetLongArrayRegion(out_pc_offsets, 0, pc_count, reinterpret_cast<const jlong *>(pc_offsets.data()));
+    env->SetIntArrayRegion(out_counts, 0, pc_count, reinterpret_cast<const jint *>(counts.data()));
+    int64_t sample_counts[NativeSamplingProfiler::SAMPLE_COUNT_SIZE];
+    NativeSamplingProfiler::getSampleCounts(sample_counts);
+    env->SetLongArrayRegion(out_sample_counts, 0,
+                            std::min(env->GetArrayLength(out_sample_counts), (jsize)NativeSamplingProfiler::SAMPLE_COUNT_SIZE),
+                            reinterpret_cast<const jlong *>(sample_counts));
+    return pc_count;
+}
@@ -26,10 +26,66 @@ JNIEXPORT jlong JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_openFr
 /*
  * Class:     helium314_keyboard_voice_whisper_WhisperGGML
  * Method:    inferNative
- * Signature: (J[FLjava/lang/String;[Ljava/lang/String;[Ljava/lang/String;IZ)Ljava/lang/String;
+ * Signature: (J[FLjava/lang/String;[Ljava/lang/String;[Ljava/lang/String;IZZ)Ljava/lang/String;
  */
 JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_inferNative
-  (JNIEnv *, jobject, jlong, jfloatArray, jstring, jobjectArray, jobjectArray, jint, jboolean);
+  (JNIEnv *, jobject, jlong, jfloatArray, jstring, jobjectArray, jobjectArray, jint, jboolean, jboolean);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    startStreamNative
+ * Signature: (JLjava/lang/String;[Ljava/lang/String;[Ljava/lang/String;IZ)V
+ */
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_startStreamNative
+  (JNIEnv *, jobject, jlong, jstring, jobjectArray, jobjectArray, jint, jboolean);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    pushAudioNative
+ * Signature: (J[FZ)V
+ */
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_pushAudioNative
+  (JNIEnv *, jobject, jlong, jfloatArray, jboolean);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    finishStreamNative
+ * Signature: (J)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_finishStreamNative
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    abortStreamNative
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_abortStreamNative
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    warmupNative
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_warmupNative
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    benchNative
+ * Signature: (JIIIII)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_benchNative
+  (JNIEnv *, jobject, jlong, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    setPartialResultIntervalNative
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_setPartialResultIntervalNative
+  (JNIEnv *, jobject, jlong, jint);
 
 /*
  * Class:     helium314_keyboard_voice_whisper_WhisperGGML
@@ -39,6 +95,22 @@ JNIEXPORT jstring JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_infe
 JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_cancelNative
   (JNIEnv *, jobject, jlong);
 
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    trimMemoryNative
+ * Signature: (JZ)J
+ */
+JNIEXPORT jlong JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_trimMemoryNative
+  (JNIEnv *, jobject, jlong, jboolean);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    setIdleTimeoutNative
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_setIdleTimeoutNative
+  (JNIEnv *, jobject, jlong, jint);
+
 /*
  * Class:     helium314_keyboard_voice_whisper_WhisperGGML
  * Method:    closeNative
@@ -47,6 +119,54 @@ JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_cancelN
 JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_closeNative
   (JNIEnv *, jobject, jlong);
 
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    quantizeModelNative
+ * Signature: (Ljava/lang/String;Ljava/lang/String;ILhelium314/keyboard/voice/whisper/WhisperGGML$QuantizationProgressCallback;)I
+ */
+JNIEXPORT jint JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_quantizeModelNative
+  (JNIEnv *, jclass, jstring, jstring, jint, jobject);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    quantizeModelFromBufferNative
+ * Signature: (Ljava/nio/Buffer;Ljava/lang/String;ILhelium314/keyboard/voice/whisper/WhisperGGML$QuantizationProgressCallback;)I
+ */
+JNIEXPORT jint JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_quantizeModelFromBufferNative
+  (JNIEnv *, jclass, jobject, jstring, jint, jobject);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    setNativeTracingEnabledNative
+ * Signature: (Z)Z
+ */
+JNIEXPORT jboolean JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_setNativeTracingEnabledNative
+  (JNIEnv *, jclass, jboolean);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    startSamplingProfilerNative
+ * Signature: (I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_startSamplingProfilerNative
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    stopSamplingProfilerNative
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_stopSamplingProfilerNative
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     helium314_keyboard_voice_whisper_WhisperGGML
+ * Method:    getSamplingProfileNative
+ * Signature: ([J[I[J)I
+ */
+JNIEXPORT jint JNICALL Java_helium314_keyboard_voice_whisper_WhisperGGML_getSamplingProfileNative
+  (JNIEnv *, jclass, jlongArray, jintArray, jlongArray);
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,7 +28,7 @@ static jlong WhisperGGML_open(JNIEnv *env, jclass clazz, jstring model_dir) {
     auto *state = new WhisperModelState();
 
     AKLOGI("Attempting to load model from file...");
-    state->context = whisper_init_from_file_with_params(model_dir_str.c_str(), { .use_gpu = false });
+    state->context = whisper_init_from_file_with_params(model_dir_str.c_str(), { .use_gpu = false, .type_k = GGML_TYPE_F16, .flash_attn = true });
 
     if(!state->context){
         AKLOGE("Failed to initialize whisper_context from path %s", model_dir_str.c_str());
@@ -46,7 +46,7 @@ static jlong WhisperGGML_openFromBuffer(JNIEnv *env, jclass clazz, jobject buffe
     auto *state = new WhisperModelState();
 
     AKLOGI("Attempting to load model from buffer...");
-    state->context = whisper_init_from_buffer_with_params(buffer_address, buffer_capacity, { .use_gpu = false });
+    state->context = whisper_init_from_buffer_with_params(buffer_address, buffer_capacity, { .use_gpu = false, .type_k = GGML_TYPE_F16, .flash_attn = true });
 
     if(!state->context){
         AKLOGE("Failed to initialize whisper_context from direct buffer");
@@ -0,0 +1,96 @@
+#!/bin/bash
+# Copyright 2026, The HeliBoard Contributors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Collects the profiles that the release builds of libjni_latinime and libwhisperggml are optimised
+# with, see NativePgo.mk. The instrumented benchmarks are built with ndk-build and run on the
+# connected device, which should be a typical arm64 phone, then the raw profiles are merged into
+# pgo/latinime.profdata and pgo/whisperggml.profdata.
+
+function usage() {
+    echo "usage: pgo-train.sh -d main.dict -t trace.txt [-m model.bin] [-o profile_dir] [-h]"  1>&2
+    echo "    -d: dictionary the keystroke replay runs on"  1>&2
+    echo "    -t: keystroke trace, see suggest_bench.cpp"  1>&2
+    echo "    -m: voice input model; without it, no whisperggml profile is collected"  1>&2
+    echo "    -o: output directory of the profiles, pgo next to this script by default"  1>&2
+}
+
+jni_dir=$(cd $(dirname ${BASH_SOURCE[0]}) && pwd)
+dict=
+trace=
+model=
+profile_dir=$jni_dir/pgo
+while [ "$1" != "" ]
+  do
+  case "$1" in
+    "-d") shift; dict=$1;;
+    "-t") shift; trace=$1;;
+    "-m") shift; model=$1;;
+    "-o") shift; profile_dir=$1;;
+    *) usage; exit 1;;
+  esac
+  shift
+done
+
+if [[ -z $dict || -z $trace ]]; then
+  usage
+  exit 1
+fi
+if [[ -z $ANDROID_NDK_HOME ]]; then
+  echo "ANDROID_NDK_HOME must point to the NDK the app is built with."  1>&2
+  exit 1
+fi
+llvm_profdata=$(ls $ANDROID_NDK_HOME/toolchains/llvm/prebuilt/*/bin/llvm-profdata | head -n 1)
+if [[ ! -x $llvm_profdata ]]; then
+  echo "llvm-profdata not found in $ANDROID_NDK_HOME."  1>&2
+  exit 1
+fi
+
+set -e
+
+build_dir=$(mktemp -d)
+trap "rm -rf $build_dir" EXIT
+$ANDROID_NDK_HOME/ndk-build -j$(nproc) \
+    NDK_PROJECT_PATH=$build_dir \
+    APP_BUILD_SCRIPT=$jni_dir/Android.mk \
+    NDK_APPLICATION_MK=$jni_dir/Application.mk \
+    APP_ABI=arm64-v8a \
+    APP_PLATFORM=android-21 \
+    NDK_OUT=$build_dir/obj \
+    NDK_LIBS_OUT=$build_dir/libs \
+    FLAG_PGO_GENERATE=true
+bin_dir=$build_dir/libs/arm64-v8a
+
+device_dir=/data/local/tmp/latinime_pgo
+adb shell rm -rf $device_dir
+adb shell mkdir -p $device_dir
+adb push $bin_dir/latinime_suggest_bench $dict $trace $device_dir
+# Several runs, so that the cached searches are part of the profile too.
+adb shell "cd $device_dir && LLVM_PROFILE_FILE=$device_dir/latinime-%p.profraw" \
+    "./latinime_suggest_bench -d $(basename $dict) -t $(basename $trace) -r 3"
+if [[ -n $model ]]; then
+  adb push $bin_dir/whisper_bench $model $device_dir
+  adb shell "cd $device_dir && LLVM_PROFILE_FILE=$device_dir/whisperggml-%p.profraw" \
+      "./whisper_bench -m $(basename $model) -r 3"
+fi
+
+mkdir -p $build_dir/profraw $profile_dir
+adb pull $device_dir/. $build_dir/profraw > /dev/null
+adb shell rm -rf $device_dir
+$llvm_profdata merge -output=$profile_dir/latinime.profdata $build_dir/profraw/latinime-*.profraw
+if [[ -n $model ]]; then
+  $llvm_profdata merge -output=$profile_dir/whisperggml.profdata \
+      $build_dir/profraw/whisperggml-*.profraw
+fi
+echo "Profiles written to $profile_dir, build the release variant to use them."
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 
+#include "dictionary/utils/byte_array_utils.h"
 #include "utils/ngram_utils.h"
 
 namespace latinime {
@@ -40,6 +41,8 @@ const char *const HeaderPolicy::EXTENDED_REGION_SIZE_KEY = "EXTENDED_REGION_SIZE
 // Historical info is information that is needed to support decaying such as timestamp, level and
 // count.
 const char *const HeaderPolicy::HAS_HISTORICAL_INFO_KEY = "HAS_HISTORICAL_INFO";
+// N-gram contexts are looked up in a flat hash map instead of walking the trie map.
+const char *const HeaderPolicy::USES_NGRAM_CONTEXT_MAP_KEY = "USES_NGRAM_CONTEXT_MAP";
 const char *const HeaderPolicy::LOCALE_KEY = "locale"; // match Java declaration
 const char *const HeaderPolicy::FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID_KEY =
         "FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID";
@@ -48,6 +51,15 @@ const int HeaderPolicy::DEFAULT_MULTIPLE_WORDS_DEMOTION_RATE = 100;
 const float HeaderPolicy::MULTIPLE_WORD_COST_MULTIPLIER_SCALE = 100.0f;
 const int HeaderPolicy::DEFAULT_FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID = 3;
 
+const DictionaryHeaderStructurePolicy::AttributeMap *HeaderPolicy::getAttributeMap() const {
+    if (mDictBuf) {
+        std::call_once(mAttributeMapOnceFlag, [this]() {
+            HeaderReadWriteUtils::fetchAllHeaderAttributes(mDictBuf, &mAttributeMap);
+        });
+    }
+    return &mAttributeMap;
+}
+
 // Used for logging. Question mark is used to indicate that the key is not found.
 void HeaderPolicy::readHeaderValueOrQuestionMark(const char *const key, int *outValue,
         int outValueSize) const {
@@ -56,6 +68,20 @@ void HeaderPolicy::readHeaderValueOrQuestionMark(const char *const key, int *out
         outValue[0] = '\0';
         return;
     }
+    if (mDictBuf) {
+        int pos = HeaderReadWriteUtils::getAttributeValuePosition(mDictBuf, key);
+        if (pos == NOT_A_DICT_POS) {
+            // The key was not found.
+            outValue[0] = '?';
+            outValue[1] = '\0';
+            return;
+        }
+        const int length = ByteArrayUtils::readStringAndAdvancePosition(mDictBuf,
+                HeaderReadWriteUtils::getHeaderSize(mDictBuf), outValueSize - 1,
+                nullptr /* codePointTable */, outValue, &pos);
+        outValue[length] = '\0';
+        return;
+    }
     std::vector<int> keyCodePointVector;
     HeaderReadWriteUtils::insertCharactersIntoVector(key, &keyCodePointVector);
     DictionaryHeaderStructurePolicy::AttributeMap::const_iterator it =
@@ -74,12 +100,29 @@ void HeaderPolicy::readHeaderValueOrQuestionMark(const char *const key, int *out
 }
 
 const std::vector<int> HeaderPolicy::readLocale() const {
+    if (mDictBuf) {
+        return HeaderReadWriteUtils::readCodePointVectorAttributeValue(mDictBuf, LOCALE_KEY);
+    }
     return HeaderReadWriteUtils::readCodePointVectorAttributeValue(&mAttributeMap, LOCALE_KEY);
 }
 
+bool HeaderPolicy::readBoolAttributeValue(const char *const key, const bool defaultValue) const {
+    if (mDictBuf) {
+        return HeaderReadWriteUtils::readBoolAttributeValue(mDictBuf, key, defaultValue);
+    }
+    return HeaderReadWriteUtils::readBoolAttributeValue(&mAttributeMap, key, defaultValue);
+}
+
+int HeaderPolicy::readIntAttributeValue(const char *const key, const int defaultValue) const {
+    if (mDictBuf) {
+        return HeaderReadWriteUtils::readIntAttributeValue(mDictBuf, key, defaultValue);
+    }
+    return HeaderReadWriteUtils::readIntAttributeValue(&mAttributeMap, key, defaultValue);
+}
+
 float HeaderPolicy::readMultipleWordCostMultiplier() const {
-    const int demotionRate = HeaderReadWriteUtils::readIntAttributeValue(&mAttributeMap,
-            MULTIPLE_WORDS_DEMOTION_RATE_KEY, DEFAULT_MULTIPLE_WORDS_DEMOTION_RATE);
+    const int demotionRate = readIntAttributeValue(MULTIPLE_WORDS_DEMOTION_RATE_KEY,
+            DEFAULT_MULTIPLE_WORDS_DEMOTION_RATE);
     if (demotionRate <= 0) {
         return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
     }
@@ -87,15 +130,14 @@ float HeaderPolicy::readMultipleWordCostMultiplier() const {
 }
 
 bool HeaderPolicy::readRequiresGermanUmlautProcessing() const {
-    return HeaderReadWriteUtils::readBoolAttributeValue(&mAttributeMap,
-            REQUIRES_GERMAN_UMLAUT_PROCESSING_KEY, false);
+    return readBoolAttributeValue(REQUIRES_GERMAN_UMLAUT_PROCESSING_KEY, false);
 }
 
 bool HeaderPolicy::fillInAndWriteHeaderToBuffer(const bool updatesLastDecayedTime,
         const EntryCounts &entryCounts, const int extendedRegionSize,
         BufferWithExtendableBuffer *const outBuffer) const {
     int writingPos = 0;
-    DictionaryHeaderStructurePolicy::AttributeMap attributeMapToWrite(mAttributeMap);
+    DictionaryHeaderStructurePolicy::AttributeMap attributeMapToWrite(*getAttributeMap());
     fillInHeader(updatesLastDecayedTime, entryCounts, extendedRegionSize, &attributeMapToWrite);
     if (!HeaderReadWriteUtils::writeDictionaryVersion(outBuffer, mDictFormatVersion,
             &writingPos)) {
@@ -152,17 +194,10 @@ void HeaderPolicy::fillInHeader(const bool updatesLastDecayedTime,
     }
 }
 
-/* static */ DictionaryHeaderStructurePolicy::AttributeMap
-        HeaderPolicy::createAttributeMapAndReadAllAttributes(const uint8_t *const dictBuf) {
-    DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
-    HeaderReadWriteUtils::fetchAllHeaderAttributes(dictBuf, &attributeMap);
-    return attributeMap;
-}
-
 /* static */ const EntryCounts HeaderPolicy::readNgramCounts() const {
     MutableEntryCounters entryCounters;
     for (const auto ngramType : AllNgramTypes::ASCENDING) {
-        const int entryCount = HeaderReadWriteUtils::readIntAttributeValue(&mAttributeMap,
+        const int entryCount = readIntAttributeValue(
                 NGRAM_COUNT_KEYS[getIndexFromNgramType(ngramType)], 0 /* defaultValue */);
         entryCounters.setNgramCount(ngramType, entryCount);
     }
@@ -173,8 +208,8 @@ void HeaderPolicy::fillInHeader(const bool updatesLastDecayedTime,
     MutableEntryCounters entryCounters;
     for (const auto ngramType : AllNgramTypes::ASCENDING) {
         const int index = getIndexFromNgramType(ngramType);
-        const int maxEntryCount = HeaderReadWriteUtils::readIntAttributeValue(&mAttributeMap,
-                MAX_NGRAM_COUNT_KEYS[index], DEFAULT_MAX_NGRAM_COUNTS[index]);
+        const int maxEntryCount = readIntAttributeValue(MAX_NGRAM_COUNT_KEYS[index],
+                DEFAULT_MAX_NGRAM_COUNTS[index]);
         entryCounters.setNgramCount(ngramType, maxEntryCount);
     }
     return entryCounters.getEntryCounts();
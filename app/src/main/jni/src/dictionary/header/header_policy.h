@@ -18,6 +18,8 @@
 #define LATINIME_HEADER_POLICY_H
 
 #include <cstdint>
+#include <mutex>
+#include <vector>
 
 #include "defines.h"
 #include "dictionary/header/header_read_write_utils.h"
@@ -31,30 +33,34 @@ namespace latinime {
 
 class HeaderPolicy : public DictionaryHeaderStructurePolicy {
  public:
-    // Reads information from existing dictionary buffer.
+    // Reads information from existing dictionary buffer. The attributes are read in place, so
+    // dictBuf has to outlive the header policy.
     HeaderPolicy(const uint8_t *const dictBuf, const FormatUtils::FORMAT_VERSION formatVersion)
             : mDictFormatVersion(formatVersion),
               mDictionaryFlags(HeaderReadWriteUtils::getFlags(dictBuf)),
-              mSize(HeaderReadWriteUtils::getHeaderSize(dictBuf)),
-              mAttributeMap(createAttributeMapAndReadAllAttributes(dictBuf)),
-              mLocale(readLocale()),
+              mSize(HeaderReadWriteUtils::getHeaderSize(dictBuf)), mDictBuf(dictBuf),
+              mAttributeMap(), mAttributeMapOnceFlag(), mLocale(readLocale()),
               mMultiWordCostMultiplier(readMultipleWordCostMultiplier()),
               mRequiresGermanUmlautProcessing(readRequiresGermanUmlautProcessing()),
-              mIsDecayingDict(HeaderReadWriteUtils::readBoolAttributeValue(&mAttributeMap,
-                      IS_DECAYING_DICT_KEY, false /* defaultValue */)),
-              mDate(HeaderReadWriteUtils::readIntAttributeValue(&mAttributeMap,
-                      DATE_KEY, TimeKeeper::peekCurrentTime() /* defaultValue */)),
-              mLastDecayedTime(HeaderReadWriteUtils::readIntAttributeValue(&mAttributeMap,
-                      LAST_DECAYED_TIME_KEY, TimeKeeper::peekCurrentTime() /* defaultValue */)),
+              mIsDecayingDict(readBoolAttributeValue(IS_DECAYING_DICT_KEY,
+                      false /* defaultValue */)),
+              mDate(readIntAttributeValue(DATE_KEY,
+                      TimeKeeper::peekCurrentTime() /* defaultValue */)),
+              mLastDecayedTime(readIntAttributeValue(LAST_DECAYED_TIME_KEY,
+                      TimeKeeper::peekCurrentTime() /* defaultValue */)),
               mNgramCounts(readNgramCounts()), mMaxNgramCounts(readMaxNgramCounts()),
-              mExtendedRegionSize(HeaderReadWriteUtils::readIntAttributeValue(&mAttributeMap,
-                      EXTENDED_REGION_SIZE_KEY, 0 /* defaultValue */)),
-              mHasHistoricalInfoOfWords(HeaderReadWriteUtils::readBoolAttributeValue(
-                      &mAttributeMap, HAS_HISTORICAL_INFO_KEY, false /* defaultValue */)),
-              mForgettingCurveProbabilityValuesTableId(HeaderReadWriteUtils::readIntAttributeValue(
-                      &mAttributeMap, FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID_KEY,
+              mExtendedRegionSize(readIntAttributeValue(EXTENDED_REGION_SIZE_KEY,
+                      0 /* defaultValue */)),
+              mHasHistoricalInfoOfWords(readBoolAttributeValue(HAS_HISTORICAL_INFO_KEY,
+                      false /* defaultValue */)),
+              mUsesNgramContextMap(readBoolAttributeValue(USES_NGRAM_CONTEXT_MAP_KEY,
+                      false /* defaultValue */)),
+              mForgettingCurveProbabilityValuesTableId(readIntAttributeValue(
+                      FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID_KEY,
                       DEFAULT_FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID)),
-              mCodePointTable(HeaderReadWriteUtils::readCodePointTable(&mAttributeMap)) {}
+              mCodePointTableStorage(HeaderReadWriteUtils::readCodePointTable(dictBuf)),
+              mCodePointTable(mCodePointTableStorage.empty()
+                      ? nullptr : mCodePointTableStorage.data()) {}
 
     // Constructs header information using an attribute map.
     HeaderPolicy(const FormatUtils::FORMAT_VERSION dictFormatVersion,
@@ -62,29 +68,34 @@ class HeaderPolicy : public DictionaryHeaderStructurePolicy {
             const DictionaryHeaderStructurePolicy::AttributeMap *const attributeMap)
             : mDictFormatVersion(dictFormatVersion),
               mDictionaryFlags(HeaderReadWriteUtils::createAndGetDictionaryFlagsUsingAttributeMap(
-                      attributeMap)), mSize(0), mAttributeMap(*attributeMap), mLocale(locale),
+                      attributeMap)), mSize(0), mDictBuf(nullptr), mAttributeMap(*attributeMap),
+              mAttributeMapOnceFlag(), mLocale(locale),
               mMultiWordCostMultiplier(readMultipleWordCostMultiplier()),
               mRequiresGermanUmlautProcessing(readRequiresGermanUmlautProcessing()),
-              mIsDecayingDict(HeaderReadWriteUtils::readBoolAttributeValue(&mAttributeMap,
-                      IS_DECAYING_DICT_KEY, false /* defaultValue */)),
-              mDate(HeaderReadWriteUtils::readIntAttributeValue(&mAttributeMap,
-                      DATE_KEY, TimeKeeper::peekCurrentTime() /* defaultValue */)),
-              mLastDecayedTime(HeaderReadWriteUtils::readIntAttributeValue(&mAttributeMap,
-                      DATE_KEY, TimeKeeper::peekCurrentTime() /* defaultValue */)),
+              mIsDecayingDict(readBoolAttributeValue(IS_DECAYING_DICT_KEY,
+                      false /* defaultValue */)),
+              mDate(readIntAttributeValue(DATE_KEY,
+                      TimeKeeper::peekCurrentTime() /* defaultValue */)),
+              mLastDecayedTime(readIntAttributeValue(DATE_KEY,
+                      TimeKeeper::peekCurrentTime() /* defaultValue */)),
               mNgramCounts(readNgramCounts()), mMaxNgramCounts(readMaxNgramCounts()),
               mExtendedRegionSize(0),
-              mHasHistoricalInfoOfWords(HeaderReadWriteUtils::readBoolAttributeValue(
-                      &mAttributeMap, HAS_HISTORICAL_INFO_KEY, false /* defaultValue */)),
-              mForgettingCurveProbabilityValuesTableId(HeaderReadWriteUtils::readIntAttributeValue(
-                      &mAttributeMap, FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID_KEY,
+              mHasHistoricalInfoOfWords(readBoolAttributeValue(HAS_HISTORICAL_INFO_KEY,
+                      false /* defaultValue */)),
+              mUsesNgramContextMap(readBoolAttributeValue(USES_NGRAM_CONTEXT_MAP_KEY,
+                      false /* defaultValue */)),
+              mForgettingCurveProbabilityValuesTableId(readIntAttributeValue(
+                      FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID_KEY,
                       DEFAULT_FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID)),
+              mCodePointTableStorage(),
               mCodePointTable(HeaderReadWriteUtils::readCodePointTable(&mAttributeMap)) {}
 
     // Copy header information
     HeaderPolicy(const HeaderPolicy *const headerPolicy)
             : mDictFormatVersion(headerPolicy->mDictFormatVersion),
               mDictionaryFlags(headerPolicy->mDictionaryFlags), mSize(headerPolicy->mSize),
-              mAttributeMap(headerPolicy->mAttributeMap), mLocale(headerPolicy->mLocale),
+              mDictBuf(nullptr), mAttributeMap(*headerPolicy->getAttributeMap()),
+              mAttributeMapOnceFlag(), mLocale(headerPolicy->mLocale),
               mMultiWordCostMultiplier(headerPolicy->mMultiWordCostMultiplier),
               mRequiresGermanUmlautProcessing(headerPolicy->mRequiresGermanUmlautProcessing),
               mIsDecayingDict(headerPolicy->mIsDecayingDict),
@@ -93,18 +104,21 @@ class HeaderPolicy : public DictionaryHeaderStructurePolicy {
               mMaxNgramCounts(headerPolicy->mMaxNgramCounts),
               mExtendedRegionSize(headerPolicy->mExtendedRegionSize),
               mHasHistoricalInfoOfWords(headerPolicy->mHasHistoricalInfoOfWords),
+              mUsesNgramContextMap(headerPolicy->mUsesNgramContextMap),
               mForgettingCurveProbabilityValuesTableId(
                       headerPolicy->mForgettingCurveProbabilityValuesTableId),
-              mCodePointTable(headerPolicy->mCodePointTable) {}
+              mCodePointTableStorage(), mCodePointTable(headerPolicy->mCodePointTable) {}
 
     // Temporary dummy header.
     HeaderPolicy()
             : mDictFormatVersion(FormatUtils::UNKNOWN_VERSION), mDictionaryFlags(0), mSize(0),
-              mAttributeMap(), mLocale(CharUtils::EMPTY_STRING), mMultiWordCostMultiplier(0.0f),
+              mDictBuf(nullptr), mAttributeMap(), mAttributeMapOnceFlag(),
+              mLocale(CharUtils::EMPTY_STRING), mMultiWordCostMultiplier(0.0f),
               mRequiresGermanUmlautProcessing(false), mIsDecayingDict(false),
               mDate(0), mLastDecayedTime(0), mNgramCounts(), mMaxNgramCounts(),
               mExtendedRegionSize(0), mHasHistoricalInfoOfWords(false),
-              mForgettingCurveProbabilityValuesTableId(0), mCodePointTable(nullptr) {}
+              mUsesNgramContextMap(false), mForgettingCurveProbabilityValuesTableId(0),
+              mCodePointTableStorage(), mCodePointTable(nullptr) {}
 
     ~HeaderPolicy() {}
 
@@ -125,6 +139,8 @@ class HeaderPolicy : public DictionaryHeaderStructurePolicy {
                 return FormatUtils::VERSION_402;
             case FormatUtils::VERSION_403:
                 return FormatUtils::VERSION_403;
+            case FormatUtils::VERSION_404:
+                return FormatUtils::VERSION_404;
             default:
                 return FormatUtils::UNKNOWN_VERSION;
         }
@@ -182,14 +198,17 @@ class HeaderPolicy : public DictionaryHeaderStructurePolicy {
         return mHasHistoricalInfoOfWords;
     }
 
+    AK_FORCE_INLINE bool usesNgramContextMap() const {
+        return mUsesNgramContextMap;
+    }
+
     AK_FORCE_INLINE bool shouldBoostExactMatches() const {
         // TODO: Investigate better ways to handle exact matches for personalized dictionaries.
         return !isDecayingDict();
     }
 
-    const DictionaryHeaderStructurePolicy::AttributeMap *getAttributeMap() const {
-        return &mAttributeMap;
-    }
+    // When the header is read from a dictionary buffer, the map is created on the first call.
+    const DictionaryHeaderStructurePolicy::AttributeMap *getAttributeMap() const;
 
     AK_FORCE_INLINE int getForgettingCurveProbabilityValuesTableId() const {
         return mForgettingCurveProbabilityValuesTableId;
@@ -214,6 +233,12 @@ class HeaderPolicy : public DictionaryHeaderStructurePolicy {
         return mDictFormatVersion >= FormatUtils::VERSION_402;
     }
 
+    // Whether the trie maps of the language model can have value links, which store the values of
+    // the n-grams without next level in 1 entry instead of 2.
+    bool usesTrieMapValueLinks() const {
+        return mDictFormatVersion >= FormatUtils::VERSION_404;
+    }
+
     const int *getCodePointTable() const {
         return mCodePointTable;
     }
@@ -231,6 +256,7 @@ class HeaderPolicy : public DictionaryHeaderStructurePolicy {
     static const int DEFAULT_MAX_NGRAM_COUNTS[];
     static const char *const EXTENDED_REGION_SIZE_KEY;
     static const char *const HAS_HISTORICAL_INFO_KEY;
+    static const char *const USES_NGRAM_CONTEXT_MAP_KEY;
     static const char *const LOCALE_KEY;
     static const char *const FORGETTING_CURVE_OCCURRENCES_TO_LEVEL_UP_KEY;
     static const char *const FORGETTING_CURVE_PROBABILITY_VALUES_TABLE_ID_KEY;
@@ -242,7 +268,11 @@ class HeaderPolicy : public DictionaryHeaderStructurePolicy {
     const FormatUtils::FORMAT_VERSION mDictFormatVersion;
     const HeaderReadWriteUtils::DictionaryFlags mDictionaryFlags;
     const int mSize;
-    DictionaryHeaderStructurePolicy::AttributeMap mAttributeMap;
+    // The dictionary buffer that the attributes are read from, or nullptr when the header is
+    // constructed from an attribute map.
+    const uint8_t *const mDictBuf;
+    mutable DictionaryHeaderStructurePolicy::AttributeMap mAttributeMap;
+    mutable std::once_flag mAttributeMapOnceFlag;
     const std::vector<int> mLocale;
     const float mMultiWordCostMultiplier;
     const bool mRequiresGermanUmlautProcessing;
@@ -253,7 +283,10 @@ class HeaderPolicy : public DictionaryHeaderStructurePolicy {
     const EntryCounts mMaxNgramCounts;
     const int mExtendedRegionSize;
     const bool mHasHistoricalInfoOfWords;
+    const bool mUsesNgramContextMap;
     const int mForgettingCurveProbabilityValuesTableId;
+    // The code point table that is read from the dictionary buffer.
+    const std::vector<int> mCodePointTableStorage;
     const int *const mCodePointTable;
 
     const std::vector<int> readLocale() const;
@@ -261,8 +294,8 @@ class HeaderPolicy : public DictionaryHeaderStructurePolicy {
     bool readRequiresGermanUmlautProcessing() const;
     const EntryCounts readNgramCounts() const;
     const EntryCounts readMaxNgramCounts() const;
-    static DictionaryHeaderStructurePolicy::AttributeMap createAttributeMapAndReadAllAttributes(
-            const uint8_t *const dictBuf);
+    bool readBoolAttributeValue(const char *const key, const bool defaultValue) const;
+    int readIntAttributeValue(const char *const key, const int defaultValue) const;
 };
 } // namespace latinime
 #endif /* LATINIME_HEADER_POLICY_H */
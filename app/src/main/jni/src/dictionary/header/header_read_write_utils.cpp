@@ -78,11 +78,11 @@ typedef DictionaryHeaderStructurePolicy::AttributeMap AttributeMap;
     std::unique_ptr<int[]> valueBuffer(new int[MAX_ATTRIBUTE_VALUE_LENGTH]);
     while (pos < headerSize) {
         // The values in the header don't use the code point table for their encoding.
-        const int keyLength = ByteArrayUtils::readStringAndAdvancePosition(dictBuf,
+        const int keyLength = ByteArrayUtils::readStringAndAdvancePosition(dictBuf, headerSize,
                 MAX_ATTRIBUTE_KEY_LENGTH, nullptr /* codePointTable */, keyBuffer, &pos);
         std::vector<int> key;
         key.insert(key.end(), keyBuffer, keyBuffer + keyLength);
-        const int valueLength = ByteArrayUtils::readStringAndAdvancePosition(dictBuf,
+        const int valueLength = ByteArrayUtils::readStringAndAdvancePosition(dictBuf, headerSize,
                 MAX_ATTRIBUTE_VALUE_LENGTH, nullptr /* codePointTable */, valueBuffer.get(), &pos);
         std::vector<int> value;
         value.insert(value.end(), valueBuffer.get(), valueBuffer.get() + valueLength);
@@ -117,6 +117,7 @@ typedef DictionaryHeaderStructurePolicy::AttributeMap AttributeMap;
         case FormatUtils::VERSION_4_ONLY_FOR_TESTING:
         case FormatUtils::VERSION_402:
         case FormatUtils::VERSION_403:
+        case FormatUtils::VERSION_404:
             return buffer->writeUintAndAdvancePosition(version /* data */,
                     HEADER_DICTIONARY_VERSION_SIZE, writingPos);
         default:
@@ -238,6 +239,93 @@ typedef DictionaryHeaderStructurePolicy::AttributeMap AttributeMap;
     return defaultValue;
 }
 
+/* static */ int HeaderReadWriteUtils::getAttributeValuePosition(const uint8_t *const dictBuf,
+        const char *const key) {
+    const int headerSize = getHeaderSize(dictBuf);
+    int pos = getHeaderOptionsPosition();
+    while (pos < headerSize) {
+        // The first attribute with the key is used like in fetchAllHeaderAttributes().
+        int keyPos = pos;
+        bool matches = true;
+        for (int i = 0; i < MAX_ATTRIBUTE_KEY_LENGTH; ++i) {
+            const int codePoint = ByteArrayUtils::readCodePointAndAdvancePosition(dictBuf,
+                    nullptr /* codePointTable */, &keyPos);
+            if (codePoint == NOT_A_CODE_POINT || key[i] == '\0') {
+                matches = codePoint == NOT_A_CODE_POINT && key[i] == '\0';
+                break;
+            }
+            if (codePoint != static_cast<unsigned char>(key[i])) {
+                matches = false;
+                break;
+            }
+        }
+        ByteArrayUtils::advancePositionToBehindString(dictBuf, headerSize,
+                MAX_ATTRIBUTE_KEY_LENGTH, &pos);
+        if (matches) {
+            return pos;
+        }
+        ByteArrayUtils::advancePositionToBehindString(dictBuf, headerSize,
+                MAX_ATTRIBUTE_VALUE_LENGTH, &pos);
+    }
+    return NOT_A_DICT_POS;
+}
+
+/* static */ const std::vector<int> HeaderReadWriteUtils::readCodePointVectorAttributeValue(
+        const uint8_t *const dictBuf, const char *const key) {
+    int pos = getAttributeValuePosition(dictBuf, key);
+    if (pos == NOT_A_DICT_POS) {
+        return std::vector<int>();
+    }
+    const int headerSize = getHeaderSize(dictBuf);
+    int valueEndPos = pos;
+    const int valueLength = ByteArrayUtils::advancePositionToBehindString(dictBuf, headerSize,
+            MAX_ATTRIBUTE_VALUE_LENGTH, &valueEndPos);
+    std::vector<int> value(valueLength);
+    ByteArrayUtils::readStringAndAdvancePosition(dictBuf, headerSize, valueLength,
+            nullptr /* codePointTable */, value.data(), &pos);
+    return value;
+}
+
+/* static */ bool HeaderReadWriteUtils::readBoolAttributeValue(const uint8_t *const dictBuf,
+        const char *const key, const bool defaultValue) {
+    const int intDefaultValue = defaultValue ? 1 : 0;
+    const int intValue = readIntAttributeValue(dictBuf, key, intDefaultValue);
+    return intValue != 0;
+}
+
+/* static */ int HeaderReadWriteUtils::readIntAttributeValue(const uint8_t *const dictBuf,
+        const char *const key, const int defaultValue) {
+    int pos = getAttributeValuePosition(dictBuf, key);
+    if (pos == NOT_A_DICT_POS) {
+        return defaultValue;
+    }
+    int value = 0;
+    bool isNegative = false;
+    for (int i = 0; i < MAX_ATTRIBUTE_VALUE_LENGTH; ++i) {
+        const int codePoint = ByteArrayUtils::readCodePointAndAdvancePosition(dictBuf,
+                nullptr /* codePointTable */, &pos);
+        if (codePoint == NOT_A_CODE_POINT) {
+            break;
+        }
+        if (i == 0 && codePoint == '-') {
+            isNegative = true;
+        } else {
+            if (codePoint < '0' || codePoint > '9') {
+                // If not a number.
+                return defaultValue;
+            }
+            value *= 10;
+            value += codePoint - '0';
+        }
+    }
+    return isNegative ? -value : value;
+}
+
+/* static */ const std::vector<int> HeaderReadWriteUtils::readCodePointTable(
+        const uint8_t *const dictBuf) {
+    return readCodePointVectorAttributeValue(dictBuf, CODE_POINT_TABLE_KEY);
+}
+
 /* static */ void HeaderReadWriteUtils::insertCharactersIntoVector(const char *const characters,
         std::vector<int> *const vector) {
     for (int i = 0; characters[i]; ++i) {
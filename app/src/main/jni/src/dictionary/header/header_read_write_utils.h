@@ -18,6 +18,7 @@
 #define LATINIME_HEADER_READ_WRITE_UTILS_H
 
 #include <cstdint>
+#include <vector>
 
 #include "defines.h"
 #include "dictionary/interface/dictionary_header_structure_policy.h"
@@ -89,6 +90,25 @@ class HeaderReadWriteUtils {
             const DictionaryHeaderStructurePolicy::AttributeMap *const headerAttributes,
             const char *const key, const int defaultValue);
 
+    /**
+     * Methods for header attributes that are read in place from the header in the dictionary
+     * buffer. They don't parse the other attributes.
+     */
+    // Returns the position of the value of the attribute, or NOT_A_DICT_POS when the header
+    // doesn't have the attribute.
+    static int getAttributeValuePosition(const uint8_t *const dictBuf, const char *const key);
+
+    static const std::vector<int> readCodePointVectorAttributeValue(const uint8_t *const dictBuf,
+            const char *const key);
+
+    static bool readBoolAttributeValue(const uint8_t *const dictBuf, const char *const key,
+            const bool defaultValue);
+
+    static int readIntAttributeValue(const uint8_t *const dictBuf, const char *const key,
+            const int defaultValue);
+
+    static const std::vector<int> readCodePointTable(const uint8_t *const dictBuf);
+
     static void insertCharactersIntoVector(const char *const characters,
             DictionaryHeaderStructurePolicy::AttributeMap::key_type *const key);
 
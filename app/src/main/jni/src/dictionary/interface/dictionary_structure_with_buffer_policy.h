@@ -18,6 +18,7 @@
 #define LATINIME_DICTIONARY_STRUCTURE_POLICY_H
 
 #include <memory>
+#include <vector>
 
 #include "defines.h"
 #include "dictionary/property/historical_info.h"
@@ -31,6 +32,7 @@ namespace latinime {
 class DicNode;
 class DicNodeVector;
 class DictionaryHeaderStructurePolicy;
+class MemoryUsage;
 class MultiBigramMap;
 class NgramListener;
 class NgramContext;
@@ -51,6 +53,10 @@ class DictionaryStructureWithBufferPolicy {
     virtual void createAndGetAllChildDicNodes(const DicNode *const dicNode,
             DicNodeVector *const childDicNodes) const = 0;
 
+    // Hints that the PtNode array at ptNodeArrayPos is going to be read soon, e.g. to create the
+    // children of a DicNode. Positions outside of the dictionary are ignored.
+    virtual void prefetchPtNodeArray(const int ptNodeArrayPos) const = 0;
+
     virtual int getCodePointsAndReturnCodePointCount(const int wordId, const int maxCodePointCount,
             int *const outCodePoints) const = 0;
 
@@ -60,6 +66,12 @@ class DictionaryStructureWithBufferPolicy {
     virtual const WordAttributes getWordAttributesInContext(const WordIdArrayView prevWordIds,
             const int wordId, MultiBigramMap *const multiBigramMap) const = 0;
 
+    // Writes the maximum probability of the words that match the code points when case, accents
+    // and intentional omissions are ignored to outProbability. Returns false when the policy
+    // can't look the words up without traversing the trie.
+    virtual bool getMaxProbabilityOfExactMatches(const CodePointArrayView codePoints,
+            int *const outProbability) const = 0;
+
     // TODO: Remove
     virtual int getProbability(const int unigramProbability, const int bigramProbability) const = 0;
 
@@ -76,6 +88,11 @@ class DictionaryStructureWithBufferPolicy {
     virtual bool addUnigramEntry(const CodePointArrayView wordCodePoints,
             const UnigramProperty *const unigramProperty) = 0;
 
+    // Adds many unigram entries at once, which is much faster than adding them one by one when
+    // the dictionary is empty. Returns whether all the entries were added or not.
+    virtual bool addUnigramEntries(const std::vector<CodePointArrayView> &wordCodePoints,
+            const std::vector<UnigramProperty> &unigramProperties) = 0;
+
     // Returns whether the update was success or not.
     virtual bool removeUnigramEntry(const CodePointArrayView wordCodePoints) = 0;
 
@@ -108,12 +125,20 @@ class DictionaryStructureWithBufferPolicy {
 
     // Method to iterate all words in the dictionary.
     // The returned token has to be used to get the next word. If token is 0, this method newly
-    // starts iterating the dictionary.
+    // starts iterating the dictionary. outWordId, when not null, receives the id of the word,
+    // which saves looking the word up again.
     virtual int getNextWordAndNextToken(const int token, int *const outCodePoints,
-            int *const outCodePointCount) = 0;
+            int *const outCodePointCount, int *const outWordId) = 0;
 
     virtual bool isCorrupted() const = 0;
 
+    // Adds the memory held by the policy and its buffers to outMemoryUsage.
+    virtual void addMemoryUsage(MemoryUsage *const outMemoryUsage) const = 0;
+
+    // Drops the resident pages of the read-only mapped buffers. Buffers that can be updated are
+    // kept.
+    virtual void releaseCleanPages() const = 0;
+
  protected:
     DictionaryStructureWithBufferPolicy() {}
 
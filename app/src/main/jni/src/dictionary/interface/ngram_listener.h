@@ -26,9 +26,57 @@ namespace latinime {
  */
 class NgramListener {
  public:
+    // The entries are passed to onVisitEntries() in chunks of at most this size.
+    static const int MAX_BATCH_SIZE = 64;
+
+    // Collects the visited entries of a policy and passes them to the listener in chunks, so
+    // that there is one virtual call per chunk.
+    class Batch {
+     public:
+        explicit Batch(NgramListener *const listener)
+                : mListener(listener), mNgramProbabilities(), mTargetWordIds(), mSize(0) {}
+
+        ~Batch() {
+            flush();
+        }
+
+        AK_FORCE_INLINE void add(const int ngramProbability, const int targetWordId) {
+            mNgramProbabilities[mSize] = ngramProbability;
+            mTargetWordIds[mSize] = targetWordId;
+            if (++mSize == MAX_BATCH_SIZE) {
+                flush();
+            }
+        }
+
+        void flush() {
+            if (mSize > 0) {
+                mListener->onVisitEntries(mNgramProbabilities, mTargetWordIds, mSize);
+                mSize = 0;
+            }
+        }
+
+     private:
+        DISALLOW_IMPLICIT_CONSTRUCTORS(Batch);
+
+        NgramListener *const mListener;
+        int mNgramProbabilities[MAX_BATCH_SIZE];
+        int mTargetWordIds[MAX_BATCH_SIZE];
+        int mSize;
+    };
+
     // ngramProbability is always 0 for v403 decaying dictionary.
     // TODO: Remove ngramProbability.
     virtual void onVisitEntry(const int ngramProbability, const int targetWordId) = 0;
+
+    // Called by the policies with the entries in the order they are visited. Listeners that do
+    // little work per entry can override this to handle a chunk in a single loop.
+    virtual void onVisitEntries(const int *const ngramProbabilities,
+            const int *const targetWordIds, const int count) {
+        for (int i = 0; i < count; ++i) {
+            onVisitEntry(ngramProbabilities[i], targetWordIds[i]);
+        }
+    }
+
     virtual ~NgramListener() {};
 
  protected:
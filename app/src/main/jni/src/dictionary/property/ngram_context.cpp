@@ -85,6 +85,21 @@ bool NgramContext::isNthPrevWordBeginningOfSentence(const size_t n) const {
     return mIsBeginningOfSentence[n - 1];
 }
 
+bool NgramContext::hasSamePrevWords(const NgramContext &ngramContext) const {
+    if (mPrevWordCount != ngramContext.mPrevWordCount) {
+        return false;
+    }
+    for (size_t i = 0; i < mPrevWordCount; ++i) {
+        if (mPrevWordCodePointCount[i] != ngramContext.mPrevWordCodePointCount[i]
+                || mIsBeginningOfSentence[i] != ngramContext.mIsBeginningOfSentence[i]
+                || memcmp(mPrevWordCodePoints[i], ngramContext.mPrevWordCodePoints[i],
+                        sizeof(mPrevWordCodePoints[i][0]) * mPrevWordCodePointCount[i]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /* static */ int NgramContext::getWordId(
         const DictionaryStructureWithBufferPolicy *const dictStructurePolicy,
         const int *const wordCodePoints, const int wordCodePointCount,
@@ -60,6 +60,8 @@ class NgramContext {
     const CodePointArrayView getNthPrevWordCodePoints(const size_t n) const;
     // n is 1-indexed.
     bool isNthPrevWordBeginningOfSentence(const size_t n) const;
+    // Returns whether the prev words resolve to the same word ids in any dictionary.
+    bool hasSamePrevWords(const NgramContext &ngramContext) const;
 
  private:
     DISALLOW_ASSIGNMENT_OPERATOR(NgramContext);
@@ -61,6 +61,10 @@ class SingleDictContent : public DictContent {
         return mExpandableContentBuffer.isNearSizeLimit();
     }
 
+    int getUsedAdditionalBufferSize() const {
+        return mExpandableContentBuffer.getUsedAdditionalBufferSize();
+    }
+
  protected:
     BufferWithExtendableBuffer *getWritableBuffer() {
         return &mExpandableContentBuffer;
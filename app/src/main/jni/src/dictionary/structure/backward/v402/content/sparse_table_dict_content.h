@@ -86,6 +86,12 @@ class SparseTableDictContent : public DictContent {
                 || mExpandableContentBuffer.isNearSizeLimit();
     }
 
+    int getUsedAdditionalBufferSize() const {
+        return mExpandableLookupTableBuffer.getUsedAdditionalBufferSize()
+                + mExpandableAddressTableBuffer.getUsedAdditionalBufferSize()
+                + mExpandableContentBuffer.getUsedAdditionalBufferSize();
+    }
+
  protected:
     SparseTable *getUpdatableAddressLookupTable() {
         return &mAddressLookupTable;
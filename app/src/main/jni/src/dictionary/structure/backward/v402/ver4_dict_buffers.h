@@ -67,6 +67,29 @@ class Ver4DictBuffers {
                 || mShortcutDictContent.isNearSizeLimit();
     }
 
+    AK_FORCE_INLINE size_t getMappedBufferSize() const {
+        return (mHeaderBuffer ? mHeaderBuffer->getReadOnlyByteArrayView().size() : 0)
+                + (mDictBuffer ? mDictBuffer->getReadOnlyByteArrayView().size() : 0);
+    }
+
+    void releaseCleanPages() const {
+        if (mHeaderBuffer) {
+            mHeaderBuffer->releaseCleanPages();
+        }
+        if (mDictBuffer) {
+            mDictBuffer->releaseCleanPages();
+        }
+    }
+
+    AK_FORCE_INLINE int getUsedAdditionalBufferSize() const {
+        return mExpandableHeaderBuffer.getUsedAdditionalBufferSize()
+                + mExpandableTrieBuffer.getUsedAdditionalBufferSize()
+                + mTerminalPositionLookupTable.getUsedAdditionalBufferSize()
+                + mProbabilityDictContent.getUsedAdditionalBufferSize()
+                + mBigramDictContent.getUsedAdditionalBufferSize()
+                + mShortcutDictContent.getUsedAdditionalBufferSize();
+    }
+
     AK_FORCE_INLINE const HeaderPolicy *getHeaderPolicy() const {
         return &mHeaderPolicy;
     }
@@ -160,6 +160,13 @@ bool Ver4PatriciaTrieNodeWriter::updatePtNodeUnigramProperty(
             toBeUpdatedPtNodeParams->getTerminalId(), &probabilityEntry);
 }
 
+bool Ver4PatriciaTrieNodeWriter::restorePtNodeAndUpdateUnigramProperty(
+        const PtNodeParams *const toBeUpdatedPtNodeParams,
+        const UnigramProperty *const unigramProperty) {
+    // The PtNode flags hold unigram flags in this format; the PtNode is moved to update them.
+    return false;
+}
+
 bool Ver4PatriciaTrieNodeWriter::updatePtNodeProbabilityAndGetNeedsToKeepPtNodeAfterGC(
         const PtNodeParams *const toBeUpdatedPtNodeParams, bool *const outNeedsToKeepPtNode) {
     if (!toBeUpdatedPtNodeParams->isTerminal()) {
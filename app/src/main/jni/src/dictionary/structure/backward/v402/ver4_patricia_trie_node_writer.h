@@ -78,6 +78,10 @@ class Ver4PatriciaTrieNodeWriter : public PtNodeWriter {
     virtual bool updatePtNodeUnigramProperty(const PtNodeParams *const toBeUpdatedPtNodeParams,
             const UnigramProperty *const unigramProperty);
 
+    virtual bool restorePtNodeAndUpdateUnigramProperty(
+            const PtNodeParams *const toBeUpdatedPtNodeParams,
+            const UnigramProperty *const unigramProperty);
+
     virtual bool updatePtNodeProbabilityAndGetNeedsToKeepPtNodeAfterGC(
             const PtNodeParams *const toBeUpdatedPtNodeParams, bool *const outNeedsToKeepPtNode);
 
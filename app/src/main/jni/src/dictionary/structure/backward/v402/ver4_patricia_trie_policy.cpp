@@ -38,6 +38,7 @@
 #include "dictionary/utils/forgetting_curve_utils.h"
 #include "dictionary/utils/multi_bigram_map.h"
 #include "dictionary/utils/probability_utils.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 namespace backward {
@@ -208,12 +209,13 @@ void Ver4PatriciaTriePolicy::iterateNgramEntries(const WordIdArrayView prevWordI
     const int bigramsPosition = mBuffers->getBigramDictContent()->getBigramListHeadPos(
             prevWordPtNodeParams.getTerminalId());
     BinaryDictionaryBigramsIterator bigramsIt(&mBigramPolicy, bigramsPosition);
+    NgramListener::Batch batch(listener);
     while (bigramsIt.hasNext()) {
         bigramsIt.next();
         const int bigramConditionalProbability = getBigramConditionalProbability(
                 prevWordPtNodeParams.getProbability(),
                 prevWordPtNodeParams.representsBeginningOfSentence(), bigramsIt.getProbability());
-        listener->onVisitEntry(bigramConditionalProbability,
+        batch.add(bigramConditionalProbability,
                 getWordIdFromTerminalPtNodePos(bigramsIt.getBigramPos()));
     }
 }
@@ -330,6 +332,20 @@ bool Ver4PatriciaTriePolicy::addUnigramEntry(const CodePointArrayView wordCodePo
     }
 }
 
+bool Ver4PatriciaTriePolicy::addUnigramEntries(
+        const std::vector<CodePointArrayView> &wordCodePoints,
+        const std::vector<UnigramProperty> &unigramProperties) {
+    // Dictionaries of this version are not created anymore, so they are only updated one entry at
+    // a time.
+    bool addedAllEntries = true;
+    for (size_t i = 0; i < wordCodePoints.size(); ++i) {
+        if (!addUnigramEntry(wordCodePoints[i], &unigramProperties[i])) {
+            addedAllEntries = false;
+        }
+    }
+    return addedAllEntries;
+}
+
 bool Ver4PatriciaTriePolicy::removeUnigramEntry(const CodePointArrayView wordCodePoints) {
     if (!mBuffers->isUpdatable()) {
         AKLOGI("Warning: removeUnigramEntry() is called for non-updatable dictionary.");
@@ -621,8 +637,11 @@ const WordProperty Ver4PatriciaTriePolicy::getWordProperty(
 }
 
 int Ver4PatriciaTriePolicy::getNextWordAndNextToken(const int token, int *const outCodePoints,
-        int *const outCodePointCount) {
+        int *const outCodePointCount, int *const outWordId) {
     *outCodePointCount = 0;
+    if (outWordId) {
+        *outWordId = NOT_A_WORD_ID;
+    }
     if (token == 0) {
         mTerminalPtNodePositionsForIteratingWords.clear();
         DynamicPtReadingHelper::TraversePolicyToGetAllTerminalPtNodePositions traversePolicy(
@@ -638,8 +657,12 @@ int Ver4PatriciaTriePolicy::getNextWordAndNextToken(const int token, int *const
         return 0;
     }
     const int terminalPtNodePos = mTerminalPtNodePositionsForIteratingWords[token];
-    *outCodePointCount = getCodePointsAndReturnCodePointCount(
-            getWordIdFromTerminalPtNodePos(terminalPtNodePos), MAX_WORD_LENGTH, outCodePoints);
+    const int wordId = getWordIdFromTerminalPtNodePos(terminalPtNodePos);
+    *outCodePointCount = getCodePointsAndReturnCodePointCount(wordId, MAX_WORD_LENGTH,
+            outCodePoints);
+    if (outWordId) {
+        *outWordId = wordId;
+    }
     const int nextToken = token + 1;
     if (nextToken >= terminalPtNodePositionsVectorSize) {
         // All words have been iterated.
@@ -657,6 +680,16 @@ int Ver4PatriciaTriePolicy::getTerminalPtNodePosFromWordId(const int wordId) con
     return wordId == NOT_A_WORD_ID ? NOT_A_DICT_POS : wordId;
 }
 
+void Ver4PatriciaTriePolicy::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    outMemoryUsage->add(MemoryUsage::MAPPED_FILE_BYTES,
+            static_cast<int64_t>(mBuffers->getMappedBufferSize()));
+    outMemoryUsage->add(MemoryUsage::ADDITIONAL_BUFFER_BYTES,
+            mBuffers->getUsedAdditionalBufferSize());
+    outMemoryUsage->add(MemoryUsage::HEAP_BYTES,
+            static_cast<int64_t>(sizeof(*this) + sizeof(*mBuffers)));
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mTerminalPtNodePositionsForIteratingWords);
+}
+
 } // namespace v402
 } // namespace backward
 } // namespace latinime
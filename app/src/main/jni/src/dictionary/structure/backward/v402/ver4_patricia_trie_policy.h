@@ -25,6 +25,7 @@
 #ifndef LATINIME_BACKWARD_V402_VER4_PATRICIA_TRIE_POLICY_H
 #define LATINIME_BACKWARD_V402_VER4_PATRICIA_TRIE_POLICY_H
 
+#include <atomic>
 #include <vector>
 
 #include "defines.h"
@@ -86,6 +87,12 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     void createAndGetAllChildDicNodes(const DicNode *const dicNode,
             DicNodeVector *const childDicNodes) const;
 
+    void prefetchPtNodeArray(const int ptNodeArrayPos) const {
+        if (ptNodeArrayPos >= 0 && ptNodeArrayPos < mDictBuffer->getTailPosition()) {
+            mDictBuffer->prefetch(ptNodeArrayPos);
+        }
+    }
+
     int getCodePointsAndReturnCodePointCount(const int wordId, const int maxCodePointCount,
             int *const outCodePoints) const;
 
@@ -94,6 +101,12 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     const WordAttributes getWordAttributesInContext(const WordIdArrayView prevWordIds,
             const int wordId, MultiBigramMap *const multiBigramMap) const;
 
+    bool getMaxProbabilityOfExactMatches(const CodePointArrayView codePoints,
+            int *const outProbability) const {
+        // The words change with the updates.
+        return false;
+    }
+
     int getProbability(const int unigramProbability, const int bigramProbability) const;
 
     int getProbabilityOfWord(const WordIdArrayView prevWordIds, const int wordId) const;
@@ -110,6 +123,9 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     bool addUnigramEntry(const CodePointArrayView wordCodePoints,
             const UnigramProperty *const unigramProperty);
 
+    bool addUnigramEntries(const std::vector<CodePointArrayView> &wordCodePoints,
+            const std::vector<UnigramProperty> &unigramProperties);
+
     bool removeUnigramEntry(const CodePointArrayView wordCodePoints);
 
     bool addNgramEntry(const NgramProperty *const ngramProperty);
@@ -133,12 +149,26 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     const WordProperty getWordProperty(const CodePointArrayView wordCodePoints) const;
 
     int getNextWordAndNextToken(const int token, int *const outCodePoints,
-            int *const outCodePointCount);
+            int *const outCodePointCount, int *const outWordId);
 
     bool isCorrupted() const {
         return mIsCorrupted;
     }
 
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+
+    void releaseCleanPages() const {
+        mBuffers->releaseCleanPages();
+    }
+
+    // For DictMigrationUtils, which reads the buffers directly to migrate the dictionary.
+    const Ver4DictBuffers *getDictBuffers() const {
+        return mBuffers.get();
+    }
+
+    int getBigramConditionalProbability(const int prevWordUnigramProbability,
+            const bool isInBeginningOfSentenceContext, const int bigramProbability) const;
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(Ver4PatriciaTriePolicy);
 
@@ -164,7 +194,8 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     Ver4PatriciaTrieWritingHelper mWritingHelper;
     MutableEntryCounters mEntryCounters;
     std::vector<int> mTerminalPtNodePositionsForIteratingWords;
-    mutable bool mIsCorrupted;
+    // Set from the reading methods, which can run concurrently.
+    mutable std::atomic<bool> mIsCorrupted;
 
     int getBigramsPositionOfPtNode(const int ptNodePos) const;
     int getShortcutPositionOfPtNode(const int ptNodePos) const;
@@ -172,8 +203,6 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     int getTerminalPtNodePosFromWordId(const int wordId) const;
     const WordAttributes getWordAttributes(const int probability,
             const PtNodeParams &ptNodeParams) const;
-    int getBigramConditionalProbability(const int prevWordUnigramProbability,
-            const bool isInBeginningOfSentenceContext, const int bigramProbability) const;
 };
 } // namespace v402
 } // namespace backward
@@ -66,7 +66,8 @@ namespace latinime {
                             dictFormatVersion, locale, attributeMap);
         }
         case FormatUtils::VERSION_4_ONLY_FOR_TESTING:
-        case FormatUtils::VERSION_403: {
+        case FormatUtils::VERSION_403:
+        case FormatUtils::VERSION_404: {
             return newPolicyForOnMemoryV4Dict<Ver4DictConstants, Ver4DictBuffers,
                     Ver4DictBuffers::Ver4DictBuffersPtr, Ver4PatriciaTriePolicy>(
                             dictFormatVersion, locale, attributeMap);
@@ -126,7 +127,8 @@ template<class DictConstants, class DictBuffers, class DictBuffersPtr, class Str
                             headerFilePath, formatVersion, std::move(mmappedBuffer));
         }
         case FormatUtils::VERSION_4_ONLY_FOR_TESTING:
-        case FormatUtils::VERSION_403: {
+        case FormatUtils::VERSION_403:
+        case FormatUtils::VERSION_404: {
             return newPolicyForV4Dict<Ver4DictConstants, Ver4DictBuffers,
                     Ver4DictBuffers::Ver4DictBuffersPtr, Ver4PatriciaTriePolicy>(
                             headerFilePath, formatVersion, std::move(mmappedBuffer));
@@ -171,7 +173,8 @@ template<class DictConstants, class DictBuffers, class DictBuffersPtr, class Str
     // Allocated buffer in MmapedBuffer::openBuffer() will be freed in the destructor of
     // MmappedBufferPtr if the instance has the responsibility.
     MmappedBuffer::MmappedBufferPtr mmappedBuffer(
-            MmappedBuffer::openBuffer(path, bufOffset, size, false /* isUpdatable */));
+            MmappedBuffer::openBuffer(path, bufOffset, size, false /* isUpdatable */,
+                    MmappedBuffer::AccessPolicy::HOT_HEAD_WITH_PREFAULT));
     if (!mmappedBuffer) {
         return nullptr;
     }
@@ -186,6 +189,7 @@ template<class DictConstants, class DictBuffers, class DictBuffersPtr, class Str
         case FormatUtils::VERSION_4_ONLY_FOR_TESTING:
         case FormatUtils::VERSION_402:
         case FormatUtils::VERSION_403:
+        case FormatUtils::VERSION_404:
             AKLOGE("Given path is a file but the format is version 4. path: %s", path);
             break;
         default:
@@ -175,6 +175,65 @@ bool DynamicPtReadingHelper::traverseAllPtNodesInPtNodeArrayLevelPreorderDepthFi
     return !isError();
 }
 
+// Visits the PtNode arrays of the first hotLevelCount levels in breadth first order, and then the
+// subtrees below them one after another in PtNode array level pre-order depth first manner. When
+// PtNodes are written in this order, the PtNode arrays that every lookup reads are contiguous
+// at the head of the buffer instead of being spread among the deeper PtNode arrays.
+// For example, visits a -> d -> b -> e -> c -> f for the following dictionary with hotLevelCount 2,
+// where the pre-order above visits a -> d -> b -> c -> e -> f:
+// a _ b _ c
+// d _ e _ f
+// Each hot PtNode array is notified with onDescend(), onVisitingPtNode() for its PtNodes,
+// onReadingPtNodeArrayTail() and onAscend().
+bool DynamicPtReadingHelper::traverseAllPtNodesInPtNodeArrayLevelHotLevelsFirstManner(
+        const int hotLevelCount, TraversingEventListener *const listener) {
+    if (hotLevelCount <= 0) {
+        return traverseAllPtNodesInPtNodeArrayLevelPreorderDepthFirstManner(listener);
+    }
+    std::vector<int> ptNodeArrayPositions;
+    std::vector<int> childPtNodeArrayPositions;
+    if (getPosOfLastPtNodeArrayHead() != NOT_A_DICT_POS) {
+        ptNodeArrayPositions.push_back(getPosOfLastPtNodeArrayHead());
+    }
+    for (int level = 0; level < hotLevelCount; ++level) {
+        childPtNodeArrayPositions.clear();
+        for (const int ptNodeArrayPos : ptNodeArrayPositions) {
+            if (!listener->onDescend(ptNodeArrayPos)) {
+                return false;
+            }
+            initWithPtNodeArrayPos(ptNodeArrayPos);
+            while (!isEnd()) {
+                const PtNodeParams ptNodeParams(getPtNodeParams());
+                if (!ptNodeParams.isValid()) {
+                    break;
+                }
+                if (!listener->onVisitingPtNode(&ptNodeParams)) {
+                    return false;
+                }
+                if (ptNodeParams.hasChildren()) {
+                    childPtNodeArrayPositions.push_back(ptNodeParams.getChildrenPos());
+                }
+                readNextSiblingNode(ptNodeParams);
+            }
+            if (isError()) {
+                return false;
+            }
+            if (!listener->onReadingPtNodeArrayTail() || !listener->onAscend()) {
+                return false;
+            }
+        }
+        ptNodeArrayPositions.swap(childPtNodeArrayPositions);
+    }
+    // The PtNode arrays below the hot levels.
+    for (const int ptNodeArrayPos : ptNodeArrayPositions) {
+        initWithPtNodeArrayPos(ptNodeArrayPos);
+        if (!traverseAllPtNodesInPtNodeArrayLevelPreorderDepthFirstManner(listener)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 int DynamicPtReadingHelper::getCodePointsAndReturnCodePointCount(const int maxCodePointCount,
         int *const outCodePoints) {
     // This method traverses parent nodes from the terminal by following parent pointers; thus,
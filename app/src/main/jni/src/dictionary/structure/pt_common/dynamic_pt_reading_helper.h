@@ -211,6 +211,9 @@ class DynamicPtReadingHelper {
     bool traverseAllPtNodesInPtNodeArrayLevelPreorderDepthFirstManner(
             TraversingEventListener *const listener);
 
+    bool traverseAllPtNodesInPtNodeArrayLevelHotLevelsFirstManner(const int hotLevelCount,
+            TraversingEventListener *const listener);
+
     int getCodePointsAndReturnCodePointCount(const int maxCodePointCount, int *const outCodePoints);
 
     int getTerminalPtNodePositionOfWord(const int *const inWord, const size_t length,
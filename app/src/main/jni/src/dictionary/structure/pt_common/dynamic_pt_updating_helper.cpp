@@ -16,6 +16,8 @@
 
 #include "dictionary/structure/pt_common/dynamic_pt_updating_helper.h"
 
+#include <algorithm>
+
 #include "dictionary/property/unigram_property.h"
 #include "dictionary/structure/pt_common/dynamic_pt_reading_helper.h"
 #include "dictionary/structure/pt_common/dynamic_pt_writing_utils.h"
@@ -81,6 +83,25 @@ bool DynamicPtUpdatingHelper::addUnigramWord(DynamicPtReadingHelper *const readi
             &pos);
 }
 
+bool DynamicPtUpdatingHelper::addUnigramWordsToEmptyTrie(
+        DynamicPtReadingHelper *const readingHelper,
+        const std::vector<CodePointArrayView> &wordCodePoints,
+        const std::vector<const UnigramProperty *> &unigramProperties) {
+    if (wordCodePoints.empty()) {
+        return true;
+    }
+    const int newPtNodeArrayPos = mBuffer->getTailPosition();
+    if (!writePtNodeArrayForWords(NOT_A_DICT_POS /* parentPos */, 0 /* matchedCodePointCount */,
+            wordCodePoints, unigramProperties, 0 /* begin */, wordCodePoints.size())) {
+        return false;
+    }
+    // The root PtNode array is empty, so the new PtNode array is linked from its forward link.
+    // This is done last to keep the trie empty when writing fails.
+    int forwardLinkFieldPos = readingHelper->getPosOfLastForwardLinkField();
+    return DynamicPtWritingUtils::writeForwardLinkPositionAndAdvancePosition(mBuffer,
+            newPtNodeArrayPos, &forwardLinkFieldPos);
+}
+
 bool DynamicPtUpdatingHelper::addNgramEntry(const PtNodePosArrayView prevWordsPtNodePos,
         const int wordPos, const NgramProperty *const ngramProperty,
         bool *const outAddedNewEntry) {
@@ -134,12 +155,105 @@ bool DynamicPtUpdatingHelper::createAndInsertNodeIntoPtNodeArray(const int paren
     return createNewPtNodeArrayWithAChildPtNode(parentPos, ptNodeCodePoints, unigramProperty);
 }
 
+// Writes a PtNode array for the words in [begin, end) at the tail of the buffer, followed by the
+// PtNode arrays of their children. All the words share the first matchedCodePointCount code
+// points and are longer than that.
+bool DynamicPtUpdatingHelper::writePtNodeArrayForWords(const int parentPos,
+        const size_t matchedCodePointCount, const std::vector<CodePointArrayView> &wordCodePoints,
+        const std::vector<const UnigramProperty *> &unigramProperties, const size_t begin,
+        const size_t end) {
+    struct PtNodeRange {
+        int mPtNodePos;
+        size_t mBegin;
+        size_t mEnd;
+        size_t mCodePointCount;
+    };
+    // Words sharing the next code point go to the same PtNode.
+    std::vector<PtNodeRange> ptNodeRanges;
+    for (size_t i = begin; i < end; ++i) {
+        if (i == begin || wordCodePoints[i][matchedCodePointCount]
+                != wordCodePoints[i - 1][matchedCodePointCount]) {
+            ptNodeRanges.push_back({ NOT_A_DICT_POS, i, i + 1, 0 });
+        } else {
+            ptNodeRanges.back().mEnd = i + 1;
+        }
+    }
+    int writingPos = mBuffer->getTailPosition();
+    if (!DynamicPtWritingUtils::writePtNodeArraySizeAndAdvancePosition(mBuffer,
+            ptNodeRanges.size(), &writingPos)) {
+        return false;
+    }
+    for (auto &ptNodeRange : ptNodeRanges) {
+        // As the words are sorted, the code points shared by all the words of the PtNode are the
+        // common prefix of the first one and the last one.
+        const CodePointArrayView firstWord = wordCodePoints[ptNodeRange.mBegin];
+        const CodePointArrayView lastWord = wordCodePoints[ptNodeRange.mEnd - 1];
+        const size_t maxCodePointCount = std::min(firstWord.size(), lastWord.size());
+        size_t codePointCount = matchedCodePointCount + 1;
+        while (codePointCount < maxCodePointCount
+                && firstWord[codePointCount] == lastWord[codePointCount]) {
+            ++codePointCount;
+        }
+        ptNodeRange.mPtNodePos = writingPos;
+        ptNodeRange.mCodePointCount = codePointCount;
+        const CodePointArrayView ptNodeCodePoints =
+                firstWord.limit(codePointCount).skip(matchedCodePointCount);
+        // Only the first word can end at this PtNode because the words are unique.
+        if (firstWord.size() == codePointCount) {
+            const UnigramProperty *const unigramProperty =
+                    unigramProperties[ptNodeRange.mBegin];
+            const PtNodeParams ptNodeParamsToWrite(getPtNodeParamsForNewPtNode(
+                    unigramProperty->isNotAWord(), unigramProperty->isPossiblyOffensive(),
+                    true /* isTerminal */, parentPos, ptNodeCodePoints,
+                    unigramProperty->getProbability()));
+            if (!mPtNodeWriter->writeNewTerminalPtNodeAndAdvancePosition(&ptNodeParamsToWrite,
+                    unigramProperty, &writingPos)) {
+                return false;
+            }
+            ++ptNodeRange.mBegin;
+        } else {
+            const PtNodeParams ptNodeParamsToWrite(getPtNodeParamsForNewPtNode(
+                    false /* isNotAWord */, false /* isPossiblyOffensive */,
+                    false /* isTerminal */, parentPos, ptNodeCodePoints, NOT_A_PROBABILITY));
+            if (!mPtNodeWriter->writePtNodeAndAdvancePosition(&ptNodeParamsToWrite,
+                    &writingPos)) {
+                return false;
+            }
+        }
+    }
+    if (!DynamicPtWritingUtils::writeForwardLinkPositionAndAdvancePosition(mBuffer,
+            NOT_A_DICT_POS /* forwardLinkPos */, &writingPos)) {
+        return false;
+    }
+    for (const auto &ptNodeRange : ptNodeRanges) {
+        if (ptNodeRange.mBegin == ptNodeRange.mEnd) {
+            continue;
+        }
+        const int childrenPos = mBuffer->getTailPosition();
+        if (!writePtNodeArrayForWords(ptNodeRange.mPtNodePos, ptNodeRange.mCodePointCount,
+                wordCodePoints, unigramProperties, ptNodeRange.mBegin, ptNodeRange.mEnd)) {
+            return false;
+        }
+        const PtNodeParams ptNodeParams(
+                mPtNodeReader->fetchPtNodeParamsInBufferFromPtNodePos(ptNodeRange.mPtNodePos));
+        if (!mPtNodeWriter->updateChildrenPosition(&ptNodeParams, childrenPos)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool DynamicPtUpdatingHelper::setPtNodeProbability(const PtNodeParams *const originalPtNodeParams,
         const UnigramProperty *const unigramProperty, bool *const outAddedNewUnigram) {
     if (originalPtNodeParams->isTerminal() && !originalPtNodeParams->isDeleted()) {
         // Overwrites the probability.
         *outAddedNewUnigram = false;
         return mPtNodeWriter->updatePtNodeUnigramProperty(originalPtNodeParams, unigramProperty);
+    } else if (originalPtNodeParams->isTerminal()
+            && mPtNodeWriter->restorePtNodeAndUpdateUnigramProperty(originalPtNodeParams,
+                    unigramProperty)) {
+        // A deleted word is learned again where it was.
+        *outAddedNewUnigram = true;
     } else {
         // Make the node terminal and write the probability.
         *outAddedNewUnigram = true;
@@ -17,6 +17,8 @@
 #ifndef LATINIME_DYNAMIC_PT_UPDATING_HELPER_H
 #define LATINIME_DYNAMIC_PT_UPDATING_HELPER_H
 
+#include <vector>
+
 #include "defines.h"
 #include "dictionary/structure/pt_common/pt_node_params.h"
 #include "utils/int_array_view.h"
@@ -43,6 +45,13 @@ class DynamicPtUpdatingHelper {
             const CodePointArrayView wordCodePoints, const UnigramProperty *const unigramProperty,
             bool *const outAddedNewUnigram);
 
+    // Add words to a dictionary whose trie is empty. wordCodePoints has to be sorted and must not
+    // contain duplicates. Each PtNode array is written once, so the trie is as compact as the one
+    // written by GC.
+    bool addUnigramWordsToEmptyTrie(DynamicPtReadingHelper *const readingHelper,
+            const std::vector<CodePointArrayView> &wordCodePoints,
+            const std::vector<const UnigramProperty *> &unigramProperties);
+
     // TODO: Remove after stopping supporting v402.
     // Add an n-gram entry.
     bool addNgramEntry(const PtNodePosArrayView prevWordsPtNodePos, const int wordPos,
@@ -69,6 +78,11 @@ class DynamicPtUpdatingHelper {
             const CodePointArrayView ptNodeCodePoints, const UnigramProperty *const unigramProperty,
             int *const forwardLinkFieldPos);
 
+    bool writePtNodeArrayForWords(const int parentPos, const size_t matchedCodePointCount,
+            const std::vector<CodePointArrayView> &wordCodePoints,
+            const std::vector<const UnigramProperty *> &unigramProperties, const size_t begin,
+            const size_t end);
+
     bool setPtNodeProbability(const PtNodeParams *const originalPtNodeParams,
             const UnigramProperty *const unigramProperty, bool *const outAddedNewUnigram);
 
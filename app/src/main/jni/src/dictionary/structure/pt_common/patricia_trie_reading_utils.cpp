@@ -67,12 +67,12 @@ const PtReadingUtils::NodeFlags PtReadingUtils::FLAG_IS_POSSIBLY_OFFENSIVE = 0x0
 
 // Returns the number of read characters.
 /* static */ int PtReadingUtils::getCharsAndAdvancePosition(const uint8_t *const buffer,
-        const NodeFlags flags, const int maxLength, const int *const codePointTable,
-        int *const outBuffer, int *const pos) {
+        const int bufferSize, const NodeFlags flags, const int maxLength,
+        const int *const codePointTable, int *const outBuffer, int *const pos) {
     int length = 0;
     if (hasMultipleChars(flags)) {
-        length = ByteArrayUtils::readStringAndAdvancePosition(buffer, maxLength, codePointTable,
-                outBuffer, pos);
+        length = ByteArrayUtils::readStringAndAdvancePosition(buffer, bufferSize, maxLength,
+                codePointTable, outBuffer, pos);
     } else {
         const int codePoint = getCodePointAndAdvancePosition(buffer, codePointTable, pos);
         if (codePoint == NOT_A_CODE_POINT) {
@@ -92,10 +92,11 @@ const PtReadingUtils::NodeFlags PtReadingUtils::FLAG_IS_POSSIBLY_OFFENSIVE = 0x0
 }
 
 // Returns the number of skipped characters.
-/* static */ int PtReadingUtils::skipCharacters(const uint8_t *const buffer, const NodeFlags flags,
-        const int maxLength, const int *const codePointTable, int *const pos) {
+/* static */ int PtReadingUtils::skipCharacters(const uint8_t *const buffer,
+        const int bufferSize, const NodeFlags flags, const int maxLength,
+        const int *const codePointTable, int *const pos) {
     if (hasMultipleChars(flags)) {
-        return ByteArrayUtils::advancePositionToBehindString(buffer, maxLength, pos);
+        return ByteArrayUtils::advancePositionToBehindString(buffer, bufferSize, maxLength, pos);
     } else {
         if (maxLength > 0) {
             getCodePointAndAdvancePosition(buffer, codePointTable, pos);
@@ -133,7 +134,8 @@ const PtReadingUtils::NodeFlags PtReadingUtils::FLAG_IS_POSSIBLY_OFFENSIVE = 0x0
     return base + offset;
 }
 
-/* static */ void PtReadingUtils::readPtNodeInfo(const uint8_t *const dictBuf, const int ptNodePos,
+/* static */ void PtReadingUtils::readPtNodeInfo(const uint8_t *const dictBuf,
+        const int bufferSize, const int ptNodePos,
         const DictionaryShortcutsStructurePolicy *const shortcutPolicy,
         const DictionaryBigramsStructurePolicy *const bigramPolicy, const int *const codePointTable,
         NodeFlags *const outFlags, int *const outCodePointCount, int *const outCodePoint,
@@ -142,8 +144,8 @@ const PtReadingUtils::NodeFlags PtReadingUtils::FLAG_IS_POSSIBLY_OFFENSIVE = 0x0
     int readingPos = ptNodePos;
     const NodeFlags flags = getFlagsAndAdvancePosition(dictBuf, &readingPos);
     *outFlags = flags;
-    *outCodePointCount = getCharsAndAdvancePosition(
-            dictBuf, flags, MAX_WORD_LENGTH, codePointTable, outCodePoint, &readingPos);
+    *outCodePointCount = getCharsAndAdvancePosition(dictBuf, bufferSize, flags, MAX_WORD_LENGTH,
+            codePointTable, outCodePoint, &readingPos);
     *outProbability = isTerminal(flags) ?
             readProbabilityAndAdvancePosition(dictBuf, &readingPos) : NOT_A_PROBABILITY;
     *outChildrenPos = hasChildrenInFlags(flags) ?
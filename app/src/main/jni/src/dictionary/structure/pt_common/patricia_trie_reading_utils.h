@@ -37,15 +37,16 @@ class PatriciaTrieReadingUtils {
     static int getCodePointAndAdvancePosition(const uint8_t *const buffer,
             const int *const codePointTable, int *const pos);
 
-    // Returns the number of read characters.
-    static int getCharsAndAdvancePosition(const uint8_t *const buffer, const NodeFlags flags,
-            const int maxLength, const int *const codePointTable, int *const outBuffer,
+    // Returns the number of read characters. bufferSize is the size of buffer.
+    static int getCharsAndAdvancePosition(const uint8_t *const buffer, const int bufferSize,
+            const NodeFlags flags, const int maxLength, const int *const codePointTable,
+            int *const outBuffer, int *const pos);
+
+    // Returns the number of skipped characters. bufferSize is the size of buffer.
+    static int skipCharacters(const uint8_t *const buffer, const int bufferSize,
+            const NodeFlags flags, const int maxLength, const int *const codePointTable,
             int *const pos);
 
-    // Returns the number of skipped characters.
-    static int skipCharacters(const uint8_t *const buffer, const NodeFlags flags,
-            const int maxLength, const int *const codePointTable, int *const pos);
-
     static int readProbabilityAndAdvancePosition(const uint8_t *const buffer, int *const pos);
 
     static int readChildrenPositionAndAdvancePosition(const uint8_t *const buffer,
@@ -105,8 +106,8 @@ class PatriciaTrieReadingUtils {
         return nodeFlags;
     }
 
-    static void readPtNodeInfo(const uint8_t *const dictBuf, const int ptNodePos,
-            const DictionaryShortcutsStructurePolicy *const shortcutPolicy,
+    static void readPtNodeInfo(const uint8_t *const dictBuf, const int bufferSize,
+            const int ptNodePos, const DictionaryShortcutsStructurePolicy *const shortcutPolicy,
             const DictionaryBigramsStructurePolicy *const bigramPolicy,
             const int *const codePointTable, NodeFlags *const outFlags,
             int *const outCodePointCount, int *const outCodePoint, int *const outProbability,
@@ -58,6 +58,12 @@ class PtNodeWriter {
     virtual bool updatePtNodeUnigramProperty(const PtNodeParams *const toBeUpdatedPtNodeParams,
             const UnigramProperty *const unigramProperty) = 0;
 
+    // Makes a deleted terminal PtNode a word again where it is, without moving it. Returns false
+    // when the PtNode has to be moved instead.
+    virtual bool restorePtNodeAndUpdateUnigramProperty(
+            const PtNodeParams *const toBeUpdatedPtNodeParams,
+            const UnigramProperty *const unigramProperty) = 0;
+
     virtual bool updatePtNodeProbabilityAndGetNeedsToKeepPtNodeAfterGC(
             const PtNodeParams *const toBeUpdatedPtNodeParams,
             bool *const outNeedsToKeepPtNode) = 0;
@@ -16,6 +16,8 @@
 
 #include "dictionary/structure/v2/patricia_trie_policy.h"
 
+#include <algorithm>
+
 #include "defines.h"
 #include "suggest/core/dicnode/dic_node.h"
 #include "suggest/core/dicnode/dic_node_vector.h"
@@ -27,6 +29,7 @@
 #include "dictionary/utils/multi_bigram_map.h"
 #include "dictionary/utils/probability_utils.h"
 #include "utils/char_utils.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 
@@ -43,6 +46,24 @@ void PatriciaTriePolicy::createAndGetAllChildDicNodes(const DicNode *const dicNo
         ASSERT(false);
         return;
     }
+    if (hasChildEdgeIndex()) {
+        int childEdgeCount = 0;
+        const Ver2ChildEdgeIndex::ChildEdge *const childEdges =
+                mChildEdgeIndex.getChildEdges(nextPos, &childEdgeCount);
+        if (childEdges) {
+            int mergedNodeCodePoints[MAX_WORD_LENGTH];
+            for (int i = 0; i < childEdgeCount; ++i) {
+                const Ver2ChildEdgeIndex::ChildEdge *const childEdge = &childEdges[i];
+                const int mergedNodeCodePointCount =
+                        mChildEdgeIndex.getCodePoints(childEdge, mergedNodeCodePoints);
+                childDicNodes->pushLeavingChild(dicNode, childEdge->mChildrenPos,
+                        childEdge->mWordId,
+                        CodePointArrayView(mergedNodeCodePoints, mergedNodeCodePointCount),
+                        mChildEdgeIndex.getMaxTerminalProbability(childEdge));
+            }
+            return;
+        }
+    }
     const int childCount = PatriciaTrieReadingUtils::getPtNodeArraySizeAndAdvancePosition(
             mBuffer.data(), &nextPos);
     for (int i = 0; i < childCount; i++) {
@@ -145,8 +166,8 @@ int PatriciaTriePolicy::getCodePointsAndProbabilityAndReturnCodePointCount(
             // We need to skip past this PtNode, so skip any remaining code points after the
             // first and possibly the probability.
             if (PatriciaTrieReadingUtils::hasMultipleChars(flags)) {
-                PatriciaTrieReadingUtils::skipCharacters(mBuffer.data(), flags, MAX_WORD_LENGTH,
-                        codePointTable, &pos);
+                PatriciaTrieReadingUtils::skipCharacters(mBuffer.data(), mBuffer.size(), flags,
+                        MAX_WORD_LENGTH, codePointTable, &pos);
             }
             if (PatriciaTrieReadingUtils::isTerminal(flags)) {
                 PatriciaTrieReadingUtils::readProbabilityAndAdvancePosition(mBuffer.data(), &pos);
@@ -279,6 +300,20 @@ int PatriciaTriePolicy::getCodePointsAndProbabilityAndReturnCodePointCount(
 // dictionary. If no match is found, it returns NOT_A_WORD_ID.
 int PatriciaTriePolicy::getWordId(const CodePointArrayView wordCodePoints,
         const bool forceLowerCaseSearch) const {
+    if (wordCodePoints.size() <= MAX_WORD_LENGTH && hasChildEdgeIndex()) {
+        int lowerCaseCodePoints[MAX_WORD_LENGTH];
+        if (forceLowerCaseSearch) {
+            for (size_t i = 0; i < wordCodePoints.size(); ++i) {
+                lowerCaseCodePoints[i] = CharUtils::toLowerCase(wordCodePoints[i]);
+            }
+        }
+        const CodePointArrayView searchCodePoints = forceLowerCaseSearch
+                ? CodePointArrayView(lowerCaseCodePoints, wordCodePoints.size()) : wordCodePoints;
+        int wordId = NOT_A_WORD_ID;
+        if (mChildEdgeIndex.getWordId(searchCodePoints, &wordId)) {
+            return wordId;
+        }
+    }
     DynamicPtReadingHelper readingHelper(&mPtNodeReader, &mPtNodeArrayReader);
     readingHelper.initWithPtNodeArrayPos(getRootPosition());
     const int ptNodePos = readingHelper.getTerminalPtNodePositionOfWord(wordCodePoints.data(),
@@ -290,6 +325,24 @@ int PatriciaTriePolicy::getWordId(const CodePointArrayView wordCodePoints,
     return getWordIdFromTerminalPtNodePos(ptNodePos);
 }
 
+bool PatriciaTriePolicy::getMaxProbabilityOfExactMatches(const CodePointArrayView codePoints,
+        int *const outProbability) const {
+    const int *wordIds = nullptr;
+    int wordIdCount = 0;
+    if (!hasFoldedWordIndex()
+            || !mFoldedWordIndex.getWordIds(codePoints, &wordIds, &wordIdCount)) {
+        return false;
+    }
+    *outProbability = NOT_A_PROBABILITY;
+    for (int i = 0; i < wordIdCount; ++i) {
+        // Same as DictionaryUtils::getMaxProbabilityOfExactMatches().
+        const WordAttributes wordAttributes = getWordAttributesInContext(WordIdArrayView(),
+                wordIds[i], nullptr /* multiBigramMap */);
+        *outProbability = std::max(*outProbability, wordAttributes.getProbability());
+    }
+    return true;
+}
+
 const WordAttributes PatriciaTriePolicy::getWordAttributesInContext(
         const WordIdArrayView prevWordIds, const int wordId,
         MultiBigramMap *const multiBigramMap) const {
@@ -373,9 +426,10 @@ void PatriciaTriePolicy::iterateNgramEntries(const WordIdArrayView prevWordIds,
     const int bigramsPosition = getBigramsPositionOfPtNode(
             getTerminalPtNodePosFromWordId(prevWordIds[0]));
     BinaryDictionaryBigramsIterator bigramsIt(&mBigramListPolicy, bigramsPosition);
+    NgramListener::Batch batch(listener);
     while (bigramsIt.hasNext()) {
         bigramsIt.next();
-        listener->onVisitEntry(bigramsIt.getProbability(),
+        batch.add(bigramsIt.getProbability(),
                 getWordIdFromTerminalPtNodePos(bigramsIt.getBigramPos()));
     }
 }
@@ -389,6 +443,14 @@ int PatriciaTriePolicy::getShortcutPositionOfPtNode(const int ptNodePos) const {
     if (ptNodePos == NOT_A_DICT_POS) {
         return NOT_A_DICT_POS;
     }
+    // Most of the words don't have shortcuts, which the flags tell without reading the PtNode.
+    if (isValidPos(ptNodePos)) {
+        int flagsPos = ptNodePos;
+        if (!PatriciaTrieReadingUtils::hasShortcutTargets(
+                PatriciaTrieReadingUtils::getFlagsAndAdvancePosition(mBuffer.data(), &flagsPos))) {
+            return NOT_A_DICT_POS;
+        }
+    }
     return mPtNodeReader.fetchPtNodeParamsInBufferFromPtNodePos(ptNodePos).getShortcutPos();
 }
 
@@ -410,10 +472,10 @@ int PatriciaTriePolicy::createAndGetLeavingChildNode(const DicNode *const dicNod
     int bigramPos = NOT_A_DICT_POS;
     int siblingPos = NOT_A_DICT_POS;
     const int *const codePointTable = mHeaderPolicy.getCodePointTable();
-    PatriciaTrieReadingUtils::readPtNodeInfo(mBuffer.data(), ptNodePos, &mShortcutListPolicy,
-            &mBigramListPolicy, codePointTable, &flags, &mergedNodeCodePointCount,
-            mergedNodeCodePoints, &probability, &childrenPos, &shortcutPos, &bigramPos,
-            &siblingPos);
+    PatriciaTrieReadingUtils::readPtNodeInfo(mBuffer.data(), mBuffer.size(), ptNodePos,
+            &mShortcutListPolicy, &mBigramListPolicy, codePointTable, &flags,
+            &mergedNodeCodePointCount, mergedNodeCodePoints, &probability, &childrenPos,
+            &shortcutPos, &bigramPos, &siblingPos);
     // Skip PtNodes don't start with Unicode code point because they represent non-word information.
     if (CharUtils::isInUnicodeSpace(mergedNodeCodePoints[0])) {
         const int wordId = PatriciaTrieReadingUtils::isTerminal(flags) ? ptNodePos : NOT_A_WORD_ID;
@@ -482,8 +544,11 @@ const WordProperty PatriciaTriePolicy::getWordProperty(
 }
 
 int PatriciaTriePolicy::getNextWordAndNextToken(const int token, int *const outCodePoints,
-        int *const outCodePointCount) {
+        int *const outCodePointCount, int *const outWordId) {
     *outCodePointCount = 0;
+    if (outWordId) {
+        *outWordId = NOT_A_WORD_ID;
+    }
     if (token == 0) {
         // Start iterating the dictionary.
         mTerminalPtNodePositionsForIteratingWords.clear();
@@ -500,8 +565,12 @@ int PatriciaTriePolicy::getNextWordAndNextToken(const int token, int *const outC
         return 0;
     }
     const int terminalPtNodePos = mTerminalPtNodePositionsForIteratingWords[token];
-    *outCodePointCount = getCodePointsAndReturnCodePointCount(
-            getWordIdFromTerminalPtNodePos(terminalPtNodePos), MAX_WORD_LENGTH, outCodePoints);
+    const int wordId = getWordIdFromTerminalPtNodePos(terminalPtNodePos);
+    *outCodePointCount = getCodePointsAndReturnCodePointCount(wordId, MAX_WORD_LENGTH,
+            outCodePoints);
+    if (outWordId) {
+        *outWordId = wordId;
+    }
     const int nextToken = token + 1;
     if (nextToken >= terminalPtNodePositionsVectorSize) {
         // All words have been iterated.
@@ -519,8 +588,38 @@ int PatriciaTriePolicy::getTerminalPtNodePosFromWordId(const int wordId) const {
     return wordId == NOT_A_WORD_ID ? NOT_A_DICT_POS : wordId;
 }
 
+bool PatriciaTriePolicy::hasChildEdgeIndex() const {
+    std::call_once(mChildEdgeIndexBuildFlag, [this]() {
+        mHasChildEdgeIndex = mChildEdgeIndex.build();
+    });
+    return mHasChildEdgeIndex;
+}
+
+bool PatriciaTriePolicy::hasFoldedWordIndex() const {
+    std::call_once(mFoldedWordIndexBuildFlag, [this]() {
+        if (hasChildEdgeIndex()) {
+            mFoldedWordIndex.build(&mChildEdgeIndex);
+            mHasFoldedWordIndex = true;
+        }
+    });
+    return mHasFoldedWordIndex;
+}
+
 bool PatriciaTriePolicy::isValidPos(const int pos) const {
     return pos >= 0 && pos < static_cast<int>(mBuffer.size());
 }
 
+void PatriciaTriePolicy::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    outMemoryUsage->add(MemoryUsage::MAPPED_FILE_BYTES,
+            static_cast<int64_t>(mMmappedBuffer->getReadOnlyByteArrayView().size()));
+    outMemoryUsage->add(MemoryUsage::HEAP_BYTES, static_cast<int64_t>(sizeof(*this)));
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mTerminalPtNodePositionsForIteratingWords);
+    if (mHasChildEdgeIndex) {
+        mChildEdgeIndex.addMemoryUsage(outMemoryUsage);
+    }
+    if (mHasFoldedWordIndex) {
+        mFoldedWordIndex.addMemoryUsage(outMemoryUsage);
+    }
+}
+
 } // namespace latinime
@@ -17,7 +17,9 @@
 #ifndef LATINIME_PATRICIA_TRIE_POLICY_H
 #define LATINIME_PATRICIA_TRIE_POLICY_H
 
+#include <atomic>
 #include <cstdint>
+#include <mutex>
 #include <vector>
 
 #include "defines.h"
@@ -25,6 +27,8 @@
 #include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
 #include "dictionary/structure/v2/bigram/bigram_list_policy.h"
 #include "dictionary/structure/v2/shortcut/shortcut_list_policy.h"
+#include "dictionary/structure/v2/ver2_child_edge_index.h"
+#include "dictionary/structure/v2/ver2_folded_word_index.h"
 #include "dictionary/structure/v2/ver2_patricia_trie_node_reader.h"
 #include "dictionary/structure/v2/ver2_pt_node_array_reader.h"
 #include "dictionary/utils/format_utils.h"
@@ -50,7 +54,11 @@ class PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
               mPtNodeReader(mBuffer, &mBigramListPolicy, &mShortcutListPolicy,
                       mHeaderPolicy.getCodePointTable()),
               mPtNodeArrayReader(mBuffer), mTerminalPtNodePositionsForIteratingWords(),
-              mIsCorrupted(false) {}
+              mIsCorrupted(false), mChildEdgeIndexBuildFlag(),
+              mChildEdgeIndex(mBuffer, &mBigramListPolicy, &mShortcutListPolicy,
+                      mHeaderPolicy.getCodePointTable()),
+              mHasChildEdgeIndex(false), mFoldedWordIndexBuildFlag(), mFoldedWordIndex(),
+              mHasFoldedWordIndex(false) {}
 
     AK_FORCE_INLINE int getRootPosition() const {
         return 0;
@@ -59,6 +67,12 @@ class PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     void createAndGetAllChildDicNodes(const DicNode *const dicNode,
             DicNodeVector *const childDicNodes) const;
 
+    void prefetchPtNodeArray(const int ptNodeArrayPos) const {
+        if (ptNodeArrayPos >= 0 && ptNodeArrayPos < static_cast<int>(mBuffer.size())) {
+            __builtin_prefetch(mBuffer.data() + ptNodeArrayPos);
+        }
+    }
+
     int getCodePointsAndReturnCodePointCount(const int wordId, const int maxCodePointCount,
             int *const outCodePoints) const;
 
@@ -67,6 +81,9 @@ class PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     const WordAttributes getWordAttributesInContext(const WordIdArrayView prevWordIds,
             const int wordId, MultiBigramMap *const multiBigramMap) const;
 
+    bool getMaxProbabilityOfExactMatches(const CodePointArrayView codePoints,
+            int *const outProbability) const;
+
     int getProbability(const int unigramProbability, const int bigramProbability) const;
 
     int getProbabilityOfWord(const WordIdArrayView prevWordIds, const int wordId) const;
@@ -87,6 +104,13 @@ class PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
         return false;
     }
 
+    bool addUnigramEntries(const std::vector<CodePointArrayView> &wordCodePoints,
+            const std::vector<UnigramProperty> &unigramProperties) {
+        // This method should not be called for non-updatable dictionary.
+        AKLOGI("Warning: addUnigramEntries() is called for non-updatable dictionary.");
+        return false;
+    }
+
     bool removeUnigramEntry(const CodePointArrayView wordCodePoints) {
         // This method should not be called for non-updatable dictionary.
         AKLOGI("Warning: removeUnigramEntry() is called for non-updatable dictionary.");
@@ -144,12 +168,18 @@ class PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     const WordProperty getWordProperty(const CodePointArrayView wordCodePoints) const;
 
     int getNextWordAndNextToken(const int token, int *const outCodePoints,
-            int *const outCodePointCount);
+            int *const outCodePointCount, int *const outWordId);
 
     bool isCorrupted() const {
         return mIsCorrupted;
     }
 
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+
+    void releaseCleanPages() const {
+        mMmappedBuffer->releaseCleanPages();
+    }
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(PatriciaTriePolicy);
 
@@ -161,7 +191,17 @@ class PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     const Ver2ParticiaTrieNodeReader mPtNodeReader;
     const Ver2PtNodeArrayReader mPtNodeArrayReader;
     std::vector<int> mTerminalPtNodePositionsForIteratingWords;
-    mutable bool mIsCorrupted;
+    // Set from the reading methods, which can run concurrently.
+    mutable std::atomic<bool> mIsCorrupted;
+    // The child edge index is built on the first expansion or word lookup since the policy is
+    // also opened just to read the header.
+    mutable std::once_flag mChildEdgeIndexBuildFlag;
+    mutable Ver2ChildEdgeIndex mChildEdgeIndex;
+    mutable bool mHasChildEdgeIndex;
+    // Built on the first query, from the child edge index.
+    mutable std::once_flag mFoldedWordIndexBuildFlag;
+    mutable Ver2FoldedWordIndex mFoldedWordIndex;
+    mutable bool mHasFoldedWordIndex;
 
     int getCodePointsAndProbabilityAndReturnCodePointCount(const int wordId,
             const int maxCodePointCount, int *const outCodePoints,
@@ -174,6 +214,10 @@ class PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     int getTerminalPtNodePosFromWordId(const int wordId) const;
     const WordAttributes getWordAttributes(const int probability,
             const PtNodeParams &ptNodeParams) const;
+    // Builds the child edge index on the first call.
+    bool hasChildEdgeIndex() const;
+    // Builds the folded word index on the first call.
+    bool hasFoldedWordIndex() const;
     bool isValidPos(const int pos) const;
 };
 } // namespace latinime
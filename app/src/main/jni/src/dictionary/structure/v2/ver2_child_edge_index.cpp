@@ -0,0 +1,383 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "dictionary/structure/v2/ver2_child_edge_index.h"
+
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+
+#include "dictionary/structure/pt_common/patricia_trie_reading_utils.h"
+#include "utils/char_utils.h"
+
+namespace latinime {
+
+// Main dictionaries are a few MB. Larger dictionaries are expanded without the index to bound
+// the memory usage.
+const int Ver2ChildEdgeIndex::MAX_INDEXED_DICT_SIZE = 16 * 1024 * 1024;
+// Enough for MAX_WORD_LENGTH.
+const int Ver2ChildEdgeIndex::CODE_POINT_COUNT_BIT_COUNT = 6;
+const int Ver2ChildEdgeIndex::CODE_BIT_COUNT = 8;
+const int Ver2ChildEdgeIndex::MAX_INLINE_CODE_COUNT = 3;
+// Main dictionaries have fewer than 150 distinct code points.
+const int Ver2ChildEdgeIndex::MAX_ALPHABET_SIZE = 1 << CODE_BIT_COUNT;
+const int Ver2ChildEdgeIndex::MAX_CODE_COUNT = 1 << (32 - CODE_POINT_COUNT_BIT_COUNT);
+const int Ver2ChildEdgeIndex::MAX_BMP_CODE_POINT = 0xFFFF;
+// A cache line of bits per rank.
+const int Ver2ChildEdgeIndex::POS_BIT_WORD_COUNT_PER_RANK = 8;
+
+bool Ver2ChildEdgeIndex::build() {
+    clear();
+    if (mBuffer.size() == 0 || mBuffer.size() > static_cast<size_t>(MAX_INDEXED_DICT_SIZE)) {
+        return false;
+    }
+    std::vector<bool> isQueued(mBuffer.size(), false);
+    std::queue<int> ptNodeArrayPositions;
+    ptNodeArrayPositions.push(0 /* rootPos */);
+    isQueued[0] = true;
+    // The PtNode arrays are indexed in the breadth-first order and sorted afterwards.
+    struct PtNodeArray {
+        int mPos;
+        int mFirstChildEdgeIndex;
+        int mChildEdgeCount;
+    };
+    std::vector<PtNodeArray> ptNodeArrays;
+    std::vector<ChildEdge> childEdges;
+    // Parallel to childEdges, the unigram probabilities of the terminals and 0 for the others.
+    std::vector<uint8_t> terminalProbabilities;
+    // Code point -> code, directly for the BMP.
+    std::vector<int16_t> bmpCodes(MAX_BMP_CODE_POINT + 1, -1);
+    std::unordered_map<int, int> supplementaryCodes;
+    int mergedNodeCodePoints[MAX_WORD_LENGTH];
+    int wordCount = 0;
+    while (!ptNodeArrayPositions.empty()) {
+        const int ptNodeArrayPos = ptNodeArrayPositions.front();
+        ptNodeArrayPositions.pop();
+        int pos = ptNodeArrayPos;
+        const int childCount = PatriciaTrieReadingUtils::getPtNodeArraySizeAndAdvancePosition(
+                mBuffer.data(), &pos);
+        ptNodeArrays.push_back({ptNodeArrayPos, static_cast<int>(childEdges.size()), 0});
+        for (int i = 0; i < childCount; ++i) {
+            if (!isValidPos(pos)) {
+                AKLOGE("Child PtNode position is invalid while building the index. pos: %d", pos);
+                clear();
+                return false;
+            }
+            const int ptNodePos = pos;
+            PatriciaTrieReadingUtils::NodeFlags flags;
+            int mergedNodeCodePointCount = 0;
+            int probability = NOT_A_PROBABILITY;
+            int childrenPos = NOT_A_DICT_POS;
+            int shortcutPos = NOT_A_DICT_POS;
+            int bigramPos = NOT_A_DICT_POS;
+            PatriciaTrieReadingUtils::readPtNodeInfo(mBuffer.data(), mBuffer.size(), ptNodePos,
+                    mShortcutPolicy, mBigramPolicy, mCodePointTable, &flags,
+                    &mergedNodeCodePointCount, mergedNodeCodePoints, &probability, &childrenPos,
+                    &shortcutPos, &bigramPos, &pos);
+            if (childrenPos != NOT_A_DICT_POS) {
+                if (!isValidPos(childrenPos)) {
+                    AKLOGE("Children position is invalid while building the index. pos: %d",
+                            childrenPos);
+                    clear();
+                    return false;
+                }
+                if (!isQueued[childrenPos]) {
+                    isQueued[childrenPos] = true;
+                    ptNodeArrayPositions.push(childrenPos);
+                }
+            }
+            // Same as PatriciaTriePolicy::createAndGetLeavingChildNode().
+            if (!CharUtils::isInUnicodeSpace(mergedNodeCodePoints[0])) {
+                continue;
+            }
+            const bool isInline = mergedNodeCodePointCount <= MAX_INLINE_CODE_COUNT;
+            if (!isInline && static_cast<int>(mCodes.size()) + mergedNodeCodePointCount
+                    > MAX_CODE_COUNT) {
+                clear();
+                return false;
+            }
+            uint32_t encodedCodePoints = isInline ? 0 : static_cast<uint32_t>(mCodes.size());
+            for (int j = 0; j < mergedNodeCodePointCount; ++j) {
+                const int codePoint = mergedNodeCodePoints[j];
+                const bool isInBmp = codePoint >= 0 && codePoint <= MAX_BMP_CODE_POINT;
+                int code = isInBmp ? bmpCodes[codePoint]
+                        : supplementaryCodes.emplace(codePoint, -1).first->second;
+                if (code < 0) {
+                    code = static_cast<int>(mAlphabet.size());
+                    if (code >= MAX_ALPHABET_SIZE) {
+                        clear();
+                        return false;
+                    }
+                    mAlphabet.push_back(codePoint);
+                    if (isInBmp) {
+                        bmpCodes[codePoint] = static_cast<int16_t>(code);
+                    } else {
+                        supplementaryCodes[codePoint] = code;
+                    }
+                }
+                if (isInline) {
+                    encodedCodePoints |= static_cast<uint32_t>(code) << (j * CODE_BIT_COUNT);
+                } else {
+                    mCodes.push_back(static_cast<uint8_t>(code));
+                }
+            }
+            const int wordId = PatriciaTrieReadingUtils::isTerminal(flags) ? ptNodePos
+                    : NOT_A_WORD_ID;
+            if (wordId != NOT_A_WORD_ID) {
+                ++wordCount;
+            }
+            terminalProbabilities.push_back(static_cast<uint8_t>(
+                    wordId != NOT_A_WORD_ID ? std::max(probability, 0) : 0));
+            childEdges.push_back({childrenPos, wordId,
+                    (encodedCodePoints << CODE_POINT_COUNT_BIT_COUNT)
+                            | static_cast<uint32_t>(mergedNodeCodePointCount)});
+            ++ptNodeArrays.back().mChildEdgeCount;
+        }
+    }
+    std::sort(ptNodeArrays.begin(), ptNodeArrays.end(),
+            [](const PtNodeArray &left, const PtNodeArray &right) {
+                return left.mPos < right.mPos;
+            });
+    // The child edges are laid out in the order of the sorted PtNode arrays, so that the edges of
+    // an array end where the edges of the next one start.
+    const int posBitWordCount = static_cast<int>(mBuffer.size()) / 64 + 1;
+    mPtNodeArrayPosBits.resize(posBitWordCount, 0);
+    mPtNodeArrayPosRanks.resize(posBitWordCount / POS_BIT_WORD_COUNT_PER_RANK + 1, 0);
+    mFirstChildEdgeIndices.reserve(ptNodeArrays.size() + 1);
+    mChildEdges.reserve(childEdges.size());
+    mMaxTerminalProbabilities.reserve(childEdges.size());
+    for (int i = 0; i < static_cast<int>(ptNodeArrays.size()); ++i) {
+        const PtNodeArray &ptNodeArray = ptNodeArrays[i];
+        mPtNodeArrayPosBits[ptNodeArray.mPos / 64] |= 1ull << (ptNodeArray.mPos % 64);
+        mFirstChildEdgeIndices.push_back(static_cast<int>(mChildEdges.size()));
+        mChildEdges.insert(mChildEdges.end(),
+                childEdges.begin() + ptNodeArray.mFirstChildEdgeIndex,
+                childEdges.begin() + ptNodeArray.mFirstChildEdgeIndex
+                        + ptNodeArray.mChildEdgeCount);
+        mMaxTerminalProbabilities.insert(mMaxTerminalProbabilities.end(),
+                terminalProbabilities.begin() + ptNodeArray.mFirstChildEdgeIndex,
+                terminalProbabilities.begin() + ptNodeArray.mFirstChildEdgeIndex
+                        + ptNodeArray.mChildEdgeCount);
+    }
+    mFirstChildEdgeIndices.push_back(static_cast<int>(mChildEdges.size()));
+    int rank = 0;
+    for (int i = 0; i < posBitWordCount; ++i) {
+        if (i % POS_BIT_WORD_COUNT_PER_RANK == 0) {
+            mPtNodeArrayPosRanks[i / POS_BIT_WORD_COUNT_PER_RANK] = rank;
+        }
+        rank += __builtin_popcountll(mPtNodeArrayPosBits[i]);
+    }
+    mCodes.shrink_to_fit();
+    mAlphabet.shrink_to_fit();
+    mSortedAlphabet.reserve(mAlphabet.size());
+    for (int code = 0; code < static_cast<int>(mAlphabet.size()); ++code) {
+        mSortedAlphabet.push_back((mAlphabet[code] << CODE_BIT_COUNT) | code);
+    }
+    std::sort(mSortedAlphabet.begin(), mSortedAlphabet.end());
+    updateMaxTerminalProbabilities(0 /* rootPos */, 0 /* codePointCount */);
+    mWordFilter.reset(static_cast<size_t>(wordCount));
+    addWordsToFilter(0 /* rootPos */, 2166136261u /* FNV offset basis */, 0 /* codePointCount */);
+    return true;
+}
+
+const Ver2ChildEdgeIndex::ChildEdge *Ver2ChildEdgeIndex::getChildEdges(const int ptNodeArrayPos,
+        int *const outChildEdgeCount) const {
+    const int ptNodeArrayIndex = getPtNodeArrayIndex(ptNodeArrayPos);
+    if (ptNodeArrayIndex == NOT_AN_INDEX) {
+        return nullptr;
+    }
+    const int firstChildEdgeIndex = mFirstChildEdgeIndices[ptNodeArrayIndex];
+    *outChildEdgeCount = mFirstChildEdgeIndices[ptNodeArrayIndex + 1] - firstChildEdgeIndex;
+    return mChildEdges.data() + firstChildEdgeIndex;
+}
+
+int Ver2ChildEdgeIndex::getCodePoints(const ChildEdge *const childEdge,
+        int *const outCodePoints) const {
+    const int codePointCount = getCodePointCount(childEdge);
+    for (int i = 0; i < codePointCount; ++i) {
+        outCodePoints[i] = mAlphabet[getCodeAt(childEdge, i)];
+    }
+    return codePointCount;
+}
+
+bool Ver2ChildEdgeIndex::getWordId(const CodePointArrayView codePoints,
+        int *const outWordId) const {
+    *outWordId = NOT_A_WORD_ID;
+    if (codePoints.empty() || codePoints.size() > MAX_WORD_LENGTH) {
+        return true;
+    }
+    uint32_t hash = 2166136261u /* FNV offset basis */;
+    for (const int codePoint : codePoints) {
+        if (!CharUtils::isInUnicodeSpace(codePoint)) {
+            // The index doesn't have the PtNodes that don't start with a Unicode code point.
+            return false;
+        }
+        hash = getNextHash(hash, codePoint);
+    }
+    if (!mWordFilter.isInFilter(static_cast<int>(hash))) {
+        return true;
+    }
+    int codes[MAX_WORD_LENGTH];
+    for (size_t i = 0; i < codePoints.size(); ++i) {
+        codes[i] = getCode(codePoints[i]);
+        if (codes[i] == NOT_AN_INDEX) {
+            return true;
+        }
+    }
+    const int codeCount = static_cast<int>(codePoints.size());
+    int ptNodeArrayPos = 0 /* rootPos */;
+    int matchedCodeCount = 0;
+    while (true) {
+        int childEdgeCount = 0;
+        const ChildEdge *const childEdges = getChildEdges(ptNodeArrayPos, &childEdgeCount);
+        if (!childEdges) {
+            return true;
+        }
+        // Sibling PtNodes start with different code points.
+        const ChildEdge *childEdge = nullptr;
+        for (int i = 0; i < childEdgeCount; ++i) {
+            if (getCodeAt(&childEdges[i], 0) == codes[matchedCodeCount]) {
+                childEdge = &childEdges[i];
+                break;
+            }
+        }
+        if (!childEdge) {
+            return true;
+        }
+        const int codePointCount = getCodePointCount(childEdge);
+        if (matchedCodeCount + codePointCount > codeCount) {
+            return true;
+        }
+        for (int i = 1; i < codePointCount; ++i) {
+            if (getCodeAt(childEdge, i) != codes[matchedCodeCount + i]) {
+                return true;
+            }
+        }
+        matchedCodeCount += codePointCount;
+        if (matchedCodeCount == codeCount) {
+            *outWordId = childEdge->mWordId;
+            return true;
+        }
+        if (childEdge->mChildrenPos == NOT_A_DICT_POS) {
+            return true;
+        }
+        ptNodeArrayPos = childEdge->mChildrenPos;
+    }
+}
+
+int Ver2ChildEdgeIndex::getPtNodeArrayIndex(const int ptNodeArrayPos) const {
+    const int posBitWordIndex = ptNodeArrayPos / 64;
+    if (ptNodeArrayPos < 0 || posBitWordIndex >= static_cast<int>(mPtNodeArrayPosBits.size())) {
+        return NOT_AN_INDEX;
+    }
+    const uint64_t posBit = 1ull << (ptNodeArrayPos % 64);
+    if ((mPtNodeArrayPosBits[posBitWordIndex] & posBit) == 0) {
+        return NOT_AN_INDEX;
+    }
+    int rank = mPtNodeArrayPosRanks[posBitWordIndex / POS_BIT_WORD_COUNT_PER_RANK];
+    for (int i = posBitWordIndex - posBitWordIndex % POS_BIT_WORD_COUNT_PER_RANK;
+            i < posBitWordIndex; ++i) {
+        rank += __builtin_popcountll(mPtNodeArrayPosBits[i]);
+    }
+    return rank + __builtin_popcountll(mPtNodeArrayPosBits[posBitWordIndex] & (posBit - 1));
+}
+
+int Ver2ChildEdgeIndex::getCode(const int codePoint) const {
+    const auto it = std::lower_bound(mSortedAlphabet.begin(), mSortedAlphabet.end(),
+            codePoint << CODE_BIT_COUNT);
+    if (it == mSortedAlphabet.end() || (*it >> CODE_BIT_COUNT) != codePoint) {
+        return NOT_AN_INDEX;
+    }
+    return *it & ((1 << CODE_BIT_COUNT) - 1);
+}
+
+int Ver2ChildEdgeIndex::getCodeAt(const ChildEdge *const childEdge, const int index) const {
+    const uint32_t encodedCodePoints = childEdge->mCodePoints >> CODE_POINT_COUNT_BIT_COUNT;
+    if (getCodePointCount(childEdge) <= MAX_INLINE_CODE_COUNT) {
+        return static_cast<int>((encodedCodePoints >> (index * CODE_BIT_COUNT))
+                & ((1u << CODE_BIT_COUNT) - 1));
+    }
+    return mCodes[encodedCodePoints + index];
+}
+
+int Ver2ChildEdgeIndex::updateMaxTerminalProbabilities(const int ptNodeArrayPos,
+        const int codePointCount) {
+    int childEdgeCount = 0;
+    const ChildEdge *const childEdges = getChildEdges(ptNodeArrayPos, &childEdgeCount);
+    if (!childEdges) {
+        return 0;
+    }
+    int maxProbability = 0;
+    for (int i = 0; i < childEdgeCount; ++i) {
+        const ChildEdge *const childEdge = &childEdges[i];
+        uint8_t *const maxTerminalProbability =
+                &mMaxTerminalProbabilities[childEdge - mChildEdges.data()];
+        if (childEdge->mChildrenPos != NOT_A_DICT_POS) {
+            const int childCodePointCount = codePointCount + getCodePointCount(childEdge);
+            // Deeper PtNodes are never reached by a search, which also bounds the recursion. They
+            // get no bound.
+            const int childMaxProbability = childCodePointCount > MAX_WORD_LENGTH
+                    ? MAX_PROBABILITY
+                    : updateMaxTerminalProbabilities(childEdge->mChildrenPos, childCodePointCount);
+            *maxTerminalProbability = static_cast<uint8_t>(
+                    std::max(static_cast<int>(*maxTerminalProbability), childMaxProbability));
+        }
+        maxProbability = std::max(maxProbability, static_cast<int>(*maxTerminalProbability));
+    }
+    return maxProbability;
+}
+
+void Ver2ChildEdgeIndex::addWordsToFilter(const int ptNodeArrayPos, const uint32_t hash,
+        const int codePointCount) {
+    int childEdgeCount = 0;
+    const ChildEdge *const childEdges = getChildEdges(ptNodeArrayPos, &childEdgeCount);
+    if (!childEdges) {
+        return;
+    }
+    for (int i = 0; i < childEdgeCount; ++i) {
+        const ChildEdge *const childEdge = &childEdges[i];
+        const int childCodePointCount = codePointCount + getCodePointCount(childEdge);
+        if (childCodePointCount > MAX_WORD_LENGTH) {
+            // Longer words are never looked up, which also bounds the recursion.
+            continue;
+        }
+        uint32_t childHash = hash;
+        for (int j = 0; j < getCodePointCount(childEdge); ++j) {
+            childHash = getNextHash(childHash, mAlphabet[getCodeAt(childEdge, j)]);
+        }
+        if (childEdge->mWordId != NOT_A_WORD_ID) {
+            mWordFilter.setInFilter(static_cast<int>(childHash));
+        }
+        if (childEdge->mChildrenPos != NOT_A_DICT_POS) {
+            addWordsToFilter(childEdge->mChildrenPos, childHash, childCodePointCount);
+        }
+    }
+}
+
+void Ver2ChildEdgeIndex::clear() {
+    mPtNodeArrayPosBits.clear();
+    mPtNodeArrayPosRanks.clear();
+    mFirstChildEdgeIndices.clear();
+    mChildEdges.clear();
+    mMaxTerminalProbabilities.clear();
+    mCodes.clear();
+    mAlphabet.clear();
+    mSortedAlphabet.clear();
+    mWordFilter.reset(0);
+}
+
+} // namespace latinime
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef LATINIME_VER2_CHILD_EDGE_INDEX_H
+#define LATINIME_VER2_CHILD_EDGE_INDEX_H
+
+#include <cstdint>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/utils/bloom_filter.h"
+#include "utils/byte_array_view.h"
+#include "utils/int_array_view.h"
+#include "utils/memory_usage.h"
+
+namespace latinime {
+
+class DictionaryBigramsStructurePolicy;
+class DictionaryShortcutsStructurePolicy;
+
+// A flat index of the child PtNodes of every PtNode array in a read-only ver2 dictionary. Each
+// child is a fixed-width record, so expanding a DicNode becomes a sequential scan instead of
+// decoding the variable-length PtNode headers.
+//
+// The code points are stored as 1-byte codes of the alphabet of the dictionary, inside the record
+// when the PtNode has up to MAX_INLINE_CODE_COUNT code points, which most PtNodes have. That keeps
+// the index at about the size of the dictionary file. The PtNode array at a position is found by
+// ranking the position in a bitmap of the array positions, so a lookup costs a couple of cache
+// misses per code point.
+//
+// A bloom filter of the hashes of all the words makes most lookups of words that are not in the
+// dictionary, which the spell checker does for every misspelling, return without walking the
+// index.
+//
+// The largest unigram probability of the words at and below every child edge bounds the language
+// cost of the words a DicNode of the edge can still reach. The ver2 format has no room for it, so
+// it is computed here instead of by the dictionary generator.
+class Ver2ChildEdgeIndex {
+ public:
+    struct ChildEdge {
+        int mChildrenPos;
+        int mWordId;
+        // The code point count in the low CODE_POINT_COUNT_BIT_COUNT bits, and above them the
+        // codes of the code points, or the index of the first code in mCodes.
+        uint32_t mCodePoints;
+    };
+
+    Ver2ChildEdgeIndex(const ReadOnlyByteArrayView buffer,
+            const DictionaryBigramsStructurePolicy *const bigramPolicy,
+            const DictionaryShortcutsStructurePolicy *const shortcutPolicy,
+            const int *const codePointTable)
+            : mBuffer(buffer), mBigramPolicy(bigramPolicy), mShortcutPolicy(shortcutPolicy),
+              mCodePointTable(codePointTable), mPtNodeArrayPosBits(), mPtNodeArrayPosRanks(),
+              mFirstChildEdgeIndices(), mChildEdges(), mMaxTerminalProbabilities(), mCodes(),
+              mAlphabet(), mSortedAlphabet(), mWordFilter() {}
+
+    // Builds the index from the root PtNode array. Returns false and keeps the index empty when
+    // the dictionary is too large to be indexed, has too many distinct code points or is broken.
+    bool build();
+
+    // Returns the child edges of the PtNode array at the position, or nullptr if the array has
+    // not been indexed. PtNodes that don't start with a Unicode code point are not included.
+    const ChildEdge *getChildEdges(const int ptNodeArrayPos, int *const outChildEdgeCount) const;
+
+    // Writes the code points of the child edge to outCodePoints, which must have room for
+    // MAX_WORD_LENGTH code points, and returns the code point count.
+    int getCodePoints(const ChildEdge *const childEdge, int *const outCodePoints) const;
+
+    // Returns the largest unigram probability of the terminals at and below the child edge, 0 if
+    // there are none.
+    int getMaxTerminalProbability(const ChildEdge *const childEdge) const {
+        return mMaxTerminalProbabilities[childEdge - mChildEdges.data()];
+    }
+
+    // Looks the word id of the exact word up, which is NOT_A_WORD_ID when the dictionary doesn't
+    // contain the word. Returns false when the index can't tell, i.e. for words with code points
+    // that are not Unicode code points.
+    bool getWordId(const CodePointArrayView codePoints, int *const outWordId) const;
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mPtNodeArrayPosBits);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mPtNodeArrayPosRanks);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mFirstChildEdgeIndices);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mChildEdges);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mMaxTerminalProbabilities);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mCodes);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mAlphabet);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mSortedAlphabet);
+        mWordFilter.addMemoryUsage(outMemoryUsage);
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(Ver2ChildEdgeIndex);
+
+    static const int MAX_INDEXED_DICT_SIZE;
+    static const int CODE_POINT_COUNT_BIT_COUNT;
+    static const int CODE_BIT_COUNT;
+    static const int MAX_INLINE_CODE_COUNT;
+    static const int MAX_ALPHABET_SIZE;
+    static const int MAX_CODE_COUNT;
+    static const int MAX_BMP_CODE_POINT;
+    static const int POS_BIT_WORD_COUNT_PER_RANK;
+
+    const ReadOnlyByteArrayView mBuffer;
+    const DictionaryBigramsStructurePolicy *const mBigramPolicy;
+    const DictionaryShortcutsStructurePolicy *const mShortcutPolicy;
+    const int *const mCodePointTable;
+    // The bit of each PtNode array position is set, and the rank of the bit is the index of the
+    // array. mPtNodeArrayPosRanks has the count of the set bits before every
+    // POS_BIT_WORD_COUNT_PER_RANK words. The child edges of the i-th PtNode array are from
+    // mFirstChildEdgeIndices[i] to mFirstChildEdgeIndices[i + 1], which has one more element for
+    // the end of the last array.
+    std::vector<uint64_t> mPtNodeArrayPosBits;
+    std::vector<int> mPtNodeArrayPosRanks;
+    std::vector<int> mFirstChildEdgeIndices;
+    std::vector<ChildEdge> mChildEdges;
+    // Parallel to mChildEdges.
+    std::vector<uint8_t> mMaxTerminalProbabilities;
+    // The codes of the PtNodes that have more than MAX_INLINE_CODE_COUNT code points.
+    std::vector<uint8_t> mCodes;
+    // Code -> code point.
+    std::vector<int> mAlphabet;
+    // (code point << CODE_BIT_COUNT) | code, sorted.
+    std::vector<int> mSortedAlphabet;
+    // The hashes of the code points of the words.
+    BloomFilter mWordFilter;
+
+    bool isValidPos(const int pos) const {
+        return pos >= 0 && pos < static_cast<int>(mBuffer.size());
+    }
+    // Returns the index of the PtNode array at the position, or NOT_AN_INDEX.
+    int getPtNodeArrayIndex(const int ptNodeArrayPos) const;
+    int getCode(const int codePoint) const;
+    int getCodeAt(const ChildEdge *const childEdge, const int index) const;
+
+    static int getCodePointCount(const ChildEdge *const childEdge) {
+        return static_cast<int>(
+                childEdge->mCodePoints & ((1u << CODE_POINT_COUNT_BIT_COUNT) - 1));
+    }
+    void clear();
+    // Sets the max terminal probabilities of the child edges of the PtNode array and below, and
+    // returns the largest of them. codePointCount is the length of the prefix that leads to the
+    // array.
+    int updateMaxTerminalProbabilities(const int ptNodeArrayPos, const int codePointCount);
+    // Sets the words below the PtNode array in the filter. hash is the hash of the prefix of
+    // codePointCount code points that leads to the array.
+    void addWordsToFilter(const int ptNodeArrayPos, const uint32_t hash,
+            const int codePointCount);
+
+    // FNV-1a, a step per code point.
+    static AK_FORCE_INLINE uint32_t getNextHash(const uint32_t hash, const int codePoint) {
+        return (hash ^ static_cast<uint32_t>(codePoint)) * 16777619u;
+    }
+};
+} // namespace latinime
+#endif // LATINIME_VER2_CHILD_EDGE_INDEX_H
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v2/ver2_folded_word_index.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "dictionary/structure/v2/ver2_child_edge_index.h"
+#include "utils/char_utils.h"
+
+namespace latinime {
+
+const uint64_t Ver2FoldedWordIndex::HASH_OFFSET_BASIS = 14695981039346656037ull;
+const uint64_t Ver2FoldedWordIndex::HASH_PRIME = 1099511628211ull;
+
+void Ver2FoldedWordIndex::build(const Ver2ChildEdgeIndex *const childEdgeIndex) {
+    std::vector<std::pair<uint64_t /* hash */, int /* wordId */>> entries;
+    addWords(childEdgeIndex, 0 /* rootPos */, HASH_OFFSET_BASIS, 0 /* codePointCount */,
+            &entries);
+    std::sort(entries.begin(), entries.end());
+    mHashes.clear();
+    mWordIds.clear();
+    mHashes.reserve(entries.size());
+    mWordIds.reserve(entries.size());
+    for (const auto &entry : entries) {
+        mHashes.push_back(entry.first);
+        mWordIds.push_back(entry.second);
+    }
+}
+
+bool Ver2FoldedWordIndex::getWordIds(const CodePointArrayView codePoints,
+        const int **const outWordIds, int *const outWordIdCount) const {
+    if (codePoints.empty()) {
+        return false;
+    }
+    uint64_t hash = HASH_OFFSET_BASIS;
+    for (const int codePoint : codePoints) {
+        const int baseLowerCodePoint = CharUtils::toBaseLowerCase(codePoint);
+        // The omissions in the input have to match the ones in the words, which the hashes
+        // don't tell.
+        if (!CharUtils::isInUnicodeSpace(codePoint)
+                || CharUtils::isIntentionalOmissionCodePoint(baseLowerCodePoint)) {
+            return false;
+        }
+        hash = getNextHash(hash, baseLowerCodePoint);
+    }
+    const auto range = std::equal_range(mHashes.begin(), mHashes.end(), hash);
+    *outWordIds = mWordIds.data() + (range.first - mHashes.begin());
+    *outWordIdCount = static_cast<int>(range.second - range.first);
+    return true;
+}
+
+void Ver2FoldedWordIndex::addWords(const Ver2ChildEdgeIndex *const childEdgeIndex,
+        const int ptNodeArrayPos, const uint64_t hash, const int codePointCount,
+        std::vector<std::pair<uint64_t, int>> *const outEntries) const {
+    int childEdgeCount = 0;
+    const Ver2ChildEdgeIndex::ChildEdge *const childEdges =
+            childEdgeIndex->getChildEdges(ptNodeArrayPos, &childEdgeCount);
+    if (!childEdges) {
+        return;
+    }
+    int edgeCodePoints[MAX_WORD_LENGTH];
+    for (int i = 0; i < childEdgeCount; ++i) {
+        const Ver2ChildEdgeIndex::ChildEdge *const childEdge = &childEdges[i];
+        const int edgeCodePointCount = childEdgeIndex->getCodePoints(childEdge, edgeCodePoints);
+        const int childCodePointCount = codePointCount + edgeCodePointCount;
+        if (childCodePointCount > MAX_WORD_LENGTH) {
+            // Bounds the recursion.
+            continue;
+        }
+        // The intentional omissions can be skipped anywhere but at the end of the word.
+        uint64_t childHash = hash;
+        for (int j = 0; j < edgeCodePointCount; ++j) {
+            if (!CharUtils::isIntentionalOmissionCodePoint(edgeCodePoints[j])) {
+                childHash = getNextHash(childHash, CharUtils::toBaseLowerCase(edgeCodePoints[j]));
+            }
+        }
+        if (childEdge->mWordId != NOT_A_WORD_ID && !CharUtils::isIntentionalOmissionCodePoint(
+                        edgeCodePoints[edgeCodePointCount - 1])) {
+            outEntries->emplace_back(childHash, childEdge->mWordId);
+        }
+        if (childEdge->mChildrenPos != NOT_A_DICT_POS) {
+            addWords(childEdgeIndex, childEdge->mChildrenPos, childHash, childCodePointCount,
+                    outEntries);
+        }
+    }
+}
+
+} // namespace latinime
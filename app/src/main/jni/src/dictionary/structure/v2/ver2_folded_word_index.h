@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_VER2_FOLDED_WORD_INDEX_H
+#define LATINIME_VER2_FOLDED_WORD_INDEX_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "defines.h"
+#include "utils/int_array_view.h"
+#include "utils/memory_usage.h"
+
+namespace latinime {
+
+class Ver2ChildEdgeIndex;
+
+// The word ids of a read-only ver2 dictionary by the hash of their code points in base lower
+// case without the intentional omissions, i.e. the words that
+// DictionaryUtils::getMaxProbabilityOfExactMatches() finds by traversing the trie. The hashes are
+// 64-bit, so the words are not compared.
+class Ver2FoldedWordIndex {
+ public:
+    Ver2FoldedWordIndex() : mHashes(), mWordIds() {}
+
+    // Builds the index from the words in the child edge index.
+    void build(const Ver2ChildEdgeIndex *const childEdgeIndex);
+
+    // Looks the ids of the words that match the code points when case, accents and intentional
+    // omissions are ignored up. Returns false when the index can't tell, i.e. for code points
+    // that have intentional omissions or are not Unicode code points.
+    bool getWordIds(const CodePointArrayView codePoints, const int **const outWordIds,
+            int *const outWordIdCount) const;
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mHashes);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mWordIds);
+    }
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(Ver2FoldedWordIndex);
+
+    static const uint64_t HASH_OFFSET_BASIS;
+    static const uint64_t HASH_PRIME;
+
+    // Sorted, with the id of the word of each hash at the same index in mWordIds.
+    std::vector<uint64_t> mHashes;
+    std::vector<int> mWordIds;
+
+    // Adds the words below the PtNode array, which is led to by the code points of the hash.
+    void addWords(const Ver2ChildEdgeIndex *const childEdgeIndex, const int ptNodeArrayPos,
+            const uint64_t hash, const int codePointCount,
+            std::vector<std::pair<uint64_t, int>> *const outEntries) const;
+
+    // FNV-1a, a step per code point.
+    static AK_FORCE_INLINE uint64_t getNextHash(const uint64_t hash, const int codePoint) {
+        return (hash ^ static_cast<uint64_t>(static_cast<uint32_t>(codePoint))) * HASH_PRIME;
+    }
+};
+} // namespace latinime
+#endif // LATINIME_VER2_FOLDED_WORD_INDEX_H
@@ -35,8 +35,12 @@ bool LanguageModelDictContent::save(FILE *const file) const {
 bool LanguageModelDictContent::runGC(
         const TerminalPositionLookupTable::TerminalIdMap *const terminalIdMap,
         const LanguageModelDictContent *const originalContent) {
-    return runGCInner(terminalIdMap, originalContent->mTrieMap.getEntriesInRootLevel(),
+    mIsNgramContextMapInUse = false;
+    const bool result = runGCInner(terminalIdMap,
+            originalContent->mTrieMap.getEntriesInRootLevel(),
             0 /* nextLevelBitmapEntryIndex */);
+    rebuildNgramContextMap();
+    return result;
 }
 
 const WordAttributes LanguageModelDictContent::getWordAttributes(const WordIdArrayView prevWordIds,
@@ -46,8 +50,9 @@ const WordAttributes LanguageModelDictContent::getWordAttributes(const WordIdArr
     bitmapEntryIndices[0] = mTrieMap.getRootBitmapEntryIndex();
     int maxPrevWordCount = 0;
     for (size_t i = 0; i < prevWordIds.size(); ++i) {
-        const int nextBitmapEntryIndex =
-                mTrieMap.get(prevWordIds[i], bitmapEntryIndices[i]).mNextLevelBitmapEntryIndex;
+        const int nextBitmapEntryIndex = mIsNgramContextMapInUse
+                ? getBitmapEntryIndex(prevWordIds.limit(i + 1))
+                : mTrieMap.get(prevWordIds[i], bitmapEntryIndices[i]).mNextLevelBitmapEntryIndex;
         if (nextBitmapEntryIndex == TrieMap::INVALID_INDEX) {
             break;
         }
@@ -55,7 +60,14 @@ const WordAttributes LanguageModelDictContent::getWordAttributes(const WordIdArr
         bitmapEntryIndices[i + 1] = nextBitmapEntryIndex;
     }
 
-    const ProbabilityEntry unigramProbabilityEntry = getProbabilityEntry(wordId);
+    // The word is looked up in all the levels at once so that the lookups overlap.
+    int wordIds[MAX_PREV_WORD_COUNT_FOR_N_GRAM + 1];
+    std::fill(wordIds, wordIds + maxPrevWordCount + 1, wordId);
+    TrieMap::Result results[MAX_PREV_WORD_COUNT_FOR_N_GRAM + 1];
+    mTrieMap.getMulti(wordIds, bitmapEntryIndices, maxPrevWordCount + 1, results);
+    const ProbabilityEntry unigramProbabilityEntry = results[0].mIsValid
+            ? ProbabilityEntry::decode(results[0].mValue, mHasHistoricalInfo)
+            : ProbabilityEntry();
     if (mHasHistoricalInfo && unigramProbabilityEntry.getHistoricalInfo()->getCount() == 0) {
         // The word should be treated as a invalid word.
         return WordAttributes();
@@ -64,7 +76,7 @@ const WordAttributes LanguageModelDictContent::getWordAttributes(const WordIdArr
         if (mustMatchAllPrevWords && prevWordIds.size() > static_cast<size_t>(i)) {
             break;
         }
-        const TrieMap::Result result = mTrieMap.get(wordId, bitmapEntryIndices[i]);
+        const TrieMap::Result &result = results[i];
         if (!result.mIsValid) {
             continue;
         }
@@ -147,7 +159,22 @@ bool LanguageModelDictContent::removeNgramProbabilityEntry(const WordIdArrayView
         // Cannot find bitmap entry for the probability entry. The entry doesn't exist.
         return false;
     }
-    return mTrieMap.remove(wordId, bitmapEntryIndex);
+    // Removing an entry removes its next level too, and the tables can be reused.
+    bool isNgramContext = false;
+    if (mIsNgramContextMapInUse && prevWordIds.size() < MAX_PREV_WORD_COUNT_FOR_N_GRAM) {
+        WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> ngramContext;
+        std::copy(prevWordIds.begin(), prevWordIds.end(), ngramContext.begin());
+        ngramContext[prevWordIds.size()] = wordId;
+        isNgramContext = mNgramContextMap.get(WordIdArrayView(ngramContext.data(),
+                prevWordIds.size() + 1)) != NgramContextMap::NOT_A_VALUE;
+    }
+    if (!mTrieMap.remove(wordId, bitmapEntryIndex)) {
+        return false;
+    }
+    if (isNgramContext) {
+        rebuildNgramContextMap();
+    }
+    return true;
 }
 
 LanguageModelDictContent::EntryRange LanguageModelDictContent::getProbabilityEntries(
@@ -198,6 +225,16 @@ void LanguageModelDictContent::exportAllNgramEntriesRelatedToWordInner(
 bool LanguageModelDictContent::truncateEntries(const EntryCounts &currentEntryCounts,
         const EntryCounts &maxEntryCounts, const HeaderPolicy *const headerPolicy,
         MutableEntryCounters *const outEntryCounters) {
+    mIsNgramContextMapInUse = false;
+    const bool result = truncateEntriesInner(currentEntryCounts, maxEntryCounts, headerPolicy,
+            outEntryCounters);
+    rebuildNgramContextMap();
+    return result;
+}
+
+bool LanguageModelDictContent::truncateEntriesInner(const EntryCounts &currentEntryCounts,
+        const EntryCounts &maxEntryCounts, const HeaderPolicy *const headerPolicy,
+        MutableEntryCounters *const outEntryCounters) {
     for (int prevWordCount = 0; prevWordCount <= MAX_PREV_WORD_COUNT_FOR_N_GRAM; ++prevWordCount) {
         const int totalWordCount = prevWordCount + 1;
         const NgramType ngramType = NgramUtils::getNgramTypeFromWordCount(totalWordCount);
@@ -209,6 +246,7 @@ bool LanguageModelDictContent::truncateEntries(const EntryCounts &currentEntryCo
         }
         int entryCount = 0;
         if (!turncateEntriesInSpecifiedLevel(headerPolicy,
+                currentEntryCounts.getNgramCount(ngramType),
                 maxEntryCounts.getNgramCount(ngramType), prevWordCount, &entryCount)) {
             return false;
         }
@@ -294,28 +332,41 @@ bool LanguageModelDictContent::runGCInner(
 }
 
 int LanguageModelDictContent::createAndGetBitmapEntryIndex(const WordIdArrayView prevWordIds) {
+    if (mIsNgramContextMapInUse && !prevWordIds.empty()) {
+        const int bitmapEntryIndex = mNgramContextMap.get(prevWordIds);
+        if (bitmapEntryIndex != NgramContextMap::NOT_A_VALUE) {
+            return bitmapEntryIndex;
+        }
+    }
     int lastBitmapEntryIndex = mTrieMap.getRootBitmapEntryIndex();
-    for (const int wordId : prevWordIds) {
+    for (size_t i = 0; i < prevWordIds.size(); ++i) {
+        const int wordId = prevWordIds[i];
         const TrieMap::Result result = mTrieMap.get(wordId, lastBitmapEntryIndex);
         if (result.mIsValid && result.mNextLevelBitmapEntryIndex != TrieMap::INVALID_INDEX) {
             lastBitmapEntryIndex = result.mNextLevelBitmapEntryIndex;
-            continue;
-        }
-        if (!result.mIsValid) {
-            if (!mTrieMap.put(wordId, ProbabilityEntry().encode(mHasHistoricalInfo),
-                    lastBitmapEntryIndex)) {
+        } else {
+            if (!result.mIsValid && !mTrieMap.put(wordId,
+                    ProbabilityEntry().encode(mHasHistoricalInfo), lastBitmapEntryIndex)) {
                 AKLOGE("Failed to update trie map. wordId: %d, lastBitmapEntryIndex %d", wordId,
                         lastBitmapEntryIndex);
                 return TrieMap::INVALID_INDEX;
             }
+            lastBitmapEntryIndex = mTrieMap.getNextLevelBitmapEntryIndex(wordId,
+                    lastBitmapEntryIndex);
+        }
+        if (mIsNgramContextMapInUse && lastBitmapEntryIndex != TrieMap::INVALID_INDEX) {
+            mNgramContextMap.put(prevWordIds.limit(i + 1), lastBitmapEntryIndex);
         }
-        lastBitmapEntryIndex = mTrieMap.getNextLevelBitmapEntryIndex(wordId,
-                lastBitmapEntryIndex);
     }
     return lastBitmapEntryIndex;
 }
 
 int LanguageModelDictContent::getBitmapEntryIndex(const WordIdArrayView prevWordIds) const {
+    if (mIsNgramContextMapInUse && !prevWordIds.empty()) {
+        const int bitmapEntryIndex = mNgramContextMap.get(prevWordIds);
+        return bitmapEntryIndex == NgramContextMap::NOT_A_VALUE
+                ? TrieMap::INVALID_INDEX : bitmapEntryIndex;
+    }
     int bitmapEntryIndex = mTrieMap.getRootBitmapEntryIndex();
     for (const int wordId : prevWordIds) {
         const TrieMap::Result result = mTrieMap.get(wordId, bitmapEntryIndex);
@@ -327,99 +378,171 @@ int LanguageModelDictContent::getBitmapEntryIndex(const WordIdArrayView prevWord
     return bitmapEntryIndex;
 }
 
+void LanguageModelDictContent::rebuildNgramContextMap() {
+    mNgramContextMap.clear();
+    mIsNgramContextMapInUse = mUsesNgramContextMap;
+    if (!mIsNgramContextMapInUse) {
+        return;
+    }
+    WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> prevWordIds;
+    addNgramContextsInLevel(mTrieMap.getRootBitmapEntryIndex(), &prevWordIds,
+            0 /* prevWordCount */);
+}
+
+void LanguageModelDictContent::addNgramContextsInLevel(const int bitmapEntryIndex,
+        WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> *const prevWordIds,
+        const int prevWordCount) {
+    if (prevWordCount >= MAX_PREV_WORD_COUNT_FOR_N_GRAM) {
+        return;
+    }
+    for (const auto &entry : mTrieMap.getEntriesInSpecifiedLevel(bitmapEntryIndex)) {
+        if (!entry.hasNextLevelMap()) {
+            continue;
+        }
+        (*prevWordIds)[prevWordCount] = entry.key();
+        mNgramContextMap.put(WordIdArrayView(prevWordIds->data(), prevWordCount + 1),
+                entry.getNextLevelBitmapEntryIndex());
+        addNgramContextsInLevel(entry.getNextLevelBitmapEntryIndex(), prevWordIds,
+                prevWordCount + 1);
+    }
+}
+
 bool LanguageModelDictContent::updateAllProbabilityEntriesForGCInner(const int bitmapEntryIndex,
         const int prevWordCount, const HeaderPolicy *const headerPolicy,
         const bool needsToHalveCounters, MutableEntryCounters *const outEntryCounters) {
-    for (const auto &entry : mTrieMap.getEntriesInSpecifiedLevel(bitmapEntryIndex)) {
+    // The entries are read in batches, so that the words of a batch can be looked up together.
+    // Only the entries in this level and below are updated here, so the words stay as they are
+    // while the level is processed.
+    int keys[MAX_ENTRY_COUNT_IN_GC_BATCH];
+    uint64_t values[MAX_ENTRY_COUNT_IN_GC_BATCH];
+    int nextLevelBitmapEntryIndices[MAX_ENTRY_COUNT_IN_GC_BATCH];
+    int rootBitmapEntryIndices[MAX_ENTRY_COUNT_IN_GC_BATCH];
+    TrieMap::Result wordEntries[MAX_ENTRY_COUNT_IN_GC_BATCH];
+    std::fill(rootBitmapEntryIndices, rootBitmapEntryIndices + MAX_ENTRY_COUNT_IN_GC_BATCH,
+            mTrieMap.getRootBitmapEntryIndex());
+    const TrieMap::TrieMapRange entries = mTrieMap.getEntriesInSpecifiedLevel(bitmapEntryIndex);
+    TrieMap::TrieMapIterator it = entries.begin();
+    const TrieMap::TrieMapIterator end = entries.end();
+    while (it != end) {
         if (prevWordCount > MAX_PREV_WORD_COUNT_FOR_N_GRAM) {
             AKLOGE("Invalid prevWordCount. prevWordCount: %d, MAX_PREV_WORD_COUNT_FOR_N_GRAM: %d.",
                     prevWordCount, MAX_PREV_WORD_COUNT_FOR_N_GRAM);
             return false;
         }
-        const ProbabilityEntry probabilityEntry =
-                ProbabilityEntry::decode(entry.value(), mHasHistoricalInfo);
-        if (prevWordCount > 0 && probabilityEntry.isValid()
-                && !mTrieMap.getRoot(entry.key()).mIsValid) {
-            // The entry is related to a word that has been removed. Remove the entry.
-            if (!mTrieMap.remove(entry.key(), bitmapEntryIndex)) {
-                return false;
-            }
-            continue;
+        int entryCount = 0;
+        for (; entryCount < MAX_ENTRY_COUNT_IN_GC_BATCH && it != end; ++entryCount, ++it) {
+            const TrieMap::TrieMapIterator::IterationResult entry = *it;
+            keys[entryCount] = entry.key();
+            values[entryCount] = entry.value();
+            nextLevelBitmapEntryIndices[entryCount] = entry.hasNextLevelMap()
+                    ? entry.getNextLevelBitmapEntryIndex() : TrieMap::INVALID_INDEX;
+        }
+        if (prevWordCount > 0) {
+            mTrieMap.getMulti(keys, rootBitmapEntryIndices, entryCount, wordEntries);
         }
-        if (mHasHistoricalInfo && probabilityEntry.isValid()) {
-            const HistoricalInfo *originalHistoricalInfo = probabilityEntry.getHistoricalInfo();
-            if (DynamicLanguageModelProbabilityUtils::shouldRemoveEntryDuringGC(
-                    *originalHistoricalInfo)) {
-                // Remove the entry.
-                if (!mTrieMap.remove(entry.key(), bitmapEntryIndex)) {
+        for (int i = 0; i < entryCount; ++i) {
+            const ProbabilityEntry probabilityEntry =
+                    ProbabilityEntry::decode(values[i], mHasHistoricalInfo);
+            if (prevWordCount > 0 && probabilityEntry.isValid() && !wordEntries[i].mIsValid) {
+                // The entry is related to a word that has been removed. Remove the entry.
+                if (!mTrieMap.remove(keys[i], bitmapEntryIndex)) {
                     return false;
                 }
                 continue;
             }
-            if (needsToHalveCounters) {
-                const int updatedCount = originalHistoricalInfo->getCount() / 2;
-                if (updatedCount == 0) {
+            if (mHasHistoricalInfo && probabilityEntry.isValid()) {
+                const HistoricalInfo *originalHistoricalInfo =
+                        probabilityEntry.getHistoricalInfo();
+                if (DynamicLanguageModelProbabilityUtils::shouldRemoveEntryDuringGC(
+                        *originalHistoricalInfo)) {
                     // Remove the entry.
-                    if (!mTrieMap.remove(entry.key(), bitmapEntryIndex)) {
+                    if (!mTrieMap.remove(keys[i], bitmapEntryIndex)) {
                         return false;
                     }
                     continue;
                 }
-                const HistoricalInfo historicalInfoToSave(originalHistoricalInfo->getTimestamp(),
-                        originalHistoricalInfo->getLevel(), updatedCount);
-                const ProbabilityEntry updatedEntry(probabilityEntry.getFlags(),
-                        &historicalInfoToSave);
-                if (!mTrieMap.put(entry.key(), updatedEntry.encode(mHasHistoricalInfo),
-                        bitmapEntryIndex)) {
-                    return false;
+                if (needsToHalveCounters) {
+                    const int updatedCount = originalHistoricalInfo->getCount() / 2;
+                    if (updatedCount == 0) {
+                        // Remove the entry.
+                        if (!mTrieMap.remove(keys[i], bitmapEntryIndex)) {
+                            return false;
+                        }
+                        continue;
+                    }
+                    const HistoricalInfo historicalInfoToSave(
+                            originalHistoricalInfo->getTimestamp(),
+                            originalHistoricalInfo->getLevel(), updatedCount);
+                    const ProbabilityEntry updatedEntry(probabilityEntry.getFlags(),
+                            &historicalInfoToSave);
+                    if (!mTrieMap.put(keys[i], updatedEntry.encode(mHasHistoricalInfo),
+                            bitmapEntryIndex)) {
+                        return false;
+                    }
                 }
             }
-        }
-        outEntryCounters->incrementNgramCount(
-                NgramUtils::getNgramTypeFromWordCount(prevWordCount + 1));
-        if (!entry.hasNextLevelMap()) {
-            continue;
-        }
-        if (!updateAllProbabilityEntriesForGCInner(entry.getNextLevelBitmapEntryIndex(),
-                prevWordCount + 1, headerPolicy, needsToHalveCounters, outEntryCounters)) {
-            return false;
+            outEntryCounters->incrementNgramCount(
+                    NgramUtils::getNgramTypeFromWordCount(prevWordCount + 1));
+            if (nextLevelBitmapEntryIndices[i] == TrieMap::INVALID_INDEX) {
+                continue;
+            }
+            if (!updateAllProbabilityEntriesForGCInner(nextLevelBitmapEntryIndices[i],
+                    prevWordCount + 1, headerPolicy, needsToHalveCounters, outEntryCounters)) {
+                return false;
+            }
         }
     }
     return true;
 }
 
 bool LanguageModelDictContent::turncateEntriesInSpecifiedLevel(
-        const HeaderPolicy *const headerPolicy, const int maxEntryCount, const int targetLevel,
-        int *const outEntryCount) {
-    std::vector<int> prevWordIds;
-    std::vector<EntryInfoToTurncate> entryInfoVector;
-    if (!getEntryInfo(headerPolicy, targetLevel, mTrieMap.getRootBitmapEntryIndex(),
-            &prevWordIds, &entryInfoVector)) {
-        return false;
-    }
-    if (static_cast<int>(entryInfoVector.size()) <= maxEntryCount) {
-        *outEntryCount = static_cast<int>(entryInfoVector.size());
-        return true;
-    }
-    *outEntryCount = maxEntryCount;
-    const int entryCountToRemove = static_cast<int>(entryInfoVector.size()) - maxEntryCount;
-    std::partial_sort(entryInfoVector.begin(), entryInfoVector.begin() + entryCountToRemove,
-            entryInfoVector.end(),
-            EntryInfoToTurncate::Comparator());
-    for (int i = 0; i < entryCountToRemove; ++i) {
-        const EntryInfoToTurncate &entryInfo = entryInfoVector[i];
-        if (!removeNgramProbabilityEntry(
-                WordIdArrayView(entryInfo.mPrevWordIds, entryInfo.mPrevWordCount),
-                entryInfo.mKey)) {
+        const HeaderPolicy *const headerPolicy, const int estimatedEntryCount,
+        const int maxEntryCount, const int targetLevel, int *const outEntryCount) {
+    // Only the entries to remove are kept while the level is traversed. The estimated count can
+    // be larger than the actual count because removing entries in the lower levels removes their
+    // next levels too. When it is smaller, the remaining entries are removed in another pass.
+    int currentEstimatedEntryCount = estimatedEntryCount;
+    while (true) {
+        std::vector<int> prevWordIds;
+        std::vector<EntryInfoToTurncate> entryInfoHeap;
+        const int maxEntryCountToRemove = currentEstimatedEntryCount - maxEntryCount;
+        entryInfoHeap.reserve(maxEntryCountToRemove);
+        int entryCount = 0;
+        if (!getEntryInfo(headerPolicy, targetLevel, mTrieMap.getRootBitmapEntryIndex(),
+                maxEntryCountToRemove, &prevWordIds, &entryInfoHeap, &entryCount)) {
             return false;
         }
+        if (entryCount <= maxEntryCount) {
+            *outEntryCount = entryCount;
+            return true;
+        }
+        const int entryCountToRemove = std::min(entryCount - maxEntryCount,
+                static_cast<int>(entryInfoHeap.size()));
+        while (static_cast<int>(entryInfoHeap.size()) > entryCountToRemove) {
+            std::pop_heap(entryInfoHeap.begin(), entryInfoHeap.end(),
+                    EntryInfoToTurncate::Comparator());
+            entryInfoHeap.pop_back();
+        }
+        for (const EntryInfoToTurncate &entryInfo : entryInfoHeap) {
+            if (!removeNgramProbabilityEntry(
+                    WordIdArrayView(entryInfo.mPrevWordIds, entryInfo.mPrevWordCount),
+                    entryInfo.mKey)) {
+                return false;
+            }
+        }
+        entryCount -= entryCountToRemove;
+        if (entryCount <= maxEntryCount) {
+            *outEntryCount = entryCount;
+            return true;
+        }
+        currentEstimatedEntryCount = entryCount;
     }
-    return true;
 }
 
 bool LanguageModelDictContent::getEntryInfo(const HeaderPolicy *const headerPolicy,
-        const int targetLevel, const int bitmapEntryIndex,  std::vector<int> *const prevWordIds,
-        std::vector<EntryInfoToTurncate> *const outEntryInfo) const {
+        const int targetLevel, const int bitmapEntryIndex, const int maxEntryInfoCount,
+        std::vector<int> *const prevWordIds,
+        std::vector<EntryInfoToTurncate> *const outEntryInfoHeap, int *const outEntryCount) const {
     const int prevWordCount = prevWordIds->size();
     for (const auto &entry : mTrieMap.getEntriesInSpecifiedLevel(bitmapEntryIndex)) {
         if (prevWordCount < targetLevel) {
@@ -428,7 +551,7 @@ bool LanguageModelDictContent::getEntryInfo(const HeaderPolicy *const headerPoli
             }
             prevWordIds->push_back(entry.key());
             if (!getEntryInfo(headerPolicy, targetLevel, entry.getNextLevelBitmapEntryIndex(),
-                    prevWordIds, outEntryInfo)) {
+                    maxEntryInfoCount, prevWordIds, outEntryInfoHeap, outEntryCount)) {
                 return false;
             }
             prevWordIds->pop_back();
@@ -440,8 +563,21 @@ bool LanguageModelDictContent::getEntryInfo(const HeaderPolicy *const headerPoli
                 ? DynamicLanguageModelProbabilityUtils::getPriorityToPreventFromEviction(
                         *probabilityEntry.getHistoricalInfo())
                 : probabilityEntry.getProbability();
-        outEntryInfo->emplace_back(priority, probabilityEntry.getHistoricalInfo()->getCount(),
-                entry.key(), targetLevel, prevWordIds->data());
+        const EntryInfoToTurncate entryInfo(priority,
+                probabilityEntry.getHistoricalInfo()->getCount(), entry.key(), targetLevel,
+                prevWordIds->data());
+        ++(*outEntryCount);
+        // The heap keeps the maxEntryInfoCount lowest entries. Its top is the highest of them.
+        const EntryInfoToTurncate::Comparator comparator;
+        if (static_cast<int>(outEntryInfoHeap->size()) < maxEntryInfoCount) {
+            outEntryInfoHeap->push_back(entryInfo);
+            std::push_heap(outEntryInfoHeap->begin(), outEntryInfoHeap->end(), comparator);
+        } else if (!outEntryInfoHeap->empty()
+                && comparator(entryInfo, outEntryInfoHeap->front())) {
+            std::pop_heap(outEntryInfoHeap->begin(), outEntryInfoHeap->end(), comparator);
+            outEntryInfoHeap->back() = entryInfo;
+            std::push_heap(outEntryInfoHeap->begin(), outEntryInfoHeap->end(), comparator);
+        }
     }
     return true;
 }
@@ -27,6 +27,7 @@
 #include "dictionary/structure/v4/content/terminal_position_lookup_table.h"
 #include "dictionary/structure/v4/ver4_dict_constants.h"
 #include "dictionary/utils/entry_counters.h"
+#include "dictionary/utils/ngram_context_map.h"
 #include "dictionary/utils/trie_map.h"
 #include "utils/byte_array_view.h"
 #include "utils/int_array_view.h"
@@ -132,19 +133,39 @@ class LanguageModelDictContent {
         const ProbabilityEntry mProbabilityEntry;
     };
 
+    // When usesNgramContextMap is true, the n-gram contexts are also kept in an NgramContextMap
+    // and looked up there. The trie map stays the format of the content. usesTrieMapValueLinks
+    // depends on the dictionary format, see TrieMap.
     LanguageModelDictContent(const ReadWriteByteArrayView *const buffers,
-            const bool hasHistoricalInfo)
-            : mTrieMap(buffers[TRIE_MAP_BUFFER_INDEX]),
+            const bool hasHistoricalInfo, const bool usesNgramContextMap,
+            const bool usesTrieMapValueLinks)
+            : mTrieMap(buffers[TRIE_MAP_BUFFER_INDEX], usesTrieMapValueLinks),
               mGlobalCounters(buffers[GLOBAL_COUNTERS_BUFFER_INDEX]),
-              mHasHistoricalInfo(hasHistoricalInfo) {}
+              mHasHistoricalInfo(hasHistoricalInfo), mNgramContextMap(),
+              mUsesNgramContextMap(usesNgramContextMap),
+              mIsNgramContextMapInUse(usesNgramContextMap) {
+        rebuildNgramContextMap();
+    }
 
-    explicit LanguageModelDictContent(const bool hasHistoricalInfo)
-            : mTrieMap(), mGlobalCounters(), mHasHistoricalInfo(hasHistoricalInfo) {}
+    LanguageModelDictContent(const bool hasHistoricalInfo, const bool usesNgramContextMap,
+            const bool usesTrieMapValueLinks)
+            : mTrieMap(usesTrieMapValueLinks), mGlobalCounters(),
+              mHasHistoricalInfo(hasHistoricalInfo), mNgramContextMap(),
+              mUsesNgramContextMap(usesNgramContextMap),
+              mIsNgramContextMapInUse(usesNgramContextMap) {}
 
     bool isNearSizeLimit() const {
         return mTrieMap.isNearSizeLimit() || mGlobalCounters.needsToHalveCounters();
     }
 
+    bool isNearHardSizeLimit() const {
+        return mTrieMap.isNearHardSizeLimit();
+    }
+
+    int getUsedAdditionalBufferSize() const {
+        return mTrieMap.getUsedAdditionalBufferSize();
+    }
+
     bool save(FILE *const file) const;
 
     bool runGC(const TerminalPositionLookupTable::TerminalIdMap *const terminalIdMap,
@@ -181,9 +202,13 @@ class LanguageModelDictContent {
 
     bool updateAllProbabilityEntriesForGC(const HeaderPolicy *const headerPolicy,
             MutableEntryCounters *const outEntryCounters) {
-        if (!updateAllProbabilityEntriesForGCInner(mTrieMap.getRootBitmapEntryIndex(),
-                0 /* prevWordCount */, headerPolicy, mGlobalCounters.needsToHalveCounters(),
-                outEntryCounters)) {
+        // Removed entries can take contexts with them, so the map is rebuilt afterwards.
+        mIsNgramContextMapInUse = false;
+        const bool result = updateAllProbabilityEntriesForGCInner(
+                mTrieMap.getRootBitmapEntryIndex(), 0 /* prevWordCount */, headerPolicy,
+                mGlobalCounters.needsToHalveCounters(), outEntryCounters);
+        rebuildNgramContextMap();
+        if (!result) {
             return false;
         }
         if (mGlobalCounters.needsToHalveCounters()) {
@@ -230,23 +255,39 @@ class LanguageModelDictContent {
 
     static const int TRIE_MAP_BUFFER_INDEX;
     static const int GLOBAL_COUNTERS_BUFFER_INDEX;
+    static const int MAX_ENTRY_COUNT_IN_GC_BATCH = 32;
 
     TrieMap mTrieMap;
     LanguageModelDictContentGlobalCounters mGlobalCounters;
     const bool mHasHistoricalInfo;
-
+    // Maps contexts to the bitmap entry indices of their levels in mTrieMap.
+    NgramContextMap mNgramContextMap;
+    const bool mUsesNgramContextMap;
+    // False while entries are removed in bulk. The map is rebuilt afterwards.
+    bool mIsNgramContextMapInUse;
+
+    bool truncateEntriesInner(const EntryCounts &currentEntryCounts,
+            const EntryCounts &maxEntryCounts, const HeaderPolicy *const headerPolicy,
+            MutableEntryCounters *const outEntryCounters);
     bool runGCInner(const TerminalPositionLookupTable::TerminalIdMap *const terminalIdMap,
             const TrieMap::TrieMapRange trieMapRange, const int nextLevelBitmapEntryIndex);
     int createAndGetBitmapEntryIndex(const WordIdArrayView prevWordIds);
     int getBitmapEntryIndex(const WordIdArrayView prevWordIds) const;
+    void rebuildNgramContextMap();
+    void addNgramContextsInLevel(const int bitmapEntryIndex,
+            WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> *const prevWordIds,
+            const int prevWordCount);
     bool updateAllProbabilityEntriesForGCInner(const int bitmapEntryIndex, const int prevWordCount,
             const HeaderPolicy *const headerPolicy, const bool needsToHalveCounters,
             MutableEntryCounters *const outEntryCounters);
     bool turncateEntriesInSpecifiedLevel(const HeaderPolicy *const headerPolicy,
-            const int maxEntryCount, const int targetLevel, int *const outEntryCount);
+            const int estimatedEntryCount, const int maxEntryCount, const int targetLevel,
+            int *const outEntryCount);
     bool getEntryInfo(const HeaderPolicy *const headerPolicy, const int targetLevel,
-            const int bitmapEntryIndex, std::vector<int> *const prevWordIds,
-            std::vector<EntryInfoToTurncate> *const outEntryInfo) const;
+            const int bitmapEntryIndex, const int maxEntryInfoCount,
+            std::vector<int> *const prevWordIds,
+            std::vector<EntryInfoToTurncate> *const outEntryInfoHeap,
+            int *const outEntryCount) const;
     const ProbabilityEntry createUpdatedEntryFrom(const ProbabilityEntry &originalProbabilityEntry,
             const bool isValid, const HistoricalInfo historicalInfo,
             const HeaderPolicy *const headerPolicy) const;
@@ -16,6 +16,8 @@
 
 #include "dictionary/structure/v4/content/shortcut_dict_content.h"
 
+#include <vector>
+
 #include "dictionary/utils/buffer_with_extendable_buffer.h"
 
 namespace latinime {
@@ -62,10 +64,21 @@ int ShortcutDictContent::getShortcutListHeadPos(const int terminalId) const {
 bool ShortcutDictContent::runGC(
         const TerminalPositionLookupTable::TerminalIdMap *const terminalIdMap,
         const ShortcutDictContent *const originalShortcutDictContent) {
+   std::vector<int> originalTerminalIds;
+   std::vector<int> terminalIds;
+   originalTerminalIds.reserve(terminalIdMap->size());
+   terminalIds.reserve(terminalIdMap->size());
    for (TerminalPositionLookupTable::TerminalIdMap::const_iterator it = terminalIdMap->begin();
            it != terminalIdMap->end(); ++it) {
-       const int originalShortcutListPos =
-               originalShortcutDictContent->getShortcutListHeadPos(it->first);
+       originalTerminalIds.push_back(it->first);
+       terminalIds.push_back(it->second);
+   }
+   // The head positions are read at once so that the reads of the lookup table overlap.
+   std::vector<uint32_t> originalShortcutListPositions(originalTerminalIds.size());
+   originalShortcutDictContent->getAddressLookupTable()->getMany(originalTerminalIds.data(),
+           originalTerminalIds.size(), originalShortcutListPositions.data());
+   for (size_t i = 0; i < originalTerminalIds.size(); ++i) {
+       const int originalShortcutListPos = originalShortcutListPositions[i];
        if (originalShortcutListPos == NOT_A_DICT_POS) {
            continue;
        }
@@ -78,9 +91,9 @@ bool ShortcutDictContent::runGC(
            return false;
        }
        // Set shortcut list position to the lookup table.
-       if (!getUpdatableAddressLookupTable()->set(it->second, shortcutListPos)) {
+       if (!getUpdatableAddressLookupTable()->set(terminalIds[i], shortcutListPos)) {
            AKLOGE("Cannot set shortcut list position. terminal id: %d, pos: %d",
-                   it->second, shortcutListPos);
+                   terminalIds[i], shortcutListPos);
            return false;
        }
    }
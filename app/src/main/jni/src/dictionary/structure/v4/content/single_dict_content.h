@@ -42,6 +42,14 @@ class SingleDictContent {
         return mExpandableContentBuffer.isNearSizeLimit();
     }
 
+    bool isNearHardSizeLimit() const {
+        return mExpandableContentBuffer.isNearHardSizeLimit();
+    }
+
+    int getUsedAdditionalBufferSize() const {
+        return mExpandableContentBuffer.getUsedAdditionalBufferSize();
+    }
+
  protected:
     BufferWithExtendableBuffer *getWritableBuffer() {
         return &mExpandableContentBuffer;
@@ -56,6 +56,18 @@ class SparseTableDictContent {
                 || mExpandableContentBuffer.isNearSizeLimit();
     }
 
+    bool isNearHardSizeLimit() const {
+        return mExpandableLookupTableBuffer.isNearHardSizeLimit()
+                || mExpandableAddressTableBuffer.isNearHardSizeLimit()
+                || mExpandableContentBuffer.isNearHardSizeLimit();
+    }
+
+    int getUsedAdditionalBufferSize() const {
+        return mExpandableLookupTableBuffer.getUsedAdditionalBufferSize()
+                + mExpandableAddressTableBuffer.getUsedAdditionalBufferSize()
+                + mExpandableContentBuffer.getUsedAdditionalBufferSize();
+    }
+
  protected:
     SparseTable *getUpdatableAddressLookupTable() {
         return &mAddressLookupTable;
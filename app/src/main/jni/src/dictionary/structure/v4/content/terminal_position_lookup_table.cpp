@@ -20,14 +20,16 @@
 
 namespace latinime {
 
-int TerminalPositionLookupTable::getTerminalPtNodePosition(const int terminalId) const {
-    if (terminalId < 0 || terminalId >= mSize) {
-        return NOT_A_DICT_POS;
+void TerminalPositionLookupTable::readTerminalPtNodePositions() {
+    const int size = getBuffer()->getTailPosition()
+            / Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE;
+    mTerminalPtNodePositions.resize(size);
+    for (int i = 0; i < size; ++i) {
+        const int terminalPos = getBuffer()->readUint(
+                Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE, getEntryPos(i));
+        mTerminalPtNodePositions[i] = (terminalPos == Ver4DictConstants::NOT_A_TERMINAL_ADDRESS) ?
+                NOT_A_DICT_POS : terminalPos;
     }
-    const int terminalPos = getBuffer()->readUint(
-            Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE, getEntryPos(terminalId));
-    return (terminalPos == Ver4DictConstants::NOT_A_TERMINAL_ADDRESS) ?
-            NOT_A_DICT_POS : terminalPos;
 }
 
 bool TerminalPositionLookupTable::setTerminalPtNodePosition(
@@ -35,26 +37,34 @@ bool TerminalPositionLookupTable::setTerminalPtNodePosition(
     if (terminalId < 0) {
         return false;
     }
-    while (terminalId >= mSize) {
+    while (terminalId >= getNextTerminalId()) {
         // Write new entry.
         if (!getWritableBuffer()->writeUint(Ver4DictConstants::NOT_A_TERMINAL_ADDRESS,
-                Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE, getEntryPos(mSize))) {
+                Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE,
+                getEntryPos(getNextTerminalId()))) {
             return false;
         }
-        mSize++;
+        mTerminalPtNodePositions.push_back(NOT_A_DICT_POS);
     }
     const int terminalPos = (terminalPtNodePos != NOT_A_DICT_POS) ?
             terminalPtNodePos : Ver4DictConstants::NOT_A_TERMINAL_ADDRESS;
-    return getWritableBuffer()->writeUint(terminalPos,
-            Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE, getEntryPos(terminalId));
+    if (!getWritableBuffer()->writeUint(terminalPos,
+            Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE, getEntryPos(terminalId))) {
+        return false;
+    }
+    // Same as read back from the buffer.
+    mTerminalPtNodePositions[terminalId] =
+            (terminalPos == Ver4DictConstants::NOT_A_TERMINAL_ADDRESS) ?
+                    NOT_A_DICT_POS : terminalPos;
+    return true;
 }
 
 bool TerminalPositionLookupTable::flushToFile(FILE *const file) const {
     // If the used buffer size is smaller than the actual buffer size, regenerate the lookup
     // table and write the new table to the file.
-    if (getEntryPos(mSize) < getBuffer()->getTailPosition()) {
+    if (getEntryPos(getNextTerminalId()) < getBuffer()->getTailPosition()) {
         TerminalPositionLookupTable lookupTableToWrite;
-        for (int i = 0; i < mSize; ++i) {
+        for (int i = 0; i < getNextTerminalId(); ++i) {
             const int terminalPtNodePosition = getTerminalPtNodePosition(i);
             if (!lookupTableToWrite.setTerminalPtNodePosition(i, terminalPtNodePosition)) {
                 AKLOGE("Cannot set terminal position to lookupTableToWrite."
@@ -71,27 +81,25 @@ bool TerminalPositionLookupTable::flushToFile(FILE *const file) const {
 }
 
 bool TerminalPositionLookupTable::runGCTerminalIds(TerminalIdMap *const terminalIdMap) {
-    int removedEntryCount = 0;
     int nextNewTerminalId = 0;
-    for (int i = 0; i < mSize; ++i) {
-        const int terminalPos = getBuffer()->readUint(
-                Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE, getEntryPos(i));
-        if (terminalPos == Ver4DictConstants::NOT_A_TERMINAL_ADDRESS) {
+    for (int i = 0; i < getNextTerminalId(); ++i) {
+        const int terminalPtNodePos = mTerminalPtNodePositions[i];
+        if (terminalPtNodePos == NOT_A_DICT_POS) {
             // This entry is a garbage.
-            removedEntryCount++;
-        } else {
-            // Give a new terminal id to the entry.
-            if (!getWritableBuffer()->writeUint(terminalPos,
-                    Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE,
-                    getEntryPos(nextNewTerminalId))) {
-                return false;
-            }
-            // Memorize the mapping to the old terminal id to the new terminal id.
-            terminalIdMap->insert(TerminalIdMap::value_type(i, nextNewTerminalId));
-            nextNewTerminalId++;
+            continue;
+        }
+        // Give a new terminal id to the entry.
+        if (!getWritableBuffer()->writeUint(terminalPtNodePos,
+                Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE,
+                getEntryPos(nextNewTerminalId))) {
+            return false;
         }
+        mTerminalPtNodePositions[nextNewTerminalId] = terminalPtNodePos;
+        // Memorize the mapping to the old terminal id to the new terminal id.
+        terminalIdMap->insert(TerminalIdMap::value_type(i, nextNewTerminalId));
+        nextNewTerminalId++;
     }
-    mSize = nextNewTerminalId;
+    mTerminalPtNodePositions.resize(nextNewTerminalId);
     return true;
 }
 
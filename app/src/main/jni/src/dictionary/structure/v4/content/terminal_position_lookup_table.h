@@ -19,37 +19,51 @@
 
 #include <cstdio>
 #include <unordered_map>
+#include <vector>
 
 #include "defines.h"
 #include "dictionary/structure/v4/content/single_dict_content.h"
 #include "dictionary/structure/v4/ver4_dict_constants.h"
 #include "utils/byte_array_view.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 
+// The table is a 3 byte position per terminal id in the file. The positions are also kept decoded
+// in a dense array, since every word id resolution reads them; the terminal ids are dense after
+// GC.
 class TerminalPositionLookupTable : public SingleDictContent {
  public:
     typedef std::unordered_map<int, int> TerminalIdMap;
 
     TerminalPositionLookupTable(const ReadWriteByteArrayView buffer)
-            : SingleDictContent(buffer),
-              mSize(getBuffer()->getTailPosition()
-                      / Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE) {}
+            : SingleDictContent(buffer), mTerminalPtNodePositions() {
+        readTerminalPtNodePositions();
+    }
 
-    TerminalPositionLookupTable() : mSize(0) {}
+    TerminalPositionLookupTable() : mTerminalPtNodePositions() {}
 
-    int getTerminalPtNodePosition(const int terminalId) const;
+    AK_FORCE_INLINE int getTerminalPtNodePosition(const int terminalId) const {
+        if (terminalId < 0 || terminalId >= getNextTerminalId()) {
+            return NOT_A_DICT_POS;
+        }
+        return mTerminalPtNodePositions[terminalId];
+    }
 
     bool setTerminalPtNodePosition(const int terminalId, const int terminalPtNodePos);
 
     int getNextTerminalId() const {
-        return mSize;
+        return static_cast<int>(mTerminalPtNodePositions.size());
     }
 
     bool flushToFile(FILE *const file) const;
 
     bool runGCTerminalIds(TerminalIdMap *const terminalIdMap);
 
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mTerminalPtNodePositions);
+    }
+
  private:
     DISALLOW_COPY_AND_ASSIGN(TerminalPositionLookupTable);
 
@@ -57,7 +71,10 @@ class TerminalPositionLookupTable : public SingleDictContent {
         return terminalId * Ver4DictConstants::TERMINAL_ADDRESS_TABLE_ADDRESS_SIZE;
     }
 
-    int mSize;
+    void readTerminalPtNodePositions();
+
+    // NOT_A_DICT_POS for the removed terminals.
+    std::vector<int> mTerminalPtNodePositions;
 };
 } // namespace latinime
 #endif // LATINIME_TERMINAL_POSITION_LOOKUP_TABLE_H
@@ -18,7 +18,6 @@
 
 #include <cerrno>
 #include <cstring>
-#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <vector>
@@ -110,24 +109,19 @@ bool Ver4DictBuffers::flushHeaderAndDictBuffers(const char *const dictDirPath,
     FileUtils::getFilePathWithSuffix(dictPath, Ver4DictConstants::BODY_FILE_EXTENSION,
             bodyFilePathBufSize, bodyFilePath);
 
-    const int fd = open(bodyFilePath, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
-    if (fd == -1) {
-        AKLOGE("File %s cannot be opened. errno: %d", bodyFilePath, errno);
-        ASSERT(false);
-        return false;
-    }
-    FILE *const file = fdopen(fd, "wb");
+    FILE *const file = DictFileWritingUtils::openFileForWriting(bodyFilePath);
     if (!file) {
-        AKLOGE("fdopen failed for the file %s. errno: %d", bodyFilePath, errno);
-        ASSERT(false);
         return false;
     }
-
     if (!flushDictBuffers(file)) {
         fclose(file);
         return false;
     }
-    fclose(file);
+    // The existing dictionary is removed only once the files replacing it are complete.
+    if (!DictFileWritingUtils::syncAndCloseFile(file)) {
+        AKLOGE("Dictionary body file %s cannot be completed.", bodyFilePath);
+        return false;
+    }
     // Remove existing dictionary.
     if (!FileUtils::removeDirAndFiles(dictDirPath)) {
         AKLOGE("Existing directory %s cannot be removed.", dictDirPath);
@@ -180,7 +174,8 @@ Ver4DictBuffers::Ver4DictBuffers(MmappedBuffer::MmappedBufferPtr &&headerBuffer,
           mTerminalPositionLookupTable(
                   contentBuffers[Ver4DictConstants::TERMINAL_ADDRESS_LOOKUP_TABLE_BUFFER_INDEX]),
           mLanguageModelDictContent(&contentBuffers[Ver4DictConstants::LANGUAGE_MODEL_BUFFER_INDEX],
-                  mHeaderPolicy.hasHistoricalInfoOfWords()),
+                  mHeaderPolicy.hasHistoricalInfoOfWords(), mHeaderPolicy.usesNgramContextMap(),
+                  mHeaderPolicy.usesTrieMapValueLinks()),
           mShortcutDictContent(&contentBuffers[Ver4DictConstants::SHORTCUT_BUFFERS_INDEX]),
           mIsUpdatable(mDictBuffer->isUpdatable()) {}
 
@@ -188,7 +183,8 @@ Ver4DictBuffers::Ver4DictBuffers(const HeaderPolicy *const headerPolicy, const i
         : mHeaderBuffer(nullptr), mDictBuffer(nullptr), mHeaderPolicy(headerPolicy),
           mExpandableHeaderBuffer(Ver4DictConstants::MAX_DICTIONARY_SIZE),
           mExpandableTrieBuffer(maxTrieSize), mTerminalPositionLookupTable(),
-          mLanguageModelDictContent(headerPolicy->hasHistoricalInfoOfWords()),
+          mLanguageModelDictContent(headerPolicy->hasHistoricalInfoOfWords(),
+                  headerPolicy->usesNgramContextMap(), headerPolicy->usesTrieMapValueLinks()),
           mShortcutDictContent(),  mIsUpdatable(true) {}
 
 } // namespace latinime
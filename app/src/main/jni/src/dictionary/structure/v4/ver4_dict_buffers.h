@@ -55,6 +55,35 @@ class Ver4DictBuffers {
                 || mShortcutDictContent.isNearSizeLimit();
     }
 
+    AK_FORCE_INLINE bool isNearHardSizeLimit() const {
+        return mExpandableTrieBuffer.isNearHardSizeLimit()
+                || mTerminalPositionLookupTable.isNearHardSizeLimit()
+                || mLanguageModelDictContent.isNearHardSizeLimit()
+                || mShortcutDictContent.isNearHardSizeLimit();
+    }
+
+    AK_FORCE_INLINE size_t getMappedBufferSize() const {
+        return (mHeaderBuffer ? mHeaderBuffer->getReadOnlyByteArrayView().size() : 0)
+                + (mDictBuffer ? mDictBuffer->getReadOnlyByteArrayView().size() : 0);
+    }
+
+    void releaseCleanPages() const {
+        if (mHeaderBuffer) {
+            mHeaderBuffer->releaseCleanPages();
+        }
+        if (mDictBuffer) {
+            mDictBuffer->releaseCleanPages();
+        }
+    }
+
+    AK_FORCE_INLINE int getUsedAdditionalBufferSize() const {
+        return mExpandableHeaderBuffer.getUsedAdditionalBufferSize()
+                + mExpandableTrieBuffer.getUsedAdditionalBufferSize()
+                + mTerminalPositionLookupTable.getUsedAdditionalBufferSize()
+                + mLanguageModelDictContent.getUsedAdditionalBufferSize()
+                + mShortcutDictContent.getUsedAdditionalBufferSize();
+    }
+
     AK_FORCE_INLINE const HeaderPolicy *getHeaderPolicy() const {
         return &mHeaderPolicy;
     }
@@ -32,6 +32,9 @@ class Ver4DictConstants {
     static const char *const HEADER_FILE_EXTENSION;
     static const int MAX_DICTIONARY_SIZE;
     static const int MAX_DICT_EXTENDED_REGION_SIZE;
+    // The PtNode arrays of the first levels, which every lookup reads, are written together at the
+    // head of the trie by GC and migration.
+    static const int HOT_PT_NODE_ARRAY_LEVEL_COUNT;
 
     static const size_t NUM_OF_CONTENT_BUFFERS_IN_BODY_FILE;
     static const int TRIE_BUFFER_INDEX;
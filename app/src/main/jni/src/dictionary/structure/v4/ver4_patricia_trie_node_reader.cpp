@@ -23,6 +23,7 @@
 #include "dictionary/structure/v4/content/probability_entry.h"
 #include "dictionary/structure/v4/ver4_patricia_trie_reading_utils.h"
 #include "dictionary/utils/buffer_with_extendable_buffer.h"
+#include "utils/byte_array_view.h"
 #include "dictionary/utils/forgetting_curve_utils.h"
 
 namespace latinime {
@@ -36,8 +37,14 @@ const PtNodeParams Ver4PatriciaTrieNodeReader::fetchPtNodeInfoFromBufferAndProce
         ASSERT(false);
         return PtNodeParams();
     }
-    const bool usesAdditionalBuffer = mBuffer->isInAdditionalBuffer(ptNodePos);
-    const uint8_t *const dictBuf = mBuffer->getBuffer(usesAdditionalBuffer);
+    // A contiguous buffer is read without adjusting the positions.
+    const ReadOnlyByteArrayView contiguousView = mBuffer->getContiguousView();
+    const bool usesAdditionalBuffer = !contiguousView.data()
+            && mBuffer->isInAdditionalBuffer(ptNodePos);
+    const uint8_t *const dictBuf = contiguousView.data() ? contiguousView.data()
+            : mBuffer->getBuffer(usesAdditionalBuffer);
+    const int dictBufSize = contiguousView.data() ? static_cast<int>(contiguousView.size())
+            : mBuffer->getBufferSize(usesAdditionalBuffer);
     int pos = ptNodePos;
     const int headPos = ptNodePos;
     if (usesAdditionalBuffer) {
@@ -52,8 +59,8 @@ const PtNodeParams Ver4PatriciaTrieNodeReader::fetchPtNodeInfoFromBufferAndProce
             DynamicPtReadingUtils::getParentPtNodePos(parentPosOffset, headPos);
     int codePoints[MAX_WORD_LENGTH];
     // Code point table is not used for ver4 dictionaries.
-    const int codePointCount = PatriciaTrieReadingUtils::getCharsAndAdvancePosition(
-            dictBuf, flags, MAX_WORD_LENGTH, nullptr /* codePointTable */, codePoints, &pos);
+    const int codePointCount = PatriciaTrieReadingUtils::getCharsAndAdvancePosition(dictBuf,
+            dictBufSize, flags, MAX_WORD_LENGTH, nullptr /* codePointTable */, codePoints, &pos);
     int terminalIdFieldPos = NOT_A_DICT_POS;
     int terminalId = Ver4DictConstants::NOT_A_TERMINAL_ID;
     if (PatriciaTrieReadingUtils::isTerminal(flags)) {
@@ -52,6 +52,9 @@ bool Ver4PatriciaTrieNodeWriter::markPtNodeAsDeleted(
             &writingPos)) {
         return false;
     }
+    if (!toBeUpdatedPtNodeParams->isDeleted()) {
+        mDeadPtNodeSize += getPtNodeSize(toBeUpdatedPtNodeParams);
+    }
     if (toBeUpdatedPtNodeParams->isTerminal()) {
         // The PtNode is a terminal. Delete entry from the terminal position lookup table.
         return mBuffers->getMutableTerminalPositionLookupTable()->setTerminalPtNodePosition(
@@ -88,6 +91,10 @@ bool Ver4PatriciaTrieNodeWriter::markPtNodeAsMoved(
             mTrieBuffer, movedPos, toBeUpdatedPtNodeParams->getHeadPos(), &writingPos)) {
         return false;
     }
+    if (!toBeUpdatedPtNodeParams->isDeleted()) {
+        // A deleted PtNode has been counted when it was deleted.
+        mDeadPtNodeSize += getPtNodeSize(toBeUpdatedPtNodeParams);
+    }
     if (toBeUpdatedPtNodeParams->hasChildren()) {
         // Update children's parent position.
         mReadingHelper.initWithPtNodeArrayPos(toBeUpdatedPtNodeParams->getChildrenPos());
@@ -147,6 +154,46 @@ bool Ver4PatriciaTrieNodeWriter::updatePtNodeUnigramProperty(
             toBeUpdatedPtNodeParams->getTerminalId(), &probabilityEntryOfUnigramProperty);
 }
 
+bool Ver4PatriciaTrieNodeWriter::restorePtNodeAndUpdateUnigramProperty(
+        const PtNodeParams *const toBeUpdatedPtNodeParams,
+        const UnigramProperty *const unigramProperty) {
+    const int terminalId = toBeUpdatedPtNodeParams->getTerminalId();
+    if (!toBeUpdatedPtNodeParams->isTerminal() || !toBeUpdatedPtNodeParams->isDeleted()
+            || terminalId == Ver4DictConstants::NOT_A_TERMINAL_ID) {
+        return false;
+    }
+    // A deleted PtNode keeps its terminal id, and the unigram flags are in the probability entry,
+    // so only the flags of the PtNode change.
+    const ProbabilityEntry probabilityEntryOfUnigramProperty = ProbabilityEntry(unigramProperty);
+    if (!mBuffers->getMutableLanguageModelDictContent()->setProbabilityEntry(
+            terminalId, &probabilityEntryOfUnigramProperty)) {
+        return false;
+    }
+    if (!mBuffers->getMutableTerminalPositionLookupTable()->setTerminalPtNodePosition(
+            terminalId, toBeUpdatedPtNodeParams->getHeadPos())) {
+        AKLOGE("Cannot update terminal position lookup table. terminal id: %d", terminalId);
+        return false;
+    }
+    int pos = toBeUpdatedPtNodeParams->getHeadPos();
+    const bool usesAdditionalBuffer = mTrieBuffer->isInAdditionalBuffer(pos);
+    const uint8_t *const dictBuf = mTrieBuffer->getBuffer(usesAdditionalBuffer);
+    if (usesAdditionalBuffer) {
+        pos -= mTrieBuffer->getOriginalBufferSize();
+    }
+    const PatriciaTrieReadingUtils::NodeFlags originalFlags =
+            PatriciaTrieReadingUtils::getFlagsAndAdvancePosition(dictBuf, &pos);
+    const PatriciaTrieReadingUtils::NodeFlags updatedFlags =
+            DynamicPtReadingUtils::updateAndGetFlags(originalFlags, false /* isMoved */,
+                    false /* isDeleted */, false /* willBecomeNonTerminal */);
+    int writingPos = toBeUpdatedPtNodeParams->getHeadPos();
+    if (!DynamicPtWritingUtils::writeFlagsAndAdvancePosition(mTrieBuffer, updatedFlags,
+            &writingPos)) {
+        return false;
+    }
+    mDeadPtNodeSize -= getPtNodeSize(toBeUpdatedPtNodeParams);
+    return true;
+}
+
 bool Ver4PatriciaTrieNodeWriter::updatePtNodeProbabilityAndGetNeedsToKeepPtNodeAfterGC(
         const PtNodeParams *const toBeUpdatedPtNodeParams, bool *const outNeedsToKeepPtNode) {
     if (!toBeUpdatedPtNodeParams->isTerminal()) {
@@ -17,6 +17,8 @@
 #ifndef LATINIME_VER4_PATRICIA_TRIE_NODE_WRITER_H
 #define LATINIME_VER4_PATRICIA_TRIE_NODE_WRITER_H
 
+#include <atomic>
+
 #include "defines.h"
 #include "dictionary/structure/pt_common/dynamic_pt_reading_helper.h"
 #include "dictionary/structure/pt_common/pt_node_params.h"
@@ -42,7 +44,8 @@ class Ver4PatriciaTrieNodeWriter : public PtNodeWriter {
             const PtNodeArrayReader *const ptNodeArrayReader,
             Ver4ShortcutListPolicy *const shortcutPolicy)
             : mTrieBuffer(trieBuffer), mBuffers(buffers),
-              mReadingHelper(ptNodeReader, ptNodeArrayReader), mShortcutPolicy(shortcutPolicy) {}
+              mReadingHelper(ptNodeReader, ptNodeArrayReader), mShortcutPolicy(shortcutPolicy),
+              mDeadPtNodeSize(0) {}
 
     virtual ~Ver4PatriciaTrieNodeWriter() {}
 
@@ -57,6 +60,10 @@ class Ver4PatriciaTrieNodeWriter : public PtNodeWriter {
     virtual bool updatePtNodeUnigramProperty(const PtNodeParams *const toBeUpdatedPtNodeParams,
             const UnigramProperty *const unigramProperty);
 
+    virtual bool restorePtNodeAndUpdateUnigramProperty(
+            const PtNodeParams *const toBeUpdatedPtNodeParams,
+            const UnigramProperty *const unigramProperty);
+
     virtual bool updatePtNodeProbabilityAndGetNeedsToKeepPtNodeAfterGC(
             const PtNodeParams *const toBeUpdatedPtNodeParams, bool *const outNeedsToKeepPtNode);
 
@@ -88,6 +95,19 @@ class Ver4PatriciaTrieNodeWriter : public PtNodeWriter {
             const int *const targetCodePoints, const int targetCodePointCount,
             const int shortcutProbability);
 
+    // Returns the size in the trie buffer of the PtNode, which is written by this class.
+    static int getPtNodeSize(const PtNodeParams *const ptNodeParams) {
+        return ptNodeParams->getChildrenPosFieldPos() + CHILDREN_POSITION_FIELD_SIZE
+                - ptNodeParams->getHeadPos();
+    }
+
+    // Returns the size of the PtNodes marked as moved or deleted by this writer minus the size of
+    // the PtNodes it restored, i.e. how much garbage it has added to the trie. This is negative
+    // when it restored PtNodes deleted before it was created.
+    int getDeadPtNodeSize() const {
+        return mDeadPtNodeSize.load(std::memory_order_relaxed);
+    }
+
  private:
     DISALLOW_COPY_AND_ASSIGN(Ver4PatriciaTrieNodeWriter);
 
@@ -103,6 +123,8 @@ class Ver4PatriciaTrieNodeWriter : public PtNodeWriter {
     Ver4DictBuffers *const mBuffers;
     DynamicPtReadingHelper mReadingHelper;
     Ver4ShortcutListPolicy *const mShortcutPolicy;
+    // Only changed by the updates, but read by needsToRunGC(), which can run concurrently.
+    std::atomic<int> mDeadPtNodeSize;
 };
 } // namespace latinime
 #endif /* LATINIME_VER4_PATRICIA_TRIE_NODE_WRITER_H */
@@ -16,6 +16,7 @@
 
 #include "dictionary/structure/v4/ver4_patricia_trie_policy.h"
 
+#include <algorithm>
 #include <array>
 #include <vector>
 
@@ -31,6 +32,7 @@
 #include "dictionary/utils/forgetting_curve_utils.h"
 #include "dictionary/utils/multi_bigram_map.h"
 #include "dictionary/utils/probability_utils.h"
+#include "utils/memory_usage.h"
 #include "utils/ngram_utils.h"
 
 namespace latinime {
@@ -41,15 +43,31 @@ const char *const Ver4PatriciaTriePolicy::UNIGRAM_COUNT_QUERY = "UNIGRAM_COUNT";
 const char *const Ver4PatriciaTriePolicy::BIGRAM_COUNT_QUERY = "BIGRAM_COUNT";
 const char *const Ver4PatriciaTriePolicy::MAX_UNIGRAM_COUNT_QUERY = "MAX_UNIGRAM_COUNT";
 const char *const Ver4PatriciaTriePolicy::MAX_BIGRAM_COUNT_QUERY = "MAX_BIGRAM_COUNT";
+const char *const Ver4PatriciaTriePolicy::TRIE_FRAGMENTATION_QUERY = "TRIE_FRAGMENTATION";
 const int Ver4PatriciaTriePolicy::MARGIN_TO_REFUSE_DYNAMIC_OPERATIONS = 1024;
 const int Ver4PatriciaTriePolicy::MIN_DICT_SIZE_TO_REFUSE_DYNAMIC_OPERATIONS =
         Ver4DictConstants::MAX_DICTIONARY_SIZE - MARGIN_TO_REFUSE_DYNAMIC_OPERATIONS;
+const float Ver4PatriciaTriePolicy::MIN_TRIE_FRAGMENTATION_RATIO_TO_RUN_GC = 0.5f;
+const int Ver4PatriciaTriePolicy::MIN_RECLAIMABLE_TRIE_SIZE_TO_RUN_GC = 64 * 1024;
 
 void Ver4PatriciaTriePolicy::createAndGetAllChildDicNodes(const DicNode *const dicNode,
         DicNodeVector *const childDicNodes) const {
     if (!dicNode->hasChildren()) {
         return;
     }
+    int cachedPtNodeCount = 0;
+    const std::vector<int> *cachedCodePoints = nullptr;
+    const Ver4TopLevelPtNodeCache::PtNode *const cachedPtNodes =
+            mTopLevelPtNodeCache.getPtNodes(dicNode->getChildrenPtNodeArrayPos(),
+                    dicNode->getNodeCodePointCount(), &cachedPtNodeCount, &cachedCodePoints);
+    if (cachedPtNodes) {
+        for (int i = 0; i < cachedPtNodeCount; ++i) {
+            const Ver4TopLevelPtNodeCache::PtNode &ptNode = cachedPtNodes[i];
+            childDicNodes->pushLeavingChild(dicNode, ptNode.mChildrenPos, ptNode.mWordId,
+                    ptNode.getCodePointArrayView(*cachedCodePoints));
+        }
+        return;
+    }
     DynamicPtReadingHelper readingHelper(&mNodeReader, &mPtNodeArrayReader);
     readingHelper.initWithPtNodeArrayPos(dicNode->getChildrenPtNodeArrayPos());
     while (!readingHelper.isEnd()) {
@@ -140,6 +158,7 @@ void Ver4PatriciaTriePolicy::iterateNgramEntries(const WordIdArrayView prevWordI
         return;
     }
     const auto languageModelDictContent = mBuffers->getLanguageModelDictContent();
+    NgramListener::Batch batch(listener);
     for (size_t i = 1; i <= prevWordIds.size(); ++i) {
         for (const auto& entry : languageModelDictContent->getProbabilityEntries(
                 prevWordIds.limit(i))) {
@@ -157,7 +176,7 @@ void Ver4PatriciaTriePolicy::iterateNgramEntries(const WordIdArrayView prevWordI
             } else {
                 probability = probabilityEntry.getProbability();
             }
-            listener->onVisitEntry(probability, entry.getWordId());
+            batch.add(probability, entry.getWordId());
         }
     }
 }
@@ -166,6 +185,11 @@ int Ver4PatriciaTriePolicy::getShortcutPositionOfWord(const int wordId) const {
     if (wordId == NOT_A_WORD_ID) {
         return NOT_A_DICT_POS;
     }
+    // The word id is the terminal id, so the words without shortcuts, which are most of them,
+    // are found in the shortcut lookup table without reading the PtNode.
+    if (mBuffers->getShortcutDictContent()->getShortcutListHeadPos(wordId) == NOT_A_DICT_POS) {
+        return NOT_A_DICT_POS;
+    }
     const int ptNodePos =
             mBuffers->getTerminalPositionLookupTable()->getTerminalPtNodePosition(wordId);
     const PtNodeParams ptNodeParams(mNodeReader.fetchPtNodeParamsInBufferFromPtNodePos(ptNodePos));
@@ -218,30 +242,84 @@ bool Ver4PatriciaTriePolicy::addUnigramEntry(const CodePointArrayView wordCodePo
         if (addedNewUnigram && !unigramProperty->representsBeginningOfSentence()) {
             mEntryCounters.incrementNgramCount(NgramType::Unigram);
         }
-        if (unigramProperty->getShortcuts().size() > 0) {
-            // Add shortcut target.
-            const int wordId = getWordId(codePointArrayView, false /* forceLowerCaseSearch */);
-            if (wordId == NOT_A_WORD_ID) {
-                AKLOGE("Cannot find word id to add shortcut target.");
-                return false;
-            }
-            const int wordPos =
-                    mBuffers->getTerminalPositionLookupTable()->getTerminalPtNodePosition(wordId);
-            for (const auto &shortcut : unigramProperty->getShortcuts()) {
-                if (!mUpdatingHelper.addShortcutTarget(wordPos,
-                        CodePointArrayView(*shortcut.getTargetCodePoints()),
-                        shortcut.getProbability())) {
-                    AKLOGE("Cannot add new shortcut target. PtNodePos: %d, length: %zd, "
-                            "probability: %d", wordPos, shortcut.getTargetCodePoints()->size(),
-                            shortcut.getProbability());
-                    return false;
-                }
+        return addShortcutTargets(codePointArrayView, unigramProperty);
+    } else {
+        return false;
+    }
+}
+
+bool Ver4PatriciaTriePolicy::addUnigramEntries(
+        const std::vector<CodePointArrayView> &wordCodePoints,
+        const std::vector<UnigramProperty> &unigramProperties) {
+    if (!mBuffers->isUpdatable()) {
+        AKLOGI("Warning: addUnigramEntries() is called for non-updatable dictionary.");
+        return false;
+    }
+    bool addedAllEntries = true;
+    DynamicPtReadingHelper readingHelper(&mNodeReader, &mPtNodeArrayReader);
+    readingHelper.initWithPtNodeArrayPos(getRootPosition());
+    if (!readingHelper.isEnd() || readingHelper.isError()) {
+        // The entries have to be merged into the existing trie.
+        for (size_t i = 0; i < wordCodePoints.size(); ++i) {
+            if (!addUnigramEntry(wordCodePoints[i], &unigramProperties[i])) {
+                addedAllEntries = false;
             }
         }
-        return true;
-    } else {
+        return addedAllEntries;
+    }
+    // The trie is empty, so it can be written at once from the sorted words. Beginning-of-sentence
+    // entries and the entries to be rejected are left to addUnigramEntry().
+    std::vector<size_t> sortedIndices;
+    std::vector<size_t> remainingIndices;
+    for (size_t i = 0; i < wordCodePoints.size(); ++i) {
+        bool hasTooLongShortcutTarget = false;
+        for (const auto &shortcut : unigramProperties[i].getShortcuts()) {
+            hasTooLongShortcutTarget |= shortcut.getTargetCodePoints()->size() > MAX_WORD_LENGTH;
+        }
+        if (unigramProperties[i].representsBeginningOfSentence() || wordCodePoints[i].empty()
+                || wordCodePoints[i].size() > MAX_WORD_LENGTH || hasTooLongShortcutTarget) {
+            remainingIndices.push_back(i);
+        } else {
+            sortedIndices.push_back(i);
+        }
+    }
+    std::stable_sort(sortedIndices.begin(), sortedIndices.end(),
+            [&wordCodePoints](const size_t left, const size_t right) {
+                return std::lexicographical_compare(wordCodePoints[left].begin(),
+                        wordCodePoints[left].end(), wordCodePoints[right].begin(),
+                        wordCodePoints[right].end());
+            });
+    std::vector<CodePointArrayView> sortedWordCodePoints;
+    std::vector<const UnigramProperty *> sortedUnigramProperties;
+    for (const size_t index : sortedIndices) {
+        const CodePointArrayView word = wordCodePoints[index];
+        if (!sortedWordCodePoints.empty() && sortedWordCodePoints.back().size() == word.size()
+                && std::equal(word.begin(), word.end(), sortedWordCodePoints.back().begin())) {
+            // The last one wins as when the entries are added one by one.
+            sortedUnigramProperties.back() = &unigramProperties[index];
+            continue;
+        }
+        sortedWordCodePoints.push_back(word);
+        sortedUnigramProperties.push_back(&unigramProperties[index]);
+    }
+    if (!mUpdatingHelper.addUnigramWordsToEmptyTrie(&readingHelper, sortedWordCodePoints,
+            sortedUnigramProperties)) {
+        AKLOGE("Cannot write %zd unigram entries to the empty dictionary.",
+                sortedWordCodePoints.size());
         return false;
     }
+    for (size_t i = 0; i < sortedWordCodePoints.size(); ++i) {
+        mEntryCounters.incrementNgramCount(NgramType::Unigram);
+        if (!addShortcutTargets(sortedWordCodePoints[i], sortedUnigramProperties[i])) {
+            addedAllEntries = false;
+        }
+    }
+    for (const size_t index : remainingIndices) {
+        if (!addUnigramEntry(wordCodePoints[index], &unigramProperties[index])) {
+            addedAllEntries = false;
+        }
+    }
+    return addedAllEntries;
 }
 
 bool Ver4PatriciaTriePolicy::removeUnigramEntry(const CodePointArrayView wordCodePoints) {
@@ -458,24 +536,63 @@ bool Ver4PatriciaTriePolicy::needsToRunGC(const bool mindsBlockByGC) const {
         AKLOGI("Warning: needsToRunGC() is called for non-updatable dictionary.");
         return false;
     }
-    if (mBuffers->isNearSizeLimit()) {
-        // Additional buffer size is near the limit.
+    if (mBuffers->isNearHardSizeLimit()) {
+        // Additional buffer size is near the hard limit, where writing fails.
+        return true;
+    } else if (!mindsBlockByGC && mBuffers->isNearSizeLimit()) {
+        // Additional buffer size is near the soft limit. Writing still succeeds, so GC only runs
+        // when it doesn't block updates, e.g. in the background.
         return true;
     } else if (mHeaderPolicy->getExtendedRegionSize() + mDictBuffer->getUsedAdditionalBufferSize()
             > Ver4DictConstants::MAX_DICT_EXTENDED_REGION_SIZE) {
         // Total extended region size of the trie exceeds the limit.
         return true;
     } else if (mDictBuffer->getTailPosition() >= MIN_DICT_SIZE_TO_REFUSE_DYNAMIC_OPERATIONS
-            && mDictBuffer->getUsedAdditionalBufferSize() > 0) {
-        // Needs to reduce dictionary size.
+            && mDictBuffer->getUsedAdditionalBufferSize() > 0
+            && (mHeaderPolicy->isDecayingDict() || mDictBuffer->getTailPosition()
+                    - getReclaimableTrieSize() < MIN_DICT_SIZE_TO_REFUSE_DYNAMIC_OPERATIONS)) {
+        // Needs to reduce dictionary size. Without decay, GC only reclaims the moved and deleted
+        // PtNodes, so it is useless when they don't bring the size back under the limit.
+        return true;
+    } else if (mHeaderPolicy->isDecayingDict()
+            && ForgettingCurveUtils::needsToDecay(mindsBlockByGC, mEntryCounters.getEntryCounts(),
+                    mHeaderPolicy)) {
+        return true;
+    } else if (!mindsBlockByGC
+            && getTrieFragmentationRatio() >= MIN_TRIE_FRAGMENTATION_RATIO_TO_RUN_GC
+            && getReclaimableTrieSize() >= MIN_RECLAIMABLE_TRIE_SIZE_TO_RUN_GC) {
+        // Most of the trie is moved or deleted PtNodes.
         return true;
-    } else if (mHeaderPolicy->isDecayingDict()) {
-        return ForgettingCurveUtils::needsToDecay(mindsBlockByGC, mEntryCounters.getEntryCounts(),
-                mHeaderPolicy);
     }
     return false;
 }
 
+int Ver4PatriciaTriePolicy::getReclaimableTrieSize() const {
+    return std::max(mReclaimableTrieSizeAtOpen + mNodeWriter.getDeadPtNodeSize(), 0);
+}
+
+int Ver4PatriciaTriePolicy::scanReclaimableTrieSize() const {
+    if (!mBuffers->isUpdatable()) {
+        // GC never runs on the dictionary.
+        return 0;
+    }
+    const int validTrieSize = mWritingHelper.getTrieSizeForValidPtNodes(getRootPosition());
+    if (validTrieSize == NOT_A_DICT_POS) {
+        AKLOGE("Cannot traverse the trie to get the reclaimable trie size.");
+        mIsCorrupted = true;
+        return 0;
+    }
+    return std::max(mDictBuffer->getTailPosition() - validTrieSize, 0);
+}
+
+float Ver4PatriciaTriePolicy::getTrieFragmentationRatio() const {
+    const int trieSize = mDictBuffer->getTailPosition();
+    if (trieSize <= 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(getReclaimableTrieSize()) / static_cast<float>(trieSize);
+}
+
 void Ver4PatriciaTriePolicy::getProperty(const char *const query, const int queryLength,
         char *const outResult, const int maxResultLength) {
     const int compareLength = queryLength + 1 /* terminator */;
@@ -498,6 +615,8 @@ void Ver4PatriciaTriePolicy::getProperty(const char *const query, const int quer
                                 mHeaderPolicy->getMaxNgramCounts().getNgramCount(
                                         NgramType::Bigram)) :
                         static_cast<int>(Ver4DictConstants::MAX_DICTIONARY_SIZE));
+    } else if (strncmp(query, TRIE_FRAGMENTATION_QUERY, compareLength) == 0) {
+        snprintf(outResult, maxResultLength, "%.3f", getTrieFragmentationRatio());
     }
 }
 
@@ -570,8 +689,11 @@ const WordProperty Ver4PatriciaTriePolicy::getWordProperty(
 }
 
 int Ver4PatriciaTriePolicy::getNextWordAndNextToken(const int token, int *const outCodePoints,
-        int *const outCodePointCount) {
+        int *const outCodePointCount, int *const outWordId) {
     *outCodePointCount = 0;
+    if (outWordId) {
+        *outWordId = NOT_A_WORD_ID;
+    }
     if (token == 0) {
         mTerminalPtNodePositionsForIteratingWords.clear();
         DynamicPtReadingHelper::TraversePolicyToGetAllTerminalPtNodePositions traversePolicy(
@@ -591,6 +713,9 @@ int Ver4PatriciaTriePolicy::getNextWordAndNextToken(const int token, int *const
             mNodeReader.fetchPtNodeParamsInBufferFromPtNodePos(terminalPtNodePos);
     *outCodePointCount = getCodePointsAndReturnCodePointCount(ptNodeParams.getTerminalId(),
             MAX_WORD_LENGTH, outCodePoints);
+    if (outWordId) {
+        *outWordId = ptNodeParams.getTerminalId();
+    }
     const int nextToken = token + 1;
     if (nextToken >= terminalPtNodePositionsVectorSize) {
         // All words have been iterated.
@@ -600,4 +725,41 @@ int Ver4PatriciaTriePolicy::getNextWordAndNextToken(const int token, int *const
     return nextToken;
 }
 
+bool Ver4PatriciaTriePolicy::addShortcutTargets(const CodePointArrayView wordCodePoints,
+        const UnigramProperty *const unigramProperty) {
+    if (unigramProperty->getShortcuts().empty()) {
+        return true;
+    }
+    const int wordId = getWordId(wordCodePoints, false /* forceLowerCaseSearch */);
+    if (wordId == NOT_A_WORD_ID) {
+        AKLOGE("Cannot find word id to add shortcut target.");
+        return false;
+    }
+    const int wordPos =
+            mBuffers->getTerminalPositionLookupTable()->getTerminalPtNodePosition(wordId);
+    for (const auto &shortcut : unigramProperty->getShortcuts()) {
+        if (!mUpdatingHelper.addShortcutTarget(wordPos,
+                CodePointArrayView(*shortcut.getTargetCodePoints()),
+                shortcut.getProbability())) {
+            AKLOGE("Cannot add new shortcut target. PtNodePos: %d, length: %zd, "
+                    "probability: %d", wordPos, shortcut.getTargetCodePoints()->size(),
+                    shortcut.getProbability());
+            return false;
+        }
+    }
+    return true;
+}
+
+void Ver4PatriciaTriePolicy::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    outMemoryUsage->add(MemoryUsage::MAPPED_FILE_BYTES,
+            static_cast<int64_t>(mBuffers->getMappedBufferSize()));
+    outMemoryUsage->add(MemoryUsage::ADDITIONAL_BUFFER_BYTES,
+            mBuffers->getUsedAdditionalBufferSize());
+    outMemoryUsage->add(MemoryUsage::HEAP_BYTES,
+            static_cast<int64_t>(sizeof(*this) + sizeof(*mBuffers)));
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mTerminalPtNodePositionsForIteratingWords);
+    mBuffers->getTerminalPositionLookupTable()->addMemoryUsage(outMemoryUsage);
+    mTopLevelPtNodeCache.addMemoryUsage(outMemoryUsage);
+}
+
 } // namespace latinime
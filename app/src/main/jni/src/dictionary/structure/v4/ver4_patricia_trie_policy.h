@@ -17,6 +17,7 @@
 #ifndef LATINIME_VER4_PATRICIA_TRIE_POLICY_H
 #define LATINIME_VER4_PATRICIA_TRIE_POLICY_H
 
+#include <atomic>
 #include <vector>
 
 #include "defines.h"
@@ -29,6 +30,7 @@
 #include "dictionary/structure/v4/ver4_patricia_trie_node_writer.h"
 #include "dictionary/structure/v4/ver4_patricia_trie_writing_helper.h"
 #include "dictionary/structure/v4/ver4_pt_node_array_reader.h"
+#include "dictionary/structure/v4/ver4_top_level_pt_node_cache.h"
 #include "dictionary/utils/buffer_with_extendable_buffer.h"
 #include "dictionary/utils/entry_counters.h"
 #include "utils/int_array_view.h"
@@ -52,7 +54,9 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
               mUpdatingHelper(mDictBuffer, &mNodeReader, &mNodeWriter),
               mWritingHelper(mBuffers.get()),
               mEntryCounters(mHeaderPolicy->getNgramCounts().getCountArray()),
-              mTerminalPtNodePositionsForIteratingWords(), mIsCorrupted(false) {};
+              mTerminalPtNodePositionsForIteratingWords(), mIsCorrupted(false),
+              mTopLevelPtNodeCache(mDictBuffer, &mNodeReader, &mPtNodeArrayReader),
+              mReclaimableTrieSizeAtOpen(scanReclaimableTrieSize()) {};
 
     AK_FORCE_INLINE int getRootPosition() const {
         return 0;
@@ -61,6 +65,12 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     void createAndGetAllChildDicNodes(const DicNode *const dicNode,
             DicNodeVector *const childDicNodes) const;
 
+    void prefetchPtNodeArray(const int ptNodeArrayPos) const {
+        if (ptNodeArrayPos >= 0 && ptNodeArrayPos < mDictBuffer->getTailPosition()) {
+            mDictBuffer->prefetch(ptNodeArrayPos);
+        }
+    }
+
     int getCodePointsAndReturnCodePointCount(const int wordId, const int maxCodePointCount,
             int *const outCodePoints) const;
 
@@ -69,6 +79,12 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     const WordAttributes getWordAttributesInContext(const WordIdArrayView prevWordIds,
             const int wordId, MultiBigramMap *const multiBigramMap) const;
 
+    bool getMaxProbabilityOfExactMatches(const CodePointArrayView codePoints,
+            int *const outProbability) const {
+        // The words change with the updates.
+        return false;
+    }
+
     // TODO: Remove
     int getProbability(const int unigramProbability, const int bigramProbability) const {
         // Not used.
@@ -89,6 +105,9 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     bool addUnigramEntry(const CodePointArrayView wordCodePoints,
             const UnigramProperty *const unigramProperty);
 
+    bool addUnigramEntries(const std::vector<CodePointArrayView> &wordCodePoints,
+            const std::vector<UnigramProperty> &unigramProperties);
+
     bool removeUnigramEntry(const CodePointArrayView wordCodePoints);
 
     bool addNgramEntry(const NgramProperty *const ngramProperty);
@@ -112,12 +131,27 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     const WordProperty getWordProperty(const CodePointArrayView wordCodePoints) const;
 
     int getNextWordAndNextToken(const int token, int *const outCodePoints,
-            int *const outCodePointCount);
+            int *const outCodePointCount, int *const outWordId);
 
     bool isCorrupted() const {
         return mIsCorrupted;
     }
 
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+
+    void releaseCleanPages() const {
+        mBuffers->releaseCleanPages();
+    }
+
+    // Returns the size of the trie that GC would reclaim without removing any word, i.e. the size
+    // of the moved and deleted PtNodes. The trie is traversed when the policy is created, and the
+    // node writer then counts the PtNodes it moves, deletes and restores, so this doesn't traverse
+    // the trie and can run concurrently with the updates.
+    int getReclaimableTrieSize() const;
+
+    // Returns the ratio of the reclaimable trie size to the trie size.
+    float getTrieFragmentationRatio() const;
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(Ver4PatriciaTriePolicy);
 
@@ -125,10 +159,15 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     static const char *const BIGRAM_COUNT_QUERY;
     static const char *const MAX_UNIGRAM_COUNT_QUERY;
     static const char *const MAX_BIGRAM_COUNT_QUERY;
+    static const char *const TRIE_FRAGMENTATION_QUERY;
     // When the dictionary size is near the maximum size, we have to refuse dynamic operations to
     // prevent the dictionary from overflowing.
     static const int MARGIN_TO_REFUSE_DYNAMIC_OPERATIONS;
     static const int MIN_DICT_SIZE_TO_REFUSE_DYNAMIC_OPERATIONS;
+    // GC rewrites the whole dictionary, so trie fragmentation alone only triggers it when both of
+    // these are reached.
+    static const float MIN_TRIE_FRAGMENTATION_RATIO_TO_RUN_GC;
+    static const int MIN_RECLAIMABLE_TRIE_SIZE_TO_RUN_GC;
 
     const Ver4DictBuffers::Ver4DictBuffersPtr mBuffers;
     const HeaderPolicy *const mHeaderPolicy;
@@ -141,9 +180,17 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     Ver4PatriciaTrieWritingHelper mWritingHelper;
     MutableEntryCounters mEntryCounters;
     std::vector<int> mTerminalPtNodePositionsForIteratingWords;
-    mutable bool mIsCorrupted;
+    // Set from the reading methods, which can run concurrently.
+    mutable std::atomic<bool> mIsCorrupted;
+    mutable Ver4TopLevelPtNodeCache mTopLevelPtNodeCache;
+    // Set before any reader or writer uses the policy.
+    const int mReclaimableTrieSizeAtOpen;
 
+    int scanReclaimableTrieSize() const;
     int getShortcutPositionOfWord(const int wordId) const;
+
+    bool addShortcutTargets(const CodePointArrayView wordCodePoints,
+            const UnigramProperty *const unigramProperty);
 };
 } // namespace latinime
 #endif // LATINIME_VER4_PATRICIA_TRIE_POLICY_H
@@ -18,6 +18,8 @@
 
 #include <cstring>
 #include <queue>
+#include <thread>
+#include <vector>
 
 #include "dictionary/header/header_policy.h"
 #include "dictionary/structure/v4/shortcut/ver4_shortcut_list_policy.h"
@@ -33,6 +35,8 @@
 
 namespace latinime {
 
+const int Ver4PatriciaTrieWritingHelper::FORWARD_LINK_FIELD_SIZE = 3;
+
 bool Ver4PatriciaTrieWritingHelper::writeToDictFile(const char *const dictDirPath,
         const EntryCounts &entryCounts) const {
     const HeaderPolicy *const headerPolicy = mBuffers->getHeaderPolicy();
@@ -72,6 +76,54 @@ bool Ver4PatriciaTrieWritingHelper::writeToDictFileWithGC(const int rootPtNodeAr
     return dictBuffers->flushHeaderAndDictBuffers(dictDirPath, &headerBuffer);
 }
 
+int Ver4PatriciaTrieWritingHelper::getTrieSizeForValidPtNodes(
+        const int rootPtNodeArrayPos) const {
+    const BufferWithExtendableBuffer *const trieBuffer = mBuffers->getTrieBuffer();
+    const Ver4PatriciaTrieNodeReader ptNodeReader(trieBuffer);
+    const Ver4PtNodeArrayReader ptNodeArrayReader(trieBuffer);
+    // Every PtNode takes at least a byte, so reading more PtNodes than the trie size means that
+    // the trie is broken.
+    const int maxPtNodeCount = trieBuffer->getTailPosition();
+    int ptNodeCount = 0;
+    int trieSize = 0;
+    std::vector<int> ptNodeArrayPositions(1 /* count */, rootPtNodeArrayPos);
+    while (!ptNodeArrayPositions.empty()) {
+        int ptNodeArrayPos = ptNodeArrayPositions.back();
+        ptNodeArrayPositions.pop_back();
+        // Follows the forward links. GC merges the linked PtNode arrays, but their fields are
+        // counted as in use like the node writer does, which only tracks PtNodes.
+        while (ptNodeArrayPos != NOT_A_DICT_POS) {
+            int ptNodeCountInArray = 0;
+            int ptNodePos = NOT_A_DICT_POS;
+            if (!ptNodeArrayReader.readPtNodeArrayInfoAndReturnIfValid(ptNodeArrayPos,
+                    &ptNodeCountInArray, &ptNodePos)) {
+                return NOT_A_DICT_POS;
+            }
+            trieSize += ptNodePos - ptNodeArrayPos;
+            for (int i = 0; i < ptNodeCountInArray; ++i) {
+                // Moved PtNodes are read at their new position.
+                const PtNodeParams ptNodeParams =
+                        ptNodeReader.fetchPtNodeParamsInBufferFromPtNodePos(ptNodePos);
+                if (!ptNodeParams.isValid() || ++ptNodeCount > maxPtNodeCount) {
+                    return NOT_A_DICT_POS;
+                }
+                if (!ptNodeParams.isDeleted()) {
+                    trieSize += Ver4PatriciaTrieNodeWriter::getPtNodeSize(&ptNodeParams);
+                }
+                if (ptNodeParams.hasChildren()) {
+                    ptNodeArrayPositions.push_back(ptNodeParams.getChildrenPos());
+                }
+                ptNodePos = ptNodeParams.getSiblingNodePos();
+            }
+            trieSize += FORWARD_LINK_FIELD_SIZE;
+            if (!ptNodeArrayReader.readForwardLinkAndReturnIfValid(ptNodePos, &ptNodeArrayPos)) {
+                return NOT_A_DICT_POS;
+            }
+        }
+    }
+    return trieSize;
+}
+
 bool Ver4PatriciaTrieWritingHelper::runGC(const int rootPtNodeArrayPos,
         const HeaderPolicy *const headerPolicy, Ver4DictBuffers *const buffersToWrite,
         MutableEntryCounters *const outEntryCounters) {
@@ -116,7 +168,8 @@ bool Ver4PatriciaTrieWritingHelper::runGC(const int rootPtNodeArrayPos,
     DynamicPtGcEventListeners::TraversePolicyToPlaceAndWriteValidPtNodesToBuffer
             traversePolicyToPlaceAndWriteValidPtNodesToBuffer(&ptNodeWriterForNewBuffers,
                     buffersToWrite->getWritableTrieBuffer(), &dictPositionRelocationMap);
-    if (!readingHelper.traverseAllPtNodesInPtNodeArrayLevelPreorderDepthFirstManner(
+    if (!readingHelper.traverseAllPtNodesInPtNodeArrayLevelHotLevelsFirstManner(
+            Ver4DictConstants::HOT_PT_NODE_ARRAY_LEVEL_COUNT,
             &traversePolicyToPlaceAndWriteValidPtNodesToBuffer)) {
         return false;
     }
@@ -135,27 +188,44 @@ bool Ver4PatriciaTrieWritingHelper::runGC(const int rootPtNodeArrayPos,
             &terminalIdMap)) {
         return false;
     }
-    // Run GC for language model dict content.
-    if (!buffersToWrite->getMutableLanguageModelDictContent()->runGC(&terminalIdMap,
-            mBuffers->getLanguageModelDictContent())) {
-        return false;
-    }
+    // The language model dict content is the largest to remap. It only shares the terminal id
+    // map and the original buffers, which are read-only here, with the rest of GC, so it runs
+    // on a worker thread while the shortcut dict content and the trie are updated.
+    bool hasLanguageModelGCSucceeded = false;
+    std::thread languageModelGCThread([&]() {
+        hasLanguageModelGCSucceeded = buffersToWrite->getMutableLanguageModelDictContent()->runGC(
+                &terminalIdMap, mBuffers->getLanguageModelDictContent());
+    });
+    const bool hasTrieGCSucceeded = runGCForShortcutsAndTrie(rootPtNodeArrayPos, &terminalIdMap,
+            &dictPositionRelocationMap, buffersToWrite, &newPtNodeReader, &newPtNodeArrayreader,
+            &newPtNodeWriter);
+    languageModelGCThread.join();
+    return hasLanguageModelGCSucceeded && hasTrieGCSucceeded;
+}
+
+bool Ver4PatriciaTrieWritingHelper::runGCForShortcutsAndTrie(const int rootPtNodeArrayPos,
+        const TerminalPositionLookupTable::TerminalIdMap *const terminalIdMap,
+        const PtNodeWriter::DictPositionRelocationMap *const dictPositionRelocationMap,
+        Ver4DictBuffers *const buffersToWrite,
+        const Ver4PatriciaTrieNodeReader *const newPtNodeReader,
+        const Ver4PtNodeArrayReader *const newPtNodeArrayReader,
+        Ver4PatriciaTrieNodeWriter *const newPtNodeWriter) const {
     // Run GC for shortcut dict content.
-    if(!buffersToWrite->getMutableShortcutDictContent()->runGC(&terminalIdMap,
+    if(!buffersToWrite->getMutableShortcutDictContent()->runGC(terminalIdMap,
             mBuffers->getShortcutDictContent())) {
         return false;
     }
-    DynamicPtReadingHelper newDictReadingHelper(&newPtNodeReader, &newPtNodeArrayreader);
+    DynamicPtReadingHelper newDictReadingHelper(newPtNodeReader, newPtNodeArrayReader);
     newDictReadingHelper.initWithPtNodeArrayPos(rootPtNodeArrayPos);
     DynamicPtGcEventListeners::TraversePolicyToUpdateAllPositionFields
-            traversePolicyToUpdateAllPositionFields(&newPtNodeWriter, &dictPositionRelocationMap);
+            traversePolicyToUpdateAllPositionFields(newPtNodeWriter, dictPositionRelocationMap);
     if (!newDictReadingHelper.traverseAllPtNodesInPtNodeArrayLevelPreorderDepthFirstManner(
             &traversePolicyToUpdateAllPositionFields)) {
         return false;
     }
     newDictReadingHelper.initWithPtNodeArrayPos(rootPtNodeArrayPos);
     TraversePolicyToUpdateAllPtNodeFlagsAndTerminalIds
-            traversePolicyToUpdateAllPtNodeFlagsAndTerminalIds(&newPtNodeWriter, &terminalIdMap);
+            traversePolicyToUpdateAllPtNodeFlagsAndTerminalIds(newPtNodeWriter, terminalIdMap);
     if (!newDictReadingHelper.traverseAllPtNodesInPostorderDepthFirstManner(
             &traversePolicyToUpdateAllPtNodeFlagsAndTerminalIds)) {
         return false;
@@ -28,6 +28,7 @@ class HeaderPolicy;
 class Ver4DictBuffers;
 class Ver4PatriciaTrieNodeReader;
 class Ver4PatriciaTrieNodeWriter;
+class Ver4PtNodeArrayReader;
 
 class Ver4PatriciaTrieWritingHelper {
  public:
@@ -40,9 +41,15 @@ class Ver4PatriciaTrieWritingHelper {
     // useless PtNodes during GC.
     bool writeToDictFileWithGC(const int rootPtNodeArrayPos, const char *const dictDirPath);
 
+    // Returns the size of the trie without the moved and deleted PtNodes, or NOT_A_DICT_POS when
+    // the trie cannot be read.
+    int getTrieSizeForValidPtNodes(const int rootPtNodeArrayPos) const;
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(Ver4PatriciaTrieWritingHelper);
 
+    static const int FORWARD_LINK_FIELD_SIZE;
+
     class TraversePolicyToUpdateAllPtNodeFlagsAndTerminalIds
             : public DynamicPtReadingHelper::TraversingEventListener {
      public:
@@ -69,6 +76,16 @@ class Ver4PatriciaTrieWritingHelper {
     bool runGC(const int rootPtNodeArrayPos, const HeaderPolicy *const headerPolicy,
             Ver4DictBuffers *const buffersToWrite, MutableEntryCounters *const outEntryCounters);
 
+    // Runs the part of GC after the terminal ids have been reassigned, except for the language
+    // model dict content.
+    bool runGCForShortcutsAndTrie(const int rootPtNodeArrayPos,
+            const TerminalPositionLookupTable::TerminalIdMap *const terminalIdMap,
+            const PtNodeWriter::DictPositionRelocationMap *const dictPositionRelocationMap,
+            Ver4DictBuffers *const buffersToWrite,
+            const Ver4PatriciaTrieNodeReader *const newPtNodeReader,
+            const Ver4PtNodeArrayReader *const newPtNodeArrayReader,
+            Ver4PatriciaTrieNodeWriter *const newPtNodeWriter) const;
+
     Ver4DictBuffers *const mBuffers;
 };
 } // namespace latinime
@@ -19,6 +19,7 @@
 #include "dictionary/structure/pt_common/dynamic_pt_reading_utils.h"
 #include "dictionary/structure/pt_common/patricia_trie_reading_utils.h"
 #include "dictionary/utils/buffer_with_extendable_buffer.h"
+#include "utils/byte_array_view.h"
 
 namespace latinime {
 
@@ -31,8 +32,12 @@ bool Ver4PtNodeArrayReader::readPtNodeArrayInfoAndReturnIfValid(const int ptNode
         ASSERT(false);
         return false;
     }
-    const bool usesAdditionalBuffer = mBuffer->isInAdditionalBuffer(ptNodeArrayPos);
-    const uint8_t *const dictBuf = mBuffer->getBuffer(usesAdditionalBuffer);
+    // A contiguous buffer is read without adjusting the positions.
+    const ReadOnlyByteArrayView contiguousView = mBuffer->getContiguousView();
+    const bool usesAdditionalBuffer = !contiguousView.data()
+            && mBuffer->isInAdditionalBuffer(ptNodeArrayPos);
+    const uint8_t *const dictBuf = contiguousView.data() ? contiguousView.data()
+            : mBuffer->getBuffer(usesAdditionalBuffer);
     int readingPos = ptNodeArrayPos;
     if (usesAdditionalBuffer) {
         readingPos -= mBuffer->getOriginalBufferSize();
@@ -60,8 +65,12 @@ bool Ver4PtNodeArrayReader::readForwardLinkAndReturnIfValid(const int forwordLin
         ASSERT(false);
         return false;
     }
-    const bool usesAdditionalBuffer = mBuffer->isInAdditionalBuffer(forwordLinkPos);
-    const uint8_t *const dictBuf = mBuffer->getBuffer(usesAdditionalBuffer);
+    // A contiguous buffer is read without adjusting the positions.
+    const ReadOnlyByteArrayView contiguousView = mBuffer->getContiguousView();
+    const bool usesAdditionalBuffer = !contiguousView.data()
+            && mBuffer->isInAdditionalBuffer(forwordLinkPos);
+    const uint8_t *const dictBuf = contiguousView.data() ? contiguousView.data()
+            : mBuffer->getBuffer(usesAdditionalBuffer);
     int readingPos = forwordLinkPos;
     if (usesAdditionalBuffer) {
         readingPos -= mBuffer->getOriginalBufferSize();
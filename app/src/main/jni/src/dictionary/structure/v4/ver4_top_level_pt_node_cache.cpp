@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v4/ver4_top_level_pt_node_cache.h"
+
+#include <queue>
+#include <utility>
+
+#include "dictionary/structure/pt_common/dynamic_pt_reading_helper.h"
+#include "dictionary/utils/buffer_with_extendable_buffer.h"
+
+namespace latinime {
+
+// The root PtNode array and the arrays below the first two letters, i.e. what is expanded for
+// the first keys of every word.
+const int Ver4TopLevelPtNodeCache::MAX_CACHED_DEPTH = 3;
+// A few thousand PtNodes make the top levels of main dictionaries. This keeps the cache at a few
+// hundred KB for large dictionaries.
+const int Ver4TopLevelPtNodeCache::MAX_CACHED_PT_NODE_COUNT = 16 * 1024;
+
+const Ver4TopLevelPtNodeCache::PtNode *Ver4TopLevelPtNodeCache::getPtNodes(
+        const int ptNodeArrayPos, const int depth, int *const outPtNodeCount,
+        const std::vector<int> **const outCodePoints) {
+    if (depth >= MAX_CACHED_DEPTH) {
+        return nullptr;
+    }
+    if (!isValid()) {
+        std::unique_lock<std::mutex> lock(mBuildMutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            // Being built by another thread.
+            return nullptr;
+        }
+        if (!isValid()) {
+            build();
+        }
+    }
+    const auto it = mPtNodeRanges.find(ptNodeArrayPos);
+    if (it == mPtNodeRanges.end()) {
+        return nullptr;
+    }
+    *outPtNodeCount = it->second.mPtNodeCount;
+    *outCodePoints = &mCodePoints;
+    return mPtNodes.data() + it->second.mFirstPtNodeIndex;
+}
+
+bool Ver4TopLevelPtNodeCache::isValid() const {
+    return mBuiltWriteCount.load(std::memory_order_acquire)
+            == static_cast<int64_t>(mBuffer->getWriteCount());
+}
+
+void Ver4TopLevelPtNodeCache::build() {
+    mPtNodeRanges.clear();
+    mPtNodes.clear();
+    mCodePoints.clear();
+    // The PtNode arrays are cached in the breadth-first order, so that the cache keeps the
+    // shallowest ones when the PtNode count limit is reached.
+    std::queue<std::pair<int /* ptNodeArrayPos */, int /* depth */>> ptNodeArrays;
+    ptNodeArrays.emplace(0 /* rootPos */, 0 /* depth */);
+    while (!ptNodeArrays.empty()) {
+        const int ptNodeArrayPos = ptNodeArrays.front().first;
+        const int depth = ptNodeArrays.front().second;
+        ptNodeArrays.pop();
+        if (mPtNodeRanges.count(ptNodeArrayPos) > 0) {
+            continue;
+        }
+        const int firstPtNodeIndex = static_cast<int>(mPtNodes.size());
+        const int firstCodePointIndex = static_cast<int>(mCodePoints.size());
+        if (!readPtNodeArray(ptNodeArrayPos)) {
+            AKLOGE("Dictionary reading error while building the top level PtNode cache.");
+            mPtNodeRanges.clear();
+            mPtNodes.clear();
+            mCodePoints.clear();
+            break;
+        }
+        if (static_cast<int>(mPtNodes.size()) > MAX_CACHED_PT_NODE_COUNT) {
+            mPtNodes.resize(firstPtNodeIndex);
+            mCodePoints.resize(firstCodePointIndex);
+            continue;
+        }
+        const int ptNodeCount = static_cast<int>(mPtNodes.size()) - firstPtNodeIndex;
+        mPtNodeRanges[ptNodeArrayPos] = {firstPtNodeIndex, ptNodeCount};
+        for (int i = firstPtNodeIndex; i < firstPtNodeIndex + ptNodeCount; ++i) {
+            const int childDepth = depth + mPtNodes[i].mCodePointCount;
+            if (mPtNodes[i].mChildrenPos != NOT_A_DICT_POS && childDepth < MAX_CACHED_DEPTH) {
+                ptNodeArrays.emplace(mPtNodes[i].mChildrenPos, childDepth);
+            }
+        }
+    }
+    mPtNodes.shrink_to_fit();
+    mCodePoints.shrink_to_fit();
+    mBuiltWriteCount.store(static_cast<int64_t>(mBuffer->getWriteCount()),
+            std::memory_order_release);
+}
+
+bool Ver4TopLevelPtNodeCache::readPtNodeArray(const int ptNodeArrayPos) {
+    // Same as Ver4PatriciaTriePolicy::createAndGetAllChildDicNodes().
+    DynamicPtReadingHelper readingHelper(mPtNodeReader, mPtNodeArrayReader);
+    readingHelper.initWithPtNodeArrayPos(ptNodeArrayPos);
+    while (!readingHelper.isEnd()) {
+        const PtNodeParams ptNodeParams = readingHelper.getPtNodeParams();
+        if (!ptNodeParams.isValid()) {
+            break;
+        }
+        const bool isTerminal = ptNodeParams.isTerminal() && !ptNodeParams.isDeleted();
+        const CodePointArrayView codePoints = ptNodeParams.getCodePointArrayView();
+        mPtNodes.push_back({ptNodeParams.getChildrenPos(),
+                isTerminal ? ptNodeParams.getTerminalId() : NOT_A_WORD_ID,
+                static_cast<int>(mCodePoints.size()), static_cast<int>(codePoints.size())});
+        mCodePoints.insert(mCodePoints.end(), codePoints.begin(), codePoints.end());
+        readingHelper.readNextSiblingNode(ptNodeParams);
+    }
+    return !readingHelper.isError();
+}
+
+} // namespace latinime
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_VER4_TOP_LEVEL_PT_NODE_CACHE_H
+#define LATINIME_VER4_TOP_LEVEL_PT_NODE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "defines.h"
+#include "utils/int_array_view.h"
+#include "utils/memory_usage.h"
+
+namespace latinime {
+
+class BufferWithExtendableBuffer;
+class PtNodeArrayReader;
+class PtNodeReader;
+
+// The decoded PtNodes of the PtNode arrays at the top of a ver4 trie, which are expanded for
+// every DicNode that starts a word. A PtNode array is cached when the PtNodes that lead to it
+// have fewer than MAX_CACHED_DEPTH code points, as long as the cache doesn't exceed
+// MAX_CACHED_PT_NODE_COUNT PtNodes.
+//
+// The cache is built on first use and rebuilt on the first use after the trie buffer has been
+// written, as the buffer isn't written while the dictionary is being read. Only one thread
+// builds it while the others decode the PtNodes from the buffer.
+class Ver4TopLevelPtNodeCache {
+ public:
+    struct PtNode {
+        int mChildrenPos;
+        int mWordId;
+        int mCodePointIndex;
+        int mCodePointCount;
+
+        const CodePointArrayView getCodePointArrayView(const std::vector<int> &codePoints) const {
+            return CodePointArrayView(codePoints.data() + mCodePointIndex, mCodePointCount);
+        }
+    };
+
+    Ver4TopLevelPtNodeCache(const BufferWithExtendableBuffer *const buffer,
+            const PtNodeReader *const ptNodeReader,
+            const PtNodeArrayReader *const ptNodeArrayReader)
+            : mBuffer(buffer), mPtNodeReader(ptNodeReader),
+              mPtNodeArrayReader(ptNodeArrayReader), mBuildMutex(), mBuiltWriteCount(-1),
+              mPtNodeRanges(), mPtNodes(), mCodePoints() {}
+
+    // Returns the cached child PtNodes of the PtNode array at the position, building the cache
+    // first when it is stale, or nullptr when they have to be read from the buffer. The code
+    // points of the PtNodes are in outCodePoints.
+    const PtNode *getPtNodes(const int ptNodeArrayPos, const int depth,
+            int *const outPtNodeCount, const std::vector<int> **const outCodePoints);
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mPtNodes);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mCodePoints);
+        outMemoryUsage->add(MemoryUsage::CACHE_BYTES, static_cast<int64_t>(mPtNodeRanges.size()
+                * (sizeof(int) + sizeof(PtNodeRange) + sizeof(void *) * 2)));
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(Ver4TopLevelPtNodeCache);
+
+    struct PtNodeRange {
+        int mFirstPtNodeIndex;
+        int mPtNodeCount;
+    };
+
+    static const int MAX_CACHED_DEPTH;
+    static const int MAX_CACHED_PT_NODE_COUNT;
+
+    const BufferWithExtendableBuffer *const mBuffer;
+    const PtNodeReader *const mPtNodeReader;
+    const PtNodeArrayReader *const mPtNodeArrayReader;
+    std::mutex mBuildMutex;
+    // The write count of the buffer when the cache was built, with release semantics after the
+    // cache is filled.
+    std::atomic<int64_t> mBuiltWriteCount;
+    std::unordered_map<int, PtNodeRange> mPtNodeRanges;
+    std::vector<PtNode> mPtNodes;
+    std::vector<int> mCodePoints;
+
+    bool isValid() const;
+    void build();
+    // Reads the child PtNodes of the PtNode array at the position into mPtNodes. Returns false
+    // when the trie is broken.
+    bool readPtNodeArray(const int ptNodeArrayPos);
+};
+} // namespace latinime
+#endif // LATINIME_VER4_TOP_LEVEL_PT_NODE_CACHE_H
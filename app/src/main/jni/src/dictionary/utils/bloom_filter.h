@@ -17,13 +17,17 @@
 #ifndef LATINIME_BLOOM_FILTER_H
 #define LATINIME_BLOOM_FILTER_H
 
-#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 #include "defines.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 
-// This bloom filter is used for optimizing bigram retrieval.
+// This bloom filter is used for optimizing bigram retrieval, and the lookups of words that are not
+// in ver2 dictionaries.
 // Execution times with previous word "this" are as follows:
 //  without bloom filter (use only hash_map):
 //   Total 147792.34 (sum of others 147771.57)
@@ -31,39 +35,78 @@ namespace latinime {
 //   Total 145900.64 (sum of others 145874.30)
 //  always read binary dictionary:
 //   Total 148603.14 (sum of others 148579.90)
+//
+// The filter is blocked: the HASH_COUNT bits of an element are in one 64-bit word, so a test
+// touches a single cache line. The filter has to be sized with reset() for the number of
+// elements that will be set, as contexts in user histories can have thousands of n-grams.
 class BloomFilter {
  public:
-    BloomFilter() : mFilter() {}
+    // Sized for DEFAULT_ELEMENT_COUNT elements.
+    BloomFilter() : mBlocks(), mBlockIndexMask(0) {
+        reset(DEFAULT_ELEMENT_COUNT);
+    }
+
+    // Clears the filter and sizes it for elementCount elements.
+    void reset(const size_t elementCount) {
+        // The number of blocks is a power of 2 so that the block index can be masked.
+        size_t blockCount = 1;
+        while (blockCount * BITS_PER_BLOCK < elementCount * BITS_PER_ELEMENT) {
+            blockCount *= 2;
+        }
+        mBlocks.assign(blockCount, 0);
+        mBlockIndexMask = blockCount - 1;
+    }
 
     AK_FORCE_INLINE void setInFilter(const int position) {
-        mFilter.set(getIndex(position));
+        const uint64_t hash = getHash(position);
+        mBlocks[getBlockIndex(hash)] |= getBitsInBlock(hash);
     }
 
     AK_FORCE_INLINE bool isInFilter(const int position) const {
-        return mFilter.test(getIndex(position));
+        const uint64_t hash = getHash(position);
+        const uint64_t bits = getBitsInBlock(hash);
+        return (mBlocks[getBlockIndex(hash)] & bits) == bits;
+    }
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mBlocks);
     }
 
  private:
     DISALLOW_ASSIGNMENT_OPERATOR(BloomFilter);
 
-    AK_FORCE_INLINE size_t getIndex(const int position) const {
-        return static_cast<size_t>(position) % BIGRAM_FILTER_MODULO;
+    // The probability of false positive is about (1 - e ** (-kn/m))**k, where k is the number of
+    // hash functions, n the number of elements, and m the number of bits. With k = 3 and at
+    // least 10 bits per element it is below 2%; blocking costs a bit more than that.
+    static const int HASH_COUNT = 3;
+    static const size_t BITS_PER_ELEMENT = 10;
+    static const size_t BITS_PER_BLOCK = 64;
+    // At the moment 100 is the maximum number of bigrams for a word with the current main
+    // dictionaries.
+    static const size_t DEFAULT_ELEMENT_COUNT = 100;
+
+    static AK_FORCE_INLINE uint64_t getHash(const int position) {
+        // Multiplicative hash. Only its upper bits are well mixed, so the lower 22 bits are not
+        // used.
+        return static_cast<uint64_t>(static_cast<uint32_t>(position)) * 0x9E3779B97F4A7C15ull;
     }
 
-    // Size, in bits, of the bloom filter index for bigrams
-    // The probability of false positive is (1 - e ** (-kn/m))**k,
-    // where k is the number of hash functions, n the number of bigrams, and m the number of
-    // bits we can test.
-    // At the moment 100 is the maximum number of bigrams for a word with the current main
-    // dictionaries, so n = 100. 1024 buckets give us m = 1024.
-    // With 1 hash function, our false positive rate is about 9.3%, which should be enough for
-    // our uses since we are only using this to increase average performance. For the record,
-    // k = 2 gives 3.1% and k = 3 gives 1.6%. With k = 1, making m = 2048 gives 4.8%,
-    // and m = 4096 gives 2.4%.
-    // This is assigned here because it is used for bitset size.
-    // 1021 is the largest prime under 1024.
-    static const size_t BIGRAM_FILTER_MODULO = 1021;
-    std::bitset<BIGRAM_FILTER_MODULO> mFilter;
+    AK_FORCE_INLINE size_t getBlockIndex(const uint64_t hash) const {
+        return static_cast<size_t>(hash >> 40) & mBlockIndexMask;
+    }
+
+    // The bit positions of the HASH_COUNT hashes are taken from 6-bit slices of the hash below the
+    // bits of the block index.
+    static AK_FORCE_INLINE uint64_t getBitsInBlock(const uint64_t hash) {
+        uint64_t bits = 0;
+        for (int i = 0; i < HASH_COUNT; ++i) {
+            bits |= 1ull << ((hash >> (i * 6 + 22)) & (BITS_PER_BLOCK - 1));
+        }
+        return bits;
+    }
+
+    std::vector<uint64_t> mBlocks;
+    size_t mBlockIndexMask;
 };
 } // namespace latinime
 #endif // LATINIME_BLOOM_FILTER_H
@@ -16,17 +16,20 @@
 
 #include "dictionary/utils/buffer_with_extendable_buffer.h"
 
+#include <cerrno>
+#include <sys/mman.h>
+#include <unistd.h>
+
 namespace latinime {
 
 const size_t BufferWithExtendableBuffer::DEFAULT_MAX_ADDITIONAL_BUFFER_SIZE = 1024 * 1024;
 const int BufferWithExtendableBuffer::NEAR_BUFFER_LIMIT_THRESHOLD_PERCENTILE = 90;
-// TODO: Needs to allocate larger memory corresponding to the current vector size.
-const size_t BufferWithExtendableBuffer::EXTEND_ADDITIONAL_BUFFER_SIZE_STEP = 128 * 1024;
+const size_t BufferWithExtendableBuffer::HARD_SIZE_LIMIT_FACTOR = 2;
 
-uint32_t BufferWithExtendableBuffer::readUint(const int size, const int pos) const {
-    const bool readingPosIsInAdditionalBuffer = isInAdditionalBuffer(pos);
-    const int posInBuffer = readingPosIsInAdditionalBuffer ? pos - mOriginalBuffer.size() : pos;
-    return ByteArrayUtils::readUint(getBuffer(readingPosIsInAdditionalBuffer), size, posInBuffer);
+BufferWithExtendableBuffer::~BufferWithExtendableBuffer() {
+    if (mAdditionalBuffer && munmap(mAdditionalBuffer, mReservedAdditionalBufferSize) != 0) {
+        AKLOGE("DICT: Failure in munmap. errno=%d", errno);
+    }
 }
 
 uint32_t BufferWithExtendableBuffer::readUintAndAdvancePosition(const int size,
@@ -44,7 +47,8 @@ void BufferWithExtendableBuffer::readCodePointsAndAdvancePosition(const int maxC
     }
     // Code point table is not used for dynamic format.
     *outCodePointCount = ByteArrayUtils::readStringAndAdvancePosition(
-            getBuffer(readingPosIsInAdditionalBuffer), maxCodePointCount,
+            getBuffer(readingPosIsInAdditionalBuffer),
+            getBufferSize(readingPosIsInAdditionalBuffer), maxCodePointCount,
             nullptr /* codePointTable */, outCodePoints, pos);
     if (readingPosIsInAdditionalBuffer) {
         *pos += mOriginalBuffer.size();
@@ -72,7 +76,7 @@ bool BufferWithExtendableBuffer::writeUintAndAdvancePosition(const uint32_t data
     }
     const bool usesAdditionalBuffer = isInAdditionalBuffer(*pos);
     uint8_t *const buffer =
-            usesAdditionalBuffer ? mAdditionalBuffer.data() : mOriginalBuffer.data();
+            usesAdditionalBuffer ? mAdditionalBuffer : mOriginalBuffer.data();
     if (usesAdditionalBuffer) {
         *pos -= mOriginalBuffer.size();
     }
@@ -92,7 +96,7 @@ bool BufferWithExtendableBuffer::writeCodePointsAndAdvancePosition(const int *co
     }
     const bool usesAdditionalBuffer = isInAdditionalBuffer(*pos);
     uint8_t *const buffer =
-            usesAdditionalBuffer ? mAdditionalBuffer.data() : mOriginalBuffer.data();
+            usesAdditionalBuffer ? mAdditionalBuffer : mOriginalBuffer.data();
     if (usesAdditionalBuffer) {
         *pos -= mOriginalBuffer.size();
     }
@@ -104,14 +108,20 @@ bool BufferWithExtendableBuffer::writeCodePointsAndAdvancePosition(const int *co
     return true;
 }
 
-bool BufferWithExtendableBuffer::extendBuffer(const size_t size) {
-    const size_t extendSize = std::max(EXTEND_ADDITIONAL_BUFFER_SIZE_STEP, size);
-    const size_t sizeAfterExtending =
-            std::min(mAdditionalBuffer.size() + extendSize, mMaxAdditionalBufferSize);
-    if (sizeAfterExtending < mAdditionalBuffer.size() + size) {
+bool BufferWithExtendableBuffer::reserveAdditionalBuffer() {
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t reservedSize =
+            (mHardMaxAdditionalBufferSize + pageSize - 1) / pageSize * pageSize;
+    // Pages of an anonymous mapping are only backed by memory once they are written.
+    void *const additionalBuffer = mmap(nullptr, reservedSize, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1 /* fd */, 0 /* offset */);
+    if (additionalBuffer == MAP_FAILED) {
+        AKLOGE("DICT: Can't reserve the additional buffer. size=%zu errno=%d", reservedSize,
+                errno);
         return false;
     }
-    mAdditionalBuffer.resize(sizeAfterExtending);
+    mAdditionalBuffer = static_cast<uint8_t *>(additionalBuffer);
+    mReservedAdditionalBufferSize = reservedSize;
     return true;
 }
 
@@ -120,6 +130,7 @@ bool BufferWithExtendableBuffer::checkAndPrepareWriting(const int pos, const int
         // Invalid position or size.
         return false;
     }
+    ++mWriteCount;
     const size_t totalRequiredSize = static_cast<size_t>(pos + size);
     if (!isInAdditionalBuffer(pos)) {
         // Here don't need to care about the additional buffer.
@@ -140,10 +151,11 @@ bool BufferWithExtendableBuffer::checkAndPrepareWriting(const int pos, const int
         // The additional buffer must be extended from the tail position.
         return false;
     }
-    const size_t extendSize = totalRequiredSize -
-            std::min(mAdditionalBuffer.size() + mOriginalBuffer.size(), totalRequiredSize);
-    if (extendSize > 0 && !extendBuffer(extendSize)) {
-        // Failed to extend the buffer.
+    if (totalRequiredSize - mOriginalBuffer.size() > mHardMaxAdditionalBufferSize) {
+        // Violate the hard size limit.
+        return false;
+    }
+    if (!mAdditionalBuffer && !reserveAdditionalBuffer()) {
         return false;
     }
     mUsedAdditionalBufferSize += size;
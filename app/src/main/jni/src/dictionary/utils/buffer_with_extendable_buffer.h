@@ -19,7 +19,6 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <vector>
 
 #include "defines.h"
 #include "dictionary/utils/byte_array_utils.h"
@@ -31,19 +30,30 @@ namespace latinime {
 // To optimize performance, raw pointer is directly used for reading buffer. The position has to be
 // adjusted to access additional buffer. On the other hand, this class does not provide writable
 // raw pointer but provides several methods that handle boundary checking for writing data.
+// The additional buffer is a mapping that is reserved up to the hard size limit when it is first
+// written and backed by memory as it is written, so growing it doesn't move or copy it. Writes
+// succeed beyond the soft size limit, which only reports that GC should run.
 class BufferWithExtendableBuffer {
  public:
     static const size_t DEFAULT_MAX_ADDITIONAL_BUFFER_SIZE;
 
+    // maxAdditionalBufferSize is the soft size limit of the additional buffer.
     BufferWithExtendableBuffer(const ReadWriteByteArrayView originalBuffer,
             const int maxAdditionalBufferSize)
-            : mOriginalBuffer(originalBuffer), mAdditionalBuffer(), mUsedAdditionalBufferSize(0),
-              mMaxAdditionalBufferSize(maxAdditionalBufferSize) {}
+            : mOriginalBuffer(originalBuffer), mAdditionalBuffer(nullptr),
+              mReservedAdditionalBufferSize(0), mUsedAdditionalBufferSize(0),
+              mMaxAdditionalBufferSize(maxAdditionalBufferSize),
+              mHardMaxAdditionalBufferSize(mMaxAdditionalBufferSize * HARD_SIZE_LIMIT_FACTOR),
+              mWriteCount(0) {}
 
     // Without original buffer.
     BufferWithExtendableBuffer(const int maxAdditionalBufferSize)
-            : mOriginalBuffer(), mAdditionalBuffer(), mUsedAdditionalBufferSize(0),
-              mMaxAdditionalBufferSize(maxAdditionalBufferSize) {}
+            : mOriginalBuffer(), mAdditionalBuffer(nullptr), mReservedAdditionalBufferSize(0),
+              mUsedAdditionalBufferSize(0), mMaxAdditionalBufferSize(maxAdditionalBufferSize),
+              mHardMaxAdditionalBufferSize(mMaxAdditionalBufferSize * HARD_SIZE_LIMIT_FACTOR),
+              mWriteCount(0) {}
+
+    ~BufferWithExtendableBuffer();
 
     AK_FORCE_INLINE int getTailPosition() const {
         return mOriginalBuffer.size() + mUsedAdditionalBufferSize;
@@ -53,6 +63,12 @@ class BufferWithExtendableBuffer {
         return mUsedAdditionalBufferSize;
     }
 
+    // Changes on every write, so that what is decoded from the buffer can be cached until the
+    // buffer is written again.
+    AK_FORCE_INLINE uint32_t getWriteCount() const {
+        return mWriteCount;
+    }
+
     /**
      * For reading.
      */
@@ -60,17 +76,59 @@ class BufferWithExtendableBuffer {
         return position >= static_cast<int>(mOriginalBuffer.size());
     }
 
-    // TODO: Resolve the issue that the address can be changed when the vector is resized.
     // CAVEAT!: Be careful about array out of bound access with buffers
     AK_FORCE_INLINE const uint8_t *getBuffer(const bool usesAdditionalBuffer) const {
         if (usesAdditionalBuffer) {
-            return mAdditionalBuffer.data();
+            return mAdditionalBuffer;
         } else {
             return mOriginalBuffer.data();
         }
     }
 
-    uint32_t readUint(const int size, const int pos) const;
+    // The size of the written region of the buffer returned by getBuffer().
+    AK_FORCE_INLINE int getBufferSize(const bool usesAdditionalBuffer) const {
+        return usesAdditionalBuffer ? mUsedAdditionalBufferSize
+                : static_cast<int>(mOriginalBuffer.size());
+    }
+
+    // Returns the whole written region when it is in one buffer, which is the case after GC and
+    // for dictionaries that only live in memory. Returns an empty view when the region spans both
+    // buffers. The view doesn't cover what is written afterwards.
+    AK_FORCE_INLINE const ReadOnlyByteArrayView getContiguousView() const {
+        if (mUsedAdditionalBufferSize == 0) {
+            return mOriginalBuffer.getReadOnlyView();
+        }
+        if (mOriginalBuffer.size() == 0) {
+            return ReadOnlyByteArrayView(mAdditionalBuffer, mUsedAdditionalBufferSize);
+        }
+        return ReadOnlyByteArrayView();
+    }
+
+    AK_FORCE_INLINE uint32_t readUint(const int size, const int pos) const {
+        const bool readingPosIsInAdditionalBuffer = isInAdditionalBuffer(pos);
+        const int posInBuffer = readingPosIsInAdditionalBuffer
+                ? pos - mOriginalBuffer.size() : pos;
+        return ByteArrayUtils::readUint(getBuffer(readingPosIsInAdditionalBuffer), size,
+                posInBuffer);
+    }
+
+    // Returns the address of the size bytes at pos, or nullptr when they span both buffers.
+    AK_FORCE_INLINE const uint8_t *getContiguousBytes(const int pos, const int size) const {
+        if (isInAdditionalBuffer(pos)) {
+            return mAdditionalBuffer + (pos - mOriginalBuffer.size());
+        }
+        if (pos + size > static_cast<int>(mOriginalBuffer.size())) {
+            return nullptr;
+        }
+        return mOriginalBuffer.data() + pos;
+    }
+
+    // Hints that pos is going to be read soon. pos has to be in the written region.
+    AK_FORCE_INLINE void prefetch(const int pos) const {
+        const bool isPosInAdditionalBuffer = isInAdditionalBuffer(pos);
+        __builtin_prefetch(getBuffer(isPosInAdditionalBuffer)
+                + (isPosInAdditionalBuffer ? pos - mOriginalBuffer.size() : pos));
+    }
 
     uint32_t readUintAndAdvancePosition(const int size, int *const pos) const;
 
@@ -81,8 +139,16 @@ class BufferWithExtendableBuffer {
         return mOriginalBuffer.size();
     }
 
+    // Returns whether the soft size limit is nearly reached. GC should run soon, but writing
+    // doesn't fail yet.
     AK_FORCE_INLINE bool isNearSizeLimit() const {
-        return mAdditionalBuffer.size() >= ((mMaxAdditionalBufferSize
+        return static_cast<size_t>(mUsedAdditionalBufferSize) >= ((mMaxAdditionalBufferSize
+                * NEAR_BUFFER_LIMIT_THRESHOLD_PERCENTILE) / 100);
+    }
+
+    // Returns whether the hard size limit is nearly reached, i.e. writing can fail soon.
+    AK_FORCE_INLINE bool isNearHardSizeLimit() const {
+        return static_cast<size_t>(mUsedAdditionalBufferSize) >= ((mHardMaxAdditionalBufferSize
                 * NEAR_BUFFER_LIMIT_THRESHOLD_PERCENTILE) / 100);
     }
 
@@ -107,15 +173,18 @@ class BufferWithExtendableBuffer {
     DISALLOW_COPY_AND_ASSIGN(BufferWithExtendableBuffer);
 
     static const int NEAR_BUFFER_LIMIT_THRESHOLD_PERCENTILE;
-    static const size_t EXTEND_ADDITIONAL_BUFFER_SIZE_STEP;
+    static const size_t HARD_SIZE_LIMIT_FACTOR;
 
     const ReadWriteByteArrayView mOriginalBuffer;
-    std::vector<uint8_t> mAdditionalBuffer;
+    uint8_t *mAdditionalBuffer;
+    size_t mReservedAdditionalBufferSize;
     int mUsedAdditionalBufferSize;
     const size_t mMaxAdditionalBufferSize;
+    const size_t mHardMaxAdditionalBufferSize;
+    uint32_t mWriteCount;
 
-    // Return if the buffer is successfully extended or not.
-    bool extendBuffer(const size_t size);
+    // Return if the address space for the additional buffer is successfully reserved or not.
+    bool reserveAdditionalBuffer();
 
     // Returns if it is possible to write size-bytes from pos. When pos is at the tail position of
     // the additional buffer, try extending the buffer.
@@ -17,7 +17,17 @@
 #ifndef LATINIME_BYTE_ARRAY_UTILS_H
 #define LATINIME_BYTE_ARRAY_UTILS_H
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LATINIME_BYTE_ARRAY_UTILS_USE_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LATINIME_BYTE_ARRAY_UTILS_USE_SSE2
+#endif
 
 #include "defines.h"
 
@@ -58,19 +68,33 @@ class ByteArrayUtils {
     /**
      * Integer reading
      *
-     * Each method read a corresponding size integer in a big endian manner.
+     * Each method read a corresponding size integer in a big endian manner. On little endian
+     * hosts, the bytes are loaded as one word and swapped, as compilers don't merge the byte
+     * loads.
      */
     static AK_FORCE_INLINE uint32_t readUint32(const uint8_t *const buffer, const int pos) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint32_t value;
+        memcpy(&value, buffer + pos, sizeof(value));
+        return __builtin_bswap32(value);
+#else
         return (buffer[pos] << 24) ^ (buffer[pos + 1] << 16)
                 ^ (buffer[pos + 2] << 8) ^ buffer[pos + 3];
+#endif
     }
 
     static AK_FORCE_INLINE uint32_t readUint24(const uint8_t *const buffer, const int pos) {
-        return (buffer[pos] << 16) ^ (buffer[pos + 1] << 8) ^ buffer[pos + 2];
+        return (static_cast<uint32_t>(readUint16(buffer, pos)) << 8) ^ buffer[pos + 2];
     }
 
     static AK_FORCE_INLINE uint16_t readUint16(const uint8_t *const buffer, const int pos) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint16_t value;
+        memcpy(&value, buffer + pos, sizeof(value));
+        return __builtin_bswap16(value);
+#else
         return (buffer[pos] << 8) ^ buffer[pos + 1];
+#endif
     }
 
     static AK_FORCE_INLINE uint8_t readUint8(const uint8_t *const buffer, const int pos) {
@@ -181,29 +205,61 @@ class ByteArrayUtils {
      *
      * Reads code points until the terminator is found.
      */
-    // Returns the length of the string.
-    static int readStringAndAdvancePosition(const uint8_t *const buffer,
+    // Returns the length of the string. outBuffer has to have room for maxLength code points, and
+    // the code points behind the returned length can be overwritten. bufferSize is the size of
+    // buffer, which bounds the bytes that are read in bulk.
+    static int readStringAndAdvancePosition(const uint8_t *const buffer, const int bufferSize,
             const int maxLength, const int *const codePointTable, int *const outBuffer,
             int *const pos) {
         int length = 0;
-        int codePoint = readCodePointAndAdvancePosition(buffer, codePointTable, pos);
-        while (NOT_A_CODE_POINT != codePoint && length < maxLength) {
+        while (true) {
+            if (length + ONE_BYTE_CODE_POINT_RUN_SIZE <= maxLength
+                    && bufferSize - *pos >= ONE_BYTE_CODE_POINT_RUN_SIZE) {
+                // Runs of 1 byte code points are decoded in bulk.
+                const int runLength = readOneByteCodePointRun(buffer + *pos, outBuffer + length);
+                if (codePointTable) {
+                    for (int i = length; i < length + runLength; ++i) {
+                        outBuffer[i] = codePointTable[outBuffer[i]
+                                - MINIMUM_ONE_BYTE_CHARACTER_VALUE];
+                    }
+                }
+                length += runLength;
+                *pos += runLength;
+                if (runLength == ONE_BYTE_CODE_POINT_RUN_SIZE) {
+                    continue;
+                }
+            }
+            const int codePoint = readCodePointAndAdvancePosition(buffer, codePointTable, pos);
+            if (NOT_A_CODE_POINT == codePoint || length >= maxLength) {
+                return length;
+            }
             outBuffer[length++] = codePoint;
-            codePoint = readCodePointAndAdvancePosition(buffer, codePointTable, pos);
         }
-        return length;
     }
 
-    // Advances the position and returns the length of the string.
-    static int advancePositionToBehindString(
-            const uint8_t *const buffer, const int maxLength, int *const pos) {
+    // Advances the position and returns the length of the string. bufferSize is the size of
+    // buffer.
+    static int advancePositionToBehindString(const uint8_t *const buffer, const int bufferSize,
+            const int maxLength, int *const pos) {
         int length = 0;
-        int codePoint = readCodePointAndAdvancePosition(buffer, nullptr /* codePointTable */, pos);
-        while (NOT_A_CODE_POINT != codePoint && length < maxLength) {
-            codePoint = readCodePointAndAdvancePosition(buffer, nullptr /* codePointTable */, pos);
+        while (true) {
+            if (length + ONE_BYTE_CODE_POINT_RUN_SIZE <= maxLength
+                    && bufferSize - *pos >= ONE_BYTE_CODE_POINT_RUN_SIZE) {
+                const int runLength = readOneByteCodePointRun(buffer + *pos,
+                        nullptr /* outCodePoints */);
+                length += runLength;
+                *pos += runLength;
+                if (runLength == ONE_BYTE_CODE_POINT_RUN_SIZE) {
+                    continue;
+                }
+            }
+            const int codePoint =
+                    readCodePointAndAdvancePosition(buffer, nullptr /* codePointTable */, pos);
+            if (NOT_A_CODE_POINT == codePoint || length >= maxLength) {
+                return length;
+            }
             length++;
         }
-        return length;
     }
 
     /**
@@ -259,6 +315,76 @@ class ByteArrayUtils {
     static const uint8_t MINIMUM_ONE_BYTE_CHARACTER_VALUE;
     static const uint8_t MAXIMUM_ONE_BYTE_CHARACTER_VALUE;
     static const uint8_t CHARACTER_ARRAY_TERMINATOR;
+#if defined(LATINIME_BYTE_ARRAY_UTILS_USE_NEON) || defined(LATINIME_BYTE_ARRAY_UTILS_USE_SSE2)
+    static const int ONE_BYTE_CODE_POINT_RUN_SIZE = 16;
+#else
+    static const int ONE_BYTE_CODE_POINT_RUN_SIZE = 8;
+#endif
+    // Reads ONE_BYTE_CODE_POINT_RUN_SIZE bytes at once, which all have to be in the buffer, and
+    // returns how many of them from the first one are 1 byte code points, i.e. are not the
+    // terminator or the first byte of a 3 byte code point. When outCodePoints isn't null, all the
+    // bytes are stored to it as code points.
+    static AK_FORCE_INLINE int readOneByteCodePointRun(const uint8_t *const buffer,
+            int *const outCodePoints) {
+#if defined(LATINIME_BYTE_ARRAY_UTILS_USE_NEON)
+        const uint8x16_t bytes = vld1q_u8(buffer);
+        if (outCodePoints) {
+            const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+            const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+            vst1q_s32(outCodePoints, vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))));
+            vst1q_s32(outCodePoints + 4, vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))));
+            vst1q_s32(outCodePoints + 8, vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(high))));
+            vst1q_s32(outCodePoints + 12,
+                    vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(high))));
+        }
+        const uint8x16_t isNotOneByteCodePoint =
+                vcltq_u8(bytes, vdupq_n_u8(MINIMUM_ONE_BYTE_CHARACTER_VALUE));
+        // Narrows the 0x00/0xFF bytes to a nibble each.
+        const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+                vshrn_n_u16(vreinterpretq_u16_u8(isNotOneByteCodePoint), 4)), 0);
+        return mask == 0 ? ONE_BYTE_CODE_POINT_RUN_SIZE : __builtin_ctzll(mask) / 4;
+#elif defined(LATINIME_BYTE_ARRAY_UTILS_USE_SSE2)
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer));
+        if (outCodePoints) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+            const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+            __m128i *const out = reinterpret_cast<__m128i *>(outCodePoints);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+        }
+        // There is no unsigned byte comparison, but a byte is less than 0x20 iff it equals its
+        // minimum with 0x1F.
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_min_epu8(bytes,
+                _mm_set1_epi8(static_cast<char>(MINIMUM_ONE_BYTE_CHARACTER_VALUE - 1)))));
+        return mask == 0 ? ONE_BYTE_CODE_POINT_RUN_SIZE : __builtin_ctz(mask);
+#else
+        if (outCodePoints) {
+            for (int i = 0; i < ONE_BYTE_CODE_POINT_RUN_SIZE; ++i) {
+                outCodePoints[i] = buffer[i];
+            }
+        }
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint64_t word;
+        memcpy(&word, buffer, sizeof(word));
+        // Sets the high bit of the bytes that are less than 0x20. A byte above such a byte can
+        // also be set by the borrow, so only the lowest one, which is the first one in memory,
+        // is exact.
+        const uint64_t mask = (word - 0x0101010101010101ULL * MINIMUM_ONE_BYTE_CHARACTER_VALUE)
+                & ~word & 0x8080808080808080ULL;
+        return mask == 0 ? ONE_BYTE_CODE_POINT_RUN_SIZE : __builtin_ctzll(mask) / 8;
+#else
+        int runLength = 0;
+        while (runLength < ONE_BYTE_CODE_POINT_RUN_SIZE
+                && buffer[runLength] >= MINIMUM_ONE_BYTE_CHARACTER_VALUE) {
+            ++runLength;
+        }
+        return runLength;
+#endif
+#endif
+    }
 
     static AK_FORCE_INLINE void writeUint32AndAdvancePosition(uint8_t *const buffer,
             const uint32_t data, int *const pos) {
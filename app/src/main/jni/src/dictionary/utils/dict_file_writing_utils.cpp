@@ -21,6 +21,7 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "dictionary/header/header_policy.h"
 #include "dictionary/structure/backward/v402/ver4_dict_buffers.h"
@@ -51,6 +52,7 @@ const int DictFileWritingUtils::SIZE_OF_BUFFER_SIZE_FIELD = 4;
                             filePath, localeAsCodePointVector, attributeMap, formatVersion);
         case FormatUtils::VERSION_4_ONLY_FOR_TESTING:
         case FormatUtils::VERSION_403:
+        case FormatUtils::VERSION_404:
             return createEmptyV4DictFile<Ver4DictConstants, Ver4DictBuffers,
                     Ver4DictBuffers::Ver4DictBuffersPtr>(
                             filePath, localeAsCodePointVector, attributeMap, formatVersion);
@@ -99,18 +101,36 @@ template<class DictConstants, class DictBuffers, class DictBuffersPtr>
     return writeBufferToFile(file, buffer);
 }
 
-/* static */ bool DictFileWritingUtils::flushBufferToFile(const char *const filePath,
-        const BufferWithExtendableBuffer *const buffer) {
+/* static */ FILE *DictFileWritingUtils::openFileForWriting(const char *const filePath) {
     const int fd = open(filePath, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
     if (fd == -1) {
         AKLOGE("File %s cannot be opened. errno: %d", filePath, errno);
         ASSERT(false);
-        return false;
+        return nullptr;
     }
     FILE *const file = fdopen(fd, "wb");
     if (!file) {
         AKLOGE("fdopen failed for the file %s. errno: %d", filePath, errno);
         ASSERT(false);
+        close(fd);
+        return nullptr;
+    }
+    return file;
+}
+
+/* static */ bool DictFileWritingUtils::syncAndCloseFile(FILE *const file) {
+    // Only the data and the size have to be on the storage before the rename.
+    const bool synced = fflush(file) == 0 && fdatasync(fileno(file)) == 0;
+    if (!synced) {
+        AKLOGE("The file cannot be synced. errno: %d", errno);
+    }
+    return fclose(file) == 0 && synced;
+}
+
+/* static */ bool DictFileWritingUtils::flushBufferToFile(const char *const filePath,
+        const BufferWithExtendableBuffer *const buffer) {
+    FILE *const file = openFileForWriting(filePath);
+    if (!file) {
         return false;
     }
     if (!writeBufferToFile(file, buffer)) {
@@ -121,7 +141,11 @@ template<class DictConstants, class DictBuffers, class DictBuffersPtr>
         ASSERT(false);
         return false;
     }
-    fclose(file);
+    if (!syncAndCloseFile(file)) {
+        remove(filePath);
+        AKLOGE("File %s cannot be completed.", filePath);
+        return false;
+    }
     return true;
 }
 
@@ -41,6 +41,14 @@ class DictFileWritingUtils {
     static bool writeBufferToFileTail(FILE *const file,
             const BufferWithExtendableBuffer *const buffer);
 
+    // Opens a new file to be written as a part of a dictionary. Returns nullptr on failure.
+    static FILE *openFileForWriting(const char *const filePath);
+
+    // Writes the buffered data of the file and syncs it to the storage before closing the file,
+    // so that a crash after the file has been renamed into place can't leave it truncated.
+    // Returns false when any of the data couldn't be written.
+    static bool syncAndCloseFile(FILE *const file);
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(DictFileWritingUtils);
 
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/utils/dict_migration_utils.h"
+
+#include "dictionary/header/header_policy.h"
+#include "dictionary/structure/backward/v402/ver4_dict_buffers.h"
+#include "dictionary/structure/backward/v402/ver4_patricia_trie_node_reader.h"
+#include "dictionary/structure/backward/v402/ver4_patricia_trie_policy.h"
+#include "dictionary/structure/backward/v402/ver4_pt_node_array_reader.h"
+#include "dictionary/structure/pt_common/dynamic_pt_gc_event_listeners.h"
+#include "dictionary/structure/pt_common/dynamic_pt_reading_helper.h"
+#include "dictionary/structure/pt_common/pt_node_params.h"
+#include "dictionary/structure/v4/shortcut/ver4_shortcut_list_policy.h"
+#include "dictionary/structure/v4/ver4_dict_buffers.h"
+#include "dictionary/structure/v4/ver4_dict_constants.h"
+#include "dictionary/structure/v4/ver4_patricia_trie_node_reader.h"
+#include "dictionary/structure/v4/ver4_patricia_trie_node_writer.h"
+#include "dictionary/structure/v4/ver4_patricia_trie_policy.h"
+#include "dictionary/structure/v4/ver4_pt_node_array_reader.h"
+#include "dictionary/utils/forgetting_curve_utils.h"
+#include "dictionary/utils/format_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+namespace {
+
+// Places the PtNodes of a v402 dictionary in the buffers of a v403 or v404 dictionary as the GC
+// does, and translates the probability, bigram and shortcut entries of each terminal on the way.
+// The terminal ids are kept by the v403 PtNode writer, so that they can be used as word ids for the
+// entries as they are.
+class TraversePolicyToMigrateVer402PtNodes
+        : public DynamicPtReadingHelper::TraversingEventListener {
+ public:
+    TraversePolicyToMigrateVer402PtNodes(
+            const backward::v402::Ver4PatriciaTriePolicy *const sourcePolicy,
+            const backward::v402::Ver4DictBuffers *const sourceBuffers,
+            Ver4DictBuffers *const buffersToWrite, PtNodeWriter *const ptNodeWriter,
+            Ver4ShortcutListPolicy *const shortcutPolicy,
+            PtNodeWriter::DictPositionRelocationMap *const dictPositionRelocationMap)
+            : mSourcePolicy(sourcePolicy), mSourceBuffers(sourceBuffers),
+              mBuffersToWrite(buffersToWrite), mShortcutPolicy(shortcutPolicy),
+              mPlacingPolicy(ptNodeWriter, buffersToWrite->getWritableTrieBuffer(),
+                      dictPositionRelocationMap) {}
+
+    bool onAscend() { return mPlacingPolicy.onAscend(); }
+
+    bool onDescend(const int ptNodeArrayPos) { return mPlacingPolicy.onDescend(ptNodeArrayPos); }
+
+    bool onReadingPtNodeArrayTail() { return mPlacingPolicy.onReadingPtNodeArrayTail(); }
+
+    bool onVisitingPtNode(const PtNodeParams *const ptNodeParams) {
+        if (!mPlacingPolicy.onVisitingPtNode(ptNodeParams)) {
+            return false;
+        }
+        if (ptNodeParams->isDeleted() || !ptNodeParams->isTerminal()
+                || ptNodeParams->willBecomeNonTerminal()) {
+            return true;
+        }
+        return migrateUnigram(ptNodeParams) && migrateBigrams(ptNodeParams)
+                && migrateShortcuts(ptNodeParams);
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(TraversePolicyToMigrateVer402PtNodes);
+
+    const backward::v402::Ver4PatriciaTriePolicy *const mSourcePolicy;
+    const backward::v402::Ver4DictBuffers *const mSourceBuffers;
+    Ver4DictBuffers *const mBuffersToWrite;
+    Ver4ShortcutListPolicy *const mShortcutPolicy;
+    DynamicPtGcEventListeners::TraversePolicyToPlaceAndWriteValidPtNodesToBuffer mPlacingPolicy;
+
+    bool migrateUnigram(const PtNodeParams *const ptNodeParams) {
+        const int terminalId = ptNodeParams->getTerminalId();
+        // The beginning-of-sentence entry is the one addNgramEntry() adds for the context.
+        const UnigramProperty unigramProperty = ptNodeParams->representsBeginningOfSentence()
+                ? UnigramProperty(true /* representsBeginningOfSentence */, true /* isNotAWord */,
+                        false /* isBlacklisted */, false /* isPossiblyOffensive */,
+                        MAX_PROBABILITY /* probability */, HistoricalInfo())
+                : UnigramProperty(false /* representsBeginningOfSentence */,
+                        ptNodeParams->isNotAWord(), ptNodeParams->isPossiblyOffensive(),
+                        ptNodeParams->getProbability(),
+                        *mSourceBuffers->getProbabilityDictContent()->getProbabilityEntry(
+                                terminalId).getHistoricalInfo());
+        const ProbabilityEntry probabilityEntry(&unigramProperty);
+        if (!mBuffersToWrite->getMutableLanguageModelDictContent()->setProbabilityEntry(
+                terminalId, &probabilityEntry)) {
+            AKLOGE("Cannot migrate the unigram entry. terminalId: %d", terminalId);
+            return false;
+        }
+        return true;
+    }
+
+    bool migrateBigrams(const PtNodeParams *const ptNodeParams) {
+        const int terminalId = ptNodeParams->getTerminalId();
+        int readingPos = mSourceBuffers->getBigramDictContent()->getBigramListHeadPos(terminalId);
+        if (readingPos == NOT_A_DICT_POS) {
+            return true;
+        }
+        const HeaderPolicy *const sourceHeaderPolicy = mSourceBuffers->getHeaderPolicy();
+        const bool hasHistoricalInfo =
+                mBuffersToWrite->getHeaderPolicy()->hasHistoricalInfoOfWords();
+        bool hasNext = true;
+        while (hasNext) {
+            const backward::v402::BigramEntry bigramEntry =
+                    mSourceBuffers->getBigramDictContent()->getBigramEntryAndAdvancePosition(
+                            &readingPos);
+            hasNext = bigramEntry.hasNext();
+            const int targetTerminalId = bigramEntry.getTargetTerminalId();
+            if (mSourceBuffers->getTerminalPositionLookupTable()->getTerminalPtNodePosition(
+                    targetTerminalId) == NOT_A_DICT_POS) {
+                continue;
+            }
+            // Same as the n-gram properties the source policy gives for the entries.
+            const int rawBigramProbability = bigramEntry.hasHistoricalInfo()
+                    ? ForgettingCurveUtils::decodeProbability(bigramEntry.getHistoricalInfo(),
+                            sourceHeaderPolicy)
+                    : bigramEntry.getProbability();
+            const int probability = mSourcePolicy->getBigramConditionalProbability(
+                    ptNodeParams->getProbability(),
+                    ptNodeParams->representsBeginningOfSentence(), rawBigramProbability);
+            const ProbabilityEntry probabilityEntry = hasHistoricalInfo
+                    ? ProbabilityEntry(0 /* flags */, bigramEntry.getHistoricalInfo())
+                    : ProbabilityEntry(0 /* flags */, probability);
+            if (!mBuffersToWrite->getMutableLanguageModelDictContent()->setNgramProbabilityEntry(
+                    WordIdArrayView::singleElementView(&terminalId), targetTerminalId,
+                    &probabilityEntry)) {
+                AKLOGE("Cannot migrate the bigram entry. terminalId: %d -> %d", terminalId,
+                        targetTerminalId);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool migrateShortcuts(const PtNodeParams *const ptNodeParams) {
+        const int terminalId = ptNodeParams->getTerminalId();
+        int readingPos =
+                mSourceBuffers->getShortcutDictContent()->getShortcutListHeadPos(terminalId);
+        if (readingPos == NOT_A_DICT_POS) {
+            return true;
+        }
+        int shortcutTarget[MAX_WORD_LENGTH];
+        bool hasNext = true;
+        while (hasNext) {
+            int shortcutTargetLength = 0;
+            int shortcutProbability = NOT_A_PROBABILITY;
+            mSourceBuffers->getShortcutDictContent()->getShortcutEntryAndAdvancePosition(
+                    MAX_WORD_LENGTH, shortcutTarget, &shortcutTargetLength, &shortcutProbability,
+                    &hasNext, &readingPos);
+            if (!mShortcutPolicy->addNewShortcut(terminalId, shortcutTarget, shortcutTargetLength,
+                    shortcutProbability)) {
+                AKLOGE("Cannot migrate the shortcut entry. terminalId: %d", terminalId);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+/* static */ bool DictMigrationUtils::canMigrate(
+        const DictionaryStructureWithBufferPolicy *const sourcePolicy,
+        const int newFormatVersion) {
+    const FormatUtils::FORMAT_VERSION formatVersion =
+            FormatUtils::getFormatVersion(newFormatVersion);
+    return sourcePolicy->getHeaderStructurePolicy()->getFormatVersionNumber()
+                    == FormatUtils::VERSION_402
+            && (formatVersion == FormatUtils::VERSION_403
+                    || formatVersion == FormatUtils::VERSION_404);
+}
+
+/* static */ DictionaryStructureWithBufferPolicy::StructurePolicyPtr DictMigrationUtils::migrate(
+        const DictionaryStructureWithBufferPolicy *const sourcePolicy,
+        const int newFormatVersion) {
+    // canMigrate() only accepts v402 dictionaries for now.
+    return migrateVer402ToVer4(sourcePolicy, FormatUtils::getFormatVersion(newFormatVersion));
+}
+
+/* static */ DictionaryStructureWithBufferPolicy::StructurePolicyPtr
+        DictMigrationUtils::migrateVer402ToVer4(
+                const DictionaryStructureWithBufferPolicy *const sourcePolicy,
+                const FormatUtils::FORMAT_VERSION newFormatVersion) {
+    const backward::v402::Ver4PatriciaTriePolicy *const ver402Policy =
+            static_cast<const backward::v402::Ver4PatriciaTriePolicy *>(sourcePolicy);
+    const backward::v402::Ver4DictBuffers *const sourceBuffers = ver402Policy->getDictBuffers();
+    const HeaderPolicy *const sourceHeaderPolicy = sourceBuffers->getHeaderPolicy();
+    HeaderPolicy headerPolicy(newFormatVersion, *sourceHeaderPolicy->getLocale(),
+            sourceHeaderPolicy->getAttributeMap());
+    Ver4DictBuffers::Ver4DictBuffersPtr buffersToWrite = Ver4DictBuffers::createVer4DictBuffers(
+            &headerPolicy, Ver4DictConstants::MAX_DICTIONARY_SIZE);
+
+    backward::v402::Ver4PatriciaTrieNodeReader sourcePtNodeReader(
+            sourceBuffers->getTrieBuffer(), sourceBuffers->getProbabilityDictContent(),
+            sourceHeaderPolicy);
+    backward::v402::Ver4PtNodeArrayReader sourcePtNodeArrayReader(sourceBuffers->getTrieBuffer());
+    Ver4ShortcutListPolicy shortcutPolicy(buffersToWrite->getMutableShortcutDictContent(),
+            buffersToWrite->getTerminalPositionLookupTable());
+    Ver4PatriciaTrieNodeWriter ptNodeWriter(buffersToWrite->getWritableTrieBuffer(),
+            buffersToWrite.get(), &sourcePtNodeReader, &sourcePtNodeArrayReader, &shortcutPolicy);
+
+    // Mapping from positions in the source trie to positions in the new one.
+    PtNodeWriter::DictPositionRelocationMap dictPositionRelocationMap;
+    DynamicPtReadingHelper readingHelper(&sourcePtNodeReader, &sourcePtNodeArrayReader);
+    readingHelper.initWithPtNodeArrayPos(sourcePolicy->getRootPosition());
+    TraversePolicyToMigrateVer402PtNodes traversePolicyToMigrateVer402PtNodes(ver402Policy,
+            sourceBuffers, buffersToWrite.get(), &ptNodeWriter, &shortcutPolicy,
+            &dictPositionRelocationMap);
+    if (!readingHelper.traverseAllPtNodesInPtNodeArrayLevelHotLevelsFirstManner(
+            Ver4DictConstants::HOT_PT_NODE_ARRAY_LEVEL_COUNT,
+            &traversePolicyToMigrateVer402PtNodes)) {
+        AKLOGE("Cannot migrate PtNodes.");
+        return nullptr;
+    }
+
+    Ver4PatriciaTrieNodeReader newPtNodeReader(buffersToWrite->getTrieBuffer());
+    Ver4PtNodeArrayReader newPtNodeArrayReader(buffersToWrite->getTrieBuffer());
+    Ver4PatriciaTrieNodeWriter newPtNodeWriter(buffersToWrite->getWritableTrieBuffer(),
+            buffersToWrite.get(), &newPtNodeReader, &newPtNodeArrayReader, &shortcutPolicy);
+    DynamicPtReadingHelper newDictReadingHelper(&newPtNodeReader, &newPtNodeArrayReader);
+    newDictReadingHelper.initWithPtNodeArrayPos(0 /* rootPos */);
+    DynamicPtGcEventListeners::TraversePolicyToUpdateAllPositionFields
+            traversePolicyToUpdateAllPositionFields(&newPtNodeWriter, &dictPositionRelocationMap);
+    if (!newDictReadingHelper.traverseAllPtNodesInPtNodeArrayLevelPreorderDepthFirstManner(
+            &traversePolicyToUpdateAllPositionFields)) {
+        AKLOGE("Cannot update the positions of migrated PtNodes.");
+        return nullptr;
+    }
+    return DictionaryStructureWithBufferPolicy::StructurePolicyPtr(
+            new Ver4PatriciaTriePolicy(std::move(buffersToWrite)));
+}
+
+} // namespace latinime
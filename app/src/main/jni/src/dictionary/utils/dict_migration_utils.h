@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_DICT_MIGRATION_UTILS_H
+#define LATINIME_DICT_MIGRATION_UTILS_H
+
+#include "defines.h"
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "dictionary/utils/format_utils.h"
+
+namespace latinime {
+
+// Migrates dictionaries to a newer format by translating their structures directly, instead of
+// adding every word and n-gram of the dictionary to an empty one. The PtNode arrays are copied in
+// one traversal of the trie as the GC lays them out, with the terminal ids of the words kept so
+// that the language model content and the shortcuts can be translated entry by entry on the way.
+// The migrated dictionary needs no GC until it is flushed.
+class DictMigrationUtils {
+ public:
+    // Returns whether sourcePolicy can be migrated to newFormatVersion by migrate().
+    static bool canMigrate(const DictionaryStructureWithBufferPolicy *const sourcePolicy,
+            const int newFormatVersion);
+
+    // Returns a new on-memory dictionary with the content of sourcePolicy in newFormatVersion,
+    // which canMigrate() has accepted, or nullptr on failure. sourcePolicy must not be updated
+    // meanwhile.
+    static DictionaryStructureWithBufferPolicy::StructurePolicyPtr migrate(
+            const DictionaryStructureWithBufferPolicy *const sourcePolicy,
+            const int newFormatVersion);
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(DictMigrationUtils);
+
+    static DictionaryStructureWithBufferPolicy::StructurePolicyPtr migrateVer402ToVer4(
+            const DictionaryStructureWithBufferPolicy *const sourcePolicy,
+            const FormatUtils::FORMAT_VERSION newFormatVersion);
+};
+} // namespace latinime
+#endif // LATINIME_DICT_MIGRATION_UTILS_H
@@ -40,6 +40,8 @@ class FormatUtils {
         VERSION_4_ONLY_FOR_TESTING = 399,
         VERSION_402 = 402,
         VERSION_403 = 403,
+        // Same as VERSION_403 with value links in the trie maps of the language model.
+        VERSION_404 = 404,
         UNKNOWN_VERSION = -1
     };
 
@@ -16,20 +16,88 @@
 
 #include "dictionary/utils/mmapped_buffer.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <climits>
 #include <cstdio>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
 #include <unistd.h>
 
 #include "dictionary/utils/file_utils.h"
 
 namespace latinime {
 
+const int MmappedBuffer::HOT_HEAD_SIZE = 64 * 1024;
+std::mutex MmappedBuffer::sSharedMappingsMutex;
+std::map<MmappedBuffer::SharedMappingKey, std::weak_ptr<const MmappedBuffer>>
+        MmappedBuffer::sSharedMappings;
+
+bool MmappedBuffer::SharedMappingKey::operator<(const SharedMappingKey &other) const {
+    return std::tie(mPath, mBufferOffset, mBufferSize, mDevice, mInode, mModificationTimeNs)
+            < std::tie(other.mPath, other.mBufferOffset, other.mBufferSize, other.mDevice,
+                    other.mInode, other.mModificationTimeNs);
+}
+
 /* static */ MmappedBuffer::MmappedBufferPtr MmappedBuffer::openBuffer(
         const char *const path, const int bufferOffset, const int bufferSize,
         const bool isUpdatable) {
+    return openBuffer(path, bufferOffset, bufferSize, isUpdatable, AccessPolicy::DEFAULT);
+}
+
+/* static */ MmappedBuffer::MmappedBufferPtr MmappedBuffer::openBuffer(
+        const char *const path, const int bufferOffset, const int bufferSize,
+        const bool isUpdatable, const AccessPolicy accessPolicy) {
+    if (!isUpdatable) {
+        return openSharedBuffer(path, bufferOffset, bufferSize, accessPolicy);
+    }
+    return MmappedBufferPtr(mapBuffer(path, bufferOffset, bufferSize, isUpdatable,
+            accessPolicy));
+}
+
+/* static */ MmappedBuffer::MmappedBufferPtr MmappedBuffer::openSharedBuffer(
+        const char *const path, const int bufferOffset, const int bufferSize,
+        const AccessPolicy accessPolicy) {
+    struct stat fileStat;
+    if (stat(path, &fileStat) != 0) {
+        AKLOGE("DICT: Can't stat the source. path=%s errno=%d", path, errno);
+        return nullptr;
+    }
+    const SharedMappingKey key = { path, bufferOffset, bufferSize, fileStat.st_dev,
+            fileStat.st_ino, static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000LL
+                    + fileStat.st_mtim.tv_nsec };
+    std::lock_guard<std::mutex> lock(sSharedMappingsMutex);
+    const auto it = sSharedMappings.find(key);
+    if (it != sSharedMappings.end()) {
+        const std::shared_ptr<const MmappedBuffer> sharedMapping = it->second.lock();
+        if (sharedMapping) {
+            return MmappedBufferPtr(new MmappedBuffer(sharedMapping));
+        }
+    }
+    MmappedBuffer *const mmappedBuffer = mapBuffer(path, bufferOffset, bufferSize,
+            false /* isUpdatable */, accessPolicy);
+    if (!mmappedBuffer) {
+        return nullptr;
+    }
+    const std::shared_ptr<const MmappedBuffer> sharedMapping(mmappedBuffer);
+    // Forget the mappings that have been closed. There are only a few dictionaries, so this is
+    // cheap.
+    for (auto entryIt = sSharedMappings.begin(); entryIt != sSharedMappings.end();) {
+        if (entryIt->second.expired()) {
+            entryIt = sSharedMappings.erase(entryIt);
+        } else {
+            ++entryIt;
+        }
+    }
+    sSharedMappings[key] = sharedMapping;
+    return MmappedBufferPtr(new MmappedBuffer(sharedMapping));
+}
+
+/* static */ MmappedBuffer *MmappedBuffer::mapBuffer(const char *const path,
+        const int bufferOffset, const int bufferSize, const bool isUpdatable,
+        const AccessPolicy accessPolicy) {
     const int mmapFd = open(path, O_RDONLY);
     if (mmapFd < 0) {
         AKLOGE("DICT: Can't open the source. path=%s errno=%d", path, errno);
@@ -53,8 +121,10 @@ namespace latinime {
         close(mmapFd);
         return nullptr;
     }
-    return MmappedBufferPtr(new MmappedBuffer(buffer, bufferSize, mmappedBuffer, alignedSize,
-            mmapFd, isUpdatable));
+    MmappedBuffer *const mmappedBufferInstance = new MmappedBuffer(buffer, bufferSize,
+            mmappedBuffer, alignedSize, mmapFd, isUpdatable);
+    mmappedBufferInstance->applyAccessPolicy(accessPolicy, pagesize);
+    return mmappedBufferInstance;
 }
 
 /* static */ MmappedBuffer::MmappedBufferPtr MmappedBuffer::openBuffer(
@@ -85,6 +155,10 @@ MmappedBuffer::~MmappedBuffer() {
     if (mAlignedSize == 0) {
         return;
     }
+    if (mPrefaultThread.joinable()) {
+        mIsClosing.store(true, std::memory_order_relaxed);
+        mPrefaultThread.join();
+    }
     int ret = munmap(mMmappedBuffer, mAlignedSize);
     if (ret != 0) {
         AKLOGE("DICT: Failure in munmap. ret=%d errno=%d", ret, errno);
@@ -95,4 +169,61 @@ MmappedBuffer::~MmappedBuffer() {
     }
 }
 
+void MmappedBuffer::releaseCleanPages() const {
+    if (mSharedMapping) {
+        mSharedMapping->releaseCleanPages();
+        return;
+    }
+    if (mIsUpdatable || mAlignedSize == 0) {
+        return;
+    }
+    const int pageSize = sysconf(_SC_PAGESIZE);
+    uint8_t *const mmappedBuffer = static_cast<uint8_t *>(mMmappedBuffer);
+    const int hotHeadOffset = static_cast<int>(mByteArrayView.data() - mmappedBuffer);
+    const int hotHeadSize = std::min(mAlignedSize,
+            (hotHeadOffset + HOT_HEAD_SIZE + pageSize - 1) / pageSize * pageSize);
+    if (hotHeadSize < mAlignedSize
+            && madvise(mmappedBuffer + hotHeadSize, mAlignedSize - hotHeadSize, MADV_DONTNEED)
+                    != 0) {
+        AKLOGE("DICT: Failure in madvise(MADV_DONTNEED). errno=%d", errno);
+    }
+}
+
+void MmappedBuffer::applyAccessPolicy(const AccessPolicy accessPolicy, const int pageSize) {
+    if (accessPolicy == AccessPolicy::DEFAULT) {
+        return;
+    }
+    uint8_t *const mmappedBuffer = static_cast<uint8_t *>(mMmappedBuffer);
+    // madvise() needs page aligned ranges, so the head is rounded up to a page boundary.
+    const int hotHeadOffset = static_cast<int>(mByteArrayView.data() - mmappedBuffer);
+    const int hotHeadSize = std::min(mAlignedSize,
+            (hotHeadOffset + HOT_HEAD_SIZE + pageSize - 1) / pageSize * pageSize);
+    const bool prefaults = accessPolicy == AccessPolicy::HOT_HEAD_WITH_PREFAULT;
+    // With prefaulting, the tail is read ahead as a whole by the kernel while the prefault
+    // thread maps the pages.
+    if (madvise(mmappedBuffer, prefaults ? mAlignedSize : hotHeadSize, MADV_WILLNEED) != 0) {
+        AKLOGE("DICT: Failure in madvise(MADV_WILLNEED). errno=%d", errno);
+    }
+    if (hotHeadSize < mAlignedSize
+            && madvise(mmappedBuffer + hotHeadSize, mAlignedSize - hotHeadSize, MADV_RANDOM)
+                    != 0) {
+        AKLOGE("DICT: Failure in madvise(MADV_RANDOM). errno=%d", errno);
+    }
+    if (prefaults) {
+        mPrefaultThread = std::thread(&MmappedBuffer::prefaultPages, this, pageSize);
+    }
+}
+
+void MmappedBuffer::prefaultPages(const int pageSize) const {
+    const volatile uint8_t *const mmappedBuffer =
+            static_cast<const volatile uint8_t *>(mMmappedBuffer);
+    for (int pos = 0; pos < mAlignedSize; pos += pageSize) {
+        if (mIsClosing.load(std::memory_order_relaxed)) {
+            return;
+        }
+        // Reading a byte is enough to fault the page in.
+        static_cast<void>(mmappedBuffer[pos]);
+    }
+}
+
 } // namespace latinime
@@ -17,21 +17,46 @@
 #ifndef LATINIME_MMAPPED_BUFFER_H
 #define LATINIME_MMAPPED_BUFFER_H
 
+#include <atomic>
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <thread>
 
 #include "defines.h"
 #include "utils/byte_array_view.h"
 
 namespace latinime {
 
+// Non-updatable buffers are shared: opening the same range of the same file again while a buffer
+// for it is alive (e.g. the same main dictionary for the keyboard and the spell checker) returns
+// a view on the existing mapping instead of mapping the file a second time.
 class MmappedBuffer {
  public:
     typedef std::unique_ptr<const MmappedBuffer> MmappedBufferPtr;
 
+    // How the mapped pages are going to be accessed. Passed to madvise() after mmap().
+    enum class AccessPolicy {
+        // No advice. The kernel reads ahead around each page fault.
+        DEFAULT,
+        // The head of the buffer (the header and the top trie levels) is read right away
+        // (MADV_WILLNEED) and the rest is accessed randomly (MADV_RANDOM).
+        HOT_HEAD,
+        // Same as HOT_HEAD, and all the pages are read ahead and faulted in by a background
+        // thread, so the first searches after the open don't wait for I/O.
+        HOT_HEAD_WITH_PREFAULT,
+    };
+
     static MmappedBufferPtr openBuffer(const char *const path,
             const int bufferOffset, const int bufferSize, const bool isUpdatable);
 
+    static MmappedBufferPtr openBuffer(const char *const path,
+            const int bufferOffset, const int bufferSize, const bool isUpdatable,
+            const AccessPolicy accessPolicy);
+
     // Mmap entire file.
     static MmappedBufferPtr openBuffer(const char *const path, const bool isUpdatable);
 
@@ -52,25 +77,72 @@ class MmappedBuffer {
         return mIsUpdatable;
     }
 
+    // Drops the resident pages after the hot head (MADV_DONTNEED) so that the kernel doesn't have
+    // to reclaim them under memory pressure. They are read from the file again on the next
+    // access. Does nothing for updatable buffers: the mapping is private, so their pages may hold
+    // changes that haven't been written to the file yet.
+    void releaseCleanPages() const;
+
  private:
     AK_FORCE_INLINE MmappedBuffer(uint8_t *const buffer, const int bufferSize,
             void *const mmappedBuffer, const int alignedSize, const int mmapFd,
             const bool isUpdatable)
             : mByteArrayView(buffer, bufferSize), mMmappedBuffer(mmappedBuffer),
-              mAlignedSize(alignedSize), mMmapFd(mmapFd), mIsUpdatable(isUpdatable) {}
+              mAlignedSize(alignedSize), mMmapFd(mmapFd), mIsUpdatable(isUpdatable),
+              mPrefaultThread(), mIsClosing(false), mSharedMapping() {}
+
+    // View on a shared mapping. Doesn't own the mapping itself.
+    AK_FORCE_INLINE MmappedBuffer(const std::shared_ptr<const MmappedBuffer> &sharedMapping)
+            : mByteArrayView(sharedMapping->mByteArrayView), mMmappedBuffer(nullptr),
+              mAlignedSize(0), mMmapFd(0), mIsUpdatable(false), mPrefaultThread(),
+              mIsClosing(false), mSharedMapping(sharedMapping) {}
 
     // Empty file. We have to handle an empty file as a valid part of a dictionary.
     AK_FORCE_INLINE MmappedBuffer(const bool isUpdatable)
             : mByteArrayView(), mMmappedBuffer(nullptr), mAlignedSize(0),
-              mMmapFd(0), mIsUpdatable(isUpdatable) {}
+              mMmapFd(0), mIsUpdatable(isUpdatable), mPrefaultThread(), mIsClosing(false),
+              mSharedMapping() {}
 
     DISALLOW_IMPLICIT_CONSTRUCTORS(MmappedBuffer);
 
+    // Identifies a mapped range of a file. The inode and the modification time make sure a
+    // dictionary file that has been replaced is mapped again.
+    struct SharedMappingKey {
+        std::string mPath;
+        int mBufferOffset;
+        int mBufferSize;
+        dev_t mDevice;
+        ino_t mInode;
+        int64_t mModificationTimeNs;
+
+        bool operator<(const SharedMappingKey &other) const;
+    };
+
+    static std::mutex sSharedMappingsMutex;
+    static std::map<SharedMappingKey, std::weak_ptr<const MmappedBuffer>> sSharedMappings;
+
+    // The size of the head that is read right away with AccessPolicy::HOT_HEAD. Covers the
+    // header and the first few levels of the trie of a main dictionary.
+    static const int HOT_HEAD_SIZE;
+
     const ReadWriteByteArrayView mByteArrayView;
     void *const mMmappedBuffer;
     const int mAlignedSize;
     const int mMmapFd;
     const bool mIsUpdatable;
+    std::thread mPrefaultThread;
+    // Stops the prefault thread before the buffer is unmapped.
+    std::atomic<bool> mIsClosing;
+    // Set for views on a shared mapping.
+    const std::shared_ptr<const MmappedBuffer> mSharedMapping;
+
+    static MmappedBuffer *mapBuffer(const char *const path, const int bufferOffset,
+            const int bufferSize, const bool isUpdatable, const AccessPolicy accessPolicy);
+    static MmappedBufferPtr openSharedBuffer(const char *const path, const int bufferOffset,
+            const int bufferSize, const AccessPolicy accessPolicy);
+
+    void applyAccessPolicy(const AccessPolicy accessPolicy, const int pageSize);
+    void prefaultPages(const int pageSize) const;
 };
 }
 #endif /* LATINIME_MMAPPED_BUFFER_H */
@@ -16,23 +16,13 @@
 
 #include "dictionary/utils/multi_bigram_map.h"
 
+#include <algorithm>
 #include <cstddef>
-#include <unordered_map>
 
 namespace latinime {
 
-// Max number of bigram maps (previous word contexts) to be cached. Increasing this number
-// could improve bigram lookup speed for multi-word suggestions, but at the cost of more memory
-// usage. Also, there are diminishing returns since the most frequently used bigrams are
-// typically near the beginning of the input and are thus the first ones to be cached. Note
-// that these bigrams are reset for each new composing word.
-const size_t MultiBigramMap::MAX_CACHED_PREV_WORDS_IN_BIGRAM_MAP = 25;
-
-// Most common previous word contexts currently have 100 bigrams
-const int MultiBigramMap::BigramMap::DEFAULT_HASH_MAP_SIZE_FOR_EACH_BIGRAM_MAP = 100;
-
 // Look up the bigram probability for the given word pair from the cached bigram maps.
-// Also caches the bigrams if there is space remaining and they have not been cached already.
+// Also caches the bigrams if they have not been cached already.
 int MultiBigramMap::getBigramProbability(
         const DictionaryStructureWithBufferPolicy *const structurePolicy,
         const WordIdArrayView prevWordIds, const int nextWordId,
@@ -40,61 +30,119 @@ int MultiBigramMap::getBigramProbability(
     if (prevWordIds.empty() || prevWordIds[0] == NOT_A_WORD_ID) {
         return structurePolicy->getProbability(unigramProbability, NOT_A_PROBABILITY);
     }
-    const auto mapPosition = mBigramMaps.find(prevWordIds[0]);
-    if (mapPosition != mBigramMaps.end()) {
-        return mapPosition->second.getBigramProbability(structurePolicy, nextWordId,
-                unigramProbability);
-    }
-    if (mBigramMaps.size() < MAX_CACHED_PREV_WORDS_IN_BIGRAM_MAP) {
-        addBigramsForWord(structurePolicy, prevWordIds);
-        return mBigramMaps[prevWordIds[0]].getBigramProbability(structurePolicy,
-                nextWordId, unigramProbability);
-    }
-    return readBigramProbabilityFromBinaryDictionary(structurePolicy, prevWordIds,
-            nextWordId, unigramProbability);
+    const BigramMap *const bigramMap = getBigramMap(structurePolicy, prevWordIds);
+    return getBigramProbability(structurePolicy, *bigramMap, nextWordId, unigramProbability);
 }
 
-void MultiBigramMap::BigramMap::init(
+MultiBigramMap::BigramMap *MultiBigramMap::getBigramMap(
         const DictionaryStructureWithBufferPolicy *const structurePolicy,
         const WordIdArrayView prevWordIds) {
-    structurePolicy->iterateNgramEntries(prevWordIds, this /* listener */);
+    ++mUseCount;
+    BigramMap *leastRecentlyUsedBigramMap = nullptr;
+    for (size_t i = 0; i < mBigramMapCount; ++i) {
+        BigramMap *const bigramMap = &mBigramMaps[i];
+        if (bigramMap->mPrevWordId == prevWordIds[0]) {
+            bigramMap->mLastUseCount = mUseCount;
+            return bigramMap;
+        }
+        if (!leastRecentlyUsedBigramMap
+                || bigramMap->mLastUseCount < leastRecentlyUsedBigramMap->mLastUseCount) {
+            leastRecentlyUsedBigramMap = bigramMap;
+        }
+    }
+    BigramMap *bigramMap = nullptr;
+    if (mBigramMapCount < MAX_CACHED_PREV_WORDS_IN_BIGRAM_MAP) {
+        bigramMap = &mBigramMaps[mBigramMapCount];
+        ++mBigramMapCount;
+    } else {
+        bigramMap = leastRecentlyUsedBigramMap;
+        mWastedSuccessorCount += bigramMap->mSize;
+        bigramMap->mSize = 0;
+        if (mWastedSuccessorCount > mSuccessors.size() / 2) {
+            compactSuccessors();
+        }
+    }
+    initBigramMap(structurePolicy, prevWordIds, bigramMap);
+    bigramMap->mLastUseCount = mUseCount;
+    return bigramMap;
 }
 
-int MultiBigramMap::BigramMap::getBigramProbability(
+void MultiBigramMap::initBigramMap(
         const DictionaryStructureWithBufferPolicy *const structurePolicy,
-        const int nextWordId, const int unigramProbability) const {
-    int bigramProbability = NOT_A_PROBABILITY;
-    if (mBloomFilter.isInFilter(nextWordId)) {
-        const auto bigramProbabilityIt = mBigramMap.find(nextWordId);
-        if (bigramProbabilityIt != mBigramMap.end()) {
-            bigramProbability = bigramProbabilityIt->second;
+        const WordIdArrayView prevWordIds, BigramMap *const bigramMap) {
+    const size_t begin = mSuccessors.size();
+    SuccessorCollector successorCollector(&mSuccessors);
+    structurePolicy->iterateNgramEntries(prevWordIds, &successorCollector);
+    // A word can be visited more than once; the last visit wins, as it is for the longest
+    // context.
+    const auto successorsBegin = mSuccessors.begin() + begin;
+    std::stable_sort(successorsBegin, mSuccessors.end(),
+            [](const Successor &left, const Successor &right) {
+                return left.mWordId < right.mWordId;
+            });
+    auto writeIt = successorsBegin;
+    for (auto readIt = successorsBegin; readIt != mSuccessors.end(); ++readIt) {
+        if (writeIt != successorsBegin && (writeIt - 1)->mWordId == readIt->mWordId) {
+            *(writeIt - 1) = *readIt;
+        } else {
+            *writeIt = *readIt;
+            ++writeIt;
         }
     }
-    return structurePolicy->getProbability(unigramProbability, bigramProbability);
-}
-
-void MultiBigramMap::BigramMap::onVisitEntry(const int ngramProbability, const int targetWordId) {
-    if (targetWordId == NOT_A_WORD_ID) {
-        return;
+    mSuccessors.erase(writeIt, mSuccessors.end());
+    bigramMap->mPrevWordId = prevWordIds[0];
+    bigramMap->mBegin = static_cast<int>(begin);
+    bigramMap->mSize = static_cast<int>(mSuccessors.size() - begin);
+    bigramMap->mBloomFilter.reset(bigramMap->mSize);
+    for (size_t i = begin; i < mSuccessors.size(); ++i) {
+        bigramMap->mBloomFilter.setInFilter(mSuccessors[i].mWordId);
     }
-    mBigramMap[targetWordId] = ngramProbability;
-    mBloomFilter.setInFilter(targetWordId);
 }
 
-void MultiBigramMap::addBigramsForWord(
+int MultiBigramMap::getBigramProbability(
         const DictionaryStructureWithBufferPolicy *const structurePolicy,
-        const WordIdArrayView prevWordIds) {
-    mBigramMaps[prevWordIds[0]].init(structurePolicy, prevWordIds);
+        const BigramMap &bigramMap, const int nextWordId, const int unigramProbability) const {
+    int bigramProbability = NOT_A_PROBABILITY;
+    if (bigramMap.mSize > 0 && bigramMap.mBloomFilter.isInFilter(nextWordId)) {
+        // Branchless binary search. The loop only depends on the size, so the comparison becomes
+        // a conditional move.
+        const Successor *base = mSuccessors.data() + bigramMap.mBegin;
+        int size = bigramMap.mSize;
+        while (size > 1) {
+            const int half = size / 2;
+            base = (base[half].mWordId <= nextWordId) ? base + half : base;
+            size -= half;
+        }
+        if (base->mWordId == nextWordId) {
+            bigramProbability = base->mProbability;
+        }
+    }
+    return structurePolicy->getProbability(unigramProbability, bigramProbability);
 }
 
-int MultiBigramMap::readBigramProbabilityFromBinaryDictionary(
-        const DictionaryStructureWithBufferPolicy *const structurePolicy,
-        const WordIdArrayView prevWordIds, const int nextWordId, const int unigramProbability) {
-    const int bigramProbability = structurePolicy->getProbabilityOfWord(prevWordIds, nextWordId);
-    if (bigramProbability != NOT_A_PROBABILITY) {
-        return bigramProbability;
+// Moves the successors of the cached contexts to the front of the arena, dropping the ones of
+// the evicted contexts.
+void MultiBigramMap::compactSuccessors() {
+    BigramMap *bigramMapsByBegin[MAX_CACHED_PREV_WORDS_IN_BIGRAM_MAP];
+    for (size_t i = 0; i < mBigramMapCount; ++i) {
+        bigramMapsByBegin[i] = &mBigramMaps[i];
+    }
+    std::sort(bigramMapsByBegin, bigramMapsByBegin + mBigramMapCount,
+            [](const BigramMap *const left, const BigramMap *const right) {
+                return left->mBegin < right->mBegin;
+            });
+    int writePos = 0;
+    for (size_t i = 0; i < mBigramMapCount; ++i) {
+        BigramMap *const bigramMap = bigramMapsByBegin[i];
+        // The ranges are in order, so writePos never passes the range that is moved.
+        std::copy(mSuccessors.begin() + bigramMap->mBegin,
+                mSuccessors.begin() + bigramMap->mBegin + bigramMap->mSize,
+                mSuccessors.begin() + writePos);
+        bigramMap->mBegin = writePos;
+        writePos += bigramMap->mSize;
     }
-    return structurePolicy->getProbability(unigramProbability, NOT_A_PROBABILITY);
+    mSuccessors.resize(writePos);
+    mWastedSuccessorCount = 0;
 }
 
 } // namespace latinime
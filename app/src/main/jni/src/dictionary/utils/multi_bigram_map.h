@@ -18,7 +18,8 @@
 #define LATINIME_MULTI_BIGRAM_MAP_H
 
 #include <cstddef>
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
 
 #include "defines.h"
 #include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
@@ -26,59 +27,113 @@
 #include "dictionary/utils/binary_dictionary_bigrams_iterator.h"
 #include "dictionary/utils/bloom_filter.h"
 #include "utils/int_array_view.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 
 // Class for caching bigram maps for multiple previous word contexts. This is useful since the
 // algorithm needs to look up the set of bigrams for every word pair that occurs in every
 // multi-word suggestion.
+// The successors of all the cached contexts are kept sorted by word id in one arena, so caching
+// a context doesn't allocate once the arena has grown.
 class MultiBigramMap {
  public:
-    MultiBigramMap() : mBigramMaps() {}
+    // Max number of bigram maps (previous word contexts) to be cached. Increasing this number
+    // could improve bigram lookup speed for multi-word suggestions, but at the cost of more
+    // memory usage. Also, there are diminishing returns since the most frequently used bigrams
+    // are typically near the beginning of the input and are thus the first ones to be cached.
+    // Note that these bigrams are reset for each new composing word.
+    static const size_t MAX_CACHED_PREV_WORDS_IN_BIGRAM_MAP = 25;
+
+    MultiBigramMap()
+            : mBigramMaps(), mBigramMapCount(0), mSuccessors(), mWastedSuccessorCount(0),
+              mUseCount(0) {}
     ~MultiBigramMap() {}
 
     // Look up the bigram probability for the given word pair from the cached bigram maps.
-    // Also caches the bigrams if there is space remaining and they have not been cached already.
+    // Also caches the bigrams if they have not been cached already, evicting the least recently
+    // used context when the cache is full.
     int getBigramProbability(const DictionaryStructureWithBufferPolicy *const structurePolicy,
             const WordIdArrayView prevWordIds, const int nextWordId, const int unigramProbability);
 
     void clear() {
-        mBigramMaps.clear();
+        mBigramMapCount = 0;
+        mSuccessors.clear();
+        mWastedSuccessorCount = 0;
+        mUseCount = 0;
+    }
+
+    // Same as clear(), and frees the cached successors.
+    void release() {
+        clear();
+        std::vector<Successor>().swap(mSuccessors);
+    }
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mSuccessors);
     }
 
  private:
     DISALLOW_COPY_AND_ASSIGN(MultiBigramMap);
 
-    class BigramMap : public NgramListener {
+    struct Successor {
+        int mWordId;
+        int mProbability;
+    };
+
+    // Appends the visited n-grams to the arena.
+    class SuccessorCollector : public NgramListener {
      public:
-        BigramMap() : mBigramMap(DEFAULT_HASH_MAP_SIZE_FOR_EACH_BIGRAM_MAP), mBloomFilter() {}
-        // Copy constructor needed for std::unordered_map.
-        BigramMap(const BigramMap &bigramMap)
-                : mBigramMap(bigramMap.mBigramMap), mBloomFilter(bigramMap.mBloomFilter) {}
-        virtual ~BigramMap() {}
-
-        void init(const DictionaryStructureWithBufferPolicy *const structurePolicy,
-                const WordIdArrayView prevWordIds);
-        int getBigramProbability(
-                const DictionaryStructureWithBufferPolicy *const structurePolicy,
-                const int nextWordId, const int unigramProbability) const;
-        virtual void onVisitEntry(const int ngramProbability, const int targetWordId);
+        explicit SuccessorCollector(std::vector<Successor> *const successors)
+                : mSuccessors(successors) {}
+        virtual ~SuccessorCollector() {}
+
+        virtual void onVisitEntry(const int ngramProbability, const int targetWordId) {
+            onVisitEntries(&ngramProbability, &targetWordId, 1 /* count */);
+        }
+
+        virtual void onVisitEntries(const int *const ngramProbabilities,
+                const int *const targetWordIds, const int count) {
+            const size_t size = mSuccessors->size();
+            mSuccessors->resize(size + count);
+            Successor *const successors = mSuccessors->data() + size;
+            int successorCount = 0;
+            for (int i = 0; i < count; ++i) {
+                successors[successorCount] = { targetWordIds[i], ngramProbabilities[i] };
+                successorCount += (targetWordIds[i] != NOT_A_WORD_ID) ? 1 : 0;
+            }
+            mSuccessors->resize(size + successorCount);
+        }
 
      private:
-        static const int DEFAULT_HASH_MAP_SIZE_FOR_EACH_BIGRAM_MAP;
-        std::unordered_map<int, int> mBigramMap;
+        DISALLOW_IMPLICIT_CONSTRUCTORS(SuccessorCollector);
+
+        std::vector<Successor> *const mSuccessors;
+    };
+
+    // A cached context. Its successors are mSuccessors[mBegin, mBegin + mSize).
+    struct BigramMap {
+        int mPrevWordId;
+        int mBegin;
+        int mSize;
+        uint64_t mLastUseCount;
         BloomFilter mBloomFilter;
     };
 
-    void addBigramsForWord(const DictionaryStructureWithBufferPolicy *const structurePolicy,
+    BigramMap *getBigramMap(const DictionaryStructureWithBufferPolicy *const structurePolicy,
             const WordIdArrayView prevWordIds);
+    void initBigramMap(const DictionaryStructureWithBufferPolicy *const structurePolicy,
+            const WordIdArrayView prevWordIds, BigramMap *const bigramMap);
+    int getBigramProbability(const DictionaryStructureWithBufferPolicy *const structurePolicy,
+            const BigramMap &bigramMap, const int nextWordId, const int unigramProbability) const;
+    void compactSuccessors();
 
-    int readBigramProbabilityFromBinaryDictionary(
-            const DictionaryStructureWithBufferPolicy *const structurePolicy,
-            const WordIdArrayView prevWordIds, const int nextWordId, const int unigramProbability);
-
-    static const size_t MAX_CACHED_PREV_WORDS_IN_BIGRAM_MAP;
-    std::unordered_map<int, BigramMap> mBigramMaps;
+    BigramMap mBigramMaps[MAX_CACHED_PREV_WORDS_IN_BIGRAM_MAP];
+    size_t mBigramMapCount;
+    std::vector<Successor> mSuccessors;
+    // Number of successors in the arena that belong to evicted contexts.
+    size_t mWastedSuccessorCount;
+    uint64_t mUseCount;
 };
 } // namespace latinime
 #endif // LATINIME_MULTI_BIGRAM_MAP_H
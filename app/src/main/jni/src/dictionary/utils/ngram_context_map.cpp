@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/utils/ngram_context_map.h"
+
+namespace latinime {
+
+const int NgramContextMap::NOT_A_VALUE = -1;
+const int NgramContextMap::MIN_BUCKET_COUNT = 16;
+const int NgramContextMap::MAX_LOAD_FACTOR_PERCENTAGE = 75;
+
+int NgramContextMap::get(const WordIdArrayView prevWordIds) const {
+    if (mBuckets.empty() || !isValidContext(prevWordIds)) {
+        return NOT_A_VALUE;
+    }
+    const size_t entryPos = findEntryPos(mBuckets, prevWordIds);
+    const Entry &entry = mBuckets[entryPos / ENTRY_COUNT_IN_BUCKET].mEntries[
+            entryPos % ENTRY_COUNT_IN_BUCKET];
+    return entry.mPrevWordIds[0] == NOT_A_WORD_ID ? NOT_A_VALUE : entry.mValue;
+}
+
+bool NgramContextMap::put(const WordIdArrayView prevWordIds, const int value) {
+    if (!isValidContext(prevWordIds)) {
+        return false;
+    }
+    const int capacity = static_cast<int>(mBuckets.size()) * ENTRY_COUNT_IN_BUCKET;
+    if ((mEntryCount + 1) * 100 > capacity * MAX_LOAD_FACTOR_PERCENTAGE) {
+        resize(mBuckets.empty() ? MIN_BUCKET_COUNT : static_cast<int>(mBuckets.size()) * 2);
+    }
+    Entry *const entry = getEntry(&mBuckets, findEntryPos(mBuckets, prevWordIds));
+    if (entry->mPrevWordIds[0] == NOT_A_WORD_ID) {
+        for (int i = 0; i < MAX_PREV_WORD_COUNT_FOR_N_GRAM; ++i) {
+            entry->mPrevWordIds[i] = static_cast<size_t>(i) < prevWordIds.size()
+                    ? prevWordIds[i] : NOT_A_WORD_ID;
+        }
+        ++mEntryCount;
+    }
+    entry->mValue = value;
+    return true;
+}
+
+void NgramContextMap::clear() {
+    mBuckets.clear();
+    mEntryCount = 0;
+}
+
+/* static */ bool NgramContextMap::isValidContext(const WordIdArrayView prevWordIds) {
+    if (prevWordIds.empty() || prevWordIds.size() > MAX_PREV_WORD_COUNT_FOR_N_GRAM) {
+        return false;
+    }
+    for (const int wordId : prevWordIds) {
+        if (wordId < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* static */ uint32_t NgramContextMap::getHash(const WordIdArrayView prevWordIds) {
+    uint64_t hash = prevWordIds.size();
+    for (const int wordId : prevWordIds) {
+        hash = (hash ^ static_cast<uint32_t>(wordId)) * 0x9E3779B97F4A7C15ULL;
+    }
+    return static_cast<uint32_t>(hash >> 32);
+}
+
+/* static */ bool NgramContextMap::isSameContext(const Entry &entry,
+        const WordIdArrayView prevWordIds) {
+    for (int i = 0; i < MAX_PREV_WORD_COUNT_FOR_N_GRAM; ++i) {
+        const int wordId = static_cast<size_t>(i) < prevWordIds.size()
+                ? prevWordIds[i] : NOT_A_WORD_ID;
+        if (entry.mPrevWordIds[i] != wordId) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* static */ size_t NgramContextMap::findEntryPos(const std::vector<Bucket> &buckets,
+        const WordIdArrayView prevWordIds) {
+    // The bucket count is a power of 2 and the load factor is below 1, so there is always an
+    // empty entry to stop at.
+    const size_t bucketIndexMask = buckets.size() - 1;
+    for (size_t bucketIndex = getHash(prevWordIds) & bucketIndexMask; ;
+            bucketIndex = (bucketIndex + 1) & bucketIndexMask) {
+        const Bucket &bucket = buckets[bucketIndex];
+        for (int i = 0; i < ENTRY_COUNT_IN_BUCKET; ++i) {
+            const Entry &entry = bucket.mEntries[i];
+            if (entry.mPrevWordIds[0] == NOT_A_WORD_ID || isSameContext(entry, prevWordIds)) {
+                return bucketIndex * ENTRY_COUNT_IN_BUCKET + i;
+            }
+        }
+    }
+}
+
+void NgramContextMap::resize(const int bucketCount) {
+    Bucket emptyBucket;
+    for (int i = 0; i < ENTRY_COUNT_IN_BUCKET; ++i) {
+        for (int j = 0; j < MAX_PREV_WORD_COUNT_FOR_N_GRAM; ++j) {
+            emptyBucket.mEntries[i].mPrevWordIds[j] = NOT_A_WORD_ID;
+        }
+        emptyBucket.mEntries[i].mValue = NOT_A_VALUE;
+    }
+    std::vector<Bucket> newBuckets(bucketCount, emptyBucket);
+    for (const Bucket &bucket : mBuckets) {
+        for (int i = 0; i < ENTRY_COUNT_IN_BUCKET; ++i) {
+            const Entry &entry = bucket.mEntries[i];
+            if (entry.mPrevWordIds[0] == NOT_A_WORD_ID) {
+                continue;
+            }
+            int prevWordCount = 0;
+            while (prevWordCount < MAX_PREV_WORD_COUNT_FOR_N_GRAM
+                    && entry.mPrevWordIds[prevWordCount] != NOT_A_WORD_ID) {
+                ++prevWordCount;
+            }
+            *getEntry(&newBuckets, findEntryPos(newBuckets,
+                    WordIdArrayView(entry.mPrevWordIds, prevWordCount))) = entry;
+        }
+    }
+    mBuckets.swap(newBuckets);
+}
+
+} // namespace latinime
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_NGRAM_CONTEXT_MAP_H
+#define LATINIME_NGRAM_CONTEXT_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "defines.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+/**
+ * Flat open-addressing hash map from n-gram contexts, i.e. tuples of previous word ids, to
+ * ints.
+ *
+ * One bucket fills a cache line, and buckets are probed linearly. Most lookups touch only one
+ * cache line, while a TrieMap lookup walks a few levels for each word of the context. Entries
+ * can't be removed one by one; the map is cleared and filled again instead.
+ */
+class NgramContextMap {
+ public:
+    static const int NOT_A_VALUE;
+
+    NgramContextMap() : mBuckets(), mEntryCount(0) {}
+
+    // Returns NOT_A_VALUE when the context isn't in the map.
+    int get(const WordIdArrayView prevWordIds) const;
+    // Contexts have 1 to MAX_PREV_WORD_COUNT_FOR_N_GRAM valid word ids. Returns false for other
+    // contexts.
+    bool put(const WordIdArrayView prevWordIds, const int value);
+    void clear();
+
+    int getEntryCount() const {
+        return mEntryCount;
+    }
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(NgramContextMap);
+
+    struct Entry {
+        // Unused word ids are NOT_A_WORD_ID. Empty entries have NOT_A_WORD_ID as the first one.
+        int mPrevWordIds[MAX_PREV_WORD_COUNT_FOR_N_GRAM];
+        int mValue;
+    };
+
+    static const int CACHE_LINE_SIZE = 64;
+    static const int ENTRY_COUNT_IN_BUCKET = CACHE_LINE_SIZE / sizeof(Entry);
+
+    struct alignas(CACHE_LINE_SIZE) Bucket {
+        Entry mEntries[ENTRY_COUNT_IN_BUCKET];
+    };
+
+    static const int MIN_BUCKET_COUNT;
+    static const int MAX_LOAD_FACTOR_PERCENTAGE;
+
+    static bool isValidContext(const WordIdArrayView prevWordIds);
+    static uint32_t getHash(const WordIdArrayView prevWordIds);
+    static bool isSameContext(const Entry &entry, const WordIdArrayView prevWordIds);
+
+    // Returns the position of the entry for the context, or of the empty entry to put the
+    // context in.
+    static size_t findEntryPos(const std::vector<Bucket> &buckets,
+            const WordIdArrayView prevWordIds);
+    static Entry *getEntry(std::vector<Bucket> *const buckets, const size_t entryPos) {
+        return &(*buckets)[entryPos / ENTRY_COUNT_IN_BUCKET].mEntries[
+                entryPos % ENTRY_COUNT_IN_BUCKET];
+    }
+
+    void resize(const int bucketCount);
+
+    std::vector<Bucket> mBuckets;
+    int mEntryCount;
+};
+} // namespace latinime
+#endif // LATINIME_NGRAM_CONTEXT_MAP_H
@@ -16,23 +16,20 @@
 
 #include "dictionary/utils/sparse_table.h"
 
+#include <algorithm>
+
 namespace latinime {
 
 const int SparseTable::NOT_EXIST = -1;
 const int SparseTable::INDEX_SIZE = 4;
+const int SparseTable::MAX_PREFETCHED_READ_COUNT = 16;
 
 bool SparseTable::contains(const int id) const {
-    const int readingPos = getPosInIndexTable(id);
-    if (id < 0 || mIndexTableBuffer->getTailPosition() <= readingPos) {
-        return false;
-    }
-    const int index = mIndexTableBuffer->readUint(INDEX_SIZE, readingPos);
-    return index != NOT_EXIST;
+    return getIndex(id) != NOT_EXIST;
 }
 
 uint32_t SparseTable::get(const int id) const {
-    const int indexTableReadingPos = getPosInIndexTable(id);
-    const int index = mIndexTableBuffer->readUint(INDEX_SIZE, indexTableReadingPos);
+    const int index = getIndex(id);
     const int contentTableReadingPos = getPosInContentTable(id, index);
     if (contentTableReadingPos < 0
             || contentTableReadingPos >= mContentTableBuffer->getTailPosition()) {
@@ -44,7 +41,41 @@ uint32_t SparseTable::get(const int id) const {
     return contentValue == NOT_EXIST ? NOT_A_DICT_POS : contentValue;
 }
 
+void SparseTable::getMany(const int *const ids, const int count,
+        uint32_t *const outValues) const {
+    int contentTableReadingPositions[MAX_PREFETCHED_READ_COUNT];
+    for (int begin = 0; begin < count; begin += MAX_PREFETCHED_READ_COUNT) {
+        const int end = std::min(count, begin + MAX_PREFETCHED_READ_COUNT);
+        for (int i = begin; i < end; ++i) {
+            const int index = getIndex(ids[i]);
+            const int contentTableReadingPos = index == NOT_EXIST ? NOT_A_DICT_POS
+                    : getPosInContentTable(ids[i], index);
+            if (contentTableReadingPos >= mContentTableBuffer->getTailPosition()) {
+                AKLOGE("contentTableReadingPos(%d) is invalid. id: %d, index: %d",
+                        contentTableReadingPos, ids[i], index);
+                contentTableReadingPositions[i - begin] = NOT_A_DICT_POS;
+                continue;
+            }
+            contentTableReadingPositions[i - begin] = contentTableReadingPos;
+            if (contentTableReadingPos != NOT_A_DICT_POS) {
+                mContentTableBuffer->prefetch(contentTableReadingPos);
+            }
+        }
+        for (int i = begin; i < end; ++i) {
+            const int contentTableReadingPos = contentTableReadingPositions[i - begin];
+            if (contentTableReadingPos == NOT_A_DICT_POS) {
+                outValues[i] = NOT_A_DICT_POS;
+                continue;
+            }
+            const int contentValue =
+                    mContentTableBuffer->readUint(mDataSize, contentTableReadingPos);
+            outValues[i] = contentValue == NOT_EXIST ? NOT_A_DICT_POS : contentValue;
+        }
+    }
+}
+
 bool SparseTable::set(const int id, const uint32_t value) {
+    loadIndexDirectoryIfNeeded();
     const int posInIndexTable = getPosInIndexTable(id);
     // Extends the index table if needed.
     int tailPos = mIndexTableBuffer->getTailPosition();
@@ -53,10 +84,11 @@ bool SparseTable::set(const int id, const uint32_t value) {
             AKLOGE("cannot extend index table. tailPos: %d to: %d", tailPos, posInIndexTable);
             return false;
         }
+        mIndexDirectory.push_back(NOT_EXIST);
     }
     if (contains(id)) {
         // The entry is already in the content table.
-        const int index = mIndexTableBuffer->readUint(INDEX_SIZE, posInIndexTable);
+        const int index = getIndex(id);
         if (!mContentTableBuffer->writeUint(value, mDataSize, getPosInContentTable(id, index))) {
             AKLOGE("cannot update value %d. pos: %d, tailPos: %d, mDataSize: %d", value,
                     getPosInContentTable(id, index), mContentTableBuffer->getTailPosition(),
@@ -72,6 +104,7 @@ bool SparseTable::set(const int id, const uint32_t value) {
         AKLOGE("cannot write index %d. pos %d", index, posInIndexTable);
         return false;
     }
+    mIndexDirectory[id / mBlockSize] = index;
     // Write a new block that containing the entry to be set.
     int writingPos = getPosInContentTable(0 /* id */, index);
     for (int i = 0; i < mBlockSize; ++i) {
@@ -85,6 +118,14 @@ bool SparseTable::set(const int id, const uint32_t value) {
     return mContentTableBuffer->writeUint(value, mDataSize, getPosInContentTable(id, index));
 }
 
+void SparseTable::loadIndexDirectory() const {
+    const int indexCount = mIndexTableBuffer->getTailPosition() / INDEX_SIZE;
+    mIndexDirectory.reserve(indexCount);
+    for (int i = 0; i < indexCount; ++i) {
+        mIndexDirectory.push_back(mIndexTableBuffer->readUint(INDEX_SIZE, i * INDEX_SIZE));
+    }
+}
+
 int SparseTable::getIndexFromContentTablePos(const int contentTablePos) const {
     return contentTablePos / mDataSize / mBlockSize;
 }
@@ -18,6 +18,8 @@
 #define LATINIME_SPARSE_TABLE_H
 
 #include <cstdint>
+#include <mutex>
+#include <vector>
 
 #include "defines.h"
 #include "dictionary/utils/buffer_with_extendable_buffer.h"
@@ -31,17 +33,38 @@ class SparseTable {
             BufferWithExtendableBuffer *const contentTableBuffer, const int blockSize,
             const int dataSize)
             : mIndexTableBuffer(indexTableBuffer), mContentTableBuffer(contentTableBuffer),
-              mBlockSize(blockSize), mDataSize(dataSize) {}
+              mBlockSize(blockSize), mDataSize(dataSize), mIndexDirectory(),
+              mIndexDirectoryOnceFlag() {}
 
     bool contains(const int id) const;
 
     uint32_t get(const int id) const;
 
+    // Outputs the value of ids[i] to outValues[i], or NOT_A_DICT_POS when the table doesn't
+    // contain ids[i]. The content reads are prefetched so that they overlap.
+    void getMany(const int *const ids, const int count, uint32_t *const outValues) const;
+
     bool set(const int id, const uint32_t value);
 
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(SparseTable);
 
+    void loadIndexDirectory() const;
+
+    AK_FORCE_INLINE void loadIndexDirectoryIfNeeded() const {
+        std::call_once(mIndexDirectoryOnceFlag, &SparseTable::loadIndexDirectory, this);
+    }
+
+    // Returns NOT_EXIST when no block has been allocated for the id.
+    AK_FORCE_INLINE int getIndex(const int id) const {
+        if (id < 0) {
+            return NOT_EXIST;
+        }
+        loadIndexDirectoryIfNeeded();
+        const size_t block = static_cast<size_t>(id / mBlockSize);
+        return block < mIndexDirectory.size() ? mIndexDirectory[block] : NOT_EXIST;
+    }
+
     int getIndexFromContentTablePos(const int contentTablePos) const;
 
     int getPosInIndexTable(const int id) const;
@@ -50,11 +73,17 @@ class SparseTable {
 
     static const int NOT_EXIST;
     static const int INDEX_SIZE;
+    static const int MAX_PREFETCHED_READ_COUNT;
 
     BufferWithExtendableBuffer *const mIndexTableBuffer;
     BufferWithExtendableBuffer *const mContentTableBuffer;
     const int mBlockSize;
     const int mDataSize;
+    // Copy of the index table, so that finding the block of an id is one array access instead of
+    // a read through the buffer. It is built on the first access rather than at open, because
+    // some tables, e.g. the shortcut tables, are rarely used.
+    mutable std::vector<int> mIndexDirectory;
+    mutable std::once_flag mIndexDirectoryOnceFlag;
 };
 } // namespace latinime
 #endif /* LATINIME_SPARSE_TABLE_H */
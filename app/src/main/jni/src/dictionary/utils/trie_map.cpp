@@ -16,6 +16,8 @@
 
 #include "dictionary/utils/trie_map.h"
 
+#include <algorithm>
+
 #include "dictionary/utils/dict_file_writing_utils.h"
 
 namespace latinime {
@@ -39,14 +41,18 @@ const int TrieMap::TERMINAL_LINKED_ENTRY_COUNT = 2; // Value entry and bitmap en
 const uint64_t TrieMap::MAX_VALUE =
         (static_cast<uint64_t>(1) << ((FIELD0_SIZE + FIELD1_SIZE) * CHAR_BIT)) - 1;
 const int TrieMap::MAX_BUFFER_SIZE = TERMINAL_LINK_MASK * ENTRY_SIZE;
+// Enough to cover the latency of a few cache misses while keeping the states in registers.
+const int TrieMap::MAX_INTERLEAVED_LOOKUP_COUNT = 8;
 
-TrieMap::TrieMap() : mBuffer(MAX_BUFFER_SIZE) {
+TrieMap::TrieMap(const bool usesValueLinks)
+        : mBuffer(MAX_BUFFER_SIZE), mUsesValueLinks(usesValueLinks) {
     mBuffer.extend(ROOT_BITMAP_ENTRY_POS);
     writeEntry(EMPTY_BITMAP_ENTRY, ROOT_BITMAP_ENTRY_INDEX);
 }
 
-TrieMap::TrieMap(const ReadWriteByteArrayView buffer)
-        : mBuffer(buffer, BufferWithExtendableBuffer::DEFAULT_MAX_ADDITIONAL_BUFFER_SIZE) {}
+TrieMap::TrieMap(const ReadWriteByteArrayView buffer, const bool usesValueLinks)
+        : mBuffer(buffer, BufferWithExtendableBuffer::DEFAULT_MAX_ADDITIONAL_BUFFER_SIZE),
+          mUsesValueLinks(usesValueLinks) {}
 
 void TrieMap::dump(const int from, const int to) const {
     AKLOGI("BufSize: %d", mBuffer.getTailPosition());
@@ -74,15 +80,17 @@ int TrieMap::getNextLevelBitmapEntryIndex(const int key, const int bitmapEntryIn
         return INVALID_INDEX;
     }
     const Entry terminalEntry = readEntry(terminalEntryIndex);
-    if (terminalEntry.hasTerminalLink()) {
-        return terminalEntry.getValueEntryIndex() + 1;
+    if (terminalEntry.getNextLevelBitmapEntryIndex() != INVALID_INDEX) {
+        return terminalEntry.getNextLevelBitmapEntryIndex();
     }
     // Create a value entry and a bitmap entry.
     const int valueEntryIndex = allocateTable(TERMINAL_LINKED_ENTRY_COUNT);
     if (valueEntryIndex == INVALID_INDEX) {
         return INVALID_INDEX;
     }
-    if (!writeEntry(Entry(0, terminalEntry.getValue()), valueEntryIndex)) {
+    const Entry valueEntry = terminalEntry.hasValueLink()
+            ? readEntry(terminalEntry.getValueEntryIndex()) : Entry(0, terminalEntry.getValue());
+    if (!writeEntry(valueEntry, valueEntryIndex)) {
         return INVALID_INDEX;
     }
     if (!writeEntry(EMPTY_BITMAP_ENTRY, valueEntryIndex + 1)) {
@@ -91,6 +99,10 @@ int TrieMap::getNextLevelBitmapEntryIndex(const int key, const int bitmapEntryIn
     if (!writeField1(valueEntryIndex | TERMINAL_LINK_FLAG, terminalEntryIndex)) {
         return INVALID_INDEX;
     }
+    if (terminalEntry.hasValueLink()
+            && !freeTable(terminalEntry.getValueEntryIndex(), 1 /* entryCount */)) {
+        return INVALID_INDEX;
+    }
     return valueEntryIndex + 1;
 }
 
@@ -100,6 +112,14 @@ const TrieMap::Result TrieMap::get(const int key, const int bitmapEntryIndex) co
             0 /* level */);
 }
 
+void TrieMap::getMulti(const int *const keys, const int *const bitmapEntryIndices,
+        const int count, Result *const outResults) const {
+    for (int i = 0; i < count; i += MAX_INTERLEAVED_LOOKUP_COUNT) {
+        getMultiInternal(keys + i, bitmapEntryIndices + i,
+                std::min(count - i, MAX_INTERLEAVED_LOOKUP_COUNT), outResults + i);
+    }
+}
+
 bool TrieMap::put(const int key, const uint64_t value, const int bitmapEntryIndex) {
     if (value > MAX_VALUE) {
         return false;
@@ -127,13 +147,7 @@ bool TrieMap::remove(const int key, const int bitmapEntryIndex) {
         return false;
     }
     if (terminalEntry.hasTerminalLink()) {
-        const Entry nextLevelBitmapEntry = readEntry(terminalEntry.getValueEntryIndex() + 1);
-        if (!freeTable(terminalEntry.getValueEntryIndex(), TERMINAL_LINKED_ENTRY_COUNT)) {
-            return false;
-        }
-        if (!removeInner(nextLevelBitmapEntry)){
-            return false;
-        }
+        return freeValueEntries(terminalEntry);
     }
     return true;
 }
@@ -166,9 +180,9 @@ const TrieMap::Result TrieMap::iterateNext(std::vector<TableIterationState> *con
                 if (!entry.hasTerminalLink()) {
                     return Result(entry.getValue(), true, INVALID_INDEX);
                 }
-                const int valueEntryIndex = entry.getValueEntryIndex();
-                const Entry valueEntry = readEntry(valueEntryIndex);
-                return Result(valueEntry.getValueOfValueEntry(), true, valueEntryIndex + 1);
+                const Entry valueEntry = readEntry(entry.getValueEntryIndex());
+                return Result(valueEntry.getValueOfValueEntry(), true,
+                        entry.getNextLevelBitmapEntryIndex());
             }
         }
     }
@@ -196,6 +210,24 @@ bool TrieMap::writeValue(const uint64_t value, const int terminalEntryIndex) {
         // Write value into the terminal entry.
         return writeField1(value | VALUE_FLAG, terminalEntryIndex);
     }
+    if (mUsesValueLinks) {
+        // Create a value entry only. The bitmap entry is created with the next level map.
+        const int valueEntryIndex = allocateTable(1 /* entryCount */);
+        if (valueEntryIndex == INVALID_INDEX) {
+            return false;
+        }
+        if (static_cast<uint32_t>(valueEntryIndex) < VALUE_MASK) {
+            if (!writeEntry(Entry(value >> (FIELD1_SIZE * CHAR_BIT), value), valueEntryIndex)) {
+                return false;
+            }
+            return writeField1(valueEntryIndex | TERMINAL_LINK_FLAG | VALUE_FLAG,
+                    terminalEntryIndex);
+        }
+        // The index doesn't fit in a value link.
+        if (!freeTable(valueEntryIndex, 1 /* entryCount */)) {
+            return false;
+        }
+    }
     // Create value entry and write value.
     const int valueEntryIndex = allocateTable(TERMINAL_LINKED_ENTRY_COUNT);
     if (valueEntryIndex == INVALID_INDEX) {
@@ -215,6 +247,13 @@ bool TrieMap::updateValue(const Entry &terminalEntry, const uint64_t value,
     if (!terminalEntry.hasTerminalLink()) {
         return writeValue(value, terminalEntryIndex);
     }
+    if (terminalEntry.hasValueLink() && value < VALUE_MASK) {
+        // The value fits in the terminal entry again.
+        if (!freeTable(terminalEntry.getValueEntryIndex(), 1 /* entryCount */)) {
+            return false;
+        }
+        return writeValue(value, terminalEntryIndex);
+    }
     const int valueEntryIndex = terminalEntry.getValueEntryIndex();
     return writeEntry(Entry(value >> (FIELD1_SIZE * CHAR_BIT), value), valueEntryIndex);
 }
@@ -226,6 +265,18 @@ bool TrieMap::freeTable(const int tableIndex, const int entryCount) {
     return writeEmptyTableLink(tableIndex, entryCount);
 }
 
+// Frees the value entry of the terminal entry, and the next level map if any.
+bool TrieMap::freeValueEntries(const Entry &terminalEntry) {
+    if (terminalEntry.hasValueLink()) {
+        return freeTable(terminalEntry.getValueEntryIndex(), 1 /* entryCount */);
+    }
+    const Entry nextLevelBitmapEntry = readEntry(terminalEntry.getNextLevelBitmapEntryIndex());
+    if (!freeTable(terminalEntry.getValueEntryIndex(), TERMINAL_LINKED_ENTRY_COUNT)) {
+        return false;
+    }
+    return removeInner(nextLevelBitmapEntry);
+}
+
 /**
  * Allocate table with entryCount-entries. Reuse freed table if possible.
  */
@@ -250,23 +301,20 @@ int TrieMap::allocateTable(const int entryCount) {
 
 int TrieMap::getTerminalEntryIndex(const uint32_t key, const uint32_t hashedKey,
         const Entry &bitmapEntry, const int level) const {
-    const int label = getLabel(hashedKey, level);
-    if (!exists(bitmapEntry.getBitmap(), label)) {
-        return INVALID_INDEX;
-    }
-    const int entryIndex = bitmapEntry.getTableIndex() + popCount(bitmapEntry.getBitmap(), label);
-    const Entry entry = readEntry(entryIndex);
-    if (entry.isBitmapEntry()) {
-        // Move to the next level.
-        return getTerminalEntryIndex(key, hashedKey, entry, level + 1);
-    }
-    if (!entry.isValidTerminalEntry()) {
+    int entryIndex = getEntryIndexInTable(bitmapEntry, hashedKey, level);
+    for (int currentLevel = level + 1; entryIndex != INVALID_INDEX; ++currentLevel) {
+        const Entry entry = readEntry(entryIndex);
+        if (entry.isBitmapEntry()) {
+            // Move to the next level.
+            entryIndex = getEntryIndexInTable(entry, hashedKey, currentLevel);
+            continue;
+        }
+        if (entry.isValidTerminalEntry() && entry.getKey() == key) {
+            // Terminal entry is found.
+            return entryIndex;
+        }
         return INVALID_INDEX;
     }
-    if (entry.getKey() == key) {
-        // Terminal entry is found.
-        return entryIndex;
-    }
     return INVALID_INDEX;
 }
 
@@ -292,9 +340,65 @@ const TrieMap::Result TrieMap::getInternal(const uint32_t key, const uint32_t ha
     if (!terminalEntry.hasTerminalLink()) {
         return Result(terminalEntry.getValue(), true, INVALID_INDEX);
     }
-    const int valueEntryIndex = terminalEntry.getValueEntryIndex();
-    const Entry valueEntry = readEntry(valueEntryIndex);
-    return Result(valueEntry.getValueOfValueEntry(), true, valueEntryIndex + 1);
+    const Entry valueEntry = readEntry(terminalEntry.getValueEntryIndex());
+    return Result(valueEntry.getValueOfValueEntry(), true,
+            terminalEntry.getNextLevelBitmapEntryIndex());
+}
+
+void TrieMap::getMultiInternal(const int *const keys, const int *const bitmapEntryIndices,
+        const int count, Result *const outResults) const {
+    uint32_t hashedKeys[MAX_INTERLEAVED_LOOKUP_COUNT];
+    int levels[MAX_INTERLEAVED_LOOKUP_COUNT];
+    // The entry each lookup reads next. INVALID_INDEX when the lookup has finished.
+    int entryIndices[MAX_INTERLEAVED_LOOKUP_COUNT];
+    // Whether the entry to read next is the value entry of the found terminal entry.
+    bool readsValueEntry[MAX_INTERLEAVED_LOOKUP_COUNT];
+    int nextLevelBitmapEntryIndices[MAX_INTERLEAVED_LOOKUP_COUNT];
+    int remainingCount = 0;
+    for (int i = 0; i < count; ++i) {
+        outResults[i] = Result(0, false, INVALID_INDEX);
+        hashedKeys[i] = getBitShuffledKey(static_cast<uint32_t>(keys[i]));
+        levels[i] = 0;
+        entryIndices[i] = bitmapEntryIndices[i] == INVALID_INDEX ? INVALID_INDEX
+                : getEntryIndexInTable(readEntry(bitmapEntryIndices[i]), hashedKeys[i],
+                        0 /* level */);
+        readsValueEntry[i] = false;
+        if (entryIndices[i] != INVALID_INDEX) {
+            prefetchEntry(entryIndices[i]);
+            ++remainingCount;
+        }
+    }
+    while (remainingCount > 0) {
+        for (int i = 0; i < count; ++i) {
+            if (entryIndices[i] == INVALID_INDEX) {
+                continue;
+            }
+            const Entry entry = readEntry(entryIndices[i]);
+            if (readsValueEntry[i]) {
+                outResults[i] = Result(entry.getValueOfValueEntry(), true,
+                        nextLevelBitmapEntryIndices[i]);
+                entryIndices[i] = INVALID_INDEX;
+            } else if (entry.isBitmapEntry()) {
+                ++levels[i];
+                entryIndices[i] = getEntryIndexInTable(entry, hashedKeys[i], levels[i]);
+            } else if (!entry.isValidTerminalEntry()
+                    || entry.getKey() != static_cast<uint32_t>(keys[i])) {
+                entryIndices[i] = INVALID_INDEX;
+            } else if (!entry.hasTerminalLink()) {
+                outResults[i] = Result(entry.getValue(), true, INVALID_INDEX);
+                entryIndices[i] = INVALID_INDEX;
+            } else {
+                readsValueEntry[i] = true;
+                nextLevelBitmapEntryIndices[i] = entry.getNextLevelBitmapEntryIndex();
+                entryIndices[i] = entry.getValueEntryIndex();
+            }
+            if (entryIndices[i] == INVALID_INDEX) {
+                --remainingCount;
+            } else {
+                prefetchEntry(entryIndices[i]);
+            }
+        }
+    }
 }
 
 /**
@@ -443,14 +547,8 @@ bool TrieMap::removeInner(const Entry &bitmapEntry) {
             if (!writeField1(VALUE_FLAG ^ INVALID_VALUE_IN_KEY_VALUE_ENTRY , entryIndex)) {
                 return false;
             }
-            if (entry.hasTerminalLink()) {
-                const Entry nextLevelBitmapEntry = readEntry(entry.getValueEntryIndex() + 1);
-                if (!freeTable(entry.getValueEntryIndex(), TERMINAL_LINKED_ENTRY_COUNT)) {
-                    return false;
-                }
-                if (!removeInner(nextLevelBitmapEntry)) {
-                    return false;
-                }
+            if (entry.hasTerminalLink() && !freeValueEntries(entry)) {
+                return false;
             }
         }
     }
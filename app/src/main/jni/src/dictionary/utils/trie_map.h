@@ -24,6 +24,7 @@
 
 #include "defines.h"
 #include "dictionary/utils/buffer_with_extendable_buffer.h"
+#include "dictionary/utils/byte_array_utils.h"
 #include "utils/byte_array_view.h"
 
 namespace latinime {
@@ -37,9 +38,11 @@ namespace latinime {
 class TrieMap {
  public:
     struct Result {
-        const uint64_t mValue;
-        const bool mIsValid;
-        const int mNextLevelBitmapEntryIndex;
+        uint64_t mValue;
+        bool mIsValid;
+        int mNextLevelBitmapEntryIndex;
+
+        Result() : mValue(0), mIsValid(false), mNextLevelBitmapEntryIndex(INVALID_INDEX) {}
 
         Result(const uint64_t value, const bool isValid, const int nextLevelBitmapEntryIndex)
                 : mValue(value), mIsValid(isValid),
@@ -164,15 +167,27 @@ class TrieMap {
     static const int INVALID_INDEX;
     static const uint64_t MAX_VALUE;
 
-    TrieMap();
+    // When usesValueLinks is true, values that don't fit in a terminal entry are written to a
+    // value entry without a bitmap entry until the key gets a next level map. Maps with value links
+    // cannot be read by the code from before they were introduced, so they are only used for
+    // dictionary formats that came after.
+    explicit TrieMap(const bool usesValueLinks = false);
     // Construct TrieMap using existing data in the memory region written by save().
-    TrieMap(const ReadWriteByteArrayView buffer);
+    TrieMap(const ReadWriteByteArrayView buffer, const bool usesValueLinks);
     void dump(const int from = 0, const int to = 0) const;
 
     bool isNearSizeLimit() const {
         return mBuffer.isNearSizeLimit();
     }
 
+    bool isNearHardSizeLimit() const {
+        return mBuffer.isNearHardSizeLimit();
+    }
+
+    int getUsedAdditionalBufferSize() const {
+        return mBuffer.getUsedAdditionalBufferSize();
+    }
+
     int getRootBitmapEntryIndex() const {
         return ROOT_BITMAP_ENTRY_INDEX;
     }
@@ -190,6 +205,11 @@ class TrieMap {
 
     const Result get(const int key, const int bitmapEntryIndex) const;
 
+    // Looks up keys[i] in the map level of bitmapEntryIndices[i] for each i. The lookups advance
+    // together and prefetch their next entries, so that their memory accesses overlap.
+    void getMulti(const int *const keys, const int *const bitmapEntryIndices, const int count,
+            Result *const outResults) const;
+
     bool putRoot(const int key, const uint64_t value) {
         return put(key, value, ROOT_BITMAP_ENTRY_INDEX);
     }
@@ -220,8 +240,11 @@ class TrieMap {
      *   FIELD_0(bitmap) FIELD_1(LINK_TO_HASH_TABLE)
      * 2. terminal entry. terminal entry contains hashed key and value or terminal link. terminal
      * entry have terminal link when the value is not fit to FIELD_1 or there is a next level map
-     * for the key.
-     *   FIELD_0(hashed key) (FIELD_1(VALUE_FLAG VALUE) | FIELD_1(TERMINAL_LINK_FLAG TERMINAL_LINK))
+     * for the key. The terminal link points to a value entry followed by the bitmap entry of the
+     * next level map. A value link points to a value entry only, and is used instead when there is
+     * no next level map.
+     *   FIELD_0(hashed key) (FIELD_1(VALUE_FLAG VALUE) | FIELD_1(TERMINAL_LINK_FLAG TERMINAL_LINK)
+     *           | FIELD_1(TERMINAL_LINK_FLAG VALUE_FLAG VALUE_LINK))
      * 3. value entry. value entry represents a value. Upper order bytes are stored in FIELD_0 and
      * lower order bytes are stored in FIELD_1.
      *   FIELD_0(value (upper order bytes)) FIELD_1(value (lower order bytes))
@@ -236,10 +259,17 @@ class TrieMap {
             return (mData1 & VALUE_FLAG) == 0 && (mData1 & TERMINAL_LINK_FLAG) == 0;
         }
 
+        // For terminal entry. Whether the value is in a value entry, which is the case for value
+        // links too.
         AK_FORCE_INLINE bool hasTerminalLink() const {
             return (mData1 & TERMINAL_LINK_FLAG) != 0;
         }
 
+        // For terminal entry.
+        AK_FORCE_INLINE bool hasValueLink() const {
+            return (mData1 & TERMINAL_LINK_FLAG) != 0 && (mData1 & VALUE_FLAG) != 0;
+        }
+
         // For terminal entry.
         AK_FORCE_INLINE uint32_t getKey() const {
             return mData0;
@@ -257,7 +287,15 @@ class TrieMap {
 
         // For terminal entry.
         AK_FORCE_INLINE uint32_t getValueEntryIndex() const {
-            return mData1 & TERMINAL_LINK_MASK;
+            return mData1 & (hasValueLink() ? VALUE_MASK : TERMINAL_LINK_MASK);
+        }
+
+        // For terminal entry.
+        AK_FORCE_INLINE int getNextLevelBitmapEntryIndex() const {
+            if (!hasTerminalLink() || hasValueLink()) {
+                return INVALID_INDEX;
+            }
+            return static_cast<int>(getValueEntryIndex()) + 1;
         }
 
         // For bitmap entry.
@@ -277,6 +315,7 @@ class TrieMap {
     };
 
     BufferWithExtendableBuffer mBuffer;
+    const bool mUsesValueLinks;
 
     static const int FIELD0_SIZE;
     static const int FIELD1_SIZE;
@@ -294,17 +333,21 @@ class TrieMap {
     static const Entry EMPTY_BITMAP_ENTRY;
     static const int TERMINAL_LINKED_ENTRY_COUNT;
     static const int MAX_BUFFER_SIZE;
+    static const int MAX_INTERLEAVED_LOOKUP_COUNT;
 
     uint32_t getBitShuffledKey(const uint32_t key) const;
     bool writeValue(const uint64_t value, const int terminalEntryIndex);
     bool updateValue(const Entry &terminalEntry, const uint64_t value,
             const int terminalEntryIndex);
     bool freeTable(const int tableIndex, const int entryCount);
+    bool freeValueEntries(const Entry &terminalEntry);
     int allocateTable(const int entryCount);
     int getTerminalEntryIndex(const uint32_t key, const uint32_t hashedKey,
             const Entry &bitmapEntry, const int level) const;
     const Result getInternal(const uint32_t key, const uint32_t hashedKey,
             const int bitmapEntryIndex, const int level) const;
+    void getMultiInternal(const int *const keys, const int *const bitmapEntryIndices,
+            const int count, Result *const outResults) const;
     bool putInternal(const uint32_t key, const uint64_t value, const uint32_t hashedKey,
             const int bitmapEntryIndex, const Entry &bitmapEntry, const int level);
     bool addNewEntryByResolvingConflict(const uint32_t key, const uint64_t value,
@@ -317,6 +360,12 @@ class TrieMap {
             int *const outKey) const;
 
     AK_FORCE_INLINE const Entry readEntry(const int entryIndex) const {
+        const uint8_t *const entry = mBuffer.getContiguousBytes(
+                ROOT_BITMAP_ENTRY_POS + entryIndex * ENTRY_SIZE, ENTRY_SIZE);
+        if (entry) {
+            return Entry(ByteArrayUtils::readUint32(entry, 0 /* pos */),
+                    ByteArrayUtils::readUint24(entry, FIELD0_SIZE));
+        }
         return Entry(readField0(entryIndex), readField1(entryIndex));
     }
 
@@ -326,6 +375,17 @@ class TrieMap {
         return (bitmap & (1 << index)) != 0;
     }
 
+    // Returns the index of the entry for the label of hashedKey in the table of bitmapEntry, or
+    // INVALID_INDEX when the table doesn't have it.
+    AK_FORCE_INLINE int getEntryIndexInTable(const Entry &bitmapEntry, const uint32_t hashedKey,
+            const int level) const {
+        const int label = getLabel(hashedKey, level);
+        if (!exists(bitmapEntry.getBitmap(), label)) {
+            return INVALID_INDEX;
+        }
+        return bitmapEntry.getTableIndex() + popCount(bitmapEntry.getBitmap(), label);
+    }
+
     // Set index-th bit in the bitmap.
     AK_FORCE_INLINE uint32_t setExist(const uint32_t bitmap, const int index) const {
         return bitmap | (1 << index);
@@ -352,6 +412,10 @@ class TrieMap {
         return mBuffer.readUint(FIELD0_SIZE, ROOT_BITMAP_ENTRY_POS + entryIndex * ENTRY_SIZE);
     }
 
+    AK_FORCE_INLINE void prefetchEntry(const int entryIndex) const {
+        mBuffer.prefetch(ROOT_BITMAP_ENTRY_POS + entryIndex * ENTRY_SIZE);
+    }
+
     AK_FORCE_INLINE uint32_t readField1(const int entryIndex) const {
         return mBuffer.readUint(FIELD1_SIZE,
                 ROOT_BITMAP_ENTRY_POS + entryIndex * ENTRY_SIZE + FIELD0_SIZE);
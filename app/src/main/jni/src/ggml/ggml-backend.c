@@ -217,6 +217,7 @@ struct ggml_backend_cpu_context {
     int n_threads;
     void * work_data;
     size_t work_size;
+    struct ggml_threadpool * threadpool;
 };
 
 static const char * ggml_backend_cpu_name(ggml_backend_t backend) {
@@ -227,6 +228,7 @@ static const char * ggml_backend_cpu_name(ggml_backend_t backend) {
 
 static void ggml_backend_cpu_free(ggml_backend_t backend) {
     struct ggml_backend_cpu_context * cpu_ctx = (struct ggml_backend_cpu_context *)backend->context;
+    ggml_threadpool_free(cpu_ctx->threadpool);
     free(cpu_ctx->work_data);
     free(cpu_ctx);
     free(backend);
@@ -319,6 +321,7 @@ static ggml_backend_graph_plan_t ggml_backend_cpu_graph_plan_create(ggml_backend
     struct ggml_backend_plan_cpu * cpu_plan = malloc(sizeof(struct ggml_backend_plan_cpu));
 
     cpu_plan->cplan = ggml_graph_plan(cgraph, cpu_ctx->n_threads);
+    cpu_plan->cplan.threadpool = cpu_ctx->threadpool;
     cpu_plan->cgraph = *cgraph;
 
     if (cpu_plan->cplan.work_size > 0) {
@@ -357,6 +360,7 @@ static void ggml_backend_cpu_graph_compute(ggml_backend_t backend, struct ggml_c
     }
 
     cplan.work_data = cpu_ctx->work_data;
+    cplan.threadpool = cpu_ctx->threadpool;
 
     ggml_graph_compute(cgraph, &cplan);
 }
@@ -390,6 +394,7 @@ ggml_backend_t ggml_backend_cpu_init(void) {
     ctx->n_threads = GGML_DEFAULT_N_THREADS;
     ctx->work_data = NULL;
     ctx->work_size = 0;
+    ctx->threadpool = ggml_threadpool_new();
 
     ggml_backend_t cpu_backend = malloc(sizeof(struct ggml_backend));
 
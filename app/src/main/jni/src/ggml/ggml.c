@@ -1205,9 +1205,154 @@ static void ggml_vec_dot_f32(const int n, float * restrict s, const float * rest
     *s = sumf;
 }
 
+#if defined(__ARM_NEON) && defined(__aarch64__) && !defined(__ARM_FEATURE_FP16_VECTOR_ARITHMETIC) && defined(__linux__)
+// The arm64 build targets baseline ARMv8-A, so the F16 NEON macros above go through F32. CPUs with the
+// ARMv8.2-A half precision arithmetic are detected at runtime and get F16 dot products instead, written
+// with inline assembly because the intrinsics need the whole file to be compiled for fp16.
+#define GGML_FP16_DISPATCH
+
+#include <sys/auxv.h>
+
+#ifndef HWCAP_ASIMDHP
+#define HWCAP_ASIMDHP (1 << 10)
+#endif
+
+static bool ggml_arm_fp16_va = false;
+
+inline static float16x8_t ggml_vfmaq_f16(float16x8_t a, float16x8_t b, float16x8_t c) {
+    __asm__(".arch_extension fp16\n\t"
+            "fmla %0.8h, %1.8h, %2.8h" : "+w"(a) : "w"(b), "w"(c));
+    return a;
+}
+
+inline static float16x8_t ggml_vaddq_f16(float16x8_t a, float16x8_t b) {
+    __asm__(".arch_extension fp16\n\t"
+            "fadd %0.8h, %0.8h, %1.8h" : "+w"(a) : "w"(b));
+    return a;
+}
+
+// the half precision sums only take GGML_FP16_DOT_BLOCK elements before they are added to single
+// precision ones, so that long rows do not lose their smaller products to the 11 bit mantissa
+#define GGML_FP16_DOT_BLOCK 256
+
+// adds sum0..sum3 to acc and clears them
+inline static float32x4_t ggml_vec_reduce_fp16(float32x4_t acc, float16x8_t * sum) {
+    sum[0] = ggml_vaddq_f16(sum[0], sum[2]);
+    sum[1] = ggml_vaddq_f16(sum[1], sum[3]);
+    sum[0] = ggml_vaddq_f16(sum[0], sum[1]);
+
+    acc = vaddq_f32(acc, vcvt_f32_f16(vget_low_f16 (sum[0])));
+    acc = vaddq_f32(acc, vcvt_f32_f16(vget_high_f16(sum[0])));
+
+    for (int j = 0; j < 4; j++) {
+        sum[j] = vreinterpretq_f16_u16(vdupq_n_u16(0));
+    }
+
+    return acc;
+}
+
+static void ggml_vec_dot_f16_fp16(const int n, float * restrict s, ggml_fp16_t * restrict x, ggml_fp16_t * restrict y) {
+    ggml_float sumf = 0.0;
+
+    const int np = (n & ~31);
+
+    float16x8_t sum[4];
+    for (int j = 0; j < 4; j++) {
+        sum[j] = vreinterpretq_f16_u16(vdupq_n_u16(0));
+    }
+
+    float32x4_t acc = vdupq_n_f32(0.0f);
+
+    for (int i0 = 0; i0 < np; i0 += GGML_FP16_DOT_BLOCK) {
+        const int i1 = MIN(i0 + GGML_FP16_DOT_BLOCK, np);
+
+        for (int i = i0; i < i1; i += 32) {
+            for (int j = 0; j < 4; j++) {
+                const float16x8_t ax = vld1q_f16(x + i + j*8);
+                const float16x8_t ay = vld1q_f16(y + i + j*8);
+
+                sum[j] = ggml_vfmaq_f16(sum[j], ax, ay);
+            }
+        }
+
+        acc = ggml_vec_reduce_fp16(acc, sum);
+    }
+
+    sumf = (ggml_float) vaddvq_f32(acc);
+
+    // leftovers
+    for (int i = np; i < n; ++i) {
+        sumf += (ggml_float)(GGML_FP16_TO_FP32(x[i])*GGML_FP16_TO_FP32(y[i]));
+    }
+
+    *s = sumf;
+}
+
+// the GGML_VEC_DOT_UNROLL rows of x share the loads of y, used by the flash attention
+static void ggml_vec_dot_f16_unroll_fp16(const int n, const int xs, float * restrict s, void * restrict xv, ggml_fp16_t * restrict y) {
+    ggml_fp16_t * restrict x[GGML_VEC_DOT_UNROLL];
+
+    for (int k = 0; k < GGML_VEC_DOT_UNROLL; ++k) {
+        x[k] = (ggml_fp16_t *) ((char *) xv + k*xs);
+    }
+
+    const int np = (n & ~31);
+
+    float16x8_t sum[GGML_VEC_DOT_UNROLL][4];
+    for (int k = 0; k < GGML_VEC_DOT_UNROLL; ++k) {
+        for (int j = 0; j < 4; j++) {
+            sum[k][j] = vreinterpretq_f16_u16(vdupq_n_u16(0));
+        }
+    }
+
+    float32x4_t acc[GGML_VEC_DOT_UNROLL];
+    for (int k = 0; k < GGML_VEC_DOT_UNROLL; ++k) {
+        acc[k] = vdupq_n_f32(0.0f);
+    }
+
+    for (int i0 = 0; i0 < np; i0 += GGML_FP16_DOT_BLOCK) {
+        const int i1 = MIN(i0 + GGML_FP16_DOT_BLOCK, np);
+
+        for (int i = i0; i < i1; i += 32) {
+            for (int j = 0; j < 4; j++) {
+                const float16x8_t ay = vld1q_f16(y + i + j*8);
+
+                for (int k = 0; k < GGML_VEC_DOT_UNROLL; ++k) {
+                    const float16x8_t ax = vld1q_f16(x[k] + i + j*8);
+
+                    sum[k][j] = ggml_vfmaq_f16(sum[k][j], ax, ay);
+                }
+            }
+        }
+
+        for (int k = 0; k < GGML_VEC_DOT_UNROLL; ++k) {
+            acc[k] = ggml_vec_reduce_fp16(acc[k], sum[k]);
+        }
+    }
+
+    for (int k = 0; k < GGML_VEC_DOT_UNROLL; ++k) {
+        ggml_float sumf = (ggml_float) vaddvq_f32(acc[k]);
+
+        // leftovers
+        for (int i = np; i < n; ++i) {
+            sumf += (ggml_float)(GGML_FP16_TO_FP32(x[k][i])*GGML_FP16_TO_FP32(y[i]));
+        }
+
+        s[k] = sumf;
+    }
+}
+#endif
+
 static void ggml_vec_dot_f16(const int n, float * restrict s, ggml_fp16_t * restrict x, ggml_fp16_t * restrict y) {
     ggml_float sumf = 0.0;
 
+#if defined(GGML_FP16_DISPATCH)
+    if (ggml_arm_fp16_va) {
+        ggml_vec_dot_f16_fp16(n, s, x, y);
+        return;
+    }
+#endif
+
 #if defined(GGML_SIMD)
     const int np = (n & ~(GGML_F16_STEP - 1));
 
@@ -1244,6 +1389,13 @@ static void ggml_vec_dot_f16(const int n, float * restrict s, ggml_fp16_t * rest
 // compute GGML_VEC_DOT_UNROLL dot products at once
 // xs - x row stride in bytes
 inline static void ggml_vec_dot_f16_unroll(const int n, const int xs, float * restrict s, void * restrict xv, ggml_fp16_t * restrict y) {
+#if defined(GGML_FP16_DISPATCH)
+    if (ggml_arm_fp16_va) {
+        ggml_vec_dot_f16_unroll_fp16(n, xs, s, xv, y);
+        return;
+    }
+#endif
+
     ggml_float sumf[GGML_VEC_DOT_UNROLL] = { 0.0 };
 
     ggml_fp16_t * restrict x[GGML_VEC_DOT_UNROLL];
@@ -1619,8 +1771,10 @@ static const char * GGML_OP_NAME[GGML_OP_COUNT] = {
     "RMS_NORM",
     "RMS_NORM_BACK",
     "GROUP_NORM",
+    "NORM_MUL_ADD",
 
     "MUL_MAT",
+    "MUL_MAT_ADD_GELU",
     "OUT_PROD",
 
     "SCALE",
@@ -1644,6 +1798,7 @@ static const char * GGML_OP_NAME[GGML_OP_COUNT] = {
     "CLAMP",
     "CONV_TRANSPOSE_1D",
     "IM2COL",
+    "CONV_1D_PH_GELU",
     "CONV_TRANSPOSE_2D",
     "POOL_1D",
     "POOL_2D",
@@ -1674,7 +1829,7 @@ static const char * GGML_OP_NAME[GGML_OP_COUNT] = {
     "CROSS_ENTROPY_LOSS_BACK",
 };
 
-static_assert(GGML_OP_COUNT == 68, "GGML_OP_COUNT != 68");
+static_assert(GGML_OP_COUNT == 71, "GGML_OP_COUNT != 71");
 
 static const char * GGML_OP_SYMBOL[GGML_OP_COUNT] = {
     "none",
@@ -1701,8 +1856,10 @@ static const char * GGML_OP_SYMBOL[GGML_OP_COUNT] = {
     "rms_norm(x)",
     "rms_norm_back(x)",
     "group_norm(x)",
+    "norm(x)*y+z",
 
     "X*Y",
+    "gelu(X*Y+z)",
     "X*Y",
 
     "x*v",
@@ -1726,6 +1883,7 @@ static const char * GGML_OP_SYMBOL[GGML_OP_COUNT] = {
     "clamp(x)",
     "conv_transpose_1d(x)",
     "im2col(x)",
+    "gelu(conv_1d_ph(x)+b)",
     "conv_transpose_2d(x)",
     "pool_1d(x)",
     "pool_2d(x)",
@@ -1756,7 +1914,7 @@ static const char * GGML_OP_SYMBOL[GGML_OP_COUNT] = {
     "cross_entropy_loss_back(x,y)",
 };
 
-static_assert(GGML_OP_COUNT == 68, "GGML_OP_COUNT != 68");
+static_assert(GGML_OP_COUNT == 71, "GGML_OP_COUNT != 71");
 
 static_assert(GGML_OP_POOL_COUNT == 2, "GGML_OP_POOL_COUNT != 2");
 
@@ -1779,6 +1937,7 @@ static void ggml_setup_op_has_task_pass(void) {
 
         p[GGML_OP_ACC                    ] = true;
         p[GGML_OP_MUL_MAT                ] = true;
+        p[GGML_OP_MUL_MAT_ADD_GELU       ] = true;
         p[GGML_OP_OUT_PROD               ] = true;
         p[GGML_OP_SET                    ] = true;
         p[GGML_OP_GET_ROWS_BACK          ] = true;
@@ -2193,6 +2352,12 @@ struct ggml_context * ggml_init(struct ggml_init_params params) {
         // initialize time system (required on Windows)
         ggml_time_init();
 
+        // pick the dot products for the CPU features found at runtime
+        ggml_quants_init_cpu_features();
+#if defined(GGML_FP16_DISPATCH)
+        ggml_arm_fp16_va = (getauxval(AT_HWCAP) & HWCAP_ASIMDHP) != 0;
+#endif
+
         // initialize GELU, Quick GELU, SILU and EXP F32 tables
         {
             const uint64_t t_start = ggml_time_us(); UNUSED(t_start);
@@ -3935,6 +4100,37 @@ struct ggml_tensor * ggml_norm_inplace(
     return ggml_norm_impl(ctx, a, eps, true);
 }
 
+// ggml_norm_mul_add
+
+struct ggml_tensor * ggml_norm_mul_add(
+        struct ggml_context * ctx,
+        struct ggml_tensor  * a,
+        struct ggml_tensor  * b,
+        struct ggml_tensor  * c,
+        float eps) {
+    GGML_ASSERT(b->ne[0] == a->ne[0] && ggml_nelements(b) == a->ne[0]);
+    GGML_ASSERT(c->ne[0] == a->ne[0] && ggml_nelements(c) == a->ne[0]);
+
+    bool is_node = false;
+
+    if (a->grad || b->grad || c->grad) {
+        GGML_ASSERT(false); // TODO: implement backward
+        is_node = true;
+    }
+
+    struct ggml_tensor * result = ggml_dup_tensor(ctx, a);
+
+    ggml_set_op_params(result, &eps, sizeof(eps));
+
+    result->op   = GGML_OP_NORM_MUL_ADD;
+    result->grad = is_node ? ggml_dup_tensor(ctx, result) : NULL;
+    result->src[0] = a;
+    result->src[1] = b;
+    result->src[2] = c;
+
+    return result;
+}
+
 // ggml_rms_norm
 
 static struct ggml_tensor * ggml_rms_norm_impl(
@@ -4064,6 +4260,36 @@ struct ggml_tensor * ggml_mul_mat(
     return result;
 }
 
+// ggml_mul_mat_add_gelu
+
+struct ggml_tensor * ggml_mul_mat_add_gelu(
+        struct ggml_context * ctx,
+        struct ggml_tensor  * a,
+        struct ggml_tensor  * b,
+        struct ggml_tensor  * c) {
+    GGML_ASSERT(ggml_can_mul_mat(a, b));
+    GGML_ASSERT(!ggml_is_transposed(a));
+    GGML_ASSERT(c->ne[0] == a->ne[1] && ggml_nelements(c) == a->ne[1]);
+
+    bool is_node = false;
+
+    if (a->grad || b->grad || c->grad) {
+        GGML_ASSERT(false); // TODO: implement backward
+        is_node = true;
+    }
+
+    const int64_t ne[4] = { a->ne[1], b->ne[1], b->ne[2], b->ne[3] };
+    struct ggml_tensor * result = ggml_new_tensor(ctx, GGML_TYPE_F32, MAX(a->n_dims, b->n_dims), ne);
+
+    result->op   = GGML_OP_MUL_MAT_ADD_GELU;
+    result->grad = is_node ? ggml_dup_tensor(ctx, result) : NULL;
+    result->src[0] = a;
+    result->src[1] = b;
+    result->src[2] = c;
+
+    return result;
+}
+
 // ggml_out_prod
 
 struct ggml_tensor * ggml_out_prod(
@@ -5168,6 +5394,44 @@ struct ggml_tensor* ggml_conv_1d_ph(
     return ggml_conv_1d(ctx, a, b, s, a->ne[0] / 2, d);
 }
 
+// ggml_conv_1d_ph_gelu
+
+struct ggml_tensor * ggml_conv_1d_ph_gelu(
+        struct ggml_context * ctx,
+        struct ggml_tensor  * a,
+        struct ggml_tensor  * b,
+        struct ggml_tensor  * c,
+        int                   s,
+        enum ggml_type        type) {
+    GGML_ASSERT(a->ne[0] % 2 == 1);
+    GGML_ASSERT(a->ne[1] == b->ne[1]);
+    GGML_ASSERT(b->ne[2] == 1);
+    GGML_ASSERT(c->ne[0] == a->ne[2] && ggml_nelements(c) == a->ne[2]);
+    GGML_ASSERT(type == GGML_TYPE_F32 || type == GGML_TYPE_F16);
+
+    bool is_node = false;
+
+    if (a->grad || b->grad || c->grad) {
+        GGML_ASSERT(false); // TODO: implement backward
+        is_node = true;
+    }
+
+    const int64_t OL = ggml_calc_conv_output_size(b->ne[0], a->ne[0], s, a->ne[0] / 2, 1);
+
+    struct ggml_tensor * result = ggml_new_tensor_2d(ctx, type, a->ne[2], OL);
+
+    int32_t params[] = { s };
+    ggml_set_op_params(result, params, sizeof(params));
+
+    result->op = GGML_OP_CONV_1D_PH_GELU;
+    result->grad = is_node ? ggml_dup_tensor(ctx, result) : NULL;
+    result->src[0] = a;
+    result->src[1] = b;
+    result->src[2] = c;
+
+    return result;
+}
+
 // ggml_conv_transpose_1d
 
 static int64_t ggml_calc_conv_transpose_1d_output_size(int64_t ins, int64_t ks, int s, int p, int d) {
@@ -9361,8 +9625,104 @@ static void ggml_compute_forward_group_norm(
     }
 }
 
+// ggml_compute_forward_norm_mul_add
+
+static void ggml_compute_forward_norm_mul_add_f32(
+        const struct ggml_compute_params * params,
+        const struct ggml_tensor * src0,
+        const struct ggml_tensor * src1,
+        const struct ggml_tensor * src2,
+        struct ggml_tensor * dst) {
+    GGML_ASSERT(ggml_are_same_shape(src0, dst));
+    GGML_ASSERT(src1->type == GGML_TYPE_F32 && ggml_is_contiguous(src1));
+    GGML_ASSERT(src2->type == GGML_TYPE_F32 && ggml_is_contiguous(src2));
+
+    if (params->type == GGML_TASK_INIT || params->type == GGML_TASK_FINALIZE) {
+        return;
+    }
+
+    GGML_ASSERT(src0->nb[0] == sizeof(float));
+
+    const int ith = params->ith;
+    const int nth = params->nth;
+
+    GGML_TENSOR_UNARY_OP_LOCALS
+
+    float eps;
+    memcpy(&eps, dst->op_params, sizeof(float));
+
+    const float * w = (const float *) src1->data;
+    const float * b = (const float *) src2->data;
+
+    for (int64_t i03 = 0; i03 < ne03; i03++) {
+        for (int64_t i02 = 0; i02 < ne02; i02++) {
+            for (int64_t i01 = ith; i01 < ne01; i01 += nth) {
+                const float * x = (float *) ((char *) src0->data + i01*nb01 + i02*nb02 + i03*nb03);
+
+                ggml_float sum = 0.0;
+                for (int64_t i00 = 0; i00 < ne00; i00++) {
+                    sum += (ggml_float)x[i00];
+                }
+
+                const float mean = sum/ne00;
+
+                ggml_float sum2 = 0.0;
+                for (int64_t i00 = 0; i00 < ne00; i00++) {
+                    const float v = x[i00] - mean;
+                    sum2 += (ggml_float)(v*v);
+                }
+
+                const float variance = sum2/ne00;
+                const float scale = 1.0f/sqrtf(variance + eps);
+
+                // the row is still in the cache, so it is written once with the scale and bias
+                // applied instead of being read back by separate mul and add nodes
+                float * y = (float *) ((char *) dst->data + i01*nb1 + i02*nb2 + i03*nb3);
+                for (int64_t i00 = 0; i00 < ne00; i00++) {
+                    y[i00] = ((x[i00] - mean)*scale)*w[i00] + b[i00];
+                }
+            }
+        }
+    }
+}
+
+static void ggml_compute_forward_norm_mul_add(
+        const struct ggml_compute_params * params,
+        const struct ggml_tensor * src0,
+        const struct ggml_tensor * src1,
+        const struct ggml_tensor * src2,
+        struct ggml_tensor * dst) {
+    switch (src0->type) {
+        case GGML_TYPE_F32:
+            {
+                ggml_compute_forward_norm_mul_add_f32(params, src0, src1, src2, dst);
+            } break;
+        default:
+            {
+                GGML_ASSERT(false);
+            } break;
+    }
+}
+
+// dynamic scheduling for the kernels that split their work into more chunks than threads: a thread
+// computes the chunk of its index first and then takes the next chunk that no thread has taken yet,
+// so the threads on the big cores compute more chunks and do not wait for the little ones at the
+// end of every node
+//
+//   for (int ic = ith; ic < n_chunks; ic = ggml_compute_next_chunk(params)) { ... }
+//
+// once the graph is aborted there is no next chunk, so the loops end after the chunks in progress
+static int ggml_compute_next_chunk(const struct ggml_compute_params * params);
+
+// polls the abort callback of the graph; the kernels with long chunks also check it inside them
+static bool ggml_compute_aborted(const struct ggml_compute_params * params);
+
 // ggml_compute_forward_mul_mat
 
+// chunks of work per thread, the more there are, the better the threads on the little cores are
+// balanced against the big ones
+#define GGML_MUL_MAT_CHUNKS_PER_THREAD 4
+
 #if defined(GGML_USE_ACCELERATE) || defined(GGML_USE_OPENBLAS)
 // helper function to determine if it is better to use BLAS or not
 // for large matrices, BLAS is faster
@@ -9393,10 +9753,21 @@ static bool ggml_compute_forward_mul_mat_use_blas(
 }
 #endif
 
+// adds the bias to each of the nr rows of n elements of y and applies gelu
+static void ggml_mul_mat_add_gelu_rows(const int64_t n, const int64_t nr, float * y, const float * bias) {
+    for (int64_t ir = 0; ir < nr; ++ir) {
+        float * row = y + ir*n;
+        ggml_vec_acc_f32(n, row, bias);
+        ggml_vec_gelu_f32(n, row, row);
+    }
+}
+
+// src2: the bias of GGML_OP_MUL_MAT_ADD_GELU, NULL for GGML_OP_MUL_MAT
 static void ggml_compute_forward_mul_mat(
         const struct ggml_compute_params * params,
         const struct ggml_tensor * src0,
         const struct ggml_tensor * src1,
+        const struct ggml_tensor * src2,
               struct ggml_tensor * dst) {
     int64_t t0 = ggml_perf_time_us();
     UNUSED(t0);
@@ -9433,6 +9804,13 @@ static void ggml_compute_forward_mul_mat(
     const int64_t r2 = ne12/ne02;
     const int64_t r3 = ne13/ne03;
 
+    const float * bias = NULL;
+    if (src2 != NULL) {
+        GGML_ASSERT(src2->type == GGML_TYPE_F32 && ggml_is_contiguous(src2));
+        GGML_ASSERT(ggml_is_contiguous(dst));
+        bias = (const float *) src2->data;
+    }
+
     // nb01 >= nb00 - src0 is not transposed
     //   compute by src0 rows
 
@@ -9440,6 +9818,9 @@ static void ggml_compute_forward_mul_mat(
     if (ggml_cl_can_mul_mat(src0, src1, dst)) {
         if (params->ith == 0 && params->type == GGML_TASK_COMPUTE) {
             ggml_cl_mul_mat(src0, src1, dst, params->wdata, params->wsize);
+            if (bias != NULL) {
+                ggml_mul_mat_add_gelu_rows(ne0, ggml_nrows(dst), (float *) dst->data, bias);
+            }
         }
         return;
     }
@@ -9489,6 +9870,10 @@ static void ggml_compute_forward_mul_mat(
                         1.0f,    y, ne10,
                                  x, ne00,
                         0.0f,    d, ne01);
+
+                if (bias != NULL) {
+                    ggml_mul_mat_add_gelu_rows(ne01, ne11, d, bias);
+                }
             }
         }
 
@@ -9528,31 +9913,6 @@ static void ggml_compute_forward_mul_mat(
 
     //printf("nr0 = %lld, nr1 = %lld\n", nr0, nr1);
 
-    // distribute the thread work across the inner or outer loop based on which one is larger
-
-    const int64_t nth0 = nr0 > nr1 ? nth : 1; // parallelize by src0 rows
-    const int64_t nth1 = nr0 > nr1 ? 1 : nth; // parallelize by src1 rows
-
-    const int64_t ith0 = ith % nth0;
-    const int64_t ith1 = ith / nth0;
-
-    const int64_t dr0 = (nr0 + nth0 - 1)/nth0;
-    const int64_t dr1 = (nr1 + nth1 - 1)/nth1;
-
-    const int64_t ir010 = dr0*ith0;
-    const int64_t ir011 = MIN(ir010 + dr0, nr0);
-
-    const int64_t ir110 = dr1*ith1;
-    const int64_t ir111 = MIN(ir110 + dr1, nr1);
-
-    //printf("ir010 = %6lld, ir011 = %6lld, ir110 = %6lld, ir111 = %6lld\n", ir010, ir011, ir110, ir111);
-
-    // threads with no work simply yield (not sure if it helps)
-    if (ir010 >= ir011 || ir110 >= ir111) {
-        sched_yield();
-        return;
-    }
-
     assert(ne12 % ne02 == 0);
     assert(ne13 % ne03 == 0);
 
@@ -9560,45 +9920,74 @@ static void ggml_compute_forward_mul_mat(
     const int64_t blck_0 = 16;
     const int64_t blck_1 = 16;
 
-    // attempt to reduce false-sharing (does not seem to make a difference)
-    float tmp[16];
+    // distribute the thread work across the inner or outer loop based on which one is larger, in
+    // a few chunks per thread of whole blocks that the threads take dynamically
 
-    for (int64_t iir1 = ir110; iir1 < ir111; iir1 += blck_1) {
-        for (int64_t iir0 = ir010; iir0 < ir011; iir0 += blck_0) {
-            for (int64_t ir1 = iir1; ir1 < iir1 + blck_1 && ir1 < ir111; ++ir1) {
-                const int64_t i13 = (ir1/(ne12*ne11));
-                const int64_t i12 = (ir1 - i13*ne12*ne11)/ne11;
-                const int64_t i11 = (ir1 - i13*ne12*ne11 - i12*ne11);
+    const bool chunk_src0 = nr0 > nr1; // parallelize by src0 rows or by src1 rows
 
-                // broadcast src0 into src1
-                const int64_t i03 = i13/r3;
-                const int64_t i02 = i12/r2;
+    const int64_t nrc = chunk_src0 ? nr0 : nr1;
+    const int64_t drc = MAX(blck_0, GGML_PAD((nrc + nth*GGML_MUL_MAT_CHUNKS_PER_THREAD - 1)/(nth*GGML_MUL_MAT_CHUNKS_PER_THREAD), blck_0));
 
-                const int64_t i1 = i11;
-                const int64_t i2 = i12;
-                const int64_t i3 = i13;
+    const int64_t n_chunks = (nrc + drc - 1)/drc;
 
-                const char * src0_row = (const char *) src0->data + (0 + i02*nb02 + i03*nb03);
+    // attempt to reduce false-sharing (does not seem to make a difference)
+    float tmp[16];
 
-                // desc: when src1 is not a contiguous memory block we have to calculate the offset using the strides
-                //       if it is, then we have either copied the data to params->wdata and made it contiguous or we are using
-                //       the original src1 data pointer, so we should index using the indices directly
-                // TODO: this is a bit of a hack, we should probably have a better way to handle this
-                const char * src1_col = (const char *) wdata +
-                    (src1_cont || src1->type != vec_dot_type
-                     ? (i11      + i12*ne11 + i13*ne12*ne11)*row_size
-                     : (i11*nb11 + i12*nb12 + i13*nb13));
+    for (int64_t ic = ith; ic < n_chunks; ic = ggml_compute_next_chunk(params)) {
+        const int64_t ir010 = chunk_src0 ? drc*ic : 0;
+        const int64_t ir011 = chunk_src0 ? MIN(ir010 + drc, nr0) : nr0;
 
-                float * dst_col = (float *) ((char *) dst->data + (i1*nb1 + i2*nb2 + i3*nb3));
+        const int64_t ir110 = chunk_src0 ? 0 : drc*ic;
+        const int64_t ir111 = chunk_src0 ? nr1 : MIN(ir110 + drc, nr1);
 
-                //for (int64_t ir0 = iir0; ir0 < iir0 + blck_0 && ir0 < ir011; ++ir0) {
-                //    vec_dot(ne00, &dst_col[ir0], src0_row + ir0*nb01, src1_col);
-                //}
+        //printf("ir010 = %6lld, ir011 = %6lld, ir110 = %6lld, ir111 = %6lld\n", ir010, ir011, ir110, ir111);
 
-                for (int64_t ir0 = iir0; ir0 < iir0 + blck_0 && ir0 < ir011; ++ir0) {
-                    vec_dot(ne00, &tmp[ir0 - iir0], src0_row + ir0*nb01, src1_col);
+        for (int64_t iir1 = ir110; iir1 < ir111; iir1 += blck_1) {
+            for (int64_t iir0 = ir010; iir0 < ir011; iir0 += blck_0) {
+                // a chunk of a large encoder product takes milliseconds, check once per block
+                if (ggml_compute_aborted(params)) {
+                    return;
+                }
+                for (int64_t ir1 = iir1; ir1 < iir1 + blck_1 && ir1 < ir111; ++ir1) {
+                    const int64_t i13 = (ir1/(ne12*ne11));
+                    const int64_t i12 = (ir1 - i13*ne12*ne11)/ne11;
+                    const int64_t i11 = (ir1 - i13*ne12*ne11 - i12*ne11);
+
+                    // broadcast src0 into src1
+                    const int64_t i03 = i13/r3;
+                    const int64_t i02 = i12/r2;
+
+                    const int64_t i1 = i11;
+                    const int64_t i2 = i12;
+                    const int64_t i3 = i13;
+
+                    const char * src0_row = (const char *) src0->data + (0 + i02*nb02 + i03*nb03);
+
+                    // desc: when src1 is not a contiguous memory block we have to calculate the offset using the strides
+                    //       if it is, then we have either copied the data to params->wdata and made it contiguous or we are using
+                    //       the original src1 data pointer, so we should index using the indices directly
+                    // TODO: this is a bit of a hack, we should probably have a better way to handle this
+                    const char * src1_col = (const char *) wdata +
+                        (src1_cont || src1->type != vec_dot_type
+                         ? (i11      + i12*ne11 + i13*ne12*ne11)*row_size
+                         : (i11*nb11 + i12*nb12 + i13*nb13));
+
+                    float * dst_col = (float *) ((char *) dst->data + (i1*nb1 + i2*nb2 + i3*nb3));
+
+                    //for (int64_t ir0 = iir0; ir0 < iir0 + blck_0 && ir0 < ir011; ++ir0) {
+                    //    vec_dot(ne00, &dst_col[ir0], src0_row + ir0*nb01, src1_col);
+                    //}
+
+                    for (int64_t ir0 = iir0; ir0 < iir0 + blck_0 && ir0 < ir011; ++ir0) {
+                        vec_dot(ne00, &tmp[ir0 - iir0], src0_row + ir0*nb01, src1_col);
+                    }
+                    if (bias != NULL) {
+                        // fused bias and gelu while the tile is in registers, so that the product is
+                        // not written and read back by separate add and gelu nodes
+                        ggml_mul_mat_add_gelu_rows(MIN(iir0 + blck_0, ir011) - iir0, 1, tmp, bias + iir0);
+                    }
+                    memcpy(&dst_col[iir0], tmp, (MIN(iir0 + blck_0, ir011) - iir0)*sizeof(float));
                 }
-                memcpy(&dst_col[iir0], tmp, (MIN(iir0 + blck_0, ir011) - iir0)*sizeof(float));
             }
         }
     }
@@ -11689,11 +12078,121 @@ static void ggml_compute_forward_im2col(
     }
 }
 
-// ggml_compute_forward_conv_transpose_2d
+// ggml_compute_forward_conv_1d_ph_gelu
 
-static void ggml_compute_forward_conv_transpose_2d(
-        const struct ggml_compute_params * params,
-        const struct ggml_tensor * src0,
+// output positions per tile: the windows of a tile are gathered once and every kernel row is then
+// dotted with all of them while it is still in the cache
+#define GGML_CONV_1D_TILE 16
+
+static size_t ggml_conv_1d_ph_gelu_wsize(const struct ggml_tensor * node) {
+    const int64_t nk = node->src[0]->ne[0]*node->src[0]->ne[1]; // K*IC
+    const int64_t OC = node->src[0]->ne[2];
+
+    return GGML_CONV_1D_TILE*(nk*sizeof(ggml_fp16_t) + OC*sizeof(float)) + CACHE_LINE_SIZE;
+}
+
+// src0: kernel [OC, IC, K]
+// src1: input  [IC, IL], any strides
+// src2: bias   [OC]
+// dst:  result [OL, OC]
+static void ggml_compute_forward_conv_1d_ph_gelu(
+        const struct ggml_compute_params * params,
+        const struct ggml_tensor * src0,
+        const struct ggml_tensor * src1,
+        const struct ggml_tensor * src2,
+              struct ggml_tensor * dst) {
+    GGML_ASSERT(src0->type == GGML_TYPE_F16);
+    GGML_ASSERT(src1->type == GGML_TYPE_F32 || src1->type == GGML_TYPE_F16);
+    GGML_ASSERT(src2->type == GGML_TYPE_F32);
+    GGML_ASSERT(ggml_is_contiguous(src0));
+
+    if (params->type == GGML_TASK_INIT || params->type == GGML_TASK_FINALIZE) {
+        return;
+    }
+
+    GGML_TENSOR_BINARY_OP_LOCALS;
+
+    const int32_t s0 = ((const int32_t *)(dst->op_params))[0];
+
+    const int ith = params->ith;
+    const int nth = params->nth;
+
+    const int64_t K  = ne00;
+    const int64_t IC = ne01;
+    const int64_t OC = ne02;
+    const int64_t IL = ne10;
+    const int64_t OL = ne1;
+    const int64_t p0 = K/2;
+    const int64_t nk = K*IC;
+
+    GGML_ASSERT(nb0 == ggml_type_size(dst->type));
+    GGML_ASSERT(params->wsize >= nth*ggml_conv_1d_ph_gelu_wsize(dst));
+
+    char * wbase = (char *) params->wdata + ith*ggml_conv_1d_ph_gelu_wsize(dst);
+
+    // windows in the kernel layout [IC, K], one per output position of the tile
+    ggml_fp16_t * win = (ggml_fp16_t *) wbase;
+    // dot products of the tile, [OC] per output position
+    float * acc = (float *) (wbase + GGML_CONV_1D_TILE*nk*sizeof(ggml_fp16_t));
+
+    const int64_t n_tiles = (OL + GGML_CONV_1D_TILE - 1)/GGML_CONV_1D_TILE;
+
+    for (int64_t it = ith; it < n_tiles; it = ggml_compute_next_chunk(params)) {
+        const int64_t t0 = it*GGML_CONV_1D_TILE;
+        const int64_t nt = MIN(GGML_CONV_1D_TILE, OL - t0);
+
+        for (int64_t j = 0; j < nt; j++) {
+            ggml_fp16_t * w = win + j*nk;
+
+            for (int64_t ic = 0; ic < IC; ic++) {
+                const char * x = (const char *) src1->data + ic*nb11;
+
+                for (int64_t k = 0; k < K; k++) {
+                    const int64_t il = (t0 + j)*s0 + k - p0;
+
+                    if (il < 0 || il >= IL) {
+                        w[ic*K + k] = 0;
+                    } else if (src1->type == GGML_TYPE_F16) {
+                        w[ic*K + k] = *(const ggml_fp16_t *) (x + il*nb10);
+                    } else {
+                        w[ic*K + k] = GGML_FP32_TO_FP16(*(const float *) (x + il*nb10));
+                    }
+                }
+            }
+        }
+
+        for (int64_t oc = 0; oc < OC; oc++) {
+            ggml_fp16_t * kr = (ggml_fp16_t *) ((char *) src0->data + oc*nb02);
+
+            for (int64_t j = 0; j < nt; j++) {
+                ggml_vec_dot_f16(nk, acc + j*OC + oc, win + j*nk, kr);
+            }
+        }
+
+        for (int64_t j = 0; j < nt; j++) {
+            float * row = acc + j*OC;
+
+            for (int64_t oc = 0; oc < OC; oc++) {
+                row[oc] += *(const float *) ((const char *) src2->data + oc*src2->nb[0]);
+            }
+
+            ggml_vec_gelu_f32(OC, row, row);
+
+            char * d = (char *) dst->data + (t0 + j)*nb1;
+            if (dst->type == GGML_TYPE_F16) {
+                ggml_fp32_to_fp16_row(row, (ggml_fp16_t *) d, OC);
+            } else {
+                memcpy(d, row, OC*sizeof(float));
+            }
+        }
+    }
+}
+
+// ggml_compute_forward_conv_transpose_2d
+
+static void ggml_compute_forward_conv_transpose_2d(
+        const struct ggml_compute_params * params,
+        const struct ggml_tensor * src0,
         const struct ggml_tensor * src1,
               struct ggml_tensor * dst) {
     GGML_ASSERT(src0->type == GGML_TYPE_F16);
@@ -11992,6 +12491,9 @@ static void ggml_compute_forward_upscale(
 
 // ggml_compute_forward_flash_attn
 
+// chunks of q rows per thread of the f16 kernel, see GGML_MUL_MAT_CHUNKS_PER_THREAD
+#define GGML_FLASH_ATTN_CHUNKS_PER_THREAD 4
+
 static void ggml_compute_forward_flash_attn_f32(
         const struct ggml_compute_params * params,
         const struct ggml_tensor * q,
@@ -12246,163 +12748,167 @@ static void ggml_compute_forward_flash_attn_f16(
     // total rows in q
     const int nr = neq1*neq2*neq3;
 
-    // rows per thread
-    const int dr = (nr + nth - 1)/nth;
+    // rows per chunk, a few chunks per thread that the threads take dynamically
+    const int dr = MAX(1, (nr + nth*GGML_FLASH_ATTN_CHUNKS_PER_THREAD - 1)/(nth*GGML_FLASH_ATTN_CHUNKS_PER_THREAD));
 
-    // row range for this thread
-    const int ir0 = dr*ith;
-    const int ir1 = MIN(ir0 + dr, nr);
+    const int n_chunks = (nr + dr - 1)/dr;
 
     const float scale = 1.0f/sqrtf(D);
 
     //printf("P=%d N=%d D=%d ir0=%d ir1=%d scale = %f\n", P, N, D, ir0, ir1, scale);
 
-    for (int ir = ir0; ir < ir1; ++ir) {
-        // q indices
-        const int iq3 = ir/(neq2*neq1);
-        const int iq2 = (ir - iq3*neq2*neq1)/neq1;
-        const int iq1 = (ir - iq3*neq2*neq1 - iq2*neq1);
+    for (int ic0 = ith; ic0 < n_chunks; ic0 = ggml_compute_next_chunk(params)) {
+        // row range of this chunk
+        const int ir0 = dr*ic0;
+        const int ir1 = MIN(ir0 + dr, nr);
 
-        float * S = (float *) params->wdata + ith*(2*Mup + CACHE_LINE_SIZE_F32);
+        for (int ir = ir0; ir < ir1; ++ir) {
+            // q indices
+            const int iq3 = ir/(neq2*neq1);
+            const int iq2 = (ir - iq3*neq2*neq1)/neq1;
+            const int iq1 = (ir - iq3*neq2*neq1 - iq2*neq1);
 
-        for (int i = M; i < Mup; ++i) {
-            S[i] = -INFINITY;
-        }
+            float * S = (float *) params->wdata + ith*(2*Mup + CACHE_LINE_SIZE_F32);
 
-        if (GGML_VEC_DOT_UNROLL > 2 || nek1 % GGML_VEC_DOT_UNROLL != 0) {
-            for (int64_t ic = 0; ic < nek1; ++ic) {
-                // k indices
-                const int ik3 = iq3;
-                const int ik2 = iq2 % nek2;
-                const int ik1 = ic;
+            for (int i = M; i < Mup; ++i) {
+                S[i] = -INFINITY;
+            }
 
-                // S indices
-                const int i1 = ik1;
+            if (GGML_VEC_DOT_UNROLL > 2 || nek1 % GGML_VEC_DOT_UNROLL != 0) {
+                for (int64_t ic = 0; ic < nek1; ++ic) {
+                    // k indices
+                    const int ik3 = iq3;
+                    const int ik2 = iq2 % nek2;
+                    const int ik1 = ic;
 
-                ggml_vec_dot_f16(neq0,
-                        S + i1,
-                        (ggml_fp16_t *) ((char *) k->data + (ik1*nbk1 + ik2*nbk2 + ik3*nbk3)),
-                        (ggml_fp16_t *) ((char *) q->data + (iq1*nbq1 + iq2*nbq2 + iq3*nbq3)));
-            }
-        } else {
-            for (int64_t ic = 0; ic < nek1; ic += GGML_VEC_DOT_UNROLL) {
-                // k indices
-                const int ik3 = iq3;
-                const int ik2 = iq2 % nek2;
-                const int ik1 = ic;
-
-                // S indices
-                const int i1 = ik1;
-
-                ggml_vec_dot_f16_unroll(neq0, nbk1,
-                        S + i1,
-                        ((char *) k->data + (ik1*nbk1 + ik2*nbk2 + ik3*nbk3)),
-                        (ggml_fp16_t *) ((char *) q->data + (iq1*nbq1 + iq2*nbq2 + iq3*nbq3)));
-            }
-        }
+                    // S indices
+                    const int i1 = ik1;
 
-        // scale
-        ggml_vec_scale_f32(nek1, S, scale);
+                    ggml_vec_dot_f16(neq0,
+                            S + i1,
+                            (ggml_fp16_t *) ((char *) k->data + (ik1*nbk1 + ik2*nbk2 + ik3*nbk3)),
+                            (ggml_fp16_t *) ((char *) q->data + (iq1*nbq1 + iq2*nbq2 + iq3*nbq3)));
+                }
+            } else {
+                for (int64_t ic = 0; ic < nek1; ic += GGML_VEC_DOT_UNROLL) {
+                    // k indices
+                    const int ik3 = iq3;
+                    const int ik2 = iq2 % nek2;
+                    const int ik1 = ic;
 
-        if (masked) {
-            for (int64_t i = P; i < M; i++) {
-                if (i > P + iq1) {
-                    S[i] = -INFINITY;
+                    // S indices
+                    const int i1 = ik1;
+
+                    ggml_vec_dot_f16_unroll(neq0, nbk1,
+                            S + i1,
+                            ((char *) k->data + (ik1*nbk1 + ik2*nbk2 + ik3*nbk3)),
+                            (ggml_fp16_t *) ((char *) q->data + (iq1*nbq1 + iq2*nbq2 + iq3*nbq3)));
                 }
             }
-        }
 
-        // softmax
-        // todo: exclude known -INF S[..] values from max and loop, assuming their results to be zero.
-        // dont forget to set their S values to zero
-        {
-            float max = -INFINITY;
-            ggml_vec_max_f32(M, &max, S);
+            // scale
+            ggml_vec_scale_f32(nek1, S, scale);
 
-            ggml_float sum = 0.0;
-            {
-#ifdef GGML_SOFT_MAX_ACCELERATE
-                max = -max;
-                vDSP_vsadd(S, 1, &max, S, 1, Mup);
-                vvexpf(S, S, &Mup);
-                ggml_vec_sum_f32(Mup, &sum, S);
-#else
-                uint16_t   scvt[GGML_SOFT_MAX_UNROLL];
-                ggml_float sump[GGML_SOFT_MAX_UNROLL] = { 0.0 };
+            if (masked) {
+                for (int64_t i = P; i < M; i++) {
+                    if (i > P + iq1) {
+                        S[i] = -INFINITY;
+                    }
+                }
+            }
 
-                for (int i = 0; i < Mup; i += GGML_SOFT_MAX_UNROLL) {
-                    float * SS = S + i;
+            // softmax
+            // todo: exclude known -INF S[..] values from max and loop, assuming their results to be zero.
+            // dont forget to set their S values to zero
+            {
+                float max = -INFINITY;
+                ggml_vec_max_f32(M, &max, S);
 
-                    for (int j = 0; j < GGML_SOFT_MAX_UNROLL; ++j) {
-                        if (SS[j] == -INFINITY) {
-                            SS[j] = 0.0f;
-                        } else {
-                            ggml_fp16_t s = GGML_FP32_TO_FP16(SS[j] - max);
-                            memcpy(&scvt[j], &s, sizeof(uint16_t));
-                            const float val = GGML_FP16_TO_FP32(ggml_table_exp_f16[scvt[j]]);
-                            sump[j] += (ggml_float)val;
-                            SS[j] = val;
+                ggml_float sum = 0.0;
+                {
+    #ifdef GGML_SOFT_MAX_ACCELERATE
+                    max = -max;
+                    vDSP_vsadd(S, 1, &max, S, 1, Mup);
+                    vvexpf(S, S, &Mup);
+                    ggml_vec_sum_f32(Mup, &sum, S);
+    #else
+                    uint16_t   scvt[GGML_SOFT_MAX_UNROLL];
+                    ggml_float sump[GGML_SOFT_MAX_UNROLL] = { 0.0 };
+
+                    for (int i = 0; i < Mup; i += GGML_SOFT_MAX_UNROLL) {
+                        float * SS = S + i;
+
+                        for (int j = 0; j < GGML_SOFT_MAX_UNROLL; ++j) {
+                            if (SS[j] == -INFINITY) {
+                                SS[j] = 0.0f;
+                            } else {
+                                ggml_fp16_t s = GGML_FP32_TO_FP16(SS[j] - max);
+                                memcpy(&scvt[j], &s, sizeof(uint16_t));
+                                const float val = GGML_FP16_TO_FP32(ggml_table_exp_f16[scvt[j]]);
+                                sump[j] += (ggml_float)val;
+                                SS[j] = val;
+                            }
                         }
                     }
-                }
 
-                for (int i = 0; i < GGML_SOFT_MAX_UNROLL; i++) {
-                    sum += sump[i];
+                    for (int i = 0; i < GGML_SOFT_MAX_UNROLL; i++) {
+                        sum += sump[i];
+                    }
+    #endif
                 }
-#endif
-            }
 
-            assert(sum > 0.0);
+                assert(sum > 0.0);
 
-            sum = 1.0/sum;
-            ggml_vec_scale_f32(M, S, sum);
+                sum = 1.0/sum;
+                ggml_vec_scale_f32(M, S, sum);
 
-#ifndef NDEBUG
-            for (int i = 0; i < M; ++i) {
-                assert(!isnan(S[i]));
-                assert(!isinf(S[i]));
+    #ifndef NDEBUG
+                for (int i = 0; i < M; ++i) {
+                    assert(!isnan(S[i]));
+                    assert(!isinf(S[i]));
+                }
+    #endif
             }
-#endif
-        }
 
-        ggml_fp16_t * S16 = (ggml_fp16_t *) ((float *) params->wdata + ith*(2*Mup + CACHE_LINE_SIZE_F32) + Mup);
+            ggml_fp16_t * S16 = (ggml_fp16_t *) ((float *) params->wdata + ith*(2*Mup + CACHE_LINE_SIZE_F32) + Mup);
 
-        for (int64_t i = 0; i < M; i++) {
-            S16[i] = GGML_FP32_TO_FP16(S[i]);
-        }
-
-        // todo: exclude known zero S[..] values from dot (reducing nev0 and increasing begin of v and S16).
-        if (GGML_VEC_DOT_UNROLL == 1 || (nev1 % GGML_VEC_DOT_UNROLL != 0)) {
-            for (int64_t ic = 0; ic < nev1; ++ic) {
-                // dst indices
-                const int i1 = iq1;
-                const int i2 = iq2;
-                const int i3 = iq3;
-
-                // v indices
-                const int iv2 = iq2 % nev2;
-                const int iv3 = iq3;
-
-                ggml_vec_dot_f16(nev0,
-                        (float *)       ((char *) dst->data + (ic*nb0 + i1*nb1  + i2*nb2   + i3*nb3)),
-                        (ggml_fp16_t *) ((char *) v->data   + (         ic*nbv1 + iv2*nbv2 + iv3*nbv3)),
-                        S16);
+            for (int64_t i = 0; i < M; i++) {
+                S16[i] = GGML_FP32_TO_FP16(S[i]);
             }
-        } else {
-            for (int64_t ic = 0; ic < nev1; ic += GGML_VEC_DOT_UNROLL) {
-                // dst indices
-                const int i1 = iq1;
-                const int i2 = iq2;
-                const int i3 = iq3;
 
-                // v indices
-                const int iv2 = iq2 % nev2;
-                const int iv3 = iq3;
-
-                ggml_vec_dot_f16_unroll(nev0, nbv1,
-                        (float *) ((char *) dst->data + (ic*nb0 + i1*nb1  + i2*nb2   + i3*nb3)),
-                        ((char *)             v->data + (         ic*nbv1 + iv2*nbv2 + iv3*nbv3)),
-                        S16);
+            // todo: exclude known zero S[..] values from dot (reducing nev0 and increasing begin of v and S16).
+            if (GGML_VEC_DOT_UNROLL == 1 || (nev1 % GGML_VEC_DOT_UNROLL != 0)) {
+                for (int64_t ic = 0; ic < nev1; ++ic) {
+                    // dst indices
+                    const int i1 = iq1;
+                    const int i2 = iq2;
+                    const int i3 = iq3;
+
+                    // v indices
+                    const int iv2 = iq2 % nev2;
+                    const int iv3 = iq3;
+
+                    ggml_vec_dot_f16(nev0,
+                            (float *)       ((char *) dst->data + (ic*nb0 + i1*nb1  + i2*nb2   + i3*nb3)),
+                            (ggml_fp16_t *) ((char *) v->data   + (         ic*nbv1 + iv2*nbv2 + iv3*nbv3)),
+                            S16);
+                }
+            } else {
+                for (int64_t ic = 0; ic < nev1; ic += GGML_VEC_DOT_UNROLL) {
+                    // dst indices
+                    const int i1 = iq1;
+                    const int i2 = iq2;
+                    const int i3 = iq3;
+
+                    // v indices
+                    const int iv2 = iq2 % nev2;
+                    const int iv3 = iq3;
+
+                    ggml_vec_dot_f16_unroll(nev0, nbv1,
+                            (float *) ((char *) dst->data + (ic*nb0 + i1*nb1  + i2*nb2   + i3*nb3)),
+                            ((char *)             v->data + (         ic*nbv1 + iv2*nbv2 + iv3*nbv3)),
+                            S16);
+                }
             }
         }
     }
@@ -13809,9 +14315,17 @@ static void ggml_compute_forward(struct ggml_compute_params * params, struct ggm
             {
                 ggml_compute_forward_group_norm(params, tensor->src[0], tensor);
             } break;
+        case GGML_OP_NORM_MUL_ADD:
+            {
+                ggml_compute_forward_norm_mul_add(params, tensor->src[0], tensor->src[1], tensor->src[2], tensor);
+            } break;
         case GGML_OP_MUL_MAT:
             {
-                ggml_compute_forward_mul_mat(params, tensor->src[0], tensor->src[1], tensor);
+                ggml_compute_forward_mul_mat(params, tensor->src[0], tensor->src[1], NULL, tensor);
+            } break;
+        case GGML_OP_MUL_MAT_ADD_GELU:
+            {
+                ggml_compute_forward_mul_mat(params, tensor->src[0], tensor->src[1], tensor->src[2], tensor);
             } break;
         case GGML_OP_OUT_PROD:
             {
@@ -13901,6 +14415,10 @@ static void ggml_compute_forward(struct ggml_compute_params * params, struct ggm
             {
                 ggml_compute_forward_im2col(params, tensor->src[0], tensor->src[1], tensor);
             } break;
+        case GGML_OP_CONV_1D_PH_GELU:
+            {
+                ggml_compute_forward_conv_1d_ph_gelu(params, tensor->src[0], tensor->src[1], tensor->src[2], tensor);
+            } break;
         case GGML_OP_CONV_TRANSPOSE_2D:
             {
                 ggml_compute_forward_conv_transpose_2d(params, tensor->src[0], tensor->src[1], tensor);
@@ -14509,6 +15027,10 @@ static void ggml_compute_backward(struct ggml_context * ctx, struct ggml_tensor
             {
                 GGML_ASSERT(false); // TODO: not implemented
             } break;
+        case GGML_OP_NORM_MUL_ADD:
+            {
+                GGML_ASSERT(false); // TODO: not implemented
+            } break;
         case GGML_OP_MUL_MAT:
             {
                 // https://cs231n.github.io/optimization-2/#staged
@@ -14567,6 +15089,10 @@ static void ggml_compute_backward(struct ggml_context * ctx, struct ggml_tensor
                                 zero_table);
                 }
             } break;
+        case GGML_OP_MUL_MAT_ADD_GELU:
+            {
+                GGML_ASSERT(false); // TODO: not implemented
+            } break;
         case GGML_OP_OUT_PROD:
             {
                 GGML_ASSERT(false); // TODO: not implemented
@@ -14889,6 +15415,10 @@ static void ggml_compute_backward(struct ggml_context * ctx, struct ggml_tensor
             {
                 GGML_ASSERT(false); // TODO: not implemented
             } break;
+        case GGML_OP_CONV_1D_PH_GELU:
+            {
+                GGML_ASSERT(false); // TODO: not implemented
+            } break;
         case GGML_OP_CONV_TRANSPOSE_2D:
             {
                 GGML_ASSERT(false); // TODO: not implemented
@@ -15405,6 +15935,18 @@ typedef pthread_t ggml_thread_t;
 
 #endif
 
+// hint to the cpu that the thread is busy waiting
+#if defined(_MSC_VER) && defined(_M_AMD64)
+#define ggml_cpu_relax() _mm_pause()
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+// immintrin.h is only included for SSE3 and later builds
+#define ggml_cpu_relax() __builtin_ia32_pause()
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define ggml_cpu_relax() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define ggml_cpu_relax()
+#endif
+
 // Android's libc implementation "bionic" does not support setting affinity
 #if defined(__linux__) && !defined(__BIONIC__)
 static void set_numa_thread_affinity(int thread_n, int n_threads) {
@@ -15470,8 +16012,10 @@ struct ggml_compute_state_shared {
     const int n_threads;
 
     // synchronization primitives
-    atomic_int n_active; // num active threads
-    atomic_int node_n;   // active graph node
+    atomic_int n_active;      // num active threads
+    atomic_int node_n;        // active graph node
+    atomic_int current_chunk; // next chunk of the active node that no thread has taken yet
+    atomic_int aborted;       // set by the first thread that sees the abort callback return true
 
     bool (*abort_callback)(void * data); // abort ggml_graph_compute when true
     void * abort_callback_data;
@@ -15483,6 +16027,29 @@ struct ggml_compute_state {
     struct ggml_compute_state_shared * shared;
 };
 
+static bool ggml_compute_state_aborted(struct ggml_compute_state_shared * shared) {
+    if (atomic_load_explicit(&shared->aborted, memory_order_relaxed)) {
+        return true;
+    }
+    const struct ggml_cplan * cplan = shared->cplan;
+    if (cplan->abort_callback && cplan->abort_callback(cplan->abort_callback_data)) {
+        atomic_store(&shared->aborted, 1);
+        return true;
+    }
+    return false;
+}
+
+static bool ggml_compute_aborted(const struct ggml_compute_params * params) {
+    return ggml_compute_state_aborted(params->shared);
+}
+
+static int ggml_compute_next_chunk(const struct ggml_compute_params * params) {
+    if (ggml_compute_aborted(params)) {
+        return INT_MAX;
+    }
+    return atomic_fetch_add(&params->shared->current_chunk, 1);
+}
+
 static void ggml_graph_compute_perf_stats_node(struct ggml_tensor * node, const struct ggml_compute_state_shared * st) {
     int64_t cycles_cur  = ggml_perf_cycles()  - st->perf_node_start_cycles;
     int64_t time_us_cur = ggml_perf_time_us() - st->perf_node_start_time_us;
@@ -15492,6 +16059,16 @@ static void ggml_graph_compute_perf_stats_node(struct ggml_tensor * node, const
     node->perf_time_us += time_us_cur;
 }
 
+// minimum work of a task: nodes smaller than this are not split any further, since the threads
+// would spend more time meeting at the barrier after the node than computing their part of it
+// (the nodes of a single token decoder graph are mostly this small)
+#define GGML_MIN_ELEMENTS_PER_TASK      4096
+#define GGML_MIN_MUL_MAT_MADS_PER_TASK (32*1024)
+
+static int ggml_get_n_tasks_for_work(int64_t work, int64_t min_work_per_task, int n_threads) {
+    return (int) MAX(1, MIN((int64_t) n_threads, work/min_work_per_task));
+}
+
 static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
     int n_tasks = 0;
 
@@ -15502,7 +16079,7 @@ static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
         case GGML_OP_ADD1:
         case GGML_OP_ACC:
             {
-                n_tasks = n_threads;
+                n_tasks = ggml_get_n_tasks_for_work(ggml_nelements(node), GGML_MIN_ELEMENTS_PER_TASK, n_threads);
             } break;
         case GGML_OP_SUB:
         case GGML_OP_DIV:
@@ -15536,30 +16113,29 @@ static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
                 case GGML_UNARY_OP_GELU_QUICK:
                 case GGML_UNARY_OP_SILU:
                     {
-                        n_tasks = n_threads;
+                        n_tasks = ggml_get_n_tasks_for_work(ggml_nelements(node), GGML_MIN_ELEMENTS_PER_TASK, n_threads);
                     } break;
             }
             break;
         case GGML_OP_SILU_BACK:
+        case GGML_OP_RMS_NORM_BACK:
+            {
+                n_tasks = n_threads;
+            } break;
         case GGML_OP_MUL:
         case GGML_OP_NORM:
         case GGML_OP_RMS_NORM:
-        case GGML_OP_RMS_NORM_BACK:
         case GGML_OP_GROUP_NORM:
+        case GGML_OP_NORM_MUL_ADD:
         case GGML_OP_CONCAT:
             {
-                n_tasks = n_threads;
+                n_tasks = ggml_get_n_tasks_for_work(ggml_nelements(node), GGML_MIN_ELEMENTS_PER_TASK, n_threads);
             } break;
         case GGML_OP_MUL_MAT:
+        case GGML_OP_MUL_MAT_ADD_GELU:
             {
-                n_tasks = n_threads;
-
-                // TODO: use different scheduling for different matrix sizes
-                //const int nr0 = ggml_nrows(node->src[0]);
-                //const int nr1 = ggml_nrows(node->src[1]);
-
-                //n_tasks = MIN(n_threads, MAX(1, nr0/128));
-                //printf("nr0 = %8d, nr1 = %8d, nr0*nr1 = %8d, n_tasks%d\n", nr0, nr1, nr0*nr1, n_tasks);
+                // multiply-adds: every element of the result is a dot product of ne00 elements
+                n_tasks = ggml_get_n_tasks_for_work(node->src[0]->ne[0]*ggml_nelements(node), GGML_MIN_MUL_MAT_MADS_PER_TASK, n_threads);
 
 #if defined(GGML_USE_CUBLAS)
                 if (ggml_cuda_can_mul_mat(node->src[0], node->src[1], node)) {
@@ -15599,8 +16175,11 @@ static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
         case GGML_OP_DIAG_MASK_ZERO:
         case GGML_OP_DIAG_MASK_INF:
         case GGML_OP_SOFT_MAX:
-        case GGML_OP_SOFT_MAX_BACK:
         case GGML_OP_ROPE:
+            {
+                n_tasks = ggml_get_n_tasks_for_work(ggml_nelements(node), GGML_MIN_ELEMENTS_PER_TASK, n_threads);
+            } break;
+        case GGML_OP_SOFT_MAX_BACK:
         case GGML_OP_ROPE_BACK:
         case GGML_OP_ADD_REL_POS:
             {
@@ -15622,6 +16201,10 @@ static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
             {
                 n_tasks = n_threads;
             } break;
+        case GGML_OP_CONV_1D_PH_GELU:
+            {
+                n_tasks = n_threads;
+            } break;
         case GGML_OP_CONV_TRANSPOSE_2D:
             {
                 n_tasks = n_threads;
@@ -15726,8 +16309,7 @@ static thread_ret_t ggml_graph_compute_thread(void * data) {
     int node_n = -1;
 
     while (true) {
-        if (cplan->abort_callback && cplan->abort_callback(cplan->abort_callback_data)) {
-            state->shared->node_n += 1;
+        if (ggml_compute_state_aborted(state->shared)) {
             return (thread_ret_t) GGML_EXIT_ABORTED;
         }
         if (atomic_fetch_sub(&state->shared->n_active, 1) == 1) {
@@ -15739,6 +16321,7 @@ static thread_ret_t ggml_graph_compute_thread(void * data) {
                 /*.nth   =*/ 0,
                 /*.wsize =*/ cplan->work_size,
                 /*.wdata =*/ cplan->work_data,
+                /*.shared=*/ state->shared,
             };
 
             if (node_n != -1) {
@@ -15763,6 +16346,9 @@ static thread_ret_t ggml_graph_compute_thread(void * data) {
 
                 params.nth = n_tasks;
 
+                // the threads start with the chunks of their index
+                atomic_store(&state->shared->current_chunk, n_tasks);
+
                 /* INIT */
                 if (GGML_OP_HAS_INIT[node->op]) {
                     params.type = GGML_TASK_INIT;
@@ -15785,8 +16371,9 @@ static thread_ret_t ggml_graph_compute_thread(void * data) {
                     break;
                 }
 
-                if (cplan->abort_callback && cplan->abort_callback(cplan->abort_callback_data)) {
-                    break;
+                if (ggml_compute_state_aborted(state->shared)) {
+                    // the waiting threads see the flag instead of a next node
+                    return (thread_ret_t) GGML_EXIT_ABORTED;
                 }
             }
 
@@ -15802,10 +16389,18 @@ static thread_ret_t ggml_graph_compute_thread(void * data) {
                 //       ref: https://github.com/ggerganov/ggml/issues/291
 #if defined(GGML_USE_ACCELERATE) || defined(GGML_USE_OPENBLAS)
                 sched_yield();
+#else
+                ggml_cpu_relax();
 #endif
 
                 node_n = atomic_load(&state->shared->node_n);
                 if (node_n != last) break;
+
+                // the thread that aborted does not publish a next node, leave without waiting for
+                // the threads that are still finishing their chunks
+                if (atomic_load_explicit(&state->shared->aborted, memory_order_relaxed)) {
+                    return (thread_ret_t) GGML_EXIT_ABORTED;
+                }
             };
         }
 
@@ -15822,6 +16417,7 @@ static thread_ret_t ggml_graph_compute_thread(void * data) {
             /*.nth   =*/ n_tasks,
             /*.wsize =*/ cplan->work_size,
             /*.wdata =*/ cplan->work_data,
+            /*.shared=*/ state->shared,
         };
 
         if (state->ith < n_tasks) {
@@ -15878,6 +16474,7 @@ struct ggml_cplan ggml_graph_plan(struct ggml_cgraph * cgraph, int n_threads) {
                     }
                 } break;
             case GGML_OP_MUL_MAT:
+            case GGML_OP_MUL_MAT_ADD_GELU:
                 {
                     const enum ggml_type vec_dot_type = type_traits[node->src[0]->type].vec_dot_type;
 
@@ -15935,6 +16532,12 @@ struct ggml_cplan ggml_graph_plan(struct ggml_cgraph * cgraph, int n_threads) {
                 {
                     n_tasks = n_threads;
                 } break;
+            case GGML_OP_CONV_1D_PH_GELU:
+                {
+                    n_tasks = n_threads;
+
+                    cur = n_tasks*ggml_conv_1d_ph_gelu_wsize(node);
+                } break;
             case GGML_OP_CONV_TRANSPOSE_2D:
                 {
                     const int64_t ne00 = node->src[0]->ne[0]; // W
@@ -16019,6 +16622,285 @@ struct ggml_cplan ggml_graph_plan(struct ggml_cgraph * cgraph, int n_threads) {
     return cplan;
 }
 
+#if defined(__linux__)
+#define GGML_USE_THREADPOOL
+#endif
+
+#ifdef GGML_USE_THREADPOOL
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+// worker threads kept between graph computations
+//
+// starting and joining the threads for every graph costs as much as computing the small graphs of
+// a decoder, which are computed one after another. the workers spin for a while after a graph so
+// that the next one starts right away, and then sleep on a futex until they are needed again.
+
+#define GGML_THREADPOOL_MAX_WORKERS  63
+#define GGML_THREADPOOL_SPIN_TIME_US 200
+
+struct ggml_threadpool;
+
+struct ggml_threadpool_worker {
+    ggml_thread_t thrd;
+    int ith;
+    struct ggml_threadpool * pool;
+
+    // the graph the worker has to compute, NULL when idle
+    _Atomic(struct ggml_compute_state_shared *) shared;
+};
+
+struct ggml_threadpool {
+    pthread_mutex_t mutex; // held while a graph is computed with the pool
+
+    atomic_int  wake_seq; // futex of the sleeping workers, bumped to wake them up
+    atomic_int  n_parked;
+    atomic_bool stop;
+
+    // the cores of the fastest clusters on big.LITTLE systems
+    cpu_set_t big_cpus;
+    int       n_big_cpus;
+
+    // affinity of the thread computing the current graph, which is worker 0 and is moved to the big
+    // cores until the graph is done
+    cpu_set_t caller_cpus;
+    bool      caller_pinned;
+
+    int n_workers;
+    struct ggml_threadpool_worker workers[GGML_THREADPOOL_MAX_WORKERS];
+};
+
+static void ggml_futex_wait(atomic_int * addr, int value) {
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+static void ggml_futex_wake_all(atomic_int * addr) {
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+// the cores whose maximum frequency is above the slowest one, none if all of them run at the same speed
+static int ggml_get_big_cpus(cpu_set_t * cpus) {
+    CPU_ZERO(cpus);
+
+    const long n_cpus = MIN(sysconf(_SC_NPROCESSORS_CONF), CPU_SETSIZE);
+
+    int64_t max_freq[CPU_SETSIZE];
+    int64_t min_max_freq = INT64_MAX;
+    for (int i = 0; i < n_cpus; ++i) {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", i);
+
+        max_freq[i] = 0;
+        FILE * f = fopen(path, "r");
+        if (f) {
+            if (fscanf(f, "%" SCNd64, &max_freq[i]) != 1) {
+                max_freq[i] = 0;
+            }
+            fclose(f);
+        }
+        if (max_freq[i] == 0) {
+            // offline or unknown core, the speeds cannot be told apart
+            return 0;
+        }
+        min_max_freq = MIN(min_max_freq, max_freq[i]);
+    }
+
+    int n_big = 0;
+    for (int i = 0; i < n_cpus; ++i) {
+        if (max_freq[i] > min_max_freq) {
+            CPU_SET(i, cpus);
+            n_big++;
+        }
+    }
+
+    return n_big;
+}
+
+static struct ggml_compute_state_shared * ggml_threadpool_wait(struct ggml_threadpool_worker * worker) {
+    struct ggml_threadpool * pool = worker->pool;
+    struct ggml_compute_state_shared * shared;
+
+    const int64_t t_end_us = ggml_time_us() + GGML_THREADPOOL_SPIN_TIME_US;
+    for (int i = 1; ; ++i) {
+        shared = atomic_load_explicit(&worker->shared, memory_order_acquire);
+        if (shared != NULL || atomic_load_explicit(&pool->stop, memory_order_relaxed)) {
+            return shared;
+        }
+        if (i % 256 == 0 && ggml_time_us() >= t_end_us) {
+            break;
+        }
+        ggml_cpu_relax();
+    }
+
+    // the worker announces itself in n_parked before it checks its graph for the last time, and a
+    // new graph is stored before n_parked is checked, so either side sees the other
+    atomic_fetch_add(&pool->n_parked, 1);
+    while (true) {
+        const int seq = atomic_load(&pool->wake_seq);
+        shared = atomic_load(&worker->shared);
+        if (shared != NULL || atomic_load(&pool->stop)) {
+            break;
+        }
+        ggml_futex_wait(&pool->wake_seq, seq);
+    }
+    atomic_fetch_sub(&pool->n_parked, 1);
+
+    return shared;
+}
+
+static thread_ret_t ggml_threadpool_worker_thread(void * data) {
+    struct ggml_threadpool_worker * worker = (struct ggml_threadpool_worker *) data;
+    struct ggml_threadpool * pool = worker->pool;
+
+    // keep the worker off the little cores, unless it would have to share a big one
+    if (worker->ith < pool->n_big_cpus && !ggml_is_numa()) {
+        sched_setaffinity(0, sizeof(cpu_set_t), &pool->big_cpus);
+    }
+
+    while (true) {
+        struct ggml_compute_state_shared * shared = ggml_threadpool_wait(worker);
+        if (shared == NULL) {
+            break;
+        }
+
+        struct ggml_compute_state state = {
+            /*.thrd   =*/ worker->thrd,
+            /*.ith    =*/ worker->ith,
+            /*.shared =*/ shared,
+        };
+
+        ggml_graph_compute_thread(&state);
+        clear_numa_thread_affinity();
+
+        atomic_store_explicit(&worker->shared, NULL, memory_order_release);
+    }
+
+    return 0;
+}
+
+struct ggml_threadpool * ggml_threadpool_new(void) {
+    struct ggml_threadpool * pool = malloc(sizeof(struct ggml_threadpool));
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    atomic_store(&pool->wake_seq, 0);
+    atomic_store(&pool->n_parked, 0);
+    atomic_store(&pool->stop, false);
+    pool->n_big_cpus = ggml_get_big_cpus(&pool->big_cpus);
+    pool->caller_pinned = false;
+    pool->n_workers  = 0;
+
+    return pool;
+}
+
+void ggml_threadpool_free(struct ggml_threadpool * pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+
+    atomic_store(&pool->stop, true);
+    atomic_fetch_add(&pool->wake_seq, 1);
+    ggml_futex_wake_all(&pool->wake_seq);
+
+    for (int j = 0; j < pool->n_workers; ++j) {
+        const int rc = ggml_thread_join(pool->workers[j].thrd, NULL);
+        GGML_ASSERT(rc == 0);
+        UNUSED(rc);
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+    pthread_mutex_destroy(&pool->mutex);
+
+    free(pool);
+}
+
+// hands the graph to the workers 1 .. n_threads - 1
+// returns false if the pool is busy with another graph or cannot grow to n_threads
+static bool ggml_threadpool_start(struct ggml_threadpool * pool, struct ggml_compute_state_shared * shared, int n_threads) {
+    if (n_threads - 1 > GGML_THREADPOOL_MAX_WORKERS || pthread_mutex_trylock(&pool->mutex) != 0) {
+        return false;
+    }
+
+    while (pool->n_workers < n_threads - 1) {
+        struct ggml_threadpool_worker * worker = &pool->workers[pool->n_workers];
+
+        worker->ith  = pool->n_workers + 1;
+        worker->pool = pool;
+        atomic_store(&worker->shared, NULL);
+
+        if (ggml_thread_create(&worker->thrd, NULL, ggml_threadpool_worker_thread, worker) != 0) {
+            pthread_mutex_unlock(&pool->mutex);
+            return false;
+        }
+        pool->n_workers++;
+    }
+
+    pool->caller_pinned = pool->n_big_cpus > 0 && !ggml_is_numa() &&
+                          sched_getaffinity(0, sizeof(cpu_set_t), &pool->caller_cpus) == 0 &&
+                          sched_setaffinity(0, sizeof(cpu_set_t), &pool->big_cpus) == 0;
+
+    for (int j = 0; j < n_threads - 1; ++j) {
+        atomic_store(&pool->workers[j].shared, shared);
+    }
+
+    if (atomic_load(&pool->n_parked) > 0) {
+        atomic_fetch_add(&pool->wake_seq, 1);
+        ggml_futex_wake_all(&pool->wake_seq);
+    }
+
+    return true;
+}
+
+// waits for the workers to leave the graph, the shared state lives on the caller's stack
+static void ggml_threadpool_finish(struct ggml_threadpool * pool, int n_threads) {
+    for (int j = 0; j < n_threads - 1; ++j) {
+        while (atomic_load_explicit(&pool->workers[j].shared, memory_order_acquire) != NULL) {
+            ggml_cpu_relax();
+        }
+    }
+
+    if (pool->caller_pinned) {
+        sched_setaffinity(0, sizeof(cpu_set_t), &pool->caller_cpus);
+        pool->caller_pinned = false;
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+int ggml_cpu_n_big_cores(void) {
+    static atomic_int n_big = -1;
+
+    int n = atomic_load(&n_big);
+    if (n < 0) {
+        cpu_set_t cpus;
+        n = ggml_get_big_cpus(&cpus);
+        atomic_store(&n_big, n);
+    }
+
+    return n;
+}
+
+#else
+
+struct ggml_threadpool * ggml_threadpool_new(void) {
+    return NULL;
+}
+
+void ggml_threadpool_free(struct ggml_threadpool * pool) {
+    UNUSED(pool);
+}
+
+int ggml_cpu_n_big_cores(void) {
+    return 0;
+}
+
+#endif // GGML_USE_THREADPOOL
+
 int ggml_graph_compute(struct ggml_cgraph * cgraph, struct ggml_cplan * cplan) {
     {
         GGML_ASSERT(cplan);
@@ -16039,13 +16921,21 @@ int ggml_graph_compute(struct ggml_cgraph * cgraph, struct ggml_cplan * cplan) {
         /*.n_threads               =*/ n_threads,
         /*.n_active                =*/ n_threads,
         /*.node_n                  =*/ -1,
+        /*.current_chunk           =*/ 0,
+        /*.aborted                 =*/ 0,
         /*.abort_callback          =*/ NULL,
         /*.abort_callback_data     =*/ NULL,
     };
     struct ggml_compute_state * workers = alloca(sizeof(struct ggml_compute_state)*n_threads);
 
+#ifdef GGML_USE_THREADPOOL
+    const bool use_threadpool = n_threads > 1 && cplan->threadpool && ggml_threadpool_start(cplan->threadpool, &state_shared, n_threads);
+#else
+    const bool use_threadpool = false;
+#endif
+
     // create thread pool
-    if (n_threads > 1) {
+    if (n_threads > 1 && !use_threadpool) {
         for (int j = 1; j < n_threads; ++j) {
             workers[j] = (struct ggml_compute_state) {
                 .thrd   = 0,
@@ -16072,7 +16962,11 @@ int ggml_graph_compute(struct ggml_cgraph * cgraph, struct ggml_cplan * cplan) {
     clear_numa_thread_affinity();
 
     // join or kill thread pool
-    if (n_threads > 1) {
+    if (use_threadpool) {
+#ifdef GGML_USE_THREADPOOL
+        ggml_threadpool_finish(cplan->threadpool, n_threads);
+#endif
+    } else if (n_threads > 1) {
         for (int j = 1; j < n_threads; j++) {
             const int rc = ggml_thread_join(workers[j].thrd, NULL);
             GGML_ASSERT(rc == 0);
@@ -19123,6 +20017,8 @@ int ggml_cpu_has_f16c(void) {
 int ggml_cpu_has_fp16_va(void) {
 #if defined(__ARM_FEATURE_FP16_VECTOR_ARITHMETIC)
     return 1;
+#elif defined(GGML_FP16_DISPATCH)
+    return ggml_arm_fp16_va;
 #else
     return 0;
 #endif
@@ -313,6 +313,8 @@ GGML_API void ggml_fp32_to_fp16_row(const float * x, ggml_fp16_t * y, int n);
 
 struct ggml_object;
 struct ggml_context;
+struct ggml_threadpool;
+struct ggml_compute_state_shared;
 
 enum ggml_type {
     GGML_TYPE_F32  = 0,
@@ -388,8 +390,10 @@ enum ggml_op {
     GGML_OP_RMS_NORM,
     GGML_OP_RMS_NORM_BACK,
     GGML_OP_GROUP_NORM,
+    GGML_OP_NORM_MUL_ADD,
 
     GGML_OP_MUL_MAT,
+    GGML_OP_MUL_MAT_ADD_GELU,
     GGML_OP_OUT_PROD,
 
     GGML_OP_SCALE,
@@ -413,6 +417,7 @@ enum ggml_op {
     GGML_OP_CLAMP,
     GGML_OP_CONV_TRANSPOSE_1D,
     GGML_OP_IM2COL,
+    GGML_OP_CONV_1D_PH_GELU,
     GGML_OP_CONV_TRANSPOSE_2D,
     GGML_OP_POOL_1D,
     GGML_OP_POOL_2D,
@@ -538,6 +543,10 @@ struct ggml_cplan {
 
     int n_threads;
 
+    // worker threads kept between graph computations, see ggml_threadpool_new()
+    // when NULL, the threads are started for this graph only
+    struct ggml_threadpool * threadpool;
+
     // abort ggml_graph_compute when true
     bool (*abort_callback)(void * data);
     void * abort_callback_data;
@@ -608,6 +617,10 @@ struct ggml_compute_params {
     // work buffer for all threads
     size_t wsize;
     void * wdata;
+
+    // state of the graph computation the node belongs to, holds the chunk counter of the kernels
+    // that hand out their work dynamically
+    struct ggml_compute_state_shared * shared;
 };
 
 // misc
@@ -997,6 +1010,15 @@ GGML_API struct ggml_tensor * ggml_norm_inplace(
         struct ggml_tensor  * a,
         float                 eps);
 
+// ggml_add(ggml_mul(ggml_norm(a, eps), b), c) in a single pass over each row
+// b, c: [ne0 of a] f32 scale and bias
+GGML_API struct ggml_tensor * ggml_norm_mul_add(
+        struct ggml_context * ctx,
+        struct ggml_tensor  * a,
+        struct ggml_tensor  * b,
+        struct ggml_tensor  * c,
+        float                 eps);
+
 GGML_API struct ggml_tensor * ggml_rms_norm(
         struct ggml_context * ctx,
         struct ggml_tensor  * a,
@@ -1036,6 +1058,15 @@ GGML_API struct ggml_tensor * ggml_mul_mat(
         struct ggml_tensor  * a,
         struct ggml_tensor  * b);
 
+// gelu(ggml_mul_mat(a, b) + c) in one node, the bias and gelu are applied to each tile of the
+// product before it is stored
+// c: [ne01 of a] f32 bias
+GGML_API struct ggml_tensor * ggml_mul_mat_add_gelu(
+        struct ggml_context * ctx,
+        struct ggml_tensor  * a,
+        struct ggml_tensor  * b,
+        struct ggml_tensor  * c);
+
 // A: m columns, n rows,
 // B: p columns, n rows,
 // result is m columns, p rows
@@ -1435,6 +1466,17 @@ GGML_API struct ggml_tensor* ggml_conv_1d_ph(
         int                   s,
         int                   d);
 
+// gelu(conv_1d_ph(a, b, s, 1) + c) without the im2col buffer
+// a: [OC, IC, K] f16 kernel, b: [IC, L] input (f32 or f16, may be a transposed view), c: [OC] bias
+// the result is [OL, OC] of the given type (channels contiguous), the transpose of ggml_conv_1d_ph
+GGML_API struct ggml_tensor * ggml_conv_1d_ph_gelu(
+        struct ggml_context * ctx,
+        struct ggml_tensor  * a,
+        struct ggml_tensor  * b,
+        struct ggml_tensor  * c,
+        int                   s,
+        enum ggml_type        type);
+
 GGML_API struct ggml_tensor * ggml_conv_transpose_1d(
         struct ggml_context * ctx,
         struct ggml_tensor  * a,
@@ -1770,6 +1812,15 @@ GGML_API size_t ggml_graph_overhead_custom(size_t size, bool grads);
 GGML_API struct ggml_cplan ggml_graph_plan   (struct ggml_cgraph * cgraph, int n_threads /*= GGML_DEFAULT_N_THREADS*/);
 GGML_API int               ggml_graph_compute(struct ggml_cgraph * cgraph, struct ggml_cplan * cplan);
 
+// worker threads for ggml_cplan.threadpool, they sleep between graph computations
+// returns NULL on platforms without a thread pool
+GGML_API struct ggml_threadpool * ggml_threadpool_new (void);
+GGML_API void                     ggml_threadpool_free(struct ggml_threadpool * threadpool);
+
+// number of cores in the faster clusters of a big.LITTLE system, 0 if all cores run at the same speed or
+// their speeds are unknown. the thread pool keeps the calling thread and its first workers on these cores
+GGML_API int ggml_cpu_n_big_cores(void);
+
 // same as ggml_graph_compute() but the work data is allocated as a part of the context
 // note: the drawback of this API is that you must have ensured that the context has enough memory for the work data
 GGML_API void ggml_graph_compute_with_ctx(struct ggml_context * ctx, struct ggml_cgraph * cgraph, int n_threads);
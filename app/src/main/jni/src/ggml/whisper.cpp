@@ -23,6 +23,7 @@
 #include "ggml-alloc.h"
 #include "ggml-backend.h"
 #include "defines.h"
+#include "utils/native_trace.h"
 
 #include <atomic>
 #include <algorithm>
@@ -46,6 +47,14 @@
 #pragma warning(disable: 4244 4267) // possible loss of data
 #endif
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define WHISPER_USE_MMAP
+#endif
+
 #if defined(GGML_BIG_ENDIAN)
 #include <bit>
 
@@ -150,11 +159,13 @@ static void whisper_log_callback_default(ggml_log_level level, const char * text
 #define WHISPER_PRINT_DEBUG(...)
 #endif
 
-#define WHISPER_USE_FLASH_ATTN
 //#define WHISPER_USE_FLASH_FF
 #define WHISPER_MAX_DECODERS 8
 #define WHISPER_MAX_NODES 4096
 
+// smallest self-attention context a memory budget reduces a state to, a quarter of the model context
+#define WHISPER_MIN_TEXT_CTX 112
+
 //
 // ggml helpers
 //
@@ -367,6 +378,10 @@ struct whisper_filters {
     int32_t n_fft;
 
     std::vector<float> data;
+
+    // the weights of row j that are not zero are the bins [span_begin[j], span_end[j]), set at load
+    std::vector<int32_t> span_begin;
+    std::vector<int32_t> span_end;
 };
 
 struct whisper_vocab {
@@ -482,11 +497,14 @@ struct whisper_allocr {
 
     std::vector<uint8_t> meta;
 
-    ggml_backend_buffer_t buffer;
+    ggml_backend_buffer_t buffer = nullptr;
+
+    // size of the data buffer, measured by whisper_allocr_graph_init
+    size_t size = 0;
 };
 
 static size_t whisper_allocr_size(struct whisper_allocr & allocr) {
-    return allocr.meta.size() + ggml_allocr_max_size(allocr.alloc);
+    return allocr.meta.size() + allocr.size;
 }
 
 // measure the memory usage of a graph and prepare the allocr's internal data buffer
@@ -494,36 +512,29 @@ static void whisper_allocr_graph_init(struct whisper_allocr & allocr, ggml_backe
     auto & alloc  = allocr.alloc;
     auto & meta   = allocr.meta;
 
+    if (alloc) {
+        // measuring again, e.g. after the KV cache has been resized
+        ggml_allocr_free(alloc);
+    }
+
     ggml_backend_buffer_t buffer = ggml_backend_alloc_buffer(backend, 1);
     alloc = ggml_allocr_new_measure(ggml_backend_buffer_get_alignment(buffer));
-    //alloc
+    ggml_backend_buffer_free(buffer);
 
     meta.resize(ggml_tensor_overhead()*WHISPER_MAX_NODES + ggml_graph_overhead());
 
     ggml_allocr_alloc_graph(alloc, get_graph());
-}
-
-static void whisper_allocr_graph_realloc(struct whisper_allocr & allocr, ggml_backend_t backend) {
-    if (allocr.alloc == nullptr) {
-        // this can be null if we use external encoder like CoreML or OpenVINO
-        return;
-    }
-
-    auto & alloc  = allocr.alloc;
-    auto & buffer = allocr.buffer;
 
-    size_t size = ggml_allocr_max_size(alloc);
-
-    ggml_allocr_free(alloc);
-
-    buffer = ggml_backend_alloc_buffer(backend, size);
-    alloc = ggml_allocr_new_from_buffer(buffer);
+    allocr.size = ggml_allocr_max_size(alloc);
 }
 
 static void whisper_allocr_free(struct whisper_allocr & allocr) {
     if (allocr.alloc) {
         ggml_allocr_free(allocr.alloc);
-        ggml_backend_buffer_free(allocr.buffer);
+        if (allocr.buffer) {
+            ggml_backend_buffer_free(allocr.buffer);
+            allocr.buffer = nullptr;
+        }
         allocr.alloc = nullptr;
     }
 }
@@ -664,12 +675,16 @@ struct whisper_kv_cache {
 
     std::vector<whisper_kv_cell> cells;
 
-    struct ggml_tensor * k;
-    struct ggml_tensor * v;
+    struct ggml_tensor * k = nullptr;
+    struct ggml_tensor * v = nullptr;
 
-    struct ggml_context * ctx;
+    // kept to allocate the cache again after whisper_trim_memory has freed it
+    ggml_type ktype = GGML_TYPE_F16;
+    ggml_type vtype = GGML_TYPE_F16;
 
-    ggml_backend_buffer_t buffer;
+    struct ggml_context * ctx = nullptr;
+
+    ggml_backend_buffer_t buffer = nullptr;
 };
 
 struct whisper_model {
@@ -712,6 +727,13 @@ struct whisper_model {
     // the model backend data is read-only and can be shared between processors
     struct ggml_backend_buffer * buffer;
 
+    // the weights used in place from the loader's memory, see whisper_model_loader::map
+    struct ggml_backend_buffer * buffer_mapped = nullptr;
+
+    // the model file mapping owned by the context, if it was loaded with use_mmap
+    void * mapping_addr = nullptr;
+    size_t mapping_size = 0;
+
     // tensors
     int n_loaded;
     std::map<std::string, struct ggml_tensor *> tensors;
@@ -825,6 +847,9 @@ struct whisper_state {
     // decode output (2-dimensional array: [n_tokens][n_vocab])
     std::vector<float> logits;
 
+    // ids masked by suppress_non_speech_tokens, looked up once per whisper_full call
+    std::vector<whisper_token> non_speech_ids;
+
     std::vector<whisper_segment> result_all;
     std::vector<whisper_token>   prompt_past;
 
@@ -850,6 +875,13 @@ struct whisper_state {
 
     // [EXPERIMENTAL] speed-up techniques
     int32_t exp_n_audio_ctx = 0; // 0 - use default
+
+    // self-attention context of a decoder, n_text_ctx of the model unless a memory budget reduced it
+    int32_t n_text_ctx = 0;
+
+    // bytes held in KV caches and compute buffers, now and at most since the state was created
+    size_t mem_cur  = 0;
+    size_t mem_peak = 0;
 };
 
 struct whisper_context {
@@ -889,7 +921,8 @@ static bool kv_cache_init(
         const struct whisper_hparams & hparams,
         struct whisper_kv_cache & cache,
         ggml_backend_t   backend,
-        ggml_type   wtype,
+        ggml_type   ktype,
+        ggml_type   vtype,
         int   n_ctx) {
     const int64_t n_text_state = hparams.n_text_state;
     const int64_t n_text_layer = hparams.n_text_layer;
@@ -905,6 +938,8 @@ static bool kv_cache_init(
 
     cache.head = 0;
     cache.size = n_ctx;
+    cache.ktype = ktype;
+    cache.vtype = vtype;
 
     cache.cells.clear();
     cache.cells.resize(n_ctx);
@@ -916,8 +951,8 @@ static bool kv_cache_init(
         return false;
     }
 
-    cache.k = ggml_new_tensor_1d(cache.ctx, wtype, n_elements);
-    cache.v = ggml_new_tensor_1d(cache.ctx, wtype, n_elements);
+    cache.k = ggml_new_tensor_1d(cache.ctx, ktype, n_elements);
+    cache.v = ggml_new_tensor_1d(cache.ctx, vtype, n_elements);
 
     const size_t mem_bytes = ggml_nbytes(cache.k) + ggml_nbytes(cache.v);
 
@@ -936,12 +971,46 @@ static bool kv_cache_init(
     return true;
 }
 
+// size in bytes of n consecutive elements of a cache row, which for quantized types must be a whole
+// number of blocks
+static size_t whisper_row_size(ggml_type type, int64_t n) {
+    return ggml_type_size(type)*n/ggml_blck_size(type);
+}
+
 static void kv_cache_free(struct whisper_kv_cache & cache) {
     if (cache.ctx) {
         ggml_free(cache.ctx);
         ggml_backend_buffer_free(cache.buffer);
         cache.ctx = nullptr;
+        cache.buffer = nullptr;
+        cache.k = nullptr;
+        cache.v = nullptr;
+    }
+}
+
+static size_t kv_cache_nbytes(const struct whisper_kv_cache & cache) {
+    return cache.ctx ? ggml_nbytes(cache.k) + ggml_nbytes(cache.v) : 0;
+}
+
+// allocates a cache that whisper_trim_memory has freed again, with its previous size and types
+static bool kv_cache_reacquire(
+        const struct whisper_hparams & hparams,
+        struct whisper_kv_cache & cache,
+        ggml_backend_t backend,
+        size_t & mem_cur,
+        size_t & mem_peak) {
+    if (cache.ctx || cache.size == 0) {
+        return true;
+    }
+
+    if (!kv_cache_init(hparams, cache, backend, cache.ktype, cache.vtype, cache.size)) {
+        return false;
     }
+
+    mem_cur += kv_cache_nbytes(cache);
+    mem_peak = std::max(mem_peak, mem_cur);
+
+    return true;
 }
 
 static bool whisper_kv_cache_find_slot(
@@ -1104,6 +1173,87 @@ static ggml_backend_t whisper_backend_init(const whisper_context_params & params
 //
 // see the convert-pt-to-ggml.py script for details
 //
+// we repeat the 2 bias tensors along dim 0:
+// [1, 512] -> [3000, 512] (conv1.bias)
+// [1, 512] -> [1500, 512] (conv2.bias)
+// data holds the ne[1] values of the file and is expanded in place
+static void whisper_expand_conv_bias(const ggml_tensor * tensor, float * data_f32) {
+    for (int64_t y = 0; y < tensor->ne[1]; ++y) {
+        const int64_t yy = tensor->ne[1] - y - 1;
+        const float val = data_f32[yy];
+
+        for (int64_t x = 0; x < tensor->ne[0]; ++x) {
+            data_f32[yy*tensor->ne[0] + x] = val;
+        }
+    }
+}
+
+// ggml reads the weights with unaligned vector loads, so a tensor can be used in place once it has the
+// alignment of the scalars its blocks are made of. The tensor data in a model file starts wherever the
+// name before it ends, so on arm64, where every load handles unaligned addresses, any address will do.
+static bool whisper_is_aligned_for_type(const void * data, ggml_type type) {
+#if defined(__aarch64__)
+    GGML_UNUSED(data);
+    GGML_UNUSED(type);
+    return true;
+#else
+    size_t alignment = sizeof(float);
+    switch (type) {
+        case GGML_TYPE_F16:
+        case GGML_TYPE_Q4_0:
+        case GGML_TYPE_Q4_1:
+        case GGML_TYPE_Q5_0:
+        case GGML_TYPE_Q5_1:
+        case GGML_TYPE_Q8_0:
+            alignment = sizeof(ggml_fp16_t);
+            break;
+        default:
+            break;
+    }
+    return reinterpret_cast<uintptr_t>(data) % alignment == 0;
+#endif
+}
+
+// values converted at once when quantizing weights
+#define WHISPER_QUANTIZE_CHUNK (1 << 16)
+
+// the types encoder_wtype can convert the weight matrices to while loading
+static bool whisper_is_weight_qtype(ggml_type type) {
+    switch (type) {
+        case GGML_TYPE_Q4_0:
+        case GGML_TYPE_Q4_1:
+        case GGML_TYPE_Q5_0:
+        case GGML_TYPE_Q5_1:
+        case GGML_TYPE_Q8_0:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// quantizes the F16 / F32 weights in src to the type of tensor, into dst
+static void whisper_quantize_weights(const ggml_tensor * tensor, ggml_type src_type, const void * src, void * dst) {
+    const int64_t n_per_row = tensor->ne[0];
+    const int64_t n_rows = ggml_nelements(tensor)/n_per_row;
+    const int64_t n_rows_chunk = std::max<int64_t>(1, WHISPER_QUANTIZE_CHUNK/n_per_row);
+    const size_t  row_size = n_per_row/ggml_blck_size(tensor->type)*ggml_type_size(tensor->type);
+
+    std::vector<float> f32(n_rows_chunk*n_per_row);
+    std::vector<int64_t> hist(1 << 4, 0);
+
+    for (int64_t r0 = 0; r0 < n_rows; r0 += n_rows_chunk) {
+        const int n = std::min(n_rows_chunk, n_rows - r0)*n_per_row;
+
+        if (src_type == GGML_TYPE_F16) {
+            ggml_fp16_to_fp32_row((const ggml_fp16_t *) src + r0*n_per_row, f32.data(), n);
+        } else {
+            memcpy(f32.data(), (const float *) src + r0*n_per_row, n*sizeof(float));
+        }
+
+        ggml_quantize_chunk(tensor->type, f32.data(), (char *) dst + r0*row_size, 0, n, hist.data());
+    }
+}
+
 static bool whisper_model_load(struct whisper_model_loader * loader, whisper_context & wctx) {
     WHISPER_LOG_INFO("%s: loading model\n", __func__);
 
@@ -1205,6 +1355,23 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
         filters.data.resize(filters.n_mel * filters.n_fft);
         loader->read(loader->context, filters.data.data(), filters.data.size() * sizeof(float));
         BYTESWAP_FILTERS(filters);
+
+        // each mel filter is a triangle over a few bins, the mel spectrogram only reads those
+        filters.span_begin.resize(filters.n_mel);
+        filters.span_end.resize(filters.n_mel);
+        for (int j = 0; j < filters.n_mel; j++) {
+            const float * row = filters.data.data() + j * filters.n_fft;
+            int begin = 0;
+            int end   = filters.n_fft;
+            while (begin < end && row[begin] == 0.0f) {
+                begin++;
+            }
+            while (end > begin && row[end - 1] == 0.0f) {
+                end--;
+            }
+            filters.span_begin[j] = begin;
+            filters.span_end[j]   = end;
+        }
     }
 
     // load vocab
@@ -1299,6 +1466,23 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
     const ggml_type wtype = wctx.wtype;
     const ggml_type vtype = wctx.wtype == GGML_TYPE_F32 ? GGML_TYPE_F32 : GGML_TYPE_F16; // conv type
 
+    // the encoder matrices of an F16 / F32 model can be quantized while loading: the encoder matmuls then
+    // quantize their activations once to the vec_dot_type and use the integer dot products
+    ggml_type etype = wtype;
+    if (wctx.params.encoder_wtype != GGML_TYPE_COUNT && wctx.params.encoder_wtype != wtype) {
+        const ggml_type qtype = wctx.params.encoder_wtype;
+        if (!whisper_is_weight_qtype(qtype)) {
+            WHISPER_LOG_WARN("%s: encoder_wtype %d is not a weight type, keeping %s\n", __func__, (int) qtype, ggml_type_name(wtype));
+        } else if (wtype != GGML_TYPE_F16 && wtype != GGML_TYPE_F32) {
+            WHISPER_LOG_WARN("%s: the model is quantized already, keeping %s\n", __func__, ggml_type_name(wtype));
+        } else if (model.hparams.n_audio_state % ggml_blck_size(qtype) != 0) {
+            WHISPER_LOG_WARN("%s: n_audio_state is not a multiple of the %s blocks, keeping %s\n", __func__, ggml_type_name(qtype), ggml_type_name(wtype));
+        } else {
+            etype = qtype;
+            WHISPER_LOG_INFO("%s: encoder type  = %s\n", __func__, ggml_type_name(etype));
+        }
+    }
+
     // create the ggml context
     {
         const auto & hparams = model.hparams;
@@ -1373,24 +1557,24 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
                 layer.mlp_ln_w    = ggml_new_tensor_1d(ctx, GGML_TYPE_F32,   n_audio_state);
                 layer.mlp_ln_b    = ggml_new_tensor_1d(ctx, GGML_TYPE_F32,   n_audio_state);
 
-                layer.mlp_0_w     = ggml_new_tensor_2d(ctx, wtype,           n_audio_state, 4*n_audio_state);
+                layer.mlp_0_w     = ggml_new_tensor_2d(ctx, etype,           n_audio_state, 4*n_audio_state);
                 layer.mlp_0_b     = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, 4*n_audio_state);
 
-                layer.mlp_1_w     = ggml_new_tensor_2d(ctx, wtype,         4*n_audio_state, n_audio_state);
+                layer.mlp_1_w     = ggml_new_tensor_2d(ctx, etype,         4*n_audio_state, n_audio_state);
                 layer.mlp_1_b     = ggml_new_tensor_1d(ctx, GGML_TYPE_F32,   n_audio_state);
 
                 layer.attn_ln_0_w = ggml_new_tensor_1d(ctx, GGML_TYPE_F32,   n_audio_state);
                 layer.attn_ln_0_b = ggml_new_tensor_1d(ctx, GGML_TYPE_F32,   n_audio_state);
 
-                layer.attn_q_w    = ggml_new_tensor_2d(ctx, wtype,           n_audio_state, n_audio_state);
+                layer.attn_q_w    = ggml_new_tensor_2d(ctx, etype,           n_audio_state, n_audio_state);
                 layer.attn_q_b    = ggml_new_tensor_1d(ctx, GGML_TYPE_F32,   n_audio_state);
 
-                layer.attn_k_w    = ggml_new_tensor_2d(ctx, wtype,           n_audio_state, n_audio_state);
+                layer.attn_k_w    = ggml_new_tensor_2d(ctx, etype,           n_audio_state, n_audio_state);
 
-                layer.attn_v_w    = ggml_new_tensor_2d(ctx, wtype,           n_audio_state, n_audio_state);
+                layer.attn_v_w    = ggml_new_tensor_2d(ctx, etype,           n_audio_state, n_audio_state);
                 layer.attn_v_b    = ggml_new_tensor_1d(ctx, GGML_TYPE_F32,   n_audio_state);
 
-                layer.attn_ln_1_w = ggml_new_tensor_2d(ctx, wtype,           n_audio_state, n_audio_state);
+                layer.attn_ln_1_w = ggml_new_tensor_2d(ctx, etype,           n_audio_state, n_audio_state);
                 layer.attn_ln_1_b = ggml_new_tensor_1d(ctx, GGML_TYPE_F32,   n_audio_state);
 
                 // map by name
@@ -1519,7 +1703,18 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
 
     wctx.backend = whisper_backend_init(wctx.params);
 
-    {
+    // if the loader can map the model, the CPU backend uses the weights in place and only the tensors
+    // that cannot be used as stored are allocated, after all of them have been seen
+#if defined(GGML_BIG_ENDIAN)
+    const bool use_map = false;
+#else
+    const bool use_map = loader->map != nullptr && ggml_backend_is_cpu(wctx.backend);
+#endif
+
+    model.buffer = nullptr;
+    ggml_allocr * alloc = nullptr;
+
+    if (!use_map) {
         size_t size_main = 0;
 
         for (const auto & t : model.tensors) {
@@ -1529,12 +1724,10 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
         model.buffer = ggml_backend_alloc_buffer(wctx.backend, size_main);
 
         WHISPER_LOG_INFO("%s: %8s buffer size = %8.2f MB\n", __func__, ggml_backend_name(wctx.backend), size_main / 1e6);
-    }
 
-    ggml_allocr * alloc = ggml_allocr_new_from_buffer(model.buffer);
+        alloc = ggml_allocr_new_from_buffer(model.buffer);
 
-    // allocate tensors in the backend buffers
-    {
+        // allocate tensors in the backend buffers
         for (const auto & t : model.tensors) {
             ggml_allocr_alloc(alloc, t.second);
         }
@@ -1548,6 +1741,13 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
 
         std::vector<char> read_buf;
 
+        // with use_map: the tensors pointing into the loader's memory, and the ones to copy from it
+        std::vector<ggml_tensor *> mapped;
+        std::vector<std::pair<ggml_tensor *, const void *>> copied;
+        const char * mapped_begin = nullptr;
+        const char * mapped_end   = nullptr;
+        size_t size_mapped = 0;
+
         while (true) {
             int32_t n_dims;
             int32_t length;
@@ -1582,6 +1782,16 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
 
             const bool is_conv_bias = (name == "encoder.conv1.bias" || name == "encoder.conv2.bias");
 
+            // an encoder matrix quantized from the weights in the file, see etype
+            const bool is_converted = tensor->type != wtype && ggml_is_quantized(tensor->type);
+            if (is_converted && ttype != wtype) {
+                WHISPER_LOG_ERROR("%s: tensor '%s' has type %d in model file, expected %d\n", __func__, name.data(), ttype, (int) wtype);
+                return false;
+            }
+
+            // the size of the tensor data in the file
+            const size_t nbytes_file = is_converted ? nelements*ggml_type_size(wtype) : ggml_nbytes(tensor);
+
             if (!is_conv_bias) {
                 if (ggml_nelements(tensor) != nelements) {
                     WHISPER_LOG_ERROR("%s: tensor '%s' has wrong size in model file\n", __func__, name.data());
@@ -1598,7 +1808,7 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
 
                 const size_t bpe = ggml_type_size(ggml_type(ttype));
 
-                if ((nelements*bpe)/ggml_blck_size(tensor->type) != ggml_nbytes(tensor)) {
+                if (!is_converted && (nelements*bpe)/ggml_blck_size(tensor->type) != ggml_nbytes(tensor)) {
                     WHISPER_LOG_ERROR("%s: tensor '%s' has wrong size in model file: got %zu, expected %zu\n",
                                       __func__, name.data(), ggml_nbytes(tensor), nelements*bpe);
                     return false;
@@ -1609,7 +1819,32 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
 
             //printf("%s: [%5.5s] %s\n", __func__, ggml_backend_name(backend), name.c_str());
 
-            if ((ggml_backend_is_cpu(backend)
+            if (use_map) {
+                const size_t file_size = is_conv_bias ? ggml_nbytes(tensor) / tensor->ne[0] : nbytes_file;
+                const char * data = (const char *) loader->map(loader->context, file_size);
+                if (data == nullptr) {
+                    WHISPER_LOG_ERROR("%s: tensor '%s' is truncated in model file\n", __func__, name.data());
+                    return false;
+                }
+
+                if (!is_conv_bias && !is_converted && whisper_is_aligned_for_type(data, tensor->type)) {
+                    tensor->data = (void *) data;
+                    mapped.push_back(tensor);
+                    mapped_begin = mapped_begin ? std::min(mapped_begin, data) : data;
+                    mapped_end   = std::max(mapped_end, data + file_size);
+                    size_mapped += file_size;
+                } else {
+                    copied.emplace_back(tensor, data);
+                }
+            } else if (is_converted) {
+                read_buf.resize(nbytes_file);
+                loader->read(loader->context, read_buf.data(), read_buf.size());
+
+                std::vector<char> quantized(ggml_nbytes(tensor));
+                whisper_quantize_weights(tensor, wtype, read_buf.data(), quantized.data());
+
+                ggml_backend_tensor_set(tensor, quantized.data(), 0, ggml_nbytes(tensor));
+            } else if ((ggml_backend_is_cpu(backend)
 #ifdef GGML_USE_METAL
                         || ggml_backend_is_metal(backend)
 #endif
@@ -1621,21 +1856,9 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
                 // read into a temporary buffer first, then copy to device memory
                 read_buf.resize(ggml_nbytes(tensor));
 
-                // we repeat the 2 bias tensors along dim 0:
-                // [1, 512] -> [3000, 512] (conv1.bias)
-                // [1, 512] -> [1500, 512] (conv2.bias)
                 if (is_conv_bias) {
                     loader->read(loader->context, read_buf.data(), read_buf.size() / tensor->ne[0]);
-
-                    float * data_f32 = (float *) read_buf.data();
-                    for (int64_t y = 0; y < tensor->ne[1]; ++y) {
-                        const int64_t yy = tensor->ne[1] - y - 1;
-                        const float val = data_f32[yy];
-
-                        for (int64_t x = 0; x < tensor->ne[0]; ++x) {
-                            data_f32[yy*tensor->ne[0] + x] = val;
-                        }
-                    }
+                    whisper_expand_conv_bias(tensor, (float *) read_buf.data());
                 } else {
                     loader->read(loader->context, read_buf.data(), read_buf.size());
                 }
@@ -1648,6 +1871,44 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
             model.n_loaded++;
         }
 
+        if (use_map) {
+            size_t size_main = 0;
+
+            for (const auto & t : copied) {
+                size_main += ggml_nbytes(t.first) + ggml_tensor_overhead();
+            }
+
+            WHISPER_LOG_INFO("%s: %8s mapped size = %8.2f MB, buffer size = %8.2f MB\n", __func__, ggml_backend_name(wctx.backend),
+                    size_mapped / 1e6, size_main / 1e6);
+
+            if (!mapped.empty()) {
+                model.buffer_mapped = ggml_backend_cpu_buffer_from_ptr(wctx.backend, (void *) mapped_begin, mapped_end - mapped_begin);
+                for (auto * tensor : mapped) {
+                    tensor->buffer = model.buffer_mapped;
+                }
+            }
+
+            if (!copied.empty()) {
+                model.buffer = ggml_backend_alloc_buffer(wctx.backend, size_main);
+                alloc = ggml_allocr_new_from_buffer(model.buffer);
+
+                for (const auto & t : copied) {
+                    ggml_tensor * tensor = t.first;
+                    ggml_allocr_alloc(alloc, tensor);
+
+                    const bool is_conv_bias = tensor == model.e_conv_1_b || tensor == model.e_conv_2_b;
+                    if (is_conv_bias) {
+                        memcpy(tensor->data, t.second, ggml_nbytes(tensor) / tensor->ne[0]);
+                        whisper_expand_conv_bias(tensor, (float *) tensor->data);
+                    } else if (tensor->type != wtype && ggml_is_quantized(tensor->type)) {
+                        whisper_quantize_weights(tensor, wtype, t.second, tensor->data);
+                    } else {
+                        memcpy(tensor->data, t.second, ggml_nbytes(tensor));
+                    }
+                }
+            }
+        }
+
         WHISPER_LOG_INFO("%s: model size    = %7.2f MB\n", __func__, total_size/1e6);
 
         if (model.n_loaded == 0) {
@@ -1658,7 +1919,9 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
         }
     }
 
-    ggml_allocr_free(alloc);
+    if (alloc) {
+        ggml_allocr_free(alloc);
+    }
 
     wctx.t_load_us = ggml_time_us() - t_start_us;
 
@@ -1683,6 +1946,31 @@ static bool whisper_encode_external(const whisper_state & wstate) {
     return use_coreml || use_openvino;
 }
 
+// allocates the data buffer of a measured allocr, unless it is held already
+static void whisper_allocr_acquire(whisper_state & wstate, whisper_allocr & allocr, ggml_backend_t backend) {
+    if (allocr.alloc != nullptr || allocr.size == 0) {
+        // held, or never measured because an external encoder like CoreML or OpenVINO is used
+        return;
+    }
+
+    allocr.buffer = ggml_backend_alloc_buffer(backend, allocr.size);
+    allocr.alloc  = ggml_allocr_new_from_buffer(allocr.buffer);
+
+    wstate.mem_cur += allocr.size;
+    wstate.mem_peak = std::max(wstate.mem_peak, wstate.mem_cur);
+}
+
+// with a memory budget, the compute buffers are only held while their graphs are used
+static void whisper_allocr_release(whisper_state & wstate, whisper_allocr & allocr) {
+    if (allocr.alloc == nullptr) {
+        return;
+    }
+
+    whisper_allocr_free(allocr);
+
+    wstate.mem_cur -= allocr.size;
+}
+
 static struct ggml_cgraph * whisper_build_graph_conv(
         whisper_context & wctx,
         whisper_state & wstate,
@@ -1736,24 +2024,15 @@ static struct ggml_cgraph * whisper_build_graph_conv(
 
     if (!whisper_encode_external(wstate)) {
         // convolution + gelu
+        // both layers run as one fused op each and produce [n_state, n_ctx], the layout the encoder consumes;
+        // the first layer keeps its output in F16, which is what the second layer reads it as anyway
         {
-            cur = ggml_conv_1d_ph(ctx0, model.e_conv_1_w, mel, 1, 1);
-            if (!ggml_allocr_is_measure(alloc) && n_ctx == hparams.n_audio_ctx) {
-                cur = ggml_add(ctx0, cur, model.e_conv_1_b);
-            } else {
-                cur = ggml_add(ctx0, cur, ggml_cont(ctx0, ggml_view_2d(ctx0, model.e_conv_1_b, cur->ne[0], cur->ne[1], model.e_conv_1_b->nb[1], 0)));
-            }
-
-            cur = ggml_gelu(ctx0, cur);
+            // the conv biases are stored expanded along dim 0, the first column holds the values
+            struct ggml_tensor * b1 = ggml_transpose(ctx0, ggml_view_2d(ctx0, model.e_conv_1_b, 1, n_state, model.e_conv_1_b->nb[1], 0));
+            struct ggml_tensor * b2 = ggml_transpose(ctx0, ggml_view_2d(ctx0, model.e_conv_2_b, 1, n_state, model.e_conv_2_b->nb[1], 0));
 
-            cur = ggml_conv_1d_ph(ctx0, model.e_conv_2_w, cur, 2, 1);
-            if (!ggml_allocr_is_measure(alloc) && n_ctx == hparams.n_audio_ctx) {
-                cur = ggml_add(ctx0, cur, model.e_conv_2_b);
-            } else {
-                cur = ggml_add(ctx0, cur, ggml_cont(ctx0, ggml_view_2d(ctx0, model.e_conv_2_b, cur->ne[0], cur->ne[1], model.e_conv_2_b->nb[1], 0)));
-            }
-
-            cur = ggml_gelu(ctx0, cur);
+            cur = ggml_conv_1d_ph_gelu(ctx0, model.e_conv_1_w, mel, b1, 1, GGML_TYPE_F16);
+            cur = ggml_conv_1d_ph_gelu(ctx0, model.e_conv_2_w, ggml_transpose(ctx0, cur), b2, 2, GGML_TYPE_F32);
         }
 
         ggml_set_name(cur, "embd_conv");
@@ -1844,7 +2123,7 @@ static struct ggml_cgraph * whisper_build_graph_encoder(
     const size_t e_pe_offset = model.e_pe->ne[0]*ggml_element_size(model.e_pe)*n_ctx*iter;
 
     struct ggml_tensor * e_pe = ggml_view_2d(ctx0, model.e_pe, model.e_pe->ne[0], n_ctx, e_pe_stride, e_pe_offset);
-    cur = ggml_add(ctx0, e_pe, ggml_cont(ctx0, ggml_transpose(ctx0, cur)));
+    cur = ggml_add(ctx0, e_pe, cur);
 
     // ===================================================================
 
@@ -1858,12 +2137,8 @@ static struct ggml_cgraph * whisper_build_graph_encoder(
 
         // norm
         {
-            cur = ggml_norm(ctx0, inpL, hparams.eps);
-
-            // cur = ln_0_w*cur + ln_0_b
-            cur = ggml_add(ctx0,
-                           ggml_mul(ctx0, cur, layer.attn_ln_0_w),
-                           layer.attn_ln_0_b);
+            // cur = ln_0_w*norm(inpL) + ln_0_b
+            cur = ggml_norm_mul_add(ctx0, inpL, layer.attn_ln_0_w, layer.attn_ln_0_b, hparams.eps);
         }
 
         // self-attention
@@ -1891,65 +2166,69 @@ static struct ggml_cgraph * whisper_build_graph_encoder(
 
             // ------
 
-#ifdef WHISPER_USE_FLASH_ATTN
-            struct ggml_tensor * Q =
-                    ggml_permute(ctx0,
-                                 ggml_cpy(ctx0,
-                                          Qcur,
-                                          ggml_new_tensor_3d(ctx0, wctx.itype, n_state/n_head, n_head, n_ctx)),
-                                 0, 2, 1, 3);
-
-            struct ggml_tensor * K =
-                    ggml_permute(ctx0,
-                                 ggml_cpy(ctx0,
-                                          Kcur,
-                                          ggml_new_tensor_3d(ctx0, wctx.itype, n_state/n_head, n_head, n_ctx)),
-                                 0, 2, 1, 3);
-
-            struct ggml_tensor * V =
-                    ggml_cpy(ctx0,
-                             ggml_permute(ctx0,
-                                          ggml_reshape_3d(ctx0,
-                                                          Vcur,
-                                                          n_state/n_head, n_head, n_ctx),
-                                          1, 2, 0, 3),
-                             ggml_new_tensor_3d(ctx0, wctx.itype, n_ctx, n_state/n_head, n_head));
-
-            struct ggml_tensor * KQV = ggml_flash_attn(ctx0, Q, K, V, false);
-#else
-            struct ggml_tensor * Q =
-                    ggml_permute(ctx0,
-                                 ggml_cpy(ctx0,
-                                          Qcur,
-                                          ggml_new_tensor_3d(ctx0, GGML_TYPE_F32, n_state/n_head, n_head, n_ctx)),
-                                 0, 2, 1, 3);
-
-            struct ggml_tensor * K =
-                    ggml_permute(ctx0,
-                                 ggml_cpy(ctx0,
-                                          Kcur,
-                                          ggml_new_tensor_3d(ctx0, wctx.itype, n_state/n_head, n_head, n_ctx)),
-                                 0, 2, 1, 3);
-
-            // K * Q
-            struct ggml_tensor * KQ = ggml_mul_mat(ctx0, K, Q);
-
-            struct ggml_tensor * KQ_scaled = ggml_scale(ctx0, KQ, KQscale);
-
-            struct ggml_tensor * KQ_soft_max = ggml_soft_max(ctx0, KQ_scaled);
-
-            struct ggml_tensor * V =
-                    ggml_cpy(ctx0,
-                             ggml_permute(ctx0,
-                                          ggml_reshape_3d(ctx0,
-                                                          Vcur,
-                                                          n_state/n_head, n_head, n_ctx),
-                                          1, 2, 0, 3),
-                             ggml_new_tensor_3d(ctx0, wctx.itype, n_ctx, n_state/n_head, n_head)
-                    );
-
-            struct ggml_tensor * KQV = ggml_mul_mat(ctx0, V, KQ_soft_max);
-#endif
+            struct ggml_tensor * KQV;
+
+            // flash attention computes the softmax of one query row at a time, so the n_ctx x n_ctx
+            // KQ matrices of every head are never materialized
+            if (wctx.params.flash_attn) {
+                struct ggml_tensor * Q =
+                        ggml_permute(ctx0,
+                                     ggml_cpy(ctx0,
+                                              Qcur,
+                                              ggml_new_tensor_3d(ctx0, wctx.itype, n_state/n_head, n_head, n_ctx)),
+                                     0, 2, 1, 3);
+
+                struct ggml_tensor * K =
+                        ggml_permute(ctx0,
+                                     ggml_cpy(ctx0,
+                                              Kcur,
+                                              ggml_new_tensor_3d(ctx0, wctx.itype, n_state/n_head, n_head, n_ctx)),
+                                     0, 2, 1, 3);
+
+                struct ggml_tensor * V =
+                        ggml_cpy(ctx0,
+                                 ggml_permute(ctx0,
+                                              ggml_reshape_3d(ctx0,
+                                                              Vcur,
+                                                              n_state/n_head, n_head, n_ctx),
+                                              1, 2, 0, 3),
+                                 ggml_new_tensor_3d(ctx0, wctx.itype, n_ctx, n_state/n_head, n_head));
+
+                KQV = ggml_flash_attn(ctx0, Q, K, V, false);
+            } else {
+                struct ggml_tensor * Q =
+                        ggml_permute(ctx0,
+                                     ggml_cpy(ctx0,
+                                              Qcur,
+                                              ggml_new_tensor_3d(ctx0, GGML_TYPE_F32, n_state/n_head, n_head, n_ctx)),
+                                     0, 2, 1, 3);
+
+                struct ggml_tensor * K =
+                        ggml_permute(ctx0,
+                                     ggml_cpy(ctx0,
+                                              Kcur,
+                                              ggml_new_tensor_3d(ctx0, wctx.itype, n_state/n_head, n_head, n_ctx)),
+                                     0, 2, 1, 3);
+
+                // K * Q
+                struct ggml_tensor * KQ = ggml_mul_mat(ctx0, K, Q);
+
+                struct ggml_tensor * KQ_scaled = ggml_scale(ctx0, KQ, KQscale);
+
+                struct ggml_tensor * KQ_soft_max = ggml_soft_max(ctx0, KQ_scaled);
+
+                struct ggml_tensor * V =
+                        ggml_cpy(ctx0,
+                                 ggml_permute(ctx0,
+                                              ggml_reshape_3d(ctx0,
+                                                              Vcur,
+                                                              n_state/n_head, n_head, n_ctx),
+                                              1, 2, 0, 3),
+                                 ggml_new_tensor_3d(ctx0, wctx.itype, n_ctx, n_state/n_head, n_head)
+                        );
+
+                KQV = ggml_mul_mat(ctx0, V, KQ_soft_max);
+            }
             struct ggml_tensor * KQV_merged = ggml_permute(ctx0, KQV, 0, 2, 1, 3);
 
             cur = ggml_cpy(ctx0,
@@ -1975,12 +2254,8 @@ static struct ggml_cgraph * whisper_build_graph_encoder(
         {
             // norm
             {
-                cur = ggml_norm(ctx0, inpFF, hparams.eps);
-
-                // cur = mlp_ln_w*cur + mlp_ln_b
-                cur = ggml_add(ctx0,
-                               ggml_mul(ctx0, cur, layer.mlp_ln_w),
-                               layer.mlp_ln_b);
+                // cur = mlp_ln_w*norm(inpFF) + mlp_ln_b
+                cur = ggml_norm_mul_add(ctx0, inpFF, layer.mlp_ln_w, layer.mlp_ln_b, hparams.eps);
             }
 
 #ifdef WHISPER_USE_FLASH_FF
@@ -1988,15 +2263,11 @@ static struct ggml_cgraph * whisper_build_graph_encoder(
                     ggml_cpy(ctx0, cur, ggml_new_tensor_2d(ctx0, wstate.itype, n_state, n_ctx)),
                     layer.mlp_0_w, layer.mlp_0_b, layer.mlp_1_w, layer.mlp_1_b);
 #else
-            // fully connected
-            cur = ggml_mul_mat(ctx0,
+            // fully connected + GELU activation
+            cur = ggml_mul_mat_add_gelu(ctx0,
                                layer.mlp_0_w,
-                               cur);
-
-            cur = ggml_add(ctx0, cur, layer.mlp_0_b);
-
-            // GELU activation
-            cur = ggml_gelu(ctx0, cur);
+                               cur,
+                               layer.mlp_0_b);
 
             // projection
             cur = ggml_mul_mat(ctx0,
@@ -2014,12 +2285,8 @@ static struct ggml_cgraph * whisper_build_graph_encoder(
 
     // norm
     {
-        cur = ggml_norm(ctx0, cur, hparams.eps);
-
-        // cur = ln_f_g*cur + ln_f_b
-        cur = ggml_add(ctx0,
-                       ggml_mul(ctx0, cur, model.e_ln_w),
-                       model.e_ln_b);
+        // cur = ln_f_g*norm(cur) + ln_f_b
+        cur = ggml_norm_mul_add(ctx0, cur, model.e_ln_w, model.e_ln_b, hparams.eps);
     }
 
     ggml_build_forward_expand(gf, cur);
@@ -2102,7 +2369,7 @@ static struct ggml_cgraph * whisper_build_graph_cross(
 
         struct ggml_tensor * k = ggml_view_1d(ctx0, wstate.kv_cross.k,
                                               n_state*n_ctx,
-                                              (ggml_element_size(wstate.kv_cross.k)*n_state)*(il*n_ctx));
+                                              whisper_row_size(wstate.kv_cross.k->type, n_state)*(il*n_ctx));
 
         struct ggml_tensor * v = ggml_view_2d(ctx0, wstate.kv_cross.v, n_ctx, n_state,
                                               (   n_ctx)*ggml_element_size(wstate.kv_cross.v),
@@ -2136,8 +2403,21 @@ static bool whisper_encode_internal(
         const int   n_threads,
         whisper_abort_callback   abort_callback,
         void * abort_callback_data) {
+    const latinime::NativeTrace::ScopedSection trace_section("whisper_encode");
     const int64_t t_start_us = ggml_time_us();
 
+    if (!kv_cache_reacquire(wctx.model.hparams, wstate.kv_cross, wctx.backend, wstate.mem_cur, wstate.mem_peak)) {
+        WHISPER_LOG_ERROR("%s: failed to allocate the cross-attention cache\n", __func__);
+        return false;
+    }
+
+    // the acquires are no-ops for the held buffers, but allocate the ones whisper_trim_memory released
+    const bool budget = wctx.params.mem_budget > 0;
+    if (budget) {
+        whisper_allocr_release(wstate, wstate.alloc_decode);
+    }
+    whisper_allocr_acquire(wstate, wstate.alloc_conv, wctx.backend);
+
     TIME_START(conv)
     // conv
     {
@@ -2158,6 +2438,8 @@ static bool whisper_encode_internal(
     TIME_START(encode)
     // encoder
     if (!whisper_encode_external(wstate)) {
+        whisper_allocr_acquire(wstate, wstate.alloc_encode, wctx.backend);
+
         auto & alloc = wstate.alloc_encode.alloc;
 
         ggml_allocr_reset(alloc);
@@ -2170,6 +2452,12 @@ static bool whisper_encode_internal(
     }
     TIME_END(encode)
 
+    if (budget) {
+        // the encoder has consumed embd_conv
+        whisper_allocr_release(wstate, wstate.alloc_conv);
+    }
+    whisper_allocr_acquire(wstate, wstate.alloc_cross, wctx.backend);
+
     TIME_START(cross)
     // cross
     {
@@ -2185,16 +2473,25 @@ static bool whisper_encode_internal(
     }
     TIME_END(cross)
 
+    if (budget) {
+        // everything the decoder needs is in the cross-attention KV cache now
+        whisper_allocr_release(wstate, wstate.alloc_conv);
+        whisper_allocr_release(wstate, wstate.alloc_encode);
+        whisper_allocr_release(wstate, wstate.alloc_cross);
+    }
+
     wstate.t_encode_us += ggml_time_us() - t_start_us;
     wstate.n_encode++;
 
     return !(abort_callback && abort_callback(abort_callback_data));
 }
 
+// n_vocab_logits > 0 computes the logits of the first n_vocab_logits tokens only
 static struct ggml_cgraph * whisper_build_graph_decoder(
         whisper_context & wctx,
         whisper_state   & wstate,
-        const whisper_batch & batch) {
+        const whisper_batch & batch,
+        int   n_vocab_logits = 0) {
     const auto & model   = wctx.model;
     const auto & hparams = model.hparams;
 
@@ -2290,14 +2587,12 @@ static struct ggml_cgraph * whisper_build_graph_decoder(
 
         // norm
         {
-            cur = ggml_norm(ctx0, inpL, hparams.eps);
-
-            // cur = ln_0_w*cur + ln_0_b
-            cur = ggml_add(ctx0,
-                           ggml_mul(ctx0,
-                                    cur,
-                                    layer.attn_ln_0_w),
-                           layer.attn_ln_0_b);
+            // cur = ln_0_w*norm(inpL) + ln_0_b
+            cur = ggml_norm_mul_add(ctx0,
+                                    inpL,
+                                    layer.attn_ln_0_w,
+                                    layer.attn_ln_0_b,
+                                    hparams.eps);
         }
 
         // self-attention
@@ -2331,7 +2626,7 @@ static struct ggml_cgraph * whisper_build_graph_decoder(
 
                 Vcur = ggml_transpose(ctx0, ggml_reshape_2d(ctx0, Vcur, n_state, n_tokens));
 
-                struct ggml_tensor * k = ggml_view_1d(ctx0, kv_self.k, n_tokens*n_state, (ggml_element_size(kv_self.k)*n_state)*(il*n_ctx + kv_head));
+                struct ggml_tensor * k = ggml_view_1d(ctx0, kv_self.k, n_tokens*n_state, whisper_row_size(kv_self.k->type, n_state)*(il*n_ctx + kv_head));
                 struct ggml_tensor * v = ggml_view_2d(ctx0, kv_self.v, n_tokens, n_state,
                                                       (   n_ctx)*ggml_element_size(kv_self.v),
                                                       (il*n_ctx)*ggml_element_size(kv_self.v)*n_state + kv_head*ggml_element_size(kv_self.v));
@@ -2350,9 +2645,9 @@ static struct ggml_cgraph * whisper_build_graph_decoder(
             struct ggml_tensor * K =
                     ggml_view_3d(ctx0, kv_self.k,
                                  n_state/n_head, n_kv, n_head,
-                                 ggml_element_size(kv_self.k)*n_state,
-                                 ggml_element_size(kv_self.k)*n_state/n_head,
-                                 ggml_element_size(kv_self.k)*n_state*n_ctx*il);
+                                 whisper_row_size(kv_self.k->type, n_state),
+                                 whisper_row_size(kv_self.k->type, n_state/n_head),
+                                 whisper_row_size(kv_self.k->type, n_state)*n_ctx*il);
 
             // K * Q
             struct ggml_tensor * KQ = ggml_mul_mat(ctx0, K, Q);
@@ -2396,14 +2691,12 @@ static struct ggml_cgraph * whisper_build_graph_decoder(
 
         // norm
         {
-            cur = ggml_norm(ctx0, inpCA, hparams.eps); // note: we use inpCA here
-
-            // cur = ln_0_w*cur + ln_0_b
-            cur = ggml_add(ctx0,
-                           ggml_mul(ctx0,
-                                    cur,
-                                    layer.cross_attn_ln_0_w),
-                           layer.cross_attn_ln_0_b);
+            // cur = ln_0_w*norm(inpCA) + ln_0_b
+            cur = ggml_norm_mul_add(ctx0,
+                                    inpCA, // note: we use inpCA here
+                                    layer.cross_attn_ln_0_w,
+                                    layer.cross_attn_ln_0_b,
+                                    hparams.eps);
         }
 
         // cross-attention
@@ -2422,9 +2715,9 @@ static struct ggml_cgraph * whisper_build_graph_decoder(
             struct ggml_tensor * Kcross =
                     ggml_view_3d(ctx0, wstate.kv_cross.k,
                                  n_state/n_head, n_audio_ctx, n_head,
-                                 ggml_element_size(wstate.kv_cross.k)*n_state,
-                                 ggml_element_size(wstate.kv_cross.k)*n_state/n_head,
-                                 ggml_element_size(wstate.kv_cross.k)*n_state*n_audio_ctx*il);
+                                 whisper_row_size(wstate.kv_cross.k->type, n_state),
+                                 whisper_row_size(wstate.kv_cross.k->type, n_state/n_head),
+                                 whisper_row_size(wstate.kv_cross.k->type, n_state)*n_audio_ctx*il);
 
             //struct ggml_tensor * Vcross =
             //    ggml_reshape_3d(ctx0,
@@ -2494,27 +2787,19 @@ static struct ggml_cgraph * whisper_build_graph_decoder(
         {
             // norm
             {
-                cur = ggml_norm(ctx0, inpFF, hparams.eps);
-
-                // cur = mlp_ln_w*cur + mlp_ln_b
-                cur = ggml_add(ctx0,
-                               ggml_mul(ctx0,
-                                        cur,
-                                        layer.mlp_ln_w),
-                               layer.mlp_ln_b);
+                // cur = mlp_ln_w*norm(inpFF) + mlp_ln_b
+                cur = ggml_norm_mul_add(ctx0,
+                                        inpFF,
+                                        layer.mlp_ln_w,
+                                        layer.mlp_ln_b,
+                                        hparams.eps);
             }
 
-            // fully connected
-            cur = ggml_mul_mat(ctx0,
-                               layer.mlp_0_w,
-                               cur);
-
-            cur = ggml_add(ctx0,
-                           cur,
-                           layer.mlp_0_b);
-
-            // GELU activation
-            cur = ggml_gelu(ctx0, cur);
+            // fully connected + GELU activation
+            cur = ggml_mul_mat_add_gelu(ctx0,
+                                        layer.mlp_0_w,
+                                        cur,
+                                        layer.mlp_0_b);
 
             // projection
             cur = ggml_mul_mat(ctx0,
@@ -2533,21 +2818,42 @@ static struct ggml_cgraph * whisper_build_graph_decoder(
 
     // norm
     {
-        cur = ggml_norm(ctx0, cur, hparams.eps);
-
-        cur = ggml_add(ctx0,
-                       ggml_mul(ctx0,
+        cur = ggml_norm_mul_add(ctx0,
                                 cur,
-                                model.d_ln_w),
-                       model.d_ln_b);
+                                model.d_ln_w,
+                                model.d_ln_b,
+                                hparams.eps);
+    }
+
+    // compute logits only for the tokens flagged in batch.logits, e.g. the last one of a prompt
+    // the measure graph projects all of them, which is the worst case
+    if (!ggml_allocr_is_measure(alloc)) {
+        std::vector<int32_t> out_ids;
+        for (int i = 0; i < n_tokens; ++i) {
+            if (batch.logits[i]) {
+                out_ids.push_back(i);
+            }
+        }
+        if (out_ids.empty()) {
+            out_ids.push_back(n_tokens - 1);
+        }
+
+        if ((int) out_ids.size() < n_tokens) {
+            struct ggml_tensor * inp_out_ids = ggml_new_tensor_1d(ctx0, GGML_TYPE_I32, out_ids.size());
+            ggml_allocr_alloc(alloc, inp_out_ids);
+            ggml_backend_tensor_set(inp_out_ids, out_ids.data(), 0, ggml_nbytes(inp_out_ids));
+
+            cur = ggml_get_rows(ctx0, cur, inp_out_ids);
+        }
     }
 
-    // compute logits only for the last token
-    // comment this line to compute logits for all n_tokens
-    // might be useful in the future
-    //cur = ggml_view_2d(ctx0, cur, cur->ne[0], 1, cur->nb[1], (cur->ne[1] - 1)*cur->nb[1]);
+    // the token embeddings of a vocab prefix are the first rows, a view needs no copy
+    struct ggml_tensor * d_te = model.d_te;
+    if (n_vocab_logits > 0) {
+        d_te = ggml_view_2d(ctx0, model.d_te, model.d_te->ne[0], n_vocab_logits, model.d_te->nb[1], 0);
+    }
 
-    struct ggml_tensor * logits = ggml_mul_mat(ctx0, model.d_te, cur);
+    struct ggml_tensor * logits = ggml_mul_mat(ctx0, d_te, cur);
 
     ggml_build_forward_expand(gf, logits);
 
@@ -2565,17 +2871,20 @@ static struct ggml_cgraph * whisper_build_graph_decoder(
 //   - tokens:     text prompt
 //   - n_tokens:   number of tokens in the prompt
 //   - n_past:     number of past tokens to prefix the prompt with
+//   - n_vocab_logits: compute the logits of the first n_vocab_logits tokens only, the others are
+//                     set to -INFINITY (0 = all tokens)
+//
+// the logits are computed for the tokens flagged in batch.logits only
 //
 static bool whisper_decode_internal(
         whisper_context & wctx,
         whisper_state & wstate,
         const whisper_batch & batch,
-        const int   _n_threads,
+        const int   n_threads,
         whisper_abort_callback   abort_callback,
-        void * abort_callback_data) {
-
-    const int n_threads = 2; // TODO: Higher n_threads appears to significantly hurt performance for some reason
-
+        void * abort_callback_data,
+        int   n_vocab_logits = 0) {
+    const latinime::NativeTrace::ScopedSection trace_section("whisper_decode");
     const int64_t t_start_us = ggml_time_us();
 
     const auto & model   = wctx.model;
@@ -2588,6 +2897,16 @@ static bool whisper_decode_internal(
 
     struct ggml_tensor * logits;
 
+    if (!wstate.kv_cross.ctx) {
+        WHISPER_LOG_ERROR("%s: the cross-attention cache has been released, the audio has to be encoded again\n", __func__);
+        return false;
+    }
+
+    if (!kv_cache_reacquire(hparams, wstate.kv_self, wctx.backend, wstate.mem_cur, wstate.mem_peak)) {
+        WHISPER_LOG_ERROR("%s: failed to allocate the self-attention cache\n", __func__);
+        return false;
+    }
+
     // find KV slot for the batch
     {
         auto & kv_self = wstate.kv_self;
@@ -2603,11 +2922,13 @@ static bool whisper_decode_internal(
 
     // decoder
     {
+        whisper_allocr_acquire(wstate, wstate.alloc_decode, wctx.backend);
+
         auto & alloc = wstate.alloc_decode.alloc;
 
         ggml_allocr_reset(alloc);
 
-        ggml_cgraph * gf = whisper_build_graph_decoder(wctx, wstate, batch);
+        ggml_cgraph * gf = whisper_build_graph_decoder(wctx, wstate, batch, n_vocab_logits);
 
         ggml_allocr_alloc_graph(alloc, gf);
 
@@ -2616,12 +2937,19 @@ static bool whisper_decode_internal(
         ggml_graph_compute_helper(wstate.backend, gf, n_threads);
     }
 
+    const int n_logits = n_vocab_logits > 0 ? n_vocab_logits : n_vocab;
+
+    // the rows of the logits are the flagged tokens only, in batch order, unless all of them are
+    const bool all_outputs = logits->ne[1] == n_tokens;
+
     logits_out.resize(n_tokens*n_vocab);
-    for (int i = 0; i < n_tokens; i++) {
+    for (int i = 0, i_out = 0; i < n_tokens; i++) {
         if (batch.logits[i] == 0) {
             continue;
         }
-        ggml_backend_tensor_get(logits, logits_out.data() + (n_vocab*i), sizeof(float)*(n_vocab*i), sizeof(float)*n_vocab);
+        const int row = all_outputs ? i : i_out++;
+        ggml_backend_tensor_get(logits, logits_out.data() + (n_vocab*i), sizeof(float)*(n_logits*row), sizeof(float)*n_logits);
+        std::fill(logits_out.begin() + n_vocab*i + n_logits, logits_out.begin() + n_vocab*(i + 1), -INFINITY);
     }
 
     if (batch.n_tokens > 1) {
@@ -2664,103 +2992,228 @@ static std::string to_timestamp(int64_t t, bool comma = false) {
     return std::string(buf);
 }
 
-#define SIN_COS_N_COUNT WHISPER_N_FFT
-static float sin_vals[SIN_COS_N_COUNT];
-static float cos_vals[SIN_COS_N_COUNT];
-
-// In FFT, we frequently use sine and cosine operations with the same values.
-// We can use precalculated values to speed up the process.
-static void fill_sin_cos_table() {
-    static bool is_filled = false;
-    if (is_filled) return;
-    for (int i = 0; i < SIN_COS_N_COUNT; i++) {
-        double theta = (2*M_PI*i)/SIN_COS_N_COUNT;
-        sin_vals[i] = sinf(theta);
-        cos_vals[i] = cosf(theta);
-    }
-    is_filled = true;
-}
-
-// naive Discrete Fourier Transform
-// input is real-valued
-// output is complex-valued
-static void dft(const std::vector<float> & in, std::vector<float> & out) {
-    int N = in.size();
+// Real FFT of one frame size, computed as a complex FFT of half the size. The complex FFT is an
+// iterative mixed-radix Stockham FFT, so the 400 and 800 sample frames, which are not powers of
+// two, need neither recursion nor a bit-reversal pass. The data is kept as separate real and
+// imaginary arrays, and every stage loops over contiguous elements, so that the compiler can
+// vectorize the butterflies.
+struct whisper_fft_plan {
+    int n = 0; // real input size
 
-    out.resize(N*2);
-    const int sin_cos_step = SIN_COS_N_COUNT / N;
+    std::vector<int> radices; // factors of n/2, in the order of the stages
 
-    for (int k = 0; k < N; k++) {
-        float re = 0;
-        float im = 0;
+    // e^(-2*pi*i*k*q/(ns*p)) of each stage, indexed by [(q - 1)*ns + k], stages concatenated
+    std::vector<float> tw_re;
+    std::vector<float> tw_im;
 
-        for (int n = 0; n < N; n++) {
-            int idx = (k * n * sin_cos_step) % (SIN_COS_N_COUNT); // t = 2*M_PI*k*n/N
-            re += in[n]*cos_vals[idx]; // cos(t)
-            im -= in[n]*sin_vals[idx]; // sin(t)
-        }
+    // e^(-2*pi*i*t/p) for the radices other than 2 and 4, indexed by [t], concatenated
+    std::vector<float> root_re;
+    std::vector<float> root_im;
 
-        out[k*2 + 0] = re;
-        out[k*2 + 1] = im;
-    }
-}
+    // e^(-2*pi*i*k/n) for k <= n/2, to split the half size FFT into the real FFT
+    std::vector<float> split_re;
+    std::vector<float> split_im;
 
-// Cooley-Tukey FFT
-// poor man's implementation - use something better
-// input is real-valued
-// output is complex-valued
-static void fft(const std::vector<float> & in, std::vector<float> & out) {
-    out.resize(in.size()*2);
+    int max_radix = 0;
+};
 
-    int N = in.size();
+// Buffers of one thread, so that a frame is transformed without allocating.
+struct whisper_fft_scratch {
+    std::vector<float> x_re;
+    std::vector<float> x_im;
+    std::vector<float> y_re;
+    std::vector<float> y_im;
+    std::vector<float> v_re;
+    std::vector<float> v_im;
+
+    explicit whisper_fft_scratch(const whisper_fft_plan & plan)
+        : x_re(plan.n/2), x_im(plan.n/2), y_re(plan.n/2), y_im(plan.n/2),
+          v_re(plan.max_radix), v_im(plan.max_radix) {}
+};
 
-    if (N == 1) {
-        out[0] = in[0];
-        out[1] = 0;
-        return;
+static void whisper_fft_plan_init(whisper_fft_plan & plan, int n) {
+    WHISPER_ASSERT(n >= 2 && n % 2 == 0);
+
+    const int m = n/2;
+
+    plan.n = n;
+    plan.radices.clear();
+    int rest = m;
+    while (rest % 4 == 0) {
+        plan.radices.push_back(4);
+        rest /= 4;
+    }
+    if (rest % 2 == 0) {
+        plan.radices.push_back(2);
+        rest /= 2;
+    }
+    for (int p = 3; rest > 1; p += 2) {
+        while (rest % p == 0) {
+            plan.radices.push_back(p);
+            rest /= p;
+        }
+    }
+
+    plan.tw_re.clear();
+    plan.tw_im.clear();
+    plan.root_re.clear();
+    plan.root_im.clear();
+    plan.max_radix = 4;
+    int ns = 1;
+    for (const int p : plan.radices) {
+        for (int q = 1; q < p; q++) {
+            for (int k = 0; k < ns; k++) {
+                const double theta = -2*M_PI*k*q/(ns*p);
+                plan.tw_re.push_back(cos(theta));
+                plan.tw_im.push_back(sin(theta));
+            }
+        }
+        if (p != 2 && p != 4) {
+            for (int t = 0; t < p; t++) {
+                const double theta = -2*M_PI*t/p;
+                plan.root_re.push_back(cos(theta));
+                plan.root_im.push_back(sin(theta));
+            }
+        }
+        plan.max_radix = std::max(plan.max_radix, p);
+        ns *= p;
+    }
+
+    plan.split_re.resize(m + 1);
+    plan.split_im.resize(m + 1);
+    for (int k = 0; k <= m; k++) {
+        const double theta = -2*M_PI*k/n;
+        plan.split_re[k] = cos(theta);
+        plan.split_im[k] = sin(theta);
+    }
+}
+
+// input is real-valued, plan.n samples
+// output is complex-valued, the plan.n/2 + 1 bins from 0 to nyquist, interleaved
+static void whisper_fft(const whisper_fft_plan & plan, const float * in, whisper_fft_scratch & scratch, float * out) {
+    const int m = plan.n/2;
+
+    float * x_re = scratch.x_re.data();
+    float * x_im = scratch.x_im.data();
+    float * y_re = scratch.y_re.data();
+    float * y_im = scratch.y_im.data();
+
+    // the even samples are the real parts, the odd samples the imaginary parts
+    for (int i = 0; i < m; i++) {
+        x_re[i] = in[2*i + 0];
+        x_im[i] = in[2*i + 1];
+    }
+
+    const float * tw_re = plan.tw_re.data();
+    const float * tw_im = plan.tw_im.data();
+    const float * root_re = plan.root_re.data();
+    const float * root_im = plan.root_im.data();
+    int ns = 1;
+    for (const int p : plan.radices) {
+        const int stride = m/p;
+        for (int j0 = 0; j0 < stride; j0 += ns) {
+            const float * a_re = x_re + j0;
+            const float * a_im = x_im + j0;
+            float * b_re = y_re + j0*p;
+            float * b_im = y_im + j0*p;
+            if (p == 2) {
+                for (int k = 0; k < ns; k++) {
+                    const float a1_re = a_re[k + stride]*tw_re[k] - a_im[k + stride]*tw_im[k];
+                    const float a1_im = a_re[k + stride]*tw_im[k] + a_im[k + stride]*tw_re[k];
+                    b_re[k]      = a_re[k] + a1_re;
+                    b_im[k]      = a_im[k] + a1_im;
+                    b_re[k + ns] = a_re[k] - a1_re;
+                    b_im[k + ns] = a_im[k] - a1_im;
+                }
+            } else if (p == 4) {
+                const float * tw1_re = tw_re;
+                const float * tw1_im = tw_im;
+                const float * tw2_re = tw_re + ns;
+                const float * tw2_im = tw_im + ns;
+                const float * tw3_re = tw_re + 2*ns;
+                const float * tw3_im = tw_im + 2*ns;
+                for (int k = 0; k < ns; k++) {
+                    const float a0_re = a_re[k];
+                    const float a0_im = a_im[k];
+                    const float a1_re = a_re[k + stride]*tw1_re[k] - a_im[k + stride]*tw1_im[k];
+                    const float a1_im = a_re[k + stride]*tw1_im[k] + a_im[k + stride]*tw1_re[k];
+                    const float a2_re = a_re[k + 2*stride]*tw2_re[k] - a_im[k + 2*stride]*tw2_im[k];
+                    const float a2_im = a_re[k + 2*stride]*tw2_im[k] + a_im[k + 2*stride]*tw2_re[k];
+                    const float a3_re = a_re[k + 3*stride]*tw3_re[k] - a_im[k + 3*stride]*tw3_im[k];
+                    const float a3_im = a_re[k + 3*stride]*tw3_im[k] + a_im[k + 3*stride]*tw3_re[k];
+
+                    const float t0_re = a0_re + a2_re;
+                    const float t0_im = a0_im + a2_im;
+                    const float t1_re = a0_re - a2_re;
+                    const float t1_im = a0_im - a2_im;
+                    const float t2_re = a1_re + a3_re;
+                    const float t2_im = a1_im + a3_im;
+                    const float t3_re = a1_re - a3_re;
+                    const float t3_im = a1_im - a3_im;
+
+                    b_re[k]        = t0_re + t2_re;
+                    b_im[k]        = t0_im + t2_im;
+                    b_re[k + ns]   = t1_re + t3_im; // t1 - i*t3
+                    b_im[k + ns]   = t1_im - t3_re;
+                    b_re[k + 2*ns] = t0_re - t2_re;
+                    b_im[k + 2*ns] = t0_im - t2_im;
+                    b_re[k + 3*ns] = t1_re - t3_im; // t1 + i*t3
+                    b_im[k + 3*ns] = t1_im + t3_re;
+                }
+            } else {
+                float * v_re = scratch.v_re.data();
+                float * v_im = scratch.v_im.data();
+                for (int k = 0; k < ns; k++) {
+                    v_re[0] = a_re[k];
+                    v_im[0] = a_im[k];
+                    for (int q = 1; q < p; q++) {
+                        const float w_re = tw_re[(q - 1)*ns + k];
+                        const float w_im = tw_im[(q - 1)*ns + k];
+                        v_re[q] = a_re[k + q*stride]*w_re - a_im[k + q*stride]*w_im;
+                        v_im[q] = a_re[k + q*stride]*w_im + a_im[k + q*stride]*w_re;
+                    }
+                    for (int r = 0; r < p; r++) {
+                        float sum_re = 0;
+                        float sum_im = 0;
+                        int t = 0; // q*r mod p
+                        for (int q = 0; q < p; q++) {
+                            sum_re += v_re[q]*root_re[t] - v_im[q]*root_im[t];
+                            sum_im += v_re[q]*root_im[t] + v_im[q]*root_re[t];
+                            t += r;
+                            if (t >= p) {
+                                t -= p;
+                            }
+                        }
+                        b_re[k + r*ns] = sum_re;
+                        b_im[k + r*ns] = sum_im;
+                    }
+                }
+            }
+        }
+        tw_re += (p - 1)*ns;
+        tw_im += (p - 1)*ns;
+        if (p != 2 && p != 4) {
+            root_re += p;
+            root_im += p;
+        }
+        ns *= p;
+        std::swap(x_re, y_re);
+        std::swap(x_im, y_im);
     }
 
-    if (N%2 == 1) {
-        dft(in, out);
-        return;
+    // X[k] = E[k] + e^(-2*pi*i*k/n)*O[k], where E and O are the FFTs of the even and odd samples:
+    // E[k] = (Z[k] + conj(Z[m - k]))/2 and O[k] = -i*(Z[k] - conj(Z[m - k]))/2
+    for (int k = 0; k <= m; k++) {
+        const int k0 = k == m ? 0 : k;
+        const int k1 = k == 0 ? 0 : m - k;
+        const float e_re = 0.5f*(x_re[k0] + x_re[k1]);
+        const float e_im = 0.5f*(x_im[k0] - x_im[k1]);
+        const float o_re = 0.5f*(x_im[k0] + x_im[k1]);
+        const float o_im = -0.5f*(x_re[k0] - x_re[k1]);
+        out[2*k + 0] = e_re + plan.split_re[k]*o_re - plan.split_im[k]*o_im;
+        out[2*k + 1] = e_im + plan.split_re[k]*o_im + plan.split_im[k]*o_re;
     }
-
-    std::vector<float> even;
-    std::vector<float> odd;
-
-    even.reserve(N/2);
-    odd.reserve(N/2);
-
-    for (int i = 0; i < N; i++) {
-        if (i % 2 == 0) {
-            even.push_back(in[i]);
-        } else {
-            odd.push_back(in[i]);
-        }
-    }
-
-    std::vector<float> even_fft;
-    std::vector<float> odd_fft;
-
-    fft(even, even_fft);
-    fft(odd, odd_fft);
-
-    const int sin_cos_step = SIN_COS_N_COUNT / N;
-    for (int k = 0; k < N/2; k++) {
-        int idx = k * sin_cos_step; // t = 2*M_PI*k/N
-        float re = cos_vals[idx]; // cos(t)
-        float im = -sin_vals[idx]; // sin(t)
-
-        float re_odd = odd_fft[2*k + 0];
-        float im_odd = odd_fft[2*k + 1];
-
-        out[2*k + 0] = even_fft[2*k + 0] + re*re_odd - im*im_odd;
-        out[2*k + 1] = even_fft[2*k + 1] + re*im_odd + im*re_odd;
-
-        out[2*(k + N/2) + 0] = even_fft[2*k + 0] - re*re_odd + im*im_odd;
-        out[2*(k + N/2) + 1] = even_fft[2*k + 1] - re*im_odd - im*re_odd;
-    }
-}
+}
 
 static bool hann_window(int length, bool periodic, std::vector<float> & output) {
     if (output.size() < static_cast<size_t>(length)) {
@@ -2777,13 +3230,60 @@ static bool hann_window(int length, bool periodic, std::vector<float> & output)
     return true;
 }
 
+// the log mel bands of one windowed frame, log10(max(power, power_floor)) of band j stored at out[j*stride]
+static void log_mel_spectrogram_frame(const float * fft_in, const whisper_fft_plan & fft_plan,
+                                      whisper_fft_scratch & fft_scratch, std::vector<float> & fft_out,
+                                      const whisper_filters & filters, int n_mel, double power_floor,
+                                      float * out, int stride) {
+    // make sure n_fft == 1 + (WHISPER_N_FFT / 2), bin_0 to bin_nyquist
+    const int n_fft = 1 + (fft_plan.n / 2);
+
+    // FFT
+    whisper_fft(fft_plan, fft_in, fft_scratch, fft_out.data());
+
+    // Calculate modulus^2 of complex numbers
+    // Use pow(fft_out[2 * j + 0], 2) + pow(fft_out[2 * j + 1], 2) causes inference quality problem? Interesting.
+    for (int j = 0; j < n_fft; j++) {
+        fft_out[j] = (fft_out[2 * j + 0] * fft_out[2 * j + 0] + fft_out[2 * j + 1] * fft_out[2 * j + 1]);
+    }
+
+    // mel spectrogram, over the bins where the filter is not zero
+    for (int j = 0; j < n_mel; j++) {
+        double sum = 0.0;
+
+        const float * row = filters.data.data() + j * filters.n_fft;
+        const int k_end = std::min(filters.span_end[j], n_fft);
+
+        // unroll loop (suggested by GH user @lunixbochs)
+        int k = filters.span_begin[j];
+        for (; k < k_end - 3; k += 4) {
+            sum +=
+                    fft_out[k + 0] * row[k + 0] +
+                    fft_out[k + 1] * row[k + 1] +
+                    fft_out[k + 2] * row[k + 2] +
+                    fft_out[k + 3] * row[k + 3];
+        }
+
+        // handle span remainder
+        for (; k < k_end; k++) {
+            sum += fft_out[k] * row[k];
+        }
+
+        sum = log10(std::max(sum, power_floor));
+
+        out[j * stride] = sum;
+    }
+}
+
 static void log_mel_spectrogram_worker_thread(int ith, const std::vector<float> & hann, const std::vector<float> & samples,
                                               int n_samples, int frame_size, int frame_step, int n_threads,
+                                              const whisper_fft_plan & fft_plan,
                                               const whisper_filters & filters, whisper_mel & mel) {
-    std::vector<float> fft_in(frame_size, 0.0);
-    std::vector<float> fft_out(2 * frame_step);
     // make sure n_fft == 1 + (WHISPER_N_FFT / 2), bin_0 to bin_nyquist
     int n_fft = 1 + (frame_size / 2);
+    std::vector<float> fft_in(frame_size, 0.0);
+    std::vector<float> fft_out(2 * n_fft);
+    whisper_fft_scratch fft_scratch(fft_plan);
     int i = ith;
 
     // calculate FFT only when fft_in are not all zero
@@ -2799,38 +3299,8 @@ static void log_mel_spectrogram_worker_thread(int ith, const std::vector<float>
             std::fill(fft_in.begin() + (n_samples - offset), fft_in.end(), 0.0);
         }
 
-        // FFT
-        fft(fft_in, fft_out);
-
-        // Calculate modulus^2 of complex numbers
-        // Use pow(fft_out[2 * j + 0], 2) + pow(fft_out[2 * j + 1], 2) causes inference quality problem? Interesting.
-        for (int j = 0; j < frame_size; j++) {
-            fft_out[j] = (fft_out[2 * j + 0] * fft_out[2 * j + 0] + fft_out[2 * j + 1] * fft_out[2 * j + 1]);
-        }
-
-        // mel spectrogram
-        for (int j = 0; j < mel.n_mel; j++) {
-            double sum = 0.0;
-
-            // unroll loop (suggested by GH user @lunixbochs)
-            int k = 0;
-            for (k = 0; k < n_fft - 3; k += 4) {
-                sum +=
-                        fft_out[k + 0] * filters.data[j * n_fft + k + 0] +
-                        fft_out[k + 1] * filters.data[j * n_fft + k + 1] +
-                        fft_out[k + 2] * filters.data[j * n_fft + k + 2] +
-                        fft_out[k + 3] * filters.data[j * n_fft + k + 3];
-            }
-
-            // handle n_fft remainder
-            for (; k < n_fft; k++) {
-                sum += fft_out[k] * filters.data[j * n_fft + k];
-            }
-
-            sum = log10(std::max(sum, 1e-10));
-
-            mel.data[j * mel.n_len + i] = sum;
-        }
+        log_mel_spectrogram_frame(fft_in.data(), fft_plan, fft_scratch, fft_out, filters, mel.n_mel, 1e-10,
+                                  mel.data.data() + i, mel.n_len);
     }
 
     // Otherwise fft_out are all zero
@@ -2855,6 +3325,7 @@ static bool log_mel_spectrogram(
         const whisper_filters & filters,
         const bool   debug,
         whisper_mel & mel) {
+    const latinime::NativeTrace::ScopedSection trace_section("whisper_mel");
     const int64_t t_start_us = ggml_time_us();
 
     // Hanning window (Use cosf to eliminate difference)
@@ -2889,16 +3360,19 @@ static bool log_mel_spectrogram(
 
 
     {
+        whisper_fft_plan fft_plan;
+        whisper_fft_plan_init(fft_plan, frame_size);
+
         std::vector<std::thread> workers(n_threads - 1);
         for (int iw = 0; iw < n_threads - 1; ++iw) {
             workers[iw] = std::thread(
-                    log_mel_spectrogram_worker_thread, iw + 1, std::cref(hann), samples_padded,
+                    log_mel_spectrogram_worker_thread, iw + 1, std::cref(hann), std::cref(samples_padded),
                     n_samples + stage_2_pad, frame_size, frame_step, n_threads,
-                    std::cref(filters), std::ref(mel));
+                    std::cref(fft_plan), std::cref(filters), std::ref(mel));
         }
 
         // main thread
-        log_mel_spectrogram_worker_thread(0, hann, samples_padded, n_samples + stage_2_pad, frame_size, frame_step, n_threads, filters, mel);
+        log_mel_spectrogram_worker_thread(0, hann, samples_padded, n_samples + stage_2_pad, frame_size, frame_step, n_threads, fft_plan, filters, mel);
 
         for (int iw = 0; iw < n_threads - 1; ++iw) {
             workers[iw].join();
@@ -3051,9 +3525,50 @@ static std::string whisper_openvino_get_path_cache(std::string path_bin) {
 }
 #endif
 
-struct whisper_state * whisper_init_state(whisper_context * ctx) {
-    fill_sin_cos_table();
+// compute buffer memory a state holds at most: all buffers at once, or, with a memory budget, only those
+// of the stages that overlap (conv and encoder, encoder and cross, decoder)
+static size_t whisper_state_mem_compute(whisper_state & state, bool budget) {
+    const size_t conv   = state.alloc_conv.size;
+    const size_t encode = state.alloc_encode.size;
+    const size_t cross  = state.alloc_cross.size;
+    const size_t decode = state.alloc_decode.size;
+
+    if (!budget) {
+        return conv + encode + cross + decode;
+    }
+
+    return std::max(std::max(conv + encode, encode + cross), decode);
+}
+
+// memory a state holds all the time: KV caches and graph metadata
+static size_t whisper_state_mem_static(whisper_state & state) {
+    size_t size = 0;
+
+    size += kv_cache_nbytes(state.kv_self);
+    size += kv_cache_nbytes(state.kv_cross);
+
+    size += state.alloc_conv.meta.size() + state.alloc_encode.meta.size() + state.alloc_cross.meta.size() + state.alloc_decode.meta.size();
+
+    return size;
+}
+
+// turns the measure allocator of allocr into a real one; the data buffer is allocated right away if hold
+// is set, or by whisper_allocr_acquire when the graph is first used
+static void whisper_allocr_graph_realloc(whisper_state & wstate, whisper_allocr & allocr, ggml_backend_t backend, bool hold) {
+    if (allocr.alloc == nullptr) {
+        // this can be null if we use external encoder like CoreML or OpenVINO
+        return;
+    }
+
+    ggml_allocr_free(allocr.alloc);
+    allocr.alloc = nullptr;
+
+    if (hold) {
+        whisper_allocr_acquire(wstate, allocr, backend);
+    }
+}
 
+struct whisper_state * whisper_init_state(whisper_context * ctx) {
     whisper_state * state = new whisper_state;
 
     state->backend = whisper_backend_init(ctx->params);
@@ -3062,7 +3577,22 @@ struct whisper_state * whisper_init_state(whisper_context * ctx) {
     // in theory, there can be a case where this is not enough, but in practice it should always be enough
     const int factor = 3;
 
-    if (!kv_cache_init(ctx->model.hparams, state->kv_self, ctx->backend, ctx->itype, factor*ctx->model.hparams.n_text_ctx)) {
+    // the key caches are only used as the first operand of a matrix multiplication, so they can be
+    // quantized on the CPU as long as a head is a whole number of blocks. The value caches are stored
+    // transposed, with rows as long as the context, and stay in the intermediate type.
+    ggml_type ktype = ctx->params.type_k;
+    if (ktype != GGML_TYPE_F16 && ktype != GGML_TYPE_F32 && ktype != GGML_TYPE_Q8_0 && ktype != GGML_TYPE_Q4_0) {
+        WHISPER_LOG_WARN("%s: unsupported key cache type %s, using %s\n", __func__, ggml_type_name(ktype), ggml_type_name(ctx->itype));
+        ktype = ctx->itype;
+    } else if (ggml_is_quantized(ktype) && (!ggml_backend_is_cpu(ctx->backend) ||
+            (ctx->model.hparams.n_text_state/ctx->model.hparams.n_text_head) % ggml_blck_size(ktype) != 0)) {
+        WHISPER_LOG_WARN("%s: key cache type %s is not usable with this model or backend, using %s\n", __func__, ggml_type_name(ktype), ggml_type_name(ctx->itype));
+        ktype = ctx->itype;
+    }
+
+    state->n_text_ctx = ctx->model.hparams.n_text_ctx;
+
+    if (!kv_cache_init(ctx->model.hparams, state->kv_self, ctx->backend, ktype, ctx->itype, factor*state->n_text_ctx)) {
         WHISPER_LOG_ERROR("%s: kv_cache_init() failed for self-attention cache\n", __func__);
         delete state;
         return nullptr;
@@ -3073,7 +3603,7 @@ struct whisper_state * whisper_init_state(whisper_context * ctx) {
         WHISPER_LOG_INFO("%s: kv self size  = %7.2f MB\n", __func__, memory_size / 1e6);
     }
 
-    if (!kv_cache_init(ctx->model.hparams, state->kv_cross, ctx->backend, ctx->itype, ctx->model.hparams.n_audio_ctx)) {
+    if (!kv_cache_init(ctx->model.hparams, state->kv_cross, ctx->backend, ktype, ctx->itype, ctx->model.hparams.n_audio_ctx)) {
         WHISPER_LOG_ERROR("%s: kv_cache_init() failed for cross-attention cache\n", __func__);
         delete state;
         return nullptr;
@@ -3102,13 +3632,9 @@ struct whisper_state * whisper_init_state(whisper_context * ctx) {
     }
 #endif
 
-    state->logits.reserve(ctx->vocab.n_vocab * ctx->model.hparams.n_text_ctx);
-
     state->batch = whisper_batch_init(ctx->model.hparams.n_text_ctx, WHISPER_MAX_DECODERS);
 
     // TAGS: WHISPER_DECODER_INIT
-    state->decoders[0].sequence.tokens.reserve(ctx->model.hparams.n_text_ctx);
-
     state->decoders[0].probs.reserve    (ctx->vocab.n_vocab);
     state->decoders[0].logits.reserve   (ctx->vocab.n_vocab);
     state->decoders[0].logprobs.reserve (ctx->vocab.n_vocab);
@@ -3147,27 +3673,63 @@ struct whisper_state * whisper_init_state(whisper_context * ctx) {
     }
 
     // decoder allocator
-    {
+    const auto measure_decode = [&]() {
         whisper_allocr_graph_init(state->alloc_decode, ctx->backend,
                                   [&]() {
-                                      const auto & hparams = ctx->model.hparams;
-
                                       // TODO: make sure this is the worst-case scenario
-                                      const int n_tokens = hparams.n_text_ctx;
+                                      const int n_tokens = state->n_text_ctx;
                                       const int n_past   = 0;
 
                                       whisper_batch_prep_legacy(state->batch, nullptr, n_tokens, n_past, 0);
 
                                       return whisper_build_graph_decoder(*ctx, *state, state->batch);
                                   });
+    };
+
+    measure_decode();
+
+    WHISPER_LOG_INFO("%s: compute buffer (decode) = %7.2f MB\n", __func__, whisper_allocr_size(state->alloc_decode) / 1e6);
+
+    const size_t budget = ctx->params.mem_budget;
+
+    if (budget > 0) {
+        // shorter self-attention contexts shrink both the KV cache and the decoder graph, but a window
+        // still has to hold a prompt and the text of a few seconds of speech
+        while (whisper_state_mem_static(*state) + whisper_state_mem_compute(*state, true) > budget && state->n_text_ctx/2 >= WHISPER_MIN_TEXT_CTX) {
+            state->n_text_ctx /= 2;
 
-        WHISPER_LOG_INFO("%s: compute buffer (decode) = %7.2f MB\n", __func__, whisper_allocr_size(state->alloc_decode) / 1e6);
+            kv_cache_free(state->kv_self);
+            if (!kv_cache_init(ctx->model.hparams, state->kv_self, ctx->backend, ktype, ctx->itype, factor*state->n_text_ctx)) {
+                WHISPER_LOG_ERROR("%s: kv_cache_init() failed for self-attention cache\n", __func__);
+                whisper_free_state(state);
+                return nullptr;
+            }
+
+            measure_decode();
+        }
+
+        const size_t mem_max = whisper_state_mem_static(*state) + whisper_state_mem_compute(*state, true);
+
+        WHISPER_LOG_INFO("%s: memory budget = %7.2f MB, n_text_ctx = %d, kv self size = %7.2f MB, compute buffer (decode) = %7.2f MB\n", __func__,
+                budget / 1e6, state->n_text_ctx, (ggml_nbytes(state->kv_self.k) + ggml_nbytes(state->kv_self.v)) / 1e6,
+                whisper_allocr_size(state->alloc_decode) / 1e6);
+
+        if (mem_max > budget) {
+            WHISPER_LOG_WARN("%s: the state needs up to %7.2f MB, more than the memory budget\n", __func__, mem_max / 1e6);
+        }
     }
 
-    whisper_allocr_graph_realloc(state->alloc_conv,   ctx->backend);
-    whisper_allocr_graph_realloc(state->alloc_encode, ctx->backend);
-    whisper_allocr_graph_realloc(state->alloc_cross,  ctx->backend);
-    whisper_allocr_graph_realloc(state->alloc_decode, ctx->backend);
+    state->logits.reserve(ctx->vocab.n_vocab * state->n_text_ctx);
+    state->decoders[0].sequence.tokens.reserve(state->n_text_ctx);
+
+    state->mem_cur = whisper_state_mem_static(*state);
+    state->mem_peak = state->mem_cur;
+
+    // with a budget, the compute buffers are allocated when their graphs are first used
+    whisper_allocr_graph_realloc(*state, state->alloc_conv,   ctx->backend, budget == 0);
+    whisper_allocr_graph_realloc(*state, state->alloc_encode, ctx->backend, budget == 0);
+    whisper_allocr_graph_realloc(*state, state->alloc_cross,  ctx->backend, budget == 0);
+    whisper_allocr_graph_realloc(*state, state->alloc_decode, ctx->backend, budget == 0);
 
     return state;
 }
@@ -3223,14 +3785,118 @@ int whisper_ctx_init_openvino_encoder(
 
 struct whisper_context_params whisper_context_default_params() {
     struct whisper_context_params result = {
-            /*.use_gpu    =*/ true,
+            /*.use_gpu       =*/ true,
+            /*.use_mmap      =*/ false,
+            /*.type_k        =*/ GGML_TYPE_F16,
+            /*.flash_attn    =*/ true,
+            /*.mem_budget    =*/ 0,
+            /*.encoder_wtype =*/ GGML_TYPE_COUNT,
     };
     return result;
 }
 
+// loads the model from memory, using the weights in place if map is set
+static struct whisper_context * whisper_init_from_memory_no_state(const void * buffer, size_t buffer_size, bool map, struct whisper_context_params params) {
+    struct buf_context {
+        const uint8_t* buffer;
+        size_t size;
+        size_t current_offset;
+    };
+
+    buf_context ctx = { reinterpret_cast<const uint8_t*>(buffer), buffer_size, 0 };
+
+    whisper_model_loader loader = {};
+
+    loader.context = &ctx;
+
+    loader.read = [](void * ctx, void * output, size_t read_size) {
+        buf_context * buf = reinterpret_cast<buf_context *>(ctx);
+
+        size_t size_to_copy = buf->current_offset + read_size < buf->size ? read_size : buf->size - buf->current_offset;
+
+        memcpy(output, buf->buffer + buf->current_offset, size_to_copy);
+        buf->current_offset += size_to_copy;
+
+        return size_to_copy;
+    };
+
+    loader.eof = [](void * ctx) {
+        buf_context * buf = reinterpret_cast<buf_context *>(ctx);
+
+        return buf->current_offset >= buf->size;
+    };
+
+    loader.close = [](void * /*ctx*/) { };
+
+    if (map) {
+        loader.map = [](void * ctx, size_t read_size) -> const void * {
+            buf_context * buf = reinterpret_cast<buf_context *>(ctx);
+
+            if (read_size > buf->size - buf->current_offset) {
+                return nullptr;
+            }
+
+            const void * data = buf->buffer + buf->current_offset;
+            buf->current_offset += read_size;
+
+            return data;
+        };
+    }
+
+    return whisper_init_with_params_no_state(&loader, params);
+}
+
+#ifdef WHISPER_USE_MMAP
+static bool whisper_map_file(const char * path_model, void ** addr, size_t * size) {
+    const int fd = open(path_model, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    void * data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps the file open
+    close(fd);
+    if (data == MAP_FAILED) {
+        WHISPER_LOG_WARN("%s: failed to map '%s', reading it instead\n", __func__, path_model);
+        return false;
+    }
+
+    *addr = data;
+    *size = st.st_size;
+
+    return true;
+}
+#endif
+
 struct whisper_context * whisper_init_from_file_with_params_no_state(const char * path_model, struct whisper_context_params params) {
     WHISPER_LOG_INFO("%s: loading model from '%s'\n", __func__, path_model);
 
+#ifdef WHISPER_USE_MMAP
+    if (params.use_mmap) {
+        void * addr = nullptr;
+        size_t size = 0;
+        if (whisper_map_file(path_model, &addr, &size)) {
+            auto ctx = whisper_init_from_memory_no_state(addr, size, true, params);
+            if (!ctx) {
+                munmap(addr, size);
+                return nullptr;
+            }
+
+            ctx->model.mapping_addr = addr;
+            ctx->model.mapping_size = size;
+            ctx->path_model = path_model;
+
+            return ctx;
+        }
+    }
+#endif
+
     auto fin = std::ifstream(path_model, std::ios::binary);
     if (!fin) {
         WHISPER_LOG_ERROR("%s: failed to open '%s'\n", __func__, path_model);
@@ -3267,40 +3933,9 @@ struct whisper_context * whisper_init_from_file_with_params_no_state(const char
 }
 
 struct whisper_context * whisper_init_from_buffer_with_params_no_state(void * buffer, size_t buffer_size, struct whisper_context_params params) {
-    struct buf_context {
-        uint8_t* buffer;
-        size_t size;
-        size_t current_offset;
-    };
-
-    buf_context ctx = { reinterpret_cast<uint8_t*>(buffer), buffer_size, 0 };
-
     WHISPER_LOG_INFO("%s: loading model from buffer\n", __func__);
 
-    whisper_model_loader loader = {};
-
-    loader.context = &ctx;
-
-    loader.read = [](void * ctx, void * output, size_t read_size) {
-        buf_context * buf = reinterpret_cast<buf_context *>(ctx);
-
-        size_t size_to_copy = buf->current_offset + read_size < buf->size ? read_size : buf->size - buf->current_offset;
-
-        memcpy(output, buf->buffer + buf->current_offset, size_to_copy);
-        buf->current_offset += size_to_copy;
-
-        return size_to_copy;
-    };
-
-    loader.eof = [](void * ctx) {
-        buf_context * buf = reinterpret_cast<buf_context *>(ctx);
-
-        return buf->current_offset >= buf->size;
-    };
-
-    loader.close = [](void * /*ctx*/) { };
-
-    return whisper_init_with_params_no_state(&loader, params);
+    return whisper_init_from_memory_no_state(buffer, buffer_size, params.use_mmap, params);
 }
 
 struct whisper_context * whisper_init_with_params_no_state(struct whisper_model_loader * loader, struct whisper_context_params params) {
@@ -3435,6 +4070,16 @@ void whisper_free(struct whisper_context * ctx) {
             ggml_backend_buffer_free(ctx->model.buffer);
         }
 
+        if (ctx->model.buffer_mapped) {
+            ggml_backend_buffer_free(ctx->model.buffer_mapped);
+        }
+
+#ifdef WHISPER_USE_MMAP
+        if (ctx->model.mapping_addr) {
+            munmap(ctx->model.mapping_addr, ctx->model.mapping_size);
+        }
+#endif
+
         whisper_free_state(ctx->state);
 
         ggml_backend_free(ctx->backend);
@@ -3455,6 +4100,294 @@ void whisper_free_params(struct whisper_full_params * params) {
     }
 }
 
+// reads the model in data and writes it to fout with the weight matrices quantized to qtype, in the
+// layout whisper_model_load expects
+static int whisper_model_quantize_internal(
+        const uint8_t * data,
+        size_t size,
+        std::ofstream & fout,
+        ggml_ftype ftype_out,
+        whisper_quantize_progress_callback progress_callback,
+        void * progress_callback_user_data) {
+    const ggml_type qtype = ggml_ftype_to_ggml_type(ftype_out);
+
+    size_t pos = 0;
+
+    // returns the next n bytes of the model, or nullptr if it is truncated
+    const auto take = [&](size_t n) -> const uint8_t * {
+        if (size - pos < n) {
+            return nullptr;
+        }
+        const uint8_t * p = data + pos;
+        pos += n;
+        return p;
+    };
+
+    const auto copy = [&](size_t n) -> bool {
+        const uint8_t * p = take(n);
+        if (p == nullptr) {
+            return false;
+        }
+        fout.write((const char *) p, n);
+        return true;
+    };
+
+    const auto take_i32 = [&](int32_t & v) -> bool {
+        const uint8_t * p = take(sizeof(v));
+        if (p == nullptr) {
+            return false;
+        }
+        memcpy(&v, p, sizeof(v));
+        return true;
+    };
+
+    // magic and hparams
+    {
+        int32_t hdr[12];
+        const uint8_t * p = take(sizeof(hdr));
+        if (p == nullptr) {
+            WHISPER_LOG_ERROR("%s: the model is truncated\n", __func__);
+            return -3;
+        }
+        memcpy(hdr, p, sizeof(hdr));
+
+        if ((uint32_t) hdr[0] != GGML_FILE_MAGIC) {
+            WHISPER_LOG_ERROR("%s: invalid model data (bad magic)\n", __func__);
+            return -3;
+        }
+
+        const int32_t ftype = hdr[11] % GGML_QNT_VERSION_FACTOR;
+        if (ftype != GGML_FTYPE_ALL_F32 && ftype != GGML_FTYPE_MOSTLY_F16) {
+            WHISPER_LOG_ERROR("%s: the model is quantized already (ftype %d)\n", __func__, ftype);
+            return -4;
+        }
+
+        hdr[11] = GGML_QNT_VERSION*GGML_QNT_VERSION_FACTOR + ftype_out;
+
+        fout.write((const char *) hdr, sizeof(hdr));
+    }
+
+    // mel filters and vocab
+    {
+        int32_t n_mel = 0;
+        int32_t n_fft = 0;
+        if (!take_i32(n_mel) || !take_i32(n_fft)) {
+            WHISPER_LOG_ERROR("%s: the model is truncated\n", __func__);
+            return -3;
+        }
+        fout.write((const char *) &n_mel, sizeof(n_mel));
+        fout.write((const char *) &n_fft, sizeof(n_fft));
+
+        bool ok = n_mel >= 0 && n_fft >= 0 && copy(size_t(n_mel)*n_fft*sizeof(float));
+
+        int32_t n_vocab = 0;
+        ok = ok && take_i32(n_vocab);
+        fout.write((const char *) &n_vocab, sizeof(n_vocab));
+
+        for (int32_t i = 0; ok && i < n_vocab; ++i) {
+            int32_t len = 0;
+            ok = take_i32(len) && len >= 0;
+            fout.write((const char *) &len, sizeof(len));
+            ok = ok && copy(len);
+        }
+
+        if (!ok) {
+            WHISPER_LOG_ERROR("%s: the model is truncated\n", __func__);
+            return -3;
+        }
+    }
+
+    // these stay in their type, the loader expects F32 or the F16 intermediate type
+    static const std::set<std::string> to_skip = {
+        "encoder.conv1.bias",
+        "encoder.conv2.bias",
+        "encoder.positional_embedding",
+        "decoder.positional_embedding",
+    };
+
+    std::vector<float> f32;
+    std::vector<uint8_t> quantized;
+    std::vector<int64_t> hist(1 << 4, 0);
+
+    size_t size_org = 0;
+    size_t size_new = 0;
+
+    while (pos < size) {
+        int32_t n_dims = 0;
+        int32_t length = 0;
+        int32_t ttype  = 0;
+        if (!take_i32(n_dims) || !take_i32(length) || !take_i32(ttype) || n_dims < 1 || n_dims > 4 || length < 0 ||
+                ttype < 0 || ttype >= GGML_TYPE_COUNT) {
+            WHISPER_LOG_ERROR("%s: invalid tensor header\n", __func__);
+            return -3;
+        }
+
+        int32_t ne[4] = { 1, 1, 1, 1 };
+        int64_t nelements = 1;
+        for (int i = 0; i < n_dims; ++i) {
+            int32_t n = 0;
+            if (!take_i32(n) || n <= 0) {
+                WHISPER_LOG_ERROR("%s: invalid tensor header\n", __func__);
+                return -3;
+            }
+            ne[i] = n;
+            nelements *= n;
+        }
+
+        const uint8_t * name_data = take(length);
+        if (name_data == nullptr) {
+            WHISPER_LOG_ERROR("%s: the model is truncated\n", __func__);
+            return -3;
+        }
+        const std::string name((const char *) name_data, length);
+
+        const ggml_type type = (ggml_type) ttype;
+        const size_t nbytes = nelements/ggml_blck_size(type)*ggml_type_size(type);
+
+        const uint8_t * src = take(nbytes);
+        if (src == nullptr) {
+            WHISPER_LOG_ERROR("%s: tensor '%s' is truncated\n", __func__, name.c_str());
+            return -3;
+        }
+
+        const bool quantize = n_dims == 2 && to_skip.count(name) == 0 && (type == GGML_TYPE_F32 || type == GGML_TYPE_F16);
+
+        if (quantize && ne[0] % ggml_blck_size(qtype) != 0) {
+            WHISPER_LOG_ERROR("%s: tensor '%s' has rows of %d values, which %s cannot store\n", __func__, name.c_str(), ne[0], ggml_type_name(qtype));
+            return -5;
+        }
+
+        const int32_t ttype_out = quantize ? (int32_t) qtype : ttype;
+
+        fout.write((const char *) &n_dims, sizeof(n_dims));
+        fout.write((const char *) &length, sizeof(length));
+        fout.write((const char *) &ttype_out, sizeof(ttype_out));
+        fout.write((const char *) ne, n_dims*sizeof(int32_t));
+        fout.write(name.data(), length);
+
+        if (quantize) {
+            // a few rows at a time, the token embeddings of the larger models would need hundreds of MB as F32
+            const int64_t n_per_row = ne[0];
+            const int64_t n_rows = nelements/n_per_row;
+            const int64_t n_rows_chunk = std::max<int64_t>(1, WHISPER_QUANTIZE_CHUNK/n_per_row);
+
+            f32.resize(n_rows_chunk*n_per_row);
+            quantized.resize(n_rows_chunk*n_per_row/ggml_blck_size(qtype)*ggml_type_size(qtype));
+
+            for (int64_t r0 = 0; r0 < n_rows; r0 += n_rows_chunk) {
+                const int n = std::min(n_rows_chunk, n_rows - r0)*n_per_row;
+
+                if (type == GGML_TYPE_F16) {
+                    ggml_fp16_to_fp32_row((const ggml_fp16_t *) src + r0*n_per_row, f32.data(), n);
+                } else {
+                    memcpy(f32.data(), (const float *) src + r0*n_per_row, n*sizeof(float));
+                }
+
+                const size_t n_quantized = ggml_quantize_chunk(qtype, f32.data(), quantized.data(), 0, n, hist.data());
+
+                fout.write((const char *) quantized.data(), n_quantized);
+                size_new += n_quantized;
+            }
+        } else {
+            fout.write((const char *) src, nbytes);
+            size_new += nbytes;
+        }
+        size_org += nbytes;
+
+        if (!fout) {
+            WHISPER_LOG_ERROR("%s: failed to write tensor '%s'\n", __func__, name.c_str());
+            return -6;
+        }
+
+        if (progress_callback && !progress_callback(float(pos)/size, progress_callback_user_data)) {
+            WHISPER_LOG_INFO("%s: cancelled\n", __func__);
+            return -7;
+        }
+    }
+
+    WHISPER_LOG_INFO("%s: %s, weights %7.2f MB -> %7.2f MB\n", __func__, ggml_type_name(qtype), size_org/1e6, size_new/1e6);
+
+    return 0;
+}
+
+static int whisper_model_quantize_to_file(
+        const uint8_t * data,
+        size_t size,
+        const char * path_out,
+        enum ggml_ftype ftype,
+        whisper_quantize_progress_callback progress_callback,
+        void * progress_callback_user_data) {
+    const ggml_type qtype = ggml_ftype_to_ggml_type(ftype);
+    if (qtype == GGML_TYPE_COUNT || !ggml_is_quantized(qtype)) {
+        WHISPER_LOG_ERROR("%s: ftype %d is not a quantized type\n", __func__, ftype);
+        return -1;
+    }
+
+    // initializes the f16 conversion tables
+    {
+        struct ggml_init_params params = { 0, nullptr, false };
+        struct ggml_context * ctx = ggml_init(params);
+        ggml_free(ctx);
+    }
+
+    std::ofstream fout(path_out, std::ios::binary);
+    if (!fout) {
+        WHISPER_LOG_ERROR("%s: failed to open '%s' for writing\n", __func__, path_out);
+        return -2;
+    }
+
+    int ret = whisper_model_quantize_internal(data, size, fout, ftype, progress_callback, progress_callback_user_data);
+
+    fout.close();
+    if (ret == 0 && !fout) {
+        WHISPER_LOG_ERROR("%s: failed to write '%s'\n", __func__, path_out);
+        ret = -6;
+    }
+
+    if (ret != 0) {
+        std::remove(path_out);
+    }
+
+    return ret;
+}
+
+int whisper_model_quantize(
+        const char * path_model,
+        const char * path_out,
+        enum ggml_ftype ftype,
+        whisper_quantize_progress_callback progress_callback,
+        void * progress_callback_user_data) {
+#ifdef WHISPER_USE_MMAP
+    void * addr = nullptr;
+    size_t size = 0;
+    if (whisper_map_file(path_model, &addr, &size)) {
+        const int ret = whisper_model_quantize_to_file((const uint8_t *) addr, size, path_out, ftype, progress_callback, progress_callback_user_data);
+        munmap(addr, size);
+        return ret;
+    }
+#endif
+
+    std::ifstream fin(path_model, std::ios::binary);
+    if (!fin) {
+        WHISPER_LOG_ERROR("%s: failed to open '%s'\n", __func__, path_model);
+        return -2;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+    return whisper_model_quantize_to_file(data.data(), data.size(), path_out, ftype, progress_callback, progress_callback_user_data);
+}
+
+int whisper_model_quantize_from_buffer(
+        const void * buffer,
+        size_t buffer_size,
+        const char * path_out,
+        enum ggml_ftype ftype,
+        whisper_quantize_progress_callback progress_callback,
+        void * progress_callback_user_data) {
+    return whisper_model_quantize_to_file((const uint8_t *) buffer, buffer_size, path_out, ftype, progress_callback, progress_callback_user_data);
+}
+
 int whisper_pcm_to_mel_with_state(struct whisper_context * ctx, struct whisper_state * state, const float * samples, int n_samples, int n_threads) {
     if (!log_mel_spectrogram(*state, samples, n_samples, WHISPER_SAMPLE_RATE, WHISPER_N_FFT, WHISPER_HOP_LENGTH, ctx->model.filters.n_mel, n_threads, ctx->model.filters, false, state->mel)) {
         WHISPER_LOG_ERROR("%s: failed to compute mel spectrogram\n", __func__);
@@ -3483,8 +4416,96 @@ int whisper_pcm_to_mel_phase_vocoder(struct whisper_context * ctx, const float *
     return whisper_pcm_to_mel_phase_vocoder_with_state(ctx, ctx->state, samples, n_samples, n_threads);
 }
 
+// WSOLA (waveform similarity overlap-add) compresses the audio in time by 2x without changing its
+// pitch. The output is built from Hann windowed frames with 50% overlap. Every frame is read from
+// around twice its output position, shifted by up to WHISPER_WSOLA_TOLERANCE samples to where it
+// continues the previously read frame best, so the overlaps add up in phase.
+#define WHISPER_WSOLA_FRAME     512 // 32 ms
+#define WHISPER_WSOLA_TOLERANCE 128 //  8 ms
+
+static std::vector<float> wsola_speed_up_x2(const float * samples, int n_samples) {
+    const int frame = WHISPER_WSOLA_FRAME;
+    const int hop   = frame/2;
+    const int tol   = WHISPER_WSOLA_TOLERANCE;
+
+    if (n_samples <= 0) {
+        return {};
+    }
+
+    const int n_out = n_samples/2;
+
+    // zero padding, so that every candidate frame lies inside the input
+    const int pad = frame + tol;
+    std::vector<float> input(pad + n_samples + 2*frame + 2*tol, 0.0f);
+    std::copy(samples, samples + n_samples, input.begin() + pad);
+
+    std::vector<float> window(frame);
+    for (int i = 0; i < frame; i++) {
+        window[i] = 0.5f - 0.5f*cosf(2.0f*M_PI*i/frame);
+    }
+
+    std::vector<float> output(n_out + frame, 0.0f);
+
+    // the first frame starts one hop before the output, so that the windows add up to 1 everywhere
+    int prev = -1;
+    for (int out_pos = -hop; out_pos < n_out; out_pos += hop) {
+        int best = pad + 2*out_pos;
+
+        if (prev >= 0) {
+            // natural continuation of the previous frame, matched against the candidate starts
+            const float * cont = input.data() + prev + hop;
+
+            const float * cand = input.data() + best - tol;
+            double energy = 0.0;
+            for (int j = 0; j < hop; j++) {
+                energy += cand[j]*cand[j];
+            }
+
+            double best_score = -1e30;
+            for (int d = -tol; d <= tol; d++) {
+                const float * x = input.data() + pad + 2*out_pos + d;
+
+                double corr = 0.0;
+                for (int j = 0; j < hop; j++) {
+                    corr += cont[j]*x[j];
+                }
+
+                const double score = corr/sqrt(energy + 1e-9);
+                if (score > best_score) {
+                    best_score = score;
+                    best = pad + 2*out_pos + d;
+                }
+
+                energy += x[hop]*x[hop] - x[0]*x[0];
+            }
+        }
+
+        for (int i = 0; i < frame; i++) {
+            const int o = out_pos + i;
+            if (o >= 0) {
+                output[o] += window[i]*input[best + i];
+            }
+        }
+
+        prev = best;
+    }
+
+    output.resize(n_out);
+
+    return output;
+}
+
 // same as whisper_pcm_to_mel, but applies WSOLA to speed up the audio x2
-// TODO
+int whisper_pcm_to_mel_wsola_with_state(struct whisper_context * ctx, struct whisper_state * state, const float * samples, int n_samples, int n_threads) {
+    const std::vector<float> compressed = wsola_speed_up_x2(samples, n_samples);
+
+    return whisper_pcm_to_mel_with_state(ctx, state, compressed.data(), compressed.size(), n_threads);
+}
+
+// same as whisper_pcm_to_mel, but applies WSOLA to speed up the audio x2
+int whisper_pcm_to_mel_wsola(struct whisper_context * ctx, const float * samples, int n_samples, int n_threads) {
+    return whisper_pcm_to_mel_wsola_with_state(ctx, ctx->state, samples, n_samples, n_threads);
+}
 
 // same as whisper_pcm_to_mel, but applies HPTSM to speed up the audio x2
 // TODO
@@ -3521,6 +4542,234 @@ int whisper_set_mel(
     return whisper_set_mel_with_state(ctx, ctx->state, data, n_len, n_mel);
 }
 
+// the stream keeps the log mel bands down to this power, so that they can still be scaled before they are
+// clamped to the 1e-10 of log_mel_spectrogram
+#define WHISPER_MEL_STREAM_FLOOR 1e-30
+
+// frame k of the stream is centered on sample k*WHISPER_HOP_LENGTH, the frames of a part of the stream
+// starting at a frame boundary are the same except the ones that reach the padding at its ends
+struct whisper_mel_stream {
+    int n_mel = 0;
+
+    std::vector<float> hann;
+    whisper_fft_plan fft_plan;
+
+    // the log mel bands of the frames computed so far, frame after frame
+    std::vector<float> frames;
+    // the largest band of each frame
+    std::vector<float> frame_max;
+    int n_frames = 0;
+};
+
+struct whisper_mel_stream * whisper_mel_stream_init(struct whisper_context * ctx) {
+    whisper_mel_stream * stream = new whisper_mel_stream;
+
+    stream->n_mel = ctx->model.filters.n_mel;
+    hann_window(WHISPER_N_FFT, true, stream->hann);
+    whisper_fft_plan_init(stream->fft_plan, WHISPER_N_FFT);
+
+    return stream;
+}
+
+void whisper_mel_stream_free(struct whisper_mel_stream * stream) {
+    delete stream;
+}
+
+void whisper_mel_stream_clear(struct whisper_mel_stream * stream) {
+    std::vector<float>().swap(stream->frames);
+    std::vector<float>().swap(stream->frame_max);
+    stream->n_frames = 0;
+}
+
+int whisper_mel_stream_update(
+        struct whisper_context * ctx,
+        struct whisper_mel_stream * stream,
+        const float * samples,
+        int   n_samples,
+        int   n_threads) {
+    const int n_mel = stream->n_mel;
+    const int half  = WHISPER_N_FFT/2;
+
+    // the frames that the samples cover entirely
+    const int n_frames = n_samples < half ? 0 : (n_samples - half)/WHISPER_HOP_LENGTH + 1;
+    if (n_frames < stream->n_frames) {
+        WHISPER_LOG_ERROR("%s: the stream has %d frames, more than %d samples cover\n", __func__, stream->n_frames, n_samples);
+        return -1;
+    }
+    if (n_frames == stream->n_frames) {
+        return 0;
+    }
+
+    const int64_t t_start_us = ggml_time_us();
+
+    const int i0 = stream->n_frames;
+    stream->frames.resize((size_t) n_frames*n_mel);
+    stream->frame_max.resize(n_frames);
+
+    auto worker = [&](int ith, int nth) {
+        std::vector<float> fft_in(WHISPER_N_FFT);
+        std::vector<float> fft_out(2*(1 + half));
+        whisper_fft_scratch fft_scratch(stream->fft_plan);
+
+        for (int i = i0 + ith; i < n_frames; i += nth) {
+            float * out = stream->frames.data() + (size_t) i*n_mel;
+
+            // the frames reaching before the stream are never used, see whisper_set_mel_from_stream_with_state
+            const int offset = i*WHISPER_HOP_LENGTH - half;
+            if (offset < 0) {
+                std::fill(out, out + n_mel, (float) log10(WHISPER_MEL_STREAM_FLOOR));
+                stream->frame_max[i] = out[0];
+                continue;
+            }
+
+            for (int j = 0; j < WHISPER_N_FFT; j++) {
+                fft_in[j] = stream->hann[j]*samples[offset + j];
+            }
+
+            log_mel_spectrogram_frame(fft_in.data(), stream->fft_plan, fft_scratch, fft_out, ctx->model.filters,
+                                      n_mel, WHISPER_MEL_STREAM_FLOOR, out, 1);
+
+            stream->frame_max[i] = *std::max_element(out, out + n_mel);
+        }
+    };
+
+    // the new audio of a stream step is a couple of hundred frames, not worth more than a few threads
+    const int n_workers = std::max(1, std::min(n_threads, (n_frames - i0)/100));
+
+    std::vector<std::thread> workers(n_workers - 1);
+    for (int iw = 0; iw < n_workers - 1; ++iw) {
+        workers[iw] = std::thread(worker, iw + 1, n_workers);
+    }
+    worker(0, n_workers);
+    for (int iw = 0; iw < n_workers - 1; ++iw) {
+        workers[iw].join();
+    }
+
+    stream->n_frames = n_frames;
+
+    if (ctx->state) {
+        ctx->state->t_mel_us += ggml_time_us() - t_start_us;
+    }
+
+    return 0;
+}
+
+int whisper_set_mel_from_stream_with_state(
+        struct whisper_context * ctx,
+        struct whisper_state * state,
+        const struct whisper_mel_stream * stream,
+        const float * samples,
+        int   n_samples,
+        int   offset,
+        float scale) {
+    const int n_mel = stream->n_mel;
+    const int half  = WHISPER_N_FFT/2;
+    const int n     = n_samples - offset;
+
+    // the reflective padding at the start takes half a frame of samples after the first one
+    if (offset < 0 || offset % WHISPER_HOP_LENGTH != 0 || n <= half || scale <= 0.0f) {
+        WHISPER_LOG_ERROR("%s: invalid offset %d of %d samples or scale %f\n", __func__, offset, n_samples, scale);
+        return -1;
+    }
+    if (stream->n_frames < (n_samples - half)/WHISPER_HOP_LENGTH + 1) {
+        WHISPER_LOG_ERROR("%s: the stream is not updated to %d samples\n", __func__, n_samples);
+        return -2;
+    }
+
+    const int64_t t_start_us = ggml_time_us();
+
+    const float * x = samples + offset;
+
+    // the same frames as log_mel_spectrogram for the n samples scaled by scale
+    whisper_mel & mel = state->mel;
+    mel.n_mel     = n_mel;
+    mel.n_len     = (n + WHISPER_SAMPLE_RATE*30)/WHISPER_HOP_LENGTH;
+    mel.n_len_org = 1 + (n - half)/WHISPER_HOP_LENGTH;
+    mel.data.resize((size_t) n_mel*mel.n_len);
+
+    const int   i_stream = offset/WHISPER_HOP_LENGTH;
+    // the frames from i_inner_begin to i_inner_end only read samples of the part
+    const int   i_inner_begin = std::min((half + WHISPER_HOP_LENGTH - 1)/WHISPER_HOP_LENGTH, mel.n_len_org);
+    const int   i_inner_end   = mel.n_len_org;
+    // the frames after i_fft_end only read the zero padding
+    const int   i_fft_end     = std::min((n + half)/WHISPER_HOP_LENGTH + 1, mel.n_len);
+    const float shift         = 2.0f*log10f(scale);
+    const float mel_floor     = log10(1e-10);
+
+    float mmax = mel_floor;
+
+    for (int i = i_inner_begin; i < i_inner_end; i++) {
+        const float * frame = stream->frames.data() + (size_t) (i_stream + i)*n_mel;
+        for (int j = 0; j < n_mel; j++) {
+            mel.data[j*mel.n_len + i] = std::max(frame[j] + shift, mel_floor);
+        }
+        mmax = std::max(mmax, stream->frame_max[i_stream + i] + shift);
+    }
+
+    // the frames reaching the padding are computed from the part, padded like log_mel_spectrogram pads it
+    {
+        std::vector<float> fft_in(WHISPER_N_FFT);
+        std::vector<float> fft_out(2*(1 + half));
+        whisper_fft_scratch fft_scratch(stream->fft_plan);
+
+        const auto padded = [&](int t) {
+            if (t < half) {
+                return x[half - t]*scale;
+            }
+            return t - half < n ? x[t - half]*scale : 0.0f;
+        };
+
+        for (int i = 0; i < i_fft_end; i++) {
+            if (i == i_inner_begin) {
+                i = std::max(i, i_inner_end);
+                if (i >= i_fft_end) {
+                    break;
+                }
+            }
+
+            for (int j = 0; j < WHISPER_N_FFT; j++) {
+                fft_in[j] = stream->hann[j]*padded(i*WHISPER_HOP_LENGTH + j);
+            }
+
+            log_mel_spectrogram_frame(fft_in.data(), stream->fft_plan, fft_scratch, fft_out, ctx->model.filters,
+                                      n_mel, 1e-10, mel.data.data() + i, mel.n_len);
+
+            for (int j = 0; j < n_mel; j++) {
+                mmax = std::max(mmax, mel.data[j*mel.n_len + i]);
+            }
+        }
+    }
+
+    for (int j = 0; j < n_mel; j++) {
+        std::fill(mel.data.begin() + j*mel.n_len + i_fft_end, mel.data.begin() + (j + 1)*mel.n_len, mel_floor);
+    }
+
+    // clamping and normalization as in log_mel_spectrogram
+    mmax -= 8.0;
+
+    for (int i = 0; i < n_mel*mel.n_len; i++) {
+        if (mel.data[i] < mmax) {
+            mel.data[i] = mmax;
+        }
+
+        mel.data[i] = (mel.data[i] + 4.0)/4.0;
+    }
+
+    state->t_mel_us += ggml_time_us() - t_start_us;
+
+    return 0;
+}
+
+int whisper_set_mel_from_stream(
+        struct whisper_context * ctx,
+        const struct whisper_mel_stream * stream,
+        const float * samples,
+        int   n_samples,
+        int   offset,
+        float scale) {
+    return whisper_set_mel_from_stream_with_state(ctx, ctx->state, stream, samples, n_samples, offset, scale);
+}
+
 int whisper_encode_with_state(struct whisper_context * ctx, struct whisper_state * state, int offset, int n_threads) {
     if (!whisper_encode_internal(*ctx, *state, offset, n_threads, nullptr, nullptr)) {
         WHISPER_LOG_ERROR("%s: failed to eval\n", __func__);
@@ -3878,6 +5127,7 @@ void whisper_reset_timings(struct whisper_context * ctx) {
         ctx->state->t_sample_us = 0;
         ctx->state->t_encode_us = 0;
         ctx->state->t_decode_us = 0;
+        ctx->state->t_batchd_us = 0;
         ctx->state->t_prompt_us = 0;
         ctx->state->n_sample = 0;
         ctx->state->n_encode = 0;
@@ -3887,6 +5137,136 @@ void whisper_reset_timings(struct whisper_context * ctx) {
     }
 }
 
+struct whisper_timings whisper_get_timings(struct whisper_context * ctx) {
+    struct whisper_timings timings = whisper_get_timings_from_state(ctx->state);
+    timings.load_ms = 1e-3f * ctx->t_load_us;
+    return timings;
+}
+
+struct whisper_timings whisper_get_timings_from_state(struct whisper_state * state) {
+    struct whisper_timings timings = {};
+
+    if (state == nullptr) {
+        return timings;
+    }
+
+    timings.mel_ms    = 1e-3f * state->t_mel_us;
+    timings.sample_ms = 1e-3f * state->t_sample_us;
+    timings.encode_ms = 1e-3f * state->t_encode_us;
+    timings.decode_ms = 1e-3f * state->t_decode_us;
+    timings.batchd_ms = 1e-3f * state->t_batchd_us;
+    timings.prompt_ms = 1e-3f * state->t_prompt_us;
+    timings.n_sample  = state->n_sample;
+    timings.n_encode  = state->n_encode;
+    timings.n_decode  = state->n_decode;
+    timings.n_batchd  = state->n_batchd;
+    timings.n_prompt  = state->n_prompt;
+
+    return timings;
+}
+
+size_t whisper_trim_memory(struct whisper_context * ctx, bool release_kv_cache) {
+    whisper_state * state = ctx->state;
+    if (state == nullptr) {
+        return 0;
+    }
+
+    const size_t mem_before = state->mem_cur;
+
+    whisper_allocr_release(*state, state->alloc_conv);
+    whisper_allocr_release(*state, state->alloc_encode);
+    whisper_allocr_release(*state, state->alloc_cross);
+    whisper_allocr_release(*state, state->alloc_decode);
+
+    if (release_kv_cache) {
+        state->mem_cur -= kv_cache_nbytes(state->kv_self) + kv_cache_nbytes(state->kv_cross);
+        kv_cache_free(state->kv_self);
+        kv_cache_free(state->kv_cross);
+    }
+
+    return mem_before - state->mem_cur;
+}
+
+#ifdef WHISPER_USE_MMAP
+#ifndef MADV_COLD
+#define MADV_COLD 20
+#endif
+
+// the whole pages inside [addr, addr + size)
+static size_t whisper_madvise_pages(void * addr, size_t size, int advice) {
+    const uintptr_t page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+    const uintptr_t begin = ((uintptr_t) addr + page_size - 1) / page_size * page_size;
+    const uintptr_t end   = ((uintptr_t) addr + size) / page_size * page_size;
+    if (end <= begin || madvise((void *) begin, end - begin, advice) != 0) {
+        return 0;
+    }
+
+    return end - begin;
+}
+#endif
+
+size_t whisper_advise_weights_cold(struct whisper_context * ctx) {
+    size_t advised = 0;
+#ifdef WHISPER_USE_MMAP
+    const whisper_model & model = ctx->model;
+    if (model.mapping_addr) {
+        advised += whisper_madvise_pages(model.mapping_addr, model.mapping_size, MADV_COLD);
+        if (advised == 0) {
+            // clean pages of a read-only file mapping, which are read again from the file
+            advised += whisper_madvise_pages(model.mapping_addr, model.mapping_size, MADV_DONTNEED);
+        }
+    } else if (model.buffer_mapped) {
+        // the caller's memory, which is not necessarily backed by a file, so it is not dropped
+        advised += whisper_madvise_pages(ggml_backend_buffer_get_base(model.buffer_mapped),
+                ggml_backend_buffer_get_size(model.buffer_mapped), MADV_COLD);
+    }
+    // the weights converted or copied while loading
+    if (model.buffer) {
+        advised += whisper_madvise_pages(ggml_backend_buffer_get_base(model.buffer),
+                ggml_backend_buffer_get_size(model.buffer), MADV_COLD);
+    }
+#else
+    (void) ctx;
+#endif
+
+    return advised;
+}
+
+void whisper_prefetch_weights(struct whisper_context * ctx) {
+#ifdef WHISPER_USE_MMAP
+    if (ctx->model.buffer_mapped) {
+        whisper_madvise_pages(ggml_backend_buffer_get_base(ctx->model.buffer_mapped),
+                ggml_backend_buffer_get_size(ctx->model.buffer_mapped), MADV_WILLNEED);
+    }
+#else
+    (void) ctx;
+#endif
+}
+
+struct whisper_mem_stats whisper_get_mem_stats(struct whisper_context * ctx) {
+    return whisper_get_mem_stats_from_state(ctx->state);
+}
+
+struct whisper_mem_stats whisper_get_mem_stats_from_state(struct whisper_state * state) {
+    struct whisper_mem_stats stats = {};
+
+    if (state == nullptr) {
+        return stats;
+    }
+
+    stats.kv_self        = kv_cache_nbytes(state->kv_self);
+    stats.kv_cross       = kv_cache_nbytes(state->kv_cross);
+    stats.compute_conv   = whisper_allocr_size(state->alloc_conv);
+    stats.compute_encode = whisper_allocr_size(state->alloc_encode);
+    stats.compute_cross  = whisper_allocr_size(state->alloc_cross);
+    stats.compute_decode = whisper_allocr_size(state->alloc_decode);
+    stats.current        = state->mem_cur;
+    stats.peak           = state->mem_peak;
+    stats.n_text_ctx     = state->n_text_ctx;
+
+    return stats;
+}
+
 static int whisper_has_coreml(void) {
 #ifdef WHISPER_USE_COREML
     return 1;
@@ -4369,6 +5749,7 @@ struct whisper_full_params whisper_full_default_params(enum whisper_sampling_str
             /*.strategy          =*/ strategy,
 
             /*.n_threads         =*/ std::min(4, (int32_t) std::thread::hardware_concurrency()),
+            /*.n_threads_decoder =*/ 0,
             /*.n_max_text_ctx    =*/ 16384,
             /*.offset_ms         =*/ 0,
             /*.duration_ms       =*/ 0,
@@ -4392,9 +5773,13 @@ struct whisper_full_params whisper_full_default_params(enum whisper_sampling_str
             /*.speed_up          =*/ false,
             /*.debug_mode        =*/ false,
             /*.audio_ctx         =*/ 0,
+            /*.text_logits_only  =*/ false,
 
             /*.tdrz_enable       =*/ false,
 
+            /*.draft_ctx         =*/ nullptr,
+            /*.n_draft           =*/ 4,
+
             /*.initial_prompt    =*/ nullptr,
             /*.prompt_tokens     =*/ nullptr,
             /*.prompt_n_tokens   =*/ 0,
@@ -4405,6 +5790,9 @@ struct whisper_full_params whisper_full_default_params(enum whisper_sampling_str
             /*.allowed_langs     =*/ nullptr,
             /*.allowed_langs_size=*/ 0,
 
+            /*.lang_detect_ms    =*/ 0,
+            /*.lang_detect_thold =*/ 0.5f,
+
             /*.suppress_blank    =*/ true,
             /*.suppress_non_speech_tokens =*/ false,
 
@@ -4412,6 +5800,10 @@ struct whisper_full_params whisper_full_default_params(enum whisper_sampling_str
             /*.max_initial_ts    =*/  1.0f,
             /*.length_penalty    =*/ -1.0f,
 
+            /*.eot_thold         =*/  0.0f,
+            /*.repetition_thold  =*/  0,
+            /*.max_tokens_per_s  =*/  0.0f,
+
             /*.temperature_inc   =*/  0.2f,
             /*.entropy_thold     =*/  2.4f,
             /*.logprob_thold     =*/ -1.0f,
@@ -4548,10 +5940,59 @@ static const std::vector<std::string> non_speech_tokens = {
         "♪♪♪","♩", "♪", "♫", "♬", "♭", "♮", "♯"
 };
 
+// the ids of the non-speech tokens with and without a leading space, plus " -" and " '"
+// (hyphens and single quotes are allowed between words, but not at the beginning of a word)
+static std::vector<whisper_token> whisper_non_speech_token_ids(const whisper_vocab & vocab) {
+    std::vector<whisper_token> ids;
+
+    for (const std::string & token : non_speech_tokens) {
+        const std::string suppress_tokens[] = {token, " " + token};
+        for (const std::string & suppress_token : suppress_tokens) {
+            const auto it = vocab.token_to_id.find(suppress_token);
+            if (it != vocab.token_to_id.end()) {
+                ids.push_back(it->second);
+            }
+        }
+    }
+
+    for (const char * suppress_token : { " -", " '" }) {
+        const auto it = vocab.token_to_id.find(suppress_token);
+        if (it != vocab.token_to_id.end()) {
+            ids.push_back(it->second);
+        }
+    }
+
+    return ids;
+}
+
+// log_softmax of the logits into logprobs
+// exps receives exp(logit - max) and their sum is returned, so the probs are one multiply away
+// masked logits (-INFINITY) give a logprob of -INFINITY and an exp of 0 without special casing
+static float whisper_log_softmax(const std::vector<float> & logits, std::vector<float> & logprobs, std::vector<float> & exps) {
+    const int n = logits.size();
+
+    float logit_max = -INFINITY;
+    for (int i = 0; i < n; ++i) {
+        logit_max = std::max(logit_max, logits[i]);
+    }
+
+    float sum = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        exps[i] = expf(logits[i] - logit_max);
+        sum += exps[i];
+    }
+
+    const float logsumexp = logf(sum) + logit_max;
+    for (int i = 0; i < n; ++i) {
+        logprobs[i] = logits[i] - logsumexp;
+    }
+
+    return sum;
+}
+
 // process the logits for the selected decoder
 // - applies logit filters
 // - computes logprobs and probs
-// TODO: optimize
 static void whisper_process_logits(
         struct whisper_context & ctx,
         struct whisper_state  & state,
@@ -4572,13 +6013,16 @@ static void whisper_process_logits(
     auto & logits   = decoder.logits;
     auto & logprobs = decoder.logprobs;
     {
-        logits.resize(n_logits);
-        memcpy(logits.data(), state.logits.data() + decoder.i_batch*n_logits, n_logits*sizeof(float));
+        const float * logits_batch = state.logits.data() + decoder.i_batch*n_logits;
 
+        logits.resize(n_logits);
         if (temperature > 0.0f) {
+            const float scale = 1.0f/temperature;
             for (int i = 0; i < n_logits; i++) {
-                logits[i] /= temperature;
+                logits[i] = logits_batch[i]*scale;
             }
+        } else {
+            memcpy(logits.data(), logits_batch, n_logits*sizeof(float));
         }
 
         // will be populated a bit later
@@ -4622,9 +6066,7 @@ static void whisper_process_logits(
         logits[vocab.token_prev]       = -INFINITY;
 
         // suppress lang tokens
-        for (size_t i = 0; i < g_lang.size(); ++i) {
-            logits[whisper_token_lang(&ctx, i)] = -INFINITY;
-        }
+        std::fill(logits.begin() + whisper_token_lang(&ctx, 0), logits.begin() + whisper_token_lang(&ctx, g_lang.size()), -INFINITY);
 
         // suppress prev token
         logits[vocab.token_prev] = -INFINITY;
@@ -4636,21 +6078,8 @@ static void whisper_process_logits(
         // suppress non-speech tokens
         // ref: https://github.com/openai/whisper/blob/7858aa9c08d98f75575035ecd6481f462d66ca27/whisper/tokenizer.py#L224-L253
         if (params.suppress_non_speech_tokens) {
-            for (const std::string & token : non_speech_tokens) {
-                const std::string suppress_tokens[] = {token, " " + token};
-                for (const std::string & suppress_token : suppress_tokens) {
-                    if (vocab.token_to_id.find(suppress_token) != vocab.token_to_id.end()) {
-                        logits[vocab.token_to_id.at(suppress_token)] = -INFINITY;
-                    }
-                }
-            }
-
-            // allow hyphens "-" and single quotes "'" between words, but not at the beginning of a word
-            if (vocab.token_to_id.find(" -") != vocab.token_to_id.end()) {
-                logits[vocab.token_to_id.at(" -")] = -INFINITY;
-            }
-            if (vocab.token_to_id.find(" '") != vocab.token_to_id.end()) {
-                logits[vocab.token_to_id.at(" '")] = -INFINITY;
+            for (const whisper_token id : state.non_speech_ids) {
+                logits[id] = -INFINITY;
             }
         }
 
@@ -4696,25 +6125,8 @@ static void whisper_process_logits(
             }
         }
 
-        // populate the logprobs array (log_softmax)
-        {
-            const float logit_max = *std::max_element(logits.begin(), logits.end());
-            float logsumexp = 0.0f;
-            for (int i = 0; i < n_logits; ++i) {
-                if (logits[i] > -INFINITY) {
-                    logsumexp += expf(logits[i] - logit_max);
-                }
-            }
-            logsumexp = logf(logsumexp) + logit_max;
-
-            for (int i = 0; i < n_logits; ++i) {
-                if (logits[i] > -INFINITY) {
-                    logprobs[i] = logits[i] - logsumexp;
-                } else {
-                    logprobs[i] = -INFINITY;
-                }
-            }
-        }
+        // populate the logprobs array (log_softmax), probs holds the exps until the end
+        float sum = whisper_log_softmax(logits, logprobs, probs);
 
         // if sum of probability over timestamps is above any other token, sample timestamp
         // ref: https://github.com/openai/whisper/blob/0b1ba3d46ebf7fe6f953acfd8cad62a4f851b49f/whisper/decoding.py#L431-L437
@@ -4722,19 +6134,19 @@ static void whisper_process_logits(
             // logsumexp over timestamps
             float timestamp_logprob = -INFINITY;
             {
-                float logsumexp = 0.0f;
-                const float logprob_max = *std::max_element(logprobs.begin() + vocab.token_beg, logprobs.end());
+                float sum_ts = 0.0f;
                 for (int i = vocab.token_beg; i < n_logits; ++i) {
-                    if (logprobs[i] > -INFINITY) {
-                        logsumexp += expf(logprobs[i] - logprob_max);
-                    }
+                    sum_ts += probs[i];
                 }
-                if (logsumexp > 0.0f) {
-                    timestamp_logprob = logf(logsumexp) + logprob_max;
+                if (sum_ts > 0.0f) {
+                    timestamp_logprob = logf(sum_ts/sum);
                 }
             }
 
-            const float max_text_token_logprob = *std::max_element(logprobs.begin(), logprobs.begin() + vocab.token_beg);
+            float max_text_token_logprob = -INFINITY;
+            for (int i = 0; i < vocab.token_beg; ++i) {
+                max_text_token_logprob = std::max(max_text_token_logprob, logprobs[i]);
+            }
 
             //WHISPER_LOG_INFO("timestamp_logprob=%f max_text_token_logprob=%f\n", timestamp_logprob, max_text_token_logprob);
 
@@ -4742,42 +6154,23 @@ static void whisper_process_logits(
                 for (int i = 0; i < vocab.token_beg; ++i) {
                     logits[i]   = -INFINITY;
                     logprobs[i] = -INFINITY;
+                    probs[i]    = 0.0f;
                 }
             } else {
                 if (params.n_grammar_rules > 0) {
                     whisper_suppress_invalid_grammar(ctx, params, logits, decoder.grammar);
 
                     // populate the logprobs array (log_softmax)
-                    {
-                        const float logit_max = *std::max_element(logits.begin(), logits.end());
-                        float logsumexp = 0.0f;
-                        for (int i = 0; i < n_logits; ++i) {
-                            if (logits[i] > -INFINITY) {
-                                logsumexp += expf(logits[i] - logit_max);
-                            }
-                        }
-                        logsumexp = logf(logsumexp) + logit_max;
-
-                        for (int i = 0; i < n_logits; ++i) {
-                            if (logits[i] > -INFINITY) {
-                                logprobs[i] = logits[i] - logsumexp;
-                            } else {
-                                logprobs[i] = -INFINITY;
-                            }
-                        }
-                    }
+                    sum = whisper_log_softmax(logits, logprobs, probs);
                 }
             }
         }
-    }
 
-    // compute probs
-    {
-        for (int i = 0; i < n_logits; ++i) {
-            if (logits[i] == -INFINITY) {
-                probs[i] = 0.0f;
-            } else {
-                probs[i] = expf(logprobs[i]);
+        // compute probs
+        {
+            const float scale = 1.0f/sum;
+            for (int i = 0; i < n_logits; ++i) {
+                probs[i] *= scale;
             }
         }
     }
@@ -4895,10 +6288,12 @@ static whisper_token_data whisper_sample_token(
     return result;
 }
 
+// the k most likely tokens with best, otherwise k tokens sampled from the probabilities
 static std::vector<whisper_token_data> whisper_sample_token_topk(
         whisper_context & ctx,
         whisper_decoder & decoder,
-        int   k) {
+        int   k,
+        bool  best) {
     const auto & vocab = ctx.vocab;
 
     const auto & probs    = decoder.probs;
@@ -4907,23 +6302,7 @@ static std::vector<whisper_token_data> whisper_sample_token_topk(
 
     const int n_logits = vocab.n_vocab;
 
-    auto & logits_id = decoder.logits_id;
-
-    logits_id.resize(n_logits);
-    for (int i = 0; i < n_logits; ++i) {
-        logits_id[i].first = logits[i];
-        logits_id[i].second = i;
-    }
-
-    {
-        using pair_type = std::remove_reference<decltype(logits_id)>::type::value_type;
-        std::partial_sort(
-                logits_id.begin(),
-                logits_id.begin() + k, logits_id.end(),
-                [](const pair_type & a, const pair_type & b) {
-                    return a.first > b.first;
-                });
-    }
+    k = std::min(k, n_logits);
 
     std::vector<whisper_token_data> result;
     result.reserve(k);
@@ -4953,24 +6332,76 @@ static std::vector<whisper_token_data> whisper_sample_token_topk(
         ptsum = sum_ts;
     }
 
+    const auto push = [&](whisper_token id) {
+        result.push_back({ id, tid, probs[id], logprobs[id], pt, ptsum, -1, -1, 0.0f, });
+
+        if (result.back().id >= vocab.token_beg) {
+            result.back().tid = result.back().id;
+            result.back().pt  = result.back().p;
+        }
+    };
+
+    if (best) {
+        auto & logits_id = decoder.logits_id;
+
+        logits_id.resize(n_logits);
+        for (int i = 0; i < n_logits; ++i) {
+            logits_id[i].first = logits[i];
+            logits_id[i].second = i;
+        }
+
+        // only the k first are ordered, in a single pass over the vocabulary
+        using pair_type = std::remove_reference<decltype(logits_id)>::type::value_type;
+        const auto greater = [](const pair_type & a, const pair_type & b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        };
+        std::nth_element(logits_id.begin(), logits_id.begin() + (k - 1), logits_id.end(), greater);
+        std::sort(logits_id.begin(), logits_id.begin() + k, greater);
+
+        for (int i = 0; i < k; ++i) {
+            // suppressed tokens are not candidates
+            if (logits_id[i].first == -INFINITY) {
+                break;
+            }
+            push(logits_id[i].second);
+        }
+
+        return result;
+    }
+
     std::discrete_distribution<> dist(probs.begin(), probs.end());
 
     for (int i = 0; i < k; ++i) {
         const auto id = dist(decoder.rng);
         //printf("XXX %d %d %f %f %f %f\n", id, tid, probs[id], logprobs[id], pt, ptsum);
 
-        result.push_back({ id, tid, probs[id], logprobs[id], pt, ptsum, -1, -1, 0.0f, });
-
-        if (result[i].id >= vocab.token_beg) {
-            result[i].tid = result[i].id;
-            result[i].pt  = result[i].p;
-        }
+        push(id);
     }
 
     return result;
 }
 
 // ref: https://github.com/openai/whisper/blob/0b1ba3d46ebf7fe6f953acfd8cad62a4f851b49f/whisper/decoding.py#L178-L192
+#define WHISPER_REPETITION_MAX_NGRAM 16
+
+// length of the shortest n-gram that ends the sequence n_repeat times in a row, 0 if there is none
+static int whisper_sequence_repetition(const whisper_sequence & sequence, int n_repeat) {
+    const auto & tokens = sequence.tokens;
+    const int n_tokens = tokens.size();
+
+    for (int n = 1; n <= WHISPER_REPETITION_MAX_NGRAM && n*n_repeat <= n_tokens; ++n) {
+        bool repeated = true;
+        for (int k = n_tokens - n*n_repeat; k < n_tokens - n && repeated; ++k) {
+            repeated = tokens[k].id == tokens[k + n].id;
+        }
+        if (repeated) {
+            return n;
+        }
+    }
+
+    return 0;
+}
+
 static void whisper_sequence_score(
         const struct whisper_full_params & params,
         whisper_sequence & sequence) {
@@ -5019,6 +6450,91 @@ static void whisper_sequence_score(
     }
 }
 
+// the number of tokens whose logits the decoder computes with text_logits_only: every token after
+// EOT is a special, language or timestamp token, and these are all suppressed without timestamps
+static int whisper_n_vocab_logits(const whisper_context & ctx, const whisper_full_params & params) {
+    if (params.text_logits_only && params.no_timestamps && !params.tdrz_enable) {
+        return ctx.vocab.token_eot + 1;
+    }
+    return 0;
+}
+
+// [EXPERIMENTAL] speculative decoding
+// proposes up to n_draft tokens that follow the sequence of the decoder, using greedy sampling with the
+// draft model. draft_past holds the tokens after the prompt that are in the draft KV cache, so that only
+// the tokens the draft has not seen yet are decoded.
+static bool whisper_draft_propose(
+        struct whisper_context & dctx,
+        struct whisper_state   & dstate,
+        const struct whisper_decoder & decoder,
+        const struct whisper_full_params & dparams,
+        int   n_prompt,
+        int   n_draft,
+        int   n_threads,
+        std::vector<whisper_token> & draft_past,
+        std::vector<whisper_token> & draft) {
+    const auto & tokens = decoder.sequence.tokens;
+
+    draft.clear();
+
+    size_t n_common = 0;
+    while (n_common < draft_past.size() && n_common < tokens.size() && draft_past[n_common] == tokens[n_common].id) {
+        n_common++;
+    }
+    // the logits of the last token are needed, so it is decoded even if the draft has seen it
+    n_common = std::min(n_common, tokens.size() - 1);
+
+    whisper_kv_cache_seq_rm(dstate.kv_self, 0, n_prompt + n_common, -1);
+    draft_past.resize(n_common);
+
+    auto & batch = dstate.batch;
+
+    whisper_batch_prep_legacy(batch, nullptr, tokens.size() - n_common, n_prompt + n_common, 0);
+    for (size_t i = n_common; i < tokens.size(); ++i) {
+        batch.token[i - n_common] = tokens[i].id;
+        draft_past.push_back(tokens[i].id);
+    }
+
+    if (!whisper_decode_internal(dctx, dstate, batch, n_threads, nullptr, nullptr, whisper_n_vocab_logits(dctx, dparams))) {
+        return false;
+    }
+
+    auto & ddecoder = dstate.decoders[0];
+
+    ddecoder.sequence   = decoder.sequence;
+    ddecoder.grammar    = {};
+    ddecoder.i_batch    = batch.n_tokens - 1;
+    ddecoder.seek_delta = decoder.seek_delta;
+    ddecoder.has_ts     = decoder.has_ts;
+
+    while (true) {
+        whisper_process_logits(dctx, dstate, ddecoder, dparams, 0.0f);
+
+        const auto token = whisper_sample_token(dctx, ddecoder, true);
+        draft.push_back(token.id);
+
+        if (token.id == whisper_token_eot(&dctx) || (int) draft.size() >= n_draft) {
+            break;
+        }
+
+        if (token.id > whisper_token_beg(&dctx)) {
+            ddecoder.seek_delta = 2*(token.id - whisper_token_beg(&dctx));
+            ddecoder.has_ts     = true;
+        }
+        ddecoder.sequence.tokens.push_back(token);
+
+        whisper_batch_prep_legacy(batch, &token.id, 1, n_prompt + draft_past.size(), 0);
+        draft_past.push_back(token.id);
+
+        if (!whisper_decode_internal(dctx, dstate, batch, n_threads, nullptr, nullptr, whisper_n_vocab_logits(dctx, dparams))) {
+            return false;
+        }
+        ddecoder.i_batch = 0;
+    }
+
+    return true;
+}
+
 int whisper_full_with_state(
         struct whisper_context * ctx,
         struct whisper_state * state,
@@ -5028,6 +6544,13 @@ int whisper_full_with_state(
 
     state->lang_id = -1;
 
+    if (params.suppress_non_speech_tokens) {
+        state->non_speech_ids = whisper_non_speech_token_ids(ctx->vocab);
+    }
+
+    const int n_threads_decoder = params.n_threads_decoder > 0 ? params.n_threads_decoder : params.n_threads;
+    const int n_vocab_logits    = whisper_n_vocab_logits(*ctx, params);
+
     TIME_START(clearing)
     // clear old results
     auto & result_all = state->result_all;
@@ -5040,9 +6563,10 @@ int whisper_full_with_state(
     if (n_samples > 0) {
         // compute log mel spectrogram
         if (params.speed_up) {
-            // TODO: Replace PV with more advanced algorithm
-            WHISPER_LOG_ERROR("%s: failed to compute log mel spectrogram\n", __func__);
-            return -1;
+            if (whisper_pcm_to_mel_wsola_with_state(ctx, state, samples, n_samples, params.n_threads) != 0) {
+                WHISPER_LOG_ERROR("%s: failed to compute log mel spectrogram\n", __func__);
+                return -1;
+            }
         } else {
             if (whisper_pcm_to_mel_with_state(ctx, state, samples, n_samples, params.n_threads) != 0) {
                 WHISPER_LOG_ERROR("%s: failed to compute log mel spectrogram\n", __func__);
@@ -5059,14 +6583,59 @@ int whisper_full_with_state(
     }
     state->exp_n_audio_ctx = params.audio_ctx;
 
+    // [EXPERIMENTAL] speculative decoding: the draft model encodes the same audio
+    struct whisper_context * draft_ctx = params.draft_ctx;
+    if (draft_ctx) {
+        if (params.strategy != WHISPER_SAMPLING_GREEDY || params.n_draft <= 0 || n_samples <= 0 || !draft_ctx->state ||
+            draft_ctx->vocab.n_vocab != ctx->vocab.n_vocab || draft_ctx->model.hparams.n_mels != ctx->model.hparams.n_mels ||
+            params.audio_ctx > whisper_n_audio_ctx(draft_ctx)) {
+            WHISPER_LOG_WARN("%s: the draft model cannot be used with this model or these parameters\n", __func__);
+            draft_ctx = nullptr;
+        } else {
+            const int ret = params.speed_up
+                ? whisper_pcm_to_mel_wsola_with_state(draft_ctx, draft_ctx->state, samples, n_samples, params.n_threads)
+                : whisper_pcm_to_mel_with_state(draft_ctx, draft_ctx->state, samples, n_samples, params.n_threads);
+            if (ret != 0) {
+                WHISPER_LOG_ERROR("%s: failed to compute log mel spectrogram of the draft model\n", __func__);
+                return -2;
+            }
+            draft_ctx->state->exp_n_audio_ctx = params.audio_ctx;
+            if (params.suppress_non_speech_tokens) {
+                draft_ctx->state->non_speech_ids = whisper_non_speech_token_ids(draft_ctx->vocab);
+            }
+        }
+    }
+
+    // a memory budget may have shortened the self-attention context of either state
+    const int n_text_ctx = draft_ctx ? std::min(state->n_text_ctx, draft_ctx->state->n_text_ctx) : state->n_text_ctx;
+
     bool encoding_required = true;
     TIME_START(detect_lang)
     // auto-detect language if not specified
     if (params.language == nullptr || strlen(params.language) == 0 || strcmp(params.language, "auto") == 0 || params.detect_language) {
         std::vector<float> probs(whisper_lang_max_id() + 1, 0.0f);
 
-        const auto lang_id = whisper_lang_auto_detect_with_state(ctx, state, 0, params.n_threads, probs.data(), params.allowed_langs, params.allowed_langs_size);
-        encoding_required = false;
+        int lang_id = -1;
+
+        // the encoding of the start of the audio is cheaper than the whole one, which is then only done
+        // once the language is known
+        const int n_audio_ctx = params.audio_ctx > 0 ? params.audio_ctx : whisper_n_audio_ctx(ctx);
+        const int n_lang_ctx  = (params.lang_detect_ms + 19)/20;
+        if (params.lang_detect_ms > 0 && n_lang_ctx < n_audio_ctx) {
+            state->exp_n_audio_ctx = n_lang_ctx;
+            lang_id = whisper_lang_auto_detect_with_state(ctx, state, 0, params.n_threads, probs.data(), params.allowed_langs, params.allowed_langs_size);
+            state->exp_n_audio_ctx = params.audio_ctx;
+
+            if (lang_id >= 0 && probs[lang_id] < params.lang_detect_thold) {
+                WHISPER_LOG_INFO("%s: language %s of the first %d ms is uncertain (p = %f)\n", __func__, whisper_lang_str(lang_id), params.lang_detect_ms, probs[lang_id]);
+                lang_id = -1;
+            }
+        }
+
+        if (lang_id < 0) {
+            lang_id = whisper_lang_auto_detect_with_state(ctx, state, 0, params.n_threads, probs.data(), params.allowed_langs, params.allowed_langs_size);
+            encoding_required = false;
+        }
         if (lang_id < 0) {
             WHISPER_LOG_ERROR("%s: failed to auto-detect language\n", __func__);
             return -3;
@@ -5220,7 +6789,7 @@ int whisper_full_with_state(
     int seek = seek_start;
 
     std::vector<whisper_token> prompt;
-    prompt.reserve(whisper_n_text_ctx(ctx));
+    prompt.reserve(n_text_ctx);
 
     struct beam_candidate {
         int decoder_idx;
@@ -5247,8 +6816,8 @@ int whisper_full_with_state(
                     ctx, state, progress_cur, params.progress_callback_user_data);
         }
 
-        // of only 1 second left, then stop
-        if (seek + 100 >= seek_end) {
+        // of only 1 second left, then stop (the spectrogram covers twice the time with speed_up)
+        if (seek + (params.speed_up ? 50 : 100) >= seek_end) {
             break;
         }
 
@@ -5268,6 +6837,14 @@ int whisper_full_with_state(
             }
         }
 
+        if (draft_ctx) {
+            if (!whisper_encode_internal(*draft_ctx, *draft_ctx->state, seek, params.n_threads,
+                                         params.abort_callback, params.abort_callback_user_data)) {
+                WHISPER_LOG_ERROR("%s: failed to encode with the draft model\n", __func__);
+                return -6;
+            }
+        }
+
         // if there is a very short audio segment left to process, we remove any past prompt since it tends
         // to confuse the decoder and often make it repeat or hallucinate stuff
         if (seek > seek_start && seek + 500 >= seek_end) {
@@ -5337,7 +6914,7 @@ int whisper_full_with_state(
 
                 // if we have already generated some text, use it as a prompt to condition the next generation
                 if (!prompt_past.empty() && t_cur < 0.5f && params.n_max_text_ctx > 0) {
-                    int n_take = std::min(std::min(params.n_max_text_ctx, whisper_n_text_ctx(ctx)/2), int(prompt_past.size()));
+                    int n_take = std::min(std::min(params.n_max_text_ctx, n_text_ctx/2), int(prompt_past.size()));
 
                     prompt = { whisper_token_prev(ctx) };
                     prompt.insert(prompt.begin() + 1, prompt_past.end() - n_take, prompt_past.end());
@@ -5357,7 +6934,7 @@ int whisper_full_with_state(
 
                 whisper_batch_prep_legacy(state->batch, prompt.data(), prompt.size(), 0, 0);
 
-                if (!whisper_decode_internal(*ctx, *state, state->batch, params.n_threads, params.abort_callback, params.abort_callback_user_data)) {
+                if (!whisper_decode_internal(*ctx, *state, state->batch, n_threads_decoder, params.abort_callback, params.abort_callback_user_data, n_vocab_logits)) {
                     WHISPER_LOG_ERROR("%s: failed to decode\n", __func__);
                     return -7;
                 }
@@ -5383,7 +6960,34 @@ int whisper_full_with_state(
                 }
             }
 
-            for (int i = 0, n_max = whisper_n_text_ctx(ctx)/2 - 4; i < n_max; ++i) {
+            // [EXPERIMENTAL] speculative decoding
+            // the draft tokens are decoded together with the last sampled token, and each time the sampled
+            // token matches the next draft token, the logits that follow it are already there
+            const bool speculative = draft_ctx && n_decoders_cur == 1 && t_cur < 1e-6f;
+
+            whisper_full_params dparams = params;
+            std::vector<whisper_token> draft_past;
+            std::vector<whisper_token> draft;
+            int i_draft = 0;
+
+            if (speculative) {
+                dparams.logits_filter_callback = nullptr;
+                dparams.grammar_rules          = nullptr;
+                dparams.n_grammar_rules        = 0;
+
+                auto & dstate = *draft_ctx->state;
+
+                whisper_kv_cache_clear(dstate.kv_self);
+
+                whisper_batch_prep_legacy(dstate.batch, prompt.data(), prompt.size(), 0, 0);
+
+                if (!whisper_decode_internal(*draft_ctx, dstate, dstate.batch, n_threads_decoder, params.abort_callback, params.abort_callback_user_data, n_vocab_logits)) {
+                    WHISPER_LOG_ERROR("%s: failed to decode with the draft model\n", __func__);
+                    return -7;
+                }
+            }
+
+            for (int i = 0, n_max = n_text_ctx/2 - 4; i < n_max; ++i) {
                 const int64_t t_start_sample_us = ggml_time_us();
 
                 if (params.strategy == whisper_sampling_strategy::WHISPER_SAMPLING_BEAM_SEARCH) {
@@ -5428,7 +7032,7 @@ int whisper_full_with_state(
                                 } break;
                                 case whisper_sampling_strategy::WHISPER_SAMPLING_BEAM_SEARCH:
                                 {
-                                    const auto tokens_new = whisper_sample_token_topk(*ctx, decoder, params.beam_search.beam_size);
+                                    const auto tokens_new = whisper_sample_token_topk(*ctx, decoder, params.beam_search.beam_size, t_cur < 1e-6f);
 
                                     for (const auto & token : tokens_new) {
                                         bc_per_dec[j].push_back({ j, decoder.seek_delta, decoder.has_ts, decoder.sequence, decoder.grammar, });
@@ -5584,6 +7188,41 @@ int whisper_full_with_state(
                         }
 #endif
 
+                        // early end of segment, the sequence is cut to n_keep tokens
+                        if (token.id != whisper_token_eot(ctx)) {
+                            int n_keep = 0;
+
+                            if (params.eot_thold > 0.0f && params.strategy == WHISPER_SAMPLING_GREEDY &&
+                                decoder.probs[whisper_token_eot(ctx)] > params.eot_thold) {
+                                n_keep = i;
+                            } else if (params.repetition_thold > 1) {
+                                const int n = whisper_sequence_repetition(decoder.sequence, params.repetition_thold);
+                                if (n > 0) {
+                                    n_keep = i + 1 - n*(params.repetition_thold - 1);
+                                }
+                            }
+                            if (n_keep == 0 && params.max_tokens_per_s > 0.0f &&
+                                i + 1 >= 8 + params.max_tokens_per_s*std::min(seek_end - seek, 100*WHISPER_CHUNK_SIZE)/100.0f) {
+                                n_keep = i + 1;
+                            }
+
+                            if (n_keep > 0) {
+                                WHISPER_PRINT_DEBUG("%s: decoder %d: early end of segment at %d tokens, keeping %d\n", __func__, j, i + 1, n_keep);
+
+                                if (!has_ts || params.single_segment) {
+                                    result_len = n_keep;
+                                } else {
+                                    result_len = std::min(result_len, n_keep);
+                                }
+                                if (params.single_segment || result_len == 0) {
+                                    seek_delta = 100*WHISPER_CHUNK_SIZE;
+                                }
+
+                                completed = true;
+                                continue;
+                            }
+                        }
+
                         // end of segment
                         if (token.id == whisper_token_eot(ctx) ||               // end of text token
                             (params.max_tokens > 0 && i >= params.max_tokens) || // max tokens per segment reached
@@ -5659,7 +7298,50 @@ int whisper_full_with_state(
                 state->t_sample_us += ggml_time_us() - t_start_sample_us;
 
                 // obtain logits for the next token
-                {
+                if (speculative) {
+                    auto & decoder = state->decoders[0];
+
+                    const int n_past = prompt.size() + i;
+
+                    if (i_draft < (int) draft.size() && decoder.sequence.tokens.back().id == draft[i_draft]) {
+                        decoder.i_batch = ++i_draft;
+                    } else {
+                        // drop the rejected draft tokens and verify new ones
+                        whisper_kv_cache_seq_rm(state->kv_self, 0, n_past, -1);
+
+                        draft.clear();
+                        i_draft = 0;
+
+                        const int n_draft = std::min(params.n_draft, n_text_ctx - 1 - n_past);
+                        if (n_draft > 0 && !whisper_draft_propose(*draft_ctx, *draft_ctx->state, decoder, dparams,
+                                                                  prompt.size(), n_draft, n_threads_decoder, draft_past, draft)) {
+                            WHISPER_LOG_ERROR("%s: failed to decode with the draft model\n", __func__);
+                            return -8;
+                        }
+
+                        auto & batch = state->batch;
+
+                        whisper_batch_prep_legacy(batch, nullptr, draft.size() + 1, n_past, 0);
+                        batch.token[0] = decoder.sequence.tokens.back().id;
+                        for (int j = 0; j < (int) draft.size(); ++j) {
+                            batch.token [j + 1] = draft[j];
+                            batch.logits[j]     = 1;
+                        }
+
+                        if (!whisper_decode_internal(*ctx, *state, batch, n_threads_decoder, params.abort_callback, params.abort_callback_user_data, n_vocab_logits)) {
+                            WHISPER_LOG_ERROR("%s: failed to decode\n", __func__);
+                            return -8;
+                        }
+
+                        decoder.i_batch = 0;
+                    }
+
+                    const int64_t t_start_sample_us = ggml_time_us();
+
+                    whisper_process_logits(*ctx, *state, decoder, params, t_cur);
+
+                    state->t_sample_us += ggml_time_us() - t_start_sample_us;
+                } else {
                     auto & batch = state->batch;
 
                     batch.n_tokens = 0;
@@ -5687,7 +7369,7 @@ int whisper_full_with_state(
 
                     assert(batch.n_tokens > 0);
 
-                    if (!whisper_decode_internal(*ctx, *state, state->batch, params.n_threads, params.abort_callback, params.abort_callback_user_data)) {
+                    if (!whisper_decode_internal(*ctx, *state, state->batch, n_threads_decoder, params.abort_callback, params.abort_callback_user_data, n_vocab_logits)) {
                         WHISPER_LOG_ERROR("%s: failed to decode\n", __func__);
                         return -8;
                     }
@@ -5716,7 +7398,9 @@ int whisper_full_with_state(
                             }
                         };
 
-                        const int n_threads = 1;// std::min(params.n_threads, n_decoders_cur);
+                        // no callback is called here, so the beams are processed in parallel unless
+                        // the logits filter callback has to be called from this thread
+                        const int n_threads = params.logits_filter_callback ? 1 : std::min(params.n_threads, n_decoders_cur);
 
                         if (n_threads == 1) {
                             process();
@@ -6431,6 +8115,182 @@ WHISPER_API const char * whisper_bench_ggml_mul_mat_str(int n_threads) {
     return s.c_str();
 }
 
+struct whisper_bench_params whisper_bench_default_params(void) {
+    struct whisper_bench_params result = {
+        /*.n_threads =*/ 4,
+        /*.audio_ms  =*/ 5000,
+        /*.audio_ctx =*/ 0,
+        /*.n_decode  =*/ 32,
+        /*.n_runs    =*/ 3,
+    };
+    return result;
+}
+
+// low level noise, so that the encoder and the sampler see no degenerate input
+static std::vector<float> whisper_bench_pcm(int audio_ms) {
+    std::vector<float> pcm((size_t) audio_ms*WHISPER_SAMPLE_RATE/1000);
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> dist(-0.01f, 0.01f);
+    for (auto & v : pcm) {
+        v = dist(rng);
+    }
+
+    return pcm;
+}
+
+// keeps the decoder going until max_tokens, however the synthetic audio is transcribed
+static void whisper_bench_suppress_eot(
+        struct whisper_context * ctx,
+        struct whisper_state * /*state*/,
+        const whisper_token_data * /*tokens*/,
+        int /*n_tokens*/,
+        float * logits,
+        void * /*user_data*/) {
+    logits[whisper_token_eot(ctx)] = -INFINITY;
+}
+
+WHISPER_API const char * whisper_bench_model_str(struct whisper_context * ctx, struct whisper_bench_params params) {
+    static std::string s;
+    s = "";
+    char strbuf[512];
+
+    const int n_decode_max = whisper_n_text_ctx(ctx)/2 - 4;
+
+    if (params.n_threads < 1 || params.n_runs < 1 || params.n_decode < 1 || params.n_decode > n_decode_max ||
+        params.audio_ms < 100 || params.audio_ms > 1000*WHISPER_CHUNK_SIZE ||
+        params.audio_ctx < 0 || params.audio_ctx > whisper_n_audio_ctx(ctx)) {
+        snprintf(strbuf, sizeof(strbuf), "{\"error\":\"invalid parameters (n_decode at most %d)\"}", n_decode_max);
+        s = strbuf;
+        return s.c_str();
+    }
+
+    const std::vector<float> pcm = whisper_bench_pcm(params.audio_ms);
+
+    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    wparams.n_threads        = params.n_threads;
+    wparams.print_progress   = false;
+    wparams.print_realtime   = false;
+    wparams.print_timestamps = false;
+    wparams.no_context       = true;
+    wparams.no_timestamps    = true;
+    wparams.single_segment   = true;
+    wparams.max_tokens       = params.n_decode;
+    wparams.audio_ctx        = params.audio_ctx;
+    wparams.language         = "en";
+    wparams.suppress_blank   = false;
+    wparams.temperature_inc  = 0.0f;
+    wparams.logits_filter_callback = whisper_bench_suppress_eot;
+
+    snprintf(strbuf, sizeof(strbuf),
+             "{\"system_info\":\"%s\",\"model_type\":\"%s\",\"ftype\":%d,"
+             "\"n_threads\":%d,\"audio_ms\":%d,\"audio_ctx\":%d,\"n_decode\":%d,\"load_ms\":%.2f,\"runs\":[",
+             whisper_print_system_info(), whisper_model_type_readable(ctx), whisper_model_ftype(ctx),
+             params.n_threads, params.audio_ms, params.audio_ctx, params.n_decode,
+             whisper_get_timings(ctx).load_ms);
+    s += strbuf;
+
+    // the warm-up run faults in the weights and builds the graphs
+    if (whisper_full(ctx, wparams, pcm.data(), (int) pcm.size()) != 0) {
+        s = "{\"error\":\"whisper_full failed\"}";
+        return s.c_str();
+    }
+
+    for (int i = 0; i < params.n_runs; ++i) {
+        whisper_reset_timings(ctx);
+
+        const int64_t t_start_us = ggml_time_us();
+        if (whisper_full(ctx, wparams, pcm.data(), (int) pcm.size()) != 0) {
+            s = "{\"error\":\"whisper_full failed\"}";
+            return s.c_str();
+        }
+        const int64_t t_end_us = ggml_time_us();
+
+        const whisper_timings t = whisper_get_timings(ctx);
+
+        snprintf(strbuf, sizeof(strbuf),
+                 "%s{\"total_ms\":%.2f,\"mel_ms\":%.2f,\"encode_ms\":%.2f,\"prompt_ms\":%.2f,\"decode_ms\":%.2f,"
+                 "\"batchd_ms\":%.2f,\"sample_ms\":%.2f,\"n_encode\":%d,\"n_prompt\":%d,\"n_decode\":%d,"
+                 "\"n_batchd\":%d,\"n_sample\":%d}",
+                 i > 0 ? "," : "", 1e-3*(t_end_us - t_start_us), t.mel_ms, t.encode_ms, t.prompt_ms, t.decode_ms,
+                 t.batchd_ms, t.sample_ms, t.n_encode, t.n_prompt, t.n_decode, t.n_batchd, t.n_sample);
+        s += strbuf;
+    }
+
+    s += "]}";
+
+    return s.c_str();
+}
+
+WHISPER_API const char * whisper_bench_accuracy_str(struct whisper_context * ctx, struct whisper_context * ctx_ref, struct whisper_bench_params params) {
+    static std::string s;
+    char strbuf[256];
+
+    if (params.n_threads < 1 || params.audio_ms < 100 || params.audio_ms > 1000*WHISPER_CHUNK_SIZE ||
+        params.audio_ctx < 0 || params.audio_ctx > whisper_n_audio_ctx(ctx) ||
+        ctx->state == nullptr || ctx_ref->state == nullptr || whisper_n_vocab(ctx) != whisper_n_vocab(ctx_ref) ||
+        whisper_n_audio_ctx(ctx) != whisper_n_audio_ctx(ctx_ref)) {
+        s = "{\"error\":\"invalid parameters or different models\"}";
+        return s.c_str();
+    }
+
+    const std::vector<float> pcm = whisper_bench_pcm(params.audio_ms);
+
+    const int n_vocab = whisper_n_vocab(ctx);
+
+    // the logits of the first token after the prompt, which depend on the whole encoder output
+    std::vector<float> logits[2];
+    for (int i = 0; i < 2; ++i) {
+        whisper_context * cur = i == 0 ? ctx : ctx_ref;
+
+        const whisper_token prompt[] = {
+            whisper_token_sot(cur),
+            whisper_token_lang(cur, whisper_lang_id("en")),
+            whisper_token_transcribe(cur),
+            whisper_token_not(cur),
+        };
+        const int n_prompt = whisper_is_multilingual(cur) ? 4 : 1;
+
+        cur->state->exp_n_audio_ctx = params.audio_ctx;
+
+        if (whisper_pcm_to_mel(cur, pcm.data(), (int) pcm.size(), params.n_threads) != 0 ||
+            whisper_encode(cur, 0, params.n_threads) != 0 ||
+            whisper_decode(cur, prompt, n_prompt, 0, params.n_threads) != 0) {
+            s = "{\"error\":\"whisper_decode failed\"}";
+            return s.c_str();
+        }
+
+        const float * last = whisper_get_logits(cur) + (n_prompt - 1)*n_vocab;
+        logits[i].assign(last, last + n_vocab);
+    }
+
+    double max_diff = 0.0;
+    double sum_diff2 = 0.0;
+    int n_finite = 0;
+    int best = 0;
+    int best_ref = 0;
+    for (int j = 0; j < n_vocab; ++j) {
+        if (logits[0][j] > logits[0][best]) {
+            best = j;
+        }
+        if (logits[1][j] > logits[1][best_ref]) {
+            best_ref = j;
+        }
+        if (std::isfinite(logits[0][j]) && std::isfinite(logits[1][j])) {
+            const double diff = std::fabs(logits[0][j] - logits[1][j]);
+            max_diff   = std::max(max_diff, diff);
+            sum_diff2 += diff*diff;
+            n_finite++;
+        }
+    }
+
+    snprintf(strbuf, sizeof(strbuf), "{\"max_logit_diff\":%.4f,\"rms_logit_diff\":%.4f,\"best_token_agrees\":%s}",
+             max_diff, n_finite > 0 ? std::sqrt(sum_diff2/n_finite) : 0.0, best == best_ref ? "true" : "false");
+    s = strbuf;
+
+    return s.c_str();
+}
+
 // =================================================================================================
 
 // =================================================================================================
@@ -86,6 +86,19 @@ typedef int32_t whisper_seq_id;
 
 struct whisper_context_params {
     bool  use_gpu;
+    bool  use_mmap; // use the weights in place: a model file is mapped instead of read, and a model
+                    // buffer has to stay valid until the context is freed
+
+    enum ggml_type type_k; // type of the attention key caches: F16, or Q8_0 / Q4_0 to cut the
+                           // memory read by every decoder step (the value caches stay F16)
+    bool  flash_attn;      // use flash attention in the encoder self-attention, which does not store the
+                           // n_audio_ctx x n_audio_ctx attention matrices
+    size_t mem_budget;     // bytes a state should fit into (KV caches and compute buffers), 0 for no limit:
+                           // the compute buffers are only held while their stage runs and the self-attention
+                           // context is shortened until the state fits, see whisper_get_mem_stats
+    enum ggml_type encoder_wtype; // type the encoder weight matrices of an F16 / F32 model are quantized to
+                                  // while loading, e.g. Q8_0 for integer dot products against the activations
+                                  // that the encoder matmuls quantize once each; GGML_TYPE_COUNT keeps them
 };
 
 typedef struct whisper_token_data {
@@ -111,6 +124,10 @@ typedef struct whisper_model_loader {
     size_t (*read)(void * ctx, void * output, size_t read_size);
     bool    (*eof)(void * ctx);
     void  (*close)(void * ctx);
+
+    // optional: returns the address of the next read_size bytes and skips them, or NULL if they have
+    // to be read. The bytes have to stay valid until the context is freed.
+    const void * (*map)(void * ctx, size_t read_size);
 } whisper_model_loader;
 
 // grammar element type
@@ -207,6 +224,28 @@ WHISPER_API void whisper_free_state(struct whisper_state * state);
 WHISPER_API void whisper_free_params(struct whisper_full_params * params);
 WHISPER_API void whisper_free_context_params(struct whisper_context_params * params);
 
+// Progress of a model conversion, from 0 to 1. Returning false cancels it.
+typedef bool (*whisper_quantize_progress_callback)(float progress, void * user_data);
+
+// Write a copy of a model with F32 or F16 weights whose weight matrices are quantized to ftype, e.g.
+// GGML_FTYPE_MOSTLY_Q8_0. The convolutions, positional embeddings, norms and biases keep their types.
+// The output file is removed again if the conversion fails or is cancelled.
+// Returns 0 on success
+WHISPER_API int whisper_model_quantize(
+        const char * path_model,
+        const char * path_out,
+        enum ggml_ftype ftype,
+        whisper_quantize_progress_callback progress_callback,
+        void * progress_callback_user_data);
+
+WHISPER_API int whisper_model_quantize_from_buffer(
+        const void * buffer,
+        size_t buffer_size,
+        const char * path_out,
+        enum ggml_ftype ftype,
+        whisper_quantize_progress_callback progress_callback,
+        void * progress_callback_user_data);
+
 // Convert RAW PCM audio to log mel spectrogram.
 // The resulting spectrogram is stored inside the default state of the provided whisper context.
 // Returns 0 on success
@@ -239,6 +278,23 @@ WHISPER_API int whisper_pcm_to_mel_phase_vocoder_with_state(
         int   n_samples,
         int   n_threads);
 
+// Convert RAW PCM audio to log mel spectrogram but applies WSOLA to speed up the audio x2.
+// Unlike the Phase Vocoder, WSOLA keeps the pitch and the phase of the speech intact.
+// The resulting spectrogram is stored inside the default state of the provided whisper context.
+// Returns 0 on success
+WHISPER_API int whisper_pcm_to_mel_wsola(
+        struct whisper_context * ctx,
+        const float * samples,
+        int   n_samples,
+        int   n_threads);
+
+WHISPER_API int whisper_pcm_to_mel_wsola_with_state(
+        struct whisper_context * ctx,
+        struct whisper_state * state,
+        const float * samples,
+        int   n_samples,
+        int   n_threads);
+
 // This can be used to set a custom log mel spectrogram inside the default state of the provided whisper context.
 // Use this instead of whisper_pcm_to_mel() if you want to provide your own log mel spectrogram.
 // n_mel must be 80
@@ -256,6 +312,46 @@ WHISPER_API int whisper_set_mel_with_state(
         int   n_len,
         int   n_mel);
 
+// Log mel spectrogram of a stream of samples that only grows, computed frame by frame as the samples arrive.
+// whisper_set_mel_from_stream() then sets the log mel spectrogram of the samples from any offset on, as
+// whisper_pcm_to_mel() would compute it, without computing the frames again.
+struct whisper_mel_stream;
+
+WHISPER_API struct whisper_mel_stream * whisper_mel_stream_init(struct whisper_context * ctx);
+WHISPER_API void whisper_mel_stream_free(struct whisper_mel_stream * stream);
+
+// Forgets the samples of the stream and releases its frames
+WHISPER_API void whisper_mel_stream_clear(struct whisper_mel_stream * stream);
+
+// Computes the frames of the samples added since the last call, samples are all the samples of the stream
+// Returns 0 on success
+WHISPER_API int whisper_mel_stream_update(
+        struct whisper_context * ctx,
+        struct whisper_mel_stream * stream,
+        const float * samples,
+        int   n_samples,
+        int   n_threads);
+
+// Sets the log mel spectrogram of samples + offset multiplied by scale, the stream has to be updated to
+// n_samples first. offset has to be a multiple of WHISPER_HOP_LENGTH.
+// Returns 0 on success
+WHISPER_API int whisper_set_mel_from_stream(
+        struct whisper_context * ctx,
+        const struct whisper_mel_stream * stream,
+        const float * samples,
+        int   n_samples,
+        int   offset,
+        float scale);
+
+WHISPER_API int whisper_set_mel_from_stream_with_state(
+        struct whisper_context * ctx,
+        struct whisper_state * state,
+        const struct whisper_mel_stream * stream,
+        const float * samples,
+        int   n_samples,
+        int   offset,
+        float scale);
+
 // Run the Whisper encoder on the log mel spectrogram stored inside the default state in the provided whisper context.
 // Make sure to call whisper_pcm_to_mel() or whisper_set_mel() first.
 // offset can be used to specify the offset of the first frame in the spectrogram.
@@ -386,6 +482,57 @@ WHISPER_API whisper_token whisper_token_transcribe(struct whisper_context * ctx)
 WHISPER_API void whisper_print_timings(struct whisper_context * ctx);
 WHISPER_API void whisper_reset_timings(struct whisper_context * ctx);
 
+// Time spent in each stage since the last reset, in milliseconds, with the number of runs
+typedef struct whisper_timings {
+    float load_ms;
+    float mel_ms;
+    float sample_ms;
+    float encode_ms;
+    float decode_ms;   // single token decoder runs
+    float batchd_ms;   // decoder runs over several tokens
+    float prompt_ms;   // decoder runs over the prompt
+    int   n_sample;
+    int   n_encode;
+    int   n_decode;
+    int   n_batchd;
+    int   n_prompt;
+} whisper_timings;
+
+WHISPER_API struct whisper_timings whisper_get_timings           (struct whisper_context * ctx);
+WHISPER_API struct whisper_timings whisper_get_timings_from_state(struct whisper_state * state);
+
+// Memory held by a state, in bytes
+typedef struct whisper_mem_stats {
+    size_t kv_self;        // self-attention KV cache
+    size_t kv_cross;       // cross-attention KV cache
+    size_t compute_conv;   // compute buffers of the stages, including their graph metadata
+    size_t compute_encode;
+    size_t compute_cross;
+    size_t compute_decode;
+    size_t current;        // KV caches and compute buffers held right now
+    size_t peak;           // the most held at once since the state was created
+    int    n_text_ctx;     // self-attention context of a decoder, the model's unless the budget reduced it
+} whisper_mem_stats;
+
+WHISPER_API struct whisper_mem_stats whisper_get_mem_stats           (struct whisper_context * ctx);
+WHISPER_API struct whisper_mem_stats whisper_get_mem_stats_from_state(struct whisper_state * state);
+
+// Frees the compute buffers of the default state, and its KV caches if release_kv_cache is set. They are
+// allocated again by the next encode or decode. Must not be called while the state is used, or between
+// the encode and the decodes of the same audio when the KV caches are released.
+// Returns the number of bytes freed
+WHISPER_API size_t whisper_trim_memory(struct whisper_context * ctx, bool release_kv_cache);
+
+// Advises the kernel that the weights are not going to be used for a while, so that their pages are
+// reclaimed before other memory (MADV_COLD). The pages of a file the context has mapped itself with use_mmap
+// are dropped instead on kernels without MADV_COLD; they stay in the page cache until it is reclaimed.
+// Returns the number of bytes advised
+WHISPER_API size_t whisper_advise_weights_cold(struct whisper_context * ctx);
+
+// Starts reading the weights used in place from a mapping in the background (MADV_WILLNEED), so that the
+// next encode after whisper_advise_weights_cold does not fault them in one page at a time
+WHISPER_API void whisper_prefetch_weights(struct whisper_context * ctx);
+
 // Print system information
 WHISPER_API const char * whisper_print_system_info(void);
 
@@ -436,6 +583,7 @@ struct whisper_full_params {
     enum whisper_sampling_strategy strategy;
 
     int n_threads;
+    int n_threads_decoder;  // threads for the decoder, 0 to use n_threads (the decoder graphs are small, fewer threads can be faster)
     int n_max_text_ctx;     // max tokens to use from past text as prompt for the decoder
     int offset_ms;          // start offset in ms
     int duration_ms;        // audio duration to process in ms
@@ -459,13 +607,20 @@ struct whisper_full_params {
 
     // [EXPERIMENTAL] speed-up techniques
     // note: these can significantly reduce the quality of the output
-    bool speed_up;          // speed-up the audio by 2x using Phase Vocoder
+    bool speed_up;          // speed-up the audio by 2x using WSOLA
     bool debug_mode;        // enable debug_mode provides extra info (eg. Dump log_mel)
     int  audio_ctx;         // overwrite the audio context size (0 = use default)
+    bool text_logits_only;  // compute the logits of the text tokens and EOT only, needs no_timestamps
 
     // [EXPERIMENTAL] [TDRZ] tinydiarize
     bool tdrz_enable;       // enable tinydiarize speaker turn detection
 
+    // [EXPERIMENTAL] speculative decoding, used for greedy decoding at temperature 0
+    // a smaller model with the same vocabulary proposes up to n_draft tokens, which are then verified
+    // with a single batched decode of this model; the draft model uses its default state
+    struct whisper_context * draft_ctx;
+    int n_draft;
+
     // tokens to provide to the whisper decoder as initial prompt
     // these are prepended to any existing text context from a previous call
     const char * initial_prompt;
@@ -479,6 +634,12 @@ struct whisper_full_params {
     const int * allowed_langs;
     size_t allowed_langs_size;
 
+    // [EXPERIMENTAL] when > 0, the language is detected on an encoding of only the first lang_detect_ms
+    // of the audio, which the audio is then transcribed in; if the detected language has a probability
+    // below lang_detect_thold, it is detected again on the encoding of the whole audio
+    int   lang_detect_ms;
+    float lang_detect_thold;
+
     // common decoding parameters:
     bool suppress_blank;    // ref: https://github.com/openai/whisper/blob/f82bc59f5ea234d4b97fb2860842ed38519f7e65/whisper/decoding.py#L89
     bool suppress_non_speech_tokens; // ref: https://github.com/openai/whisper/blob/7858aa9c08d98f75575035ecd6481f462d66ca27/whisper/tokenizer.py#L224-L253
@@ -487,6 +648,11 @@ struct whisper_full_params {
     float max_initial_ts;   // ref: https://github.com/openai/whisper/blob/f82bc59f5ea234d4b97fb2860842ed38519f7e65/whisper/decoding.py#L97
     float length_penalty;   // ref: https://github.com/openai/whisper/blob/f82bc59f5ea234d4b97fb2860842ed38519f7e65/whisper/transcribe.py#L267
 
+    // early end of a segment, to bound the decoder steps spent on hallucinations (0 = disabled)
+    float eot_thold;        // [greedy] end when the probability of EOT exceeds this, even if another token was sampled
+    int   repetition_thold; // end when the last tokens are an n-gram (n <= 16) repeated this many times, keeping one copy
+    float max_tokens_per_s; // end after 8 + max_tokens_per_s tokens per second of the segment's audio
+
     // fallback parameters
     // ref: https://github.com/openai/whisper/blob/f82bc59f5ea234d4b97fb2860842ed38519f7e65/whisper/transcribe.py#L274-L278
     float temperature_inc;
@@ -622,6 +788,25 @@ WHISPER_API const char * whisper_bench_memcpy_str      (int n_threads);
 WHISPER_API int          whisper_bench_ggml_mul_mat    (int n_threads);
 WHISPER_API const char * whisper_bench_ggml_mul_mat_str(int n_threads);
 
+// Times the default state on synthetic audio: one untimed warm-up run, then n_runs runs of whisper_full
+// that encode the audio and make n_decode decoder steps each (the end of text token is suppressed).
+// Returns a JSON object with the whisper_timings of every run, or with an "error" member.
+struct whisper_bench_params {
+    int n_threads;
+    int audio_ms;  // length of the synthetic audio, at most 30 s
+    int audio_ctx; // encoder context, 0 for the full 1500
+    int n_decode;  // decoder steps per run, at most half the text context
+    int n_runs;
+};
+
+WHISPER_API struct whisper_bench_params whisper_bench_default_params(void);
+WHISPER_API const char * whisper_bench_model_str(struct whisper_context * ctx, struct whisper_bench_params params);
+
+// Compares the logits after the prompt of ctx with the ones of ctx_ref, a context of the same model loaded
+// with other parameters (e.g. without encoder_wtype), on the synthetic audio of whisper_bench_model_str.
+// Returns the JSON of the largest and the RMS logit difference and whether the best tokens agree.
+WHISPER_API const char * whisper_bench_accuracy_str(struct whisper_context * ctx, struct whisper_context * ctx_ref, struct whisper_bench_params params);
+
 // Control logging output; default behavior is to print to stderr
 
 WHISPER_API void whisper_log_set(ggml_log_callback log_callback, void * user_data);
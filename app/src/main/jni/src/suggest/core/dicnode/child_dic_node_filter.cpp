@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "suggest/core/dicnode/child_dic_node_filter.h"
+
+#include <algorithm>
+
+#include "suggest/core/dictionary/digraph_utils.h"
+#include "utils/char_utils.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LATINIME_USE_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LATINIME_USE_SSE2
+#endif
+
+namespace latinime {
+
+const int ChildDicNodeFilter::MAX_CODE_POINT_COUNT = CODE_POINT_BUFFER_SIZE;
+
+ChildDicNodeFilter::ChildDicNodeFilter(const int *const codePoints, const int codePointCount,
+        const DigraphUtils::DigraphType digraphType)
+        : mDigraphType(digraphType), mCodePoints() {
+    const int count = std::min(codePointCount, MAX_CODE_POINT_COUNT);
+    std::copy(codePoints, codePoints + count, mCodePoints);
+    std::fill(mCodePoints + count, mCodePoints + CODE_POINT_BUFFER_SIZE, NOT_A_CODE_POINT);
+}
+
+bool ChildDicNodeFilter::accepts(const int codePoint) const {
+    const int baseLowerCodePoint = CharUtils::toBaseLowerCase(codePoint);
+#if defined(LATINIME_USE_NEON)
+    const int32x4_t codePointV = vdupq_n_s32(codePoint);
+    const int32x4_t baseLowerCodePointV = vdupq_n_s32(baseLowerCodePoint);
+    uint32x4_t matched = vdupq_n_u32(0);
+    for (int i = 0; i < CODE_POINT_BUFFER_SIZE; i += 4) {
+        const int32x4_t codePointsV = vld1q_s32(mCodePoints + i);
+        matched = vorrq_u32(matched, vorrq_u32(vceqq_s32(codePointsV, codePointV),
+                vceqq_s32(codePointsV, baseLowerCodePointV)));
+    }
+    const uint32x2_t matchedHalf = vorr_u32(vget_low_u32(matched), vget_high_u32(matched));
+    if ((vget_lane_u32(matchedHalf, 0) | vget_lane_u32(matchedHalf, 1)) != 0) {
+        return true;
+    }
+#elif defined(LATINIME_USE_SSE2)
+    const __m128i codePointV = _mm_set1_epi32(codePoint);
+    const __m128i baseLowerCodePointV = _mm_set1_epi32(baseLowerCodePoint);
+    __m128i matched = _mm_setzero_si128();
+    for (int i = 0; i < CODE_POINT_BUFFER_SIZE; i += 4) {
+        const __m128i codePointsV =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(mCodePoints + i));
+        matched = _mm_or_si128(matched, _mm_or_si128(_mm_cmpeq_epi32(codePointsV, codePointV),
+                _mm_cmpeq_epi32(codePointsV, baseLowerCodePointV)));
+    }
+    if (_mm_movemask_epi8(matched) != 0) {
+        return true;
+    }
+#else
+    for (int i = 0; i < CODE_POINT_BUFFER_SIZE; ++i) {
+        if (mCodePoints[i] == codePoint || mCodePoints[i] == baseLowerCodePoint) {
+            return true;
+        }
+    }
+#endif
+    return CharUtils::isIntentionalOmissionCodePoint(codePoint)
+            || DigraphUtils::hasDigraphForCodePoint(mDigraphType, codePoint);
+}
+
+} // namespace latinime
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef LATINIME_CHILD_DIC_NODE_FILTER_H
+#define LATINIME_CHILD_DIC_NODE_FILTER_H
+
+#include "defines.h"
+#include "suggest/core/dictionary/digraph_utils.h"
+
+namespace latinime {
+
+// Filters the child DicNodes by their first code point before they are created. A child passes
+// when the code point or its base lower case is one of the given code points, or when the child
+// can be handled before the proximity check in Suggest, i.e. as an intentional omission or a
+// digraph. The code point comparison uses NEON or SSE2 when available.
+class ChildDicNodeFilter {
+ public:
+    // codePointCount can be up to MAX_CODE_POINT_COUNT.
+    ChildDicNodeFilter(const int *const codePoints, const int codePointCount,
+            const DigraphUtils::DigraphType digraphType);
+
+    bool accepts(const int codePoint) const;
+
+    static const int MAX_CODE_POINT_COUNT;
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(ChildDicNodeFilter);
+
+    // A multiple of 4, padded with NOT_A_CODE_POINT.
+    static const int CODE_POINT_BUFFER_SIZE = 20;
+
+    const DigraphUtils::DigraphType mDigraphType;
+    int mCodePoints[CODE_POINT_BUFFER_SIZE];
+};
+} // namespace latinime
+#endif // LATINIME_CHILD_DIC_NODE_FILTER_H
@@ -17,6 +17,9 @@
 #ifndef LATINIME_DIC_NODE_H
 #define LATINIME_DIC_NODE_H
 
+#include <algorithm>
+#include <cstdint>
+
 #include "defines.h"
 #include "suggest/core/dicnode/dic_node_profiler.h"
 #include "suggest/core/dicnode/dic_node_utils.h"
@@ -31,19 +34,22 @@
 #if DEBUG_DICT
 #define LOGI_SHOW_ADD_COST_PROP \
         do { \
+            int codePointBuf[MAX_WORD_LENGTH]; \
+            mDicNodeState.mDicNodeStateOutput.outputCodePoints(getNodeCodePointCount(), \
+                    codePointBuf); \
             char charBuf[50]; \
-            INTS_TO_CHARS(getOutputWordBuf(), getNodeCodePointCount(), charBuf, NELEMS(charBuf)); \
+            INTS_TO_CHARS(codePointBuf, getNodeCodePointCount(), charBuf, NELEMS(charBuf)); \
             AKLOGI("%20s, \"%c\", size = %03d, total = %03d, index(0) = %02d, dist = %.4f, %s,,", \
                     __FUNCTION__, getNodeCodePoint(), inputSize, getTotalInputIndex(), \
                     getInputIndex(0), getNormalizedCompoundDistance(), charBuf); \
         } while (0)
 #define DUMP_WORD_AND_SCORE(header) \
         do { \
+            int codePointBuf[MAX_WORD_LENGTH]; \
+            mDicNodeState.mDicNodeStateOutput.outputCodePoints(getTotalNodeCodePointCount(), \
+                    codePointBuf); \
             char charBuf[50]; \
-            INTS_TO_CHARS(getOutputWordBuf(), \
-                    getNodeCodePointCount() \
-                            + mDicNodeState.mDicNodeStateOutput.getPrevWordsLength(), \
-                    charBuf, NELEMS(charBuf)); \
+            INTS_TO_CHARS(codePointBuf, getTotalNodeCodePointCount(), charBuf, NELEMS(charBuf)); \
             AKLOGI("#%8s, %5f, %5f, %5f, %5f, %s, %d, %5f,", header, \
                     getSpatialDistanceForScoring(), \
                     mDicNodeState.mDicNodeStateScoring.getLanguageDistance(), \
@@ -135,14 +141,17 @@ class DicNode {
         PROF_NODE_COPY(&parentDicNode->mProfiler, mProfiler);
     }
 
+    // maxTerminalProbability bounds the unigram probability of the words at and below the PtNode.
     void initAsChild(const DicNode *const dicNode, const int childrenPtNodeArrayPos,
-            const int wordId, const CodePointArrayView mergedCodePoints) {
+            const int wordId, const CodePointArrayView mergedCodePoints,
+            const int maxTerminalProbability = MAX_PROBABILITY) {
         uint16_t newDepth = static_cast<uint16_t>(dicNode->getNodeCodePointCount() + 1);
         mIsCachedForNextSuggestion = dicNode->mIsCachedForNextSuggestion;
         const uint16_t newLeavingDepth = static_cast<uint16_t>(
                 dicNode->mDicNodeProperties.getLeavingDepth() + mergedCodePoints.size());
         mDicNodeProperties.init(childrenPtNodeArrayPos, mergedCodePoints[0],
-                wordId, newDepth, newLeavingDepth, dicNode->mDicNodeProperties.getPrevWordIds());
+                wordId, newDepth, newLeavingDepth, maxTerminalProbability,
+                dicNode->mDicNodeProperties.getPrevWordIds());
         mDicNodeState.init(&dicNode->mDicNodeState, mergedCodePoints.size(),
                 mergedCodePoints.data());
         PROF_NODE_COPY(&dicNode->mProfiler, mProfiler);
@@ -206,6 +215,11 @@ class DicNode {
         return mDicNodeProperties.getPrevWordIds();
     }
 
+    // Used to prune the DicNodes that can't reach a word that is probable enough.
+    int getMaxTerminalProbability() const {
+        return mDicNodeProperties.getMaxTerminalProbability();
+    }
+
     // Used in DicNodeUtils
     int getChildrenPtNodeArrayPos() const {
         return mDicNodeProperties.getChildrenPtNodeArrayPos();
@@ -240,8 +254,13 @@ class DicNode {
         return getTotalNodeCodePointCount() > MAX_WORD_LENGTH - 3;
     }
 
+    // Writes the first codePointCount code points of the output, previous words included.
+    void outputCodePoints(const int codePointCount, int *const dest) const {
+        mDicNodeState.mDicNodeStateOutput.outputCodePoints(codePointCount, dest);
+    }
+
     void outputResult(int *dest) const {
-        memmove(dest, getOutputWordBuf(), getTotalNodeCodePointCount() * sizeof(dest[0]));
+        outputCodePoints(getTotalNodeCodePointCount(), dest);
         DUMP_WORD_AND_SCORE("OUTPUT");
     }
 
@@ -253,7 +272,7 @@ class DicNode {
         if (!hasMultipleWords()) {
             return 0;
         }
-        return CharUtils::getSpaceCount(mDicNodeState.mDicNodeStateOutput.getCodePointBuf(),
+        return mDicNodeState.mDicNodeStateOutput.getSpaceCount(
                 mDicNodeState.mDicNodeStateOutput.getPrevWordsLength());
     }
 
@@ -300,10 +319,6 @@ class DicNode {
                 weightOfLangModelVsSpatialModel);
     }
 
-    AK_FORCE_INLINE const int *getOutputWordBuf() const {
-        return mDicNodeState.mDicNodeStateOutput.getCodePointBuf();
-    }
-
     int getPrevCodePointG(int pointerId) const {
         return mDicNodeState.mDicNodeStateInput.getPrevCodePoint(pointerId);
     }
@@ -444,6 +459,83 @@ class DicNode {
         return this > right;
     }
 
+    // Whether the DicNode can be recombined with other DicNodes, see isEquivalentTo(). Multiple
+    // word DicNodes also depend on how the input was split into words, so they are not.
+    bool isRecombinable() const {
+        return !hasMultipleWords();
+    }
+
+    // Returns the same value for equivalent DicNodes.
+    AK_FORCE_INLINE uint32_t getRecombinationHash() const {
+        uint32_t hash = static_cast<uint32_t>(mDicNodeProperties.getChildrenPtNodeArrayPos());
+        hash = hash * 31 + static_cast<uint32_t>(mDicNodeProperties.getWordId());
+        hash = hash * 31 + getNodeCodePointCount();
+        for (int i = 0; i < MAX_POINTER_COUNT_G; ++i) {
+            hash = hash * 31 + static_cast<uint32_t>(getInputIndex(i));
+        }
+        hash = hash * 31 + static_cast<uint32_t>(getContainedErrorTypes());
+        return hash;
+    }
+
+    // Whether the DicNodes are at the same position of the trie and of the input in the same
+    // correction state, so that they only differ in the costs so far. Such DicNodes get the same
+    // children with the same additional costs, hence only the one that is not more costly than
+    // the other has to be expanded. Both must be recombinable.
+    bool isEquivalentTo(const DicNode *const right) const {
+        if (mDicNodeProperties.getChildrenPtNodeArrayPos()
+                        != right->mDicNodeProperties.getChildrenPtNodeArrayPos()
+                || mDicNodeProperties.getWordId() != right->mDicNodeProperties.getWordId()
+                || getNodeCodePointCount() != right->getNodeCodePointCount()
+                || mDicNodeProperties.getLeavingDepth()
+                        != right->mDicNodeProperties.getLeavingDepth()
+                || getContainedErrorTypes() != right->getContainedErrorTypes()) {
+            return false;
+        }
+        const DicNodeStateInput &input = mDicNodeState.mDicNodeStateInput;
+        const DicNodeStateInput &rightInput = right->mDicNodeState.mDicNodeStateInput;
+        for (int i = 0; i < MAX_POINTER_COUNT_G; ++i) {
+            if (input.getInputIndex(i) != rightInput.getInputIndex(i)
+                    || input.getPrevCodePoint(i) != rightInput.getPrevCodePoint(i)
+                    || input.getTerminalDiffCost(i) != rightInput.getTerminalDiffCost(i)) {
+                return false;
+            }
+        }
+        const DicNodeStateScoring &scoring = mDicNodeState.mDicNodeStateScoring;
+        const DicNodeStateScoring &rightScoring = right->mDicNodeState.mDicNodeStateScoring;
+        if (scoring.getEditCorrectionCount() != rightScoring.getEditCorrectionCount()
+                || scoring.getProximityCorrectionCount()
+                        != rightScoring.getProximityCorrectionCount()
+                || scoring.getCompletionCount() != rightScoring.getCompletionCount()
+                || scoring.getDoubleLetterLevel() != rightScoring.getDoubleLetterLevel()
+                || scoring.getDigraphIndex() != rightScoring.getDigraphIndex()) {
+            return false;
+        }
+        const WordIdArrayView prevWordIds = getPrevWordIds();
+        const WordIdArrayView rightPrevWordIds = right->getPrevWordIds();
+        if (prevWordIds.size() != rightPrevWordIds.size()
+                || !std::equal(prevWordIds.begin(), prevWordIds.end(), rightPrevWordIds.begin())) {
+            return false;
+        }
+        // Including the code points of the PtNode that are yet to be passed.
+        for (int i = 0; i < mDicNodeProperties.getLeavingDepth(); ++i) {
+            if (mDicNodeState.mDicNodeStateOutput.getCurrentWordCodePointAt(i)
+                    != right->mDicNodeState.mDicNodeStateOutput.getCurrentWordCodePointAt(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Whether no cost of the DicNode is higher than the one of the equivalent right DicNode, so
+    // that the right DicNode can't lead to a better suggestion.
+    bool isNotMoreCostlyThan(const DicNode *const right) const {
+        const DicNodeStateScoring &scoring = mDicNodeState.mDicNodeStateScoring;
+        const DicNodeStateScoring &rightScoring = right->mDicNodeState.mDicNodeStateScoring;
+        return scoring.getSpatialDistance() <= rightScoring.getSpatialDistance()
+                && scoring.getLanguageDistance() <= rightScoring.getLanguageDistance()
+                && scoring.getRawLength() <= rightScoring.getRawLength();
+    }
+
  private:
     DicNodeProperties mDicNodeProperties;
     DicNodeState mDicNodeState;
@@ -17,56 +17,98 @@
 #ifndef LATINIME_DIC_NODE_POOL_H
 #define LATINIME_DIC_NODE_POOL_H
 
-#include <deque>
 #include <unordered_set>
 #include <vector>
 
 #include "defines.h"
 #include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_node_slab_allocator.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 
+// An arena of DicNodes. Instances are handed out by bumping an index into a preallocated buffer
+// and recycled through a free list, so neither getInstance() nor reset() allocates once the buffer
+// is large enough for the requested capacity. The buffer is leased from the process-wide
+// DicNodeSlabAllocator and returned to it by release().
 class DicNodePool {
  public:
-    explicit DicNodePool(const int capacity) : mDicNodes(), mPooledDicNodes() {
+    explicit DicNodePool(const int capacity)
+            : mDicNodes(), mPooledDicNodes(), mCapacity(0), mUsedDicNodeCount(0) {
         reset(capacity);
     }
 
+    ~DicNodePool() {
+        release();
+    }
+
+    // Makes all the instances available again. All instances taken by getInstance() become
+    // invalid.
     void reset(const int capacity) {
-        if (capacity == static_cast<int>(mDicNodes.size())
-                && capacity == static_cast<int>(mPooledDicNodes.size())) {
-            // No need to reset.
-            return;
+        if (capacity > static_cast<int>(mDicNodes.size())) {
+            // The buffer only grows; shrinking would lease another slab every time the capacity
+            // changes between searches.
+            DicNodeSlabAllocator::getInstance()->returnSlab(std::move(mDicNodes));
+            mDicNodes = DicNodeSlabAllocator::getInstance()->leaseSlab(capacity);
+            mPooledDicNodes.reserve(capacity);
         }
-        mDicNodes.resize(capacity);
-        mDicNodes.shrink_to_fit();
+        mCapacity = capacity;
+        mUsedDicNodeCount = 0;
         mPooledDicNodes.clear();
-        for (auto &dicNode : mDicNodes) {
-            mPooledDicNodes.emplace_back(&dicNode);
-        }
+    }
+
+    // Returns the buffer to the DicNodeSlabAllocator. All instances taken by getInstance() become
+    // invalid and no instance is available until the next reset().
+    void release() {
+        DicNodeSlabAllocator::getInstance()->returnSlab(std::move(mDicNodes));
+        mDicNodes.clear();
+        std::vector<DicNode*>().swap(mPooledDicNodes);
+        mCapacity = 0;
+        mUsedDicNodeCount = 0;
     }
 
     // Get a DicNode instance from the pool. The instance has to be returned by returnInstance().
     DicNode *getInstance() {
-        if (mPooledDicNodes.empty()) {
+        if (!mPooledDicNodes.empty()) {
+            DicNode *const dicNode = mPooledDicNodes.back();
+            mPooledDicNodes.pop_back();
+            return dicNode;
+        }
+        if (mUsedDicNodeCount >= mCapacity) {
             return nullptr;
         }
-        DicNode *const dicNode = mPooledDicNodes.back();
-        mPooledDicNodes.pop_back();
-        return dicNode;
+        return &mDicNodes[mUsedDicNodeCount++];
+    }
+
+    int getCapacity() const {
+        return mCapacity;
+    }
+
+    // Returns the index of an instance taken by getInstance(), which is smaller than the capacity.
+    int getIndexOf(const DicNode *const dicNode) const {
+        return static_cast<int>(dicNode - mDicNodes.data());
+    }
+
+    DicNode *getInstanceAt(const int index) {
+        return &mDicNodes[index];
     }
 
     // Return an instance that has been removed from the pool by getInstance() to the pool. The
     // instance must not be used after returning without getInstance().
     void placeBackInstance(DicNode *dicNode) {
-        mPooledDicNodes.emplace_back(dicNode);
+        mPooledDicNodes.push_back(dicNode);
+    }
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mDicNodes);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mPooledDicNodes);
     }
 
     void dump() const {
         AKLOGI("\n\n\n\n\n===========================");
         std::unordered_set<const DicNode*> usedDicNodes;
-        for (const auto &dicNode : mDicNodes) {
-            usedDicNodes.insert(&dicNode);
+        for (int i = 0; i < mUsedDicNodeCount; ++i) {
+            usedDicNodes.insert(&mDicNodes[i]);
         }
         for (const auto &dicNodePtr : mPooledDicNodes) {
             usedDicNodes.erase(dicNodePtr);
@@ -81,7 +123,12 @@ class DicNodePool {
     DISALLOW_IMPLICIT_CONSTRUCTORS(DicNodePool);
 
     std::vector<DicNode> mDicNodes;
-    std::deque<DicNode*> mPooledDicNodes;
+    // Instances that have been placed back. Never exceeds the capacity, so it does not reallocate.
+    std::vector<DicNode*> mPooledDicNodes;
+    int mCapacity;
+    // Instances in mDicNodes before this index have been handed out at least once since the last
+    // reset.
+    int mUsedDicNodeCount;
 };
 } // namespace latinime
 #endif // LATINIME_DIC_NODE_POOL_H
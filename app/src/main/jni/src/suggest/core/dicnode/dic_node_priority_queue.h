@@ -18,7 +18,6 @@
 #define LATINIME_DIC_NODE_PRIORITY_QUEUE_H
 
 #include <algorithm>
-#include <queue>
 #include <vector>
 
 #include "defines.h"
@@ -27,10 +26,18 @@
 
 namespace latinime {
 
+// A bounded priority queue of DicNodes. The nodes are kept in a min-max heap, so both the best
+// and the worst node can be accessed in O(1) and removed in O(log n). When the queue is full, a
+// pushed node replaces the worst one if it is better.
+//
+// Once copyPushRecombining() is used, the nodes are also indexed by DicNode::getRecombinationHash()
+// until the next clear(), so that equivalent nodes can be found. The index is a hash table that is
+// chained through the pool indices of the nodes.
 class DicNodePriorityQueue {
  public:
     AK_FORCE_INLINE explicit DicNodePriorityQueue(const int capacity)
-            : mMaxSize(capacity), mDicNodesQueue(), mDicNodePool(capacity) {
+            : mMaxSize(capacity), mHeap(), mDicNodePool(capacity), mIsRecombining(false),
+              mRecombinationBuckets(), mNextRecombinationIndices(), mRecombinationHashes() {
         clear();
     }
 
@@ -38,13 +45,21 @@ class DicNodePriorityQueue {
     AK_FORCE_INLINE ~DicNodePriorityQueue() {}
 
     AK_FORCE_INLINE int getSize() const {
-        return static_cast<int>(mDicNodesQueue.size());
+        return static_cast<int>(mHeap.size());
     }
 
     AK_FORCE_INLINE int getMaxSize() const {
         return mMaxSize;
     }
 
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mHeap);
+        mDicNodePool.addMemoryUsage(outMemoryUsage);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mRecombinationBuckets);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mNextRecombinationIndices);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mRecombinationHashes);
+    }
+
     AK_FORCE_INLINE void setMaxSize(const int maxSize) {
         mMaxSize = maxSize;
     }
@@ -55,41 +70,96 @@ class DicNodePriorityQueue {
 
     AK_FORCE_INLINE void clearAndResize(const int maxSize) {
         mMaxSize = maxSize;
-        while (!mDicNodesQueue.empty()) {
-            mDicNodesQueue.pop();
-        }
+        mHeap.clear();
+        mHeap.reserve(mMaxSize + 1);
         mDicNodePool.reset(mMaxSize + 1);
+        mIsRecombining = false;
+    }
+
+    // Frees the heap and the pool. The queue can't be pushed to until the next clear() or
+    // clearAndResize().
+    void release() {
+        std::vector<DicNode *>().swap(mHeap);
+        mDicNodePool.release();
+        mIsRecombining = false;
+        std::vector<int>().swap(mRecombinationBuckets);
+        std::vector<int>().swap(mNextRecombinationIndices);
+        std::vector<uint32_t>().swap(mRecombinationHashes);
     }
 
-    AK_FORCE_INLINE void copyPush(const DicNode *const dicNode) {
+    // Empties the queue and returns the DicNodes of the pool to the DicNodeSlabAllocator, keeping
+    // the other buffers. The queue can't be pushed to until the next clear() or clearAndResize().
+    void releaseDicNodes() {
+        mHeap.clear();
+        mDicNodePool.release();
+        mIsRecombining = false;
+    }
+
+    // Returns whether a DicNode had to be dropped, either the given one or the worst one.
+    AK_FORCE_INLINE bool copyPush(const DicNode *const dicNode) {
         DicNode *const pooledDicNode = newDicNode(dicNode);
         if (!pooledDicNode) {
-            return;
+            return true;
         }
         if (getSize() < mMaxSize) {
-            mDicNodesQueue.push(pooledDicNode);
-            return;
+            pushToHeap(pooledDicNode);
+            return false;
         }
-        if (betterThanWorstDicNode(pooledDicNode)) {
-            mDicNodePool.placeBackInstance(mDicNodesQueue.top());
-            mDicNodesQueue.pop();
-            mDicNodesQueue.push(pooledDicNode);
-            return;
+        if (getSize() > 0 && betterThanWorstDicNode(pooledDicNode)) {
+            mDicNodePool.placeBackInstance(removeFromHeap(getWorstIndex()));
+            pushToHeap(pooledDicNode);
+            return true;
         }
         mDicNodePool.placeBackInstance(pooledDicNode);
+        return true;
     }
 
-    AK_FORCE_INLINE void copyPop(DicNode *const dest) {
-        if (mDicNodesQueue.empty()) {
-            ASSERT(false);
-            return;
+    // Same as copyPush(), but the DicNode is first recombined with the equivalent DicNodes in the
+    // queue (see DicNode::isEquivalentTo()): it is dropped when one of them is not more costly,
+    // and the ones that are not less costly are removed. outRecombinedCount is set to the number
+    // of DicNodes dropped that way. All DicNodes in the queue have to be pushed by this method.
+    bool copyPushRecombining(const DicNode *const dicNode, int *const outRecombinedCount) {
+        *outRecombinedCount = 0;
+        if (!mIsRecombining) {
+            startRecombining();
         }
-        DicNode *node = mDicNodesQueue.top();
-        if (dest) {
-            DicNodeUtils::initByCopy(node, dest);
+        if (dicNode->isRecombinable()) {
+            const uint32_t hash = dicNode->getRecombinationHash();
+            int index = mRecombinationBuckets[getRecombinationBucketIndex(hash)];
+            while (index != NOT_AN_INDEX) {
+                DicNode *const queuedDicNode = mDicNodePool.getInstanceAt(index);
+                const int nextIndex = mNextRecombinationIndices[index];
+                if (mRecombinationHashes[index] == hash && queuedDicNode->isEquivalentTo(dicNode)) {
+                    if (queuedDicNode->isNotMoreCostlyThan(dicNode)) {
+                        ++(*outRecombinedCount);
+                        return false;
+                    }
+                    if (dicNode->isNotMoreCostlyThan(queuedDicNode)) {
+                        const int heapIndex = static_cast<int>(
+                                std::find(mHeap.begin(), mHeap.end(), queuedDicNode)
+                                        - mHeap.begin());
+                        mDicNodePool.placeBackInstance(removeFromHeap(heapIndex));
+                        ++(*outRecombinedCount);
+                    }
+                }
+                index = nextIndex;
+            }
         }
-        mDicNodePool.placeBackInstance(node);
-        mDicNodesQueue.pop();
+        return copyPush(dicNode);
+    }
+
+    // Pops the worst DicNode.
+    AK_FORCE_INLINE void copyPop(DicNode *const dest) {
+        copyPopAt(getWorstIndex(), dest);
+    }
+
+    AK_FORCE_INLINE void copyPopBest(DicNode *const dest) {
+        copyPopAt(0 /* index */, dest);
+    }
+
+    // Returns the worst DicNode, or nullptr if the queue is empty.
+    AK_FORCE_INLINE const DicNode *peekWorst() const {
+        return mHeap.empty() ? nullptr : mHeap[getWorstIndex()];
     }
 
     AK_FORCE_INLINE void dump() {
@@ -104,23 +174,83 @@ class DicNodePriorityQueue {
         return left->compare(right);
     }
 
-    struct DicNodeComparator {
-        bool operator ()(const DicNode *left, const DicNode *right) const {
-            return compareDicNode(left, right);
+    // Nodes on even levels of the heap are better than all their descendants and nodes on odd
+    // levels are worse than all their descendants. The root is the best node.
+    AK_FORCE_INLINE static bool isOnBestLevel(const int index) {
+        int level = 0;
+        for (int i = index + 1; i > 1; i >>= 1) {
+            ++level;
         }
-    };
+        return level % 2 == 0;
+    }
+
+    AK_FORCE_INLINE static int getParentIndex(const int index) {
+        return (index - 1) / 2;
+    }
+
+    static const int NOT_INDEXED = -2;
 
-    typedef std::priority_queue<DicNode *, std::vector<DicNode *>, DicNodeComparator> DicNodesQueue;
     int mMaxSize;
-    DicNodesQueue mDicNodesQueue;
+    std::vector<DicNode *> mHeap;
     DicNodePool mDicNodePool;
+    bool mIsRecombining;
+    // The first pool index of each bucket, and for each pool index the next one in the bucket,
+    // NOT_AN_INDEX at the end of the bucket or NOT_INDEXED.
+    std::vector<int> mRecombinationBuckets;
+    std::vector<int> mNextRecombinationIndices;
+    std::vector<uint32_t> mRecombinationHashes;
 
-    AK_FORCE_INLINE bool betterThanWorstDicNode(const DicNode *const dicNode) const {
-        DicNode *worstNode = mDicNodesQueue.top();
-        if (!worstNode) {
-            return true;
+    void startRecombining() {
+        // At least twice as many buckets as nodes.
+        int bucketCount = 1;
+        while (bucketCount < mDicNodePool.getCapacity() * 2) {
+            bucketCount <<= 1;
+        }
+        mRecombinationBuckets.assign(bucketCount, NOT_AN_INDEX);
+        mNextRecombinationIndices.assign(mDicNodePool.getCapacity(),
+                static_cast<int>(NOT_INDEXED) /* not odr-used */);
+        mRecombinationHashes.resize(mDicNodePool.getCapacity());
+        mIsRecombining = true;
+        for (const DicNode *const dicNode : mHeap) {
+            addToRecombinationIndex(dicNode);
+        }
+    }
+
+    AK_FORCE_INLINE int getRecombinationBucketIndex(const uint32_t hash) const {
+        return static_cast<int>((hash ^ (hash >> 16)) & (mRecombinationBuckets.size() - 1));
+    }
+
+    AK_FORCE_INLINE void addToRecombinationIndex(const DicNode *const dicNode) {
+        if (!mIsRecombining || !dicNode->isRecombinable()) {
+            return;
         }
-        return compareDicNode(dicNode, worstNode);
+        const int index = mDicNodePool.getIndexOf(dicNode);
+        const uint32_t hash = dicNode->getRecombinationHash();
+        int *const bucket = &mRecombinationBuckets[getRecombinationBucketIndex(hash)];
+        mRecombinationHashes[index] = hash;
+        mNextRecombinationIndices[index] = *bucket;
+        *bucket = index;
+    }
+
+    AK_FORCE_INLINE void removeFromRecombinationIndex(const DicNode *const dicNode) {
+        if (!mIsRecombining) {
+            return;
+        }
+        const int index = mDicNodePool.getIndexOf(dicNode);
+        if (mNextRecombinationIndices[index] == NOT_INDEXED) {
+            return;
+        }
+        int *link = &mRecombinationBuckets[
+                getRecombinationBucketIndex(mRecombinationHashes[index])];
+        while (*link != index) {
+            link = &mNextRecombinationIndices[*link];
+        }
+        *link = mNextRecombinationIndices[index];
+        mNextRecombinationIndices[index] = NOT_INDEXED;
+    }
+
+    AK_FORCE_INLINE bool betterThanWorstDicNode(const DicNode *const dicNode) const {
+        return compareDicNode(dicNode, mHeap[getWorstIndex()]);
     }
 
     AK_FORCE_INLINE DicNode *newDicNode(const DicNode *const dicNode) {
@@ -130,6 +260,113 @@ class DicNodePriorityQueue {
         }
         return newNode;
     }
+
+    AK_FORCE_INLINE void copyPopAt(const int index, DicNode *const dest) {
+        if (mHeap.empty()) {
+            ASSERT(false);
+            return;
+        }
+        DicNode *const node = removeFromHeap(index);
+        if (dest) {
+            DicNodeUtils::initByCopy(node, dest);
+        }
+        mDicNodePool.placeBackInstance(node);
+    }
+
+    AK_FORCE_INLINE int getWorstIndex() const {
+        const int size = getSize();
+        if (size <= 2) {
+            return size - 1;
+        }
+        return compareDicNode(mHeap[1], mHeap[2]) ? 2 : 1;
+    }
+
+    // Returns whether the node at the index has to be closer to the root than the node at the
+    // other index on a level of the given kind.
+    AK_FORCE_INLINE bool precedes(const int index, const int otherIndex,
+            const bool isBestLevel) const {
+        return isBestLevel ? compareDicNode(mHeap[index], mHeap[otherIndex])
+                : compareDicNode(mHeap[otherIndex], mHeap[index]);
+    }
+
+    void pushToHeap(DicNode *const dicNode) {
+        addToRecombinationIndex(dicNode);
+        mHeap.push_back(dicNode);
+        bubbleUp(getSize() - 1);
+    }
+
+    // Returns whether the node at the index has been moved.
+    bool bubbleUp(int index) {
+        if (index == 0) {
+            return false;
+        }
+        const int originalIndex = index;
+        const int parentIndex = getParentIndex(index);
+        bool isBestLevel = isOnBestLevel(index);
+        // The parent is on a level of the other kind.
+        if (precedes(index, parentIndex, !isBestLevel)) {
+            std::swap(mHeap[index], mHeap[parentIndex]);
+            index = parentIndex;
+            isBestLevel = !isBestLevel;
+        }
+        // Bubble up through the grandparents, which are on a level of the same kind.
+        while (index >= 3) {
+            const int grandparentIndex = getParentIndex(getParentIndex(index));
+            if (!precedes(index, grandparentIndex, isBestLevel)) {
+                break;
+            }
+            std::swap(mHeap[index], mHeap[grandparentIndex]);
+            index = grandparentIndex;
+        }
+        return index != originalIndex;
+    }
+
+    DicNode *removeFromHeap(const int index) {
+        DicNode *const dicNode = mHeap[index];
+        removeFromRecombinationIndex(dicNode);
+        mHeap[index] = mHeap.back();
+        mHeap.pop_back();
+        // The moved node only has to go up when a node other than the best and the worst ones
+        // is removed.
+        if (index < getSize() && !bubbleUp(index)) {
+            trickleDown(index);
+        }
+        return dicNode;
+    }
+
+    void trickleDown(int index) {
+        const int size = getSize();
+        const bool isBestLevel = isOnBestLevel(index);
+        while (true) {
+            const int firstChildIndex = index * 2 + 1;
+            if (firstChildIndex >= size) {
+                return;
+            }
+            // Find the most preceding node among the children and the grandchildren.
+            int targetIndex = firstChildIndex;
+            const int descendantIndices[] = { firstChildIndex + 1, firstChildIndex * 2 + 1,
+                    firstChildIndex * 2 + 2, firstChildIndex * 2 + 3, firstChildIndex * 2 + 4 };
+            for (const int descendantIndex : descendantIndices) {
+                if (descendantIndex < size && precedes(descendantIndex, targetIndex, isBestLevel)) {
+                    targetIndex = descendantIndex;
+                }
+            }
+            if (!precedes(targetIndex, index, isBestLevel)) {
+                return;
+            }
+            std::swap(mHeap[index], mHeap[targetIndex]);
+            if (targetIndex <= firstChildIndex + 1) {
+                // A child has no descendants of the same level kind below the node.
+                return;
+            }
+            // A grandchild; make sure it is still consistent with its parent.
+            const int parentIndex = getParentIndex(targetIndex);
+            if (precedes(parentIndex, targetIndex, isBestLevel)) {
+                std::swap(mHeap[parentIndex], mHeap[targetIndex]);
+            }
+            index = targetIndex;
+        }
+    }
 };
 } // namespace latinime
 #endif // LATINIME_DIC_NODE_PRIORITY_QUEUE_H
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dicnode/dic_node_slab_allocator.h"
+
+#include "utils/memory_usage.h"
+
+namespace latinime {
+
+// Slabs are rounded up to this many DicNodes, so that the slightly different capacities the
+// queues are reset to share the idle slabs.
+const int DicNodeSlabAllocator::SLAB_GRANULARITY = 64;
+// About the queues of two searches with the large capacity cache, e.g. typing and the spell
+// checker.
+const int DicNodeSlabAllocator::MAX_IDLE_DIC_NODE_COUNT = 2048;
+
+/* static */ DicNodeSlabAllocator *DicNodeSlabAllocator::getInstance() {
+    static DicNodeSlabAllocator sInstance(MAX_IDLE_DIC_NODE_COUNT);
+    return &sInstance;
+}
+
+std::vector<DicNode> DicNodeSlabAllocator::leaseSlab(const int capacity) {
+    const int slabSize = (capacity + SLAB_GRANULARITY - 1) / SLAB_GRANULARITY * SLAB_GRANULARITY;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        int bestIndex = -1;
+        for (int i = 0; i < static_cast<int>(mIdleSlabs.size()); ++i) {
+            const int size = static_cast<int>(mIdleSlabs[i].size());
+            if (size >= slabSize && (bestIndex < 0
+                    || size < static_cast<int>(mIdleSlabs[bestIndex].size()))) {
+                bestIndex = i;
+            }
+        }
+        if (bestIndex >= 0) {
+            std::vector<DicNode> slab(std::move(mIdleSlabs[bestIndex]));
+            mIdleSlabs[bestIndex] = std::move(mIdleSlabs.back());
+            mIdleSlabs.pop_back();
+            mIdleDicNodeCount -= static_cast<int>(slab.size());
+            return slab;
+        }
+    }
+    // Allocate outside the lock; slabs are relatively large.
+    return std::vector<DicNode>(slabSize);
+}
+
+void DicNodeSlabAllocator::returnSlab(std::vector<DicNode> &&slab) {
+    if (slab.empty()) {
+        return;
+    }
+    std::vector<DicNode> freedSlab;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mIdleDicNodeCount + static_cast<int>(slab.size()) <= mMaxIdleDicNodeCount) {
+            mIdleDicNodeCount += static_cast<int>(slab.size());
+            mIdleSlabs.emplace_back(std::move(slab));
+            return;
+        }
+        freedSlab.swap(slab);
+    }
+    // freedSlab is freed outside the lock.
+}
+
+int DicNodeSlabAllocator::getIdleDicNodeCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mIdleDicNodeCount;
+}
+
+void DicNodeSlabAllocator::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mIdleSlabs);
+    for (const auto &slab : mIdleSlabs) {
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, slab);
+    }
+}
+
+void DicNodeSlabAllocator::trimMemory() {
+    std::vector<std::vector<DicNode>> freedSlabs;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        freedSlabs.swap(mIdleSlabs);
+        mIdleDicNodeCount = 0;
+    }
+    // freedSlabs is freed outside the lock.
+}
+
+} // namespace latinime
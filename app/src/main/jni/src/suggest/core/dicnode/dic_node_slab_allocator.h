@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_DIC_NODE_SLAB_ALLOCATOR_H
+#define LATINIME_DIC_NODE_SLAB_ALLOCATOR_H
+
+#include <mutex>
+#include <vector>
+
+#include "defines.h"
+#include "suggest/core/dicnode/dic_node.h"
+
+namespace latinime {
+
+class MemoryUsage;
+
+// The process-wide source of the DicNode buffers of the DicNodePools. A pool leases a slab for
+// the capacity it is reset to and returns it when it is released, so the sessions that are not
+// searching don't hold DicNodes of their own; the DicNodes in use scale with the searches that
+// run at the same time. Each pool leases at most its capacity, which is bounded by the queue
+// capacities of its DicNodesCache, and the slabs that are back are kept up to a total of
+// maxIdleDicNodeCount DicNodes for the next lease.
+class DicNodeSlabAllocator {
+ public:
+    static DicNodeSlabAllocator *getInstance();
+
+    explicit DicNodeSlabAllocator(const int maxIdleDicNodeCount)
+            : mMaxIdleDicNodeCount(maxIdleDicNodeCount), mMutex(), mIdleSlabs(),
+              mIdleDicNodeCount(0) {}
+
+    // Returns a slab of at least capacity DicNodes, the smallest idle one that is large enough
+    // if there is one.
+    std::vector<DicNode> leaseSlab(const int capacity);
+
+    // Takes back a slab returned by leaseSlab(). It is freed when keeping it would exceed the
+    // maximum idle DicNode count.
+    void returnSlab(std::vector<DicNode> &&slab);
+
+    int getIdleDicNodeCount() const;
+
+    // Adds the memory of the idle slabs. The leased ones are counted by their pools.
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+
+    // Frees the idle slabs.
+    void trimMemory();
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(DicNodeSlabAllocator);
+
+    static const int SLAB_GRANULARITY;
+    static const int MAX_IDLE_DIC_NODE_COUNT;
+
+    const int mMaxIdleDicNodeCount;
+    mutable std::mutex mMutex;
+    std::vector<std::vector<DicNode>> mIdleSlabs;
+    int mIdleDicNodeCount;
+};
+} // namespace latinime
+#endif // LATINIME_DIC_NODE_SLAB_ALLOCATOR_H
@@ -19,6 +19,7 @@
 #include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
 #include "suggest/core/dicnode/dic_node.h"
 #include "suggest/core/dicnode/dic_node_vector.h"
+#include "suggest/core/session/dic_traverse_session.h"
 
 namespace latinime {
 
@@ -67,12 +68,12 @@ namespace latinime {
  * Computes the combined bigram / unigram cost for the given dicNode.
  */
 /* static */ float DicNodeUtils::getBigramNodeImprobability(
-        const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
-        const DicNode *const dicNode, MultiBigramMap *const multiBigramMap) {
+        const DicTraverseSession *const traverseSession, const DicNode *const dicNode,
+        MultiBigramMap *const multiBigramMap) {
     if (dicNode->hasMultipleWords() && !dicNode->isValidMultipleWordSuggestion()) {
         return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
     }
-    const WordAttributes wordAttributes = dictionaryStructurePolicy->getWordAttributesInContext(
+    const WordAttributes wordAttributes = traverseSession->getWordAttributesInContext(
             dicNode->getPrevWordIds(), dicNode->getWordId(), multiBigramMap);
     if (wordAttributes.getProbability() == NOT_A_PROBABILITY
             || (dicNode->hasMultipleWords()
@@ -24,6 +24,7 @@ namespace latinime {
 
 class DicNode;
 class DicNodeVector;
+class DicTraverseSession;
 class DictionaryStructureWithBufferPolicy;
 class MultiBigramMap;
 
@@ -39,8 +40,7 @@ class DicNodeUtils {
     static void getAllChildDicNodes(const DicNode *dicNode,
             const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
             DicNodeVector *childDicNodes);
-    static float getBigramNodeImprobability(
-            const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
+    static float getBigramNodeImprobability(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode, MultiBigramMap *const multiBigramMap);
 
  private:
@@ -20,8 +20,10 @@
 #include <vector>
 
 #include "defines.h"
+#include "suggest/core/dicnode/child_dic_node_filter.h"
 #include "suggest/core/dicnode/dic_node.h"
 #include "utils/int_array_view.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 
@@ -33,21 +35,41 @@ class DicNodeVector {
 #else
     static const int DEFAULT_NODES_SIZE_FOR_OPTIMIZATION = 60;
 #endif
-    AK_FORCE_INLINE DicNodeVector() : mDicNodes(), mLock(false) {}
+    AK_FORCE_INLINE DicNodeVector() : mDicNodes(), mLock(false), mLeavingChildFilter(nullptr) {}
 
     // Specify the capacity of the vector
-    AK_FORCE_INLINE DicNodeVector(const int size) : mDicNodes(), mLock(false) {
+    AK_FORCE_INLINE DicNodeVector(const int size)
+            : mDicNodes(), mLock(false), mLeavingChildFilter(nullptr) {
         mDicNodes.reserve(size);
     }
 
     // Non virtual inline destructor -- never inherit this class
     AK_FORCE_INLINE ~DicNodeVector() {}
 
+    AK_FORCE_INLINE void reserve(const int size) {
+        mDicNodes.reserve(size);
+    }
+
     AK_FORCE_INLINE void clear() {
         mDicNodes.clear();
         mLock = false;
     }
 
+    // Same as clear(), and frees the buffer.
+    void release() {
+        std::vector<DicNode>().swap(mDicNodes);
+        mLock = false;
+    }
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mDicNodes);
+    }
+
+    // Leaving children whose first code point is rejected by the filter are not pushed.
+    AK_FORCE_INLINE void setLeavingChildFilter(const ChildDicNodeFilter *const filter) {
+        mLeavingChildFilter = filter;
+    }
+
     int getSizeAndLock() {
         mLock = true;
         return static_cast<int>(mDicNodes.size());
@@ -60,10 +82,15 @@ class DicNodeVector {
     }
 
     void pushLeavingChild(const DicNode *const dicNode, const int childrenPtNodeArrayPos,
-            const int wordId, const CodePointArrayView mergedCodePoints) {
+            const int wordId, const CodePointArrayView mergedCodePoints,
+            const int maxTerminalProbability = MAX_PROBABILITY) {
         ASSERT(!mLock);
+        if (mLeavingChildFilter && !mLeavingChildFilter->accepts(mergedCodePoints[0])) {
+            return;
+        }
         mDicNodes.emplace_back();
-        mDicNodes.back().initAsChild(dicNode, childrenPtNodeArrayPos, wordId, mergedCodePoints);
+        mDicNodes.back().initAsChild(dicNode, childrenPtNodeArrayPos, wordId, mergedCodePoints,
+                maxTerminalProbability);
     }
 
     DicNode *operator[](const int id) {
@@ -80,6 +107,7 @@ class DicNodeVector {
     DISALLOW_COPY_AND_ASSIGN(DicNodeVector);
     std::vector<DicNode> mDicNodes;
     bool mLock;
+    const ChildDicNodeFilter *mLeavingChildFilter;
 };
 } // namespace latinime
 #endif // LATINIME_DIC_NODE_VECTOR_H
@@ -27,5 +27,49 @@ namespace latinime {
 const int DicNodesCache::LARGE_PRIORITY_QUEUE_CAPACITY = 310;
 // Capacity for reducing memory footprint.
 const int DicNodesCache::SMALL_PRIORITY_QUEUE_CAPACITY = 100;
+// The DicNodes of the last input index are expanded without look-ahead correction, and the ones
+// before don't depend on the input size.
+const int DicNodesCache::CACHE_BACK_LENGTH = 1;
+// Snapshots are relatively large (up to LARGE_PRIORITY_QUEUE_CAPACITY DicNodes each). Edits
+// beyond this input index restart the search from the root.
+const int DicNodesCache::MAX_SNAPSHOT_INPUT_INDEX = 12;
+
+bool DicNodesCache::restoreFromSnapshot(const int nextActiveSize, const int terminalSize,
+        const int maxInputIndex) {
+    const int snapshotInputIndex = std::min(maxInputIndex,
+            std::min(mSnapshotInputIndexLimit, MAX_SNAPSHOT_INPUT_INDEX) - 1);
+    // A snapshot of input index 0 only contains the root node.
+    if (snapshotInputIndex <= 0) {
+        return false;
+    }
+    const std::vector<DicNode> &snapshot = mSnapshots[snapshotInputIndex];
+    if (snapshot.empty()) {
+        return false;
+    }
+    if (DEBUG_CACHE) {
+        AKLOGI("Restore %zu nodes from the snapshot. inputIndex = %d.", snapshot.size(),
+                snapshotInputIndex);
+    }
+    mActiveDicNodes->clear();
+    const int nextActiveSizeFittingToTheCapacity = std::min(nextActiveSize, getCacheCapacity());
+    mNextActiveDicNodes->clearAndResize(nextActiveSizeFittingToTheCapacity);
+    mTerminalDicNodes->clearAndResize(terminalSize);
+    mCachedDicNodesForContinuousSuggestion->clear();
+    // The terminals found while expanding the restored input index and after are found again.
+    mTerminalCandidates.erase(std::remove_if(mTerminalCandidates.begin(),
+            mTerminalCandidates.end(), [snapshotInputIndex](const TerminalCandidate &candidate) {
+                return candidate.mInputIndex >= snapshotInputIndex;
+            }), mTerminalCandidates.end());
+    mSearchEffort.reset();
+    for (const DicNode &dicNode : snapshot) {
+        mActiveDicNodes->copyPush(&dicNode);
+    }
+    mInputIndex = snapshotInputIndex;
+    mLastCachedInputIndex = snapshotInputIndex;
+    // Snapshots of later input indices were taken for the previous input.
+    mSnapshotInputIndexLimit = snapshotInputIndex + 1;
+    mIsTakingSnapshot = false;
+    return true;
+}
 
 }  // namespace latinime
@@ -18,14 +18,16 @@
 #define LATINIME_DIC_NODES_CACHE_H
 
 #include <algorithm>
+#include <vector>
 
 #include "defines.h"
+#include "suggest/core/dicnode/dic_node.h"
 #include "suggest/core/dicnode/dic_node_priority_queue.h"
+#include "suggest/core/session/search_effort.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 
-class DicNode;
-
 /**
  * Class for controlling dicNode search priority queue and lexicon trie traversal.
  */
@@ -41,7 +43,8 @@ class DicNodesCache {
               mNextActiveDicNodes(&mDicNodePriorityQueue1),
               mCachedDicNodesForContinuousSuggestion(&mDicNodePriorityQueue2),
               mTerminalDicNodes(&mDicNodePriorityQueueForTerminal),
-              mInputIndex(0), mLastCachedInputIndex(0) {}
+              mInputIndex(0), mLastCachedInputIndex(0), mTerminalCandidates(), mSnapshots(),
+              mSnapshotInputIndexLimit(0), mIsTakingSnapshot(false), mSearchEffort() {}
 
     AK_FORCE_INLINE virtual ~DicNodesCache() {}
 
@@ -56,10 +59,24 @@ class DicNodesCache {
         mTerminalDicNodes->clearAndResize(terminalSize);
         // The size of cached DicNode queue doesn't have to be changed.
         mCachedDicNodesForContinuousSuggestion->clear();
+        mTerminalCandidates.clear();
+        mSnapshotInputIndexLimit = 0;
+        mIsTakingSnapshot = false;
+        mSearchEffort.reset();
     }
 
-    AK_FORCE_INLINE void continueSearch() {
+    // Restarts the search from the snapshot of the active DicNodes taken at the largest input
+    // index that is not greater than maxInputIndex. Returns false when there is no such snapshot;
+    // the caller has to restart the search from the root in that case.
+    bool restoreFromSnapshot(const int nextActiveSize, const int terminalSize,
+            const int maxInputIndex);
+
+    // nextActiveSize replaces the limit of the next active DicNodes given to reset(), so that
+    // each call of the continued search can have its own.
+    AK_FORCE_INLINE void continueSearch(const int nextActiveSize) {
+        mSearchEffort.reset();
         resetTemporaryCaches();
+        mNextActiveDicNodes->clearAndResize(std::min(nextActiveSize, getCacheCapacity()));
         restoreActiveDicNodesFromCache();
     }
 
@@ -86,37 +103,126 @@ class DicNodesCache {
     }
 
     AK_FORCE_INLINE void copyPushTerminal(DicNode *dicNode) {
-        mTerminalDicNodes->copyPush(dicNode);
+        countPush(mTerminalDicNodes->copyPush(dicNode));
+    }
+
+    // Returns the terminal DicNode that has to be beaten to be kept in the full terminal queue,
+    // or nullptr if the queue still has room.
+    const DicNode *getTerminalCutoffDicNode() const {
+        if (mTerminalDicNodes->getSize() < mTerminalDicNodes->getMaxSize()) {
+            return nullptr;
+        }
+        return mTerminalDicNodes->peekWorst();
     }
 
     AK_FORCE_INLINE void copyPushActive(DicNode *dicNode) {
-        mActiveDicNodes->copyPush(dicNode);
+        countPush(mActiveDicNodes->copyPush(dicNode));
+    }
+
+    // Whether the terminals found for the current input index are not found again when the next
+    // search continues from the cache, which is taken at a later input index.
+    AK_FORCE_INLINE bool isBeforeCacheBorderForTyping(const int inputSize) const {
+        return mInputIndex < inputSize - CACHE_BACK_LENGTH;
+    }
+
+    // Keeps a terminal DicNode before the terminal costs are added, so that its terminal can be
+    // recreated for the next input when the search continues from the cache.
+    AK_FORCE_INLINE void copyPushTerminalCandidate(const DicNode *const dicNode) {
+        mTerminalCandidates.push_back({mInputIndex, *dicNode});
+    }
+
+    int getTerminalCandidateCount() const {
+        return static_cast<int>(mTerminalCandidates.size());
+    }
+
+    const DicNode *getTerminalCandidateAt(const int index) const {
+        return &mTerminalCandidates[index].mDicNode;
+    }
+
+    // Drops the terminal candidates for which shouldRemove(dicNode) returns true, keeping the
+    // order of the others.
+    template<typename Predicate>
+    void removeTerminalCandidates(const Predicate &shouldRemove) {
+        mTerminalCandidates.erase(std::remove_if(mTerminalCandidates.begin(),
+                mTerminalCandidates.end(), [&shouldRemove](const TerminalCandidate &candidate) {
+                    return shouldRemove(&candidate.mDicNode);
+                }), mTerminalCandidates.end());
     }
 
     AK_FORCE_INLINE void copyPushContinue(DicNode *dicNode) {
-        mCachedDicNodesForContinuousSuggestion->copyPush(dicNode);
+        mSearchEffort.increment(SearchEffort::CACHED_DIC_NODES_FOR_CONTINUATION);
+        if (mCachedDicNodesForContinuousSuggestion->copyPush(dicNode)) {
+            mSearchEffort.increment(SearchEffort::EVICTED_DIC_NODES);
+        }
     }
 
+    // Equivalent DicNodes are recombined, so that only the least costly ones take the room of
+    // the next active DicNodes.
     AK_FORCE_INLINE void copyPushNextActive(DicNode *dicNode) {
-        mNextActiveDicNodes->copyPush(dicNode);
+        int recombinedCount = 0;
+        countPush(mNextActiveDicNodes->copyPushRecombining(dicNode, &recombinedCount));
+        mSearchEffort.add(SearchEffort::RECOMBINED_DIC_NODES, recombinedCount);
     }
 
+    // Pops the best terminal DicNode.
     void popTerminal(DicNode *dest) {
-        mTerminalDicNodes->copyPop(dest);
+        mTerminalDicNodes->copyPopBest(dest);
     }
 
     void popActive(DicNode *dest) {
+        mSearchEffort.increment(SearchEffort::POPPED_DIC_NODES);
         mActiveDicNodes->copyPop(dest);
     }
 
+    AK_FORCE_INLINE void countExpandedDicNode() {
+        mSearchEffort.increment(SearchEffort::EXPANDED_DIC_NODES);
+    }
+
+    // The effort of the search since the last reset(), restoreFromSnapshot() or continueSearch().
+    const SearchEffort &getSearchEffort() const { return mSearchEffort; }
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        mDicNodePriorityQueue0.addMemoryUsage(outMemoryUsage);
+        mDicNodePriorityQueue1.addMemoryUsage(outMemoryUsage);
+        mDicNodePriorityQueue2.addMemoryUsage(outMemoryUsage);
+        mDicNodePriorityQueueForTerminal.addMemoryUsage(outMemoryUsage);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mTerminalCandidates);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mSnapshots);
+        for (const auto &snapshot : mSnapshots) {
+            outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, snapshot);
+        }
+    }
+
+    // Frees the queues and the snapshots. The cached DicNodes are lost, so the next search has to
+    // start with reset().
+    void release() {
+        mDicNodePriorityQueue0.release();
+        mDicNodePriorityQueue1.release();
+        mDicNodePriorityQueue2.release();
+        mDicNodePriorityQueueForTerminal.release();
+        std::vector<TerminalCandidate>().swap(mTerminalCandidates);
+        std::vector<std::vector<DicNode>>().swap(mSnapshots);
+        mInputIndex = 0;
+        mLastCachedInputIndex = 0;
+        mSnapshotInputIndexLimit = 0;
+        mIsTakingSnapshot = false;
+    }
+
+    // Returns the DicNodes of the queues that are only used during a search to the
+    // DicNodeSlabAllocator. The DicNodes cached for the continuous suggestion and the snapshots
+    // are kept. The queues lease DicNodes again on the next reset() or continueSearch().
+    void releaseSearchQueues() {
+        mActiveDicNodes->releaseDicNodes();
+        mNextActiveDicNodes->releaseDicNodes();
+        mTerminalDicNodes->releaseDicNodes();
+    }
+
     bool hasCachedDicNodesForContinuousSuggestion() const {
         return mCachedDicNodesForContinuousSuggestion
                 && mCachedDicNodesForContinuousSuggestion->getSize() > 0;
     }
 
     AK_FORCE_INLINE bool isCacheBorderForTyping(const int inputSize) const {
-        // TODO: Move this variable to header
-        static const int CACHE_BACK_LENGTH = 3;
         const int cacheInputIndex = inputSize - CACHE_BACK_LENGTH;
         const bool shouldCache = (cacheInputIndex == mInputIndex)
                 && (cacheInputIndex != mLastCachedInputIndex);
@@ -127,9 +233,46 @@ class DicNodesCache {
         mLastCachedInputIndex = mInputIndex;
     }
 
+    // Starts recording the active DicNodes of the current input index. Returns whether the
+    // snapshot is being taken; in that case every popped active DicNode has to be passed to
+    // copyPushSnapshot() and commitSnapshot() has to be called once all of them are expanded.
+    AK_FORCE_INLINE bool startSnapshot() {
+        mIsTakingSnapshot = false;
+        if (mInputIndex >= MAX_SNAPSHOT_INPUT_INDEX || mInputIndex > mSnapshotInputIndexLimit) {
+            return false;
+        }
+        // Snapshots for this index and after are going to be taken again.
+        mSnapshotInputIndexLimit = mInputIndex;
+        if (static_cast<int>(mSnapshots.size()) <= mInputIndex) {
+            mSnapshots.resize(mInputIndex + 1);
+        }
+        mSnapshots[mInputIndex].clear();
+        mIsTakingSnapshot = true;
+        return true;
+    }
+
+    AK_FORCE_INLINE void copyPushSnapshot(const DicNode *const dicNode) {
+        mSnapshots[mInputIndex].emplace_back(*dicNode);
+    }
+
+    AK_FORCE_INLINE void commitSnapshot() {
+        if (mIsTakingSnapshot) {
+            mSnapshotInputIndexLimit = mInputIndex + 1;
+            mIsTakingSnapshot = false;
+        }
+    }
+
+    int getCacheBackLength() const { return CACHE_BACK_LENGTH; }
+
  private:
     DISALLOW_COPY_AND_ASSIGN(DicNodesCache);
 
+    struct TerminalCandidate {
+        // The input index that was being expanded when the candidate was found.
+        int mInputIndex;
+        DicNode mDicNode;
+    };
+
     AK_FORCE_INLINE void restoreActiveDicNodesFromCache() {
         if (DEBUG_DICT) {
             AKLOGI("Restore %d nodes. inputIndex = %d.",
@@ -159,6 +302,13 @@ class DicNodesCache {
                 LARGE_PRIORITY_QUEUE_CAPACITY : SMALL_PRIORITY_QUEUE_CAPACITY;
     }
 
+    AK_FORCE_INLINE void countPush(const bool hasDroppedDicNode) {
+        mSearchEffort.increment(SearchEffort::PUSHED_DIC_NODES);
+        if (hasDroppedDicNode) {
+            mSearchEffort.increment(SearchEffort::EVICTED_DIC_NODES);
+        }
+    }
+
     AK_FORCE_INLINE void resetTemporaryCaches() {
         mActiveDicNodes->clear();
         mNextActiveDicNodes->clear();
@@ -167,6 +317,11 @@ class DicNodesCache {
 
     static const int LARGE_PRIORITY_QUEUE_CAPACITY;
     static const int SMALL_PRIORITY_QUEUE_CAPACITY;
+    // DicNodes are cached this many input points before the end of the input, because the
+    // expansion of the DicNodes close to the end depends on the input size (e.g. look-ahead
+    // correction). The terminals found before are recreated from mTerminalCandidates.
+    static const int CACHE_BACK_LENGTH;
+    static const int MAX_SNAPSHOT_INPUT_INDEX;
 
     const bool mUsesLargeCapacityCache;
     // Instances
@@ -185,6 +340,14 @@ class DicNodesCache {
     DicNodePriorityQueue *mTerminalDicNodes;
     int mInputIndex;
     int mLastCachedInputIndex;
+    // The terminal DicNodes found before the cache border, in the order they were found.
+    std::vector<TerminalCandidate> mTerminalCandidates;
+    // mSnapshots[i] holds the active DicNodes at the time input index i started to be expanded.
+    // Only the snapshots for input indices smaller than mSnapshotInputIndexLimit are valid.
+    std::vector<std::vector<DicNode>> mSnapshots;
+    int mSnapshotInputIndexLimit;
+    bool mIsTakingSnapshot;
+    SearchEffort mSearchEffort;
 };
 } // namespace latinime
 #endif // LATINIME_DIC_NODES_CACHE_H
@@ -32,18 +32,21 @@ class DicNodeProperties {
  public:
     AK_FORCE_INLINE DicNodeProperties()
             : mChildrenPtNodeArrayPos(NOT_A_DICT_POS), mDicNodeCodePoint(NOT_A_CODE_POINT),
-              mWordId(NOT_A_WORD_ID), mDepth(0), mLeavingDepth(0), mPrevWordCount(0) {}
+              mWordId(NOT_A_WORD_ID), mDepth(0), mLeavingDepth(0),
+              mMaxTerminalProbability(MAX_PROBABILITY), mPrevWordCount(0) {}
 
     ~DicNodeProperties() {}
 
     // Should be called only once per DicNode is initialized.
     void init(const int childrenPos, const int nodeCodePoint, const int wordId,
-            const uint16_t depth, const uint16_t leavingDepth, const WordIdArrayView prevWordIds) {
+            const uint16_t depth, const uint16_t leavingDepth, const int maxTerminalProbability,
+            const WordIdArrayView prevWordIds) {
         mChildrenPtNodeArrayPos = childrenPos;
         mDicNodeCodePoint = nodeCodePoint;
         mWordId = wordId;
         mDepth = depth;
         mLeavingDepth = leavingDepth;
+        mMaxTerminalProbability = static_cast<uint8_t>(maxTerminalProbability);
         prevWordIds.copyToArray(&mPrevWordIds, 0 /* offset */);
         mPrevWordCount = prevWordIds.size();
     }
@@ -55,6 +58,7 @@ class DicNodeProperties {
         mWordId = NOT_A_WORD_ID;
         mDepth = 0;
         mLeavingDepth = 0;
+        mMaxTerminalProbability = MAX_PROBABILITY;
         prevWordIds.copyToArray(&mPrevWordIds, 0 /* offset */);
         mPrevWordCount = prevWordIds.size();
     }
@@ -65,6 +69,7 @@ class DicNodeProperties {
         mWordId = dicNodeProp->mWordId;
         mDepth = dicNodeProp->mDepth;
         mLeavingDepth = dicNodeProp->mLeavingDepth;
+        mMaxTerminalProbability = dicNodeProp->mMaxTerminalProbability;
         const WordIdArrayView prevWordIdArrayView = dicNodeProp->getPrevWordIds();
         prevWordIdArrayView.copyToArray(&mPrevWordIds, 0 /* offset */);
         mPrevWordCount = prevWordIdArrayView.size();
@@ -77,6 +82,7 @@ class DicNodeProperties {
         mWordId = dicNodeProp->mWordId;
         mDepth = dicNodeProp->mDepth + 1; // Increment the depth of a passing child
         mLeavingDepth = dicNodeProp->mLeavingDepth;
+        mMaxTerminalProbability = dicNodeProp->mMaxTerminalProbability;
         const WordIdArrayView prevWordIdArrayView = dicNodeProp->getPrevWordIds();
         prevWordIdArrayView.copyToArray(&mPrevWordIds, 0 /* offset */);
         mPrevWordCount = prevWordIdArrayView.size();
@@ -99,6 +105,12 @@ class DicNodeProperties {
         return mLeavingDepth;
     }
 
+    // An upper bound of the unigram probability of the words at and below the PtNode, or
+    // MAX_PROBABILITY when the dictionary doesn't know one.
+    int getMaxTerminalProbability() const {
+        return mMaxTerminalProbability;
+    }
+
     bool isTerminal() const {
         return mWordId != NOT_A_WORD_ID;
     }
@@ -125,6 +137,8 @@ class DicNodeProperties {
     uint16_t mDepth;
     uint16_t mLeavingDepth;
     WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> mPrevWordIds;
+    // Fits into the padding before mPrevWordCount.
+    uint8_t mMaxTerminalProbability;
     size_t mPrevWordCount;
 };
 } // namespace latinime
@@ -26,12 +26,15 @@ namespace latinime {
 
 class DicNodeState {
  public:
+    // The input and scoring states are read by every priority queue comparison and traversal
+    // step, so they are laid out before the output state whose code point buffer is only needed
+    // to break ties and to output suggestions.
     DicNodeStateInput mDicNodeStateInput;
-    DicNodeStateOutput mDicNodeStateOutput;
     DicNodeStateScoring mDicNodeStateScoring;
+    DicNodeStateOutput mDicNodeStateOutput;
 
     AK_FORCE_INLINE DicNodeState()
-            : mDicNodeStateInput(), mDicNodeStateOutput(), mDicNodeStateScoring() {}
+            : mDicNodeStateInput(), mDicNodeStateScoring(), mDicNodeStateOutput() {}
 
     ~DicNodeState() {}
 
@@ -41,7 +44,7 @@ class DicNodeState {
     }
 
     DicNodeState(const DicNodeState& src)
-            : mDicNodeStateInput(), mDicNodeStateOutput(), mDicNodeStateScoring() {
+            : mDicNodeStateInput(), mDicNodeStateScoring(), mDicNodeStateOutput() {
         initByCopy(&src);
     }
 
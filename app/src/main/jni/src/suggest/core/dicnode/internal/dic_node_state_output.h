@@ -19,7 +19,7 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <cstring> // for memmove()
+#include <cstring> // for memmove() and memset()
 
 #include "defines.h"
 
@@ -31,7 +31,8 @@ class DicNodeStateOutput {
  public:
     DicNodeStateOutput()
             : mOutputtedCodePointCount(0), mCurrentWordStart(0), mPrevWordCount(0),
-              mPrevWordsLength(0), mPrevWordStart(0), mSecondWordFirstInputIndex(NOT_AN_INDEX) {}
+              mPrevWordsLength(0), mPrevWordStart(0), mHasSupplementaryCodePoints(false),
+              mSecondWordFirstInputIndex(NOT_AN_INDEX) {}
 
     ~DicNodeStateOutput() {}
 
@@ -39,19 +40,19 @@ class DicNodeStateOutput {
     void init() {
         mOutputtedCodePointCount = 0;
         mCurrentWordStart = 0;
-        mOutputCodePoints[0] = 0;
+        mOutputCodeUnits[0] = 0;
         mPrevWordCount = 0;
         mPrevWordsLength = 0;
         mPrevWordStart = 0;
+        mHasSupplementaryCodePoints = false;
         mSecondWordFirstInputIndex = NOT_AN_INDEX;
     }
 
     // Init for next word.
     void init(const DicNodeStateOutput *const stateOutput) {
+        copyCodePoints(stateOutput, stateOutput->mOutputtedCodePointCount);
         mOutputtedCodePointCount = stateOutput->mOutputtedCodePointCount + 1;
-        memmove(mOutputCodePoints, stateOutput->mOutputCodePoints,
-                stateOutput->mOutputtedCodePointCount * sizeof(mOutputCodePoints[0]));
-        mOutputCodePoints[stateOutput->mOutputtedCodePointCount] = KEYCODE_SPACE;
+        setCodePointAt(stateOutput->mOutputtedCodePointCount, KEYCODE_SPACE);
         mCurrentWordStart = stateOutput->mOutputtedCodePointCount + 1;
         mPrevWordCount = std::min(static_cast<int16_t>(stateOutput->mPrevWordCount + 1),
                 static_cast<int16_t>(MAX_RESULTS));
@@ -61,11 +62,10 @@ class DicNodeStateOutput {
     }
 
     void initByCopy(const DicNodeStateOutput *const stateOutput) {
-        memmove(mOutputCodePoints, stateOutput->mOutputCodePoints,
-                stateOutput->mOutputtedCodePointCount * sizeof(mOutputCodePoints[0]));
+        copyCodePoints(stateOutput, stateOutput->mOutputtedCodePointCount);
         mOutputtedCodePointCount = stateOutput->mOutputtedCodePointCount;
         if (mOutputtedCodePointCount < MAX_WORD_LENGTH) {
-            mOutputCodePoints[mOutputtedCodePointCount] = 0;
+            mOutputCodeUnits[mOutputtedCodePointCount] = 0;
         }
         mCurrentWordStart = stateOutput->mCurrentWordStart;
         mPrevWordCount = stateOutput->mPrevWordCount;
@@ -80,22 +80,35 @@ class DicNodeStateOutput {
             const int additionalCodePointCount = std::min(
                     static_cast<int>(mergedNodeCodePointCount),
                     MAX_WORD_LENGTH - mOutputtedCodePointCount);
-            memmove(&mOutputCodePoints[mOutputtedCodePointCount], mergedNodeCodePoints,
-                    additionalCodePointCount * sizeof(mOutputCodePoints[0]));
+            for (int i = 0; i < additionalCodePointCount; ++i) {
+                setCodePointAt(mOutputtedCodePointCount + i, mergedNodeCodePoints[i]);
+            }
             mOutputtedCodePointCount = static_cast<uint16_t>(
                     mOutputtedCodePointCount + additionalCodePointCount);
             if (mOutputtedCodePointCount < MAX_WORD_LENGTH) {
-                mOutputCodePoints[mOutputtedCodePointCount] = 0;
+                mOutputCodeUnits[mOutputtedCodePointCount] = 0;
             }
         }
     }
 
     int getCurrentWordCodePointAt(const int index) const {
-        return mOutputCodePoints[mCurrentWordStart + index];
+        return getOutputCodePointAt(mCurrentWordStart + index);
     }
 
-    const int *getCodePointBuf() const {
-        return mOutputCodePoints;
+    void outputCodePoints(const int codePointCount, int *const outCodePoints) const {
+        for (int i = 0; i < codePointCount; ++i) {
+            outCodePoints[i] = getOutputCodePointAt(i);
+        }
+    }
+
+    int getSpaceCount(const int codePointCount) const {
+        int spaceCount = 0;
+        for (int i = 0; i < codePointCount; ++i) {
+            if (getOutputCodePointAt(i) == KEYCODE_SPACE) {
+                ++spaceCount;
+            }
+        }
+        return spaceCount;
     }
 
     void setSecondWordFirstInputIndex(const int inputIndex) {
@@ -120,12 +133,40 @@ class DicNodeStateOutput {
     }
 
     int getOutputCodePointAt(const int id) const {
-        return mOutputCodePoints[id];
+        if (!mHasSupplementaryCodePoints) {
+            return mOutputCodeUnits[id];
+        }
+        return (static_cast<int>(mOutputPlanes[id]) << 16) | mOutputCodeUnits[id];
     }
 
  private:
     DISALLOW_COPY_AND_ASSIGN(DicNodeStateOutput);
 
+    // Copies the first codePointCount code points of stateOutput. The planes are only copied for
+    // the (rare) outputs that have supplementary code points.
+    void copyCodePoints(const DicNodeStateOutput *const stateOutput, const int codePointCount) {
+        memmove(mOutputCodeUnits, stateOutput->mOutputCodeUnits,
+                codePointCount * sizeof(mOutputCodeUnits[0]));
+        mHasSupplementaryCodePoints = stateOutput->mHasSupplementaryCodePoints;
+        if (mHasSupplementaryCodePoints) {
+            memmove(mOutputPlanes, stateOutput->mOutputPlanes,
+                    codePointCount * sizeof(mOutputPlanes[0]));
+        }
+    }
+
+    void setCodePointAt(const int index, const int codePoint) {
+        mOutputCodeUnits[index] = static_cast<uint16_t>(codePoint);
+        const uint8_t plane = static_cast<uint8_t>(codePoint >> 16);
+        if (plane != 0 && !mHasSupplementaryCodePoints) {
+            // The planes of the code points before are all 0.
+            memset(mOutputPlanes, 0, index * sizeof(mOutputPlanes[0]));
+            mHasSupplementaryCodePoints = true;
+        }
+        if (mHasSupplementaryCodePoints) {
+            mOutputPlanes[index] = plane;
+        }
+    }
+
     // When the DicNode represents "this is a pen":
     // mOutputtedCodePointCount is 13, which is total code point count of "this is a pen" including
     // spaces.
@@ -135,17 +176,26 @@ class DicNodeStateOutput {
     // mPrevWordStart is the start index of "a"; thus, it is 8.
     // mSecondWordFirstInputIndex is the first input index of "is".
 
+    // The counters are placed before mOutputCodeUnits so that they share a cache line with the
+    // preceding states. Only the used part of mOutputCodeUnits is copied.
     uint16_t mOutputtedCodePointCount;
-    int mOutputCodePoints[MAX_WORD_LENGTH];
     int16_t mCurrentWordStart;
-    // Previous word count in mOutputCodePoints.
+    // Previous word count in mOutputCodeUnits.
     int16_t mPrevWordCount;
-    // Total length of previous words in mOutputCodePoints. This is being used by the algorithm
+    // Total length of previous words in mOutputCodeUnits. This is being used by the algorithm
     // that may want to look at the previous word information.
     int16_t mPrevWordsLength;
-    // Start index of the previous word in mOutputCodePoints. This is being used for auto commit.
+    // Start index of the previous word in mOutputCodeUnits. This is being used for auto commit.
     int16_t mPrevWordStart;
+    // Whether mOutputPlanes is in use.
+    bool mHasSupplementaryCodePoints;
     int mSecondWordFirstInputIndex;
+    // The code points are stored one per element, as their lower 16 bits in mOutputCodeUnits and,
+    // only once a supplementary code point has been output, their planes in mOutputPlanes. This
+    // halves the bytes copied for each DicNode of the (almost always BMP) dictionary words, while
+    // keeping the output indexed by code point like the rest of the search state.
+    uint16_t mOutputCodeUnits[MAX_WORD_LENGTH];
+    uint8_t mOutputPlanes[MAX_WORD_LENGTH];
 };
 } // namespace latinime
 #endif // LATINIME_DIC_NODE_STATE_OUTPUT_H
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/completion_cache.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_node_utils.h"
+#include "suggest/core/dicnode/dic_node_vector.h"
+#include "utils/memory_usage.h"
+#include "utils/time_keeper.h"
+
+namespace latinime {
+
+// The prefixes typed in the last sentences and the PtNodes their corrections reach.
+const int CompletionCache::MAX_ENTRY_COUNT = 256;
+const int CompletionCache::ENTRY_LIFETIME_IN_SECONDS = 60;
+
+void CompletionCache::Completions::addCompletion(const int wordId, const int probability,
+        const int childrenPtNodeArrayPos, const CodePointArrayView codePoints) {
+    mWordIds.push_back(wordId);
+    mProbabilities.push_back(probability);
+    mChildrenPtNodeArrayPositions.push_back(childrenPtNodeArrayPos);
+    mCodePoints.insert(mCodePoints.end(), codePoints.begin(), codePoints.end());
+    mCodePointEnds.push_back(static_cast<int>(mCodePoints.size()));
+}
+
+void CompletionCache::Completions::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mWordIds);
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mProbabilities);
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mChildrenPtNodeArrayPositions);
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mCodePointEnds);
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mCodePoints);
+}
+
+CompletionCache::CompletionCache()
+        : mMutex(), mPolicy(nullptr), mDictionaryGeneration(0), mEntries(), mSequenceNumber(0) {}
+
+CompletionCache::~CompletionCache() {}
+
+bool CompletionCache::getCompletions(const DictionaryStructureWithBufferPolicy *const policy,
+        const uint64_t dictionaryGeneration, const int ptNodeArrayPos,
+        Completions *const outCompletions) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!isSameDictionary(policy, dictionaryGeneration)) {
+        return false;
+    }
+    const auto it = mEntries.find(ptNodeArrayPos);
+    if (it == mEntries.end()) {
+        return false;
+    }
+    if (std::abs(TimeKeeper::peekCurrentTime() - it->second.mTimestamp)
+            > ENTRY_LIFETIME_IN_SECONDS) {
+        mEntries.erase(it);
+        return false;
+    }
+    it->second.mLastUsedSequenceNumber = ++mSequenceNumber;
+    *outCompletions = it->second.mCompletions;
+    return true;
+}
+
+void CompletionCache::putCompletions(const DictionaryStructureWithBufferPolicy *const policy,
+        const uint64_t dictionaryGeneration, const int ptNodeArrayPos,
+        const Completions &completions) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!isSameDictionary(policy, dictionaryGeneration)) {
+        // The dictionary has been updated since the entries were read.
+        mEntries.clear();
+        mPolicy = policy;
+        mDictionaryGeneration = dictionaryGeneration;
+    }
+    if (mEntries.find(ptNodeArrayPos) == mEntries.end()
+            && static_cast<int>(mEntries.size()) >= MAX_ENTRY_COUNT) {
+        mEntries.erase(std::min_element(mEntries.begin(), mEntries.end(),
+                [](const std::pair<const int, Entry> &left,
+                        const std::pair<const int, Entry> &right) {
+                    return left.second.mLastUsedSequenceNumber
+                            < right.second.mLastUsedSequenceNumber;
+                }));
+    }
+    Entry &entry = mEntries[ptNodeArrayPos];
+    entry.mCompletions = completions;
+    entry.mTimestamp = TimeKeeper::peekCurrentTime();
+    entry.mLastUsedSequenceNumber = ++mSequenceNumber;
+}
+
+void CompletionCache::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+}
+
+void CompletionCache::release() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::unordered_map<int, Entry>().swap(mEntries);
+}
+
+int CompletionCache::getEntryCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return static_cast<int>(mEntries.size());
+}
+
+void CompletionCache::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    outMemoryUsage->addUnorderedMap(MemoryUsage::CACHE_BYTES, mEntries);
+    for (const auto &entry : mEntries) {
+        entry.second.mCompletions.addMemoryUsage(outMemoryUsage);
+    }
+}
+
+/* static */ void CompletionCache::readCompletions(
+        const DictionaryStructureWithBufferPolicy *const policy, const DicNode *const dicNode,
+        const int maxCompletionCount, const int maxVisitedDicNodeCount,
+        Completions *const outCompletions) {
+    outCompletions->clear();
+    // The same DicNodes as the search creates below dicNode, one per code point, depth first.
+    Completions terminals;
+    std::vector<DicNode> dicNodeStack;
+    DicNodeVector childDicNodes;
+    int codePoints[MAX_WORD_LENGTH];
+    const int depth = dicNode->getNodeCodePointCount();
+    int visitedDicNodeCount = 0;
+    DicNode currentDicNode(*dicNode);
+    while (true) {
+        if (currentDicNode.hasChildren()) {
+            childDicNodes.clear();
+            DicNodeUtils::getAllChildDicNodes(&currentDicNode, policy, &childDicNodes);
+            const int childCount = childDicNodes.getSizeAndLock();
+            visitedDicNodeCount += childCount;
+            if (visitedDicNodeCount > maxVisitedDicNodeCount) {
+                return;
+            }
+            for (int i = childCount - 1; i >= 0; --i) {
+                dicNodeStack.push_back(*childDicNodes[i]);
+            }
+        }
+        if (dicNodeStack.empty()) {
+            break;
+        }
+        currentDicNode = dicNodeStack.back();
+        dicNodeStack.pop_back();
+        const int codePointCount = currentDicNode.getNodeCodePointCount() - depth;
+        codePoints[codePointCount - 1] = currentDicNode.getNodeCodePoint();
+        if (currentDicNode.isTerminalDicNode()) {
+            terminals.addCompletion(currentDicNode.getWordId(),
+                    policy->getProbabilityOfWord(WordIdArrayView(), currentDicNode.getWordId()),
+                    currentDicNode.getChildrenPtNodeArrayPos(),
+                    CodePointArrayView(codePoints, codePointCount));
+        }
+    }
+    std::vector<int> indices(terminals.getCount());
+    for (int i = 0; i < terminals.getCount(); ++i) {
+        indices[i] = i;
+    }
+    std::stable_sort(indices.begin(), indices.end(), [&terminals](const int left, const int right) {
+        return terminals.getProbability(left) > terminals.getProbability(right);
+    });
+    const int completionCount = std::min(terminals.getCount(), maxCompletionCount);
+    for (int i = 0; i < completionCount; ++i) {
+        const int index = indices[i];
+        outCompletions->addCompletion(terminals.getWordId(index), terminals.getProbability(index),
+                terminals.getChildrenPtNodeArrayPos(index), terminals.getCodePoints(index));
+    }
+    outCompletions->setValid();
+}
+
+} // namespace latinime
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_COMPLETION_CACHE_H
+#define LATINIME_COMPLETION_CACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "defines.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+class DicNode;
+class DictionaryStructureWithBufferPolicy;
+class MemoryUsage;
+
+/**
+ * An LRU cache of the most probable completions below a PtNode, keyed by the position of its
+ * children PtNode array.
+ *
+ * When all the input has been consumed, the search expands the whole subtree of the typed prefix
+ * to find the completions, and does it again for every DicNode that reaches the same PtNode and on
+ * the next searches with the same prefix. The completions are the same each time as long as the
+ * dictionary is, so they are cached with the policy and the generation of the dictionary they were
+ * read from, and the entries of another policy or generation are dropped (see
+ * Dictionary::getGeneration(), which changes on every update). Entries also expire after a while
+ * so that time dependent probabilities don't go stale.
+ *
+ * This class is thread-safe.
+ */
+class CompletionCache {
+ public:
+    // The most probable words of a subtree, most probable first. When the subtree was too large
+    // to be read, there are none and isValid() is false; the search expands it as usual.
+    class Completions {
+     public:
+        Completions() : mWordIds(), mProbabilities(), mChildrenPtNodeArrayPositions(),
+                mCodePointEnds(), mCodePoints(), mIsValid(false) {}
+
+        int getCount() const { return static_cast<int>(mWordIds.size()); }
+        int getWordId(const int index) const { return mWordIds[index]; }
+        int getProbability(const int index) const { return mProbabilities[index]; }
+        int getChildrenPtNodeArrayPos(const int index) const {
+            return mChildrenPtNodeArrayPositions[index];
+        }
+        // The code points after those of the DicNode the completions were read from.
+        const CodePointArrayView getCodePoints(const int index) const {
+            const int start = index == 0 ? 0 : mCodePointEnds[index - 1];
+            return CodePointArrayView(mCodePoints).skip(start).limit(
+                    mCodePointEnds[index] - start);
+        }
+        bool isValid() const { return mIsValid; }
+
+        void clear() {
+            mWordIds.clear();
+            mProbabilities.clear();
+            mChildrenPtNodeArrayPositions.clear();
+            mCodePointEnds.clear();
+            mCodePoints.clear();
+            mIsValid = false;
+        }
+        void addCompletion(const int wordId, const int probability,
+                const int childrenPtNodeArrayPos, const CodePointArrayView codePoints);
+        void setValid() { mIsValid = true; }
+        void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+
+     private:
+        std::vector<int> mWordIds;
+        std::vector<int> mProbabilities;
+        std::vector<int> mChildrenPtNodeArrayPositions;
+        std::vector<int> mCodePointEnds;
+        std::vector<int> mCodePoints;
+        bool mIsValid;
+    };
+
+    CompletionCache();
+    ~CompletionCache();
+
+    // Copies the cached completions of the PtNode array to outCompletions and returns true on a
+    // hit.
+    bool getCompletions(const DictionaryStructureWithBufferPolicy *const policy,
+            const uint64_t dictionaryGeneration, const int ptNodeArrayPos,
+            Completions *const outCompletions) const;
+    void putCompletions(const DictionaryStructureWithBufferPolicy *const policy,
+            const uint64_t dictionaryGeneration, const int ptNodeArrayPos,
+            const Completions &completions);
+    void clear();
+    // Same as clear(), and frees the entry buffer.
+    void release();
+
+    int getEntryCount() const;
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+
+    // Reads the maxCompletionCount most probable words below the leaving dicNode into
+    // outCompletions, ranked by their unigram probabilities. Gives up when the subtree has more
+    // than maxVisitedDicNodeCount code points, which leaves outCompletions invalid.
+    static void readCompletions(const DictionaryStructureWithBufferPolicy *const policy,
+            const DicNode *const dicNode, const int maxCompletionCount,
+            const int maxVisitedDicNodeCount, Completions *const outCompletions);
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(CompletionCache);
+
+    struct Entry {
+        Completions mCompletions;
+        int mTimestamp;
+        uint64_t mLastUsedSequenceNumber;
+    };
+
+    static const int MAX_ENTRY_COUNT;
+    static const int ENTRY_LIFETIME_IN_SECONDS;
+
+    bool isSameDictionary(const DictionaryStructureWithBufferPolicy *const policy,
+            const uint64_t dictionaryGeneration) const {
+        return mPolicy == policy && mDictionaryGeneration == dictionaryGeneration;
+    }
+
+    mutable std::mutex mMutex;
+    // The policy and the generation of all the entries.
+    const DictionaryStructureWithBufferPolicy *mPolicy;
+    uint64_t mDictionaryGeneration;
+    mutable std::unordered_map<int, Entry> mEntries;
+    mutable uint64_t mSequenceNumber;
+};
+} // namespace latinime
+#endif // LATINIME_COMPLETION_CACHE_H
@@ -18,86 +18,219 @@
 
 #include "suggest/core/dictionary/dictionary.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+
 #include "defines.h"
 #include "dictionary/interface/dictionary_header_structure_policy.h"
 #include "dictionary/property/ngram_context.h"
+#include "dictionary/property/ngram_property.h"
+#include "suggest/core/dicnode/dic_node_slab_allocator.h"
 #include "suggest/core/dictionary/dictionary_utils.h"
+#include "suggest/core/layout/proximity_info.h"
+#include "suggest/core/layout/touch_position_model.h"
 #include "suggest/core/result/suggestion_results.h"
 #include "suggest/core/session/dic_traverse_session.h"
 #include "suggest/core/suggest.h"
 #include "suggest/core/suggest_options.h"
 #include "suggest/policyimpl/gesture/gesture_suggest_policy_factory.h"
-#include "suggest/policyimpl/typing/typing_suggest_policy_factory.h"
+#include "suggest/policyimpl/typing/typing_beam_width_tuner.h"
+#include "suggest/policyimpl/typing/typing_latency_guard.h"
+#include "suggest/policyimpl/typing/typing_suggest.h"
 #include "utils/int_array_view.h"
 #include "utils/log_utils.h"
+#include "utils/memory_usage.h"
+#include "utils/native_metrics.h"
+#include "utils/native_trace.h"
 #include "utils/time_keeper.h"
 
 namespace latinime {
 
 const int Dictionary::HEADER_ATTRIBUTE_BUFFER_SIZE = 32;
+// The words of up to 3 code points are the most frequent ones, and their PtNodes cover the first
+// levels of the trie every search goes through.
+const int Dictionary::PREWARM_CODE_POINT_DEPTH = 3;
+const char *const Dictionary::TYPING_BEAM_WIDTH_QUERY = "TYPING_BEAM_WIDTH";
+const char *const Dictionary::TYPING_DEGRADATION_LEVEL_QUERY = "TYPING_DEGRADATION_LEVEL";
+std::atomic<uint64_t> Dictionary::sLastGeneration(0);
+
+Dictionary::Dictionary(JNIEnv *env, DictionaryStructureWithBufferPolicy::StructurePolicyPtr
+        dictionaryStructureWithBufferPolicy, const bool usesLargeTraverseSessionCache)
+        : Dictionary(env, std::move(dictionaryStructureWithBufferPolicy),
+                nullptr /* replicaStructurePolicy */, usesLargeTraverseSessionCache) {}
 
 Dictionary::Dictionary(JNIEnv *env, DictionaryStructureWithBufferPolicy::StructurePolicyPtr
-        dictionaryStructureWithBufferPolicy)
+        dictionaryStructureWithBufferPolicy,
+        DictionaryStructureWithBufferPolicy::StructurePolicyPtr replicaStructurePolicy,
+        const bool usesLargeTraverseSessionCache)
         : mDictionaryStructureWithBufferPolicy(std::move(dictionaryStructureWithBufferPolicy)),
+          mReplicaStructurePolicy(std::move(replicaStructurePolicy)), mPublishedPolicyIndex(0),
+          mReaderCounts(), mGeneration(sLastGeneration.fetch_add(1) + 1), mUpdateMutex(),
+          mFlushMutex(), mNeedsReopening(false),
           mGestureSuggest(new Suggest(GestureSuggestPolicyFactory::getGestureSuggestPolicy())),
-          mTypingSuggest(new Suggest(TypingSuggestPolicyFactory::getTypingSuggestPolicy())) {
+          mTypingSuggest(new TypingSuggest()),
+          mTraverseSessionPool(usesLargeTraverseSessionCache), mPredictionCache(),
+          mCompletionCache(), mUpdateLog() {
     logDictionaryInfo(env);
 }
 
+Dictionary::ScopedReadingPolicy::ScopedReadingPolicy(const Dictionary *const dictionary)
+        : mDictionary(dictionary), mPolicyIndex(dictionary->acquireReadingPolicyIndex()) {}
+
+Dictionary::ScopedReadingPolicy::~ScopedReadingPolicy() {
+    mDictionary->mReaderCounts[mPolicyIndex].fetch_sub(1);
+}
+
+int Dictionary::acquireReadingPolicyIndex() const {
+    while (true) {
+        const int policyIndex = mPublishedPolicyIndex.load();
+        mReaderCounts[policyIndex].fetch_add(1);
+        // The policy might have been unpublished and started being updated before the reader
+        // was counted.
+        if (mPublishedPolicyIndex.load() == policyIndex) {
+            return policyIndex;
+        }
+        mReaderCounts[policyIndex].fetch_sub(1);
+    }
+}
+
+void Dictionary::publishPolicyAndWaitForReaders(const int policyIndex) {
+    mPublishedPolicyIndex.store(policyIndex);
+    // Searches take up to tens of milliseconds, so the updating thread sleeps instead of spinning.
+    while (mReaderCounts[1 - policyIndex].load() > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
 void Dictionary::getSuggestions(ProximityInfo *proximityInfo, DicTraverseSession *traverseSession,
         int *xcoordinates, int *ycoordinates, int *times, int *pointerIds, int *inputCodePoints,
         int inputSize, const NgramContext *const ngramContext,
         const SuggestOptions *const suggestOptions, const float weightOfLangModelVsSpatialModel,
         SuggestionResults *const outSuggestionResults) const {
+    if (proximityInfo) {
+        proximityInfo->applyTouchPositionModel(TouchPositionModel::getInstance());
+    }
+    if (!traverseSession) {
+        DicTraverseSessionPool::ScopedSession leasedSession(&mTraverseSessionPool);
+        getSuggestions(proximityInfo, leasedSession.get(), xcoordinates, ycoordinates, times,
+                pointerIds, inputCodePoints, inputSize, ngramContext, suggestOptions,
+                weightOfLangModelVsSpatialModel, outSuggestionResults);
+        return;
+    }
     TimeKeeper::setCurrentTime();
-    traverseSession->init(this, ngramContext, suggestOptions);
-    const auto &suggest = suggestOptions->isGesture() ? mGestureSuggest : mTypingSuggest;
+    const ScopedReadingPolicy readingPolicy(this);
+    traverseSession->init(this, readingPolicy.get(), ngramContext, suggestOptions);
+    const bool isGesture = suggestOptions->isGesture();
+    const auto &suggest = isGesture ? mGestureSuggest : mTypingSuggest;
+    const int64_t searchStartTime = TimeKeeper::getMonotonicTimeInMicroseconds();
     suggest->getSuggestions(proximityInfo, traverseSession, xcoordinates,
             ycoordinates, times, pointerIds, inputCodePoints, inputSize,
             weightOfLangModelVsSpatialModel, outSuggestionResults);
+    // Single point searches use a fixed cache size, so they don't tell about the beam cost.
+    if (!isGesture && inputSize > 1) {
+        const int64_t elapsedTimeUs =
+                TimeKeeper::getMonotonicTimeInMicroseconds() - searchStartTime;
+        const int timeBudgetUs = suggestOptions->getSearchTimeLimitInMicroseconds();
+        TypingBeamWidthTuner::getInstance()->onSearchFinished(elapsedTimeUs, timeBudgetUs);
+        TypingLatencyGuard::getInstance()->onSearchFinished(elapsedTimeUs, timeBudgetUs);
+    }
 }
 
 Dictionary::NgramListenerForPrediction::NgramListenerForPrediction(
         const NgramContext *const ngramContext, const WordIdArrayView prevWordIds,
         SuggestionResults *const suggestionResults,
-        const DictionaryStructureWithBufferPolicy *const dictStructurePolicy)
+        const DictionaryStructureWithBufferPolicy *const dictStructurePolicy,
+        std::vector<int> *const outVisitedWordIds)
     : mNgramContext(ngramContext), mPrevWordIds(prevWordIds),
-      mSuggestionResults(suggestionResults), mDictStructurePolicy(dictStructurePolicy) {}
+      mSuggestionResults(suggestionResults), mDictStructurePolicy(dictStructurePolicy),
+      mVisitedWordIds(outVisitedWordIds), mMostProbableWords() {
+    mMostProbableWords.reserve(suggestionResults->getMaxSuggestionCount());
+}
 
 void Dictionary::NgramListenerForPrediction::onVisitEntry(const int ngramProbability,
         const int targetWordId) {
     if (targetWordId == NOT_A_WORD_ID) {
         return;
     }
+    // Record the word even if it's not added; updating it might make it a prediction.
+    mVisitedWordIds->push_back(targetWordId);
     if (mNgramContext->isNthPrevWordBeginningOfSentence(1 /* n */)
             && ngramProbability == NOT_A_PROBABILITY) {
         return;
     }
-    int targetWordCodePoints[MAX_WORD_LENGTH];
-    const int codePointCount = mDictStructurePolicy->getCodePointsAndReturnCodePointCount(
-            targetWordId, MAX_WORD_LENGTH, targetWordCodePoints);
-    if (codePointCount <= 0) {
-        return;
-    }
+    // The probabilities passed by the policies can't be compared with each other; they are
+    // relative to the unigram probabilities in ver2 dictionaries and 0 in decaying ones. Hence the
+    // probability in context is resolved for every successor.
     const WordAttributes wordAttributes = mDictStructurePolicy->getWordAttributesInContext(
             mPrevWordIds, targetWordId, nullptr /* multiBigramMap */);
-    if (wordAttributes.getProbability() == NOT_A_PROBABILITY) {
+    const int probability = wordAttributes.getProbability();
+    if (probability == NOT_A_PROBABILITY) {
         return;
     }
-    mSuggestionResults->addPrediction(targetWordCodePoints, codePointCount,
-            wordAttributes.getProbability());
+    const std::greater<ProbabilityAndWordId> comparator;
+    const size_t maxWordCount = static_cast<size_t>(mSuggestionResults->getMaxSuggestionCount());
+    if (mMostProbableWords.size() >= maxWordCount) {
+        if (maxWordCount == 0 || probability <= mMostProbableWords.front().first) {
+            return;
+        }
+    }
+    // A word can be visited for each n-gram order of the context, always with the same
+    // probability in context.
+    for (const ProbabilityAndWordId &probabilityAndWordId : mMostProbableWords) {
+        if (probabilityAndWordId.second == targetWordId) {
+            return;
+        }
+    }
+    if (mMostProbableWords.size() >= maxWordCount) {
+        std::pop_heap(mMostProbableWords.begin(), mMostProbableWords.end(), comparator);
+        mMostProbableWords.pop_back();
+    }
+    mMostProbableWords.emplace_back(probability, targetWordId);
+    std::push_heap(mMostProbableWords.begin(), mMostProbableWords.end(), comparator);
+}
+
+void Dictionary::NgramListenerForPrediction::outputPredictions() {
+    for (const ProbabilityAndWordId &probabilityAndWordId : mMostProbableWords) {
+        int targetWordCodePoints[MAX_WORD_LENGTH];
+        const int codePointCount = mDictStructurePolicy->getCodePointsAndReturnCodePointCount(
+                probabilityAndWordId.second, MAX_WORD_LENGTH, targetWordCodePoints);
+        if (codePointCount <= 0) {
+            continue;
+        }
+        mSuggestionResults->addPrediction(targetWordCodePoints, codePointCount,
+                probabilityAndWordId.first);
+    }
+    mMostProbableWords.clear();
 }
 
 void Dictionary::getPredictions(const NgramContext *const ngramContext,
         SuggestionResults *const outSuggestionResults) const {
+    const NativeMetrics::ScopedTimer timer(NativeMetrics::METRIC_GET_PREDICTIONS);
     TimeKeeper::setCurrentTime();
+    const ScopedReadingPolicy readingPolicy(this);
     WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> prevWordIdArray;
-    const WordIdArrayView prevWordIds = ngramContext->getPrevWordIds(
-            mDictionaryStructureWithBufferPolicy.get(), &prevWordIdArray,
-            true /* tryLowerCaseSearch */);
+    const WordIdArrayView prevWordIds = ngramContext->getPrevWordIds(readingPolicy.get(),
+            &prevWordIdArray, true /* tryLowerCaseSearch */);
+    const bool isBeginningOfSentence = ngramContext->isNthPrevWordBeginningOfSentence(1 /* n */);
+    // Cached predictions can only be reused as a whole.
+    const bool usesPredictionCache = outSuggestionResults->getSuggestionCount() == 0;
+    if (usesPredictionCache && mPredictionCache.getPredictions(prevWordIds, isBeginningOfSentence,
+            outSuggestionResults)) {
+        return;
+    }
+    std::vector<int> visitedWordIds;
     NgramListenerForPrediction listener(ngramContext, prevWordIds, outSuggestionResults,
-            mDictionaryStructureWithBufferPolicy.get());
-    mDictionaryStructureWithBufferPolicy->iterateNgramEntries(prevWordIds, &listener);
+            readingPolicy.get(), &visitedWordIds);
+    readingPolicy.get()->iterateNgramEntries(prevWordIds, &listener);
+    listener.outputPredictions();
+    if (usesPredictionCache) {
+        mPredictionCache.putPredictions(prevWordIds, isBeginningOfSentence, visitedWordIds,
+                outSuggestionResults);
+    }
 }
 
 int Dictionary::getProbability(const CodePointArrayView codePoints) const {
@@ -106,94 +239,370 @@ int Dictionary::getProbability(const CodePointArrayView codePoints) const {
 
 int Dictionary::getMaxProbabilityOfExactMatches(const CodePointArrayView codePoints) const {
     TimeKeeper::setCurrentTime();
-    return DictionaryUtils::getMaxProbabilityOfExactMatches(
-            mDictionaryStructureWithBufferPolicy.get(), codePoints);
+    const ScopedReadingPolicy readingPolicy(this);
+    return DictionaryUtils::getMaxProbabilityOfExactMatches(readingPolicy.get(), codePoints);
 }
 
 int Dictionary::getNgramProbability(const NgramContext *const ngramContext,
         const CodePointArrayView codePoints) const {
     TimeKeeper::setCurrentTime();
-    const int wordId = mDictionaryStructureWithBufferPolicy->getWordId(codePoints,
+    const ScopedReadingPolicy readingPolicy(this);
+    const int wordId = readingPolicy.get()->getWordId(codePoints,
             false /* forceLowerCaseSearch */);
     if (wordId == NOT_A_WORD_ID) return NOT_A_PROBABILITY;
     if (!ngramContext) {
-        return getDictionaryStructurePolicy()->getProbabilityOfWord(WordIdArrayView(), wordId);
+        return readingPolicy.get()->getProbabilityOfWord(WordIdArrayView(), wordId);
     }
     WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> prevWordIdArray;
-    const WordIdArrayView prevWordIds = ngramContext->getPrevWordIds(
-            mDictionaryStructureWithBufferPolicy.get(), &prevWordIdArray,
-            true /* tryLowerCaseSearch */);
-    return getDictionaryStructurePolicy()->getProbabilityOfWord(prevWordIds, wordId);
+    const WordIdArrayView prevWordIds = ngramContext->getPrevWordIds(readingPolicy.get(),
+            &prevWordIdArray, true /* tryLowerCaseSearch */);
+    return readingPolicy.get()->getProbabilityOfWord(prevWordIds, wordId);
 }
 
 bool Dictionary::addUnigramEntry(const CodePointArrayView codePoints,
         const UnigramProperty *const unigramProperty) {
     if (unigramProperty->representsBeginningOfSentence()
-            && !mDictionaryStructureWithBufferPolicy->getHeaderStructurePolicy()
+            && !getDictionaryStructurePolicy()->getHeaderStructurePolicy()
                     ->supportsBeginningOfSentence()) {
         AKLOGE("The dictionary doesn't support Beginning-of-Sentence.");
         return false;
     }
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->addUnigramEntry(codePoints, unigramProperty);
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    const bool result = updateStructurePolicies(
+            [&](DictionaryStructureWithBufferPolicy *const policy) {
+                return policy->addUnigramEntry(codePoints, unigramProperty);
+            });
+    // A new word can't be in any cached prediction, but an existing one might have been updated.
+    invalidatePredictionCacheForWord(codePoints);
+    if (result) {
+        mUpdateLog.logAddUnigramEntry(codePoints, unigramProperty);
+    }
+    return result;
+}
+
+bool Dictionary::addUnigramEntries(const std::vector<CodePointArrayView> &codePoints,
+        const std::vector<UnigramProperty> &unigramProperties) {
+    if (!getDictionaryStructurePolicy()->getHeaderStructurePolicy()
+            ->supportsBeginningOfSentence()) {
+        for (const auto &unigramProperty : unigramProperties) {
+            if (unigramProperty.representsBeginningOfSentence()) {
+                AKLOGE("The dictionary doesn't support Beginning-of-Sentence.");
+                return false;
+            }
+        }
+    }
+    TimeKeeper::setCurrentTime();
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    const bool result = updateStructurePolicies(
+            [&](DictionaryStructureWithBufferPolicy *const policy) {
+                return policy->addUnigramEntries(codePoints, unigramProperties);
+            });
+    mPredictionCache.clear();
+    // Bulk updates are written as a new dictionary image rather than logged entry by entry.
+    mUpdateLog.requireDictionaryWrite();
+    return result;
 }
 
 bool Dictionary::removeUnigramEntry(const CodePointArrayView codePoints) {
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->removeUnigramEntry(codePoints);
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    // The word id is gone after the removal.
+    const int wordId = getDictionaryStructurePolicy()->getWordId(codePoints,
+            false /* forceLowerCaseSearch */);
+    const bool result = updateStructurePolicies(
+            [&](DictionaryStructureWithBufferPolicy *const policy) {
+                return policy->removeUnigramEntry(codePoints);
+            });
+    mPredictionCache.invalidateEntriesForWord(wordId);
+    if (result) {
+        mUpdateLog.logRemoveUnigramEntry(codePoints);
+    }
+    return result;
 }
 
 bool Dictionary::addNgramEntry(const NgramProperty *const ngramProperty) {
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->addNgramEntry(ngramProperty);
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    const bool result = updateStructurePolicies(
+            [&](DictionaryStructureWithBufferPolicy *const policy) {
+                return policy->addNgramEntry(ngramProperty);
+            });
+    invalidatePredictionCacheForPrevWord(ngramProperty->getNgramContext());
+    if (result) {
+        mUpdateLog.logAddNgramEntry(ngramProperty);
+    }
+    return result;
 }
 
 bool Dictionary::removeNgramEntry(const NgramContext *const ngramContext,
         const CodePointArrayView codePoints) {
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->removeNgramEntry(ngramContext, codePoints);
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    const bool result = updateStructurePolicies(
+            [&](DictionaryStructureWithBufferPolicy *const policy) {
+                return policy->removeNgramEntry(ngramContext, codePoints);
+            });
+    invalidatePredictionCacheForPrevWord(ngramContext);
+    if (result) {
+        mUpdateLog.logRemoveNgramEntry(ngramContext, codePoints);
+    }
+    return result;
 }
 
 bool Dictionary::updateEntriesForWordWithNgramContext(const NgramContext *const ngramContext,
         const CodePointArrayView codePoints, const bool isValidWord,
         const HistoricalInfo historicalInfo) {
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->updateEntriesForWordWithNgramContext(ngramContext,
-            codePoints, isValidWord, historicalInfo);
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    const bool result = updateStructurePolicies(
+            [&](DictionaryStructureWithBufferPolicy *const policy) {
+                return policy->updateEntriesForWordWithNgramContext(ngramContext, codePoints,
+                        isValidWord, historicalInfo);
+            });
+    // The n-gram entry for the context and the unigram entry of the word (e.g. its count, which
+    // is the context count of predictions after it) have been updated.
+    invalidatePredictionCacheForPrevWord(ngramContext);
+    invalidatePredictionCacheForWord(codePoints);
+    if (result) {
+        mUpdateLog.logUpdateEntriesForWord(ngramContext, codePoints, isValidWord,
+                &historicalInfo);
+    }
+    return result;
+}
+
+int Dictionary::updateEntriesForWords(const std::vector<NgramContext> &ngramContexts,
+        const std::vector<CodePointArrayView> &codePoints,
+        const std::vector<HistoricalInfo> &historicalInfos) {
+    TimeKeeper::setCurrentTime();
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    const int wordCount = static_cast<int>(codePoints.size());
+    // The first update decides how many words are applied, and the update of the other policy
+    // applies the same words.
+    bool isFirstUpdate = true;
+    int appliedWordCount = 0;
+    std::vector<bool> results;
+    updateStructurePolicies([&](DictionaryStructureWithBufferPolicy *const policy) {
+        const int targetWordCount = isFirstUpdate ? wordCount : appliedWordCount;
+        for (int i = 0; i < targetWordCount; ++i) {
+            const bool result = policy->updateEntriesForWordWithNgramContext(&ngramContexts[i],
+                    codePoints[i], true /* isValidWord */, historicalInfos[i]);
+            if (!isFirstUpdate) {
+                continue;
+            }
+            results.push_back(result);
+            if (policy->needsToRunGC(true /* mindsBlockByGC */)) {
+                break;
+            }
+        }
+        if (isFirstUpdate) {
+            appliedWordCount = static_cast<int>(results.size());
+            isFirstUpdate = false;
+        }
+        return true;
+    });
+    mPredictionCache.clear();
+    for (int i = 0; i < appliedWordCount; ++i) {
+        if (results[i]) {
+            mUpdateLog.logUpdateEntriesForWord(&ngramContexts[i], codePoints[i],
+                    true /* isValidWord */, &historicalInfos[i]);
+        }
+    }
+    return appliedWordCount;
+}
+
+void Dictionary::openUpdateLog(const char *const dictDirPath) {
+    mUpdateLog.openAndReplay(dictDirPath, this);
+}
+
+void Dictionary::replayUpdateLog(const char *const dictDirPath) {
+    DictionaryUpdateLog::replay(dictDirPath, this);
 }
 
 bool Dictionary::flush(const char *const filePath) {
+    const NativeMetrics::ScopedTimer timer(NativeMetrics::METRIC_FLUSH);
+    const NativeTrace::ScopedSection section("Dictionary::flush");
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->flush(filePath);
+    std::lock_guard<std::mutex> flushLock(mFlushMutex);
+    std::vector<int32_t> records;
+    {
+        std::lock_guard<std::mutex> lock(mUpdateMutex);
+        if (!mUpdateLog.takePendingRecords(filePath, &records)) {
+            return writeDictionaryLocked(filePath);
+        }
+    }
+    // The records are a snapshot of the updates, so the updates don't wait for the log to be
+    // written and synced. The next updates are logged to be appended by the next flush.
+    if (mUpdateLog.appendRecords(records)) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    mUpdateLog.requireDictionaryWrite();
+    return writeDictionaryLocked(filePath);
+}
+
+bool Dictionary::writeDictionaryLocked(const char *const filePath) {
+    // Flushing only reads the policy, so it can share the published one with the readers.
+    if (!getStructurePolicy(mPublishedPolicyIndex.load())->flush(filePath)) {
+        return false;
+    }
+    mUpdateLog.onDictionaryWritten(filePath);
+    return true;
 }
 
 bool Dictionary::flushWithGC(const char *const filePath) {
+    const NativeMetrics::ScopedTimer timer(NativeMetrics::METRIC_FLUSH_WITH_GC);
+    const NativeTrace::ScopedSection section("Dictionary::flushWithGC");
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->flushWithGC(filePath);
+    std::lock_guard<std::mutex> flushLock(mFlushMutex);
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    // GC can remove entries and reassign word ids.
+    mPredictionCache.clear();
+    advanceGeneration();
+    if (!mReplicaStructurePolicy) {
+        if (!mDictionaryStructureWithBufferPolicy->flushWithGC(filePath)) {
+            return false;
+        }
+        mUpdateLog.onDictionaryWritten(filePath);
+        return true;
+    }
+    if (mNeedsReopening) {
+        AKLOGE("The dictionary has to be reopened after GC.");
+        return false;
+    }
+    // GC updates the policy in place, so it runs on the policy that is not read. The other one is
+    // left as is and the dictionary has to be reopened from the written file.
+    mNeedsReopening = true;
+    if (!getStructurePolicy(1 - mPublishedPolicyIndex.load())->flushWithGC(filePath)) {
+        return false;
+    }
+    mUpdateLog.onDictionaryWritten(filePath);
+    return true;
 }
 
 bool Dictionary::needsToRunGC(const bool mindsBlockByGC) {
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->needsToRunGC(mindsBlockByGC);
+    const ScopedReadingPolicy readingPolicy(this);
+    return readingPolicy.get()->needsToRunGC(mindsBlockByGC);
 }
 
 void Dictionary::getProperty(const char *const query, const int queryLength, char *const outResult,
         const int maxResultLength) {
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->getProperty(query, queryLength, outResult,
-            maxResultLength);
+    if (strncmp(query, TYPING_BEAM_WIDTH_QUERY, queryLength + 1 /* terminator */) == 0) {
+        snprintf(outResult, maxResultLength, "%d",
+                TypingBeamWidthTuner::getInstance()->getBeamWidth());
+        return;
+    }
+    if (strncmp(query, TYPING_DEGRADATION_LEVEL_QUERY, queryLength + 1 /* terminator */) == 0) {
+        snprintf(outResult, maxResultLength, "%d",
+                TypingLatencyGuard::getInstance()->getLevel());
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    return getStructurePolicy(mPublishedPolicyIndex.load())->getProperty(query, queryLength,
+            outResult, maxResultLength);
 }
 
 const WordProperty Dictionary::getWordProperty(const CodePointArrayView codePoints) {
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->getWordProperty(codePoints);
+    const ScopedReadingPolicy readingPolicy(this);
+    return readingPolicy.get()->getWordProperty(codePoints);
 }
 
 int Dictionary::getNextWordAndNextToken(const int token, int *const outCodePoints,
         int *const outCodePointCount) {
     TimeKeeper::setCurrentTime();
+    // The iteration state is kept in the policy, so the same policy is always used. Holding
+    // mUpdateMutex keeps it from being updated meanwhile.
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
     return mDictionaryStructureWithBufferPolicy->getNextWordAndNextToken(
-            token, outCodePoints, outCodePointCount);
+            token, outCodePoints, outCodePointCount, nullptr /* outWordId */);
+}
+
+int Dictionary::getNextWordsAndNextToken(const int token, WordListener *const listener) {
+    TimeKeeper::setCurrentTime();
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    int codePoints[MAX_WORD_LENGTH];
+    int codePointCount = 0;
+    int wordId = NOT_A_WORD_ID;
+    int currentToken = token;
+    while (listener->canTakeWord()) {
+        // The word id saves looking the word up again for the attributes.
+        const int nextToken = mDictionaryStructureWithBufferPolicy->getNextWordAndNextToken(
+                currentToken, codePoints, &codePointCount, &wordId);
+        if (codePointCount > 0) {
+            listener->onVisitWord(CodePointArrayView(codePoints, codePointCount),
+                    mDictionaryStructureWithBufferPolicy->getWordAttributesInContext(
+                            WordIdArrayView(), wordId, nullptr /* multiBigramMap */));
+        }
+        if (nextToken == 0) {
+            return 0;
+        }
+        currentToken = nextToken;
+    }
+    return currentToken;
+}
+
+void Dictionary::addMemoryUsage(MemoryUsage *const outMemoryUsage) {
+    // Holding mUpdateMutex keeps the buffers from growing meanwhile.
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    outMemoryUsage->add(MemoryUsage::HEAP_BYTES, static_cast<int64_t>(sizeof(*this)));
+    mDictionaryStructureWithBufferPolicy->addMemoryUsage(outMemoryUsage);
+    if (mReplicaStructurePolicy) {
+        mReplicaStructurePolicy->addMemoryUsage(outMemoryUsage);
+    }
+    mTraverseSessionPool.addMemoryUsage(outMemoryUsage);
+    mPredictionCache.addMemoryUsage(outMemoryUsage);
+    mCompletionCache.addMemoryUsage(outMemoryUsage);
+    mUpdateLog.addMemoryUsage(outMemoryUsage);
+}
+
+void Dictionary::trimMemory(const int level) {
+    mPredictionCache.release();
+    mCompletionCache.release();
+    mTraverseSessionPool.trimMemory(level >= TRIM_MEMORY_ALL /* deletesIdleSessions */);
+    DicNodeSlabAllocator::getInstance()->trimMemory();
+    if (level < TRIM_MEMORY_ALL) {
+        return;
+    }
+    // Holding mUpdateMutex keeps the policies from being reopened meanwhile.
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    mDictionaryStructureWithBufferPolicy->releaseCleanPages();
+    if (mReplicaStructurePolicy) {
+        mReplicaStructurePolicy->releaseCleanPages();
+    }
+}
+
+void Dictionary::prewarm(DicTraverseSession *const traverseSession) const {
+    if (!traverseSession) {
+        DicTraverseSessionPool::ScopedSession leasedSession(&mTraverseSessionPool);
+        prewarm(leasedSession.get());
+        return;
+    }
+    const NativeTrace::ScopedSection section("Dictionary::prewarm");
+    TimeKeeper::setCurrentTime();
+    traverseSession->preallocateCaches();
+    const ScopedReadingPolicy readingPolicy(this);
+    DictionaryUtils::prefaultTopLevels(readingPolicy.get(), PREWARM_CODE_POINT_DEPTH);
+}
+
+void Dictionary::invalidatePredictionCacheForPrevWord(const NgramContext *const ngramContext) {
+    // Predictions are looked up with lower case search, but updates might be done with the exact
+    // word. Invalidate both.
+    for (const bool tryLowerCaseSearch : { false, true }) {
+        WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> prevWordIdArray;
+        const WordIdArrayView prevWordIds = ngramContext->getPrevWordIds(
+                getDictionaryStructurePolicy(), &prevWordIdArray, tryLowerCaseSearch);
+        if (!prevWordIds.empty()) {
+            mPredictionCache.invalidateEntriesForPrevWord(prevWordIds[0]);
+        }
+    }
+}
+
+void Dictionary::invalidatePredictionCacheForWord(const CodePointArrayView codePoints) {
+    mPredictionCache.invalidateEntriesForWord(getDictionaryStructurePolicy()->getWordId(
+            codePoints, false /* forceLowerCaseSearch */));
 }
 
 void Dictionary::logDictionaryInfo(JNIEnv *const env) const {
@@ -17,7 +17,12 @@
 #ifndef LATINIME_DICTIONARY_H
 #define LATINIME_DICTIONARY_H
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include "defines.h"
 #include "jni.h"
@@ -25,7 +30,12 @@
 #include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
 #include "dictionary/interface/ngram_listener.h"
 #include "dictionary/property/historical_info.h"
+#include "dictionary/property/word_attributes.h"
 #include "dictionary/property/word_property.h"
+#include "suggest/core/dictionary/completion_cache.h"
+#include "suggest/core/dictionary/dictionary_update_log.h"
+#include "suggest/core/dictionary/prediction_cache.h"
+#include "suggest/core/session/dic_traverse_session_pool.h"
 #include "suggest/core/suggest_interface.h"
 #include "utils/int_array_view.h"
 
@@ -33,6 +43,7 @@ namespace latinime {
 
 class DictionaryStructureWithBufferPolicy;
 class DicTraverseSession;
+class MemoryUsage;
 class NgramContext;
 class ProximityInfo;
 class SuggestionResults;
@@ -62,9 +73,27 @@ class Dictionary {
     static const int KIND_FLAG_EXACT_MATCH_WITH_INTENTIONAL_OMISSION = 0x20000000;
     static const int KIND_FLAG_APPROPRIATE_FOR_AUTOCORRECTION = 0x10000000;
 
+    // Must be equal to the TRIM_MEMORY_* constants in BinaryDictionary.java
+    // Frees the prediction and completion caches and the caches of the idle sessions.
+    static const int TRIM_MEMORY_CACHES = 1;
+    // Also deletes the idle sessions and drops the resident pages of the read-only buffers.
+    static const int TRIM_MEMORY_ALL = 2;
+
     Dictionary(JNIEnv *env, DictionaryStructureWithBufferPolicy::StructurePolicyPtr
-            dictionaryStructureWithBufferPolicy);
+            dictionaryStructureWithBufferPolicy, const bool usesLargeTraverseSessionCache);
 
+    // replicaStructurePolicy has to be a second policy for the same dictionary contents. Updates
+    // are applied to both of them in turn, so reads never wait for updates and always see a
+    // consistent version of the dictionary.
+    Dictionary(JNIEnv *env, DictionaryStructureWithBufferPolicy::StructurePolicyPtr
+            dictionaryStructureWithBufferPolicy,
+            DictionaryStructureWithBufferPolicy::StructurePolicyPtr replicaStructurePolicy,
+            const bool usesLargeTraverseSessionCache);
+
+    // This method can be called concurrently from multiple threads as long as each call uses its
+    // own traverseSession. Updates may run at the same time only when the dictionary has a replica
+    // policy. When traverseSession is nullptr, a session is leased from the dictionary's session
+    // pool for the duration of the call.
     void getSuggestions(ProximityInfo *proximityInfo, DicTraverseSession *traverseSession,
             int *xcoordinates, int *ycoordinates, int *times, int *pointerIds, int *inputCodePoints,
             int inputSize, const NgramContext *const ngramContext,
@@ -74,6 +103,8 @@ class Dictionary {
     void getPredictions(const NgramContext *const ngramContext,
             SuggestionResults *const outSuggestionResults) const;
 
+    // The lookups below don't use a traverse session and can be called concurrently from multiple
+    // threads, with the same guarantee for updates as getSuggestions().
     int getProbability(const CodePointArrayView codePoints) const;
 
     int getMaxProbabilityOfExactMatches(const CodePointArrayView codePoints) const;
@@ -84,6 +115,10 @@ class Dictionary {
     bool addUnigramEntry(const CodePointArrayView codePoints,
             const UnigramProperty *const unigramProperty);
 
+    // Much faster than adding the entries one by one when the dictionary is empty.
+    bool addUnigramEntries(const std::vector<CodePointArrayView> &codePoints,
+            const std::vector<UnigramProperty> &unigramProperties);
+
     bool removeUnigramEntry(const CodePointArrayView codePoints);
 
     bool addNgramEntry(const NgramProperty *const ngramProperty);
@@ -95,8 +130,27 @@ class Dictionary {
             const CodePointArrayView codePoints, const bool isValidWord,
             const HistoricalInfo historicalInfo);
 
+    // Batch version of updateEntriesForWordWithNgramContext for valid words. The updates are
+    // applied in order under one lock, and the count of the applied updates is returned, which is
+    // smaller than the count of the words when the dictionary needs GC.
+    int updateEntriesForWords(const std::vector<NgramContext> &ngramContexts,
+            const std::vector<CodePointArrayView> &codePoints,
+            const std::vector<HistoricalInfo> &historicalInfos);
+
+    // Replays the update log of the dictionary directory the dictionary has been opened from, and
+    // logs the updates from then on, so that flushing to that directory only appends to the log.
+    void openUpdateLog(const char *const dictDirPath);
+
+    // Replays the update log of the dictionary directory without logging the next updates or
+    // changing the log file, for a snapshot of a dictionary that is still in use.
+    void replayUpdateLog(const char *const dictDirPath);
+
+    // Appends the updates to the update log when possible, which doesn't block the updates
+    // while the log is written. Otherwise the whole dictionary is written.
     bool flush(const char *const filePath);
 
+    // GC updates the policy that is not being read, so the dictionary has to be reopened
+    // afterwards when it has a replica policy.
     bool flushWithGC(const char *const filePath);
 
     bool needsToRunGC(const bool mindsBlockByGC);
@@ -112,39 +166,172 @@ class Dictionary {
     int getNextWordAndNextToken(const int token, int *const outCodePoints,
             int *const outCodePointCount);
 
+    // Receives the words of getNextWordsAndNextToken().
+    class WordListener {
+     public:
+        // Returns whether a word of up to MAX_WORD_LENGTH code points can still be taken.
+        virtual bool canTakeWord() const = 0;
+        virtual void onVisitWord(const CodePointArrayView codePoints,
+                const WordAttributes &wordAttributes) = 0;
+
+     protected:
+        WordListener() {}
+        virtual ~WordListener() {}
+
+     private:
+        DISALLOW_COPY_AND_ASSIGN(WordListener);
+    };
+
+    // Same as getNextWordAndNextToken(), but gives the listener the words from token on with
+    // their unigram attributes for as long as it can take them, in one lock. The listener has to
+    // be able to take the first word.
+    int getNextWordsAndNextToken(const int token, WordListener *const listener);
+
+    // Adds the memory held by the policies, the idle sessions of the pool and the prediction and
+    // completion caches. Both policies are counted when there is a replica, even though they map
+    // the same files and the clean pages are shared.
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage);
+
+    // Frees memory that is rebuilt on demand. level is one of the TRIM_MEMORY_* constants.
+    // Sessions that are leased for a search are not touched.
+    void trimMemory(const int level);
+
+    // Maps the pages of the top levels of the trie and of their unigram entries, and allocates the
+    // caches of traverseSession, or of a pooled session when it is nullptr, so that the first
+    // search after a language switch doesn't wait for them.
+    void prewarm(DicTraverseSession *const traverseSession) const;
+
+    // The returned policy may be updated at any time. Use it only for data that updates don't
+    // change, e.g. the header.
     const DictionaryStructureWithBufferPolicy *getDictionaryStructurePolicy() const {
-        return mDictionaryStructureWithBufferPolicy.get();
+        return getStructurePolicy(mPublishedPolicyIndex.load());
     }
 
+    // Changes whenever the word ids of the dictionary may have changed. Generations are unique
+    // across all dictionaries, so the same generation always means the same dictionary content.
+    uint64_t getGeneration() const {
+        return mGeneration.load();
+    }
+
+    // The completions of the prefixes searched in this dictionary, see CompletionCache.
+    CompletionCache *getCompletionCache() const {
+        return &mCompletionCache;
+    }
+
+    // Keeps the published policy from being updated while it's read.
+    class ScopedReadingPolicy {
+     public:
+        explicit ScopedReadingPolicy(const Dictionary *const dictionary);
+        ~ScopedReadingPolicy();
+
+        const DictionaryStructureWithBufferPolicy *get() const {
+            return mDictionary->getStructurePolicy(mPolicyIndex);
+        }
+
+     private:
+        DISALLOW_IMPLICIT_CONSTRUCTORS(ScopedReadingPolicy);
+
+        const Dictionary *const mDictionary;
+        const int mPolicyIndex;
+    };
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(Dictionary);
 
     typedef std::unique_ptr<SuggestInterface> SuggestInterfacePtr;
 
+    // Keeps the most probable successors in a heap bounded by the max suggestion count of the
+    // results, so that only the successors that can be output are decoded into code points and
+    // added to the results by outputPredictions().
     class NgramListenerForPrediction : public NgramListener {
      public:
         NgramListenerForPrediction(const NgramContext *const ngramContext,
                 const WordIdArrayView prevWordIds, SuggestionResults *const suggestionResults,
-                const DictionaryStructureWithBufferPolicy *const dictStructurePolicy);
+                const DictionaryStructureWithBufferPolicy *const dictStructurePolicy,
+                std::vector<int> *const outVisitedWordIds);
         virtual void onVisitEntry(const int ngramProbability, const int targetWordId);
+        void outputPredictions();
 
      private:
         DISALLOW_IMPLICIT_CONSTRUCTORS(NgramListenerForPrediction);
 
+        typedef std::pair<int /* probability */, int /* wordId */> ProbabilityAndWordId;
+
         const NgramContext *const mNgramContext;
         const WordIdArrayView mPrevWordIds;
         SuggestionResults *const mSuggestionResults;
         const DictionaryStructureWithBufferPolicy *const mDictStructurePolicy;
+        std::vector<int> *const mVisitedWordIds;
+        // A min-heap on the probability.
+        std::vector<ProbabilityAndWordId> mMostProbableWords;
     };
 
     static const int HEADER_ATTRIBUTE_BUFFER_SIZE;
+    static std::atomic<uint64_t> sLastGeneration;
+    static const int PREWARM_CODE_POINT_DEPTH;
+    static const char *const TYPING_BEAM_WIDTH_QUERY;
+    static const char *const TYPING_DEGRADATION_LEVEL_QUERY;
 
     const DictionaryStructureWithBufferPolicy::StructurePolicyPtr
             mDictionaryStructureWithBufferPolicy;
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr mReplicaStructurePolicy;
+    // The index of the policy that new readers use: 0 for the main policy, 1 for the replica.
+    std::atomic<int> mPublishedPolicyIndex;
+    mutable std::atomic<int> mReaderCounts[2];
+    std::atomic<uint64_t> mGeneration;
+    // Serializes the updates and the other operations that need both policies to be in sync.
+    std::mutex mUpdateMutex;
+    // Serializes the flushes, which write the files without holding mUpdateMutex. Acquired before
+    // mUpdateMutex.
+    std::mutex mFlushMutex;
+    // GC has updated only one of the policies.
+    bool mNeedsReopening;
     const SuggestInterfacePtr mGestureSuggest;
     const SuggestInterfacePtr mTypingSuggest;
+    mutable DicTraverseSessionPool mTraverseSessionPool;
+    mutable PredictionCache mPredictionCache;
+    mutable CompletionCache mCompletionCache;
+    DictionaryUpdateLog mUpdateLog;
+
+    DictionaryStructureWithBufferPolicy *getStructurePolicy(const int index) const {
+        return index == 0 ? mDictionaryStructureWithBufferPolicy.get()
+                : mReplicaStructurePolicy.get();
+    }
+
+    // Writes the whole dictionary to filePath. mUpdateMutex has to be held.
+    bool writeDictionaryLocked(const char *const filePath);
+    int acquireReadingPolicyIndex() const;
+    void advanceGeneration() {
+        mGeneration.store(sLastGeneration.fetch_add(1) + 1);
+    }
+    void publishPolicyAndWaitForReaders(const int policyIndex);
+
+    // Applies the update to the policy that is not read, publishes it, and applies the update to
+    // the other policy once its readers have finished. mUpdateMutex has to be held. Returns the
+    // result of the first update.
+    template<typename UpdateFunction>
+    bool updateStructurePolicies(const UpdateFunction &update) {
+        if (!mReplicaStructurePolicy) {
+            const bool result = update(mDictionaryStructureWithBufferPolicy.get());
+            advanceGeneration();
+            return result;
+        }
+        if (mNeedsReopening) {
+            AKLOGE("The dictionary has to be reopened after GC.");
+            return false;
+        }
+        const int readPolicyIndex = mPublishedPolicyIndex.load();
+        const bool result = update(getStructurePolicy(1 - readPolicyIndex));
+        // Before the readers can see the updated policy.
+        advanceGeneration();
+        publishPolicyAndWaitForReaders(1 - readPolicyIndex);
+        update(getStructurePolicy(readPolicyIndex));
+        return result;
+    }
 
     void logDictionaryInfo(JNIEnv *const env) const;
+    void invalidatePredictionCacheForPrevWord(const NgramContext *const ngramContext);
+    void invalidatePredictionCacheForWord(const CodePointArrayView codePoints);
 };
 } // namespace latinime
 #endif // LATINIME_DICTIONARY_H
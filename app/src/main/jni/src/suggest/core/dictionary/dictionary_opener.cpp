@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/dictionary_opener.h"
+
+#include <utility>
+
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "suggest/core/dictionary/dictionary.h"
+#include "suggest/core/session/dic_traverse_session.h"
+#include "utils/native_trace.h"
+#include "utils/worker_thread_pool.h"
+
+namespace latinime {
+
+/* static */ std::unique_ptr<Dictionary> DictionaryOpener::openDictionary(JNIEnv *const env,
+        const DictionaryFile &dictionaryFile) {
+    OpenedPolicies policies;
+    if (!openPolicies(dictionaryFile, &policies)) {
+        return nullptr;
+    }
+    std::unique_ptr<Dictionary> dictionary = createDictionary(env, dictionaryFile, &policies);
+    if (dictionaryFile.mIsUpdatable) {
+        dictionary->openUpdateLog(dictionaryFile.mPath.c_str());
+    }
+    return dictionary;
+}
+
+/* static */ std::unique_ptr<Dictionary> DictionaryOpener::openSnapshot(JNIEnv *const env,
+        const char *const path) {
+    const NativeTrace::ScopedSection section("DictionaryOpener::openSnapshot");
+    // GC updates the policy in place, which needs a writable mapping.
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(
+                    path, 0 /* offset */, 0 /* size */, true /* isUpdatable */);
+    if (!policy) {
+        return nullptr;
+    }
+    std::unique_ptr<Dictionary> dictionary(new Dictionary(env, std::move(policy),
+            false /* usesLargeTraverseSessionCache */));
+    // Flushing only appends the updates to the log, so the dictionary file alone misses them.
+    dictionary->replayUpdateLog(path);
+    return dictionary;
+}
+
+/* static */ void DictionaryOpener::openDictionaries(JNIEnv *const env,
+        const std::vector<DictionaryFile> &dictionaryFiles,
+        std::vector<std::unique_ptr<Dictionary>> *const outDictionaries) {
+    const NativeTrace::ScopedSection section("DictionaryOpener::openDictionaries");
+    const size_t dictionaryCount = dictionaryFiles.size();
+    std::vector<OpenedPolicies> policies(dictionaryCount);
+    std::vector<WorkerThreadPool::Task> tasks;
+    tasks.reserve(dictionaryCount);
+    for (size_t i = 0; i < dictionaryCount; ++i) {
+        // The policies are left empty when the dictionary can't be opened.
+        tasks.emplace_back([&dictionaryFiles, &policies, i]() {
+            openPolicies(dictionaryFiles[i], &policies[i]);
+        });
+    }
+    WorkerThreadPool::getInstance()->runTasks(tasks);
+
+    // The dictionaries log to Java when created, which has to happen on the thread of the env.
+    outDictionaries->clear();
+    outDictionaries->reserve(dictionaryCount);
+    tasks.clear();
+    for (size_t i = 0; i < dictionaryCount; ++i) {
+        if (!policies[i].mPolicy) {
+            outDictionaries->emplace_back(nullptr);
+            continue;
+        }
+        outDictionaries->push_back(createDictionary(env, dictionaryFiles[i], &policies[i]));
+        if (dictionaryFiles[i].mIsUpdatable) {
+            Dictionary *const dictionary = outDictionaries->back().get();
+            const char *const path = dictionaryFiles[i].mPath.c_str();
+            tasks.emplace_back([dictionary, path]() {
+                dictionary->openUpdateLog(path);
+            });
+        }
+    }
+    WorkerThreadPool::getInstance()->runTasks(tasks);
+}
+
+/* static */ bool DictionaryOpener::openPolicies(const DictionaryFile &dictionaryFile,
+        OpenedPolicies *const outPolicies) {
+    const NativeTrace::ScopedSection section("DictionaryOpener::openPolicies");
+    outPolicies->mPolicy = DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(
+            dictionaryFile.mPath.c_str(), dictionaryFile.mOffset, dictionaryFile.mSize,
+            dictionaryFile.mIsUpdatable);
+    if (!outPolicies->mPolicy) {
+        return false;
+    }
+    // Updatable dictionaries keep a replica so that reads don't wait for updates.
+    if (dictionaryFile.mIsUpdatable) {
+        outPolicies->mReplicaPolicy =
+                DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(
+                        dictionaryFile.mPath.c_str(), dictionaryFile.mOffset,
+                        dictionaryFile.mSize, true /* isUpdatable */);
+        if (!outPolicies->mReplicaPolicy) {
+            AKLOGE("Cannot open the replica of the dictionary.");
+            outPolicies->mPolicy.reset();
+            return false;
+        }
+    }
+    return true;
+}
+
+/* static */ std::unique_ptr<Dictionary> DictionaryOpener::createDictionary(JNIEnv *const env,
+        const DictionaryFile &dictionaryFile, OpenedPolicies *const policies) {
+    return std::unique_ptr<Dictionary>(new Dictionary(env, std::move(policies->mPolicy),
+            std::move(policies->mReplicaPolicy),
+            DicTraverseSession::usesLargeCacheForDictionarySize(dictionaryFile.mSize)));
+}
+
+} // namespace latinime
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_DICTIONARY_OPENER_H
+#define LATINIME_DICTIONARY_OPENER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+#include "jni.h"
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+
+namespace latinime {
+
+class Dictionary;
+
+/**
+ * Opens dictionaries from their files. Several independent dictionaries (e.g. the main, user
+ * history, contacts and personal dictionaries at startup) can be opened in parallel on the
+ * WorkerThreadPool, since each pays for mapping its buffers, parsing its header and replaying its
+ * update log.
+ */
+class DictionaryOpener {
+ public:
+    struct DictionaryFile {
+        DictionaryFile(const char *const path, const int offset, const int size,
+                const bool isUpdatable)
+                : mPath(path), mOffset(offset), mSize(size), mIsUpdatable(isUpdatable) {}
+
+        std::string mPath;
+        int mOffset;
+        int mSize;
+        bool mIsUpdatable;
+    };
+
+    // Returns nullptr when the dictionary can't be opened.
+    static std::unique_ptr<Dictionary> openDictionary(JNIEnv *const env,
+            const DictionaryFile &dictionaryFile);
+
+    // Opens a snapshot of the dictionary at the path to run GC on, or returns nullptr. The file is
+    // mapped privately, so GC doesn't write to it, and the update log of the directory is replayed
+    // into the snapshot but left as is. Unlike an updatable dictionary, the snapshot has no replica
+    // and its updates are not logged.
+    static std::unique_ptr<Dictionary> openSnapshot(JNIEnv *const env, const char *const path);
+
+    // outDictionaries[i] is the dictionary of dictionaryFiles[i], or nullptr when it can't be
+    // opened. The env is only used on the calling thread.
+    static void openDictionaries(JNIEnv *const env,
+            const std::vector<DictionaryFile> &dictionaryFiles,
+            std::vector<std::unique_ptr<Dictionary>> *const outDictionaries);
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(DictionaryOpener);
+
+    // The policies of an updatable dictionary, and the replica that serves reads during updates.
+    struct OpenedPolicies {
+        DictionaryStructureWithBufferPolicy::StructurePolicyPtr mPolicy;
+        DictionaryStructureWithBufferPolicy::StructurePolicyPtr mReplicaPolicy;
+    };
+
+    static bool openPolicies(const DictionaryFile &dictionaryFile,
+            OpenedPolicies *const outPolicies);
+    static std::unique_ptr<Dictionary> createDictionary(JNIEnv *const env,
+            const DictionaryFile &dictionaryFile, OpenedPolicies *const policies);
+};
+} // namespace latinime
+#endif // LATINIME_DICTIONARY_OPENER_H
@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define LOG_TAG "LatinIME: dictionary_update_log.cpp"
+
+#include "suggest/core/dictionary/dictionary_update_log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dictionary/property/historical_info.h"
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/property/ngram_property.h"
+#include "dictionary/property/unigram_property.h"
+#include "dictionary/utils/file_utils.h"
+#include "suggest/core/dictionary/dictionary.h"
+
+namespace latinime {
+
+const char *const DictionaryUpdateLog::LOG_FILE_NAME = "update.log";
+// Replaying is much cheaper than writing the dictionary, but it runs on each open.
+const int DictionaryUpdateLog::MAX_LOG_FILE_SIZE = 256 * 1024;
+// The payload size, the record type and the checksum.
+const int DictionaryUpdateLog::RECORD_OVERHEAD_IN_WORDS = 3;
+
+void DictionaryUpdateLog::openAndReplay(const char *const dictDirPath,
+        Dictionary *const dictionary) {
+    mLogFilePath.clear();
+    mLogFileSize = 0;
+    mPendingRecords.clear();
+    if (!FileUtils::existsDir(dictDirPath)) {
+        return;
+    }
+    const std::string logFilePath = getLogFilePath(dictDirPath);
+    int fileSize = 0;
+    const int validSize = replayLogFile(logFilePath, dictionary, &fileSize);
+    if (validSize < fileSize) {
+        // Drop the torn tail, so that the records appended next are readable.
+        AKLOGE("The dictionary update log is truncated. size: %d, valid size: %d", fileSize,
+                validSize);
+        if (truncate(logFilePath.c_str(), validSize) != 0) {
+            AKLOGE("Cannot truncate the dictionary update log. errno: %d", errno);
+            return;
+        }
+    }
+    // Start logging after replaying, so that the replayed updates are not logged again.
+    mLogFilePath = logFilePath;
+    mLogFileSize = validSize;
+}
+
+/* static */ void DictionaryUpdateLog::replay(const char *const dictDirPath,
+        Dictionary *const dictionary) {
+    if (!FileUtils::existsDir(dictDirPath)) {
+        return;
+    }
+    int fileSize = 0;
+    replayLogFile(getLogFilePath(dictDirPath), dictionary, &fileSize);
+}
+
+bool DictionaryUpdateLog::takePendingRecords(const char *const dictDirPath,
+        std::vector<int32_t> *const outRecords) {
+    outRecords->clear();
+    if (mLogFilePath.empty() || mLogFilePath != getLogFilePath(dictDirPath)
+            || mRequiresDictionaryWrite) {
+        return false;
+    }
+    const int pendingSize = static_cast<int>(mPendingRecords.size() * sizeof(int32_t));
+    if (mLogFileSize + pendingSize > MAX_LOG_FILE_SIZE) {
+        return false;
+    }
+    outRecords->swap(mPendingRecords);
+    return true;
+}
+
+bool DictionaryUpdateLog::appendRecords(const std::vector<int32_t> &records) {
+    if (records.empty()) {
+        return true;
+    }
+    const int recordsSize = static_cast<int>(records.size() * sizeof(int32_t));
+    const int fd = open(mLogFilePath.c_str(), O_WRONLY | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        AKLOGE("Cannot open the dictionary update log %s. errno: %d", mLogFilePath.c_str(), errno);
+        return false;
+    }
+    const ssize_t writtenSize = write(fd, records.data(), recordsSize);
+    const bool succeeded = writtenSize == recordsSize && fsync(fd) == 0;
+    close(fd);
+    if (!succeeded) {
+        AKLOGE("Cannot write the dictionary update log %s. errno: %d", mLogFilePath.c_str(),
+                errno);
+        if (writtenSize > 0 && truncate(mLogFilePath.c_str(), mLogFileSize) != 0) {
+            // Replaying drops the partially written records anyway.
+            AKLOGE("Cannot truncate the dictionary update log. errno: %d", errno);
+        }
+        return false;
+    }
+    mLogFileSize += recordsSize;
+    return true;
+}
+
+void DictionaryUpdateLog::onDictionaryWritten(const char *const dictDirPath) {
+    mPendingRecords.clear();
+    mRequiresDictionaryWrite = false;
+    if (mLogFilePath.empty() || mLogFilePath != getLogFilePath(dictDirPath)) {
+        return;
+    }
+    // Writing the dictionary has replaced the directory and the log in it.
+    mLogFileSize = 0;
+}
+
+void DictionaryUpdateLog::logAddUnigramEntry(const CodePointArrayView codePoints,
+        const UnigramProperty *const unigramProperty) {
+    if (mLogFilePath.empty()) {
+        return;
+    }
+    const size_t recordStart = beginRecord(ADD_UNIGRAM_ENTRY);
+    pushCodePoints(codePoints);
+    mPendingRecords.push_back((unigramProperty->representsBeginningOfSentence() ? 0x1 : 0)
+            | (unigramProperty->isNotAWord() ? 0x2 : 0)
+            | (unigramProperty->isBlacklisted() ? 0x4 : 0)
+            | (unigramProperty->isPossiblyOffensive() ? 0x8 : 0));
+    mPendingRecords.push_back(unigramProperty->getProbability());
+    const HistoricalInfo historicalInfo = unigramProperty->getHistoricalInfo();
+    pushHistoricalInfo(&historicalInfo);
+    mPendingRecords.push_back(unigramProperty->getShortcuts().size());
+    for (const auto &shortcut : unigramProperty->getShortcuts()) {
+        pushCodePoints(CodePointArrayView(*shortcut.getTargetCodePoints()));
+        mPendingRecords.push_back(shortcut.getProbability());
+    }
+    endRecord(recordStart);
+}
+
+void DictionaryUpdateLog::logRemoveUnigramEntry(const CodePointArrayView codePoints) {
+    if (mLogFilePath.empty()) {
+        return;
+    }
+    const size_t recordStart = beginRecord(REMOVE_UNIGRAM_ENTRY);
+    pushCodePoints(codePoints);
+    endRecord(recordStart);
+}
+
+void DictionaryUpdateLog::logAddNgramEntry(const NgramProperty *const ngramProperty) {
+    if (mLogFilePath.empty()) {
+        return;
+    }
+    const size_t recordStart = beginRecord(ADD_NGRAM_ENTRY);
+    pushNgramContext(ngramProperty->getNgramContext());
+    pushCodePoints(CodePointArrayView(*ngramProperty->getTargetCodePoints()));
+    mPendingRecords.push_back(ngramProperty->getProbability());
+    const HistoricalInfo historicalInfo = ngramProperty->getHistoricalInfo();
+    pushHistoricalInfo(&historicalInfo);
+    endRecord(recordStart);
+}
+
+void DictionaryUpdateLog::logRemoveNgramEntry(const NgramContext *const ngramContext,
+        const CodePointArrayView codePoints) {
+    if (mLogFilePath.empty()) {
+        return;
+    }
+    const size_t recordStart = beginRecord(REMOVE_NGRAM_ENTRY);
+    pushNgramContext(ngramContext);
+    pushCodePoints(codePoints);
+    endRecord(recordStart);
+}
+
+void DictionaryUpdateLog::logUpdateEntriesForWord(const NgramContext *const ngramContext,
+        const CodePointArrayView codePoints, const bool isValidWord,
+        const HistoricalInfo *const historicalInfo) {
+    if (mLogFilePath.empty()) {
+        return;
+    }
+    const size_t recordStart = beginRecord(UPDATE_ENTRIES_FOR_WORD);
+    pushNgramContext(ngramContext);
+    pushCodePoints(codePoints);
+    mPendingRecords.push_back(isValidWord ? 1 : 0);
+    pushHistoricalInfo(historicalInfo);
+    endRecord(recordStart);
+}
+
+/* static */ int DictionaryUpdateLog::replayLogFile(const std::string &logFilePath,
+        Dictionary *const dictionary, int *const outFileSize) {
+    const int fileSize = FileUtils::getFileSize(logFilePath.c_str());
+    *outFileSize = fileSize;
+    if (fileSize <= 0) {
+        return 0;
+    }
+    std::vector<int32_t> words(fileSize / sizeof(int32_t));
+    FILE *const file = fopen(logFilePath.c_str(), "rb");
+    const size_t readWordCount = file ? fread(words.data(), sizeof(int32_t), words.size(),
+            file) : 0;
+    if (file) {
+        fclose(file);
+    }
+    size_t pos = 0;
+    while (pos + RECORD_OVERHEAD_IN_WORDS <= readWordCount) {
+        const int payloadSize = words[pos];
+        if (payloadSize < 0 || pos + RECORD_OVERHEAD_IN_WORDS + payloadSize > readWordCount) {
+            break;
+        }
+        const int32_t *const typeAndPayload = &words[pos + 1];
+        if (getChecksum(typeAndPayload, payloadSize + 1)
+                != static_cast<uint32_t>(typeAndPayload[payloadSize + 1])) {
+            break;
+        }
+        RecordReader reader(typeAndPayload + 1, payloadSize);
+        if (!replayRecord(typeAndPayload[0], &reader, dictionary)) {
+            AKLOGE("Cannot replay a record of the dictionary update log. type: %d",
+                    typeAndPayload[0]);
+        }
+        pos += RECORD_OVERHEAD_IN_WORDS + payloadSize;
+    }
+    return static_cast<int>(pos * sizeof(int32_t));
+}
+
+/* static */ bool DictionaryUpdateLog::replayRecord(const int type, RecordReader *const reader,
+        Dictionary *const dictionary) {
+    std::vector<int> codePoints;
+    int prevWordCodePoints[MAX_PREV_WORD_COUNT_FOR_N_GRAM][MAX_WORD_LENGTH];
+    int prevWordCodePointCount[MAX_PREV_WORD_COUNT_FOR_N_GRAM];
+    bool isBeginningOfSentence[MAX_PREV_WORD_COUNT_FOR_N_GRAM];
+    size_t prevWordCount = 0;
+    switch (type) {
+        case ADD_UNIGRAM_ENTRY: {
+            reader->readCodePoints(&codePoints);
+            const int flags = reader->readInt();
+            const int probability = reader->readInt();
+            const int timestamp = reader->readInt();
+            const int level = reader->readInt();
+            const int count = reader->readInt();
+            const int shortcutCount = reader->readInt();
+            std::vector<UnigramProperty::ShortcutProperty> shortcuts;
+            for (int i = 0; i < shortcutCount && !reader->hasFailed(); ++i) {
+                std::vector<int> targetCodePoints;
+                reader->readCodePoints(&targetCodePoints);
+                shortcuts.emplace_back(std::move(targetCodePoints), reader->readInt());
+            }
+            if (reader->hasFailed()) {
+                return false;
+            }
+            const UnigramProperty unigramProperty((flags & 0x1) != 0, (flags & 0x2) != 0,
+                    (flags & 0x4) != 0, (flags & 0x8) != 0, probability,
+                    HistoricalInfo(timestamp, level, count), std::move(shortcuts));
+            return dictionary->addUnigramEntry(CodePointArrayView(codePoints), &unigramProperty);
+        }
+        case REMOVE_UNIGRAM_ENTRY:
+            reader->readCodePoints(&codePoints);
+            if (reader->hasFailed()) {
+                return false;
+            }
+            return dictionary->removeUnigramEntry(CodePointArrayView(codePoints));
+        case ADD_NGRAM_ENTRY: {
+            reader->readNgramContext(prevWordCodePoints, prevWordCodePointCount,
+                    isBeginningOfSentence, &prevWordCount);
+            reader->readCodePoints(&codePoints);
+            const int probability = reader->readInt();
+            const int timestamp = reader->readInt();
+            const int level = reader->readInt();
+            const int count = reader->readInt();
+            if (reader->hasFailed()) {
+                return false;
+            }
+            const NgramProperty ngramProperty(NgramContext(prevWordCodePoints,
+                    prevWordCodePointCount, isBeginningOfSentence, prevWordCount),
+                    std::move(codePoints), probability, HistoricalInfo(timestamp, level, count));
+            return dictionary->addNgramEntry(&ngramProperty);
+        }
+        case REMOVE_NGRAM_ENTRY: {
+            reader->readNgramContext(prevWordCodePoints, prevWordCodePointCount,
+                    isBeginningOfSentence, &prevWordCount);
+            reader->readCodePoints(&codePoints);
+            if (reader->hasFailed()) {
+                return false;
+            }
+            const NgramContext ngramContext(prevWordCodePoints, prevWordCodePointCount,
+                    isBeginningOfSentence, prevWordCount);
+            return dictionary->removeNgramEntry(&ngramContext, CodePointArrayView(codePoints));
+        }
+        case UPDATE_ENTRIES_FOR_WORD: {
+            reader->readNgramContext(prevWordCodePoints, prevWordCodePointCount,
+                    isBeginningOfSentence, &prevWordCount);
+            reader->readCodePoints(&codePoints);
+            const bool isValidWord = reader->readInt() != 0;
+            const int timestamp = reader->readInt();
+            const int level = reader->readInt();
+            const int count = reader->readInt();
+            if (reader->hasFailed()) {
+                return false;
+            }
+            const NgramContext ngramContext(prevWordCodePoints, prevWordCodePointCount,
+                    isBeginningOfSentence, prevWordCount);
+            return dictionary->updateEntriesForWordWithNgramContext(&ngramContext,
+                    CodePointArrayView(codePoints), isValidWord,
+                    HistoricalInfo(timestamp, level, count));
+        }
+        default:
+            return false;
+    }
+}
+
+// FNV-1a over the words.
+/* static */ uint32_t DictionaryUpdateLog::getChecksum(const int32_t *const words,
+        const int count) {
+    uint32_t checksum = 2166136261u;
+    for (int i = 0; i < count; ++i) {
+        checksum = (checksum ^ static_cast<uint32_t>(words[i])) * 16777619u;
+    }
+    return checksum;
+}
+
+/* static */ std::string DictionaryUpdateLog::getLogFilePath(const char *const dictDirPath) {
+    const int filePathBufSize = FileUtils::getFilePathBufSize(dictDirPath, LOG_FILE_NAME);
+    char filePath[filePathBufSize];
+    FileUtils::getFilePath(dictDirPath, LOG_FILE_NAME, filePathBufSize, filePath);
+    return std::string(filePath);
+}
+
+size_t DictionaryUpdateLog::beginRecord(const RecordType type) {
+    const size_t recordStart = mPendingRecords.size();
+    mPendingRecords.push_back(0 /* payload size, set by endRecord() */);
+    mPendingRecords.push_back(type);
+    return recordStart;
+}
+
+void DictionaryUpdateLog::endRecord(const size_t recordStart) {
+    const int typeAndPayloadSize = static_cast<int>(mPendingRecords.size() - recordStart - 1);
+    mPendingRecords[recordStart] = typeAndPayloadSize - 1;
+    mPendingRecords.push_back(getChecksum(&mPendingRecords[recordStart + 1], typeAndPayloadSize));
+}
+
+void DictionaryUpdateLog::pushCodePoints(const CodePointArrayView codePoints) {
+    mPendingRecords.push_back(codePoints.size());
+    mPendingRecords.insert(mPendingRecords.end(), codePoints.begin(), codePoints.end());
+}
+
+void DictionaryUpdateLog::pushNgramContext(const NgramContext *const ngramContext) {
+    mPendingRecords.push_back(ngramContext->getPrevWordCount());
+    for (size_t n = 1; n <= ngramContext->getPrevWordCount(); ++n) {
+        mPendingRecords.push_back(ngramContext->isNthPrevWordBeginningOfSentence(n) ? 1 : 0);
+        pushCodePoints(ngramContext->getNthPrevWordCodePoints(n));
+    }
+}
+
+void DictionaryUpdateLog::pushHistoricalInfo(const HistoricalInfo *const historicalInfo) {
+    mPendingRecords.push_back(historicalInfo->getTimestamp());
+    mPendingRecords.push_back(historicalInfo->getLevel());
+    mPendingRecords.push_back(historicalInfo->getCount());
+}
+
+int DictionaryUpdateLog::RecordReader::readInt() {
+    if (mPos >= mSize) {
+        mHasFailed = true;
+        return 0;
+    }
+    return mPayload[mPos++];
+}
+
+bool DictionaryUpdateLog::RecordReader::readCodePoints(std::vector<int> *const outCodePoints) {
+    const int count = readInt();
+    if (count < 0 || count > MAX_WORD_LENGTH || count > mSize - mPos) {
+        mHasFailed = true;
+        return false;
+    }
+    outCodePoints->assign(mPayload + mPos, mPayload + mPos + count);
+    mPos += count;
+    return true;
+}
+
+bool DictionaryUpdateLog::RecordReader::readNgramContext(
+        int prevWordCodePoints[][MAX_WORD_LENGTH], int *const outPrevWordCodePointCount,
+        bool *const outIsBeginningOfSentence, size_t *const outPrevWordCount) {
+    const int prevWordCount = readInt();
+    if (prevWordCount < 0 || prevWordCount > MAX_PREV_WORD_COUNT_FOR_N_GRAM) {
+        mHasFailed = true;
+        return false;
+    }
+    std::vector<int> codePoints;
+    for (int i = 0; i < prevWordCount; ++i) {
+        outIsBeginningOfSentence[i] = readInt() != 0;
+        if (!readCodePoints(&codePoints)) {
+            return false;
+        }
+        std::copy(codePoints.begin(), codePoints.end(), prevWordCodePoints[i]);
+        outPrevWordCodePointCount[i] = static_cast<int>(codePoints.size());
+    }
+    *outPrevWordCount = prevWordCount;
+    return true;
+}
+
+} // namespace latinime
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef LATINIME_DICTIONARY_UPDATE_LOG_H
+#define LATINIME_DICTIONARY_UPDATE_LOG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+#include "utils/int_array_view.h"
+#include "utils/memory_usage.h"
+
+namespace latinime {
+
+class Dictionary;
+class HistoricalInfo;
+class NgramContext;
+class NgramProperty;
+class UnigramProperty;
+
+/**
+ * Append-only log of the updates made to an updatable dictionary since its files were last
+ * written. Flushing appends the new records to a log file in the dictionary directory instead of
+ * rewriting the whole dictionary, and opening the dictionary replays the log. Writing the whole
+ * dictionary (a full flush or GC) replaces the directory, which folds the log into the image.
+ *
+ * Each record is a sequence of int32 words: the payload size, the record type, the payload and a
+ * checksum of the type and the payload. A torn record at the end of the file (e.g. after a crash
+ * while appending) is dropped.
+ */
+class DictionaryUpdateLog {
+ public:
+    DictionaryUpdateLog()
+            : mLogFilePath(), mLogFileSize(0), mPendingRecords(), mRequiresDictionaryWrite(false) {}
+
+    // Replays the log of the dictionary directory and starts logging the updates of dictionary.
+    // Does nothing for dictionaries that are not in a directory.
+    void openAndReplay(const char *const dictDirPath, Dictionary *const dictionary);
+
+    // Replays the log of the dictionary directory without changing the log file, e.g. into a
+    // snapshot of the dictionary while the dictionary keeps appending to the log.
+    static void replay(const char *const dictDirPath, Dictionary *const dictionary);
+
+    // Moves the updates to be appended to the log of dictDirPath to outRecords, so that they can
+    // be written while the next updates are logged. When false is returned, the whole dictionary
+    // has to be written, followed by onDictionaryWritten().
+    bool takePendingRecords(const char *const dictDirPath,
+            std::vector<int32_t> *const outRecords);
+
+    // Appends the records taken by takePendingRecords() to the log. The caller serializes the
+    // appends and the dictionary writes. When false is returned, the records have been dropped
+    // and the whole dictionary has to be written.
+    bool appendRecords(const std::vector<int32_t> &records);
+
+    // Called when the whole dictionary has been written to dictDirPath.
+    void onDictionaryWritten(const char *const dictDirPath);
+
+    // Makes the next flush write the whole dictionary, for updates that are not logged.
+    void requireDictionaryWrite() {
+        mRequiresDictionaryWrite = true;
+    }
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mPendingRecords);
+    }
+
+    void logAddUnigramEntry(const CodePointArrayView codePoints,
+            const UnigramProperty *const unigramProperty);
+    void logRemoveUnigramEntry(const CodePointArrayView codePoints);
+    void logAddNgramEntry(const NgramProperty *const ngramProperty);
+    void logRemoveNgramEntry(const NgramContext *const ngramContext,
+            const CodePointArrayView codePoints);
+    void logUpdateEntriesForWord(const NgramContext *const ngramContext,
+            const CodePointArrayView codePoints, const bool isValidWord,
+            const HistoricalInfo *const historicalInfo);
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(DictionaryUpdateLog);
+
+    enum RecordType {
+        ADD_UNIGRAM_ENTRY = 1,
+        REMOVE_UNIGRAM_ENTRY = 2,
+        ADD_NGRAM_ENTRY = 3,
+        REMOVE_NGRAM_ENTRY = 4,
+        UPDATE_ENTRIES_FOR_WORD = 5,
+    };
+
+    // Reads the fields of a record payload. Reading past the end marks the reader as failed.
+    class RecordReader {
+     public:
+        RecordReader(const int32_t *const payload, const int size)
+                : mPayload(payload), mSize(size), mPos(0), mHasFailed(false) {}
+
+        int readInt();
+        bool readCodePoints(std::vector<int> *const outCodePoints);
+        bool readNgramContext(int prevWordCodePoints[][MAX_WORD_LENGTH],
+                int *const outPrevWordCodePointCount, bool *const outIsBeginningOfSentence,
+                size_t *const outPrevWordCount);
+
+        bool hasFailed() const {
+            return mHasFailed || mPos != mSize;
+        }
+
+     private:
+        DISALLOW_IMPLICIT_CONSTRUCTORS(RecordReader);
+
+        const int32_t *const mPayload;
+        const int mSize;
+        int mPos;
+        bool mHasFailed;
+    };
+
+    static const char *const LOG_FILE_NAME;
+    static const int MAX_LOG_FILE_SIZE;
+    static const int RECORD_OVERHEAD_IN_WORDS;
+
+    // Replays the valid records of the log file and returns their size. outFileSize is the size
+    // of the file, which is larger when the file has a torn tail.
+    static int replayLogFile(const std::string &logFilePath, Dictionary *const dictionary,
+            int *const outFileSize);
+    static bool replayRecord(const int type, RecordReader *const reader,
+            Dictionary *const dictionary);
+    static uint32_t getChecksum(const int32_t *const words, const int count);
+    static std::string getLogFilePath(const char *const dictDirPath);
+
+    size_t beginRecord(const RecordType type);
+    void endRecord(const size_t recordStart);
+    void pushCodePoints(const CodePointArrayView codePoints);
+    void pushNgramContext(const NgramContext *const ngramContext);
+    void pushHistoricalInfo(const HistoricalInfo *const historicalInfo);
+
+    // Empty when the updates are not logged.
+    std::string mLogFilePath;
+    int mLogFileSize;
+    std::vector<int32_t> mPendingRecords;
+    bool mRequiresDictionaryWrite;
+};
+} // namespace latinime
+#endif // LATINIME_DICTIONARY_UPDATE_LOG_H
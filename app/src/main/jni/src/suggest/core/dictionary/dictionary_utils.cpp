@@ -30,6 +30,15 @@ namespace latinime {
 /* static */ int DictionaryUtils::getMaxProbabilityOfExactMatches(
         const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
         const CodePointArrayView codePoints) {
+    const DigraphUtils::DigraphType digraphType = DigraphUtils::getDigraphTypeForDictionary(
+            dictionaryStructurePolicy->getHeaderStructurePolicy());
+    // The index of the policy doesn't have the digraphs.
+    int indexedMaxProbability = NOT_A_PROBABILITY;
+    if (digraphType == DigraphUtils::DIGRAPH_TYPE_NONE
+            && dictionaryStructurePolicy->getMaxProbabilityOfExactMatches(codePoints,
+                    &indexedMaxProbability)) {
+        return indexedMaxProbability;
+    }
     std::vector<DicNode> current;
     std::vector<DicNode> next;
 
@@ -49,7 +58,8 @@ namespace latinime {
                 next.back().advanceDigraphIndex();
                 continue;
             }
-            processChildDicNodes(dictionaryStructurePolicy, baseLowerCodePoint, &dicNode, &next);
+            processChildDicNodes(dictionaryStructurePolicy, digraphType, baseLowerCodePoint,
+                    &dicNode, &next);
         }
         current.clear();
         current.swap(next);
@@ -69,10 +79,39 @@ namespace latinime {
     return maxProbability;
 }
 
+/* static */ int DictionaryUtils::prefaultTopLevels(
+        const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
+        const int codePointDepth) {
+    std::vector<DicNode> current;
+    std::vector<DicNode> next;
+    current.emplace_back();
+    DicNodeUtils::initAsRoot(dictionaryStructurePolicy, WordIdArrayView(), &current.front());
+    int wordCount = 0;
+    for (int depth = 0; depth < codePointDepth && !current.empty(); ++depth) {
+        for (const DicNode &dicNode : current) {
+            DicNodeVector childDicNodes;
+            DicNodeUtils::getAllChildDicNodes(&dicNode, dictionaryStructurePolicy,
+                    &childDicNodes);
+            for (int childIndex = 0; childIndex < childDicNodes.getSizeAndLock(); ++childIndex) {
+                const DicNode *const childDicNode = childDicNodes[childIndex];
+                if (childDicNode->isTerminalDicNode()) {
+                    dictionaryStructurePolicy->getWordAttributesInContext(WordIdArrayView(),
+                            childDicNode->getWordId(), nullptr /* multiBigramMap */);
+                    ++wordCount;
+                }
+                next.emplace_back(*childDicNode);
+            }
+        }
+        current.clear();
+        current.swap(next);
+    }
+    return wordCount;
+}
+
 /* static */ void DictionaryUtils::processChildDicNodes(
         const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
-        const int inputCodePoint, const DicNode *const parentDicNode,
-        std::vector<DicNode> *const outDicNodes) {
+        const DigraphUtils::DigraphType digraphType, const int inputCodePoint,
+        const DicNode *const parentDicNode, std::vector<DicNode> *const outDicNodes) {
     DicNodeVector childDicNodes;
     DicNodeUtils::getAllChildDicNodes(parentDicNode, dictionaryStructurePolicy, &childDicNodes);
     for (int childIndex = 0; childIndex < childDicNodes.getSizeAndLock(); ++childIndex) {
@@ -82,12 +121,10 @@ namespace latinime {
             outDicNodes->emplace_back(*childDicNode);
         }
         if (childDicNode->canBeIntentionalOmission()) {
-            processChildDicNodes(dictionaryStructurePolicy, inputCodePoint, childDicNode,
-                    outDicNodes);
+            processChildDicNodes(dictionaryStructurePolicy, digraphType, inputCodePoint,
+                    childDicNode, outDicNodes);
         }
-        if (DigraphUtils::hasDigraphForCodePoint(
-                dictionaryStructurePolicy->getHeaderStructurePolicy(),
-                childDicNode->getNodeCodePoint())) {
+        if (DigraphUtils::hasDigraphForCodePoint(digraphType, childDicNode->getNodeCodePoint())) {
             childDicNode->advanceDigraphIndex();
             if (childDicNode->getNodeCodePoint() == codePoint) {
                 childDicNode->advanceDigraphIndex();
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "defines.h"
+#include "suggest/core/dictionary/digraph_utils.h"
 #include "utils/int_array_view.h"
 
 namespace latinime {
@@ -33,13 +34,19 @@ class DictionaryUtils {
             const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
             const CodePointArrayView codePoints);
 
+    // Reads the PtNodes of the words up to codePointDepth code points and the unigram entries of
+    // them, so that their pages are mapped. Returns the count of the words that have been read.
+    static int prefaultTopLevels(
+            const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
+            const int codePointDepth);
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(DictionaryUtils);
 
     static void processChildDicNodes(
             const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
-            const int inputCodePoint, const DicNode *const parentDicNode,
-            std::vector<DicNode> *const outDicNodes);
+            const DigraphUtils::DigraphType digraphType, const int inputCodePoint,
+            const DicNode *const parentDicNode, std::vector<DicNode> *const outDicNodes);
 };
 } // namespace latinime
 #endif // LATINIME_DICTIONARY_UTILS_H
@@ -30,18 +30,25 @@ const DigraphUtils::digraph_t DigraphUtils::GERMAN_UMLAUT_DIGRAPHS[] =
         { 'u', 'e', 0x00FC } }; // U+00FC : LATIN SMALL LETTER U WITH DIAERESIS
 const DigraphUtils::DigraphType DigraphUtils::USED_DIGRAPH_TYPES[] =
         { DIGRAPH_TYPE_GERMAN_UMLAUT };
+const int DigraphUtils::DIGRAPH_TABLE_SIZE;
+
+DigraphUtils::DigraphTables::DigraphTables() : mDigraphs() {
+    for (int digraphType = 0; digraphType < DIGRAPH_TYPE_COUNT; ++digraphType) {
+        for (int codePoint = 0; codePoint < DIGRAPH_TABLE_SIZE; ++codePoint) {
+            mDigraphs[digraphType][codePoint] =
+                    getDigraphForDigraphTypeAndLowerCaseCodePoint(
+                            static_cast<DigraphType>(digraphType), codePoint);
+        }
+    }
+}
 
 /* static */ bool DigraphUtils::hasDigraphForCodePoint(
         const DictionaryHeaderStructurePolicy *const headerPolicy,
         const int compositeGlyphCodePoint) {
-    const DigraphUtils::DigraphType digraphType = getDigraphTypeForDictionary(headerPolicy);
-    if (DigraphUtils::getDigraphForDigraphTypeAndCodePoint(digraphType, compositeGlyphCodePoint)) {
-        return true;
-    }
-    return false;
+    return hasDigraphForCodePoint(getDigraphTypeForDictionary(headerPolicy),
+            compositeGlyphCodePoint);
 }
 
-// Returns the digraph type associated with the given dictionary.
 /* static */ DigraphUtils::DigraphType DigraphUtils::getDigraphTypeForDictionary(
         const DictionaryHeaderStructurePolicy *const headerPolicy) {
     if (headerPolicy->requiresGermanUmlautProcessing()) {
@@ -99,13 +106,11 @@ const DigraphUtils::DigraphType DigraphUtils::USED_DIGRAPH_TYPES[] =
     return nullptr;
 }
 
-/**
- * Returns the digraph for the input composite glyph codepoint, or nullptr if none exists.
- * digraphType: the type of digraphs supported.
- * compositeGlyphCodePoint: the method returns the digraph corresponding to this codepoint.
- */
-/* static */ const DigraphUtils::digraph_t *DigraphUtils::getDigraphForDigraphTypeAndCodePoint(
-        const DigraphUtils::DigraphType digraphType, const int compositeGlyphCodePoint) {
+// Scans the digraphs of the type for the lower case of the code point. Only used to fill the
+// digraph tables and for the code points out of them.
+/* static */ const DigraphUtils::digraph_t *
+        DigraphUtils::getDigraphForDigraphTypeAndLowerCaseCodePoint(
+                const DigraphUtils::DigraphType digraphType, const int compositeGlyphCodePoint) {
     const DigraphUtils::digraph_t *digraphs = nullptr;
     const int compositeGlyphLowerCodePoint = CharUtils::toLowerCase(compositeGlyphCodePoint);
     const int digraphsSize =
@@ -34,23 +34,74 @@ class DigraphUtils {
     typedef enum {
         DIGRAPH_TYPE_NONE,
         DIGRAPH_TYPE_GERMAN_UMLAUT,
+        DIGRAPH_TYPE_COUNT
     } DigraphType;
 
     typedef struct { int first; int second; int compositeGlyph; } digraph_t;
 
+    // Returns the digraph type associated with the given dictionary. The searches resolve it once
+    // per dictionary, see DicTraverseSession::getDigraphType().
+    static DigraphType getDigraphTypeForDictionary(
+            const DictionaryHeaderStructurePolicy *const headerPolicy);
     static bool hasDigraphForCodePoint(const DictionaryHeaderStructurePolicy *const headerPolicy,
             const int compositeGlyphCodePoint);
+    // As cheap as a code point comparison for the composite glyphs, all of which are in
+    // Latin-1.
+    static AK_FORCE_INLINE bool hasDigraphForCodePoint(const DigraphType digraphType,
+            const int compositeGlyphCodePoint) {
+        return getDigraphForDigraphTypeAndCodePoint(digraphType, compositeGlyphCodePoint)
+                != nullptr;
+    }
     static int getDigraphCodePointForIndex(const int compositeGlyphCodePoint,
             const DigraphCodePointIndex digraphCodePointIndex);
 
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(DigraphUtils);
-    static DigraphType getDigraphTypeForDictionary(
-            const DictionaryHeaderStructurePolicy *const headerPolicy);
+
+    // Code points of DIGRAPH_TABLE_SIZE or more are looked up by their lower case.
+    static const int DIGRAPH_TABLE_SIZE = 0x100;
+
+    // The digraph of each code point and its upper case, for each digraph type.
+    class DigraphTables {
+     public:
+        DigraphTables();
+
+        AK_FORCE_INLINE const digraph_t *getDigraph(const DigraphType digraphType,
+                const int compositeGlyphCodePoint) const {
+            return mDigraphs[digraphType][compositeGlyphCodePoint];
+        }
+
+     private:
+        DISALLOW_COPY_AND_ASSIGN(DigraphTables);
+
+        const digraph_t *mDigraphs[DIGRAPH_TYPE_COUNT][DIGRAPH_TABLE_SIZE];
+    };
+
+    // Built on first use since it depends on the case mapping of CharUtils, which is initialized
+    // at load time too.
+    static AK_FORCE_INLINE const DigraphTables &getDigraphTables() {
+        static const DigraphTables sDigraphTables;
+        return sDigraphTables;
+    }
+
     static int getAllDigraphsForDigraphTypeAndReturnSize(
             const DigraphType digraphType, const digraph_t **const digraphs);
     static const digraph_t *getDigraphForCodePoint(const int compositeGlyphCodePoint);
-    static const digraph_t *getDigraphForDigraphTypeAndCodePoint(
+
+    /**
+     * Returns the digraph for the input composite glyph codepoint, or nullptr if none exists.
+     * digraphType: the type of digraphs supported.
+     * compositeGlyphCodePoint: the method returns the digraph corresponding to this codepoint.
+     */
+    static AK_FORCE_INLINE const digraph_t *getDigraphForDigraphTypeAndCodePoint(
+            const DigraphType digraphType, const int compositeGlyphCodePoint) {
+        if (compositeGlyphCodePoint >= 0 && compositeGlyphCodePoint < DIGRAPH_TABLE_SIZE) {
+            return getDigraphTables().getDigraph(digraphType, compositeGlyphCodePoint);
+        }
+        return getDigraphForDigraphTypeAndLowerCaseCodePoint(digraphType,
+                compositeGlyphCodePoint);
+    }
+    static const digraph_t *getDigraphForDigraphTypeAndLowerCaseCodePoint(
             const DigraphType digraphType, const int compositeGlyphCodePoint);
 
     static const digraph_t GERMAN_UMLAUT_DIGRAPHS[];
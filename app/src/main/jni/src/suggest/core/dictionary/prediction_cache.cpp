@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "suggest/core/dictionary/prediction_cache.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "suggest/core/result/suggested_word.h"
+#include "suggest/core/result/suggestion_results.h"
+#include "utils/memory_usage.h"
+#include "utils/time_keeper.h"
+
+namespace latinime {
+
+// Predictions right after a space are requested again when the user goes back to a context;
+// a few recent contexts cover that.
+const int PredictionCache::MAX_ENTRY_COUNT = 16;
+const int PredictionCache::ENTRY_LIFETIME_IN_SECONDS = 60;
+
+PredictionCache::PredictionCache() : mMutex(), mEntries(), mSequenceNumber(0) {}
+
+PredictionCache::~PredictionCache() {}
+
+bool PredictionCache::getPredictions(const WordIdArrayView prevWordIds,
+        const bool isBeginningOfSentence, SuggestionResults *const outSuggestionResults) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+        if (!isSameKey(*it, prevWordIds, isBeginningOfSentence)) {
+            continue;
+        }
+        if (std::abs(TimeKeeper::peekCurrentTime() - it->mTimestamp)
+                > ENTRY_LIFETIME_IN_SECONDS) {
+            mEntries.erase(it);
+            return false;
+        }
+        if (outSuggestionResults->getMaxSuggestionCount() > it->mMaxSuggestionCount) {
+            // Predictions that were dropped from the entry might be needed.
+            return false;
+        }
+        it->mLastUsedSequenceNumber = ++mSequenceNumber;
+        outSuggestionResults->addSuggestedWords(it->mPredictions);
+        return true;
+    }
+    return false;
+}
+
+void PredictionCache::putPredictions(const WordIdArrayView prevWordIds,
+        const bool isBeginningOfSentence, const std::vector<int> &visitedWordIds,
+        const SuggestionResults *const suggestionResults) {
+    if (prevWordIds.empty() || prevWordIds.size() > MAX_PREV_WORD_COUNT_FOR_N_GRAM) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto entryIt = std::find_if(mEntries.begin(), mEntries.end(),
+            [&](const Entry &entry) {
+                return isSameKey(entry, prevWordIds, isBeginningOfSentence);
+            });
+    if (entryIt == mEntries.end()) {
+        if (static_cast<int>(mEntries.size()) < MAX_ENTRY_COUNT) {
+            mEntries.emplace_back();
+            entryIt = mEntries.end() - 1;
+        } else {
+            entryIt = std::min_element(mEntries.begin(), mEntries.end(),
+                    [](const Entry &left, const Entry &right) {
+                        return left.mLastUsedSequenceNumber < right.mLastUsedSequenceNumber;
+                    });
+        }
+    }
+    Entry &entry = *entryIt;
+    prevWordIds.copyToArray(&entry.mPrevWordIds, 0 /* offset */);
+    entry.mPrevWordCount = prevWordIds.size();
+    entry.mIsBeginningOfSentence = isBeginningOfSentence;
+    entry.mMaxSuggestionCount = suggestionResults->getMaxSuggestionCount();
+    entry.mPredictions.clear();
+    suggestionResults->getSuggestedWords(&entry.mPredictions);
+    entry.mVisitedWordIds = visitedWordIds;
+    std::sort(entry.mVisitedWordIds.begin(), entry.mVisitedWordIds.end());
+    entry.mTimestamp = TimeKeeper::peekCurrentTime();
+    entry.mLastUsedSequenceNumber = ++mSequenceNumber;
+}
+
+void PredictionCache::invalidateEntriesForPrevWord(const int prevWordId) {
+    if (prevWordId == NOT_A_WORD_ID) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    // Predictions for a context also include the entries of its shorter contexts, which all start
+    // with the last word.
+    mEntries.erase(std::remove_if(mEntries.begin(), mEntries.end(),
+            [prevWordId](const Entry &entry) { return entry.mPrevWordIds[0] == prevWordId; }),
+            mEntries.end());
+}
+
+void PredictionCache::invalidateEntriesForWord(const int wordId) {
+    if (wordId == NOT_A_WORD_ID) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.erase(std::remove_if(mEntries.begin(), mEntries.end(),
+            [wordId](const Entry &entry) { return dependsOnWord(entry, wordId); }),
+            mEntries.end());
+}
+
+void PredictionCache::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+}
+
+void PredictionCache::release() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::vector<Entry>().swap(mEntries);
+}
+
+int PredictionCache::getEntryCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return static_cast<int>(mEntries.size());
+}
+
+void PredictionCache::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mEntries);
+    for (const auto &entry : mEntries) {
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, entry.mPredictions);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, entry.mVisitedWordIds);
+        for (const auto &prediction : entry.mPredictions) {
+            outMemoryUsage->add(MemoryUsage::CACHE_BYTES,
+                    static_cast<int64_t>(prediction.getCodePointCount() * sizeof(int)));
+        }
+    }
+}
+
+/* static */ bool PredictionCache::isSameKey(const Entry &entry,
+        const WordIdArrayView prevWordIds, const bool isBeginningOfSentence) {
+    return entry.mIsBeginningOfSentence == isBeginningOfSentence
+            && entry.mPrevWordCount == prevWordIds.size()
+            && std::equal(prevWordIds.begin(), prevWordIds.end(), entry.mPrevWordIds.begin());
+}
+
+/* static */ bool PredictionCache::dependsOnWord(const Entry &entry, const int wordId) {
+    for (size_t i = 0; i < entry.mPrevWordCount; ++i) {
+        if (entry.mPrevWordIds[i] == wordId) {
+            return true;
+        }
+    }
+    return std::binary_search(entry.mVisitedWordIds.begin(), entry.mVisitedWordIds.end(), wordId);
+}
+
+} // namespace latinime
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef LATINIME_PREDICTION_CACHE_H
+#define LATINIME_PREDICTION_CACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "defines.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+class MemoryUsage;
+class SuggestedWord;
+class SuggestionResults;
+
+/**
+ * A small LRU cache of next word predictions, keyed by the previous word ids.
+ *
+ * Each entry remembers the ids of all words that were visited to compute it, so that dictionary
+ * updates only invalidate the entries that can be affected by them. Entries also expire after a
+ * while so that time dependent probabilities don't go stale.
+ *
+ * This class is thread-safe.
+ */
+class PredictionCache {
+ public:
+    PredictionCache();
+    ~PredictionCache();
+
+    // Adds the cached predictions to outSuggestionResults and returns true on a hit.
+    bool getPredictions(const WordIdArrayView prevWordIds, const bool isBeginningOfSentence,
+            SuggestionResults *const outSuggestionResults) const;
+    // visitedWordIds are the ids of all the words that were visited to compute the predictions.
+    void putPredictions(const WordIdArrayView prevWordIds, const bool isBeginningOfSentence,
+            const std::vector<int> &visitedWordIds,
+            const SuggestionResults *const suggestionResults);
+
+    // Invalidates the entries for contexts whose last word is the given word.
+    void invalidateEntriesForPrevWord(const int prevWordId);
+    // Invalidates the entries that depend on the given word in any way.
+    void invalidateEntriesForWord(const int wordId);
+    void clear();
+    // Same as clear(), and frees the entry buffer.
+    void release();
+
+    int getEntryCount() const;
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(PredictionCache);
+
+    struct Entry {
+        WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> mPrevWordIds;
+        size_t mPrevWordCount;
+        bool mIsBeginningOfSentence;
+        // The predictions are the best ones for up to this count.
+        int mMaxSuggestionCount;
+        std::vector<SuggestedWord> mPredictions;
+        std::vector<int> mVisitedWordIds;
+        int mTimestamp;
+        uint64_t mLastUsedSequenceNumber;
+    };
+
+    static const int MAX_ENTRY_COUNT;
+    static const int ENTRY_LIFETIME_IN_SECONDS;
+
+    static bool isSameKey(const Entry &entry, const WordIdArrayView prevWordIds,
+            const bool isBeginningOfSentence);
+    static bool dependsOnWord(const Entry &entry, const int wordId);
+
+    mutable std::mutex mMutex;
+    // Entries are looked up linearly; MAX_ENTRY_COUNT is small.
+    mutable std::vector<Entry> mEntries;
+    mutable uint64_t mSequenceNumber;
+};
+} // namespace latinime
+#endif // LATINIME_PREDICTION_CACHE_H
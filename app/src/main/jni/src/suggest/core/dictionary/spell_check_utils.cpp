@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/spell_check_utils.h"
+
+#include "suggest/core/dictionary/dictionary.h"
+#include "utils/char_utils.h"
+
+namespace latinime {
+
+const int SpellCheckUtils::APOSTROPHE = '\'';
+const int SpellCheckUtils::RIGHT_SINGLE_QUOTATION_MARK = 0x2019;
+
+/* static */ void SpellCheckUtils::getMisspelledRanges(const Dictionary *const dictionary,
+        const uint16_t *const text, const int textLength,
+        std::vector<int> *const outMisspelledRanges) {
+    int codePoints[MAX_WORD_LENGTH];
+    int index = 0;
+    while (index < textLength) {
+        int charCount = 0;
+        int codePoint = readCodePoint(text, textLength, index, &charCount);
+        if (!CharUtils::isLetterOrDigit(codePoint)) {
+            index += charCount;
+            continue;
+        }
+        const int wordStart = index;
+        int wordEnd = index;
+        int codePointCount = 0;
+        bool hasDigit = false;
+        // The apostrophes are a part of the word only between letters or digits, as in "don't".
+        while (true) {
+            if (CharUtils::isLetterOrDigit(codePoint)) {
+                if (codePointCount < MAX_WORD_LENGTH) {
+                    codePoints[codePointCount] = codePoint;
+                }
+                ++codePointCount;
+                hasDigit |= (codePoint >= '0' && codePoint <= '9');
+                index += charCount;
+                wordEnd = index;
+            } else if (isApostrophe(codePoint)) {
+                index += charCount;
+                if (index >= textLength) {
+                    break;
+                }
+                int nextCharCount = 0;
+                const int nextCodePoint = readCodePoint(text, textLength, index, &nextCharCount);
+                if (!CharUtils::isLetterOrDigit(nextCodePoint)) {
+                    break;
+                }
+                // The dictionaries only have the ASCII apostrophe.
+                if (codePointCount < MAX_WORD_LENGTH) {
+                    codePoints[codePointCount] = APOSTROPHE;
+                }
+                ++codePointCount;
+                codePoint = nextCodePoint;
+                charCount = nextCharCount;
+                continue;
+            } else {
+                break;
+            }
+            if (index >= textLength) {
+                break;
+            }
+            codePoint = readCodePoint(text, textLength, index, &charCount);
+        }
+        index = wordEnd;
+        if (hasDigit || codePointCount > MAX_WORD_LENGTH) {
+            continue;
+        }
+        if (!isInDictionaryForAnyCapitalization(dictionary,
+                CodePointArrayView(codePoints, codePointCount))) {
+            outMisspelledRanges->push_back(wordStart);
+            outMisspelledRanges->push_back(wordEnd);
+        }
+    }
+}
+
+/* static */ bool SpellCheckUtils::isInDictionaryForAnyCapitalization(
+        const Dictionary *const dictionary, const CodePointArrayView codePoints) {
+    if (codePoints.empty() || codePoints.size() > MAX_WORD_LENGTH) {
+        return false;
+    }
+    if (dictionary->getProbability(codePoints) != NOT_A_PROBABILITY) {
+        return true;
+    }
+    int lowerCaseCodePoints[MAX_WORD_LENGTH];
+    int upperCaseCount = 0;
+    for (size_t i = 0; i < codePoints.size(); ++i) {
+        lowerCaseCodePoints[i] = CharUtils::toLowerCase(codePoints[i]);
+        if (lowerCaseCodePoints[i] != codePoints[i]) {
+            ++upperCaseCount;
+        }
+    }
+    if (upperCaseCount == 0) {
+        return false;
+    }
+    const CodePointArrayView lowerCaseWord(lowerCaseCodePoints, codePoints.size());
+    if (dictionary->getProbability(lowerCaseWord) != NOT_A_PROBABILITY) {
+        return true;
+    }
+    const bool isFirstUpperCase = lowerCaseCodePoints[0] != codePoints[0];
+    if (upperCaseCount == 1 || !isFirstUpperCase) {
+        // Capitalized or camel case, which has been looked up as it is.
+        return false;
+    }
+    // Capitalized version of a word in all caps, e.g. "Paris" for "PARIS".
+    lowerCaseCodePoints[0] = codePoints[0];
+    return dictionary->getProbability(lowerCaseWord) != NOT_A_PROBABILITY;
+}
+
+/* static */ int SpellCheckUtils::readCodePoint(const uint16_t *const text, const int textLength,
+        const int index, int *const outCharCount) {
+    const int highSurrogate = text[index];
+    if (highSurrogate >= 0xD800 && highSurrogate <= 0xDBFF && index + 1 < textLength) {
+        const int lowSurrogate = text[index + 1];
+        if (lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF) {
+            *outCharCount = 2;
+            return 0x10000 + ((highSurrogate - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+        }
+    }
+    *outCharCount = 1;
+    return highSurrogate;
+}
+
+} // namespace latinime
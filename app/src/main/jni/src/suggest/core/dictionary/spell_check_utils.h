@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_SPELL_CHECK_UTILS_H
+#define LATINIME_SPELL_CHECK_UTILS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "defines.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+class Dictionary;
+
+// Checks whole texts in one call, for the spell checker to avoid a JNI call per word.
+class SpellCheckUtils {
+ public:
+    // Splits the UTF-16 text into words and appends the UTF-16 ranges of the words that are not in
+    // the dictionary to outMisspelledRanges, as pairs of start and end offsets. The words with
+    // digits and the words longer than MAX_WORD_LENGTH are not checked.
+    static void getMisspelledRanges(const Dictionary *const dictionary,
+            const uint16_t *const text, const int textLength,
+            std::vector<int> *const outMisspelledRanges);
+
+    // Same as AndroidWordLevelSpellCheckerSession.isInDictForAnyCapitalization(): the word is
+    // also looked up in lower case, and capitalized when it is in all caps.
+    static bool isInDictionaryForAnyCapitalization(const Dictionary *const dictionary,
+            const CodePointArrayView codePoints);
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(SpellCheckUtils);
+
+    static const int APOSTROPHE;
+    static const int RIGHT_SINGLE_QUOTATION_MARK;
+
+    static bool isApostrophe(const int codePoint) {
+        return codePoint == APOSTROPHE || codePoint == RIGHT_SINGLE_QUOTATION_MARK;
+    }
+
+    static int readCodePoint(const uint16_t *const text, const int textLength, const int index,
+            int *const outCharCount);
+};
+} // namespace latinime
+#endif // LATINIME_SPELL_CHECK_UTILS_H
@@ -54,43 +54,33 @@ class AdditionalProximityChars {
     }
 
  public:
-    static int getAdditionalCharsSize(const std::vector<int> *locale, const int c) {
-        if (!isEnLocale(locale)) {
-            return 0;
-        }
-        switch (c) {
-        case 'a':
-            return EN_US_ADDITIONAL_A_SIZE;
-        case 'e':
-            return EN_US_ADDITIONAL_E_SIZE;
-        case 'i':
-            return EN_US_ADDITIONAL_I_SIZE;
-        case 'o':
-            return EN_US_ADDITIONAL_O_SIZE;
-        case 'u':
-            return EN_US_ADDITIONAL_U_SIZE;
-        default:
-            return 0;
-        }
+    // The locale is resolved once per input with this, so that getAdditionalChars() does no locale
+    // comparison for each input code point.
+    static bool hasAdditionalChars(const std::vector<int> *locale) {
+        return isEnLocale(locale);
     }
 
-    static const int *getAdditionalChars(const std::vector<int> *locale, const int c) {
-        if (!isEnLocale(locale)) {
-            return 0;
-        }
+    // Returns the additional chars of c for a locale that hasAdditionalChars(), or nullptr.
+    static const int *getAdditionalChars(const int c, int *const outSize) {
         switch (c) {
         case 'a':
+            *outSize = EN_US_ADDITIONAL_A_SIZE;
             return EN_US_ADDITIONAL_A;
         case 'e':
+            *outSize = EN_US_ADDITIONAL_E_SIZE;
             return EN_US_ADDITIONAL_E;
         case 'i':
+            *outSize = EN_US_ADDITIONAL_I_SIZE;
             return EN_US_ADDITIONAL_I;
         case 'o':
+            *outSize = EN_US_ADDITIONAL_O_SIZE;
             return EN_US_ADDITIONAL_O;
         case 'u':
+            *outSize = EN_US_ADDITIONAL_U_SIZE;
             return EN_US_ADDITIONAL_U;
         default:
-            return 0;
+            *outSize = 0;
+            return nullptr;
         }
     }
 };
@@ -17,6 +17,7 @@
 #ifndef LATINIME_GEOMETRY_UTILS_H
 #define LATINIME_GEOMETRY_UTILS_H
 
+#include <algorithm>
 #include <cmath>
 
 #include "defines.h"
@@ -34,7 +35,28 @@ class GeometryUtils {
         const int dx = x1 - x2;
         const int dy = y1 - y2;
         if (dx == 0 && dy == 0) return 0.0f;
+#ifdef FLAG_USE_LIBM_GEOMETRY
         return atan2f(static_cast<float>(dy), static_cast<float>(dx));
+#else
+        return fastAtan2(static_cast<float>(dy), static_cast<float>(dx));
+#endif
+    }
+
+    // Approximates atan2f(y, x) within 5e-7 radians, using the odd polynomial of
+    // Abramowitz and Stegun 4.4.47 for atan on [0, 1] and the octant symmetries. The result is
+    // computed without branches so that loops calling this can be vectorized. (0, 0) gives 0.
+    static AK_FORCE_INLINE float fastAtan2(const float y, const float x) {
+        const float absX = fabsf(x);
+        const float absY = fabsf(y);
+        const float maxAbs = std::max(absX, absY);
+        const float t = std::min(absX, absY) / (maxAbs > 0.0f ? maxAbs : 1.0f);
+        const float s = t * t;
+        float angle = (((((((-0.0040540580f * s + 0.0218612288f) * s - 0.0559098861f) * s
+                + 0.0964200441f) * s - 0.1390853351f) * s + 0.1994653599f) * s
+                - 0.3332985605f) * s + 0.9999993329f) * t;
+        angle = absY > absX ? M_PI_F / 2.0f - angle : angle;
+        angle = x < 0.0f ? M_PI_F - angle : angle;
+        return y < 0.0f ? -angle : angle;
     }
 
     static AK_FORCE_INLINE float getAngleDiff(const float a1, const float a2) {
@@ -51,7 +73,15 @@ class GeometryUtils {
 
     static AK_FORCE_INLINE int getDistanceInt(const int x1, const int y1, const int x2,
             const int y2) {
-        return static_cast<int>(hypotf(static_cast<float>(x1 - x2), static_cast<float>(y1 - y2)));
+        const float dx = static_cast<float>(x1 - x2);
+        const float dy = static_cast<float>(y1 - y2);
+#ifdef FLAG_USE_LIBM_GEOMETRY
+        return static_cast<int>(hypotf(dx, dy));
+#else
+        // hypotf() guards against overflow and underflow, which can't happen for screen
+        // coordinates, and isn't inlined.
+        return static_cast<int>(sqrtf(dx * dx + dy * dy));
+#endif
     }
 
  private:
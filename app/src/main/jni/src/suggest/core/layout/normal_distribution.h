@@ -38,6 +38,9 @@ class NormalDistribution {
                 * expf(mPreComputedExponentPart * GeometryUtils::SQUARE_FLOAT(shiftedX));
     }
 
+    float getPreComputedNonExpPart() const { return mPreComputedNonExpPart; }
+    float getPreComputedExponentPart() const { return mPreComputedExponentPart; }
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(NormalDistribution);
 
@@ -22,6 +22,7 @@
 #include "defines.h"
 #include "suggest/core/layout/geometry_utils.h"
 #include "suggest/core/layout/normal_distribution.h"
+#include "suggest/core/layout/proximity_info_simd_utils.h"
 
 namespace latinime {
 
@@ -45,6 +46,18 @@ class NormalDistribution2D {
                 * mYDistribution.getProbabilityDensity(rotatedShiftedY);
     }
 
+    // Batch version of getProbabilityDensity for count points given as struct of arrays.
+    void getProbabilityDensities(const float *const xs, const float *const ys, const int count,
+            float *const outProbabilityDensities) const {
+        ProximityInfoSimdUtils::computeRotatedGaussianExponents(xs, ys, count, mUX, mUY,
+                mCosTheta, mSinTheta, mXDistribution.getPreComputedExponentPart(),
+                mYDistribution.getPreComputedExponentPart(), outProbabilityDensities);
+        const float nonExpPart = mXDistribution.getPreComputedNonExpPart()
+                * mYDistribution.getPreComputedNonExpPart();
+        ProximityInfoSimdUtils::computeScaledExps(outProbabilityDensities, count, nonExpPart,
+                outProbabilityDensities);
+    }
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(NormalDistribution2D);
 
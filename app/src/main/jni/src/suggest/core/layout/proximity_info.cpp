@@ -19,31 +19,58 @@
 #include "suggest/core/layout/proximity_info.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <cmath>
+#include <limits>
+#include <thread>
 
 #include "defines.h"
 #include "jni.h"
 #include "suggest/core/layout/additional_proximity_chars.h"
 #include "suggest/core/layout/geometry_utils.h"
 #include "suggest/core/layout/proximity_info_params.h"
+#include "suggest/core/layout/proximity_info_simd_utils.h"
+#include "suggest/core/layout/touch_position_model.h"
 #include "utils/char_utils.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 
-static AK_FORCE_INLINE void safeGetOrFillZeroIntArrayRegion(JNIEnv *env, jintArray jArray,
-        jsize len, jint *buffer) {
-    if (jArray && buffer) {
-        env->GetIntArrayRegion(jArray, 0, len, buffer);
-    } else if (buffer) {
-        memset(buffer, 0, len * sizeof(buffer[0]));
+static int getArrayKeyCount(const int keyCount) {
+    return std::min(keyCount, MAX_KEY_COUNT_IN_A_KEYBOARD);
+}
+
+template<typename JavaArray, typename Value>
+static std::vector<Value> getArrayRegion(JNIEnv *env, const JavaArray jArray, const jsize len,
+        void (JNIEnv::*getRegion)(JavaArray, jsize, jsize, Value *)) {
+    std::vector<Value> values;
+    if (jArray) {
+        values.resize(len);
+        (env->*getRegion)(jArray, 0, len, values.data());
     }
+    return values;
+}
+
+static std::vector<int> getIntArray(JNIEnv *env, const jintArray jArray, const jsize len) {
+    return getArrayRegion<jintArray, jint>(env, jArray, len, &JNIEnv::GetIntArrayRegion);
+}
+
+static std::vector<float> getFloatArray(JNIEnv *env, const jfloatArray jArray, const jsize len) {
+    return getArrayRegion<jfloatArray, jfloat>(env, jArray, len, &JNIEnv::GetFloatArrayRegion);
+}
+
+// A null Java array stays null, so that the missing data can be detected.
+template<typename Value>
+static const Value *dataOrNull(const std::vector<Value> &values) {
+    return values.empty() ? nullptr : values.data();
 }
 
-static AK_FORCE_INLINE void safeGetOrFillZeroFloatArrayRegion(JNIEnv *env, jfloatArray jArray,
-        jsize len, jfloat *buffer) {
-    if (jArray && buffer) {
-        env->GetFloatArrayRegion(jArray, 0, len, buffer);
+template<typename Value>
+static AK_FORCE_INLINE void safeCopyOrFillZeroArray(const Value *const values, const int len,
+        Value *const buffer) {
+    if (values && buffer) {
+        memmove(buffer, values, len * sizeof(buffer[0]));
     } else if (buffer) {
         memset(buffer, 0, len * sizeof(buffer[0]));
     }
@@ -56,6 +83,29 @@ ProximityInfo::ProximityInfo(JNIEnv *env, const int keyboardWidth, const int key
         const jintArray keyWidths, const jintArray keyHeights, const jintArray keyCharCodes,
         const jfloatArray sweetSpotCenterXs, const jfloatArray sweetSpotCenterYs,
         const jfloatArray sweetSpotRadii)
+        // The vectors live until the delegated constructor has copied them.
+        : ProximityInfo(keyboardWidth, keyboardHeight, gridWidth, gridHeight, mostCommonKeyWidth,
+                mostCommonKeyHeight,
+                dataOrNull(getIntArray(env, proximityChars,
+                        proximityChars ? env->GetArrayLength(proximityChars) : 0)),
+                proximityChars ? env->GetArrayLength(proximityChars) : 0, keyCount,
+                dataOrNull(getIntArray(env, keyXCoordinates, getArrayKeyCount(keyCount))),
+                dataOrNull(getIntArray(env, keyYCoordinates, getArrayKeyCount(keyCount))),
+                dataOrNull(getIntArray(env, keyWidths, getArrayKeyCount(keyCount))),
+                dataOrNull(getIntArray(env, keyHeights, getArrayKeyCount(keyCount))),
+                dataOrNull(getIntArray(env, keyCharCodes, getArrayKeyCount(keyCount))),
+                dataOrNull(getFloatArray(env, sweetSpotCenterXs, getArrayKeyCount(keyCount))),
+                dataOrNull(getFloatArray(env, sweetSpotCenterYs, getArrayKeyCount(keyCount))),
+                dataOrNull(getFloatArray(env, sweetSpotRadii, getArrayKeyCount(keyCount)))) {}
+
+ProximityInfo::ProximityInfo(const int keyboardWidth, const int keyboardHeight,
+        const int gridWidth, const int gridHeight, const int mostCommonKeyWidth,
+        const int mostCommonKeyHeight, const int *const proximityChars,
+        const int proximityCharsLength, const int keyCount, const int *const keyXCoordinates,
+        const int *const keyYCoordinates, const int *const keyWidths,
+        const int *const keyHeights, const int *const keyCharCodes,
+        const float *const sweetSpotCenterXs, const float *const sweetSpotCenterYs,
+        const float *const sweetSpotRadii)
         : GRID_WIDTH(gridWidth), GRID_HEIGHT(gridHeight), MOST_COMMON_KEY_WIDTH(mostCommonKeyWidth),
           MOST_COMMON_KEY_WIDTH_SQUARE(mostCommonKeyWidth * mostCommonKeyWidth),
           NORMALIZED_SQUARED_MOST_COMMON_KEY_HYPOTENUSE(1.0f +
@@ -63,42 +113,58 @@ ProximityInfo::ProximityInfo(JNIEnv *env, const int keyboardWidth, const int key
                           static_cast<float>(mostCommonKeyWidth))),
           CELL_WIDTH((keyboardWidth + gridWidth - 1) / gridWidth),
           CELL_HEIGHT((keyboardHeight + gridHeight - 1) / gridHeight),
-          KEY_COUNT(std::min(keyCount, MAX_KEY_COUNT_IN_A_KEYBOARD)),
+          KEY_COUNT(getArrayKeyCount(keyCount)),
           KEYBOARD_WIDTH(keyboardWidth), KEYBOARD_HEIGHT(keyboardHeight),
           KEYBOARD_HYPOTENUSE(hypotf(KEYBOARD_WIDTH, KEYBOARD_HEIGHT)),
           HAS_TOUCH_POSITION_CORRECTION_DATA(keyCount > 0 && keyXCoordinates && keyYCoordinates
                   && keyWidths && keyHeights && keyCharCodes && sweetSpotCenterXs
                   && sweetSpotCenterYs && sweetSpotRadii),
+          TAP_DISTANCE_TABLE_CELL_SIZE(std::max(1, mostCommonKeyWidth
+                  / ProximityInfoParams::TAP_DISTANCE_TABLE_CELLS_PER_KEY_WIDTH)),
           mProximityCharsArray(new int[GRID_WIDTH * GRID_HEIGHT * MAX_PROXIMITY_CHARS_SIZE
                   /* proximityCharsLength */]),
-          mLowerCodePointToKeyMap() {
+          mLowerCodePointToKeyMap(), mTapDistanceTables(),
+          mPublishedTapDistanceTablesIndex(0), mTapDistanceTablesReaderCounts(),
+          mTouchPositionModelMutex(), mTouchPositionModelVersion(0) {
     /* Let's check the input array length here to make sure */
-    const jsize proximityCharsLength = env->GetArrayLength(proximityChars);
     if (proximityCharsLength != GRID_WIDTH * GRID_HEIGHT * MAX_PROXIMITY_CHARS_SIZE) {
         AKLOGE("Invalid proximityCharsLength: %d", proximityCharsLength);
         ASSERT(false);
+        // No key is found then.
+        initializeKeyIndexTable();
         return;
     }
     if (DEBUG_PROXIMITY_INFO) {
         AKLOGI("Create proximity info array %d", proximityCharsLength);
     }
-    safeGetOrFillZeroIntArrayRegion(env, proximityChars, proximityCharsLength,
-            mProximityCharsArray);
-    safeGetOrFillZeroIntArrayRegion(env, keyXCoordinates, KEY_COUNT, mKeyXCoordinates);
-    safeGetOrFillZeroIntArrayRegion(env, keyYCoordinates, KEY_COUNT, mKeyYCoordinates);
-    safeGetOrFillZeroIntArrayRegion(env, keyWidths, KEY_COUNT, mKeyWidths);
-    safeGetOrFillZeroIntArrayRegion(env, keyHeights, KEY_COUNT, mKeyHeights);
-    safeGetOrFillZeroIntArrayRegion(env, keyCharCodes, KEY_COUNT, mKeyCodePoints);
-    safeGetOrFillZeroFloatArrayRegion(env, sweetSpotCenterXs, KEY_COUNT, mSweetSpotCenterXs);
-    safeGetOrFillZeroFloatArrayRegion(env, sweetSpotCenterYs, KEY_COUNT, mSweetSpotCenterYs);
-    safeGetOrFillZeroFloatArrayRegion(env, sweetSpotRadii, KEY_COUNT, mSweetSpotRadii);
+    safeCopyOrFillZeroArray(proximityChars, proximityCharsLength, mProximityCharsArray);
+    safeCopyOrFillZeroArray(keyXCoordinates, KEY_COUNT, mKeyXCoordinates);
+    safeCopyOrFillZeroArray(keyYCoordinates, KEY_COUNT, mKeyYCoordinates);
+    safeCopyOrFillZeroArray(keyWidths, KEY_COUNT, mKeyWidths);
+    safeCopyOrFillZeroArray(keyHeights, KEY_COUNT, mKeyHeights);
+    safeCopyOrFillZeroArray(keyCharCodes, KEY_COUNT, mKeyCodePoints);
+    safeCopyOrFillZeroArray(sweetSpotCenterXs, KEY_COUNT, mSweetSpotCenterXs);
+    safeCopyOrFillZeroArray(sweetSpotCenterYs, KEY_COUNT, mSweetSpotCenterYs);
+    safeCopyOrFillZeroArray(sweetSpotRadii, KEY_COUNT, mSweetSpotRadii);
     initializeG();
+    initializeTapDistanceTables(&mTapDistanceTables[0]);
+    initializeKeyIndexTable();
 }
 
 ProximityInfo::~ProximityInfo() {
     delete[] mProximityCharsArray;
 }
 
+void ProximityInfo::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    outMemoryUsage->add(MemoryUsage::HEAP_BYTES, static_cast<int64_t>(sizeof(*this)
+            + GRID_WIDTH * GRID_HEIGHT * MAX_PROXIMITY_CHARS_SIZE * sizeof(int)));
+    outMemoryUsage->addUnorderedMap(MemoryUsage::HEAP_BYTES, mLowerCodePointToKeyMap);
+    for (const TapDistanceTables &tables : mTapDistanceTables) {
+        outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, tables.mXTable);
+        outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, tables.mYTable);
+    }
+}
+
 bool ProximityInfo::hasSpaceProximity(const int x, const int y) const {
     if (x < 0 || y < 0) {
         if (DEBUG_DICT) {
@@ -136,6 +202,28 @@ float ProximityInfo::getNormalizedSquaredDistanceFromCenterFloatG(
             / GeometryUtils::SQUARE_FLOAT(static_cast<float>(getMostCommonKeyWidth()));
 }
 
+void ProximityInfo::getNormalizedSquaredDistancesFromCentersForTap(const int x, const int y,
+        float *const outDistances) const {
+    const ScopedReadingTapDistanceTables readingTables(this);
+    const TapDistanceTables *const tables = readingTables.get();
+    const int column = x / TAP_DISTANCE_TABLE_CELL_SIZE;
+    const int row = y / TAP_DISTANCE_TABLE_CELL_SIZE;
+    if (x < 0 || y < 0
+            || static_cast<size_t>((column + 1) * KEY_COUNT) > tables->mXTable.size()
+            || static_cast<size_t>((row + 1) * KEY_COUNT) > tables->mYTable.size()) {
+        // Out of the keyboard. This can happen with touches on the edge of the keyboard.
+        for (int keyId = 0; keyId < KEY_COUNT; ++keyId) {
+            outDistances[keyId] = getNormalizedSquaredDistanceFromCenterForTap(tables, keyId, x, y);
+        }
+        return;
+    }
+    const float *const xDistances = tables->mXTable.data() + column * KEY_COUNT;
+    const float *const yDistances = tables->mYTable.data() + row * KEY_COUNT;
+    for (int keyId = 0; keyId < KEY_COUNT; ++keyId) {
+        outDistances[keyId] = xDistances[keyId] + yDistances[keyId];
+    }
+}
+
 int ProximityInfo::getCodePointOf(const int keyIndex) const {
     if (keyIndex < 0 || keyIndex >= KEY_COUNT) {
         return NOT_A_CODE_POINT;
@@ -186,6 +274,137 @@ void ProximityInfo::initializeG() {
             mKeyKeyDistancesG[j][i] = mKeyKeyDistancesG[i][j];
         }
     }
+    // Same as getKeyCenterXOfKeyIdG() and getKeyCenterYOfKeyIdG(), as ranges which the reference
+    // point is clamped to.
+    for (int i = 0; i < KEY_COUNT; ++i) {
+        const int centerX = getKeyCenterXOfKeyIdG(i, NOT_A_COORDINATE, true /* isGeometric */);
+        const int centerY = getKeyCenterYOfKeyIdG(i, NOT_A_COORDINATE, true /* isGeometric */);
+        const int keyWidthHalfDiff = mKeyWidths[i] > getMostCommonKeyWidth()
+                ? (mKeyWidths[i] - getMostCommonKeyWidth()) / 2 : 0;
+        mKeyCenterXsForSimdG[i] = static_cast<float>(centerX);
+        mKeyCenterYsForSimdG[i] = static_cast<float>(centerY);
+        mKeyMinXsForSimdG[i] = static_cast<float>(centerX - keyWidthHalfDiff);
+        mKeyMaxXsForSimdG[i] = static_cast<float>(centerX + keyWidthHalfDiff);
+        mKeyMaxYsForSimdG[i] = centerY + mKeyHeights[i] > KEYBOARD_HEIGHT
+                ? std::numeric_limits<float>::max() : static_cast<float>(centerY);
+    }
+}
+
+void ProximityInfo::initializeKeyIndexTable() {
+    for (int codePoint = 0; codePoint < ProximityInfoUtils::KEY_INDEX_TABLE_SIZE; ++codePoint) {
+        mKeyIndexTable[codePoint] = static_cast<int8_t>(ProximityInfoUtils::getKeyIndexOf(
+                KEY_COUNT, codePoint, &mLowerCodePointToKeyMap));
+    }
+}
+
+void ProximityInfo::getNormalizedSquaredDistancesFromCentersForGesture(const int x, const int y,
+        float *const outDistances) const {
+    if (x == NOT_A_COORDINATE || y == NOT_A_COORDINATE) {
+        // Reference points are not used for NOT_A_COORDINATE.
+        for (int keyId = 0; keyId < KEY_COUNT; ++keyId) {
+            outDistances[keyId] = getNormalizedSquaredDistanceFromCenterFloatG(keyId, x, y,
+                    true /* isGeometric */);
+        }
+        return;
+    }
+    ProximityInfoSimdUtils::computeScaledSquaredDistances(static_cast<float>(x),
+            static_cast<float>(y), mKeyMinXsForSimdG, mKeyMaxXsForSimdG, mKeyCenterYsForSimdG,
+            mKeyMaxYsForSimdG, KEY_COUNT,
+            1.0f / GeometryUtils::SQUARE_FLOAT(static_cast<float>(getMostCommonKeyWidth())),
+            outDistances);
+}
+
+void ProximityInfo::applyTouchPositionModel(
+        const TouchPositionModel *const touchPositionModel) {
+    const int version = touchPositionModel->getVersion();
+    if (version == mTouchPositionModelVersion.load()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mTouchPositionModelMutex);
+    if (version == mTouchPositionModelVersion.load()) {
+        return;
+    }
+    float offsetXs[MAX_KEY_COUNT_IN_A_KEYBOARD];
+    float offsetYs[MAX_KEY_COUNT_IN_A_KEYBOARD];
+    touchPositionModel->getOffsets(mKeyIndexToLowerCodePointG, KEY_COUNT, offsetXs, offsetYs);
+    const int tablesIndex = 1 - mPublishedTapDistanceTablesIndex.load();
+    // The readers of the tables published before the current ones might still be there. Building
+    // the tables takes much longer than reading them, so this sleeps instead of spinning.
+    while (mTapDistanceTablesReaderCounts[tablesIndex].load() > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    TapDistanceTables *const tables = &mTapDistanceTables[tablesIndex];
+    for (int keyId = 0; keyId < KEY_COUNT; ++keyId) {
+        tables->mKeyOffsetXs[keyId] =
+                static_cast<int>(lroundf(offsetXs[keyId] * getMostCommonKeyWidth()));
+        tables->mKeyOffsetYs[keyId] =
+                static_cast<int>(lroundf(offsetYs[keyId] * getMostCommonKeyWidth()));
+    }
+    initializeTapDistanceTables(tables);
+    mPublishedTapDistanceTablesIndex.store(tablesIndex);
+    mTouchPositionModelVersion.store(version);
+}
+
+ProximityInfo::ScopedReadingTapDistanceTables::ScopedReadingTapDistanceTables(
+        const ProximityInfo *const proximityInfo)
+        : mProximityInfo(proximityInfo),
+          mTablesIndex(proximityInfo->acquireTapDistanceTablesIndex()) {}
+
+ProximityInfo::ScopedReadingTapDistanceTables::~ScopedReadingTapDistanceTables() {
+    mProximityInfo->mTapDistanceTablesReaderCounts[mTablesIndex].fetch_sub(1);
+}
+
+int ProximityInfo::acquireTapDistanceTablesIndex() const {
+    while (true) {
+        const int tablesIndex = mPublishedTapDistanceTablesIndex.load();
+        mTapDistanceTablesReaderCounts[tablesIndex].fetch_add(1);
+        // The tables might have been unpublished and started being rebuilt before the reader
+        // was counted.
+        if (mPublishedTapDistanceTablesIndex.load() == tablesIndex) {
+            return tablesIndex;
+        }
+        mTapDistanceTablesReaderCounts[tablesIndex].fetch_sub(1);
+    }
+}
+
+// Same as getNormalizedSquaredDistanceFromCenterFloatG(keyId, x, y, false), with the key shifted
+// by its learned offset.
+float ProximityInfo::getNormalizedSquaredDistanceFromCenterForTap(
+        const TapDistanceTables *const tables, const int keyId, const int x, const int y) const {
+    return getNormalizedSquaredDistanceFromCenterFloatG(keyId, x - tables->mKeyOffsetXs[keyId],
+            y - tables->mKeyOffsetYs[keyId], false /* isGeometric */);
+}
+
+void ProximityInfo::initializeTapDistanceTables(TapDistanceTables *const outTables) const {
+    const float squaredMostCommonKeyWidth =
+            GeometryUtils::SQUARE_FLOAT(static_cast<float>(getMostCommonKeyWidth()));
+    const int columnCount =
+            (KEYBOARD_WIDTH + TAP_DISTANCE_TABLE_CELL_SIZE - 1) / TAP_DISTANCE_TABLE_CELL_SIZE;
+    const int rowCount =
+            (KEYBOARD_HEIGHT + TAP_DISTANCE_TABLE_CELL_SIZE - 1) / TAP_DISTANCE_TABLE_CELL_SIZE;
+    outTables->mXTable.resize(columnCount * KEY_COUNT);
+    for (int column = 0; column < columnCount; ++column) {
+        const int x = column * TAP_DISTANCE_TABLE_CELL_SIZE + TAP_DISTANCE_TABLE_CELL_SIZE / 2;
+        for (int keyId = 0; keyId < KEY_COUNT; ++keyId) {
+            // Shifting the key by the offset is the same as shifting the point the other way.
+            const int shiftedX = x - outTables->mKeyOffsetXs[keyId];
+            const float distanceX = static_cast<float>(
+                    shiftedX - getKeyCenterXOfKeyIdG(keyId, shiftedX, false /* isGeometric */));
+            outTables->mXTable[column * KEY_COUNT + keyId] =
+                    GeometryUtils::SQUARE_FLOAT(distanceX) / squaredMostCommonKeyWidth;
+        }
+    }
+    outTables->mYTable.resize(rowCount * KEY_COUNT);
+    for (int row = 0; row < rowCount; ++row) {
+        const int y = row * TAP_DISTANCE_TABLE_CELL_SIZE + TAP_DISTANCE_TABLE_CELL_SIZE / 2;
+        for (int keyId = 0; keyId < KEY_COUNT; ++keyId) {
+            const int shiftedY = y - outTables->mKeyOffsetYs[keyId];
+            const float distanceY = static_cast<float>(
+                    shiftedY - getKeyCenterYOfKeyIdG(keyId, shiftedY, false /* isGeometric */));
+            outTables->mYTable[row * KEY_COUNT + keyId] =
+                    GeometryUtils::SQUARE_FLOAT(distanceY) / squaredMostCommonKeyWidth;
+        }
+    }
 }
 
 // referencePointX is used only for keys wider than most common key width. When the referencePointX
@@ -17,6 +17,9 @@
 #ifndef LATINIME_PROXIMITY_INFO_H
 #define LATINIME_PROXIMITY_INFO_H
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -26,6 +29,9 @@
 
 namespace latinime {
 
+class MemoryUsage;
+class TouchPositionModel;
+
 class ProximityInfo {
  public:
     ProximityInfo(JNIEnv *env, const int keyboardWidth, const int keyboardHeight,
@@ -35,10 +41,23 @@ class ProximityInfo {
             const jintArray keyYCoordinates, const jintArray keyWidths, const jintArray keyHeights,
             const jintArray keyCharCodes, const jfloatArray sweetSpotCenterXs,
             const jfloatArray sweetSpotCenterYs, const jfloatArray sweetSpotRadii);
+    // Same as above without JNI, for native tools. Null arrays are read as zeros.
+    ProximityInfo(const int keyboardWidth, const int keyboardHeight,
+            const int gridWidth, const int gridHeight,
+            const int mostCommonKeyWidth, const int mostCommonKeyHeight,
+            const int *const proximityChars, const int proximityCharsLength, const int keyCount,
+            const int *const keyXCoordinates, const int *const keyYCoordinates,
+            const int *const keyWidths, const int *const keyHeights,
+            const int *const keyCharCodes, const float *const sweetSpotCenterXs,
+            const float *const sweetSpotCenterYs, const float *const sweetSpotRadii);
     ~ProximityInfo();
     bool hasSpaceProximity(const int x, const int y) const;
     float getNormalizedSquaredDistanceFromCenterFloatG(
             const int keyId, const int x, const int y, const bool isGeometric) const;
+    // Outputs getNormalizedSquaredDistanceFromCenterFloatG(keyId, x, y, false) for all keys.
+    // outDistances must have room for getKeyCount() elements.
+    void getNormalizedSquaredDistancesFromCentersForTap(const int x, const int y,
+            float *const outDistances) const;
     int getCodePointOf(const int keyIndex) const;
     int getOriginalCodePointOf(const int keyIndex) const;
     bool hasSweetSpotData(const int keyIndex) const {
@@ -69,6 +88,13 @@ class ProximityInfo {
     int getKeyCenterYOfKeyIdG(
             const int keyId, const int referencePointY, const bool isGeometric) const;
     int getKeyKeyDistanceG(int keyId0, int keyId1) const;
+    // Outputs getNormalizedSquaredDistanceFromCenterFloatG(keyId, x, y, true) for all keys.
+    // outDistances must have room for getKeyCount() elements.
+    void getNormalizedSquaredDistancesFromCentersForGesture(const int x, const int y,
+            float *const outDistances) const;
+    // Key centers for geometric input without reference points, indexed by key id.
+    const float *getKeyCenterXsG() const { return mKeyCenterXsForSimdG; }
+    const float *getKeyCenterYsG() const { return mKeyCenterYsForSimdG; }
 
     AK_FORCE_INLINE void initializeProximities(const int *const inputCodes,
             const int *const inputXCoordinates, const int *const inputYCoordinates,
@@ -76,21 +102,63 @@ class ProximityInfo {
         ProximityInfoUtils::initializeProximities(inputCodes, inputXCoordinates, inputYCoordinates,
                 inputSize, mKeyXCoordinates, mKeyYCoordinates, mKeyWidths, mKeyHeights,
                 mProximityCharsArray, CELL_HEIGHT, CELL_WIDTH, GRID_WIDTH, MOST_COMMON_KEY_WIDTH,
-                KEY_COUNT, locale, &mLowerCodePointToKeyMap, allInputCodes);
+                KEY_COUNT, locale, mKeyIndexTable, &mLowerCodePointToKeyMap, allInputCodes);
     }
 
     AK_FORCE_INLINE int getKeyIndexOf(const int c) const {
-        return ProximityInfoUtils::getKeyIndexOf(KEY_COUNT, c, &mLowerCodePointToKeyMap);
+        return ProximityInfoUtils::getKeyIndexOf(KEY_COUNT, c, mKeyIndexTable,
+                &mLowerCodePointToKeyMap);
     }
 
     AK_FORCE_INLINE bool isCodePointOnKeyboard(const int codePoint) const {
         return getKeyIndexOf(codePoint) != NOT_AN_INDEX;
     }
 
+    // Compiles the key offsets learned by the model into the tap distance tables, unless they
+    // are the same as the last time. The key centers themselves and geometric input are not
+    // affected.
+    void applyTouchPositionModel(const TouchPositionModel *const touchPositionModel);
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(ProximityInfo);
 
+    // For tap input, the normalized squared distance from a point to a key is the sum of a part
+    // that only depends on x and a part that only depends on y. These tables hold those parts,
+    // sampled at the centers of TAP_DISTANCE_TABLE_CELL_SIZE wide columns and rows. They are
+    // indexed by [column * KEY_COUNT + keyId] and [row * KEY_COUNT + keyId]. The keys are shifted
+    // by the offsets learned by TouchPositionModel.
+    struct TapDistanceTables {
+        std::vector<float> mXTable;
+        std::vector<float> mYTable;
+        int mKeyOffsetXs[MAX_KEY_COUNT_IN_A_KEYBOARD];
+        int mKeyOffsetYs[MAX_KEY_COUNT_IN_A_KEYBOARD];
+    };
+
+    // Counts the reader of the published tap distance tables while it is alive.
+    class ScopedReadingTapDistanceTables {
+     public:
+        explicit ScopedReadingTapDistanceTables(const ProximityInfo *const proximityInfo);
+        ~ScopedReadingTapDistanceTables();
+
+        const TapDistanceTables *get() const {
+            return &mProximityInfo->mTapDistanceTables[mTablesIndex];
+        }
+
+     private:
+        DISALLOW_IMPLICIT_CONSTRUCTORS(ScopedReadingTapDistanceTables);
+
+        const ProximityInfo *const mProximityInfo;
+        const int mTablesIndex;
+    };
+
     void initializeG();
+    int acquireTapDistanceTablesIndex() const;
+    void initializeTapDistanceTables(TapDistanceTables *const outTables) const;
+    float getNormalizedSquaredDistanceFromCenterForTap(const TapDistanceTables *const tables,
+            const int keyId, const int x, const int y) const;
+    void initializeKeyIndexTable();
 
     const int GRID_WIDTH;
     const int GRID_HEIGHT;
@@ -104,6 +172,7 @@ class ProximityInfo {
     const int KEYBOARD_HEIGHT;
     const float KEYBOARD_HYPOTENUSE;
     const bool HAS_TOUCH_POSITION_CORRECTION_DATA;
+    const int TAP_DISTANCE_TABLE_CELL_SIZE;
     int *mProximityCharsArray;
     int mKeyXCoordinates[MAX_KEY_COUNT_IN_A_KEYBOARD];
     int mKeyYCoordinates[MAX_KEY_COUNT_IN_A_KEYBOARD];
@@ -116,11 +185,29 @@ class ProximityInfo {
     float mSweetSpotCenterYsG[MAX_KEY_COUNT_IN_A_KEYBOARD];
     float mSweetSpotRadii[MAX_KEY_COUNT_IN_A_KEYBOARD];
     std::unordered_map<int, int> mLowerCodePointToKeyMap;
+    // getKeyIndexOf() of the code points below ProximityInfoUtils::KEY_INDEX_TABLE_SIZE. The key
+    // indices are less than MAX_KEY_COUNT_IN_A_KEYBOARD, so they fit in a byte.
+    int8_t mKeyIndexTable[ProximityInfoUtils::KEY_INDEX_TABLE_SIZE];
     int mKeyIndexToOriginalCodePoint[MAX_KEY_COUNT_IN_A_KEYBOARD];
     int mKeyIndexToLowerCodePointG[MAX_KEY_COUNT_IN_A_KEYBOARD];
     int mCenterXsG[MAX_KEY_COUNT_IN_A_KEYBOARD];
     int mCenterYsG[MAX_KEY_COUNT_IN_A_KEYBOARD];
     int mKeyKeyDistancesG[MAX_KEY_COUNT_IN_A_KEYBOARD][MAX_KEY_COUNT_IN_A_KEYBOARD];
+    // Searches read the published tables without locking, so the tables for a new model version
+    // are built into the other ones once no reader is left on them, and then published.
+    TapDistanceTables mTapDistanceTables[2];
+    std::atomic<int> mPublishedTapDistanceTablesIndex;
+    mutable std::atomic<int> mTapDistanceTablesReaderCounts[2];
+    std::mutex mTouchPositionModelMutex;
+    std::atomic<int> mTouchPositionModelVersion;
+    // Key geometry for geometric input as struct of arrays for ProximityInfoSimdUtils. A point is
+    // compared against the segment [mKeyMinXsForSimdG, mKeyMaxXsForSimdG] of wide keys, and
+    // against the segment [mKeyCenterYsForSimdG, mKeyMaxYsForSimdG] of bottom row keys.
+    float mKeyCenterXsForSimdG[MAX_KEY_COUNT_IN_A_KEYBOARD];
+    float mKeyCenterYsForSimdG[MAX_KEY_COUNT_IN_A_KEYBOARD];
+    float mKeyMinXsForSimdG[MAX_KEY_COUNT_IN_A_KEYBOARD];
+    float mKeyMaxXsForSimdG[MAX_KEY_COUNT_IN_A_KEYBOARD];
+    float mKeyMaxYsForSimdG[MAX_KEY_COUNT_IN_A_KEYBOARD];
 };
 } // namespace latinime
 #endif // LATINIME_PROXIMITY_INFO_H
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LatinIME: proximity_info_cache.cpp"
+
+#include "suggest/core/layout/proximity_info_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "suggest/core/layout/proximity_info.h"
+
+namespace latinime {
+
+// Enough for the letters, symbols and shifted symbols layouts of a couple of languages.
+const int ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT = 6;
+ProximityInfoCache ProximityInfoCache::sInstance;
+
+ProximityInfoCache::ProximityInfoCache()
+        : mMutex(), mEntries(), mContentBuffer(), mSequenceNumber(0) {}
+
+ProximityInfoCache::~ProximityInfoCache() {}
+
+ProximityInfo *ProximityInfoCache::acquire(JNIEnv *env, const int keyboardWidth,
+        const int keyboardHeight, const int gridWidth, const int gridHeight,
+        const int mostCommonKeyWidth, const int mostCommonKeyHeight,
+        const jintArray proximityChars, const int keyCount, const jintArray keyXCoordinates,
+        const jintArray keyYCoordinates, const jintArray keyWidths, const jintArray keyHeights,
+        const jintArray keyCharCodes, const jfloatArray sweetSpotCenterXs,
+        const jfloatArray sweetSpotCenterYs, const jfloatArray sweetSpotRadii) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const int arrayKeyCount = std::min(keyCount, MAX_KEY_COUNT_IN_A_KEYBOARD);
+    startContent(keyboardWidth, keyboardHeight, gridWidth, gridHeight, mostCommonKeyWidth,
+            mostCommonKeyHeight, keyCount);
+    appendIntArray(env, proximityChars,
+            proximityChars ? env->GetArrayLength(proximityChars) : 0, &mContentBuffer);
+    appendIntArray(env, keyXCoordinates, arrayKeyCount, &mContentBuffer);
+    appendIntArray(env, keyYCoordinates, arrayKeyCount, &mContentBuffer);
+    appendIntArray(env, keyWidths, arrayKeyCount, &mContentBuffer);
+    appendIntArray(env, keyHeights, arrayKeyCount, &mContentBuffer);
+    appendIntArray(env, keyCharCodes, arrayKeyCount, &mContentBuffer);
+    appendFloatArray(env, sweetSpotCenterXs, arrayKeyCount, &mContentBuffer);
+    appendFloatArray(env, sweetSpotCenterYs, arrayKeyCount, &mContentBuffer);
+    appendFloatArray(env, sweetSpotRadii, arrayKeyCount, &mContentBuffer);
+    const uint64_t contentHash = getContentHash(mContentBuffer);
+    ProximityInfo *const cachedProximityInfo = acquireCachedEntry(contentHash);
+    if (cachedProximityInfo) {
+        return cachedProximityInfo;
+    }
+    ProximityInfo *const proximityInfo = new ProximityInfo(env, keyboardWidth, keyboardHeight,
+            gridWidth, gridHeight, mostCommonKeyWidth, mostCommonKeyHeight, proximityChars,
+            keyCount, keyXCoordinates, keyYCoordinates, keyWidths, keyHeights, keyCharCodes,
+            sweetSpotCenterXs, sweetSpotCenterYs, sweetSpotRadii);
+    addEntry(contentHash, proximityInfo);
+    return proximityInfo;
+}
+
+ProximityInfo *ProximityInfoCache::acquire(const int keyboardWidth, const int keyboardHeight,
+        const int gridWidth, const int gridHeight,
+        const int mostCommonKeyWidth, const int mostCommonKeyHeight,
+        const int *const proximityChars, const int proximityCharsLength, const int keyCount,
+        const int *const keyXCoordinates, const int *const keyYCoordinates,
+        const int *const keyWidths, const int *const keyHeights,
+        const int *const keyCharCodes, const float *const sweetSpotCenterXs,
+        const float *const sweetSpotCenterYs, const float *const sweetSpotRadii) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const int arrayKeyCount = std::min(keyCount, MAX_KEY_COUNT_IN_A_KEYBOARD);
+    startContent(keyboardWidth, keyboardHeight, gridWidth, gridHeight, mostCommonKeyWidth,
+            mostCommonKeyHeight, keyCount);
+    appendIntArray(proximityChars, proximityCharsLength, &mContentBuffer);
+    appendIntArray(keyXCoordinates, arrayKeyCount, &mContentBuffer);
+    appendIntArray(keyYCoordinates, arrayKeyCount, &mContentBuffer);
+    appendIntArray(keyWidths, arrayKeyCount, &mContentBuffer);
+    appendIntArray(keyHeights, arrayKeyCount, &mContentBuffer);
+    appendIntArray(keyCharCodes, arrayKeyCount, &mContentBuffer);
+    appendFloatArray(sweetSpotCenterXs, arrayKeyCount, &mContentBuffer);
+    appendFloatArray(sweetSpotCenterYs, arrayKeyCount, &mContentBuffer);
+    appendFloatArray(sweetSpotRadii, arrayKeyCount, &mContentBuffer);
+    const uint64_t contentHash = getContentHash(mContentBuffer);
+    ProximityInfo *const cachedProximityInfo = acquireCachedEntry(contentHash);
+    if (cachedProximityInfo) {
+        return cachedProximityInfo;
+    }
+    ProximityInfo *const proximityInfo = new ProximityInfo(keyboardWidth, keyboardHeight,
+            gridWidth, gridHeight, mostCommonKeyWidth, mostCommonKeyHeight, proximityChars,
+            proximityCharsLength, keyCount, keyXCoordinates, keyYCoordinates, keyWidths,
+            keyHeights, keyCharCodes, sweetSpotCenterXs, sweetSpotCenterYs, sweetSpotRadii);
+    addEntry(contentHash, proximityInfo);
+    return proximityInfo;
+}
+
+void ProximityInfoCache::release(const ProximityInfo *const proximityInfo) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (Entry &entry : mEntries) {
+        if (entry.mProximityInfo.get() == proximityInfo) {
+            if (--entry.mReferenceCount == 0) {
+                entry.mLastReleasedSequenceNumber = ++mSequenceNumber;
+                evictUnusedEntries();
+            }
+            return;
+        }
+    }
+    AKLOGE("Released ProximityInfo %p is not in the cache.", proximityInfo);
+    ASSERT(false);
+}
+
+int ProximityInfoCache::getEntryCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return static_cast<int>(mEntries.size());
+}
+
+void ProximityInfoCache::startContent(const int keyboardWidth, const int keyboardHeight,
+        const int gridWidth, const int gridHeight, const int mostCommonKeyWidth,
+        const int mostCommonKeyHeight, const int keyCount) {
+    mContentBuffer.clear();
+    mContentBuffer.push_back(keyboardWidth);
+    mContentBuffer.push_back(keyboardHeight);
+    mContentBuffer.push_back(gridWidth);
+    mContentBuffer.push_back(gridHeight);
+    mContentBuffer.push_back(mostCommonKeyWidth);
+    mContentBuffer.push_back(mostCommonKeyHeight);
+    mContentBuffer.push_back(keyCount);
+}
+
+/* static */ void ProximityInfoCache::appendIntArray(JNIEnv *env, const jintArray array,
+        const int length, std::vector<int> *const outContent) {
+    // A null array and an empty array give different ProximityInfo instances.
+    if (!array) {
+        outContent->push_back(NOT_AN_INDEX);
+        return;
+    }
+    outContent->push_back(length);
+    const size_t start = outContent->size();
+    outContent->resize(start + length);
+    env->GetIntArrayRegion(array, 0, length, outContent->data() + start);
+}
+
+/* static */ void ProximityInfoCache::appendFloatArray(JNIEnv *env, const jfloatArray array,
+        const int length, std::vector<int> *const outContent) {
+    if (!array) {
+        outContent->push_back(NOT_AN_INDEX);
+        return;
+    }
+    outContent->push_back(length);
+    const size_t start = outContent->size();
+    outContent->resize(start + length);
+    // Floats are compared bitwise.
+    static_assert(sizeof(jfloat) == sizeof(int), "jfloat and int must have the same size.");
+    env->GetFloatArrayRegion(array, 0, length,
+            reinterpret_cast<jfloat *>(outContent->data() + start));
+}
+
+/* static */ void ProximityInfoCache::appendIntArray(const int *const array, const int length,
+        std::vector<int> *const outContent) {
+    if (!array) {
+        outContent->push_back(NOT_AN_INDEX);
+        return;
+    }
+    outContent->push_back(length);
+    outContent->insert(outContent->end(), array, array + length);
+}
+
+/* static */ void ProximityInfoCache::appendFloatArray(const float *const array,
+        const int length, std::vector<int> *const outContent) {
+    if (!array) {
+        outContent->push_back(NOT_AN_INDEX);
+        return;
+    }
+    outContent->push_back(length);
+    const size_t start = outContent->size();
+    outContent->resize(start + length);
+    static_assert(sizeof(float) == sizeof(int), "float and int must have the same size.");
+    memcpy(outContent->data() + start, array, length * sizeof(float));
+}
+
+// FNV-1a
+/* static */ uint64_t ProximityInfoCache::getContentHash(const std::vector<int> &content) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const int value : content) {
+        hash ^= static_cast<uint32_t>(value);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+ProximityInfo *ProximityInfoCache::acquireCachedEntry(const uint64_t contentHash) {
+    for (Entry &entry : mEntries) {
+        if (entry.mContentHash == contentHash && entry.mContent == mContentBuffer) {
+            ++entry.mReferenceCount;
+            return entry.mProximityInfo.get();
+        }
+    }
+    return nullptr;
+}
+
+void ProximityInfoCache::addEntry(const uint64_t contentHash,
+        ProximityInfo *const proximityInfo) {
+    mEntries.push_back(Entry{contentHash, mContentBuffer,
+            std::unique_ptr<ProximityInfo>(proximityInfo), 1 /* referenceCount */,
+            0 /* lastReleasedSequenceNumber */});
+}
+
+void ProximityInfoCache::evictUnusedEntries() {
+    int unusedEntryCount = 0;
+    for (const Entry &entry : mEntries) {
+        if (entry.mReferenceCount == 0) {
+            ++unusedEntryCount;
+        }
+    }
+    while (unusedEntryCount > MAX_UNUSED_ENTRY_COUNT) {
+        auto leastRecentlyReleased = mEntries.end();
+        for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+            if (it->mReferenceCount == 0 && (leastRecentlyReleased == mEntries.end()
+                    || it->mLastReleasedSequenceNumber
+                            < leastRecentlyReleased->mLastReleasedSequenceNumber)) {
+                leastRecentlyReleased = it;
+            }
+        }
+        mEntries.erase(leastRecentlyReleased);
+        --unusedEntryCount;
+    }
+}
+} // namespace latinime
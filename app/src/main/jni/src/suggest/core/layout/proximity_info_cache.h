@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_PROXIMITY_INFO_CACHE_H
+#define LATINIME_PROXIMITY_INFO_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "defines.h"
+#include "jni.h"
+
+namespace latinime {
+
+class ProximityInfo;
+
+/**
+ * Shares ProximityInfo instances between keyboards with the same geometry, so that switching
+ * back to a layout that was built before (e.g. letters <-> symbols) doesn't build it again.
+ *
+ * Instances are reference counted and keyed by the full content they are built from. A few
+ * instances that are not used anymore are kept around for the next layout switch.
+ *
+ * This class is thread-safe.
+ */
+class ProximityInfoCache {
+ public:
+    // How many instances that are not used anymore are kept.
+    static const int MAX_UNUSED_ENTRY_COUNT;
+
+    static ProximityInfoCache *getInstance() { return &sInstance; }
+
+    // The app shares getInstance(). Tests and native tools may have their own caches.
+    ProximityInfoCache();
+    ~ProximityInfoCache();
+
+    // Takes the same arguments as the ProximityInfo constructor. Each returned instance must be
+    // given back with release().
+    ProximityInfo *acquire(JNIEnv *env, const int keyboardWidth, const int keyboardHeight,
+            const int gridWidth, const int gridHeight,
+            const int mostCommonKeyWidth, const int mostCommonKeyHeight,
+            const jintArray proximityChars, const int keyCount, const jintArray keyXCoordinates,
+            const jintArray keyYCoordinates, const jintArray keyWidths, const jintArray keyHeights,
+            const jintArray keyCharCodes, const jfloatArray sweetSpotCenterXs,
+            const jfloatArray sweetSpotCenterYs, const jfloatArray sweetSpotRadii);
+    // Same as above without JNI, taking the same arguments as the native ProximityInfo
+    // constructor.
+    ProximityInfo *acquire(const int keyboardWidth, const int keyboardHeight,
+            const int gridWidth, const int gridHeight,
+            const int mostCommonKeyWidth, const int mostCommonKeyHeight,
+            const int *const proximityChars, const int proximityCharsLength, const int keyCount,
+            const int *const keyXCoordinates, const int *const keyYCoordinates,
+            const int *const keyWidths, const int *const keyHeights,
+            const int *const keyCharCodes, const float *const sweetSpotCenterXs,
+            const float *const sweetSpotCenterYs, const float *const sweetSpotRadii);
+    void release(const ProximityInfo *const proximityInfo);
+
+    int getEntryCount() const;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(ProximityInfoCache);
+
+    struct Entry {
+        uint64_t mContentHash;
+        std::vector<int> mContent;
+        std::unique_ptr<ProximityInfo> mProximityInfo;
+        int mReferenceCount;
+        uint64_t mLastReleasedSequenceNumber;
+    };
+
+    static ProximityInfoCache sInstance;
+
+    void startContent(const int keyboardWidth, const int keyboardHeight, const int gridWidth,
+            const int gridHeight, const int mostCommonKeyWidth, const int mostCommonKeyHeight,
+            const int keyCount);
+    static void appendIntArray(JNIEnv *env, const jintArray array, const int length,
+            std::vector<int> *const outContent);
+    static void appendFloatArray(JNIEnv *env, const jfloatArray array, const int length,
+            std::vector<int> *const outContent);
+    static void appendIntArray(const int *const array, const int length,
+            std::vector<int> *const outContent);
+    static void appendFloatArray(const float *const array, const int length,
+            std::vector<int> *const outContent);
+    static uint64_t getContentHash(const std::vector<int> &content);
+
+    // Returns the instance built from mContentBuffer after taking a reference to it, or nullptr
+    // if there is none.
+    ProximityInfo *acquireCachedEntry(const uint64_t contentHash);
+    // Adds the instance built from mContentBuffer with one reference.
+    void addEntry(const uint64_t contentHash, ProximityInfo *const proximityInfo);
+    void evictUnusedEntries();
+
+    mutable std::mutex mMutex;
+    std::vector<Entry> mEntries;
+    // The content of the requested instance. Kept across calls so that cache hits don't allocate.
+    std::vector<int> mContentBuffer;
+    uint64_t mSequenceNumber;
+};
+} // namespace latinime
+#endif // LATINIME_PROXIMITY_INFO_CACHE_H
@@ -24,6 +24,15 @@ const float ProximityInfoParams::VERTICAL_SWEET_SPOT_SCALE = 1.0f;
 const float ProximityInfoParams::VERTICAL_SWEET_SPOT_SCALE_G = 0.5f;
 
 /* Per method constants */
+// Used by ProximityInfo::initializeTapDistanceTables()
+const int ProximityInfoParams::TAP_DISTANCE_TABLE_CELLS_PER_KEY_WIDTH = 16;
+
+// Used by ProximityInfoStateUtils::updateTouchPoints()
+// The gesture points closer than 1/8 of the key width to the last point the sampling evaluated
+// are skipped, unless the trace turns there.
+const int ProximityInfoParams::TRACE_DECIMATION_DISTANCE_SCALE = 8;
+const float ProximityInfoParams::TRACE_DECIMATION_CORNER_ANGLE_THRESHOLD = M_PI_F * 30.0f / 180.0f;
+
 // Used by ProximityInfoStateUtils::updateNearKeysDistances()
 const float ProximityInfoParams::NEAR_KEY_THRESHOLD_FOR_DISTANCE = 2.0f;
 
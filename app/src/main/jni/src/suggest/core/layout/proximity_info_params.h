@@ -28,6 +28,13 @@ class ProximityInfoParams {
     static const float VERTICAL_SWEET_SPOT_SCALE;
     static const float VERTICAL_SWEET_SPOT_SCALE_G;
 
+    // Used by ProximityInfo::initializeTapDistanceTables()
+    static const int TAP_DISTANCE_TABLE_CELLS_PER_KEY_WIDTH;
+
+    // Used by ProximityInfoStateUtils::updateTouchPoints()
+    static const int TRACE_DECIMATION_DISTANCE_SCALE;
+    static const float TRACE_DECIMATION_CORNER_ANGLE_THRESHOLD;
+
     // Used by ProximityInfoStateUtils::updateNearKeysDistances()
     static const float NEAR_KEY_THRESHOLD_FOR_DISTANCE;
 
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/layout/proximity_info_simd_utils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring> // for memcpy()
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LATINIME_USE_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LATINIME_USE_SSE2
+#endif
+
+namespace latinime {
+
+// exp(x) is computed as 2^n * exp(u), where n = round(x * log2(e)) and u = x - n * ln(2) is in
+// [-ln(2) / 2, ln(2) / 2], where a degree 6 Taylor polynomial of exp is accurate enough. 2^n is
+// built from its exponent bits. ln(2) is split in two so that u is computed precisely.
+static const float LOG2_E = 1.44269504f;
+static const float LN2_HIGH = 0.693359375f;
+static const float LN2_LOW = -2.12194440e-4f;
+// Adding this rounds floats below 2^22 to integers that are then stored in the low mantissa bits.
+static const float ROUND_TO_INT = 12582912.0f; // 1.5 * 2^23
+static const int32_t ROUND_TO_INT_BITS = 0x4B400000;
+static const float MIN_EXP2 = -126.0f;
+static const float MAX_EXP2 = 127.0f;
+static const float EXP_COEFFS[] = { 1.0f / 720.0f, 1.0f / 120.0f, 1.0f / 24.0f, 1.0f / 6.0f,
+        1.0f / 2.0f, 1.0f, 1.0f };
+
+/* static */ void ProximityInfoSimdUtils::computeScaledSquaredDistances(const float x,
+        const float y, const float *const minXs, const float *const maxXs,
+        const float *const centerYs, const float *const maxYs, const int count,
+        const float scale, float *const outDistances) {
+    int k = 0;
+#if defined(LATINIME_USE_NEON)
+    const float32x4_t xv = vdupq_n_f32(x);
+    const float32x4_t yv = vdupq_n_f32(y);
+    const float32x4_t scalev = vdupq_n_f32(scale);
+    for (; k + 4 <= count; k += 4) {
+        const float32x4_t nearestXs =
+                vminq_f32(vmaxq_f32(xv, vld1q_f32(minXs + k)), vld1q_f32(maxXs + k));
+        const float32x4_t nearestYs =
+                vmaxq_f32(vld1q_f32(centerYs + k), vminq_f32(yv, vld1q_f32(maxYs + k)));
+        const float32x4_t dx = vsubq_f32(xv, nearestXs);
+        const float32x4_t dy = vsubq_f32(yv, nearestYs);
+        const float32x4_t squaredDistances = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+        vst1q_f32(outDistances + k, vmulq_f32(squaredDistances, scalev));
+    }
+#elif defined(LATINIME_USE_SSE2)
+    const __m128 xv = _mm_set1_ps(x);
+    const __m128 yv = _mm_set1_ps(y);
+    const __m128 scalev = _mm_set1_ps(scale);
+    for (; k + 4 <= count; k += 4) {
+        const __m128 nearestXs =
+                _mm_min_ps(_mm_max_ps(xv, _mm_loadu_ps(minXs + k)), _mm_loadu_ps(maxXs + k));
+        const __m128 nearestYs =
+                _mm_max_ps(_mm_loadu_ps(centerYs + k), _mm_min_ps(yv, _mm_loadu_ps(maxYs + k)));
+        const __m128 dx = _mm_sub_ps(xv, nearestXs);
+        const __m128 dy = _mm_sub_ps(yv, nearestYs);
+        const __m128 squaredDistances = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        _mm_storeu_ps(outDistances + k, _mm_mul_ps(squaredDistances, scalev));
+    }
+#endif
+    for (; k < count; ++k) {
+        const float dx = x - std::min(std::max(x, minXs[k]), maxXs[k]);
+        const float dy = y - std::max(centerYs[k], std::min(y, maxYs[k]));
+        outDistances[k] = (dx * dx + dy * dy) * scale;
+    }
+}
+
+/* static */ void ProximityInfoSimdUtils::computeRotatedGaussianExponents(
+        const float *const xs, const float *const ys, const int count, const float uX,
+        const float uY, const float cosTheta, const float sinTheta, const float exponentX,
+        const float exponentY, float *const outExponents) {
+    int k = 0;
+#if defined(LATINIME_USE_NEON)
+    const float32x4_t uXv = vdupq_n_f32(uX);
+    const float32x4_t uYv = vdupq_n_f32(uY);
+    const float32x4_t cosv = vdupq_n_f32(cosTheta);
+    const float32x4_t sinv = vdupq_n_f32(sinTheta);
+    const float32x4_t exponentXv = vdupq_n_f32(exponentX);
+    const float32x4_t exponentYv = vdupq_n_f32(exponentY);
+    for (; k + 4 <= count; k += 4) {
+        const float32x4_t shiftedXs = vsubq_f32(vld1q_f32(xs + k), uXv);
+        const float32x4_t shiftedYs = vsubq_f32(vld1q_f32(ys + k), uYv);
+        const float32x4_t rotatedXs =
+                vaddq_f32(vmulq_f32(cosv, shiftedXs), vmulq_f32(sinv, shiftedYs));
+        const float32x4_t rotatedYs =
+                vsubq_f32(vmulq_f32(cosv, shiftedYs), vmulq_f32(sinv, shiftedXs));
+        vst1q_f32(outExponents + k,
+                vaddq_f32(vmulq_f32(exponentXv, vmulq_f32(rotatedXs, rotatedXs)),
+                        vmulq_f32(exponentYv, vmulq_f32(rotatedYs, rotatedYs))));
+    }
+#elif defined(LATINIME_USE_SSE2)
+    const __m128 uXv = _mm_set1_ps(uX);
+    const __m128 uYv = _mm_set1_ps(uY);
+    const __m128 cosv = _mm_set1_ps(cosTheta);
+    const __m128 sinv = _mm_set1_ps(sinTheta);
+    const __m128 exponentXv = _mm_set1_ps(exponentX);
+    const __m128 exponentYv = _mm_set1_ps(exponentY);
+    for (; k + 4 <= count; k += 4) {
+        const __m128 shiftedXs = _mm_sub_ps(_mm_loadu_ps(xs + k), uXv);
+        const __m128 shiftedYs = _mm_sub_ps(_mm_loadu_ps(ys + k), uYv);
+        const __m128 rotatedXs =
+                _mm_add_ps(_mm_mul_ps(cosv, shiftedXs), _mm_mul_ps(sinv, shiftedYs));
+        const __m128 rotatedYs =
+                _mm_sub_ps(_mm_mul_ps(cosv, shiftedYs), _mm_mul_ps(sinv, shiftedXs));
+        _mm_storeu_ps(outExponents + k,
+                _mm_add_ps(_mm_mul_ps(exponentXv, _mm_mul_ps(rotatedXs, rotatedXs)),
+                        _mm_mul_ps(exponentYv, _mm_mul_ps(rotatedYs, rotatedYs))));
+    }
+#endif
+    for (; k < count; ++k) {
+        const float shiftedX = xs[k] - uX;
+        const float shiftedY = ys[k] - uY;
+        const float rotatedX = cosTheta * shiftedX + sinTheta * shiftedY;
+        const float rotatedY = cosTheta * shiftedY - sinTheta * shiftedX;
+        outExponents[k] = exponentX * rotatedX * rotatedX + exponentY * rotatedY * rotatedY;
+    }
+}
+
+/* static */ void ProximityInfoSimdUtils::computeScaledExps(const float *const exponents,
+        const int count, const float scale, float *const outValues) {
+    int k = 0;
+#if defined(LATINIME_USE_NEON)
+    const float32x4_t roundv = vdupq_n_f32(ROUND_TO_INT);
+    const float32x4_t minv = vdupq_n_f32(MIN_EXP2);
+    const float32x4_t scalev = vdupq_n_f32(scale);
+    for (; k + 4 <= count; k += 4) {
+        const float32x4_t xs = vld1q_f32(exponents + k);
+        const float32x4_t ts = vmulq_f32(xs, vdupq_n_f32(LOG2_E));
+        const uint32x4_t isNormal = vcgeq_f32(ts, minv);
+        const float32x4_t roundeds =
+                vaddq_f32(vminq_f32(vmaxq_f32(ts, minv), vdupq_n_f32(MAX_EXP2)), roundv);
+        const float32x4_t ns = vsubq_f32(roundeds, roundv);
+        const float32x4_t us = vmlsq_f32(vmlsq_f32(xs, ns, vdupq_n_f32(LN2_HIGH)), ns,
+                vdupq_n_f32(LN2_LOW));
+        float32x4_t ps = vdupq_n_f32(EXP_COEFFS[0]);
+        for (size_t i = 1; i < NELEMS(EXP_COEFFS); ++i) {
+            ps = vmlaq_f32(vdupq_n_f32(EXP_COEFFS[i]), ps, us);
+        }
+        const int32x4_t exp2Bits = vshlq_n_s32(vaddq_s32(vsubq_s32(
+                vreinterpretq_s32_f32(roundeds), vdupq_n_s32(ROUND_TO_INT_BITS)),
+                vdupq_n_s32(127)), 23);
+        const float32x4_t values =
+                vmulq_f32(vmulq_f32(ps, vreinterpretq_f32_s32(exp2Bits)), scalev);
+        vst1q_f32(outValues + k, vreinterpretq_f32_u32(
+                vandq_u32(vreinterpretq_u32_f32(values), isNormal)));
+    }
+#elif defined(LATINIME_USE_SSE2)
+    const __m128 roundv = _mm_set1_ps(ROUND_TO_INT);
+    const __m128 minv = _mm_set1_ps(MIN_EXP2);
+    const __m128 scalev = _mm_set1_ps(scale);
+    for (; k + 4 <= count; k += 4) {
+        const __m128 xs = _mm_loadu_ps(exponents + k);
+        const __m128 ts = _mm_mul_ps(xs, _mm_set1_ps(LOG2_E));
+        const __m128 isNormal = _mm_cmpge_ps(ts, minv);
+        const __m128 roundeds =
+                _mm_add_ps(_mm_min_ps(_mm_max_ps(ts, minv), _mm_set1_ps(MAX_EXP2)), roundv);
+        const __m128 ns = _mm_sub_ps(roundeds, roundv);
+        const __m128 us = _mm_sub_ps(_mm_sub_ps(xs, _mm_mul_ps(ns, _mm_set1_ps(LN2_HIGH))),
+                _mm_mul_ps(ns, _mm_set1_ps(LN2_LOW)));
+        __m128 ps = _mm_set1_ps(EXP_COEFFS[0]);
+        for (size_t i = 1; i < NELEMS(EXP_COEFFS); ++i) {
+            ps = _mm_add_ps(_mm_mul_ps(ps, us), _mm_set1_ps(EXP_COEFFS[i]));
+        }
+        const __m128i exp2Bits = _mm_slli_epi32(_mm_add_epi32(_mm_sub_epi32(
+                _mm_castps_si128(roundeds), _mm_set1_epi32(ROUND_TO_INT_BITS)),
+                _mm_set1_epi32(127)), 23);
+        const __m128 values = _mm_mul_ps(_mm_mul_ps(ps, _mm_castsi128_ps(exp2Bits)), scalev);
+        _mm_storeu_ps(outValues + k, _mm_and_ps(values, isNormal));
+    }
+#endif
+    for (; k < count; ++k) {
+        const float x = exponents[k];
+        const float t = x * LOG2_E;
+        if (t < MIN_EXP2) {
+            outValues[k] = 0.0f;
+            continue;
+        }
+        const float rounded = std::min(t, MAX_EXP2) + ROUND_TO_INT;
+        const float n = rounded - ROUND_TO_INT;
+        const float u = x - n * LN2_HIGH - n * LN2_LOW;
+        float p = EXP_COEFFS[0];
+        for (size_t i = 1; i < NELEMS(EXP_COEFFS); ++i) {
+            p = p * u + EXP_COEFFS[i];
+        }
+        int32_t roundedBits;
+        memcpy(&roundedBits, &rounded, sizeof(roundedBits));
+        const int32_t exp2Bits = (roundedBits - ROUND_TO_INT_BITS + 127) << 23;
+        float exp2;
+        memcpy(&exp2, &exp2Bits, sizeof(exp2));
+        outValues[k] = p * exp2 * scale;
+    }
+}
+} // namespace latinime
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_PROXIMITY_INFO_SIMD_UTILS_H
+#define LATINIME_PROXIMITY_INFO_SIMD_UTILS_H
+
+#include "defines.h"
+
+namespace latinime {
+
+// Per point, all keys kernels used by ProximityInfoStateUtils for gesture input. Keys are given
+// as struct of arrays. NEON and SSE2 versions process 4 keys at a time; other architectures and
+// the remaining keys use the scalar version, which gives the same results up to float rounding.
+class ProximityInfoSimdUtils {
+ public:
+    // outDistances[k] = ((x - min(max(x, minXs[k]), maxXs[k]))^2
+    //         + (y - max(centerYs[k], min(y, maxYs[k])))^2) * scale
+    // This is the squared distance from (x, y) to the segment [minXs[k], maxXs[k]] x centerYs[k]
+    // that is extended to y for keys that have a maxYs[k] above centerYs[k].
+    static void computeScaledSquaredDistances(const float x, const float y,
+            const float *const minXs, const float *const maxXs, const float *const centerYs,
+            const float *const maxYs, const int count, const float scale,
+            float *const outDistances);
+
+    // outExponents[k] = exponentX * rx^2 + exponentY * ry^2, where (rx, ry) is
+    // (xs[k] - uX, ys[k] - uY) rotated by the angle given by cosTheta and sinTheta.
+    static void computeRotatedGaussianExponents(const float *const xs, const float *const ys,
+            const int count, const float uX, const float uY, const float cosTheta,
+            const float sinTheta, const float exponentX, const float exponentY,
+            float *const outExponents);
+
+    // outValues[k] = scale * exp(exponents[k]) within 3e-7 relative error. Results below
+    // FLT_MIN are flushed to zero. exponents and outValues can be the same array.
+    static void computeScaledExps(const float *const exponents, const int count,
+            const float scale, float *const outValues);
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(ProximityInfoSimdUtils);
+};
+} // namespace latinime
+#endif // LATINIME_PROXIMITY_INFO_SIMD_UTILS_H
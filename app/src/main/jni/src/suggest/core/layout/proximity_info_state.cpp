@@ -29,6 +29,8 @@
 #include "suggest/core/layout/proximity_info.h"
 #include "suggest/core/layout/proximity_info_state_utils.h"
 #include "utils/char_utils.h"
+#include "utils/memory_usage.h"
+#include "utils/native_trace.h"
 
 namespace latinime {
 
@@ -43,6 +45,7 @@ void ProximityInfoState::initInputParams(const int pointerId, const float maxPoi
         const ProximityInfo *proximityInfo, const int *const inputCodes, const int inputSize,
         const int *const xCoordinates, const int *const yCoordinates, const int *const times,
         const int *const pointerIds, const bool isGeometric, const std::vector<int> *locale) {
+    const NativeTrace::ScopedSection section("ProximityInfoState::initInputParams");
     ASSERT(isGeometric || (inputSize < MAX_WORD_LENGTH));
     mIsContinuousSuggestionPossible = (mHasBeenUpdatedByGeometricInput != isGeometric) ?
             false : ProximityInfoStateUtils::checkAndReturnIsContinuousSuggestionPossible(
@@ -67,6 +70,12 @@ void ProximityInfoState::initInputParams(const int pointerId, const float maxPoi
     if (!isGeometric && pointerId == 0) {
         mProximityInfo->initializeProximities(inputCodes, xCoordinates, yCoordinates,
                 inputSize, mInputProximities, locale);
+        initProximityKeyMasks(inputSize);
+    } else {
+        // Same as the empty proximity chars.
+        memset(mProximityKeyMasks, 0, sizeof(mProximityKeyMasks));
+        memset(mAdditionalProximityKeyMasks, 0, sizeof(mAdditionalProximityKeyMasks));
+        std::fill(mHasProximityKeyMasks, mHasProximityKeyMasks + MAX_WORD_LENGTH, true);
     }
 
     ///////////////////////
@@ -92,11 +101,16 @@ void ProximityInfoState::initInputParams(const int pointerId, const float maxPoi
         mSampledInputIndice.clear();
         mSampledLengthCache.clear();
         mSampledNormalizedSquaredLengthCache.clear();
+        mSampledMinNormalizedSquaredLengths.clear();
+        mSampledSweetSpotFactors.clear();
         mSampledSearchKeySets.clear();
         mSpeedRates.clear();
         mBeelineSpeedPercentiles.clear();
         mCharProbabilities.clear();
         mDirections.clear();
+        mBeelineSpeedStableSampledInputSize = 0;
+        mMostProbableStringCodePointCounts.clear();
+        mMostProbableStringSumLogProbabilities.clear();
     }
 
     if (DEBUG_GEO_FULL) {
@@ -117,16 +131,21 @@ void ProximityInfoState::initInputParams(const int pointerId, const float maxPoi
                 yCoordinates, times, lastSavedInputSize, mSampledInputSize, &mSampledInputXs,
                 &mSampledInputYs, &mSampledTimes, &mSampledLengthCache, &mSampledInputIndice,
                 &mSpeedRates, &mDirections);
-        ProximityInfoStateUtils::refreshBeelineSpeedRates(mProximityInfo->getMostCommonKeyWidth(),
-                mAverageSpeed, inputSize, xCoordinates, yCoordinates, times, mSampledInputSize,
-                &mSampledInputXs, &mSampledInputYs, &mSampledInputIndice,
-                &mBeelineSpeedPercentiles);
+        // As with the speed rates, percentiles of the points that can't be affected by the
+        // appended points are kept as they are.
+        mBeelineSpeedStableSampledInputSize =
+                ProximityInfoStateUtils::refreshBeelineSpeedRates(
+                        mProximityInfo->getMostCommonKeyWidth(), mAverageSpeed, inputSize,
+                        xCoordinates, yCoordinates, times,
+                        std::min(mBeelineSpeedStableSampledInputSize, lastSavedInputSize),
+                        mSampledInputSize, &mSampledInputXs, &mSampledInputYs,
+                        &mSampledInputIndice, &mBeelineSpeedPercentiles);
     }
 
     if (mSampledInputSize > 0) {
         ProximityInfoStateUtils::initGeometricDistanceInfos(mProximityInfo, mSampledInputSize,
                 lastSavedInputSize, isGeometric, &mSampledInputXs, &mSampledInputYs,
-                &mSampledNormalizedSquaredLengthCache);
+                &mSampledNormalizedSquaredLengthCache, &mSampledMinNormalizedSquaredLengths);
         if (isGeometric) {
             // updates probabilities of skipping or mapping each key for all points.
             ProximityInfoStateUtils::updateAlignPointProbabilities(
@@ -139,7 +158,9 @@ void ProximityInfoState::initInputParams(const int pointerId, const float maxPoi
                     &mCharProbabilities, &mSampledSearchKeySets,
                     &mSampledSearchKeyVectors);
             mMostProbableStringProbability = ProximityInfoStateUtils::getMostProbableString(
-                    mProximityInfo, mSampledInputSize, &mCharProbabilities, mMostProbableString);
+                    mProximityInfo, lastSavedInputSize, mSampledInputSize, &mCharProbabilities,
+                    &mMostProbableStringCodePointCounts, &mMostProbableStringSumLogProbabilities,
+                    mMostProbableString);
 
         }
     }
@@ -158,12 +179,59 @@ void ProximityInfoState::initInputParams(const int pointerId, const float maxPoi
         ProximityInfoStateUtils::initPrimaryInputWord(
                 inputSize, mInputProximities, mPrimaryInputWord);
     }
+    if (!isGeometric) {
+        initTapCostTables(inputSize);
+    }
     if (DEBUG_GEO_FULL) {
         AKLOGI("ProximityState init finished: %d points out of %d", mSampledInputSize, inputSize);
     }
     mHasBeenUpdatedByGeometricInput = isGeometric;
 }
 
+void ProximityInfoState::initTapCostTables(const int inputSize) {
+    for (int i = 0; i < inputSize; ++i) {
+        mBaseLowerCasePrimaryCodePoints[i] = CharUtils::toBaseLowerCase(getPrimaryCodePointAt(i));
+    }
+    // Cheap for tap input, so all the points are done again, as the touch position correction
+    // may have been turned on or off for the previous ones.
+    mSampledSweetSpotFactors.resize(mSampledInputSize * mKeyCount);
+    for (int i = 0; i < mSampledInputSize * mKeyCount; ++i) {
+        mSampledSweetSpotFactors[i] = TouchPositionCorrectionUtils::getSweetSpotFactor(
+                mTouchPositionCorrectionEnabled,
+                std::min(mSampledNormalizedSquaredLengthCache[i], mMaxPointToKeyLength));
+    }
+}
+
+void ProximityInfoState::initProximityKeyMasks(const int inputSize) {
+    static_assert(MAX_KEY_COUNT_IN_A_KEYBOARD <= 64, "Key ids must fit in the key masks.");
+    // Same as the empty proximity chars past the input.
+    memset(mProximityKeyMasks, 0, sizeof(mProximityKeyMasks));
+    memset(mAdditionalProximityKeyMasks, 0, sizeof(mAdditionalProximityKeyMasks));
+    std::fill(mHasProximityKeyMasks, mHasProximityKeyMasks + MAX_WORD_LENGTH, true);
+    for (int i = 0; i < inputSize; ++i) {
+        const int *const codePoints = getProximityCodePointsAt(i);
+        uint64_t *keyMask = &mProximityKeyMasks[i];
+        // The same sections as getProximityType() reads.
+        for (int j = 1; j < MAX_PROXIMITY_CHARS_SIZE; ++j) {
+            if (codePoints[j] == ADDITIONAL_PROXIMITY_CHAR_DELIMITER_CODE
+                    && keyMask == &mProximityKeyMasks[i]) {
+                keyMask = &mAdditionalProximityKeyMasks[i];
+                continue;
+            }
+            if (codePoints[j] <= ADDITIONAL_PROXIMITY_CHAR_DELIMITER_CODE) {
+                break;
+            }
+            const uint64_t codePointKeyMask = getKeyMaskOf(codePoints[j]);
+            if (codePointKeyMask == 0) {
+                // Not a key. Such chars are only found by scanning the list.
+                mHasProximityKeyMasks[i] = false;
+                break;
+            }
+            *keyMask |= codePointKeyMask;
+        }
+    }
+}
+
 // This function basically converts from a length to an edit distance. Accordingly, it's obviously
 // wrong to compare with mMaxPointToKeyLength.
 float ProximityInfoState::getPointToKeyLength(
@@ -180,6 +248,17 @@ float ProximityInfoState::getPointToKeyLength(
     return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
 }
 
+float ProximityInfoState::getMinPointToKeyLength(const int inputIndex) const {
+    const int primaryCodePoint = getPrimaryCodePointAt(inputIndex);
+    if (mProximityInfo->getKeyIndexOf(primaryCodePoint) == NOT_AN_INDEX
+            || mProximityInfo->getKeyIndexOf(CharUtils::toBaseLowerCase(primaryCodePoint))
+                    == NOT_AN_INDEX) {
+        // The typed char is not a key, so getPointToKeyLength() may return 0 for it.
+        return 0.0f;
+    }
+    return std::min(mSampledMinNormalizedSquaredLengths[inputIndex], mMaxPointToKeyLength);
+}
+
 float ProximityInfoState::getPointToKeyByIdLength(
         const int inputIndex, const int keyId) const {
     return ProximityInfoStateUtils::getPointToKeyByIdLength(mMaxPointToKeyLength,
@@ -187,6 +266,19 @@ float ProximityInfoState::getPointToKeyByIdLength(
             keyId);
 }
 
+int ProximityInfoState::getMatchOrProximityCodePoints(const int index,
+        int *const outCodePoints) const {
+    const int *const currentCodePoints = getProximityCodePointsAt(index);
+    int count = 0;
+    outCodePoints[count++] = currentCodePoints[0];
+    outCodePoints[count++] = CharUtils::toBaseLowerCase(currentCodePoints[0]);
+    for (int j = 1; j < MAX_PROXIMITY_CHARS_SIZE
+            && currentCodePoints[j] > ADDITIONAL_PROXIMITY_CHAR_DELIMITER_CODE; ++j) {
+        outCodePoints[count++] = currentCodePoints[j];
+    }
+    return count;
+}
+
 // In the following function, c is the current character of the dictionary word currently examined.
 // currentChars is an array containing the keys close to the character the user actually typed at
 // the same position. We want to see if c is in it: if so, then the word contains at that position
@@ -217,7 +309,17 @@ ProximityType ProximityInfoState::getProximityType(const int index, const int co
         return PROXIMITY_CHAR;
     }
 
-    // Not an exact nor an accent-alike match: search the list of close keys
+    // Not an exact nor an accent-alike match: search the close keys
+    if (mHasProximityKeyMasks[index] && !proximityIndex) {
+        const uint64_t keyMask = getKeyMaskOf(baseLowerC) | getKeyMaskOf(codePoint);
+        if ((mProximityKeyMasks[index] & keyMask) != 0) {
+            return PROXIMITY_CHAR;
+        }
+        if ((mAdditionalProximityKeyMasks[index] & keyMask) != 0) {
+            return ADDITIONAL_PROXIMITY_CHAR;
+        }
+        return SUBSTITUTION_CHAR;
+    }
     int j = 1;
     while (j < MAX_PROXIMITY_CHARS_SIZE
             && currentCodePoints[j] > ADDITIONAL_PROXIMITY_CHAR_DELIMITER_CODE) {
@@ -274,6 +376,31 @@ ProximityType ProximityInfoState::getProximityTypeG(const int index, const int c
     return UNRELATED_CHAR;
 }
 
+void ProximityInfoState::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSampledInputXs);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSampledInputYs);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSampledTimes);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSampledInputIndice);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSampledLengthCache);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mBeelineSpeedPercentiles);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSampledNormalizedSquaredLengthCache);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSampledMinNormalizedSquaredLengths);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSampledSweetSpotFactors);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSpeedRates);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mDirections);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mCharProbabilities);
+    for (const auto &charProbabilities : mCharProbabilities) {
+        outMemoryUsage->addUnorderedMap(MemoryUsage::HEAP_BYTES, charProbabilities);
+    }
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSampledSearchKeySets);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mSampledSearchKeyVectors);
+    for (const auto &searchKeyVector : mSampledSearchKeyVectors) {
+        outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, searchKeyVector);
+    }
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mMostProbableStringCodePointCounts);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mMostProbableStringSumLogProbabilities);
+}
+
 bool ProximityInfoState::isKeyInSerchKeysAfterIndex(const int index, const int keyId) const {
     ASSERT(keyId >= 0 && index >= 0 && index < mSampledInputSize);
     return mSampledSearchKeySets[index].test(keyId);
@@ -17,17 +17,20 @@
 #ifndef LATINIME_PROXIMITY_INFO_STATE_H
 #define LATINIME_PROXIMITY_INFO_STATE_H
 
+#include <cstdint>
 #include <cstring> // for memset()
 #include <unordered_map>
 #include <vector>
 
 #include "defines.h"
+#include "suggest/core/layout/proximity_info.h"
 #include "suggest/core/layout/proximity_info_params.h"
 #include "suggest/core/layout/proximity_info_state_utils.h"
+#include "suggest/core/layout/touch_position_correction_utils.h"
 
 namespace latinime {
 
-class ProximityInfo;
+class MemoryUsage;
 
 class ProximityInfoState {
  public:
@@ -40,6 +43,9 @@ class ProximityInfoState {
             const int *const times, const int *const pointerIds, const bool isGeometric,
             const std::vector<int> *locale);
 
+    // Adds the buffers of the sampled input. The instance itself is not included.
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+
     /////////////////////////////////////////
     // Defined here                        //
     /////////////////////////////////////////
@@ -50,12 +56,18 @@ class ProximityInfoState {
               mIsContinuousSuggestionPossible(false), mHasBeenUpdatedByGeometricInput(false),
               mSampledInputXs(), mSampledInputYs(), mSampledTimes(), mSampledInputIndice(),
               mSampledLengthCache(), mBeelineSpeedPercentiles(),
-              mSampledNormalizedSquaredLengthCache(), mSpeedRates(), mDirections(),
+              mSampledNormalizedSquaredLengthCache(), mSampledMinNormalizedSquaredLengths(),
+              mSampledSweetSpotFactors(), mSpeedRates(), mDirections(),
               mCharProbabilities(), mSampledSearchKeySets(), mSampledSearchKeyVectors(),
               mTouchPositionCorrectionEnabled(false), mSampledInputSize(0),
-              mMostProbableStringProbability(0.0f) {
+              mBeelineSpeedStableSampledInputSize(0), mMostProbableStringCodePointCounts(),
+              mMostProbableStringSumLogProbabilities(), mMostProbableStringProbability(0.0f) {
         memset(mInputProximities, 0, sizeof(mInputProximities));
+        memset(mProximityKeyMasks, 0, sizeof(mProximityKeyMasks));
+        memset(mAdditionalProximityKeyMasks, 0, sizeof(mAdditionalProximityKeyMasks));
+        memset(mHasProximityKeyMasks, 0, sizeof(mHasProximityKeyMasks));
         memset(mPrimaryInputWord, 0, sizeof(mPrimaryInputWord));
+        memset(mBaseLowerCasePrimaryCodePoints, 0, sizeof(mBaseLowerCasePrimaryCodePoints));
         memset(mMostProbableString, 0, sizeof(mMostProbableString));
     }
 
@@ -68,6 +80,11 @@ class ProximityInfoState {
 
     int getPrimaryOriginalCodePointAt(const int index) const;
 
+    // CharUtils::toBaseLowerCase() of getPrimaryCodePointAt(), precomputed for tap input.
+    AK_FORCE_INLINE int getBaseLowerCasePrimaryCodePointAt(const int index) const {
+        return mBaseLowerCasePrimaryCodePoints[index];
+    }
+
     inline bool sameAsTyped(const int *word, int length) const {
         if (length != mSampledInputSize) {
             return false;
@@ -85,6 +102,10 @@ class ProximityInfoState {
 
     AK_FORCE_INLINE bool existsCodePointInProximityAt(const int index, const int c) const {
         const int *codePoints = getProximityCodePointsAt(index);
+        if (mHasProximityKeyMasks[index]) {
+            return codePoints[0] == c || ((mProximityKeyMasks[index]
+                    | mAdditionalProximityKeyMasks[index]) & getKeyMaskOf(c)) != 0;
+        }
         int i = 0;
         while (codePoints[i] > 0 && i < MAX_PROXIMITY_CHARS_SIZE) {
             if (codePoints[i++] == c) {
@@ -147,12 +168,31 @@ class ProximityInfoState {
     float getPointToKeyByIdLength(const int inputIndex, const int keyId) const;
     // TODO: Rename s/Length/NormalizedSquaredLength/
     float getPointToKeyLength(const int inputIndex, const int codePoint) const;
+    // Returns a lower bound of getPointToKeyLength() over all code points for the input index.
+    float getMinPointToKeyLength(const int inputIndex) const;
+    // TouchPositionCorrectionUtils::getSweetSpotFactor() of getPointToKeyLength(), which the
+    // typing weighting charges for every matched code point. It is precomputed for all the keys
+    // at each point of tap input, so that only the key of the code point is looked up.
+    AK_FORCE_INLINE float getPointToKeySweetSpotFactor(const int inputIndex,
+            const int codePoint) const {
+        ASSERT(!mHasBeenUpdatedByGeometricInput);
+        const int keyId = mProximityInfo->getKeyIndexOf(codePoint);
+        if (keyId != NOT_AN_INDEX && inputIndex < mSampledInputSize) {
+            return mSampledSweetSpotFactors[inputIndex * mKeyCount + keyId];
+        }
+        return TouchPositionCorrectionUtils::getSweetSpotFactor(mTouchPositionCorrectionEnabled,
+                getPointToKeyLength(inputIndex, codePoint));
+    }
 
     ProximityType getProximityType(const int index, const int codePoint,
             const bool checkProximityChars, int *proximityIndex = 0) const;
 
     ProximityType getProximityTypeG(const int index, const int codePoint) const;
 
+    // Copies the code points that getProximityType() compares with to return MATCH_CHAR or
+    // PROXIMITY_CHAR, and returns their count, which is at most MAX_PROXIMITY_CHARS_SIZE + 1.
+    int getMatchOrProximityCodePoints(const int index, int *const outCodePoints) const;
+
     float getSpeedRate(const int index) const {
         return mSpeedRates[index];
     }
@@ -192,6 +232,19 @@ class ProximityInfoState {
         return ProximityInfoStateUtils::getProximityCodePointsAt(mInputProximities, index);
     }
 
+    // The bit of the key of codePoint in the proximity key masks, or 0 when no key has exactly
+    // this code point.
+    AK_FORCE_INLINE uint64_t getKeyMaskOf(const int codePoint) const {
+        const int keyId = mProximityInfo->getKeyIndexOf(codePoint);
+        if (keyId == NOT_AN_INDEX || mProximityInfo->getOriginalCodePointOf(keyId) != codePoint) {
+            return 0;
+        }
+        return static_cast<uint64_t>(1) << keyId;
+    }
+
+    void initTapCostTables(const int inputSize);
+    void initProximityKeyMasks(const int inputSize);
+
     // const
     const ProximityInfo *mProximityInfo;
     float mMaxPointToKeyLength;
@@ -213,6 +266,11 @@ class ProximityInfoState {
     std::vector<int> mSampledLengthCache;
     std::vector<int> mBeelineSpeedPercentiles;
     std::vector<float> mSampledNormalizedSquaredLengthCache;
+    // The smallest normalized squared length from each sampled point to any key.
+    std::vector<float> mSampledMinNormalizedSquaredLengths;
+    // See getPointToKeySweetSpotFactor(). Indexed like mSampledNormalizedSquaredLengthCache, only
+    // for tap input.
+    std::vector<float> mSampledSweetSpotFactors;
     std::vector<float> mSpeedRates;
     std::vector<float> mDirections;
     // probabilities of skipping or mapping to a key for each point.
@@ -225,8 +283,20 @@ class ProximityInfoState {
     std::vector<std::vector<int>> mSampledSearchKeyVectors;
     bool mTouchPositionCorrectionEnabled;
     int mInputProximities[MAX_PROXIMITY_CHARS_SIZE * MAX_WORD_LENGTH];
+    // The keys of the proximity chars and of the additional proximity chars of mInputProximities
+    // as key id bitmasks, so that getProximityType() is a bit test. Only valid when
+    // mHasProximityKeyMasks is set, that is when each of these chars is the code point of a key.
+    uint64_t mProximityKeyMasks[MAX_WORD_LENGTH];
+    uint64_t mAdditionalProximityKeyMasks[MAX_WORD_LENGTH];
+    bool mHasProximityKeyMasks[MAX_WORD_LENGTH];
     int mSampledInputSize;
+    // The number of leading sampled points whose beeline speed percentiles are final.
+    int mBeelineSpeedStableSampledInputSize;
     int mPrimaryInputWord[MAX_WORD_LENGTH];
+    int mBaseLowerCasePrimaryCodePoints[MAX_WORD_LENGTH];
+    // Trace state of the most probable string after each sampled point.
+    std::vector<int> mMostProbableStringCodePointCounts;
+    std::vector<float> mMostProbableStringSumLogProbabilities;
     float mMostProbableStringProbability;
     int mMostProbableString[MAX_WORD_LENGTH];
 };
@@ -82,16 +82,39 @@ namespace latinime {
     if (DEBUG_GEO_FULL) {
         AKLOGI("Init ProximityInfoState: last input index = %d", lastInputIndex);
     }
+    if (!isGeometric) {
+        // Tap input is not sampled, so all the points of the pointer are pushed without the
+        // angles and the near keys distances the sampling needs.
+        for (int i = pushTouchPointStartIndex; i <= lastInputIndex; ++i) {
+            const int pid = pointerIds ? pointerIds[i] : 0;
+            if (pointerId == pid) {
+                pushInputData(proximityInfo, i, getPrimaryCodePointAt(inputProximities, i),
+                        proximityOnly ? NOT_A_COORDINATE : inputXCoordinates[i],
+                        proximityOnly ? NOT_A_COORDINATE : inputYCoordinates[i],
+                        times ? times[i] : -1, isGeometric, sampledInputXs, sampledInputYs,
+                        sampledInputTimes, sampledLengthCache, sampledInputIndice);
+            }
+        }
+        return sampledInputXs->size();
+    }
     // Working space to save near keys distances for current, prev and prevprev input point.
-    NearKeysDistanceMap nearKeysDistances[3];
+    NearKeysDistances nearKeysDistances[3];
     // These pointers are swapped for each inputs points.
-    NearKeysDistanceMap *currentNearKeysDistances = &nearKeysDistances[0];
-    NearKeysDistanceMap *prevNearKeysDistances = &nearKeysDistances[1];
-    NearKeysDistanceMap *prevPrevNearKeysDistances = &nearKeysDistances[2];
+    NearKeysDistances *currentNearKeysDistances = &nearKeysDistances[0];
+    NearKeysDistances *prevNearKeysDistances = &nearKeysDistances[1];
+    NearKeysDistances *prevPrevNearKeysDistances = &nearKeysDistances[2];
     // "sumAngle" is accumulated by each angle of input points. And when "sumAngle" exceeds
     // the threshold we save that point, reset sumAngle. This aims to keep the figure of
     // the curve.
     float sumAngle = 0.0f;
+    // Raw gesture traces have many more points than the sampling keeps, and evaluating the near
+    // keys distances of each point dominates the sampling. The points that are too close to the
+    // last evaluated one to change the near keys are skipped before that, except where the trace
+    // turns. Unlike a simplification of the whole trace, this only depends on the points since
+    // the last evaluated one, so an incremental update skips the same points as a full one.
+    const int decimationDistance = proximityInfo->getMostCommonKeyWidth()
+            / ProximityInfoParams::TRACE_DECIMATION_DISTANCE_SCALE;
+    int lastEvaluatedIndex = NOT_AN_INDEX;
 
     for (int i = pushTouchPointStartIndex; i <= lastInputIndex; ++i) {
         // Assuming pointerId == 0 if pointerIds is null.
@@ -100,10 +123,9 @@ namespace latinime {
             AKLOGI("Init ProximityInfoState: (%d)PID = %d", i, pid);
         }
         if (pointerId == pid) {
-            const int c = isGeometric ?
-                    NOT_A_COORDINATE : getPrimaryCodePointAt(inputProximities, i);
-            const int x = proximityOnly ? NOT_A_COORDINATE : inputXCoordinates[i];
-            const int y = proximityOnly ? NOT_A_COORDINATE : inputYCoordinates[i];
+            const int c = NOT_A_COORDINATE;
+            const int x = inputXCoordinates[i];
+            const int y = inputYCoordinates[i];
             const int time = times ? times[i] : -1;
 
             if (i > 1) {
@@ -114,6 +136,13 @@ namespace latinime {
                         inputXCoordinates[i - 1], inputYCoordinates[i - 1], x, y);
                 sumAngle += GeometryUtils::getAngleDiff(prevAngle, currentAngle);
             }
+            if (lastEvaluatedIndex != NOT_AN_INDEX && i != lastInputIndex
+                    && !needsToEvaluateTracePoint(inputXCoordinates, inputYCoordinates, pointerIds,
+                            lastEvaluatedIndex, i, decimationDistance)) {
+                // The angles of the skipped points still add up to sumAngle.
+                continue;
+            }
+            lastEvaluatedIndex = i;
 
             if (pushTouchPoint(proximityInfo, maxPointToKeyLength, i, c, x, y, time,
                     isGeometric, isGeometric /* doSampling */, i == lastInputIndex,
@@ -121,11 +150,11 @@ namespace latinime {
                     prevPrevNearKeysDistances, sampledInputXs, sampledInputYs, sampledInputTimes,
                     sampledLengthCache, sampledInputIndice)) {
                 // Previous point information was popped.
-                NearKeysDistanceMap *tmp = prevNearKeysDistances;
+                NearKeysDistances *tmp = prevNearKeysDistances;
                 prevNearKeysDistances = currentNearKeysDistances;
                 currentNearKeysDistances = tmp;
             } else {
-                NearKeysDistanceMap *tmp = prevPrevNearKeysDistances;
+                NearKeysDistances *tmp = prevPrevNearKeysDistances;
                 prevPrevNearKeysDistances = prevNearKeysDistances;
                 prevNearKeysDistances = currentNearKeysDistances;
                 currentNearKeysDistances = tmp;
@@ -136,6 +165,36 @@ namespace latinime {
     return sampledInputXs->size();
 }
 
+// Returns whether the point at index has to be evaluated by the sampling after the point at
+// lastEvaluatedIndex, i.e. whether it is far enough from it or the trace turns at the previous
+// point.
+/* static */ bool ProximityInfoStateUtils::needsToEvaluateTracePoint(const int *const inputXCoordinates,
+        const int *const inputYCoordinates, const int *const pointerIds,
+        const int lastEvaluatedIndex, const int index, const int decimationDistance) {
+    const int x = inputXCoordinates[index];
+    const int y = inputYCoordinates[index];
+    const int lastX = inputXCoordinates[lastEvaluatedIndex];
+    const int lastY = inputYCoordinates[lastEvaluatedIndex];
+    if (GeometryUtils::getDistanceInt(x, y, lastX, lastY) >= decimationDistance) {
+        return true;
+    }
+    const int prevIndex = index - 1;
+    if (prevIndex == lastEvaluatedIndex
+            || (pointerIds && pointerIds[prevIndex] != pointerIds[index])) {
+        return false;
+    }
+    const int prevX = inputXCoordinates[prevIndex];
+    const int prevY = inputYCoordinates[prevIndex];
+    // The turns between points closer than that are the jitter of the coordinates.
+    if (GeometryUtils::getDistanceInt(prevX, prevY, lastX, lastY) * 2 < decimationDistance
+            || (prevX == x && prevY == y)) {
+        return false;
+    }
+    return GeometryUtils::getAngleDiff(GeometryUtils::getAngle(lastX, lastY, prevX, prevY),
+            GeometryUtils::getAngle(prevX, prevY, x, y))
+                    > ProximityInfoParams::TRACE_DECIMATION_CORNER_ANGLE_THRESHOLD;
+}
+
 /* static */ const int *ProximityInfoStateUtils::getProximityCodePointsAt(
         const int *const inputProximities, const int index) {
     return inputProximities + (index * MAX_PROXIMITY_CHARS_SIZE);
@@ -189,19 +248,26 @@ namespace latinime {
         const int lastSavedInputSize, const bool isGeometric,
         const std::vector<int> *const sampledInputXs,
         const std::vector<int> *const sampledInputYs,
-        std::vector<float> *sampledNormalizedSquaredLengthCache) {
+        std::vector<float> *sampledNormalizedSquaredLengthCache,
+        std::vector<float> *sampledMinNormalizedSquaredLengths) {
     const int keyCount = proximityInfo->getKeyCount();
     sampledNormalizedSquaredLengthCache->resize(sampledInputSize * keyCount);
+    sampledMinNormalizedSquaredLengths->resize(sampledInputSize);
     for (int i = lastSavedInputSize; i < sampledInputSize; ++i) {
-        for (int k = 0; k < keyCount; ++k) {
-            const int index = i * keyCount + k;
-            const int x = (*sampledInputXs)[i];
-            const int y = (*sampledInputYs)[i];
-            const float normalizedSquaredDistance =
-                    proximityInfo->getNormalizedSquaredDistanceFromCenterFloatG(
-                            k, x, y, isGeometric);
-            (*sampledNormalizedSquaredLengthCache)[index] = normalizedSquaredDistance;
+        const int x = (*sampledInputXs)[i];
+        const int y = (*sampledInputYs)[i];
+        float *const distances = sampledNormalizedSquaredLengthCache->data() + i * keyCount;
+        if (isGeometric) {
+            proximityInfo->getNormalizedSquaredDistancesFromCentersForGesture(x, y, distances);
+        } else {
+            // Tap input is looked up in the precomputed tables of the proximity info.
+            proximityInfo->getNormalizedSquaredDistancesFromCentersForTap(x, y, distances);
+        }
+        float minDistance = static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
+        for (int keyId = 0; keyId < keyCount; ++keyId) {
+            minDistance = std::min(minDistance, distances[keyId]);
         }
+        (*sampledMinNormalizedSquaredLengths)[i] = minDistance;
     }
 }
 
@@ -274,21 +340,30 @@ namespace latinime {
     return averageSpeed;
 }
 
-/* static */ void ProximityInfoStateUtils::refreshBeelineSpeedRates(const int mostCommonKeyWidth,
+// Updates beeline speed percentiles from startIndex and returns the number of leading sampled points
+// whose percentiles do not depend on input points that may be appended later.
+/* static */ int ProximityInfoStateUtils::refreshBeelineSpeedRates(const int mostCommonKeyWidth,
         const float averageSpeed, const int inputSize, const int *const xCoordinates,
-        const int *const yCoordinates, const int *times, const int sampledInputSize,
-        const std::vector<int> *const sampledInputXs,
+        const int *const yCoordinates, const int *times, const int startIndex,
+        const int sampledInputSize, const std::vector<int> *const sampledInputXs,
         const std::vector<int> *const sampledInputYs, const std::vector<int> *const inputIndice,
         std::vector<int> *beelineSpeedPercentiles) {
     if (DEBUG_SAMPLING_POINTS) {
         AKLOGI("--- refresh beeline speed rates");
     }
     beelineSpeedPercentiles->resize(sampledInputSize);
-    for (int i = 0; i < sampledInputSize; ++i) {
+    int stableSampledInputSize = sampledInputSize;
+    for (int i = std::max(0, startIndex); i < sampledInputSize; ++i) {
+        bool reachesInputEnd = false;
         (*beelineSpeedPercentiles)[i] = static_cast<int>(calculateBeelineSpeedRate(
                 mostCommonKeyWidth, averageSpeed, i, inputSize, xCoordinates, yCoordinates, times,
-                sampledInputSize, sampledInputXs, sampledInputYs, inputIndice) * MAX_PERCENTILE);
+                sampledInputSize, sampledInputXs, sampledInputYs, inputIndice, &reachesInputEnd)
+                        * MAX_PERCENTILE);
+        if (reachesInputEnd && stableSampledInputSize == sampledInputSize) {
+            stableSampledInputSize = i;
+        }
     }
+    return stableSampledInputSize;
 }
 
 /* static */float ProximityInfoStateUtils::getDirection(
@@ -313,15 +388,20 @@ namespace latinime {
 // the given point and the nearest key position.
 /* static */ float ProximityInfoStateUtils::updateNearKeysDistances(
         const ProximityInfo *const proximityInfo, const float maxPointToKeyLength, const int x,
-        const int y, const bool isGeometric, NearKeysDistanceMap *const currentNearKeysDistances) {
+        const int y, const bool isGeometric, NearKeysDistances *const currentNearKeysDistances) {
     currentNearKeysDistances->clear();
     const int keyCount = proximityInfo->getKeyCount();
+    float distances[MAX_KEY_COUNT_IN_A_KEYBOARD];
+    if (isGeometric) {
+        proximityInfo->getNormalizedSquaredDistancesFromCentersForGesture(x, y, distances);
+    } else {
+        proximityInfo->getNormalizedSquaredDistancesFromCentersForTap(x, y, distances);
+    }
     float nearestKeyDistance = maxPointToKeyLength;
     for (int k = 0; k < keyCount; ++k) {
-        const float dist = proximityInfo->getNormalizedSquaredDistanceFromCenterFloatG(k, x, y,
-                isGeometric);
+        const float dist = distances[k];
         if (dist < ProximityInfoParams::NEAR_KEY_THRESHOLD_FOR_DISTANCE) {
-            currentNearKeysDistances->insert(std::pair<int, float>(k, dist));
+            currentNearKeysDistances->add(k, dist);
         }
         if (nearestKeyDistance > dist) {
             nearestKeyDistance = dist;
@@ -332,17 +412,20 @@ namespace latinime {
 
 // Check if previous point is at local minimum position to near keys.
 /* static */ bool ProximityInfoStateUtils::isPrevLocalMin(
-        const NearKeysDistanceMap *const currentNearKeysDistances,
-        const NearKeysDistanceMap *const prevNearKeysDistances,
-        const NearKeysDistanceMap *const prevPrevNearKeysDistances) {
-    for (NearKeysDistanceMap::const_iterator it = prevNearKeysDistances->begin();
-            it != prevNearKeysDistances->end(); ++it) {
-        NearKeysDistanceMap::const_iterator itPP = prevPrevNearKeysDistances->find(it->first);
-        NearKeysDistanceMap::const_iterator itC = currentNearKeysDistances->find(it->first);
-        const bool isPrevPrevNear = (itPP == prevPrevNearKeysDistances->end()
-                || itPP->second > it->second + ProximityInfoParams::MARGIN_FOR_PREV_LOCAL_MIN);
-        const bool isCurrentNear = (itC == currentNearKeysDistances->end()
-                || itC->second > it->second + ProximityInfoParams::MARGIN_FOR_PREV_LOCAL_MIN);
+        const NearKeysDistances *const currentNearKeysDistances,
+        const NearKeysDistances *const prevNearKeysDistances,
+        const NearKeysDistances *const prevPrevNearKeysDistances) {
+    for (int keyId = 0; keyId < MAX_KEY_COUNT_IN_A_KEYBOARD; ++keyId) {
+        if (!prevNearKeysDistances->contains(keyId)) {
+            continue;
+        }
+        const float prevDistance = prevNearKeysDistances->getDistance(keyId);
+        const bool isPrevPrevNear = (!prevPrevNearKeysDistances->contains(keyId)
+                || prevPrevNearKeysDistances->getDistance(keyId)
+                        > prevDistance + ProximityInfoParams::MARGIN_FOR_PREV_LOCAL_MIN);
+        const bool isCurrentNear = (!currentNearKeysDistances->contains(keyId)
+                || currentNearKeysDistances->getDistance(keyId)
+                        > prevDistance + ProximityInfoParams::MARGIN_FOR_PREV_LOCAL_MIN);
         if (isPrevPrevNear && isCurrentNear) {
             return true;
         }
@@ -353,9 +436,9 @@ namespace latinime {
 // Calculating a point score that indicates usefulness of the point.
 /* static */ float ProximityInfoStateUtils::getPointScore(const int mostCommonKeyWidth,
         const int x, const int y, const int time, const bool lastPoint, const float nearest,
-        const float sumAngle, const NearKeysDistanceMap *const currentNearKeysDistances,
-        const NearKeysDistanceMap *const prevNearKeysDistances,
-        const NearKeysDistanceMap *const prevPrevNearKeysDistances,
+        const float sumAngle, const NearKeysDistances *const currentNearKeysDistances,
+        const NearKeysDistances *const prevNearKeysDistances,
+        const NearKeysDistances *const prevPrevNearKeysDistances,
         std::vector<int> *sampledInputXs, std::vector<int> *sampledInputYs) {
     const size_t size = sampledInputXs->size();
     // If there is only one point, add this point. Besides, if the previous point's distance map
@@ -402,9 +485,9 @@ namespace latinime {
         const int maxPointToKeyLength, const int inputIndex, const int nodeCodePoint, int x, int y,
         const int time, const bool isGeometric, const bool doSampling,
         const bool isLastPoint, const float sumAngle,
-        NearKeysDistanceMap *const currentNearKeysDistances,
-        const NearKeysDistanceMap *const prevNearKeysDistances,
-        const NearKeysDistanceMap *const prevPrevNearKeysDistances,
+        NearKeysDistances *const currentNearKeysDistances,
+        const NearKeysDistances *const prevNearKeysDistances,
+        const NearKeysDistances *const prevPrevNearKeysDistances,
         std::vector<int> *sampledInputXs, std::vector<int> *sampledInputYs,
         std::vector<int> *sampledInputTimes, std::vector<int> *sampledLengthCache,
         std::vector<int> *sampledInputIndice) {
@@ -445,6 +528,21 @@ namespace latinime {
         }
     }
 
+    pushInputData(proximityInfo, inputIndex, nodeCodePoint, x, y, time, isGeometric,
+            sampledInputXs, sampledInputYs, sampledInputTimes, sampledLengthCache,
+            sampledInputIndice);
+    if (DEBUG_GEO_FULL) {
+        AKLOGI("pushTouchPoint: x = %03d, y = %03d, time = %d, index = %d, popped ? %01d",
+                x, y, time, inputIndex, popped);
+    }
+    return popped;
+}
+
+/* static */ void ProximityInfoStateUtils::pushInputData(const ProximityInfo *const proximityInfo,
+        const int inputIndex, const int nodeCodePoint, int x, int y, const int time,
+        const bool isGeometric, std::vector<int> *sampledInputXs,
+        std::vector<int> *sampledInputYs, std::vector<int> *sampledInputTimes,
+        std::vector<int> *sampledLengthCache, std::vector<int> *sampledInputIndice) {
     if (nodeCodePoint >= 0 && (x < 0 || y < 0)) {
         const int keyId = proximityInfo->getKeyIndexOf(nodeCodePoint);
         if (keyId >= 0) {
@@ -453,8 +551,7 @@ namespace latinime {
         }
     }
 
-    // Pushing point information.
-    if (size > 0) {
+    if (!sampledInputXs->empty()) {
         sampledLengthCache->push_back(
                 sampledLengthCache->back() + GeometryUtils::getDistanceInt(
                         x, y, sampledInputXs->back(), sampledInputYs->back()));
@@ -465,11 +562,6 @@ namespace latinime {
     sampledInputYs->push_back(y);
     sampledInputTimes->push_back(time);
     sampledInputIndice->push_back(inputIndex);
-    if (DEBUG_GEO_FULL) {
-        AKLOGI("pushTouchPoint: x = %03d, y = %03d, time = %d, index = %d, popped ? %01d",
-                x, y, time, inputIndex, popped);
-    }
-    return popped;
 }
 
 /* static */ float ProximityInfoStateUtils::calculateBeelineSpeedRate(const int mostCommonKeyWidth,
@@ -477,12 +569,13 @@ namespace latinime {
         const int *const yCoordinates, const int *times, const int sampledInputSize,
         const std::vector<int> *const sampledInputXs,
         const std::vector<int> *const sampledInputYs,
-        const std::vector<int> *const sampledInputIndices) {
+        const std::vector<int> *const sampledInputIndices, bool *const outReachesInputEnd) {
     if (sampledInputSize <= 0 || averageSpeed < 0.001f) {
         if (DEBUG_SAMPLING_POINTS) {
             AKLOGI("--- invalid state: cancel. size = %d, ave = %f",
                     sampledInputSize, averageSpeed);
         }
+        *outReachesInputEnd = true;
         return 1.0f;
     }
     const int lookupRadius = mostCommonKeyWidth
@@ -514,6 +607,8 @@ namespace latinime {
         tempBeelineDistance = GeometryUtils::getDistanceInt(x0, y0, xCoordinates[end],
                 yCoordinates[end]);
     }
+    // The result may change when more points are appended after the last one.
+    *outReachesInputEnd = end >= (inputSize - 1);
     // Exclusive unless this is an edge point
     if (end > actualInputIndex && end < (inputSize - 1)) {
         --end;
@@ -733,23 +828,17 @@ namespace latinime {
         NormalDistribution2D distribution((*sampledInputXs)[i], sigmaX, (*sampledInputYs)[i],
                 sigmaY, theta);
         // Summing up probability densities of all near keys.
+        float probabilityDensities[MAX_KEY_COUNT_IN_A_KEYBOARD];
+        distribution.getProbabilityDensities(proximityInfo->getKeyCenterXsG(),
+                proximityInfo->getKeyCenterYsG(), keyCount, probabilityDensities);
         float sumOfProbabilityDensities = 0.0f;
         for (int j = 0; j < keyCount; ++j) {
-            sumOfProbabilityDensities += distribution.getProbabilityDensity(
-                    proximityInfo->getKeyCenterXOfKeyIdG(j,
-                            NOT_A_COORDINATE /* referencePointX */, true /* isGeometric */),
-                    proximityInfo->getKeyCenterYOfKeyIdG(j,
-                            NOT_A_COORDINATE /* referencePointY */, true /* isGeometric */));
+            sumOfProbabilityDensities += probabilityDensities[j];
         }
 
         // Split the probability of an input point to keys that are close to the input point.
         for (int j = 0; j < keyCount; ++j) {
-            const float probabilityDensity = distribution.getProbabilityDensity(
-                    proximityInfo->getKeyCenterXOfKeyIdG(j,
-                            NOT_A_COORDINATE /* referencePointX */, true /* isGeometric */),
-                    proximityInfo->getKeyCenterYOfKeyIdG(j,
-                            NOT_A_COORDINATE /* referencePointY */, true /* isGeometric */));
-            const float probability = inputCharProbability * probabilityDensity
+            const float probability = inputCharProbability * probabilityDensities[j]
                     / sumOfProbabilityDensities;
             (*charProbabilities)[i][j] = probability;
         }
@@ -830,7 +919,17 @@ namespace latinime {
     const int readForwordLength = static_cast<int>(
             hypotf(proximityInfo->getKeyboardWidth(), proximityInfo->getKeyboardHeight())
                     * ProximityInfoParams::SEARCH_KEY_RADIUS_RATIO);
-    for (int i = 0; i < sampledInputSize; ++i) {
+    // Points that are farther than readForwordLength from the first new point can't get any new
+    // search keys. As the length cache is monotonic, only a trailing range has to be updated.
+    int startIndex = std::max(0, lastSavedInputSize);
+    if (startIndex < sampledInputSize) {
+        const int boundaryLength = (*sampledLengthCache)[startIndex];
+        while (startIndex > 0
+                && boundaryLength - (*sampledLengthCache)[startIndex - 1] < readForwordLength) {
+            --startIndex;
+        }
+    }
+    for (int i = startIndex; i < sampledInputSize; ++i) {
         if (i >= lastSavedInputSize) {
             (*sampledSearchKeySets)[i].reset();
         }
@@ -848,7 +947,7 @@ namespace latinime {
         }
     }
     const int keyCount = proximityInfo->getKeyCount();
-    for (int i = 0; i < sampledInputSize; ++i) {
+    for (int i = startIndex; i < sampledInputSize; ++i) {
         std::vector<int> *searchKeyVector = &(*sampledSearchKeyVectors)[i];
         searchKeyVector->clear();
         for (int j = 0; j < keyCount; ++j) {
@@ -930,17 +1029,26 @@ namespace latinime {
 }
 
 // Get a word that is detected by tracing the most probable string into codePointBuf and
-// returns probability of generating the word.
+// returns probability of generating the word. The trace state after each sampled point is kept in
+// sampledCodePointCounts and sampledSumLogProbabilities so that the trace can be resumed from
+// startIndex when the char probabilities of the preceding points have not changed.
 /* static */ float ProximityInfoStateUtils::getMostProbableString(
-        const ProximityInfo *const proximityInfo, const int sampledInputSize,
+        const ProximityInfo *const proximityInfo, const int startIndex, const int sampledInputSize,
         const std::vector<std::unordered_map<int, float>> *const charProbabilities,
-        int *const codePointBuf) {
+        std::vector<int> *const sampledCodePointCounts,
+        std::vector<float> *const sampledSumLogProbabilities, int *const codePointBuf) {
     ASSERT(sampledInputSize >= 0);
-    memset(codePointBuf, 0, sizeof(codePointBuf[0]) * MAX_WORD_LENGTH);
-    int index = 0;
-    float sumLogProbability = 0.0f;
+    ASSERT(sampledCodePointCounts->size() == sampledSumLogProbabilities->size());
+    const int resumeIndex = std::min(std::max(0, startIndex),
+            static_cast<int>(sampledCodePointCounts->size()));
+    sampledCodePointCounts->resize(resumeIndex);
+    sampledSumLogProbabilities->resize(resumeIndex);
+    int index = (resumeIndex > 0) ? (*sampledCodePointCounts)[resumeIndex - 1] : 0;
+    float sumLogProbability =
+            (resumeIndex > 0) ? (*sampledSumLogProbabilities)[resumeIndex - 1] : 0.0f;
+    memset(codePointBuf + index, 0, sizeof(codePointBuf[0]) * (MAX_WORD_LENGTH - index));
     // TODO: Current implementation is greedy algorithm. DP would be efficient for many cases.
-    for (int i = 0; i < sampledInputSize && index < MAX_WORD_LENGTH - 1; ++i) {
+    for (int i = resumeIndex; i < sampledInputSize && index < MAX_WORD_LENGTH - 1; ++i) {
         float minLogProbability = static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
         int character = NOT_AN_INDEX;
         for (std::unordered_map<int, float>::const_iterator it = (*charProbabilities)[i].begin();
@@ -960,12 +1068,16 @@ namespace latinime {
                 ASSERT(false);
                 // Make the length zero, which means most probable string won't be used.
                 index = 0;
+                sampledCodePointCounts->clear();
+                sampledSumLogProbabilities->clear();
                 break;
             }
             codePointBuf[index] = codePoint;
             index++;
         }
         sumLogProbability += minLogProbability;
+        sampledCodePointCounts->push_back(index);
+        sampledSumLogProbabilities->push_back(sumLogProbability);
     }
     codePointBuf[index] = '\0';
     return sumLogProbability;
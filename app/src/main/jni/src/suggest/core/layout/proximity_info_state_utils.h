@@ -29,9 +29,43 @@ class ProximityInfoParams;
 
 class ProximityInfoStateUtils {
  public:
-    typedef std::unordered_map<int, float> NearKeysDistanceMap;
     typedef std::bitset<MAX_KEY_COUNT_IN_A_KEYBOARD> NearKeycodesSet;
 
+    // The distances from an input point to the keys near it, indexed by key id, so that sampling
+    // a gesture doesn't allocate for each point.
+    class NearKeysDistances {
+     public:
+        NearKeysDistances() : mNearKeys() {}
+
+        void clear() {
+            mNearKeys.reset();
+        }
+
+        bool empty() const {
+            return mNearKeys.none();
+        }
+
+        void add(const int keyId, const float distance) {
+            mNearKeys.set(keyId);
+            mDistances[keyId] = distance;
+        }
+
+        bool contains(const int keyId) const {
+            return mNearKeys.test(keyId);
+        }
+
+        // Only valid for the keys contained.
+        float getDistance(const int keyId) const {
+            return mDistances[keyId];
+        }
+
+     private:
+        DISALLOW_COPY_AND_ASSIGN(NearKeysDistances);
+
+        NearKeycodesSet mNearKeys;
+        float mDistances[MAX_KEY_COUNT_IN_A_KEYBOARD];
+    };
+
     static int trimLastTwoTouchPoints(std::vector<int> *sampledInputXs,
             std::vector<int> *sampledInputYs, std::vector<int> *sampledInputTimes,
             std::vector<int> *sampledLengthCache, std::vector<int> *sampledInputIndice);
@@ -56,9 +90,9 @@ class ProximityInfoStateUtils {
             const std::vector<int> *const sampledLengthCache,
             const std::vector<int> *const sampledInputIndice,
             std::vector<float> *sampledSpeedRates, std::vector<float> *sampledDirections);
-    static void refreshBeelineSpeedRates(const int mostCommonKeyWidth, const float averageSpeed,
+    static int refreshBeelineSpeedRates(const int mostCommonKeyWidth, const float averageSpeed,
             const int inputSize, const int *const xCoordinates, const int *const yCoordinates,
-            const int *times, const int sampledInputSize,
+            const int *times, const int startIndex, const int sampledInputSize,
             const std::vector<int> *const sampledInputXs,
             const std::vector<int> *const sampledInputYs, const std::vector<int> *const inputIndice,
             std::vector<int> *beelineSpeedPercentiles);
@@ -86,7 +120,8 @@ class ProximityInfoStateUtils {
             const int sampledInputSize, const int lastSavedInputSize, const bool isGeometric,
             const std::vector<int> *const sampledInputXs,
             const std::vector<int> *const sampledInputYs,
-            std::vector<float> *sampledNormalizedSquaredLengthCache);
+            std::vector<float> *sampledNormalizedSquaredLengthCache,
+            std::vector<float> *sampledMinNormalizedSquaredLengths);
     static void initPrimaryInputWord(const int inputSize, const int *const inputProximities,
             int *primaryInputWord);
     static void dump(const bool isGeometric, const int inputSize,
@@ -104,9 +139,10 @@ class ProximityInfoStateUtils {
             const std::vector<int> *const sampledInputIndices);
     // TODO: Move to most_probable_string_utils.h
     static float getMostProbableString(const ProximityInfo *const proximityInfo,
-            const int sampledInputSize,
+            const int startIndex, const int sampledInputSize,
             const std::vector<std::unordered_map<int, float>> *const charProbabilities,
-            int *const codePointBuf);
+            std::vector<int> *const sampledCodePointCounts,
+            std::vector<float> *const sampledSumLogProbabilities, int *const codePointBuf);
 
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(ProximityInfoStateUtils);
@@ -114,23 +150,31 @@ class ProximityInfoStateUtils {
     static float updateNearKeysDistances(const ProximityInfo *const proximityInfo,
             const float maxPointToKeyLength, const int x, const int y,
             const bool isGeometric,
-            NearKeysDistanceMap *const currentNearKeysDistances);
-    static bool isPrevLocalMin(const NearKeysDistanceMap *const currentNearKeysDistances,
-            const NearKeysDistanceMap *const prevNearKeysDistances,
-            const NearKeysDistanceMap *const prevPrevNearKeysDistances);
+            NearKeysDistances *const currentNearKeysDistances);
+    static bool needsToEvaluateTracePoint(const int *const inputXCoordinates,
+            const int *const inputYCoordinates, const int *const pointerIds,
+            const int lastEvaluatedIndex, const int index, const int decimationDistance);
+    static bool isPrevLocalMin(const NearKeysDistances *const currentNearKeysDistances,
+            const NearKeysDistances *const prevNearKeysDistances,
+            const NearKeysDistances *const prevPrevNearKeysDistances);
     static float getPointScore(const int mostCommonKeyWidth, const int x, const int y,
             const int time, const bool lastPoint, const float nearest, const float sumAngle,
-            const NearKeysDistanceMap *const currentNearKeysDistances,
-            const NearKeysDistanceMap *const prevNearKeysDistances,
-            const NearKeysDistanceMap *const prevPrevNearKeysDistances,
+            const NearKeysDistances *const currentNearKeysDistances,
+            const NearKeysDistances *const prevNearKeysDistances,
+            const NearKeysDistances *const prevPrevNearKeysDistances,
             std::vector<int> *sampledInputXs, std::vector<int> *sampledInputYs);
     static bool pushTouchPoint(const ProximityInfo *const proximityInfo,
             const int maxPointToKeyLength, const int inputIndex, const int nodeCodePoint, int x,
             int y, const int time, const bool isGeometric,
             const bool doSampling, const bool isLastPoint,
-            const float sumAngle, NearKeysDistanceMap *const currentNearKeysDistances,
-            const NearKeysDistanceMap *const prevNearKeysDistances,
-            const NearKeysDistanceMap *const prevPrevNearKeysDistances,
+            const float sumAngle, NearKeysDistances *const currentNearKeysDistances,
+            const NearKeysDistances *const prevNearKeysDistances,
+            const NearKeysDistances *const prevPrevNearKeysDistances,
+            std::vector<int> *sampledInputXs, std::vector<int> *sampledInputYs,
+            std::vector<int> *sampledInputTimes, std::vector<int> *sampledLengthCache,
+            std::vector<int> *sampledInputIndice);
+    static void pushInputData(const ProximityInfo *const proximityInfo, const int inputIndex,
+            const int nodeCodePoint, int x, int y, const int time, const bool isGeometric,
             std::vector<int> *sampledInputXs, std::vector<int> *sampledInputYs,
             std::vector<int> *sampledInputTimes, std::vector<int> *sampledLengthCache,
             std::vector<int> *sampledInputIndice);
@@ -139,7 +183,7 @@ class ProximityInfoStateUtils {
             const int *const yCoordinates, const int *times, const int sampledInputSize,
             const std::vector<int> *const sampledInputXs,
             const std::vector<int> *const sampledInputYs,
-            const std::vector<int> *const inputIndice);
+            const std::vector<int> *const inputIndice, bool *const outReachesInputEnd);
     static float getPointAngle(const std::vector<int> *const sampledInputXs,
             const std::vector<int> *const sampledInputYs, const int index);
     static float getPointsAngle(const std::vector<int> *const sampledInputXs,
@@ -18,6 +18,7 @@
 #define LATINIME_PROXIMITY_INFO_UTILS_H
 
 #include <cmath>
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 
@@ -29,6 +30,10 @@
 namespace latinime {
 class ProximityInfoUtils {
  public:
+    // The code points below this, which include Latin, Greek and Cyrillic, have their key index
+    // in a table, so that the typing search does not hash them.
+    static const int KEY_INDEX_TABLE_SIZE = 0x530;
+
     static AK_FORCE_INLINE int getKeyIndexOf(const int keyCount, const int c,
             const std::unordered_map<int, int> *const codeToKeyMap) {
         if (keyCount == 0) {
@@ -46,6 +51,16 @@ class ProximityInfoUtils {
         return NOT_AN_INDEX;
     }
 
+    // keyIndexTable holds getKeyIndexOf() of the code points below KEY_INDEX_TABLE_SIZE.
+    static AK_FORCE_INLINE int getKeyIndexOf(const int keyCount, const int c,
+            const int8_t *const keyIndexTable,
+            const std::unordered_map<int, int> *const codeToKeyMap) {
+        if (0 <= c && c < KEY_INDEX_TABLE_SIZE) {
+            return keyIndexTable[c];
+        }
+        return getKeyIndexOf(keyCount, c, codeToKeyMap);
+    }
+
     static AK_FORCE_INLINE void initializeProximities(const int *const inputCodes,
             const int *const inputXCoordinates, const int *const inputYCoordinates,
             const int inputSize, const int *const keyXCoordinates,
@@ -53,11 +68,14 @@ class ProximityInfoUtils {
             const int *const proximityCharsArray, const int cellHeight, const int cellWidth,
             const int gridWidth, const int mostCommonKeyWidth, const int keyCount,
             const std::vector<int> *locale,
+            const int8_t *const keyIndexTable,
             const std::unordered_map<int, int> *const codeToKeyMap, int *inputProximities) {
         // Initialize
         // - mInputCodes
         // - mNormalizedSquaredDistances
         // TODO: Merge
+        const bool hasAdditionalProximityChars =
+                AdditionalProximityChars::hasAdditionalChars(locale);
         for (int i = 0; i < inputSize; ++i) {
             const int primaryKey = inputCodes[i];
             const int x = inputXCoordinates[i];
@@ -65,7 +83,8 @@ class ProximityInfoUtils {
             int *proximities = &inputProximities[i * MAX_PROXIMITY_CHARS_SIZE];
             calculateProximities(keyXCoordinates, keyYCoordinates, keyWidths, keyHeights,
                     proximityCharsArray, cellHeight, cellWidth, gridWidth, mostCommonKeyWidth,
-                    keyCount, x, y, primaryKey, locale, codeToKeyMap, proximities);
+                    keyCount, x, y, primaryKey, hasAdditionalProximityChars, keyIndexTable,
+                    codeToKeyMap, proximities);
         }
 
         if (DEBUG_PROXIMITY_CHARS) {
@@ -144,7 +163,8 @@ class ProximityInfoUtils {
             const int *const keyYCoordinates, const int *const keyWidths, const int *keyHeights,
             const int *const proximityCharsArray, const int cellHeight, const int cellWidth,
             const int gridWidth, const int mostCommonKeyWidth, const int keyCount,
-            const int x, const int y, const int primaryKey, const std::vector<int> *locale,
+            const int x, const int y, const int primaryKey,
+            const bool hasAdditionalProximityChars, const int8_t *const keyIndexTable,
             const std::unordered_map<int, int> *const codeToKeyMap, int *proximities) {
         const int mostCommonKeyWidthSquare = mostCommonKeyWidth * mostCommonKeyWidth;
         int insertPos = 0;
@@ -162,7 +182,7 @@ class ProximityInfoUtils {
                 if (c < KEYCODE_SPACE || c == primaryKey) {
                     continue;
                 }
-                const int keyIndex = getKeyIndexOf(keyCount, c, codeToKeyMap);
+                const int keyIndex = getKeyIndexOf(keyCount, c, keyIndexTable, codeToKeyMap);
                 const bool onKey = isOnKey(keyXCoordinates, keyYCoordinates, keyWidths, keyHeights,
                         keyIndex, x, y);
                 const int distance = squaredLengthToEdge(keyXCoordinates, keyYCoordinates,
@@ -177,8 +197,11 @@ class ProximityInfoUtils {
                     }
                 }
             }
-            const int additionalProximitySize =
-                    AdditionalProximityChars::getAdditionalCharsSize(locale, primaryKey);
+            int additionalProximitySize = 0;
+            const int *const additionalProximityChars = hasAdditionalProximityChars
+                    ? AdditionalProximityChars::getAdditionalChars(primaryKey,
+                            &additionalProximitySize)
+                    : nullptr;
             if (additionalProximitySize > 0) {
                 proximities[insertPos++] = ADDITIONAL_PROXIMITY_CHAR_DELIMITER_CODE;
                 if (insertPos >= MAX_PROXIMITY_CHARS_SIZE) {
@@ -188,8 +211,6 @@ class ProximityInfoUtils {
                     return;
                 }
 
-                const int *additionalProximityChars =
-                        AdditionalProximityChars::getAdditionalChars(locale, primaryKey);
                 for (int j = 0; j < additionalProximitySize; ++j) {
                     const int ac = additionalProximityChars[j];
                     int k = 0;
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LatinIME: touch_position_model.cpp"
+
+#include "suggest/core/layout/touch_position_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "suggest/core/layout/geometry_utils.h"
+#include "suggest/core/layout/proximity_info.h"
+
+namespace latinime {
+
+// The learned offsets are less than a key width, so they span half of the int16_t range.
+const float TouchPositionModel::OFFSET_UNITS_PER_KEY_WIDTH = 16384.0f;
+// Taps farther than a key width from the key center were rather aimed at another key.
+const float TouchPositionModel::MAX_LEARNED_SQUARED_DISTANCE = 1.0f;
+// Past this count, the offsets are moving averages that follow changes of the typing habits.
+const int TouchPositionModel::MAX_TAP_COUNT = 64;
+// Offsets of keys with few taps are shrunk towards 0 as if that many taps hit the key center.
+const int TouchPositionModel::PRIOR_TAP_COUNT = 8;
+TouchPositionModel TouchPositionModel::sInstance;
+
+TouchPositionModel::TouchPositionModel() : mMutex(), mKeyOffsets(), mVersion(0) {}
+
+void TouchPositionModel::learn(const ProximityInfo *const proximityInfo,
+        const int *const xCoordinates, const int *const yCoordinates,
+        const int *const codePoints, const int inputSize) {
+    if (!proximityInfo || proximityInfo->getMostCommonKeyWidth() <= 0) {
+        return;
+    }
+    const float keyWidth = static_cast<float>(proximityInfo->getMostCommonKeyWidth());
+    bool hasLearned = false;
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (int i = 0; i < inputSize; ++i) {
+        const int x = xCoordinates[i];
+        const int y = yCoordinates[i];
+        const int keyId = proximityInfo->getKeyIndexOf(codePoints[i]);
+        if (keyId == NOT_AN_INDEX || x < 0 || y < 0) {
+            continue;
+        }
+        // Relative to the key centers without any learned offset.
+        const float offsetX = static_cast<float>(x - proximityInfo->getKeyCenterXOfKeyIdG(
+                keyId, x, false /* isGeometric */)) / keyWidth;
+        const float offsetY = static_cast<float>(y - proximityInfo->getKeyCenterYOfKeyIdG(
+                keyId, y, false /* isGeometric */)) / keyWidth;
+        if (GeometryUtils::SQUARE_FLOAT(offsetX) + GeometryUtils::SQUARE_FLOAT(offsetY)
+                > MAX_LEARNED_SQUARED_DISTANCE) {
+            continue;
+        }
+        KeyOffset &keyOffset = mKeyOffsets.insert(std::make_pair(
+                proximityInfo->getCodePointOf(keyId), KeyOffset{0, 0, 0})).first->second;
+        keyOffset.mTapCount = static_cast<uint16_t>(
+                std::min(static_cast<int>(keyOffset.mTapCount) + 1, MAX_TAP_COUNT));
+        const float meanX = static_cast<float>(keyOffset.mOffsetX) / OFFSET_UNITS_PER_KEY_WIDTH;
+        const float meanY = static_cast<float>(keyOffset.mOffsetY) / OFFSET_UNITS_PER_KEY_WIDTH;
+        keyOffset.mOffsetX = static_cast<int16_t>(lroundf((meanX
+                + (offsetX - meanX) / static_cast<float>(keyOffset.mTapCount))
+                * OFFSET_UNITS_PER_KEY_WIDTH));
+        keyOffset.mOffsetY = static_cast<int16_t>(lroundf((meanY
+                + (offsetY - meanY) / static_cast<float>(keyOffset.mTapCount))
+                * OFFSET_UNITS_PER_KEY_WIDTH));
+        hasLearned = true;
+    }
+    if (hasLearned) {
+        mVersion.fetch_add(1);
+    }
+}
+
+void TouchPositionModel::getOffsets(const int *const codePoints, const int count,
+        float *const outOffsetXs, float *const outOffsetYs) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (int i = 0; i < count; ++i) {
+        const auto it = mKeyOffsets.find(codePoints[i]);
+        if (it == mKeyOffsets.end()) {
+            outOffsetXs[i] = 0.0f;
+            outOffsetYs[i] = 0.0f;
+            continue;
+        }
+        const float weight = static_cast<float>(it->second.mTapCount)
+                / static_cast<float>(it->second.mTapCount + PRIOR_TAP_COUNT);
+        outOffsetXs[i] = weight * static_cast<float>(it->second.mOffsetX)
+                / OFFSET_UNITS_PER_KEY_WIDTH;
+        outOffsetYs[i] = weight * static_cast<float>(it->second.mOffsetY)
+                / OFFSET_UNITS_PER_KEY_WIDTH;
+    }
+}
+
+void TouchPositionModel::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mKeyOffsets.clear();
+    mVersion.fetch_add(1);
+}
+} // namespace latinime
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_TOUCH_POSITION_MODEL_H
+#define LATINIME_TOUCH_POSITION_MODEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "defines.h"
+
+namespace latinime {
+
+class ProximityInfo;
+
+/**
+ * Learns where the user actually taps each key from the taps of committed words. For each key,
+ * the taps are modeled as a 2D Gaussian, of which the mean is kept as an offset from the key
+ * center in most common key widths, so that it carries over between keyboard sizes.
+ *
+ * ProximityInfo::applyTouchPositionModel() compiles the offsets into the tap distance tables, so
+ * that the correction costs nothing while searching.
+ *
+ * This class is thread-safe.
+ */
+class TouchPositionModel {
+ public:
+    static TouchPositionModel *getInstance() { return &sInstance; }
+
+    TouchPositionModel();
+    ~TouchPositionModel() {}
+
+    // Learns the taps of a word of inputSize code points that was typed on proximityInfo and
+    // committed as codePoints.
+    void learn(const ProximityInfo *const proximityInfo, const int *const xCoordinates,
+            const int *const yCoordinates, const int *const codePoints, const int inputSize);
+    // Outputs the offsets of the keys of the given lower case code points in most common key
+    // widths; 0 for unknown keys.
+    void getOffsets(const int *const codePoints, const int count, float *const outOffsetXs,
+            float *const outOffsetYs) const;
+    // Changes whenever an offset changes.
+    int getVersion() const { return mVersion.load(); }
+    void clear();
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(TouchPositionModel);
+
+    // The offsets are stored in fixed point, which is plenty for sub-pixel precision on the
+    // largest keys.
+    struct KeyOffset {
+        int16_t mOffsetX;
+        int16_t mOffsetY;
+        uint16_t mTapCount;
+    };
+
+    static const float OFFSET_UNITS_PER_KEY_WIDTH;
+    static const float MAX_LEARNED_SQUARED_DISTANCE;
+    static const int MAX_TAP_COUNT;
+    static const int PRIOR_TAP_COUNT;
+    static TouchPositionModel sInstance;
+
+    mutable std::mutex mMutex;
+    std::unordered_map<int, KeyOffset> mKeyOffsets;
+    std::atomic<int> mVersion;
+};
+} // namespace latinime
+#endif // LATINIME_TOUCH_POSITION_MODEL_H
@@ -30,6 +30,10 @@ class Traversal {
     virtual bool isOmission(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode, const DicNode *const childDicNode,
             const bool allowsErrorCorrections) const = 0;
+    // Whether the only children of the dicNode that can be processed are intentional omissions,
+    // digraphs and the children getProximityType() returns MATCH_CHAR or PROXIMITY_CHAR for.
+    virtual bool canFilterChildrenByProximity(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode, const bool allowsErrorCorrections) const = 0;
     virtual bool isSpaceSubstitutionTerminal(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode) const = 0;
     virtual bool isSpaceOmissionTerminal(const DicTraverseSession *const traverseSession,
@@ -45,6 +49,10 @@ class Traversal {
     virtual float getMaxSpatialDistance() const = 0;
     virtual int getDefaultExpandDicNodeSize() const = 0;
     virtual int getMaxCacheSize(const int inputSize, const float weightForLocale) const = 0;
+    // Returns the max cache size for the search of the input, which may be smaller than the
+    // given one, e.g. when the input obviously is the word it has to be corrected to.
+    virtual int getMaxCacheSizeForInput(const DicTraverseSession *const traverseSession,
+            const int maxCacheSize) const = 0;
     virtual int getTerminalCacheSize() const = 0;
     virtual bool isPossibleOmissionChildNode(const DicTraverseSession *const traverseSession,
             const DicNode *const parentDicNode, const DicNode *const dicNode) const = 0;
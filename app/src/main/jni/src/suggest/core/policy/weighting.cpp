@@ -22,6 +22,7 @@
 #include "suggest/core/dicnode/dic_node_utils.h"
 #include "suggest/core/dictionary/error_type_utils.h"
 #include "suggest/core/session/dic_traverse_session.h"
+#include "suggest/policyimpl/typing/typing_weighting.h"
 
 namespace latinime {
 
@@ -72,7 +73,8 @@ static inline void profile(const CorrectionType correctionType, DicNode *const n
 #endif
 }
 
-/* static */ void Weighting::addCostAndForwardInputIndex(const Weighting *const weighting,
+template<class WeightingType>
+/* static */ void Weighting::addCostAndForwardInputIndex(const WeightingType *const weighting,
         const CorrectionType correctionType, const DicTraverseSession *const traverseSession,
         const DicNode *const parentDicNode, DicNode *const dicNode,
         MultiBigramMap *const multiBigramMap) {
@@ -101,7 +103,21 @@ static inline void profile(const CorrectionType correctionType, DicNode *const n
     }
 }
 
-/* static */ float Weighting::getSpatialCost(const Weighting *const weighting,
+template<class WeightingType>
+/* static */ float Weighting::getCompoundDistanceLowerBound(const WeightingType *const weighting,
+        const DicTraverseSession *const traverseSession, const DicNode *const dicNode) {
+    if (weighting->needsToNormalizeCompoundDistance()) {
+        // The normalized distance can decrease when the DicNode consumes more input points.
+        return 0.0f;
+    }
+    // All costs are non-negative, so the distance never decreases along the search.
+    return dicNode->getNormalizedCompoundDistance()
+            + weighting->getRemainingSpatialCostLowerBound(traverseSession, dicNode)
+            + weighting->getRemainingLanguageCostLowerBound(traverseSession, dicNode);
+}
+
+template<class WeightingType>
+/* static */ float Weighting::getSpatialCost(const WeightingType *const weighting,
         const CorrectionType correctionType, const DicTraverseSession *const traverseSession,
         const DicNode *const parentDicNode, const DicNode *const dicNode,
         DicNode_InputStateG *const inputStateG) {
@@ -139,7 +155,8 @@ static inline void profile(const CorrectionType correctionType, DicNode *const n
     }
 }
 
-/* static */ float Weighting::getLanguageCost(const Weighting *const weighting,
+template<class WeightingType>
+/* static */ float Weighting::getLanguageCost(const WeightingType *const weighting,
         const CorrectionType correctionType, const DicTraverseSession *const traverseSession,
         const DicNode *const parentDicNode, const DicNode *const dicNode,
         MultiBigramMap *const multiBigramMap) {
@@ -157,8 +174,7 @@ static inline void profile(const CorrectionType correctionType, DicNode *const n
         return 0.0f;
     case CT_TERMINAL: {
         const float languageImprobability =
-                DicNodeUtils::getBigramNodeImprobability(
-                        traverseSession->getDictionaryStructurePolicy(), dicNode, multiBigramMap);
+                DicNodeUtils::getBigramNodeImprobability(traverseSession, dicNode, multiBigramMap);
         return weighting->getTerminalLanguageCost(traverseSession, dicNode, languageImprobability);
     }
     case CT_TERMINAL_INSERTION:
@@ -203,4 +219,17 @@ static inline void profile(const CorrectionType correctionType, DicNode *const n
             return 0;
     }
 }
+
+template void Weighting::addCostAndForwardInputIndex(const Weighting *const weighting,
+        const CorrectionType correctionType, const DicTraverseSession *const traverseSession,
+        const DicNode *const parentDicNode, DicNode *const dicNode,
+        MultiBigramMap *const multiBigramMap);
+template void Weighting::addCostAndForwardInputIndex(const TypingWeighting *const weighting,
+        const CorrectionType correctionType, const DicTraverseSession *const traverseSession,
+        const DicNode *const parentDicNode, DicNode *const dicNode,
+        MultiBigramMap *const multiBigramMap);
+template float Weighting::getCompoundDistanceLowerBound(const Weighting *const weighting,
+        const DicTraverseSession *const traverseSession, const DicNode *const dicNode);
+template float Weighting::getCompoundDistanceLowerBound(const TypingWeighting *const weighting,
+        const DicTraverseSession *const traverseSession, const DicNode *const dicNode);
 }  // namespace latinime
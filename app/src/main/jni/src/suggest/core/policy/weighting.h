@@ -29,12 +29,21 @@ class MultiBigramMap;
 
 class Weighting {
  public:
-    static void addCostAndForwardInputIndex(const Weighting *const weighting,
+    // The weighting is either a Weighting called through the virtual interface or a final
+    // subclass whose costs can be inlined. Both are instantiated in weighting.cpp.
+    template<class WeightingType>
+    static void addCostAndForwardInputIndex(const WeightingType *const weighting,
             const CorrectionType correctionType,
             const DicTraverseSession *const traverseSession,
             const DicNode *const parentDicNode, DicNode *const dicNode,
             MultiBigramMap *const multiBigramMap);
 
+    // Returns a lower bound of the compound distance of any terminal DicNode that can be reached
+    // from the dicNode. DicNodes whose bound can't beat the current terminals can be pruned.
+    template<class WeightingType>
+    static float getCompoundDistanceLowerBound(const WeightingType *const weighting,
+            const DicTraverseSession *const traverseSession, const DicNode *const dicNode);
+
  protected:
     virtual float getTerminalSpatialCost(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode) const = 0;
@@ -78,6 +87,17 @@ class Weighting {
 
     virtual bool needsToNormalizeCompoundDistance() const = 0;
 
+    // Returns a lower bound of the spatial cost of consuming the rest of the input points.
+    virtual float getRemainingSpatialCostLowerBound(
+            const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const = 0;
+
+    // Returns a lower bound of the language cost of the words the DicNode can still reach, from
+    // DicNode::getMaxTerminalProbability().
+    virtual float getRemainingLanguageCostLowerBound(
+            const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const = 0;
+
     virtual float getAdditionalProximityCost() const = 0;
 
     virtual float getSubstitutionCost() const = 0;
@@ -95,11 +115,13 @@ class Weighting {
  private:
     DISALLOW_COPY_AND_ASSIGN(Weighting);
 
-    static float getSpatialCost(const Weighting *const weighting,
+    template<class WeightingType>
+    static float getSpatialCost(const WeightingType *const weighting,
             const CorrectionType correctionType, const DicTraverseSession *const traverseSession,
             const DicNode *const parentDicNode, const DicNode *const dicNode,
             DicNode_InputStateG *const inputStateG);
-    static float getLanguageCost(const Weighting *const weighting,
+    template<class WeightingType>
+    static float getLanguageCost(const WeightingType *const weighting,
             const CorrectionType correctionType, const DicTraverseSession *const traverseSession,
             const DicNode *const parentDicNode, const DicNode *const dicNode,
             MultiBigramMap *const multiBigramMap);
@@ -17,7 +17,7 @@
 #ifndef LATINIME_SUGGESTED_WORD_H
 #define LATINIME_SUGGESTED_WORD_H
 
-#include <vector>
+#include <algorithm>
 
 #include "defines.h"
 #include "suggest/core/dictionary/dictionary.h"
@@ -39,19 +39,32 @@ class SuggestedWord {
         DISALLOW_ASSIGNMENT_OPERATOR(Comparator);
     };
 
+    // An empty word for the fixed slots of SuggestionResults.
+    SuggestedWord()
+            : mCodePoints(), mCodePointCount(0), mScore(0), mType(0),
+              mIndexToPartialCommit(NOT_AN_INDEX),
+              mAutoCommitFirstWordConfidence(NOT_A_FIRST_WORD_CONFIDENCE) {}
+
+    // codePointCount must not exceed MAX_WORD_LENGTH.
     SuggestedWord(const int *const codePoints, const int codePointCount,
             const int score, const int type, const int indexToPartialCommit,
             const int autoCommitFirstWordConfidence)
-            : mCodePoints(codePoints, codePoints + codePointCount), mScore(score),
+            : mCodePoints(), mCodePointCount(codePointCount), mScore(score),
               mType(type), mIndexToPartialCommit(indexToPartialCommit),
-              mAutoCommitFirstWordConfidence(autoCommitFirstWordConfidence) {}
+              mAutoCommitFirstWordConfidence(autoCommitFirstWordConfidence) {
+        ASSERT(codePointCount <= MAX_WORD_LENGTH);
+        std::copy(codePoints, codePoints + codePointCount, mCodePoints);
+    }
+
+    SuggestedWord(const SuggestedWord &suggestedWord) = default;
+    SuggestedWord &operator=(const SuggestedWord &suggestedWord) = default;
 
     const int *getCodePoint() const {
-        return &mCodePoints.at(0);
+        return mCodePoints;
     }
 
     int getCodePointCount() const {
-        return mCodePoints.size();
+        return mCodePointCount;
     }
 
     int getScore() const {
@@ -71,9 +84,9 @@ class SuggestedWord {
     }
 
  private:
-    DISALLOW_DEFAULT_CONSTRUCTOR(SuggestedWord);
-
-    std::vector<int> mCodePoints;
+    // Kept inline so that suggestions are stored and copied without allocations.
+    int mCodePoints[MAX_WORD_LENGTH];
+    int mCodePointCount;
     int mScore;
     int mType;
     int mIndexToPartialCommit;
@@ -16,6 +16,8 @@
 
 #include "suggest/core/result/suggestion_results.h"
 
+#include <algorithm>
+
 #include "utils/jni_data_utils.h"
 
 namespace latinime {
@@ -25,9 +27,9 @@ void SuggestionResults::outputSuggestions(JNIEnv *env, jintArray outSuggestionCo
         jintArray outTypesArray, jintArray outAutoCommitFirstWordConfidenceArray,
         jfloatArray outWeightOfLangModelVsSpatialModel) {
     int outputIndex = 0;
-    while (!mSuggestedWords.empty()) {
-        const SuggestedWord &suggestedWord = mSuggestedWords.top();
-        suggestedWord.getCodePointCount();
+    while (mSuggestionCount > 0) {
+        const bool isLast = mSuggestionCount == 1;
+        const SuggestedWord &suggestedWord = mSuggestedWords[popWorstSuggestedWord()];
         const int start = outputIndex * MAX_WORD_LENGTH;
         JniDataUtils::outputCodePoints(env, outputCodePointsArray, start,
                 MAX_WORD_LENGTH /* maxLength */, suggestedWord.getCodePoint(),
@@ -36,18 +38,42 @@ void SuggestionResults::outputSuggestions(JNIEnv *env, jintArray outSuggestionCo
         JniDataUtils::putIntToArray(env, outSpaceIndicesArray, outputIndex,
                 suggestedWord.getIndexToPartialCommit());
         JniDataUtils::putIntToArray(env, outTypesArray, outputIndex, suggestedWord.getType());
-        if (mSuggestedWords.size() == 1) {
+        if (isLast) {
             JniDataUtils::putIntToArray(env, outAutoCommitFirstWordConfidenceArray, 0 /* index */,
                     suggestedWord.getAutoCommitFirstWordConfidence());
         }
         ++outputIndex;
-        mSuggestedWords.pop();
     }
     JniDataUtils::putIntToArray(env, outSuggestionCount, 0 /* index */, outputIndex);
     JniDataUtils::putFloatToArray(env, outWeightOfLangModelVsSpatialModel, 0 /* index */,
             mWeightOfLangModelVsSpatialModel);
 }
 
+int SuggestionResults::outputSuggestions(int *const outCodePoints, int *const outScores,
+        int *const outSpaceIndices, int *const outTypes,
+        int *const outAutoCommitFirstWordConfidence) {
+    int outputIndex = 0;
+    while (mSuggestionCount > 0) {
+        const bool isLast = mSuggestionCount == 1;
+        const SuggestedWord &suggestedWord = mSuggestedWords[popWorstSuggestedWord()];
+        int *const codePoints = outCodePoints + outputIndex * MAX_WORD_LENGTH;
+        const int codePointCount = JniDataUtils::copyCodePointsForOutput(
+                suggestedWord.getCodePoint(),
+                std::min(suggestedWord.getCodePointCount(), MAX_WORD_LENGTH), codePoints);
+        if (codePointCount < MAX_WORD_LENGTH) {
+            codePoints[codePointCount] = 0;
+        }
+        outScores[outputIndex] = suggestedWord.getScore();
+        outSpaceIndices[outputIndex] = suggestedWord.getIndexToPartialCommit();
+        outTypes[outputIndex] = suggestedWord.getType();
+        if (isLast) {
+            *outAutoCommitFirstWordConfidence = suggestedWord.getAutoCommitFirstWordConfidence();
+        }
+        ++outputIndex;
+    }
+    return outputIndex;
+}
+
 void SuggestionResults::addPrediction(const int *const codePoints, const int codePointCount,
         const int probability) {
     if (probability == NOT_A_PROBABILITY) {
@@ -67,36 +93,147 @@ void SuggestionResults::addSuggestion(const int *const codePoints, const int cod
                 codePointCount);
         return;
     }
+    addSuggestedWord(SuggestedWord(codePoints, codePointCount, score, type,
+            indexToPartialCommit, autocimmitFirstWordConfindence));
+}
+
+void SuggestionResults::addSuggestedWord(const SuggestedWord &suggestedWord) {
+    if (mMaxSuggestionCount <= 0) {
+        return;
+    }
+    const uint32_t codePointHash = getCodePointHash(suggestedWord.getCodePoint(),
+            suggestedWord.getCodePointCount());
+    int bucket = findHashBucket(suggestedWord, codePointHash);
+    if (mHashBuckets[bucket] != EMPTY_BUCKET) {
+        // The word is already in the results. The other suggestion of the same code points only
+        // replaces it when its score is higher.
+        const int slotIndex = mHashBuckets[bucket];
+        if (suggestedWord.getScore() > mSuggestedWords[slotIndex].getScore()) {
+            mSuggestedWords[slotIndex] = suggestedWord;
+            std::make_heap(mSuggestedWordIndices, mSuggestedWordIndices + mSuggestionCount,
+                    IndexComparator(mSuggestedWords));
+        }
+        return;
+    }
     if (getSuggestionCount() >= mMaxSuggestionCount) {
-        const SuggestedWord &mWorstSuggestion = mSuggestedWords.top();
-        if (score > mWorstSuggestion.getScore() || (score == mWorstSuggestion.getScore()
-                && codePointCount < mWorstSuggestion.getCodePointCount())) {
-            mSuggestedWords.pop();
+        const SuggestedWord &mWorstSuggestion = getWorstSuggestedWord();
+        if (suggestedWord.getScore() > mWorstSuggestion.getScore()
+                || (suggestedWord.getScore() == mWorstSuggestion.getScore()
+                        && suggestedWord.getCodePointCount()
+                                < mWorstSuggestion.getCodePointCount())) {
+            popWorstSuggestedWord();
+            // Removing the worst suggestion may have moved the empty bucket of the word.
+            bucket = findHashBucket(suggestedWord, codePointHash);
         } else {
             return;
         }
     }
-    mSuggestedWords.push(SuggestedWord(codePoints, codePointCount, score, type,
-            indexToPartialCommit, autocimmitFirstWordConfindence));
+    const int slotIndex = mSuggestedWordIndices[mSuggestionCount];
+    mSuggestedWords[slotIndex] = suggestedWord;
+    mCodePointHashes[slotIndex] = codePointHash;
+    mHashBuckets[bucket] = slotIndex;
+    ++mSuggestionCount;
+    std::push_heap(mSuggestedWordIndices, mSuggestedWordIndices + mSuggestionCount,
+            IndexComparator(mSuggestedWords));
+}
+
+int SuggestionResults::popWorstSuggestedWord() {
+    std::pop_heap(mSuggestedWordIndices, mSuggestedWordIndices + mSuggestionCount,
+            IndexComparator(mSuggestedWords));
+    --mSuggestionCount;
+    const int slotIndex = mSuggestedWordIndices[mSuggestionCount];
+    removeFromHashBuckets(slotIndex);
+    return slotIndex;
+}
+
+/* static */ uint32_t SuggestionResults::getCodePointHash(const int *const codePoints,
+        const int codePointCount) {
+    // FNV-1a on the code points.
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < codePointCount; ++i) {
+        hash = (hash ^ static_cast<uint32_t>(codePoints[i])) * 16777619u;
+    }
+    return hash;
+}
+
+int SuggestionResults::findHashBucket(const SuggestedWord &suggestedWord,
+        const uint32_t codePointHash) const {
+    // There are more buckets than slots, so the probing always reaches an empty bucket.
+    int bucket = static_cast<int>(codePointHash & (HASH_BUCKET_COUNT - 1));
+    while (mHashBuckets[bucket] != EMPTY_BUCKET) {
+        const int slotIndex = mHashBuckets[bucket];
+        const SuggestedWord &word = mSuggestedWords[slotIndex];
+        if (mCodePointHashes[slotIndex] == codePointHash
+                && word.getCodePointCount() == suggestedWord.getCodePointCount()
+                && std::equal(word.getCodePoint(), word.getCodePoint() + word.getCodePointCount(),
+                        suggestedWord.getCodePoint())) {
+            return bucket;
+        }
+        bucket = (bucket + 1) & (HASH_BUCKET_COUNT - 1);
+    }
+    return bucket;
+}
+
+// Backward shift deletion, which keeps every slot reachable from its home bucket without
+// leaving tombstones.
+void SuggestionResults::removeFromHashBuckets(const int slotIndex) {
+    int bucket = static_cast<int>(mCodePointHashes[slotIndex] & (HASH_BUCKET_COUNT - 1));
+    while (mHashBuckets[bucket] != slotIndex) {
+        bucket = (bucket + 1) & (HASH_BUCKET_COUNT - 1);
+    }
+    int nextBucket = (bucket + 1) & (HASH_BUCKET_COUNT - 1);
+    while (mHashBuckets[nextBucket] != EMPTY_BUCKET) {
+        const int homeBucket = static_cast<int>(
+                mCodePointHashes[mHashBuckets[nextBucket]] & (HASH_BUCKET_COUNT - 1));
+        // Moves the slot to the hole unless its home bucket is cyclically in (hole, next].
+        const int distanceToHole = (bucket - homeBucket) & (HASH_BUCKET_COUNT - 1);
+        const int distanceToNext = (nextBucket - homeBucket) & (HASH_BUCKET_COUNT - 1);
+        if (distanceToHole < distanceToNext) {
+            mHashBuckets[bucket] = mHashBuckets[nextBucket];
+            bucket = nextBucket;
+        }
+        nextBucket = (nextBucket + 1) & (HASH_BUCKET_COUNT - 1);
+    }
+    mHashBuckets[bucket] = EMPTY_BUCKET;
+}
+
+// Pops a copy of the index heap, so the suggestions themselves are not copied.
+void SuggestionResults::getSuggestedWordIndicesWorstFirst(int *const outIndices) const {
+    std::copy(mSuggestedWordIndices, mSuggestedWordIndices + mSuggestionCount, outIndices);
+    for (int count = mSuggestionCount; count > 0; --count) {
+        std::pop_heap(outIndices, outIndices + count, IndexComparator(mSuggestedWords));
+    }
+    // pop_heap moves the popped index to the end.
+    std::reverse(outIndices, outIndices + mSuggestionCount);
+}
+
+void SuggestionResults::getSuggestedWords(
+        std::vector<SuggestedWord> *const outSuggestedWords) const {
+    int indices[MAX_RESULTS];
+    getSuggestedWordIndicesWorstFirst(indices);
+    for (int i = 0; i < mSuggestionCount; ++i) {
+        outSuggestedWords->push_back(mSuggestedWords[indices[i]]);
+    }
+}
+
+void SuggestionResults::addSuggestedWords(const std::vector<SuggestedWord> &suggestedWords) {
+    for (const SuggestedWord &suggestedWord : suggestedWords) {
+        addSuggestedWord(suggestedWord);
+    }
 }
 
 void SuggestionResults::getSortedScores(int *const outScores) const {
-    auto copyOfSuggestedWords = mSuggestedWords;
-    while (!copyOfSuggestedWords.empty()) {
-        const SuggestedWord &suggestedWord = copyOfSuggestedWords.top();
-        outScores[copyOfSuggestedWords.size() - 1] = suggestedWord.getScore();
-        copyOfSuggestedWords.pop();
+    int indices[MAX_RESULTS];
+    getSuggestedWordIndicesWorstFirst(indices);
+    for (int i = 0; i < mSuggestionCount; ++i) {
+        outScores[mSuggestionCount - 1 - i] = mSuggestedWords[indices[i]].getScore();
     }
 }
 
 void SuggestionResults::dumpSuggestions() const {
     AKLOGE("weight of language model vs spatial model: %f", mWeightOfLangModelVsSpatialModel);
     std::vector<SuggestedWord> suggestedWords;
-    auto copyOfSuggestedWords = mSuggestedWords;
-    while (!copyOfSuggestedWords.empty()) {
-        suggestedWords.push_back(copyOfSuggestedWords.top());
-        copyOfSuggestedWords.pop();
-    }
+    getSuggestedWords(&suggestedWords);
     int index = 0;
     for (auto it = suggestedWords.rbegin(); it != suggestedWords.rend(); ++it) {
         DUMP_SUGGESTION(it->getCodePoint(), it->getCodePointCount(), index, it->getScore());
@@ -17,31 +17,52 @@
 #ifndef LATINIME_SUGGESTION_RESULTS_H
 #define LATINIME_SUGGESTION_RESULTS_H
 
-#include <queue>
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 
 #include "defines.h"
 #include "jni.h"
 #include "suggest/core/result/suggested_word.h"
+#include "suggest/core/session/search_effort.h"
 
 namespace latinime {
 
 class SuggestionResults {
  public:
+    // maxSuggestionCount must not exceed MAX_RESULTS.
     explicit SuggestionResults(const int maxSuggestionCount)
-            : mMaxSuggestionCount(maxSuggestionCount),
+            : mMaxSuggestionCount(std::min(maxSuggestionCount, MAX_RESULTS)),
               mWeightOfLangModelVsSpatialModel(NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL),
-              mSuggestedWords() {}
+              mSuggestedWords(), mSuggestedWordIndices(), mSuggestionCount(0),
+              mCodePointHashes(), mHashBuckets(), mSearchEffort() {
+        ASSERT(maxSuggestionCount <= MAX_RESULTS);
+        for (int i = 0; i < MAX_RESULTS; ++i) {
+            mSuggestedWordIndices[i] = i;
+        }
+        std::fill(mHashBuckets, mHashBuckets + HASH_BUCKET_COUNT,
+                static_cast<int>(EMPTY_BUCKET) /* not odr-used */);
+    }
 
     // Returns suggestion count.
     void outputSuggestions(JNIEnv *env, jintArray outSuggestionCount, jintArray outCodePointsArray,
             jintArray outScoresArray, jintArray outSpaceIndicesArray, jintArray outTypesArray,
             jintArray outAutoCommitFirstWordConfidenceArray,
             jfloatArray outWeightOfLangModelVsSpatialModel);
+    // Same as above, but writes into native memory. outCodePoints must have room for
+    // mMaxSuggestionCount * MAX_WORD_LENGTH code points and the other arrays for
+    // mMaxSuggestionCount elements. Returns suggestion count.
+    int outputSuggestions(int *const outCodePoints, int *const outScores,
+            int *const outSpaceIndices, int *const outTypes,
+            int *const outAutoCommitFirstWordConfidence);
     void addPrediction(const int *const codePoints, const int codePointCount, const int score);
+    // A word that is already in the results only keeps the better of its two suggestions.
     void addSuggestion(const int *const codePoints, const int codePointCount,
             const int score, const int type, const int indexToPartialCommit,
             const int autocimmitFirstWordConfindence);
+    // Copies the suggestions in no particular order.
+    void getSuggestedWords(std::vector<SuggestedWord> *const outSuggestedWords) const;
+    void addSuggestedWords(const std::vector<SuggestedWord> &suggestedWords);
     void getSortedScores(int *const outScores) const;
     void dumpSuggestions() const;
 
@@ -50,16 +71,83 @@ class SuggestionResults {
     }
 
     int getSuggestionCount() const {
-        return mSuggestedWords.size();
+        return mSuggestionCount;
+    }
+
+    int getMaxSuggestionCount() const {
+        return mMaxSuggestionCount;
+    }
+
+    // Returns false when a suggestion of the score would be dropped for sure, i.e. the results
+    // are full and their worst score is higher.
+    bool canAddSuggestionOfScore(const int score) const {
+        if (getSuggestionCount() < mMaxSuggestionCount) {
+            return true;
+        }
+        return mSuggestionCount > 0 && score >= getWorstSuggestedWord().getScore();
+    }
+
+    float getWeightOfLangModelVsSpatialModel() const {
+        return mWeightOfLangModelVsSpatialModel;
+    }
+
+    // The effort of the searches that produced the suggestions.
+    void addSearchEffort(const SearchEffort &searchEffort) {
+        mSearchEffort.add(searchEffort);
+    }
+
+    const SearchEffort &getSearchEffort() const {
+        return mSearchEffort;
     }
 
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(SuggestionResults);
 
+    // Orders slot indices by SuggestedWord::Comparator.
+    class IndexComparator {
+     public:
+        explicit IndexComparator(const SuggestedWord *const suggestedWords)
+                : mSuggestedWords(suggestedWords) {}
+
+        bool operator()(const int left, const int right) const {
+            return SuggestedWord::Comparator()(mSuggestedWords[left], mSuggestedWords[right]);
+        }
+
+     private:
+        const SuggestedWord *const mSuggestedWords;
+    };
+
+    // Twice MAX_RESULTS rounded up to a power of 2, so that the probe sequences stay short.
+    static const int HASH_BUCKET_COUNT = 128;
+    static const int EMPTY_BUCKET = -1;
+
+    static uint32_t getCodePointHash(const int *const codePoints, const int codePointCount);
+
+    void addSuggestedWord(const SuggestedWord &suggestedWord);
+    // Removes the worst suggestion and returns the index of the slot it was stored in. The slot
+    // stays valid until the next suggestion is added.
+    int popWorstSuggestedWord();
+    // Returns the bucket of the slot of the word, or the empty bucket where it would be inserted.
+    int findHashBucket(const SuggestedWord &suggestedWord, const uint32_t codePointHash) const;
+    void removeFromHashBuckets(const int slotIndex);
+    void getSuggestedWordIndicesWorstFirst(int *const outIndices) const;
+
+    const SuggestedWord &getWorstSuggestedWord() const {
+        return mSuggestedWords[mSuggestedWordIndices[0]];
+    }
+
     const int mMaxSuggestionCount;
     float mWeightOfLangModelVsSpatialModel;
-    std::priority_queue<
-            SuggestedWord, std::vector<SuggestedWord>, SuggestedWord::Comparator> mSuggestedWords;
+    // The suggestions are kept in fixed slots, and the heap is built on the slot indices so that
+    // sifting only moves ints. The first mSuggestionCount indices form a heap that has the worst
+    // suggestion at its top; the rest are the free slots.
+    SuggestedWord mSuggestedWords[MAX_RESULTS];
+    int mSuggestedWordIndices[MAX_RESULTS];
+    int mSuggestionCount;
+    // The slots of the suggestions by the hash of their code points, with linear probing.
+    uint32_t mCodePointHashes[MAX_RESULTS];
+    int mHashBuckets[HASH_BUCKET_COUNT];
+    SearchEffort mSearchEffort;
 };
 } // namespace latinime
 #endif // LATINIME_SUGGESTION_RESULTS_H
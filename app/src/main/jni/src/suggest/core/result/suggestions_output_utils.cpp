@@ -17,6 +17,7 @@
 #include "suggest/core/result/suggestions_output_utils.h"
 
 #include <algorithm>
+#include <utility>
 #include <vector>
 
 #include "dictionary/utils/binary_dictionary_shortcut_iterator.h"
@@ -27,22 +28,27 @@
 #include "suggest/core/result/suggestion_results.h"
 #include "suggest/core/session/dic_traverse_session.h"
 #include "suggest/core/suggest_options.h"
+#include "utils/native_trace.h"
 
 namespace latinime {
 
 const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
+// Returned for terminals of which only the shortcuts are output.
+const int SuggestionsOutputUtils::NOT_A_FINAL_SCORE = S_INT_MIN;
 
 /* static */ void SuggestionsOutputUtils::outputSuggestions(
         const Scoring *const scoringPolicy, DicTraverseSession *traverseSession,
         const float weightOfLangModelVsSpatialModel,
         SuggestionResults *const outSuggestionResults) {
+    const NativeTrace::ScopedSection section("SuggestionsOutputUtils::outputSuggestions");
 #if DEBUG_EVALUATE_MOST_PROBABLE_STRING
     const int terminalSize = 0;
 #else
     const int terminalSize = traverseSession->getDicTraverseCache()->terminalSize();
 #endif
-    std::vector<DicNode> terminals(terminalSize);
-    for (int index = terminalSize - 1; index >= 0; --index) {
+    std::vector<DicNode> &terminals = *traverseSession->getOutputTerminalDicNodes();
+    terminals.resize(terminalSize);
+    for (int index = 0; index < terminalSize; ++index) {
         traverseSession->getDicTraverseCache()->popTerminal(&terminals[index]);
     }
     // Compute a weight of language model when an invalid weight is passed.
@@ -66,11 +72,57 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
     const bool boostExactMatches = traverseSession->getDictionaryStructurePolicy()->
             getHeaderStructurePolicy()->shouldBoostExactMatches();
 
-    // Output suggestion results here
-    for (auto &terminalDicNode : terminals) {
-        outputSuggestionsOfDicNode(scoringPolicy, traverseSession, &terminalDicNode,
+    // Output suggestion results here, the most promising terminals first so that the results
+    // fill up early. Once they are full, the terminals that cannot beat the worst suggestion
+    // are skipped without reading their attributes and shortcuts.
+    std::vector<std::pair<int, int>> &upperBoundScoreAndIndices =
+            *traverseSession->getOutputUpperBoundScoreAndIndices();
+    upperBoundScoreAndIndices.resize(terminalSize);
+    for (int index = 0; index < terminalSize; ++index) {
+        upperBoundScoreAndIndices[index] = std::make_pair(getFinalScoreUpperBound(scoringPolicy,
+                traverseSession, &terminals[index],
                 weightOfLangModelVsSpatialModelToOutputSuggestions, boostExactMatches,
-                forceCommitMultiWords, outputSecondWordFirstLetterInputIndex, outSuggestionResults);
+                forceCommitMultiWords), index);
+    }
+    // The terminals are popped best first, so their order is kept on ties. Not stable_sort(),
+    // which allocates a temporary buffer.
+    std::sort(upperBoundScoreAndIndices.begin(), upperBoundScoreAndIndices.end(),
+            [](const std::pair<int, int> &left, const std::pair<int, int> &right) {
+                return left.first > right.first
+                        || (left.first == right.first && left.second < right.second);
+            });
+    // The same word often reaches the terminals through different corrections. The results keep
+    // its best suggestion, so once a word has been output, the later terminals of the word that
+    // cannot beat its score are skipped. Their shortcuts would not beat the ones already output
+    // either.
+    std::vector<std::pair<int /* wordId */, int /* finalScore */>> &outputWordIdAndScores =
+            *traverseSession->getOutputWordIdAndScores();
+    outputWordIdAndScores.clear();
+    for (const auto &upperBoundScoreAndIndex : upperBoundScoreAndIndices) {
+        const DicNode *const terminalDicNode = &terminals[upperBoundScoreAndIndex.second];
+        // A whitelist shortcut of the typed word is output with S_INT_MAX regardless of the
+        // score of the terminal.
+        if (!outSuggestionResults->canAddSuggestionOfScore(upperBoundScoreAndIndex.first)
+                && (terminalDicNode->hasMultipleWords()
+                        || !scoringPolicy->sameAsTyped(traverseSession, terminalDicNode))) {
+            continue;
+        }
+        const bool isSingleWord = !terminalDicNode->hasMultipleWords();
+        if (isSingleWord && std::any_of(outputWordIdAndScores.begin(),
+                outputWordIdAndScores.end(),
+                [terminalDicNode, &upperBoundScoreAndIndex](const std::pair<int, int> &output) {
+                    return output.first == terminalDicNode->getWordId()
+                            && output.second >= upperBoundScoreAndIndex.first;
+                })) {
+            continue;
+        }
+        const int finalScore = outputSuggestionsOfDicNode(scoringPolicy, traverseSession,
+                terminalDicNode, weightOfLangModelVsSpatialModelToOutputSuggestions,
+                boostExactMatches, forceCommitMultiWords, outputSecondWordFirstLetterInputIndex,
+                outSuggestionResults);
+        if (isSingleWord && finalScore != NOT_A_FINAL_SCORE) {
+            outputWordIdAndScores.emplace_back(terminalDicNode->getWordId(), finalScore);
+        }
     }
     scoringPolicy->getMostProbableString(traverseSession,
             weightOfLangModelVsSpatialModelToOutputSuggestions, outSuggestionResults);
@@ -122,7 +174,26 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
     }
 }
 
-/* static */ void SuggestionsOutputUtils::outputSuggestionsOfDicNode(
+// The final score only depends on the word attributes through whether the probability is 0, so
+// the higher of the two scores bounds the score of the terminal and of its shortcuts.
+/* static */ int SuggestionsOutputUtils::getFinalScoreUpperBound(
+        const Scoring *const scoringPolicy, const DicTraverseSession *const traverseSession,
+        const DicNode *const terminalDicNode, const float weightOfLangModelVsSpatialModel,
+        const bool boostExactMatches, const bool forceCommitMultiWords) {
+    const float compoundDistance =
+            terminalDicNode->getCompoundDistance(weightOfLangModelVsSpatialModel)
+                    + scoringPolicy->getDoubleLetterDemotionDistanceCost(terminalDicNode);
+    const bool forceCommit = forceCommitMultiWords && terminalDicNode->hasMultipleWords();
+    return std::max(
+            scoringPolicy->calculateFinalScore(compoundDistance, traverseSession->getInputSize(),
+                    terminalDicNode->getContainedErrorTypes(), forceCommit, boostExactMatches,
+                    false /* hasProbabilityZero */),
+            scoringPolicy->calculateFinalScore(compoundDistance, traverseSession->getInputSize(),
+                    terminalDicNode->getContainedErrorTypes(), forceCommit, boostExactMatches,
+                    true /* hasProbabilityZero */));
+}
+
+/* static */ int SuggestionsOutputUtils::outputSuggestionsOfDicNode(
         const Scoring *const scoringPolicy, DicTraverseSession *traverseSession,
         const DicNode *const terminalDicNode, const float weightOfLangModelVsSpatialModel,
         const bool boostExactMatches, const bool forceCommitMultiWords,
@@ -136,9 +207,9 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
     const float compoundDistance =
             terminalDicNode->getCompoundDistance(weightOfLangModelVsSpatialModel)
                     + doubleLetterCost;
-    const WordAttributes wordAttributes = traverseSession->getDictionaryStructurePolicy()
-            ->getWordAttributesInContext(terminalDicNode->getPrevWordIds(),
-                    terminalDicNode->getWordId(), nullptr /* multiBigramMap */);
+    const WordAttributes wordAttributes = traverseSession->getWordAttributesInContext(
+            terminalDicNode->getPrevWordIds(), terminalDicNode->getWordId(),
+            nullptr /* multiBigramMap */);
     const bool isExactMatch =
             ErrorTypeUtils::isExactMatch(terminalDicNode->getContainedErrorTypes());
     const bool isExactMatchWithIntentionalOmission =
@@ -193,6 +264,7 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
         const bool sameAsTyped = scoringPolicy->sameAsTyped(traverseSession, terminalDicNode);
         outputShortcuts(&shortcutIt, finalScore, sameAsTyped, outSuggestionResults);
     }
+    return (isValidWord && !shouldBlockThisWord) ? finalScore : NOT_A_FINAL_SCORE;
 }
 
 /* static */ int SuggestionsOutputUtils::computeFirstWordConfidence(
@@ -50,8 +50,14 @@ class SuggestionsOutputUtils {
 
     // Inputs longer than this will autocorrect if the suggestion is multi-word
     static const int MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT;
+    static const int NOT_A_FINAL_SCORE;
 
-    static void outputSuggestionsOfDicNode(const Scoring *const scoringPolicy,
+    static int getFinalScoreUpperBound(const Scoring *const scoringPolicy,
+            const DicTraverseSession *const traverseSession, const DicNode *const terminalDicNode,
+            const float weightOfLangModelVsSpatialModel, const bool boostExactMatches,
+            const bool forceCommitMultiWords);
+    // Returns the score the word of the terminal was output with, or NOT_A_FINAL_SCORE.
+    static int outputSuggestionsOfDicNode(const Scoring *const scoringPolicy,
             DicTraverseSession *traverseSession, const DicNode *const terminalDicNode,
             const float weightOfLangModelVsSpatialModel, const bool boostExactMatches,
             const bool forceCommitMultiWords, const bool outputSecondWordFirstLetterInputIndex,
@@ -16,48 +16,233 @@
 
 #include "suggest/core/session/dic_traverse_session.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstring> // for memmove()
+
 #include "defines.h"
 #include "dictionary/interface/dictionary_header_structure_policy.h"
 #include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "dictionary/interface/ngram_listener.h"
 #include "dictionary/property/ngram_context.h"
 #include "suggest/core/dictionary/dictionary.h"
+#include "suggest/core/suggest_options.h"
+#include "utils/memory_usage.h"
 
 namespace latinime {
 
+namespace {
+
+class MaxNgramProbabilityListener : public NgramListener {
+ public:
+    MaxNgramProbabilityListener() : mMaxNgramProbability(NOT_A_PROBABILITY) {}
+    virtual ~MaxNgramProbabilityListener() {}
+
+    virtual void onVisitEntry(const int ngramProbability, const int targetWordId) {
+        if (targetWordId != NOT_A_WORD_ID) {
+            mMaxNgramProbability = std::max(mMaxNgramProbability, ngramProbability);
+        }
+    }
+
+    int getMaxNgramProbability() const {
+        return mMaxNgramProbability;
+    }
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(MaxNgramProbabilityListener);
+
+    int mMaxNgramProbability;
+};
+
+} // namespace
+
 // 256K bytes threshold is heuristically used to distinguish dictionaries containing many unigrams
 // (e.g. main dictionary) from small dictionaries (e.g. contacts...)
 const int DicTraverseSession::DICTIONARY_SIZE_THRESHOLD_TO_USE_LARGE_CACHE_FOR_SUGGESTION =
         256 * 1024;
+const int DicTraverseSession::SEARCH_OPTION_FLAG_IS_GESTURE = 0x1;
+const int DicTraverseSession::SEARCH_OPTION_FLAG_USE_FULL_EDIT_DISTANCE = 0x2;
+const int DicTraverseSession::SEARCH_OPTION_FLAG_BLOCK_OFFENSIVE_WORDS = 0x4;
 
 void DicTraverseSession::init(const Dictionary *const dictionary,
+        const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
         const NgramContext *const ngramContext, const SuggestOptions *const suggestOptions) {
+    // The dictionary switches the policy after each update, so a different policy means that the
+    // positions in the previous search may be stale.
+    const bool isSameDictionary = mDictionary == dictionary
+            && mDictionaryStructurePolicy == dictionaryStructurePolicy;
     mDictionary = dictionary;
+    mDictionaryStructurePolicy = dictionaryStructurePolicy;
     mMultiWordCostMultiplier = getDictionaryStructurePolicy()->getHeaderStructurePolicy()
             ->getMultiWordCostMultiplier();
+    mDigraphType = DigraphUtils::getDigraphTypeForDictionary(
+            getDictionaryStructurePolicy()->getHeaderStructurePolicy());
     mSuggestOptions = suggestOptions;
-    mPrevWordIdCount = ngramContext->getPrevWordIds(getDictionaryStructurePolicy(),
-            &mPrevWordIdArray, true /* tryLowerCaseSearch */).size();
+    // The policy has been acquired before, since a generation read earlier could be older than an
+    // updated policy that is published meanwhile.
+    const uint64_t dictionaryGeneration = dictionary->getGeneration();
+    mCompletionCache = dictionary->getCompletionCache();
+    mDictionaryGeneration = dictionaryGeneration;
+    bool isSamePrevWords = isSameDictionary && mPrevWordIdsNgramContext
+            && mPrevWordIdsDictionaryGeneration == dictionaryGeneration
+            && mPrevWordIdsNgramContext->hasSamePrevWords(*ngramContext);
+    if (!isSamePrevWords) {
+        WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> prevWordIdArray;
+        const size_t prevWordIdCount = ngramContext->getPrevWordIds(getDictionaryStructurePolicy(),
+                &prevWordIdArray, true /* tryLowerCaseSearch */).size();
+        // Another context can resolve to the same words, e.g. with a different case.
+        isSamePrevWords = isSameDictionary && prevWordIdCount == mPrevWordIdCount
+                && std::equal(prevWordIdArray.begin(), prevWordIdArray.begin() + prevWordIdCount,
+                        mPrevWordIdArray.begin());
+        mPrevWordIdArray = prevWordIdArray;
+        mPrevWordIdCount = prevWordIdCount;
+        MaxNgramProbabilityListener maxNgramProbabilityListener;
+        if (prevWordIdCount > 0 && prevWordIdArray[0] != NOT_A_WORD_ID) {
+            getDictionaryStructurePolicy()->iterateNgramEntries(getPrevWordIds(),
+                    &maxNgramProbabilityListener);
+        }
+        mMaxNgramProbability = maxNgramProbabilityListener.getMaxNgramProbability();
+        mPrevWordIdsNgramContext.reset(new NgramContext(*ngramContext));
+        mPrevWordIdsDictionaryGeneration = dictionaryGeneration;
+    }
+    // SuggestOptions is owned by the caller and does not outlive the call, so the option values
+    // that affect the search are remembered instead of the instance.
+    if (!suggestOptions) {
+        // Initialized without a search, e.g. from Java.
+        mIsSearchContextUnchanged = false;
+        return;
+    }
+    const int lastOptionFlags = mSearchOptionFlags;
+    const float lastWeightForLocale = mWeightForLocale;
+    mSearchOptionFlags = (suggestOptions->isGesture() ? SEARCH_OPTION_FLAG_IS_GESTURE : 0)
+            | (suggestOptions->useFullEditDistance()
+                    ? SEARCH_OPTION_FLAG_USE_FULL_EDIT_DISTANCE : 0)
+            | (suggestOptions->blockOffensiveWords()
+                    ? SEARCH_OPTION_FLAG_BLOCK_OFFENSIVE_WORDS : 0);
+    mWeightForLocale = suggestOptions->weightForLocale();
+    mIsSearchContextUnchanged = isSamePrevWords && lastOptionFlags == mSearchOptionFlags
+            && lastWeightForLocale == mWeightForLocale;
 }
 
 void DicTraverseSession::setupForGetSuggestions(const ProximityInfo *pInfo,
         const int *inputCodePoints, const int inputSize, const int *const inputXs,
         const int *const inputYs, const int *const times, const int *const pointerIds,
         const float maxSpatialDistance, const int maxPointerCount) {
+    if (mProximityInfo != pInfo) {
+        // The keyboard layout has changed.
+        mIsSearchContextUnchanged = false;
+    }
     mProximityInfo = pInfo;
     mMaxPointerCount = maxPointerCount;
+    mTypingSearchCosts.init(mMultiWordCostMultiplier, mWeightForLocale);
     initializeProximityInfoStates(inputCodePoints, inputXs, inputYs, times, pointerIds, inputSize,
             maxSpatialDistance, maxPointerCount);
+    updateReusableInputPrefixLength(inputCodePoints, inputXs, inputYs, inputSize,
+            maxPointerCount);
 }
 
 const DictionaryStructureWithBufferPolicy *DicTraverseSession::getDictionaryStructurePolicy()
         const {
-    return mDictionary->getDictionaryStructurePolicy();
+    return mDictionaryStructurePolicy;
+}
+
+void DicTraverseSession::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    outMemoryUsage->add(MemoryUsage::HEAP_BYTES, static_cast<int64_t>(sizeof(*this)));
+    mDicNodesCache.addMemoryUsage(outMemoryUsage);
+    mExpansionWorkspace.addMemoryUsage(outMemoryUsage);
+    for (const auto &workspace : mParallelExpansionWorkspaces) {
+        outMemoryUsage->add(MemoryUsage::HEAP_BYTES, static_cast<int64_t>(sizeof(*workspace)));
+        workspace->addMemoryUsage(outMemoryUsage);
+    }
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mPoppedActiveDicNodes);
+    mCompletionsBuffer.addMemoryUsage(outMemoryUsage);
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mOutputTerminalDicNodes);
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mOutputUpperBoundScoreAndIndices);
+    outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mOutputWordIdAndScores);
+    for (int i = 0; i < MAX_POINTER_COUNT_G; ++i) {
+        mProximityInfoStates[i].addMemoryUsage(outMemoryUsage);
+    }
+}
+
+void DicTraverseSession::trimMemory() {
+    mDicNodesCache.release();
+    mExpansionWorkspace.release();
+    mParallelExpansionWorkspaces.clear();
+    std::vector<DicNode>().swap(mPoppedActiveDicNodes);
+    mCompletionsBuffer = CompletionCache::Completions();
+    std::vector<DicNode>().swap(mOutputTerminalDicNodes);
+    std::vector<std::pair<int, int>>().swap(mOutputUpperBoundScoreAndIndices);
+    std::vector<std::pair<int, int>>().swap(mOutputWordIdAndScores);
+}
+
+void DicTraverseSession::preallocateCaches() {
+    resetCache(INT_MAX /* thresholdForNextActiveDicNodes */, MAX_RESULTS /* maxWords */);
 }
 
 void DicTraverseSession::resetCache(const int thresholdForNextActiveDicNodes, const int maxWords) {
     mDicNodesCache.reset(thresholdForNextActiveDicNodes /* nextActiveSize */,
             maxWords /* terminalSize */);
-    mMultiBigramMap.clear();
+    mExpansionWorkspace.clearCaches();
+    for (const auto &workspace : mParallelExpansionWorkspaces) {
+        workspace->clearCaches();
+    }
+}
+
+bool DicTraverseSession::restoreCacheFromSnapshot(const int thresholdForNextActiveDicNodes,
+        const int maxWords, const int maxInputIndex) {
+    // The previous words are the same, so the cached bigram probabilities are still valid. The
+    // word attributes are cleared anyway, since the dictionary may have been updated in between.
+    mExpansionWorkspace.clearWordAttributesCache();
+    for (const auto &workspace : mParallelExpansionWorkspaces) {
+        workspace->clearWordAttributesCache();
+    }
+    return mDicNodesCache.restoreFromSnapshot(thresholdForNextActiveDicNodes /* nextActiveSize */,
+            maxWords /* terminalSize */, maxInputIndex);
+}
+
+ExpansionWorkspace *DicTraverseSession::getParallelExpansionWorkspace(const int taskIndex) {
+    while (static_cast<int>(mParallelExpansionWorkspaces.size()) <= taskIndex) {
+        mParallelExpansionWorkspaces.emplace_back(new ExpansionWorkspace(true /* defersPushes */));
+    }
+    return mParallelExpansionWorkspaces[taskIndex].get();
+}
+
+ExpansionWorkspace *DicTraverseSession::getExpansionWorkspaceOf(
+        const MultiBigramMap *const multiBigramMap) const {
+    for (const auto &workspace : mParallelExpansionWorkspaces) {
+        if (workspace->getMultiBigramMap() == multiBigramMap) {
+            return workspace.get();
+        }
+    }
+    return &mExpansionWorkspace;
+}
+
+void DicTraverseSession::updateReusableInputPrefixLength(const int *const inputCodePoints,
+        const int *const inputXs, const int *const inputYs, const int inputSize,
+        const int maxPointerCount) {
+    const bool isSingleTypingInput = maxPointerCount == 1 && inputSize <= MAX_WORD_LENGTH
+            && !(mSearchOptionFlags & SEARCH_OPTION_FLAG_IS_GESTURE) && inputCodePoints
+            && inputXs && inputYs;
+    mReusableInputPrefixLength = 0;
+    if (isSingleTypingInput && mIsSearchContextUnchanged) {
+        const int prefixLimit = std::min(inputSize, mPrevInputSize);
+        while (mReusableInputPrefixLength < prefixLimit
+                && mPrevInputCodePoints[mReusableInputPrefixLength]
+                        == inputCodePoints[mReusableInputPrefixLength]
+                && mPrevInputXs[mReusableInputPrefixLength] == inputXs[mReusableInputPrefixLength]
+                && mPrevInputYs[mReusableInputPrefixLength]
+                        == inputYs[mReusableInputPrefixLength]) {
+            ++mReusableInputPrefixLength;
+        }
+    }
+    if (!isSingleTypingInput) {
+        mPrevInputSize = 0;
+        return;
+    }
+    memmove(mPrevInputCodePoints, inputCodePoints, sizeof(mPrevInputCodePoints[0]) * inputSize);
+    memmove(mPrevInputXs, inputXs, sizeof(mPrevInputXs[0]) * inputSize);
+    memmove(mPrevInputYs, inputYs, sizeof(mPrevInputYs[0]) * inputSize);
+    mPrevInputSize = inputSize;
 }
 
 void DicTraverseSession::initializeProximityInfoStates(const int *const inputCodePoints,
@@ -17,43 +17,64 @@
 #ifndef LATINIME_DIC_TRAVERSE_SESSION_H
 #define LATINIME_DIC_TRAVERSE_SESSION_H
 
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "defines.h"
+#include "dictionary/property/ngram_context.h"
 #include "dictionary/utils/multi_bigram_map.h"
 #include "jni.h"
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_node_vector.h"
 #include "suggest/core/dicnode/dic_nodes_cache.h"
+#include "suggest/core/dictionary/completion_cache.h"
+#include "suggest/core/dictionary/digraph_utils.h"
 #include "suggest/core/layout/proximity_info_state.h"
+#include "suggest/core/session/expansion_workspace.h"
+#include "suggest/core/session/search_effort.h"
+#include "suggest/policyimpl/typing/typing_search_costs.h"
 #include "utils/int_array_view.h"
 
 namespace latinime {
 
 class Dictionary;
 class DictionaryStructureWithBufferPolicy;
-class NgramContext;
+class MemoryUsage;
 class ProximityInfo;
 class SuggestOptions;
 
 class DicTraverseSession {
  public:
-
     // A factory method for DicTraverseSession
-    static AK_FORCE_INLINE void *getSessionInstance(JNIEnv *env, jstring localeStr,
-            jlong dictSize) {
+    static AK_FORCE_INLINE DicTraverseSession *getSessionInstance(const jlong dictSize) {
         // To deal with the trade-off between accuracy and memory space, large cache is used for
         // dictionaries larger that the threshold
-        return new DicTraverseSession(env, localeStr,
-                dictSize >= DICTIONARY_SIZE_THRESHOLD_TO_USE_LARGE_CACHE_FOR_SUGGESTION);
+        return new DicTraverseSession(usesLargeCacheForDictionarySize(dictSize));
+    }
+
+    static AK_FORCE_INLINE bool usesLargeCacheForDictionarySize(const jlong dictSize) {
+        return dictSize >= DICTIONARY_SIZE_THRESHOLD_TO_USE_LARGE_CACHE_FOR_SUGGESTION;
     }
 
     static AK_FORCE_INLINE void releaseSessionInstance(DicTraverseSession *traverseSession) {
         delete traverseSession;
     }
 
-    AK_FORCE_INLINE DicTraverseSession(JNIEnv *env, jstring localeStr, bool usesLargeCache)
-            : mPrevWordIdCount(0), mProximityInfo(nullptr), mDictionary(nullptr),
-              mSuggestOptions(nullptr), mDicNodesCache(usesLargeCache), mMultiBigramMap(),
-              mInputSize(0), mMaxPointerCount(1), mMultiWordCostMultiplier(1.0f) {
+    AK_FORCE_INLINE explicit DicTraverseSession(const bool usesLargeCache)
+            : mPrevWordIdCount(0), mMaxNgramProbability(NOT_A_PROBABILITY),
+              mPrevWordIdsNgramContext(),
+              mPrevWordIdsDictionaryGeneration(0), mProximityInfo(nullptr), mDictionary(nullptr),
+              mDictionaryStructurePolicy(nullptr), mCompletionCache(nullptr),
+              mDictionaryGeneration(0), mSuggestOptions(nullptr), mDicNodesCache(usesLargeCache),
+              mExpansionWorkspace(false /* defersPushes */), mParallelExpansionWorkspaces(),
+              mPoppedActiveDicNodes(), mCompletionsBuffer(), mOutputTerminalDicNodes(),
+              mOutputUpperBoundScoreAndIndices(), mOutputWordIdAndScores(),
+              mInputSize(0), mMaxPointerCount(1), mMultiWordCostMultiplier(1.0f),
+              mDigraphType(DigraphUtils::DIGRAPH_TYPE_NONE), mTypingSearchCosts(),
+              mSearchOptionFlags(0), mWeightForLocale(0.0f), mIsSearchContextUnchanged(false),
+              mPrevInputSize(0),
+              mReusableInputPrefixLength(0) {
         // NOTE: mProximityInfoStates is an array of instances.
         // No need to initialize it explicitly here.
     }
@@ -61,17 +82,40 @@ class DicTraverseSession {
     // Non virtual inline destructor -- never inherit this class
     AK_FORCE_INLINE ~DicTraverseSession() {}
 
-    void init(const Dictionary *dictionary, const NgramContext *const ngramContext,
-            const SuggestOptions *const suggestOptions);
+    // dictionaryStructurePolicy is the policy of the dictionary that is used for the search. It
+    // has to stay unchanged until the search is finished.
+    void init(const Dictionary *dictionary,
+            const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
+            const NgramContext *const ngramContext, const SuggestOptions *const suggestOptions);
     // TODO: Remove and merge into init
     void setupForGetSuggestions(const ProximityInfo *pInfo, const int *inputCodePoints,
             const int inputSize, const int *const inputXs, const int *const inputYs,
             const int *const times, const int *const pointerIds, const float maxSpatialDistance,
             const int maxPointerCount);
     void resetCache(const int thresholdForNextActiveDicNodes, const int maxWords);
+    // Restarts the search from a DicNode snapshot of the previous search. Returns false when no
+    // usable snapshot exists.
+    bool restoreCacheFromSnapshot(const int thresholdForNextActiveDicNodes, const int maxWords,
+            const int maxInputIndex);
 
     const DictionaryStructureWithBufferPolicy *getDictionaryStructurePolicy() const;
 
+    // Adds the memory held by the session and its caches. Must not be called during a search.
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+
+    // Frees the DicNode pools, the snapshots and the temporary caches. They grow again on the
+    // next search, which starts from the root like after resetCache(). Must not be called during
+    // a search.
+    void trimMemory();
+
+    // Returns the DicNodes that are only used during a search to the DicNodeSlabAllocator, see
+    // DicNodesCache::releaseSearchQueues(). Must not be called during a search.
+    void releaseSearchQueues() { mDicNodesCache.releaseSearchQueues(); }
+
+    // Allocates the caches that trimMemory() frees at the largest size of a search, so that the
+    // next search doesn't allocate them. Must not be called during a search.
+    void preallocateCaches();
+
     //--------------------
     // getters and setters
     //--------------------
@@ -80,12 +124,50 @@ class DicTraverseSession {
     const WordIdArrayView getPrevWordIds() const {
         return WordIdArrayView::fromArray(mPrevWordIdArray).limit(mPrevWordIdCount);
     }
+    // Returns the largest raw n-gram probability of the words after getPrevWordIds(), or
+    // NOT_A_PROBABILITY when there are none.
+    int getMaxNgramProbability() const { return mMaxNgramProbability; }
+    // The completion cache of the dictionary, and the generation of the dictionary the search
+    // reads, which the cached completions are checked against.
+    CompletionCache *getCompletionCache() const { return mCompletionCache; }
+    uint64_t getDictionaryGeneration() const { return mDictionaryGeneration; }
     DicNodesCache *getDicTraverseCache() { return &mDicNodesCache; }
-    MultiBigramMap *getMultiBigramMap() { return &mMultiBigramMap; }
+    MultiBigramMap *getMultiBigramMap() { return mExpansionWorkspace.getMultiBigramMap(); }
+    // Returns the attributes of wordId after prevWordIds. They are memoised until the next search
+    // in the expansion workspace multiBigramMap belongs to.
+    const WordAttributes getWordAttributesInContext(const WordIdArrayView prevWordIds,
+            const int wordId, MultiBigramMap *const multiBigramMap) const {
+        return getExpansionWorkspaceOf(multiBigramMap)->getWordAttributesCache()
+                ->getWordAttributes(mDictionaryStructurePolicy, prevWordIds, wordId,
+                        multiBigramMap);
+    }
+    // The workspace of the serial expansion.
+    ExpansionWorkspace *getExpansionWorkspace() { return &mExpansionWorkspace; }
+    // Returns the deferring workspace of the taskIndex-th task of the parallel expansion. Must not
+    // be called while the tasks are running.
+    ExpansionWorkspace *getParallelExpansionWorkspace(const int taskIndex);
+    // Buffer for the active DicNodes that are popped to be expanded.
+    std::vector<DicNode> *getPoppedActiveDicNodes() { return &mPoppedActiveDicNodes; }
+    // Buffer for the completions the popped DicNodes are looked up with. It keeps its capacity,
+    // so that the cache hits don't allocate.
+    CompletionCache::Completions *getCompletionsBuffer() { return &mCompletionsBuffer; }
+    // Buffers of SuggestionsOutputUtils::outputSuggestions(). They keep their capacity between
+    // searches, so outputting the suggestions does not allocate once they have grown.
+    std::vector<DicNode> *getOutputTerminalDicNodes() { return &mOutputTerminalDicNodes; }
+    std::vector<std::pair<int, int>> *getOutputUpperBoundScoreAndIndices() {
+        return &mOutputUpperBoundScoreAndIndices;
+    }
+    std::vector<std::pair<int, int>> *getOutputWordIdAndScores() {
+        return &mOutputWordIdAndScores;
+    }
     const ProximityInfoState *getProximityInfoState(int id) const {
         return &mProximityInfoStates[id];
     }
     int getInputSize() const { return mInputSize; }
+    // Returns the length of the input prefix that is identical to the input of the previous search
+    // on this session with the same dictionary, context and options. Always 0 for gestures.
+    int getReusableInputPrefixLength() const { return mReusableInputPrefixLength; }
+    const SearchEffort &getSearchEffort() const { return mDicNodesCache.getSearchEffort(); }
 
     bool isOnlyOnePointerUsed(int *pointerId) const {
         // Not in the dictionary word
@@ -157,24 +239,56 @@ class DicTraverseSession {
         return mMultiWordCostMultiplier;
     }
 
+    // The digraph type of the dictionary, resolved from its header in init().
+    DigraphUtils::DigraphType getDigraphType() const {
+        return mDigraphType;
+    }
+
+    // The typing costs of this search, computed in setupForGetSuggestions().
+    const TypingSearchCosts *getTypingSearchCosts() const {
+        return &mTypingSearchCosts;
+    }
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(DicTraverseSession);
     // threshold to start caching
     static const int CACHE_START_INPUT_LENGTH_THRESHOLD;
     static const int DICTIONARY_SIZE_THRESHOLD_TO_USE_LARGE_CACHE_FOR_SUGGESTION;
+    static const int SEARCH_OPTION_FLAG_IS_GESTURE;
+    static const int SEARCH_OPTION_FLAG_USE_FULL_EDIT_DISTANCE;
+    static const int SEARCH_OPTION_FLAG_BLOCK_OFFENSIVE_WORDS;
     void initializeProximityInfoStates(const int *const inputCodePoints, const int *const inputXs,
             const int *const inputYs, const int *const times, const int *const pointerIds,
             const int inputSize, const float maxSpatialDistance, const int maxPointerCount);
+    void updateReusableInputPrefixLength(const int *const inputCodePoints,
+            const int *const inputXs, const int *const inputYs, const int inputSize,
+            const int maxPointerCount);
+    ExpansionWorkspace *getExpansionWorkspaceOf(const MultiBigramMap *const multiBigramMap) const;
 
     WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> mPrevWordIdArray;
     size_t mPrevWordIdCount;
+    int mMaxNgramProbability;
+    // The context and the dictionary generation that mPrevWordIdArray was resolved for. The
+    // context doesn't change while a word is typed, so the lookups are done once per word.
+    std::unique_ptr<NgramContext> mPrevWordIdsNgramContext;
+    uint64_t mPrevWordIdsDictionaryGeneration;
     const ProximityInfo *mProximityInfo;
     const Dictionary *mDictionary;
+    const DictionaryStructureWithBufferPolicy *mDictionaryStructurePolicy;
+    CompletionCache *mCompletionCache;
+    uint64_t mDictionaryGeneration;
     const SuggestOptions *mSuggestOptions;
 
     DicNodesCache mDicNodesCache;
-    // Temporary cache for bigram frequencies
-    MultiBigramMap mMultiBigramMap;
+    // The memos of the workspaces are written while scoring from const contexts.
+    mutable ExpansionWorkspace mExpansionWorkspace;
+    // Created on the first parallel expansion.
+    std::vector<std::unique_ptr<ExpansionWorkspace>> mParallelExpansionWorkspaces;
+    std::vector<DicNode> mPoppedActiveDicNodes;
+    CompletionCache::Completions mCompletionsBuffer;
+    std::vector<DicNode> mOutputTerminalDicNodes;
+    std::vector<std::pair<int, int>> mOutputUpperBoundScoreAndIndices;
+    std::vector<std::pair<int, int>> mOutputWordIdAndScores;
     ProximityInfoState mProximityInfoStates[MAX_POINTER_COUNT_G];
 
     int mInputSize;
@@ -183,7 +297,22 @@ class DicTraverseSession {
     /////////////////////////////////
     // Configuration per dictionary
     float mMultiWordCostMultiplier;
+    DigraphUtils::DigraphType mDigraphType;
+
+    /////////////////////////////////
+    // Configuration per search
+    TypingSearchCosts mTypingSearchCosts;
 
+    /////////////////////////////////
+    // Previous search on this session, used to reuse DicNodes for an edited input
+    int mSearchOptionFlags;
+    float mWeightForLocale;
+    bool mIsSearchContextUnchanged;
+    int mPrevInputCodePoints[MAX_WORD_LENGTH];
+    int mPrevInputXs[MAX_WORD_LENGTH];
+    int mPrevInputYs[MAX_WORD_LENGTH];
+    int mPrevInputSize;
+    int mReusableInputPrefixLength;
 };
 } // namespace latinime
 #endif // LATINIME_DIC_TRAVERSE_SESSION_H
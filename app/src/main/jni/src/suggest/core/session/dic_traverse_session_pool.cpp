@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/session/dic_traverse_session_pool.h"
+
+#include "suggest/core/session/dic_traverse_session.h"
+#include "utils/memory_usage.h"
+
+namespace latinime {
+
+// Enough for the typing, prediction and spell checker threads to run at the same time.
+const int DicTraverseSessionPool::MAX_IDLE_SESSION_COUNT = 4;
+
+DicTraverseSessionPool::DicTraverseSessionPool(const bool usesLargeCache)
+        : mUsesLargeCache(usesLargeCache), mMutex(), mIdleSessions(),
+          mCreatedSessionCount(0) {}
+
+DicTraverseSessionPool::~DicTraverseSessionPool() {
+    if (mCreatedSessionCount != static_cast<int>(mIdleSessions.size())) {
+        AKLOGE("DicTraverseSessionPool is destroyed while %d sessions are leased.",
+                mCreatedSessionCount - static_cast<int>(mIdleSessions.size()));
+        ASSERT(false);
+    }
+}
+
+DicTraverseSession *DicTraverseSessionPool::acquireSession() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mIdleSessions.empty()) {
+            DicTraverseSession *const session = mIdleSessions.back().release();
+            mIdleSessions.pop_back();
+            return session;
+        }
+        ++mCreatedSessionCount;
+    }
+    // Create the session outside the lock; its caches are relatively large.
+    return new DicTraverseSession(mUsesLargeCache);
+}
+
+void DicTraverseSessionPool::releaseSession(DicTraverseSession *const session) {
+    if (!session) {
+        return;
+    }
+    std::unique_ptr<DicTraverseSession> sessionPtr(session);
+    // An idle session only keeps what the next search may continue from.
+    session->releaseSearchQueues();
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (static_cast<int>(mIdleSessions.size()) >= MAX_IDLE_SESSION_COUNT) {
+        --mCreatedSessionCount;
+        // sessionPtr deletes the session.
+        return;
+    }
+    mIdleSessions.emplace_back(std::move(sessionPtr));
+}
+
+int DicTraverseSessionPool::getCreatedSessionCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCreatedSessionCount;
+}
+
+int DicTraverseSessionPool::getIdleSessionCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return static_cast<int>(mIdleSessions.size());
+}
+
+void DicTraverseSessionPool::addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    outMemoryUsage->addVector(MemoryUsage::HEAP_BYTES, mIdleSessions);
+    for (const auto &session : mIdleSessions) {
+        session->addMemoryUsage(outMemoryUsage);
+    }
+}
+
+void DicTraverseSessionPool::trimMemory(const bool deletesIdleSessions) {
+    std::vector<std::unique_ptr<DicTraverseSession>> deletedSessions;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (deletesIdleSessions) {
+            mCreatedSessionCount -= static_cast<int>(mIdleSessions.size());
+            deletedSessions.swap(mIdleSessions);
+        } else {
+            for (const auto &session : mIdleSessions) {
+                session->trimMemory();
+            }
+        }
+    }
+    // deletedSessions deletes the sessions outside the lock.
+}
+
+} // namespace latinime
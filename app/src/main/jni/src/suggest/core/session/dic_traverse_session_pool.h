@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_DIC_TRAVERSE_SESSION_POOL_H
+#define LATINIME_DIC_TRAVERSE_SESSION_POOL_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "defines.h"
+
+namespace latinime {
+
+class DicTraverseSession;
+class MemoryUsage;
+
+/**
+ * A pool of DicTraverseSession instances that are leased for the duration of a single search.
+ *
+ * All mutable search state lives in DicTraverseSession, so concurrent searches on the same
+ * dictionary are possible as long as each thread uses its own session. This pool hands out an
+ * idle session (or creates a new one) per call and takes it back afterwards. Note that sessions
+ * returned to the pool keep the cached DicNodes of their DicNodesCache, so continuous suggestion
+ * is only effective when sequential calls happen to lease the same session. The DicNodes of the
+ * other queues go back to the DicNodeSlabAllocator until the session is leased again.
+ */
+class DicTraverseSessionPool {
+ public:
+    // RAII helper that leases a session from the pool and returns it on destruction.
+    class ScopedSession {
+     public:
+        explicit ScopedSession(DicTraverseSessionPool *const pool)
+                : mPool(pool), mSession(pool->acquireSession()) {}
+
+        ~ScopedSession() {
+            mPool->releaseSession(mSession);
+        }
+
+        DicTraverseSession *get() const { return mSession; }
+
+     private:
+        DISALLOW_IMPLICIT_CONSTRUCTORS(ScopedSession);
+
+        DicTraverseSessionPool *const mPool;
+        DicTraverseSession *const mSession;
+    };
+
+    explicit DicTraverseSessionPool(const bool usesLargeCache);
+    ~DicTraverseSessionPool();
+
+    // Returns an idle session or a newly created one. Never returns nullptr.
+    DicTraverseSession *acquireSession();
+    void releaseSession(DicTraverseSession *const session);
+
+    int getCreatedSessionCount() const;
+    int getIdleSessionCount() const;
+    // Adds the memory held by the idle sessions. Leased sessions are in use and not counted.
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const;
+    // Trims the caches of the idle sessions, or deletes them when deletesIdleSessions is true.
+    // Leased sessions are in use and not touched.
+    void trimMemory(const bool deletesIdleSessions);
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(DicTraverseSessionPool);
+
+    // Idle sessions beyond this count are deleted instead of being kept in the pool.
+    static const int MAX_IDLE_SESSION_COUNT;
+
+    const bool mUsesLargeCache;
+    mutable std::mutex mMutex;
+    std::vector<std::unique_ptr<DicTraverseSession>> mIdleSessions;
+    int mCreatedSessionCount;
+};
+} // namespace latinime
+#endif // LATINIME_DIC_TRAVERSE_SESSION_POOL_H
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_EXPANSION_WORKSPACE_H
+#define LATINIME_EXPANSION_WORKSPACE_H
+
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/utils/multi_bigram_map.h"
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_node_vector.h"
+#include "suggest/core/dicnode/dic_nodes_cache.h"
+#include "suggest/core/session/word_attributes_cache.h"
+#include "utils/memory_usage.h"
+
+namespace latinime {
+
+// The buffers and memos a thread uses to expand DicNodes. A DicTraverseSession has one for the
+// serial expansion and one per task of the parallel expansion, so that the tasks share no mutable
+// state. A deferring workspace keeps the DicNodes it would push into the DicNodesCache until
+// flushTo() is called; the queues of the cache are only written by one thread at a time.
+class ExpansionWorkspace {
+ public:
+    // Ids of the DicNodeVectors that are used at the same time while expanding a DicNode.
+    static const int CHILD_DIC_NODES_FOR_EXPANSION = 0;
+    static const int CHILD_DIC_NODES_FOR_OMISSION = 1;
+    static const int CHILD_DIC_NODES_FOR_INSERTION = 2;
+    static const int CHILD_DIC_NODES_FOR_TRANSPOSITION_FIRST = 3;
+    static const int CHILD_DIC_NODES_FOR_TRANSPOSITION_SECOND = 4;
+    static const int CHILD_DIC_NODES_BUFFER_COUNT = 5;
+
+    explicit ExpansionWorkspace(const bool defersPushes)
+            : mDefersPushes(defersPushes), mChildDicNodesBuffers(), mMultiBigramMap(),
+              mWordAttributesCache(), mDeferredNextActiveDicNodes(), mDeferredTerminalDicNodes(),
+              mDeferredTerminalCandidates() {}
+
+    // Returns a cleared DicNodeVector to collect child DicNodes. The buffers keep their capacity
+    // between expansions, so collecting children does not allocate once they have grown.
+    DicNodeVector *getChildDicNodesBuffer(const int bufferId) {
+        ASSERT(0 <= bufferId && bufferId < CHILD_DIC_NODES_BUFFER_COUNT);
+        DicNodeVector *const buffer = &mChildDicNodesBuffers[bufferId];
+        buffer->clear();
+        return buffer;
+    }
+
+    MultiBigramMap *getMultiBigramMap() { return &mMultiBigramMap; }
+    WordAttributesCache *getWordAttributesCache() { return &mWordAttributesCache; }
+
+    AK_FORCE_INLINE void copyPushNextActive(DicNodesCache *const cache, DicNode *const dicNode) {
+        if (mDefersPushes) {
+            mDeferredNextActiveDicNodes.emplace_back(*dicNode);
+        } else {
+            cache->copyPushNextActive(dicNode);
+        }
+    }
+
+    AK_FORCE_INLINE void copyPushTerminal(DicNodesCache *const cache, DicNode *const dicNode) {
+        if (mDefersPushes) {
+            mDeferredTerminalDicNodes.emplace_back(*dicNode);
+        } else {
+            cache->copyPushTerminal(dicNode);
+        }
+    }
+
+    AK_FORCE_INLINE void copyPushTerminalCandidate(DicNodesCache *const cache,
+            const DicNode *const dicNode) {
+        if (mDefersPushes) {
+            mDeferredTerminalCandidates.emplace_back(*dicNode);
+        } else {
+            cache->copyPushTerminalCandidate(dicNode);
+        }
+    }
+
+    // Pushes the deferred DicNodes into the cache in the order they were recorded.
+    void flushTo(DicNodesCache *const cache) {
+        for (DicNode &dicNode : mDeferredNextActiveDicNodes) {
+            cache->copyPushNextActive(&dicNode);
+        }
+        for (DicNode &dicNode : mDeferredTerminalDicNodes) {
+            cache->copyPushTerminal(&dicNode);
+        }
+        for (const DicNode &dicNode : mDeferredTerminalCandidates) {
+            cache->copyPushTerminalCandidate(&dicNode);
+        }
+        mDeferredNextActiveDicNodes.clear();
+        mDeferredTerminalDicNodes.clear();
+        mDeferredTerminalCandidates.clear();
+    }
+
+    // Clears the memos, which are only valid for one search.
+    void clearCaches() {
+        mMultiBigramMap.clear();
+        mWordAttributesCache.clear();
+    }
+
+    void clearWordAttributesCache() {
+        mWordAttributesCache.clear();
+    }
+
+    // Same as clearCaches(), and frees the buffers.
+    void release() {
+        mMultiBigramMap.release();
+        mWordAttributesCache.clear();
+        for (int i = 0; i < CHILD_DIC_NODES_BUFFER_COUNT; ++i) {
+            mChildDicNodesBuffers[i].release();
+        }
+        std::vector<DicNode>().swap(mDeferredNextActiveDicNodes);
+        std::vector<DicNode>().swap(mDeferredTerminalDicNodes);
+        std::vector<DicNode>().swap(mDeferredTerminalCandidates);
+    }
+
+    void addMemoryUsage(MemoryUsage *const outMemoryUsage) const {
+        mMultiBigramMap.addMemoryUsage(outMemoryUsage);
+        for (int i = 0; i < CHILD_DIC_NODES_BUFFER_COUNT; ++i) {
+            mChildDicNodesBuffers[i].addMemoryUsage(outMemoryUsage);
+        }
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mDeferredNextActiveDicNodes);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mDeferredTerminalDicNodes);
+        outMemoryUsage->addVector(MemoryUsage::CACHE_BYTES, mDeferredTerminalCandidates);
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(ExpansionWorkspace);
+
+    const bool mDefersPushes;
+    DicNodeVector mChildDicNodesBuffers[CHILD_DIC_NODES_BUFFER_COUNT];
+    // Temporary cache for bigram frequencies
+    MultiBigramMap mMultiBigramMap;
+    WordAttributesCache mWordAttributesCache;
+    std::vector<DicNode> mDeferredNextActiveDicNodes;
+    std::vector<DicNode> mDeferredTerminalDicNodes;
+    std::vector<DicNode> mDeferredTerminalCandidates;
+};
+} // namespace latinime
+#endif // LATINIME_EXPANSION_WORKSPACE_H
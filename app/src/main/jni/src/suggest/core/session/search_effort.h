@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_SEARCH_EFFORT_H
+#define LATINIME_SEARCH_EFFORT_H
+
+#include "defines.h"
+
+namespace latinime {
+
+// Counts the work done by one search, so that the latency can be put in relation to the search
+// effort and the beam sizes can be tuned. Unlike DicNodeProfiler, it is kept in every build.
+class SearchEffort {
+ public:
+    // Must be equal to the SEARCH_EFFORT_* constants in DicTraverseSession.java
+    enum Counter {
+        // DicNodes pushed to the active, next active and terminal queues.
+        PUSHED_DIC_NODES = 0,
+        // DicNodes popped from the active queue.
+        POPPED_DIC_NODES,
+        // DicNodes dropped because a queue was full, either the pushed one or the worst one.
+        EVICTED_DIC_NODES,
+        // DicNodes cached to continue the search on the next keystroke.
+        CACHED_DIC_NODES_FOR_CONTINUATION,
+        // DicNodes whose children were looked up.
+        EXPANDED_DIC_NODES,
+        // DicNodes dropped in favor of an equivalent, not more costly next active DicNode.
+        RECOMBINED_DIC_NODES,
+        COUNTER_COUNT
+    };
+
+    SearchEffort() : mCounts() {}
+
+    void reset() {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            mCounts[i] = 0;
+        }
+    }
+
+    AK_FORCE_INLINE void increment(const Counter counter) {
+        ++mCounts[counter];
+    }
+
+    AK_FORCE_INLINE void add(const Counter counter, const int count) {
+        mCounts[counter] += count;
+    }
+
+    void add(const SearchEffort &searchEffort) {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            mCounts[i] += searchEffort.mCounts[i];
+        }
+    }
+
+    int get(const Counter counter) const {
+        return mCounts[counter];
+    }
+
+    // outCounts must have room for COUNTER_COUNT values.
+    void copyTo(int *const outCounts) const {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            outCounts[i] = mCounts[i];
+        }
+    }
+
+ private:
+    int mCounts[COUNTER_COUNT];
+};
+} // namespace latinime
+#endif // LATINIME_SEARCH_EFFORT_H
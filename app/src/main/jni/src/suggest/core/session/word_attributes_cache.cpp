@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "suggest/core/session/word_attributes_cache.h"
+
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+
+namespace latinime {
+
+const WordAttributes WordAttributesCache::getWordAttributes(
+        const DictionaryStructureWithBufferPolicy *const structurePolicy,
+        const WordIdArrayView prevWordIds, const int wordId,
+        MultiBigramMap *const multiBigramMap) {
+    if (prevWordIds.size() > static_cast<size_t>(MAX_PREV_WORD_COUNT_FOR_N_GRAM)) {
+        return structurePolicy->getWordAttributesInContext(prevWordIds, wordId, multiBigramMap);
+    }
+    Entry &entry = mEntries[getEntryPos(prevWordIds, wordId)];
+    if (isMatchingEntry(entry, prevWordIds, wordId)) {
+        return WordAttributes(entry.mProbability, entry.mIsBlacklisted, entry.mIsNotAWord,
+                entry.mIsPossiblyOffensive);
+    }
+    const WordAttributes wordAttributes =
+            structurePolicy->getWordAttributesInContext(prevWordIds, wordId, multiBigramMap);
+    entry.mGeneration = mGeneration;
+    entry.mWordId = wordId;
+    prevWordIds.copyToArray(&entry.mPrevWordIds, 0 /* offset */);
+    entry.mPrevWordIdCount = prevWordIds.size();
+    entry.mProbability = wordAttributes.getProbability();
+    entry.mIsBlacklisted = wordAttributes.isBlacklisted();
+    entry.mIsNotAWord = wordAttributes.isNotAWord();
+    entry.mIsPossiblyOffensive = wordAttributes.isPossiblyOffensive();
+    return wordAttributes;
+}
+
+void WordAttributesCache::clear() {
+    ++mGeneration;
+    if (mGeneration == 0) {
+        // The generation wrapped around. Entries of old generations could match again.
+        for (Entry &entry : mEntries) {
+            entry.mGeneration = 0;
+        }
+        mGeneration = 1;
+    }
+}
+
+/* static */ int WordAttributesCache::getEntryPos(const WordIdArrayView prevWordIds,
+        const int wordId) {
+    uint32_t hash = static_cast<uint32_t>(wordId);
+    for (const int prevWordId : prevWordIds) {
+        hash = hash * 31 + static_cast<uint32_t>(prevWordId);
+    }
+    // Take the upper bits of a multiplicative hash, as word ids are often close to each other.
+    return static_cast<int>((hash * 0x9E3779B9u) >> 24) & (ENTRY_COUNT - 1);
+}
+
+bool WordAttributesCache::isMatchingEntry(const Entry &entry, const WordIdArrayView prevWordIds,
+        const int wordId) const {
+    if (entry.mGeneration != mGeneration || entry.mWordId != wordId
+            || entry.mPrevWordIdCount != static_cast<int>(prevWordIds.size())) {
+        return false;
+    }
+    for (size_t i = 0; i < prevWordIds.size(); ++i) {
+        if (entry.mPrevWordIds[i] != prevWordIds[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace latinime
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef LATINIME_WORD_ATTRIBUTES_CACHE_H
+#define LATINIME_WORD_ATTRIBUTES_CACHE_H
+
+#include <cstdint>
+
+#include "defines.h"
+#include "dictionary/property/word_attributes.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+class DictionaryStructureWithBufferPolicy;
+class MultiBigramMap;
+
+// Direct-mapped memo of the attributes of words in their contexts. One search looks up the same
+// word in the same context for many DicNodes, and the n-gram backoff is redone every time. The
+// memo has to be cleared before every search because the dictionary can be updated in between.
+class WordAttributesCache {
+ public:
+    WordAttributesCache() : mGeneration(1), mEntries() {}
+
+    // Returns the attributes of wordId after prevWordIds, reading them from structurePolicy when
+    // they are not memoised.
+    const WordAttributes getWordAttributes(
+            const DictionaryStructureWithBufferPolicy *const structurePolicy,
+            const WordIdArrayView prevWordIds, const int wordId,
+            MultiBigramMap *const multiBigramMap);
+
+    void clear();
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(WordAttributesCache);
+
+    // WordAttributes can't be assigned, so its fields are kept separately.
+    struct Entry {
+        uint32_t mGeneration;
+        int mWordId;
+        WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> mPrevWordIds;
+        int mPrevWordIdCount;
+        int mProbability;
+        bool mIsBlacklisted;
+        bool mIsNotAWord;
+        bool mIsPossiblyOffensive;
+    };
+
+    // Has to be a power of 2.
+    static const int ENTRY_COUNT = 256;
+
+    static int getEntryPos(const WordIdArrayView prevWordIds, const int wordId);
+    bool isMatchingEntry(const Entry &entry, const WordIdArrayView prevWordIds,
+            const int wordId) const;
+
+    // Entries of older generations are regarded as empty, so that clearing is cheap.
+    uint32_t mGeneration;
+    Entry mEntries[ENTRY_COUNT];
+};
+} // namespace latinime
+#endif // LATINIME_WORD_ATTRIBUTES_CACHE_H
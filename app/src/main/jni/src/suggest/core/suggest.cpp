@@ -16,41 +16,79 @@
 
 #include "suggest/core/suggest.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
 #include "dictionary/property/word_attributes.h"
+#include "suggest/core/dicnode/child_dic_node_filter.h"
 #include "suggest/core/dicnode/dic_node.h"
 #include "suggest/core/dicnode/dic_node_priority_queue.h"
 #include "suggest/core/dicnode/dic_node_vector.h"
+#include "suggest/core/dictionary/completion_cache.h"
 #include "suggest/core/dictionary/dictionary.h"
 #include "suggest/core/dictionary/digraph_utils.h"
+#include "suggest/core/dictionary/error_type_utils.h"
 #include "suggest/core/layout/proximity_info.h"
+#include "suggest/core/layout/proximity_info_state.h"
 #include "suggest/core/policy/traversal.h"
 #include "suggest/core/policy/weighting.h"
+#include "suggest/core/result/suggestion_results.h"
 #include "suggest/core/result/suggestions_output_utils.h"
 #include "suggest/core/session/dic_traverse_session.h"
+#include "suggest/core/session/expansion_workspace.h"
 #include "suggest/core/suggest_options.h"
-#include "utils/profiler.h"
+#include "suggest/policyimpl/typing/typing_traversal.h"
+#include "suggest/policyimpl/typing/typing_weighting.h"
+#include "utils/native_metrics.h"
+#include "utils/native_trace.h"
+#include "utils/time_keeper.h"
+#include "utils/worker_thread_pool.h"
 
 namespace latinime {
 
 // Initialization of class constants.
-const int Suggest::MIN_CONTINUOUS_SUGGESTION_INPUT_SIZE = 2;
+template<class TraversalType, class WeightingType>
+const int SuggestImpl<TraversalType, WeightingType>::MIN_CONTINUOUS_SUGGESTION_INPUT_SIZE = 2;
+// Larger than the distance difference DicNode::compare() regards as a tie.
+template<class TraversalType, class WeightingType>
+const float SuggestImpl<TraversalType, WeightingType>::TERMINAL_CUTOFF_MARGIN = 0.00001f;
+// Enough to keep a few cores busy without waiting on each other for the workspaces to flush.
+template<class TraversalType, class WeightingType>
+const int SuggestImpl<TraversalType, WeightingType>::MAX_PARALLEL_EXPANSION_TASK_COUNT = 4;
+// Fewer nodes are expanded faster on the calling thread than handed to the workers.
+template<class TraversalType, class WeightingType>
+const int SuggestImpl<TraversalType, WeightingType>::MIN_DIC_NODE_COUNT_PER_EXPANSION_TASK = 32;
+// About the number of dicNodes expanded while a child PtNode array is fetched from memory.
+template<class TraversalType, class WeightingType>
+const int SuggestImpl<TraversalType, WeightingType>::PREFETCH_DIC_NODE_DISTANCE = 4;
+// As many as the terminal queue keeps.
+template<class TraversalType, class WeightingType>
+const int SuggestImpl<TraversalType, WeightingType>::MAX_CACHED_COMPLETION_COUNT = MAX_RESULTS;
+// About the DicNodes a few completion rounds of the search expand below a short prefix. Larger
+// subtrees are expanded by the search, which prunes them.
+template<class TraversalType, class WeightingType>
+const int SuggestImpl<TraversalType, WeightingType>::MAX_COMPLETION_SUBTREE_SIZE = 256;
 
 /**
  * Returns a set of suggestions for the given input touch points. The commitPoint argument indicates
  * whether to prematurely commit the suggested words up to the given point for sentence-level
  * suggestion.
  *
- * Note: Currently does not support concurrent calls across threads. Continuous suggestion is
- * automatically activated for sequential calls that share the same starting input.
+ * Note: Suggest and the suggest policies hold no mutable state; all search state lives in the
+ * given traverseSession. The only exceptions are the process-wide typing beam width and
+ * degradation level (see TypingBeamWidthTuner and TypingLatencyGuard), which are kept in atomics
+ * and read without locking. Concurrent calls across threads are therefore supported
+ * as long as each thread uses its own session (see DicTraverseSessionPool). Continuous suggestion is automatically
+ * activated for sequential calls on the same session that share the same starting input.
  * TODO: Stop detecting continuous suggestion. Start using traverseSession instead.
  */
-void Suggest::getSuggestions(ProximityInfo *pInfo, void *traverseSession,
-        int *inputXs, int *inputYs, int *times, int *pointerIds, int *inputCodePoints,
-        int inputSize, const float weightOfLangModelVsSpatialModel,
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::getSuggestions(ProximityInfo *pInfo,
+        void *traverseSession, int *inputXs, int *inputYs, int *times, int *pointerIds,
+        int *inputCodePoints, int inputSize, const float weightOfLangModelVsSpatialModel,
         SuggestionResults *const outSuggestionResults) const {
-    PROF_INIT;
-    PROF_TIMER_START(0);
+    const int64_t setupStartTime = TimeKeeper::getMonotonicTimeInMicroseconds();
     const float maxSpatialDistance = TRAVERSAL->getMaxSpatialDistance();
     DicTraverseSession *tSession = static_cast<DicTraverseSession *>(traverseSession);
     tSession->setupForGetSuggestions(pInfo, inputCodePoints, inputSize, inputXs, inputYs, times,
@@ -58,57 +96,114 @@ void Suggest::getSuggestions(ProximityInfo *pInfo, void *traverseSession,
     // TODO: Add the way to evaluate cache
 
     initializeSearch(tSession);
-    PROF_TIMER_END(0);
-    PROF_TIMER_START(1);
+    const int64_t expandStartTime = TimeKeeper::getMonotonicTimeInMicroseconds();
+    NativeMetrics::record(NativeMetrics::METRIC_SUGGEST_SETUP, expandStartTime - setupStartTime);
 
+    const int searchTimeLimit = tSession->getSuggestOptions()->getSearchTimeLimitInMicroseconds();
+    const int64_t searchDeadline = searchTimeLimit > 0 ? expandStartTime + searchTimeLimit : 0;
     // keep expanding search dicNodes until all have terminated.
     while (tSession->getDicTraverseCache()->activeSize() > 0) {
         expandCurrentDicNodes(tSession);
         tSession->getDicTraverseCache()->advanceActiveDicNodes();
         tSession->getDicTraverseCache()->advanceInputIndex(inputSize);
+        if (searchDeadline > 0 && tSession->getDicTraverseCache()->activeSize() > 0
+                && TimeKeeper::getMonotonicTimeInMicroseconds() >= searchDeadline) {
+            // Out of time; output the terminals found so far.
+            if (DEBUG_DICT) {
+                AKLOGI("Search time limit (%d us) reached.", searchTimeLimit);
+            }
+            break;
+        }
     }
-    PROF_TIMER_END(1);
-    PROF_TIMER_START(2);
+    const int64_t outputStartTime = TimeKeeper::getMonotonicTimeInMicroseconds();
+    NativeMetrics::record(NativeMetrics::METRIC_SUGGEST_EXPAND, outputStartTime - expandStartTime);
     SuggestionsOutputUtils::outputSuggestions(
             SCORING, tSession, weightOfLangModelVsSpatialModel, outSuggestionResults);
-    PROF_TIMER_END(2);
+    outSuggestionResults->addSearchEffort(tSession->getSearchEffort());
+    NativeMetrics::record(NativeMetrics::METRIC_SUGGEST_OUTPUT,
+            TimeKeeper::getMonotonicTimeInMicroseconds() - outputStartTime);
 }
 
 /**
  * Initializes the search at the root of the lexicon trie. Note that when possible the search will
  * continue suggestion from where it left off during the last call.
  */
-void Suggest::initializeSearch(DicTraverseSession *traverseSession) const {
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::initializeSearch(
+        DicTraverseSession *traverseSession) const {
+    const NativeTrace::ScopedSection section("Suggest::initializeSearch");
     if (!traverseSession->getProximityInfoState(0)->isUsed()) {
         return;
     }
 
+    const int maxCacheSize = TRAVERSAL->getMaxCacheSizeForInput(traverseSession,
+            TRAVERSAL->getMaxCacheSize(traverseSession->getInputSize(),
+                    traverseSession->getSuggestOptions()->weightForLocale()));
     if (traverseSession->getInputSize() > MIN_CONTINUOUS_SUGGESTION_INPUT_SIZE
             && traverseSession->isContinuousSuggestionPossible()) {
         // Continue suggestion
-        traverseSession->getDicTraverseCache()->continueSearch();
-    } else {
-        // Restart recognition at the root.
-        traverseSession->resetCache(TRAVERSAL->getMaxCacheSize(traverseSession->getInputSize(),
-                traverseSession->getSuggestOptions()->weightForLocale()),
-                TRAVERSAL->getTerminalCacheSize());
-        // Create a new dic node here
-        DicNode rootNode;
-        DicNodeUtils::initAsRoot(traverseSession->getDictionaryStructurePolicy(),
-                traverseSession->getPrevWordIds(), &rootNode);
-        traverseSession->getDicTraverseCache()->copyPushActive(&rootNode);
+        traverseSession->getDicTraverseCache()->continueSearch(maxCacheSize);
+        restoreTerminalDicNodesFromCandidates(traverseSession);
+        return;
+    }
+    // When the input was edited (e.g. a backspace followed by another letter), restart from the
+    // DicNodes of the previous search at an input index before the first changed input point.
+    // The same margin as the continuous suggestion cache is kept, since DicNodes close to the end
+    // of the input depend on the input size.
+    const int maxRestoredInputIndex = traverseSession->getReusableInputPrefixLength()
+            - traverseSession->getDicTraverseCache()->getCacheBackLength();
+    if (maxRestoredInputIndex > 0 && traverseSession->restoreCacheFromSnapshot(maxCacheSize,
+            TRAVERSAL->getTerminalCacheSize(), maxRestoredInputIndex)) {
+        restoreTerminalDicNodesFromCandidates(traverseSession);
+        return;
+    }
+    // Restart recognition at the root.
+    traverseSession->resetCache(maxCacheSize, TRAVERSAL->getTerminalCacheSize());
+    // Create a new dic node here
+    DicNode rootNode;
+    DicNodeUtils::initAsRoot(traverseSession->getDictionaryStructurePolicy(),
+            traverseSession->getPrevWordIds(), &rootNode);
+    traverseSession->getDicTraverseCache()->copyPushActive(&rootNode);
+}
+
+/**
+ * Recreates the terminals found before the input index the search continues from, which are not
+ * found again. Their terminal costs grow by the same amount for each added input point, so the
+ * candidates that don't make it into a full terminal queue never will and are dropped.
+ */
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::restoreTerminalDicNodesFromCandidates(
+        DicTraverseSession *traverseSession) const {
+    DicNodesCache *const cache = traverseSession->getDicTraverseCache();
+    ExpansionWorkspace *const workspace = traverseSession->getExpansionWorkspace();
+    for (int i = 0; i < cache->getTerminalCandidateCount(); ++i) {
+        DicNode terminalDicNode;
+        if (createTerminalDicNode(traverseSession, workspace, cache->getTerminalCandidateAt(i),
+                &terminalDicNode)) {
+            cache->copyPushTerminal(&terminalDicNode);
+        }
+    }
+    const DicNode *const cutoffDicNode = cache->getTerminalCutoffDicNode();
+    if (!cutoffDicNode) {
+        return;
     }
+    const DicNode cutoffTerminalDicNode(*cutoffDicNode);
+    cache->removeTerminalCandidates([this, traverseSession, workspace, &cutoffTerminalDicNode](
+            const DicNode *const dicNode) {
+        DicNode terminalDicNode;
+        return !createTerminalDicNode(traverseSession, workspace, dicNode, &terminalDicNode)
+                || cutoffTerminalDicNode.compare(&terminalDicNode);
+    });
 }
 
 /**
  * Expands the dicNodes in the current search priority queue by advancing to the possible child
  * nodes based on the next touch point(s) (or no touch points for lookahead)
  */
-void Suggest::expandCurrentDicNodes(DicTraverseSession *traverseSession) const {
-    const int inputSize = traverseSession->getInputSize();
-    DicNodeVector childDicNodes(TRAVERSAL->getDefaultExpandDicNodeSize());
-    DicNode correctionDicNode;
-
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::expandCurrentDicNodes(
+        DicTraverseSession *traverseSession) const {
+    const NativeTrace::ScopedSection section("Suggest::expandCurrentDicNodes");
     // TODO: Find more efficient caching
     const bool shouldDepthLevelCache = TRAVERSAL->shouldDepthLevelCache(traverseSession);
     if (shouldDepthLevelCache) {
@@ -116,191 +211,465 @@ void Suggest::expandCurrentDicNodes(DicTraverseSession *traverseSession) const {
     }
     if (DEBUG_CACHE) {
         AKLOGI("expandCurrentDicNodes depth level cache = %d, inputSize = %d",
-                shouldDepthLevelCache, inputSize);
+                shouldDepthLevelCache, traverseSession->getInputSize());
+    }
+    const bool shouldTakeSnapshot = traverseSession->getDicTraverseCache()->startSnapshot();
+    const int taskCount = getParallelExpansionTaskCount(traverseSession);
+    std::vector<DicNode> *const dicNodes = traverseSession->getPoppedActiveDicNodes();
+    const bool isSnapshotComplete = popActiveDicNodes(traverseSession, shouldDepthLevelCache,
+            shouldTakeSnapshot, dicNodes);
+    if (taskCount > 1) {
+        expandCurrentDicNodesInParallel(traverseSession, taskCount, dicNodes);
+    } else {
+        ExpansionWorkspace *const workspace = traverseSession->getExpansionWorkspace();
+        const int dicNodeCount = static_cast<int>(dicNodes->size());
+        for (int i = 0; i < dicNodeCount; ++i) {
+            if (i + PREFETCH_DIC_NODE_DISTANCE < dicNodeCount) {
+                prefetchChildPtNodeArray(traverseSession,
+                        &(*dicNodes)[i + PREFETCH_DIC_NODE_DISTANCE]);
+            }
+            expandDicNode(traverseSession, workspace, &(*dicNodes)[i]);
+        }
+    }
+    dicNodes->clear();
+    if (isSnapshotComplete) {
+        traverseSession->getDicTraverseCache()->commitSnapshot();
     }
+}
+
+/**
+ * Pops all the active dicNodes into outDicNodes and prepares them for the expansion, stopping at
+ * the first one that exceeds the input size limit. The ones whose completions are cached are
+ * expanded right away instead. The child PtNode arrays of the first few are prefetched. Returns
+ * false if the snapshot is incomplete.
+ */
+template<class TraversalType, class WeightingType>
+bool SuggestImpl<TraversalType, WeightingType>::popActiveDicNodes(
+        DicTraverseSession *traverseSession, const bool shouldDepthLevelCache,
+        const bool shouldTakeSnapshot, std::vector<DicNode> *const outDicNodes) const {
+    outDicNodes->clear();
     while (traverseSession->getDicTraverseCache()->activeSize() > 0) {
-        DicNode dicNode;
-        traverseSession->getDicTraverseCache()->popActive(&dicNode);
-        if (dicNode.isTotalInputSizeExceedingLimit()) {
-            return;
+        outDicNodes->emplace_back();
+        traverseSession->getDicTraverseCache()->popActive(&outDicNodes->back());
+        if (!prepareDicNodeForExpansion(traverseSession, &outDicNodes->back(),
+                shouldDepthLevelCache, shouldTakeSnapshot)) {
+            // This node and the ones after it are not expanded.
+            outDicNodes->pop_back();
+            return false;
         }
-        childDicNodes.clear();
-        const int point0Index = dicNode.getInputIndex(0);
-        const bool canDoLookAheadCorrection =
-                TRAVERSAL->canDoLookAheadCorrection(traverseSession, &dicNode);
-        const bool isLookAheadCorrection = canDoLookAheadCorrection
-                && traverseSession->getDicTraverseCache()->
-                        isLookAheadCorrectionInputIndex(static_cast<int>(point0Index));
-        const bool isCompletion = dicNode.isCompletion(inputSize);
-
-        const bool shouldNodeLevelCache =
-                TRAVERSAL->shouldNodeLevelCache(traverseSession, &dicNode);
-        if (shouldDepthLevelCache || shouldNodeLevelCache) {
-            if (DEBUG_CACHE) {
-                dicNode.dump("PUSH_CACHE");
-            }
-            traverseSession->getDicTraverseCache()->copyPushContinue(&dicNode);
-            dicNode.setCached();
+        if (expandDicNodeWithCachedCompletions(traverseSession, &outDicNodes->back())) {
+            outDicNodes->pop_back();
+            continue;
+        }
+        if (static_cast<int>(outDicNodes->size()) <= PREFETCH_DIC_NODE_DISTANCE) {
+            prefetchChildPtNodeArray(traverseSession, &outDicNodes->back());
         }
+    }
+    return true;
+}
 
-        if (dicNode.isInDigraph()) {
-            // Finish digraph handling if the node is in the middle of a digraph expansion.
-            processDicNodeAsDigraph(traverseSession, &dicNode);
-        } else if (isLookAheadCorrection) {
-            // The algorithm maintains a small set of "deferred" nodes that have not consumed the
-            // latest touch point yet. These are needed to apply look-ahead correction operations
-            // that require special handling of the latest touch point. For example, with insertions
-            // (e.g., "thiis" -> "this") the latest touch point should not be consumed at all.
-            processDicNodeAsTransposition(traverseSession, &dicNode);
-            processDicNodeAsInsertion(traverseSession, &dicNode);
-        } else { // !isLookAheadCorrection
-            // Only consider typing error corrections if the normalized compound distance is
-            // below a spatial distance threshold.
-            // NOTE: the threshold may need to be updated if scoring model changes.
-            // TODO: Remove. Do not prune node here.
-            const bool allowsErrorCorrections = TRAVERSAL->allowsErrorCorrections(&dicNode);
-            // Process for handling space substitution (e.g., hevis => he is)
-            if (TRAVERSAL->isSpaceSubstitutionTerminal(traverseSession, &dicNode)) {
-                createNextWordDicNode(traverseSession, &dicNode, true /* spaceSubstitution */);
-            }
+/**
+ * Outputs the terminals below a completion dicNode from the completion cache of the dictionary,
+ * reading them into the cache on a miss, and returns true unless the dicNode has to be expanded by
+ * the search. The terminals are the same DicNodes as the search would reach: the code points of
+ * each completion are weighted one by one as completions. Only the most probable unigrams are
+ * cached, so the words that are only probable enough after the previous words may be missed.
+ * Serial, since the cache hits are copied to a session buffer.
+ */
+template<class TraversalType, class WeightingType>
+bool SuggestImpl<TraversalType, WeightingType>::expandDicNodeWithCachedCompletions(
+        DicTraverseSession *traverseSession, const DicNode *const dicNode) const {
+    CompletionCache *const completionCache = traverseSession->getCompletionCache();
+    if (!completionCache || traverseSession->getSuggestOptions()->isGesture()) {
+        return false;
+    }
+    // Multiple word DicNodes don't look ahead (see processExpandedDicNode()), and the ones
+    // expandDicNode() would prune are left to it.
+    if (!dicNode->isCompletion(traverseSession->getInputSize()) || dicNode->hasMultipleWords()
+            || dicNode->isInDigraph() || !dicNode->isLeavingNode() || !dicNode->hasChildren()
+            || isPrunableByTerminalCutoff(traverseSession, dicNode)) {
+        return false;
+    }
+    const DictionaryStructureWithBufferPolicy *const policy =
+            traverseSession->getDictionaryStructurePolicy();
+    const uint64_t dictionaryGeneration = traverseSession->getDictionaryGeneration();
+    const int ptNodeArrayPos = dicNode->getChildrenPtNodeArrayPos();
+    CompletionCache::Completions *const completions = traverseSession->getCompletionsBuffer();
+    if (!completionCache->getCompletions(policy, dictionaryGeneration, ptNodeArrayPos,
+            completions)) {
+        // Too large subtrees are cached as well, so that they are not read again.
+        CompletionCache::readCompletions(policy, dicNode, MAX_CACHED_COMPLETION_COUNT,
+                MAX_COMPLETION_SUBTREE_SIZE, completions);
+        completionCache->putCompletions(policy, dictionaryGeneration, ptNodeArrayPos,
+                *completions);
+    }
+    if (!completions->isValid()) {
+        return false;
+    }
+    ExpansionWorkspace *const workspace = traverseSession->getExpansionWorkspace();
+    DicNode dicNodes[2];
+    for (int i = 0; i < completions->getCount(); ++i) {
+        // The remaining code points are passed as the ones of a single PtNode; the DicNodes only
+        // differ in the PtNode positions, which the terminal doesn't use.
+        const CodePointArrayView codePoints = completions->getCodePoints(i);
+        dicNodes[0].initAsChild(dicNode, completions->getChildrenPtNodeArrayPos(i),
+                completions->getWordId(i), codePoints);
+        weightChildNode(traverseSession, &dicNodes[0]);
+        for (size_t j = 1; j < codePoints.size(); ++j) {
+            dicNodes[j % 2].initAsPassingChild(&dicNodes[(j - 1) % 2]);
+            weightChildNode(traverseSession, &dicNodes[j % 2]);
+        }
+        processTerminalDicNode(traverseSession, workspace, &dicNodes[(codePoints.size() - 1) % 2]);
+    }
+    return true;
+}
 
-            DicNodeUtils::getAllChildDicNodes(
-                    &dicNode, traverseSession->getDictionaryStructurePolicy(), &childDicNodes);
-
-            const int childDicNodesSize = childDicNodes.getSizeAndLock();
-            for (int i = 0; i < childDicNodesSize; ++i) {
-                DicNode *const childDicNode = childDicNodes[i];
-                if (isCompletion) {
-                    // Handle forward lookahead when the lexicon letter exceeds the input size.
-                    processDicNodeAsMatch(traverseSession, childDicNode);
-                    continue;
-                }
-                if (DigraphUtils::hasDigraphForCodePoint(
-                        traverseSession->getDictionaryStructurePolicy()
-                                ->getHeaderStructurePolicy(),
-                        childDicNode->getNodeCodePoint())) {
-                    correctionDicNode.initByCopy(childDicNode);
-                    correctionDicNode.advanceDigraphIndex();
-                    processDicNodeAsDigraph(traverseSession, &correctionDicNode);
-                }
-                if (TRAVERSAL->isOmission(traverseSession, &dicNode, childDicNode,
-                        allowsErrorCorrections)) {
-                    // TODO: (Gesture) Change weight between omission and substitution errors
-                    // TODO: (Gesture) Terminal node should not be handled as omission
-                    correctionDicNode.initByCopy(childDicNode);
-                    processDicNodeAsOmission(traverseSession, &correctionDicNode);
-                }
-                const ProximityType proximityType = TRAVERSAL->getProximityType(
-                        traverseSession, &dicNode, childDicNode);
-                switch (proximityType) {
-                    // TODO: Consider the difference of proximityType here
-                    case MATCH_CHAR:
-                    case PROXIMITY_CHAR:
-                        processDicNodeAsMatch(traverseSession, childDicNode);
-                        break;
-                    case ADDITIONAL_PROXIMITY_CHAR:
-                        if (allowsErrorCorrections) {
-                            processDicNodeAsAdditionalProximityChar(traverseSession, &dicNode,
-                                    childDicNode);
-                        }
-                        break;
-                    case SUBSTITUTION_CHAR:
-                        if (allowsErrorCorrections) {
-                            processDicNodeAsSubstitution(traverseSession, &dicNode, childDicNode);
-                        }
-                        break;
-                    case UNRELATED_CHAR:
-                        // Just drop this dicNode and do nothing.
-                        break;
-                    default:
-                        // Just drop this dicNode and do nothing.
-                        break;
+/**
+ * Hints the dictionary that the children of dicNode are going to be read, so that fetching them
+ * from memory overlaps with the expansion of the dicNodes before it.
+ */
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::prefetchChildPtNodeArray(
+        DicTraverseSession *traverseSession, const DicNode *const dicNode) const {
+    if (dicNode->hasChildren()) {
+        traverseSession->getDictionaryStructurePolicy()->prefetchPtNodeArray(
+                dicNode->getChildrenPtNodeArrayPos());
+    }
+}
+
+/**
+ * Expands the popped dicNodes with taskCount tasks on the WorkerThreadPool. Each task expands a
+ * fixed share of the nodes into its own workspace, and the workspaces are flushed into the cache
+ * in the order of the tasks, so the result does not depend on the scheduling. Terminals found by
+ * one task don't tighten the terminal cutoff of the others until the next input index.
+ */
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::expandCurrentDicNodesInParallel(
+        DicTraverseSession *traverseSession, const int taskCount,
+        std::vector<DicNode> *const dicNodes) const {
+    std::vector<WorkerThreadPool::Task> tasks;
+    tasks.reserve(taskCount);
+    for (int taskIndex = 0; taskIndex < taskCount; ++taskIndex) {
+        ExpansionWorkspace *const workspace =
+                traverseSession->getParallelExpansionWorkspace(taskIndex);
+        // The nodes are popped from the worst one; striding spreads the costly nodes evenly.
+        tasks.emplace_back([this, traverseSession, workspace, dicNodes, taskIndex, taskCount]() {
+            const size_t prefetchDistance = PREFETCH_DIC_NODE_DISTANCE * taskCount;
+            for (size_t i = taskIndex; i < dicNodes->size(); i += taskCount) {
+                if (i + prefetchDistance < dicNodes->size()) {
+                    prefetchChildPtNodeArray(traverseSession, &(*dicNodes)[i + prefetchDistance]);
                 }
+                expandDicNode(traverseSession, workspace, &(*dicNodes)[i]);
             }
+        });
+    }
+    WorkerThreadPool::getInstance()->runTasks(tasks);
+    for (int taskIndex = 0; taskIndex < taskCount; ++taskIndex) {
+        traverseSession->getParallelExpansionWorkspace(taskIndex)->flushTo(
+                traverseSession->getDicTraverseCache());
+    }
+}
+
+/**
+ * Returns the number of tasks to expand the active dicNodes with. The expansion is only split
+ * when every task gets enough nodes to outweigh handing them to the workers. Gesture policies can
+ * be provided by other libraries and are not required to be thread-safe, so gestures are always
+ * expanded serially.
+ */
+template<class TraversalType, class WeightingType>
+int SuggestImpl<TraversalType, WeightingType>::getParallelExpansionTaskCount(
+        DicTraverseSession *traverseSession) const {
+    const SuggestOptions *const suggestOptions = traverseSession->getSuggestOptions();
+    const int threadCount = suggestOptions->getParallelExpansionThreadCount();
+    if (threadCount <= 1 || suggestOptions->isGesture()) {
+        return 1;
+    }
+    const int activeSize = traverseSession->getDicTraverseCache()->activeSize();
+    return std::max(1, std::min(std::min(threadCount, MAX_PARALLEL_EXPANSION_TASK_COUNT),
+            activeSize / MIN_DIC_NODE_COUNT_PER_EXPANSION_TASK));
+}
+
+/**
+ * Does the bookkeeping for a popped active dicNode that has to happen in the order of popping:
+ * counting, the snapshot and the caches for continuous suggestion. Returns false when the dicNode
+ * exceeds the input size limit and the expansion of the current input index has to stop.
+ */
+template<class TraversalType, class WeightingType>
+bool SuggestImpl<TraversalType, WeightingType>::prepareDicNodeForExpansion(
+        DicTraverseSession *traverseSession, DicNode *dicNode, const bool shouldDepthLevelCache,
+        const bool shouldTakeSnapshot) const {
+    if (dicNode->isTotalInputSizeExceedingLimit()) {
+        return false;
+    }
+    traverseSession->getDicTraverseCache()->countExpandedDicNode();
+    if (shouldTakeSnapshot) {
+        traverseSession->getDicTraverseCache()->copyPushSnapshot(dicNode);
+    }
+    const bool shouldNodeLevelCache = TRAVERSAL->shouldNodeLevelCache(traverseSession, dicNode);
+    if (shouldDepthLevelCache || shouldNodeLevelCache) {
+        if (DEBUG_CACHE) {
+            dicNode->dump("PUSH_CACHE");
+        }
+        traverseSession->getDicTraverseCache()->copyPushContinue(dicNode);
+        dicNode->setCached();
+    }
+    return true;
+}
+
+/**
+ * Expands a single active dicNode. Writes to the DicNodesCache only through the workspace; the
+ * terminals are read for the cutoff.
+ */
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::expandDicNode(DicTraverseSession *traverseSession,
+        ExpansionWorkspace *workspace, DicNode *dicNode) const {
+    const int inputSize = traverseSession->getInputSize();
+    DicNodeVector *const childDicNodes = workspace->getChildDicNodesBuffer(
+            ExpansionWorkspace::CHILD_DIC_NODES_FOR_EXPANSION);
+    childDicNodes->reserve(TRAVERSAL->getDefaultExpandDicNodeSize());
+    DicNode correctionDicNode;
+    const int point0Index = dicNode->getInputIndex(0);
+    const bool canDoLookAheadCorrection =
+            TRAVERSAL->canDoLookAheadCorrection(traverseSession, dicNode);
+    const bool isLookAheadCorrection = canDoLookAheadCorrection
+            && traverseSession->getDicTraverseCache()->
+                    isLookAheadCorrectionInputIndex(static_cast<int>(point0Index));
+    const bool isCompletion = dicNode->isCompletion(inputSize);
+
+    // The node is kept in the caches by prepareDicNodeForExpansion() since the cutoff only holds
+    // for the current input.
+    if (isPrunableByTerminalCutoff(traverseSession, dicNode)) {
+        if (DEBUG_CACHE) {
+            dicNode->dump("PRUNE_BY_CUTOFF");
+        }
+        return;
+    }
+
+    if (dicNode->isInDigraph()) {
+        // Finish digraph handling if the node is in the middle of a digraph expansion.
+        processDicNodeAsDigraph(traverseSession, workspace, dicNode);
+    } else if (isLookAheadCorrection) {
+        // The algorithm maintains a small set of "deferred" nodes that have not consumed the
+        // latest touch point yet. These are needed to apply look-ahead correction operations
+        // that require special handling of the latest touch point. For example, with insertions
+        // (e.g., "thiis" -> "this") the latest touch point should not be consumed at all.
+        processDicNodeAsTransposition(traverseSession, workspace, dicNode);
+        processDicNodeAsInsertion(traverseSession, workspace, dicNode);
+    } else { // !isLookAheadCorrection
+        // Only consider typing error corrections if the normalized compound distance is
+        // below a spatial distance threshold.
+        // NOTE: the threshold may need to be updated if scoring model changes.
+        // TODO: Remove. Do not prune node here.
+        const bool allowsErrorCorrections = TRAVERSAL->allowsErrorCorrections(dicNode);
+        // Process for handling space substitution (e.g., hevis => he is)
+        if (TRAVERSAL->isSpaceSubstitutionTerminal(traverseSession, dicNode)) {
+            createNextWordDicNode(traverseSession, workspace, dicNode,
+                    true /* spaceSubstitution */);
+        }
+
+        if (TRAVERSAL->canFilterChildrenByProximity(traverseSession, dicNode,
+                allowsErrorCorrections)) {
+            // Don't create the children that would be dropped below anyway.
+            int matchOrProximityCodePoints[ChildDicNodeFilter::MAX_CODE_POINT_COUNT];
+            const int matchOrProximityCodePointCount = traverseSession
+                    ->getProximityInfoState(0)->getMatchOrProximityCodePoints(
+                            point0Index, matchOrProximityCodePoints);
+            const ChildDicNodeFilter childDicNodeFilter(matchOrProximityCodePoints,
+                    matchOrProximityCodePointCount, traverseSession->getDigraphType());
+            childDicNodes->setLeavingChildFilter(&childDicNodeFilter);
+            DicNodeUtils::getAllChildDicNodes(
+                    dicNode, traverseSession->getDictionaryStructurePolicy(), childDicNodes);
+            childDicNodes->setLeavingChildFilter(nullptr);
+        } else {
+            DicNodeUtils::getAllChildDicNodes(
+                    dicNode, traverseSession->getDictionaryStructurePolicy(), childDicNodes);
+        }
 
-            // Push the dicNode for look-ahead correction
-            if (allowsErrorCorrections && canDoLookAheadCorrection) {
-                traverseSession->getDicTraverseCache()->copyPushNextActive(&dicNode);
+        const int childDicNodesSize = childDicNodes->getSizeAndLock();
+        for (int i = 0; i < childDicNodesSize; ++i) {
+            DicNode *const childDicNode = (*childDicNodes)[i];
+            if (isCompletion) {
+                // Handle forward lookahead when the lexicon letter exceeds the input size.
+                processDicNodeAsMatch(traverseSession, workspace, childDicNode);
+                continue;
+            }
+            if (DigraphUtils::hasDigraphForCodePoint(traverseSession->getDigraphType(),
+                    childDicNode->getNodeCodePoint())) {
+                correctionDicNode.initByCopy(childDicNode);
+                correctionDicNode.advanceDigraphIndex();
+                processDicNodeAsDigraph(traverseSession, workspace, &correctionDicNode);
+            }
+            if (TRAVERSAL->isOmission(traverseSession, dicNode, childDicNode,
+                    allowsErrorCorrections)) {
+                // TODO: (Gesture) Change weight between omission and substitution errors
+                // TODO: (Gesture) Terminal node should not be handled as omission
+                correctionDicNode.initByCopy(childDicNode);
+                processDicNodeAsOmission(traverseSession, workspace, &correctionDicNode);
+            }
+            const ProximityType proximityType = TRAVERSAL->getProximityType(
+                    traverseSession, dicNode, childDicNode);
+            switch (proximityType) {
+                // TODO: Consider the difference of proximityType here
+                case MATCH_CHAR:
+                case PROXIMITY_CHAR:
+                    processDicNodeAsMatch(traverseSession, workspace, childDicNode);
+                    break;
+                case ADDITIONAL_PROXIMITY_CHAR:
+                    if (allowsErrorCorrections) {
+                        processDicNodeAsAdditionalProximityChar(traverseSession, workspace, dicNode,
+                                childDicNode);
+                    }
+                    break;
+                case SUBSTITUTION_CHAR:
+                    if (allowsErrorCorrections) {
+                        processDicNodeAsSubstitution(traverseSession, workspace, dicNode,
+                                childDicNode);
+                    }
+                    break;
+                case UNRELATED_CHAR:
+                    // Just drop this dicNode and do nothing.
+                    break;
+                default:
+                    // Just drop this dicNode and do nothing.
+                    break;
             }
         }
+
+        // Push the dicNode for look-ahead correction
+        if (allowsErrorCorrections && canDoLookAheadCorrection) {
+            workspace->copyPushNextActive(traverseSession->getDicTraverseCache(), dicNode);
+        }
+    }
+}
+
+/**
+ * Returns whether no terminal reachable from the dicNode can be kept in the full terminal queue,
+ * i.e. the lower bound of its compound distance is already worse than the worst terminal.
+ */
+template<class TraversalType, class WeightingType>
+bool SuggestImpl<TraversalType, WeightingType>::isPrunableByTerminalCutoff(
+        DicTraverseSession *traverseSession, const DicNode *const dicNode) const {
+    const DicNode *const cutoffDicNode =
+            traverseSession->getDicTraverseCache()->getTerminalCutoffDicNode();
+    if (!cutoffDicNode) {
+        return false;
     }
+    // Exact matches are promoted over all other nodes (see DicNode::compare). Contained errors are
+    // never removed, so a node that isn't an exact match can't become one later.
+    const bool isExactMatch = ErrorTypeUtils::isExactMatch(dicNode->getContainedErrorTypes());
+    const bool isCutoffExactMatch =
+            ErrorTypeUtils::isExactMatch(cutoffDicNode->getContainedErrorTypes());
+    if (isExactMatch != isCutoffExactMatch) {
+        return isCutoffExactMatch;
+    }
+    return Weighting::getCompoundDistanceLowerBound(WEIGHTING, traverseSession, dicNode)
+            > cutoffDicNode->getNormalizedCompoundDistance() + TERMINAL_CUTOFF_MARGIN;
 }
 
-void Suggest::processTerminalDicNode(
-        DicTraverseSession *traverseSession, DicNode *dicNode) const {
+template<class TraversalType, class WeightingType>
+bool SuggestImpl<TraversalType, WeightingType>::createTerminalDicNode(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace,
+        const DicNode *dicNode, DicNode *outTerminalDicNode) const {
     if (dicNode->getCompoundDistance() >= static_cast<float>(MAX_VALUE_FOR_WEIGHTING)) {
-        return;
+        return false;
     }
     if (!dicNode->isTerminalDicNode()) {
-        return;
+        return false;
     }
     if (dicNode->shouldBeFilteredBySafetyNetForBigram()) {
-        return;
+        return false;
     }
     if (!dicNode->hasMatchedOrProximityCodePoints()) {
-        return;
+        return false;
     }
     // Create a non-cached node here.
-    DicNode terminalDicNode(*dicNode);
+    *outTerminalDicNode = *dicNode;
     if (TRAVERSAL->needsToTraverseAllUserInput()
             && dicNode->getInputIndex(0) < traverseSession->getInputSize()) {
         Weighting::addCostAndForwardInputIndex(WEIGHTING, CT_TERMINAL_INSERTION, traverseSession, 0,
-                &terminalDicNode, traverseSession->getMultiBigramMap());
+                outTerminalDicNode, workspace->getMultiBigramMap());
     }
     Weighting::addCostAndForwardInputIndex(WEIGHTING, CT_TERMINAL, traverseSession, 0,
-            &terminalDicNode, traverseSession->getMultiBigramMap());
-    traverseSession->getDicTraverseCache()->copyPushTerminal(&terminalDicNode);
+            outTerminalDicNode, workspace->getMultiBigramMap());
+    return true;
+}
+
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::processTerminalDicNode(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace,
+        DicNode *dicNode) const {
+    DicNode terminalDicNode;
+    if (!createTerminalDicNode(traverseSession, workspace, dicNode, &terminalDicNode)) {
+        return;
+    }
+    DicNodesCache *const cache = traverseSession->getDicTraverseCache();
+    workspace->copyPushTerminal(cache, &terminalDicNode);
+    if (!traverseSession->getSuggestOptions()->isGesture()
+            && cache->isBeforeCacheBorderForTyping(traverseSession->getInputSize())) {
+        workspace->copyPushTerminalCandidate(cache, dicNode);
+    }
 }
 
 /**
  * Adds the expanded dicNode to the next search priority queue. Also creates an additional next word
  * (by the space omission error correction) search path if input dicNode is on a terminal.
  */
-void Suggest::processExpandedDicNode(
-        DicTraverseSession *traverseSession, DicNode *dicNode) const {
-    processTerminalDicNode(traverseSession, dicNode);
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::processExpandedDicNode(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace,
+        DicNode *dicNode) const {
+    processTerminalDicNode(traverseSession, workspace, dicNode);
     if (dicNode->getCompoundDistance() < static_cast<float>(MAX_VALUE_FOR_WEIGHTING)) {
         if (TRAVERSAL->isSpaceOmissionTerminal(traverseSession, dicNode)) {
-            createNextWordDicNode(traverseSession, dicNode, false /* spaceSubstitution */);
+            createNextWordDicNode(traverseSession, workspace, dicNode,
+                    false /* spaceSubstitution */);
         }
         const int allowsLookAhead = !(dicNode->hasMultipleWords()
                 && dicNode->isCompletion(traverseSession->getInputSize()));
         if (dicNode->hasChildren() && allowsLookAhead) {
-            traverseSession->getDicTraverseCache()->copyPushNextActive(dicNode);
+            workspace->copyPushNextActive(traverseSession->getDicTraverseCache(), dicNode);
         }
     }
 }
 
-void Suggest::processDicNodeAsMatch(DicTraverseSession *traverseSession,
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::processDicNodeAsMatch(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace,
         DicNode *childDicNode) const {
     weightChildNode(traverseSession, childDicNode);
-    processExpandedDicNode(traverseSession, childDicNode);
+    processExpandedDicNode(traverseSession, workspace, childDicNode);
 }
 
-void Suggest::processDicNodeAsAdditionalProximityChar(DicTraverseSession *traverseSession,
-        DicNode *dicNode, DicNode *childDicNode) const {
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::processDicNodeAsAdditionalProximityChar(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace, DicNode *dicNode,
+        DicNode *childDicNode) const {
     // Note: Most types of corrections don't need to look up the bigram information since they do
     // not treat the node as a terminal. There is no need to pass the bigram map in these cases.
     Weighting::addCostAndForwardInputIndex(WEIGHTING, CT_ADDITIONAL_PROXIMITY,
             traverseSession, dicNode, childDicNode, 0 /* multiBigramMap */);
-    processExpandedDicNode(traverseSession, childDicNode);
+    processExpandedDicNode(traverseSession, workspace, childDicNode);
 }
 
-void Suggest::processDicNodeAsSubstitution(DicTraverseSession *traverseSession,
-        DicNode *dicNode, DicNode *childDicNode) const {
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::processDicNodeAsSubstitution(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace, DicNode *dicNode,
+        DicNode *childDicNode) const {
     Weighting::addCostAndForwardInputIndex(WEIGHTING, CT_SUBSTITUTION, traverseSession,
             dicNode, childDicNode, 0 /* multiBigramMap */);
-    processExpandedDicNode(traverseSession, childDicNode);
+    processExpandedDicNode(traverseSession, workspace, childDicNode);
 }
 
 // Process the DicNode codepoint as a digraph. This means that composite glyphs like the German
 // u-umlaut is expanded to the transliteration "ue". Note that this happens in parallel with
 // the normal non-digraph traversal, so both "uber" and "ueber" can be corrected to "[u-umlaut]ber".
-void Suggest::processDicNodeAsDigraph(DicTraverseSession *traverseSession,
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::processDicNodeAsDigraph(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace,
         DicNode *childDicNode) const {
     weightChildNode(traverseSession, childDicNode);
     childDicNode->advanceDigraphIndex();
-    processExpandedDicNode(traverseSession, childDicNode);
+    processExpandedDicNode(traverseSession, workspace, childDicNode);
 }
 
 /**
@@ -310,15 +679,18 @@ void Suggest::processDicNodeAsDigraph(DicTraverseSession *traverseSession,
  * the possible *next* letters after the omission to better limit search to plausible omissions.
  * Note that apostrophes are handled as omissions.
  */
-void Suggest::processDicNodeAsOmission(
-        DicTraverseSession *traverseSession, DicNode *dicNode) const {
-    DicNodeVector childDicNodes;
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::processDicNodeAsOmission(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace,
+        DicNode *dicNode) const {
+    DicNodeVector *const childDicNodes = workspace->getChildDicNodesBuffer(
+            ExpansionWorkspace::CHILD_DIC_NODES_FOR_OMISSION);
     DicNodeUtils::getAllChildDicNodes(
-            dicNode, traverseSession->getDictionaryStructurePolicy(), &childDicNodes);
+            dicNode, traverseSession->getDictionaryStructurePolicy(), childDicNodes);
 
-    const int size = childDicNodes.getSizeAndLock();
+    const int size = childDicNodes->getSizeAndLock();
     for (int i = 0; i < size; i++) {
-        DicNode *const childDicNode = childDicNodes[i];
+        DicNode *const childDicNode = (*childDicNodes)[i];
         // Treat this word as omission
         Weighting::addCostAndForwardInputIndex(WEIGHTING, CT_OMISSION, traverseSession,
                 dicNode, childDicNode, 0 /* multiBigramMap */);
@@ -326,7 +698,7 @@ void Suggest::processDicNodeAsOmission(
         if (!TRAVERSAL->isPossibleOmissionChildNode(traverseSession, dicNode, childDicNode)) {
             continue;
         }
-        processExpandedDicNode(traverseSession, childDicNode);
+        processExpandedDicNode(traverseSession, workspace, childDicNode);
     }
 }
 
@@ -334,50 +706,58 @@ void Suggest::processDicNodeAsOmission(
  * Handle the dicNode as an insertion error (e.g., thiis => this). Skip the current touch point and
  * consider matches for the next touch point.
  */
-void Suggest::processDicNodeAsInsertion(DicTraverseSession *traverseSession,
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::processDicNodeAsInsertion(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace,
         DicNode *dicNode) const {
     const int16_t pointIndex = dicNode->getInputIndex(0);
-    DicNodeVector childDicNodes;
+    DicNodeVector *const childDicNodes = workspace->getChildDicNodesBuffer(
+            ExpansionWorkspace::CHILD_DIC_NODES_FOR_INSERTION);
     DicNodeUtils::getAllChildDicNodes(dicNode, traverseSession->getDictionaryStructurePolicy(),
-            &childDicNodes);
-    const int size = childDicNodes.getSizeAndLock();
+            childDicNodes);
+    const int size = childDicNodes->getSizeAndLock();
     for (int i = 0; i < size; i++) {
         if (traverseSession->getProximityInfoState(0)->getPrimaryCodePointAt(pointIndex + 1)
-                != childDicNodes[i]->getNodeCodePoint()) {
+                != (*childDicNodes)[i]->getNodeCodePoint()) {
             continue;
         }
-        DicNode *const childDicNode = childDicNodes[i];
+        DicNode *const childDicNode = (*childDicNodes)[i];
         Weighting::addCostAndForwardInputIndex(WEIGHTING, CT_INSERTION, traverseSession,
                 dicNode, childDicNode, 0 /* multiBigramMap */);
-        processExpandedDicNode(traverseSession, childDicNode);
+        processExpandedDicNode(traverseSession, workspace, childDicNode);
     }
 }
 
 /**
  * Handle the dicNode as a transposition error (e.g., thsi => this). Swap the next two touch points.
  */
-void Suggest::processDicNodeAsTransposition(DicTraverseSession *traverseSession,
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::processDicNodeAsTransposition(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace,
         DicNode *dicNode) const {
     const int16_t pointIndex = dicNode->getInputIndex(0);
-    DicNodeVector childDicNodes1;
-    DicNodeVector childDicNodes2;
+    DicNodeVector *const childDicNodes1 = workspace->getChildDicNodesBuffer(
+            ExpansionWorkspace::CHILD_DIC_NODES_FOR_TRANSPOSITION_FIRST);
+    DicNodeVector *const childDicNodes2 = workspace->getChildDicNodesBuffer(
+            ExpansionWorkspace::CHILD_DIC_NODES_FOR_TRANSPOSITION_SECOND);
     DicNodeUtils::getAllChildDicNodes(dicNode, traverseSession->getDictionaryStructurePolicy(),
-            &childDicNodes1);
-    const int childSize1 = childDicNodes1.getSizeAndLock();
+            childDicNodes1);
+    const int childSize1 = childDicNodes1->getSizeAndLock();
     for (int i = 0; i < childSize1; i++) {
+        DicNode *const childDicNode1 = (*childDicNodes1)[i];
         const ProximityType matchedId1 = traverseSession->getProximityInfoState(0)
-                ->getProximityType(pointIndex + 1, childDicNodes1[i]->getNodeCodePoint(),
+                ->getProximityType(pointIndex + 1, childDicNode1->getNodeCodePoint(),
                         true /* checkProximityChars */);
         if (!ProximityInfoUtils::isMatchOrProximityChar(matchedId1)) {
             continue;
         }
-        if (childDicNodes1[i]->hasChildren()) {
-            childDicNodes2.clear();
-            DicNodeUtils::getAllChildDicNodes(childDicNodes1[i],
-                    traverseSession->getDictionaryStructurePolicy(), &childDicNodes2);
-            const int childSize2 = childDicNodes2.getSizeAndLock();
+        if (childDicNode1->hasChildren()) {
+            childDicNodes2->clear();
+            DicNodeUtils::getAllChildDicNodes(childDicNode1,
+                    traverseSession->getDictionaryStructurePolicy(), childDicNodes2);
+            const int childSize2 = childDicNodes2->getSizeAndLock();
             for (int j = 0; j < childSize2; j++) {
-                DicNode *const childDicNode2 = childDicNodes2[j];
+                DicNode *const childDicNode2 = (*childDicNodes2)[j];
                 const ProximityType matchedId2 = traverseSession->getProximityInfoState(0)
                         ->getProximityType(pointIndex, childDicNode2->getNodeCodePoint(),
                                 true /* checkProximityChars */);
@@ -385,8 +765,8 @@ void Suggest::processDicNodeAsTransposition(DicTraverseSession *traverseSession,
                     continue;
                 }
                 Weighting::addCostAndForwardInputIndex(WEIGHTING, CT_TRANSPOSITION,
-                        traverseSession, childDicNodes1[i], childDicNode2, 0 /* multiBigramMap */);
-                processExpandedDicNode(traverseSession, childDicNode2);
+                        traverseSession, childDicNode1, childDicNode2, 0 /* multiBigramMap */);
+                processExpandedDicNode(traverseSession, workspace, childDicNode2);
             }
         }
     }
@@ -395,7 +775,9 @@ void Suggest::processDicNodeAsTransposition(DicTraverseSession *traverseSession,
 /**
  * Weight child dicNode by aligning it to the key
  */
-void Suggest::weightChildNode(DicTraverseSession *traverseSession, DicNode *dicNode) const {
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::weightChildNode(DicTraverseSession *traverseSession,
+        DicNode *dicNode) const {
     const int inputSize = traverseSession->getInputSize();
     if (dicNode->isCompletion(inputSize)) {
         Weighting::addCostAndForwardInputIndex(WEIGHTING, CT_COMPLETION, traverseSession,
@@ -410,12 +792,12 @@ void Suggest::weightChildNode(DicTraverseSession *traverseSession, DicNode *dicN
  * Creates a new dicNode that represents a space insertion at the end of the input dicNode. Also
  * incorporates the unigram / bigram score for the ending word into the new dicNode.
  */
-void Suggest::createNextWordDicNode(DicTraverseSession *traverseSession, DicNode *dicNode,
+template<class TraversalType, class WeightingType>
+void SuggestImpl<TraversalType, WeightingType>::createNextWordDicNode(
+        DicTraverseSession *traverseSession, ExpansionWorkspace *workspace, DicNode *dicNode,
         const bool spaceSubstitution) const {
-    const WordAttributes wordAttributes =
-            traverseSession->getDictionaryStructurePolicy()->getWordAttributesInContext(
-                    dicNode->getPrevWordIds(), dicNode->getWordId(),
-                    traverseSession->getMultiBigramMap());
+    const WordAttributes wordAttributes = traverseSession->getWordAttributesInContext(
+            dicNode->getPrevWordIds(), dicNode->getWordId(), workspace->getMultiBigramMap());
     if (SuggestionsOutputUtils::shouldBlockWord(traverseSession->getSuggestOptions(),
             dicNode, wordAttributes, false /* isLastWord */)) {
         return;
@@ -432,13 +814,16 @@ void Suggest::createNextWordDicNode(DicTraverseSession *traverseSession, DicNode
     const CorrectionType correctionType = spaceSubstitution ?
             CT_NEW_WORD_SPACE_SUBSTITUTION : CT_NEW_WORD_SPACE_OMISSION;
     Weighting::addCostAndForwardInputIndex(WEIGHTING, correctionType, traverseSession, dicNode,
-            &newDicNode, traverseSession->getMultiBigramMap());
+            &newDicNode, workspace->getMultiBigramMap());
     if (newDicNode.getCompoundDistance() < static_cast<float>(MAX_VALUE_FOR_WEIGHTING)) {
         // newDicNode is worth continuing to traverse.
         // CAVEAT: This pruning is important for speed. Remove this when we can afford not to prune
         // here because here is not the right place to do pruning. Pruning should take place only
         // in DicNodePriorityQueue.
-        traverseSession->getDicTraverseCache()->copyPushNextActive(&newDicNode);
+        workspace->copyPushNextActive(traverseSession->getDicTraverseCache(), &newDicNode);
     }
 }
+
+template class SuggestImpl<Traversal, Weighting>;
+template class SuggestImpl<TypingTraversal, TypingWeighting>;
 } // namespace latinime
@@ -17,6 +17,8 @@
 #ifndef LATINIME_SUGGEST_IMPL_H
 #define LATINIME_SUGGEST_IMPL_H
 
+#include <vector>
+
 #include "defines.h"
 #include "suggest/core/suggest_interface.h"
 #include "suggest/core/policy/suggest_policy.h"
@@ -34,50 +36,99 @@ namespace latinime {
 
 class DicNode;
 class DicTraverseSession;
+class ExpansionWorkspace;
 class ProximityInfo;
 class Scoring;
 class SuggestionResults;
 class Traversal;
 class Weighting;
 
-class Suggest : public SuggestInterface {
+// The search, compiled once per pair of traversal and weighting classes. The typing policy is
+// instantiated with its final classes so that the calls made for each DicNode are resolved at
+// compile time and can be inlined (see TypingSuggest). Scoring is only used once per search and is
+// always called through its interface.
+template<class TraversalType, class WeightingType>
+class SuggestImpl : public SuggestInterface {
  public:
-    AK_FORCE_INLINE Suggest(const SuggestPolicy *const suggestPolicy)
-            : TRAVERSAL(suggestPolicy ? suggestPolicy->getTraversal() : nullptr),
-              SCORING(suggestPolicy ? suggestPolicy->getScoring() : nullptr),
-              WEIGHTING(suggestPolicy ? suggestPolicy->getWeighting() : nullptr) {}
-    AK_FORCE_INLINE virtual ~Suggest() {}
+    AK_FORCE_INLINE virtual ~SuggestImpl() {}
     void getSuggestions(ProximityInfo *pInfo, void *traverseSession, int *inputXs, int *inputYs,
             int *times, int *pointerIds, int *inputCodePoints, int inputSize,
             const float weightOfLangModelVsSpatialModel,
             SuggestionResults *const outSuggestionResults) const;
 
+ protected:
+    AK_FORCE_INLINE SuggestImpl(const TraversalType *const traversal,
+            const Scoring *const scoring, const WeightingType *const weighting)
+            : TRAVERSAL(traversal), SCORING(scoring), WEIGHTING(weighting) {}
+
  private:
-    DISALLOW_IMPLICIT_CONSTRUCTORS(Suggest);
-    void createNextWordDicNode(DicTraverseSession *traverseSession, DicNode *dicNode,
-            const bool spaceSubstitution) const;
+    DISALLOW_IMPLICIT_CONSTRUCTORS(SuggestImpl);
+    void createNextWordDicNode(DicTraverseSession *traverseSession,
+            ExpansionWorkspace *workspace, DicNode *dicNode, const bool spaceSubstitution) const;
     void initializeSearch(DicTraverseSession *traverseSession) const;
     void expandCurrentDicNodes(DicTraverseSession *traverseSession) const;
-    void processTerminalDicNode(DicTraverseSession *traverseSession, DicNode *dicNode) const;
-    void processExpandedDicNode(DicTraverseSession *traverseSession, DicNode *dicNode) const;
+    bool popActiveDicNodes(DicTraverseSession *traverseSession, const bool shouldDepthLevelCache,
+            const bool shouldTakeSnapshot, std::vector<DicNode> *const outDicNodes) const;
+    bool expandDicNodeWithCachedCompletions(DicTraverseSession *traverseSession,
+            const DicNode *const dicNode) const;
+    void prefetchChildPtNodeArray(DicTraverseSession *traverseSession,
+            const DicNode *const dicNode) const;
+    void expandCurrentDicNodesInParallel(DicTraverseSession *traverseSession, const int taskCount,
+            std::vector<DicNode> *const dicNodes) const;
+    int getParallelExpansionTaskCount(DicTraverseSession *traverseSession) const;
+    bool prepareDicNodeForExpansion(DicTraverseSession *traverseSession, DicNode *dicNode,
+            const bool shouldDepthLevelCache, const bool shouldTakeSnapshot) const;
+    void expandDicNode(DicTraverseSession *traverseSession, ExpansionWorkspace *workspace,
+            DicNode *dicNode) const;
+    void restoreTerminalDicNodesFromCandidates(DicTraverseSession *traverseSession) const;
+    bool createTerminalDicNode(DicTraverseSession *traverseSession, ExpansionWorkspace *workspace,
+            const DicNode *dicNode, DicNode *outTerminalDicNode) const;
+    void processTerminalDicNode(DicTraverseSession *traverseSession,
+            ExpansionWorkspace *workspace, DicNode *dicNode) const;
+    void processExpandedDicNode(DicTraverseSession *traverseSession,
+            ExpansionWorkspace *workspace, DicNode *dicNode) const;
     void weightChildNode(DicTraverseSession *traverseSession, DicNode *dicNode) const;
-    void processDicNodeAsOmission(DicTraverseSession *traverseSession, DicNode *dicNode) const;
-    void processDicNodeAsDigraph(DicTraverseSession *traverseSession, DicNode *dicNode) const;
+    void processDicNodeAsOmission(DicTraverseSession *traverseSession,
+            ExpansionWorkspace *workspace, DicNode *dicNode) const;
+    void processDicNodeAsDigraph(DicTraverseSession *traverseSession,
+            ExpansionWorkspace *workspace, DicNode *dicNode) const;
     void processDicNodeAsTransposition(DicTraverseSession *traverseSession,
-            DicNode *dicNode) const;
-    void processDicNodeAsInsertion(DicTraverseSession *traverseSession, DicNode *dicNode) const;
+            ExpansionWorkspace *workspace, DicNode *dicNode) const;
+    void processDicNodeAsInsertion(DicTraverseSession *traverseSession,
+            ExpansionWorkspace *workspace, DicNode *dicNode) const;
     void processDicNodeAsAdditionalProximityChar(DicTraverseSession *traverseSession,
-            DicNode *dicNode, DicNode *childDicNode) const;
-    void processDicNodeAsSubstitution(DicTraverseSession *traverseSession, DicNode *dicNode,
-            DicNode *childDicNode) const;
+            ExpansionWorkspace *workspace, DicNode *dicNode, DicNode *childDicNode) const;
+    void processDicNodeAsSubstitution(DicTraverseSession *traverseSession,
+            ExpansionWorkspace *workspace, DicNode *dicNode, DicNode *childDicNode) const;
     void processDicNodeAsMatch(DicTraverseSession *traverseSession,
-            DicNode *childDicNode) const;
+            ExpansionWorkspace *workspace, DicNode *childDicNode) const;
+    bool isPrunableByTerminalCutoff(DicTraverseSession *traverseSession,
+            const DicNode *const dicNode) const;
 
     static const int MIN_CONTINUOUS_SUGGESTION_INPUT_SIZE;
+    static const float TERMINAL_CUTOFF_MARGIN;
+    static const int MAX_PARALLEL_EXPANSION_TASK_COUNT;
+    static const int MIN_DIC_NODE_COUNT_PER_EXPANSION_TASK;
+    static const int PREFETCH_DIC_NODE_DISTANCE;
+    static const int MAX_CACHED_COMPLETION_COUNT;
+    static const int MAX_COMPLETION_SUBTREE_SIZE;
 
-    const Traversal *const TRAVERSAL;
+    const TraversalType *const TRAVERSAL;
     const Scoring *const SCORING;
-    const Weighting *const WEIGHTING;
+    const WeightingType *const WEIGHTING;
+};
+
+// Calls the policy through the virtual interfaces. Used for gesture input, whose policy can be
+// replaced at runtime.
+class Suggest : public SuggestImpl<Traversal, Weighting> {
+ public:
+    AK_FORCE_INLINE Suggest(const SuggestPolicy *const suggestPolicy)
+            : SuggestImpl(suggestPolicy ? suggestPolicy->getTraversal() : nullptr,
+                      suggestPolicy ? suggestPolicy->getScoring() : nullptr,
+                      suggestPolicy ? suggestPolicy->getWeighting() : nullptr) {}
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(Suggest);
 };
 } // namespace latinime
 #endif // LATINIME_SUGGEST_IMPL_H
@@ -48,6 +48,18 @@ class SuggestOptions{
         return static_cast<float>(getIntOption(WEIGHT_FOR_LOCALE_IN_THOUSANDS)) / 1000.0f;
     }
 
+    // Returns the time the search may take in microseconds. 0 means there is no limit. When the
+    // limit is reached, the search stops and the terminals found so far are returned.
+    AK_FORCE_INLINE int getSearchTimeLimitInMicroseconds() const {
+        return getIntOption(SEARCH_TIME_LIMIT_IN_MICROSECONDS);
+    }
+
+    // Returns the number of threads the DicNodes of one input index may be expanded with. 0 and 1
+    // mean that the expansion is serial. Only used for typing.
+    AK_FORCE_INLINE int getParallelExpansionThreadCount() const {
+        return getIntOption(PARALLEL_EXPANSION_THREAD_COUNT);
+    }
+
     AK_FORCE_INLINE bool getAdditionalFeaturesBoolOption(const int key) const {
         return getBoolOption(key + ADDITIONAL_FEATURES_OPTIONS);
     }
@@ -62,9 +74,11 @@ class SuggestOptions{
     static const int BLOCK_OFFENSIVE_WORDS = 2;
     static const int SPACE_AWARE_GESTURE_ENABLED = 3;
     static const int WEIGHT_FOR_LOCALE_IN_THOUSANDS = 4;
+    static const int SEARCH_TIME_LIMIT_IN_MICROSECONDS = 5;
+    static const int PARALLEL_EXPANSION_THREAD_COUNT = 6;
     // Additional features options are stored after the other options and used as setting values of
     // experimental features.
-    static const int ADDITIONAL_FEATURES_OPTIONS = 5;
+    static const int ADDITIONAL_FEATURES_OPTIONS = 7;
 
     const int *const mOptions;
     const int mLength;
@@ -18,6 +18,7 @@
 #define LATINIME_GESTURE_SUGGEST_POLICY_FACTORY_H
 
 #include "defines.h"
+#include "suggest/policyimpl/gesture/gesture_suggest_policy.h"
 
 namespace latinime {
 
@@ -29,9 +30,10 @@ class GestureSuggestPolicyFactory {
         sGestureSuggestFactoryMethod = factoryMethod;
     }
 
+    // Returns the built-in gesture policy unless another factory method has been registered.
     static const SuggestPolicy *getGestureSuggestPolicy() {
         if (!sGestureSuggestFactoryMethod) {
-            return 0;
+            return GestureSuggestPolicy::getInstance();
         }
         return sGestureSuggestFactoryMethod();
     }
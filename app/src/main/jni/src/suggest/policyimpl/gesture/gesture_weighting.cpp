@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/policyimpl/gesture/gesture_weighting.h"
+
+#include <algorithm>
+
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/layout/proximity_info.h"
+#include "suggest/core/layout/proximity_info_state.h"
+#include "utils/char_utils.h"
+
+namespace latinime {
+
+const GestureWeighting GestureWeighting::sInstance;
+
+static AK_FORCE_INLINE int getKeyIdOf(const ProximityInfo *const proximityInfo,
+        const int codePoint) {
+    if (codePoint == NOT_A_CODE_POINT) {
+        return NOT_AN_INDEX;
+    }
+    return proximityInfo->getKeyIndexOf(CharUtils::toBaseLowerCase(codePoint));
+}
+
+// Returns the cost of a path between two aligned points that is longer than the beeline between
+// the two keys. Skip costs already cover most detours; this covers sparsely sampled ones.
+static AK_FORCE_INLINE float getDetourCost(const ProximityInfo *const proximityInfo,
+        const ProximityInfoState *const pInfoState, const int prevKeyId, const int keyId,
+        const int prevPointIndex, const int pointIndex) {
+    if (prevKeyId == NOT_AN_INDEX || prevPointIndex < 0) {
+        return 0.0f;
+    }
+    const int pathLength =
+            pInfoState->getLengthCache(pointIndex) - pInfoState->getLengthCache(prevPointIndex);
+    const int detourLength = pathLength - proximityInfo->getKeyKeyDistanceG(prevKeyId, keyId);
+    if (detourLength <= 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(detourLength)
+            / static_cast<float>(std::max(1, proximityInfo->getMostCommonKeyWidth()))
+            * ScoringParamsG::DETOUR_COST_PER_KEY_WIDTH;
+}
+
+static AK_FORCE_INLINE float getDoubleLetterCost(const DoubleLetterLevel doubleLetterLevel) {
+    switch (doubleLetterLevel) {
+        case A_STRONG_DOUBLE_LETTER:
+            return ScoringParamsG::DOUBLE_LETTER_COST_FOR_A_STRONG_DOUBLE_LETTER;
+        case A_DOUBLE_LETTER:
+            return ScoringParamsG::DOUBLE_LETTER_COST_FOR_A_DOUBLE_LETTER;
+        default:
+            return ScoringParamsG::DOUBLE_LETTER_COST;
+    }
+}
+
+float GestureWeighting::getMatchedCost(const DicTraverseSession *const traverseSession,
+        const DicNode *const dicNode, DicNode_InputStateG *inputStateG) const {
+    const ProximityInfo *const proximityInfo = traverseSession->getProximityInfo();
+    const ProximityInfoState *const pInfoState = traverseSession->getProximityInfoState(0);
+    const int sampledInputSize = pInfoState->size();
+    const int codePoint = dicNode->getNodeCodePoint();
+    const int keyId = getKeyIdOf(proximityInfo, codePoint);
+    const int startIndex = dicNode->getInputIndex(0);
+    if (keyId == NOT_AN_INDEX || startIndex >= sampledInputSize) {
+        return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
+    }
+    // The point the previous letter has been aligned to.
+    const int prevPointIndex = startIndex - 1;
+    const int prevKeyId = (prevPointIndex >= 0)
+            ? getKeyIdOf(proximityInfo, dicNode->getPrevCodePointG(0)) : NOT_AN_INDEX;
+
+    float bestCost = static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
+    int bestPointIndex = NOT_AN_INDEX;
+    if (prevKeyId == keyId) {
+        // Double letters are usually drawn as a single point on the key, so the second letter can
+        // share the point of the first one.
+        bestCost = getDoubleLetterCost(pInfoState->getDoubleLetterLevel(prevPointIndex));
+        bestPointIndex = prevPointIndex;
+    }
+    float skipCost = 0.0f;
+    bool hasReachedKey = false;
+    for (int i = startIndex; i < sampledInputSize && skipCost < bestCost; ++i) {
+        const float alignCost = pInfoState->getProbability(i, keyId);
+        if (alignCost < static_cast<float>(MAX_VALUE_FOR_WEIGHTING)) {
+            hasReachedKey = true;
+            const float cost = skipCost + alignCost
+                    + getDetourCost(proximityInfo, pInfoState, prevKeyId, keyId, prevPointIndex, i);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestPointIndex = i;
+            }
+        } else if (hasReachedKey) {
+            // The path has left the key; later points belong to another visit of it.
+            break;
+        }
+        skipCost += pInfoState->getProbability(i, NOT_AN_INDEX);
+    }
+    if (bestPointIndex == NOT_AN_INDEX) {
+        return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
+    }
+    inputStateG->mNeedsToUpdateInputStateG = true;
+    inputStateG->mPointerId = 0;
+    inputStateG->mInputIndex = static_cast<int16_t>(bestPointIndex + 1);
+    inputStateG->mPrevCodePoint = codePoint;
+    inputStateG->mTerminalDiffCost = 0.0f;
+    inputStateG->mRawLength = (prevPointIndex >= 0) ? static_cast<float>(
+            pInfoState->getLengthCache(bestPointIndex) - pInfoState->getLengthCache(prevPointIndex))
+            : 0.0f;
+    inputStateG->mDoubleLetterLevel = pInfoState->getDoubleLetterLevel(bestPointIndex);
+    return bestCost;
+}
+
+float GestureWeighting::getTerminalInsertionCost(const DicTraverseSession *const traverseSession,
+        const DicNode *const dicNode) const {
+    // The points after the last aligned point are skipped.
+    const ProximityInfoState *const pInfoState = traverseSession->getProximityInfoState(0);
+    float cost = 0.0f;
+    for (int i = dicNode->getInputIndex(0); i < pInfoState->size(); ++i) {
+        cost += pInfoState->getProbability(i, NOT_AN_INDEX);
+    }
+    return cost;
+}
+
+ErrorTypeUtils::ErrorType GestureWeighting::getErrorType(const CorrectionType correctionType,
+        const DicTraverseSession *const traverseSession, const DicNode *const parentDicNode,
+        const DicNode *const dicNode) const {
+    switch (correctionType) {
+        case CT_MATCH:
+            // Gesture letters are always spatially aligned; they are never typed exactly.
+            return ErrorTypeUtils::PROXIMITY_CORRECTION;
+        case CT_OMISSION:
+            return ErrorTypeUtils::INTENTIONAL_OMISSION;
+        case CT_NEW_WORD_SPACE_OMISSION:
+            return ErrorTypeUtils::NEW_WORD;
+        case CT_COMPLETION:
+            return ErrorTypeUtils::COMPLETION;
+        case CT_TERMINAL:
+        case CT_TERMINAL_INSERTION:
+            return ErrorTypeUtils::NOT_AN_ERROR;
+        default:
+            return ErrorTypeUtils::EDIT_CORRECTION;
+    }
+}
+}  // namespace latinime
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_GESTURE_WEIGHTING_H
+#define LATINIME_GESTURE_WEIGHTING_H
+
+#include "defines.h"
+#include "suggest/core/dicnode/dic_node_utils.h"
+#include "suggest/core/dictionary/error_type_utils.h"
+#include "suggest/core/policy/weighting.h"
+#include "suggest/core/session/dic_traverse_session.h"
+#include "suggest/policyimpl/gesture/scoring_params_g.h"
+
+namespace latinime {
+
+class DicNode;
+struct DicNode_InputStateG;
+class MultiBigramMap;
+
+// Weighting for gesture input. A letter is aligned to the sampled point that minimizes the cost of
+// mapping the point to the letter's key plus the cost of skipping the points in between. The costs
+// are the negative log probabilities precomputed by ProximityInfoState.
+class GestureWeighting : public Weighting {
+ public:
+    static const GestureWeighting *getInstance() { return &sInstance; }
+
+ protected:
+    float getTerminalSpatialCost(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const {
+        return dicNode->hasMultipleWords() ? ScoringParamsG::HAS_MULTI_WORD_TERMINAL_COST : 0.0f;
+    }
+
+    float getOmissionCost(const DicNode *const parentDicNode, const DicNode *const dicNode) const {
+        if (parentDicNode->isZeroCostOmission()) {
+            return 0.0f;
+        }
+        if (parentDicNode->canBeIntentionalOmission()) {
+            return ScoringParamsG::INTENTIONAL_OMISSION_COST;
+        }
+        return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
+    }
+
+    float getMatchedCost(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode, DicNode_InputStateG *inputStateG) const;
+
+    bool isProximityDicNode(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const {
+        return false;
+    }
+
+    float getTranspositionCost(const DicTraverseSession *const traverseSession,
+            const DicNode *const parentDicNode, const DicNode *const dicNode) const {
+        return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
+    }
+
+    float getInsertionCost(const DicTraverseSession *const traverseSession,
+            const DicNode *const parentDicNode, const DicNode *const dicNode) const {
+        return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
+    }
+
+    float getSpaceOmissionCost(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode, DicNode_InputStateG *inputStateG) const {
+        return ScoringParamsG::SPACE_OMISSION_COST
+                * traverseSession->getMultiWordCostMultiplier();
+    }
+
+    float getNewWordBigramLanguageCost(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode,
+            MultiBigramMap *const multiBigramMap) const {
+        return DicNodeUtils::getBigramNodeImprobability(traverseSession, dicNode, multiBigramMap)
+                * ScoringParamsG::DISTANCE_WEIGHT_LANGUAGE;
+    }
+
+    float getCompletionCost(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const {
+        const bool firstCompletion = dicNode->getInputIndex(0)
+                == traverseSession->getInputSize();
+        return firstCompletion ? ScoringParamsG::COST_FIRST_COMPLETION
+                : ScoringParamsG::COST_COMPLETION;
+    }
+
+    float getTerminalLanguageCost(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode, const float dicNodeLanguageImprobability) const {
+        return dicNodeLanguageImprobability * ScoringParamsG::DISTANCE_WEIGHT_LANGUAGE;
+    }
+
+    float getTerminalInsertionCost(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const;
+
+    AK_FORCE_INLINE bool needsToNormalizeCompoundDistance() const {
+        // DicNodes at the same depth can have consumed very different numbers of points.
+        return true;
+    }
+
+    float getRemainingSpatialCostLowerBound(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const {
+        // Not used, since normalized distances have no lower bound along the search.
+        return 0.0f;
+    }
+
+    float getRemainingLanguageCostLowerBound(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const {
+        // Not used, since normalized distances have no lower bound along the search.
+        return 0.0f;
+    }
+
+    AK_FORCE_INLINE float getAdditionalProximityCost() const {
+        return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
+    }
+
+    AK_FORCE_INLINE float getSubstitutionCost() const {
+        return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
+    }
+
+    AK_FORCE_INLINE float getSpaceSubstitutionCost(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const {
+        return static_cast<float>(MAX_VALUE_FOR_WEIGHTING);
+    }
+
+    ErrorTypeUtils::ErrorType getErrorType(const CorrectionType correctionType,
+            const DicTraverseSession *const traverseSession,
+            const DicNode *const parentDicNode, const DicNode *const dicNode) const;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(GestureWeighting);
+    static const GestureWeighting sInstance;
+
+    GestureWeighting() {}
+    ~GestureWeighting() {}
+};
+} // namespace latinime
+#endif // LATINIME_GESTURE_WEIGHTING_H
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/policyimpl/gesture/scoring_params_g.h"
+
+namespace latinime {
+const float ScoringParamsG::MAX_SPATIAL_DISTANCE = 1.0f;
+const int ScoringParamsG::THRESHOLD_NEXT_WORD_PROBABILITY = 60;
+const int ScoringParamsG::THRESHOLD_NEXT_WORD_PROBABILITY_FOR_CAPPED = 120;
+const int ScoringParamsG::THRESHOLD_SHORT_WORD_LENGTH = 4;
+const float ScoringParamsG::AUTOCORRECT_OUTPUT_THRESHOLD = 1.0f;
+
+// Each match scans several sampled points, so the beam is kept smaller than the typing one.
+const int ScoringParamsG::MAX_CACHE_DIC_NODE_SIZE = 100;
+const int ScoringParamsG::MAX_CACHE_DIC_NODE_SIZE_FOR_LOW_PROBABILITY_LOCALE = 30;
+const float ScoringParamsG::LOCALE_WEIGHT_THRESHOLD_FOR_SMALL_CACHE_SIZE = 0.99f;
+const float ScoringParamsG::LOCALE_WEIGHT_THRESHOLD_FOR_SPACE_OMISSION = 0.99f;
+
+const float ScoringParamsG::DISTANCE_WEIGHT_LANGUAGE = 4.0f;
+const float ScoringParamsG::DETOUR_COST_PER_KEY_WIDTH = 0.1f;
+const float ScoringParamsG::DOUBLE_LETTER_COST = 1.5f;
+const float ScoringParamsG::DOUBLE_LETTER_COST_FOR_A_DOUBLE_LETTER = 0.3f;
+const float ScoringParamsG::DOUBLE_LETTER_COST_FOR_A_STRONG_DOUBLE_LETTER = 0.0f;
+const float ScoringParamsG::INTENTIONAL_OMISSION_COST = 0.3f;
+const float ScoringParamsG::SPACE_OMISSION_COST = 1.0f;
+const float ScoringParamsG::COST_FIRST_COMPLETION = 1.2f;
+const float ScoringParamsG::COST_COMPLETION = 0.4f;
+const float ScoringParamsG::HAS_MULTI_WORD_TERMINAL_COST = 0.8f;
+const float ScoringParamsG::GESTURE_BASE_OUTPUT_SCORE = 1.0f;
+const float ScoringParamsG::GESTURE_MAX_OUTPUT_SCORE_PER_INPUT = 0.25f;
+} // namespace latinime
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_SCORING_PARAMS_G_H
+#define LATINIME_SCORING_PARAMS_G_H
+
+#include "defines.h"
+
+namespace latinime {
+
+// Parameters of the gesture suggest policy. All spatial costs are in the unit of the negative
+// log probabilities computed by ProximityInfoState for sampled points.
+class ScoringParamsG {
+ public:
+    static const float MAX_SPATIAL_DISTANCE;
+    static const int THRESHOLD_NEXT_WORD_PROBABILITY;
+    static const int THRESHOLD_NEXT_WORD_PROBABILITY_FOR_CAPPED;
+    static const int THRESHOLD_SHORT_WORD_LENGTH;
+    static const float AUTOCORRECT_OUTPUT_THRESHOLD;
+    static const int MAX_CACHE_DIC_NODE_SIZE;
+    static const int MAX_CACHE_DIC_NODE_SIZE_FOR_LOW_PROBABILITY_LOCALE;
+    static const float LOCALE_WEIGHT_THRESHOLD_FOR_SMALL_CACHE_SIZE;
+    static const float LOCALE_WEIGHT_THRESHOLD_FOR_SPACE_OMISSION;
+
+    static const float DISTANCE_WEIGHT_LANGUAGE;
+    static const float DETOUR_COST_PER_KEY_WIDTH;
+    static const float DOUBLE_LETTER_COST;
+    static const float DOUBLE_LETTER_COST_FOR_A_DOUBLE_LETTER;
+    static const float DOUBLE_LETTER_COST_FOR_A_STRONG_DOUBLE_LETTER;
+    static const float INTENTIONAL_OMISSION_COST;
+    static const float SPACE_OMISSION_COST;
+    static const float COST_FIRST_COMPLETION;
+    static const float COST_COMPLETION;
+    static const float HAS_MULTI_WORD_TERMINAL_COST;
+    static const float GESTURE_BASE_OUTPUT_SCORE;
+    static const float GESTURE_MAX_OUTPUT_SCORE_PER_INPUT;
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(ScoringParamsG);
+};
+} // namespace latinime
+#endif // LATINIME_SCORING_PARAMS_G_H
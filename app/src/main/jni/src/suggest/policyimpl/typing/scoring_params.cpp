@@ -33,6 +33,12 @@ const float ScoringParams::DIGRAPH_PENALTY_FOR_EXACT_MATCH = 0.03f;
 const int ScoringParams::MAX_CACHE_DIC_NODE_SIZE = 170;
 const int ScoringParams::MAX_CACHE_DIC_NODE_SIZE_FOR_SINGLE_POINT = 310;
 const int ScoringParams::MAX_CACHE_DIC_NODE_SIZE_FOR_LOW_PROBABILITY_LOCALE = 50;
+// The typed word is found with any beam, so a small one is enough for its completions and the
+// close corrections that could outrank it.
+const int ScoringParams::MAX_CACHE_DIC_NODE_SIZE_FOR_CONFIDENT_EXACT_MATCH = 60;
+const int ScoringParams::THRESHOLD_PROBABILITY_FOR_CONFIDENT_EXACT_MATCH = 180;
+// About a third of the most common key width away from the key center.
+const float ScoringParams::THRESHOLD_NORMALIZED_SQUARED_LENGTH_FOR_CONFIDENT_EXACT_MATCH = 0.1f;
 const int ScoringParams::THRESHOLD_SHORT_WORD_LENGTH = 4;
 
 const float ScoringParams::DISTANCE_WEIGHT_LENGTH = 0.1524f;
@@ -31,6 +31,9 @@ class ScoringParams {
     static const int MAX_CACHE_DIC_NODE_SIZE;
     static const int MAX_CACHE_DIC_NODE_SIZE_FOR_SINGLE_POINT;
     static const int MAX_CACHE_DIC_NODE_SIZE_FOR_LOW_PROBABILITY_LOCALE;
+    static const int MAX_CACHE_DIC_NODE_SIZE_FOR_CONFIDENT_EXACT_MATCH;
+    static const int THRESHOLD_PROBABILITY_FOR_CONFIDENT_EXACT_MATCH;
+    static const float THRESHOLD_NORMALIZED_SQUARED_LENGTH_FOR_CONFIDENT_EXACT_MATCH;
     static const int THRESHOLD_SHORT_WORD_LENGTH;
 
     static const float EXACT_MATCH_PROMOTION;
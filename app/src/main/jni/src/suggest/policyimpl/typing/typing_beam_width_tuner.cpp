@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/policyimpl/typing/typing_beam_width_tuner.h"
+
+#include <algorithm>
+
+#include "suggest/policyimpl/typing/scoring_params.h"
+
+namespace latinime {
+
+const int TypingBeamWidthTuner::DEFAULT_BEAM_WIDTH = ScoringParams::MAX_CACHE_DIC_NODE_SIZE;
+const int TypingBeamWidthTuner::MIN_BEAM_WIDTH = 60;
+const int TypingBeamWidthTuner::MAX_BEAM_WIDTH = 310;
+// About one frame at 60fps.
+const int TypingBeamWidthTuner::DEFAULT_SEARCH_TIME_BUDGET_US = 16000;
+const int TypingBeamWidthTuner::OVER_BUDGET_SEARCH_COUNT_TO_SHRINK = 3;
+const int TypingBeamWidthTuner::UNDER_BUDGET_SEARCH_COUNT_TO_GROW = 10;
+const float TypingBeamWidthTuner::HEADROOM_RATE = 0.5f;
+const float TypingBeamWidthTuner::SHRINK_RATE = 0.8f;
+const float TypingBeamWidthTuner::GROW_RATE = 1.1f;
+
+TypingBeamWidthTuner TypingBeamWidthTuner::sInstance;
+
+void TypingBeamWidthTuner::onSearchFinished(const int64_t elapsedTimeUs, const int timeBudgetUs) {
+    if (mFixedBeamWidth.load(std::memory_order_relaxed) > 0) {
+        return;
+    }
+    const int64_t budgetUs = (timeBudgetUs > 0) ? timeBudgetUs : DEFAULT_SEARCH_TIME_BUDGET_US;
+    if (elapsedTimeUs > budgetUs) {
+        mUnderBudgetSearchCount.store(0, std::memory_order_relaxed);
+        if (mOverBudgetSearchCount.fetch_add(1, std::memory_order_relaxed) + 1
+                >= OVER_BUDGET_SEARCH_COUNT_TO_SHRINK) {
+            mOverBudgetSearchCount.store(0, std::memory_order_relaxed);
+            updateBeamWidth(SHRINK_RATE);
+        }
+    } else if (static_cast<float>(elapsedTimeUs) < static_cast<float>(budgetUs) * HEADROOM_RATE) {
+        mOverBudgetSearchCount.store(0, std::memory_order_relaxed);
+        if (mUnderBudgetSearchCount.fetch_add(1, std::memory_order_relaxed) + 1
+                >= UNDER_BUDGET_SEARCH_COUNT_TO_GROW) {
+            mUnderBudgetSearchCount.store(0, std::memory_order_relaxed);
+            updateBeamWidth(GROW_RATE);
+        }
+    } else {
+        // Close to the budget; keep the current beam.
+        mOverBudgetSearchCount.store(0, std::memory_order_relaxed);
+        mUnderBudgetSearchCount.store(0, std::memory_order_relaxed);
+    }
+}
+
+void TypingBeamWidthTuner::updateBeamWidth(const float rate) {
+    int beamWidth = mBeamWidth.load(std::memory_order_relaxed);
+    int newBeamWidth = 0;
+    do {
+        newBeamWidth = static_cast<int>(static_cast<float>(beamWidth) * rate);
+        if (newBeamWidth == beamWidth) {
+            // Make sure small beams can still move.
+            newBeamWidth += (rate > 1.0f) ? 1 : -1;
+        }
+        newBeamWidth = std::max(MIN_BEAM_WIDTH, std::min(MAX_BEAM_WIDTH, newBeamWidth));
+    } while (!mBeamWidth.compare_exchange_weak(beamWidth, newBeamWidth,
+            std::memory_order_relaxed));
+    if (DEBUG_DICT) {
+        AKLOGI("Typing beam width: %d -> %d", beamWidth, newBeamWidth);
+    }
+}
+} // namespace latinime
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_TYPING_BEAM_WIDTH_TUNER_H
+#define LATINIME_TYPING_BEAM_WIDTH_TUNER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "defines.h"
+
+namespace latinime {
+
+// Adapts the number of active DicNodes kept for typing searches to the observed search cost. The
+// beam shrinks when consecutive searches run over their time budget and grows back when there is
+// enough headroom. The state is process-wide because it reflects the speed of the device; it is
+// kept in atomics so that sessions on other threads can read and update it.
+class TypingBeamWidthTuner {
+ public:
+    static TypingBeamWidthTuner *getInstance() { return &sInstance; }
+
+    TypingBeamWidthTuner()
+            : mBeamWidth(DEFAULT_BEAM_WIDTH), mFixedBeamWidth(0), mOverBudgetSearchCount(0),
+              mUnderBudgetSearchCount(0) {}
+
+    int getBeamWidth() const {
+        const int fixedBeamWidth = mFixedBeamWidth.load(std::memory_order_relaxed);
+        return fixedBeamWidth > 0 ? fixedBeamWidth : mBeamWidth.load(std::memory_order_relaxed);
+    }
+
+    // Pins the beam width, e.g. to compare engine configurations on the same input. A
+    // non-positive beamWidth returns to the adapted beam width.
+    void setFixedBeamWidth(const int beamWidth) {
+        mFixedBeamWidth.store(std::max(0, beamWidth), std::memory_order_relaxed);
+    }
+
+    // Records the elapsed time of a finished typing search. A non-positive timeBudgetUs means
+    // that the search had no time limit; DEFAULT_SEARCH_TIME_BUDGET_US is used then.
+    void onSearchFinished(const int64_t elapsedTimeUs, const int timeBudgetUs);
+
+    static const int DEFAULT_BEAM_WIDTH;
+    static const int MIN_BEAM_WIDTH;
+    static const int MAX_BEAM_WIDTH;
+    static const int DEFAULT_SEARCH_TIME_BUDGET_US;
+    static const int OVER_BUDGET_SEARCH_COUNT_TO_SHRINK;
+    static const int UNDER_BUDGET_SEARCH_COUNT_TO_GROW;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(TypingBeamWidthTuner);
+
+    static const float HEADROOM_RATE;
+    static const float SHRINK_RATE;
+    static const float GROW_RATE;
+    static TypingBeamWidthTuner sInstance;
+
+    void updateBeamWidth(const float rate);
+
+    std::atomic<int> mBeamWidth;
+    std::atomic<int> mFixedBeamWidth;
+    std::atomic<int> mOverBudgetSearchCount;
+    std::atomic<int> mUnderBudgetSearchCount;
+};
+} // namespace latinime
+#endif // LATINIME_TYPING_BEAM_WIDTH_TUNER_H
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/policyimpl/typing/typing_latency_guard.h"
+
+#include <algorithm>
+
+#include "suggest/policyimpl/typing/typing_beam_width_tuner.h"
+
+namespace latinime {
+
+const int TypingLatencyGuard::WINDOW_SIZE;
+const int TypingLatencyGuard::PERCENTILE = 95;
+// The same as the headroom of TypingBeamWidthTuner, so that a level is only restored when the
+// beam can grow too.
+const float TypingLatencyGuard::HEADROOM_RATE = 0.5f;
+
+TypingLatencyGuard TypingLatencyGuard::sInstance;
+
+void TypingLatencyGuard::onSearchFinished(const int64_t elapsedTimeUs, const int timeBudgetUs) {
+    const int64_t budgetUs = (timeBudgetUs > 0)
+            ? timeBudgetUs : TypingBeamWidthTuner::DEFAULT_SEARCH_TIME_BUDGET_US;
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLatenciesUs[mNextLatencyIndex] = elapsedTimeUs;
+    mNextLatencyIndex = (mNextLatencyIndex + 1) % WINDOW_SIZE;
+    mLatencyCount = std::min(mLatencyCount + 1, WINDOW_SIZE);
+    if (mLatencyCount < WINDOW_SIZE) {
+        return;
+    }
+    const int64_t percentileLatencyUs = getPercentileLatencyUsLocked();
+    const int level = mLevel.load(std::memory_order_relaxed);
+    int newLevel = level;
+    if (percentileLatencyUs > budgetUs) {
+        newLevel = std::min(level + 1, LEVEL_COUNT - 1);
+    } else if (static_cast<float>(percentileLatencyUs)
+            < static_cast<float>(budgetUs) * HEADROOM_RATE) {
+        newLevel = std::max(level - 1, static_cast<int>(LEVEL_FULL));
+    }
+    if (newLevel == level) {
+        return;
+    }
+    if (DEBUG_DICT) {
+        AKLOGI("Typing degradation level: %d -> %d (p%d latency %lld us, budget %lld us)",
+                level, newLevel, PERCENTILE, static_cast<long long>(percentileLatencyUs),
+                static_cast<long long>(budgetUs));
+    }
+    mLevel.store(newLevel, std::memory_order_relaxed);
+    mLatencyCount = 0;
+    mNextLatencyIndex = 0;
+}
+
+int64_t TypingLatencyGuard::getPercentileLatencyUsLocked() const {
+    int64_t latenciesUs[WINDOW_SIZE];
+    std::copy(mLatenciesUs, mLatenciesUs + mLatencyCount, latenciesUs);
+    // The nearest rank: the smallest latency that at least PERCENTILE% of the searches are not
+    // slower than.
+    const int rank = (mLatencyCount * PERCENTILE + 99) / 100;
+    int64_t *const percentile = latenciesUs + std::max(rank - 1, 0);
+    std::nth_element(latenciesUs, percentile, latenciesUs + mLatencyCount);
+    return *percentile;
+}
+} // namespace latinime
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_TYPING_LATENCY_GUARD_H
+#define LATINIME_TYPING_LATENCY_GUARD_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "defines.h"
+
+namespace latinime {
+
+// Keeps the typing searches within their time budget on slow devices by turning corrections off
+// step by step. The level goes down the ladder when the 95th percentile of the recent search
+// latencies is over the budget, and back up when it is well under it. TypingBeamWidthTuner adapts
+// the beam continuously to single searches; this reacts to a sustained tail latency instead. The
+// state is process-wide for the same reason as the tuner's.
+class TypingLatencyGuard {
+ public:
+    // Each level includes the degradations of the levels before it.
+    enum Level {
+        LEVEL_FULL = 0,
+        // The beam is capped to TypingBeamWidthTuner::MIN_BEAM_WIDTH.
+        LEVEL_SMALL_BEAM,
+        // No look-ahead corrections, which include the space substitution.
+        LEVEL_NO_LOOK_AHEAD_CORRECTION,
+        // No space omission either, so no multi-word suggestions.
+        LEVEL_NO_MULTI_WORD,
+        LEVEL_COUNT
+    };
+
+    static TypingLatencyGuard *getInstance() { return &sInstance; }
+
+    TypingLatencyGuard()
+            : mLevel(LEVEL_FULL), mMutex(), mLatenciesUs(), mLatencyCount(0),
+              mNextLatencyIndex(0) {}
+
+    int getLevel() const {
+        return mLevel.load(std::memory_order_relaxed);
+    }
+
+    bool isAtLeast(const Level level) const {
+        return getLevel() >= level;
+    }
+
+    // Records the elapsed time of a finished typing search. A non-positive timeBudgetUs means
+    // that the search had no time limit; TypingBeamWidthTuner::DEFAULT_SEARCH_TIME_BUDGET_US is
+    // used then.
+    void onSearchFinished(const int64_t elapsedTimeUs, const int timeBudgetUs);
+
+    // The number of searches the percentile is taken over. The window starts empty again after
+    // each level change, so that the new level is judged by its own searches.
+    static const int WINDOW_SIZE = 32;
+    static const int PERCENTILE;
+    static const float HEADROOM_RATE;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(TypingLatencyGuard);
+
+    static TypingLatencyGuard sInstance;
+
+    int64_t getPercentileLatencyUsLocked() const;
+
+    std::atomic<int> mLevel;
+    std::mutex mMutex;
+    // Ring buffer of the latest latencies.
+    int64_t mLatenciesUs[WINDOW_SIZE];
+    int mLatencyCount;
+    int mNextLatencyIndex;
+};
+} // namespace latinime
+#endif // LATINIME_TYPING_LATENCY_GUARD_H
@@ -22,6 +22,7 @@
 #include "suggest/core/policy/scoring.h"
 #include "suggest/core/session/dic_traverse_session.h"
 #include "suggest/policyimpl/typing/scoring_params.h"
+#include "suggest/policyimpl/typing/typing_segmentation.h"
 
 namespace latinime {
 
@@ -32,9 +33,13 @@ class TypingScoring : public Scoring {
  public:
     static const TypingScoring *getInstance() { return &sInstance; }
 
+    // The most probable string of long typed input is its best segmentation into words.
     AK_FORCE_INLINE void getMostProbableString(const DicTraverseSession *const traverseSession,
             const float weightOfLangModelVsSpatialModel,
-            SuggestionResults *const outSuggestionResults) const {}
+            SuggestionResults *const outSuggestionResults) const {
+        TypingSegmentation::outputSegmentation(traverseSession, this,
+                weightOfLangModelVsSpatialModel, outSuggestionResults);
+    }
 
     AK_FORCE_INLINE float getAdjustedWeightOfLangModelVsSpatialModel(
             DicTraverseSession *const traverseSession, DicNode *const terminals,
@@ -104,8 +109,10 @@ class TypingScoring : public Scoring {
 
     AK_FORCE_INLINE bool sameAsTyped(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode) const {
+        int codePoints[MAX_WORD_LENGTH];
+        dicNode->outputCodePoints(dicNode->getNodeCodePointCount(), codePoints);
         return traverseSession->getProximityInfoState(0)->sameAsTyped(
-                dicNode->getOutputWordBuf(), dicNode->getNodeCodePointCount());
+                codePoints, dicNode->getNodeCodePointCount());
     }
 
  private:
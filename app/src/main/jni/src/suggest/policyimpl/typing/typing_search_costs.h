@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_TYPING_SEARCH_COSTS_H
+#define LATINIME_TYPING_SEARCH_COSTS_H
+
+#include <algorithm>
+
+#include "defines.h"
+#include "suggest/policyimpl/typing/scoring_params.h"
+
+namespace latinime {
+
+// The costs and conditions of the typing policies that combine ScoringParams with the dictionary
+// and the options of a search. They are computed once per search by DicTraverseSession, so that
+// the per-DicNode functions of TypingTraversal and TypingWeighting read them instead of multiplying
+// and comparing the same values for every DicNode.
+class TypingSearchCosts {
+ public:
+    TypingSearchCosts()
+            : mSpaceOmissionCost(0.0f), mSpaceSubstitutionCostRate(0.0f),
+              mMinCorrectionCostPerInput(0.0f), mAllowsSpaceOmission(false),
+              mAllowsSpaceSubstitution(false) {}
+
+    void init(const float multiWordCostMultiplier, const float weightForLocale) {
+        mSpaceOmissionCost = ScoringParams::SPACE_OMISSION_COST * multiWordCostMultiplier;
+        mSpaceSubstitutionCostRate =
+                ScoringParams::SPACE_SUBSTITUTION_COST * multiWordCostMultiplier;
+        // Each input point is consumed by a match, a substitution, a space substitution or a
+        // terminal insertion, or together with the next point by an insertion or a
+        // transposition. Half of the costs of the latter two are charged to each of their points.
+        mMinCorrectionCostPerInput = std::min({ScoringParams::INSERTION_COST_SAME_CHAR * 0.5f,
+                ScoringParams::TRANSPOSITION_COST * 0.5f, ScoringParams::TERMINAL_INSERTION_COST,
+                ScoringParams::SUBSTITUTION_COST, ScoringParams::ADDITIONAL_PROXIMITY_COST});
+        // Space omission and substitution are heavy, so they are skipped if the weight for this
+        // language is low because we anticipate the suggestions out of this dictionary are not
+        // for the language the user intends to type in.
+        mAllowsSpaceOmission =
+                weightForLocale >= ScoringParams::LOCALE_WEIGHT_THRESHOLD_FOR_SPACE_OMISSION;
+        mAllowsSpaceSubstitution =
+                weightForLocale >= ScoringParams::LOCALE_WEIGHT_THRESHOLD_FOR_SPACE_SUBSTITUTION;
+    }
+
+    // The cost of an omitted space, scaled by the multi-word cost multiplier of the dictionary.
+    float getSpaceOmissionCost() const { return mSpaceOmissionCost; }
+    // The cost per distance to the space key of a substituted space, scaled the same way.
+    float getSpaceSubstitutionCostRate() const { return mSpaceSubstitutionCostRate; }
+    // The smallest cost of a correction that consumes an input point.
+    float getMinCorrectionCostPerInput() const { return mMinCorrectionCostPerInput; }
+    bool allowsSpaceOmission() const { return mAllowsSpaceOmission; }
+    bool allowsSpaceSubstitution() const { return mAllowsSpaceSubstitution; }
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(TypingSearchCosts);
+
+    float mSpaceOmissionCost;
+    float mSpaceSubstitutionCostRate;
+    float mMinCorrectionCostPerInput;
+    bool mAllowsSpaceOmission;
+    bool mAllowsSpaceSubstitution;
+};
+} // namespace latinime
+#endif // LATINIME_TYPING_SEARCH_COSTS_H
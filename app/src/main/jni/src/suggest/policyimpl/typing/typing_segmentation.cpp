@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/policyimpl/typing/typing_segmentation.h"
+
+#include <algorithm>
+
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "suggest/core/dicnode/dic_node.h"
+#include "dictionary/property/word_attributes.h"
+#include "suggest/core/dictionary/dictionary.h"
+#include "suggest/core/dictionary/error_type_utils.h"
+#include "suggest/core/layout/proximity_info_state.h"
+#include "suggest/core/policy/scoring.h"
+#include "suggest/core/result/suggestion_results.h"
+#include "suggest/core/session/dic_traverse_session.h"
+#include "suggest/core/suggest_options.h"
+#include "suggest/policyimpl/typing/scoring_params.h"
+#include "suggest/policyimpl/typing/typing_latency_guard.h"
+#include "utils/char_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+// The same as SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT; shorter input is left
+// to the search, which can also correct the words.
+const int TypingSegmentation::MIN_INPUT_SIZE = 16;
+const int TypingSegmentation::MAX_STATE_COUNT_PER_INDEX;
+const int TypingSegmentation::MAX_WORD_CODE_POINT_COUNT = 24;
+// One typo in the words so far, so that mistyped long input is still split by the search.
+const int TypingSegmentation::MAX_CORRECTION_COUNT_FOR_SPACE_OMISSION = 1;
+
+/* static */ bool TypingSegmentation::isEnabled(const DicTraverseSession *const traverseSession) {
+    if (traverseSession->getInputSize() < MIN_INPUT_SIZE) {
+        return false;
+    }
+    if (TypingLatencyGuard::getInstance()->isAtLeast(TypingLatencyGuard::LEVEL_NO_MULTI_WORD)) {
+        return false;
+    }
+    // The same condition as the space omission of TypingTraversal.
+    return traverseSession->getTypingSearchCosts()->allowsSpaceOmission();
+}
+
+/* static */ bool TypingSegmentation::allowsSpaceOmissionAfter(const DicNode *const dicNode) {
+    return dicNode->getProximityCorrectionCount() + dicNode->getEditCorrectionCount()
+            <= MAX_CORRECTION_COUNT_FOR_SPACE_OMISSION;
+}
+
+/* static */ void TypingSegmentation::outputSegmentation(
+        const DicTraverseSession *const traverseSession, const Scoring *const scoringPolicy,
+        const float weightOfLangModelVsSpatialModel,
+        SuggestionResults *const outSuggestionResults) {
+    if (!isEnabled(traverseSession)) {
+        return;
+    }
+    const ProximityInfoState *const pInfoState = traverseSession->getProximityInfoState(0);
+    const int inputSize = std::min(traverseSession->getInputSize(), MAX_WORD_LENGTH);
+    const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy =
+            traverseSession->getDictionaryStructurePolicy();
+    const bool blocksOffensiveWords =
+            traverseSession->getSuggestOptions()->blockOffensiveWords();
+    int inputCodePoints[MAX_WORD_LENGTH];
+    // The matched costs of the typed code points, which are the same for all segmentations.
+    float inputSpatialCost = 0.0f;
+    for (int i = 0; i < inputSize; ++i) {
+        inputCodePoints[i] = pInfoState->getPrimaryCodePointAt(i);
+        inputSpatialCost += ScoringParams::DISTANCE_WEIGHT_LENGTH
+                * pInfoState->getPointToKeySweetSpotFactor(i,
+                        CharUtils::toBaseLowerCase(inputCodePoints[i]));
+    }
+    const float spaceOmissionCost =
+            traverseSession->getTypingSearchCosts()->getSpaceOmissionCost();
+
+    // states[index * MAX_STATE_COUNT_PER_INDEX + i] is the i-th segmentation ending at index.
+    State states[(MAX_WORD_LENGTH + 1) * MAX_STATE_COUNT_PER_INDEX];
+    int stateCounts[MAX_WORD_LENGTH + 1] = {};
+    for (int endIndex = 1; endIndex <= inputSize; ++endIndex) {
+        const bool isLastWord = endIndex == inputSize;
+        State *const endStates = states + endIndex * MAX_STATE_COUNT_PER_INDEX;
+        for (int startIndex = std::max(0, endIndex - MAX_WORD_CODE_POINT_COUNT);
+                startIndex < endIndex; ++startIndex) {
+            const bool isFirstWord = startIndex == 0;
+            if (!isFirstWord && stateCounts[startIndex] == 0) {
+                continue;
+            }
+            int wordIds[WORD_FORM_COUNT];
+            getWordIds(dictionaryStructurePolicy, inputCodePoints + startIndex,
+                    endIndex - startIndex, wordIds);
+            for (int form = 0; form < WORD_FORM_COUNT; ++form) {
+                const int wordId = wordIds[form];
+                if (wordId == NOT_A_WORD_ID) {
+                    continue;
+                }
+                // The same demotion as TypingWeighting::getMatchedCost().
+                const float capitalizationCost = (form == WORD_FORM_CAPITALIZED && !isFirstWord)
+                        ? ScoringParams::COST_SECOND_OR_LATER_WORD_FIRST_CHAR_UPPERCASE : 0.0f;
+                const int prevStateCount = isFirstWord ? 1 : stateCounts[startIndex];
+                for (int i = 0; i < prevStateCount; ++i) {
+                    const int prevStateIndex =
+                            isFirstWord ? NOT_AN_INDEX : startIndex * MAX_STATE_COUNT_PER_INDEX + i;
+                    const State *const prevState =
+                            isFirstWord ? nullptr : &states[prevStateIndex];
+                    const WordAttributes wordAttributes =
+                            traverseSession->getWordAttributesInContext(isFirstWord
+                                    ? traverseSession->getPrevWordIds()
+                                    : WordIdArrayView::singleElementView(&prevState->mWordId),
+                                    wordId, nullptr /* multiBigramMap */);
+                    if (wordAttributes.getProbability() == NOT_A_PROBABILITY
+                            || wordAttributes.isBlacklisted() || wordAttributes.isNotAWord()) {
+                        continue;
+                    }
+                    // The words are exact matches, so only the last one may be offensive as in
+                    // SuggestionsOutputUtils::shouldBlockWord().
+                    if (blocksOffensiveWords && wordAttributes.isPossiblyOffensive()
+                            && !isLastWord) {
+                        continue;
+                    }
+                    // The same threshold as TypingTraversal::isGoodToTraverseNextWord().
+                    if (!isLastWord && wordAttributes.getProbability()
+                            < ScoringParams::THRESHOLD_NEXT_WORD_PROBABILITY) {
+                        continue;
+                    }
+                    // The same language cost as DicNodeUtils::getBigramNodeImprobability().
+                    const float languageCost = static_cast<float>(
+                            MAX_PROBABILITY - wordAttributes.getProbability())
+                            / static_cast<float>(MAX_PROBABILITY)
+                            * ScoringParams::DISTANCE_WEIGHT_LANGUAGE;
+                    State state;
+                    state.mSpatialCost = (isFirstWord ? 0.0f
+                            : prevState->mSpatialCost + spaceOmissionCost) + capitalizationCost;
+                    state.mLanguageCost = (isFirstWord ? 0.0f : prevState->mLanguageCost)
+                            + languageCost;
+                    state.mWordId = wordId;
+                    state.mWordStartIndex = startIndex;
+                    state.mPrevStateIndex = prevStateIndex;
+                    state.mWordCount = isFirstWord ? 1 : prevState->mWordCount + 1;
+                    addState(state, weightOfLangModelVsSpatialModel, endStates,
+                            &stateCounts[endIndex]);
+                }
+            }
+        }
+    }
+
+    const State *bestState = nullptr;
+    for (int i = 0; i < stateCounts[inputSize]; ++i) {
+        const State *const state = &states[inputSize * MAX_STATE_COUNT_PER_INDEX + i];
+        // A single word is left to the search.
+        if (state->mWordCount >= 2 && (!bestState
+                || getCompoundCost(*state, weightOfLangModelVsSpatialModel)
+                        < getCompoundCost(*bestState, weightOfLangModelVsSpatialModel))) {
+            bestState = state;
+        }
+    }
+    if (!bestState) {
+        return;
+    }
+    int wordIds[MAX_WORD_LENGTH];
+    int wordCount = 0;
+    int secondWordStartIndex = NOT_AN_INDEX;
+    for (const State *state = bestState; state;
+            state = (state->mPrevStateIndex == NOT_AN_INDEX) ? nullptr
+                    : &states[state->mPrevStateIndex]) {
+        wordIds[wordCount++] = state->mWordId;
+        if (state->mWordCount == 2) {
+            secondWordStartIndex = state->mWordStartIndex;
+        }
+    }
+    int codePoints[MAX_WORD_LENGTH];
+    int codePointCount = 0;
+    for (int i = wordCount - 1; i >= 0; --i) {
+        if (i != wordCount - 1) {
+            if (codePointCount >= MAX_WORD_LENGTH) {
+                return;
+            }
+            codePoints[codePointCount++] = KEYCODE_SPACE;
+        }
+        int wordCodePoints[MAX_WORD_LENGTH];
+        const int wordCodePointCount = dictionaryStructurePolicy->
+                getCodePointsAndReturnCodePointCount(wordIds[i], MAX_WORD_LENGTH, wordCodePoints);
+        if (wordCodePointCount <= 0 || codePointCount + wordCodePointCount > MAX_WORD_LENGTH) {
+            return;
+        }
+        std::copy(wordCodePoints, wordCodePoints + wordCodePointCount,
+                codePoints + codePointCount);
+        codePointCount += wordCodePointCount;
+    }
+    // Scored like the multi-word terminals of the search, see TypingWeighting. The input is
+    // always long enough for SuggestionsOutputUtils to force the autocorrection to a multi-word
+    // suggestion, and the words match the input exactly. An exact single word still wins by
+    // its exact match promotion.
+    const float compoundDistance = inputSpatialCost + ScoringParams::HAS_MULTI_WORD_TERMINAL_COST
+            + getCompoundCost(*bestState, weightOfLangModelVsSpatialModel);
+    const int finalScore = scoringPolicy->calculateFinalScore(compoundDistance, inputSize,
+            ErrorTypeUtils::NEW_WORD, scoringPolicy->autoCorrectsToMultiWordSuggestionIfTop(),
+            false /* boostExactMatches */, false /* hasProbabilityZero */);
+    outSuggestionResults->addSuggestion(codePoints, codePointCount, finalScore,
+            Dictionary::KIND_CORRECTION | Dictionary::KIND_FLAG_APPROPRIATE_FOR_AUTOCORRECTION,
+            traverseSession->isOnlyOnePointerUsed(0 /* pointerId */) ? secondWordStartIndex
+                    : NOT_AN_INDEX,
+            NOT_A_FIRST_WORD_CONFIDENCE);
+}
+
+// Looks the typed code points up case-insensitively, and capitalized for words like "I" that
+// the dictionary may also have in lower case with probability 0.
+/* static */ void TypingSegmentation::getWordIds(
+        const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
+        const int *const codePoints, const int codePointCount, int *const outWordIds) {
+    outWordIds[WORD_FORM_AS_TYPED] = dictionaryStructurePolicy->getWordId(
+            CodePointArrayView(codePoints, codePointCount), true /* forceLowerCaseSearch */);
+    outWordIds[WORD_FORM_CAPITALIZED] = NOT_A_WORD_ID;
+    if (codePoints[0] < 'a' || codePoints[0] > 'z') {
+        return;
+    }
+    int capitalizedCodePoints[MAX_WORD_LENGTH];
+    capitalizedCodePoints[0] = codePoints[0] - 'a' + 'A';
+    for (int i = 1; i < codePointCount; ++i) {
+        capitalizedCodePoints[i] = CharUtils::toLowerCase(codePoints[i]);
+    }
+    outWordIds[WORD_FORM_CAPITALIZED] = dictionaryStructurePolicy->getWordId(
+            CodePointArrayView(capitalizedCodePoints, codePointCount),
+            false /* forceLowerCaseSearch */);
+}
+
+// Keeps the MAX_STATE_COUNT_PER_INDEX cheapest states. Of the states with the same last word, only
+// the cheapest one is kept since the following words only depend on the last one.
+/* static */ void TypingSegmentation::addState(const State &state,
+        const float weightOfLangModelVsSpatialModel, State *const states, int *const stateCount) {
+    const float cost = getCompoundCost(state, weightOfLangModelVsSpatialModel);
+    int replacedIndex = NOT_AN_INDEX;
+    for (int i = 0; i < *stateCount; ++i) {
+        if (states[i].mWordId == state.mWordId) {
+            replacedIndex = i;
+            break;
+        }
+    }
+    if (replacedIndex == NOT_AN_INDEX) {
+        if (*stateCount < MAX_STATE_COUNT_PER_INDEX) {
+            states[(*stateCount)++] = state;
+            return;
+        }
+        replacedIndex = 0;
+        for (int i = 1; i < *stateCount; ++i) {
+            if (getCompoundCost(states[i], weightOfLangModelVsSpatialModel)
+                    > getCompoundCost(states[replacedIndex], weightOfLangModelVsSpatialModel)) {
+                replacedIndex = i;
+            }
+        }
+    }
+    if (cost < getCompoundCost(states[replacedIndex], weightOfLangModelVsSpatialModel)) {
+        states[replacedIndex] = state;
+    }
+}
+} // namespace latinime
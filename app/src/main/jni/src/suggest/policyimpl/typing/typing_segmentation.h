@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_TYPING_SEGMENTATION_H
+#define LATINIME_TYPING_SEGMENTATION_H
+
+#include "defines.h"
+
+namespace latinime {
+
+class DicNode;
+class DicTraverseSession;
+class DictionaryStructureWithBufferPolicy;
+class Scoring;
+class SuggestionResults;
+
+// Splits long input that has no spaces into dictionary words. Restarting the beam search at the
+// trie root on every terminal makes the DicNode count explode with the input length, mostly by
+// the combinations of the corrections of the words. For long input, the search only omits spaces
+// after DicNodes with at most MAX_CORRECTION_COUNT_FOR_SPACE_OMISSION corrections, which still
+// splits input with a typo, and this stage adds the most probable segmentation of the typed code
+// points. It is a Viterbi search over the input indices that keeps the MAX_STATE_COUNT_PER_INDEX
+// cheapest segmentations ending at each index, weighted by the bigram costs of the words. The
+// cost is bounded by the input size times MAX_WORD_CODE_POINT_COUNT times
+// MAX_STATE_COUNT_PER_INDEX.
+class TypingSegmentation {
+ public:
+    // Returns whether the input is long enough to be segmented by this stage, which limits the
+    // space omission of the search.
+    static bool isEnabled(const DicTraverseSession *const traverseSession);
+
+    // Returns whether the search may omit a space after the terminal DicNode when this stage is
+    // enabled.
+    static bool allowsSpaceOmissionAfter(const DicNode *const dicNode);
+
+    // Adds the best segmentation of at least two words, if any.
+    static void outputSegmentation(const DicTraverseSession *const traverseSession,
+            const Scoring *const scoringPolicy, const float weightOfLangModelVsSpatialModel,
+            SuggestionResults *const outSuggestionResults);
+
+    static const int MIN_INPUT_SIZE;
+    static const int MAX_STATE_COUNT_PER_INDEX = 4;
+    static const int MAX_WORD_CODE_POINT_COUNT;
+    static const int MAX_CORRECTION_COUNT_FOR_SPACE_OMISSION;
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(TypingSegmentation);
+
+    // A segmentation of the input up to an index whose last word is mWordId.
+    struct State {
+        float mSpatialCost;
+        float mLanguageCost;
+        int mWordId;
+        int mWordStartIndex;
+        // The index of the state the segmentation before mWordStartIndex ends with, or
+        // NOT_AN_INDEX for the first word.
+        int mPrevStateIndex;
+        int mWordCount;
+    };
+
+    static float getCompoundCost(const State &state, const float weightOfLangModelVsSpatialModel) {
+        return state.mSpatialCost + state.mLanguageCost * weightOfLangModelVsSpatialModel;
+    }
+
+    // The forms the typed code points of a word are looked up in.
+    enum WordForm {
+        WORD_FORM_AS_TYPED = 0,
+        WORD_FORM_CAPITALIZED,
+        WORD_FORM_COUNT
+    };
+
+    static void getWordIds(
+            const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
+            const int *const codePoints, const int codePointCount, int *const outWordIds);
+    static void addState(const State &state, const float weightOfLangModelVsSpatialModel,
+            State *const states, int *const stateCount);
+};
+} // namespace latinime
+#endif // LATINIME_TYPING_SEGMENTATION_H
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_TYPING_SUGGEST_H
+#define LATINIME_TYPING_SUGGEST_H
+
+#include "defines.h"
+#include "suggest/core/suggest.h"
+#include "suggest/policyimpl/typing/typing_scoring.h"
+#include "suggest/policyimpl/typing/typing_traversal.h"
+#include "suggest/policyimpl/typing/typing_weighting.h"
+
+namespace latinime {
+
+// The typing search with TypingTraversal and TypingWeighting called directly instead of through
+// TypingSuggestPolicy.
+class TypingSuggest : public SuggestImpl<TypingTraversal, TypingWeighting> {
+ public:
+    AK_FORCE_INLINE TypingSuggest()
+            : SuggestImpl(TypingTraversal::getInstance(), TypingScoring::getInstance(),
+                      TypingWeighting::getInstance()) {}
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(TypingSuggest);
+};
+} // namespace latinime
+#endif // LATINIME_TYPING_SUGGEST_H
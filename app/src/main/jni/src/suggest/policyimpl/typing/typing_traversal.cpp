@@ -16,9 +16,49 @@
 
 #include "suggest/policyimpl/typing/typing_traversal.h"
 
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "dictionary/property/word_attributes.h"
+#include "utils/int_array_view.h"
+
 namespace latinime {
 const bool TypingTraversal::CORRECT_OMISSION = true;
 const bool TypingTraversal::CORRECT_NEW_WORD_SPACE_SUBSTITUTION = true;
 const bool TypingTraversal::CORRECT_NEW_WORD_SPACE_OMISSION = true;
 const TypingTraversal TypingTraversal::sInstance;
+
+int TypingTraversal::getMaxCacheSizeForInput(const DicTraverseSession *const traverseSession,
+        const int maxCacheSize) const {
+    const int inputSize = traverseSession->getInputSize();
+    // A single tap is corrected to any key around it, see getMaxCacheSize().
+    if (inputSize <= 1 || inputSize > MAX_WORD_LENGTH
+            || maxCacheSize <= ScoringParams::MAX_CACHE_DIC_NODE_SIZE_FOR_CONFIDENT_EXACT_MATCH
+            || traverseSession->getSuggestOptions()->useFullEditDistance()) {
+        return maxCacheSize;
+    }
+    const ProximityInfoState *const pInfoState = traverseSession->getProximityInfoState(0);
+    if (pInfoState->size() != inputSize) {
+        return maxCacheSize;
+    }
+    int typedCodePoints[MAX_WORD_LENGTH];
+    for (int i = 0; i < inputSize; ++i) {
+        typedCodePoints[i] = pInfoState->getPrimaryCodePointAt(i);
+        if (pInfoState->getPointToKeyLength(i, typedCodePoints[i]) > ScoringParams::
+                THRESHOLD_NORMALIZED_SQUARED_LENGTH_FOR_CONFIDENT_EXACT_MATCH) {
+            return maxCacheSize;
+        }
+    }
+    const int wordId = traverseSession->getDictionaryStructurePolicy()->getWordId(
+            CodePointArrayView(typedCodePoints, inputSize), false /* forceLowerCaseSearch */);
+    if (wordId == NOT_A_WORD_ID) {
+        return maxCacheSize;
+    }
+    const WordAttributes wordAttributes = traverseSession->getWordAttributesInContext(
+            traverseSession->getPrevWordIds(), wordId, nullptr /* multiBigramMap */);
+    if (wordAttributes.isBlacklisted() || wordAttributes.isNotAWord()
+            || wordAttributes.getProbability()
+                    < ScoringParams::THRESHOLD_PROBABILITY_FOR_CONFIDENT_EXACT_MATCH) {
+        return maxCacheSize;
+    }
+    return ScoringParams::MAX_CACHE_DIC_NODE_SIZE_FOR_CONFIDENT_EXACT_MATCH;
+}
 }  // namespace latinime
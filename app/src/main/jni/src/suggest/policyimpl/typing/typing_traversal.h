@@ -17,6 +17,7 @@
 #ifndef LATINIME_TYPING_TRAVERSAL_H
 #define LATINIME_TYPING_TRAVERSAL_H
 
+#include <algorithm>
 #include <cstdint>
 
 #include "defines.h"
@@ -28,10 +29,13 @@
 #include "suggest/core/session/dic_traverse_session.h"
 #include "suggest/core/suggest_options.h"
 #include "suggest/policyimpl/typing/scoring_params.h"
+#include "suggest/policyimpl/typing/typing_beam_width_tuner.h"
+#include "suggest/policyimpl/typing/typing_latency_guard.h"
+#include "suggest/policyimpl/typing/typing_segmentation.h"
 #include "utils/char_utils.h"
 
 namespace latinime {
-class TypingTraversal : public Traversal {
+class TypingTraversal final : public Traversal {
  public:
     static const TypingTraversal *getInstance() { return &sInstance; }
 
@@ -73,16 +77,20 @@ class TypingTraversal : public Traversal {
         return (currentBaseLowerCodePoint != typedBaseLowerCodePoint);
     }
 
+    AK_FORCE_INLINE bool canFilterChildrenByProximity(
+            const DicTraverseSession *const traverseSession, const DicNode *const dicNode,
+            const bool allowsErrorCorrections) const {
+        // Additional proximity chars, substitutions and omissions other than intentional ones
+        // need error corrections, and completions accept all children.
+        return !allowsErrorCorrections && !dicNode->isCompletion(traverseSession->getInputSize());
+    }
+
     AK_FORCE_INLINE bool isSpaceSubstitutionTerminal(
             const DicTraverseSession *const traverseSession, const DicNode *const dicNode) const {
         if (!CORRECT_NEW_WORD_SPACE_SUBSTITUTION) {
             return false;
         }
-        if (traverseSession->getSuggestOptions()->weightForLocale()
-                < ScoringParams::LOCALE_WEIGHT_THRESHOLD_FOR_SPACE_SUBSTITUTION) {
-            // Space substitution is heavy, so we skip doing it if the weight for this language
-            // is low because we anticipate the suggestions out of this dictionary are not for
-            // the language the user intends to type in.
+        if (!traverseSession->getTypingSearchCosts()->allowsSpaceSubstitution()) {
             return false;
         }
         if (!canDoLookAheadCorrection(traverseSession, dicNode)) {
@@ -99,11 +107,16 @@ class TypingTraversal : public Traversal {
         if (!CORRECT_NEW_WORD_SPACE_OMISSION) {
             return false;
         }
-        if (traverseSession->getSuggestOptions()->weightForLocale()
-                < ScoringParams::LOCALE_WEIGHT_THRESHOLD_FOR_SPACE_OMISSION) {
-            // Space omission is heavy, so we skip doing it if the weight for this language
-            // is low because we anticipate the suggestions out of this dictionary are not for
-            // the language the user intends to type in.
+        if (TypingLatencyGuard::getInstance()->isAtLeast(
+                TypingLatencyGuard::LEVEL_NO_MULTI_WORD)) {
+            return false;
+        }
+        if (TypingSegmentation::isEnabled(traverseSession)
+                && !TypingSegmentation::allowsSpaceOmissionAfter(dicNode)) {
+            // Long input is also split into its exact words after the search.
+            return false;
+        }
+        if (!traverseSession->getTypingSearchCosts()->allowsSpaceOmission()) {
             return false;
         }
         const int inputSize = traverseSession->getInputSize();
@@ -132,6 +145,10 @@ class TypingTraversal : public Traversal {
 
     AK_FORCE_INLINE bool canDoLookAheadCorrection(
             const DicTraverseSession *const traverseSession, const DicNode *const dicNode) const {
+        if (TypingLatencyGuard::getInstance()->isAtLeast(
+                TypingLatencyGuard::LEVEL_NO_LOOK_AHEAD_CORRECTION)) {
+            return false;
+        }
         const int inputSize = traverseSession->getInputSize();
         return dicNode->canDoLookAheadCorrection(inputSize);
     }
@@ -160,12 +177,23 @@ class TypingTraversal : public Traversal {
         if (inputSize <= 1) {
             return ScoringParams::MAX_CACHE_DIC_NODE_SIZE_FOR_SINGLE_POINT;
         }
+        const int beamWidth = TypingLatencyGuard::getInstance()->isAtLeast(
+                TypingLatencyGuard::LEVEL_SMALL_BEAM)
+                        ? TypingBeamWidthTuner::MIN_BEAM_WIDTH
+                        : TypingBeamWidthTuner::getInstance()->getBeamWidth();
         if (weightForLocale < ScoringParams::LOCALE_WEIGHT_THRESHOLD_FOR_SMALL_CACHE_SIZE) {
-            return ScoringParams::MAX_CACHE_DIC_NODE_SIZE_FOR_LOW_PROBABILITY_LOCALE;
+            return std::min(beamWidth,
+                    ScoringParams::MAX_CACHE_DIC_NODE_SIZE_FOR_LOW_PROBABILITY_LOCALE);
         }
-        return ScoringParams::MAX_CACHE_DIC_NODE_SIZE;
+        return beamWidth;
     }
 
+    // The search is narrowed down when the taps are exactly the code points of a frequent word,
+    // each close to the center of its key. The word is found by any beam, and the much less
+    // probable corrections a wider beam would add could not outrank it.
+    int getMaxCacheSizeForInput(const DicTraverseSession *const traverseSession,
+            const int maxCacheSize) const;
+
     AK_FORCE_INLINE int getTerminalCacheSize() const {
         return MAX_RESULTS;
     }
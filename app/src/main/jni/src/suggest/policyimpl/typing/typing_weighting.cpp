@@ -16,6 +16,9 @@
 
 #include "suggest/policyimpl/typing/typing_weighting.h"
 
+#include <algorithm>
+
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
 #include "suggest/core/dicnode/dic_node.h"
 #include "suggest/core/layout/proximity_info.h"
 #include "suggest/policyimpl/typing/scoring_params.h"
@@ -24,6 +27,45 @@ namespace latinime {
 
 const TypingWeighting TypingWeighting::sInstance;
 
+float TypingWeighting::getRemainingSpatialCostLowerBound(
+        const DicTraverseSession *const traverseSession, const DicNode *const dicNode) const {
+    const ProximityInfoState *const pInfoState = traverseSession->getProximityInfoState(0);
+    const int inputSize = traverseSession->getInputSize();
+    const TypingSearchCosts *const searchCosts = traverseSession->getTypingSearchCosts();
+    const float minCorrectionCost = searchCosts->getMinCorrectionCostPerInput();
+    const float spaceSubstitutionCostRate = searchCosts->getSpaceSubstitutionCostRate();
+    float cost = 0.0f;
+    for (int i = dicNode->getInputIndex(0); i < inputSize; ++i) {
+        const float matchedCost = ScoringParams::DISTANCE_WEIGHT_LENGTH
+                * TouchPositionCorrectionUtils::getSweetSpotFactor(
+                        traverseSession->isTouchPositionCorrectionEnabled(),
+                        pInfoState->getMinPointToKeyLength(i));
+        const float spaceSubstitutionCost = spaceSubstitutionCostRate
+                * pInfoState->getPointToKeyLength(i, KEYCODE_SPACE);
+        cost += std::min({matchedCost, spaceSubstitutionCost, minCorrectionCost});
+    }
+    return cost;
+}
+
+float TypingWeighting::getRemainingLanguageCostLowerBound(
+        const DicTraverseSession *const traverseSession, const DicNode *const dicNode) const {
+    const int maxTerminalProbability = dicNode->getMaxTerminalProbability();
+    // The n-grams of the session are those after its previous words, not after the words of a
+    // multiple word DicNode.
+    if (maxTerminalProbability >= MAX_PROBABILITY || dicNode->hasMultipleWords()) {
+        return 0.0f;
+    }
+    // The probability in context grows with both the unigram and the n-gram probability.
+    const int maxProbability = traverseSession->getDictionaryStructurePolicy()->getProbability(
+            maxTerminalProbability, traverseSession->getMaxNgramProbability());
+    if (maxProbability == NOT_A_PROBABILITY) {
+        return 0.0f;
+    }
+    // Same as the terminal language cost from DicNodeUtils::getBigramNodeImprobability().
+    return static_cast<float>(MAX_PROBABILITY - std::min(maxProbability, MAX_PROBABILITY))
+            / static_cast<float>(MAX_PROBABILITY) * ScoringParams::DISTANCE_WEIGHT_LANGUAGE;
+}
+
 ErrorTypeUtils::ErrorType TypingWeighting::getErrorType(const CorrectionType correctionType,
         const DicTraverseSession *const traverseSession, const DicNode *const parentDicNode,
         const DicNode *const dicNode) const {
@@ -32,7 +32,7 @@ class DicNode;
 struct DicNode_InputStateG;
 class MultiBigramMap;
 
-class TypingWeighting : public Weighting {
+class TypingWeighting final : public Weighting {
  public:
     static const TypingWeighting *getInstance() { return &sInstance; }
 
@@ -75,15 +75,15 @@ class TypingWeighting : public Weighting {
     float getMatchedCost(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode, DicNode_InputStateG *inputStateG) const {
         const int pointIndex = dicNode->getInputIndex(0);
-        const float normalizedSquaredLength = traverseSession->getProximityInfoState(0)
-                ->getPointToKeyLength(pointIndex,
-                        CharUtils::toBaseLowerCase(dicNode->getNodeCodePoint()));
-        const float normalizedDistance = TouchPositionCorrectionUtils::getSweetSpotFactor(
-                traverseSession->isTouchPositionCorrectionEnabled(), normalizedSquaredLength);
-        const float weightedDistance = ScoringParams::DISTANCE_WEIGHT_LENGTH * normalizedDistance;
+        const ProximityInfoState *const pInfoState = traverseSession->getProximityInfoState(0);
+        const int baseLowerCaseCodePoint = CharUtils::toBaseLowerCase(dicNode->getNodeCodePoint());
+        // The sweet spot factors of the point are computed once per input.
+        const float weightedDistance = ScoringParams::DISTANCE_WEIGHT_LENGTH
+                * pInfoState->getPointToKeySweetSpotFactor(pointIndex, baseLowerCaseCodePoint);
 
         const bool isFirstChar = pointIndex == 0;
-        const bool isProximity = isProximityDicNode(traverseSession, dicNode);
+        const bool isProximity =
+                pInfoState->getBaseLowerCasePrimaryCodePointAt(pointIndex) != baseLowerCaseCodePoint;
         float cost = isProximity ? (isFirstChar ? ScoringParams::FIRST_CHAR_PROXIMITY_COST
                 : ScoringParams::PROXIMITY_COST) : 0.0f;
         if (isProximity && dicNode->getProximityCorrectionCount() == 0) {
@@ -105,10 +105,8 @@ class TypingWeighting : public Weighting {
     bool isProximityDicNode(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode) const {
         const int pointIndex = dicNode->getInputIndex(0);
-        const int primaryCodePoint = CharUtils::toBaseLowerCase(
-                traverseSession->getProximityInfoState(0)->getPrimaryCodePointAt(pointIndex));
-        const int dicNodeChar = CharUtils::toBaseLowerCase(dicNode->getNodeCodePoint());
-        return primaryCodePoint != dicNodeChar;
+        return traverseSession->getProximityInfoState(0)->getBaseLowerCasePrimaryCodePointAt(
+                pointIndex) != CharUtils::toBaseLowerCase(dicNode->getNodeCodePoint());
     }
 
     float getTranspositionCost(const DicTraverseSession *const traverseSession,
@@ -152,16 +150,14 @@ class TypingWeighting : public Weighting {
 
     float getSpaceOmissionCost(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode, DicNode_InputStateG *inputStateG) const {
-        const float cost = ScoringParams::SPACE_OMISSION_COST;
-        return cost * traverseSession->getMultiWordCostMultiplier();
+        return traverseSession->getTypingSearchCosts()->getSpaceOmissionCost();
     }
 
     float getNewWordBigramLanguageCost(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode,
             MultiBigramMap *const multiBigramMap) const {
-        return DicNodeUtils::getBigramNodeImprobability(
-                traverseSession->getDictionaryStructurePolicy(),
-                dicNode, multiBigramMap) * ScoringParams::DISTANCE_WEIGHT_LANGUAGE;
+        return DicNodeUtils::getBigramNodeImprobability(traverseSession, dicNode, multiBigramMap)
+                * ScoringParams::DISTANCE_WEIGHT_LANGUAGE;
     }
 
     float getCompletionCost(const DicTraverseSession *const traverseSession,
@@ -193,6 +189,12 @@ class TypingWeighting : public Weighting {
         return false;
     }
 
+    float getRemainingSpatialCostLowerBound(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const;
+
+    float getRemainingLanguageCostLowerBound(const DicTraverseSession *const traverseSession,
+            const DicNode *const dicNode) const;
+
     AK_FORCE_INLINE float getAdditionalProximityCost() const {
         return ScoringParams::ADDITIONAL_PROXIMITY_COST;
     }
@@ -206,8 +208,8 @@ class TypingWeighting : public Weighting {
         const int inputIndex = dicNode->getInputIndex(0);
         const float distanceToSpaceKey = traverseSession->getProximityInfoState(0)
                 ->getPointToKeyLength(inputIndex, KEYCODE_SPACE);
-        const float cost = ScoringParams::SPACE_SUBSTITUTION_COST * distanceToSpaceKey;
-        return cost * traverseSession->getMultiWordCostMultiplier();
+        return traverseSession->getTypingSearchCosts()->getSpaceSubstitutionCostRate()
+                * distanceToSpaceKey;
     }
 
     ErrorTypeUtils::ErrorType getErrorType(const CorrectionType correctionType,
@@ -215,6 +217,9 @@ class TypingWeighting : public Weighting {
             const DicNode *const parentDicNode, const DicNode *const dicNode) const;
 
  private:
+    // For the costs called from the Weighting instantiations for TypingWeighting.
+    friend class Weighting;
+
     DISALLOW_COPY_AND_ASSIGN(TypingWeighting);
     static const TypingWeighting sInstance;
 
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_BIT_PARALLEL_EDIT_DISTANCE_H
+#define LATINIME_BIT_PARALLEL_EDIT_DISTANCE_H
+
+#include <cstdint>
+
+#include "defines.h"
+#include "utils/char_utils.h"
+
+namespace latinime {
+
+// The edit distance of DamerauLevenshteinEditDistancePolicy from one pattern to any number of
+// texts, with the bit-parallel algorithm of Hyyro for the optimal string alignment distance. The
+// pattern is case folded once, then each code point of a text takes a constant number of word
+// operations. Only patterns of up to MAX_PATTERN_LENGTH code points are supported.
+class BitParallelEditDistance {
+ public:
+    static const int MAX_PATTERN_LENGTH = 64;
+
+    static bool canEncode(const int patternLength) {
+        return patternLength <= MAX_PATTERN_LENGTH;
+    }
+
+    AK_FORCE_INLINE BitParallelEditDistance(const int *const pattern, const int patternLength)
+            : mPatternLength(patternLength), mBaseLowerCasePattern() {
+        for (int i = 0; i < patternLength; ++i) {
+            mBaseLowerCasePattern[i] = CharUtils::toBaseLowerCase(pattern[i]);
+        }
+    }
+
+    AK_FORCE_INLINE int getEditDistance(const int *const text, const int textLength) const {
+        if (mPatternLength == 0) {
+            return textLength;
+        }
+        // Bit i of the vectors is about the row of pattern[i]: the vertical deltas are +1 in
+        // positiveVertical and -1 in negativeVertical, diagonalZero has the zero diagonal deltas.
+        uint64_t positiveVertical = ~static_cast<uint64_t>(0);
+        uint64_t negativeVertical = 0;
+        uint64_t diagonalZero = 0;
+        uint64_t previousMatches = 0;
+        const uint64_t lastRowBit = static_cast<uint64_t>(1) << (mPatternLength - 1);
+        int distance = mPatternLength;
+        for (int j = 0; j < textLength; ++j) {
+            const uint64_t matches = getMatchVector(CharUtils::toBaseLowerCase(text[j]));
+            const uint64_t transpositions = ((~diagonalZero & matches) << 1) & previousMatches;
+            diagonalZero = (((matches & positiveVertical) + positiveVertical) ^ positiveVertical)
+                    | matches | negativeVertical | transpositions;
+            const uint64_t positiveHorizontal =
+                    negativeVertical | ~(diagonalZero | positiveVertical);
+            const uint64_t negativeHorizontal = diagonalZero & positiveVertical;
+            if (positiveHorizontal & lastRowBit) {
+                ++distance;
+            } else if (negativeHorizontal & lastRowBit) {
+                --distance;
+            }
+            const uint64_t shiftedPositiveHorizontal = (positiveHorizontal << 1) | 1;
+            positiveVertical = (negativeHorizontal << 1)
+                    | ~(diagonalZero | shiftedPositiveHorizontal);
+            negativeVertical = shiftedPositiveHorizontal & diagonalZero;
+            previousMatches = matches;
+        }
+        return distance;
+    }
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(BitParallelEditDistance);
+
+    // The positions of the code point in the pattern. Comparing with the whole pattern without
+    // branches is faster than a lookup for the short patterns of words; the compiler vectorizes it.
+    AK_FORCE_INLINE uint64_t getMatchVector(const int baseLowerCaseCodePoint) const {
+        uint64_t matches = 0;
+        for (int i = 0; i < mPatternLength; ++i) {
+            matches |= static_cast<uint64_t>(mBaseLowerCasePattern[i] == baseLowerCaseCodePoint)
+                    << i;
+        }
+        return matches;
+    }
+
+    const int mPatternLength;
+    int mBaseLowerCasePattern[MAX_PATTERN_LENGTH];
+};
+} // namespace latinime
+
+#endif  // LATINIME_BIT_PARALLEL_EDIT_DISTANCE_H
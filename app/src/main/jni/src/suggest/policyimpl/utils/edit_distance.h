@@ -20,6 +20,8 @@
 #include <algorithm>
 
 #include "defines.h"
+#include "suggest/policyimpl/utils/bit_parallel_edit_distance.h"
+#include "suggest/policyimpl/utils/damerau_levenshtein_edit_distance_policy.h"
 #include "suggest/policyimpl/utils/edit_distance_policy.h"
 
 namespace latinime {
@@ -64,6 +66,24 @@ class EditDistance {
         return dp[(beforeLength + 1) * (afterLength + 1) - 1];
     }
 
+    // The edit distance of DamerauLevenshteinEditDistancePolicy. All its costs are 1, so unless
+    // both strings are longer than a machine word, BitParallelEditDistance is used instead of the
+    // DP table of getEditDistance().
+    AK_FORCE_INLINE static int getDamerauLevenshteinEditDistance(const int *const codePoints0,
+            const int length0, const int *const codePoints1, const int length1) {
+        // The distance is symmetric; the shorter string is the one encoded in the bit vectors.
+        if (length0 > length1) {
+            return getDamerauLevenshteinEditDistance(codePoints1, length1, codePoints0, length0);
+        }
+        if (!BitParallelEditDistance::canEncode(length0)) {
+            const DamerauLevenshteinEditDistancePolicy policy(
+                    codePoints0, length0, codePoints1, length1);
+            return static_cast<int>(getEditDistance(&policy));
+        }
+        const BitParallelEditDistance bitParallelEditDistance(codePoints0, length0);
+        return bitParallelEditDistance.getEditDistance(codePoints1, length1);
+    }
+
     AK_FORCE_INLINE static void dumpEditDistance10ForDebug(const float *const editDistanceTable,
             const int editDistanceTableWidth, const int outputLength) {
         if (DEBUG_DICT) {
@@ -20,8 +20,8 @@
 #include <cmath>
 
 #include "defines.h"
+#include "suggest/policyimpl/utils/bit_parallel_edit_distance.h"
 #include "suggest/policyimpl/utils/edit_distance.h"
-#include "suggest/policyimpl/utils/damerau_levenshtein_edit_distance_policy.h"
 
 namespace latinime {
 
@@ -31,9 +31,8 @@ const int AutocorrectionThresholdUtils::FULL_WORD_MULTIPLIER = 2;
 
 /* static */ int AutocorrectionThresholdUtils::editDistance(const int *before,
         const int beforeLength, const int *after, const int afterLength) {
-    const DamerauLevenshteinEditDistancePolicy daemaruLevenshtein(
+    return EditDistance::getDamerauLevenshteinEditDistance(
             before, beforeLength, after, afterLength);
-    return static_cast<int>(EditDistance::getEditDistance(&daemaruLevenshtein));
 }
 
 // In dictionary.cpp, getSuggestion() method,
@@ -72,7 +71,33 @@ const int AutocorrectionThresholdUtils::FULL_WORD_MULTIPLIER = 2;
     if (0 == beforeLength || 0 == afterLength) {
         return 0.0f;
     }
-    const int distance = editDistance(before, beforeLength, after, afterLength);
+    return calcNormalizedScoreWithEditDistance(beforeLength, after, afterLength, score,
+            editDistance(before, beforeLength, after, afterLength));
+}
+
+/* static */ void AutocorrectionThresholdUtils::calcNormalizedScores(const int *before,
+        const int beforeLength, const int *afters, const int *afterLengths, const int *scores,
+        const int afterCount, float *outNormalizedScores) {
+    if (!BitParallelEditDistance::canEncode(beforeLength)) {
+        for (int i = 0; i < afterCount; ++i) {
+            outNormalizedScores[i] = calcNormalizedScore(before, beforeLength, afters,
+                    afterLengths[i], scores[i]);
+            afters += afterLengths[i];
+        }
+        return;
+    }
+    const BitParallelEditDistance beforeEditDistance(before, beforeLength);
+    for (int i = 0; i < afterCount; ++i) {
+        outNormalizedScores[i] = (0 == beforeLength || 0 == afterLengths[i]) ? 0.0f
+                : calcNormalizedScoreWithEditDistance(beforeLength, afters, afterLengths[i],
+                        scores[i], beforeEditDistance.getEditDistance(afters, afterLengths[i]));
+        afters += afterLengths[i];
+    }
+}
+
+/* static */ float AutocorrectionThresholdUtils::calcNormalizedScoreWithEditDistance(
+        const int beforeLength, const int *after, const int afterLength, const int score,
+        const int distance) {
     int spaceCount = 0;
     for (int i = 0; i < afterLength; ++i) {
         if (after[i] == KEYCODE_SPACE) {
@@ -25,12 +25,20 @@ class AutocorrectionThresholdUtils {
  public:
     static float calcNormalizedScore(const int *before, const int beforeLength,
             const int *after, const int afterLength, const int score);
+    // calcNormalizedScore() of before and each of the afterCount candidates, whose code points
+    // are concatenated in afters. The edit distance vectors of before are built only once.
+    static void calcNormalizedScores(const int *before, const int beforeLength,
+            const int *afters, const int *afterLengths, const int *scores, const int afterCount,
+            float *outNormalizedScores);
     static int editDistance(const int *before, const int beforeLength, const int *after,
             const int afterLength);
 
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(AutocorrectionThresholdUtils);
 
+    static float calcNormalizedScoreWithEditDistance(const int beforeLength, const int *after,
+            const int afterLength, const int score, const int distance);
+
     static const int MAX_INITIAL_SCORE;
     static const int TYPED_LETTER_MULTIPLIER;
     static const int FULL_WORD_MULTIPLIER;
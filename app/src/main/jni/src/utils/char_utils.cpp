@@ -1064,6 +1064,61 @@ static int compare_pair_capital(const void *a, const void *b) {
     return p ? static_cast<int>(p->small) : c;
 }
 
+/* static */ bool CharUtils::isLetterOrDigit(const int codePoint) {
+    if (isAscii(codePoint)) {
+        return (codePoint >= 'a' && codePoint <= 'z') || isAsciiUpper(codePoint)
+                || (codePoint >= '0' && codePoint <= '9');
+    }
+    // Latin-1 punctuation and symbols, and the multiplication and division signs.
+    if (codePoint < 0xC0 || codePoint == 0xD7 || codePoint == 0xF7) {
+        return false;
+    }
+    if (!isInUnicodeSpace(codePoint)) {
+        return false;
+    }
+    // General punctuation to miscellaneous symbols and arrows, CJK symbols and punctuation,
+    // unpaired surrogates, variation selectors, and the emoji and pictographs.
+    return !(codePoint >= 0x2000 && codePoint <= 0x2BFF)
+            && !(codePoint >= 0x3000 && codePoint <= 0x303F)
+            && !(codePoint >= 0xD800 && codePoint <= 0xDFFF)
+            && !(codePoint >= 0xFE00 && codePoint <= 0xFE0F)
+            && !(codePoint >= 0x1F000 && codePoint <= 0x1FAFF);
+}
+
+/* static */ int CharUtils::toLowerCaseWithoutTable(const int c) {
+    if (isAsciiUpper(c)) {
+        return toAsciiLower(c);
+    }
+    if (isAscii(c)) {
+        return c;
+    }
+    return latin_tolower(c);
+}
+
+/* static */ int CharUtils::toBaseLowerCaseWithoutTable(const int c) {
+    return toLowerCaseWithoutTable(toBaseCodePoint(c));
+}
+
+CharUtils::CodePointMappingTable::CodePointMappingTable(int (*const mapping)(const int))
+        : mBlockIndices(), mDifferences(1 << BLOCK_SIZE_BITS, 0) {
+    // Block 0 is the block without differences.
+    for (int blockStart = 0; blockStart < TABLE_SIZE; blockStart += 1 << BLOCK_SIZE_BITS) {
+        uint16_t differences[1 << BLOCK_SIZE_BITS];
+        bool hasDifference = false;
+        for (int i = 0; i < (1 << BLOCK_SIZE_BITS); ++i) {
+            const int c = blockStart + i;
+            differences[i] = static_cast<uint16_t>((mapping(c) - c) & (TABLE_SIZE - 1));
+            hasDifference |= differences[i] != 0;
+        }
+        if (hasDifference) {
+            mBlockIndices[blockStart >> BLOCK_SIZE_BITS] =
+                    static_cast<uint8_t>(mDifferences.size() >> BLOCK_SIZE_BITS);
+            mDifferences.insert(mDifferences.end(), differences,
+                    differences + (1 << BLOCK_SIZE_BITS));
+        }
+    }
+}
+
 /*
  * Table mapping most combined Latin, Greek, and Cyrillic characters
  * to their base characters.  If c is in range, CharUtils::BASE_CHARS[c] == c
@@ -1283,5 +1338,11 @@ static int compare_pair_capital(const void *a, const void *b) {
     /* U+04F8 */ 0x042B, 0x044B, 0x04FA, 0x04FB, 0x04FC, 0x04FD, 0x04FE, 0x04FF,
 };
 
+// Built during static initialization from the constant tables above.
+const CharUtils::CodePointMappingTable CharUtils::LOWER_CASE_TABLE(
+        CharUtils::toLowerCaseWithoutTable);
+const CharUtils::CodePointMappingTable CharUtils::BASE_LOWER_CASE_TABLE(
+        CharUtils::toBaseLowerCaseWithoutTable);
+
 /* static */ const std::vector<int> CharUtils::EMPTY_STRING(1 /* size */, '\0' /* value */);
 } // namespace latinime
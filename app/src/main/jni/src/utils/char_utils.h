@@ -18,6 +18,7 @@
 #define LATINIME_CHAR_UTILS_H
 
 #include <cctype>
+#include <cstdint>
 #include <cstring>
 #include <vector>
 
@@ -42,11 +43,17 @@ class CharUtils {
         if (isAscii(c)) {
             return c;
         }
-        return latin_tolower(c);
+        return LOWER_CASE_TABLE.map(c);
     }
 
     static AK_FORCE_INLINE int toBaseLowerCase(const int c) {
-        return toLowerCase(toBaseCodePoint(c));
+        if (isAsciiUpper(c)) {
+            return toAsciiLower(c);
+        }
+        if (isAscii(c)) {
+            return c;
+        }
+        return BASE_LOWER_CASE_TABLE.map(c);
     }
 
     static AK_FORCE_INLINE bool isIntentionalOmissionCodePoint(const int codePoint) {
@@ -84,6 +91,10 @@ class CharUtils {
         return codePoint >= MIN_UNICODE_CODE_POINT && codePoint <= MAX_UNICODE_CODE_POINT;
     }
 
+    // Approximates Character.isLetterOrDigit() without the Unicode tables. The code points out of
+    // the punctuation, symbol, surrogate and emoji blocks are letters.
+    static bool isLetterOrDigit(const int codePoint);
+
     // Returns updated code point count. Returns 0 when the code points cannot be marked as a
     // Beginning-of-Sentence.
     static AK_FORCE_INLINE int attachBeginningOfSentenceMarker(int *const codePoints,
@@ -115,8 +126,39 @@ class CharUtils {
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(CharUtils);
 
+    // Two-stage table that maps the code points in the BMP. The first stage maps the upper bits
+    // of a code point to a block of the second stage, which holds the differences between the
+    // mapped code points and the code points. Blocks without differences share a block.
+    class CodePointMappingTable {
+     public:
+        // Builds the table from mapping, which has to map the BMP to itself.
+        explicit CodePointMappingTable(int (*const mapping)(const int));
+
+        AK_FORCE_INLINE int map(const int c) const {
+            if (static_cast<unsigned int>(c) >= static_cast<unsigned int>(TABLE_SIZE)) {
+                return c;
+            }
+            const int blockIndex = mBlockIndices[c >> BLOCK_SIZE_BITS];
+            return (c + mDifferences[(blockIndex << BLOCK_SIZE_BITS) | (c & BLOCK_MASK)])
+                    & (TABLE_SIZE - 1);
+        }
+
+     private:
+        DISALLOW_IMPLICIT_CONSTRUCTORS(CodePointMappingTable);
+
+        static const int TABLE_SIZE = 0x10000;
+        static const int BLOCK_SIZE_BITS = 8;
+        static const int BLOCK_MASK = (1 << BLOCK_SIZE_BITS) - 1;
+
+        uint8_t mBlockIndices[TABLE_SIZE >> BLOCK_SIZE_BITS];
+        // Modulo TABLE_SIZE.
+        std::vector<uint16_t> mDifferences;
+    };
+
     static const int MIN_UNICODE_CODE_POINT;
     static const int MAX_UNICODE_CODE_POINT;
+    static const CodePointMappingTable LOWER_CASE_TABLE;
+    static const CodePointMappingTable BASE_LOWER_CASE_TABLE;
 
     /**
      * Table mapping most combined Latin, Greek, and Cyrillic characters
@@ -136,6 +178,10 @@ class CharUtils {
     }
 
     static int latin_tolower(const int c);
+
+    // Reference implementations the tables are built from.
+    static int toLowerCaseWithoutTable(const int c);
+    static int toBaseLowerCaseWithoutTable(const int c);
 };
 } // namespace latinime
 #endif // LATINIME_CHAR_UTILS_H
@@ -75,8 +75,22 @@ class JniDataUtils {
             const bool needsNullTermination) {
         const int codePointBufSize = std::min(maxLength, codePointCount);
         int outputCodePonts[codePointBufSize];
+        const int outputCodePointCount = copyCodePointsForOutput(codePoints, codePointBufSize,
+                outputCodePonts);
+        env->SetIntArrayRegion(intArrayToOutputCodePoints, start, outputCodePointCount,
+                outputCodePonts);
+        if (needsNullTermination && outputCodePointCount < maxLength) {
+            env->SetIntArrayRegion(intArrayToOutputCodePoints, start + outputCodePointCount,
+                    1 /* len */, &CODE_POINT_NULL);
+        }
+    }
+
+    // Copies code points the way outputCodePoints() outputs them: Beginning-of-Sentence markers
+    // are skipped and invalid code points are replaced. Returns the output code point count.
+    static int copyCodePointsForOutput(const int *const codePoints, const int codePointCount,
+            int *const outCodePoints) {
         int outputCodePointCount = 0;
-        for (int i = 0; i < codePointBufSize; ++i) {
+        for (int i = 0; i < codePointCount; ++i) {
             const int codePoint = codePoints[i];
             int codePointToOutput = codePoint;
             if (!CharUtils::isInUnicodeSpace(codePoint)) {
@@ -89,14 +103,9 @@ class JniDataUtils {
                 // Control code.
                 codePointToOutput = CODE_POINT_REPLACEMENT_CHARACTER;
             }
-            outputCodePonts[outputCodePointCount++] = codePointToOutput;
-        }
-        env->SetIntArrayRegion(intArrayToOutputCodePoints, start, outputCodePointCount,
-                outputCodePonts);
-        if (needsNullTermination && outputCodePointCount < maxLength) {
-            env->SetIntArrayRegion(intArrayToOutputCodePoints, start + outputCodePointCount,
-                    1 /* len */, &CODE_POINT_NULL);
+            outCodePoints[outputCodePointCount++] = codePointToOutput;
         }
+        return outputCodePointCount;
     }
 
     static NgramContext constructNgramContext(JNIEnv *env, jobjectArray prevWordCodePointArrays,
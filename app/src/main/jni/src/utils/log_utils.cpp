@@ -24,6 +24,10 @@
 namespace latinime {
     /* static */ void LogUtils::logToJava(JNIEnv *const env, const char *const format, ...) {
         static const char *TAG = "LatinIME:LogUtils";
+        if (!env) {
+            // Native tools run without a JVM.
+            return;
+        }
         const jclass androidUtilLogClass = env->FindClass("android/util/Log");
         if (!androidUtilLogClass) {
             // If we can't find the class, we are probably in off-device testing, and
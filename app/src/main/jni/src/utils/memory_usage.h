@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_MEMORY_USAGE_H
+#define LATINIME_MEMORY_USAGE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "defines.h"
+
+namespace latinime {
+
+// The memory held by a native object, so that Java can decide from real numbers what to close
+// under memory pressure. The sizes of the containers are estimated from their capacity, the
+// allocator overhead is not counted.
+class MemoryUsage {
+ public:
+    // Must be equal to the MEMORY_USAGE_* constants in BinaryDictionary.java
+    enum Category {
+        // Mapped dictionary files. These pages are clean and can be dropped by the kernel, unless
+        // the dictionary is updatable and they were written.
+        MAPPED_FILE_BYTES = 0,
+        // Written bytes of the additional buffers of BufferWithExtendableBuffer, i.e. private
+        // dirty memory of updatable dictionaries until the next GC.
+        ADDITIONAL_BUFFER_BYTES,
+        // Caches and pools kept between the calls, e.g. the DicNode pools, MultiBigramMap and the
+        // prediction cache.
+        CACHE_BYTES,
+        // Everything else on the heap, e.g. the objects themselves and the index of the v2 trie.
+        HEAP_BYTES,
+        CATEGORY_COUNT
+    };
+
+    MemoryUsage() : mBytes() {}
+
+    void add(const Category category, const int64_t bytes) {
+        mBytes[category] += bytes;
+    }
+
+    void add(const MemoryUsage &memoryUsage) {
+        for (int i = 0; i < CATEGORY_COUNT; ++i) {
+            mBytes[i] += memoryUsage.mBytes[i];
+        }
+    }
+
+    template<typename T>
+    void addVector(const Category category, const std::vector<T> &vector) {
+        add(category, static_cast<int64_t>(vector.capacity() * sizeof(T)));
+    }
+
+    // Each node is estimated to hold the value and a pointer to the next node.
+    template<typename K, typename V>
+    void addUnorderedMap(const Category category, const std::unordered_map<K, V> &map) {
+        add(category, static_cast<int64_t>(map.bucket_count() * sizeof(void *) + map.size()
+                * (sizeof(typename std::unordered_map<K, V>::value_type) + sizeof(void *))));
+    }
+
+    int64_t get(const Category category) const {
+        return mBytes[category];
+    }
+
+    int64_t getTotal() const {
+        int64_t total = 0;
+        for (int i = 0; i < CATEGORY_COUNT; ++i) {
+            total += mBytes[i];
+        }
+        return total;
+    }
+
+    // outBytes must have room for CATEGORY_COUNT values.
+    void copyTo(int64_t *const outBytes) const {
+        for (int i = 0; i < CATEGORY_COUNT; ++i) {
+            outBytes[i] = mBytes[i];
+        }
+    }
+
+ private:
+    int64_t mBytes[CATEGORY_COUNT];
+};
+} // namespace latinime
+#endif // LATINIME_MEMORY_USAGE_H
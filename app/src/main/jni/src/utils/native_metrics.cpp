@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/native_metrics.h"
+
+namespace latinime {
+
+const int NativeMetrics::BUCKET_COUNT;
+const int NativeMetrics::VALUES_PER_METRIC;
+const int NativeMetrics::VALUE_COUNT;
+
+NativeMetrics::Slot NativeMetrics::sSlots[NativeMetrics::METRIC_COUNT];
+
+/* static */ int NativeMetrics::getBucketIndex(const int64_t latencyUs) {
+    if (latencyUs < 2) {
+        return 0;
+    }
+    const int index = 63 - __builtin_clzll(static_cast<unsigned long long>(latencyUs));
+    return index < BUCKET_COUNT ? index : BUCKET_COUNT - 1;
+}
+
+/* static */ void NativeMetrics::record(const Metric metric, const int64_t latencyUs) {
+    // The monotonic clock does not go back, but keep a bad sample out of the sum anyway.
+    const int64_t latency = latencyUs > 0 ? latencyUs : 0;
+    Slot &slot = sSlots[metric];
+    slot.mCount.fetch_add(1, std::memory_order_relaxed);
+    slot.mSumUs.fetch_add(latency, std::memory_order_relaxed);
+    slot.mBuckets[getBucketIndex(latency)].fetch_add(1, std::memory_order_relaxed);
+    int64_t max = slot.mMaxUs.load(std::memory_order_relaxed);
+    while (latency > max
+            && !slot.mMaxUs.compare_exchange_weak(max, latency, std::memory_order_relaxed)) {}
+}
+
+/* static */ int NativeMetrics::copyTo(int64_t *const outValues, const int maxValueCount) {
+    int valueCount = 0;
+    for (int i = 0; i < METRIC_COUNT && valueCount + VALUES_PER_METRIC <= maxValueCount; ++i) {
+        const Slot &slot = sSlots[i];
+        outValues[valueCount++] = slot.mCount.load(std::memory_order_relaxed);
+        outValues[valueCount++] = slot.mSumUs.load(std::memory_order_relaxed);
+        outValues[valueCount++] = slot.mMaxUs.load(std::memory_order_relaxed);
+        for (int j = 0; j < BUCKET_COUNT; ++j) {
+            outValues[valueCount++] = slot.mBuckets[j].load(std::memory_order_relaxed);
+        }
+    }
+    return valueCount;
+}
+
+/* static */ void NativeMetrics::reset() {
+    for (Slot &slot : sSlots) {
+        slot.mCount.store(0, std::memory_order_relaxed);
+        slot.mSumUs.store(0, std::memory_order_relaxed);
+        slot.mMaxUs.store(0, std::memory_order_relaxed);
+        for (auto &bucket : slot.mBuckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace latinime
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_NATIVE_METRICS_H
+#define LATINIME_NATIVE_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "defines.h"
+#include "utils/time_keeper.h"
+
+namespace latinime {
+
+// Latency histograms of the dictionary operations, kept in every build. Each metric has a fixed slot
+// of relaxed atomic counters, so recording a sample costs a few increments and never locks, and
+// concurrent suggestion calls can record at the same time. Java reads all the slots at once with
+// BinaryDictionary.getNativeMetrics().
+class NativeMetrics {
+ public:
+    // Must be equal to the METRIC_* constants in BinaryDictionary.java
+    enum Metric {
+        // The phases of Suggest::getSuggestions, PROF_TIMER 0, 1 and 2 there.
+        METRIC_SUGGEST_SETUP = 0,
+        METRIC_SUGGEST_EXPAND,
+        METRIC_SUGGEST_OUTPUT,
+        METRIC_GET_PREDICTIONS,
+        METRIC_FLUSH,
+        METRIC_FLUSH_WITH_GC,
+        METRIC_COUNT
+    };
+
+    // Bucket 0 counts the latencies under 2 us, bucket i > 0 those from 2^i to 2^(i+1) us, and the
+    // last bucket everything from 2^(BUCKET_COUNT - 1) us, about a minute, on.
+    static const int BUCKET_COUNT = 26;
+    // Values of a metric in the output of copyTo: the sample count, the sum and the maximum of the
+    // latencies in microseconds, then the bucket counts.
+    static const int VALUES_PER_METRIC = 3 + BUCKET_COUNT;
+    static const int VALUE_COUNT = METRIC_COUNT * VALUES_PER_METRIC;
+
+    static void record(const Metric metric, const int64_t latencyUs);
+
+    // Copies the values of the metrics in order and returns how many were copied, at most
+    // maxValueCount.
+    static int copyTo(int64_t *const outValues, const int maxValueCount);
+
+    static void reset();
+
+    static int getBucketIndex(const int64_t latencyUs);
+
+    // Records the time from its construction to its destruction.
+    class ScopedTimer {
+     public:
+        explicit ScopedTimer(const Metric metric)
+                : mMetric(metric), mStartTimeUs(TimeKeeper::getMonotonicTimeInMicroseconds()) {}
+
+        ~ScopedTimer() {
+            record(mMetric, TimeKeeper::getMonotonicTimeInMicroseconds() - mStartTimeUs);
+        }
+
+     private:
+        DISALLOW_IMPLICIT_CONSTRUCTORS(ScopedTimer);
+
+        const Metric mMetric;
+        const int64_t mStartTimeUs;
+    };
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(NativeMetrics);
+
+    struct Slot {
+        std::atomic<int64_t> mCount;
+        std::atomic<int64_t> mSumUs;
+        std::atomic<int64_t> mMaxUs;
+        std::atomic<int64_t> mBuckets[BUCKET_COUNT];
+    };
+
+    static Slot sSlots[METRIC_COUNT];
+};
+} // namespace latinime
+#endif /* LATINIME_NATIVE_METRICS_H */
@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/native_sampling_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <link.h>
+#include <mutex>
+#include <sys/time.h>
+#include <ucontext.h>
+
+namespace latinime {
+
+namespace {
+
+// Open addressing, a PC that does not find its slot within MAX_PROBE_COUNT slots is dropped.
+const int MAX_PROBE_COUNT = 16;
+static_assert((NativeSamplingProfiler::MAX_PC_COUNT & (NativeSamplingProfiler::MAX_PC_COUNT - 1))
+        == 0, "MAX_PC_COUNT has to be a power of two");
+
+#ifdef FLAG_SAMPLING_PROFILE
+// Bounds of the frame pointer walk, so that a stale frame pointer in code built without frame
+// pointers, e.g. ART compiled code, stops the walk instead of reading beyond the stack.
+const int MAX_FRAME_COUNT = 32;
+const uintptr_t MAX_STACK_WALK_BYTES = 256 * 1024;
+#endif // FLAG_SAMPLING_PROFILE
+
+struct LibraryRange {
+    uintptr_t mBase;
+    uintptr_t mBegin;
+    uintptr_t mEnd;
+};
+
+// Only atomics are touched by the signal handler, they are all lock-free.
+std::atomic<uintptr_t> sPcs[NativeSamplingProfiler::MAX_PC_COUNT];
+std::atomic<uint32_t> sPcCounts[NativeSamplingProfiler::MAX_PC_COUNT];
+std::atomic<uint32_t> sSampleCounts[NativeSamplingProfiler::SAMPLE_COUNT_SIZE];
+std::atomic<bool> sRunning(false);
+std::atomic<uintptr_t> sLibraryBegin(0);
+std::atomic<uintptr_t> sLibraryEnd(0);
+uintptr_t sLibraryBase = 0;
+// The handler that was installed before ours, which ours chains to.
+struct sigaction sPreviousAction;
+bool sIsHandlerInstalled = false;
+std::mutex sMutex;
+
+int findLibraryRange(struct dl_phdr_info *info, size_t size, void *data) {
+    LibraryRange *const range = static_cast<LibraryRange *>(data);
+    const uintptr_t address = range->mBase;
+    uintptr_t begin = UINTPTR_MAX;
+    uintptr_t end = 0;
+    for (int i = 0; i < info->dlpi_phnum; ++i) {
+        const ElfW(Phdr) &header = info->dlpi_phdr[i];
+        if (header.p_type != PT_LOAD) {
+            continue;
+        }
+        const uintptr_t segmentBegin = info->dlpi_addr + header.p_vaddr;
+        begin = std::min(begin, segmentBegin);
+        end = std::max(end, static_cast<uintptr_t>(segmentBegin + header.p_memsz));
+    }
+    if (address < begin || address >= end) {
+        return 0;
+    }
+    range->mBase = info->dlpi_addr;
+    range->mBegin = begin;
+    range->mEnd = end;
+    return 1;
+}
+
+AK_FORCE_INLINE bool isInLibrary(const uintptr_t pc) {
+    return pc >= sLibraryBegin.load(std::memory_order_relaxed)
+            && pc < sLibraryEnd.load(std::memory_order_relaxed);
+}
+
+void countSample(const NativeSamplingProfiler::SampleCountIndex index) {
+    sSampleCounts[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+void addPc(const uintptr_t pc) {
+    const uint32_t mask = NativeSamplingProfiler::MAX_PC_COUNT - 1;
+    uint32_t slot = static_cast<uint32_t>((pc >> 2) * 0x9E3779B1u) & mask;
+    for (int i = 0; i < MAX_PROBE_COUNT; ++i, slot = (slot + 1) & mask) {
+        uintptr_t slotPc = sPcs[slot].load(std::memory_order_relaxed);
+        if (slotPc == 0 && sPcs[slot].compare_exchange_strong(slotPc, pc,
+                std::memory_order_relaxed)) {
+            slotPc = pc;
+        }
+        if (slotPc == pc) {
+            sPcCounts[slot].fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    countSample(NativeSamplingProfiler::SAMPLE_COUNT_DROPPED);
+}
+
+// Returns the innermost PC of the interrupted thread inside the library, or 0.
+uintptr_t getLibraryPc(const ucontext_t *const context) {
+    uintptr_t pc = 0;
+    uintptr_t fp = 0;
+    uintptr_t sp = 0;
+#if defined(__aarch64__)
+    pc = static_cast<uintptr_t>(context->uc_mcontext.pc);
+    fp = static_cast<uintptr_t>(context->uc_mcontext.regs[29]);
+    sp = static_cast<uintptr_t>(context->uc_mcontext.sp);
+#elif defined(__x86_64__)
+    pc = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RIP]);
+    fp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RBP]);
+    sp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RSP]);
+#elif defined(__i386__)
+    pc = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_EIP]);
+    fp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_EBP]);
+    sp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_ESP]);
+#elif defined(__arm__)
+    // ARM and Thumb code keep the frame pointer in different registers with different frame
+    // layouts, so only the interrupted PC is looked at.
+    pc = static_cast<uintptr_t>(context->uc_mcontext.arm_pc);
+#endif
+    if (isInLibrary(pc)) {
+        return pc;
+    }
+#ifdef FLAG_SAMPLING_PROFILE
+    // Each frame record holds the caller's frame pointer followed by the return address.
+    for (int i = 0; i < MAX_FRAME_COUNT; ++i) {
+        if (fp < sp || fp - sp >= MAX_STACK_WALK_BYTES || fp % sizeof(uintptr_t) != 0) {
+            break;
+        }
+        const uintptr_t *const frameRecord = reinterpret_cast<const uintptr_t *>(fp);
+        const uintptr_t returnAddress = frameRecord[1];
+        if (isInLibrary(returnAddress)) {
+            // The call instruction, so that addr2line prints the line of the call.
+            return returnAddress - 1;
+        }
+        const uintptr_t callerFp = frameRecord[0];
+        if (callerFp <= fp) {
+            break;
+        }
+        fp = callerFp;
+    }
+#else // FLAG_SAMPLING_PROFILE
+    (void) fp;
+    (void) sp;
+#endif // FLAG_SAMPLING_PROFILE
+    return 0;
+}
+
+void chainToPreviousHandler(int signal, siginfo_t *info, void *context) {
+    if (sPreviousAction.sa_flags & SA_SIGINFO) {
+        if (sPreviousAction.sa_sigaction) {
+            sPreviousAction.sa_sigaction(signal, info, context);
+        }
+    } else if (sPreviousAction.sa_handler != SIG_DFL && sPreviousAction.sa_handler != SIG_IGN) {
+        // The default action of SIGPROF terminates the process, a late signal after stop() is
+        // ignored instead.
+        sPreviousAction.sa_handler(signal);
+    }
+}
+
+void handleProfilingSignal(int signal, siginfo_t *info, void *context) {
+    const int savedErrno = errno;
+    if (sRunning.load(std::memory_order_relaxed)) {
+        countSample(NativeSamplingProfiler::SAMPLE_COUNT_TOTAL);
+        const uintptr_t pc = getLibraryPc(static_cast<const ucontext_t *>(context));
+        if (pc != 0) {
+            addPc(pc);
+        } else {
+            countSample(NativeSamplingProfiler::SAMPLE_COUNT_OUTSIDE_LIBRARY);
+        }
+    }
+    chainToPreviousHandler(signal, info, context);
+    errno = savedErrno;
+}
+
+bool setTimer(const int intervalUs) {
+    struct itimerval timer;
+    timer.it_interval.tv_sec = intervalUs / 1000000;
+    timer.it_interval.tv_usec = intervalUs % 1000000;
+    timer.it_value = timer.it_interval;
+    return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+} // namespace
+
+/* static */ bool NativeSamplingProfiler::start(const int samplingIntervalUs) {
+    std::lock_guard<std::mutex> lock(sMutex);
+    if (sLibraryEnd.load(std::memory_order_relaxed) == 0) {
+        LibraryRange range = { reinterpret_cast<uintptr_t>(&findLibraryRange), 0, 0 };
+        if (!dl_iterate_phdr(findLibraryRange, &range)) {
+            AKLOGE("The library of the sampling profiler is not found.");
+            return false;
+        }
+        sLibraryBase = range.mBase;
+        sLibraryBegin.store(range.mBegin, std::memory_order_relaxed);
+        sLibraryEnd.store(range.mEnd, std::memory_order_relaxed);
+    }
+    if (!sIsHandlerInstalled) {
+        // Installed once and never removed, as a handler installed later may chain to it.
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = handleProfilingSignal;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, &sPreviousAction) != 0) {
+            AKLOGE("The SIGPROF handler could not be installed: %d", errno);
+            return false;
+        }
+        sIsHandlerInstalled = true;
+    }
+    sRunning.store(false, std::memory_order_relaxed);
+    for (int i = 0; i < MAX_PC_COUNT; ++i) {
+        sPcs[i].store(0, std::memory_order_relaxed);
+        sPcCounts[i].store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < SAMPLE_COUNT_SIZE; ++i) {
+        sSampleCounts[i].store(0, std::memory_order_relaxed);
+    }
+    sRunning.store(true, std::memory_order_relaxed);
+    if (!setTimer(std::max(samplingIntervalUs, MIN_SAMPLING_INTERVAL_US))) {
+        AKLOGE("The profiling timer could not be set: %d", errno);
+        sRunning.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+/* static */ void NativeSamplingProfiler::stop() {
+    std::lock_guard<std::mutex> lock(sMutex);
+    if (!sRunning.load(std::memory_order_relaxed)) {
+        return;
+    }
+    setTimer(0);
+    sRunning.store(false, std::memory_order_relaxed);
+}
+
+/* static */ bool NativeSamplingProfiler::isRunning() {
+    return sRunning.load(std::memory_order_relaxed);
+}
+
+/* static */ int NativeSamplingProfiler::getSamples(const int maxCount,
+        int64_t *const outPcOffsets, int *const outCounts) {
+    std::lock_guard<std::mutex> lock(sMutex);
+    int count = 0;
+    for (int i = 0; i < MAX_PC_COUNT && count < maxCount; ++i) {
+        const uintptr_t pc = sPcs[i].load(std::memory_order_relaxed);
+        const uint32_t pcCount = sPcCounts[i].load(std::memory_order_relaxed);
+        // A slot that was just claimed may not be counted yet.
+        if (pc == 0 || pcCount == 0) {
+            continue;
+        }
+        outPcOffsets[count] = static_cast<int64_t>(pc - sLibraryBase);
+        outCounts[count] = static_cast<int>(pcCount);
+        ++count;
+    }
+    return count;
+}
+
+/* static */ void NativeSamplingProfiler::getSampleCounts(int64_t *const outSampleCounts) {
+    for (int i = 0; i < SAMPLE_COUNT_SIZE; ++i) {
+        outSampleCounts[i] = sSampleCounts[i].load(std::memory_order_relaxed);
+    }
+}
+
+} // namespace latinime
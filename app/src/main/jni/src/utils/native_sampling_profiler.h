@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_NATIVE_SAMPLING_PROFILER_H
+#define LATINIME_NATIVE_SAMPLING_PROFILER_H
+
+#include <cstdint>
+
+#include "defines.h"
+
+namespace latinime {
+
+// Opt-in, low-rate sampling of the native code on real devices. A SIGPROF timer interrupts the
+// thread that is using the CPU, and the handler counts the innermost PC inside the library this
+// file is compiled into in a fixed-size table. The PCs are exported as offsets from the library
+// base so that they can be symbolised offline with addr2line on the unstripped library.
+//
+// With FLAG_SAMPLING_PROFILE the library is built with frame pointers and a sample landing
+// outside of it, e.g. in memcpy or libm, is attributed to the innermost return address inside it.
+// Without frame pointers only the interrupted PC is looked at.
+//
+// libjni_latinime and whisperggml each have their own copy of the histogram. The timer and the
+// signal handler are shared by the process, so the libraries are profiled one at a time.
+class NativeSamplingProfiler {
+ public:
+    static const int MAX_PC_COUNT = 1024;
+    static const int MIN_SAMPLING_INTERVAL_US = 1000;
+
+    enum SampleCountIndex {
+        // All samples taken while this copy was running.
+        SAMPLE_COUNT_TOTAL = 0,
+        // Samples without a PC or return address inside the library.
+        SAMPLE_COUNT_OUTSIDE_LIBRARY,
+        // Samples of a PC that did not fit into the table any more.
+        SAMPLE_COUNT_DROPPED,
+        SAMPLE_COUNT_SIZE,
+    };
+
+    // Clears the previous samples and samples every samplingIntervalUs microseconds of CPU time,
+    // at least MIN_SAMPLING_INTERVAL_US. Returns false when the timer or the handler could not
+    // be set up or the library is not found.
+    static bool start(const int samplingIntervalUs);
+
+    static void stop();
+
+    static bool isRunning();
+
+    // Writes the sampled PCs as offsets from the library base with their sample counts, in no
+    // particular order, and returns how many were written.
+    static int getSamples(const int maxCount, int64_t *const outPcOffsets,
+            int *const outCounts);
+
+    // outSampleCounts should have SAMPLE_COUNT_SIZE elements.
+    static void getSampleCounts(int64_t *const outSampleCounts);
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(NativeSamplingProfiler);
+};
+} // namespace latinime
+#endif /* LATINIME_NATIVE_SAMPLING_PROFILER_H */
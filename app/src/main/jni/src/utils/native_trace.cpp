@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/native_trace.h"
+
+#ifdef __ANDROID__
+#include <dlfcn.h>
+#endif // __ANDROID__
+
+namespace latinime {
+
+namespace {
+
+typedef void (*BeginSectionFunction)(const char *sectionName);
+typedef void (*EndSectionFunction)();
+
+struct ATraceFunctions {
+    BeginSectionFunction mBeginSection;
+    EndSectionFunction mEndSection;
+};
+
+// Looked up once, libandroid stays loaded for the lifetime of the process.
+const ATraceFunctions &getATraceFunctions() {
+    static const ATraceFunctions functions = []() {
+        ATraceFunctions loaded = { nullptr, nullptr };
+#ifdef __ANDROID__
+        void *const libandroid = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+        if (libandroid) {
+            loaded.mBeginSection = reinterpret_cast<BeginSectionFunction>(
+                    dlsym(libandroid, "ATrace_beginSection"));
+            loaded.mEndSection = reinterpret_cast<EndSectionFunction>(
+                    dlsym(libandroid, "ATrace_endSection"));
+        }
+        if (!loaded.mBeginSection || !loaded.mEndSection) {
+            AKLOGI("ATrace is not available, native tracing stays disabled.");
+            loaded.mBeginSection = nullptr;
+            loaded.mEndSection = nullptr;
+        }
+#endif // __ANDROID__
+        return loaded;
+    }();
+    return functions;
+}
+
+} // namespace
+
+std::atomic<bool> NativeTrace::sEnabled(false);
+
+/* static */ bool NativeTrace::setEnabled(const bool enabled) {
+    const bool available = enabled && getATraceFunctions().mBeginSection;
+    sEnabled.store(available, std::memory_order_relaxed);
+    return available;
+}
+
+/* static */ void NativeTrace::beginSection(const char *const name) {
+    getATraceFunctions().mBeginSection(name);
+}
+
+/* static */ void NativeTrace::endSection() {
+    getATraceFunctions().mEndSection();
+}
+
+} // namespace latinime
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_NATIVE_TRACE_H
+#define LATINIME_NATIVE_TRACE_H
+
+#include <atomic>
+
+#include "defines.h"
+
+namespace latinime {
+
+// Optional systrace/Perfetto sections around the native hot paths, so that they show up on the
+// frame timelines instead of one opaque JNI block. ATrace_beginSection is looked up in libandroid
+// at runtime, it only exists from API 23 on, and the sections are no-ops until setEnabled(true)
+// found it. On the host tracing can never be enabled.
+class NativeTrace {
+ public:
+    // Returns whether tracing is enabled now, which is false when enabling was requested but
+    // ATrace is not available.
+    static bool setEnabled(const bool enabled);
+
+    static AK_FORCE_INLINE bool isEnabled() {
+        return sEnabled.load(std::memory_order_relaxed);
+    }
+
+    // Traces the time from its construction to its destruction as a section on the current
+    // thread. A section begun while tracing was enabled is always ended.
+    class ScopedSection {
+     public:
+        explicit ScopedSection(const char *const name) : mBegun(isEnabled()) {
+            if (mBegun) {
+                beginSection(name);
+            }
+        }
+
+        ~ScopedSection() {
+            if (mBegun) {
+                endSection();
+            }
+        }
+
+     private:
+        DISALLOW_IMPLICIT_CONSTRUCTORS(ScopedSection);
+
+        const bool mBegun;
+    };
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(NativeTrace);
+
+    static void beginSection(const char *const name);
+    static void endSection();
+
+    static std::atomic<bool> sEnabled;
+};
+} // namespace latinime
+#endif /* LATINIME_NATIVE_TRACE_H */
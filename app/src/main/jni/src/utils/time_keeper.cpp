@@ -16,26 +16,32 @@
 
 #include "utils/time_keeper.h"
 
+#include <chrono>
 #include <ctime>
 
 namespace latinime {
 
-int TimeKeeper::sCurrentTime;
-bool TimeKeeper::sSetForTesting;
+std::atomic<int> TimeKeeper::sCurrentTime(0);
+std::atomic<bool> TimeKeeper::sSetForTesting(false);
 
 /* static  */ void TimeKeeper::setCurrentTime() {
-    if (!sSetForTesting) {
-        sCurrentTime = time(0);
+    if (!sSetForTesting.load(std::memory_order_relaxed)) {
+        sCurrentTime.store(static_cast<int>(time(0)), std::memory_order_relaxed);
     }
 }
 
 /* static */ void TimeKeeper::startTestModeWithForceCurrentTime(const int currentTime) {
-    sCurrentTime = currentTime;
-    sSetForTesting = true;
+    sCurrentTime.store(currentTime, std::memory_order_relaxed);
+    sSetForTesting.store(true, std::memory_order_relaxed);
 }
 
 /* static */ void TimeKeeper::stopTestMode() {
-    sSetForTesting = false;
+    sSetForTesting.store(false, std::memory_order_relaxed);
+}
+
+/* static */ int64_t TimeKeeper::getMonotonicTimeInMicroseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
 } // namespace latinime
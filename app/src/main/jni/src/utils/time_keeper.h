@@ -17,10 +17,15 @@
 #ifndef LATINIME_TIME_KEEPER_H
 #define LATINIME_TIME_KEEPER_H
 
+#include <atomic>
+#include <cstdint>
+
 #include "defines.h"
 
 namespace latinime {
 
+// The current time is shared by every thread that runs a dictionary operation, so it is kept in
+// atomics to allow concurrent suggestion calls on different DicTraverseSessions.
 class TimeKeeper {
  public:
     static void setCurrentTime();
@@ -29,13 +34,17 @@ class TimeKeeper {
 
     static void stopTestMode();
 
-    static int peekCurrentTime() { return sCurrentTime; };
+    static int peekCurrentTime() { return sCurrentTime.load(std::memory_order_relaxed); };
+
+    // Returns a monotonic time to measure elapsed time, e.g. for search time limits. This is not
+    // affected by the test mode.
+    static int64_t getMonotonicTimeInMicroseconds();
 
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(TimeKeeper);
 
-    static int sCurrentTime;
-    static bool sSetForTesting;
+    static std::atomic<int> sCurrentTime;
+    static std::atomic<bool> sSetForTesting;
 };
 } // namespace latinime
 #endif /* LATINIME_TIME_KEEPER_H */
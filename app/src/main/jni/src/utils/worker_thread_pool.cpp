@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/worker_thread_pool.h"
+
+#include <algorithm>
+
+namespace latinime {
+
+// Native IME work is latency sensitive but small; a couple of helper threads are enough.
+const int WorkerThreadPool::MAX_WORKER_THREAD_COUNT = 3;
+
+WorkerThreadPool::WorkerThreadPool(const int workerThreadCount)
+        : mMutex(), mTaskAvailable(), mQueuedTasks(), mWorkerThreads(),
+          mIsShuttingDown(false) {
+    const int threadCount = std::max(0, std::min(workerThreadCount, MAX_WORKER_THREAD_COUNT));
+    for (int i = 0; i < threadCount; ++i) {
+        mWorkerThreads.emplace_back(&WorkerThreadPool::workerLoop, this);
+    }
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsShuttingDown = true;
+    }
+    mTaskAvailable.notify_all();
+    for (auto &thread : mWorkerThreads) {
+        thread.join();
+    }
+}
+
+/* static */ WorkerThreadPool *WorkerThreadPool::getInstance() {
+    // Leave one core for the calling thread.
+    static WorkerThreadPool sInstance(
+            static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    return &sInstance;
+}
+
+void WorkerThreadPool::runTasks(const std::vector<Task> &tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+    if (tasks.size() == 1 || mWorkerThreads.empty()) {
+        for (const auto &task : tasks) {
+            task();
+        }
+        return;
+    }
+    Batch batch;
+    std::unique_lock<std::mutex> lock(mMutex);
+    // The first task is run by the calling thread below; the others are made available to the
+    // workers.
+    batch.mPendingTaskCount = static_cast<int>(tasks.size());
+    for (size_t i = 1; i < tasks.size(); ++i) {
+        mQueuedTasks.emplace_back(&tasks[i], &batch);
+    }
+    mTaskAvailable.notify_all();
+    mQueuedTasks.emplace_front(&tasks[0], &batch);
+    while (batch.mPendingTaskCount > 0) {
+        if (!mQueuedTasks.empty()) {
+            runOneTaskLocked(&lock);
+        } else {
+            batch.mFinished.wait(lock);
+        }
+    }
+}
+
+void WorkerThreadPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mTaskAvailable.wait(lock, [this] { return mIsShuttingDown || !mQueuedTasks.empty(); });
+        if (mIsShuttingDown) {
+            return;
+        }
+        runOneTaskLocked(&lock);
+    }
+}
+
+void WorkerThreadPool::runOneTaskLocked(std::unique_lock<std::mutex> *const lock) {
+    const QueuedTask queuedTask = mQueuedTasks.front();
+    mQueuedTasks.pop_front();
+    lock->unlock();
+    (*queuedTask.mTask)();
+    lock->lock();
+    --queuedTask.mBatch->mPendingTaskCount;
+    if (queuedTask.mBatch->mPendingTaskCount == 0) {
+        queuedTask.mBatch->mFinished.notify_all();
+    }
+}
+
+} // namespace latinime
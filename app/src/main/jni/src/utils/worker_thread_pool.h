@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_WORKER_THREAD_POOL_H
+#define LATINIME_WORKER_THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "defines.h"
+
+namespace latinime {
+
+/**
+ * A small fixed-size pool of worker threads used to run independent native tasks in parallel,
+ * e.g. the expansion of the beam of a search or the opening of several dictionaries.
+ *
+ * runTasks() blocks until all the given tasks have finished. The calling thread takes part in
+ * running the tasks, so a pool without workers simply runs them sequentially.
+ */
+class WorkerThreadPool {
+ public:
+    typedef std::function<void()> Task;
+
+    explicit WorkerThreadPool(const int workerThreadCount);
+    ~WorkerThreadPool();
+
+    // Returns the process-wide pool. Workers are created on the first call.
+    static WorkerThreadPool *getInstance();
+
+    void runTasks(const std::vector<Task> &tasks);
+
+    int getWorkerThreadCount() const { return static_cast<int>(mWorkerThreads.size()); }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(WorkerThreadPool);
+
+    // Tasks of one runTasks() call. Lives on the stack of the calling thread.
+    struct Batch {
+        Batch() : mPendingTaskCount(0) {}
+
+        int mPendingTaskCount;
+        std::condition_variable mFinished;
+    };
+
+    struct QueuedTask {
+        QueuedTask(const Task *const task, Batch *const batch) : mTask(task), mBatch(batch) {}
+
+        const Task *mTask;
+        Batch *mBatch;
+    };
+
+    static const int MAX_WORKER_THREAD_COUNT;
+
+    void workerLoop();
+    // Pops and runs one queued task. Must be called with the lock held; the lock is released
+    // while the task runs.
+    void runOneTaskLocked(std::unique_lock<std::mutex> *const lock);
+
+    std::mutex mMutex;
+    std::condition_variable mTaskAvailable;
+    std::deque<QueuedTask> mQueuedTasks;
+    std::vector<std::thread> mWorkerThreads;
+    bool mIsShuttingDown;
+};
+} // namespace latinime
+#endif // LATINIME_WORKER_THREAD_POOL_H
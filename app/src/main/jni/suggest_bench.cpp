@@ -0,0 +1,668 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Keystroke replay benchmark of the typing suggestions, built for the host by HostUnitTests.mk:
+//   latinime_suggest_bench -d main.dict [-t trace.txt] [-r runs] [-l search_time_limit_us]
+//           [-p parallel_expansion_threads] [-a config] [-b config]
+//
+// The trace has one typed word per line, optionally followed by an "x,y,time" touch point per
+// code point on the synthetic QWERTY keyboard below. Words without touch points are typed on the
+// key centers, 100 ms apart. Lines starting with '#' are ignored. Without -t, the trace is read
+// from the standard input.
+//
+// Every prefix of every word is given to Dictionary::getSuggestions on one session, as the
+// keyboard does while typing, and the latency, the search effort and the heap allocations of each
+// call are reported. -p sets SuggestOptions::getParallelExpansionThreadCount(). The quality is
+// reported as the rate of words whose full input has the traced word as the first (top-1) or one
+// of the first three (top-3) suggestions.
+//
+// With -b, the trace is replayed with two engine configurations, -a (by default the one given by
+// -l and -p) and -b, after an unrecorded warm-up replay, and the quality, latency and search
+// effort of b are reported against a. A configuration is a comma separated list of:
+//   limit=<us>        SuggestOptions::getSearchTimeLimitInMicroseconds()
+//   threads=<n>       SuggestOptions::getParallelExpansionThreadCount()
+//   beam=<n>          a typing beam width fixed with TypingBeamWidthTuner::setFixedBeamWidth()
+//   full_edit=<0|1>   SuggestOptions::useFullEditDistance()
+//   locale=<weight>   SuggestOptions::weightForLocale(), in thousands
+// e.g. -a beam=310 -b beam=160,threads=2.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "suggest/core/dictionary/dictionary.h"
+#include "suggest/core/layout/proximity_info.h"
+#include "suggest/core/result/suggested_word.h"
+#include "suggest/core/result/suggestion_results.h"
+#include "suggest/core/session/dic_traverse_session.h"
+#include "suggest/core/session/search_effort.h"
+#include "suggest/core/suggest_options.h"
+#include "suggest/policyimpl/typing/typing_beam_width_tuner.h"
+#include "utils/char_utils.h"
+#include "utils/native_metrics.h"
+#include "utils/time_keeper.h"
+
+static std::atomic<int64_t> sAllocationCount(0);
+
+// Counts the heap allocations. The operators are not inlined, so that the compiler doesn't see
+// free() on memory from operator new.
+
+__attribute__((noinline)) void *operator new(size_t size) {
+    sAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    void *const ptr = malloc(size == 0 ? 1 : size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+__attribute__((noinline)) void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete[](void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+namespace latinime {
+namespace {
+
+// Same grid as com.android.inputmethod.keyboard.ProximityInfo.
+const int GRID_WIDTH = 32;
+const int GRID_HEIGHT = 16;
+const int KEY_WIDTH = 108;
+const int KEY_HEIGHT = 160;
+const int KEYBOARD_WIDTH = KEY_WIDTH * 10;
+const int KEYBOARD_HEIGHT = KEY_HEIGHT * 4;
+// Same as ProximityInfo.SEARCH_DISTANCE in Java.
+const float SEARCH_DISTANCE = 1.2f;
+const int TIME_PER_KEYSTROKE_MS = 100;
+
+struct Key {
+    int mCodePoint;
+    int mX;
+    int mY;
+    int mWidth;
+    int mHeight;
+};
+
+struct TouchPoint {
+    int mX;
+    int mY;
+    int mTime;
+};
+
+struct TracedWord {
+    std::vector<int> mCodePoints;
+    std::vector<TouchPoint> mTouchPoints;
+};
+
+struct Sample {
+    int mInputSize;
+    int64_t mLatencyUs;
+    SearchEffort mSearchEffort;
+    int64_t mAllocationCount;
+};
+
+// An engine configuration, see the top of this file.
+struct Config {
+    int mSearchTimeLimitUs;
+    int mParallelExpansionThreadCount;
+    int mBeamWidth;
+    bool mUsesFullEditDistance;
+    int mWeightForLocaleInThousands;
+};
+
+// The results of replaying a trace with one configuration. mRanks has the rank of every traced
+// word in the suggestions for its full input, or NOT_AN_INDEX when it isn't suggested.
+struct Replay {
+    std::vector<Sample> mSamples;
+    std::vector<int> mRanks;
+};
+
+std::vector<Key> createQwertyKeys() {
+    static const char *const ROWS[] = { "qwertyuiop", "asdfghjkl", "zxcvbnm" };
+    std::vector<Key> keys;
+    for (size_t row = 0; row < NELEMS(ROWS); ++row) {
+        const int rowLength = static_cast<int>(strlen(ROWS[row]));
+        const int rowX = (KEYBOARD_WIDTH - rowLength * KEY_WIDTH) / 2;
+        for (int i = 0; i < rowLength; ++i) {
+            keys.push_back(Key{ROWS[row][i], rowX + i * KEY_WIDTH,
+                    static_cast<int>(row) * KEY_HEIGHT, KEY_WIDTH, KEY_HEIGHT});
+        }
+    }
+    keys.push_back(Key{KEYCODE_SPACE, KEY_WIDTH * 3, KEY_HEIGHT * 3, KEY_WIDTH * 4, KEY_HEIGHT});
+    return keys;
+}
+
+int getSquaredDistanceToEdge(const Key &key, const int x, const int y) {
+    const int dx = x < key.mX ? key.mX - x : (x >= key.mX + key.mWidth ? x - key.mX - key.mWidth
+            + 1 : 0);
+    const int dy = y < key.mY ? key.mY - y : (y >= key.mY + key.mHeight ? y - key.mY
+            - key.mHeight + 1 : 0);
+    return dx * dx + dy * dy;
+}
+
+// Builds the proximity info the way ProximityInfo.java does, without touch position correction.
+ProximityInfo *createQwertyProximityInfo(const std::vector<Key> &keys) {
+    const int cellWidth = (KEYBOARD_WIDTH + GRID_WIDTH - 1) / GRID_WIDTH;
+    const int cellHeight = (KEYBOARD_HEIGHT + GRID_HEIGHT - 1) / GRID_HEIGHT;
+    const int threshold = static_cast<int>(KEY_WIDTH * SEARCH_DISTANCE);
+    std::vector<int> proximityChars(GRID_WIDTH * GRID_HEIGHT * MAX_PROXIMITY_CHARS_SIZE,
+            NOT_A_CODE_POINT);
+    for (int cellY = 0; cellY < GRID_HEIGHT; ++cellY) {
+        for (int cellX = 0; cellX < GRID_WIDTH; ++cellX) {
+            const int centerX = cellX * cellWidth + cellWidth / 2;
+            const int centerY = cellY * cellHeight + cellHeight / 2;
+            int *const cell = &proximityChars[(cellY * GRID_WIDTH + cellX)
+                    * MAX_PROXIMITY_CHARS_SIZE];
+            int count = 0;
+            for (const Key &key : keys) {
+                if (count < MAX_PROXIMITY_CHARS_SIZE
+                        && getSquaredDistanceToEdge(key, centerX, centerY)
+                                < threshold * threshold) {
+                    cell[count++] = key.mCodePoint;
+                }
+            }
+        }
+    }
+    std::vector<int> xs, ys, widths, heights, codePoints;
+    for (const Key &key : keys) {
+        xs.push_back(key.mX);
+        ys.push_back(key.mY);
+        widths.push_back(key.mWidth);
+        heights.push_back(key.mHeight);
+        codePoints.push_back(key.mCodePoint);
+    }
+    return new ProximityInfo(KEYBOARD_WIDTH, KEYBOARD_HEIGHT, GRID_WIDTH, GRID_HEIGHT, KEY_WIDTH,
+            KEY_HEIGHT, proximityChars.data(), static_cast<int>(proximityChars.size()),
+            static_cast<int>(keys.size()), xs.data(), ys.data(), widths.data(), heights.data(),
+            codePoints.data(), nullptr /* sweetSpotCenterXs */, nullptr /* sweetSpotCenterYs */,
+            nullptr /* sweetSpotRadii */);
+}
+
+// Parses a trace line, see the top of this file. Returns false for lines without a word.
+bool parseTracedWord(const std::string &line, const std::vector<Key> &keys,
+        TracedWord *const outWord) {
+    outWord->mCodePoints.clear();
+    outWord->mTouchPoints.clear();
+    if (line.empty() || line[0] == '#') {
+        return false;
+    }
+    size_t pos = line.find_first_not_of(" \t");
+    if (pos == std::string::npos) {
+        return false;
+    }
+    const size_t wordEnd = std::min(line.find_first_of(" \t", pos), line.size());
+    // The words are ASCII, as the synthetic keyboard only has the ASCII letters.
+    for (size_t i = pos; i < wordEnd && outWord->mCodePoints.size() < MAX_WORD_LENGTH; ++i) {
+        outWord->mCodePoints.push_back(CharUtils::toLowerCase(line[i]));
+    }
+    pos = wordEnd;
+    while ((pos = line.find_first_not_of(" \t", pos)) != std::string::npos) {
+        TouchPoint point;
+        if (sscanf(line.c_str() + pos, "%d,%d,%d", &point.mX, &point.mY, &point.mTime) != 3) {
+            fprintf(stderr, "Invalid touch point in \"%s\"\n", line.c_str());
+            return false;
+        }
+        outWord->mTouchPoints.push_back(point);
+        pos = line.find_first_of(" \t", pos);
+    }
+    if (!outWord->mTouchPoints.empty()) {
+        if (outWord->mTouchPoints.size() != outWord->mCodePoints.size()) {
+            fprintf(stderr, "Expected one touch point per code point in \"%s\"\n", line.c_str());
+            return false;
+        }
+        return true;
+    }
+    for (size_t i = 0; i < outWord->mCodePoints.size(); ++i) {
+        TouchPoint point{NOT_A_COORDINATE, NOT_A_COORDINATE,
+                static_cast<int>(i) * TIME_PER_KEYSTROKE_MS};
+        for (const Key &key : keys) {
+            if (key.mCodePoint == outWord->mCodePoints[i]) {
+                point.mX = key.mX + key.mWidth / 2;
+                point.mY = key.mY + key.mHeight / 2;
+            }
+        }
+        outWord->mTouchPoints.push_back(point);
+    }
+    return true;
+}
+
+bool readTrace(FILE *const file, const std::vector<Key> &keys,
+        std::vector<TracedWord> *const outWords) {
+    char buffer[4096];
+    while (fgets(buffer, sizeof(buffer), file)) {
+        std::string line(buffer);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+            line.pop_back();
+        }
+        TracedWord word;
+        if (parseTracedWord(line, keys, &word)) {
+            outWords->push_back(word);
+        } else if (!line.empty() && line[0] != '#'
+                && line.find_first_not_of(" \t") != std::string::npos) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+T getPercentile(std::vector<T> values, const int percentile) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t index = std::min(values.size() - 1, values.size() * percentile / 100);
+    return values[index];
+}
+
+template<typename T>
+double getMean(const std::vector<T> &values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (const T value : values) {
+        sum += static_cast<double>(value);
+    }
+    return sum / static_cast<double>(values.size());
+}
+
+template<typename T>
+void printDistribution(const char *const name, const std::vector<T> &values) {
+    printf("%-22s mean %10.1f  p50 %8lld  p90 %8lld  p99 %8lld  max %8lld\n", name,
+            getMean(values), static_cast<long long>(getPercentile(values, 50)),
+            static_cast<long long>(getPercentile(values, 90)),
+            static_cast<long long>(getPercentile(values, 99)),
+            static_cast<long long>(getPercentile(values, 100)));
+}
+
+double getHitRate(const std::vector<int> &ranks, const int maxRank) {
+    if (ranks.empty()) {
+        return 0.0;
+    }
+    int hitCount = 0;
+    for (const int rank : ranks) {
+        if (rank != NOT_AN_INDEX && rank < maxRank) {
+            ++hitCount;
+        }
+    }
+    return 100.0 * hitCount / static_cast<double>(ranks.size());
+}
+
+void printQuality(const std::vector<int> &ranks) {
+    printf("words %zu  top-1 %5.1f%%  top-3 %5.1f%%\n", ranks.size(), getHitRate(ranks, 1),
+            getHitRate(ranks, 3));
+}
+
+void printReport(const std::vector<Sample> &samples) {
+    std::vector<int64_t> latencies;
+    std::vector<int> searchEffortCounts[SearchEffort::COUNTER_COUNT];
+    std::vector<int64_t> allocationCounts;
+    int maxInputSize = 0;
+    for (const Sample &sample : samples) {
+        latencies.push_back(sample.mLatencyUs);
+        for (int i = 0; i < SearchEffort::COUNTER_COUNT; ++i) {
+            searchEffortCounts[i].push_back(
+                    sample.mSearchEffort.get(static_cast<SearchEffort::Counter>(i)));
+        }
+        allocationCounts.push_back(sample.mAllocationCount);
+        maxInputSize = std::max(maxInputSize, sample.mInputSize);
+    }
+    printf("keystrokes %zu\n", samples.size());
+    printDistribution("latency (us)", latencies);
+    static const char *const SEARCH_EFFORT_NAMES[SearchEffort::COUNTER_COUNT] = {
+            "pushed dic nodes", "popped dic nodes", "evicted dic nodes", "continuation cache",
+            "expanded dic nodes", "recombined dic nodes" };
+    for (int i = 0; i < SearchEffort::COUNTER_COUNT; ++i) {
+        printDistribution(SEARCH_EFFORT_NAMES[i], searchEffortCounts[i]);
+    }
+    printDistribution("allocations", allocationCounts);
+
+    int64_t metrics[NativeMetrics::VALUE_COUNT];
+    NativeMetrics::copyTo(metrics, NativeMetrics::VALUE_COUNT);
+    static const char *const PHASE_NAMES[] = { "setup", "expand", "output" };
+    for (size_t i = 0; i < NELEMS(PHASE_NAMES); ++i) {
+        const int64_t *const values = &metrics[(NativeMetrics::METRIC_SUGGEST_SETUP + i)
+                * NativeMetrics::VALUES_PER_METRIC];
+        printf("phase %-16s mean %10.1f  max %8lld\n", PHASE_NAMES[i],
+                values[0] > 0 ? static_cast<double>(values[1]) / values[0] : 0.0,
+                static_cast<long long>(values[2]));
+    }
+
+    printf("\nlatency (us) by input size\n");
+    for (int inputSize = 1; inputSize <= maxInputSize; ++inputSize) {
+        std::vector<int64_t> sizeLatencies;
+        for (const Sample &sample : samples) {
+            if (sample.mInputSize == inputSize) {
+                sizeLatencies.push_back(sample.mLatencyUs);
+            }
+        }
+        printf("%4d: n %6zu  mean %10.1f  p50 %8lld  p99 %8lld\n", inputSize,
+                sizeLatencies.size(), getMean(sizeLatencies),
+                static_cast<long long>(getPercentile(sizeLatencies, 50)),
+                static_cast<long long>(getPercentile(sizeLatencies, 99)));
+    }
+}
+
+// Prints the means of a and b, and the change from a to b.
+void printComparisonRow(const char *const name, const double a, const double b) {
+    if (a == 0.0) {
+        printf("%-22s %12.1f %12.1f %9s\n", name, a, b, "-");
+        return;
+    }
+    printf("%-22s %12.1f %12.1f %+8.1f%%\n", name, a, b, 100.0 * (b - a) / a);
+}
+
+template<typename T>
+void printDistributionComparison(const char *const name, const std::vector<T> &a,
+        const std::vector<T> &b) {
+    char rowName[64];
+    printComparisonRow(name, getMean(a), getMean(b));
+    static const int PERCENTILES[] = { 50, 90, 99 };
+    for (size_t i = 0; i < NELEMS(PERCENTILES); ++i) {
+        snprintf(rowName, sizeof(rowName), "  p%d", PERCENTILES[i]);
+        printComparisonRow(rowName, static_cast<double>(getPercentile(a, PERCENTILES[i])),
+                static_cast<double>(getPercentile(b, PERCENTILES[i])));
+    }
+}
+
+void printComparison(const Replay &a, const Replay &b) {
+    printf("a: ");
+    printQuality(a.mRanks);
+    printf("b: ");
+    printQuality(b.mRanks);
+    int top1GainCount = 0;
+    int top1LossCount = 0;
+    for (size_t i = 0; i < a.mRanks.size(); ++i) {
+        const bool isTop1InA = a.mRanks[i] == 0;
+        const bool isTop1InB = b.mRanks[i] == 0;
+        if (isTop1InB && !isTop1InA) {
+            ++top1GainCount;
+        } else if (isTop1InA && !isTop1InB) {
+            ++top1LossCount;
+        }
+    }
+    printf("top-1 %+5.1f points (b gains %d words and loses %d), top-3 %+5.1f points\n",
+            getHitRate(b.mRanks, 1) - getHitRate(a.mRanks, 1), top1GainCount, top1LossCount,
+            getHitRate(b.mRanks, 3) - getHitRate(a.mRanks, 3));
+
+    printf("\n%-22s %12s %12s %9s\n", "mean per keystroke", "a", "b", "change");
+    std::vector<int64_t> latencies[2];
+    std::vector<int> searchEffortCounts[2][SearchEffort::COUNTER_COUNT];
+    const Replay *const replays[] = { &a, &b };
+    for (int r = 0; r < 2; ++r) {
+        for (const Sample &sample : replays[r]->mSamples) {
+            latencies[r].push_back(sample.mLatencyUs);
+            for (int i = 0; i < SearchEffort::COUNTER_COUNT; ++i) {
+                searchEffortCounts[r][i].push_back(
+                        sample.mSearchEffort.get(static_cast<SearchEffort::Counter>(i)));
+            }
+        }
+    }
+    printDistributionComparison("latency (us)", latencies[0], latencies[1]);
+    static const char *const SEARCH_EFFORT_NAMES[SearchEffort::COUNTER_COUNT] = {
+            "pushed dic nodes", "popped dic nodes", "evicted dic nodes", "continuation cache",
+            "expanded dic nodes", "recombined dic nodes" };
+    for (int i = 0; i < SearchEffort::COUNTER_COUNT; ++i) {
+        printComparisonRow(SEARCH_EFFORT_NAMES[i], getMean(searchEffortCounts[0][i]),
+                getMean(searchEffortCounts[1][i]));
+    }
+}
+
+// Parses a configuration, see the top of this file, over the values already in outConfig.
+bool parseConfig(const char *const value, Config *const outConfig) {
+    const std::string config(value);
+    size_t pos = 0;
+    while (pos < config.size()) {
+        const size_t end = std::min(config.find(',', pos), config.size());
+        const std::string entry = config.substr(pos, end - pos);
+        pos = end + 1;
+        const size_t separator = entry.find('=');
+        if (separator == std::string::npos) {
+            fprintf(stderr, "Invalid configuration entry \"%s\"\n", entry.c_str());
+            return false;
+        }
+        const std::string key = entry.substr(0, separator);
+        const int number = std::max(0, atoi(entry.c_str() + separator + 1));
+        if (key == "limit") {
+            outConfig->mSearchTimeLimitUs = number;
+        } else if (key == "threads") {
+            outConfig->mParallelExpansionThreadCount = number;
+        } else if (key == "beam") {
+            outConfig->mBeamWidth = number;
+        } else if (key == "full_edit") {
+            outConfig->mUsesFullEditDistance = number != 0;
+        } else if (key == "locale") {
+            outConfig->mWeightForLocaleInThousands = number;
+        } else {
+            fprintf(stderr, "Unknown configuration key \"%s\"\n", key.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the rank of codePoints in the suggestions, or NOT_AN_INDEX when it isn't suggested.
+int getRank(const SuggestionResults &results, const std::vector<int> &codePoints) {
+    std::vector<SuggestedWord> suggestedWords;
+    results.getSuggestedWords(&suggestedWords);
+    std::sort(suggestedWords.begin(), suggestedWords.end(),
+            [](const SuggestedWord &left, const SuggestedWord &right) {
+                return left.getScore() > right.getScore();
+            });
+    for (size_t rank = 0; rank < suggestedWords.size(); ++rank) {
+        const SuggestedWord &suggestedWord = suggestedWords[rank];
+        if (suggestedWord.getCodePointCount() != static_cast<int>(codePoints.size())) {
+            continue;
+        }
+        bool isSame = true;
+        for (size_t i = 0; i < codePoints.size() && isSame; ++i) {
+            isSame = CharUtils::toLowerCase(suggestedWord.getCodePoint()[i]) == codePoints[i];
+        }
+        if (isSame) {
+            return static_cast<int>(rank);
+        }
+    }
+    return NOT_AN_INDEX;
+}
+
+// Replays every prefix of every word runCount times on a new session. The ranks are taken from
+// the first run.
+void replayTrace(const Dictionary *const dictionary, ProximityInfo *const proximityInfo,
+        const std::vector<TracedWord> &words, const int runCount, const bool usesLargeCache,
+        const Config &config, Replay *const outReplay) {
+    TypingBeamWidthTuner::getInstance()->setFixedBeamWidth(config.mBeamWidth);
+    DicTraverseSession session(usesLargeCache);
+    // See SuggestOptions.
+    int options[] = { 0 /* isGesture */, config.mUsesFullEditDistance ? 1 : 0,
+            0 /* blockOffensiveWords */, 0 /* spaceAwareGesture */,
+            config.mWeightForLocaleInThousands, config.mSearchTimeLimitUs,
+            config.mParallelExpansionThreadCount };
+    const SuggestOptions suggestOptions(options, NELEMS(options));
+    const NgramContext ngramContext;
+    int xs[MAX_WORD_LENGTH];
+    int ys[MAX_WORD_LENGTH];
+    int times[MAX_WORD_LENGTH];
+    int pointerIds[MAX_WORD_LENGTH] = {};
+    int codePoints[MAX_WORD_LENGTH];
+    for (int run = 0; run < runCount; ++run) {
+        for (const TracedWord &word : words) {
+            const int wordLength = static_cast<int>(word.mCodePoints.size());
+            for (int i = 0; i < wordLength; ++i) {
+                xs[i] = word.mTouchPoints[i].mX;
+                ys[i] = word.mTouchPoints[i].mY;
+                times[i] = word.mTouchPoints[i].mTime;
+                codePoints[i] = word.mCodePoints[i];
+            }
+            for (int inputSize = 1; inputSize <= wordLength; ++inputSize) {
+                SuggestionResults results(MAX_RESULTS);
+                const int64_t allocationCount = sAllocationCount.load(std::memory_order_relaxed);
+                const int64_t startTimeUs = TimeKeeper::getMonotonicTimeInMicroseconds();
+                dictionary->getSuggestions(proximityInfo, &session, xs, ys, times, pointerIds,
+                        codePoints, inputSize, &ngramContext, &suggestOptions,
+                        NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL, &results);
+                const int64_t latencyUs =
+                        TimeKeeper::getMonotonicTimeInMicroseconds() - startTimeUs;
+                outReplay->mSamples.push_back(Sample{inputSize, latencyUs,
+                        results.getSearchEffort(),
+                        sAllocationCount.load(std::memory_order_relaxed) - allocationCount});
+                if (run == 0 && inputSize == wordLength) {
+                    outReplay->mRanks.push_back(getRank(results, word.mCodePoints));
+                }
+            }
+        }
+    }
+    TypingBeamWidthTuner::getInstance()->setFixedBeamWidth(0);
+}
+
+void usage(const char *const argv0) {
+    fprintf(stderr, "usage: %s -d main.dict [-t trace.txt] [-r runs] [-l search_time_limit_us]"
+            " [-p parallel_expansion_threads] [-a config] [-b config]\n", argv0);
+}
+
+int run(int argc, char **argv) {
+    const char *dictPath = nullptr;
+    const char *tracePath = nullptr;
+    const char *configA = nullptr;
+    const char *configB = nullptr;
+    int runCount = 1;
+    int searchTimeLimitUs = 0;
+    int parallelExpansionThreadCount = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char *const arg = argv[i];
+        const char *const value = argv[++i];
+        if (strcmp(arg, "-d") == 0) {
+            dictPath = value;
+        } else if (strcmp(arg, "-t") == 0) {
+            tracePath = value;
+        } else if (strcmp(arg, "-r") == 0) {
+            runCount = std::max(1, atoi(value));
+        } else if (strcmp(arg, "-l") == 0) {
+            searchTimeLimitUs = std::max(0, atoi(value));
+        } else if (strcmp(arg, "-p") == 0) {
+            parallelExpansionThreadCount = std::max(0, atoi(value));
+        } else if (strcmp(arg, "-a") == 0) {
+            configA = value;
+        } else if (strcmp(arg, "-b") == 0) {
+            configB = value;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!dictPath) {
+        usage(argv[0]);
+        return 1;
+    }
+    // The weight for the locale is in thousands.
+    const Config defaultConfig{searchTimeLimitUs, parallelExpansionThreadCount,
+            0 /* beamWidth */, false /* usesFullEditDistance */,
+            1000 /* weightForLocaleInThousands */};
+    Config a = defaultConfig;
+    Config b = defaultConfig;
+    if ((configA && !parseConfig(configA, &a)) || (configB && !parseConfig(configB, &b))) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const std::vector<Key> keys = createQwertyKeys();
+    std::vector<TracedWord> words;
+    FILE *const traceFile = tracePath ? fopen(tracePath, "r") : stdin;
+    if (!traceFile) {
+        fprintf(stderr, "Cannot open %s\n", tracePath);
+        return 1;
+    }
+    const bool isTraceValid = readTrace(traceFile, keys, &words);
+    if (tracePath) {
+        fclose(traceFile);
+    }
+    if (!isTraceValid || words.empty()) {
+        fprintf(stderr, "No words to replay\n");
+        return 1;
+    }
+
+    FILE *const dictFile = fopen(dictPath, "rb");
+    if (!dictFile) {
+        fprintf(stderr, "Cannot open %s\n", dictPath);
+        return 1;
+    }
+    fseek(dictFile, 0, SEEK_END);
+    const long dictSize = ftell(dictFile);
+    fclose(dictFile);
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(dictPath,
+                    0 /* bufOffset */, static_cast<int>(dictSize), false /* isUpdatable */);
+    if (!policy) {
+        fprintf(stderr, "Cannot load %s\n", dictPath);
+        return 1;
+    }
+    const bool usesLargeCache = DicTraverseSession::usesLargeCacheForDictionarySize(dictSize);
+    const Dictionary dictionary(nullptr /* env */, std::move(policy), usesLargeCache);
+    ProximityInfo *const proximityInfo = createQwertyProximityInfo(keys);
+    if (configB) {
+        // Neither configuration pays for the lazily built indices of the dictionary.
+        Replay warmUpReplay;
+        replayTrace(&dictionary, proximityInfo, words, 1 /* runCount */, usesLargeCache, a,
+                &warmUpReplay);
+    }
+    Replay replayA;
+    replayTrace(&dictionary, proximityInfo, words, runCount, usesLargeCache, a, &replayA);
+    if (configB) {
+        Replay replayB;
+        replayTrace(&dictionary, proximityInfo, words, runCount, usesLargeCache, b, &replayB);
+        printComparison(replayA, replayB);
+    } else {
+        printQuality(replayA.mRanks);
+        printReport(replayA.mSamples);
+    }
+    delete proximityInfo;
+    return 0;
+}
+
+} // namespace
+} // namespace latinime
+
+int main(int argc, char **argv) {
+    return latinime::run(argc, argv);
+}
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "dictionary/interface/dictionary_header_structure_policy.h"
+#include "dictionary/utils/buffer_with_extendable_buffer.h"
 
 namespace latinime {
 namespace {
@@ -74,5 +75,48 @@ TEST(HeaderReadWriteUtilsTest, TestAttributeMapCodeForPoints) {
             &attributeMap, "abc"));
 }
 
+TEST(HeaderReadWriteUtilsTest, TestReadAttributesInPlace) {
+    DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+    HeaderReadWriteUtils::setIntAttribute(&attributeMap, "abc", 10);
+    HeaderReadWriteUtils::setIntAttribute(&attributeMap, "abcd", -30);
+    HeaderReadWriteUtils::setBoolAttribute(&attributeMap, "flag", true);
+    HeaderReadWriteUtils::setCodePointVectorAttribute(&attributeMap, "text", { 'a', '1' });
+    const std::vector<int> codePoints = { 0x20, 0xFF, 0x100, 0x100000 };
+    HeaderReadWriteUtils::setCodePointVectorAttribute(&attributeMap, "xyz", codePoints);
+
+    BufferWithExtendableBuffer buffer(
+            BufferWithExtendableBuffer::DEFAULT_MAX_ADDITIONAL_BUFFER_SIZE);
+    int writingPos = 0;
+    ASSERT_TRUE(HeaderReadWriteUtils::writeDictionaryVersion(&buffer, FormatUtils::VERSION_403,
+            &writingPos));
+    ASSERT_TRUE(HeaderReadWriteUtils::writeDictionaryFlags(&buffer, 0 /* flags */,
+            &writingPos));
+    int headerSizeFieldPos = writingPos;
+    ASSERT_TRUE(HeaderReadWriteUtils::writeDictionaryHeaderSize(&buffer, 0 /* size */,
+            &writingPos));
+    ASSERT_TRUE(HeaderReadWriteUtils::writeHeaderAttributes(&buffer, &attributeMap,
+            &writingPos));
+    ASSERT_TRUE(HeaderReadWriteUtils::writeDictionaryHeaderSize(&buffer, writingPos,
+            &headerSizeFieldPos));
+    const uint8_t *const dictBuf = buffer.getContiguousView().data();
+
+    EXPECT_EQ(10, HeaderReadWriteUtils::readIntAttributeValue(dictBuf, "abc", 100));
+    EXPECT_EQ(-30, HeaderReadWriteUtils::readIntAttributeValue(dictBuf, "abcd", 100));
+    EXPECT_EQ(100, HeaderReadWriteUtils::readIntAttributeValue(dictBuf, "ab", 100));
+    EXPECT_EQ(100, HeaderReadWriteUtils::readIntAttributeValue(dictBuf, "abcde", 100));
+    EXPECT_EQ(100, HeaderReadWriteUtils::readIntAttributeValue(dictBuf, "text", 100));
+    EXPECT_TRUE(HeaderReadWriteUtils::readBoolAttributeValue(dictBuf, "flag", false));
+    EXPECT_FALSE(HeaderReadWriteUtils::readBoolAttributeValue(dictBuf, "nothing", false));
+    EXPECT_EQ(codePoints, HeaderReadWriteUtils::readCodePointVectorAttributeValue(dictBuf,
+            "xyz"));
+    EXPECT_TRUE(HeaderReadWriteUtils::readCodePointVectorAttributeValue(dictBuf, "").empty());
+    EXPECT_EQ(NOT_A_DICT_POS, HeaderReadWriteUtils::getAttributeValuePosition(dictBuf, "x"));
+    EXPECT_TRUE(HeaderReadWriteUtils::readCodePointTable(dictBuf).empty());
+
+    DictionaryHeaderStructurePolicy::AttributeMap fetchedAttributeMap;
+    HeaderReadWriteUtils::fetchAllHeaderAttributes(dictBuf, &fetchedAttributeMap);
+    EXPECT_EQ(attributeMap, fetchedAttributeMap);
+}
+
 }  // namespace
 }  // namespace latinime
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/interface/ngram_listener.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/property/ngram_property.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// More than fit in one batch of NgramListener::Batch.
+static const int SUCCESSOR_COUNT = NgramListener::MAX_BATCH_SIZE * 2 + 3;
+static const int UNIGRAM_PROBABILITY = 100;
+
+class BatchSizeListener : public NgramListener {
+ public:
+    BatchSizeListener() : mBatchSizes() {}
+
+    virtual void onVisitEntry(const int ngramProbability, const int targetWordId) {
+        mBatchSizes.push_back(1);
+    }
+
+    virtual void onVisitEntries(const int *const ngramProbabilities,
+            const int *const targetWordIds, const int count) {
+        mBatchSizes.push_back(count);
+    }
+
+    std::vector<int> mBatchSizes;
+};
+
+// Only handles single entries.
+class WordIdListener : public NgramListener {
+ public:
+    WordIdListener() : mWordIds() {}
+
+    virtual void onVisitEntry(const int ngramProbability, const int targetWordId) {
+        mWordIds.push_back(targetWordId);
+    }
+
+    std::vector<int> mWordIds;
+};
+
+std::vector<int> getWord(const int index) {
+    return { 'a' + index % 26, 'a' + index / 26 };
+}
+
+DictionaryStructureWithBufferPolicy::StructurePolicyPtr createPolicy() {
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    // The previous word, the successors and a word that is not a successor.
+    for (int i = -1; i <= SUCCESSOR_COUNT; ++i) {
+        DictionaryTestUtils::addUnigram(policy.get(), getWord(i + 1), UNIGRAM_PROBABILITY);
+    }
+    const std::vector<int> prevWord = getWord(0);
+    const NgramContext ngramContext(prevWord.data(), static_cast<int>(prevWord.size()),
+            false /* isBeginningOfSentence */);
+    for (int i = 0; i < SUCCESSOR_COUNT; ++i) {
+        const NgramProperty ngramProperty(ngramContext, getWord(i + 1),
+                UNIGRAM_PROBABILITY + 1 + i % 100 /* probability */, HistoricalInfo());
+        EXPECT_TRUE(policy->addNgramEntry(&ngramProperty));
+    }
+    return policy;
+}
+
+int getWordId(const DictionaryStructureWithBufferPolicy *const policy, const int index) {
+    return policy->getWordId(CodePointArrayView(getWord(index)),
+            false /* forceLowerCaseSearch */);
+}
+
+TEST(NgramListenerTest, TestIteratesNgramEntriesInBatches) {
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy = createPolicy();
+    ASSERT_NE(nullptr, policy.get());
+    const int prevWordId = getWordId(policy.get(), 0);
+    BatchSizeListener listener;
+    policy->iterateNgramEntries(WordIdArrayView::singleElementView(&prevWordId), &listener);
+    EXPECT_EQ(std::vector<int>({ NgramListener::MAX_BATCH_SIZE, NgramListener::MAX_BATCH_SIZE,
+            3 }), listener.mBatchSizes);
+}
+
+TEST(NgramListenerTest, TestVisitsEachEntryByDefault) {
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy = createPolicy();
+    ASSERT_NE(nullptr, policy.get());
+    const int prevWordId = getWordId(policy.get(), 0);
+    WordIdListener listener;
+    policy->iterateNgramEntries(WordIdArrayView::singleElementView(&prevWordId), &listener);
+    ASSERT_EQ(static_cast<size_t>(SUCCESSOR_COUNT), listener.mWordIds.size());
+    std::vector<int> wordIds;
+    for (int i = 0; i < SUCCESSOR_COUNT; ++i) {
+        wordIds.push_back(getWordId(policy.get(), i + 1));
+    }
+    EXPECT_TRUE(std::is_permutation(wordIds.begin(), wordIds.end(), listener.mWordIds.begin()));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/property/ngram_context.h"
+
+#include <gtest/gtest.h>
+
+namespace latinime {
+namespace {
+
+TEST(NgramContextTest, TestHasSamePrevWords) {
+    const int word[] = {'w', 'o', 'r', 'd'};
+    const int other[] = {'w', 'o', 'r', 'e'};
+    const int wordLength = NELEMS(word);
+    const NgramContext ngramContext(word, wordLength, false /* isBeginningOfSentence */);
+
+    EXPECT_TRUE(ngramContext.hasSamePrevWords(ngramContext));
+    EXPECT_TRUE(ngramContext.hasSamePrevWords(NgramContext(ngramContext)));
+    EXPECT_TRUE(ngramContext.hasSamePrevWords(
+            NgramContext(word, wordLength, false /* isBeginningOfSentence */)));
+    EXPECT_FALSE(ngramContext.hasSamePrevWords(
+            NgramContext(other, wordLength, false /* isBeginningOfSentence */)));
+    EXPECT_FALSE(ngramContext.hasSamePrevWords(
+            NgramContext(word, wordLength - 1, false /* isBeginningOfSentence */)));
+    EXPECT_FALSE(ngramContext.hasSamePrevWords(
+            NgramContext(word, wordLength, true /* isBeginningOfSentence */)));
+    EXPECT_FALSE(ngramContext.hasSamePrevWords(NgramContext()));
+    EXPECT_TRUE(NgramContext().hasSamePrevWords(NgramContext()));
+}
+
+TEST(NgramContextTest, TestHasSamePrevWordsForMultipleWords) {
+    int prevWordCodePoints[2][MAX_WORD_LENGTH] = {{'a', 'b'}, {'c'}};
+    const int prevWordCodePointCounts[] = {2, 1};
+    const bool isBeginningOfSentence[] = {false, false};
+    const NgramContext ngramContext(prevWordCodePoints, prevWordCodePointCounts,
+            isBeginningOfSentence, 2 /* prevWordCount */);
+
+    EXPECT_TRUE(ngramContext.hasSamePrevWords(NgramContext(prevWordCodePoints,
+            prevWordCodePointCounts, isBeginningOfSentence, 2 /* prevWordCount */)));
+    EXPECT_FALSE(ngramContext.hasSamePrevWords(NgramContext(prevWordCodePoints,
+            prevWordCodePointCounts, isBeginningOfSentence, 1 /* prevWordCount */)));
+    prevWordCodePoints[1][0] = 'd';
+    EXPECT_FALSE(ngramContext.hasSamePrevWords(NgramContext(prevWordCodePoints,
+            prevWordCodePointCounts, isBeginningOfSentence, 2 /* prevWordCount */)));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/pt_common/dynamic_pt_reading_helper.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "dictionary/header/header_policy.h"
+#include "dictionary/property/unigram_property.h"
+#include "dictionary/structure/pt_common/dynamic_pt_writing_utils.h"
+#include "dictionary/structure/pt_common/pt_node_params.h"
+#include "dictionary/structure/v4/ver4_dict_buffers.h"
+#include "dictionary/structure/v4/ver4_dict_constants.h"
+#include "dictionary/structure/v4/ver4_patricia_trie_node_reader.h"
+#include "dictionary/structure/v4/ver4_patricia_trie_policy.h"
+#include "dictionary/structure/v4/ver4_pt_node_array_reader.h"
+#include "dictionary/utils/format_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// Records the first code point of each visited PtNode.
+class RecordingListener : public DynamicPtReadingHelper::TraversingEventListener {
+ public:
+    RecordingListener() : mVisitedCodePoints(), mDescendCount(0), mTailCount(0) {}
+
+    bool onAscend() { return true; }
+
+    bool onDescend(const int /* ptNodeArrayPos */) {
+        ++mDescendCount;
+        return true;
+    }
+
+    bool onReadingPtNodeArrayTail() {
+        ++mTailCount;
+        return true;
+    }
+
+    bool onVisitingPtNode(const PtNodeParams *const node) {
+        mVisitedCodePoints.push_back(static_cast<char>(node->getCodePoints()[0]));
+        return true;
+    }
+
+    std::string mVisitedCodePoints;
+    int mDescendCount;
+    int mTailCount;
+};
+
+void addWord(DictionaryStructureWithBufferPolicy *const policy, const std::vector<int> &word) {
+    const UnigramProperty unigramProperty(false /* representsBeginningOfSentence */,
+            false /* isNotAWord */, false /* isPossiblyOffensive */, 100 /* probability */,
+            HistoricalInfo());
+    ASSERT_TRUE(policy->addUnigramEntry(CodePointArrayView(word), &unigramProperty));
+}
+
+class DynamicPtReadingHelperTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        const std::vector<int> locale = { 'e', 'n' };
+        const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+        HeaderPolicy headerPolicy(FormatUtils::VERSION_403, locale, &attributeMap);
+        Ver4DictBuffers::Ver4DictBuffersPtr buffers = Ver4DictBuffers::createVer4DictBuffers(
+                &headerPolicy, Ver4DictConstants::MAX_DICT_EXTENDED_REGION_SIZE);
+        ASSERT_TRUE(DynamicPtWritingUtils::writeEmptyDictionary(
+                buffers->getWritableTrieBuffer(), 0 /* rootPos */));
+        mBuffers = buffers.get();
+        mPolicy.reset(new Ver4PatriciaTriePolicy(std::move(buffers)));
+        // Root: a _ d, level 1: b _ c and e _ f, level 2: x and y.
+        for (const std::vector<int> &word : std::vector<std::vector<int>>({ { 'a', 'b' },
+                { 'a', 'c' }, { 'a', 'b', 'x' }, { 'a', 'c', 'y' }, { 'd', 'e' },
+                { 'd', 'f' } })) {
+            addWord(mPolicy.get(), word);
+        }
+    }
+
+    void traverse(const int hotLevelCount, RecordingListener *const listener) {
+        const Ver4PatriciaTrieNodeReader ptNodeReader(mBuffers->getTrieBuffer());
+        const Ver4PtNodeArrayReader ptNodeArrayReader(mBuffers->getTrieBuffer());
+        DynamicPtReadingHelper readingHelper(&ptNodeReader, &ptNodeArrayReader);
+        readingHelper.initWithPtNodeArrayPos(0 /* rootPos */);
+        EXPECT_TRUE(readingHelper.traverseAllPtNodesInPtNodeArrayLevelHotLevelsFirstManner(
+                hotLevelCount, listener));
+    }
+
+    const Ver4DictBuffers *mBuffers = nullptr;
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr mPolicy;
+};
+
+TEST_F(DynamicPtReadingHelperTest, TestFallsBackToPreorderWithoutHotLevels) {
+    RecordingListener listener;
+    traverse(0 /* hotLevelCount */, &listener);
+    EXPECT_EQ("adbcxyef", listener.mVisitedCodePoints);
+    EXPECT_EQ(5, listener.mDescendCount);
+    EXPECT_EQ(5, listener.mTailCount);
+}
+
+TEST_F(DynamicPtReadingHelperTest, TestVisitsHotLevelsFirst) {
+    RecordingListener listener;
+    traverse(2 /* hotLevelCount */, &listener);
+    EXPECT_EQ("adbcefxy", listener.mVisitedCodePoints);
+    EXPECT_EQ(5, listener.mDescendCount);
+    EXPECT_EQ(5, listener.mTailCount);
+}
+
+TEST_F(DynamicPtReadingHelperTest, TestVisitsEachPtNodeOnceWithDeepHotLevels) {
+    RecordingListener listener;
+    traverse(10 /* hotLevelCount */, &listener);
+    EXPECT_EQ("adbcefxy", listener.mVisitedCodePoints);
+    EXPECT_EQ(5, listener.mDescendCount);
+    EXPECT_EQ(5, listener.mTailCount);
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/pt_common/dynamic_pt_updating_helper.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+#include "utils/memory_usage.h"
+
+namespace latinime {
+namespace {
+
+int getProbability(const DictionaryStructureWithBufferPolicy *const policy,
+        const std::vector<int> &word) {
+    const int wordId = policy->getWordId(CodePointArrayView(word),
+            false /* forceLowerCaseSearch */);
+    if (wordId == NOT_A_WORD_ID) {
+        return NOT_A_PROBABILITY;
+    }
+    return policy->getProbabilityOfWord(WordIdArrayView(), wordId);
+}
+
+int64_t getAdditionalBufferBytes(const DictionaryStructureWithBufferPolicy *const policy) {
+    MemoryUsage memoryUsage;
+    policy->addMemoryUsage(&memoryUsage);
+    return memoryUsage.get(MemoryUsage::ADDITIONAL_BUFFER_BYTES);
+}
+
+TEST(DynamicPtUpdatingHelperTest, TestUpdatesProbabilityInPlace) {
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    ASSERT_NE(nullptr, policy.get());
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b' }, 100 /* probability */);
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b', 'c' }, 100 /* probability */);
+    const int64_t additionalBufferBytes = getAdditionalBufferBytes(policy.get());
+    for (int probability = 101; probability < 110; ++probability) {
+        DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b' }, probability);
+        DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b', 'c' }, probability);
+    }
+    EXPECT_EQ(additionalBufferBytes, getAdditionalBufferBytes(policy.get()));
+    EXPECT_EQ(109, getProbability(policy.get(), { 'a', 'b' }));
+    EXPECT_EQ(109, getProbability(policy.get(), { 'a', 'b', 'c' }));
+}
+
+TEST(DynamicPtUpdatingHelperTest, TestRestoresRemovedWordInPlace) {
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    ASSERT_NE(nullptr, policy.get());
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b' }, 100 /* probability */);
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b', 'c' }, 100 /* probability */);
+    const int64_t additionalBufferBytes = getAdditionalBufferBytes(policy.get());
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(policy->removeUnigramEntry(CodePointArrayView(
+                std::vector<int>({ 'a', 'b' }))));
+        EXPECT_EQ(NOT_A_PROBABILITY, getProbability(policy.get(), { 'a', 'b' }));
+        DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b' }, 120 + i /* probability */);
+    }
+    EXPECT_EQ(additionalBufferBytes, getAdditionalBufferBytes(policy.get()));
+    EXPECT_EQ(129, getProbability(policy.get(), { 'a', 'b' }));
+    // The child is still reached through the restored PtNode.
+    EXPECT_EQ(100, getProbability(policy.get(), { 'a', 'b', 'c' }));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v2/ver2_child_edge_index.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/structure/pt_common/patricia_trie_reading_utils.h"
+#include "tests/dictionary/structure/v2/ver2_dict_buffer_test_utils.h"
+#include "utils/byte_array_view.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+static const int SMILEY = 0x1F600;
+
+// The code points of the alphabet go from 'a' to SMILEY, and both ends start words. "abcdef" and
+// "naïve" have more code points than fit in a record of the index.
+const std::map<std::vector<int>, int> WORDS = {
+        { { 'a' }, 200 }, { { 'a', 'b' }, 120 }, { { 'a', 'b', 'c' }, 110 },
+        { { 'a', 'b', 'c', 'd', 'e', 'f' }, 90 }, { { 'a', 'b', 'd' }, 100 },
+        { { 'b', 'e' }, 150 }, { { 'c', 'a', 'f', 0xE9 }, 80 },
+        { { 'n', 'a', 0xEF, 'v', 'e' }, 70 }, { { 'z', 'e', 'b', 'r', 'a' }, 60 },
+        { { 'z', 'z' }, 50 }, { { SMILEY }, 140 }, { { 'x', SMILEY, 'y' }, 40 } };
+
+struct PtNodeInfo {
+    int mPos;
+    std::vector<int> mCodePoints;
+    int mProbability;
+    int mChildrenPos;
+};
+
+// Reads the PtNodes of the PtNode array one after another from the buffer.
+std::vector<PtNodeInfo> readPtNodeArray(const std::vector<uint8_t> &buffer,
+        const int ptNodeArrayPos) {
+    int pos = ptNodeArrayPos;
+    const int ptNodeCount =
+            PatriciaTrieReadingUtils::getPtNodeArraySizeAndAdvancePosition(buffer.data(), &pos);
+    std::vector<PtNodeInfo> ptNodes;
+    for (int i = 0; i < ptNodeCount; ++i) {
+        PtNodeInfo ptNode;
+        ptNode.mPos = pos;
+        PatriciaTrieReadingUtils::NodeFlags flags;
+        int codePoints[MAX_WORD_LENGTH];
+        int codePointCount = 0;
+        int shortcutPos = NOT_A_DICT_POS;
+        int bigramPos = NOT_A_DICT_POS;
+        PatriciaTrieReadingUtils::readPtNodeInfo(buffer.data(), buffer.size(), ptNode.mPos,
+                nullptr /* shortcutPolicy */, nullptr /* bigramPolicy */,
+                nullptr /* codePointTable */, &flags, &codePointCount, codePoints,
+                &ptNode.mProbability, &ptNode.mChildrenPos, &shortcutPos, &bigramPos, &pos);
+        ptNode.mCodePoints.assign(codePoints, codePoints + codePointCount);
+        if (!PatriciaTrieReadingUtils::isTerminal(flags)) {
+            ptNode.mProbability = NOT_A_PROBABILITY;
+        }
+        ptNodes.push_back(ptNode);
+    }
+    return ptNodes;
+}
+
+// Looks the word up by scanning the PtNode arrays from the root, like the policy does without
+// the index. The word id of a ver2 word is the position of its terminal PtNode.
+int getWordIdByLinearScan(const std::vector<uint8_t> &buffer,
+        const std::vector<int> &codePoints) {
+    if (codePoints.empty()) {
+        return NOT_A_WORD_ID;
+    }
+    int ptNodeArrayPos = 0 /* rootPos */;
+    size_t matchedCodePointCount = 0;
+    while (ptNodeArrayPos != NOT_A_DICT_POS) {
+        const PtNodeInfo *matchedPtNode = nullptr;
+        const std::vector<PtNodeInfo> ptNodes = readPtNodeArray(buffer, ptNodeArrayPos);
+        for (const PtNodeInfo &ptNode : ptNodes) {
+            if (matchedCodePointCount + ptNode.mCodePoints.size() <= codePoints.size()
+                    && std::equal(ptNode.mCodePoints.begin(), ptNode.mCodePoints.end(),
+                            codePoints.begin() + matchedCodePointCount)) {
+                matchedPtNode = &ptNode;
+                break;
+            }
+        }
+        if (!matchedPtNode) {
+            return NOT_A_WORD_ID;
+        }
+        matchedCodePointCount += matchedPtNode->mCodePoints.size();
+        if (matchedCodePointCount == codePoints.size()) {
+            return matchedPtNode->mProbability == NOT_A_PROBABILITY ? NOT_A_WORD_ID
+                    : matchedPtNode->mPos;
+        }
+        ptNodeArrayPos = matchedPtNode->mChildrenPos;
+    }
+    return NOT_A_WORD_ID;
+}
+
+int getWordId(const Ver2ChildEdgeIndex &index, const std::vector<int> &codePoints) {
+    int wordId = NOT_A_WORD_ID;
+    EXPECT_TRUE(index.getWordId(CodePointArrayView(codePoints), &wordId));
+    return wordId;
+}
+
+class Ver2ChildEdgeIndexTest : public ::testing::Test {
+ protected:
+    Ver2ChildEdgeIndexTest()
+            : mBuffer(Ver2DictBufferTestUtils::createDictBuffer(WORDS)),
+              mIndex(ReadOnlyByteArrayView(mBuffer.data(), mBuffer.size()),
+                      nullptr /* bigramPolicy */, nullptr /* shortcutPolicy */,
+                      nullptr /* codePointTable */) {}
+
+    void SetUp() override {
+        ASSERT_TRUE(mIndex.build());
+    }
+
+    const std::vector<uint8_t> mBuffer;
+    Ver2ChildEdgeIndex mIndex;
+};
+
+TEST_F(Ver2ChildEdgeIndexTest, TestHasChildEdgesOfEveryPtNodeArray) {
+    std::queue<int> ptNodeArrayPositions;
+    ptNodeArrayPositions.push(0 /* rootPos */);
+    int ptNodeArrayCount = 0;
+    while (!ptNodeArrayPositions.empty()) {
+        const int ptNodeArrayPos = ptNodeArrayPositions.front();
+        ptNodeArrayPositions.pop();
+        ++ptNodeArrayCount;
+        const std::vector<PtNodeInfo> ptNodes = readPtNodeArray(mBuffer, ptNodeArrayPos);
+        int childEdgeCount = 0;
+        const Ver2ChildEdgeIndex::ChildEdge *const childEdges =
+                mIndex.getChildEdges(ptNodeArrayPos, &childEdgeCount);
+        ASSERT_NE(nullptr, childEdges) << ptNodeArrayPos;
+        ASSERT_EQ(static_cast<int>(ptNodes.size()), childEdgeCount);
+        for (int i = 0; i < childEdgeCount; ++i) {
+            const PtNodeInfo &ptNode = ptNodes[i];
+            int codePoints[MAX_WORD_LENGTH];
+            const int codePointCount = mIndex.getCodePoints(&childEdges[i], codePoints);
+            EXPECT_EQ(ptNode.mCodePoints, std::vector<int>(codePoints,
+                    codePoints + codePointCount));
+            EXPECT_EQ(ptNode.mProbability == NOT_A_PROBABILITY ? NOT_A_WORD_ID : ptNode.mPos,
+                    childEdges[i].mWordId);
+            EXPECT_EQ(ptNode.mChildrenPos, childEdges[i].mChildrenPos);
+            EXPECT_GE(mIndex.getMaxTerminalProbability(&childEdges[i]),
+                    std::max(ptNode.mProbability, 0));
+            if (ptNode.mChildrenPos != NOT_A_DICT_POS) {
+                ptNodeArrayPositions.push(ptNode.mChildrenPos);
+            }
+        }
+    }
+    EXPECT_LT(1, ptNodeArrayCount);
+    // Positions of PtNodes and of nothing are not PtNode arrays.
+    int childEdgeCount = 0;
+    EXPECT_EQ(nullptr, mIndex.getChildEdges(1 /* ptNodeArrayPos */, &childEdgeCount));
+    EXPECT_EQ(nullptr, mIndex.getChildEdges(static_cast<int>(mBuffer.size()), &childEdgeCount));
+    EXPECT_EQ(nullptr, mIndex.getChildEdges(NOT_A_DICT_POS, &childEdgeCount));
+}
+
+TEST_F(Ver2ChildEdgeIndexTest, TestGetsWordIdsOfWords) {
+    for (const auto &word : WORDS) {
+        const int wordId = getWordIdByLinearScan(mBuffer, word.first);
+        EXPECT_NE(NOT_A_WORD_ID, wordId);
+        EXPECT_EQ(wordId, getWordId(mIndex, word.first));
+    }
+}
+
+TEST_F(Ver2ChildEdgeIndexTest, TestGetsWordIdsOfMisses) {
+    const std::vector<std::vector<int>> misses = {
+            // Empty, or not in the alphabet.
+            {}, { 'q' }, { 'A' }, { SMILEY + 1 },
+            // Prefixes that are not words, and prefixes that end within a PtNode.
+            { 'z' }, { 'x' }, { 'x', SMILEY }, { 'a', 'b', 'c', 'd' }, { 'c', 'a', 'f' },
+            // The first code point differs.
+            { 'b', 'b', 'c' }, { 'z', 'a', 'f', 0xE9 }, { SMILEY, 'e' },
+            // The last code point differs.
+            { 'a', 'b', 'e' }, { 'a', 'b', 'c', 'd', 'e', 'e' }, { 'c', 'a', 'f', 'e' },
+            { 'x', SMILEY, SMILEY },
+            // Longer than a word.
+            { 'a', 'b', 'c', 'd', 'e', 'f', 'g' }, { 'z', 'z', 'z' }, { SMILEY, SMILEY } };
+    for (const std::vector<int> &miss : misses) {
+        EXPECT_EQ(NOT_A_WORD_ID, getWordIdByLinearScan(mBuffer, miss));
+        EXPECT_EQ(NOT_A_WORD_ID, getWordId(mIndex, miss));
+    }
+}
+
+TEST_F(Ver2ChildEdgeIndexTest, TestGetsWordIdsOfEditedWords) {
+    // Every prefix of the words, and the words with each of their code points replaced by the
+    // first or the last code point of the alphabet or dropped.
+    for (const auto &word : WORDS) {
+        for (size_t i = 0; i < word.first.size(); ++i) {
+            const std::vector<int> prefix(word.first.begin(), word.first.begin() + i + 1);
+            EXPECT_EQ(getWordIdByLinearScan(mBuffer, prefix), getWordId(mIndex, prefix));
+            for (const int codePoint : { static_cast<int>('a'), SMILEY }) {
+                std::vector<int> edited = word.first;
+                edited[i] = codePoint;
+                EXPECT_EQ(getWordIdByLinearScan(mBuffer, edited), getWordId(mIndex, edited));
+            }
+            std::vector<int> dropped = word.first;
+            dropped.erase(dropped.begin() + i);
+            EXPECT_EQ(getWordIdByLinearScan(mBuffer, dropped), getWordId(mIndex, dropped));
+        }
+    }
+}
+
+TEST_F(Ver2ChildEdgeIndexTest, TestCantTellWordsWithoutUnicodeCodePoints) {
+    int wordId = NOT_A_WORD_ID;
+    const std::vector<int> codePoints = { 'a', -2 };
+    EXPECT_FALSE(mIndex.getWordId(CodePointArrayView(codePoints), &wordId));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_VER2_DICT_BUFFER_TEST_UTILS_H
+#define LATINIME_VER2_DICT_BUFFER_TEST_UTILS_H
+
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/structure/pt_common/patricia_trie_reading_utils.h"
+
+namespace latinime {
+
+// Writes the PtNode arrays of read-only ver2 dictionaries without header, n-grams or shortcuts.
+class Ver2DictBufferTestUtils {
+ public:
+    // Writes the PtNode arrays of the words, which map to their probabilities, in the
+    // breadth-first order and with 3-byte children positions.
+    static std::vector<uint8_t> createDictBuffer(const std::map<std::vector<int>, int> &words) {
+        CharNode root;
+        for (const auto &word : words) {
+            CharNode *node = &root;
+            for (const int codePoint : word.first) {
+                node = &node->mChildren[codePoint];
+            }
+            node->mProbability = word.second;
+        }
+        const std::vector<PtNode> rootPtNodes = createPtNodes(root);
+        std::vector<uint8_t> buffer;
+        // The PtNode arrays to write, with the position of the children position that points to
+        // them.
+        std::queue<std::pair<const std::vector<PtNode> *, int>> ptNodeArrays;
+        ptNodeArrays.emplace(&rootPtNodes, NOT_A_DICT_POS);
+        while (!ptNodeArrays.empty()) {
+            const std::vector<PtNode> *const ptNodes = ptNodeArrays.front().first;
+            const int childrenPosFieldPos = ptNodeArrays.front().second;
+            ptNodeArrays.pop();
+            if (childrenPosFieldPos != NOT_A_DICT_POS) {
+                const int offset = static_cast<int>(buffer.size()) - childrenPosFieldPos;
+                buffer[childrenPosFieldPos] = static_cast<uint8_t>(offset >> 16);
+                buffer[childrenPosFieldPos + 1] = static_cast<uint8_t>(offset >> 8);
+                buffer[childrenPosFieldPos + 2] = static_cast<uint8_t>(offset);
+            }
+            buffer.push_back(static_cast<uint8_t>(ptNodes->size()));
+            for (const PtNode &ptNode : *ptNodes) {
+                const bool hasMultipleChars = ptNode.mCodePoints.size() > 1;
+                const bool isTerminal = ptNode.mProbability != NOT_A_PROBABILITY;
+                buffer.push_back(PatriciaTrieReadingUtils::createAndGetFlags(
+                        false /* isPossiblyOffensive */, false /* isNotAWord */, isTerminal,
+                        false /* hasShortcutTargets */, false /* hasBigrams */, hasMultipleChars,
+                        ptNode.mChildren.empty() ? 0 : 3 /* childrenPositionFieldSize */));
+                for (const int codePoint : ptNode.mCodePoints) {
+                    writeCodePoint(codePoint, &buffer);
+                }
+                if (hasMultipleChars) {
+                    buffer.push_back(0x1F /* CHARACTER_ARRAY_TERMINATOR */);
+                }
+                if (isTerminal) {
+                    buffer.push_back(static_cast<uint8_t>(ptNode.mProbability));
+                }
+                if (!ptNode.mChildren.empty()) {
+                    ptNodeArrays.emplace(&ptNode.mChildren, static_cast<int>(buffer.size()));
+                    buffer.insert(buffer.end(), 3, 0);
+                }
+            }
+        }
+        return buffer;
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(Ver2DictBufferTestUtils);
+
+    struct PtNode {
+        std::vector<int> mCodePoints;
+        int mProbability;
+        std::vector<PtNode> mChildren;
+    };
+
+    struct CharNode {
+        std::map<int, CharNode> mChildren;
+        int mProbability = NOT_A_PROBABILITY;
+    };
+
+    // Merges the chains of non-terminal CharNodes with a single child into PtNodes.
+    static std::vector<PtNode> createPtNodes(const CharNode &charNode) {
+        std::vector<PtNode> ptNodes;
+        for (const auto &entry : charNode.mChildren) {
+            PtNode ptNode;
+            ptNode.mCodePoints.push_back(entry.first);
+            const CharNode *node = &entry.second;
+            while (node->mProbability == NOT_A_PROBABILITY && node->mChildren.size() == 1) {
+                ptNode.mCodePoints.push_back(node->mChildren.begin()->first);
+                node = &node->mChildren.begin()->second;
+            }
+            ptNode.mProbability = node->mProbability;
+            ptNode.mChildren = createPtNodes(*node);
+            ptNodes.push_back(ptNode);
+        }
+        return ptNodes;
+    }
+
+    static void writeCodePoint(const int codePoint, std::vector<uint8_t> *const outBuffer) {
+        if (codePoint >= 0x20 && codePoint <= 0xFF) {
+            outBuffer->push_back(static_cast<uint8_t>(codePoint));
+            return;
+        }
+        outBuffer->push_back(static_cast<uint8_t>(codePoint >> 16));
+        outBuffer->push_back(static_cast<uint8_t>(codePoint >> 8));
+        outBuffer->push_back(static_cast<uint8_t>(codePoint));
+    }
+};
+} // namespace latinime
+#endif // LATINIME_VER2_DICT_BUFFER_TEST_UTILS_H
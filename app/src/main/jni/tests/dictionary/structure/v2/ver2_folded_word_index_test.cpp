@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v2/ver2_folded_word_index.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/structure/v2/ver2_child_edge_index.h"
+#include "tests/dictionary/structure/v2/ver2_dict_buffer_test_utils.h"
+#include "utils/byte_array_view.h"
+#include "utils/char_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+static const int SMILEY = 0x1F600;
+
+// Words that only differ in case, accents or intentional omissions, and words that end with an
+// omission, which the index leaves out.
+const std::map<std::vector<int>, int> WORDS = {
+        { { 'a' }, 200 }, { { 'A' }, 120 }, { { 'a', 'b', 'c' }, 110 },
+        { { 'A', 'b', 'c' }, 100 }, { { 'n', 'a', 0xEF, 'v', 'e' }, 90 },
+        { { 'n', 'a', 'i', 'v', 'e' }, 80 }, { { 'c', 'a', 'n', '\'', 't' }, 150 },
+        { { 'c', 'a', 'n', 't' }, 70 }, { { 'e', '-', 'm', 'a', 'i', 'l' }, 60 },
+        { { 'e', 'm', 'a', 'i', 'l' }, 50 }, { { 'r', 'e', '-' }, 40 },
+        { { '\'', 't', 'i', 's' }, 30 }, { { 0xDC, 'b', 'e', 'r' }, 20 },
+        { { 'u', 'b', 'e', 'r' }, 10 }, { { 'r', 0xE9, 's', 'u', 'm', 0xE9 }, 90 },
+        { { SMILEY }, 140 }, { { 'x', SMILEY }, 40 } };
+
+// Returns the code points in base lower case without the intentional omissions.
+std::vector<int> fold(const std::vector<int> &codePoints) {
+    std::vector<int> foldedCodePoints;
+    for (const int codePoint : codePoints) {
+        if (!CharUtils::isIntentionalOmissionCodePoint(codePoint)) {
+            foldedCodePoints.push_back(CharUtils::toBaseLowerCase(codePoint));
+        }
+    }
+    return foldedCodePoints;
+}
+
+class Ver2FoldedWordIndexTest : public ::testing::Test {
+ protected:
+    Ver2FoldedWordIndexTest()
+            : mBuffer(Ver2DictBufferTestUtils::createDictBuffer(WORDS)),
+              mChildEdgeIndex(ReadOnlyByteArrayView(mBuffer.data(), mBuffer.size()),
+                      nullptr /* bigramPolicy */, nullptr /* shortcutPolicy */,
+                      nullptr /* codePointTable */),
+              mFoldedWordIndex() {}
+
+    void SetUp() override {
+        ASSERT_TRUE(mChildEdgeIndex.build());
+        mFoldedWordIndex.build(&mChildEdgeIndex);
+    }
+
+    // Scans all the words for the ones that match the code points.
+    std::vector<int> getWordIdsByLinearScan(const std::vector<int> &codePoints) const {
+        std::vector<int> wordIds;
+        for (const auto &word : WORDS) {
+            if (CharUtils::isIntentionalOmissionCodePoint(word.first.back())
+                    || fold(word.first) != fold(codePoints)) {
+                continue;
+            }
+            int wordId = NOT_A_WORD_ID;
+            EXPECT_TRUE(mChildEdgeIndex.getWordId(CodePointArrayView(word.first), &wordId));
+            EXPECT_NE(NOT_A_WORD_ID, wordId);
+            wordIds.push_back(wordId);
+        }
+        std::sort(wordIds.begin(), wordIds.end());
+        return wordIds;
+    }
+
+    std::vector<int> getWordIds(const std::vector<int> &codePoints) const {
+        const int *wordIds = nullptr;
+        int wordIdCount = 0;
+        EXPECT_TRUE(mFoldedWordIndex.getWordIds(CodePointArrayView(codePoints), &wordIds,
+                &wordIdCount));
+        std::vector<int> sortedWordIds(wordIds, wordIds + wordIdCount);
+        std::sort(sortedWordIds.begin(), sortedWordIds.end());
+        return sortedWordIds;
+    }
+
+    const std::vector<uint8_t> mBuffer;
+    Ver2ChildEdgeIndex mChildEdgeIndex;
+    Ver2FoldedWordIndex mFoldedWordIndex;
+};
+
+TEST_F(Ver2FoldedWordIndexTest, TestMatchesLinearScanForWords) {
+    for (const auto &word : WORDS) {
+        const std::vector<int> query = fold(word.first);
+        if (query.empty()) {
+            continue;
+        }
+        EXPECT_EQ(getWordIdsByLinearScan(query), getWordIds(query));
+    }
+}
+
+TEST_F(Ver2FoldedWordIndexTest, TestMatchesLinearScanForFoldedQueries) {
+    const std::vector<std::vector<int>> queries = {
+            // Other cases and accents than the words.
+            { 'a' }, { 0xC0 }, { 'A', 'B', 'C' }, { 0xE0, 'b', 'c' }, { 'N', 'A', 'I', 'V', 'E' },
+            { 'n', 'a', 0xEE, 'v', 'e' }, { 'C', 'A', 'N', 'T' }, { 'E', 'm', 'a', 'i', 'l' },
+            { 'u', 'b', 'e', 'r' }, { 0xFC, 'b', 'e', 'r' }, { 'R', 'e', 's', 'u', 'm', 'e' },
+            { 'x', SMILEY },
+            // Without the omissions of the words.
+            { 'r', 'e' }, { 't', 'i', 's' },
+            // Misses.
+            { 'b' }, { 'a', 'b' }, { 'c', 'a', 'n' }, { 'n', 'a', 'i', 'v' }, { SMILEY, 'x' },
+            { 'a', 'b', 'c', 'd' } };
+    for (const std::vector<int> &query : queries) {
+        EXPECT_EQ(getWordIdsByLinearScan(query), getWordIds(query));
+    }
+    EXPECT_EQ(2u, getWordIds({ 'a' }).size());
+    EXPECT_EQ(2u, getWordIds({ 'C', 'A', 'N', 'T' }).size());
+    EXPECT_TRUE(getWordIds({ 'r', 'e' }).empty());
+    EXPECT_TRUE(getWordIds({ 'a', 'b' }).empty());
+}
+
+TEST_F(Ver2FoldedWordIndexTest, TestCantTellQueriesWithOmissions) {
+    const std::vector<std::vector<int>> queries = {
+            {}, { 'c', 'a', 'n', '\'', 't' }, { 'e', '-', 'm', 'a', 'i', 'l' }, { 'r', 'e', '-' },
+            { 'a', -2 } };
+    for (const std::vector<int> &query : queries) {
+        const int *wordIds = nullptr;
+        int wordIdCount = 0;
+        EXPECT_FALSE(mFoldedWordIndex.getWordIds(CodePointArrayView(query), &wordIds,
+                &wordIdCount));
+    }
+}
+
+}  // namespace
+}  // namespace latinime
@@ -27,7 +27,8 @@ namespace latinime {
 namespace {
 
 TEST(LanguageModelDictContentTest, TestUnigramProbability) {
-    LanguageModelDictContent languageModelDictContent(false /* useHistoricalInfo */);
+    LanguageModelDictContent languageModelDictContent(false /* useHistoricalInfo */,
+            false /* usesNgramContextMap */, false /* usesTrieMapValueLinks */);
 
     const int flag = 0xF0;
     const int probability = 10;
@@ -48,7 +49,8 @@ TEST(LanguageModelDictContentTest, TestUnigramProbability) {
 }
 
 TEST(LanguageModelDictContentTest, TestUnigramProbabilityWithHistoricalInfo) {
-    LanguageModelDictContent languageModelDictContent(true /* useHistoricalInfo */);
+    LanguageModelDictContent languageModelDictContent(true /* useHistoricalInfo */,
+            false /* usesNgramContextMap */, false /* usesTrieMapValueLinks */);
 
     const int flag = 0xF0;
     const int timestamp = 0x3FFFFFFF;
@@ -71,7 +73,8 @@ TEST(LanguageModelDictContentTest, TestUnigramProbabilityWithHistoricalInfo) {
 }
 
 TEST(LanguageModelDictContentTest, TestIterateProbabilityEntry) {
-    LanguageModelDictContent languageModelDictContent(false /* useHistoricalInfo */);
+    LanguageModelDictContent languageModelDictContent(false /* useHistoricalInfo */,
+            false /* usesNgramContextMap */, false /* usesTrieMapValueLinks */);
 
     const ProbabilityEntry originalEntry(0xFC, 100);
 
@@ -89,7 +92,8 @@ TEST(LanguageModelDictContentTest, TestIterateProbabilityEntry) {
 }
 
 TEST(LanguageModelDictContentTest, TestGetWordProbability) {
-    LanguageModelDictContent languageModelDictContent(false /* useHistoricalInfo */);
+    LanguageModelDictContent languageModelDictContent(false /* useHistoricalInfo */,
+            false /* usesNgramContextMap */, false /* usesTrieMapValueLinks */);
 
     const int flag = 0xFF;
     const int probability = 10;
@@ -116,5 +120,57 @@ TEST(LanguageModelDictContentTest, TestGetWordProbability) {
             false /* mustMatchAllPrevWords */, nullptr /* headerPolicy */).getProbability());
 }
 
+TEST(LanguageModelDictContentTest, TestNgramContextMap) {
+    LanguageModelDictContent languageModelDictContent(false /* useHistoricalInfo */,
+            true /* usesNgramContextMap */, false /* usesTrieMapValueLinks */);
+
+    const int flag = 0xFF;
+    const int probability = 10;
+    const int bigramProbability = 20;
+    const int trigramProbability = 30;
+    const int wordId = 100;
+    const std::array<int, 2> prevWordIdArray = {{ 1, 2 }};
+    const WordIdArrayView prevWordIds = WordIdArrayView::fromArray(prevWordIdArray);
+
+    const ProbabilityEntry probabilityEntry(flag, probability);
+    languageModelDictContent.setProbabilityEntry(wordId, &probabilityEntry);
+    languageModelDictContent.setProbabilityEntry(prevWordIds[0], &probabilityEntry);
+    const ProbabilityEntry bigramProbabilityEntry(flag, bigramProbability);
+    languageModelDictContent.setNgramProbabilityEntry(prevWordIds.limit(1), wordId,
+            &bigramProbabilityEntry);
+    const ProbabilityEntry trigramProbabilityEntry(flag, trigramProbability);
+    languageModelDictContent.setNgramProbabilityEntry(prevWordIds.limit(1),
+            prevWordIds[1], &probabilityEntry);
+    languageModelDictContent.setNgramProbabilityEntry(prevWordIds.limit(2), wordId,
+            &trigramProbabilityEntry);
+    EXPECT_EQ(trigramProbability, languageModelDictContent.getNgramProbabilityEntry(
+            prevWordIds, wordId).getProbability());
+    EXPECT_EQ(trigramProbability, languageModelDictContent.getWordAttributes(prevWordIds, wordId,
+            false /* mustMatchAllPrevWords */, nullptr /* headerPolicy */).getProbability());
+
+    // Removing the bigram context removes the trigram too.
+    EXPECT_TRUE(languageModelDictContent.removeNgramProbabilityEntry(prevWordIds.limit(1),
+            prevWordIds[1]));
+    EXPECT_FALSE(languageModelDictContent.getNgramProbabilityEntry(prevWordIds,
+            wordId).isValid());
+    EXPECT_EQ(bigramProbability, languageModelDictContent.getWordAttributes(prevWordIds, wordId,
+            false /* mustMatchAllPrevWords */, nullptr /* headerPolicy */).getProbability());
+    EXPECT_TRUE(languageModelDictContent.removeProbabilityEntry(prevWordIds[0]));
+    EXPECT_FALSE(languageModelDictContent.getNgramProbabilityEntry(prevWordIds.limit(1),
+            wordId).isValid());
+    EXPECT_EQ(probability, languageModelDictContent.getWordAttributes(prevWordIds, wordId,
+            false /* mustMatchAllPrevWords */, nullptr /* headerPolicy */).getProbability());
+
+    // The freed tables are reused for new contexts.
+    const int otherPrevWordId = 3;
+    languageModelDictContent.setProbabilityEntry(otherPrevWordId, &probabilityEntry);
+    languageModelDictContent.setNgramProbabilityEntry(WordIdArrayView(&otherPrevWordId, 1),
+            wordId, &bigramProbabilityEntry);
+    EXPECT_EQ(bigramProbability, languageModelDictContent.getNgramProbabilityEntry(
+            WordIdArrayView(&otherPrevWordId, 1), wordId).getProbability());
+    EXPECT_FALSE(languageModelDictContent.getNgramProbabilityEntry(prevWordIds.limit(1),
+            wordId).isValid());
+}
+
 }  // namespace
 }  // namespace latinime
@@ -18,10 +18,12 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
 #include <vector>
 
 #include "defines.h"
 #include "dictionary/structure/v4/ver4_dict_constants.h"
+#include "utils/byte_array_view.h"
 
 namespace latinime {
 namespace {
@@ -72,5 +74,33 @@ TEST(TerminalPositionLookupTableTest, TestGC) {
     }
 }
 
+TEST(TerminalPositionLookupTableTest, TestReadFromBuffer) {
+    // Positions 0x10203 and 0x40506, and a removed terminal.
+    std::vector<uint8_t> buffer = { 0x01, 0x02, 0x03, 0x00, 0x00, 0x00, 0x04, 0x05, 0x06 };
+    TerminalPositionLookupTable lookupTable(
+            ReadWriteByteArrayView(buffer.data(), buffer.size()));
+
+    EXPECT_EQ(3, lookupTable.getNextTerminalId());
+    EXPECT_EQ(0x10203, lookupTable.getTerminalPtNodePosition(0));
+    EXPECT_EQ(NOT_A_DICT_POS, lookupTable.getTerminalPtNodePosition(1));
+    EXPECT_EQ(0x40506, lookupTable.getTerminalPtNodePosition(2));
+    EXPECT_EQ(NOT_A_DICT_POS, lookupTable.getTerminalPtNodePosition(3));
+
+    EXPECT_TRUE(lookupTable.setTerminalPtNodePosition(1, 0x70809));
+    EXPECT_TRUE(lookupTable.setTerminalPtNodePosition(0, NOT_A_DICT_POS));
+    EXPECT_TRUE(lookupTable.setTerminalPtNodePosition(4, 0x100));
+    EXPECT_EQ(5, lookupTable.getNextTerminalId());
+    TerminalPositionLookupTable::TerminalIdMap terminalIdMap;
+    EXPECT_TRUE(lookupTable.runGCTerminalIds(&terminalIdMap));
+    EXPECT_EQ(3, lookupTable.getNextTerminalId());
+    EXPECT_EQ(0x70809, lookupTable.getTerminalPtNodePosition(terminalIdMap[1]));
+    EXPECT_EQ(0x40506, lookupTable.getTerminalPtNodePosition(terminalIdMap[2]));
+    EXPECT_EQ(0x100, lookupTable.getTerminalPtNodePosition(terminalIdMap[4]));
+    EXPECT_EQ(0u, terminalIdMap.count(0));
+    // The buffer is updated in place.
+    EXPECT_EQ(std::vector<uint8_t>({ 0x07, 0x08, 0x09, 0x04, 0x05, 0x06 }),
+            std::vector<uint8_t>(buffer.begin(), buffer.begin() + 6));
+}
+
 }  // namespace
 }  // namespace latinime
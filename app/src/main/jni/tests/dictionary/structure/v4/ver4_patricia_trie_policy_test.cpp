@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v4/ver4_patricia_trie_policy.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "dictionary/property/unigram_property.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+const Ver4PatriciaTriePolicy *asVer4Policy(
+        const DictionaryStructureWithBufferPolicy::StructurePolicyPtr &policy) {
+    return static_cast<const Ver4PatriciaTriePolicy *>(policy.get());
+}
+
+void removeWord(DictionaryStructureWithBufferPolicy *const policy, const std::vector<int> &word) {
+    ASSERT_TRUE(policy->removeUnigramEntry(CodePointArrayView(word)));
+}
+
+// "aaa", "aab", ... in the order of the index.
+std::vector<int> getThreeLetterWord(const int index) {
+    return { 'a' + (index / (26 * 26)) % 26, 'a' + (index / 26) % 26, 'a' + index % 26 };
+}
+
+struct WordAndProbability {
+    const char *mWord;
+    int mProbability;
+};
+
+void addWordsOneByOne(DictionaryStructureWithBufferPolicy *const policy,
+        const std::vector<WordAndProbability> &words) {
+    for (const WordAndProbability &word : words) {
+        DictionaryTestUtils::addUnigram(policy, DictionaryTestUtils::toCodePoints(word.mWord),
+                word.mProbability);
+    }
+}
+
+void addWordsAtOnce(DictionaryStructureWithBufferPolicy *const policy,
+        const std::vector<WordAndProbability> &words) {
+    std::vector<std::vector<int>> codePoints;
+    std::vector<UnigramProperty> unigramProperties;
+    for (const WordAndProbability &word : words) {
+        codePoints.push_back(DictionaryTestUtils::toCodePoints(word.mWord));
+        unigramProperties.push_back(
+                DictionaryTestUtils::createUnigramProperty(word.mProbability));
+    }
+    std::vector<CodePointArrayView> codePointArrayViews;
+    for (const std::vector<int> &wordCodePoints : codePoints) {
+        codePointArrayViews.emplace_back(wordCodePoints);
+    }
+    ASSERT_TRUE(policy->addUnigramEntries(codePointArrayViews, unigramProperties));
+}
+
+int getProbability(const DictionaryStructureWithBufferPolicy *const policy,
+        const char *const word) {
+    const int wordId = policy->getWordId(
+            CodePointArrayView(DictionaryTestUtils::toCodePoints(word)),
+            false /* forceLowerCaseSearch */);
+    if (wordId == NOT_A_WORD_ID) {
+        return NOT_A_PROBABILITY;
+    }
+    return policy->getProbabilityOfWord(WordIdArrayView(), wordId);
+}
+
+int getUnigramCount(DictionaryStructureWithBufferPolicy *const policy) {
+    static const char *const QUERY = "UNIGRAM_COUNT";
+    char result[16];
+    policy->getProperty(QUERY, strlen(QUERY), result, sizeof(result));
+    return atoi(result);
+}
+
+// The probabilities of all the words in the trie, found by iterating it.
+std::map<std::vector<int>, int> getAllWords(DictionaryStructureWithBufferPolicy *const policy) {
+    std::map<std::vector<int>, int> words;
+    int codePoints[MAX_WORD_LENGTH];
+    int token = 0;
+    do {
+        int codePointCount = 0;
+        int wordId = NOT_A_WORD_ID;
+        token = policy->getNextWordAndNextToken(token, codePoints, &codePointCount, &wordId);
+        if (codePointCount > 0) {
+            words[std::vector<int>(codePoints, codePoints + codePointCount)] =
+                    policy->getProbabilityOfWord(WordIdArrayView(), wordId);
+        }
+    } while (token != 0);
+    return words;
+}
+
+// Checks that the words added at once make the same dictionary as the words added one by one.
+void expectSameDictionaries(DictionaryStructureWithBufferPolicy *const bulkLoadedPolicy,
+        DictionaryStructureWithBufferPolicy *const policy,
+        const std::vector<WordAndProbability> &words, const int expectedUnigramCount) {
+    for (const WordAndProbability &word : words) {
+        EXPECT_NE(NOT_A_WORD_ID, bulkLoadedPolicy->getWordId(
+                CodePointArrayView(DictionaryTestUtils::toCodePoints(word.mWord)),
+                false /* forceLowerCaseSearch */))
+                << word.mWord;
+        EXPECT_EQ(getProbability(policy, word.mWord),
+                getProbability(bulkLoadedPolicy, word.mWord)) << word.mWord;
+    }
+    EXPECT_EQ(expectedUnigramCount, getUnigramCount(policy));
+    EXPECT_EQ(expectedUnigramCount, getUnigramCount(bulkLoadedPolicy));
+    const std::map<std::vector<int>, int> allWords = getAllWords(policy);
+    EXPECT_EQ(static_cast<size_t>(expectedUnigramCount), allWords.size());
+    EXPECT_EQ(allWords, getAllWords(bulkLoadedPolicy));
+}
+
+// Shared prefixes, words that are prefixes of others and prefixes that aren't words.
+const std::vector<WordAndProbability> SORTED_WORDS = { { "a", 200 }, { "ab", 120 },
+        { "abc", 110 }, { "abd", 100 }, { "abde", 90 }, { "b", 180 }, { "t", 60 },
+        { "tea", 150 }, { "team", 140 }, { "test", 130 }, { "tester", 70 }, { "testing", 80 } };
+
+float getFragmentationProperty(DictionaryStructureWithBufferPolicy *const policy) {
+    static const char *const QUERY = "TRIE_FRAGMENTATION";
+    char result[16];
+    policy->getProperty(QUERY, strlen(QUERY), result, sizeof(result));
+    return static_cast<float>(atof(result));
+}
+
+TEST(Ver4PatriciaTriePolicyTest, TestHasNoReclaimableTrieSizeWithoutRemovals) {
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    ASSERT_NE(nullptr, policy.get());
+    EXPECT_EQ(0, asVer4Policy(policy)->getReclaimableTrieSize());
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b' });
+    DictionaryTestUtils::addUnigram(policy.get(), { 't', 'o' });
+    EXPECT_EQ(0, asVer4Policy(policy)->getReclaimableTrieSize());
+    EXPECT_FLOAT_EQ(0.0f, getFragmentationProperty(policy.get()));
+}
+
+TEST(Ver4PatriciaTriePolicyTest, TestTracksMovedAndDeletedPtNodes) {
+    // The first policy traverses the trie before the updates and tracks them, the second one
+    // traverses the trie after them.
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr trackingPolicy =
+            DictionaryTestUtils::createPolicy();
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr scanningPolicy =
+            DictionaryTestUtils::createPolicy();
+    ASSERT_NE(nullptr, trackingPolicy.get());
+    ASSERT_NE(nullptr, scanningPolicy.get());
+    EXPECT_EQ(0, asVer4Policy(trackingPolicy)->getReclaimableTrieSize());
+    for (DictionaryStructureWithBufferPolicy *const policy :
+            { trackingPolicy.get(), scanningPolicy.get() }) {
+        DictionaryTestUtils::addUnigram(policy, { 'a', 'b', 'c' });
+        // Splits the "abc" PtNode, which is moved.
+        DictionaryTestUtils::addUnigram(policy, { 'a', 'b' });
+        removeWord(policy, { 'a', 'b', 'c' });
+    }
+    const int reclaimableTrieSize = asVer4Policy(trackingPolicy)->getReclaimableTrieSize();
+    EXPECT_GT(reclaimableTrieSize, 0);
+    EXPECT_EQ(reclaimableTrieSize, asVer4Policy(scanningPolicy)->getReclaimableTrieSize());
+    EXPECT_GT(getFragmentationProperty(trackingPolicy.get()), 0.0f);
+
+    // A restored word is no longer garbage.
+    DictionaryTestUtils::addUnigram(trackingPolicy.get(), { 'a', 'b', 'c' });
+    EXPECT_LT(asVer4Policy(trackingPolicy)->getReclaimableTrieSize(), reclaimableTrieSize);
+    DictionaryTestUtils::addUnigram(scanningPolicy.get(), { 'a', 'b', 'c' });
+    EXPECT_EQ(asVer4Policy(scanningPolicy)->getReclaimableTrieSize(),
+            asVer4Policy(trackingPolicy)->getReclaimableTrieSize());
+}
+
+TEST(Ver4PatriciaTriePolicyTest, TestPrefetchesOnlyPositionsInTheTrie) {
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    ASSERT_NE(nullptr, policy.get());
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b' });
+    // None of them may fault.
+    policy->prefetchPtNodeArray(policy->getRootPosition());
+    policy->prefetchPtNodeArray(NOT_A_DICT_POS);
+    policy->prefetchPtNodeArray(1 << 30);
+    EXPECT_NE(NOT_A_WORD_ID, policy->getWordId(CodePointArrayView(std::vector<int>({ 'a', 'b' })),
+            false /* forceLowerCaseSearch */));
+}
+
+TEST(Ver4PatriciaTriePolicyTest, TestNeedsToRunGCForFragmentedTrie) {
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    ASSERT_NE(nullptr, policy.get());
+    static const int WORD_COUNT = 10000;
+    for (int i = 0; i < WORD_COUNT; ++i) {
+        DictionaryTestUtils::addUnigram(policy.get(), getThreeLetterWord(i));
+    }
+    EXPECT_FALSE(policy->needsToRunGC(false /* mindsBlockByGC */));
+    for (int i = 0; i < WORD_COUNT; ++i) {
+        removeWord(policy.get(), getThreeLetterWord(i));
+    }
+    EXPECT_GT(asVer4Policy(policy)->getTrieFragmentationRatio(), 0.5f);
+    EXPECT_TRUE(policy->needsToRunGC(false /* mindsBlockByGC */));
+    // Rewriting the dictionary isn't worth blocking updates.
+    EXPECT_FALSE(policy->needsToRunGC(true /* mindsBlockByGC */));
+}
+
+TEST(Ver4PatriciaTriePolicyTest, TestAddsSortedWordsAtOnce) {
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr bulkLoadedPolicy =
+            DictionaryTestUtils::createPolicy();
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    addWordsAtOnce(bulkLoadedPolicy.get(), SORTED_WORDS);
+    addWordsOneByOne(policy.get(), SORTED_WORDS);
+    expectSameDictionaries(bulkLoadedPolicy.get(), policy.get(), SORTED_WORDS,
+            static_cast<int>(SORTED_WORDS.size()));
+    for (const char *const prefix : { "te", "tes", "abcd", "c" }) {
+        EXPECT_EQ(NOT_A_PROBABILITY, getProbability(bulkLoadedPolicy.get(), prefix)) << prefix;
+    }
+}
+
+TEST(Ver4PatriciaTriePolicyTest, TestAddsUnsortedWordsAtOnce) {
+    // The later one of the duplicates wins.
+    const std::vector<WordAndProbability> words = { { "testing", 80 }, { "abd", 100 },
+            { "tea", 50 }, { "b", 180 }, { "abde", 90 }, { "a", 200 }, { "test", 130 },
+            { "ab", 120 }, { "team", 140 }, { "tea", 150 }, { "t", 60 }, { "abc", 110 },
+            { "tester", 70 } };
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr bulkLoadedPolicy =
+            DictionaryTestUtils::createPolicy();
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    addWordsAtOnce(bulkLoadedPolicy.get(), words);
+    addWordsOneByOne(policy.get(), words);
+    expectSameDictionaries(bulkLoadedPolicy.get(), policy.get(), words,
+            static_cast<int>(words.size()) - 1);
+    // The order of the batch doesn't matter.
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr sortedPolicy =
+            DictionaryTestUtils::createPolicy();
+    addWordsAtOnce(sortedPolicy.get(), SORTED_WORDS);
+    EXPECT_EQ(getAllWords(sortedPolicy.get()), getAllWords(bulkLoadedPolicy.get()));
+}
+
+TEST(Ver4PatriciaTriePolicyTest, TestAddsWordsAtOnceToNonEmptyDictionary) {
+    const std::vector<WordAndProbability> existingWords = { { "test", 40 }, { "to", 90 } };
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr bulkLoadedPolicy =
+            DictionaryTestUtils::createPolicy();
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    addWordsOneByOne(bulkLoadedPolicy.get(), existingWords);
+    addWordsOneByOne(policy.get(), existingWords);
+    // "test" already exists and gets the new probability.
+    addWordsAtOnce(bulkLoadedPolicy.get(), SORTED_WORDS);
+    addWordsOneByOne(policy.get(), SORTED_WORDS);
+    expectSameDictionaries(bulkLoadedPolicy.get(), policy.get(), SORTED_WORDS,
+            static_cast<int>(SORTED_WORDS.size()) + 1);
+    EXPECT_EQ(getProbability(policy.get(), "to"), getProbability(bulkLoadedPolicy.get(), "to"));
+}
+
+}  // namespace
+}  // namespace latinime
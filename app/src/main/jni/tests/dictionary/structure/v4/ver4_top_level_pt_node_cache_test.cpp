@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v4/ver4_top_level_pt_node_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_node_utils.h"
+#include "suggest/core/dicnode/dic_node_vector.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// Returns the first code points of the children, upper case for the terminal ones.
+std::vector<int> getChildren(const DictionaryStructureWithBufferPolicy *const policy,
+        const DicNode *const dicNode, std::vector<DicNode> *const outChildDicNodes) {
+    DicNodeVector childDicNodes;
+    DicNodeUtils::getAllChildDicNodes(dicNode, policy, &childDicNodes);
+    std::vector<int> children;
+    for (int i = 0; i < childDicNodes.getSizeAndLock(); ++i) {
+        const DicNode *const childDicNode = childDicNodes[i];
+        const int codePoint = childDicNode->getNodeCodePoint();
+        children.push_back(childDicNode->isTerminalDicNode() ? codePoint - 'a' + 'A' : codePoint);
+        if (outChildDicNodes) {
+            outChildDicNodes->push_back(*childDicNode);
+        }
+    }
+    return children;
+}
+
+TEST(Ver4TopLevelPtNodeCacheTest, TestExpandsTopLevels) {
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    ASSERT_NE(nullptr, policy.get());
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a' });
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b' });
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b', 'c', 'd' });
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a', 'b', 'c', 'd', 'e' });
+
+    DicNode rootDicNode;
+    DicNodeUtils::initAsRoot(policy.get(), WordIdArrayView(), &rootDicNode);
+    std::vector<DicNode> dicNodes;
+    EXPECT_EQ(std::vector<int>({ 'A' }), getChildren(policy.get(), &rootDicNode, &dicNodes));
+    const DicNode aDicNode = dicNodes.back();
+    EXPECT_EQ(std::vector<int>({ 'B' }), getChildren(policy.get(), &aDicNode, &dicNodes));
+    const DicNode bDicNode = dicNodes.back();
+    EXPECT_EQ(std::vector<int>({ 'c' }), getChildren(policy.get(), &bDicNode, &dicNodes));
+    // "cd" is expanded from the buffer below the cached levels.
+    DicNode cdDicNode = dicNodes.back();
+    while (!cdDicNode.isLeavingNode()) {
+        DicNodeVector passingDicNodes;
+        DicNodeUtils::getAllChildDicNodes(&cdDicNode, policy.get(), &passingDicNodes);
+        ASSERT_EQ(1, passingDicNodes.getSizeAndLock());
+        cdDicNode = *passingDicNodes[0];
+    }
+    EXPECT_EQ(std::vector<int>({ 'E' }), getChildren(policy.get(), &cdDicNode, nullptr));
+}
+
+TEST(Ver4TopLevelPtNodeCacheTest, TestInvalidatesOnWrites) {
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    ASSERT_NE(nullptr, policy.get());
+    DictionaryTestUtils::addUnigram(policy.get(), { 'a' });
+    DictionaryTestUtils::addUnigram(policy.get(), { 't', 'o' });
+
+    DicNode rootDicNode;
+    DicNodeUtils::initAsRoot(policy.get(), WordIdArrayView(), &rootDicNode);
+    EXPECT_EQ(std::vector<int>({ 'A', 't' }), getChildren(policy.get(), &rootDicNode, nullptr));
+    DictionaryTestUtils::addUnigram(policy.get(), { 'b' });
+    EXPECT_EQ(std::vector<int>({ 'A', 't', 'B' }),
+            getChildren(policy.get(), &rootDicNode, nullptr));
+    ASSERT_TRUE(policy->removeUnigramEntry(CodePointArrayView(std::vector<int>({ 'a' }))));
+    EXPECT_EQ(std::vector<int>({ 'a', 't', 'B' }),
+            getChildren(policy.get(), &rootDicNode, nullptr));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -76,5 +76,32 @@ TEST(BloomFilterTest, TestFilter) {
     }
 }
 
+TEST(BloomFilterTest, TestFalsePositiveRateOfSizedFilter) {
+    static const int ELEMENT_COUNT = 5000;
+    static const int TEST_COUNT = 100000;
+
+    BloomFilter bloomFilter;
+    bloomFilter.reset(ELEMENT_COUNT);
+    // Consecutive ids, as word ids are.
+    for (int i = 0; i < ELEMENT_COUNT; ++i) {
+        bloomFilter.setInFilter(i * 2);
+    }
+    for (int i = 0; i < ELEMENT_COUNT; ++i) {
+        ASSERT_TRUE(bloomFilter.isInFilter(i * 2));
+    }
+    int falsePositiveCount = 0;
+    for (int i = 0; i < TEST_COUNT; ++i) {
+        if (bloomFilter.isInFilter(i * 2 + 1)) {
+            ++falsePositiveCount;
+        }
+    }
+    EXPECT_LT(falsePositiveCount, TEST_COUNT * 3 / 100);
+
+    bloomFilter.reset(ELEMENT_COUNT);
+    for (int i = 0; i < ELEMENT_COUNT; ++i) {
+        EXPECT_FALSE(bloomFilter.isInFilter(i * 2));
+    }
+}
+
 }  // namespace
 }  // namespace latinime
@@ -47,6 +47,26 @@ TEST(BufferWithExtendablebufferTest, TestWriteAndRead) {
     EXPECT_EQ(data_4, buffer.readUint(4, pos));
 }
 
+TEST(BufferWithExtendablebufferTest, TestContiguousView) {
+    uint8_t originalBuffer[] = { 0x01, 0x02, 0x03, 0x04 };
+    BufferWithExtendableBuffer buffer(ReadWriteByteArrayView(originalBuffer, 4),
+            DEFAULT_MAX_BUFFER_SIZE);
+    EXPECT_EQ(originalBuffer, buffer.getContiguousView().data());
+    EXPECT_EQ(4u, buffer.getContiguousView().size());
+    EXPECT_EQ(0x01020304u, buffer.readUint(4, 0 /* pos */));
+    // The written region spans both buffers.
+    EXPECT_TRUE(buffer.writeUint(0x0506, 2 /* size */, 4 /* pos */));
+    EXPECT_EQ(nullptr, buffer.getContiguousView().data());
+    EXPECT_EQ(0x0506u, buffer.readUint(2, 4 /* pos */));
+
+    BufferWithExtendableBuffer additionalOnlyBuffer(DEFAULT_MAX_BUFFER_SIZE);
+    EXPECT_TRUE(additionalOnlyBuffer.writeUint(0x0A0B0C, 3 /* size */, 0 /* pos */));
+    EXPECT_NE(nullptr, additionalOnlyBuffer.getContiguousView().data());
+    EXPECT_EQ(3u, additionalOnlyBuffer.getContiguousView().size());
+    EXPECT_EQ(0x0A0B0Cu, ByteArrayUtils::readUint24(
+            additionalOnlyBuffer.getContiguousView().data(), 0 /* pos */));
+}
+
 TEST(BufferWithExtendablebufferTest, TestExtend) {
     BufferWithExtendableBuffer buffer(DEFAULT_MAX_BUFFER_SIZE);
     EXPECT_EQ(0, buffer.getTailPosition());
@@ -58,6 +78,20 @@ TEST(BufferWithExtendablebufferTest, TestExtend) {
     EXPECT_TRUE(buffer.writeUint(0xFF /* data */, 4 /* size */, 0 /* pos */));
 }
 
+TEST(BufferWithExtendablebufferTest, TestExtendBeyondExtendingStep) {
+    const int maxBufferSize = 1024 * 1024;
+    BufferWithExtendableBuffer buffer(maxBufferSize);
+    int pos = 0;
+    while (pos < maxBufferSize) {
+        const uint32_t data = pos;
+        EXPECT_TRUE(buffer.writeUintAndAdvancePosition(data, 4 /* size */, &pos));
+    }
+    EXPECT_EQ(maxBufferSize, buffer.getTailPosition());
+    for (int readingPos = 0; readingPos < maxBufferSize; readingPos += 4 * 1024) {
+        EXPECT_EQ(static_cast<uint32_t>(readingPos), buffer.readUint(4 /* size */, readingPos));
+    }
+}
+
 TEST(BufferWithExtendablebufferTest, TestCopy) {
     BufferWithExtendableBuffer buffer(DEFAULT_MAX_BUFFER_SIZE);
     EXPECT_TRUE(buffer.writeUint(0xFF /* data */, 4 /* size */, 0 /* pos */));
@@ -75,7 +109,9 @@ TEST(BufferWithExtendablebufferTest, TestSizeLimit) {
 
     BufferWithExtendableBuffer smallBuffer(4 /* maxAdditionalBufferSize */);
     EXPECT_TRUE(smallBuffer.writeUint(0 /* data */, 4 /* size */, 0 /* pos */));
-    EXPECT_FALSE(smallBuffer.writeUint(0 /* data */, 1 /* size */, 4 /* pos */));
+    // Writing beyond the soft limit succeeds up to the hard limit.
+    EXPECT_TRUE(smallBuffer.writeUint(0 /* data */, 4 /* size */, 4 /* pos */));
+    EXPECT_FALSE(smallBuffer.writeUint(0 /* data */, 1 /* size */, 8 /* pos */));
 
     EXPECT_TRUE(smallBuffer.copy(&emptyBuffer));
     EXPECT_FALSE(emptyBuffer.copy(&smallBuffer));
@@ -88,6 +124,29 @@ TEST(BufferWithExtendablebufferTest, TestSizeLimit) {
     }
     EXPECT_GT(pos, 0);
     EXPECT_LE(pos, DEFAULT_MAX_BUFFER_SIZE);
+    EXPECT_FALSE(buffer.isNearHardSizeLimit());
+}
+
+TEST(BufferWithExtendablebufferTest, TestSoftSizeLimit) {
+    const int maxBufferSize = 64 * 1024;
+    BufferWithExtendableBuffer buffer(maxBufferSize);
+    EXPECT_TRUE(buffer.writeUint(0x01020304 /* data */, 4 /* size */, 0 /* pos */));
+    const uint8_t *const additionalBuffer = buffer.getBuffer(true /* usesAdditionalBuffer */);
+    int pos = 4;
+    while (pos < maxBufferSize) {
+        EXPECT_TRUE(buffer.writeUintAndAdvancePosition(pos /* data */, 4 /* size */, &pos));
+    }
+    EXPECT_TRUE(buffer.isNearSizeLimit());
+    EXPECT_FALSE(buffer.isNearHardSizeLimit());
+    while (!buffer.isNearHardSizeLimit()) {
+        EXPECT_TRUE(buffer.writeUintAndAdvancePosition(pos /* data */, 4 /* size */, &pos));
+    }
+    EXPECT_LE(pos, maxBufferSize * 2);
+    // Extending the buffer doesn't move the written data.
+    EXPECT_EQ(additionalBuffer, buffer.getBuffer(true /* usesAdditionalBuffer */));
+    EXPECT_EQ(0x01020304u, ByteArrayUtils::readUint32(additionalBuffer, 0 /* pos */));
+    EXPECT_EQ(static_cast<uint32_t>(maxBufferSize),
+            buffer.readUint(4 /* size */, maxBufferSize /* pos */));
 }
 
 }  // namespace
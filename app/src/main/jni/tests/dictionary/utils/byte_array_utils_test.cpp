@@ -18,7 +18,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 namespace latinime {
 namespace {
@@ -79,9 +83,9 @@ TEST(ByteArrayUtilsTest, TestReadCodePoint) {
     EXPECT_EQ(NOT_A_CODE_POINT, ByteArrayUtils::readCodePoint(buffer, 5));
 
     int pos = 0;
-    int codePointArray[3];
-    EXPECT_EQ(3, ByteArrayUtils::readStringAndAdvancePosition(buffer, MAX_WORD_LENGTH, nullptr,
-            codePointArray, &pos));
+    int codePointArray[MAX_WORD_LENGTH];
+    EXPECT_EQ(3, ByteArrayUtils::readStringAndAdvancePosition(buffer, sizeof(buffer),
+            MAX_WORD_LENGTH, nullptr, codePointArray, &pos));
     EXPECT_EQ(0x10FF00, codePointArray[0]);
     EXPECT_EQ(0x20, codePointArray[1]);
     EXPECT_EQ(0x41, codePointArray[2]);
@@ -101,5 +105,88 @@ TEST(ByteArrayUtilsTest, TestWriteAndReadCodePoint) {
     EXPECT_EQ(NOT_A_CODE_POINT, ByteArrayUtils::readCodePoint(buffer, 5));
 }
 
+TEST(ByteArrayUtilsTest, TestReadLongString) {
+    std::vector<int> codePoints;
+    for (int i = 0; i < 40; ++i) {
+        codePoints.push_back(0x61 + i % 26);
+    }
+    // 3 byte code points in the middle of a run and around the scanned chunks.
+    codePoints[5] = 0x3042;
+    codePoints[16] = 0x10;
+    codePoints[17] = 0x100;
+    // 1 byte code points with the high bit set.
+    codePoints[20] = 0xE9;
+    codePoints[33] = 0xFF;
+    // Different offsets cover the boundaries of the scanned chunks. The string ends the buffer,
+    // which is allocated to its size so that reading past it is reported by the sanitizers.
+    for (int offset = 0; offset < 64; ++offset) {
+        std::vector<uint8_t> writtenBuffer(offset + codePoints.size() * 3 + 1);
+        int pos = offset;
+        ByteArrayUtils::writeCodePointsAndAdvancePosition(writtenBuffer.data(), codePoints.data(),
+                codePoints.size(), true /* writesTerminator */, &pos);
+        const int endPos = pos;
+        const std::unique_ptr<uint8_t[]> buffer(new uint8_t[endPos]);
+        memcpy(buffer.get(), writtenBuffer.data(), endPos);
+
+        int outCodePoints[MAX_WORD_LENGTH];
+        pos = offset;
+        EXPECT_EQ(static_cast<int>(codePoints.size()),
+                ByteArrayUtils::readStringAndAdvancePosition(buffer.get(), endPos,
+                        MAX_WORD_LENGTH, nullptr /* codePointTable */, outCodePoints, &pos));
+        EXPECT_EQ(endPos, pos);
+        EXPECT_EQ(codePoints, std::vector<int>(outCodePoints,
+                outCodePoints + codePoints.size()));
+
+        pos = offset;
+        EXPECT_EQ(static_cast<int>(codePoints.size()),
+                ByteArrayUtils::advancePositionToBehindString(buffer.get(), endPos,
+                        MAX_WORD_LENGTH, &pos));
+        EXPECT_EQ(endPos, pos);
+    }
+}
+
+TEST(ByteArrayUtilsTest, TestReadStringWithMaxLength) {
+    uint8_t buffer[64];
+    memset(buffer, 0x61, sizeof(buffer));
+    buffer[40] = 0x1F;
+    int codePoints[64];
+    for (int maxLength = 0; maxLength < 45; ++maxLength) {
+        const int expectedLength = std::min(maxLength, 40);
+        // The code point after the last read one is skipped as well.
+        const int expectedPos = expectedLength + 1;
+        int pos = 0;
+        EXPECT_EQ(expectedLength, ByteArrayUtils::readStringAndAdvancePosition(buffer,
+                sizeof(buffer), maxLength, nullptr /* codePointTable */, codePoints, &pos));
+        EXPECT_EQ(expectedPos, pos);
+        pos = 0;
+        EXPECT_EQ(expectedLength,
+                ByteArrayUtils::advancePositionToBehindString(buffer, sizeof(buffer), maxLength,
+                        &pos));
+        EXPECT_EQ(expectedPos, pos);
+    }
+}
+
+TEST(ByteArrayUtilsTest, TestReadStringWithCodePointTable) {
+    int codePointTable[256 - 0x20];
+    for (int i = 0; i < 256 - 0x20; ++i) {
+        codePointTable[i] = 0x1000 + i;
+    }
+    uint8_t buffer[24];
+    memset(buffer, 0x21, sizeof(buffer));
+    buffer[18] = 0x00;
+    buffer[19] = 0x01;
+    buffer[20] = 0x00;
+    buffer[21] = 0x1F;
+    int codePoints[MAX_WORD_LENGTH];
+    int pos = 0;
+    EXPECT_EQ(19, ByteArrayUtils::readStringAndAdvancePosition(buffer, sizeof(buffer),
+            MAX_WORD_LENGTH, codePointTable, codePoints, &pos));
+    EXPECT_EQ(22, pos);
+    for (int i = 0; i < 18; ++i) {
+        EXPECT_EQ(0x1001, codePoints[i]);
+    }
+    EXPECT_EQ(0x100, codePoints[18]);
+}
+
 }  // namespace
 }  // namespace latinime
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "dictionary/utils/dict_migration_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/property/ngram_property.h"
+#include "dictionary/property/unigram_property.h"
+#include "dictionary/property/word_property.h"
+#include "dictionary/utils/format_utils.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+using StructurePolicyPtr = DictionaryStructureWithBufferPolicy::StructurePolicyPtr;
+
+void addWord(DictionaryStructureWithBufferPolicy *const policy,
+        const std::vector<int> &codePoints, const int probability,
+        std::vector<UnigramProperty::ShortcutProperty> &&shortcuts) {
+    const UnigramProperty unigramProperty(false /* representsBeginningOfSentence */,
+            false /* isNotAWord */, false /* isPossiblyOffensive */, probability,
+            HistoricalInfo(), std::move(shortcuts));
+    ASSERT_TRUE(policy->addUnigramEntry(CodePointArrayView(codePoints), &unigramProperty));
+}
+
+void addBigram(DictionaryStructureWithBufferPolicy *const policy,
+        const NgramContext &ngramContext, std::vector<int> &&codePoints, const int probability) {
+    const NgramProperty ngramProperty(ngramContext, std::move(codePoints), probability,
+            HistoricalInfo());
+    ASSERT_TRUE(policy->addNgramEntry(&ngramProperty));
+}
+
+int getProbabilityInContext(const DictionaryStructureWithBufferPolicy *const policy,
+        const NgramContext &ngramContext, const std::vector<int> &codePoints) {
+    WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> prevWordIdArray;
+    const WordIdArrayView prevWordIds = ngramContext.getPrevWordIds(policy, &prevWordIdArray,
+            false /* tryLowerCaseSearch */);
+    const int wordId = policy->getWordId(CodePointArrayView(codePoints),
+            false /* forceLowerCaseSearch */);
+    return policy->getWordAttributesInContext(prevWordIds, wordId,
+            nullptr /* multiBigramMap */).getProbability();
+}
+
+TEST(DictMigrationUtilsTest, TestCanMigrate) {
+    const StructurePolicyPtr ver402Policy =
+            DictionaryTestUtils::createPolicy(FormatUtils::VERSION_402);
+    const StructurePolicyPtr ver403Policy =
+            DictionaryTestUtils::createPolicy(FormatUtils::VERSION_403);
+    ASSERT_NE(nullptr, ver402Policy.get());
+    ASSERT_NE(nullptr, ver403Policy.get());
+    EXPECT_TRUE(DictMigrationUtils::canMigrate(ver402Policy.get(), FormatUtils::VERSION_403));
+    EXPECT_TRUE(DictMigrationUtils::canMigrate(ver402Policy.get(), FormatUtils::VERSION_404));
+    EXPECT_FALSE(DictMigrationUtils::canMigrate(ver402Policy.get(), FormatUtils::VERSION_402));
+    EXPECT_FALSE(DictMigrationUtils::canMigrate(ver403Policy.get(), FormatUtils::VERSION_403));
+}
+
+TEST(DictMigrationUtilsTest, TestMigrateVer402ToVer403) {
+    const StructurePolicyPtr sourcePolicy =
+            DictionaryTestUtils::createPolicy(FormatUtils::VERSION_402);
+    ASSERT_NE(nullptr, sourcePolicy.get());
+    const std::vector<int> the = { 't', 'h', 'e' };
+    const std::vector<int> them = { 't', 'h', 'e', 'm' };
+    const std::vector<int> cat = { 'c', 'a', 't' };
+    addWord(sourcePolicy.get(), the, 200, {});
+    addWord(sourcePolicy.get(), them, 120, {});
+    addWord(sourcePolicy.get(), cat, 100,
+            { UnigramProperty::ShortcutProperty({ 'c', 'a', 't', 's' }, 14 /* probability */) });
+    const NgramContext theContext(the.data(), the.size(), false /* isBeginningOfSentence */);
+    const NgramContext beginningOfSentenceContext(the.data(), 0,
+            true /* isBeginningOfSentence */);
+    addBigram(sourcePolicy.get(), theContext, std::vector<int>(cat), 150);
+    addBigram(sourcePolicy.get(), beginningOfSentenceContext, std::vector<int>(the), 180);
+
+    const StructurePolicyPtr migratedPolicy =
+            DictMigrationUtils::migrate(sourcePolicy.get(), FormatUtils::VERSION_403);
+    ASSERT_NE(nullptr, migratedPolicy.get());
+    EXPECT_EQ(FormatUtils::VERSION_403,
+            migratedPolicy->getHeaderStructurePolicy()->getFormatVersionNumber());
+    const NgramContext emptyContext;
+    for (const auto &word : { the, them, cat }) {
+        EXPECT_EQ(getProbabilityInContext(sourcePolicy.get(), emptyContext, word),
+                getProbabilityInContext(migratedPolicy.get(), emptyContext, word));
+    }
+    EXPECT_NE(getProbabilityInContext(migratedPolicy.get(), emptyContext, cat),
+            getProbabilityInContext(migratedPolicy.get(), theContext, cat));
+    EXPECT_EQ(getProbabilityInContext(sourcePolicy.get(), theContext, cat),
+            getProbabilityInContext(migratedPolicy.get(), theContext, cat));
+    EXPECT_EQ(getProbabilityInContext(sourcePolicy.get(), beginningOfSentenceContext, the),
+            getProbabilityInContext(migratedPolicy.get(), beginningOfSentenceContext, the));
+
+    const WordProperty wordProperty = migratedPolicy->getWordProperty(CodePointArrayView(cat));
+    const std::vector<UnigramProperty::ShortcutProperty> &shortcuts =
+            wordProperty.getUnigramProperty().getShortcuts();
+    ASSERT_EQ(1u, shortcuts.size());
+    EXPECT_EQ(std::vector<int>({ 'c', 'a', 't', 's' }), *shortcuts[0].getTargetCodePoints());
+    EXPECT_EQ(14, shortcuts[0].getProbability());
+}
+
+}  // namespace
+}  // namespace latinime
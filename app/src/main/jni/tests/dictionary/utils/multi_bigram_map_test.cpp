@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/utils/multi_bigram_map.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/header/header_policy.h"
+#include "dictionary/interface/ngram_listener.h"
+#include "dictionary/property/historical_info.h"
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/property/ngram_property.h"
+#include "dictionary/structure/pt_common/dynamic_pt_writing_utils.h"
+#include "dictionary/structure/v4/ver4_dict_buffers.h"
+#include "dictionary/structure/v4/ver4_dict_constants.h"
+#include "dictionary/structure/v4/ver4_patricia_trie_policy.h"
+#include "dictionary/utils/format_utils.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// An on-memory ver4 policy that counts the reads of n-gram entries, which MultiBigramMap only
+// does when a context is not cached. The ver4 policies don't combine the probabilities since
+// they don't use MultiBigramMap, so this one does it like the ver2 policy without backoff.
+class CountingPolicy : public Ver4PatriciaTriePolicy {
+ public:
+    static std::unique_ptr<CountingPolicy> create() {
+        const std::vector<int> locale = { 'e', 'n' };
+        const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+        const HeaderPolicy headerPolicy(FormatUtils::VERSION_403, locale, &attributeMap);
+        Ver4DictBuffers::Ver4DictBuffersPtr dictBuffers = Ver4DictBuffers::createVer4DictBuffers(
+                &headerPolicy, Ver4DictConstants::MAX_DICT_EXTENDED_REGION_SIZE);
+        if (!DynamicPtWritingUtils::writeEmptyDictionary(dictBuffers->getWritableTrieBuffer(),
+                0 /* rootPos */)) {
+            return nullptr;
+        }
+        return std::unique_ptr<CountingPolicy>(new CountingPolicy(std::move(dictBuffers)));
+    }
+
+    int getProbability(const int unigramProbability, const int bigramProbability) const override {
+        return bigramProbability != NOT_A_PROBABILITY ? bigramProbability : unigramProbability;
+    }
+
+    void iterateNgramEntries(const WordIdArrayView prevWordIds,
+            NgramListener *const listener) const override {
+        ++mNgramIterationCount;
+        Ver4PatriciaTriePolicy::iterateNgramEntries(prevWordIds, listener);
+    }
+
+    int getNgramIterationCount() const {
+        return mNgramIterationCount;
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(CountingPolicy);
+
+    explicit CountingPolicy(Ver4DictBuffers::Ver4DictBuffersPtr dictBuffers)
+            : Ver4PatriciaTriePolicy(std::move(dictBuffers)), mNgramIterationCount(0) {}
+
+    mutable int mNgramIterationCount;
+};
+
+const int CONTEXT_COUNT = static_cast<int>(MultiBigramMap::MAX_CACHED_PREV_WORDS_IN_BIGRAM_MAP);
+// More contexts than fit in the map.
+const int PREV_WORD_COUNT = CONTEXT_COUNT * 3;
+// The successors of every previous word. Another next word has no n-gram at all.
+const int SUCCESSOR_COUNT = 3;
+
+std::string getPrevWord(const int prevWordIndex) {
+    return "prev" + std::to_string(prevWordIndex);
+}
+
+std::string getNextWord(const int nextWordIndex) {
+    return "next" + std::to_string(nextWordIndex);
+}
+
+int getNgramProbability(const int prevWordIndex, const int nextWordIndex) {
+    return 50 + prevWordIndex + nextWordIndex * 10;
+}
+
+class MultiBigramMapTest : public ::testing::Test {
+ protected:
+    MultiBigramMapTest() : mPolicy(CountingPolicy::create()), mBigramMap() {}
+
+    void SetUp() override {
+        ASSERT_NE(nullptr, mPolicy);
+        for (int i = 0; i < PREV_WORD_COUNT; ++i) {
+            DictionaryTestUtils::addUnigram(mPolicy.get(),
+                    DictionaryTestUtils::toCodePoints(getPrevWord(i).c_str()));
+        }
+        for (int j = 0; j <= SUCCESSOR_COUNT; ++j) {
+            DictionaryTestUtils::addUnigram(mPolicy.get(),
+                    DictionaryTestUtils::toCodePoints(getNextWord(j).c_str()));
+        }
+        for (int i = 0; i < PREV_WORD_COUNT; ++i) {
+            const std::vector<int> prevWord =
+                    DictionaryTestUtils::toCodePoints(getPrevWord(i).c_str());
+            const NgramContext ngramContext(prevWord.data(), static_cast<int>(prevWord.size()),
+                    false /* isBeginningOfSentence */);
+            // In the reverse order of the word ids, so that the successors have to be sorted.
+            for (int j = SUCCESSOR_COUNT - 1; j >= 0; --j) {
+                const NgramProperty ngramProperty(ngramContext,
+                        DictionaryTestUtils::toCodePoints(getNextWord(j).c_str()),
+                        getNgramProbability(i, j), HistoricalInfo());
+                ASSERT_TRUE(mPolicy->addNgramEntry(&ngramProperty));
+            }
+        }
+    }
+
+    int getWordId(const std::string &word) const {
+        const std::vector<int> codePoints = DictionaryTestUtils::toCodePoints(word.c_str());
+        return mPolicy->getWordId(CodePointArrayView(codePoints),
+                false /* forceLowerCaseSearch */);
+    }
+
+    int getBigramProbability(const int prevWordIndex, const int nextWordIndex) {
+        const int prevWordId = getWordId(getPrevWord(prevWordIndex));
+        return mBigramMap.getBigramProbability(mPolicy.get(),
+                WordIdArrayView::singleElementView(&prevWordId),
+                getWordId(getNextWord(nextWordIndex)), DictionaryTestUtils::DEFAULT_PROBABILITY);
+    }
+
+    int getExpectedProbability(const int prevWordIndex, const int nextWordIndex) const {
+        return nextWordIndex < SUCCESSOR_COUNT ? getNgramProbability(prevWordIndex, nextWordIndex)
+                : DictionaryTestUtils::DEFAULT_PROBABILITY;
+    }
+
+    const std::unique_ptr<CountingPolicy> mPolicy;
+    MultiBigramMap mBigramMap;
+};
+
+TEST_F(MultiBigramMapTest, TestGetsBigramProbabilities) {
+    for (int i = 0; i < CONTEXT_COUNT; ++i) {
+        for (int j = 0; j <= SUCCESSOR_COUNT; ++j) {
+            EXPECT_EQ(getExpectedProbability(i, j), getBigramProbability(i, j)) << i << " " << j;
+        }
+    }
+    EXPECT_EQ(CONTEXT_COUNT, mPolicy->getNgramIterationCount());
+    // Without a context, the n-grams are not read.
+    EXPECT_EQ(DictionaryTestUtils::DEFAULT_PROBABILITY, mBigramMap.getBigramProbability(
+            mPolicy.get(), WordIdArrayView(), getWordId(getNextWord(0)),
+            DictionaryTestUtils::DEFAULT_PROBABILITY));
+    EXPECT_EQ(CONTEXT_COUNT, mPolicy->getNgramIterationCount());
+}
+
+TEST_F(MultiBigramMapTest, TestHitsCachedContexts) {
+    for (int i = 0; i < CONTEXT_COUNT; ++i) {
+        getBigramProbability(i, 0);
+    }
+    EXPECT_EQ(CONTEXT_COUNT, mPolicy->getNgramIterationCount());
+    // All the contexts fit, so none of them is read again.
+    for (int i = CONTEXT_COUNT - 1; i >= 0; --i) {
+        for (int j = 0; j <= SUCCESSOR_COUNT; ++j) {
+            EXPECT_EQ(getExpectedProbability(i, j), getBigramProbability(i, j)) << i << " " << j;
+        }
+    }
+    EXPECT_EQ(CONTEXT_COUNT, mPolicy->getNgramIterationCount());
+    mBigramMap.clear();
+    EXPECT_EQ(getExpectedProbability(0, 0), getBigramProbability(0, 0));
+    EXPECT_EQ(CONTEXT_COUNT + 1, mPolicy->getNgramIterationCount());
+}
+
+TEST_F(MultiBigramMapTest, TestEvictsLeastRecentlyUsedContext) {
+    for (int i = 0; i < CONTEXT_COUNT; ++i) {
+        getBigramProbability(i, 0);
+    }
+    // The first context is used again, so the second one is the least recently used.
+    getBigramProbability(0, 1);
+    EXPECT_EQ(getExpectedProbability(CONTEXT_COUNT, 0), getBigramProbability(CONTEXT_COUNT, 0));
+    EXPECT_EQ(CONTEXT_COUNT + 1, mPolicy->getNgramIterationCount());
+    EXPECT_EQ(getExpectedProbability(0, 2), getBigramProbability(0, 2));
+    for (int i = 2; i <= CONTEXT_COUNT; ++i) {
+        EXPECT_EQ(getExpectedProbability(i, 1), getBigramProbability(i, 1)) << i;
+    }
+    EXPECT_EQ(CONTEXT_COUNT + 1, mPolicy->getNgramIterationCount());
+    EXPECT_EQ(getExpectedProbability(1, 1), getBigramProbability(1, 1));
+    EXPECT_EQ(CONTEXT_COUNT + 2, mPolicy->getNgramIterationCount());
+}
+
+TEST_F(MultiBigramMapTest, TestKeepsSuccessorsAcrossCompactions) {
+    // Cycling through more contexts than fit evicts a context per previous word, which compacts
+    // the successors every few previous words.
+    const int roundCount = 3;
+    for (int round = 0; round < roundCount; ++round) {
+        for (int i = 0; i < PREV_WORD_COUNT; ++i) {
+            for (int j = 0; j <= SUCCESSOR_COUNT; ++j) {
+                EXPECT_EQ(getExpectedProbability(i, j), getBigramProbability(i, j))
+                        << i << " " << j;
+            }
+        }
+    }
+    EXPECT_EQ(roundCount * PREV_WORD_COUNT, mPolicy->getNgramIterationCount());
+    // The last previous words are the cached ones.
+    for (int i = PREV_WORD_COUNT - CONTEXT_COUNT; i < PREV_WORD_COUNT; ++i) {
+        EXPECT_EQ(getExpectedProbability(i, 0), getBigramProbability(i, 0)) << i;
+    }
+    EXPECT_EQ(roundCount * PREV_WORD_COUNT, mPolicy->getNgramIterationCount());
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/utils/ngram_context_map.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+TEST(NgramContextMapTest, TestPutAndGet) {
+    NgramContextMap ngramContextMap;
+    const std::array<int, 3> prevWordIdArray = {{ 10, 20, 30 }};
+    const WordIdArrayView prevWordIds = WordIdArrayView::fromArray(prevWordIdArray);
+    EXPECT_EQ(NgramContextMap::NOT_A_VALUE, ngramContextMap.get(prevWordIds.limit(1)));
+    EXPECT_TRUE(ngramContextMap.put(prevWordIds.limit(1), 1));
+    EXPECT_TRUE(ngramContextMap.put(prevWordIds.limit(2), 2));
+    EXPECT_TRUE(ngramContextMap.put(prevWordIds, 3));
+    EXPECT_EQ(1, ngramContextMap.get(prevWordIds.limit(1)));
+    EXPECT_EQ(2, ngramContextMap.get(prevWordIds.limit(2)));
+    EXPECT_EQ(3, ngramContextMap.get(prevWordIds));
+    EXPECT_EQ(NgramContextMap::NOT_A_VALUE, ngramContextMap.get(prevWordIds.skip(1)));
+    EXPECT_EQ(3, ngramContextMap.getEntryCount());
+
+    EXPECT_TRUE(ngramContextMap.put(prevWordIds.limit(2), 4));
+    EXPECT_EQ(4, ngramContextMap.get(prevWordIds.limit(2)));
+    EXPECT_EQ(3, ngramContextMap.getEntryCount());
+
+    ngramContextMap.clear();
+    EXPECT_EQ(NgramContextMap::NOT_A_VALUE, ngramContextMap.get(prevWordIds));
+    EXPECT_EQ(0, ngramContextMap.getEntryCount());
+}
+
+TEST(NgramContextMapTest, TestInvalidContexts) {
+    NgramContextMap ngramContextMap;
+    const std::array<int, 4> tooLongPrevWordIds = {{ 1, 2, 3, 4 }};
+    const int invalidPrevWordId = NOT_A_WORD_ID;
+    EXPECT_FALSE(ngramContextMap.put(WordIdArrayView(), 1));
+    EXPECT_FALSE(ngramContextMap.put(WordIdArrayView::fromArray(tooLongPrevWordIds), 1));
+    EXPECT_FALSE(ngramContextMap.put(WordIdArrayView(&invalidPrevWordId, 1), 1));
+    EXPECT_EQ(NgramContextMap::NOT_A_VALUE, ngramContextMap.get(WordIdArrayView()));
+    EXPECT_EQ(0, ngramContextMap.getEntryCount());
+}
+
+TEST(NgramContextMapTest, TestRandomContexts) {
+    NgramContextMap ngramContextMap;
+    std::map<std::vector<int>, int> testMap;
+    std::mt19937 randomEngine(1);
+    std::uniform_int_distribution<int> wordIdDistribution(0, 500);
+    std::uniform_int_distribution<int> prevWordCountDistribution(1,
+            MAX_PREV_WORD_COUNT_FOR_N_GRAM);
+    for (int i = 0; i < 100000; ++i) {
+        std::vector<int> prevWordIds(prevWordCountDistribution(randomEngine));
+        for (int &wordId : prevWordIds) {
+            wordId = wordIdDistribution(randomEngine);
+        }
+        EXPECT_TRUE(ngramContextMap.put(WordIdArrayView(prevWordIds), i));
+        testMap[prevWordIds] = i;
+    }
+    EXPECT_EQ(static_cast<int>(testMap.size()), ngramContextMap.getEntryCount());
+    for (const auto &entry : testMap) {
+        EXPECT_EQ(entry.second, ngramContextMap.get(WordIdArrayView(entry.first)));
+    }
+}
+
+}  // namespace
+}  // namespace latinime
@@ -43,5 +43,49 @@ TEST(SparseTableTest, TestSetAndGet) {
     EXPECT_EQ(101u, sparseTable.get(11));
 }
 
+TEST(SparseTableTest, TestGetManyAndReopen) {
+    static const int BLOCK_SIZE = 4;
+    static const int DATA_SIZE = 4;
+    static const int ID_COUNT = 100;
+    BufferWithExtendableBuffer indexTableBuffer(
+            BufferWithExtendableBuffer::DEFAULT_MAX_ADDITIONAL_BUFFER_SIZE);
+    BufferWithExtendableBuffer contentTableBuffer(
+            BufferWithExtendableBuffer::DEFAULT_MAX_ADDITIONAL_BUFFER_SIZE);
+    SparseTable sparseTable(&indexTableBuffer, &contentTableBuffer, BLOCK_SIZE, DATA_SIZE);
+    // Only some of the blocks are allocated.
+    for (int id = 0; id < ID_COUNT; id += 3) {
+        EXPECT_TRUE(sparseTable.set(id, id * 10));
+    }
+    int ids[ID_COUNT + 2];
+    for (int id = 0; id < ID_COUNT; ++id) {
+        ids[id] = id;
+    }
+    ids[ID_COUNT] = -1;
+    ids[ID_COUNT + 1] = ID_COUNT * 10;
+    uint32_t values[ID_COUNT + 2];
+    sparseTable.getMany(ids, ID_COUNT + 2, values);
+    for (int id = 0; id < ID_COUNT; ++id) {
+        const uint32_t expectedValue = id % 3 == 0 ? static_cast<uint32_t>(id * 10)
+                : static_cast<uint32_t>(NOT_A_DICT_POS);
+        EXPECT_EQ(expectedValue, values[id]);
+        if (sparseTable.contains(id)) {
+            EXPECT_EQ(sparseTable.get(id), values[id]);
+        }
+    }
+    EXPECT_EQ(static_cast<uint32_t>(NOT_A_DICT_POS), values[ID_COUNT]);
+    EXPECT_EQ(static_cast<uint32_t>(NOT_A_DICT_POS), values[ID_COUNT + 1]);
+
+    // The index directory is read back from the buffers.
+    SparseTable reopenedSparseTable(&indexTableBuffer, &contentTableBuffer, BLOCK_SIZE,
+            DATA_SIZE);
+    for (int id = 0; id < ID_COUNT; ++id) {
+        EXPECT_EQ(sparseTable.contains(id), reopenedSparseTable.contains(id));
+        if (id % 3 == 0) {
+            EXPECT_EQ(static_cast<uint32_t>(id * 10), reopenedSparseTable.get(id));
+        }
+    }
+    EXPECT_FALSE(reopenedSparseTable.contains(ID_COUNT * 10));
+}
+
 }  // namespace
 }  // namespace latinime
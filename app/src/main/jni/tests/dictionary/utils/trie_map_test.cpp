@@ -24,6 +24,7 @@
 #include <map>
 #include <random>
 #include <unordered_map>
+#include <vector>
 
 namespace latinime {
 namespace {
@@ -48,6 +49,15 @@ TEST(TrieMapTest, TestSetAndGet) {
     EXPECT_EQ(0xFFFFFFFFFull, trieMap.getRoot(0).mValue);
 }
 
+TEST(TrieMapTest, TestUsedAdditionalBufferSize) {
+    TrieMap trieMap;
+    const int initialSize = trieMap.getUsedAdditionalBufferSize();
+    for (int i = 0; i < 100; ++i) {
+        trieMap.putRoot(i, i);
+    }
+    EXPECT_LT(initialSize, trieMap.getUsedAdditionalBufferSize());
+}
+
 TEST(TrieMapTest, TestRemove) {
     TrieMap trieMap;
     trieMap.putRoot(10, 10);
@@ -223,6 +233,41 @@ TEST(TrieMapTest, TestMultiLevel) {
     }
 }
 
+TEST(TrieMapTest, TestGetMulti) {
+    static const int ENTRY_COUNT = 10000;
+    static const int LOOKUP_COUNT = 20;
+
+    TrieMap trieMap;
+    std::vector<int> keys;
+    std::vector<int> bitmapEntryIndices;
+    std::uniform_int_distribution<int> distribution(0, S_INT_MAX);
+    auto keyRandomNumberGenerator = std::bind(distribution, std::mt19937());
+    for (int i = 0; i < ENTRY_COUNT; ++i) {
+        const int key = keyRandomNumberGenerator();
+        // Large values use value entries.
+        EXPECT_TRUE(trieMap.putRoot(key, i % 2 == 0 ? i : TrieMap::MAX_VALUE - i));
+        const int nextLevelBitmapEntryIndex = trieMap.getNextLevelBitmapEntryIndex(key);
+        EXPECT_TRUE(trieMap.put(key + 1, i, nextLevelBitmapEntryIndex));
+        keys.push_back(key);
+        bitmapEntryIndices.push_back(trieMap.getRootBitmapEntryIndex());
+        keys.push_back(key + 1);
+        bitmapEntryIndices.push_back(nextLevelBitmapEntryIndex);
+        // Not in the map.
+        keys.push_back(key + 2);
+        bitmapEntryIndices.push_back(nextLevelBitmapEntryIndex);
+    }
+    for (size_t i = 0; i + LOOKUP_COUNT <= keys.size(); i += LOOKUP_COUNT) {
+        TrieMap::Result results[LOOKUP_COUNT];
+        trieMap.getMulti(&keys[i], &bitmapEntryIndices[i], LOOKUP_COUNT, results);
+        for (int j = 0; j < LOOKUP_COUNT; ++j) {
+            const TrieMap::Result result = trieMap.get(keys[i + j], bitmapEntryIndices[i + j]);
+            EXPECT_EQ(result.mIsValid, results[j].mIsValid);
+            EXPECT_EQ(result.mValue, results[j].mValue);
+            EXPECT_EQ(result.mNextLevelBitmapEntryIndex, results[j].mNextLevelBitmapEntryIndex);
+        }
+    }
+}
+
 TEST(TrieMapTest, TestIteration) {
     static const int ELEMENT_COUNT = 200000;
     TrieMap trieMap;
@@ -249,5 +294,86 @@ TEST(TrieMapTest, TestIteration) {
     EXPECT_TRUE(testKeyValuePairs.empty());
 }
 
+TEST(TrieMapTest, TestValueLinks) {
+    TrieMap trieMap(true /* usesValueLinks */);
+    EXPECT_TRUE(trieMap.putRoot(10, 0xFFFFFFFFFull));
+    EXPECT_EQ(0xFFFFFFFFFull, trieMap.getRoot(10).mValue);
+    EXPECT_EQ(TrieMap::INVALID_INDEX, trieMap.getRoot(10).mNextLevelBitmapEntryIndex);
+    // Inline again, then back to a value link.
+    EXPECT_TRUE(trieMap.putRoot(10, 10));
+    EXPECT_EQ(10ull, trieMap.getRoot(10).mValue);
+    EXPECT_TRUE(trieMap.putRoot(10, TrieMap::MAX_VALUE));
+    EXPECT_EQ(TrieMap::MAX_VALUE, trieMap.getRoot(10).mValue);
+    // The value link is turned into a link to the next level.
+    const int nextLevel = trieMap.getNextLevelBitmapEntryIndex(10);
+    EXPECT_NE(TrieMap::INVALID_INDEX, nextLevel);
+    EXPECT_EQ(TrieMap::MAX_VALUE, trieMap.getRoot(10).mValue);
+    EXPECT_EQ(nextLevel, trieMap.getRoot(10).mNextLevelBitmapEntryIndex);
+    EXPECT_TRUE(trieMap.put(9, 0xFFFFFFFFFull, nextLevel));
+    EXPECT_EQ(0xFFFFFFFFFull, trieMap.get(9, nextLevel).mValue);
+    EXPECT_TRUE(trieMap.remove(9, nextLevel));
+    EXPECT_FALSE(trieMap.get(9, nextLevel).mIsValid);
+    EXPECT_TRUE(trieMap.remove(10, trieMap.getRootBitmapEntryIndex()));
+    EXPECT_FALSE(trieMap.getRoot(10).mIsValid);
+    EXPECT_TRUE(trieMap.putRoot(11, 0xFFFFFFFFFull));
+    EXPECT_EQ(0xFFFFFFFFFull, trieMap.getRoot(11).mValue);
+}
+
+TEST(TrieMapTest, TestValueLinksUseLessBuffer) {
+    static const int ELEMENT_COUNT = 1000;
+    TrieMap trieMap;
+    TrieMap trieMapWithValueLinks(true /* usesValueLinks */);
+    for (int i = 0; i < ELEMENT_COUNT; ++i) {
+        EXPECT_TRUE(trieMap.putRoot(i, TrieMap::MAX_VALUE - i));
+        EXPECT_TRUE(trieMapWithValueLinks.putRoot(i, TrieMap::MAX_VALUE - i));
+    }
+    EXPECT_LT(trieMapWithValueLinks.getUsedAdditionalBufferSize(),
+            trieMap.getUsedAdditionalBufferSize());
+    int count = 0;
+    for (const auto &entry : trieMapWithValueLinks.getEntriesInRootLevel()) {
+        EXPECT_EQ(TrieMap::MAX_VALUE - entry.key(), entry.value());
+        EXPECT_FALSE(entry.hasNextLevelMap());
+        ++count;
+    }
+    EXPECT_EQ(ELEMENT_COUNT, count);
+}
+
+TEST(TrieMapTest, TestValueLinksRandMultiLevel) {
+    static const int ELEMENT_COUNT = 20000;
+    TrieMap trieMap(true /* usesValueLinks */);
+    std::vector<uint64_t> firstLevelValues;
+    std::vector<uint64_t> secondLevelValues;
+
+    // Use the uniform distribution [0, TrieMap::MAX_VALUE].
+    std::uniform_int_distribution<uint64_t> valueDistribution(0, TrieMap::MAX_VALUE);
+    auto valueRandomNumberGenerator = std::bind(valueDistribution, std::mt19937());
+    for (int i = 0; i < ELEMENT_COUNT; ++i) {
+        firstLevelValues.push_back(valueRandomNumberGenerator());
+        secondLevelValues.push_back(valueRandomNumberGenerator());
+        EXPECT_TRUE(trieMap.putRoot(i, firstLevelValues[i]));
+        if (i % 4 == 0) {
+            EXPECT_TRUE(trieMap.put(i, secondLevelValues[i],
+                    trieMap.getNextLevelBitmapEntryIndex(i)));
+        }
+    }
+    for (int i = 0; i < ELEMENT_COUNT; i += 3) {
+        EXPECT_TRUE(trieMap.remove(i, trieMap.getRootBitmapEntryIndex()));
+    }
+    for (int i = 0; i < ELEMENT_COUNT; ++i) {
+        const TrieMap::Result result = trieMap.getRoot(i);
+        if (i % 3 == 0) {
+            EXPECT_FALSE(result.mIsValid);
+            continue;
+        }
+        EXPECT_EQ(firstLevelValues[i], result.mValue);
+        if (i % 4 == 0) {
+            EXPECT_EQ(secondLevelValues[i],
+                    trieMap.get(i, result.mNextLevelBitmapEntryIndex).mValue);
+        } else {
+            EXPECT_EQ(TrieMap::INVALID_INDEX, result.mNextLevelBitmapEntryIndex);
+        }
+    }
+}
+
 }  // namespace
 }  // namespace latinime
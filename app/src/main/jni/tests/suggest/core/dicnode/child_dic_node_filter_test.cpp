@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "suggest/core/dicnode/child_dic_node_filter.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "dictionary/header/header_policy.h"
+#include "dictionary/header/header_read_write_utils.h"
+
+namespace latinime {
+namespace {
+
+const std::vector<int> LOCALE;
+
+TEST(ChildDicNodeFilterTest, TestAccepts) {
+    const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+    const HeaderPolicy headerPolicy(FormatUtils::VERSION_403, LOCALE, &attributeMap);
+    const int codePoints[] = {'g', 'f', 'h', 't'};
+    const ChildDicNodeFilter filter(codePoints, NELEMS(codePoints),
+            DigraphUtils::getDigraphTypeForDictionary(&headerPolicy));
+    for (const int codePoint : codePoints) {
+        EXPECT_TRUE(filter.accepts(codePoint));
+    }
+    // Upper case and accented code points are compared by their base lower case.
+    EXPECT_TRUE(filter.accepts('G'));
+    EXPECT_TRUE(filter.accepts(0x125 /* LATIN SMALL LETTER H WITH CIRCUMFLEX */));
+    EXPECT_FALSE(filter.accepts(0xE8 /* LATIN SMALL LETTER E WITH GRAVE */));
+    // Intentional omissions are always accepted.
+    EXPECT_TRUE(filter.accepts('\''));
+    EXPECT_FALSE(filter.accepts('a'));
+    EXPECT_FALSE(filter.accepts('z'));
+    EXPECT_FALSE(filter.accepts(0xE4 /* LATIN SMALL LETTER A WITH DIAERESIS */));
+}
+
+TEST(ChildDicNodeFilterTest, TestMaxCodePointCount) {
+    const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+    const HeaderPolicy headerPolicy(FormatUtils::VERSION_403, LOCALE, &attributeMap);
+    std::vector<int> codePoints;
+    for (int i = 0; i < ChildDicNodeFilter::MAX_CODE_POINT_COUNT; ++i) {
+        codePoints.push_back('a' + i);
+    }
+    const ChildDicNodeFilter filter(codePoints.data(), static_cast<int>(codePoints.size()),
+            DigraphUtils::getDigraphTypeForDictionary(&headerPolicy));
+    for (const int codePoint : codePoints) {
+        EXPECT_TRUE(filter.accepts(codePoint));
+    }
+    EXPECT_FALSE(filter.accepts('a' + ChildDicNodeFilter::MAX_CODE_POINT_COUNT));
+    EXPECT_FALSE(filter.accepts(NOT_A_CODE_POINT + 1));
+}
+
+TEST(ChildDicNodeFilterTest, TestDigraph) {
+    DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+    HeaderReadWriteUtils::setBoolAttribute(&attributeMap, "REQUIRES_GERMAN_UMLAUT_PROCESSING",
+            true);
+    const HeaderPolicy headerPolicy(FormatUtils::VERSION_403, LOCALE, &attributeMap);
+    const int codePoints[] = {'s'};
+    const ChildDicNodeFilter filter(codePoints, NELEMS(codePoints),
+            DigraphUtils::getDigraphTypeForDictionary(&headerPolicy));
+    EXPECT_TRUE(filter.accepts(0xE4 /* LATIN SMALL LETTER A WITH DIAERESIS */));
+    EXPECT_FALSE(filter.accepts('a'));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -65,5 +65,31 @@ TEST(DicNodePoolTest, TestReset) {
     EXPECT_EQ(nullptr, dicNodePool.getInstance());
 }
 
+TEST(DicNodePoolTest, TestResetKeepsBuffer) {
+    static const int CAPACITY_SMALL = 2;
+    static const int CAPACITY_LARGE = 10;
+    DicNodePool dicNodePool(CAPACITY_LARGE);
+
+    DicNode *const dicNode = dicNodePool.getInstance();
+    dicNodePool.reset(CAPACITY_SMALL);
+    EXPECT_EQ(dicNode, dicNodePool.getInstance());
+    dicNodePool.reset(CAPACITY_LARGE);
+    EXPECT_EQ(dicNode, dicNodePool.getInstance());
+}
+
+TEST(DicNodePoolTest, TestPlaceBackAfterExhausted) {
+    static const int CAPACITY = 3;
+    DicNodePool dicNodePool(CAPACITY);
+
+    DicNode *dicNodes[CAPACITY];
+    for (int i = 0; i < CAPACITY; ++i) {
+        dicNodes[i] = dicNodePool.getInstance();
+    }
+    EXPECT_EQ(nullptr, dicNodePool.getInstance());
+    dicNodePool.placeBackInstance(dicNodes[1]);
+    EXPECT_EQ(dicNodes[1], dicNodePool.getInstance());
+    EXPECT_EQ(nullptr, dicNodePool.getInstance());
+}
+
 }  // namespace
 }  // namespace latinime
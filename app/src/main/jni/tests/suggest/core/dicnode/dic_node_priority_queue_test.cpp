@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dicnode/dic_node_priority_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "suggest/core/dicnode/dic_node.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// Shallower DicNodes are better when the distances are the same.
+void initDicNodeWithDepth(const int depth, DicNode *const outDicNode) {
+    static const int CODE_POINT = 'a';
+    outDicNode->initAsRoot(0 /* rootPtNodeArrayPos */, WordIdArrayView());
+    DicNode parentDicNode;
+    for (int i = 0; i < depth; ++i) {
+        parentDicNode.initByCopy(outDicNode);
+        outDicNode->initAsChild(&parentDicNode, NOT_A_DICT_POS, NOT_A_WORD_ID,
+                CodePointArrayView(&CODE_POINT, 1));
+    }
+}
+
+TEST(DicNodePriorityQueueTest, TestPopBestAndWorst) {
+    static const int CAPACITY = 16;
+    DicNodePriorityQueue queue(CAPACITY);
+    std::vector<int> depths;
+    for (int i = 0; i < CAPACITY; ++i) {
+        depths.push_back(i);
+    }
+    std::mt19937 random(1234);
+    std::shuffle(depths.begin(), depths.end(), random);
+    DicNode dicNode;
+    for (const int depth : depths) {
+        initDicNodeWithDepth(depth, &dicNode);
+        queue.copyPush(&dicNode);
+    }
+    EXPECT_EQ(CAPACITY, queue.getSize());
+    int bestDepth = 0;
+    int worstDepth = CAPACITY - 1;
+    while (queue.getSize() > 0) {
+        queue.copyPopBest(&dicNode);
+        EXPECT_EQ(bestDepth++, dicNode.getNodeCodePointCount());
+        if (queue.getSize() == 0) {
+            break;
+        }
+        queue.copyPop(&dicNode);
+        EXPECT_EQ(worstDepth--, dicNode.getNodeCodePointCount());
+    }
+}
+
+TEST(DicNodePriorityQueueTest, TestEvictWorst) {
+    static const int CAPACITY = 5;
+    static const int PUSH_COUNT = 50;
+    DicNodePriorityQueue queue(CAPACITY);
+    std::vector<int> depths;
+    for (int i = 0; i < PUSH_COUNT; ++i) {
+        depths.push_back(i);
+    }
+    std::mt19937 random(5678);
+    std::shuffle(depths.begin(), depths.end(), random);
+    DicNode dicNode;
+    for (const int depth : depths) {
+        initDicNodeWithDepth(depth, &dicNode);
+        queue.copyPush(&dicNode);
+        EXPECT_LE(queue.getSize(), CAPACITY);
+    }
+    // Only the best nodes are kept.
+    for (int i = 0; i < CAPACITY; ++i) {
+        queue.copyPopBest(&dicNode);
+        EXPECT_EQ(i, dicNode.getNodeCodePointCount());
+    }
+    EXPECT_EQ(0, queue.getSize());
+}
+
+TEST(DicNodePriorityQueueTest, TestPeekWorst) {
+    static const int CAPACITY = 4;
+    DicNodePriorityQueue queue(CAPACITY);
+    EXPECT_EQ(nullptr, queue.peekWorst());
+    DicNode dicNode;
+    static const int DEPTHS[] = {2, 5, 1, 3, 0};
+    for (const int depth : DEPTHS) {
+        initDicNodeWithDepth(depth, &dicNode);
+        queue.copyPush(&dicNode);
+    }
+    ASSERT_NE(nullptr, queue.peekWorst());
+    EXPECT_EQ(3, queue.peekWorst()->getNodeCodePointCount());
+    EXPECT_EQ(CAPACITY, queue.getSize());
+}
+
+TEST(DicNodePriorityQueueTest, TestClearAndResize) {
+    static const int CAPACITY = 3;
+    DicNodePriorityQueue queue(CAPACITY);
+    DicNode dicNode;
+    for (int i = 0; i < CAPACITY; ++i) {
+        initDicNodeWithDepth(i, &dicNode);
+        queue.copyPush(&dicNode);
+    }
+    queue.clearAndResize(1 /* maxSize */);
+    EXPECT_EQ(0, queue.getSize());
+    for (int i = CAPACITY; i > 0; --i) {
+        initDicNodeWithDepth(i, &dicNode);
+        queue.copyPush(&dicNode);
+    }
+    EXPECT_EQ(1, queue.getSize());
+    queue.copyPop(&dicNode);
+    EXPECT_EQ(1, dicNode.getNodeCodePointCount());
+}
+
+TEST(DicNodePriorityQueueTest, TestRecombineEquivalentDicNodes) {
+    static const int CAPACITY = 4;
+    DicNodePriorityQueue queue(CAPACITY);
+    DicNode dicNode;
+    int recombinedCount = 0;
+    for (int i = 0; i < 2; ++i) {
+        for (int depth = 0; depth < 3; ++depth) {
+            initDicNodeWithDepth(depth, &dicNode);
+            EXPECT_FALSE(queue.copyPushRecombining(&dicNode, &recombinedCount));
+            // The second time, the same costs as the queued ones.
+            EXPECT_EQ(i, recombinedCount);
+        }
+    }
+    EXPECT_EQ(3, queue.getSize());
+
+    // Dropped DicNodes are not found anymore.
+    queue.copyPopBest(&dicNode);
+    EXPECT_EQ(0, dicNode.getNodeCodePointCount());
+    for (int depth = 3; depth < 5; ++depth) {
+        initDicNodeWithDepth(depth, &dicNode);
+        queue.copyPushRecombining(&dicNode, &recombinedCount);
+        EXPECT_EQ(0, recombinedCount);
+    }
+    // Depth 4 has been evicted.
+    initDicNodeWithDepth(0, &dicNode);
+    EXPECT_TRUE(queue.copyPushRecombining(&dicNode, &recombinedCount));
+    EXPECT_EQ(0, recombinedCount);
+    initDicNodeWithDepth(4, &dicNode);
+    EXPECT_TRUE(queue.copyPushRecombining(&dicNode, &recombinedCount));
+    EXPECT_EQ(0, recombinedCount);
+    initDicNodeWithDepth(3, &dicNode);
+    EXPECT_FALSE(queue.copyPushRecombining(&dicNode, &recombinedCount));
+    EXPECT_EQ(1, recombinedCount);
+    for (int depth = 0; depth < CAPACITY; ++depth) {
+        queue.copyPopBest(&dicNode);
+        EXPECT_EQ(depth, dicNode.getNodeCodePointCount());
+    }
+    EXPECT_EQ(0, queue.getSize());
+}
+
+}  // namespace
+}  // namespace latinime
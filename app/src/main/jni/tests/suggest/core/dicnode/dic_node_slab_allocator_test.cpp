@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dicnode/dic_node_slab_allocator.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "utils/memory_usage.h"
+
+namespace latinime {
+namespace {
+
+TEST(DicNodeSlabAllocatorTest, TestLeasesAtLeastTheCapacity) {
+    DicNodeSlabAllocator allocator(1000 /* maxIdleDicNodeCount */);
+    for (const int capacity : { 1, 41, 64, 101, 311 }) {
+        EXPECT_LE(capacity, static_cast<int>(allocator.leaseSlab(capacity).size()));
+    }
+    EXPECT_EQ(0, allocator.getIdleDicNodeCount());
+}
+
+TEST(DicNodeSlabAllocatorTest, TestReusesReturnedSlab) {
+    DicNodeSlabAllocator allocator(1000 /* maxIdleDicNodeCount */);
+    std::vector<DicNode> slab = allocator.leaseSlab(100 /* capacity */);
+    const DicNode *const dicNodes = slab.data();
+    const int slabSize = static_cast<int>(slab.size());
+    allocator.returnSlab(std::move(slab));
+    EXPECT_EQ(slabSize, allocator.getIdleDicNodeCount());
+
+    // A larger capacity doesn't fit into the idle slab.
+    EXPECT_NE(dicNodes, allocator.leaseSlab(slabSize + 1).data());
+    EXPECT_EQ(slabSize, allocator.getIdleDicNodeCount());
+    EXPECT_EQ(dicNodes, allocator.leaseSlab(10 /* capacity */).data());
+    EXPECT_EQ(0, allocator.getIdleDicNodeCount());
+}
+
+TEST(DicNodeSlabAllocatorTest, TestLeasesSmallestFittingSlab) {
+    DicNodeSlabAllocator allocator(1000 /* maxIdleDicNodeCount */);
+    std::vector<DicNode> largeSlab = allocator.leaseSlab(300 /* capacity */);
+    std::vector<DicNode> smallSlab = allocator.leaseSlab(60 /* capacity */);
+    const DicNode *const smallDicNodes = smallSlab.data();
+    allocator.returnSlab(std::move(largeSlab));
+    allocator.returnSlab(std::move(smallSlab));
+    EXPECT_EQ(smallDicNodes, allocator.leaseSlab(50 /* capacity */).data());
+}
+
+TEST(DicNodeSlabAllocatorTest, TestFreesSlabsBeyondMaxIdleCount) {
+    DicNodeSlabAllocator allocator(100 /* maxIdleDicNodeCount */);
+    std::vector<DicNode> slab0 = allocator.leaseSlab(64 /* capacity */);
+    std::vector<DicNode> slab1 = allocator.leaseSlab(64 /* capacity */);
+    allocator.returnSlab(std::move(slab0));
+    allocator.returnSlab(std::move(slab1));
+    EXPECT_EQ(64, allocator.getIdleDicNodeCount());
+
+    MemoryUsage memoryUsage;
+    allocator.addMemoryUsage(&memoryUsage);
+    EXPECT_LE(static_cast<int64_t>(64 * sizeof(DicNode)),
+            memoryUsage.get(MemoryUsage::CACHE_BYTES));
+    allocator.trimMemory();
+    EXPECT_EQ(0, allocator.getIdleDicNodeCount());
+    MemoryUsage trimmedMemoryUsage;
+    allocator.addMemoryUsage(&trimmedMemoryUsage);
+    EXPECT_EQ(0, trimmedMemoryUsage.get(MemoryUsage::CACHE_BYTES));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dicnode/dic_node.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// Follows one child per code point from parentDicNode.
+void initAsDescendant(const DicNode *const parentDicNode, const std::vector<int> &codePoints,
+        DicNode *const outDicNode) {
+    outDicNode->initByCopy(parentDicNode);
+    DicNode dicNode;
+    for (const int codePoint : codePoints) {
+        dicNode.initByCopy(outDicNode);
+        outDicNode->initAsChild(&dicNode, NOT_A_DICT_POS, NOT_A_WORD_ID,
+                CodePointArrayView(&codePoint, 1));
+    }
+}
+
+std::vector<int> getOutput(const DicNode *const dicNode) {
+    std::vector<int> codePoints(dicNode->getTotalNodeCodePointCount());
+    dicNode->outputResult(codePoints.data());
+    return codePoints;
+}
+
+TEST(DicNodeTest, TestOutputsBmpCodePoints) {
+    DicNode rootDicNode;
+    rootDicNode.initAsRoot(0 /* rootPtNodeArrayPos */, WordIdArrayView());
+    DicNode dicNode;
+    // LATIN SMALL LETTER E WITH ACUTE and a CJK ideograph.
+    initAsDescendant(&rootDicNode, { 'c', 0xE9, 0x4E2D }, &dicNode);
+    EXPECT_EQ(std::vector<int>({ 'c', 0xE9, 0x4E2D }), getOutput(&dicNode));
+    EXPECT_EQ(0x4E2D, dicNode.getNodeCodePoint());
+}
+
+TEST(DicNodeTest, TestOutputsSupplementaryCodePoints) {
+    DicNode rootDicNode;
+    rootDicNode.initAsRoot(0 /* rootPtNodeArrayPos */, WordIdArrayView());
+    DicNode parentDicNode;
+    initAsDescendant(&rootDicNode, { 'a', 'b' }, &parentDicNode);
+    DicNode dicNode;
+    // A supplementary code point after BMP ones, then a BMP one again.
+    initAsDescendant(&parentDicNode, { 0x1F600 /* GRINNING FACE */, 0x20000, 'c' }, &dicNode);
+    EXPECT_EQ(std::vector<int>({ 'a', 'b', 0x1F600, 0x20000, 'c' }), getOutput(&dicNode));
+
+    // The copies and the next word keep the planes.
+    DicNode copiedDicNode(dicNode);
+    EXPECT_EQ(getOutput(&dicNode), getOutput(&copiedDicNode));
+    DicNode nextWordDicNode;
+    nextWordDicNode.initAsRootWithPreviousWord(&dicNode, 0 /* rootPtNodeArrayPos */);
+    DicNode nextWordChildDicNode;
+    initAsDescendant(&nextWordDicNode, { 'd' }, &nextWordChildDicNode);
+    EXPECT_EQ(std::vector<int>({ 'a', 'b', 0x1F600, 0x20000, 'c', KEYCODE_SPACE, 'd' }),
+            getOutput(&nextWordChildDicNode));
+    EXPECT_EQ(1, nextWordChildDicNode.getTotalNodeSpaceCount());
+
+    // Reusing the storage for a BMP word doesn't keep any plane.
+    copiedDicNode.initByCopy(&parentDicNode);
+    EXPECT_EQ(std::vector<int>({ 'a', 'b' }), getOutput(&copiedDicNode));
+}
+
+TEST(DicNodeTest, TestKeepsMaxTerminalProbabilityBelowPtNode) {
+    DicNode rootDicNode;
+    rootDicNode.initAsRoot(0 /* rootPtNodeArrayPos */, WordIdArrayView());
+    EXPECT_EQ(MAX_PROBABILITY, rootDicNode.getMaxTerminalProbability());
+    const std::vector<int> mergedCodePoints = { 'a', 'b', 'c' };
+    DicNode dicNode;
+    dicNode.initAsChild(&rootDicNode, NOT_A_DICT_POS, NOT_A_WORD_ID,
+            CodePointArrayView(mergedCodePoints), 120 /* maxTerminalProbability */);
+    EXPECT_EQ(120, dicNode.getMaxTerminalProbability());
+
+    // The passing children are on the same PtNode.
+    DicNode passingChildDicNode;
+    passingChildDicNode.initAsPassingChild(&dicNode);
+    EXPECT_EQ(120, passingChildDicNode.getMaxTerminalProbability());
+    DicNode copiedDicNode(passingChildDicNode);
+    EXPECT_EQ(120, copiedDicNode.getMaxTerminalProbability());
+
+    // The next word starts from the root again.
+    DicNode nextWordDicNode;
+    nextWordDicNode.initAsRootWithPreviousWord(&dicNode, 0 /* rootPtNodeArrayPos */);
+    EXPECT_EQ(MAX_PROBABILITY, nextWordDicNode.getMaxTerminalProbability());
+    DicNode nextWordChildDicNode;
+    initAsDescendant(&nextWordDicNode, { 'd' }, &nextWordChildDicNode);
+    EXPECT_EQ(MAX_PROBABILITY, nextWordChildDicNode.getMaxTerminalProbability());
+}
+
+}  // namespace
+}  // namespace latinime
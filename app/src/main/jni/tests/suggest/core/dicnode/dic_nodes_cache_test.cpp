@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dicnode/dic_nodes_cache.h"
+
+#include <gtest/gtest.h>
+
+#include "suggest/core/dicnode/dic_node.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+static const int QUEUE_SIZE = 10;
+static const int INPUT_SIZE = 8;
+
+// DicNodes of different depths, which are not recombined.
+void initDicNodeWithDepth(const int depth, DicNode *const outDicNode) {
+    static const int CODE_POINT = 'a';
+    outDicNode->initAsRoot(0 /* rootPtNodeArrayPos */, WordIdArrayView());
+    DicNode parentDicNode;
+    for (int i = 0; i < depth; ++i) {
+        parentDicNode.initByCopy(outDicNode);
+        outDicNode->initAsChild(&parentDicNode, NOT_A_DICT_POS, NOT_A_WORD_ID,
+                CodePointArrayView(&CODE_POINT, 1));
+    }
+}
+
+// Runs a fake search that keeps nodeCount DicNodes active and records one terminal candidate for
+// every input index.
+void runSearch(DicNodesCache *const cache, const int nodeCount) {
+    cache->reset(QUEUE_SIZE, QUEUE_SIZE);
+    DicNode dicNode;
+    cache->copyPushActive(&dicNode);
+    for (int inputIndex = 0; inputIndex < INPUT_SIZE; ++inputIndex) {
+        const bool shouldTakeSnapshot = cache->startSnapshot();
+        while (cache->activeSize() > 0) {
+            cache->popActive(&dicNode);
+            if (shouldTakeSnapshot) {
+                cache->copyPushSnapshot(&dicNode);
+            }
+        }
+        cache->copyPushTerminalCandidate(&dicNode);
+        for (int i = 0; i < nodeCount; ++i) {
+            initDicNodeWithDepth(i, &dicNode);
+            cache->copyPushNextActive(&dicNode);
+        }
+        cache->commitSnapshot();
+        cache->advanceActiveDicNodes();
+        cache->advanceInputIndex(INPUT_SIZE);
+    }
+}
+
+TEST(DicNodesCacheTest, TestRestoreFromSnapshot) {
+    static const int NODE_COUNT = 3;
+    DicNodesCache cache(false /* usesLargeCapacityCache */);
+    runSearch(&cache, NODE_COUNT);
+
+    EXPECT_TRUE(cache.restoreFromSnapshot(QUEUE_SIZE, QUEUE_SIZE, 4 /* maxInputIndex */));
+    EXPECT_EQ(NODE_COUNT, cache.activeSize());
+    EXPECT_EQ(0, cache.terminalSize());
+    EXPECT_TRUE(cache.isLookAheadCorrectionInputIndex(3));
+}
+
+TEST(DicNodesCacheTest, TestRestoreFromSnapshotKeepsEarlierTerminalCandidates) {
+    DicNodesCache cache(false /* usesLargeCapacityCache */);
+    runSearch(&cache, 2 /* nodeCount */);
+    EXPECT_EQ(INPUT_SIZE, cache.getTerminalCandidateCount());
+
+    // The candidates of the restored input index and after are recorded again.
+    EXPECT_TRUE(cache.restoreFromSnapshot(QUEUE_SIZE, QUEUE_SIZE, 4 /* maxInputIndex */));
+    EXPECT_EQ(4, cache.getTerminalCandidateCount());
+
+    cache.reset(QUEUE_SIZE, QUEUE_SIZE);
+    EXPECT_EQ(0, cache.getTerminalCandidateCount());
+}
+
+TEST(DicNodesCacheTest, TestRestoreFromSnapshotNotAvailable) {
+    DicNodesCache cache(false /* usesLargeCapacityCache */);
+    // Nothing has been searched yet.
+    EXPECT_FALSE(cache.restoreFromSnapshot(QUEUE_SIZE, QUEUE_SIZE, 4 /* maxInputIndex */));
+
+    runSearch(&cache, 1 /* nodeCount */);
+    // The snapshot of the first input index only contains the root.
+    EXPECT_FALSE(cache.restoreFromSnapshot(QUEUE_SIZE, QUEUE_SIZE, 0 /* maxInputIndex */));
+
+    cache.reset(QUEUE_SIZE, QUEUE_SIZE);
+    EXPECT_FALSE(cache.restoreFromSnapshot(QUEUE_SIZE, QUEUE_SIZE, 4 /* maxInputIndex */));
+}
+
+TEST(DicNodesCacheTest, TestRestoreInvalidatesLaterSnapshots) {
+    DicNodesCache cache(false /* usesLargeCapacityCache */);
+    runSearch(&cache, 2 /* nodeCount */);
+
+    EXPECT_TRUE(cache.restoreFromSnapshot(QUEUE_SIZE, QUEUE_SIZE, 2 /* maxInputIndex */));
+    // Snapshots after the restored input index belong to the previous input.
+    EXPECT_TRUE(cache.restoreFromSnapshot(QUEUE_SIZE, QUEUE_SIZE, 5 /* maxInputIndex */));
+    EXPECT_TRUE(cache.isLookAheadCorrectionInputIndex(1));
+}
+
+TEST(DicNodesCacheTest, TestSearchEffort) {
+    static const int NODE_COUNT = 3;
+    DicNodesCache cache(false /* usesLargeCapacityCache */);
+    runSearch(&cache, NODE_COUNT);
+
+    const SearchEffort &searchEffort = cache.getSearchEffort();
+    // The root, then NODE_COUNT nodes for every input index.
+    EXPECT_EQ(1 + INPUT_SIZE * NODE_COUNT, searchEffort.get(SearchEffort::PUSHED_DIC_NODES));
+    // The nodes pushed for the last input index are never popped.
+    EXPECT_EQ(1 + (INPUT_SIZE - 1) * NODE_COUNT,
+            searchEffort.get(SearchEffort::POPPED_DIC_NODES));
+    EXPECT_EQ(0, searchEffort.get(SearchEffort::EVICTED_DIC_NODES));
+
+    EXPECT_EQ(0, searchEffort.get(SearchEffort::RECOMBINED_DIC_NODES));
+
+    DicNode dicNode;
+    for (int i = 0; i < QUEUE_SIZE + 2; ++i) {
+        initDicNodeWithDepth(i, &dicNode);
+        cache.copyPushNextActive(&dicNode);
+    }
+    EXPECT_EQ(2, searchEffort.get(SearchEffort::EVICTED_DIC_NODES));
+    // The same DicNode as a kept one.
+    initDicNodeWithDepth(0, &dicNode);
+    cache.copyPushNextActive(&dicNode);
+    EXPECT_EQ(1, searchEffort.get(SearchEffort::RECOMBINED_DIC_NODES));
+    cache.copyPushContinue(&dicNode);
+    EXPECT_EQ(1, searchEffort.get(SearchEffort::CACHED_DIC_NODES_FOR_CONTINUATION));
+
+    cache.reset(QUEUE_SIZE, QUEUE_SIZE);
+    EXPECT_EQ(0, searchEffort.get(SearchEffort::PUSHED_DIC_NODES));
+    EXPECT_EQ(0, searchEffort.get(SearchEffort::EVICTED_DIC_NODES));
+}
+
+}  // namespace
+}  // namespace latinime
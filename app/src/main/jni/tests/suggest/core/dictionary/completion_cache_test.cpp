@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/completion_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_node_utils.h"
+#include "suggest/core/dicnode/dic_node_vector.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+#include "utils/time_keeper.h"
+
+namespace latinime {
+namespace {
+
+static const int PT_NODE_ARRAY_POS = 10;
+static const int OTHER_PT_NODE_ARRAY_POS = 20;
+static const uint64_t GENERATION = 1;
+
+std::string toString(const CodePointArrayView codePoints) {
+    return std::string(codePoints.begin(), codePoints.end());
+}
+
+CompletionCache::Completions createCompletions(const int wordId) {
+    CompletionCache::Completions completions;
+    const std::vector<int> codePoints = DictionaryTestUtils::toCodePoints("ab");
+    completions.addCompletion(wordId, 100 /* probability */, NOT_A_DICT_POS,
+            CodePointArrayView(codePoints));
+    completions.setValid();
+    return completions;
+}
+
+class CompletionCacheTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        TimeKeeper::startTestModeWithForceCurrentTime(1000);
+        mPolicy = DictionaryTestUtils::createPolicy();
+        mOtherPolicy = DictionaryTestUtils::createPolicy();
+    }
+
+    void TearDown() override {
+        TimeKeeper::stopTestMode();
+    }
+
+    void addUnigram(const char *const word, const int probability) {
+        DictionaryTestUtils::addUnigram(mPolicy.get(), DictionaryTestUtils::toCodePoints(word),
+                probability);
+    }
+
+    // Walks down the trie to the DicNode of the last code point of the prefix.
+    bool getDicNode(const char *const prefix, DicNode *const outDicNode) const {
+        DicNodeUtils::initAsRoot(mPolicy.get(), WordIdArrayView(), outDicNode);
+        for (const int codePoint : DictionaryTestUtils::toCodePoints(prefix)) {
+            DicNodeVector childDicNodes;
+            DicNodeUtils::getAllChildDicNodes(outDicNode, mPolicy.get(), &childDicNodes);
+            bool hasChild = false;
+            for (int i = 0; i < childDicNodes.getSizeAndLock(); ++i) {
+                if (childDicNodes[i]->getNodeCodePoint() == codePoint) {
+                    *outDicNode = *childDicNodes[i];
+                    hasChild = true;
+                    break;
+                }
+            }
+            if (!hasChild) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int getWordId(const char *const word) const {
+        const std::vector<int> codePoints = DictionaryTestUtils::toCodePoints(word);
+        return mPolicy->getWordId(CodePointArrayView(codePoints),
+                false /* forceLowerCaseSearch */);
+    }
+
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr mPolicy;
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr mOtherPolicy;
+};
+
+TEST_F(CompletionCacheTest, TestGetAndPut) {
+    CompletionCache cache;
+    CompletionCache::Completions completions;
+    EXPECT_FALSE(cache.getCompletions(mPolicy.get(), GENERATION, PT_NODE_ARRAY_POS,
+            &completions));
+    cache.putCompletions(mPolicy.get(), GENERATION, PT_NODE_ARRAY_POS,
+            createCompletions(5 /* wordId */));
+    ASSERT_TRUE(cache.getCompletions(mPolicy.get(), GENERATION, PT_NODE_ARRAY_POS,
+            &completions));
+    EXPECT_TRUE(completions.isValid());
+    ASSERT_EQ(1, completions.getCount());
+    EXPECT_EQ(5, completions.getWordId(0));
+    EXPECT_EQ("ab", toString(completions.getCodePoints(0)));
+
+    EXPECT_FALSE(cache.getCompletions(mPolicy.get(), GENERATION, OTHER_PT_NODE_ARRAY_POS,
+            &completions));
+    EXPECT_FALSE(cache.getCompletions(mPolicy.get(), GENERATION + 1, PT_NODE_ARRAY_POS,
+            &completions));
+    EXPECT_FALSE(cache.getCompletions(mOtherPolicy.get(), GENERATION, PT_NODE_ARRAY_POS,
+            &completions));
+}
+
+TEST_F(CompletionCacheTest, TestInvalidation) {
+    CompletionCache cache;
+    cache.putCompletions(mPolicy.get(), GENERATION, PT_NODE_ARRAY_POS,
+            createCompletions(5 /* wordId */));
+    cache.putCompletions(mPolicy.get(), GENERATION, OTHER_PT_NODE_ARRAY_POS,
+            createCompletions(6 /* wordId */));
+    EXPECT_EQ(2, cache.getEntryCount());
+
+    // The dictionary has been updated.
+    cache.putCompletions(mPolicy.get(), GENERATION + 1, PT_NODE_ARRAY_POS,
+            createCompletions(7 /* wordId */));
+    EXPECT_EQ(1, cache.getEntryCount());
+    CompletionCache::Completions completions;
+    EXPECT_FALSE(cache.getCompletions(mPolicy.get(), GENERATION, PT_NODE_ARRAY_POS,
+            &completions));
+    ASSERT_TRUE(cache.getCompletions(mPolicy.get(), GENERATION + 1, PT_NODE_ARRAY_POS,
+            &completions));
+    EXPECT_EQ(7, completions.getWordId(0));
+
+    cache.putCompletions(mOtherPolicy.get(), GENERATION + 1, PT_NODE_ARRAY_POS,
+            createCompletions(8 /* wordId */));
+    EXPECT_FALSE(cache.getCompletions(mPolicy.get(), GENERATION + 1, PT_NODE_ARRAY_POS,
+            &completions));
+
+    cache.clear();
+    EXPECT_EQ(0, cache.getEntryCount());
+}
+
+TEST_F(CompletionCacheTest, TestExpiration) {
+    CompletionCache cache;
+    cache.putCompletions(mPolicy.get(), GENERATION, PT_NODE_ARRAY_POS,
+            createCompletions(5 /* wordId */));
+    TimeKeeper::startTestModeWithForceCurrentTime(1000 + 60 * 60);
+    CompletionCache::Completions completions;
+    EXPECT_FALSE(cache.getCompletions(mPolicy.get(), GENERATION, PT_NODE_ARRAY_POS,
+            &completions));
+    EXPECT_EQ(0, cache.getEntryCount());
+}
+
+TEST_F(CompletionCacheTest, TestEviction) {
+    static const int ENTRY_COUNT = 1000;
+    CompletionCache cache;
+    CompletionCache::Completions completions;
+    for (int i = 0; i < ENTRY_COUNT; ++i) {
+        cache.putCompletions(mPolicy.get(), GENERATION, i, createCompletions(i /* wordId */));
+        // Keep the first entry in use.
+        EXPECT_TRUE(cache.getCompletions(mPolicy.get(), GENERATION, 0, &completions));
+    }
+    EXPECT_GT(ENTRY_COUNT, cache.getEntryCount());
+    EXPECT_TRUE(cache.getCompletions(mPolicy.get(), GENERATION, ENTRY_COUNT - 1, &completions));
+    EXPECT_FALSE(cache.getCompletions(mPolicy.get(), GENERATION, 1, &completions));
+}
+
+TEST_F(CompletionCacheTest, TestReadsMostProbableCompletions) {
+    addUnigram("key", 200);
+    addUnigram("keys", 150);
+    addUnigram("keyboard", 180);
+    addUnigram("kept", 120);
+    addUnigram("ketchup", 100);
+    addUnigram("the", 250);
+    DicNode dicNode;
+    ASSERT_TRUE(getDicNode("ke", &dicNode));
+    ASSERT_TRUE(dicNode.isLeavingNode());
+
+    CompletionCache::Completions completions;
+    CompletionCache::readCompletions(mPolicy.get(), &dicNode, 3 /* maxCompletionCount */,
+            100 /* maxVisitedDicNodeCount */, &completions);
+    ASSERT_TRUE(completions.isValid());
+    ASSERT_EQ(3, completions.getCount());
+    EXPECT_EQ("y", toString(completions.getCodePoints(0)));
+    EXPECT_EQ(getWordId("key"), completions.getWordId(0));
+    EXPECT_EQ(200, completions.getProbability(0));
+    EXPECT_EQ("yboard", toString(completions.getCodePoints(1)));
+    EXPECT_EQ(getWordId("keyboard"), completions.getWordId(1));
+    EXPECT_EQ(NOT_A_DICT_POS, completions.getChildrenPtNodeArrayPos(1));
+    EXPECT_EQ("ys", toString(completions.getCodePoints(2)));
+    EXPECT_EQ(getWordId("keys"), completions.getWordId(2));
+
+    // y, s, board, pt and tchup.
+    CompletionCache::readCompletions(mPolicy.get(), &dicNode, 3 /* maxCompletionCount */,
+            13 /* maxVisitedDicNodeCount */, &completions);
+    EXPECT_FALSE(completions.isValid());
+    EXPECT_EQ(0, completions.getCount());
+    CompletionCache::readCompletions(mPolicy.get(), &dicNode, 10 /* maxCompletionCount */,
+            14 /* maxVisitedDicNodeCount */, &completions);
+    EXPECT_TRUE(completions.isValid());
+    EXPECT_EQ(5, completions.getCount());
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/dictionary_opener.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dictionary/utils/file_utils.h"
+#include "suggest/core/dictionary/dictionary.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// Writes a dictionary that contains the given word to a new directory in tempDirPath and returns
+// the path of the dictionary.
+std::string writeDictionary(const std::string &tempDirPath, const char *const name,
+        const std::vector<int> &word) {
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryTestUtils::createPolicy();
+    DictionaryTestUtils::addUnigram(policy.get(), word);
+    const std::string path = tempDirPath + "/" + name;
+    EXPECT_TRUE(policy->flushWithGC(path.c_str()));
+    return path;
+}
+
+int getProbability(const Dictionary *const dictionary, const std::vector<int> &word) {
+    return dictionary->getProbability(CodePointArrayView(word));
+}
+
+TEST(DictionaryOpenerTest, TestOpenDictionaries) {
+    char tempDirPath[] = "/tmp/dictionary_opener_test_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDirPath));
+    const std::vector<int> mainWord = { 'k', 'e', 'y' };
+    const std::vector<int> userWord = { 'h', 'e', 'l', 'l', 'o' };
+    const std::string mainPath = writeDictionary(tempDirPath, "main", mainWord);
+    const std::string userPath = writeDictionary(tempDirPath, "user", userWord);
+    const std::string missingPath = std::string(tempDirPath) + "/missing";
+
+    std::vector<DictionaryOpener::DictionaryFile> dictionaryFiles;
+    dictionaryFiles.emplace_back(mainPath.c_str(), 0 /* offset */, 0 /* size */,
+            false /* isUpdatable */);
+    dictionaryFiles.emplace_back(missingPath.c_str(), 0 /* offset */, 0 /* size */,
+            false /* isUpdatable */);
+    dictionaryFiles.emplace_back(userPath.c_str(), 0 /* offset */, 0 /* size */,
+            true /* isUpdatable */);
+    std::vector<std::unique_ptr<Dictionary>> dictionaries;
+    DictionaryOpener::openDictionaries(nullptr /* env */, dictionaryFiles, &dictionaries);
+
+    ASSERT_EQ(3u, dictionaries.size());
+    ASSERT_NE(nullptr, dictionaries[0].get());
+    EXPECT_NE(NOT_A_PROBABILITY, getProbability(dictionaries[0].get(), mainWord));
+    EXPECT_EQ(NOT_A_PROBABILITY, getProbability(dictionaries[0].get(), userWord));
+    EXPECT_EQ(nullptr, dictionaries[1].get());
+    ASSERT_NE(nullptr, dictionaries[2].get());
+    EXPECT_NE(NOT_A_PROBABILITY, getProbability(dictionaries[2].get(), userWord));
+
+    // The same dictionaries are opened one by one.
+    const std::unique_ptr<Dictionary> mainDictionary =
+            DictionaryOpener::openDictionary(nullptr /* env */, dictionaryFiles[0]);
+    ASSERT_NE(nullptr, mainDictionary.get());
+    EXPECT_EQ(getProbability(dictionaries[0].get(), mainWord),
+            getProbability(mainDictionary.get(), mainWord));
+    EXPECT_EQ(nullptr,
+            DictionaryOpener::openDictionary(nullptr /* env */, dictionaryFiles[1]).get());
+
+    dictionaries.clear();
+    EXPECT_TRUE(FileUtils::removeDirAndFiles(tempDirPath));
+}
+
+TEST(DictionaryOpenerTest, TestOpenSnapshot) {
+    char tempDirPath[] = "/tmp/dictionary_opener_test_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDirPath));
+    const std::vector<int> word = { 'h', 'e', 'l', 'l', 'o' };
+    const std::string path = writeDictionary(tempDirPath, "user", word);
+    const std::string gcPath = path + ".gc";
+
+    const std::unique_ptr<Dictionary> snapshot =
+            DictionaryOpener::openSnapshot(nullptr /* env */, path.c_str());
+    ASSERT_NE(nullptr, snapshot.get());
+    const int probability = getProbability(snapshot.get(), word);
+    EXPECT_NE(NOT_A_PROBABILITY, probability);
+    EXPECT_TRUE(snapshot->flushWithGC(gcPath.c_str()));
+
+    // GC wrote the result to the other file and left the snapshot's file as is.
+    for (const std::string &dictPath : { path, gcPath }) {
+        const std::unique_ptr<Dictionary> dictionary = DictionaryOpener::openDictionary(
+                nullptr /* env */, DictionaryOpener::DictionaryFile(dictPath.c_str(),
+                        0 /* offset */, 0 /* size */, false /* isUpdatable */));
+        ASSERT_NE(nullptr, dictionary.get()) << dictPath;
+        EXPECT_EQ(probability, getProbability(dictionary.get(), word)) << dictPath;
+    }
+    const std::string missingPath = std::string(tempDirPath) + "/missing";
+    EXPECT_EQ(nullptr, DictionaryOpener::openSnapshot(nullptr /* env */, missingPath.c_str()));
+
+    EXPECT_TRUE(FileUtils::removeDirAndFiles(tempDirPath));
+}
+
+TEST(DictionaryOpenerTest, TestSnapshotReplaysUpdateLog) {
+    char tempDirPath[] = "/tmp/dictionary_opener_test_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDirPath));
+    const std::vector<int> word = { 'h', 'e', 'l', 'l', 'o' };
+    const std::vector<int> learnedWord = { 'w', 'o', 'r', 'l', 'd' };
+    const std::string path = writeDictionary(tempDirPath, "user", word);
+    const std::string gcPath = path + ".gc";
+
+    {
+        const std::unique_ptr<Dictionary> dictionary = DictionaryOpener::openDictionary(
+                nullptr /* env */, DictionaryOpener::DictionaryFile(path.c_str(),
+                        0 /* offset */, 0 /* size */, true /* isUpdatable */));
+        ASSERT_NE(nullptr, dictionary.get());
+        DictionaryTestUtils::addUnigram(dictionary.get(), learnedWord);
+        ASSERT_TRUE(dictionary->flush(path.c_str()));
+    }
+    // Flushing has appended the word to the update log instead of writing the dictionary.
+    EXPECT_GT(FileUtils::getFileSize((path + "/update.log").c_str()), 0);
+
+    const std::unique_ptr<Dictionary> snapshot =
+            DictionaryOpener::openSnapshot(nullptr /* env */, path.c_str());
+    ASSERT_NE(nullptr, snapshot.get());
+    EXPECT_NE(NOT_A_PROBABILITY, getProbability(snapshot.get(), learnedWord));
+    EXPECT_TRUE(snapshot->flushWithGC(gcPath.c_str()));
+
+    const std::unique_ptr<Dictionary> gcDictionary = DictionaryOpener::openDictionary(
+            nullptr /* env */, DictionaryOpener::DictionaryFile(gcPath.c_str(), 0 /* offset */,
+                    0 /* size */, false /* isUpdatable */));
+    ASSERT_NE(nullptr, gcDictionary.get());
+    EXPECT_NE(NOT_A_PROBABILITY, getProbability(gcDictionary.get(), word));
+    EXPECT_NE(NOT_A_PROBABILITY, getProbability(gcDictionary.get(), learnedWord));
+    // The snapshot has left the log of the dictionary as is.
+    EXPECT_GT(FileUtils::getFileSize((path + "/update.log").c_str()), 0);
+
+    EXPECT_TRUE(FileUtils::removeDirAndFiles(tempDirPath));
+}
+
+}  // namespace
+}  // namespace latinime
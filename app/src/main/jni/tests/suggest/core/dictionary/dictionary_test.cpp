@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/dictionary.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/property/ngram_property.h"
+#include "dictionary/property/unigram_property.h"
+#include "suggest/core/layout/proximity_info.h"
+#include "suggest/core/result/suggested_word.h"
+#include "suggest/core/result/suggestion_results.h"
+#include "suggest/core/session/dic_traverse_session.h"
+#include "suggest/core/suggest_options.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "tests/suggest/core/layout/proximity_info_test_utils.h"
+#include "tests/utils/allocation_counter.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+void addNgram(Dictionary *const dictionary, const std::vector<int> &prevWord,
+        const std::vector<int> &word) {
+    const NgramContext ngramContext(prevWord.data(), static_cast<int>(prevWord.size()),
+            false /* isBeginningOfSentence */);
+    const NgramProperty ngramProperty(ngramContext, std::vector<int>(word), 100 /* probability */,
+            HistoricalInfo());
+    ASSERT_TRUE(dictionary->addNgramEntry(&ngramProperty));
+}
+
+TEST(DictionaryTest, TestPredictsMostProbableSuccessors) {
+    Dictionary dictionary(nullptr /* env */, DictionaryTestUtils::createPolicy(),
+            false /* usesLargeTraverseSessionCache */);
+    const std::vector<int> prevWord = { 't', 'h', 'e' };
+    DictionaryTestUtils::addUnigram(&dictionary, prevWord);
+    const NgramContext ngramContext(prevWord.data(), static_cast<int>(prevWord.size()),
+            false /* isBeginningOfSentence */);
+    // More successors than predictions, in a scrambled order of probabilities.
+    static const int SUCCESSOR_COUNT = 20;
+    for (int i = 0; i < SUCCESSOR_COUNT; ++i) {
+        const std::vector<int> successor = { 'a' + i };
+        DictionaryTestUtils::addUnigram(&dictionary, successor);
+        const NgramProperty ngramProperty(ngramContext, std::vector<int>(successor),
+                100 + (i * 7) % SUCCESSOR_COUNT /* probability */, HistoricalInfo());
+        ASSERT_TRUE(dictionary.addNgramEntry(&ngramProperty));
+    }
+
+    static const int MAX_SUGGESTION_COUNT = 3;
+    SuggestionResults suggestionResults(MAX_SUGGESTION_COUNT);
+    dictionary.getPredictions(&ngramContext, &suggestionResults);
+    std::vector<SuggestedWord> suggestedWords;
+    suggestionResults.getSuggestedWords(&suggestedWords);
+    ASSERT_EQ(static_cast<size_t>(MAX_SUGGESTION_COUNT), suggestedWords.size());
+    // Worst first. (i * 7) % 20 is 17, 18 and 19 for i = 11, 14 and 17.
+    EXPECT_EQ(std::vector<int>({ 'a' + 11 }), std::vector<int>(suggestedWords[0].getCodePoint(),
+            suggestedWords[0].getCodePoint() + suggestedWords[0].getCodePointCount()));
+    EXPECT_EQ('a' + 14, suggestedWords[1].getCodePoint()[0]);
+    EXPECT_EQ('a' + 17, suggestedWords[2].getCodePoint()[0]);
+    EXPECT_GT(suggestedWords[1].getScore(), suggestedWords[0].getScore());
+    EXPECT_GT(suggestedWords[2].getScore(), suggestedWords[1].getScore());
+}
+
+TEST(DictionaryTest, TestFailedFlushWithGCKeepsServingReads) {
+    const std::unique_ptr<Dictionary> dictionary =
+            DictionaryTestUtils::createDictionaryWithReplica();
+    const std::vector<int> word = { 'k', 'e', 'y' };
+    DictionaryTestUtils::addUnigram(dictionary.get(), word);
+    ASSERT_NE(NOT_A_PROBABILITY, dictionary->getProbability(CodePointArrayView(word)));
+    EXPECT_FALSE(dictionary->flushWithGC("/nonexistent/dictionary/dir"));
+    // GC may have changed the replica before failing, so the updates are refused until the
+    // dictionary is reopened (see BinaryDictionary.flushWithGC()), but the reads go on.
+    EXPECT_NE(NOT_A_PROBABILITY, dictionary->getProbability(CodePointArrayView(word)));
+    const UnigramProperty unigramProperty = DictionaryTestUtils::createUnigramProperty();
+    const std::vector<int> otherWord = { 'k', 'e', 'y', 's' };
+    EXPECT_FALSE(dictionary->addUnigramEntry(CodePointArrayView(otherWord), &unigramProperty));
+    EXPECT_FALSE(dictionary->flushWithGC("/nonexistent/dictionary/dir"));
+}
+
+TEST(DictionaryTest, TestGetSuggestionsDoesNotAllocate) {
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary();
+    static const char *const WORDS[] = { "the", "they", "then", "there", "keyboard", "key",
+            "kept", "ketchup", "keys" };
+    for (const char *const word : WORDS) {
+        DictionaryTestUtils::addUnigram(dictionary.get(), DictionaryTestUtils::toCodePoints(word));
+    }
+    const std::unique_ptr<ProximityInfo> proximityInfo =
+            ProximityInfoTestUtils::createQwertyProximityInfo();
+    static const char *const INPUT = "keyboard";
+    static const int INPUT_SIZE = 8;
+    int codePoints[INPUT_SIZE];
+    int xs[INPUT_SIZE];
+    int ys[INPUT_SIZE];
+    int times[INPUT_SIZE];
+    int pointerIds[INPUT_SIZE] = {};
+    for (int i = 0; i < INPUT_SIZE; ++i) {
+        codePoints[i] = INPUT[i];
+        ASSERT_TRUE(ProximityInfoTestUtils::getKeyCenter(proximityInfo.get(), codePoints[i],
+                &xs[i], &ys[i]));
+        times[i] = i * 100;
+    }
+    // See SuggestOptions. The weight for the locale is in thousands.
+    int options[] = { 0 /* isGesture */, 0 /* useFullEditDistance */,
+            0 /* blockOffensiveWords */, 0 /* spaceAwareGesture */, 1000 /* weightForLocale */ };
+    const SuggestOptions suggestOptions(options, NELEMS(options));
+    const NgramContext ngramContext;
+    DicTraverseSession session(false /* usesLargeCache */);
+
+    // Every prefix twice, as the keyboard does while typing: the first round sizes the session
+    // buffers and the second one must reuse them.
+    for (int round = 0; round < 2; ++round) {
+        for (int inputSize = 1; inputSize <= INPUT_SIZE; ++inputSize) {
+            SuggestionResults suggestionResults(MAX_RESULTS);
+            const AllocationCounter allocationCounter;
+            dictionary->getSuggestions(proximityInfo.get(), &session, xs, ys, times, pointerIds,
+                    codePoints, inputSize, &ngramContext, &suggestOptions,
+                    NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL, &suggestionResults);
+            if (round > 0) {
+                EXPECT_EQ(0, allocationCounter.getAllocationCount()) << "inputSize " << inputSize;
+            }
+        }
+    }
+    SuggestionResults suggestionResults(MAX_RESULTS);
+    dictionary->getSuggestions(proximityInfo.get(), &session, xs, ys, times, pointerIds,
+            codePoints, INPUT_SIZE, &ngramContext, &suggestOptions,
+            NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL, &suggestionResults);
+    std::vector<SuggestedWord> suggestedWords;
+    suggestionResults.getSuggestedWords(&suggestedWords);
+    ASSERT_FALSE(suggestedWords.empty());
+    // Worst first.
+    const SuggestedWord &bestWord = suggestedWords.back();
+    EXPECT_EQ(std::vector<int>(codePoints, codePoints + INPUT_SIZE),
+            std::vector<int>(bestWord.getCodePoint(),
+                    bestWord.getCodePoint() + bestWord.getCodePointCount()));
+}
+
+// Types the input on the QWERTY keyboard of ProximityInfoTestUtils and returns the suggested
+// words with their scores, best first.
+std::vector<std::pair<std::vector<int>, int>> getTypingSuggestions(
+        const Dictionary *const dictionary, DicTraverseSession *const session,
+        const ProximityInfo *const proximityInfo, const char *const input, const int inputSize) {
+    int codePoints[MAX_WORD_LENGTH];
+    int xs[MAX_WORD_LENGTH];
+    int ys[MAX_WORD_LENGTH];
+    int times[MAX_WORD_LENGTH];
+    int pointerIds[MAX_WORD_LENGTH] = {};
+    for (int i = 0; i < inputSize; ++i) {
+        codePoints[i] = input[i];
+        EXPECT_TRUE(ProximityInfoTestUtils::getKeyCenter(proximityInfo, codePoints[i], &xs[i],
+                &ys[i]));
+        times[i] = i * 100;
+    }
+    int options[] = { 0 /* isGesture */, 0 /* useFullEditDistance */,
+            0 /* blockOffensiveWords */, 0 /* spaceAwareGesture */, 1000 /* weightForLocale */ };
+    const SuggestOptions suggestOptions(options, NELEMS(options));
+    const NgramContext ngramContext;
+    SuggestionResults suggestionResults(MAX_RESULTS);
+    dictionary->getSuggestions(const_cast<ProximityInfo *>(proximityInfo), session, xs, ys, times,
+            pointerIds, codePoints, inputSize, &ngramContext, &suggestOptions,
+            NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL, &suggestionResults);
+    std::vector<SuggestedWord> suggestedWords;
+    suggestionResults.getSuggestedWords(&suggestedWords);
+    std::vector<std::pair<std::vector<int>, int>> suggestions;
+    // Worst first.
+    for (auto it = suggestedWords.rbegin(); it != suggestedWords.rend(); ++it) {
+        suggestions.emplace_back(std::vector<int>(it->getCodePoint(),
+                it->getCodePoint() + it->getCodePointCount()), it->getScore());
+    }
+    return suggestions;
+}
+
+TEST(DictionaryTest, TestContinuedSearchMatchesNewSearch) {
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary();
+    static const char *const WORDS[] = { "the", "then", "there", "their", "these", "thesis",
+            "key", "keyboard", "keyboards", "keys", "kept", "board", "boards", "hello",
+            "help", "helped", "helps", "word", "words", "world", "worlds" };
+    for (const char *const word : WORDS) {
+        DictionaryTestUtils::addUnigram(dictionary.get(), DictionaryTestUtils::toCodePoints(word));
+    }
+    const std::unique_ptr<ProximityInfo> proximityInfo =
+            ProximityInfoTestUtils::createQwertyProximityInfo();
+    // Transpositions, insertions and extra letters past the end of the words.
+    static const char *const INPUTS[] = { "keybaords", "thsesiss", "helloooo", "wrolsdd",
+            "theree" };
+    for (const char *const input : INPUTS) {
+        DicTraverseSession continuedSession(false /* usesLargeCache */);
+        for (int inputSize = 1; inputSize <= static_cast<int>(strlen(input)); ++inputSize) {
+            DicTraverseSession newSession(false /* usesLargeCache */);
+            EXPECT_EQ(getTypingSuggestions(dictionary.get(), &newSession, proximityInfo.get(),
+                            input, inputSize),
+                    getTypingSuggestions(dictionary.get(), &continuedSession,
+                            proximityInfo.get(), input, inputSize))
+                    << input << " inputSize " << inputSize;
+        }
+    }
+}
+
+TEST(DictionaryTest, TestCachedCompletionsFollowUpdates) {
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary();
+    static const char *const WORDS[] = { "key", "keyboard", "keyboards", "keys", "kept",
+            "ketchup", "the", "then" };
+    for (const char *const word : WORDS) {
+        DictionaryTestUtils::addUnigram(dictionary.get(), DictionaryTestUtils::toCodePoints(word));
+    }
+    const std::unique_ptr<ProximityInfo> proximityInfo =
+            ProximityInfoTestUtils::createQwertyProximityInfo();
+    DicTraverseSession session(false /* usesLargeCache */);
+    const std::vector<std::pair<std::vector<int>, int>> suggestions = getTypingSuggestions(
+            dictionary.get(), &session, proximityInfo.get(), "ke", 2 /* inputSize */);
+    EXPECT_LT(0, dictionary->getCompletionCache()->getEntryCount());
+    DicTraverseSession otherSession(false /* usesLargeCache */);
+    EXPECT_EQ(suggestions, getTypingSuggestions(dictionary.get(), &otherSession,
+            proximityInfo.get(), "ke", 2 /* inputSize */));
+
+    const std::vector<int> newWord = { 'k', 'e', 'y', 'e', 'd' };
+    DictionaryTestUtils::addUnigram(dictionary.get(), newWord);
+    bool hasNewWord = false;
+    for (const auto &suggestion : getTypingSuggestions(dictionary.get(), &session,
+            proximityInfo.get(), "ke", 2 /* inputSize */)) {
+        hasNewWord |= suggestion.first == newWord;
+    }
+    EXPECT_TRUE(hasNewWord);
+}
+
+TEST(DictionaryTest, TestGetPredictionsDoesNotAllocate) {
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary();
+    const std::vector<int> prevWord = { 't', 'h', 'e' };
+    DictionaryTestUtils::addUnigram(dictionary.get(), prevWord);
+    for (int i = 0; i < 10; ++i) {
+        const std::vector<int> successor = { 'a' + i, 'b' };
+        DictionaryTestUtils::addUnigram(dictionary.get(), successor);
+        addNgram(dictionary.get(), prevWord, successor);
+    }
+    const NgramContext ngramContext(prevWord.data(), static_cast<int>(prevWord.size()),
+            false /* isBeginningOfSentence */);
+    static const int MAX_SUGGESTION_COUNT = 3;
+    {
+        // Fills the caches of the dictionary.
+        SuggestionResults suggestionResults(MAX_SUGGESTION_COUNT);
+        dictionary->getPredictions(&ngramContext, &suggestionResults);
+    }
+    SuggestionResults suggestionResults(MAX_SUGGESTION_COUNT);
+    const AllocationCounter allocationCounter;
+    dictionary->getPredictions(&ngramContext, &suggestionResults);
+    EXPECT_EQ(0, allocationCounter.getAllocationCount());
+    EXPECT_EQ(MAX_SUGGESTION_COUNT, suggestionResults.getSuggestionCount());
+}
+
+TEST(DictionaryTest, TestConcurrentLookups) {
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary();
+    static const int WORD_COUNT = 200;
+    std::vector<std::vector<int>> words;
+    for (int i = 0; i < WORD_COUNT; ++i) {
+        words.push_back({ 'a' + i % 26, 'a' + (i / 26) % 26, 'k' });
+        DictionaryTestUtils::addUnigram(dictionary.get(), words.back());
+    }
+    for (int i = 1; i < WORD_COUNT; ++i) {
+        addNgram(dictionary.get(), words[i - 1], words[i]);
+    }
+    const std::vector<int> unknownWord = { 'z', 'z', 'z', 'z' };
+    words.push_back(unknownWord);
+
+    struct Probabilities {
+        int mProbability;
+        int mMaxProbabilityOfExactMatches;
+        int mNgramProbability;
+        bool operator==(const Probabilities &other) const {
+            return mProbability == other.mProbability
+                    && mMaxProbabilityOfExactMatches == other.mMaxProbabilityOfExactMatches
+                    && mNgramProbability == other.mNgramProbability;
+        }
+    };
+    const auto lookUp = [&dictionary, &words](const int index) {
+        const CodePointArrayView codePoints(words[index]);
+        const std::vector<int> &prevWord = words[index == 0 ? words.size() - 1 : index - 1];
+        const NgramContext ngramContext(prevWord.data(), static_cast<int>(prevWord.size()),
+                false /* isBeginningOfSentence */);
+        return Probabilities{ dictionary->getProbability(codePoints),
+                dictionary->getMaxProbabilityOfExactMatches(codePoints),
+                dictionary->getNgramProbability(&ngramContext, codePoints) };
+    };
+    std::vector<Probabilities> expectedProbabilities;
+    for (int i = 0; i < static_cast<int>(words.size()); ++i) {
+        expectedProbabilities.push_back(lookUp(i));
+    }
+    EXPECT_NE(NOT_A_PROBABILITY, expectedProbabilities[1].mNgramProbability);
+    EXPECT_EQ(NOT_A_PROBABILITY, expectedProbabilities.back().mProbability);
+
+    static const int THREAD_COUNT = 4;
+    static const int ROUND_COUNT = 50;
+    int mismatchCounts[THREAD_COUNT] = {};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < ROUND_COUNT; ++round) {
+                for (int i = 0; i < static_cast<int>(words.size()); ++i) {
+                    // Each thread walks the words from a different offset.
+                    const int index = (i + t * WORD_COUNT / THREAD_COUNT)
+                            % static_cast<int>(words.size());
+                    if (!(lookUp(index) == expectedProbabilities[index])) {
+                        ++mismatchCounts[t];
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < THREAD_COUNT; ++t) {
+        EXPECT_EQ(0, mismatchCounts[t]) << "thread " << t;
+    }
+    EXPECT_FALSE(dictionary->getDictionaryStructurePolicy()->isCorrupted());
+}
+
+}  // namespace
+}  // namespace latinime
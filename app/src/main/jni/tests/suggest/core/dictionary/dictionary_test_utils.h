@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_DICTIONARY_TEST_UTILS_H
+#define LATINIME_DICTIONARY_TEST_UTILS_H
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "dictionary/property/historical_info.h"
+#include "dictionary/property/unigram_property.h"
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/utils/format_utils.h"
+#include "suggest/core/dictionary/dictionary.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+// Empty on-memory "en" dictionaries of the updatable format, and the words the tests add to them.
+class DictionaryTestUtils {
+ public:
+    static constexpr int DEFAULT_PROBABILITY = 100;
+
+    static DictionaryStructureWithBufferPolicy::StructurePolicyPtr createPolicy(
+            const int formatVersion = FormatUtils::VERSION_403) {
+        const std::vector<int> locale = { 'e', 'n' };
+        const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+        return DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
+                formatVersion, locale, &attributeMap);
+    }
+
+    static std::unique_ptr<Dictionary> createDictionary() {
+        return std::unique_ptr<Dictionary>(new Dictionary(nullptr /* env */, createPolicy(),
+                false /* usesLargeTraverseSessionCache */));
+    }
+
+    // The words have DEFAULT_PROBABILITY.
+    static std::unique_ptr<Dictionary> createDictionary(const std::vector<const char *> &words) {
+        std::unique_ptr<Dictionary> dictionary = createDictionary();
+        for (const char *const word : words) {
+            addUnigram(dictionary.get(), toCodePoints(word));
+        }
+        return dictionary;
+    }
+
+    // The policies are updated alike, so they are created empty.
+    static std::unique_ptr<Dictionary> createDictionaryWithReplica() {
+        return std::unique_ptr<Dictionary>(new Dictionary(nullptr /* env */, createPolicy(),
+                createPolicy(), false /* usesLargeTraverseSessionCache */));
+    }
+
+    // A word without any flag.
+    static UnigramProperty createUnigramProperty(const int probability = DEFAULT_PROBABILITY) {
+        return UnigramProperty(false /* representsBeginningOfSentence */, false /* isNotAWord */,
+                false /* isPossiblyOffensive */, probability, HistoricalInfo());
+    }
+
+    static void addUnigram(DictionaryStructureWithBufferPolicy *const policy,
+            const std::vector<int> &word, const int probability = DEFAULT_PROBABILITY) {
+        const UnigramProperty unigramProperty = createUnigramProperty(probability);
+        ASSERT_TRUE(policy->addUnigramEntry(CodePointArrayView(word), &unigramProperty));
+    }
+
+    static void addUnigram(Dictionary *const dictionary, const std::vector<int> &word,
+            const int probability = DEFAULT_PROBABILITY) {
+        const UnigramProperty unigramProperty = createUnigramProperty(probability);
+        ASSERT_TRUE(dictionary->addUnigramEntry(CodePointArrayView(word), &unigramProperty));
+    }
+
+    static std::vector<int> toCodePoints(const char *const word) {
+        return std::vector<int>(word, word + strlen(word));
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(DictionaryTestUtils);
+};
+} // namespace latinime
+#endif // LATINIME_DICTIONARY_TEST_UTILS_H
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/dictionary_update_log.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "dictionary/property/historical_info.h"
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/property/ngram_property.h"
+#include "dictionary/property/unigram_property.h"
+#include "dictionary/utils/file_utils.h"
+#include "suggest/core/dictionary/dictionary.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// Applies the updates to the dictionary and logs them, as Dictionary does while its log is open.
+class LoggedDictionary {
+ public:
+    explicit LoggedDictionary(const char *const dictDirPath)
+            : mDictDirPath(dictDirPath), mDictionary(DictionaryTestUtils::createDictionary()),
+              mUpdateLog() {
+        mUpdateLog.openAndReplay(dictDirPath, mDictionary.get());
+    }
+
+    const Dictionary *getDictionary() const {
+        return mDictionary.get();
+    }
+
+    void addUnigram(const char *const word, const int probability) {
+        const std::vector<int> codePoints = DictionaryTestUtils::toCodePoints(word);
+        const UnigramProperty unigramProperty =
+                DictionaryTestUtils::createUnigramProperty(probability);
+        ASSERT_TRUE(mDictionary->addUnigramEntry(CodePointArrayView(codePoints),
+                &unigramProperty));
+        mUpdateLog.logAddUnigramEntry(CodePointArrayView(codePoints), &unigramProperty);
+    }
+
+    void removeUnigram(const char *const word) {
+        const std::vector<int> codePoints = DictionaryTestUtils::toCodePoints(word);
+        ASSERT_TRUE(mDictionary->removeUnigramEntry(CodePointArrayView(codePoints)));
+        mUpdateLog.logRemoveUnigramEntry(CodePointArrayView(codePoints));
+    }
+
+    void addBigram(const char *const prevWord, const char *const word, const int probability) {
+        const NgramProperty ngramProperty(createNgramContext(prevWord),
+                DictionaryTestUtils::toCodePoints(word), probability, HistoricalInfo());
+        ASSERT_TRUE(mDictionary->addNgramEntry(&ngramProperty));
+        mUpdateLog.logAddNgramEntry(&ngramProperty);
+    }
+
+    void removeBigram(const char *const prevWord, const char *const word) {
+        const NgramContext ngramContext = createNgramContext(prevWord);
+        const std::vector<int> codePoints = DictionaryTestUtils::toCodePoints(word);
+        ASSERT_TRUE(mDictionary->removeNgramEntry(&ngramContext, CodePointArrayView(codePoints)));
+        mUpdateLog.logRemoveNgramEntry(&ngramContext, CodePointArrayView(codePoints));
+    }
+
+    // Appends the updates logged since the last flush to the log file.
+    void flush() {
+        std::vector<int32_t> records;
+        ASSERT_TRUE(mUpdateLog.takePendingRecords(mDictDirPath.c_str(), &records));
+        ASSERT_TRUE(mUpdateLog.appendRecords(records));
+    }
+
+    static NgramContext createNgramContext(const char *const prevWord) {
+        const std::vector<int> codePoints = DictionaryTestUtils::toCodePoints(prevWord);
+        return NgramContext(codePoints.data(), static_cast<int>(codePoints.size()),
+                false /* isBeginningOfSentence */);
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(LoggedDictionary);
+
+    const std::string mDictDirPath;
+    const std::unique_ptr<Dictionary> mDictionary;
+    DictionaryUpdateLog mUpdateLog;
+};
+
+int getProbability(const Dictionary *const dictionary, const char *const word) {
+    return dictionary->getProbability(
+            CodePointArrayView(DictionaryTestUtils::toCodePoints(word)));
+}
+
+int getBigramProbability(const Dictionary *const dictionary, const char *const prevWord,
+        const char *const word) {
+    const NgramContext ngramContext = LoggedDictionary::createNgramContext(prevWord);
+    return dictionary->getNgramProbability(&ngramContext,
+            CodePointArrayView(DictionaryTestUtils::toCodePoints(word)));
+}
+
+std::string getLogFilePath(const char *const dictDirPath) {
+    return std::string(dictDirPath) + "/update.log";
+}
+
+// Overwrites the int32 word at wordIndex of the file.
+void overwriteWord(const std::string &filePath, const int wordIndex, const int32_t value) {
+    FILE *const file = fopen(filePath.c_str(), "r+b");
+    ASSERT_NE(nullptr, file);
+    EXPECT_EQ(0, fseek(file, wordIndex * sizeof(int32_t), SEEK_SET));
+    EXPECT_EQ(1u, fwrite(&value, sizeof(int32_t), 1 /* count */, file));
+    fclose(file);
+}
+
+TEST(DictionaryUpdateLogTest, TestReplaysRecords) {
+    char tempDirPath[] = "/tmp/dictionary_update_log_test_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDirPath));
+    LoggedDictionary loggedDictionary(tempDirPath);
+    loggedDictionary.addUnigram("the", 150);
+    loggedDictionary.addUnigram("cat", 120);
+    loggedDictionary.addUnigram("dog", 110);
+    loggedDictionary.addUnigram("hat", 100);
+    loggedDictionary.flush();
+    loggedDictionary.addBigram("the", "cat", 180);
+    loggedDictionary.addBigram("the", "hat", 170);
+    loggedDictionary.removeUnigram("dog");
+    loggedDictionary.removeBigram("the", "hat");
+    loggedDictionary.flush();
+
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary();
+    DictionaryUpdateLog::replay(tempDirPath, dictionary.get());
+    const Dictionary *const expectedDictionary = loggedDictionary.getDictionary();
+    for (const char *const word : { "the", "cat", "dog", "hat" }) {
+        EXPECT_EQ(getProbability(expectedDictionary, word), getProbability(dictionary.get(), word))
+                << word;
+    }
+    EXPECT_NE(NOT_A_PROBABILITY, getProbability(dictionary.get(), "the"));
+    EXPECT_NE(NOT_A_PROBABILITY, getProbability(dictionary.get(), "hat"));
+    EXPECT_EQ(NOT_A_PROBABILITY, getProbability(dictionary.get(), "dog"));
+    for (const char *const word : { "cat", "hat" }) {
+        EXPECT_EQ(getBigramProbability(expectedDictionary, "the", word),
+                getBigramProbability(dictionary.get(), "the", word)) << word;
+    }
+    EXPECT_NE(getProbability(dictionary.get(), "cat"),
+            getBigramProbability(dictionary.get(), "the", "cat"));
+    EXPECT_EQ(NOT_A_PROBABILITY, getBigramProbability(dictionary.get(), "the", "hat"));
+
+    EXPECT_TRUE(FileUtils::removeDirAndFiles(tempDirPath));
+}
+
+TEST(DictionaryUpdateLogTest, TestDropsTruncatedTail) {
+    char tempDirPath[] = "/tmp/dictionary_update_log_test_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDirPath));
+    const std::string logFilePath = getLogFilePath(tempDirPath);
+    int validSize = 0;
+    {
+        LoggedDictionary loggedDictionary(tempDirPath);
+        loggedDictionary.addUnigram("the", 150);
+        loggedDictionary.flush();
+        validSize = FileUtils::getFileSize(logFilePath.c_str());
+        ASSERT_GT(validSize, 0);
+        loggedDictionary.addUnigram("cat", 120);
+        loggedDictionary.flush();
+    }
+    // As if appending "cat" had been interrupted.
+    const int fileSize = FileUtils::getFileSize(logFilePath.c_str());
+    ASSERT_EQ(0, truncate(logFilePath.c_str(), fileSize - sizeof(int32_t)));
+
+    {
+        LoggedDictionary loggedDictionary(tempDirPath);
+        EXPECT_NE(NOT_A_PROBABILITY, getProbability(loggedDictionary.getDictionary(), "the"));
+        EXPECT_EQ(NOT_A_PROBABILITY, getProbability(loggedDictionary.getDictionary(), "cat"));
+        // The torn record has been dropped from the file, so the next records can be replayed.
+        EXPECT_EQ(validSize, FileUtils::getFileSize(logFilePath.c_str()));
+        loggedDictionary.addUnigram("dog", 110);
+        loggedDictionary.flush();
+    }
+
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary();
+    DictionaryUpdateLog::replay(tempDirPath, dictionary.get());
+    EXPECT_NE(NOT_A_PROBABILITY, getProbability(dictionary.get(), "the"));
+    EXPECT_EQ(NOT_A_PROBABILITY, getProbability(dictionary.get(), "cat"));
+    EXPECT_NE(NOT_A_PROBABILITY, getProbability(dictionary.get(), "dog"));
+
+    EXPECT_TRUE(FileUtils::removeDirAndFiles(tempDirPath));
+}
+
+TEST(DictionaryUpdateLogTest, TestStopsAtCorruptRecord) {
+    char tempDirPath[] = "/tmp/dictionary_update_log_test_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDirPath));
+    const std::string logFilePath = getLogFilePath(tempDirPath);
+    int validSize = 0;
+    {
+        LoggedDictionary loggedDictionary(tempDirPath);
+        loggedDictionary.addUnigram("the", 150);
+        loggedDictionary.flush();
+        validSize = FileUtils::getFileSize(logFilePath.c_str());
+        loggedDictionary.addUnigram("cat", 120);
+        loggedDictionary.addUnigram("dog", 110);
+        loggedDictionary.flush();
+    }
+    // The record of "cat" starts with the payload size, the type and the code point count, so
+    // this changes its first code point, which doesn't match the checksum anymore.
+    const int fileSize = FileUtils::getFileSize(logFilePath.c_str());
+    overwriteWord(logFilePath, validSize / sizeof(int32_t) + 3, 'b');
+
+    // The records after the corrupt one are dropped as well, since they may depend on it.
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary();
+    DictionaryUpdateLog::replay(tempDirPath, dictionary.get());
+    EXPECT_NE(NOT_A_PROBABILITY, getProbability(dictionary.get(), "the"));
+    EXPECT_EQ(NOT_A_PROBABILITY, getProbability(dictionary.get(), "cat"));
+    EXPECT_EQ(NOT_A_PROBABILITY, getProbability(dictionary.get(), "bat"));
+    EXPECT_EQ(NOT_A_PROBABILITY, getProbability(dictionary.get(), "dog"));
+    // Only opening the log drops the corrupt records from the file.
+    EXPECT_EQ(fileSize, FileUtils::getFileSize(logFilePath.c_str()));
+    {
+        LoggedDictionary loggedDictionary(tempDirPath);
+        EXPECT_NE(NOT_A_PROBABILITY, getProbability(loggedDictionary.getDictionary(), "the"));
+        EXPECT_EQ(NOT_A_PROBABILITY, getProbability(loggedDictionary.getDictionary(), "dog"));
+    }
+    EXPECT_EQ(validSize, FileUtils::getFileSize(logFilePath.c_str()));
+
+    EXPECT_TRUE(FileUtils::removeDirAndFiles(tempDirPath));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/dictionary_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "dictionary/property/unigram_property.h"
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/utils/format_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+TEST(DictionaryUtilsTest, TestPrefaultTopLevels) {
+    const std::vector<int> locale = { 'e', 'n' };
+    const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy =
+            DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
+                    FormatUtils::VERSION_403, locale, &attributeMap);
+    ASSERT_NE(nullptr, policy.get());
+    const std::vector<std::vector<int>> words = {
+            { 'a' }, { 'a', 'n' }, { 'a', 'n', 'd' }, { 'a', 'n', 'd', 'y' }, { 't', 'h', 'e' },
+            { 't', 'h', 'e', 'r', 'e' } };
+    for (const auto &word : words) {
+        const UnigramProperty unigramProperty(false /* representsBeginningOfSentence */,
+                false /* isNotAWord */, false /* isPossiblyOffensive */, 100 /* probability */,
+                HistoricalInfo());
+        ASSERT_TRUE(policy->addUnigramEntry(CodePointArrayView(word), &unigramProperty));
+    }
+    EXPECT_EQ(0, DictionaryUtils::prefaultTopLevels(policy.get(), 0 /* codePointDepth */));
+    EXPECT_EQ(1, DictionaryUtils::prefaultTopLevels(policy.get(), 1 /* codePointDepth */));
+    EXPECT_EQ(4, DictionaryUtils::prefaultTopLevels(policy.get(), 3 /* codePointDepth */));
+    EXPECT_EQ(6, DictionaryUtils::prefaultTopLevels(policy.get(), MAX_WORD_LENGTH));
+}
+
+}  // namespace
+}  // namespace latinime
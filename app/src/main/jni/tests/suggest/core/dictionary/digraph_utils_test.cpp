@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/digraph_utils.h"
+
+#include <gtest/gtest.h>
+
+namespace latinime {
+namespace {
+
+TEST(DigraphUtilsTest, TestHasDigraphForCodePoint) {
+    const DigraphUtils::DigraphType germanUmlaut = DigraphUtils::DIGRAPH_TYPE_GERMAN_UMLAUT;
+    EXPECT_TRUE(DigraphUtils::hasDigraphForCodePoint(germanUmlaut,
+            0xE4 /* LATIN SMALL LETTER A WITH DIAERESIS */));
+    EXPECT_TRUE(DigraphUtils::hasDigraphForCodePoint(germanUmlaut,
+            0xD6 /* LATIN CAPITAL LETTER O WITH DIAERESIS */));
+    EXPECT_TRUE(DigraphUtils::hasDigraphForCodePoint(germanUmlaut,
+            0xFC /* LATIN SMALL LETTER U WITH DIAERESIS */));
+    EXPECT_FALSE(DigraphUtils::hasDigraphForCodePoint(germanUmlaut, 'a'));
+    EXPECT_FALSE(DigraphUtils::hasDigraphForCodePoint(germanUmlaut,
+            0xEB /* LATIN SMALL LETTER E WITH DIAERESIS */));
+    EXPECT_FALSE(DigraphUtils::hasDigraphForCodePoint(germanUmlaut,
+            0x4E4 /* CYRILLIC SMALL LETTER I WITH DIAERESIS */));
+    EXPECT_FALSE(DigraphUtils::hasDigraphForCodePoint(germanUmlaut, NOT_A_CODE_POINT));
+    EXPECT_FALSE(DigraphUtils::hasDigraphForCodePoint(DigraphUtils::DIGRAPH_TYPE_NONE,
+            0xE4 /* LATIN SMALL LETTER A WITH DIAERESIS */));
+}
+
+TEST(DigraphUtilsTest, TestGetDigraphCodePointForIndex) {
+    EXPECT_EQ('o', DigraphUtils::getDigraphCodePointForIndex(
+            0xD6 /* LATIN CAPITAL LETTER O WITH DIAERESIS */,
+            DigraphUtils::FIRST_DIGRAPH_CODEPOINT));
+    EXPECT_EQ('e', DigraphUtils::getDigraphCodePointForIndex(
+            0xF6 /* LATIN SMALL LETTER O WITH DIAERESIS */,
+            DigraphUtils::SECOND_DIGRAPH_CODEPOINT));
+    EXPECT_EQ(NOT_A_CODE_POINT, DigraphUtils::getDigraphCodePointForIndex('o',
+            DigraphUtils::FIRST_DIGRAPH_CODEPOINT));
+    EXPECT_EQ(NOT_A_CODE_POINT, DigraphUtils::getDigraphCodePointForIndex(
+            0xF6 /* LATIN SMALL LETTER O WITH DIAERESIS */, DigraphUtils::NOT_A_DIGRAPH_INDEX));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/prediction_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "suggest/core/result/suggestion_results.h"
+#include "utils/int_array_view.h"
+#include "utils/time_keeper.h"
+
+namespace latinime {
+namespace {
+
+static const int MAX_SUGGESTION_COUNT = 3;
+static const int PREV_WORD_ID = 10;
+static const int OTHER_PREV_WORD_ID = 11;
+static const int TARGET_WORD_ID = 20;
+static const int OTHER_WORD_ID = 30;
+
+void putPredictions(PredictionCache *const cache, const int prevWordId) {
+    SuggestionResults suggestionResults(MAX_SUGGESTION_COUNT);
+    const int codePoints[] = { 'a', 'b' };
+    suggestionResults.addPrediction(codePoints, 2 /* codePointCount */, 100 /* probability */);
+    const std::vector<int> visitedWordIds = { TARGET_WORD_ID };
+    cache->putPredictions(WordIdArrayView::singleElementView(&prevWordId),
+            false /* isBeginningOfSentence */, visitedWordIds, &suggestionResults);
+}
+
+bool hasPredictions(const PredictionCache *const cache, const int prevWordId,
+        const int maxSuggestionCount) {
+    SuggestionResults suggestionResults(maxSuggestionCount);
+    const bool isHit = cache->getPredictions(WordIdArrayView::singleElementView(&prevWordId),
+            false /* isBeginningOfSentence */, &suggestionResults);
+    EXPECT_EQ(isHit ? 1 : 0, suggestionResults.getSuggestionCount());
+    return isHit;
+}
+
+class PredictionCacheTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        TimeKeeper::startTestModeWithForceCurrentTime(1000);
+    }
+
+    void TearDown() override {
+        TimeKeeper::stopTestMode();
+    }
+};
+
+TEST_F(PredictionCacheTest, TestGetAndPut) {
+    PredictionCache cache;
+    EXPECT_FALSE(hasPredictions(&cache, PREV_WORD_ID, MAX_SUGGESTION_COUNT));
+    putPredictions(&cache, PREV_WORD_ID);
+    EXPECT_TRUE(hasPredictions(&cache, PREV_WORD_ID, MAX_SUGGESTION_COUNT));
+    EXPECT_TRUE(hasPredictions(&cache, PREV_WORD_ID, MAX_SUGGESTION_COUNT - 1));
+    // More predictions than cached are requested.
+    EXPECT_FALSE(hasPredictions(&cache, PREV_WORD_ID, MAX_SUGGESTION_COUNT + 1));
+    EXPECT_FALSE(hasPredictions(&cache, OTHER_PREV_WORD_ID, MAX_SUGGESTION_COUNT));
+    // Different beginning-of-sentence state.
+    SuggestionResults suggestionResults(MAX_SUGGESTION_COUNT);
+    EXPECT_FALSE(cache.getPredictions(WordIdArrayView::singleElementView(&PREV_WORD_ID),
+            true /* isBeginningOfSentence */, &suggestionResults));
+}
+
+TEST_F(PredictionCacheTest, TestInvalidation) {
+    PredictionCache cache;
+    putPredictions(&cache, PREV_WORD_ID);
+    putPredictions(&cache, OTHER_PREV_WORD_ID);
+    EXPECT_EQ(2, cache.getEntryCount());
+
+    cache.invalidateEntriesForWord(OTHER_WORD_ID);
+    EXPECT_EQ(2, cache.getEntryCount());
+    cache.invalidateEntriesForPrevWord(PREV_WORD_ID);
+    EXPECT_FALSE(hasPredictions(&cache, PREV_WORD_ID, MAX_SUGGESTION_COUNT));
+    EXPECT_TRUE(hasPredictions(&cache, OTHER_PREV_WORD_ID, MAX_SUGGESTION_COUNT));
+
+    putPredictions(&cache, PREV_WORD_ID);
+    // Both entries visited the target word.
+    cache.invalidateEntriesForWord(TARGET_WORD_ID);
+    EXPECT_EQ(0, cache.getEntryCount());
+
+    putPredictions(&cache, PREV_WORD_ID);
+    cache.invalidateEntriesForWord(PREV_WORD_ID);
+    EXPECT_EQ(0, cache.getEntryCount());
+
+    putPredictions(&cache, PREV_WORD_ID);
+    cache.clear();
+    EXPECT_EQ(0, cache.getEntryCount());
+}
+
+TEST_F(PredictionCacheTest, TestExpiration) {
+    PredictionCache cache;
+    putPredictions(&cache, PREV_WORD_ID);
+    TimeKeeper::startTestModeWithForceCurrentTime(1000 + 24 * 60 * 60);
+    EXPECT_FALSE(hasPredictions(&cache, PREV_WORD_ID, MAX_SUGGESTION_COUNT));
+    EXPECT_EQ(0, cache.getEntryCount());
+}
+
+TEST_F(PredictionCacheTest, TestEviction) {
+    static const int ENTRY_COUNT = 100;
+    PredictionCache cache;
+    for (int i = 0; i < ENTRY_COUNT; ++i) {
+        putPredictions(&cache, i);
+        // Keep the first entry in use.
+        EXPECT_TRUE(hasPredictions(&cache, 0, MAX_SUGGESTION_COUNT));
+    }
+    EXPECT_GT(ENTRY_COUNT, cache.getEntryCount());
+    EXPECT_TRUE(hasPredictions(&cache, ENTRY_COUNT - 1, MAX_SUGGESTION_COUNT));
+    EXPECT_FALSE(hasPredictions(&cache, 1, MAX_SUGGESTION_COUNT));
+}
+
+}  // namespace
+}  // namespace latinime
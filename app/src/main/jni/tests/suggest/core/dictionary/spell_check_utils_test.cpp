@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/spell_check_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+std::vector<int> getMisspelledRanges(const Dictionary *const dictionary,
+        const std::vector<uint16_t> &text) {
+    std::vector<int> misspelledRanges;
+    SpellCheckUtils::getMisspelledRanges(dictionary, text.data(), static_cast<int>(text.size()),
+            &misspelledRanges);
+    return misspelledRanges;
+}
+
+std::vector<uint16_t> toUtf16(const char *const text) {
+    return std::vector<uint16_t>(text, text + strlen(text));
+}
+
+TEST(SpellCheckUtilsTest, TestGetMisspelledRanges) {
+    const std::unique_ptr<Dictionary> dictionary =
+            DictionaryTestUtils::createDictionary({ "the", "quick", "fox", "don't", "Paris" });
+    EXPECT_EQ(std::vector<int>(), getMisspelledRanges(dictionary.get(), toUtf16("")));
+    EXPECT_EQ(std::vector<int>(), getMisspelledRanges(dictionary.get(), toUtf16("The quick fox.")));
+    EXPECT_EQ(std::vector<int>({ 4, 9, 15, 18 }),
+            getMisspelledRanges(dictionary.get(), toUtf16("the quikc fox, teh fox")));
+    // The apostrophes only belong to the word between letters.
+    EXPECT_EQ(std::vector<int>(),
+            getMisspelledRanges(dictionary.get(), toUtf16("'don't' 'the' fox'")));
+    EXPECT_EQ(std::vector<int>({ 0, 4 }), getMisspelledRanges(dictionary.get(), toUtf16("dont")));
+    std::vector<uint16_t> text = toUtf16("don t");
+    text[3] = 0x2019;
+    EXPECT_EQ(std::vector<int>(), getMisspelledRanges(dictionary.get(), text));
+    // The words with digits are not checked.
+    EXPECT_EQ(std::vector<int>(), getMisspelledRanges(dictionary.get(), toUtf16("2nd fox4 42")));
+}
+
+TEST(SpellCheckUtilsTest, TestGetMisspelledRangesWithSurrogates) {
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary({ "fox" });
+    // U+1F98A, the fox face emoji, is a separator.
+    const std::vector<uint16_t> text = { 'f', 'o', 'x', 0xD83E, 0xDD8A, 'f', 'x' };
+    EXPECT_EQ(std::vector<int>({ 5, 7 }), getMisspelledRanges(dictionary.get(), text));
+    // An unpaired surrogate is a separator as well.
+    const std::vector<uint16_t> unpairedText = { 0xD83E, 'f', 'o', 'x', 0xDD8A };
+    EXPECT_EQ(std::vector<int>(), getMisspelledRanges(dictionary.get(), unpairedText));
+}
+
+TEST(SpellCheckUtilsTest, TestIsInDictionaryForAnyCapitalization) {
+    const std::unique_ptr<Dictionary> dictionary =
+            DictionaryTestUtils::createDictionary({ "fox", "Paris" });
+    const auto isInDictionary = [&dictionary](const char *const word) {
+        return SpellCheckUtils::isInDictionaryForAnyCapitalization(dictionary.get(),
+                CodePointArrayView(DictionaryTestUtils::toCodePoints(word)));
+    };
+    EXPECT_TRUE(isInDictionary("fox"));
+    EXPECT_TRUE(isInDictionary("Fox"));
+    EXPECT_TRUE(isInDictionary("FOX"));
+    EXPECT_TRUE(isInDictionary("Paris"));
+    EXPECT_TRUE(isInDictionary("PARIS"));
+    EXPECT_FALSE(isInDictionary("paris"));
+    EXPECT_FALSE(isInDictionary("pARIS"));
+    EXPECT_FALSE(isInDictionary("fax"));
+    EXPECT_FALSE(isInDictionary(""));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -79,5 +79,36 @@ TEST(GeometryUtilsTest, testGetDistanceInt) {
     EXPECT_EQ(500, GeometryUtils::getDistanceInt(0, 0, 300, -400));
 }
 
+TEST(GeometryUtilsTest, testGetAngleAccuracy) {
+    for (int x = -1000; x <= 1000; x += 7) {
+        for (int y = -1000; y <= 1000; y += 3) {
+            if (x == 0 && y == 0) {
+                continue;
+            }
+            EXPECT_NEAR(atan2f(static_cast<float>(y), static_cast<float>(x)),
+                    GeometryUtils::getAngle(x, y, 0, 0), 5e-7f) << x << ", " << y;
+        }
+    }
+}
+
+TEST(GeometryUtilsTest, testFastAtan2) {
+    EXPECT_FLOAT_EQ(0.0f, GeometryUtils::fastAtan2(0.0f, 0.0f));
+    EXPECT_FLOAT_EQ(0.0f, GeometryUtils::fastAtan2(0.0f, 1.0f));
+    EXPECT_FLOAT_EQ(M_PI_F / 2.0f, GeometryUtils::fastAtan2(1.0f, 0.0f));
+    EXPECT_FLOAT_EQ(M_PI_F, GeometryUtils::fastAtan2(0.0f, -1.0f));
+    EXPECT_FLOAT_EQ(-M_PI_F / 2.0f, GeometryUtils::fastAtan2(-1.0f, 0.0f));
+    EXPECT_FLOAT_EQ(-M_PI_F * 3.0f / 4.0f, GeometryUtils::fastAtan2(-2.5f, -2.5f));
+    EXPECT_NEAR(atan2f(0.001f, 1000.0f), GeometryUtils::fastAtan2(0.001f, 1000.0f), 5e-7f);
+}
+
+TEST(GeometryUtilsTest, testGetDistanceIntAccuracy) {
+    for (int x = -2000; x <= 2000; x += 3) {
+        for (int y = -2000; y <= 2000; y += 11) {
+            EXPECT_EQ(static_cast<int>(hypotf(static_cast<float>(x), static_cast<float>(y))),
+                    GeometryUtils::getDistanceInt(x, y, 0, 0)) << x << ", " << y;
+        }
+    }
+}
+
 }  // namespace
 }  // namespace latinime
@@ -64,5 +64,28 @@ TEST(NormalDistribution2DTest, Rotate) {
     }
 }
 
+TEST(NormalDistribution2DTest, ProbabilityDensities) {
+    static const float COORDINATES[] = {0.0f, 10.0f, 100.0f, -20.0f, 500.0f, -3000.0f};
+    const NormalDistribution2D distribution(ORIGIN_X, LARGE_STANDARD_DEVIATION, ORIGIN_Y,
+            SMALL_STANDARD_DEVIATION, M_PI_4);
+    std::vector<float> xs;
+    std::vector<float> ys;
+    for (const float x : COORDINATES) {
+        for (const float y : COORDINATES) {
+            xs.push_back(x);
+            ys.push_back(y);
+        }
+    }
+    std::vector<float> probabilityDensities(xs.size());
+    distribution.getProbabilityDensities(xs.data(), ys.data(), xs.size(),
+            probabilityDensities.data());
+    for (size_t i = 0; i < xs.size(); ++i) {
+        // The batch version is the same up to float rounding, including the far points whose
+        // probability densities are zero.
+        const float expected = distribution.getProbabilityDensity(xs[i], ys[i]);
+        EXPECT_NEAR(expected, probabilityDensities[i], expected * 1e-5f + 1e-30f);
+    }
+}
+
 }  // namespace
 }  // namespace latinime
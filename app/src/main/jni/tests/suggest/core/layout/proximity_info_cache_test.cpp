@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/layout/proximity_info_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "defines.h"
+#include "suggest/core/layout/proximity_info.h"
+
+namespace latinime {
+namespace {
+
+// A one key keyboard, which differs from the other keyboards in its width.
+ProximityInfo *acquireKeyboard(ProximityInfoCache *const cache, const int keyboardWidth) {
+    const int gridWidth = 2;
+    const int gridHeight = 2;
+    const std::vector<int> proximityChars(gridWidth * gridHeight * MAX_PROXIMITY_CHARS_SIZE,
+            NOT_A_CODE_POINT);
+    const int keyX = 0;
+    const int keyY = 0;
+    const int keyWidth = 100;
+    const int keyHeight = 100;
+    const int keyCharCode = 'a';
+    return cache->acquire(keyboardWidth, keyHeight, gridWidth, gridHeight, keyWidth, keyHeight,
+            proximityChars.data(), static_cast<int>(proximityChars.size()), 1 /* keyCount */,
+            &keyX, &keyY, &keyWidth, &keyHeight, &keyCharCode, nullptr /* sweetSpotCenterXs */,
+            nullptr /* sweetSpotCenterYs */, nullptr /* sweetSpotRadii */);
+}
+
+int getKeyboardWidth(const int keyboardIndex) {
+    return 100 * (keyboardIndex + 1);
+}
+
+TEST(ProximityInfoCacheTest, TestSharesInstances) {
+    ProximityInfoCache cache;
+    ProximityInfo *const proximityInfo = acquireKeyboard(&cache, getKeyboardWidth(0));
+    EXPECT_EQ(proximityInfo, acquireKeyboard(&cache, getKeyboardWidth(0)));
+    ProximityInfo *const otherProximityInfo = acquireKeyboard(&cache, getKeyboardWidth(1));
+    EXPECT_NE(proximityInfo, otherProximityInfo);
+    EXPECT_EQ(2, cache.getEntryCount());
+    cache.release(proximityInfo);
+    cache.release(proximityInfo);
+    cache.release(otherProximityInfo);
+    // Kept for the next layout switch.
+    EXPECT_EQ(2, cache.getEntryCount());
+    EXPECT_EQ(proximityInfo, acquireKeyboard(&cache, getKeyboardWidth(0)));
+    cache.release(proximityInfo);
+}
+
+TEST(ProximityInfoCacheTest, TestEvictsLeastRecentlyReleasedEntry) {
+    ProximityInfoCache cache;
+    const int keyboardCount = ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT + 1;
+    std::vector<ProximityInfo *> proximityInfos;
+    for (int i = 0; i < keyboardCount; ++i) {
+        proximityInfos.push_back(acquireKeyboard(&cache, getKeyboardWidth(i)));
+    }
+    // The second keyboard is released first, then the others in order.
+    cache.release(proximityInfos[1]);
+    for (int i = 0; i < keyboardCount; ++i) {
+        if (i != 1) {
+            cache.release(proximityInfos[i]);
+        }
+    }
+    EXPECT_EQ(ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT, cache.getEntryCount());
+    // The first keyboard is still cached, so acquiring it doesn't add an entry.
+    EXPECT_EQ(proximityInfos[0], acquireKeyboard(&cache, getKeyboardWidth(0)));
+    EXPECT_EQ(ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT, cache.getEntryCount());
+    // The second one has been evicted and is built again.
+    ProximityInfo *const rebuiltProximityInfo = acquireKeyboard(&cache, getKeyboardWidth(1));
+    EXPECT_EQ(ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT + 1, cache.getEntryCount());
+    cache.release(proximityInfos[0]);
+    cache.release(rebuiltProximityInfo);
+}
+
+TEST(ProximityInfoCacheTest, TestKeepsEntriesInUse) {
+    ProximityInfoCache cache;
+    ProximityInfo *const proximityInfo = acquireKeyboard(&cache, getKeyboardWidth(0));
+    // The unused entries are all evicted before the entry in use.
+    const int unusedKeyboardCount = ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT * 2;
+    for (int i = 1; i <= unusedKeyboardCount; ++i) {
+        cache.release(acquireKeyboard(&cache, getKeyboardWidth(i)));
+    }
+    EXPECT_EQ(ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT + 1, cache.getEntryCount());
+    EXPECT_EQ(proximityInfo, acquireKeyboard(&cache, getKeyboardWidth(0)));
+    EXPECT_EQ(ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT + 1, cache.getEntryCount());
+    cache.release(proximityInfo);
+    cache.release(proximityInfo);
+}
+
+TEST(ProximityInfoCacheTest, TestReleasingLastReference) {
+    ProximityInfoCache cache;
+    ProximityInfo *const proximityInfo = acquireKeyboard(&cache, getKeyboardWidth(0));
+    EXPECT_EQ(proximityInfo, acquireKeyboard(&cache, getKeyboardWidth(0)));
+    for (int i = 1; i <= ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT; ++i) {
+        cache.release(acquireKeyboard(&cache, getKeyboardWidth(i)));
+    }
+    // One reference is left, so the entry is still in use.
+    cache.release(proximityInfo);
+    EXPECT_EQ(ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT + 1, cache.getEntryCount());
+    // Releasing the last reference makes it the most recently released unused entry, so the
+    // least recently released other one is evicted instead.
+    cache.release(proximityInfo);
+    EXPECT_EQ(ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT, cache.getEntryCount());
+    EXPECT_EQ(proximityInfo, acquireKeyboard(&cache, getKeyboardWidth(0)));
+    EXPECT_EQ(ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT, cache.getEntryCount());
+    ProximityInfo *const rebuiltProximityInfo = acquireKeyboard(&cache, getKeyboardWidth(1));
+    EXPECT_EQ(ProximityInfoCache::MAX_UNUSED_ENTRY_COUNT + 1, cache.getEntryCount());
+    cache.release(proximityInfo);
+    cache.release(rebuiltProximityInfo);
+}
+
+}  // namespace
+}  // namespace latinime
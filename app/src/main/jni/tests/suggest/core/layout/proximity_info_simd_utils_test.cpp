@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/layout/proximity_info_simd_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "suggest/core/layout/normal_distribution_2d.h"
+
+namespace latinime {
+namespace {
+
+// Not a multiple of 4 to also cover the scalar remainder.
+static const int KEY_COUNT = 11;
+
+TEST(ProximityInfoSimdUtilsTest, TestScaledSquaredDistances) {
+    std::vector<float> minXs;
+    std::vector<float> maxXs;
+    std::vector<float> centerYs;
+    std::vector<float> maxYs;
+    for (int k = 0; k < KEY_COUNT; ++k) {
+        const float centerX = 50.0f + 100.0f * k;
+        // Every third key is a wide key and every other key is on the bottom row.
+        const float halfDiff = (k % 3 == 0) ? 30.0f : 0.0f;
+        minXs.push_back(centerX - halfDiff);
+        maxXs.push_back(centerX + halfDiff);
+        centerYs.push_back(40.0f * k);
+        maxYs.push_back((k % 2 == 0) ? std::numeric_limits<float>::max() : 40.0f * k);
+    }
+    static const float SCALE = 1.0f / 10000.0f;
+    static const float POINTS[][2] = {{0.0f, 0.0f}, {75.0f, 200.0f}, {620.0f, 130.0f},
+            {1200.0f, 500.0f}};
+    for (const auto &point : POINTS) {
+        const float x = point[0];
+        const float y = point[1];
+        float distances[KEY_COUNT];
+        ProximityInfoSimdUtils::computeScaledSquaredDistances(x, y, minXs.data(), maxXs.data(),
+                centerYs.data(), maxYs.data(), KEY_COUNT, SCALE, distances);
+        for (int k = 0; k < KEY_COUNT; ++k) {
+            float nearestX = x;
+            if (x < minXs[k]) {
+                nearestX = minXs[k];
+            } else if (x > maxXs[k]) {
+                nearestX = maxXs[k];
+            }
+            const bool isBottomRowKey = k % 2 == 0;
+            const float nearestY = (isBottomRowKey && centerYs[k] < y) ? y : centerYs[k];
+            const float expected = ((x - nearestX) * (x - nearestX)
+                    + (y - nearestY) * (y - nearestY)) * SCALE;
+            EXPECT_NEAR(expected, distances[k], expected * 1e-5f);
+        }
+    }
+}
+
+TEST(ProximityInfoSimdUtilsTest, TestProbabilityDensities) {
+    static const float EPSILON = 1e-5f;
+    std::vector<float> xs;
+    std::vector<float> ys;
+    for (int k = 0; k < KEY_COUNT; ++k) {
+        xs.push_back(-50.0f + 13.0f * k);
+        ys.push_back(30.0f - 7.0f * k);
+    }
+    const NormalDistribution2D distribution(10.0f, 40.0f, -5.0f, 20.0f, M_PI_4);
+    float densities[KEY_COUNT];
+    distribution.getProbabilityDensities(xs.data(), ys.data(), KEY_COUNT, densities);
+    for (int k = 0; k < KEY_COUNT; ++k) {
+        const float expected = distribution.getProbabilityDensity(xs[k], ys[k]);
+        EXPECT_NEAR(expected, densities[k], expected * EPSILON);
+    }
+}
+
+TEST(ProximityInfoSimdUtilsTest, TestScaledExps) {
+    static const float SCALE = 0.25f;
+    std::vector<float> exponents;
+    for (float x = -100.0f; x <= 20.0f; x += 0.37f) {
+        exponents.push_back(x);
+    }
+    exponents.push_back(0.0f);
+    exponents.push_back(-1000.0f);
+    std::vector<float> values(exponents.size());
+    ProximityInfoSimdUtils::computeScaledExps(exponents.data(), exponents.size(), SCALE,
+            values.data());
+    for (size_t i = 0; i < exponents.size(); ++i) {
+        const float expected = SCALE * expf(exponents[i]);
+        if (expected < std::numeric_limits<float>::min()) {
+            EXPECT_LT(values[i], std::numeric_limits<float>::min()) << exponents[i];
+        } else {
+            EXPECT_NEAR(expected, values[i], expected * 3e-7f) << exponents[i];
+        }
+    }
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/layout/proximity_info_state.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "suggest/policyimpl/typing/scoring_params.h"
+#include "tests/suggest/core/layout/proximity_info_test_utils.h"
+#include "tests/utils/allocation_counter.h"
+
+namespace latinime {
+namespace {
+
+TEST(ProximityInfoStateTest, TestInitInputParamsDoesNotAllocate) {
+    const std::unique_ptr<ProximityInfo> proximityInfo =
+            ProximityInfoTestUtils::createQwertyProximityInfo();
+    const std::vector<int> locale = { 'e', 'n' };
+    static const char *const WORD = "keyboard";
+    static const int WORD_LENGTH = 8;
+    int codePoints[WORD_LENGTH];
+    int xs[WORD_LENGTH];
+    int ys[WORD_LENGTH];
+    int times[WORD_LENGTH];
+    int pointerIds[WORD_LENGTH] = {};
+    for (int i = 0; i < WORD_LENGTH; ++i) {
+        codePoints[i] = WORD[i];
+        ASSERT_TRUE(ProximityInfoTestUtils::getKeyCenter(proximityInfo.get(), codePoints[i],
+                &xs[i], &ys[i]));
+        times[i] = i * 100;
+    }
+
+    ProximityInfoState proximityInfoState;
+    // The first call sizes the sampled input buffers for the longest input.
+    proximityInfoState.initInputParams(0 /* pointerId */, ScoringParams::MAX_SPATIAL_DISTANCE,
+            proximityInfo.get(), codePoints, WORD_LENGTH, xs, ys, times, pointerIds,
+            false /* isGeometric */, &locale);
+    ASSERT_EQ(WORD_LENGTH, proximityInfoState.size());
+    for (int inputSize = 1; inputSize <= WORD_LENGTH; ++inputSize) {
+        const AllocationCounter allocationCounter;
+        proximityInfoState.initInputParams(0 /* pointerId */, ScoringParams::MAX_SPATIAL_DISTANCE,
+                proximityInfo.get(), codePoints, inputSize, xs, ys, times, pointerIds,
+                false /* isGeometric */, &locale);
+        EXPECT_EQ(0, allocationCounter.getAllocationCount()) << "inputSize " << inputSize;
+        EXPECT_EQ(inputSize, proximityInfoState.size());
+        EXPECT_EQ(WORD[inputSize - 1], proximityInfoState.getPrimaryCodePointAt(inputSize - 1));
+    }
+}
+
+TEST(ProximityInfoStateTest, TestAdditionalProximityCharsForLocale) {
+    const std::unique_ptr<ProximityInfo> proximityInfo =
+            ProximityInfoTestUtils::createQwertyProximityInfo();
+    int codePoints[] = { 'a', 'k' };
+    int xs[NELEMS(codePoints)];
+    int ys[NELEMS(codePoints)];
+    int times[NELEMS(codePoints)] = { 0, 100 };
+    int pointerIds[NELEMS(codePoints)] = {};
+    for (size_t i = 0; i < NELEMS(codePoints); ++i) {
+        ASSERT_TRUE(ProximityInfoTestUtils::getKeyCenter(proximityInfo.get(), codePoints[i],
+                &xs[i], &ys[i]));
+    }
+    const auto initInput = [&](ProximityInfoState *const proximityInfoState,
+            const std::vector<int> *const locale) {
+        proximityInfoState->initInputParams(0 /* pointerId */,
+                ScoringParams::MAX_SPATIAL_DISTANCE, proximityInfo.get(), codePoints,
+                NELEMS(codePoints), xs, ys, times, pointerIds, false /* isGeometric */, locale);
+    };
+
+    // The other vowels are additional proximity chars of the vowels in English only.
+    const std::vector<int> enLocale = { 'e', 'n', '_', 'U', 'S' };
+    ProximityInfoState proximityInfoState;
+    initInput(&proximityInfoState, &enLocale);
+    EXPECT_EQ(ProximityType::ADDITIONAL_PROXIMITY_CHAR,
+            proximityInfoState.getProximityType(0, 'o', true /* checkProximityChars */));
+    EXPECT_EQ(ProximityType::PROXIMITY_CHAR,
+            proximityInfoState.getProximityType(0, 's', true /* checkProximityChars */));
+    EXPECT_EQ(ProximityType::SUBSTITUTION_CHAR,
+            proximityInfoState.getProximityType(1, 'z', true /* checkProximityChars */));
+
+    const std::vector<int> frLocale = { 'f', 'r' };
+    initInput(&proximityInfoState, &frLocale);
+    EXPECT_EQ(ProximityType::SUBSTITUTION_CHAR,
+            proximityInfoState.getProximityType(0, 'o', true /* checkProximityChars */));
+    EXPECT_EQ(ProximityType::PROXIMITY_CHAR,
+            proximityInfoState.getProximityType(0, 's', true /* checkProximityChars */));
+}
+
+// A one pixel per millisecond gesture through the points.
+void createGestureTrace(const std::vector<std::pair<int, int>> &points, std::vector<int> *const xs,
+        std::vector<int> *const ys, std::vector<int> *const times) {
+    for (size_t i = 0; i + 1 < points.size(); ++i) {
+        const int dx = points[i + 1].first - points[i].first;
+        const int dy = points[i + 1].second - points[i].second;
+        const int length = std::max(std::abs(dx), std::abs(dy));
+        for (int step = 0; step < length; ++step) {
+            xs->push_back(points[i].first + dx * step / length);
+            ys->push_back(points[i].second + dy * step / length);
+            times->push_back(static_cast<int>(times->size()));
+        }
+    }
+    xs->push_back(points.back().first);
+    ys->push_back(points.back().second);
+    times->push_back(static_cast<int>(times->size()));
+}
+
+void initGestureInput(ProximityInfoState *const proximityInfoState,
+        const ProximityInfo *const proximityInfo, const std::vector<int> &xs,
+        const std::vector<int> &ys, const std::vector<int> &times) {
+    const std::vector<int> locale = { 'e', 'n' };
+    const std::vector<int> pointerIds(xs.size(), 0);
+    proximityInfoState->initInputParams(0 /* pointerId */, ScoringParams::MAX_SPATIAL_DISTANCE,
+            proximityInfo, nullptr /* inputCodes */, static_cast<int>(xs.size()), xs.data(),
+            ys.data(), times.data(), pointerIds.data(), true /* isGeometric */, &locale);
+}
+
+TEST(ProximityInfoStateTest, TestGestureTraceDecimation) {
+    const std::unique_ptr<ProximityInfo> proximityInfo =
+            ProximityInfoTestUtils::createQwertyProximityInfo();
+    int qX, qY, pX, pY, bX, bY;
+    ASSERT_TRUE(ProximityInfoTestUtils::getKeyCenter(proximityInfo.get(), 'q', &qX, &qY));
+    ASSERT_TRUE(ProximityInfoTestUtils::getKeyCenter(proximityInfo.get(), 'p', &pX, &pY));
+    ASSERT_TRUE(ProximityInfoTestUtils::getKeyCenter(proximityInfo.get(), 'b', &bX, &bY));
+    std::vector<int> xs, ys, times;
+    createGestureTrace({ { qX, qY }, { bX, bY }, { pX, pY } }, &xs, &ys, &times);
+
+    ProximityInfoState proximityInfoState;
+    initGestureInput(&proximityInfoState, proximityInfo.get(), xs, ys, times);
+    ASSERT_LT(2, proximityInfoState.size());
+    EXPECT_GT(static_cast<int>(xs.size()) / 8, proximityInfoState.size());
+    EXPECT_EQ(0, proximityInfoState.getInputIndexOfSampledPoint(0));
+    // The points closer than 1/8 of the key width are not sampled.
+    for (int i = 1; i + 1 < proximityInfoState.size(); ++i) {
+        const int dx = proximityInfoState.getInputX(i) - proximityInfoState.getInputX(i - 1);
+        const int dy = proximityInfoState.getInputY(i) - proximityInfoState.getInputY(i - 1);
+        EXPECT_LE(ProximityInfoTestUtils::KEY_WIDTH / 8 * ProximityInfoTestUtils::KEY_WIDTH / 8,
+                dx * dx + dy * dy) << "sampled point " << i;
+    }
+    // The corner at "b" is kept.
+    bool hasCorner = false;
+    for (int i = 0; i < proximityInfoState.size(); ++i) {
+        hasCorner |= std::abs(proximityInfoState.getInputX(i) - bX)
+                + std::abs(proximityInfoState.getInputY(i) - bY)
+                        < ProximityInfoTestUtils::KEY_WIDTH / 8;
+    }
+    EXPECT_TRUE(hasCorner);
+
+    // Dwelling on "b" doesn't change the sampled trace.
+    const size_t cornerIndex = std::find(xs.begin(), xs.end(), bX) - xs.begin();
+    ASSERT_EQ(bY, ys[cornerIndex]);
+    std::vector<int> dwellingXs(xs.begin(), xs.begin() + cornerIndex);
+    std::vector<int> dwellingYs(ys.begin(), ys.begin() + cornerIndex);
+    dwellingXs.insert(dwellingXs.end(), 200, bX);
+    dwellingYs.insert(dwellingYs.end(), 200, bY);
+    dwellingXs.insert(dwellingXs.end(), xs.begin() + cornerIndex, xs.end());
+    dwellingYs.insert(dwellingYs.end(), ys.begin() + cornerIndex, ys.end());
+    std::vector<int> dwellingTimes;
+    for (size_t i = 0; i < dwellingXs.size(); ++i) {
+        dwellingTimes.push_back(static_cast<int>(i));
+    }
+    ProximityInfoState dwellingProximityInfoState;
+    initGestureInput(&dwellingProximityInfoState, proximityInfo.get(), dwellingXs, dwellingYs,
+            dwellingTimes);
+    ASSERT_EQ(proximityInfoState.size(), dwellingProximityInfoState.size());
+    for (int i = 0; i < proximityInfoState.size(); ++i) {
+        EXPECT_EQ(proximityInfoState.getInputX(i), dwellingProximityInfoState.getInputX(i));
+        EXPECT_EQ(proximityInfoState.getInputY(i), dwellingProximityInfoState.getInputY(i));
+    }
+}
+
+}  // namespace
+}  // namespace latinime
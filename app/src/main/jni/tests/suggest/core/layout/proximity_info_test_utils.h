@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_PROXIMITY_INFO_TEST_UTILS_H
+#define LATINIME_PROXIMITY_INFO_TEST_UTILS_H
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "defines.h"
+#include "suggest/core/layout/proximity_info.h"
+
+namespace latinime {
+
+// A synthetic QWERTY keyboard without touch position correction, built like latinime_suggest_bench
+// does. The keys are KEY_WIDTH x KEY_HEIGHT and the first row starts at (0, 0).
+class ProximityInfoTestUtils {
+ public:
+    static constexpr int KEY_WIDTH = 108;
+    static constexpr int KEY_HEIGHT = 160;
+
+    static std::unique_ptr<ProximityInfo> createQwertyProximityInfo() {
+        static const char *const ROWS[] = { "qwertyuiop", "asdfghjkl", "zxcvbnm" };
+        std::vector<int> xs, ys, widths, heights, codePoints;
+        for (size_t row = 0; row < NELEMS(ROWS); ++row) {
+            const int rowLength = static_cast<int>(strlen(ROWS[row]));
+            const int rowX = (KEYBOARD_WIDTH - rowLength * KEY_WIDTH) / 2;
+            for (int i = 0; i < rowLength; ++i) {
+                xs.push_back(rowX + i * KEY_WIDTH);
+                ys.push_back(static_cast<int>(row) * KEY_HEIGHT);
+                widths.push_back(KEY_WIDTH);
+                heights.push_back(KEY_HEIGHT);
+                codePoints.push_back(ROWS[row][i]);
+            }
+        }
+        const int cellWidth = (KEYBOARD_WIDTH + GRID_WIDTH - 1) / GRID_WIDTH;
+        const int cellHeight = (KEYBOARD_HEIGHT + GRID_HEIGHT - 1) / GRID_HEIGHT;
+        // Same as ProximityInfo.SEARCH_DISTANCE in Java.
+        const int threshold = static_cast<int>(KEY_WIDTH * 1.2f);
+        std::vector<int> proximityChars(GRID_WIDTH * GRID_HEIGHT * MAX_PROXIMITY_CHARS_SIZE,
+                NOT_A_CODE_POINT);
+        for (int cell = 0; cell < GRID_WIDTH * GRID_HEIGHT; ++cell) {
+            const int centerX = (cell % GRID_WIDTH) * cellWidth + cellWidth / 2;
+            const int centerY = (cell / GRID_WIDTH) * cellHeight + cellHeight / 2;
+            int count = 0;
+            for (size_t i = 0; i < codePoints.size() && count < MAX_PROXIMITY_CHARS_SIZE; ++i) {
+                const int dx = std::max(0, std::max(xs[i] - centerX, centerX - xs[i] - KEY_WIDTH));
+                const int dy = std::max(0, std::max(ys[i] - centerY,
+                        centerY - ys[i] - KEY_HEIGHT));
+                if (dx * dx + dy * dy < threshold * threshold) {
+                    proximityChars[cell * MAX_PROXIMITY_CHARS_SIZE + count++] = codePoints[i];
+                }
+            }
+        }
+        return std::unique_ptr<ProximityInfo>(new ProximityInfo(KEYBOARD_WIDTH, KEYBOARD_HEIGHT,
+                GRID_WIDTH, GRID_HEIGHT, KEY_WIDTH, KEY_HEIGHT, proximityChars.data(),
+                static_cast<int>(proximityChars.size()), static_cast<int>(codePoints.size()),
+                xs.data(), ys.data(), widths.data(), heights.data(), codePoints.data(),
+                nullptr /* sweetSpotCenterXs */, nullptr /* sweetSpotCenterYs */,
+                nullptr /* sweetSpotRadii */));
+    }
+
+    // Returns the center of the key, or false if the keyboard doesn't have it.
+    static bool getKeyCenter(const ProximityInfo *const proximityInfo, const int codePoint,
+            int *const outX, int *const outY) {
+        const int keyIndex = proximityInfo->getKeyIndexOf(codePoint);
+        if (keyIndex == NOT_AN_INDEX) {
+            return false;
+        }
+        *outX = proximityInfo->getKeyCenterXOfKeyIdG(keyIndex, NOT_A_COORDINATE, false);
+        *outY = proximityInfo->getKeyCenterYOfKeyIdG(keyIndex, NOT_A_COORDINATE, false);
+        return true;
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(ProximityInfoTestUtils);
+
+    // Same grid as com.android.inputmethod.keyboard.ProximityInfo.
+    static constexpr int GRID_WIDTH = 32;
+    static constexpr int GRID_HEIGHT = 16;
+    static constexpr int KEYBOARD_WIDTH = KEY_WIDTH * 10;
+    static constexpr int KEYBOARD_HEIGHT = KEY_HEIGHT * 4;
+};
+} // namespace latinime
+#endif // LATINIME_PROXIMITY_INFO_TEST_UTILS_H
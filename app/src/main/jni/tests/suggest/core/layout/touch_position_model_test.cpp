@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/layout/touch_position_model.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "defines.h"
+#include "suggest/core/layout/proximity_info.h"
+
+namespace latinime {
+namespace {
+
+// One row of keys "asd". The tap distance tables are sampled every KEY_SIZE / 16 pixels.
+static const int KEY_SIZE = 96;
+static const int KEY_COUNT = 3;
+static const int CODE_POINTS[KEY_COUNT] = { 'a', 's', 'd' };
+
+ProximityInfo *createProximityInfo() {
+    const int gridWidth = KEY_COUNT;
+    const int gridHeight = 1;
+    const std::vector<int> proximityChars(gridWidth * gridHeight * MAX_PROXIMITY_CHARS_SIZE,
+            NOT_A_CODE_POINT);
+    const int xs[KEY_COUNT] = { 0, KEY_SIZE, 2 * KEY_SIZE };
+    const int ys[KEY_COUNT] = { 0, 0, 0 };
+    const int sizes[KEY_COUNT] = { KEY_SIZE, KEY_SIZE, KEY_SIZE };
+    return new ProximityInfo(KEY_COUNT * KEY_SIZE, KEY_SIZE, gridWidth, gridHeight, KEY_SIZE,
+            KEY_SIZE, proximityChars.data(), static_cast<int>(proximityChars.size()), KEY_COUNT,
+            xs, ys, sizes, sizes, CODE_POINTS, nullptr /* sweetSpotCenterXs */,
+            nullptr /* sweetSpotCenterYs */, nullptr /* sweetSpotRadii */);
+}
+
+void tapRepeatedly(TouchPositionModel *const model, const ProximityInfo *const proximityInfo,
+        const int codePoint, const int x, const int y, const int count) {
+    for (int i = 0; i < count; ++i) {
+        model->learn(proximityInfo, &x, &y, &codePoint, 1 /* inputSize */);
+    }
+}
+
+TEST(TouchPositionModelTest, TestLearnsMeanOffsets) {
+    const std::unique_ptr<ProximityInfo> proximityInfo(createProximityInfo());
+    TouchPositionModel model;
+    EXPECT_EQ(0, model.getVersion());
+    // 24 and 12 pixels right of the center of 'a' alternately, 6 pixels above it.
+    for (int i = 0; i < 32; ++i) {
+        tapRepeatedly(&model, proximityInfo.get(), 'A', 72, 42, 1 /* count */);
+        tapRepeatedly(&model, proximityInfo.get(), 'a', 60, 42, 1 /* count */);
+    }
+    EXPECT_NE(0, model.getVersion());
+
+    float offsetXs[KEY_COUNT];
+    float offsetYs[KEY_COUNT];
+    model.getOffsets(CODE_POINTS, KEY_COUNT, offsetXs, offsetYs);
+    // Shrunk by the prior of 8 taps at the center.
+    EXPECT_NEAR(18.0f / KEY_SIZE * 64.0f / 72.0f, offsetXs[0], 0.01f);
+    EXPECT_NEAR(-6.0f / KEY_SIZE * 64.0f / 72.0f, offsetYs[0], 0.001f);
+    EXPECT_FLOAT_EQ(0.0f, offsetXs[1]);
+    EXPECT_FLOAT_EQ(0.0f, offsetYs[1]);
+
+    model.clear();
+    model.getOffsets(CODE_POINTS, KEY_COUNT, offsetXs, offsetYs);
+    EXPECT_FLOAT_EQ(0.0f, offsetXs[0]);
+    EXPECT_FLOAT_EQ(0.0f, offsetYs[0]);
+}
+
+TEST(TouchPositionModelTest, TestIgnoresUnusableTaps) {
+    const std::unique_ptr<ProximityInfo> proximityInfo(createProximityInfo());
+    TouchPositionModel model;
+    // More than a key width away from the center of 'a'.
+    tapRepeatedly(&model, proximityInfo.get(), 'a', 48 + KEY_SIZE + 1, 48, 1 /* count */);
+    // Not on the keyboard.
+    tapRepeatedly(&model, proximityInfo.get(), 'q', 48, 48, 1 /* count */);
+    // Without coordinates.
+    tapRepeatedly(&model, proximityInfo.get(), 's', NOT_A_COORDINATE, NOT_A_COORDINATE,
+            1 /* count */);
+    EXPECT_EQ(0, model.getVersion());
+}
+
+TEST(TouchPositionModelTest, TestShiftsTapDistances) {
+    const std::unique_ptr<ProximityInfo> proximityInfo(createProximityInfo());
+    TouchPositionModel model;
+    // The points are at the centers of the cells of the tap distance tables.
+    const int x = 75;
+    // Above the centers, as the keys are extended down to the bottom edge of the keyboard.
+    const int y = 45;
+    const float squaredKeySize = static_cast<float>(KEY_SIZE * KEY_SIZE);
+    float distances[KEY_COUNT];
+    proximityInfo->getNormalizedSquaredDistancesFromCentersForTap(x, y, distances);
+    EXPECT_FLOAT_EQ((27.0f * 27.0f + 3.0f * 3.0f) / squaredKeySize, distances[0]);
+
+    tapRepeatedly(&model, proximityInfo.get(), 'a', 48 + 24, 48, 64 /* count */);
+    proximityInfo->applyTouchPositionModel(&model);
+    proximityInfo->getNormalizedSquaredDistancesFromCentersForTap(x, y, distances);
+    // The center of 'a' moved by 24 * 64 / 72 pixels, rounded to 21.
+    EXPECT_FLOAT_EQ((6.0f * 6.0f + 3.0f * 3.0f) / squaredKeySize, distances[0]);
+    // The other keys didn't move.
+    EXPECT_FLOAT_EQ((69.0f * 69.0f + 3.0f * 3.0f) / squaredKeySize, distances[1]);
+    // Out of the keyboard, the distances are computed one by one in the same way.
+    proximityInfo->getNormalizedSquaredDistancesFromCentersForTap(-6, y, distances);
+    EXPECT_FLOAT_EQ((75.0f * 75.0f + 3.0f * 3.0f) / squaredKeySize, distances[0]);
+
+    model.clear();
+    proximityInfo->applyTouchPositionModel(&model);
+    proximityInfo->getNormalizedSquaredDistancesFromCentersForTap(x, y, distances);
+    EXPECT_FLOAT_EQ((27.0f * 27.0f + 3.0f * 3.0f) / squaredKeySize, distances[0]);
+}
+
+TEST(TouchPositionModelTest, TestReadsTapDistancesWhileApplying) {
+    const std::unique_ptr<ProximityInfo> proximityInfo(createProximityInfo());
+    TouchPositionModel model;
+    const int x = 75;
+    const int y = 45;
+    const float squaredKeySize = static_cast<float>(KEY_SIZE * KEY_SIZE);
+    const float unshiftedDistance = (27.0f * 27.0f + 3.0f * 3.0f) / squaredKeySize;
+    const float shiftedDistance = (6.0f * 6.0f + 3.0f * 3.0f) / squaredKeySize;
+    std::atomic<bool> isApplying(true);
+    std::atomic<int> unexpectedDistanceCount(0);
+    // Every read sees either of the tables, never ones that are being rebuilt.
+    std::thread reader([&]() {
+        float distances[KEY_COUNT];
+        while (isApplying.load()) {
+            proximityInfo->getNormalizedSquaredDistancesFromCentersForTap(x, y, distances);
+            if (distances[0] != unshiftedDistance && distances[0] != shiftedDistance) {
+                unexpectedDistanceCount.fetch_add(1);
+            }
+        }
+    });
+    for (int i = 0; i < 100; ++i) {
+        tapRepeatedly(&model, proximityInfo.get(), 'a', 48 + 24, 48, 64 /* count */);
+        proximityInfo->applyTouchPositionModel(&model);
+        model.clear();
+        proximityInfo->applyTouchPositionModel(&model);
+    }
+    isApplying.store(false);
+    reader.join();
+    EXPECT_EQ(0, unexpectedDistanceCount.load());
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/result/suggestion_results.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "suggest/core/result/suggested_word.h"
+
+namespace latinime {
+namespace {
+
+void addWord(SuggestionResults *const suggestionResults, const std::vector<int> &codePoints,
+        const int score) {
+    suggestionResults->addSuggestion(codePoints.data(), static_cast<int>(codePoints.size()),
+            score, Dictionary::KIND_CORRECTION, NOT_AN_INDEX, NOT_A_FIRST_WORD_CONFIDENCE);
+}
+
+// The first code point depends on the score, so that suggestions of different scores are
+// different words.
+void addSuggestionOfLength(SuggestionResults *const suggestionResults, const int codePointCount,
+        const int score) {
+    std::vector<int> codePoints(codePointCount, 'a');
+    codePoints[0] = 0x100 + score;
+    addWord(suggestionResults, codePoints, score);
+}
+
+TEST(SuggestionResultsTest, TestKeepsBestSuggestions) {
+    static const int MAX_SUGGESTION_COUNT = 3;
+    SuggestionResults suggestionResults(MAX_SUGGESTION_COUNT);
+    addSuggestionOfLength(&suggestionResults, 1 /* codePointCount */, 10 /* score */);
+    addSuggestionOfLength(&suggestionResults, 1 /* codePointCount */, 40 /* score */);
+    addSuggestionOfLength(&suggestionResults, 1 /* codePointCount */, 20 /* score */);
+    EXPECT_TRUE(suggestionResults.canAddSuggestionOfScore(10));
+    EXPECT_FALSE(suggestionResults.canAddSuggestionOfScore(9));
+    addSuggestionOfLength(&suggestionResults, 1 /* codePointCount */, 30 /* score */);
+    addSuggestionOfLength(&suggestionResults, 1 /* codePointCount */, 5 /* score */);
+    EXPECT_EQ(MAX_SUGGESTION_COUNT, suggestionResults.getSuggestionCount());
+    int scores[MAX_SUGGESTION_COUNT];
+    suggestionResults.getSortedScores(scores);
+    EXPECT_EQ(40, scores[0]);
+    EXPECT_EQ(30, scores[1]);
+    EXPECT_EQ(20, scores[2]);
+    // Reading the scores doesn't consume the suggestions.
+    EXPECT_EQ(MAX_SUGGESTION_COUNT, suggestionResults.getSuggestionCount());
+}
+
+TEST(SuggestionResultsTest, TestShorterWordWinsTie) {
+    SuggestionResults suggestionResults(1 /* maxSuggestionCount */);
+    addSuggestionOfLength(&suggestionResults, 3 /* codePointCount */, 10 /* score */);
+    addSuggestionOfLength(&suggestionResults, 4 /* codePointCount */, 10 /* score */);
+    addSuggestionOfLength(&suggestionResults, 2 /* codePointCount */, 10 /* score */);
+    std::vector<SuggestedWord> suggestedWords;
+    suggestionResults.getSuggestedWords(&suggestedWords);
+    ASSERT_EQ(1u, suggestedWords.size());
+    EXPECT_EQ(2, suggestedWords[0].getCodePointCount());
+}
+
+TEST(SuggestionResultsTest, TestOutputWorstFirst) {
+    SuggestionResults suggestionResults(MAX_RESULTS);
+    for (int i = 0; i < MAX_RESULTS * 2; ++i) {
+        // Scores in a scrambled order.
+        addSuggestionOfLength(&suggestionResults, MAX_WORD_LENGTH, (i * 7) % (MAX_RESULTS * 2));
+    }
+    int codePoints[MAX_RESULTS * MAX_WORD_LENGTH];
+    int scores[MAX_RESULTS];
+    int spaceIndices[MAX_RESULTS];
+    int types[MAX_RESULTS];
+    int autoCommitFirstWordConfidence = 0;
+    EXPECT_EQ(MAX_RESULTS, suggestionResults.outputSuggestions(codePoints, scores, spaceIndices,
+            types, &autoCommitFirstWordConfidence));
+    for (int i = 0; i < MAX_RESULTS; ++i) {
+        EXPECT_EQ(MAX_RESULTS + i, scores[i]);
+        EXPECT_EQ('a', codePoints[i * MAX_WORD_LENGTH + MAX_WORD_LENGTH - 1]);
+    }
+    EXPECT_EQ(0, suggestionResults.getSuggestionCount());
+}
+
+TEST(SuggestionResultsTest, TestMergesDuplicates) {
+    SuggestionResults suggestionResults(2 /* maxSuggestionCount */);
+    addWord(&suggestionResults, { 'a', 'b' }, 10 /* score */);
+    addWord(&suggestionResults, { 'a', 'b' }, 30 /* score */);
+    addWord(&suggestionResults, { 'a', 'b' }, 20 /* score */);
+    EXPECT_EQ(1, suggestionResults.getSuggestionCount());
+    addWord(&suggestionResults, { 'a' }, 15 /* score */);
+    // The results are full, but the better suggestion of "a" doesn't drop the other word.
+    addWord(&suggestionResults, { 'a' }, 40 /* score */);
+    std::vector<SuggestedWord> suggestedWords;
+    suggestionResults.getSuggestedWords(&suggestedWords);
+    ASSERT_EQ(2u, suggestedWords.size());
+    EXPECT_EQ(30, suggestedWords[0].getScore());
+    EXPECT_EQ(2, suggestedWords[0].getCodePointCount());
+    EXPECT_EQ(40, suggestedWords[1].getScore());
+    EXPECT_EQ(1, suggestedWords[1].getCodePointCount());
+}
+
+TEST(SuggestionResultsTest, TestMergesDuplicatesOfDroppedWords) {
+    SuggestionResults suggestionResults(MAX_RESULTS);
+    // Many more words than the results keep, so that the worst ones are dropped over and over.
+    static const int WORD_COUNT = MAX_RESULTS * 8;
+    for (int i = 0; i < WORD_COUNT; ++i) {
+        addWord(&suggestionResults, { 'a' + i % 26, 'a' + i / 26 }, i /* score */);
+    }
+    for (int i = 0; i < WORD_COUNT; ++i) {
+        addWord(&suggestionResults, { 'a' + i % 26, 'a' + i / 26 }, i - 1 /* score */);
+    }
+    EXPECT_EQ(MAX_RESULTS, suggestionResults.getSuggestionCount());
+    int scores[MAX_RESULTS];
+    suggestionResults.getSortedScores(scores);
+    for (int i = 0; i < MAX_RESULTS; ++i) {
+        EXPECT_EQ(WORD_COUNT - 1 - i, scores[i]);
+    }
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/session/dic_traverse_session_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "suggest/core/session/dic_traverse_session.h"
+#include "utils/memory_usage.h"
+
+namespace latinime {
+namespace {
+
+TEST(DicTraverseSessionPoolTest, TestReuse) {
+    DicTraverseSessionPool pool(false /* usesLargeCache */);
+    DicTraverseSession *const session = pool.acquireSession();
+    EXPECT_NE(nullptr, session);
+    EXPECT_EQ(1, pool.getCreatedSessionCount());
+    pool.releaseSession(session);
+    EXPECT_EQ(1, pool.getIdleSessionCount());
+    EXPECT_EQ(session, pool.acquireSession());
+    EXPECT_EQ(0, pool.getIdleSessionCount());
+    pool.releaseSession(session);
+}
+
+TEST(DicTraverseSessionPoolTest, TestDistinctSessions) {
+    DicTraverseSessionPool pool(false /* usesLargeCache */);
+    DicTraverseSession *const session0 = pool.acquireSession();
+    DicTraverseSession *const session1 = pool.acquireSession();
+    EXPECT_NE(session0, session1);
+    EXPECT_EQ(2, pool.getCreatedSessionCount());
+    pool.releaseSession(session0);
+    pool.releaseSession(session1);
+    EXPECT_EQ(2, pool.getIdleSessionCount());
+}
+
+TEST(DicTraverseSessionPoolTest, TestScopedSession) {
+    DicTraverseSessionPool pool(false /* usesLargeCache */);
+    {
+        DicTraverseSessionPool::ScopedSession scopedSession(&pool);
+        EXPECT_NE(nullptr, scopedSession.get());
+        EXPECT_EQ(0, pool.getIdleSessionCount());
+    }
+    EXPECT_EQ(1, pool.getIdleSessionCount());
+}
+
+TEST(DicTraverseSessionPoolTest, TestMemoryUsageOfIdleSessions) {
+    DicTraverseSessionPool pool(false /* usesLargeCache */);
+    MemoryUsage emptyPoolMemoryUsage;
+    pool.addMemoryUsage(&emptyPoolMemoryUsage);
+    EXPECT_EQ(0, emptyPoolMemoryUsage.get(MemoryUsage::CACHE_BYTES));
+
+    DicTraverseSession *const session = pool.acquireSession();
+    MemoryUsage leasedSessionMemoryUsage;
+    pool.addMemoryUsage(&leasedSessionMemoryUsage);
+    EXPECT_EQ(0, leasedSessionMemoryUsage.get(MemoryUsage::CACHE_BYTES));
+
+    pool.releaseSession(session);
+    MemoryUsage idleSessionMemoryUsage;
+    pool.addMemoryUsage(&idleSessionMemoryUsage);
+    MemoryUsage sessionMemoryUsage;
+    session->addMemoryUsage(&sessionMemoryUsage);
+    // The idle session keeps the DicNodes cached for the continuous suggestion.
+    EXPECT_LT(0, sessionMemoryUsage.get(MemoryUsage::CACHE_BYTES));
+    EXPECT_LE(static_cast<int64_t>(sizeof(DicTraverseSession)),
+            sessionMemoryUsage.get(MemoryUsage::HEAP_BYTES));
+    EXPECT_EQ(sessionMemoryUsage.get(MemoryUsage::CACHE_BYTES),
+            idleSessionMemoryUsage.get(MemoryUsage::CACHE_BYTES));
+    EXPECT_EQ(0, idleSessionMemoryUsage.get(MemoryUsage::MAPPED_FILE_BYTES));
+}
+
+TEST(DicTraverseSessionPoolTest, TestReleasedSessionReturnsSearchQueues) {
+    DicTraverseSessionPool pool(false /* usesLargeCache */);
+    DicTraverseSession *const session = pool.acquireSession();
+    MemoryUsage leasedSessionMemoryUsage;
+    session->addMemoryUsage(&leasedSessionMemoryUsage);
+    pool.releaseSession(session);
+    MemoryUsage idleSessionMemoryUsage;
+    session->addMemoryUsage(&idleSessionMemoryUsage);
+    EXPECT_LT(idleSessionMemoryUsage.get(MemoryUsage::CACHE_BYTES),
+            leasedSessionMemoryUsage.get(MemoryUsage::CACHE_BYTES));
+
+    // The queues lease DicNodes again for the next search.
+    EXPECT_EQ(session, pool.acquireSession());
+    session->resetCache(10 /* thresholdForNextActiveDicNodes */, 5 /* maxWords */);
+    MemoryUsage resetSessionMemoryUsage;
+    session->addMemoryUsage(&resetSessionMemoryUsage);
+    EXPECT_LT(idleSessionMemoryUsage.get(MemoryUsage::CACHE_BYTES),
+            resetSessionMemoryUsage.get(MemoryUsage::CACHE_BYTES));
+    pool.releaseSession(session);
+}
+
+TEST(DicTraverseSessionPoolTest, TestTrimMemory) {
+    DicTraverseSessionPool pool(false /* usesLargeCache */);
+    DicTraverseSession *const session = pool.acquireSession();
+    pool.releaseSession(session);
+
+    pool.trimMemory(false /* deletesIdleSessions */);
+    EXPECT_EQ(1, pool.getIdleSessionCount());
+    MemoryUsage trimmedSessionMemoryUsage;
+    session->addMemoryUsage(&trimmedSessionMemoryUsage);
+    EXPECT_EQ(0, trimmedSessionMemoryUsage.get(MemoryUsage::CACHE_BYTES));
+
+    // The DicNode pools are allocated again for the next search.
+    session->resetCache(10 /* thresholdForNextActiveDicNodes */, 5 /* maxWords */);
+    MemoryUsage resetSessionMemoryUsage;
+    session->addMemoryUsage(&resetSessionMemoryUsage);
+    EXPECT_LT(0, resetSessionMemoryUsage.get(MemoryUsage::CACHE_BYTES));
+
+    pool.trimMemory(true /* deletesIdleSessions */);
+    EXPECT_EQ(0, pool.getIdleSessionCount());
+    EXPECT_EQ(0, pool.getCreatedSessionCount());
+}
+
+TEST(DicTraverseSessionPoolTest, TestConcurrentLease) {
+    static const int THREAD_COUNT = 4;
+    static const int LEASE_COUNT_PER_THREAD = 100;
+    DicTraverseSessionPool pool(false /* usesLargeCache */);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([&pool]() {
+            for (int j = 0; j < LEASE_COUNT_PER_THREAD; ++j) {
+                DicTraverseSessionPool::ScopedSession scopedSession(&pool);
+                EXPECT_NE(nullptr, scopedSession.get());
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_LE(pool.getCreatedSessionCount(), THREAD_COUNT);
+    EXPECT_EQ(pool.getCreatedSessionCount(), pool.getIdleSessionCount());
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/session/expansion_workspace.h"
+
+#include <gtest/gtest.h>
+
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_nodes_cache.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+static const int QUEUE_SIZE = 10;
+
+TEST(ExpansionWorkspaceTest, TestPushesDirectly) {
+    DicNodesCache cache(false /* usesLargeCapacityCache */);
+    cache.reset(QUEUE_SIZE, QUEUE_SIZE);
+    ExpansionWorkspace workspace(false /* defersPushes */);
+    DicNode dicNode;
+    workspace.copyPushNextActive(&cache, &dicNode);
+    workspace.copyPushTerminal(&cache, &dicNode);
+    EXPECT_EQ(1, cache.terminalSize());
+    cache.advanceActiveDicNodes();
+    EXPECT_EQ(1, cache.activeSize());
+}
+
+TEST(ExpansionWorkspaceTest, TestDefersPushes) {
+    DicNodesCache cache(false /* usesLargeCapacityCache */);
+    cache.reset(QUEUE_SIZE, QUEUE_SIZE);
+    ExpansionWorkspace workspace(true /* defersPushes */);
+    DicNode dicNode;
+    workspace.copyPushNextActive(&cache, &dicNode);
+    // Not equivalent to the first DicNode, so that both are kept.
+    static const int CODE_POINT = 'a';
+    DicNode childDicNode;
+    childDicNode.initAsChild(&dicNode, NOT_A_DICT_POS, NOT_A_WORD_ID,
+            CodePointArrayView(&CODE_POINT, 1));
+    workspace.copyPushNextActive(&cache, &childDicNode);
+    workspace.copyPushTerminal(&cache, &dicNode);
+    EXPECT_EQ(0, cache.terminalSize());
+    EXPECT_EQ(0, cache.getSearchEffort().get(SearchEffort::PUSHED_DIC_NODES));
+
+    workspace.flushTo(&cache);
+    EXPECT_EQ(1, cache.terminalSize());
+    EXPECT_EQ(3, cache.getSearchEffort().get(SearchEffort::PUSHED_DIC_NODES));
+    cache.advanceActiveDicNodes();
+    EXPECT_EQ(2, cache.activeSize());
+
+    // Flushing clears the deferred DicNodes.
+    workspace.flushTo(&cache);
+    EXPECT_EQ(1, cache.terminalSize());
+}
+
+TEST(ExpansionWorkspaceTest, TestChildDicNodesBuffers) {
+    ExpansionWorkspace workspace(false /* defersPushes */);
+    DicNodeVector *const buffer =
+            workspace.getChildDicNodesBuffer(ExpansionWorkspace::CHILD_DIC_NODES_FOR_OMISSION);
+    EXPECT_NE(buffer, workspace.getChildDicNodesBuffer(
+            ExpansionWorkspace::CHILD_DIC_NODES_FOR_INSERTION));
+    EXPECT_EQ(buffer,
+            workspace.getChildDicNodesBuffer(ExpansionWorkspace::CHILD_DIC_NODES_FOR_OMISSION));
+    EXPECT_EQ(0, buffer->getSizeAndLock());
+}
+
+}  // namespace
+}  // namespace latinime
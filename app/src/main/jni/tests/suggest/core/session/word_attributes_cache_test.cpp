@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "suggest/core/session/word_attributes_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+class WordAttributesCacheTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        mPolicy = DictionaryTestUtils::createPolicy();
+        ASSERT_NE(nullptr, mPolicy.get());
+    }
+
+    int addWord(const std::vector<int> &codePoints, const int probability) {
+        DictionaryTestUtils::addUnigram(mPolicy.get(), codePoints, probability);
+        return mPolicy->getWordId(CodePointArrayView(codePoints), false /* forceLowerCaseSearch */);
+    }
+
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr mPolicy;
+};
+
+TEST_F(WordAttributesCacheTest, TestGetWordAttributes) {
+    WordAttributesCache cache;
+    const int wordId = addWord({ 'a', 'b', 'c' }, 100);
+    const int otherWordId = addWord({ 'a', 'b', 'd' }, 50);
+    const int prevWordIdArray[] = { otherWordId };
+    const WordIdArrayView prevWordIds(prevWordIdArray, 1 /* size */);
+    EXPECT_EQ(100, cache.getWordAttributes(mPolicy.get(), WordIdArrayView(), wordId,
+            nullptr /* multiBigramMap */).getProbability());
+    EXPECT_EQ(mPolicy->getWordAttributesInContext(prevWordIds, wordId,
+            nullptr /* multiBigramMap */).getProbability(),
+            cache.getWordAttributes(mPolicy.get(), prevWordIds, wordId,
+                    nullptr /* multiBigramMap */).getProbability());
+    EXPECT_EQ(50, cache.getWordAttributes(mPolicy.get(), WordIdArrayView(), otherWordId,
+            nullptr /* multiBigramMap */).getProbability());
+    EXPECT_EQ(NOT_A_PROBABILITY, cache.getWordAttributes(mPolicy.get(), WordIdArrayView(),
+            NOT_A_WORD_ID, nullptr /* multiBigramMap */).getProbability());
+}
+
+TEST_F(WordAttributesCacheTest, TestClear) {
+    WordAttributesCache cache;
+    const int wordId = addWord({ 'a', 'b', 'c' }, 100);
+    EXPECT_EQ(100, cache.getWordAttributes(mPolicy.get(), WordIdArrayView(), wordId,
+            nullptr /* multiBigramMap */).getProbability());
+    addWord({ 'a', 'b', 'c' }, 200);
+    // Still memoised.
+    EXPECT_EQ(100, cache.getWordAttributes(mPolicy.get(), WordIdArrayView(), wordId,
+            nullptr /* multiBigramMap */).getProbability());
+    cache.clear();
+    EXPECT_EQ(200, cache.getWordAttributes(mPolicy.get(), WordIdArrayView(), wordId,
+            nullptr /* multiBigramMap */).getProbability());
+}
+
+}  // namespace
+}  // namespace latinime
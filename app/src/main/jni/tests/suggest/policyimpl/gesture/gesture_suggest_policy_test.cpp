@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/policyimpl/gesture/gesture_suggest_policy.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/property/ngram_context.h"
+#include "suggest/core/dictionary/dictionary.h"
+#include "suggest/core/layout/proximity_info.h"
+#include "suggest/core/result/suggested_word.h"
+#include "suggest/core/result/suggestion_results.h"
+#include "suggest/core/session/dic_traverse_session.h"
+#include "suggest/core/suggest_options.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "tests/suggest/core/layout/proximity_info_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// Swipes are sampled every POINT_INTERVAL pixels and POINT_DURATION milliseconds, which is about
+// the speed of a fluent gesture.
+static const int POINT_INTERVAL = 20;
+static const int POINT_DURATION = 10;
+static const int MAX_GESTURE_POINT_COUNT = 512;
+
+static const char *const WORDS[] = { "the", "they", "then", "there", "hello", "help",
+        "helped", "world", "word", "words", "keyboard", "key", "keys", "kept", "quick",
+        "brown", "fox", "jumps" };
+
+std::unique_ptr<Dictionary> createDictionaryWithWords() {
+    std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary();
+    for (const char *const word : WORDS) {
+        DictionaryTestUtils::addUnigram(dictionary.get(), DictionaryTestUtils::toCodePoints(word));
+    }
+    return dictionary;
+}
+
+// Swipes along the straight lines between the key centers of the word, moved by (offsetX,
+// offsetY), on the QWERTY keyboard of ProximityInfoTestUtils. Returns the suggested words with
+// their scores, best first.
+std::vector<std::pair<std::string, int>> getGestureSuggestions(const Dictionary *const dictionary,
+        const ProximityInfo *const proximityInfo, const char *const word, const int offsetX,
+        const int offsetY) {
+    int xs[MAX_GESTURE_POINT_COUNT];
+    int ys[MAX_GESTURE_POINT_COUNT];
+    int times[MAX_GESTURE_POINT_COUNT];
+    int pointerIds[MAX_GESTURE_POINT_COUNT] = {};
+    int codePoints[MAX_GESTURE_POINT_COUNT];
+    int pointCount = 0;
+    int lastX = 0;
+    int lastY = 0;
+    for (int i = 0; word[i] != '\0'; ++i) {
+        int x = 0;
+        int y = 0;
+        EXPECT_TRUE(ProximityInfoTestUtils::getKeyCenter(proximityInfo, word[i], &x, &y));
+        x += offsetX;
+        y += offsetY;
+        const int dx = x - lastX;
+        const int dy = y - lastY;
+        const int stepCount = i == 0 ? 1 : std::max(1, static_cast<int>(
+                sqrtf(static_cast<float>(dx * dx + dy * dy))) / POINT_INTERVAL);
+        for (int step = 1; step <= stepCount && pointCount < MAX_GESTURE_POINT_COUNT; ++step) {
+            xs[pointCount] = lastX + dx * step / stepCount;
+            ys[pointCount] = lastY + dy * step / stepCount;
+            times[pointCount] = pointCount * POINT_DURATION;
+            codePoints[pointCount] = NOT_A_CODE_POINT;
+            ++pointCount;
+        }
+        lastX = x;
+        lastY = y;
+    }
+    // See SuggestOptions. The weight for the locale is in thousands.
+    int options[] = { 1 /* isGesture */, 0 /* useFullEditDistance */,
+            0 /* blockOffensiveWords */, 0 /* spaceAwareGesture */, 1000 /* weightForLocale */ };
+    const SuggestOptions suggestOptions(options, NELEMS(options));
+    const NgramContext ngramContext;
+    DicTraverseSession session(false /* usesLargeCache */);
+    SuggestionResults suggestionResults(MAX_RESULTS);
+    dictionary->getSuggestions(const_cast<ProximityInfo *>(proximityInfo), &session, xs, ys,
+            times, pointerIds, codePoints, pointCount, &ngramContext, &suggestOptions,
+            NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL, &suggestionResults);
+    std::vector<SuggestedWord> suggestedWords;
+    suggestionResults.getSuggestedWords(&suggestedWords);
+    std::vector<std::pair<std::string, int>> suggestions;
+    // Worst first.
+    for (auto it = suggestedWords.rbegin(); it != suggestedWords.rend(); ++it) {
+        suggestions.emplace_back(std::string(it->getCodePoint(),
+                it->getCodePoint() + it->getCodePointCount()), it->getScore());
+    }
+    return suggestions;
+}
+
+int getScore(const std::vector<std::pair<std::string, int>> &suggestions,
+        const char *const word) {
+    for (const auto &suggestion : suggestions) {
+        if (suggestion.first == word) {
+            return suggestion.second;
+        }
+    }
+    return NOT_A_PROBABILITY;
+}
+
+TEST(GestureSuggestPolicyTest, TestSuggestsSwipedWord) {
+    const std::unique_ptr<Dictionary> dictionary = createDictionaryWithWords();
+    const std::unique_ptr<ProximityInfo> proximityInfo =
+            ProximityInfoTestUtils::createQwertyProximityInfo();
+    static const char *const SWIPED_WORDS[] = { "the", "hello", "world", "word", "keyboard",
+            "quick", "brown", "jumps" };
+    for (const char *const word : SWIPED_WORDS) {
+        const std::vector<std::pair<std::string, int>> suggestions =
+                getGestureSuggestions(dictionary.get(), proximityInfo.get(), word,
+                        0 /* offsetX */, 0 /* offsetY */);
+        ASSERT_FALSE(suggestions.empty()) << word;
+        EXPECT_EQ(word, suggestions[0].first);
+        for (size_t i = 1; i < suggestions.size(); ++i) {
+            EXPECT_GE(suggestions[i - 1].second, suggestions[i].second) << word;
+        }
+    }
+}
+
+TEST(GestureSuggestPolicyTest, TestSuggestsSloppilySwipedWord) {
+    const std::unique_ptr<Dictionary> dictionary = createDictionaryWithWords();
+    const std::unique_ptr<ProximityInfo> proximityInfo =
+            ProximityInfoTestUtils::createQwertyProximityInfo();
+    static const int OFFSET_X = ProximityInfoTestUtils::KEY_WIDTH / 4;
+    static const int OFFSET_Y = ProximityInfoTestUtils::KEY_HEIGHT / 4;
+    const std::vector<std::pair<std::string, int>> suggestions = getGestureSuggestions(
+            dictionary.get(), proximityInfo.get(), "keyboard", 0 /* offsetX */, 0 /* offsetY */);
+    const std::vector<std::pair<std::string, int>> sloppySuggestions = getGestureSuggestions(
+            dictionary.get(), proximityInfo.get(), "keyboard", OFFSET_X, OFFSET_Y);
+    ASSERT_FALSE(sloppySuggestions.empty());
+    EXPECT_EQ("keyboard", sloppySuggestions[0].first);
+    // Swiping off the key centers costs spatial distance.
+    EXPECT_GT(getScore(suggestions, "keyboard"), sloppySuggestions[0].second);
+}
+
+TEST(GestureSuggestPolicyTest, TestScoresFollowPathAndProbability) {
+    const std::unique_ptr<ProximityInfo> proximityInfo =
+            ProximityInfoTestUtils::createQwertyProximityInfo();
+    const std::unique_ptr<Dictionary> dictionary = createDictionaryWithWords();
+    // "words" starts with the swiped word, but the swipe doesn't reach 's'.
+    const std::vector<std::pair<std::string, int>> suggestions = getGestureSuggestions(
+            dictionary.get(), proximityInfo.get(), "word", 0 /* offsetX */, 0 /* offsetY */);
+    const int wordScore = getScore(suggestions, "word");
+    const int wordsScore = getScore(suggestions, "words");
+    ASSERT_NE(NOT_A_PROBABILITY, wordScore);
+    ASSERT_NE(NOT_A_PROBABILITY, wordsScore);
+    EXPECT_GT(wordScore, wordsScore);
+
+    // A more probable word costs less language distance on the same path.
+    const std::unique_ptr<Dictionary> otherDictionary = createDictionaryWithWords();
+    DictionaryTestUtils::addUnigram(otherDictionary.get(),
+            DictionaryTestUtils::toCodePoints("word"), 200 /* probability */);
+    const std::vector<std::pair<std::string, int>> otherSuggestions = getGestureSuggestions(
+            otherDictionary.get(), proximityInfo.get(), "word", 0 /* offsetX */,
+            0 /* offsetY */);
+    EXPECT_GT(getScore(otherSuggestions, "word"), wordScore);
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "suggest/policyimpl/typing/typing_beam_width_tuner.h"
+
+#include <gtest/gtest.h>
+
+namespace latinime {
+namespace {
+
+static const int TEST_BUDGET_US = 10000;
+
+void runSearches(TypingBeamWidthTuner *const tuner, const int count,
+        const int64_t elapsedTimeUs, const int budgetUs) {
+    for (int i = 0; i < count; ++i) {
+        tuner->onSearchFinished(elapsedTimeUs, budgetUs);
+    }
+}
+
+TEST(TypingBeamWidthTunerTest, TestDefault) {
+    TypingBeamWidthTuner tuner;
+    EXPECT_EQ(TypingBeamWidthTuner::DEFAULT_BEAM_WIDTH, tuner.getBeamWidth());
+}
+
+TEST(TypingBeamWidthTunerTest, TestShrink) {
+    TypingBeamWidthTuner tuner;
+    const int overBudgetTimeUs = TEST_BUDGET_US * 2;
+    runSearches(&tuner, TypingBeamWidthTuner::OVER_BUDGET_SEARCH_COUNT_TO_SHRINK - 1,
+            overBudgetTimeUs, TEST_BUDGET_US);
+    EXPECT_EQ(TypingBeamWidthTuner::DEFAULT_BEAM_WIDTH, tuner.getBeamWidth());
+    runSearches(&tuner, 1, overBudgetTimeUs, TEST_BUDGET_US);
+    EXPECT_GT(TypingBeamWidthTuner::DEFAULT_BEAM_WIDTH, tuner.getBeamWidth());
+}
+
+TEST(TypingBeamWidthTunerTest, TestShrinkNeedsConsecutiveSearches) {
+    TypingBeamWidthTuner tuner;
+    for (int i = 0; i < TypingBeamWidthTuner::OVER_BUDGET_SEARCH_COUNT_TO_SHRINK * 2; ++i) {
+        tuner.onSearchFinished(TEST_BUDGET_US * 2, TEST_BUDGET_US);
+        tuner.onSearchFinished(TEST_BUDGET_US, TEST_BUDGET_US);
+    }
+    EXPECT_EQ(TypingBeamWidthTuner::DEFAULT_BEAM_WIDTH, tuner.getBeamWidth());
+}
+
+TEST(TypingBeamWidthTunerTest, TestGrow) {
+    TypingBeamWidthTuner tuner;
+    runSearches(&tuner, TypingBeamWidthTuner::UNDER_BUDGET_SEARCH_COUNT_TO_GROW - 1,
+            0 /* elapsedTimeUs */, TEST_BUDGET_US);
+    EXPECT_EQ(TypingBeamWidthTuner::DEFAULT_BEAM_WIDTH, tuner.getBeamWidth());
+    runSearches(&tuner, 1, 0 /* elapsedTimeUs */, TEST_BUDGET_US);
+    EXPECT_LT(TypingBeamWidthTuner::DEFAULT_BEAM_WIDTH, tuner.getBeamWidth());
+}
+
+TEST(TypingBeamWidthTunerTest, TestClamp) {
+    TypingBeamWidthTuner tuner;
+    runSearches(&tuner, TypingBeamWidthTuner::OVER_BUDGET_SEARCH_COUNT_TO_SHRINK * 100,
+            TEST_BUDGET_US * 2, TEST_BUDGET_US);
+    EXPECT_EQ(TypingBeamWidthTuner::MIN_BEAM_WIDTH, tuner.getBeamWidth());
+    runSearches(&tuner, TypingBeamWidthTuner::UNDER_BUDGET_SEARCH_COUNT_TO_GROW * 100,
+            0 /* elapsedTimeUs */, TEST_BUDGET_US);
+    EXPECT_EQ(TypingBeamWidthTuner::MAX_BEAM_WIDTH, tuner.getBeamWidth());
+}
+
+TEST(TypingBeamWidthTunerTest, TestFixedBeamWidth) {
+    TypingBeamWidthTuner tuner;
+    tuner.setFixedBeamWidth(100);
+    EXPECT_EQ(100, tuner.getBeamWidth());
+    // The fixed beam isn't adapted, and the adapted one doesn't change meanwhile.
+    runSearches(&tuner, TypingBeamWidthTuner::OVER_BUDGET_SEARCH_COUNT_TO_SHRINK,
+            TEST_BUDGET_US * 2, TEST_BUDGET_US);
+    EXPECT_EQ(100, tuner.getBeamWidth());
+    tuner.setFixedBeamWidth(0);
+    EXPECT_EQ(TypingBeamWidthTuner::DEFAULT_BEAM_WIDTH, tuner.getBeamWidth());
+}
+
+TEST(TypingBeamWidthTunerTest, TestDefaultBudget) {
+    TypingBeamWidthTuner tuner;
+    // Without a time limit, searches within the default budget must not shrink the beam.
+    runSearches(&tuner, TypingBeamWidthTuner::OVER_BUDGET_SEARCH_COUNT_TO_SHRINK,
+            TypingBeamWidthTuner::DEFAULT_SEARCH_TIME_BUDGET_US, 0 /* timeBudgetUs */);
+    EXPECT_EQ(TypingBeamWidthTuner::DEFAULT_BEAM_WIDTH, tuner.getBeamWidth());
+    runSearches(&tuner, TypingBeamWidthTuner::OVER_BUDGET_SEARCH_COUNT_TO_SHRINK,
+            TypingBeamWidthTuner::DEFAULT_SEARCH_TIME_BUDGET_US + 1, 0 /* timeBudgetUs */);
+    EXPECT_GT(TypingBeamWidthTuner::DEFAULT_BEAM_WIDTH, tuner.getBeamWidth());
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/policyimpl/typing/typing_latency_guard.h"
+
+#include <gtest/gtest.h>
+
+#include "suggest/policyimpl/typing/typing_beam_width_tuner.h"
+
+namespace latinime {
+namespace {
+
+static const int TEST_BUDGET_US = 10000;
+
+void runSearches(TypingLatencyGuard *const guard, const int count,
+        const int64_t elapsedTimeUs, const int budgetUs) {
+    for (int i = 0; i < count; ++i) {
+        guard->onSearchFinished(elapsedTimeUs, budgetUs);
+    }
+}
+
+TEST(TypingLatencyGuardTest, TestDefault) {
+    TypingLatencyGuard guard;
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_FULL, guard.getLevel());
+}
+
+TEST(TypingLatencyGuardTest, TestDegradeNeedsFullWindow) {
+    TypingLatencyGuard guard;
+    runSearches(&guard, TypingLatencyGuard::WINDOW_SIZE - 1, TEST_BUDGET_US * 2, TEST_BUDGET_US);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_FULL, guard.getLevel());
+    runSearches(&guard, 1, TEST_BUDGET_US * 2, TEST_BUDGET_US);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_SMALL_BEAM, guard.getLevel());
+    // The next level is judged by a window of its own.
+    runSearches(&guard, TypingLatencyGuard::WINDOW_SIZE - 1, TEST_BUDGET_US * 2, TEST_BUDGET_US);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_SMALL_BEAM, guard.getLevel());
+    runSearches(&guard, 1, TEST_BUDGET_US * 2, TEST_BUDGET_US);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_NO_LOOK_AHEAD_CORRECTION, guard.getLevel());
+}
+
+TEST(TypingLatencyGuardTest, TestTailLatency) {
+    TypingLatencyGuard guard;
+    // One slow search in the window is below the 95th percentile.
+    runSearches(&guard, TypingLatencyGuard::WINDOW_SIZE - 1, TEST_BUDGET_US * 3 / 4,
+            TEST_BUDGET_US);
+    runSearches(&guard, 1, TEST_BUDGET_US * 10, TEST_BUDGET_US);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_FULL, guard.getLevel());
+    // Three slow searches are not.
+    runSearches(&guard, 2, TEST_BUDGET_US * 10, TEST_BUDGET_US);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_SMALL_BEAM, guard.getLevel());
+}
+
+TEST(TypingLatencyGuardTest, TestLadder) {
+    TypingLatencyGuard guard;
+    runSearches(&guard, TypingLatencyGuard::WINDOW_SIZE * TypingLatencyGuard::LEVEL_COUNT * 2,
+            TEST_BUDGET_US * 2, TEST_BUDGET_US);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_NO_MULTI_WORD, guard.getLevel());
+    // Close to the budget; stay degraded.
+    runSearches(&guard, TypingLatencyGuard::WINDOW_SIZE * 2, TEST_BUDGET_US * 3 / 4,
+            TEST_BUDGET_US);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_NO_MULTI_WORD, guard.getLevel());
+    // Enough headroom; walk back up one level per window.
+    runSearches(&guard, TypingLatencyGuard::WINDOW_SIZE, 0 /* elapsedTimeUs */, TEST_BUDGET_US);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_NO_LOOK_AHEAD_CORRECTION, guard.getLevel());
+    runSearches(&guard, TypingLatencyGuard::WINDOW_SIZE * TypingLatencyGuard::LEVEL_COUNT,
+            0 /* elapsedTimeUs */, TEST_BUDGET_US);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_FULL, guard.getLevel());
+}
+
+TEST(TypingLatencyGuardTest, TestDefaultBudget) {
+    TypingLatencyGuard guard;
+    runSearches(&guard, TypingLatencyGuard::WINDOW_SIZE,
+            TypingBeamWidthTuner::DEFAULT_SEARCH_TIME_BUDGET_US, 0 /* timeBudgetUs */);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_FULL, guard.getLevel());
+    runSearches(&guard, TypingLatencyGuard::WINDOW_SIZE,
+            TypingBeamWidthTuner::DEFAULT_SEARCH_TIME_BUDGET_US + 1, 0 /* timeBudgetUs */);
+    EXPECT_EQ(TypingLatencyGuard::LEVEL_SMALL_BEAM, guard.getLevel());
+}
+
+}  // namespace
+}  // namespace latinime
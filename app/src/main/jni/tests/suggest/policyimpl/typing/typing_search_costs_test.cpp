@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/policyimpl/typing/typing_search_costs.h"
+
+#include <gtest/gtest.h>
+
+#include "suggest/policyimpl/typing/scoring_params.h"
+
+namespace latinime {
+namespace {
+
+TEST(TypingSearchCostsTest, TestMultiWordCostMultiplier) {
+    TypingSearchCosts searchCosts;
+    searchCosts.init(2.0f /* multiWordCostMultiplier */, 1.0f /* weightForLocale */);
+    EXPECT_FLOAT_EQ(ScoringParams::SPACE_OMISSION_COST * 2.0f,
+            searchCosts.getSpaceOmissionCost());
+    EXPECT_FLOAT_EQ(ScoringParams::SPACE_SUBSTITUTION_COST * 2.0f,
+            searchCosts.getSpaceSubstitutionCostRate());
+    EXPECT_GT(searchCosts.getMinCorrectionCostPerInput(), 0.0f);
+    EXPECT_LE(searchCosts.getMinCorrectionCostPerInput(), ScoringParams::SUBSTITUTION_COST);
+}
+
+TEST(TypingSearchCostsTest, TestWeightForLocale) {
+    TypingSearchCosts searchCosts;
+    searchCosts.init(1.0f /* multiWordCostMultiplier */, 1.0f /* weightForLocale */);
+    EXPECT_TRUE(searchCosts.allowsSpaceOmission());
+    EXPECT_TRUE(searchCosts.allowsSpaceSubstitution());
+    searchCosts.init(1.0f /* multiWordCostMultiplier */, 0.5f /* weightForLocale */);
+    EXPECT_FALSE(searchCosts.allowsSpaceOmission());
+    EXPECT_FALSE(searchCosts.allowsSpaceSubstitution());
+}
+
+}  // namespace
+}  // namespace latinime
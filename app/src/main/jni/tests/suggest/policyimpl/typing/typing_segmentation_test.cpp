@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/policyimpl/typing/typing_segmentation.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dictionary/property/ngram_context.h"
+#include "suggest/core/dictionary/dictionary.h"
+#include "suggest/core/layout/proximity_info.h"
+#include "suggest/core/result/suggested_word.h"
+#include "suggest/core/result/suggestion_results.h"
+#include "suggest/core/session/dic_traverse_session.h"
+#include "suggest/core/suggest_options.h"
+#include "tests/suggest/core/dictionary/dictionary_test_utils.h"
+#include "tests/suggest/core/layout/proximity_info_test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// Types the input on the QWERTY keyboard of ProximityInfoTestUtils and returns the suggested
+// words, best first.
+std::vector<std::string> getTypingSuggestions(const Dictionary *const dictionary,
+        const char *const input) {
+    const std::unique_ptr<ProximityInfo> proximityInfo =
+            ProximityInfoTestUtils::createQwertyProximityInfo();
+    const int inputSize = static_cast<int>(strlen(input));
+    int codePoints[MAX_WORD_LENGTH];
+    int xs[MAX_WORD_LENGTH];
+    int ys[MAX_WORD_LENGTH];
+    int times[MAX_WORD_LENGTH];
+    int pointerIds[MAX_WORD_LENGTH] = {};
+    for (int i = 0; i < inputSize; ++i) {
+        codePoints[i] = input[i];
+        EXPECT_TRUE(ProximityInfoTestUtils::getKeyCenter(proximityInfo.get(), codePoints[i],
+                &xs[i], &ys[i]));
+        times[i] = i * 100;
+    }
+    int options[] = { 0 /* isGesture */, 0 /* useFullEditDistance */,
+            0 /* blockOffensiveWords */, 0 /* spaceAwareGesture */, 1000 /* weightForLocale */ };
+    const SuggestOptions suggestOptions(options, NELEMS(options));
+    const NgramContext ngramContext;
+    DicTraverseSession session(false /* usesLargeCache */);
+    SuggestionResults suggestionResults(MAX_RESULTS);
+    dictionary->getSuggestions(proximityInfo.get(), &session, xs, ys, times, pointerIds,
+            codePoints, inputSize, &ngramContext, &suggestOptions,
+            NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL, &suggestionResults);
+    std::vector<SuggestedWord> suggestedWords;
+    suggestionResults.getSuggestedWords(&suggestedWords);
+    std::vector<std::string> suggestions;
+    // Worst first.
+    for (auto it = suggestedWords.rbegin(); it != suggestedWords.rend(); ++it) {
+        suggestions.emplace_back(it->getCodePoint(),
+                it->getCodePoint() + it->getCodePointCount());
+    }
+    return suggestions;
+}
+
+const std::vector<const char *> WORDS = { "the", "quick", "brown", "fox", "jumps", "over",
+        "lazy", "dog", "internationalization", "international", "nation", "inter", "al",
+        "ization" };
+
+TEST(TypingSegmentationTest, TestSplitsLongInput) {
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary(WORDS);
+    const char *const input = "thequickbrownfoxjumps";
+    ASSERT_GE(static_cast<int>(strlen(input)), TypingSegmentation::MIN_INPUT_SIZE);
+    const std::vector<std::string> suggestions = getTypingSuggestions(dictionary.get(), input);
+    ASSERT_FALSE(suggestions.empty());
+    EXPECT_EQ("the quick brown fox jumps", suggestions[0]);
+}
+
+TEST(TypingSegmentationTest, TestSplitsLongInputWithTypo) {
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary(WORDS);
+    // "brown" with the 'p' next to the 'o', and "jumps" with the 'n' next to the 'm'.
+    static const char *const INPUTS[] = { "thequickbrpwnfoxjumps", "thequickbrownfoxjunps" };
+    for (const char *const input : INPUTS) {
+        const std::vector<std::string> suggestions =
+                getTypingSuggestions(dictionary.get(), input);
+        ASSERT_FALSE(suggestions.empty()) << input;
+        EXPECT_EQ("the quick brown fox jumps", suggestions[0]) << input;
+    }
+}
+
+TEST(TypingSegmentationTest, TestKeepsExactLongWord) {
+    const std::unique_ptr<Dictionary> dictionary = DictionaryTestUtils::createDictionary(WORDS);
+    // Also "international ization" and "inter nation al ization", which don't beat the exact
+    // single word.
+    const char *const input = "internationalization";
+    const std::vector<std::string> suggestions = getTypingSuggestions(dictionary.get(), input);
+    ASSERT_FALSE(suggestions.empty());
+    EXPECT_EQ("internationalization", suggestions[0]);
+}
+
+}  // namespace
+}  // namespace latinime
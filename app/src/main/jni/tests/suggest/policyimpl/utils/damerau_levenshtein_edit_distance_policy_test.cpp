@@ -18,6 +18,7 @@
 
 #include <gtest/gtest.h>
 
+#include <random>
 #include <vector>
 
 #include "suggest/policyimpl/utils/edit_distance.h"
@@ -61,5 +62,43 @@ TEST(DamerauLevenshteinEditDistancePolicyTest, TestEditDistance) {
     EXPECT_FLOAT_EQ(1.0f, getEditDistance({ 1, 2 }, { 2, 1 }));
     EXPECT_FLOAT_EQ(2.0f, getEditDistance({ 1, 2, 3, 4 }, { 2, 1, 4, 3 }));
 }
+int getBitParallelEditDistance(const std::vector<int> &codePoints0,
+        const std::vector<int> &codePoints1) {
+    return EditDistance::getDamerauLevenshteinEditDistance(codePoints0.data(),
+            codePoints0.size(), codePoints1.data(), codePoints1.size());
+}
+
+TEST(DamerauLevenshteinEditDistancePolicyTest, TestBitParallelEditDistance) {
+    EXPECT_EQ(0, getBitParallelEditDistance({}, {}));
+    EXPECT_EQ(5, getBitParallelEditDistance({}, { 1, 2, 3, 4, 5 }));
+    EXPECT_EQ(5, getBitParallelEditDistance({ 1, 2, 3, 4, 5 }, {}));
+    EXPECT_EQ(2, getBitParallelEditDistance({ 1, 2 }, { 0, 1, 2, 3 }));
+    EXPECT_EQ(1, getBitParallelEditDistance({ 1, 2 }, { 2, 1 }));
+    EXPECT_EQ(2, getBitParallelEditDistance({ 1, 2, 3, 4 }, { 2, 1, 4, 3 }));
+    // Optimal string alignment: the transposed characters are not edited again.
+    EXPECT_EQ(3, getBitParallelEditDistance({ 'c', 'a' }, { 'a', 'b', 'c' }));
+    // The characters are compared like getSubstitutionCost() does.
+    EXPECT_EQ(0, getBitParallelEditDistance({ 'A', 0xE9 }, { 'a', 'e' }));
+}
+
+TEST(DamerauLevenshteinEditDistancePolicyTest, TestBitParallelEditDistanceMatchesTable) {
+    std::mt19937 random(1234);
+    // A small alphabet, so that the strings have many matches and transpositions. The lengths go
+    // beyond a machine word, where the table is used.
+    std::uniform_int_distribution<int> codePointDistribution('a', 'd');
+    std::uniform_int_distribution<int> lengthDistribution(0, 70);
+    for (int i = 0; i < 2000; ++i) {
+        std::vector<int> codePoints0(lengthDistribution(random));
+        std::vector<int> codePoints1(lengthDistribution(random));
+        for (int &codePoint : codePoints0) {
+            codePoint = codePointDistribution(random);
+        }
+        for (int &codePoint : codePoints1) {
+            codePoint = codePointDistribution(random);
+        }
+        EXPECT_EQ(static_cast<int>(getEditDistance(codePoints0, codePoints1)),
+                getBitParallelEditDistance(codePoints0, codePoints1));
+    }
+}
 }  // namespace
 }  // namespace latinime
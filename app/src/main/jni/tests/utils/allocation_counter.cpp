@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tests/utils/allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation operators of the unit tests to count the allocations. The core
+// doesn't call malloc() directly, so every container allocation goes through operator new. The
+// operators are not inlined, so that the compiler doesn't see free() on memory from operator new.
+
+namespace {
+
+thread_local int64_t sThreadAllocationCount = 0;
+
+} // namespace
+
+__attribute__((noinline)) void *operator new(size_t size) {
+    ++sThreadAllocationCount;
+    void *const ptr = malloc(size == 0 ? 1 : size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+__attribute__((noinline)) void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+__attribute__((noinline)) void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    ++sThreadAllocationCount;
+    return malloc(size == 0 ? 1 : size);
+}
+
+__attribute__((noinline)) void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+__attribute__((noinline)) void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete[](void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+namespace latinime {
+
+/* static */ int64_t AllocationCounter::getThreadAllocationCount() {
+    return sThreadAllocationCount;
+}
+
+} // namespace latinime
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_ALLOCATION_COUNTER_H
+#define LATINIME_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+#include "defines.h"
+
+namespace latinime {
+
+// Counts the heap allocations made by the calling thread since the construction. The unit tests
+// replace the global operator new to count them, see allocation_counter.cpp.
+//
+//   AllocationCounter allocationCounter;
+//   ... // The code that should not allocate.
+//   EXPECT_EQ(0, allocationCounter.getAllocationCount());
+class AllocationCounter {
+ public:
+    AllocationCounter() : mInitialAllocationCount(getThreadAllocationCount()) {}
+
+    int64_t getAllocationCount() const {
+        return getThreadAllocationCount() - mInitialAllocationCount;
+    }
+
+    static int64_t getThreadAllocationCount();
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(AllocationCounter);
+
+    const int64_t mInitialAllocationCount;
+};
+} // namespace latinime
+#endif // LATINIME_ALLOCATION_COUNTER_H
@@ -35,5 +35,30 @@ TEST(AutocorrectionThresholdUtilsTest, SameData) {
     EXPECT_EQ(0, CalcEditDistance({3, 3, 3}, {3, 3, 3}));
 }
 
+TEST(AutocorrectionThresholdUtilsTest, BatchScores) {
+    const std::vector<int> before = { 'T', 'e', 'h' };
+    const std::vector<std::vector<int>> afters = {
+            { 't', 'h', 'e' }, { 't', 'e', 'a' }, {}, { ' ' }, { 't', 'e', 'h', 'e', 'e' },
+            { 'x', 'y', 'z' } };
+    const std::vector<int> scores = { 1000000, 500000, 1000000, 1000000, 0, 1000000 };
+    std::vector<int> concatenatedAfters;
+    std::vector<int> afterLengths;
+    for (const std::vector<int> &after : afters) {
+        concatenatedAfters.insert(concatenatedAfters.end(), after.begin(), after.end());
+        afterLengths.push_back(after.size());
+    }
+    std::vector<float> normalizedScores(afters.size());
+    AutocorrectionThresholdUtils::calcNormalizedScores(before.data(), before.size(),
+            concatenatedAfters.data(), afterLengths.data(), scores.data(), afters.size(),
+            normalizedScores.data());
+    for (size_t i = 0; i < afters.size(); ++i) {
+        EXPECT_FLOAT_EQ(AutocorrectionThresholdUtils::calcNormalizedScore(before.data(),
+                before.size(), afters[i].data(), afters[i].size(), scores[i]),
+                normalizedScores[i]);
+    }
+    EXPECT_GT(normalizedScores[0], 0.0f);
+    EXPECT_FLOAT_EQ(0.0f, normalizedScores[2]);
+}
+
 }  // namespace
 }  // namespace latinime
@@ -101,6 +101,32 @@ TEST(CharUtilsTest, TestToBaseCodePoint) {
     EXPECT_EQ(0x1F36A /* COOKIE */, CharUtils::toBaseCodePoint(0x1F36A /* COOKIE */));
 }
 
+TEST(CharUtilsTest, TestToLowerCaseWithTable) {
+    EXPECT_EQ(0x0069 /* LATIN SMALL LETTER I */,
+            CharUtils::toLowerCase(0x0130 /* LATIN CAPITAL LETTER I WITH DOT ABOVE */));
+    EXPECT_EQ(0x00DF /* LATIN SMALL LETTER SHARP S */,
+            CharUtils::toLowerCase(0x1E9E /* LATIN CAPITAL LETTER SHARP S */));
+    EXPECT_EQ(0xFF41 /* FULLWIDTH LATIN SMALL LETTER A */,
+            CharUtils::toLowerCase(0xFF21 /* FULLWIDTH LATIN CAPITAL LETTER A */));
+    EXPECT_EQ(0xFFFF, CharUtils::toLowerCase(0xFFFF));
+    EXPECT_EQ(0x10000, CharUtils::toLowerCase(0x10000));
+    EXPECT_EQ(NOT_A_CODE_POINT, CharUtils::toLowerCase(NOT_A_CODE_POINT));
+    EXPECT_EQ(NOT_A_CODE_POINT, CharUtils::toBaseLowerCase(NOT_A_CODE_POINT));
+    EXPECT_EQ(CODE_POINT_BEGINNING_OF_SENTENCE,
+            CharUtils::toBaseLowerCase(CODE_POINT_BEGINNING_OF_SENTENCE));
+}
+
+TEST(CharUtilsTest, TestToBaseLowerCaseInBmp) {
+    int mismatchCount = 0;
+    for (int c = 0; c <= 0x10000; ++c) {
+        if (CharUtils::toBaseLowerCase(c)
+                != CharUtils::toLowerCase(CharUtils::toBaseCodePoint(c))) {
+            ++mismatchCount;
+        }
+    }
+    EXPECT_EQ(0, mismatchCount);
+}
+
 TEST(CharUtilsTest, TestIsIntentionalOmissionCodePoint) {
     EXPECT_TRUE(CharUtils::isIntentionalOmissionCodePoint('\''));
     EXPECT_TRUE(CharUtils::isIntentionalOmissionCodePoint('-'));
@@ -118,5 +144,23 @@ TEST(CharUtilsTest, TestIsInUnicodeSpace) {
     EXPECT_TRUE(CharUtils::isInUnicodeSpace(0x1F36A /* COOKIE */));
 }
 
+TEST(CharUtilsTest, TestIsLetterOrDigit) {
+    EXPECT_TRUE(CharUtils::isLetterOrDigit('a'));
+    EXPECT_TRUE(CharUtils::isLetterOrDigit('Z'));
+    EXPECT_TRUE(CharUtils::isLetterOrDigit('7'));
+    EXPECT_TRUE(CharUtils::isLetterOrDigit(0xE9 /* LATIN SMALL LETTER E WITH ACUTE */));
+    EXPECT_TRUE(CharUtils::isLetterOrDigit(0x0410 /* CYRILLIC CAPITAL LETTER A */));
+    EXPECT_TRUE(CharUtils::isLetterOrDigit(0x3042 /* HIRAGANA LETTER A */));
+    EXPECT_FALSE(CharUtils::isLetterOrDigit(' '));
+    EXPECT_FALSE(CharUtils::isLetterOrDigit('\''));
+    EXPECT_FALSE(CharUtils::isLetterOrDigit(0xAB /* LEFT-POINTING DOUBLE ANGLE QUOTATION MARK */));
+    EXPECT_FALSE(CharUtils::isLetterOrDigit(0xD7 /* MULTIPLICATION SIGN */));
+    EXPECT_FALSE(CharUtils::isLetterOrDigit(0x2019 /* RIGHT SINGLE QUOTATION MARK */));
+    EXPECT_FALSE(CharUtils::isLetterOrDigit(0x3002 /* IDEOGRAPHIC FULL STOP */));
+    EXPECT_FALSE(CharUtils::isLetterOrDigit(0xD83E /* unpaired surrogate */));
+    EXPECT_FALSE(CharUtils::isLetterOrDigit(0x1F36A /* COOKIE */));
+    EXPECT_FALSE(CharUtils::isLetterOrDigit(NOT_A_CODE_POINT));
+}
+
 }  // namespace
 }  // namespace latinime
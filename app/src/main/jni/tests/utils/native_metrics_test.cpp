@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/native_metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace latinime {
+namespace {
+
+int64_t getValue(const std::vector<int64_t> &values, const NativeMetrics::Metric metric,
+        const int index) {
+    return values[metric * NativeMetrics::VALUES_PER_METRIC + index];
+}
+
+TEST(NativeMetricsTest, TestBucketIndex) {
+    EXPECT_EQ(0, NativeMetrics::getBucketIndex(0));
+    EXPECT_EQ(0, NativeMetrics::getBucketIndex(1));
+    EXPECT_EQ(1, NativeMetrics::getBucketIndex(2));
+    EXPECT_EQ(1, NativeMetrics::getBucketIndex(3));
+    EXPECT_EQ(10, NativeMetrics::getBucketIndex(1024));
+    EXPECT_EQ(10, NativeMetrics::getBucketIndex(2047));
+    EXPECT_EQ(NativeMetrics::BUCKET_COUNT - 1, NativeMetrics::getBucketIndex(INT64_MAX));
+}
+
+TEST(NativeMetricsTest, TestRecordAndCopy) {
+    NativeMetrics::reset();
+    NativeMetrics::record(NativeMetrics::METRIC_FLUSH, 3);
+    NativeMetrics::record(NativeMetrics::METRIC_FLUSH, 1500);
+    NativeMetrics::record(NativeMetrics::METRIC_FLUSH, -5);
+
+    std::vector<int64_t> values(NativeMetrics::VALUE_COUNT);
+    EXPECT_EQ(NativeMetrics::VALUE_COUNT, NativeMetrics::copyTo(values.data(), values.size()));
+    EXPECT_EQ(3, getValue(values, NativeMetrics::METRIC_FLUSH, 0));
+    EXPECT_EQ(1503, getValue(values, NativeMetrics::METRIC_FLUSH, 1));
+    EXPECT_EQ(1500, getValue(values, NativeMetrics::METRIC_FLUSH, 2));
+    EXPECT_EQ(1, getValue(values, NativeMetrics::METRIC_FLUSH, 3 + 0));
+    EXPECT_EQ(1, getValue(values, NativeMetrics::METRIC_FLUSH, 3 + 1));
+    EXPECT_EQ(1, getValue(values, NativeMetrics::METRIC_FLUSH, 3 + 10));
+    EXPECT_EQ(0, getValue(values, NativeMetrics::METRIC_GET_PREDICTIONS, 0));
+
+    // Only whole metrics are copied.
+    EXPECT_EQ(NativeMetrics::VALUES_PER_METRIC,
+            NativeMetrics::copyTo(values.data(), NativeMetrics::VALUES_PER_METRIC * 2 - 1));
+
+    NativeMetrics::reset();
+    NativeMetrics::copyTo(values.data(), values.size());
+    EXPECT_EQ(0, getValue(values, NativeMetrics::METRIC_FLUSH, 0));
+    EXPECT_EQ(0, getValue(values, NativeMetrics::METRIC_FLUSH, 2));
+}
+
+TEST(NativeMetricsTest, TestConcurrentRecord) {
+    NativeMetrics::reset();
+    static const int THREAD_COUNT = 4;
+    static const int SAMPLE_COUNT = 10000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([i]() {
+            for (int j = 0; j < SAMPLE_COUNT; ++j) {
+                NativeMetrics::record(NativeMetrics::METRIC_SUGGEST_EXPAND, i + 1);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::vector<int64_t> values(NativeMetrics::VALUE_COUNT);
+    NativeMetrics::copyTo(values.data(), values.size());
+    EXPECT_EQ(THREAD_COUNT * SAMPLE_COUNT, getValue(values, NativeMetrics::METRIC_SUGGEST_EXPAND, 0));
+    EXPECT_EQ(SAMPLE_COUNT * (1 + 2 + 3 + 4),
+            getValue(values, NativeMetrics::METRIC_SUGGEST_EXPAND, 1));
+    EXPECT_EQ(THREAD_COUNT, getValue(values, NativeMetrics::METRIC_SUGGEST_EXPAND, 2));
+    NativeMetrics::reset();
+}
+
+}  // namespace
+}  // namespace latinime
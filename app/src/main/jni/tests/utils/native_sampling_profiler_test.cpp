@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/native_sampling_profiler.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace latinime {
+namespace {
+
+volatile uint32_t sSink = 0;
+
+// Keeps the CPU busy in this binary for about durationMs of wall time.
+void burnCpu(const int durationMs) {
+    const std::chrono::steady_clock::time_point end =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(durationMs);
+    uint32_t value = 1;
+    while (std::chrono::steady_clock::now() < end) {
+        for (int i = 0; i < 10000; ++i) {
+            value = value * 1664525u + 1013904223u;
+        }
+        sSink = value;
+    }
+}
+
+TEST(NativeSamplingProfilerTest, TestSamplesThisLibrary) {
+    ASSERT_TRUE(NativeSamplingProfiler::start(NativeSamplingProfiler::MIN_SAMPLING_INTERVAL_US));
+    EXPECT_TRUE(NativeSamplingProfiler::isRunning());
+    burnCpu(300 /* durationMs */);
+    NativeSamplingProfiler::stop();
+    EXPECT_FALSE(NativeSamplingProfiler::isRunning());
+
+    std::vector<int64_t> pcOffsets(NativeSamplingProfiler::MAX_PC_COUNT);
+    std::vector<int> counts(NativeSamplingProfiler::MAX_PC_COUNT);
+    const int pcCount = NativeSamplingProfiler::getSamples(NativeSamplingProfiler::MAX_PC_COUNT,
+            pcOffsets.data(), counts.data());
+    EXPECT_GT(pcCount, 0);
+    int64_t sampledCount = 0;
+    for (int i = 0; i < pcCount; ++i) {
+        EXPECT_GE(pcOffsets[i], 0);
+        EXPECT_GT(counts[i], 0);
+        sampledCount += counts[i];
+    }
+    int64_t sampleCounts[NativeSamplingProfiler::SAMPLE_COUNT_SIZE];
+    NativeSamplingProfiler::getSampleCounts(sampleCounts);
+    EXPECT_EQ(sampleCounts[NativeSamplingProfiler::SAMPLE_COUNT_TOTAL], sampledCount
+            + sampleCounts[NativeSamplingProfiler::SAMPLE_COUNT_OUTSIDE_LIBRARY]
+            + sampleCounts[NativeSamplingProfiler::SAMPLE_COUNT_DROPPED]);
+
+    // Nothing is sampled after stop().
+    burnCpu(50 /* durationMs */);
+    int64_t sampleCountsAfterStop[NativeSamplingProfiler::SAMPLE_COUNT_SIZE];
+    NativeSamplingProfiler::getSampleCounts(sampleCountsAfterStop);
+    EXPECT_EQ(sampleCounts[NativeSamplingProfiler::SAMPLE_COUNT_TOTAL],
+            sampleCountsAfterStop[NativeSamplingProfiler::SAMPLE_COUNT_TOTAL]);
+}
+
+TEST(NativeSamplingProfilerTest, TestStartClearsSamples) {
+    ASSERT_TRUE(NativeSamplingProfiler::start(NativeSamplingProfiler::MIN_SAMPLING_INTERVAL_US));
+    burnCpu(50 /* durationMs */);
+    NativeSamplingProfiler::stop();
+    // A long interval so that no sample is taken before the second stop().
+    ASSERT_TRUE(NativeSamplingProfiler::start(1000000 /* samplingIntervalUs */));
+    NativeSamplingProfiler::stop();
+    int64_t sampleCounts[NativeSamplingProfiler::SAMPLE_COUNT_SIZE];
+    NativeSamplingProfiler::getSampleCounts(sampleCounts);
+    EXPECT_EQ(0, sampleCounts[NativeSamplingProfiler::SAMPLE_COUNT_TOTAL]);
+    int64_t pcOffset = 0;
+    int count = 0;
+    EXPECT_EQ(0, NativeSamplingProfiler::getSamples(1, &pcOffset, &count));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/native_trace.h"
+
+#include <gtest/gtest.h>
+
+namespace latinime {
+namespace {
+
+TEST(NativeTraceTest, TestDisabledByDefault) {
+    EXPECT_FALSE(NativeTrace::isEnabled());
+    // Sections are no-ops while tracing is disabled.
+    const NativeTrace::ScopedSection section("NativeTraceTest");
+    EXPECT_FALSE(NativeTrace::isEnabled());
+}
+
+#ifndef __ANDROID__
+TEST(NativeTraceTest, TestCannotBeEnabledOnHost) {
+    EXPECT_FALSE(NativeTrace::setEnabled(true));
+    EXPECT_FALSE(NativeTrace::isEnabled());
+    {
+        const NativeTrace::ScopedSection section("NativeTraceTest");
+    }
+    EXPECT_FALSE(NativeTrace::setEnabled(false));
+    EXPECT_FALSE(NativeTrace::isEnabled());
+}
+#endif // __ANDROID__
+
+}  // namespace
+}  // namespace latinime
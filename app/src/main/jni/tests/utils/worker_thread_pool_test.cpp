@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026 The HeliBoard Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/worker_thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+namespace latinime {
+namespace {
+
+TEST(WorkerThreadPoolTest, TestRunAllTasks) {
+    static const int TASK_COUNT = 50;
+    WorkerThreadPool workerThreadPool(2 /* workerThreadCount */);
+    std::vector<int> results(TASK_COUNT, 0);
+    std::vector<WorkerThreadPool::Task> tasks;
+    for (int i = 0; i < TASK_COUNT; ++i) {
+        tasks.emplace_back([&results, i]() { results[i] = i * 2; });
+    }
+    workerThreadPool.runTasks(tasks);
+    for (int i = 0; i < TASK_COUNT; ++i) {
+        EXPECT_EQ(i * 2, results[i]);
+    }
+}
+
+TEST(WorkerThreadPoolTest, TestWithoutWorkers) {
+    WorkerThreadPool workerThreadPool(0 /* workerThreadCount */);
+    EXPECT_EQ(0, workerThreadPool.getWorkerThreadCount());
+    int count = 0;
+    std::vector<WorkerThreadPool::Task> tasks;
+    for (int i = 0; i < 3; ++i) {
+        tasks.emplace_back([&count]() { ++count; });
+    }
+    workerThreadPool.runTasks(tasks);
+    EXPECT_EQ(3, count);
+}
+
+TEST(WorkerThreadPoolTest, TestRepeatedBatches) {
+    WorkerThreadPool workerThreadPool(3 /* workerThreadCount */);
+    std::atomic<int> count(0);
+    std::vector<WorkerThreadPool::Task> tasks;
+    for (int i = 0; i < 4; ++i) {
+        tasks.emplace_back([&count]() { count.fetch_add(1); });
+    }
+    for (int i = 0; i < 100; ++i) {
+        workerThreadPool.runTasks(tasks);
+    }
+    EXPECT_EQ(400, count.load());
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,143 @@
+// Command line benchmark of the voice input model, meant to be pushed to a device with adb:
+//   whisper_bench -m model.bin [-t threads] [-a audio_ms] [-c audio_ctx] [-n decode_steps] [-r runs]
+//                 [-q q4_0|q4_1|q5_0|q5_1|q8_0] [-b budget_mb] [-k f16|q8_0|q4_0] [-e q4_0|q4_1|q5_0|q5_1|q8_0]
+// Prints the JSON of whisper_bench_model_str to stdout. With -q, an F16/F32 model is converted next to
+// itself first, and the converted copy is removed afterwards. With -e, the encoder matrices are quantized
+// while loading instead, and the accuracy against the model as stored is printed on a second line.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "src/ggml/whisper.h"
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s -m model.bin [-t threads] [-a audio_ms] [-c audio_ctx] [-n decode_steps] [-r runs]\n"
+                    "          [-q q4_0|q4_1|q5_0|q5_1|q8_0] [-b budget_mb] [-k f16|q8_0|q4_0]\n"
+                    "          [-e q4_0|q4_1|q5_0|q5_1|q8_0]\n", argv0);
+}
+
+static int parseFtype(const char *name) {
+    if(strcmp(name, "q4_0") == 0) return GGML_FTYPE_MOSTLY_Q4_0;
+    if(strcmp(name, "q4_1") == 0) return GGML_FTYPE_MOSTLY_Q4_1;
+    if(strcmp(name, "q5_0") == 0) return GGML_FTYPE_MOSTLY_Q5_0;
+    if(strcmp(name, "q5_1") == 0) return GGML_FTYPE_MOSTLY_Q5_1;
+    if(strcmp(name, "q8_0") == 0) return GGML_FTYPE_MOSTLY_Q8_0;
+    return -1;
+}
+
+static int parseKeyType(const char *name) {
+    if(strcmp(name, "f16") == 0) return GGML_TYPE_F16;
+    if(strcmp(name, "q8_0") == 0) return GGML_TYPE_Q8_0;
+    if(strcmp(name, "q4_0") == 0) return GGML_TYPE_Q4_0;
+    return -1;
+}
+
+int main(int argc, char **argv) {
+    std::string model;
+    int ftype = -1;
+    int key_type = GGML_TYPE_Q8_0;
+    int encoder_type = GGML_TYPE_COUNT;
+    long budget_mb = 0;
+    whisper_bench_params params = whisper_bench_default_params();
+
+    for(int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if(i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char *value = argv[++i];
+
+        if(strcmp(arg, "-m") == 0) {
+            model = value;
+        } else if(strcmp(arg, "-t") == 0) {
+            params.n_threads = atoi(value);
+        } else if(strcmp(arg, "-a") == 0) {
+            params.audio_ms = atoi(value);
+        } else if(strcmp(arg, "-c") == 0) {
+            params.audio_ctx = atoi(value);
+        } else if(strcmp(arg, "-n") == 0) {
+            params.n_decode = atoi(value);
+        } else if(strcmp(arg, "-r") == 0) {
+            params.n_runs = atoi(value);
+        } else if(strcmp(arg, "-b") == 0) {
+            budget_mb = atol(value);
+        } else if(strcmp(arg, "-q") == 0) {
+            ftype = parseFtype(value);
+            if(ftype < 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if(strcmp(arg, "-e") == 0) {
+            const int encoder_ftype = parseFtype(value);
+            if(encoder_ftype < 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            encoder_type = ggml_ftype_to_ggml_type((ggml_ftype)encoder_ftype);
+        } else if(strcmp(arg, "-k") == 0) {
+            key_type = parseKeyType(value);
+            if(key_type < 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(model.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string path = model;
+    if(ftype >= 0) {
+        path = model + ".bench";
+        const int result = whisper_model_quantize(model.c_str(), path.c_str(), (ggml_ftype)ftype, nullptr, nullptr);
+        if(result != 0) {
+            fprintf(stderr, "failed to convert %s (%d)\n", model.c_str(), result);
+            return 1;
+        }
+    }
+
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = false;
+    cparams.use_mmap = true;
+    cparams.type_k = (ggml_type)key_type;
+    cparams.mem_budget = (size_t)budget_mb << 20;
+    cparams.encoder_wtype = (ggml_type)encoder_type;
+
+    whisper_context *ctx = whisper_init_from_file_with_params(path.c_str(), cparams);
+    if(ctx == nullptr) {
+        fprintf(stderr, "failed to load %s\n", path.c_str());
+        if(ftype >= 0) remove(path.c_str());
+        return 1;
+    }
+
+    const std::string result = whisper_bench_model_str(ctx, params);
+    printf("%s\n", result.c_str());
+
+    bool failed = result.find("\"error\"") != std::string::npos;
+    if(!failed && encoder_type != GGML_TYPE_COUNT) {
+        cparams.encoder_wtype = GGML_TYPE_COUNT;
+        whisper_context *ctx_ref = whisper_init_from_file_with_params(path.c_str(), cparams);
+        if(ctx_ref == nullptr) {
+            fprintf(stderr, "failed to load %s\n", path.c_str());
+            failed = true;
+        } else {
+            const std::string accuracy = whisper_bench_accuracy_str(ctx, ctx_ref, params);
+            printf("%s\n", accuracy.c_str());
+            failed = accuracy.find("\"error\"") != std::string::npos;
+            whisper_free(ctx_ref);
+        }
+    }
+
+    whisper_free(ctx);
+    if(ftype >= 0) remove(path.c_str());
+
+    return failed ? 1 : 0;
+}